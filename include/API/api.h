@@ -19,13 +19,34 @@
 
 #include "API/errors.h"
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+class raw_ostream;
+} // namespace llvm
 
 namespace qssc {
 
+namespace config {
+struct QSSConfig;
+} // namespace config
+
+namespace hal::compile {
+class CompileCancellation;
+} // namespace hal::compile
+
 /// @brief Call the qss-compiler
 /// @param argc the number of argument strings
 /// @param argv array of argument strings
@@ -35,6 +56,191 @@ namespace qssc {
 int compile(int argc, char const **argv, std::string *outputString,
             std::optional<DiagnosticCallback> diagnosticCb);
 
+/// @brief Call the qss-compiler with a configuration built by the caller
+/// instead of parsing a command line. All options of the compilation,
+/// including the options of the OpenQASM 3 frontend and the pass pipeline
+/// with the options of its passes, are taken from the configuration. Each
+/// call compiles in a context of its own, so calls with different
+/// configurations may run concurrently within one process. The input type and
+/// the emit action are derived from the input source and the output file path
+/// when unset, as they are for a command line.
+/// @param config the configuration of the compilation
+/// @param outputString an optional buffer for the compilation result
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @return 0 on success
+int compile(const config::QSSConfig &config, std::string *outputString,
+            std::optional<DiagnosticCallback> diagnosticCb);
+
+/// @brief Call the qss-compiler via a command line as compile does, for calls
+/// which compile concurrently within one process, e.g., from the threads of a
+/// host application. The process-wide command line options are only held while
+/// the command line is parsed into a configuration, which is then compiled as
+/// by compile(const config::QSSConfig &, ...). Malformed command lines are
+/// returned as errors rather than exiting the process.
+/// @param argc the number of argument strings
+/// @param argv array of argument strings
+/// @param outputString an optional buffer for the compilation result
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics, possibly from several threads of the compilation
+/// @return 0 on success
+int compileConcurrent(int argc, char const **argv, std::string *outputString,
+                      std::optional<DiagnosticCallback> diagnosticCb);
+
+/// @brief Call the qss-compiler for a batch of programs sharing the same
+/// options. The target is built once for the batch and the programs are
+/// compiled in parallel.
+/// @param argc the number of argument strings
+/// @param argv array of argument strings without an input source
+/// @param inputs the program sources, interpreted as with "--direct"
+/// @param outputs an optional vector receiving the compilation result of each
+/// input
+/// @param statuses an optional vector receiving the status of each input, 0 on
+/// success
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics of all inputs
+/// @return 0 if all inputs compiled successfully
+int compileBatch(int argc, char const **argv,
+                 const std::vector<std::string> &inputs,
+                 std::vector<std::string> *outputs, std::vector<int> *statuses,
+                 std::optional<DiagnosticCallback> diagnosticCb);
+
+/// @brief Call the qss-compiler for a single program and several
+/// configurations of its target. The program is parsed and the command line
+/// passes, which must not depend on the target, are run once. The resulting
+/// module is then compiled for each configuration in parallel.
+/// @param argc the number of argument strings
+/// @param argv array of argument strings, whose target configuration is
+/// replaced by each of configPaths
+/// @param configPaths the target configurations to compile for
+/// @param outputs an optional vector receiving the compilation result for each
+/// configuration
+/// @param statuses an optional vector receiving the status of each
+/// configuration, 0 on success
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics of all configurations
+/// @return 0 if the program compiled successfully for all configurations
+int compileMultiConfig(int argc, char const **argv,
+                       const std::vector<std::string> &configPaths,
+                       std::vector<std::string> *outputs,
+                       std::vector<int> *statuses,
+                       std::optional<DiagnosticCallback> diagnosticCb);
+
+/// @brief Compile a stream of JSON Lines requests concurrently, streaming a
+/// JSON Lines response for each as it completes. The command line sets the
+/// base configuration of all requests, which is parsed once. Each request is
+/// an object with the program as "source" or as a "path" and optionally an
+/// "id", "inputType", "emit", "output" file, "target", "config", "numShots",
+/// "shotDelay", "passPipeline" and "includeDirs", overriding the base
+/// configuration. Each response has the "id" of its request, or its index in
+/// the stream, its "status", 0 on success, the "output" file or the
+/// base64-encoded "payload", the "error" of a failed request, its
+/// "diagnostics" and its "timings" in seconds. The jobs share their targets
+/// and the thread pool their passes run on.
+/// @param argc the number of argument strings of the base configuration
+/// @param argv array of argument strings of the base configuration
+/// @param requests stream of requests, one JSON object per line
+/// @param responses stream to write the responses to
+/// @param numJobs the maximum number of concurrent jobs, 0 for one per
+/// hardware thread
+/// @return 0 at the end of the request stream, 1 if the base configuration
+/// is invalid
+int compileJSONL(int argc, char const **argv, std::istream &requests,
+                 llvm::raw_ostream &responses, unsigned numJobs);
+
+/// @brief When a CompileServer replaces the MLIRContext of its jobs. The
+/// attributes and types uniqued in a context, e.g., angles, durations and
+/// waveform samples, are only freed with it, so a context reused by every
+/// job grows without bound.
+struct ContextRecyclingPolicy {
+  /// @brief Replace the context after this many jobs, 0 for never
+  unsigned maxJobsPerContext = 0;
+  /// @brief Replace the context once the memory allocated by the process
+  /// since its creation reaches this many bytes, 0 for never
+  size_t maxContextBytes = 0;
+};
+
+/// @brief The memory accounting of a CompileServer. Memory is measured for
+/// the whole process, so concurrent work on other threads contributes to it.
+struct CompileServerMetrics {
+  /// @brief The number of jobs compiled by the server
+  size_t numJobs = 0;
+  /// @brief The number of times the context has been replaced
+  size_t contextGeneration = 0;
+  /// @brief The number of jobs compiled in the current context
+  size_t contextJobs = 0;
+  /// @brief The memory allocated since the current context was created
+  int64_t contextAllocatedBytes = 0;
+  /// @brief The change of the allocated memory over the last job
+  int64_t lastJobAllocatedBytes = 0;
+  /// @brief The change of the resident memory over the last job
+  int64_t lastJobResidentBytes = 0;
+  /// @brief The resident memory after the last job
+  size_t residentBytes = 0;
+};
+
+/// @brief A long-lived compiler instance for compiling many programs in one
+/// process. The MLIRContext, target and target pass managers of the previous
+/// job are reused by the next job whenever its target, target configuration
+/// and pipeline options are unchanged, avoiding the per-job setup cost of
+/// compile. The context is replaced by a new generation according to the
+/// recycling policy of the server, keeping the registries, thread pool and
+/// targets warm. Process-wide options such as threading and the state of the
+/// OpenQASM 3 parser are fixed by the first job.
+class CompileServer {
+public:
+  explicit CompileServer(ContextRecyclingPolicy recyclingPolicy = {});
+  ~CompileServer();
+
+  /// @brief Get the memory accounting of the server.
+  CompileServerMetrics getMetrics() const;
+
+  /// @brief Replace the context now, freeing its memory, regardless of the
+  /// recycling policy.
+  void recycleContext();
+
+  /// @brief Compile a single job with the arguments of the qss-compiler.
+  /// Command line errors are reported rather than exiting the process.
+  /// @param argc the number of argument strings
+  /// @param argv array of argument strings
+  /// @param outputString an optional buffer for the compilation result
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics
+  /// @return 0 on success
+  int compile(int argc, char const **argv, std::string *outputString,
+              std::optional<DiagnosticCallback> diagnosticCb);
+
+  /// @brief Compile a batch of programs as with qssc::compileBatch, reusing
+  /// the target between batches.
+  int compileBatch(int argc, char const **argv,
+                   const std::vector<std::string> &inputs,
+                   std::vector<std::string> *outputs,
+                   std::vector<int> *statuses,
+                   std::optional<DiagnosticCallback> diagnosticCb);
+
+  /// @brief Compile a program for several target configurations as with
+  /// qssc::compileMultiConfig, reusing the context the program is parsed in
+  /// between jobs.
+  int compileMultiConfig(int argc, char const **argv,
+                         const std::vector<std::string> &configPaths,
+                         std::vector<std::string> *outputs,
+                         std::vector<int> *statuses,
+                         std::optional<DiagnosticCallback> diagnosticCb);
+
+  /// @brief Serve compilation requests until the end of the request stream.
+  /// Each request is "<argc>\n" followed by argc arguments each encoded as
+  /// "<length>\n<bytes>". Each response is "<status> <length>\n<bytes>" with
+  /// the status of compile and the compilation result.
+  /// @param requests stream of framed compilation requests
+  /// @param responses stream to write framed responses to
+  /// @return 0 at the end of the request stream, 1 on malformed requests
+  int serve(std::istream &requests, llvm::raw_ostream &responses);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
 /// @brief Call the parameter binder
 /// @param target name of the target to employ
 /// @param moduleInputPath path of the module to use as input
@@ -43,6 +249,7 @@ int compile(int argc, char const **argv, std::string *outputString,
 /// @param treatWarningsAsErrors return errors in place of warnings
 /// @param diagnosticCb an optional callback that will receive emitted
 /// diagnostics
+/// @param patchInParallel patch the binaries of the module concurrently
 /// @return 0 on success
 int bindArguments(std::string_view target, std::string_view configPath,
                   std::string_view moduleInput,
@@ -50,7 +257,276 @@ int bindArguments(std::string_view target, std::string_view configPath,
                   std::unordered_map<std::string, double> const &arguments,
                   bool treatWarningsAsErrors, bool enableInMemoryInput,
                   std::string *inMemoryOutput,
-                  const std::optional<DiagnosticCallback> &onDiagnostic);
+                  const std::optional<DiagnosticCallback> &onDiagnostic,
+                  bool patchInParallel = false);
+
+/// @brief Call the parameter binder on a module in memory. The module is
+/// neither copied nor written to disk and the payload is handed out in an
+/// owned buffer.
+/// @param target name of the target to employ
+/// @param configPath path of the target configuration
+/// @param moduleInput the module, which must remain valid during the call
+/// @param arguments bindings for the parameters in the module to apply
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param payloadOutput receives the payload
+/// @param onDiagnostic an optional callback that will receive emitted
+/// diagnostics
+/// @param patchInParallel patch the binaries of the module concurrently
+/// @return 0 on success
+int bindArgumentsInMemory(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::unordered_map<std::string, double> const &arguments,
+    bool treatWarningsAsErrors,
+    std::unique_ptr<llvm::MemoryBuffer> *payloadOutput,
+    const std::optional<DiagnosticCallback> &onDiagnostic,
+    bool patchInParallel = false);
+
+/// @brief Call the parameter binder for a batch of argument sets, binding each
+/// set to its own copy of the same module. The module and its signature are
+/// only loaded once for the batch and the argument sets are bound in parallel.
+/// @param target name of the target to employ
+/// @param configPath path of the target configuration
+/// @param moduleInput path of the module or the module itself if
+/// enableInMemoryInput
+/// @param argumentSets bindings for the parameters in the module to apply, one
+/// payload is generated for each
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param enableInMemoryInput whether moduleInput is the module itself
+/// @param outputs an optional vector receiving the payload of each argument
+/// set
+/// @param statuses an optional vector receiving the status of each argument
+/// set, 0 on success
+/// @param onDiagnostic an optional callback that will receive emitted
+/// diagnostics of all argument sets
+/// @param onResult an optional callback that will receive the index, status
+/// and payload of each argument set as soon as it is bound, concurrently from
+/// the binding threads. It may take the payload, which is then left empty in
+/// outputs
+/// @return 0 if all argument sets were bound successfully
+int bindArgumentsBatch(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *outputs, std::vector<int> *statuses,
+    const std::optional<DiagnosticCallback> &onDiagnostic,
+    const std::optional<
+        std::function<void(size_t index, int status, std::string &payload)>>
+        &onResult = std::nullopt);
+
+/// @brief Call the parameter binder for a batch of argument sets, writing
+/// the parameter table of the module with one row per argument set rather
+/// than patching its binaries, for modules whose target emits their
+/// parametric values into a parameter table.
+/// @param target name of the target to employ
+/// @param configPath path of the target configuration
+/// @param moduleInput path of the module or the module itself if
+/// enableInMemoryInput
+/// @param argumentSets bindings for the parameters in the module to apply,
+/// one row of the table is written for each
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param enableInMemoryInput whether moduleInput is the module itself
+/// @param table receives the parameter table
+/// @param onDiagnostic an optional callback that will receive emitted
+/// diagnostics
+/// @return 0 on success
+int bindParameterTable(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput, std::string *table,
+    const std::optional<DiagnosticCallback> &onDiagnostic);
+
+/// @brief The result of an asynchronous compilation or binding.
+struct AsyncResult {
+  /// @brief 0 on success
+  int status = 1;
+  /// @brief The compilation result, or the payload of a binding
+  std::string output;
+  /// @brief Whether the job failed as it was cancelled or exceeded its
+  /// deadline
+  bool cancelled = false;
+};
+
+/// @brief Handle of an asynchronous compilation or binding running on a
+/// thread of its own. The job may be cancelled cooperatively: it checks for
+/// cancellation and its deadline between the stages of the compilation, the
+/// passes of its pass managers and the targets of its target system, and
+/// fails as soon as it notices, releasing its threads. Destroying the handle
+/// of a job which has not completed cancels it and waits for it to stop.
+class AsyncHandle {
+public:
+  AsyncHandle(std::future<AsyncResult> result,
+              std::shared_ptr<hal::compile::CompileCancellation> cancellation);
+  AsyncHandle(AsyncHandle &&) noexcept;
+  AsyncHandle &operator=(AsyncHandle &&) noexcept;
+  ~AsyncHandle();
+
+  /// @brief Request the job to stop as soon as possible.
+  void cancel();
+
+  /// @brief Wait for the job to complete for at most timeout.
+  /// @return true if the result is ready
+  bool waitFor(std::chrono::milliseconds timeout) const;
+
+  /// @brief Wait for the job to complete and take its result. May only be
+  /// called once.
+  AsyncResult get();
+
+private:
+  std::future<AsyncResult> result;
+  std::shared_ptr<hal::compile::CompileCancellation> cancellation;
+};
+
+/// @brief Call the qss-compiler with a configuration as with
+/// compile(const config::QSSConfig &, ...) without blocking.
+/// @param config the configuration of the compilation
+/// @param deadline an optional point in time after which the compilation is
+/// cancelled
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics, called from the thread of the compilation
+/// @return the handle of the compilation, whose result receives the
+/// compilation result
+AsyncHandle
+compileAsync(config::QSSConfig config,
+             std::optional<std::chrono::steady_clock::time_point> deadline,
+             std::optional<DiagnosticCallback> diagnosticCb);
+
+/// @brief Call the parameter binder on a module in memory as with
+/// bindArgumentsInMemory without blocking. The binding is cancelled before
+/// the module is patched.
+/// @param target name of the target to employ
+/// @param configPath path of the target configuration
+/// @param moduleInput the module
+/// @param arguments bindings for the parameters in the module to apply
+/// @param treatWarningsAsErrors return errors in place of warnings
+/// @param deadline an optional point in time after which the binding is
+/// cancelled
+/// @param onDiagnostic an optional callback that will receive emitted
+/// diagnostics, called from the thread of the binding
+/// @return the handle of the binding, whose result receives the payload
+AsyncHandle bindArgumentsAsync(
+    std::string target, std::string configPath, std::string moduleInput,
+    std::unordered_map<std::string, double> arguments,
+    bool treatWarningsAsErrors,
+    std::optional<std::chrono::steady_clock::time_point> deadline,
+    std::optional<DiagnosticCallback> onDiagnostic);
+
+/// @brief The formats of exportMetrics.
+enum class MetricsFormat {
+  /// @brief The Prometheus text exposition format
+  Prometheus,
+  /// @brief The OpenMetrics text format
+  OpenMetrics,
+  /// @brief JSON as accepted by mergeMetrics
+  JSON
+};
+
+/// @brief Export the metrics of the compilations and bindings of this
+/// process, which are:
+///  - qssc_compilations_total{status}: the compiled programs by status,
+///    success, failure or cancelled
+///  - qssc_compile_duration_seconds: the latency of compiling a program
+///  - qssc_compile_stage_duration_seconds{stage}: the latency of the
+///    frontend, passes and emit stages of a program
+///  - qssc_target_stage_duration_seconds{target,stage}: the latency of the
+///    passes and emit stages of each target
+///  - qssc_compile_cache_lookups_total{result}: the compile cache lookups by
+///    result, memory-hit, disk-hit or miss
+///  - qssc_target_payload_reuses_total{target,result}: the lookups of the
+///    previously emitted payload of a target, hit or miss
+///  - qssc_payload_size_bytes{emit}: the size of the payloads written
+///  - qssc_bind_arguments_total{target,status} and
+///    qssc_bind_arguments_duration_seconds{target}: the calls binding
+///    arguments and their latency
+/// Compile cache hits are not counted as compilations.
+/// @param format the format of the metrics
+/// @param reset whether to remove the exported metrics at once, e.g., to
+/// merge the metrics of a compile process into another process
+/// @return the metrics
+std::string exportMetrics(MetricsFormat format = MetricsFormat::Prometheus,
+                          bool reset = false);
+
+/// @brief Add metrics exported as JSON by another process to the metrics of
+/// this process.
+/// @param json the metrics as exported by exportMetrics
+/// @return 0 on success
+int mergeMetrics(std::string_view json);
+
+/// @brief The features of a program which its compile cost is estimated from.
+struct CompileCostFeatures {
+  /// @brief The operations of the program after the frontend
+  uint64_t numOperations = 0;
+  /// @brief The qubits declared by the program
+  uint64_t numQubits = 0;
+  /// @brief The circuits of the program
+  uint64_t numCircuits = 0;
+  /// @brief The targets below the target system, each of which runs its
+  /// passes on and emits a module of its own
+  uint64_t numTargets = 0;
+};
+
+/// @brief The estimated cost of compiling a program.
+struct CompileCostEstimate {
+  CompileCostFeatures features;
+  /// @brief The estimated wall time of the compilation
+  double seconds = 0.;
+  /// @brief The estimated peak memory of the compilation
+  uint64_t peakMemoryBytes = 0;
+
+  /// @brief Whether the compilation fits a budget, e.g., to admit it to a
+  /// host only while the host has the memory it needs.
+  /// @param maxSeconds the longest compilation admitted, 0 for no limit
+  /// @param maxPeakMemoryBytes the most memory a compilation may use, 0 for
+  /// no limit
+  bool fits(double maxSeconds, uint64_t maxPeakMemoryBytes) const {
+    return (maxSeconds <= 0. || seconds <= maxSeconds) &&
+           (maxPeakMemoryBytes == 0 || peakMemoryBytes <= maxPeakMemoryBytes);
+  }
+};
+
+/// @brief The linear model of the compile cost of a program. Each target
+/// runs its passes over the operations of the program, so the cost of the
+/// target tree grows with the product of the operations and the targets. The
+/// defaults are conservative for the mock target on a single thread and are
+/// meant to be refit per target and host class from the CostModel
+/// benchmarks of qssc-bench, which report the measured and estimated cost
+/// of the same programs side by side.
+struct CompileCostModel {
+  /// @brief The cost of a compilation of an empty program, building the
+  /// target and the pass managers
+  double baseSeconds = 0.05;
+  double secondsPerOperation = 2e-5;
+  double secondsPerQubit = 1e-4;
+  double secondsPerCircuit = 1e-4;
+  double secondsPerTargetOperation = 1e-5;
+  uint64_t baseBytes = 64ull << 20;
+  uint64_t bytesPerOperation = 2048;
+  uint64_t bytesPerQubit = 16ull << 10;
+  uint64_t bytesPerCircuit = 4096;
+  uint64_t bytesPerTargetOperation = 1024;
+
+  /// @brief Estimate the cost of compiling a program with features.
+  CompileCostEstimate estimate(const CompileCostFeatures &features) const;
+};
+
+/// @brief Estimate the cost of a compilation without running it, e.g., to
+/// admit it to a host with the time and memory it needs. The program is only
+/// parsed and the target is only built, both of which are cheap compared to
+/// the passes of the compilation. The command line is that of the
+/// compilation, whose emit action and output are ignored.
+/// @param argc the number of argument strings
+/// @param argv array of argument strings
+/// @param estimate receives the estimated cost
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @param model the model to estimate the cost with
+/// @return 0 on success
+int estimateCompileCost(int argc, char const **argv,
+                        CompileCostEstimate *estimate,
+                        std::optional<DiagnosticCallback> diagnosticCb,
+                        const CompileCostModel &model = {});
 
 } // namespace qssc
 #endif // QSS_COMPILER_LIB_H
@@ -29,21 +29,59 @@
 #include "Arguments/Signature.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace qssc::arguments {
 
 using ArgumentType = std::variant<std::optional<double>>;
 using OptDiagnosticCallback = std::optional<qssc::DiagnosticCallback>;
 
+// BatchResultCallback - receives an argument set of a batch as soon as it is
+// bound, from the thread which bound it, with its index, its status, 0 on
+// success, and its payload, which it may take. Calls are concurrent.
+using BatchResultCallback =
+    std::function<void(size_t index, int status, std::string &payload)>;
+
+class ParameterExpressionCache;
+
 class ArgumentSource {
 public:
   virtual ArgumentType getArgumentValue(llvm::StringRef name) const = 0;
 
+  // get the values of the named parameters at once, values[i] being the
+  // value of names[i]. Sources which hold their arguments indexed, e.g., as
+  // the parameters of a PreparedSignature, override this to avoid a lookup
+  // by name per parameter.
+  virtual void
+  getArgumentValues(llvm::ArrayRef<std::string> names,
+                    llvm::MutableArrayRef<ArgumentType> values) const {
+    for (size_t i = 0; i < names.size(); ++i)
+      values[i] = getArgumentValue(names[i]);
+  }
+
   virtual ~ArgumentSource() = default;
 };
 
+// Patcher - patch a value into a binary at the offset of a patch point, for
+// a patch type of a target
+using Patcher = llvm::Error (*)(llvm::MutableArrayRef<char> binary,
+                                uint64_t offset, ArgumentType const &value);
+
 // BindArgumentsImplementation - abstract class to be subclassed by targets to
 // define and implement methods for binding arguments to compiled payloads
 class BindArgumentsImplementation {
@@ -77,16 +115,182 @@ public:
   create(std::vector<char> &buf, OptDiagnosticCallback onDiagnostic) = 0;
   virtual BindArgumentsImplementation *
   create(std::string &str, OptDiagnosticCallback onDiagnostic) = 0;
+  // Factories of implementations which patch binaries through a view of the
+  // payload member, i.e., in place, override both of the following.
+  virtual bool supportsInPlacePatching() const { return false; }
+  virtual BindArgumentsImplementation *
+  create(llvm::MutableArrayRef<char> buf, OptDiagnosticCallback onDiagnostic) {
+    return nullptr;
+  }
+  // Get the patcher of a patch type, if the target patches points of the
+  // type without state of a BindArgumentsImplementation. Signatures of which
+  // all patch types have patchers are bound through a PreparedSignature.
+  virtual Patcher getPatcher(llvm::StringRef patchType) const {
+    return nullptr;
+  }
+};
+
+// PreparedSignature - a signature with the expressions of its patch points
+// resolved to the indices of its parameters and its patch types resolved to
+// the patchers of a factory once, so that binding looks up the value of each
+// parameter once and patches each binary in a loop over flat arrays of
+// offsets, parameter indices and patchers rather than dispatching on the
+// strings of every patch point.
+class PreparedSignature {
+public:
+  // fails if the factory has no patcher for a patch type of the signature
+  static llvm::Expected<PreparedSignature>
+  prepare(const Signature &sig,
+          const BindArgumentsImplementationFactory &factory);
+
+  // the distinct parameters of the patch points, in order of appearance
+  llvm::ArrayRef<std::string> getParameters() const { return parameters_; }
+
+  size_t getNumBinaries() const { return binaries_.size(); }
+  llvm::StringRef getBinaryName(size_t binary) const {
+    return binaries_[binary].name;
+  }
+
+  // get the values of the parameters from arguments, indexed as
+  // getParameters
+  std::vector<ArgumentType> getValues(ArgumentSource const &arguments) const;
+
+  // patch the patch points of a binary with the values of getValues
+  llvm::Error apply(size_t binary, llvm::MutableArrayRef<char> contents,
+                    llvm::ArrayRef<ArgumentType> values) const;
+
+private:
+  struct Binary {
+    std::string name;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> parameters;
+    std::vector<Patcher> patchers;
+  };
+
+  std::vector<std::string> parameters_;
+  std::vector<Binary> binaries_;
+};
+
+// DeltaBinder - bind argument sets one after another to a resident copy of
+// the binaries of a payload, e.g., the points of a parameter sweep. The patch
+// points of each parameter across the binaries are indexed once from the
+// signature and each bind only patches the points of the parameters whose
+// values changed since the previous bind, so that its cost is in the number
+// of changed patch points. Patching a point must overwrite all bytes the
+// point depends on. The payload, signature and factory must outlive the
+// binder, which may be copied, e.g., to bind in parallel, but not shared
+// between threads.
+class DeltaBinder {
+public:
+  // read the binaries of the payload which have patch points
+  static llvm::Expected<DeltaBinder>
+  create(qssc::payload::PatchablePayload &payload, const Signature &sig,
+         bool treatWarningsAsErrors,
+         BindArgumentsImplementationFactory &factory,
+         const OptDiagnosticCallback &onDiagnostic);
+
+  // patch the parameters of arguments which changed since the previous bind
+  // and write the payload with the patched binaries to output, the patch
+  // points of expressions over parameters when their value changed. The bind
+  // after a failed bind patches all parameters.
+  llvm::Error bind(ArgumentSource const &arguments, std::string *output);
+
+  // number of patch points patched by the last bind
+  size_t getNumPatched() const { return numPatched_; }
+
+private:
+  DeltaBinder(qssc::payload::PatchablePayload &payload,
+              bool treatWarningsAsErrors,
+              BindArgumentsImplementationFactory &factory,
+              const OptDiagnosticCallback &onDiagnostic)
+      : payload_(&payload), factory_(&factory),
+        treatWarningsAsErrors_(treatWarningsAsErrors),
+        onDiagnostic_(onDiagnostic) {}
+
+  qssc::payload::PatchablePayload *payload_;
+  BindArgumentsImplementationFactory *factory_;
+  bool treatWarningsAsErrors_;
+  OptDiagnosticCallback onDiagnostic_;
+
+  std::map<std::string, qssc::payload::PatchablePayload::ContentBuffer>
+      binaries_;
+  // the name and patch points of each binary with patch points
+  std::vector<std::pair<std::string, const PatchPointVector *>>
+      binaryPatchPoints_;
+  // the binary and patch point indices of the patch points of each parameter
+  llvm::StringMap<std::vector<std::pair<size_t, size_t>>>
+      patchPointsByParameter_;
+  llvm::StringMap<ArgumentType> lastValues_;
+  size_t numPatched_ = 0;
+  // the parsed expressions of the patch points, shared by the copies of the
+  // binder
+  std::shared_ptr<ParameterExpressionCache> expressions_;
 };
 
 // TODO generalize type of arguments
+// With patchInParallel, the binaries of the payload are patched concurrently,
+// which requires BindArgumentsImplementationFactory::create and the patching
+// of distinct binaries to be thread-safe.
 llvm::Error bindArguments(llvm::StringRef moduleInput,
                           llvm::StringRef payloadOutputPath,
                           ArgumentSource const &arguments,
                           bool treatWarningsAsErrors, bool enableInMemoryInput,
                           std::string *inMemoryOutput,
                           BindArgumentsImplementationFactory &factory,
-                          const OptDiagnosticCallback &onDiagnostic);
+                          const OptDiagnosticCallback &onDiagnostic,
+                          bool patchInParallel = false);
+
+// bindArgumentsInMemory - bind the arguments to a payload in memory, handing
+// out the patched payload as a buffer without intermediate copies.
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+bindArgumentsInMemory(llvm::MemoryBufferRef moduleInput,
+                      ArgumentSource const &arguments,
+                      bool treatWarningsAsErrors,
+                      BindArgumentsImplementationFactory &factory,
+                      const OptDiagnosticCallback &onDiagnostic,
+                      bool patchInParallel = false);
+
+// bindArgumentsBatch - bind each of the argument sets to its own copy of the
+// payload. The payload is opened and its signature parsed once and the
+// binaries to patch are kept in memory while contiguous chunks of the
+// argument sets are bound in parallel, each chunk by a DeltaBinder, so that
+// neighbouring argument sets of a sweep only patch the parameters which
+// differ. BindArgumentsImplementationFactory::create and the patching of
+// distinct binaries must be thread-safe. statuses receives 0 for each argument
+// set bound successfully and the returned error joins the errors of all
+// argument sets. If given, onResult is called with each argument set as it is
+// bound, before the batch completes.
+llvm::Error bindArgumentsBatch(
+    llvm::StringRef moduleInput,
+    llvm::ArrayRef<const ArgumentSource *> argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> &outputs, std::vector<int> &statuses,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic,
+    const std::optional<BatchResultCallback> &onResult = std::nullopt);
+
+// parameterTableMember - the payload member of the parameter table of a
+// program. Targets may emit the parametric values of a program into this
+// member, rather than into its instrument binaries, as a single row holding
+// the default values at the offsets of patch points for this member in the
+// signature. The row layout, i.e., the size of the member and the offsets
+// and patch types of its patch points, is fixed by the target.
+inline constexpr llvm::StringLiteral parameterTableMember = "parameters.tbl";
+
+// bindParameterTable - bind the argument sets to the parameter table of a
+// payload without touching its instrument binaries, writing one row of the
+// table per argument set to table, e.g., a single row for a single argument
+// set or a table of all points of a sweep for batched execution. The
+// signature of the payload must only have patch points in its parameter
+// table member. Rows are patched in parallel, through the patchers of the
+// target where it has them for all patch types of the table.
+llvm::Error
+bindParameterTable(llvm::StringRef moduleInput,
+                   llvm::ArrayRef<const ArgumentSource *> argumentSets,
+                   bool treatWarningsAsErrors, bool enableInMemoryInput,
+                   std::string &table,
+                   BindArgumentsImplementationFactory &factory,
+                   const OptDiagnosticCallback &onDiagnostic);
 
 } // namespace qssc::arguments
 
@@ -0,0 +1,135 @@
+//===- ParameterExpression.h - Expressions over parameters ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the expressions over parameters which the compiler
+///  derives values from, e.g., the angle of a gate computed from parameters,
+///  and which are evaluated once when arguments are bound rather than at
+///  runtime.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ARGUMENTS_PARAMETER_EXPRESSION_H
+#define ARGUMENTS_PARAMETER_EXPRESSION_H
+
+#include "Arguments/Arguments.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace qssc::arguments {
+
+// ParameterExpression - an arithmetic expression over parameters, written in
+// prefix form as the expression of a patch point in place of a parameter
+// name:
+//
+//   expr := number | parameter | '(' op expr... ')'
+//   op   := add | sub | mul | div | neg | angle
+//
+// e.g., (angle (add (div theta 2) 3.141592653589793)). angle wraps its
+// operand to [0, 2*pi), as the angle operations of the compiler do, the other
+// operations are those of doubles.
+class ParameterExpression {
+public:
+  // whether text is an expression rather than the name of a parameter
+  static bool isExpression(llvm::StringRef text) {
+    return text.startswith("(");
+  }
+
+  static llvm::Expected<ParameterExpression> parse(llvm::StringRef text);
+
+  // the parameters of the expression, in order of first use
+  llvm::ArrayRef<std::string> getParameters() const { return parameters; }
+
+  // evaluate the expression given the values of its parameters, values[i]
+  // being the value of getParameters()[i]. std::nullopt if a parameter has
+  // no value.
+  std::optional<double>
+  evaluate(llvm::ArrayRef<std::optional<double>> values) const;
+
+  // evaluate the expression over the values of its parameters in arguments
+  ArgumentType evaluate(ArgumentSource const &arguments) const;
+
+  // wrap an angle to [0, 2*pi)
+  static double wrapAngle(double value);
+
+private:
+  enum class Kind : uint8_t {
+    Constant,
+    Parameter,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Neg,
+    Angle
+  };
+  struct Step {
+    Kind kind;
+    double constant = 0.0;
+    uint32_t parameter = 0;
+  };
+
+  // the expression in postfix order
+  std::vector<Step> steps;
+  std::vector<std::string> parameters;
+  size_t maxDepth = 0;
+
+  friend class ExpressionParser;
+};
+
+// ParameterExpressionCache - the parsed expressions of the patch points of a
+// binding, shared by the argument sets of a batch. Thread-safe.
+class ParameterExpressionCache {
+public:
+  // get the parsed expression of text, nullptr if text is not an expression
+  // or is malformed
+  const ParameterExpression *get(llvm::StringRef text);
+
+private:
+  std::mutex mutex;
+  llvm::StringMap<std::optional<ParameterExpression>> expressions;
+};
+
+// ExpressionArgumentSource - the arguments of source, along with the values
+// of the parameter expressions over them. Expressions which are malformed or
+// have a parameter without argument have no value, as missing arguments.
+class ExpressionArgumentSource : public ArgumentSource {
+public:
+  ExpressionArgumentSource(ArgumentSource const &source,
+                           ParameterExpressionCache &cache)
+      : source(source), cache(cache) {}
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override;
+  void
+  getArgumentValues(llvm::ArrayRef<std::string> names,
+                    llvm::MutableArrayRef<ArgumentType> values) const override;
+
+private:
+  ArgumentSource const &source;
+  ParameterExpressionCache &cache;
+};
+
+} // namespace qssc::arguments
+
+#endif // ARGUMENTS_PARAMETER_EXPRESSION_H
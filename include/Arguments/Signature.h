@@ -28,8 +28,12 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -71,6 +75,9 @@ public:
   void dump();
 
   std::string serialize();
+  // serialize in the binary format that may be read in place by SignatureView,
+  // see SignatureWriter
+  std::string serializeBinary();
 
   static llvm::Expected<Signature>
   deserialize(llvm::StringRef,
@@ -80,6 +87,135 @@ public:
   bool isEmpty() { return patchPointsByBinary.size() == 0; }
 };
 
+// SignatureWriter - builds a signature in the binary format read by
+// SignatureView as the patch points of each binary are added, e.g., while a
+// target emits the binaries of a large parametric program, rather than
+// collecting a Signature first. Patch points are kept as their 16 byte binary
+// records and each distinct string once, so that the memory held during
+// emission is that of the serialized signature.
+class SignatureWriter {
+public:
+  // start adding the patch points of a binary, ending those of the previous
+  // one. The patch points of a binary must be added together.
+  llvm::Error beginBinary(llvm::StringRef name);
+  // add a patch point to the binary begun last
+  void addPatchPoint(llvm::StringRef expression, llvm::StringRef patchType,
+                     uint64_t offset);
+
+  size_t numBinaries() const { return binaries_.size(); }
+  size_t numPatchPoints() const { return patchPoints_.size(); }
+
+  // write the signature, e.g., to the stream of a payload file
+  void write(llvm::raw_ostream &os) const;
+  std::string serialize() const;
+
+private:
+  uint32_t intern(llvm::StringRef str);
+
+  // the layout of the records, see SignatureView
+  struct PatchPointRecord {
+    uint64_t offset;
+    uint32_t expression;
+    uint32_t patchType;
+  };
+  struct BinaryRecord {
+    uint32_t name;
+    uint32_t firstPatchPoint;
+    uint32_t numPatchPoints;
+  };
+
+  llvm::StringMap<uint32_t> stringIndices_;
+  // the keys of stringIndices_ by index
+  std::vector<llvm::StringRef> strings_;
+  uint64_t stringDataSize_ = 0;
+  std::vector<PatchPointRecord> patchPoints_;
+  std::vector<BinaryRecord> binaries_;
+};
+
+// SignatureView - read-only view of a signature in the compact binary format
+// written by Signature::serializeBinary. Expression and patch type strings are
+// interned and the patch points of each binary are stored as a contiguous
+// array, so that a memory mapped signature can be iterated without parsing or
+// allocating.
+//
+// All integers are little endian. The buffer contains a header, followed by
+// the arrays of patch points, binaries and strings, followed by the string
+// data:
+//   header:      magic[8] version:u32 numStrings:u32 numBinaries:u32
+//                numPatchPoints:u32 stringDataSize:u64
+//   patch point: offset:u64 expression:u32 patchType:u32
+//   binary:      name:u32 firstPatchPoint:u32 numPatchPoints:u32
+//   string:      offset:u32 size:u32
+class SignatureView {
+public:
+  class BinaryRef;
+
+  class PatchPointRef {
+  public:
+    llvm::StringRef expression() const;
+    llvm::StringRef patchType() const;
+    uint64_t offset() const;
+
+  private:
+    PatchPointRef(const SignatureView &view, size_t index)
+        : view_(view), index_(index) {}
+    friend class SignatureView;
+    friend class BinaryRef;
+
+    const SignatureView &view_;
+    size_t index_;
+  };
+
+  class BinaryRef {
+  public:
+    llvm::StringRef name() const;
+    size_t size() const;
+    PatchPointRef operator[](size_t index) const;
+
+  private:
+    BinaryRef(const SignatureView &view, size_t index)
+        : view_(view), index_(index) {}
+    friend class SignatureView;
+
+    const SignatureView &view_;
+    size_t index_;
+  };
+
+  // whether the buffer starts with the binary signature magic
+  static bool isBinarySignature(llvm::StringRef buffer);
+
+  // validate the buffer and create a view on it. The buffer must outlive the
+  // view.
+  static llvm::Expected<SignatureView>
+  create(llvm::StringRef buffer,
+         const std::optional<qssc::DiagnosticCallback> &onDiagnostic);
+
+  size_t numBinaries() const { return numBinaries_; }
+  BinaryRef binary(size_t index) const { return {*this, index}; }
+  // size of the serialized signature, which may be less than the buffer
+  size_t serializedSize() const { return serializedSize_; }
+
+  // copy into an owning Signature
+  Signature toSignature() const;
+
+private:
+  SignatureView() = default;
+
+  uint32_t read32(size_t pos) const;
+  uint64_t read64(size_t pos) const;
+  llvm::StringRef string(uint32_t index) const;
+
+  llvm::StringRef buffer_;
+  uint32_t numStrings_ = 0;
+  uint32_t numBinaries_ = 0;
+  uint32_t numPatchPoints_ = 0;
+  size_t patchPointsPos_ = 0;
+  size_t binariesPos_ = 0;
+  size_t stringsPos_ = 0;
+  size_t stringDataPos_ = 0;
+  size_t serializedSize_ = 0;
+};
+
 } // namespace qssc::arguments
 
 #endif // PARAMETER_SIGNATURE_H
@@ -40,6 +40,10 @@ class CLIConfigBuilder : public QSSConfigBuilder {
 public:
   explicit CLIConfigBuilder();
   static void registerCLOptions(mlir::DialectRegistry &registry);
+  /// @brief Reset all previously parsed CLI options to their defaults so that
+  /// the command line may be parsed again within the same process, e.g., for
+  /// each job of a long-lived compile server.
+  static void resetCLOptions();
   llvm::Error populateConfig(QSSConfig &config) override;
 };
 
@@ -29,6 +29,8 @@ namespace qssc::config {
 /// These currently are:
 /// - `QSSC_TARGET_NAME`: Sets QSSConfig::targetName.
 /// - `QSSC_TARGET_CONFIG_PATH`: Sets QSSConfig::targetConfigPath.
+/// - `QSSC_COMPILE_CACHE_DIR`: Sets QSSConfig::compileCacheDir.
+/// - `QSSC_CHECKPOINT_DIR`: Sets QSSConfig::checkpointDir.
 ///
 class EnvVarConfigBuilder : public QSSConfigBuilder {
 public:
@@ -38,6 +40,7 @@ private:
   llvm::Error populateConfigurationPath_(QSSConfig &config);
   llvm::Error populateTarget_(QSSConfig &config);
   llvm::Error populateVerbosity_(QSSConfig &config);
+  llvm::Error populateCompileCache_(QSSConfig &config);
 };
 
 } // namespace qssc::config
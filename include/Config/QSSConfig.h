@@ -15,6 +15,7 @@
 #define QSSC_QSSCONFIG_H
 
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "mlir/IR/MLIRContext.h"
@@ -24,6 +25,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace qssc::config {
 
@@ -35,7 +37,16 @@ enum QSSVerbosity {
   _VerbosityCnt = 4
 };
 
-enum class EmitAction { None, AST, ASTPretty, MLIR, WaveMem, QEM, QEQEM };
+enum class EmitAction {
+  None,
+  AST,
+  ASTPretty,
+  MLIR,
+  MLIRBytecode,
+  WaveMem,
+  QEM,
+  QEQEM
+};
 
 enum class FileExtension {
   None,
@@ -43,6 +54,7 @@ enum class FileExtension {
   ASTPretty,
   QASM,
   MLIR,
+  MLIRBytecode,
   WaveMem,
   QEM,
   QEQEM
@@ -50,12 +62,47 @@ enum class FileExtension {
 
 enum class InputType { None, QASM, MLIR };
 
+enum class PayloadCompression { Store, Deflate, Zstd };
+
+/// @brief Form of the debug artifacts of a payload, e.g., the IR dumps of the
+/// targets, which the instruments do not execute
+enum class PayloadDebugArtifacts { Text, Bytecode, None };
+
+/// @brief Format of the report of the metrics of each pass
+enum class PassMetricsFormat { Table, JSON };
+
+/// @brief Stages of a compilation after which a checkpoint of the module may
+/// be kept, i.e., after the frontend and after the command line passes
+enum class CheckpointStage { Frontend, Passes };
+
+/// @brief When a compilation verifies the module, i.e., after every pass or
+/// only at the boundaries of its stages: after the frontend, after the
+/// command line passes and after the passes of each target before it emits
+enum class VerificationMode { Passes, Boundaries };
+
+/// @brief Locations of the operations generated from OpenQASM 3, i.e., the
+/// line and column of their statement, only its line, which the operations
+/// of a line share, or no locations once the frontend has succeeded
+enum class QASMLocations { Full, Lines, None };
+
 std::string to_string(const EmitAction &inExt);
 
 std::string to_string(const FileExtension &inExt);
 
 std::string to_string(const InputType &inType);
 
+std::string to_string(const PayloadCompression &inCompression);
+
+std::string to_string(const PayloadDebugArtifacts &inDebugArtifacts);
+
+std::string to_string(const PassMetricsFormat &inFormat);
+
+std::string to_string(const CheckpointStage &inStage);
+
+std::string to_string(const VerificationMode &inMode);
+
+std::string to_string(const QASMLocations &inLocations);
+
 InputType fileExtensionToInputType(const FileExtension &inExt);
 
 EmitAction fileExtensionToAction(const FileExtension &inExt);
@@ -80,9 +127,22 @@ public:
 
   QSSConfig &setInputSource(std::string source) {
     inputSource = std::move(source);
+    inputBuffer.reset();
+    return *this;
+  }
+  /// @brief Set the input program to compile directly from buffer, which is
+  /// not copied. The caller keeps buffer alive while it is compiled. As for
+  /// llvm::MemoryBuffer, buffer must be null-terminated, i.e.,
+  /// buffer.data()[buffer.size()] == 0, which the MLIR parser relies on.
+  QSSConfig &setInputBuffer(llvm::StringRef buffer) {
+    inputBuffer = buffer;
+    directInputFlag = true;
     return *this;
   }
-  llvm::StringRef getInputSource() const { return inputSource; }
+  llvm::StringRef getInputSource() const {
+    return inputBuffer.has_value() ? *inputBuffer
+                                   : llvm::StringRef(inputSource);
+  }
 
   QSSConfig &directInput(bool flag) {
     directInputFlag = flag;
@@ -184,6 +244,241 @@ public:
     return bypassPayloadTargetCompilationFlag;
   }
 
+  QSSConfig &streamPayload(bool flag) {
+    streamPayloadFlag = flag;
+    return *this;
+  }
+  bool shouldStreamPayload() const { return streamPayloadFlag; }
+
+  QSSConfig &splitPayload(bool flag) {
+    splitPayloadFlag = flag;
+    return *this;
+  }
+  bool shouldSplitPayload() const { return splitPayloadFlag; }
+
+  QSSConfig &setPayloadCompression(PayloadCompression compression) {
+    payloadCompression = compression;
+    return *this;
+  }
+  PayloadCompression getPayloadCompression() const {
+    return payloadCompression;
+  }
+
+  QSSConfig &setPayloadCompressionLevel(int level) {
+    payloadCompressionLevel = level;
+    return *this;
+  }
+  int getPayloadCompressionLevel() const { return payloadCompressionLevel; }
+
+  QSSConfig &setPayloadDebugArtifacts(PayloadDebugArtifacts debugArtifacts) {
+    payloadDebugArtifacts = debugArtifacts;
+    return *this;
+  }
+  PayloadDebugArtifacts getPayloadDebugArtifacts() const {
+    return payloadDebugArtifacts;
+  }
+
+  QSSConfig &setPayloadBlobStore(std::string dir) {
+    payloadBlobStore = std::move(dir);
+    return *this;
+  }
+  std::optional<llvm::StringRef> getPayloadBlobStore() const {
+    if (payloadBlobStore.has_value())
+      return payloadBlobStore.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &useCompileCache(bool flag) {
+    compileCacheFlag = flag;
+    return *this;
+  }
+  bool shouldUseCompileCache() const {
+    return compileCacheFlag || parametricTemplatesFlag ||
+           compileCacheDir.has_value();
+  }
+
+  QSSConfig &useParametricTemplates(bool flag) {
+    parametricTemplatesFlag = flag;
+    return *this;
+  }
+  bool shouldUseParametricTemplates() const { return parametricTemplatesFlag; }
+
+  QSSConfig &setCompileCacheDir(std::string dir) {
+    compileCacheDir = std::move(dir);
+    return *this;
+  }
+  std::optional<llvm::StringRef> getCompileCacheDir() const {
+    if (compileCacheDir.has_value())
+      return compileCacheDir.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setPassMetricsReport(std::string path) {
+    passMetricsReport = std::move(path);
+    return *this;
+  }
+  std::optional<llvm::StringRef> getPassMetricsReport() const {
+    if (passMetricsReport.has_value())
+      return passMetricsReport.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setPassMetricsFormat(PassMetricsFormat format) {
+    passMetricsFormat = format;
+    return *this;
+  }
+  PassMetricsFormat getPassMetricsFormat() const { return passMetricsFormat; }
+
+  QSSConfig &checkpoint(CheckpointStage stage, bool flag) {
+    unsigned const bit = 1u << static_cast<unsigned>(stage);
+    if (flag)
+      checkpointStages |= bit;
+    else
+      checkpointStages &= ~bit;
+    return *this;
+  }
+  bool shouldCheckpoint(CheckpointStage stage) const {
+    return checkpointStages & (1u << static_cast<unsigned>(stage));
+  }
+  bool shouldCheckpoint() const { return checkpointStages != 0; }
+
+  QSSConfig &setCheckpointDir(std::string dir) {
+    checkpointDir = std::move(dir);
+    return *this;
+  }
+  std::optional<llvm::StringRef> getCheckpointDir() const {
+    if (checkpointDir.has_value())
+      return checkpointDir.value();
+    return std::nullopt;
+  }
+
+  QSSConfig &setVerificationMode(VerificationMode mode) {
+    verificationMode = mode;
+    return *this;
+  }
+  VerificationMode getVerificationMode() const { return verificationMode; }
+  /// @brief Should the pass managers verify the module after every pass
+  bool shouldVerifyEachPass() const {
+    return shouldVerifyPasses() &&
+           verificationMode == VerificationMode::Passes;
+  }
+  /// @brief Should the module only be verified at the stage boundaries
+  bool shouldVerifyBoundaries() const {
+    return verificationMode == VerificationMode::Boundaries;
+  }
+
+  QSSConfig &setNumShots(unsigned shots) {
+    numShots = shots;
+    return *this;
+  }
+  unsigned getNumShots() const { return numShots; }
+
+  QSSConfig &setShotDelay(std::string delay) {
+    shotDelay = std::move(delay);
+    return *this;
+  }
+  llvm::StringRef getShotDelay() const { return shotDelay; }
+
+  QSSConfig &setIncludeDirs(std::vector<std::string> dirs) {
+    includeDirs = std::move(dirs);
+    return *this;
+  }
+  const std::vector<std::string> &getIncludeDirs() const {
+    return includeDirs;
+  }
+
+  QSSConfig &setGateLibraries(std::vector<std::string> libraries) {
+    gateLibraries = std::move(libraries);
+    return *this;
+  }
+  const std::vector<std::string> &getGateLibraries() const {
+    return gateLibraries;
+  }
+
+  QSSConfig &cacheQASMIncludes(bool flag) {
+    cacheQASMIncludesFlag = flag;
+    return *this;
+  }
+  bool shouldCacheQASMIncludes() const { return cacheQASMIncludesFlag; }
+
+  QSSConfig &streamQASM(bool flag) {
+    streamQASMFlag = flag;
+    return *this;
+  }
+  bool shouldStreamQASM() const { return streamQASMFlag; }
+
+  /// @brief Set the locations of the operations generated from OpenQASM 3.
+  /// Compact locations reduce the memory of large programs at the expense of
+  /// the locations of the diagnostics emitted after the frontend.
+  QSSConfig &setQASMLocations(QASMLocations locations) {
+    qasmLocations = locations;
+    return *this;
+  }
+  QASMLocations getQASMLocations() const { return qasmLocations; }
+
+  /// @brief Set the duration of dt of the target in seconds, e.g., from its
+  /// configuration, to emit the durations of OpenQASM 3 programs in dt
+  /// rather than in the units they are written in.
+  QSSConfig &setQASMDtTimestep(double dt) {
+    qasmDtTimestep = dt;
+    return *this;
+  }
+  std::optional<double> getQASMDtTimestep() const { return qasmDtTimestep; }
+
+  /// @brief Set the textual pass pipeline to run, e.g.,
+  /// "builtin.module(canonicalize,quir-merge-resets)", including the options
+  /// of its passes. This replaces the pipeline setup of the command line, so
+  /// the pipeline is parsed into every pass manager built for the
+  /// configuration without consulting any process-wide option.
+  QSSConfig &setPassPipeline(std::string pipeline);
+  std::optional<llvm::StringRef> getPassPipeline() const {
+    if (passPipeline.has_value())
+      return passPipeline.value();
+    return std::nullopt;
+  }
+
+  /// @brief Set the number of threads of the thread pool of the compilation,
+  /// 0 for one per hardware thread available to it. Without a number of
+  /// threads the passes run on the default thread pool of the MLIRContext.
+  QSSConfig &setNumThreads(unsigned threads) {
+    numThreads = threads;
+    return *this;
+  }
+  std::optional<unsigned> getNumThreads() const { return numThreads; }
+
+  /// @brief Restrict the thread starting the compilation, and the threads it
+  /// starts, such as the threads of its thread pool, to these CPUs.
+  QSSConfig &setCPUAffinity(std::vector<unsigned> cpus) {
+    cpuAffinity = std::move(cpus);
+    return *this;
+  }
+  const std::vector<unsigned> &getCPUAffinity() const { return cpuAffinity; }
+
+  /// @brief Restrict the compilation to the CPUs of a NUMA node, within its
+  /// CPU affinity if any.
+  QSSConfig &setNUMANode(unsigned node) {
+    numaNode = node;
+    return *this;
+  }
+  std::optional<unsigned> getNUMANode() const { return numaNode; }
+
+  /// @brief Run the passes of the compilation on a thread pool owned by the
+  /// caller, e.g., shared by the compilations of a worker, rather than on a
+  /// pool of its own. Takes precedence over the number of threads.
+  /// @param pool The thread pool, which must outlive the compilation.
+  QSSConfig &setThreadPool(llvm::ThreadPool *pool) {
+    threadPool = pool;
+    return *this;
+  }
+  llvm::ThreadPool *getThreadPool() const { return threadPool; }
+
+  /// @brief Derive the input type from the extension of the input source if
+  /// it has not been set.
+  llvm::Error computeInputType();
+  /// @brief Derive the emit action from the extension of the output file if
+  /// it has not been set, defaulting to MLIR.
+  llvm::Error computeOutputType();
+
   QSSConfig &setPassPlugins(std::vector<std::string> plugins) {
     dialectPlugins = std::move(plugins);
     return *this;
@@ -203,6 +498,9 @@ public:
 protected:
   /// @brief input source (file path or direct input) to compile
   std::string inputSource = "-";
+  /// @brief The input program when it is compiled from the buffer of the
+  /// caller instead of inputSource.
+  std::optional<llvm::StringRef> inputBuffer;
   /// @brief Whether inputSource directly contains the input source (otherwise
   /// it is a file path).
   bool directInputFlag = false;
@@ -234,6 +532,68 @@ protected:
   bool compileTargetIRFlag = false;
   /// @brief Should target payload generation be bypassed
   bool bypassPayloadTargetCompilationFlag = false;
+  /// @brief Should payload files be archived while the remaining targets
+  /// compile
+  bool streamPayloadFlag = false;
+  /// @brief Should the payload files of each instrument be grouped, with an
+  /// index of their byte ranges in the payload
+  bool splitPayloadFlag = false;
+  /// @brief Compression of the payload members
+  PayloadCompression payloadCompression = PayloadCompression::Store;
+  /// @brief Codec specific compression level, 0 for the codec default
+  int payloadCompressionLevel = 0;
+  /// @brief Form of the debug artifacts in the payload
+  PayloadDebugArtifacts payloadDebugArtifacts = PayloadDebugArtifacts::Text;
+  /// @brief Directory of the content-addressed store of payload members,
+  /// which payloads refer to rather than archive the members it holds
+  std::optional<std::string> payloadBlobStore = std::nullopt;
+  /// @brief Should compilation results be cached in-memory
+  bool compileCacheFlag = false;
+  /// @brief Directory of the persistent compilation cache, implies caching
+  std::optional<std::string> compileCacheDir = std::nullopt;
+  /// @brief Should payloads of programs only differing in their parameter
+  /// values be reused by binding the parameters
+  bool parametricTemplatesFlag = false;
+  /// @brief File to write the op count, number of symbols and memory use
+  /// before and after each pass to
+  std::optional<std::string> passMetricsReport = std::nullopt;
+  /// @brief Format of the pass metrics report
+  PassMetricsFormat passMetricsFormat = PassMetricsFormat::Table;
+  /// @brief Bits of the stages after which the module is checkpointed, one
+  /// per CheckpointStage
+  unsigned checkpointStages = 0;
+  /// @brief Directory to persist checkpoints to so that retried compilations
+  /// resume from them
+  std::optional<std::string> checkpointDir = std::nullopt;
+  /// @brief When the module is verified
+  VerificationMode verificationMode = VerificationMode::Passes;
+  /// @brief The number of shots to execute the circuit for
+  unsigned numShots = 1000;
+  /// @brief Repetition delay between shots
+  std::string shotDelay = "1ms";
+  /// @brief Include paths of the OpenQASM 3 preprocessor
+  std::vector<std::string> includeDirs;
+  /// @brief Precompiled gate libraries to link gate definitions from
+  std::vector<std::string> gateLibraries;
+  /// @brief Should OpenQASM 3 includes be expanded from the process-wide
+  /// cache of preprocessed include files
+  bool cacheQASMIncludesFlag = false;
+  /// @brief Should OpenQASM 3 be lowered statement by statement
+  bool streamQASMFlag = false;
+  /// @brief Locations of the operations generated from OpenQASM 3
+  QASMLocations qasmLocations = QASMLocations::Full;
+  /// @brief Duration of dt in seconds to emit OpenQASM 3 durations in
+  std::optional<double> qasmDtTimestep = std::nullopt;
+  /// @brief Textual pass pipeline replacing the command line pipeline
+  std::optional<std::string> passPipeline = std::nullopt;
+  /// @brief Number of threads of the thread pool, 0 for the hardware threads
+  std::optional<unsigned> numThreads = std::nullopt;
+  /// @brief CPUs to run the compilation on, any if empty
+  std::vector<unsigned> cpuAffinity;
+  /// @brief NUMA node to run the compilation on
+  std::optional<unsigned> numaNode = std::nullopt;
+  /// @brief Thread pool owned by the caller to run the passes on
+  llvm::ThreadPool *threadPool = nullptr;
   /// @brief Pass plugin paths
   std::vector<std::string> passPlugins;
   /// @brief Dialect plugin paths
@@ -249,6 +609,10 @@ std::ostream &operator<<(std::ostream &os, const QSSConfig &config);
 /// @param config The configuration to move for the context.
 void setContextConfig(mlir::MLIRContext *context, const QSSConfig &config);
 
+/// @brief Release the configuration of a context which is about to be
+/// destroyed.
+void eraseContextConfig(mlir::MLIRContext *context);
+
 /// @brief Get a constant reference to the configuration registered for this
 /// context.
 /// @param context The context to lookup the configuration for.
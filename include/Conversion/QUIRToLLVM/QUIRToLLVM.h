@@ -33,6 +33,7 @@
 #include "mlir/Conversion/LLVMCommon/TypeConverter.h"
 #include "mlir/Conversion/MemRefToLLVM/MemRefToLLVM.h"
 #include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
+#include "mlir/Conversion/VectorToLLVM/ConvertVectorToLLVM.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
@@ -81,6 +82,8 @@ static auto translateModuleToLLVMDialect(mlir::ModuleOp op,
   mlir::cf::populateControlFlowToLLVMConversionPatterns(typeConverter,
                                                         patterns);
   mlir::populateFuncToLLVMConversionPatterns(typeConverter, patterns);
+  // e.g., the angle operations which the mock controller vectorizes
+  mlir::populateVectorToLLVMConversionPatterns(typeConverter, patterns);
 
   if (mlir::applyFullConversion(op, target, std::move(patterns)).failed())
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -21,16 +21,60 @@
 #ifndef LOAD_PULSE_CALS_H
 #define LOAD_PULSE_CALS_H
 
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
 
-#include <unordered_set>
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace mlir::pulse {
 
+/// A gate applied to a list of qubits, identifying its pulse calibration
+/// without building the mangled name of the calibration.
+struct PulseCalKey {
+  mlir::StringAttr gateName;
+  llvm::ArrayRef<uint32_t> qubits;
+};
+
+struct PulseCalKeyInfo {
+  static PulseCalKey getEmptyKey() {
+    return {llvm::DenseMapInfo<mlir::StringAttr>::getEmptyKey(), {}};
+  }
+  static PulseCalKey getTombstoneKey() {
+    return {llvm::DenseMapInfo<mlir::StringAttr>::getTombstoneKey(), {}};
+  }
+  static unsigned getHashValue(const PulseCalKey &key) {
+    return llvm::hash_combine(
+        key.gateName.getAsOpaquePointer(),
+        llvm::hash_combine_range(key.qubits.begin(), key.qubits.end()));
+  }
+  static bool isEqual(const PulseCalKey &lhs, const PulseCalKey &rhs) {
+    return lhs.gateName == rhs.gateName && lhs.qubits == rhs.qubits;
+  }
+};
+
+/// The pulse calibration of a gate, with the name of the calibration
+/// interned, and a null sequence if there is no calibration of that name.
+struct PulseCal {
+  mlir::StringAttr name;
+  SequenceOp sequence;
+};
+
 struct LoadPulseCalsPass
     : public PassWrapper<LoadPulseCalsPass, OperationPass<ModuleOp>> {
   std::string DEFAULT_PULSE_CALS = "";
@@ -96,12 +140,41 @@ struct LoadPulseCalsPass
   void addPulseCalToModule(mlir::func::FuncOp funcOp,
                            mlir::pulse::SequenceOp sequenceOp);
 
-  // parse the pulse cals and return the parsed module
-  llvm::Error parsePulseCalsModuleOp(std::string &pulseCalsPath,
-                                     mlir::OwningOpRef<ModuleOp> &owningOpRef);
+  // load the index of the pulse cals and create the module the sequences
+  // used by the program are deserialized into
+  llvm::Error loadPulseCalsIndex(std::string &pulseCalsPath,
+                                 std::shared_ptr<const PulseCalsIndex> &index,
+                                 mlir::OwningOpRef<ModuleOp> &owningOpRef);
+  std::shared_ptr<const PulseCalsIndex> defaultPulseCalsIndex;
+  std::shared_ptr<const PulseCalsIndex> additionalPulseCalsIndex;
   mlir::OwningOpRef<ModuleOp> defaultPulseCalsModule;
   mlir::OwningOpRef<ModuleOp> additionalPulseCalsModule;
-  std::map<std::string, SequenceOp> pulseCalsNameToSequenceMap;
+  // pulse cals found so far; sequences of the pulse cals files are only added
+  // once looked up with lookupPulseCal
+  llvm::StringMap<SequenceOp> pulseCalsNameToSequenceMap;
+
+  // returns the pulse cal sequenceName, deserializing it from the additional
+  // or default pulse cals if needed, or a null sequence if there is none
+  mlir::pulse::SequenceOp lookupPulseCal(llvm::StringRef sequenceName);
+
+  // returns the pulse cal of gateName on qubits, which is looked up by
+  // mangled name only the first time the gate is seen on these qubits
+  PulseCal resolvePulseCal(mlir::StringAttr gateName,
+                           llvm::ArrayRef<uint32_t> qubits);
+  // returns the pulse cal of gateName on qubits, merging the pulse cals of
+  // the individual qubits if there is none. Merged pulse cals are reused by
+  // later gates on the same qubits and, for order independent gates, on any
+  // order of the same qubits
+  PulseCal getOrMergePulseCal(mlir::StringAttr gateName,
+                              llvm::ArrayRef<uint32_t> qubits,
+                              bool orderIndependent);
+  // records pulseCal as the pulse cal of gateName on qubits, which must have
+  // been resolved
+  void recordPulseCal(mlir::StringAttr gateName,
+                      llvm::ArrayRef<uint32_t> qubits, PulseCal pulseCal);
+  llvm::DenseMap<PulseCalKey, PulseCal, PulseCalKeyInfo> pulseCalsByGate;
+  // storage of the qubits of the keys of pulseCalsByGate
+  llvm::BumpPtrAllocator pulseCalKeyAllocator;
 
   mlir::pulse::SequenceOp
   mergePulseSequenceOps(std::vector<mlir::pulse::SequenceOp> &sequenceOps,
@@ -111,7 +184,14 @@ struct LoadPulseCalsPass
                                 mlir::OpBuilder &builder);
 
   // set of pulse cals already added to IR
-  std::unordered_set<std::string> pulseCalsAddedToIR;
+  llvm::DenseSet<mlir::StringAttr> pulseCalsAddedToIR;
+
+  // the names of the builtin gates, interned once per run rather than for
+  // every gate so that circuits do not contend on the context's uniquer
+  struct BuiltinGateNames {
+    mlir::StringAttr cx, u3, measure, midCircuitMeasure, barrier, delay,
+        reset;
+  } builtinGateNames;
 
   // returns true if all the sequence ops in the input vector has the same
   // duration
@@ -130,9 +210,19 @@ struct LoadPulseCalsPass
   getQubitOperands(std::vector<Value> &qubitOperands,
                    mlir::quir::CallCircuitOp callCircuitOp);
 
-  // TODO: move this function to Utils; it's used here and MergeCircuitsPass
-  static mlir::quir::CircuitOp
-  getCircuitOp(mlir::quir::CallCircuitOp callCircuitOp);
+  mlir::quir::CircuitOp getCircuitOp(mlir::quir::CallCircuitOp callCircuitOp);
+  mlir::quir::SymbolIndexAnalysis *symbolIndex = nullptr;
+
+  Statistic numPulseCalLookups{this, "num-pulse-cal-lookups",
+                               "Number of pulse calibration lookups"};
+  Statistic numPulseCalCacheHits{
+      this, "num-pulse-cal-cache-hits",
+      "Number of pulse calibration lookups of already resolved gates"};
+  Statistic numMergedPulseCals{this, "num-merged-pulse-cals",
+                               "Number of pulse calibrations merged"};
+  Statistic numReusedMergedPulseCals{
+      this, "num-reused-merged-pulse-cals",
+      "Number of merged pulse calibrations reused for reordered qubits"};
 };
 } // namespace mlir::pulse
 
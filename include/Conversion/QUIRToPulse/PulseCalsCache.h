@@ -0,0 +1,135 @@
+//===- PulseCalsCache.h - Cache of parsed pulse calibrations ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the process wide cache of parsed pulse calibration
+///  files.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_CALS_CACHE_H
+#define PULSE_CALS_CACHE_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace mlir::pulse {
+
+/// The pulse sequences of a calibrations file, each serialized as a separate
+/// MLIR bytecode module and indexed by name, so that a compilation only
+/// deserializes the sequences it uses rather than all the sequences of the
+/// device.
+class PulseCalsIndex {
+public:
+  /// Check whether the calibrations contain the sequence name.
+  bool contains(llvm::StringRef name) const { return ranges.count(name); }
+
+  /// Get the number of sequences in the calibrations.
+  size_t size() const { return ranges.size(); }
+
+  /// Get the version of the calibrations, a hash of their sequences which
+  /// changes whenever they do.
+  llvm::StringRef getVersion() const { return version; }
+
+  /// Deserialize the sequence name and append it to module. Returns a null
+  /// sequence if the calibrations do not contain it.
+  llvm::Expected<SequenceOp> materialize(llvm::StringRef name,
+                                         mlir::ModuleOp module) const;
+
+private:
+  friend class PulseCalsCache;
+
+  /// The byte range of a sequence within bytecode.
+  struct Range {
+    size_t offset;
+    size_t length;
+  };
+
+  std::string path;
+  std::string version;
+  std::string bytecode;
+  llvm::StringMap<Range> ranges;
+};
+
+/// A thread safe cache of the pulse calibration files parsed by the
+/// compilations of a process. Parsed modules belong to the MLIRContext they
+/// were parsed in and are modified by LoadPulseCalsPass, so the cache keeps
+/// the calibrations as MLIR bytecode, which is much faster to read than the
+/// textual files. A cached file is parsed again once its modification time
+/// or size changes.
+///
+/// Calibrations may also be loaded as a PulseCalsIndex, which is shared by
+/// all the compilations loading the same unchanged file.
+class PulseCalsCache {
+public:
+  /// Get the cache shared by all compilations of the process.
+  static PulseCalsCache &global();
+
+  /// Load the pulse calibrations file at path into context, from the cached
+  /// bytecode if the file did not change since it was cached.
+  llvm::Expected<mlir::OwningOpRef<mlir::ModuleOp>>
+  load(llvm::StringRef path, mlir::MLIRContext *context);
+
+  /// Load the index of the sequences of the pulse calibrations file at path,
+  /// parsing the file with context if it changed since it was indexed.
+  llvm::Expected<std::shared_ptr<const PulseCalsIndex>>
+  loadIndex(llvm::StringRef path, mlir::MLIRContext *context);
+
+  /// Check whether the calibrations of the file at path are cached, without
+  /// checking whether the file changed.
+  bool contains(llvm::StringRef path);
+
+  /// Drop all cached calibrations.
+  void clear();
+
+private:
+  /// The cached forms of a file, each created when first loaded.
+  struct Entry {
+    llvm::sys::TimePoint<> modificationTime;
+    uint64_t size;
+    std::shared_ptr<const std::string> bytecode;
+    std::shared_ptr<const PulseCalsIndex> index;
+  };
+
+  /// Get the entry of path if it is up to date with status.
+  Entry *lookup(llvm::StringRef path, const llvm::sys::fs::file_status &status);
+
+  /// Get the entry of path, replacing it with an empty one if it is not up
+  /// to date with status.
+  Entry &getOrReset(llvm::StringRef path,
+                    const llvm::sys::fs::file_status &status);
+
+  std::mutex mutex;
+  llvm::StringMap<Entry> entries;
+};
+
+} // namespace mlir::pulse
+
+#endif // PULSE_CALS_CACHE_H
@@ -23,12 +23,21 @@
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/LoweredCircuitCache.h"
 #include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 
+#include "mlir/IR/Attributes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+
+#include <map>
 #include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace mlir::pulse {
 
@@ -61,59 +70,85 @@ struct QUIRToPulsePass
 
   mlir::Operation *mainFuncFirstOp;
 
-  // convert quir circuit to pulse sequence
-  void convertCircuitToSequence(mlir::quir::CallCircuitOp callCircuitOp,
-                                mlir::func::FuncOp &mainFunc,
+  // the pulse.args names of angle and duration arguments, interned before
+  // the circuits are converted in parallel
+  mlir::StringAttr angleArgName;
+  mlir::StringAttr durationArgName;
+
+  Option<bool> cacheCircuits{
+      *this, "cache-circuits",
+      llvm::cl::desc("reuse the sequences which the compilations of the "
+                     "process lowered the same circuits to with the same "
+                     "calibrations, as loaded by load-pulse-cals"),
+      llvm::cl::init(true)};
+
+  Statistic numCacheHits{this, "num-cache-hits",
+                         "Number of circuits read from the cache"};
+  Statistic numCacheMisses{this, "num-cache-misses",
+                           "Number of circuits lowered and cached"};
+
+  // a quir circuit call and the pulse sequence converted from it. The
+  // sequence is built detached from the module without creating or using
+  // any op in main, so that the circuits can be converted in parallel; its
+  // operands are then materialized in main in the order of the circuit calls
+  struct ConvertedCircuit {
+    mlir::quir::CallCircuitOp callCircuitOp;
+    mlir::quir::CircuitOp circuitOp;
+    SequenceOp sequenceOp;
+    // the key of the lowered circuit in the LoweredCircuitCache, empty if
+    // it is not cached
+    std::string cacheKey;
+    std::vector<ConvertedSequenceArg> args;
+    // the pulse.args names of the sequence arguments
+    std::vector<mlir::Attribute> argNames;
+    std::map<uint, uint> circuitArgToSequenceArg;
+    // map of the values of quir angle/duration constants in the circuit to
+    // their converted pulse ops in the sequence
+    llvm::DenseMap<mlir::Attribute, mlir::Value> convertedConstants;
+  };
+
+  // convert quir circuit to pulse sequence; this may run concurrently for
+  // different circuit calls
+  void convertCircuitToSequence(ConvertedCircuit &converted,
                                 ModuleOp moduleOp);
-  // helper datastructure for converting quir circuit to pulse sequence; these
-  // will be reset every time convertCircuitToSequence is called and will be
-  // used by several functions that are called within that function
-  uint convertedSequenceOpArgIndex;
-  std::map<uint, uint> circuitArgToConvertedSequenceArgMap;
-  SmallVector<Value> convertedPulseSequenceOpArgs;
-  std::vector<mlir::Attribute> convertedPulseCallSequenceOpOperandNames;
-
-  // process the args of the circuit op, and add corresponding args to the
-  // converted pulse sequence op
-  void processCircuitArgs(mlir::quir::CallCircuitOp callCircuitOp,
-                          mlir::quir::CircuitOp circuitOp,
-                          SequenceOp convertedPulseSequenceOp,
-                          mlir::func::FuncOp &mainFunc,
+  // read the converted pulse sequence from a cached lowered circuit, or
+  // return false if it cannot be read
+  bool loadCachedCircuit(ConvertedCircuit &converted,
+                         const LoweredCircuit &circuit);
+  // cache the converted pulse sequence under the key of converted
+  void cacheConvertedCircuit(const ConvertedCircuit &converted);
+  // add the converted pulse sequence to the module and replace the circuit
+  // call with a call to it, adding the ports, mixframes and waveforms it uses
+  // to main
+  void materializeConvertedCircuit(ConvertedCircuit &converted,
+                                   mlir::func::FuncOp &mainFunc);
+
+  // add the args of the converted pulse sequence op corresponding to the
+  // angle and duration args of the circuit op
+  void processCircuitArgs(ConvertedCircuit &converted,
                           mlir::OpBuilder &builder);
 
   // process the args of the pulse cal sequence op corresponding to quirOp
   void processPulseCalArgs(mlir::Operation *quirOp,
                            SequenceOp pulseCalSequenceOp,
                            SmallVector<Value> &pulseCalSeqArgs,
-                           SequenceOp convertedPulseSequenceOp,
-                           mlir::func::FuncOp &mainFunc,
+                           ConvertedCircuit &converted,
                            mlir::OpBuilder &builder);
   void getQUIROpClassicalOperands(mlir::Operation *quirOp,
                                   std::queue<Value> &angleOperands,
                                   std::queue<Value> &durationOperands);
-  void processMixFrameOpArg(std::string const &mixFrameName,
-                            std::string const &portName,
-                            SequenceOp convertedPulseSequenceOp,
-                            SmallVector<Value> &quirOpPulseCalSeqArgs,
-                            Value argumentValue, mlir::func::FuncOp &mainFunc,
-                            mlir::OpBuilder &builder);
-  void processPortOpArg(std::string const &portName,
-                        SequenceOp convertedPulseSequenceOp,
-                        SmallVector<Value> &quirOpPulseCalSeqArgs,
-                        Value argumentValue, mlir::func::FuncOp &mainFunc,
-                        mlir::OpBuilder &builder);
-  void processWfrOpArg(std::string const &wfrName,
-                       SequenceOp convertedPulseSequenceOp,
+  // add a mixframe, port or waveform arg to the converted pulse sequence op if
+  // it does not have one of that name yet
+  void processNamedArg(ConvertedSequenceArg arg, mlir::Type argType,
+                       Value argumentValue,
                        SmallVector<Value> &quirOpPulseCalSeqArgs,
-                       Value argumentValue, mlir::func::FuncOp &mainFunc,
-                       mlir::OpBuilder &builder);
+                       ConvertedCircuit &converted, mlir::OpBuilder &builder);
   void processAngleArg(Value nextAngleOperand,
-                       SequenceOp convertedPulseSequenceOp,
                        SmallVector<Value> &quirOpPulseCalSeqArgs,
-                       mlir::OpBuilder &builder);
+                       ConvertedCircuit &converted, mlir::OpBuilder &builder);
   void processDurationArg(Value frontDurOperand,
-                          SequenceOp convertedPulseSequenceOp,
                           SmallVector<Value> &quirOpPulseCalSeqArgs,
+                          ConvertedCircuit &converted,
                           mlir::OpBuilder &builder);
 
   // convert angle to F64
@@ -123,9 +158,9 @@ struct QUIRToPulsePass
                                    Operation *durOp, uint &cnt,
                                    mlir::OpBuilder &builder,
                                    mlir::func::FuncOp &mainFunc);
-  // map of the hashed location of quir angle/duration ops to their converted
-  // pulse ops
-  std::map<std::string, mlir::Value> classicalQUIROpLocToConvertedPulseOpMap;
+  // map of the quir angle/duration ops to their converted pulse ops in main
+  llvm::DenseMap<mlir::Operation *, mlir::Value>
+      classicalQUIROpToConvertedPulseOpMap;
 
   // port name to Port_CreateOp map
   std::map<std::string, mlir::pulse::Port_CreateOp> openedPorts;
@@ -133,6 +168,11 @@ struct QUIRToPulsePass
   std::map<std::string, mlir::pulse::MixFrameOp> openedMixFrames;
   // waveform name to Waveform_CreateOp map
   std::map<std::string, mlir::pulse::Waveform_CreateOp> openedWfrs;
+  // waveform samples and scale to Waveform_CreateOp map, shared by all the
+  // waveform names with the same samples
+  llvm::DenseMap<std::pair<mlir::Attribute, mlir::Attribute>,
+                 mlir::pulse::Waveform_CreateOp>
+      openedWfrsBySamples;
   // add a port to IR if it's not already added and return the Port_CreateOp
   mlir::pulse::Port_CreateOp addPortOpToIR(std::string const &portName,
                                            mlir::func::FuncOp &mainFunc,
@@ -159,8 +199,8 @@ struct QUIRToPulsePass
   void parsePulseWaveformContainerOps(std::string &waveformContainerPath);
   std::map<std::string, Waveform_CreateOp> pulseNameToWaveformMap;
 
-  static mlir::quir::CircuitOp
-  getCircuitOp(mlir::quir::CallCircuitOp callCircuitOp);
+  mlir::quir::CircuitOp getCircuitOp(mlir::quir::CallCircuitOp callCircuitOp);
+  mlir::quir::SymbolIndexAnalysis *symbolIndex = nullptr;
 };
 } // namespace mlir::pulse
 
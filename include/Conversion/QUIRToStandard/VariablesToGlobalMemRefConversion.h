@@ -23,15 +23,58 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#ifndef QUIRTOSTD_VARIABLESTOGLOBALMEMREFCONVERSION_H
+#define QUIRTOSTD_VARIABLESTOGLOBALMEMREFCONVERSION_H
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 
+#include "llvm/ADT/DenseMap.h"
+
+#include <cstdint>
+
 namespace mlir::quir {
 
+/// The placement of the QUIR scalar variables which are packed into shared
+/// global buffers instead of a memref.global each.
+struct PackedVariableLayout {
+  /// The element of a buffer holding a variable.
+  struct Slot {
+    mlir::FlatSymbolRefAttr buffer;
+    int64_t index;
+  };
+
+  /// The slots of the packed variables, by variable name.
+  llvm::DenseMap<mlir::StringAttr, Slot> slots;
+};
+
+/// Pack the private scalar variables declared in moduleOp into one aligned
+/// memref.global buffer per converted element type (i.e., a struct of
+/// arrays), created at the top of moduleOp. Input and output variables keep
+/// a global of their own. The variables are ordered by decreasing static
+/// access count, where accesses in loops weigh more, so that the frequently
+/// accessed variables share the leading cache lines of their buffer and the
+/// rarely accessed ones are kept out of them.
+///
+/// With reuseSlots, the variables which are assigned before any other access
+/// and only accessed in a single block, e.g., the temporaries of a round of
+/// measurements, share a slot with the other such variables of the block
+/// whose live ranges do not overlap theirs.
+PackedVariableLayout packVariables(mlir::ModuleOp moduleOp,
+                                   mlir::TypeConverter &typeConverter,
+                                   bool reuseSlots = false);
+
+/// Add the patterns converting QUIR variables to global memrefs. The
+/// variables placed by layout, if given, are accessed in their buffer slot.
 void populateVariableToGlobalMemRefConversionPatterns(
     RewritePatternSet &patterns, mlir::TypeConverter &typeConverter,
-    bool externalizeOutputVariables);
+    bool externalizeOutputVariables,
+    const PackedVariableLayout *layout = nullptr);
 
 }; // namespace mlir::quir
+
+#endif // QUIRTOSTD_VARIABLESTOGLOBALMEMREFCONVERSION_H
@@ -0,0 +1,72 @@
+//===- DialectBytecode.h - Bytecode versioning of dialects ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the bytecode interface shared by the qss-compiler
+///  dialects to version their bytecode.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DIALECT_DIALECTBYTECODE_H
+#define DIALECT_DIALECTBYTECODE_H
+
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace qssc::dialect {
+
+/// @brief The version of a dialect read from bytecode.
+struct DialectBytecodeVersion : public mlir::DialectVersion {
+  explicit DialectBytecodeVersion(uint64_t version) : version(version) {}
+
+  uint64_t version;
+};
+
+/// @brief Bytecode interface recording the version of a dialect in the
+/// bytecode it is written to and rejecting bytecode written by newer
+/// versions of the dialect. Attributes and types fall back to their textual
+/// encoding. Version must be bumped whenever operations, attributes or types
+/// of the dialect change in a way that bytecode of the previous version no
+/// longer parses.
+template <uint64_t Version>
+struct VersionedBytecodeInterface : public mlir::BytecodeDialectInterface {
+  using mlir::BytecodeDialectInterface::BytecodeDialectInterface;
+
+  void writeVersion(mlir::DialectBytecodeWriter &writer) const override {
+    writer.writeVarInt(Version);
+  }
+
+  std::unique_ptr<mlir::DialectVersion>
+  readVersion(mlir::DialectBytecodeReader &reader) const override {
+    uint64_t version;
+    if (mlir::failed(reader.readVarInt(version)))
+      return nullptr;
+    if (version > Version) {
+      reader.emitError() << "bytecode version " << version << " of dialect "
+                         << getDialect()->getNamespace()
+                         << " is newer than the supported version " << Version;
+      return nullptr;
+    }
+    return std::make_unique<DialectBytecodeVersion>(version);
+  }
+};
+
+} // namespace qssc::dialect
+
+#endif // DIALECT_DIALECTBYTECODE_H
@@ -18,9 +18,20 @@
 #define LIMIT_CBIT_WIDTH_H
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
 
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace mlir::oq3 {
 
 using namespace mlir;
@@ -45,24 +56,34 @@ public:
       llvm::cl::desc("Maximum width of classical bit arrays")};
 
 private:
-  void addNewDeclareVariableOps(
-      mlir::Operation *module, mlir::oq3::DeclareVariableOp op,
-      uint numRegistersRequired, uint numRemainingBits,
-      llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters,
-      mlir::SymbolTableCollection &symbolTableCol);
+  /// The registers a wide variable is split into, indexed by register
+  /// number.
+  struct SplitRegisters {
+    llvm::SmallVector<mlir::FlatSymbolRefAttr> names;
+    llvm::SmallVector<mlir::quir::CBitType> types;
+
+    size_t size() const { return names.size(); }
+  };
+
+  SplitRegisters addNewDeclareVariableOps(mlir::oq3::DeclareVariableOp op,
+                                          mlir::SymbolTable &symbolTable);
+  std::string getUniqueVariableName(const std::string &variableName,
+                                    mlir::SymbolTable &symbolTable);
   void processOp(mlir::oq3::CBitAssignBitOp cbitAssignOp,
-                 uint numRegistersRequired, uint numRemainingBits,
-                 llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters);
+                 const SplitRegisters &newRegisters);
   void processOp(mlir::oq3::VariableAssignOp variableAssignOp, uint orgWidth,
-                 uint numRegistersRequired, uint numRemainingBits,
-                 llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters);
+                 const SplitRegisters &newRegisters);
   void processOp(mlir::oq3::VariableLoadOp variableLoadOp,
-                 uint numRegistersRequired, uint numRemainingBits,
-                 llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters);
+                 const SplitRegisters &newRegisters);
   std::pair<uint64_t, uint64_t> remapBit(const llvm::APInt &indexInt);
   uint getNewRegisterWidth(uint regNum, uint numRegistersRequired,
                            uint numRemainingBits);
   std::vector<Operation *> eraseList_;
+  /// The names of the new registers, which are not in the symbol table
+  /// until the pass completes.
+  llvm::StringSet<> newVariableNames_;
+  /// The next suffix to try for each name found to be taken.
+  llvm::StringMap<uint> nextSuffix_;
 };
 } // namespace mlir::oq3
 
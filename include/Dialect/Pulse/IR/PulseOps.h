@@ -25,6 +25,7 @@
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Dialect.h"
@@ -37,6 +38,18 @@
 
 #include "llvm/Support/Error.h"
 
+#include <vector>
+
+namespace mlir::pulse {
+
+/// Whether the samples of a pulse.create_waveform may be stored as elements
+/// of type, i.e., f64, f16 or i16.
+inline bool isWaveformSampleType(Type type) {
+  return type.isF64() || type.isF16() || type.isSignlessInteger(16);
+}
+
+} // namespace mlir::pulse
+
 #define GET_OP_CLASSES
 #include "Dialect/Pulse/IR/Pulse.h.inc"
 
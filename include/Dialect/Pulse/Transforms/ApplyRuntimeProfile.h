@@ -0,0 +1,87 @@
+//===- ApplyRuntimeProfile.h - Apply a measured runtime profile -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass applying the profile of a program measured
+///  by running it on hardware, for the passes after it to consult.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_APPLY_RUNTIME_PROFILE_H
+#define PULSE_APPLY_RUNTIME_PROFILE_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace mlir::pulse {
+
+/// Apply a runtime profile, i.e., a JSON object of the form
+///
+///   {
+///     "sequences": {"<sequence>": <duration in dt>, ...},
+///     "branches": {"<location>": [<count>, ...], ...}
+///   }
+///
+/// with the measured durations of pulse.sequence ops, which are set as their
+/// pulse.measuredDuration, and the number of times each region of the scf.if
+/// and quir.switch ops at a location executed, in region order, which are
+/// set as their quir.branchCounts. Locations are keyed as in the report of
+/// FeedForwardLatencyPass. The sequence a quir.circuit is lowered to is
+/// named <circuit>_sequence, see QUIRToPulsePass.
+///
+/// A measured duration only ever lengthens a sequence, the gates of which
+/// SequenceDurationAnalysis and the circuits of which
+/// QuantumCircuitPulseSchedulingPass then schedule with it. The regions of
+/// an scf.if whose else region executed more often are swapped and its
+/// condition negated, so that the hot region is laid out first, and the
+/// lowering of quir.switch lays its regions out by decreasing count.
+/// Entries of the profile matching no op are ignored, as the profile may
+/// have been measured on an earlier compilation of the program.
+class ApplyRuntimeProfilePass
+    : public PassWrapper<ApplyRuntimeProfilePass, OperationPass<ModuleOp>> {
+public:
+  ApplyRuntimeProfilePass() = default;
+  ApplyRuntimeProfilePass(const ApplyRuntimeProfilePass &pass)
+      : PassWrapper(pass) {}
+
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<std::string> profileFile{
+      *this, "profile", llvm::cl::desc("The runtime profile JSON file"),
+      llvm::cl::value_desc("filename"), llvm::cl::init("")};
+
+  Statistic numSequencesProfiled{
+      this, "num-sequences-profiled",
+      "Number of sequences given a measured duration"};
+  Statistic numBranchesProfiled{
+      this, "num-branches-profiled",
+      "Number of conditionals given branch counts"};
+  Statistic numBranchesSwapped{
+      this, "num-branches-swapped",
+      "Number of scf.if ops whose regions were swapped"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_APPLY_RUNTIME_PROFILE_H
@@ -29,10 +29,10 @@ namespace mlir::pulse {
 
 // This pass recurses through the IR and detects when scf
 // ops use only classical operations. It then applies the classicalOnly
-// attribute to all of the scf ops with a value of either true or false
+// attribute to all of the scf ops with a value of either true or false, as
+// computed by ClassicalOnlyAnalysis
 struct ClassicalOnlyDetectionPass
     : public PassWrapper<ClassicalOnlyDetectionPass, OperationPass<>> {
-  auto hasPulseSubOps(Operation *inOp) -> bool;
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
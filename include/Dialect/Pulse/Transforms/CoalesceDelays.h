@@ -0,0 +1,54 @@
+//===- CoalesceDelays.h - Coalesce delays on the same targets ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for coalescing the quir.delay,
+///  qcs.delay_cycles and pulse.delay ops on the same targets which are
+///  separated by operations on other targets.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_COALESCE_DELAYS_H
+#define PULSE_COALESCE_DELAYS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::pulse {
+
+/// Merge each delay with constant duration into the previous delay of the
+/// same kind in its block on the same qubits, or frame, with a constant
+/// duration, if the operations in between only operate on other qubits, or
+/// frames. Unlike pulse-merge-delay, the delays need not be back to back, so
+/// they are coalesced across the calls of circuits and sequences on other
+/// targets. Barriers, synchronizations and calls whose targets are not known
+/// are not crossed.
+class CoalesceDelaysPass
+    : public PassWrapper<CoalesceDelaysPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numDelaysCoalesced{this, "num-delays-coalesced",
+                               "Number of delays merged into an earlier delay"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_COALESCE_DELAYS_H
@@ -0,0 +1,60 @@
+//===- DeduplicateWaveforms.h - Share identical waveforms -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for sharing a single definition between
+///  waveforms with identical contents, e.g., the same samples registered
+///  under different waveform names.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_DEDUPLICATE_WAVEFORMS_H
+#define PULSE_DEDUPLICATE_WAVEFORMS_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::pulse {
+
+/// Replace each waveform op, i.e., pulse.create_waveform, pulse.gaussian,
+/// pulse.gaussian_square, pulse.drag or pulse.const_waveform, with an
+/// identical waveform op dominating it. Waveforms are identical if they have
+/// the same samples, or the same parameters, where constant parameters are
+/// compared by value. Likewise, pulse.create_kernel ops are replaced once
+/// their weights are, so that the kernels of the same weights, e.g., of
+/// qubits with the same readout, are shared. Waveforms in a
+/// pulse.waveform_container are left untouched.
+class DeduplicateWaveformsPass
+    : public PassWrapper<DeduplicateWaveformsPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numWaveformsDeduplicated{this, "num-waveforms-deduplicated",
+                                     "Number of waveforms deduplicated"};
+  Statistic numKernelsDeduplicated{this, "num-kernels-deduplicated",
+                                   "Number of kernels deduplicated"};
+  Statistic numSampleBytesSaved{
+      this, "num-sample-bytes-saved",
+      "Number of waveform sample bytes no longer emitted, counting 16 bytes "
+      "per complex sample of the waveforms with a constant duration"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_DEDUPLICATE_WAVEFORMS_H
@@ -0,0 +1,52 @@
+//===- EliminateBarriers.h - Erase and narrow pulse barriers ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass erasing the pulse barriers which do not
+///  constrain the operations after them and narrowing the others.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_ELIMINATE_BARRIERS_H
+#define PULSE_ELIMINATE_BARRIERS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::pulse {
+
+/// Erase the pulse.barrier which do not delay any operation, e.g., those on
+/// a single frame or next to another barrier of all their frames, and
+/// narrow the others to the frames they delay, see
+/// quir::eliminateBarriers. The frames of an operation are its operands
+/// and those of the operations nested in it.
+class EliminateBarriersPass
+    : public PassWrapper<EliminateBarriersPass, OperationPass<>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numBarriersErased{this, "num-barriers-erased",
+                              "Number of barriers erased"};
+  Statistic numBarriersNarrowed{this, "num-barriers-narrowed",
+                                "Number of barriers narrowed to fewer frames"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_ELIMINATE_BARRIERS_H
@@ -0,0 +1,74 @@
+//===- FeedForwardLatency.h - Report feed-forward latencies -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass reporting the latency from the measurements
+///  to the conditionals depending on them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_FEED_FORWARD_LATENCY_H
+#define PULSE_FEED_FORWARD_LATENCY_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <string>
+
+namespace mlir::pulse {
+
+/// Print loc as the report of FeedForwardLatencyPass does, i.e., as
+/// file:line:col for file locations, which is also how the conditionals of a
+/// runtime profile are keyed, see ApplyRuntimeProfilePass.
+std::string printConditionalLocation(Location loc);
+
+/// Report, as JSON, the feed-forward latency of each scf.if and quir.switch
+/// whose condition depends on a measurement, i.e., on the result of a
+/// quir.measure or pulse.call_sequence, or on a value received by a qcs.recv
+/// from another node after qubit localization. The latency to each
+/// measurement is the sum of the pulse.duration of the sequences called
+/// between the measurement and the conditional, plus hop-latency for a value
+/// received from another node. The latency of the conditional is the one of
+/// its critical, i.e., slowest, measurement. A latency is not exact when the
+/// calls in between are nested in other control flow or lack a duration, or
+/// when a dependency could not be followed. The IR is left unchanged.
+class FeedForwardLatencyPass
+    : public PassWrapper<FeedForwardLatencyPass, OperationPass<ModuleOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<std::string> outputFile{
+      *this, "output", llvm::cl::desc("The file to write the report to"),
+      llvm::cl::value_desc("filename"), llvm::cl::init("-")};
+  Option<uint64_t> hopLatency{
+      *this, "hop-latency",
+      llvm::cl::desc("The latency in dt of receiving a value from another "
+                     "node"),
+      llvm::cl::init(0)};
+
+  Statistic numConditionals{this, "num-conditionals",
+                            "Number of conditionals depending on measurements"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_FEED_FORWARD_LATENCY_H
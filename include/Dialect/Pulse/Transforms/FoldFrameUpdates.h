@@ -0,0 +1,60 @@
+//===- FoldFrameUpdates.h - Fold phase and frequency updates ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for folding the chains of phase and
+///  frequency updates of a frame into a single update.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_FOLD_FRAME_UPDATES_H
+#define PULSE_FOLD_FRAME_UPDATES_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::pulse {
+
+/// Fold each pulse.set_phase or pulse.shift_phase into the next update of
+/// the phase of the same frame in its block, and likewise for the frequency,
+/// if no operation in between may observe the frame, e.g., a pulse.play,
+/// pulse.capture or pulse.delay on it, a barrier, a call or an operation
+/// with regions. A set drops the updates before it, and the sum of a set or
+/// shift and a later shift by constants is a single set or shift at the
+/// later update, e.g., the shifts of a chain of virtual Z gates become one.
+///
+/// Updates of the phase may cross updates of the frequency and conversely.
+/// As the frequency sets the accumulation of the phase, updates of the
+/// frequency are only folded at the same pulse.timepoint. Frames are
+/// compared by value, so the updates of a frame are not folded across the
+/// operations on another value which aliases it.
+class FoldFrameUpdatesPass
+    : public PassWrapper<FoldFrameUpdatesPass, OperationPass<SequenceOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numUpdatesFolded{this, "num-updates-folded",
+                             "Number of frame updates removed by folding"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_FOLD_FRAME_UPDATES_H
@@ -0,0 +1,55 @@
+//===- MergeCaptures.h - Merge simultaneous captures ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for merging the simultaneous pulse.capture
+///  ops on the frames of the same port into a pulse.multiplexed_capture.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_MERGE_CAPTURES_H
+#define PULSE_MERGE_CAPTURES_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::pulse {
+
+/// Replace the pulse.capture ops of a block of a sequence which have the
+/// same pulse.timepoint and capture frames of the same port, as given by the
+/// pulse.argPorts of the sequence, with a single pulse.multiplexed_capture
+/// of their frames at the first of them, e.g., the readouts of the qubits
+/// multiplexed on an acquire channel, so that the port is set up and
+/// acquires once. Captures which are not scheduled are left untouched, so
+/// the pass runs after scheduling.
+class MergeCapturesPass
+    : public PassWrapper<MergeCapturesPass, OperationPass<SequenceOp>> {
+public:
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numCapturesMerged{
+      this, "num-captures-merged",
+      "Number of captures merged into a multiplexed capture"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_MERGE_CAPTURES_H
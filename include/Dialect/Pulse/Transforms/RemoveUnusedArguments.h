@@ -30,6 +30,12 @@
 
 namespace mlir::pulse {
 
+/// Remove the unused arguments of each pulse.sequence which is only
+/// referenced by its pulse.call_sequence ops, and the matching operands of
+/// its calls. The callers of each sequence are found once through a
+/// SymbolUserMap, and the sequences are processed bottom-up in the call
+/// graph so that the arguments left unused by removing the operands of
+/// calls are removed too.
 class RemoveUnusedArgumentsPass
     : public PassWrapper<RemoveUnusedArgumentsPass, OperationPass<ModuleOp>> {
 public:
@@ -38,6 +44,9 @@ public:
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+  Statistic numArgumentsRemoved{this, "num-arguments-removed",
+                                "Number of sequence arguments removed"};
 };
 } // namespace mlir::pulse
 
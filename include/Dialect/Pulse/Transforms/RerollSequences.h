@@ -0,0 +1,84 @@
+//===- RerollSequences.h - Reroll repeated pulse operations -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for rerolling runs of repeated pulse
+///  operations into a single repeated pulse.call_sequence.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_REROLL_SEQUENCES_H
+#define PULSE_REROLL_SEQUENCES_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::pulse {
+
+/// Get the name of the attribute of a pulse.call_sequence which repeats the
+/// call, i.e., pulse.repeat. A call with a pulse.repeat of N runs its
+/// sequence N times back to back, the i-th time starting at the
+/// pulse.timepoint of the call plus i times the pulse.duration of its
+/// sequence, and is equivalent to N calls. The duration of the call is N
+/// times that of its sequence for SequenceDurationAnalysis, and thus for
+/// QuantumCircuitPulseSchedulingPass and FeedForwardLatencyPass. Targets
+/// should lower it to a hardware loop rather than unroll it; no in-tree
+/// target lowers pulse sequences yet, and passes reading durations
+/// otherwise, e.g., PulseOpSchedulingInterface::getDuration, see a single
+/// run, so they must run before RerollSequencesPass.
+llvm::StringRef getRepeatAttrName();
+
+/// Replace each run of a pattern of pulse operations without results, i.e.,
+/// calls of sequences, plays, delays, barriers and frame updates, which is
+/// repeated back to back with the same operands and attributes by a single
+/// pulse.call_sequence with a pulse.repeat attribute. A pattern of a single
+/// call is repeated in place, others are outlined into a new sequence
+/// taking the values they use as arguments. If the operations are
+/// scheduled, each repetition must start the same number of samples after
+/// the previous one, which becomes the pulse.duration of the outlined
+/// sequence, so the pass should run after scheduling.
+class RerollSequencesPass
+    : public PassWrapper<RerollSequencesPass, OperationPass<ModuleOp>> {
+public:
+  RerollSequencesPass() = default;
+  RerollSequencesPass(const RerollSequencesPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<unsigned> minRepeats{
+      *this, "min-repeats",
+      llvm::cl::desc("The number of repetitions from which a pattern is "
+                     "rerolled, default is 2"),
+      llvm::cl::init(2)};
+  Option<unsigned> maxPatternLength{
+      *this, "max-pattern-length",
+      llvm::cl::desc("The number of operations of the longest pattern "
+                     "searched for, default is 16"),
+      llvm::cl::init(16)};
+
+  Statistic numRunsRerolled{this, "num-runs-rerolled",
+                            "Number of runs replaced by a repeated call"};
+  Statistic numOpsRerolled{this, "num-ops-rerolled",
+                           "Number of operations replaced by repeated calls"};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_REROLL_SEQUENCES_H
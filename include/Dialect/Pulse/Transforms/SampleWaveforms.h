@@ -0,0 +1,81 @@
+//===- SampleWaveforms.h - Fold parametric waveforms ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for folding the parametric waveforms with
+///  constant parameters into sample waveforms.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_SAMPLE_WAVEFORMS_H
+#define PULSE_SAMPLE_WAVEFORMS_H
+
+#include "Dialect/Pulse/Utils/WaveformSamples.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::pulse {
+
+/// Add the patterns replacing pulse.gaussian, pulse.gaussian_square,
+/// pulse.drag and pulse.const_waveform ops with constant parameters by the
+/// pulse.create_waveform of their samples, stored in format and in a dense
+/// resource if useResources, see storeSamples. Waveforms longer than
+/// maxSamples are left untouched unless maxSamples is 0.
+void populateSampleWaveformsPatterns(RewritePatternSet &patterns,
+                                     unsigned maxSamples = 0,
+                                     SampleFormat format = SampleFormat::F64,
+                                     bool useResources = false);
+
+/// Fold the parametric waveforms with constant parameters into the
+/// pulse.create_waveform of their samples, see WaveformSampling.h.
+class SampleWaveformsPass
+    : public PassWrapper<SampleWaveformsPass, OperationPass<ModuleOp>> {
+public:
+  SampleWaveformsPass() = default;
+  SampleWaveformsPass(const SampleWaveformsPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Option<unsigned> maxSamples{
+      *this, "max-samples",
+      llvm::cl::desc("Do not sample waveforms longer than this, 0 for no "
+                     "limit"),
+      llvm::cl::init(0)};
+
+  Option<SampleFormat> sampleFormat{
+      *this, "sample-format",
+      llvm::cl::desc("The element type of the samples, default is f64"),
+      llvm::cl::values(
+          clEnumValN(SampleFormat::F64, "f64", "Double precision samples"),
+          clEnumValN(SampleFormat::F16, "f16", "Half precision samples"),
+          clEnumValN(SampleFormat::I16, "i16",
+                     "i16 DAC codes spanning the full scale")),
+      llvm::cl::init(SampleFormat::F64)};
+
+  Option<bool> useResources{
+      *this, "use-resources",
+      llvm::cl::desc("Store the samples in dense resources, which are "
+                     "neither uniqued nor copied, default is false"),
+      llvm::cl::init(false)};
+};
+} // namespace mlir::pulse
+
+#endif // PULSE_SAMPLE_WAVEFORMS_H
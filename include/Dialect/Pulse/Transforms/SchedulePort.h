@@ -31,8 +31,11 @@
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Utils/DebugIndent.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Support/LogicalResult.h"
 
-#include <map>
+#include "llvm/ADT/DenseMap.h"
+
+#include <cstdint>
 #include <vector>
 
 namespace mlir::pulse {
@@ -48,20 +51,35 @@ public:
   llvm::StringRef getName() const override;
 
 private:
-  using mixedFrameMap_t = std::map<uint32_t, std::vector<Operation *>>;
+  using timepointMap_t = llvm::DenseMap<Operation *, int64_t>;
+
+  /// The operations on each mixed frame of a sequence in block order, with
+  /// their start times and durations, stored as flat arrays in which the
+  /// operations of frame f are [frameBegins[f], frameBegins[f + 1]).
+  /// Sequence calls are on all the mixed frames passed to them.
+  struct MixedFrameTimeline {
+    std::vector<unsigned> frameBegins;
+    std::vector<Operation *> ops;
+    std::vector<int64_t> starts;
+    std::vector<uint64_t> durations;
+  };
 
   uint64_t processCall(CallSequenceOp &callSequenceOp,
                        bool updateNestedSequences);
   uint64_t processSequence(SequenceOp sequenceOp);
   uint64_t updateSequence(SequenceOp sequenceOp);
 
-  mixedFrameMap_t buildMixedFrameMap(SequenceOp &sequenceOp,
-                                     uint32_t &numMixedFrames);
+  mlir::LogicalResult buildMixedFrameTimeline(SequenceOp &sequenceOp,
+                                              MixedFrameTimeline &timeline);
 
-  void addTimepoints(mlir::OpBuilder &builder,
-                     mixedFrameMap_t &mixedFrameSequences, int64_t &maxTime);
-  void sortOpsByTimepoint(SequenceOp &sequenceOp);
+  int64_t addTimepoints(MixedFrameTimeline &timeline,
+                        timepointMap_t &timepoints);
+  mlir::LogicalResult sortOpsByTimepoint(SequenceOp &sequenceOp,
+                                         const timepointMap_t &timepoints);
   llvm::StringMap<mlir::pulse::SequenceOp> sequenceOps;
+
+  // durations of the sequences already scheduled by processSequence
+  llvm::DenseMap<Operation *, uint64_t> sequenceDurations;
 };
 } // namespace mlir::pulse
 
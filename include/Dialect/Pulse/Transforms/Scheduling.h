@@ -23,9 +23,22 @@
 #define SCHEDULING_PULSE_SEQUENCES_H
 
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/SequenceDurationAnalysis.h"
 
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace mlir::pulse {
 
@@ -58,16 +71,76 @@ public:
       llvm::cl::desc("an string to specify scheduling method"),
       llvm::cl::value_desc("filename"), llvm::cl::init("")};
 
+  Option<bool> globalScheduling{
+      *this, "global-scheduling",
+      llvm::cl::desc("schedule the consecutive circuit calls of straight-line "
+                     "regions together, overlapping them where their ports "
+                     "are free"),
+      llvm::cl::init(false)};
+
+  Statistic numCacheHits{this, "num-cache-hits",
+                         "Number of circuit schedules read from the cache"};
+
 private:
-  // map to keep track of next availability of ports
-  std::map<std::string, int> portNameToNextAvailabilityMap;
-
-  void scheduleAlap(mlir::pulse::CallSequenceOp quantumCircuitCallSequenceOp);
-  int getNextAvailableTimeOfPorts(mlir::ArrayAttr ports);
-  void updatePortAvailabilityMap(mlir::ArrayAttr ports,
-                                 int updatedAvailableTime);
-  static mlir::pulse::SequenceOp
-  getSequenceOp(mlir::pulse::CallSequenceOp callSequenceOp);
+  /// A gate call of a quantum circuit with its duration and the interned
+  /// ids of its ports.
+  struct GateCall {
+    mlir::pulse::CallSequenceOp callSequenceOp;
+    uint64_t duration;
+    llvm::SmallVector<unsigned, 4> portIds;
+    int64_t timepoint = 0;
+  };
+
+  /// The time a quantum circuit uses a port, relative to its start.
+  struct PortUsage {
+    unsigned portId;
+    int64_t begin;
+    int64_t end;
+  };
+
+  /// The schedule of a quantum circuit sequence, shared by all its calls.
+  struct CircuitSchedule {
+    mlir::pulse::SequenceOp sequenceOp;
+    // the key of the circuit in the LoweredCircuitCache, if it is cached
+    llvm::StringRef cacheKey;
+    // whether the schedule was read from the cache
+    bool cached = false;
+    std::vector<GateCall> gateCalls;
+    int64_t duration = 0;
+    int64_t timepoint = 0;
+    std::vector<PortUsage> portUsages;
+  };
+
+  /// Collect the gate calls of circuitSequenceOp into schedule.
+  mlir::LogicalResult
+  collectGateCalls(mlir::pulse::SequenceOp circuitSequenceOp,
+                   CircuitSchedule &schedule,
+                   SequenceDurationAnalysis &sequenceDurations);
+  /// Read the schedule of circuitSequenceOp from the LoweredCircuitCache,
+  /// returning false if it is not cached.
+  bool loadCachedSchedule(mlir::pulse::SequenceOp circuitSequenceOp,
+                          CircuitSchedule &schedule);
+  /// Cache the schedule of a circuit which QUIRToPulsePass cached.
+  void cacheSchedule(const CircuitSchedule &schedule) const;
+  unsigned getPortId(mlir::StringAttr portName);
+  llvm::StringRef getSchedulingMethodName() const;
+
+  void scheduleAlap(CircuitSchedule &schedule) const;
+  void scheduleAsap(CircuitSchedule &schedule) const;
+  static void collectPortUsages(CircuitSchedule &schedule);
+
+  /// Overlap the consecutive calls of circuits in straight-line regions,
+  /// setting the duration of each call to the time until the next one
+  /// starts.
+  void scheduleCircuitCalls(
+      llvm::ArrayRef<std::pair<mlir::pulse::CallSequenceOp, size_t>>
+          circuitCalls,
+      llvm::ArrayRef<CircuitSchedule> schedules) const;
+
+  // ids of the non empty port names of the gates
+  llvm::DenseMap<mlir::StringAttr, unsigned> portIds;
+  // the port names of the ids
+  std::vector<mlir::StringAttr> portNames;
 };
 } // namespace mlir::pulse
 
@@ -0,0 +1,55 @@
+//===- ClassicalOnlyAnalysis.h - Operations without pulse ops ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares an analysis which finds the operations containing
+///  Pulse dialect operations in a single post-order walk.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_CLASSICAL_ONLY_ANALYSIS_H
+#define PULSE_CLASSICAL_ONLY_ANALYSIS_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/AnalysisManager.h"
+
+#include "llvm/ADT/DenseSet.h"
+
+namespace mlir::pulse {
+
+/// Whether the operations nested in the operation the analysis is attached
+/// to contain Pulse dialect operations, computed for all of them at once by
+/// marking the parents of each operation which is or contains one. The
+/// analysis holds no references to the IR, so passes which only set
+/// attributes should mark it preserved.
+class ClassicalOnlyAnalysis {
+public:
+  ClassicalOnlyAnalysis(mlir::Operation *op);
+
+  /// Whether op is or contains a Pulse dialect operation.
+  bool hasPulseOps(mlir::Operation *op) const;
+
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return !pa.isPreserved<ClassicalOnlyAnalysis>();
+  }
+
+private:
+  // the operations with regions containing Pulse dialect operations
+  llvm::DenseSet<mlir::Operation *> withPulseOps;
+};
+
+} // namespace mlir::pulse
+
+#endif // PULSE_CLASSICAL_ONLY_ANALYSIS_H
@@ -0,0 +1,128 @@
+//===- LoweredCircuitCache.h - Cache of lowered circuits --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the process wide cache of the pulse sequences which
+///  quir circuits were lowered to, and of their schedules, so that the
+///  circuits shared by the programs compiled between calibration updates are
+///  only lowered and scheduled once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_LOWERED_CIRCUIT_CACHE_H
+#define PULSE_LOWERED_CIRCUIT_CACHE_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace mlir::pulse {
+
+/// An argument of a pulse sequence converted from a quir circuit, and what
+/// the call to the sequence passes it.
+struct ConvertedSequenceArg {
+  enum class Kind { Angle, Duration, MixFrame, Port, Waveform };
+  Kind kind;
+  // the circuit argument converted for angle and duration arguments
+  uint circuitArgIndex = 0;
+  // the name of the mixframe, port or waveform opened in main
+  std::string name;
+  // the port of the mixframe
+  std::string portName;
+};
+
+/// A quir circuit lowered to a pulse sequence by QUIRToPulsePass.
+struct LoweredCircuit {
+  /// The MLIR bytecode of a module holding the sequence.
+  std::string bytecode;
+  std::vector<ConvertedSequenceArg> args;
+};
+
+/// The schedule of a lowered circuit, see QuantumCircuitPulseSchedulingPass.
+struct LoweredCircuitSchedule {
+  /// The time a port is used, relative to the start of the circuit.
+  struct PortUsage {
+    std::string portName;
+    int64_t begin;
+    int64_t end;
+  };
+
+  /// The timepoints of the gate calls of the sequence, in order.
+  std::vector<int64_t> gateTimepoints;
+  int64_t duration = 0;
+  int64_t timepoint = 0;
+  std::vector<PortUsage> portUsages;
+};
+
+/// A thread safe cache of the circuits lowered by the compilations of a
+/// process and of their schedules. Lowered circuits are keyed on a hash of
+/// the circuit, of the operands of its call which its lowering depends on,
+/// and of the version of the pulse calibrations they were lowered with, so
+/// that entries are no longer found once the calibrations change. Schedules
+/// are keyed on the key of their circuit and the scheduling method. The
+/// cache is emptied once it holds more than maxBytes of bytecode.
+class LoweredCircuitCache {
+public:
+  static constexpr size_t maxBytes = 64 * 1024 * 1024;
+
+  /// The module attribute holding the version of the pulse calibrations
+  /// loaded by LoadPulseCalsPass, which the lowering of the circuits of the
+  /// module is only cached with.
+  static constexpr llvm::StringLiteral calsVersionAttrName =
+      "pulse.calsVersion";
+  /// The attribute holding the key of a sequence lowered from a circuit.
+  static constexpr llvm::StringLiteral circuitKeyAttrName =
+      "pulse.circuitKey";
+
+  /// Get the cache shared by all compilations of the process.
+  static LoweredCircuitCache &global();
+
+  /// Get the lowered circuit of key, if cached.
+  std::shared_ptr<const LoweredCircuit> lookup(llvm::StringRef key);
+
+  /// Cache the lowered circuit of key.
+  void insert(llvm::StringRef key, LoweredCircuit circuit);
+
+  /// Get the schedule of the circuit of key by method, if cached.
+  std::shared_ptr<const LoweredCircuitSchedule>
+  lookupSchedule(llvm::StringRef key, llvm::StringRef method);
+
+  /// Cache the schedule of the circuit of key by method.
+  void insertSchedule(llvm::StringRef key, llvm::StringRef method,
+                      LoweredCircuitSchedule schedule);
+
+  /// Get the number of cached circuits.
+  size_t size();
+
+  /// Drop all cached circuits and schedules.
+  void clear();
+
+private:
+  std::mutex mutex;
+  llvm::StringMap<std::shared_ptr<const LoweredCircuit>> circuits;
+  llvm::StringMap<std::shared_ptr<const LoweredCircuitSchedule>> schedules;
+  size_t numBytes = 0;
+};
+
+} // namespace mlir::pulse
+
+#endif // PULSE_LOWERED_CIRCUIT_CACHE_H
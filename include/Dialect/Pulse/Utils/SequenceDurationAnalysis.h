@@ -0,0 +1,92 @@
+//===- SequenceDurationAnalysis.h - Cached sequence durations ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares an analysis which caches the callee, duration and
+///  ports of the sequences called by pulse.call_sequence ops, so that passes
+///  visiting every call of the gate sequences shared by many calls look up
+///  each sequence once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_SEQUENCE_DURATION_ANALYSIS_H
+#define PULSE_SEQUENCE_DURATION_ANALYSIS_H
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/AnalysisManager.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace mlir::pulse {
+
+/// The sequences called by pulse.call_sequence ops with their
+/// pulse.duration, lengthened to their pulse.measuredDuration if any, and
+/// pulse.argPorts attributes, looked up once per sequence. The analysis is
+/// kept across passes which preserve it, so passes which neither add, remove
+/// nor rename sequences nor change their durations or ports should mark it
+/// preserved.
+class SequenceDurationAnalysis {
+public:
+  SequenceDurationAnalysis(mlir::Operation *op);
+
+  /// Get the sequence called by callSequenceOp, or a null sequence if there
+  /// is none.
+  SequenceOp getSequenceOp(CallSequenceOp callSequenceOp);
+
+  /// Get the duration of callSequenceOp, see SequenceOp::getDuration, times
+  /// the number of times it repeats its sequence.
+  llvm::Expected<uint64_t> getDuration(CallSequenceOp callSequenceOp);
+
+  /// Get the number of times callSequenceOp runs its sequence back to back,
+  /// i.e., its pulse.repeat if any, see RerollSequencesPass. The
+  /// pulse.duration of a call is that of a single run.
+  static uint64_t getRepeats(CallSequenceOp callSequenceOp);
+
+  /// Get the ports of the sequence called by callSequenceOp, see
+  /// PulseOpSchedulingInterface::getPorts.
+  llvm::Expected<mlir::ArrayAttr> getPorts(CallSequenceOp callSequenceOp);
+
+  void invalidate() { invalid_ = true; }
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return invalid_ || !pa.isPreserved<SequenceDurationAnalysis>();
+  }
+
+private:
+  struct SequenceInfo {
+    SequenceOp sequenceOp;
+    std::optional<uint64_t> duration;
+    mlir::ArrayAttr ports;
+  };
+
+  /// Get the cached sequence called by callSequenceOp, looking it up the
+  /// first time it is called.
+  const SequenceInfo &getSequenceInfo(CallSequenceOp callSequenceOp);
+
+  mlir::SymbolTableCollection symbolTables;
+  llvm::DenseMap<mlir::Operation *, SequenceInfo> sequences;
+  bool invalid_{false};
+};
+
+} // namespace mlir::pulse
+
+#endif // PULSE_SEQUENCE_DURATION_ANALYSIS_H
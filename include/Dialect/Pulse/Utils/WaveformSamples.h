@@ -0,0 +1,55 @@
+//===- WaveformSamples.h - Storage of waveform samples ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the storage of the samples of pulse.create_waveform
+///  ops as f64, f16 or i16 elements of a dense attribute or of a dense
+///  resource.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_WAVEFORM_SAMPLES_H
+#define PULSE_WAVEFORM_SAMPLES_H
+
+#include "mlir/IR/BuiltinAttributeInterfaces.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+namespace mlir::pulse {
+
+/// The element type of the stored samples of a waveform.
+enum class SampleFormat { F64, F16, I16 };
+
+/// The samples and scale of a pulse.create_waveform.
+struct WaveformSamples {
+  ElementsAttr samples;
+  // null if the default scale of the format applies
+  FloatAttr scale;
+};
+
+/// Store samples, interleaved as [real, imag] pairs, in format, in a dense
+/// resource rather than in a dense attribute if useResource. f16 samples
+/// are rounded to the nearest f16. Codes of i16 span the full scale [-1, 1],
+/// or [-m, m] with a scale of m / 32767 if the largest magnitude m of the
+/// samples is above 1.
+WaveformSamples storeSamples(MLIRContext *context,
+                             llvm::ArrayRef<double> samples,
+                             SampleFormat format, bool useResource);
+
+} // namespace mlir::pulse
+
+#endif // PULSE_WAVEFORM_SAMPLES_H
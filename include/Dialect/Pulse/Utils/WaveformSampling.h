@@ -0,0 +1,69 @@
+//===- WaveformSampling.h - Parametric waveform samples ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the evaluation of the samples of the parametric
+///  waveforms of the Pulse dialect.
+///
+///  Samples are written interleaved as [real, imag] pairs, the layout of the
+///  samples of pulse.create_waveform, so a waveform of duration dur fills
+///  2 * dur doubles. Sample k is evaluated at time k + 1/2 as in Qiskit
+///  Pulse, and the Gaussian edges are lifted to be zero one sample before
+///  the first and one sample after the last.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PULSE_WAVEFORM_SAMPLING_H
+#define PULSE_WAVEFORM_SAMPLING_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <complex>
+
+namespace mlir::pulse {
+
+/// Write the samples of pulse.const_waveform with amplitude amp.
+void sampleConstWaveform(std::complex<double> amp,
+                         llvm::MutableArrayRef<double> samples);
+
+/// Write the samples of pulse.gaussian with amplitude amp and standard
+/// deviation sigma, which must be positive.
+void sampleGaussianWaveform(std::complex<double> amp, double sigma,
+                            llvm::MutableArrayRef<double> samples);
+
+/// Write the samples of pulse.gaussian_square with amplitude amp, standard
+/// deviation sigma of its edges, which must be positive, and width of its
+/// flat top.
+void sampleGaussianSquareWaveform(std::complex<double> amp, double sigma,
+                                  double width,
+                                  llvm::MutableArrayRef<double> samples);
+
+/// Write the samples of pulse.drag with amplitude amp, standard deviation
+/// sigma, which must be positive, and derivative scale beta.
+void sampleDragWaveform(std::complex<double> amp, double sigma, double beta,
+                        llvm::MutableArrayRef<double> samples);
+
+/// Replace each of values with its exponential, using the vector kernel of
+/// the host. Values below the smallest normal exponent produce zero.
+void expInPlace(llvm::MutableArrayRef<double> values);
+
+/// Get the name of the vector kernel selected for the host, i.e., "avx2",
+/// "neon" or "scalar".
+llvm::StringRef getWaveformSamplingKernel();
+
+} // namespace mlir::pulse
+
+#endif // PULSE_WAVEFORM_SAMPLING_H
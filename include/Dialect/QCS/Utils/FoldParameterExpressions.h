@@ -0,0 +1,58 @@
+//===- FoldParameterExpressions.h - Fold parameter arithmetic ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass folding the arithmetic over parameters into
+///  parameters derived from them, which are evaluated when the arguments of
+///  the program are bound.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QCS_FOLD_PARAMETER_EXPRESSIONS_H
+#define QCS_FOLD_PARAMETER_EXPRESSIONS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::qcs {
+
+/// The angle and float arithmetic over parameters and constants, e.g., the
+/// theta / 2 + pi of a gate call, has the same result in every shot and for
+/// every program invocation with the same arguments. Replace the results of
+/// such computations with loads of parameters derived from the parameters
+/// they use, named by the expression computing them in the prefix form of
+/// the patch point expressions of the argument binder, e.g.,
+///
+///   qcs.declare_parameter @"(angle (add (div theta 2) 3.14...))"
+///
+/// so that the expression is evaluated once when the arguments are bound
+/// rather than by the controllers. The initial value of a derived parameter
+/// is that of the expression over the initial values of its parameters.
+struct FoldParameterExpressionsPass
+    : public PassWrapper<FoldParameterExpressionsPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numExpressionsFolded{
+      this, "num-expressions-folded",
+      "Number of parameter expressions folded into derived parameters"};
+}; // struct FoldParameterExpressionsPass
+} // namespace mlir::qcs
+
+#endif // QCS_FOLD_PARAMETER_EXPRESSIONS_H
@@ -0,0 +1,53 @@
+//===- HoistParameterLoads.h - Hoist parameters out of shots ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass hoisting the parameter loads of a shot loop,
+///  and the computations which only depend on them, in front of the loop.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QCS_HOIST_PARAMETER_LOADS_H
+#define QCS_HOIST_PARAMETER_LOADS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::qcs {
+
+/// The values of the parameters of a program are fixed when its arguments
+/// are bound, so a qcs.parameter_load in a shot loop loads the same value in
+/// every shot. Hoist the parameter loads of shot loops in front of them,
+/// along with the side-effect free operations of the shot body, e.g., angle
+/// and duration arithmetic, whose operands are all defined outside the loop,
+/// so that they are computed once rather than once per shot.
+struct HoistParameterLoadsPass
+    : public PassWrapper<HoistParameterLoadsPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numParameterLoadsHoisted{this, "num-parameter-loads-hoisted",
+                                     "Number of parameter loads hoisted"};
+  Statistic numOpsHoisted{
+      this, "num-ops-hoisted",
+      "Number of operations hoisted along with the parameter loads"};
+}; // struct HoistParameterLoadsPass
+} // namespace mlir::qcs
+
+#endif // QCS_HOIST_PARAMETER_LOADS_H
@@ -0,0 +1,59 @@
+//===- NarrowSynchronizations.h - Narrow qcs.synchronize ops ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass narrowing synchronizations to the qubits
+///  whose controllers depend on them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QCS_NARROW_SYNCHRONIZATIONS_H
+#define QCS_NARROW_SYNCHRONIZATIONS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::qcs {
+
+/// @brief Narrow each qcs.synchronize to the qubits whose controllers depend
+/// on it and erase the synchronizations no controller depends on.
+///
+/// A qubit no longer needs a synchronization if no operation in the block
+/// of the synchronization uses it, nested or through the results of its
+/// measurements, before a later synchronization of the same block covers
+/// it. The controllers of the qubits operated on in the regions of a
+/// qcs.parallel_control_flow only rendezvous with the others for the qubits
+/// they use after it. Synchronizations followed by calls whose qubits are
+/// not known are kept as is, as are synchronizations of all qubits which are
+/// not followed by another one in their block.
+struct NarrowSynchronizationsPass
+    : public PassWrapper<NarrowSynchronizationsPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numSynchronizationsEliminated{
+      this, "num-synchronizations-eliminated",
+      "Number of synchronizations erased"};
+  Statistic numSynchronizationsNarrowed{
+      this, "num-synchronizations-narrowed",
+      "Number of synchronizations narrowed to fewer qubits"};
+}; // struct NarrowSynchronizationsPass
+} // namespace mlir::qcs
+
+#endif // QCS_NARROW_SYNCHRONIZATIONS_H
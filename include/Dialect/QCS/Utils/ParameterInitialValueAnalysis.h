@@ -11,8 +11,11 @@
 /// This file defines a MLIR Analysis for parameter inputs which
 /// caches the initial_value of the input parameter
 ///
-/// Note: by default this analysis is always treated as valid unless
-/// the invalidate() method is called.
+/// Note: this analysis is invalidated by the passes which do not preserve
+/// it. Passes which add, modify or erase qcs.declare_parameter ops may keep
+/// it up to date with updateParameter() and eraseParameter(), or with a
+/// ParameterInitialValueAnalysis::Listener attached to their rewriter, and
+/// preserve it.
 ///
 //===----------------------------------------------------------------------===//
 
@@ -22,6 +25,7 @@
 #include "Dialect/QCS/IR/QCSOps.h"
 #include "HAL/SystemConfiguration.h"
 
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Pass/Pass.h"
 
@@ -46,9 +50,28 @@ private:
 public:
   ParameterInitialValueAnalysis(mlir::Operation *op);
   InitialValueType &getNames() { return initial_values_; }
+
+  /// Update the initial value of a parameter which was added or modified.
+  void updateParameter(DeclareParameterOp declareParameterOp);
+  /// Forget a parameter which was erased.
+  void eraseParameter(llvm::StringRef name) { initial_values_.erase(name); }
+
+  /// A rewriter listener which keeps the analysis up to date as top level
+  /// qcs.declare_parameter ops are inserted or erased.
+  class Listener : public RewriterBase::Listener {
+  public:
+    Listener(ParameterInitialValueAnalysis &analysis) : analysis(analysis) {}
+
+    void notifyOperationInserted(Operation *op) override;
+    void notifyOperationRemoved(Operation *op) override;
+
+  private:
+    ParameterInitialValueAnalysis &analysis;
+  };
+
   void invalidate() { invalid_ = true; }
   bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
-    return invalid_;
+    return invalid_ || !pa.isPreserved<ParameterInitialValueAnalysis>();
   }
 };
 
@@ -62,10 +85,6 @@ struct ParameterInitialValueAnalysisPass
   llvm::StringRef getName() const override;
 }; // struct ParameterInitialValueAnalysisPass
 
-// TODO: move registerQCSPasses to separate header if additional passes
-// are added to the QCS Dialect
-void registerQCSPasses();
-
 } // namespace mlir::qcs
 
 #endif // QCS_PARAMETER_INITIAL_VALUE_ANALYSIS_H
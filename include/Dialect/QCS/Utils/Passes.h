@@ -0,0 +1,30 @@
+//===- Passes.h - QCS Passes ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QCS_QCSPASSES_H
+#define QCS_QCSPASSES_H
+
+#include "FoldParameterExpressions.h"
+#include "HoistParameterLoads.h"
+#include "NarrowSynchronizations.h"
+#include "ParameterInitialValueAnalysis.h"
+
+namespace mlir::qcs {
+void registerQCSPasses();
+
+} // namespace mlir::qcs
+
+#endif // QCS_QCSPASSES_H
@@ -0,0 +1,64 @@
+//===- ShotLoop.h - Shot loop utilities -------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file declares utilities for the shot loop of a program, the scf.for
+/// with the qcs.shot_loop attribute which repeats the shot body, i.e., its
+/// body starting at its qcs.shot_init, once per shot.
+///
+/// The shot body is a single unit of compilation: passes and targets should
+/// compile it once and repeat it with the number of shots of its
+/// qcs.shot_init, e.g., as a hardware repeat count, rather than unroll the
+/// shot loop, so that compile time and payload size do not depend on the
+/// number of shots.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QCS_SHOT_LOOP_H
+#define QCS_SHOT_LOOP_H
+
+#include "Dialect/QCS/IR/QCSOps.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Operation.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace mlir::qcs {
+
+/// Return true if op is a shot loop.
+bool isShotLoop(Operation *op);
+
+/// Get the outermost shot loop nested in op, if any.
+scf::ForOp getShotLoop(Operation *op);
+
+/// Get the shot loop enclosing op, if any.
+scf::ForOp getEnclosingShotLoop(Operation *op);
+
+/// Get the qcs.shot_init anchoring the shot body of shotLoop, if any.
+ShotInitOp getShotInit(scf::ForOp shotLoop);
+
+/// Get the number of shots of shotLoop, i.e., the qcs.num_shots of its
+/// qcs.shot_init, if set.
+std::optional<uint32_t> getNumShots(scf::ForOp shotLoop);
+
+/// Set the number of shots of shotLoop, both as its trip count and as the
+/// qcs.num_shots of its qcs.shot_init.
+void setNumShots(scf::ForOp shotLoop, uint32_t numShots);
+
+} // namespace mlir::qcs
+
+#endif // QCS_SHOT_LOOP_H
@@ -54,6 +54,11 @@ static inline llvm::StringRef getDurationAttrName() {
   return "quir.durationValue";
 }
 
+// the measured execution counts of the regions of an scf.if or quir.switch
+static inline llvm::StringRef getBranchCountsAttrName() {
+  return "quir.branchCounts";
+}
+
 } // namespace mlir::quir
 
 #define GET_ATTRDEF_CLASSES
@@ -21,9 +21,9 @@
 #ifndef QUIR_QUIRINTERFACES_H
 #define QUIR_QUIRINTERFACES_H
 
-#include "mlir/IR/OpDefinition.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 
-#include <set>
+#include "mlir/IR/OpDefinition.h"
 
 //===----------------------------------------------------------------------===//
 // Operation Interface Types
@@ -36,33 +36,30 @@ namespace mlir::quir::interfaces_impl {
 //===----------------------------------------------------------------------===//
 
 /// Returns the nested qubits operated on within the operation.
-std::set<uint32_t> getOperatedQubits(mlir::Operation *op,
-                                     bool ignoreSelf = false);
+QubitSet getOperatedQubits(mlir::Operation *op, bool ignoreSelf = false);
 
 /// Get the next (lexographically) Qubit operation implementing this interface
 std::optional<Operation *> getNextQubitOp(Operation *op);
 
 /// @brief Get qubits that are shared between the two operations
-std::set<uint32_t> getSharedQubits(std::set<uint32_t> &first,
-                                   std::set<uint32_t> &second);
+QubitSet getSharedQubits(const QubitSet &first, const QubitSet &second);
 
 /// @brief Get qubits the union of the two qubit sets.
-std::set<uint32_t> getUnionQubits(std::set<uint32_t> &first,
-                                  std::set<uint32_t> &second);
+QubitSet getUnionQubits(const QubitSet &first, const QubitSet &second);
 
 /// @brief Get qubits that are shared between the two operations
-std::set<uint32_t> getSharedQubits(Operation *first, Operation *second);
+QubitSet getSharedQubits(Operation *first, Operation *second);
 
 /// @brief This operation shares qubits with another
 bool opsShareQubits(Operation *first, Operation *second);
 
 /// @brief Check if the qubit sets overlap
-bool qubitSetsOverlap(std::set<uint32_t> &first, std::set<uint32_t> &second);
+bool qubitSetsOverlap(const QubitSet &first, const QubitSet &second);
 
 /// @brief Get the qubits between two operations. Not including the operations
 /// themselves
-std::set<uint32_t> getQubitsBetweenOperations(mlir::Operation *first,
-                                              mlir::Operation *second);
+QubitSet getQubitsBetweenOperations(mlir::Operation *first,
+                                    mlir::Operation *second);
 
 } // namespace mlir::quir::interfaces_impl
 
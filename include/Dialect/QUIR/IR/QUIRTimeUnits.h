@@ -0,0 +1,110 @@
+//===- QUIRTimeUnits.h - QUIR time unit conversions -------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  Conversions between the time units of QUIR durations, specialized at
+///  compile time for each pair of units.
+///
+///  A value is converted through seconds, i.e., divided by the number of
+///  its units per second and multiplied by the number of target units per
+///  second, or multiplied and divided by dt for dt, exactly as
+///  DurationAttr::convertUnitsToUnits always did.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_QUIRTIMEUNITS_H
+#define QUIR_QUIRTIMEUNITS_H
+
+#include "Dialect/QUIR/IR/QUIREnums.h"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace mlir::quir {
+
+/// The number of TimeUnits.
+constexpr size_t numTimeUnits =
+    static_cast<size_t>(getMaxEnumValForTimeUnits()) + 1;
+
+/// Get the number of units per second for the units other than dt, whose
+/// length is only known at run time.
+constexpr double getUnitsPerSecond(TimeUnits units) {
+  switch (units) {
+  case TimeUnits::fs:
+    return 1.e15;
+  case TimeUnits::ps:
+    return 1.e12;
+  case TimeUnits::ns:
+    return 1.e9;
+  case TimeUnits::us:
+    return 1.e6;
+  case TimeUnits::ms:
+    return 1.e3;
+  case TimeUnits::dt:
+  case TimeUnits::s:
+    break;
+  }
+  return 1.;
+}
+
+/// Convert value from InputUnits to OutputUnits, where dt is the length of
+/// the scheduling timestep in seconds.
+template <TimeUnits InputUnits, TimeUnits OutputUnits>
+double convertTimeUnits(double value, double dt) {
+  if constexpr (InputUnits == OutputUnits)
+    return value;
+
+  double seconds = value;
+  if constexpr (InputUnits == TimeUnits::dt)
+    seconds = value * dt;
+  else if constexpr (InputUnits != TimeUnits::s)
+    seconds = value / getUnitsPerSecond(InputUnits);
+
+  if constexpr (OutputUnits == TimeUnits::dt)
+    return seconds / dt;
+  else if constexpr (OutputUnits != TimeUnits::s)
+    return seconds * getUnitsPerSecond(OutputUnits);
+  return seconds;
+}
+
+using TimeUnitsConversion = double (*)(double value, double dt);
+
+namespace detail {
+template <size_t... Indices>
+constexpr std::array<TimeUnitsConversion, sizeof...(Indices)>
+makeTimeUnitsConversionTable(std::index_sequence<Indices...>) {
+  return {&convertTimeUnits<static_cast<TimeUnits>(Indices / numTimeUnits),
+                            static_cast<TimeUnits>(Indices % numTimeUnits)>...};
+}
+} // namespace detail
+
+/// The specialized conversions, indexed by
+/// inputUnits * numTimeUnits + outputUnits.
+inline constexpr std::array<TimeUnitsConversion, numTimeUnits * numTimeUnits>
+    timeUnitsConversionTable = detail::makeTimeUnitsConversionTable(
+        std::make_index_sequence<numTimeUnits * numTimeUnits>());
+
+/// Get the specialized conversion from inputUnits to outputUnits.
+inline TimeUnitsConversion getTimeUnitsConversion(TimeUnits inputUnits,
+                                                  TimeUnits outputUnits) {
+  return timeUnitsConversionTable[static_cast<size_t>(inputUnits) *
+                                      numTimeUnits +
+                                  static_cast<size_t>(outputUnits)];
+}
+
+} // namespace mlir::quir
+
+#endif // QUIR_QUIRTIMEUNITS_H
@@ -0,0 +1,230 @@
+//===- QubitSet.h - Dense set of qubit ids ----------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the dense set of qubit ids operated on by QUIR
+///  operations
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_QUBITSET_H
+#define QUIR_QUBITSET_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/bit.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+
+namespace mlir::quir {
+
+/// @brief A set of qubit ids stored as a bitset. Sets of qubits with ids below
+/// 128 are stored inline, larger ids grow the bitset on the heap. Overlap,
+/// union and intersection operate word by word on the bitsets, which the
+/// compiler can vectorize, and iteration visits the ids in ascending order
+/// like std::set.
+class QubitSet {
+  using Word = uint64_t;
+  static constexpr unsigned bitsPerWord = 64;
+  static constexpr unsigned inlineWords = 2;
+
+public:
+  using value_type = uint32_t;
+  using size_type = size_t;
+
+  /// @brief Iterator over the ids of a set in ascending order.
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const uint32_t *;
+    using reference = uint32_t;
+
+    const_iterator() = default;
+
+    uint32_t operator*() const {
+      return wordIndex * bitsPerWord + llvm::countr_zero(remaining);
+    }
+
+    const_iterator &operator++() {
+      remaining &= remaining - 1;
+      advanceToSetBit();
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return wordIndex == other.wordIndex && remaining == other.remaining;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    friend class QubitSet;
+
+    const_iterator(const Word *words, size_t numWords, size_t wordIndex)
+        : words(words), numWords(numWords), wordIndex(wordIndex),
+          remaining(wordIndex < numWords ? words[wordIndex] : 0) {
+      advanceToSetBit();
+    }
+
+    void advanceToSetBit() {
+      while (!remaining && ++wordIndex < numWords)
+        remaining = words[wordIndex];
+      if (wordIndex >= numWords)
+        wordIndex = numWords;
+    }
+
+    const Word *words = nullptr;
+    size_t numWords = 0;
+    size_t wordIndex = 0;
+    Word remaining = 0;
+  };
+  using iterator = const_iterator;
+
+  QubitSet() = default;
+
+  QubitSet(std::initializer_list<uint32_t> ids) {
+    insert(ids.begin(), ids.end());
+  }
+
+  template <typename InputIt>
+  QubitSet(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(words.data(), words.size(), 0);
+  }
+  const_iterator end() const {
+    return const_iterator(words.data(), words.size(), words.size());
+  }
+
+  bool empty() const {
+    return std::all_of(words.begin(), words.end(),
+                       [](Word word) { return word == 0; });
+  }
+
+  size_t size() const {
+    size_t count = 0;
+    for (Word const word : words)
+      count += llvm::popcount(word);
+    return count;
+  }
+
+  bool contains(uint32_t id) const {
+    size_t const index = id / bitsPerWord;
+    return index < words.size() && (words[index] & bit(id));
+  }
+  size_t count(uint32_t id) const { return contains(id) ? 1 : 0; }
+
+  /// @brief Insert an id.
+  /// @return Whether the id was not in the set yet.
+  bool insert(uint32_t id) {
+    size_t const index = id / bitsPerWord;
+    if (index >= words.size())
+      words.resize(index + 1, 0);
+    bool const inserted = !(words[index] & bit(id));
+    words[index] |= bit(id);
+    return inserted;
+  }
+
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first)
+      insert(static_cast<uint32_t>(*first));
+  }
+
+  void insert(const QubitSet &other) { *this |= other; }
+
+  /// @brief Erase an id.
+  /// @return The number of ids erased.
+  size_t erase(uint32_t id) {
+    size_t const index = id / bitsPerWord;
+    if (index >= words.size() || !(words[index] & bit(id)))
+      return 0;
+    words[index] &= ~bit(id);
+    return 1;
+  }
+
+  void clear() { words.clear(); }
+
+  /// @brief Check whether this set and other share an id.
+  bool overlaps(const QubitSet &other) const {
+    size_t const numWords = std::min(words.size(), other.words.size());
+    Word shared = 0;
+    for (size_t i = 0; i < numWords; ++i)
+      shared |= words[i] & other.words[i];
+    return shared != 0;
+  }
+
+  QubitSet &operator|=(const QubitSet &other) {
+    if (other.words.size() > words.size())
+      words.resize(other.words.size(), 0);
+    for (size_t i = 0, e = other.words.size(); i < e; ++i)
+      words[i] |= other.words[i];
+    return *this;
+  }
+
+  QubitSet &operator&=(const QubitSet &other) {
+    if (words.size() > other.words.size())
+      words.resize(other.words.size());
+    for (size_t i = 0, e = words.size(); i < e; ++i)
+      words[i] &= other.words[i];
+    return *this;
+  }
+
+  friend QubitSet operator|(QubitSet lhs, const QubitSet &rhs) {
+    lhs |= rhs;
+    return lhs;
+  }
+
+  friend QubitSet operator&(QubitSet lhs, const QubitSet &rhs) {
+    lhs &= rhs;
+    return lhs;
+  }
+
+  bool operator==(const QubitSet &other) const {
+    size_t const numWords = std::max(words.size(), other.words.size());
+    for (size_t i = 0; i < numWords; ++i)
+      if (wordAt(i) != other.wordAt(i))
+        return false;
+    return true;
+  }
+  bool operator!=(const QubitSet &other) const { return !(*this == other); }
+
+private:
+  static Word bit(uint32_t id) { return Word{1} << (id % bitsPerWord); }
+
+  Word wordAt(size_t index) const {
+    return index < words.size() ? words[index] : 0;
+  }
+
+  llvm::SmallVector<Word, inlineWords> words;
+};
+
+} // namespace mlir::quir
+
+#endif // QUIR_QUBITSET_H
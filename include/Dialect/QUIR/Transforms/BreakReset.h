@@ -28,17 +28,23 @@ namespace mlir::quir {
 
 /// This pass converts input ResetQubitOps to a parameterized number of
 /// measure and the conditionally called x gates, as well as an optional delay.
+/// The qubits of a parallel reset, e.g., as merged by
+/// MergeResetsTopologicalPass, share the measure and the delay of each
+/// iteration.
 struct BreakResetPass
     : public mlir::PassWrapper<BreakResetPass,
                                mlir::OperationPass<mlir::ModuleOp>> {
   BreakResetPass() = default;
   BreakResetPass(const BreakResetPass &pass) : PassWrapper(pass) {}
-  BreakResetPass(uint inNumIterations, uint inDelayCycles) {
+  BreakResetPass(uint inNumIterations, uint inDelayCycles,
+                 bool inBatchCorrections = false) {
     numIterations = inNumIterations;
     delayCycles = inDelayCycles;
+    batchCorrections = inBatchCorrections;
   }
 
   void runOnOperation() override;
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
   Option<uint> numIterations{
       *this, "numIterations",
       llvm::cl::desc(
@@ -49,6 +55,12 @@ struct BreakResetPass
       llvm::cl::desc("Number of cycles of delay to add between reset "
                      "iterations, default is 1000"),
       llvm::cl::value_desc("num"), llvm::cl::init(1000)};
+  Option<bool> batchCorrections{
+      *this, "batchCorrections",
+      llvm::cl::desc("Nest the conditional x gates of each iteration of a "
+                     "parallel reset in a single branch taken only if any "
+                     "qubit measured 1, default is false"),
+      llvm::cl::init(false)};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
@@ -0,0 +1,119 @@
+//===- CacheFunctions.h - Cache optimized functions -------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for running a pipeline on the functions and
+///  circuits of a module, reusing the results of the compilations of the
+///  process for the functions and circuits they already optimized.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_CACHE_FUNCTIONS_H
+#define QUIR_CACHE_FUNCTIONS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace mlir::quir {
+
+/// A thread safe cache of the functions and circuits optimized by the
+/// compilations of a process, each kept as the MLIR bytecode of a module
+/// holding it and keyed on the pipeline which optimized it and its
+/// contents before. The cache is emptied once it holds more than
+/// maxBytes of bytecode.
+class FunctionCache {
+public:
+  static constexpr size_t maxBytes = 64 * 1024 * 1024;
+
+  /// Get the cache shared by all compilations of the process.
+  static FunctionCache &global();
+
+  /// Get the bytecode of the optimized function of key, if cached.
+  std::shared_ptr<const std::string> lookup(llvm::StringRef key);
+
+  /// Cache the bytecode of the optimized function of key.
+  void insert(llvm::StringRef key, std::string bytecode);
+
+  /// Get the number of cached functions.
+  size_t size();
+
+  /// Drop all cached functions.
+  void clear();
+
+private:
+  std::mutex mutex;
+  llvm::StringMap<std::shared_ptr<const std::string>> entries;
+  size_t numBytes = 0;
+};
+
+/// @brief Run a pipeline of function passes, e.g., canonicalize, on each
+/// func.func and quir.circuit of the module other than main, replacing the
+/// functions and circuits which an earlier run of the process already
+/// optimized with the same pipeline by its result. Functions are identified
+/// by their printed form without locations, which includes their symbol
+/// name, so that programs which share subroutines and gate definitions but
+/// differ in main only optimize them once. The operations of a cached
+/// function are located at the function they replace.
+///
+/// The result of the pipeline must only depend on the function it runs on,
+/// as the pipeline does not run again on the functions and circuits found
+/// in the cache.
+struct CacheFunctionsPass
+    : public PassWrapper<CacheFunctionsPass, OperationPass<ModuleOp>> {
+  CacheFunctionsPass() = default;
+  CacheFunctionsPass(const CacheFunctionsPass &pass) : PassWrapper(pass) {}
+
+  LogicalResult initialize(MLIRContext *context) override;
+  void getDependentDialects(DialectRegistry &registry) const override;
+  void runOnOperation() override;
+
+  Option<std::string> pipeline{
+      *this, "pipeline",
+      llvm::cl::desc("The pass pipeline to run on each function and "
+                     "circuit, default is canonicalize"),
+      llvm::cl::init("canonicalize")};
+
+  Statistic numCacheHits{this, "num-cache-hits",
+                         "Number of functions and circuits read from the "
+                         "cache"};
+  Statistic numCacheMisses{this, "num-cache-misses",
+                           "Number of functions and circuits optimized"};
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+private:
+  // the pipeline nested on func.func and quir.circuit, parsed when the pass
+  // is initialized
+  std::optional<OpPassManager> funcPipeline;
+  std::optional<OpPassManager> circuitPipeline;
+}; // struct CacheFunctionsPass
+} // namespace mlir::quir
+
+#endif // QUIR_CACHE_FUNCTIONS_H
@@ -30,6 +30,12 @@
 
 namespace mlir::quir {
 
+/// Convert the quir.constant durations nested in op to targetUnits in place,
+/// converting each distinct duration once, and return the number of
+/// constants converted. The users of the constants are not updated.
+unsigned convertDurationConstants(Operation *op, TimeUnits targetUnits,
+                                  double dtTimestep);
+
 /// @brief This pass will convert all standard usage of durations
 /// within QUIR to the input target units. It is useful for canonicalizing
 /// durations within a program to uniform base unit such as the target
@@ -67,6 +73,9 @@ struct ConvertDurationUnitsPass
                      "Defaults to 1s."),
       llvm::cl::value_desc("num"), llvm::cl::init(1.)};
 
+  Statistic numDurationsConverted{this, "num-durations-converted",
+                                  "Number of duration constants converted"};
+
   void runOnOperation() override;
 
   virtual TimeUnits getTargetConvertUnits() const;
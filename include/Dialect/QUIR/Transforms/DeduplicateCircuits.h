@@ -0,0 +1,46 @@
+//===- DeduplicateCircuits.h - Share identical circuits ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for replacing the circuits which are
+///  structurally identical to an earlier circuit by that circuit.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_DEDUPLICATE_CIRCUITS_H
+#define QUIR_DEDUPLICATE_CIRCUITS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::quir {
+
+/// @brief Redirect the uses of each circuit to the first circuit of the
+/// module with the same type, attributes other than its symbol name, and
+/// body up to the renaming of values, and erase it.
+struct DeduplicateCircuitsPass
+    : public PassWrapper<DeduplicateCircuitsPass, OperationPass<ModuleOp>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numCircuitsDeduplicated{this, "num-circuits-deduplicated",
+                                    "Number of duplicate circuits erased"};
+}; // struct DeduplicateCircuitsPass
+} // namespace mlir::quir
+
+#endif // QUIR_DEDUPLICATE_CIRCUITS_H
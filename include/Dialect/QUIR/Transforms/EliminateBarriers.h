@@ -0,0 +1,51 @@
+//===- EliminateBarriers.h - Erase and narrow QUIR barriers -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass erasing the barriers which do not constrain
+///  the operations after them and narrowing the others.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_ELIMINATE_BARRIERS_H
+#define QUIR_ELIMINATE_BARRIERS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// @brief Erase the quir.barrier which do not delay any operation, e.g.,
+/// those on a single qubit or next to another barrier or a
+/// qcs.synchronize of all their qubits, and narrow the others to the
+/// qubits they delay, see eliminateBarriers. Operations whose qubits are
+/// not known, e.g., calls of subroutines, use all qubits.
+struct EliminateBarriersPass
+    : public PassWrapper<EliminateBarriersPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numBarriersErased{this, "num-barriers-erased",
+                              "Number of barriers erased"};
+  Statistic numBarriersNarrowed{this, "num-barriers-narrowed",
+                                "Number of barriers narrowed to fewer qubits"};
+}; // struct EliminateBarriersPass
+} // namespace mlir::quir
+
+#endif // QUIR_ELIMINATE_BARRIERS_H
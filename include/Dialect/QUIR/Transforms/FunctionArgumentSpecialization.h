@@ -24,28 +24,48 @@
 #define QUIR_FUNCTION_ARGUMENT_SPECIALIZATION_H
 
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
+
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
 
-#include <deque>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <utility>
 
 namespace mlir::quir {
 struct FunctionArgumentSpecializationPass
     : public PassWrapper<FunctionArgumentSpecializationPass, OperationPass<>> {
 
+  /// The calls to process, in the order they are found.
+  using CallWorkList = llvm::SmallVector<Operation *>;
+
   template <class CallOpTy>
-  void processCallOp(Operation *op, std::deque<Operation *> &callWorkList);
+  void processCallOp(Operation *op, CallWorkList &callWorkList);
 
   template <class T1, class T2, class... Rest>
-  void processCallOp(Operation *op, std::deque<Operation *> &callWorkList);
+  void processCallOp(Operation *op, CallWorkList &callWorkList);
 
   template <class CallOpTy>
   void copyFuncAndSpecialize(mlir::func::FuncOp inFunc, CallOpTy callOp,
-                             std::deque<Operation *> &callWorkList);
+                             CallWorkList &callWorkList);
+
+  /// Add the calls in a function to the work list, once per function.
+  void addCallsOf(mlir::func::FuncOp funcOp, CallWorkList &callWorkList);
 
   void runOnOperation() override;
 
+  SymbolIndexAnalysis *symbolIndex = nullptr;
+  /// The specialization of each callee for the type of its calls, so that
+  /// calls with the same types reuse it without naming and looking it up.
+  llvm::DenseMap<std::pair<Operation *, Type>, FlatSymbolRefAttr>
+      specializations;
+  /// The functions whose calls were added to the work list.
+  llvm::SmallPtrSet<Operation *, 16> visitedFuncs;
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
@@ -0,0 +1,57 @@
+//===- FuseSingleQubitGates.h - Fuse single qubit gates ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for fusing the runs of single qubit gates
+///  with known angles into a single quir.builtin_U.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_FUSE_SINGLE_QUBIT_GATES_H
+#define QUIR_FUSE_SINGLE_QUBIT_GATES_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// @brief Fuse the runs of single qubit gates with constant angles on the
+/// same qubit into a single quir.builtin_U, erasing the runs which compose
+/// to the identity, and cancel the pairs of consecutive quir.builtin_CX on
+/// the same control and target. A quir.call_gate is part of a run only if
+/// the body of its gate is nothing but quir.builtin_U of its qubit, as
+/// gates without body are defined by their calibrations. Runs end at the
+/// other operations on their qubit, and at operations with regions or side
+/// effects.
+struct FuseSingleQubitGatesPass
+    : public PassWrapper<FuseSingleQubitGatesPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+  Statistic numGatesFused{this, "num-gates-fused",
+                          "Number of single qubit gates fused"};
+  Statistic numGatesErased{
+      this, "num-gates-erased",
+      "Number of gates erased as their run composes to the identity"};
+  Statistic numCXCancelled{this, "num-cx-cancelled",
+                           "Number of pairs of CX gates cancelled"};
+}; // struct FuseSingleQubitGatesPass
+} // namespace mlir::quir
+
+#endif // QUIR_FUSE_SINGLE_QUBIT_GATES_H
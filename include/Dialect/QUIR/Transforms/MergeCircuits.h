@@ -23,15 +23,22 @@
 #define QUIR_MERGE_CIRCUITS_H
 
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/GreedyRewrite.h"
 
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+
 namespace mlir::quir {
 
 /// @brief Merge together back to back circuits into a single circuit
 struct MergeCircuitsPass
     : public PassWrapper<MergeCircuitsPass, OperationPass<>> {
+  MergeCircuitsPass() = default;
+  MergeCircuitsPass(const MergeCircuitsPass &pass) : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
   static CircuitOp getCircuitOp(CallCircuitOp callCircuitOp,
@@ -40,10 +47,37 @@ struct MergeCircuitsPass
   mergeCallCircuits(PatternRewriter &rewriter, CallCircuitOp callCircuitOp,
                     CallCircuitOp nextCallCircuitOp,
                     llvm::StringMap<Operation *> *symbolMap);
+  /// @brief Replace adjacent call_circuits with a single call to a new
+  /// circuit built from their circuits in order, cloning each circuit once.
+  /// @return The new call_circuit, placed after the last of callCircuitOps.
+  static CallCircuitOp
+  mergeCallCircuits(RewriterBase &rewriter,
+                    llvm::ArrayRef<CallCircuitOp> callCircuitOps,
+                    llvm::StringMap<Operation *> *symbolMap);
+
+  Option<bool> singleSweep{
+      *this, "single-sweep",
+      llvm::cl::desc("Merge each maximal run of mergeable circuits of a block "
+                     "at once instead of merging pairs of circuits with "
+                     "repeated greedy rewrites, default is false"),
+      llvm::cl::init(false)};
+  GreedyRewriteOptions rewriteOptions{*this,
+                                      /*regionSimplificationDefault=*/false};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+  GreedyRewriteStatistics rewriteStatistics{*this};
+  Statistic numCircuitAndCircuitMerges{
+      this, "num-circuit-and-circuit-merges",
+      "Number of applications of the circuit and circuit pattern"};
+  Statistic numBarrierAndCircuitMoves{
+      this, "num-barrier-and-circuit-moves",
+      "Number of applications of the barrier and circuit pattern"};
+  Statistic numCircuitAndBarrierMoves{
+      this, "num-circuit-and-barrier-moves",
+      "Number of applications of the circuit and barrier pattern"};
 }; // struct MergeCircuitsPass
 } // namespace mlir::quir
 #endif // QUIR_MERGE_CIRCUITS_H
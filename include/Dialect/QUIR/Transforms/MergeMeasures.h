@@ -22,30 +22,68 @@
 #ifndef QUIR_MERGE_MEASURES_H
 #define QUIR_MERGE_MEASURES_H
 
+#include "Dialect/QUIR/Utils/GreedyRewrite.h"
+
 #include "mlir/Pass/Pass.h"
 
 namespace mlir::quir {
 
 /// @brief Merge together measures in a circuit that are lexicographically
-/// adjacent into a single variadic measurement.
+/// adjacent into a single variadic measurement. Each run of mergeable
+/// measures is merged at once, into measurements of at most max-width
+/// qubits.
 struct MergeMeasuresLexographicalPass
     : public PassWrapper<MergeMeasuresLexographicalPass, OperationPass<>> {
+  MergeMeasuresLexographicalPass() = default;
+  MergeMeasuresLexographicalPass(const MergeMeasuresLexographicalPass &pass)
+      : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
+  GreedyRewriteOptions rewriteOptions{*this,
+                                      /*regionSimplificationDefault=*/false};
+  Option<unsigned> maxWidth{
+      *this, "max-width",
+      llvm::cl::desc("Maximum number of qubits of a merged measurement, "
+                     "e.g., the readout multiplexing ratio, 0 for no limit"),
+      llvm::cl::init(0)};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+  GreedyRewriteStatistics rewriteStatistics{*this};
+  Statistic numMeasuresMerged{this, "num-measures-merged",
+                              "Number of groups of measurements merged"};
 }; // struct MergeMeasuresLexographicalPass
 
 /// @brief Merge together measures in a circuit that are topologically
-/// adjacent into a single variadic measurement.
+/// adjacent into a single variadic measurement. Each run of mergeable
+/// measures is merged at once, into measurements of at most max-width
+/// qubits.
 struct MergeMeasuresTopologicalPass
     : public PassWrapper<MergeMeasuresTopologicalPass, OperationPass<>> {
+  MergeMeasuresTopologicalPass() = default;
+  MergeMeasuresTopologicalPass(const MergeMeasuresTopologicalPass &pass)
+      : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
+  GreedyRewriteOptions rewriteOptions{*this,
+                                      /*regionSimplificationDefault=*/false};
+  Option<unsigned> maxWidth{
+      *this, "max-width",
+      llvm::cl::desc("Maximum number of qubits of a merged measurement, "
+                     "e.g., the readout multiplexing ratio, 0 for no limit"),
+      llvm::cl::init(0)};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+  GreedyRewriteStatistics rewriteStatistics{*this};
+  Statistic numMeasuresMerged{this, "num-measures-merged",
+                              "Number of groups of measurements merged"};
 }; // struct MergeMeasuresTopologicalPass
 
 } // namespace mlir::quir
@@ -0,0 +1,60 @@
+//===- PackCircuits.h - Pack independent circuits ---------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for packing the independent circuits of a
+///  block into wider circuits.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_PACK_CIRCUITS_H
+#define QUIR_PACK_CIRCUITS_H
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// @brief Pack the call_circuits on disjoint qubits which do not depend on
+/// each other into single calls of wider circuits. Unlike merge-circuits,
+/// which merges circuits in program order, the calls of a block are placed
+/// in a graph of their dependencies through qubits, values and side effects
+/// and the calls at the same depth of the graph are packed, up to max-width
+/// qubits per packed circuit. The operations of the block are reordered as
+/// little as possible to make the packed calls adjacent. Control flow and
+/// quantum operations on unknown qubits are not crossed.
+struct PackCircuitsPass
+    : public PassWrapper<PackCircuitsPass, OperationPass<>> {
+  PackCircuitsPass() = default;
+  PackCircuitsPass(const PackCircuitsPass &pass) : PassWrapper(pass) {}
+
+  void runOnOperation() override;
+
+  Option<unsigned> maxWidth{
+      *this, "max-width",
+      llvm::cl::desc("The maximum number of qubits of a packed circuit, 0 "
+                     "for no limit, default is 0"),
+      llvm::cl::init(0)};
+
+  Statistic numCircuitsPacked{this, "num-circuits-packed",
+                              "Number of call_circuits packed into others"};
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct PackCircuitsPass
+} // namespace mlir::quir
+#endif // QUIR_PACK_CIRCUITS_H
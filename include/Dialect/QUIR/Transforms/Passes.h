@@ -21,13 +21,19 @@
 #include "AngleConversion.h"
 #include "BreakReset.h"
 #include "ConvertDurationUnits.h"
+#include "DeduplicateCircuits.h"
+#include "EliminateBarriers.h"
 #include "FunctionArgumentSpecialization.h"
+#include "FuseSingleQubitGates.h"
 #include "LoadElimination.h"
 #include "MergeCircuits.h"
 #include "MergeMeasures.h"
 #include "MergeParallelResets.h"
+#include "PackCircuits.h"
+#include "PipelineShotLoop.h"
 #include "QuantumDecoration.h"
 #include "RemoveQubitOperands.h"
+#include "RemoveUnusedQubits.h"
 #include "ReorderCircuits.h"
 #include "ReorderMeasurements.h"
 #include "SubroutineCloning.h"
@@ -45,10 +51,10 @@ void registerQuirPassPipeline();
 
 // This pass recurses through the IR and detects when scf
 // ops use only classical operations. It then applies the classicalOnly
-// attribute to all of the scf ops with a value of either true or false
+// attribute to all of the scf ops with a value of either true or false, as
+// computed by ClassicalOnlyAnalysis
 struct ClassicalOnlyDetectionPass
     : public PassWrapper<ClassicalOnlyDetectionPass, OperationPass<>> {
-  auto hasQuantumSubOps(Operation *inOp) -> bool;
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
@@ -0,0 +1,62 @@
+//===- PipelineShotLoop.h - Overlap shots with their tails ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the pass for overlapping the classical tail of each
+//  shot with the shot delay of the next one
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_PIPELINE_SHOT_LOOP_H
+#define QUIR_PIPELINE_SHOT_LOOP_H
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::quir {
+
+/// @brief Software pipeline the shot loops, i.e., the scf.for loops with
+/// the qcs.shot_loop attribute, so that the classical work following the
+/// last quantum operation of a shot, e.g., assigning its results and
+/// sending them, runs while the shot delay before the next shot elapses
+/// rather than ahead of it.
+///
+/// The shot delays, the quir.delay ops on all qubits and the
+/// qcs.delay_cycles ops ahead of the qcs.shot_init of the shot body, are
+/// moved after its last quantum operation, i.e., they delay the next shot
+/// rather than the current one, and a copy of them delays the first shot
+/// ahead of the loop. The shot delays are only moved if their durations do
+/// not depend on the shot, i.e., on values computed in the shot body other
+/// than constants, and the operations after the last quantum operation
+/// neither take time on the target nor operate on qubits.
+struct PipelineShotLoopPass
+    : public PassWrapper<PipelineShotLoopPass, OperationPass<>> {
+  void runOnOperation() override;
+
+  Statistic numPipelinedLoops{this, "num-pipelined-loops",
+                              "Number of shot loops pipelined"};
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+private:
+  /// Move the shot delays of shotLoop after its last quantum operation.
+  /// @return Whether shotLoop was pipelined.
+  bool pipelineShotLoop(mlir::scf::ForOp shotLoop);
+}; // struct PipelineShotLoopPass
+} // namespace mlir::quir
+
+#endif // QUIR_PIPELINE_SHOT_LOOP_H
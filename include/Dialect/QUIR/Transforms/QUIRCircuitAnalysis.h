@@ -11,6 +11,10 @@
 /// This file implements an analysis for caching argument attributes with
 /// default values for angle and duration arguments.
 ///
+/// The attributes of the operands of the calls to a circuit are only
+/// evaluated when first queried, and are stored contiguously per circuit,
+/// indexed by argument number. Queries are not thread safe.
+///
 //===----------------------------------------------------------------------===//
 
 #ifndef QUIR_CIRCUITS_ANALYSIS_H
@@ -21,10 +25,15 @@
 #include "Dialect/QUIR/IR/QUIROps.h"
 
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+
+#include <optional>
 #include <tuple>
+#include <vector>
 
 namespace mlir::quir {
 
@@ -33,23 +42,55 @@ enum QUIRCircuitAnalysisEntry { ANGLE = 0, PARAMETER_NAME, DURATION };
 using OperandAttributes =
     std::tuple<double, llvm::StringRef, mlir::quir::DurationAttr>;
 
-using CircuitAnalysisMap = std::unordered_map<
-    mlir::Operation *,
-    std::unordered_map<mlir::Operation *,
-                       std::unordered_map<int, OperandAttributes>>>;
-
 class QUIRCircuitAnalysis {
 private:
-  CircuitAnalysisMap circuitOperands;
+  /// The last call to a circuit, and the start of the attributes of its
+  /// operands in operandAttributes once queried.
+  struct CircuitEntry {
+    Operation *callCircuitOp;
+    std::optional<unsigned> operandsBegin;
+  };
+
+  llvm::DenseMap<Operation *, CircuitEntry> circuits;
+  std::vector<std::optional<OperandAttributes>> operandAttributes;
+  mlir::qcs::ParameterInitialValueAnalysis *nameAnalysis{nullptr};
   bool invalid_{true};
 
 public:
   QUIRCircuitAnalysis(mlir::Operation *op, AnalysisManager &am);
-  CircuitAnalysisMap &getAnalysisMap() { return circuitOperands; }
+
+  /// Get the attributes of the operand of the last call to circuitOp passed
+  /// as argument argNum, i.e., its angle value and parameter name if it is
+  /// an angle, or its duration if it is a duration, and default values
+  /// otherwise.
+  OperandAttributes getOperandAttributes(CircuitOp circuitOp, unsigned argNum);
+
+  /// Record callCircuitOp as the last call to its circuit.
+  void updateCall(CallCircuitOp callCircuitOp);
+  /// Forget the attributes of the operands of the last call to circuitOp,
+  /// e.g., after that call was modified in place.
+  void invalidateCircuit(CircuitOp circuitOp);
+  /// Forget the circuits and calls nested in op, which is being erased.
+  void eraseNested(Operation *op);
+
+  /// A rewriter listener which keeps the analysis up to date as circuits
+  /// and calls to circuits are inserted or erased.
+  class Listener : public RewriterBase::Listener {
+  public:
+    Listener(QUIRCircuitAnalysis &analysis) : analysis(analysis) {}
+
+    void notifyOperationInserted(Operation *op) override;
+    void notifyOperationRemoved(Operation *op) override;
+
+  private:
+    QUIRCircuitAnalysis &analysis;
+  };
 
   void invalidate() { invalid_ = true; }
   bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) {
-    return invalid_;
+    // the operand attributes depend on the parameter initial values
+    return invalid_ || !pa.isPreserved<QUIRCircuitAnalysis>() ||
+           !pa.isPreserved<mlir::qcs::ParameterInitialValueAnalysis>();
   }
 
 private:
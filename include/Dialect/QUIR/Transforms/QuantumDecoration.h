@@ -23,9 +23,11 @@
 #define QUIR_QUANTUM_DECORATION_H
 
 #include "Dialect/QUIR/IR/QUIROps.h"
-#include "mlir/Pass/Pass.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 
-#include <unordered_set>
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
 
 namespace mlir {
 class ModuleOp;
@@ -34,19 +36,41 @@ class ModuleOp;
 namespace mlir::quir {
 struct QuantumDecorationPass
     : public PassWrapper<QuantumDecorationPass, OperationPass<ModuleOp>> {
+  /// The qubits operated on by an op and the ops nested in it, along with
+  /// whether any qubit could not be resolved to an id, which is decorated
+  /// as -1.
+  struct QubitFootprint {
+    QubitSet ids;
+    bool unresolved = false;
+
+    void insert(Value qubit);
+    QubitFootprint &operator|=(const QubitFootprint &other) {
+      ids |= other.ids;
+      unresolved |= other.unresolved;
+      return *this;
+    }
+  };
+
   // TODO: Add a mechanism to get the qubit arguments for any qubit-using op
   // using a standard interface, so this can be simplified to a single function
-  void processOp(Operation *op, std::unordered_set<int> &retSet);
-  void processOp(BuiltinCXOp op, std::unordered_set<int> &retSet);
-  void processOp(Builtin_UOp op, std::unordered_set<int> &retSet);
-  void processOp(CallDefCalGateOp op, std::unordered_set<int> &retSet);
-  void processOp(CallDefcalMeasureOp op, std::unordered_set<int> &retSet);
-  void processOp(DelayOp op, std::unordered_set<int> &retSet);
-  void processOp(CallGateOp op, std::unordered_set<int> &retSet);
-  void processOp(BarrierOp op, std::unordered_set<int> &retSet);
-  void processOp(MeasureOp op, std::unordered_set<int> &retSet);
-  void processOp(ResetQubitOp op, std::unordered_set<int> &retSet);
-  void processOp(CallCircuitOp op, std::unordered_set<int> &retSet);
+  void processOp(Operation *op, QubitFootprint &footprint);
+  void processOp(BuiltinCXOp op, QubitFootprint &footprint);
+  void processOp(Builtin_UOp op, QubitFootprint &footprint);
+  void processOp(CallDefCalGateOp op, QubitFootprint &footprint);
+  void processOp(CallDefcalMeasureOp op, QubitFootprint &footprint);
+  void processOp(DelayOp op, QubitFootprint &footprint);
+  void processOp(CallGateOp op, QubitFootprint &footprint);
+  void processOp(BarrierOp op, QubitFootprint &footprint);
+  void processOp(MeasureOp op, QubitFootprint &footprint);
+  void processOp(ResetQubitOp op, QubitFootprint &footprint);
+  void processOp(CallCircuitOp op, QubitFootprint &footprint);
+
+  /// Decorate op and the ops nested in it in post-order, so that the
+  /// footprint of each op with regions is the union of the footprints of
+  /// its nested ops, each of which is collected once.
+  /// @return The footprint of op.
+  QubitFootprint decorate(Operation *op, OpBuilder &build);
+
   void runOnOperation() override;
 
   llvm::StringRef getArgument() const override;
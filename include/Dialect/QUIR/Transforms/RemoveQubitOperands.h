@@ -27,7 +27,9 @@
 #include <unordered_set>
 
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
@@ -39,13 +41,18 @@ struct RemoveQubitOperandsPass
     : public PassWrapper<RemoveQubitOperandsPass, OperationPass<>> {
   auto lookupQubitId(const Value val) -> int;
   void addQubitDeclarations(mlir::func::FuncOp funcOp);
-  void processCallOp(Operation *op);
+  /// Enqueue the subroutines called from op which are not yet processed.
+  void enqueueCallees(Operation *op);
+  /// Remove the qubit arguments of a subroutine and the matching operands of
+  /// all of its callers.
+  void processFuncOp(Operation *op, SymbolUserMap &symbolUsers);
   void runOnOperation() override;
 
-  std::deque<Operation *> callWorkList;
+  std::deque<Operation *> funcWorkList;
   std::unordered_set<Operation *> clonedFuncs;
   std::unordered_set<Operation *> alreadyProcessed;
   Operation *moduleOperation;
+  SymbolIndexAnalysis *symbolIndex;
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
@@ -0,0 +1,70 @@
+//===- RemoveUnusedQubits.h - Remove unused qubits --------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass for removing the declarations of unused
+///  qubits and, optionally, the operations on otherwise idle qubits.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_REMOVE_UNUSED_QUBITS_H
+#define QUIR_REMOVE_UNUSED_QUBITS_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir::quir {
+
+/// @brief Remove the declarations of the physical qubits which no operation
+/// uses, e.g., of a program declaring all the qubits of a device, so that
+/// qubit localization does not create the modules of their instruments. The
+/// declarations of a qubit are removed only if none of the declarations of
+/// its id in the module is used, e.g., once subroutine cloning and
+/// remove-qubit-args declared the qubit in its subroutines. With
+/// remove-idle-operations, the resets, delays and barriers of a qubit which
+/// no other operation uses are removed along with its declarations. An
+/// operation left without qubits is erased rather than applied to all
+/// qubits.
+struct RemoveUnusedQubitsPass
+    : public PassWrapper<RemoveUnusedQubitsPass, OperationPass<ModuleOp>> {
+  RemoveUnusedQubitsPass() = default;
+  RemoveUnusedQubitsPass(const RemoveUnusedQubitsPass &pass)
+      : PassWrapper(pass) {}
+  RemoveUnusedQubitsPass(bool removeIdle) : PassWrapper() {
+    removeIdleOperations = removeIdle;
+  }
+
+  void runOnOperation() override;
+
+  Option<bool> removeIdleOperations{
+      *this, "remove-idle-operations",
+      llvm::cl::desc("Also remove the resets, delays and barriers of qubits "
+                     "which no other operation uses, default is false"),
+      llvm::cl::init(false)};
+
+  Statistic numQubitsRemoved{this, "num-qubits-removed",
+                             "Number of physical qubits removed"};
+  Statistic numOperationsRemoved{
+      this, "num-operations-removed",
+      "Number of operations removed from idle qubits"};
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct RemoveUnusedQubitsPass
+} // namespace mlir::quir
+#endif // QUIR_REMOVE_UNUSED_QUBITS_H
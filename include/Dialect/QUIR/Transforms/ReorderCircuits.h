@@ -28,8 +28,19 @@ namespace mlir::quir {
 /// @brief Move call_circuits when possible
 struct ReorderCircuitsPass
     : public PassWrapper<ReorderCircuitsPass, OperationPass<>> {
+  ReorderCircuitsPass() = default;
+  ReorderCircuitsPass(const ReorderCircuitsPass &pass) : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
+  Option<bool> listSchedule{
+      *this, "list-schedule",
+      llvm::cl::desc("List schedule the operations of each block from their "
+                     "dependences, starting each as soon as possible, rather "
+                     "than moving stores ahead of call_circuits one at a "
+                     "time"),
+      llvm::cl::init(true)};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
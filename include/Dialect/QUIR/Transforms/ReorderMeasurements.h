@@ -21,6 +21,8 @@
 #ifndef QUIR_REORDER_MEASURES_H
 #define QUIR_REORDER_MEASURES_H
 
+#include "Dialect/QUIR/Utils/GreedyRewrite.h"
+
 #include "mlir/Pass/Pass.h"
 
 namespace mlir::quir {
@@ -28,11 +30,23 @@ namespace mlir::quir {
 /// @brief Move measures in a circuit to be as late as possible topologically
 struct ReorderMeasurementsPass
     : public PassWrapper<ReorderMeasurementsPass, OperationPass<>> {
+  ReorderMeasurementsPass() = default;
+  ReorderMeasurementsPass(const ReorderMeasurementsPass &pass)
+      : PassWrapper(pass) {}
+
   void runOnOperation() override;
 
+  GreedyRewriteOptions rewriteOptions{*this,
+                                      /*regionSimplificationDefault=*/false};
+
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+  GreedyRewriteStatistics rewriteStatistics{*this};
+  Statistic numMeasuresReordered{
+      this, "num-measures-reordered",
+      "Number of operations moved ahead of measurements"};
 }; // struct ReorderMeasurementsPass
 
 } // namespace mlir::quir
@@ -25,11 +25,20 @@
 #ifndef QUIR_SUBROUTINE_CLONING_H
 #define QUIR_SUBROUTINE_CLONING_H
 
-#include <deque>
-#include <unordered_set>
-
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Value.h"
 #include "mlir/Pass/Pass.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace mlir {
 class Operation;
 } // namespace mlir
@@ -38,24 +47,60 @@ namespace mlir::quir {
 
 using SymbolOpMap = llvm::StringMap<Operation *>;
 
+/// A specialization of a subroutine or circuit for the ids of the qubits
+/// passed to it, in the order of its qubit operands.
+struct SpecializationKey {
+  StringAttr callee;
+  llvm::SmallVector<int, 4> qubitIds;
+
+  bool operator==(const SpecializationKey &other) const {
+    return callee == other.callee && qubitIds == other.qubitIds;
+  }
+};
+
+struct SpecializationKeyInfo {
+  static SpecializationKey getEmptyKey() {
+    return {llvm::DenseMapInfo<StringAttr>::getEmptyKey(), {}};
+  }
+  static SpecializationKey getTombstoneKey() {
+    return {llvm::DenseMapInfo<StringAttr>::getTombstoneKey(), {}};
+  }
+  static unsigned getHashValue(const SpecializationKey &key) {
+    return llvm::hash_combine(
+        key.callee,
+        llvm::hash_combine_range(key.qubitIds.begin(), key.qubitIds.end()));
+  }
+  static bool isEqual(const SpecializationKey &lhs,
+                      const SpecializationKey &rhs) {
+    return lhs == rhs;
+  }
+};
+
 struct SubroutineCloningPass
     : public PassWrapper<SubroutineCloningPass, OperationPass<>> {
   auto lookupQubitId(const Value val) -> int;
 
   template <class CallLikeOp>
-  auto getMangledName(Operation *op) -> std::string;
+  auto getSpecializationKey(CallLikeOp callOp) -> SpecializationKey;
+  static auto getMangledName(const SpecializationKey &key) -> std::string;
   template <class CallLikeOp, class FuncLikeOp>
-  void processCallOp(Operation *op, SymbolOpMap &symbolOpMap);
+  void processCallOps(std::vector<Operation *> callOps,
+                      SymbolOpMap &symbolOpMap);
 
   void runOnOperation() override;
 
-  std::deque<Operation *> callWorkList;
   std::unordered_set<Operation *> clonedFuncs;
   Operation *moduleOperation;
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+private:
+  /// The callee of the calls with each specialization, shared by the
+  /// clones of subroutines and circuits.
+  llvm::DenseMap<SpecializationKey, FlatSymbolRefAttr, SpecializationKeyInfo>
+      specializations;
 }; // struct SubroutineCloningPass
 } // namespace mlir::quir
 
@@ -36,6 +36,22 @@ struct VariableEliminationPass
 
   VariableEliminationPass(bool externalizeOutputVariables = false)
       : PassWrapper(), externalizeOutputVariables(externalizeOutputVariables) {}
+  VariableEliminationPass(const VariableEliminationPass &pass)
+      : PassWrapper(pass),
+        externalizeOutputVariables(pass.externalizeOutputVariables) {}
+
+  Option<bool> packVariables{
+      *this, "pack-variables",
+      llvm::cl::desc("Pack the private scalar variables into one aligned "
+                     "global buffer per element type, ordered by access "
+                     "frequency"),
+      llvm::cl::init(false)};
+  Option<bool> reuseVariableSlots{
+      *this, "reuse-variable-slots",
+      llvm::cl::desc("Share a slot of the packed buffers between the private "
+                     "scalar variables of a block whose live ranges do not "
+                     "overlap, implies pack-variables"),
+      llvm::cl::init(false)};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
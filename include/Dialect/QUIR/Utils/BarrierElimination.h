@@ -0,0 +1,171 @@
+//===- BarrierElimination.h - Erase and narrow barriers ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the elimination of the barriers of a block which do
+//  not constrain the operations after them, shared by the barriers of the
+//  dialects, e.g., quir.barrier over qubits and pulse.barrier over frames
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_BARRIER_ELIMINATION_H
+#define QUIR_BARRIER_ELIMINATION_H
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <optional>
+
+namespace mlir::quir {
+
+/// The resources an operation aligns in time, e.g., the qubits of a barrier.
+template <typename Resource>
+struct Alignment {
+  /// Whether all resources are aligned, e.g., by a synchronization of all
+  /// qubits, rather than those of resources.
+  bool all = false;
+  llvm::SmallVector<Resource, 4> resources;
+
+  bool covers(llvm::ArrayRef<Resource> others) const {
+    return all || llvm::all_of(others, [&](const Resource &resource) {
+             return llvm::is_contained(resources, resource);
+           });
+  }
+};
+
+/// The resources the operations of a dialect use and align.
+template <typename Resource>
+struct BarrierModel {
+  /// The resources op uses, including those it aligns, or std::nullopt if
+  /// not known, in which case op may use all of them.
+  llvm::function_ref<std::optional<llvm::SmallVector<Resource, 4>>(
+      Operation *)>
+      getUsedResources;
+  /// What op aligns, std::nullopt if op is not an alignment, e.g., a
+  /// barrier or a synchronization. The resources of a barrier are those of
+  /// its operands, in order.
+  llvm::function_ref<std::optional<Alignment<Resource>>(Operation *)>
+      getAlignment;
+};
+
+struct BarrierEliminationStatistics {
+  unsigned numErased = 0;
+  unsigned numNarrowed = 0;
+};
+
+/// Erase the barriers of block which do not constrain the operations after
+/// them, and narrow the others to the resources they constrain. A barrier
+/// delays the operations on its resources after it until all operations on
+/// them before it end. It does not if
+///   - it is on a single resource, which is used in order anyway,
+///   - it is preceded, on all its resources, by the same alignment of all of
+///     them, as they are aligned already, or
+///   - it is followed, on all its resources, by the same alignment of all of
+///     them, which delays the operations after it as much.
+/// A resource which is neither used since an alignment of all resources of
+/// the barrier nor before the next one is not constrained by the barrier, as
+/// it does not end later than the other ones and is aligned with them again
+/// before it is used.
+template <typename BarrierOpT, typename Resource>
+BarrierEliminationStatistics
+eliminateBarriers(Block &block, const BarrierModel<Resource> &model) {
+  BarrierEliminationStatistics statistics;
+
+  llvm::DenseMap<Operation *, std::optional<llvm::SmallVector<Resource, 4>>>
+      usedResources;
+  auto uses = [&](Operation *op, const Resource &resource) {
+    auto it = usedResources.find(op);
+    if (it == usedResources.end())
+      it = usedResources.try_emplace(op, model.getUsedResources(op)).first;
+    return !it->second || llvm::is_contained(*it->second, resource);
+  };
+  // the closest operation using resource before or after op in the block,
+  // null if none
+  auto getNeighbour = [&](Operation *op, const Resource &resource,
+                          bool forward) -> Operation * {
+    for (Operation *other = forward ? op->getNextNode() : op->getPrevNode();
+         other; other = forward ? other->getNextNode() : other->getPrevNode())
+      if (uses(other, resource))
+        return other;
+    return nullptr;
+  };
+  auto isAlignmentOf = [&](Operation *op,
+                           llvm::ArrayRef<Resource> resources) -> bool {
+    if (!op)
+      return false;
+    auto alignment = model.getAlignment(op);
+    return alignment && alignment->covers(resources);
+  };
+  auto erase = [&](BarrierOpT barrierOp) {
+    usedResources.erase(barrierOp.getOperation());
+    barrierOp->erase();
+    ++statistics.numErased;
+  };
+
+  llvm::SmallVector<BarrierOpT> barrierOps(block.getOps<BarrierOpT>());
+  for (auto barrierOp : barrierOps) {
+    auto alignment = model.getAlignment(barrierOp);
+    if (!alignment || alignment->all ||
+        alignment->resources.size() != barrierOp->getNumOperands())
+      continue;
+    llvm::ArrayRef<Resource> const resources = alignment->resources;
+    if (resources.size() < 2) {
+      erase(barrierOp);
+      continue;
+    }
+
+    llvm::SmallVector<Operation *, 4> previousOps;
+    llvm::SmallVector<Operation *, 4> nextOps;
+    for (const auto &resource : resources) {
+      previousOps.push_back(getNeighbour(barrierOp, resource, false));
+      nextOps.push_back(getNeighbour(barrierOp, resource, true));
+    }
+    auto isCommonAlignment = [&](llvm::ArrayRef<Operation *> ops) {
+      return llvm::all_equal(ops) && isAlignmentOf(ops.front(), resources);
+    };
+    if (isCommonAlignment(previousOps) || isCommonAlignment(nextOps)) {
+      erase(barrierOp);
+      continue;
+    }
+
+    llvm::SmallVector<Value, 4> kept;
+    for (auto [operand, previousOp, nextOp] :
+         llvm::zip(barrierOp->getOperands(), previousOps, nextOps))
+      if (!isAlignmentOf(previousOp, resources) ||
+          !isAlignmentOf(nextOp, resources))
+        kept.push_back(operand);
+    if (kept.size() == barrierOp->getNumOperands())
+      continue;
+    if (kept.size() < 2) {
+      erase(barrierOp);
+      continue;
+    }
+    usedResources.erase(barrierOp.getOperation());
+    barrierOp->setOperands(kept);
+    ++statistics.numNarrowed;
+  }
+  return statistics;
+}
+
+} // namespace mlir::quir
+
+#endif // QUIR_BARRIER_ELIMINATION_H
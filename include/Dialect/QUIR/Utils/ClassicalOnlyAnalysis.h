@@ -0,0 +1,84 @@
+//===- ClassicalOnlyAnalysis.h - Classical only operations ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares an analysis which finds the operations containing
+//  quantum operations in a single post-order walk, so that the control flow
+//  and functions of a module are classified without rescanning nested
+//  regions for every enclosing operation
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_CLASSICAL_ONLY_ANALYSIS_H
+#define QUIR_CLASSICAL_ONLY_ANALYSIS_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/AnalysisManager.h"
+
+#include "llvm/ADT/DenseMap.h"
+
+#include <cstdint>
+
+namespace mlir::quir {
+
+/// Whether the operations nested in the operation the analysis is attached
+/// to contain quantum operations, i.e., gates, measurements, resets, delays,
+/// qubit declarations and circuit calls, computed for all of them at once
+/// by propagating what each operation contains to its parent.
+///
+/// The analysis describes the IR at the time it was computed and holds no
+/// references to it, so passes which only set attributes should mark it
+/// preserved.
+class ClassicalOnlyAnalysis {
+public:
+  ClassicalOnlyAnalysis(mlir::Operation *op);
+
+  /// Whether op is or contains a quantum operation.
+  bool hasQuantumOps(mlir::Operation *op) const {
+    return (getContents(op) & QuantumOps) != 0;
+  }
+
+  /// Whether op is or contains a qubit declaration or a circuit call.
+  bool hasQubitDeclarations(mlir::Operation *op) const {
+    return (getContents(op) & QubitDeclarations) != 0;
+  }
+
+  /// Whether op is classical only, as set in its quir.classicalOnly
+  /// attribute by ClassicalOnlyDetectionPass. A function is classical only
+  /// if it is not main and neither takes qubits nor declares qubits or
+  /// calls circuits, any other operation if it contains no quantum
+  /// operation.
+  bool isClassicalOnly(mlir::Operation *op) const;
+
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return !pa.isPreserved<ClassicalOnlyAnalysis>();
+  }
+
+private:
+  enum Contents : uint8_t { QuantumOps = 1, QubitDeclarations = 2 };
+
+  /// Get the contents of op itself, not of the operations nested in it.
+  static uint8_t getOwnContents(mlir::Operation *op);
+
+  uint8_t getContents(mlir::Operation *op) const;
+
+  // the contents of the operations with regions, including the operations
+  // nested in them
+  llvm::DenseMap<mlir::Operation *, uint8_t> contents;
+};
+
+} // namespace mlir::quir
+
+#endif // QUIR_CLASSICAL_ONLY_ANALYSIS_H
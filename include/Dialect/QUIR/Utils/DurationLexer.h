@@ -0,0 +1,46 @@
+//===- DurationLexer.h - QUIR duration literal lexer ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the lexer for duration literals such as "10ns" or
+//  "1.5us" which is shared by the frontends and QUIR passes
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_DURATIONLEXER_H
+#define QUIR_DURATIONLEXER_H
+
+#include "Dialect/QUIR/IR/QUIREnums.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <optional>
+#include <utility>
+
+namespace mlir::quir {
+
+/// Lex the units of a duration, ignoring case. An empty string is seconds.
+std::optional<TimeUnits> lexTimeUnits(llvm::StringRef units);
+
+/// Lex a duration literal made of a decimal number, i.e., digits with an
+/// optional fraction, directly followed by optional units, e.g., "10ns",
+/// ".5us", "100DT" or "1" (seconds).
+llvm::Expected<std::pair<double, TimeUnits>>
+lexDuration(llvm::StringRef duration);
+
+} // namespace mlir::quir
+
+#endif // QUIR_DURATIONLEXER_H
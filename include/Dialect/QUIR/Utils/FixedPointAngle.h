@@ -0,0 +1,117 @@
+//===- FixedPointAngle.h - Fixed-point angles of a width --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the fixed-point values of quir.angle<Width>, as the
+//  integers controllers compute with
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_FIXED_POINT_ANGLE_H
+#define QUIR_FIXED_POINT_ANGLE_H
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace mlir::quir {
+
+/// The value of a quir.angle<Width> on a controller, i.e., its value scaled
+/// by 2^Width and wrapped around to the Width low bits, as the integer
+/// arithmetic of the lowered angle operations does. Arithmetic wraps around
+/// as that of the controller, so that folding and lowering compute the same
+/// bits without going through doubles.
+template <unsigned Width>
+class Angle {
+  static_assert(Width > 0 && Width < 64, "unsupported angle width");
+
+public:
+  /// The bits of the angle.
+  static constexpr uint64_t mask = (uint64_t{1} << Width) - 1;
+  /// The integer type the angle is lowered to, see QuirTypeConverter.
+  using Storage = std::conditional_t<(Width > 31), int64_t, int32_t>;
+
+  constexpr Angle() = default;
+
+  /// The angle of the given bits, wrapped around to Width bits.
+  static constexpr Angle fromBits(uint64_t bits) { return Angle(bits & mask); }
+
+  /// The angle of value scaled by 2^Width, truncated towards zero and
+  /// wrapped around to Width bits.
+  static Angle fromDouble(double value) {
+    double const scaled = std::fmod(std::ldexp(value, Width),
+                                    std::ldexp(1.0, Width));
+    return fromBits(static_cast<uint64_t>(static_cast<int64_t>(scaled)));
+  }
+
+  constexpr uint64_t getBits() const { return bits; }
+  /// The bits of the angle as its lowered integer.
+  constexpr Storage getStorage() const { return static_cast<Storage>(bits); }
+  /// The value of the angle, scaled back from 2^Width.
+  double toDouble() const {
+    return std::ldexp(static_cast<double>(bits), -static_cast<int>(Width));
+  }
+
+  constexpr Angle operator+(Angle other) const {
+    return fromBits(bits + other.bits);
+  }
+  constexpr Angle operator-(Angle other) const {
+    return fromBits(bits - other.bits);
+  }
+  constexpr Angle operator*(Angle other) const {
+    return fromBits(bits * other.bits);
+  }
+  constexpr Angle operator-() const { return fromBits(-bits); }
+
+  constexpr bool operator==(Angle other) const { return bits == other.bits; }
+  constexpr bool operator!=(Angle other) const { return bits != other.bits; }
+
+private:
+  constexpr explicit Angle(uint64_t bits) : bits(bits) {}
+
+  uint64_t bits = 0;
+}; // class Angle
+
+namespace detail {
+template <typename FnT, unsigned... Widths>
+auto visitAngleWidth(unsigned width, FnT &&fn,
+                     std::integer_sequence<unsigned, Widths...>) {
+  using Result = decltype(fn(Angle<1>()));
+  std::optional<Result> result;
+  ((width == Widths + 1 ? (void)(result = fn(Angle<Widths + 1>())) : void()),
+   ...);
+  return result;
+}
+} // namespace detail
+
+/// Call fn with an Angle of width, the specialization of the width of an
+/// angle type being only known at runtime, e.g.,
+///
+///   visitAngleWidth(*angleType.getWidth(), [&](auto angle) {
+///     return decltype(angle)::mask;
+///   });
+///
+/// @return The result of fn, or std::nullopt if width is not supported.
+template <typename FnT>
+auto visitAngleWidth(unsigned width, FnT &&fn) {
+  return detail::visitAngleWidth(width, std::forward<FnT>(fn),
+                                 std::make_integer_sequence<unsigned, 63>());
+}
+
+} // namespace mlir::quir
+
+#endif // QUIR_FIXED_POINT_ANGLE_H
@@ -0,0 +1,119 @@
+//===- GreedyRewrite.h - Instrumented greedy rewrites -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the pass options and statistics of the greedy rewrites
+//  of the QUIR passes, for diagnosing and bounding runaway rewrites
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_GREEDY_REWRITE_H
+#define QUIR_GREEDY_REWRITE_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/Statistic.h"
+
+#include <utility>
+
+namespace mlir::quir {
+
+/// The options of the greedy rewrite driver of a pass, registered as options
+/// of the pass. Passes holding them must define their copy constructor, as
+/// the options are rebuilt rather than copied with the pass.
+struct GreedyRewriteOptions {
+  GreedyRewriteOptions(mlir::Pass &pass, bool regionSimplificationDefault);
+  GreedyRewriteOptions(const GreedyRewriteOptions &) = delete;
+
+  mlir::Pass::Option<int64_t> maxIterations;
+  mlir::Pass::Option<bool> topDown;
+  mlir::Pass::Option<bool> regionSimplification;
+
+  /// Get the configuration of the driver with these options.
+  mlir::GreedyRewriteConfig getConfig() const;
+};
+
+/// The statistics of the greedy rewrites of a pass.
+struct GreedyRewriteStatistics {
+  explicit GreedyRewriteStatistics(mlir::Pass &pass);
+  GreedyRewriteStatistics(const GreedyRewriteStatistics &) = delete;
+
+  mlir::Pass::Statistic numIterations;
+  mlir::Pass::Statistic numNonConvergences;
+  mlir::Pass::Statistic rewriteMicroseconds;
+};
+
+/// Apply patterns greedily to the regions of op as
+/// applyPatternsAndFoldGreedily does, one iteration of the driver at a time
+/// so that the iterations and the time spent are recorded in statistics.
+/// Fails with an error on op if the rewrites do not converge within
+/// config.maxIterations.
+mlir::LogicalResult
+applyPatternsGreedily(mlir::Operation *op,
+                      const mlir::FrozenRewritePatternSet &patterns,
+                      mlir::GreedyRewriteConfig config,
+                      GreedyRewriteStatistics &statistics);
+
+/// Call fn on each of the operations isolated from above directly nested in
+/// op, e.g., on each function and circuit of a module, in parallel on the
+/// threads of the context of op, so that the rewrites of a large program are
+/// spread over its functions and circuits. fn is called on op itself if any
+/// of the operations directly nested in it with regions is not isolated from
+/// above, or if there are none. fn must not touch anything outside of the
+/// operation it is called on, e.g., the analyses of the pass or symbols.
+mlir::LogicalResult parallelForEachIsolatedOp(
+    mlir::Operation *op,
+    llvm::function_ref<mlir::LogicalResult(mlir::Operation *)> fn);
+
+namespace detail {
+template <typename SourceOp>
+SourceOp getSourceOp(const mlir::OpRewritePattern<SourceOp> *);
+} // namespace detail
+
+/// An OpRewritePattern counting its successful applications in a statistic
+/// of the pass it was added by, e.g.,
+///
+///   patterns.add<CountedPattern<MyPattern>>(numMyPatterns, context);
+template <typename PatternT>
+class CountedPattern : public PatternT {
+  using SourceOp =
+      decltype(detail::getSourceOp(std::declval<const PatternT *>()));
+
+public:
+  template <typename... Args>
+  explicit CountedPattern(llvm::Statistic &applications, Args &&...args)
+      : PatternT(std::forward<Args>(args)...), applications(applications) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(SourceOp op, mlir::PatternRewriter &rewriter) const override {
+    if (mlir::failed(PatternT::matchAndRewrite(op, rewriter)))
+      return mlir::failure();
+    ++applications;
+    return mlir::success();
+  }
+
+private:
+  llvm::Statistic &applications;
+};
+
+} // namespace mlir::quir
+
+#endif // QUIR_GREEDY_REWRITE_H
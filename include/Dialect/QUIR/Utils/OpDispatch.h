@@ -0,0 +1,91 @@
+//===- OpDispatch.h - Table driven dispatch over op kinds -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the dispatch of the visitors of the hot walks of the
+//  QUIR passes over the kinds of the operations they handle
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_OP_DISPATCH_H
+#define QUIR_OP_DISPATCH_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/TypeID.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Casting.h"
+
+#include <type_traits>
+
+namespace mlir::quir {
+
+/// Dispatches operations to a visitor by their kind among OpTys in a single
+/// lookup of the TypeID of their registered OperationName, rather than
+/// trying each kind in turn as a chain of dyn_casts does. The visitor is
+/// called with the operation cast to its kind, e.g., a generic lambda or a
+/// functor with an overload per kind. If an op kind is listed more than once
+/// the first entry wins, as in a chain of dyn_casts.
+///
+///   using Dispatcher = OpDispatcher<MeasureOp, DelayOp>;
+///   op->walk([&](Operation *op) {
+///     Dispatcher::get().dispatch(op, [&](auto castOp) { process(castOp); });
+///   });
+template <typename... OpTys>
+class OpDispatcher {
+public:
+  OpDispatcher() {
+    unsigned index = 0;
+    (indices.try_emplace(TypeID::get<OpTys>(), index++), ...);
+  }
+
+  /// Get the dispatcher of OpTys, which is built once per process.
+  static const OpDispatcher &get() {
+    static const OpDispatcher dispatcher;
+    return dispatcher;
+  }
+
+  /// Call visitor with op cast to its kind if it is one of OpTys.
+  /// @return Whether op is one of OpTys.
+  template <typename VisitorT>
+  bool dispatch(Operation *op, VisitorT &&visitor) const {
+    auto it = indices.find(op->getName().getTypeID());
+    if (it == indices.end())
+      return false;
+
+    using Visitor = std::remove_reference_t<VisitorT>;
+    using Thunk = void (*)(Operation *, Visitor &);
+    static constexpr Thunk thunks[] = {&visit<OpTys, Visitor>...};
+    thunks[it->second](op, visitor);
+    return true;
+  }
+
+  /// Whether op is one of OpTys.
+  bool contains(Operation *op) const {
+    return indices.count(op->getName().getTypeID());
+  }
+
+private:
+  template <typename OpTy, typename Visitor>
+  static void visit(Operation *op, Visitor &visitor) {
+    visitor(llvm::cast<OpTy>(op));
+  }
+
+  llvm::SmallDenseMap<TypeID, unsigned, 32> indices;
+}; // class OpDispatcher
+
+} // namespace mlir::quir
+
+#endif // QUIR_OP_DISPATCH_H
@@ -0,0 +1,111 @@
+//===- QubitFootprintAnalysis.h - Cached operated qubits --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares an analysis which caches the qubits operated on by each
+//  operation and by ranges of operations within a block, so that the reorder
+//  and merge passes do not rescan nested regions for every match
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_QUBIT_FOOTPRINT_ANALYSIS_H
+#define QUIR_QUBIT_FOOTPRINT_ANALYSIS_H
+
+#include "Dialect/QUIR/IR/QubitSet.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/AnalysisManager.h"
+
+#include "llvm/ADT/DenseMap.h"
+
+#include <vector>
+
+namespace mlir::quir {
+
+/// The qubits operated on by operations, see
+/// QubitOpInterface::getOperatedQubits, computed lazily and cached. The
+/// footprint of an operation with regions is the union of the footprints of
+/// the operations nested in it, so each nested operation is visited once.
+///
+/// For each block queried with getQubitsBetween a table of the footprints of
+/// all power of two long ranges of operations is built, which answers the
+/// query for any range with a single union.
+///
+/// The cache is kept up to date through the rewriter listener returned by
+/// getListener, which should be set as the listener of the greedy rewrite
+/// driver. Operations moved with Operation::moveBefore or moveAfter bypass
+/// the rewriter and must be reported with notifyOperationMoved.
+class QubitFootprintAnalysis {
+public:
+  QubitFootprintAnalysis(mlir::Operation *op);
+
+  /// Get the qubits operated on by op and the operations nested in it.
+  QubitSet getOperatedQubits(mlir::Operation *op);
+
+  /// Get the qubits operated on by the operations strictly between first and
+  /// second, which must be in the same block with first before second.
+  QubitSet getQubitsBetween(mlir::Operation *first, mlir::Operation *second);
+
+  /// Drop the cached footprints affected by op having been moved out of
+  /// oldBlock, which may be the block op is now in.
+  void notifyOperationMoved(mlir::Operation *op, mlir::Block *oldBlock);
+
+  /// Get a rewriter listener dropping the cached footprints of operations
+  /// that are modified, inserted or erased.
+  mlir::RewriterBase::Listener *getListener() { return &listener; }
+
+  void invalidate() { invalid_ = true; }
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return invalid_ || !pa.isPreserved<QubitFootprintAnalysis>();
+  }
+
+private:
+  /// Footprints of the ranges [i, i + 2^level) of the operations of a block.
+  struct BlockRanges {
+    llvm::DenseMap<mlir::Operation *, unsigned> positions;
+    std::vector<std::vector<QubitSet>> levels;
+  };
+
+  struct Listener : public mlir::RewriterBase::Listener {
+    Listener(QubitFootprintAnalysis &analysis) : analysis(analysis) {}
+
+    void notifyOperationInserted(mlir::Operation *op) override;
+    void notifyOperationModified(mlir::Operation *op) override;
+    void notifyOperationRemoved(mlir::Operation *op) override;
+
+    QubitFootprintAnalysis &analysis;
+  };
+
+  const BlockRanges &getBlockRanges(mlir::Block *block);
+
+  /// Drop the cached footprints of op, of the operations nested in it and of
+  /// the blocks nested in it.
+  void eraseNested(mlir::Operation *op);
+
+  /// Drop the cached footprints of block and of the operations and blocks
+  /// enclosing it.
+  void invalidateEnclosing(mlir::Block *block);
+
+  llvm::DenseMap<mlir::Operation *, QubitSet> footprints;
+  llvm::DenseMap<mlir::Block *, BlockRanges> blockRanges;
+  Listener listener;
+  bool invalid_{false};
+};
+
+} // namespace mlir::quir
+
+#endif // QUIR_QUBIT_FOOTPRINT_ANALYSIS_H
@@ -0,0 +1,97 @@
+//===- SymbolIndexAnalysis.h - Cached module symbol lookups -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares an analysis which indexes the symbols of a module so
+//  that passes can resolve circuits, functions and sequences by name without
+//  scanning the module for each lookup
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUIR_SYMBOL_INDEX_ANALYSIS_H
+#define QUIR_SYMBOL_INDEX_ANALYSIS_H
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/AnalysisManager.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <optional>
+
+namespace mlir::quir {
+
+/// An index of the symbol tables nested in an operation, built lazily for
+/// each symbol table the first time it is looked up in. The analysis is kept
+/// across passes which preserve it, so passes which neither add, remove nor
+/// rename symbols should mark it preserved. Passes which do change symbols
+/// while using the index must do so through getSymbolTable or invalidate it.
+class SymbolIndexAnalysis {
+public:
+  SymbolIndexAnalysis(mlir::Operation *op);
+
+  /// Look up a symbol in the symbol table of symbolTableOp.
+  mlir::Operation *lookupSymbolIn(mlir::Operation *symbolTableOp,
+                                  llvm::StringRef name);
+  mlir::Operation *lookupSymbolIn(mlir::Operation *symbolTableOp,
+                                  mlir::SymbolRefAttr symbol);
+
+  template <typename OpT>
+  OpT lookupSymbolIn(mlir::Operation *symbolTableOp, llvm::StringRef name) {
+    return llvm::dyn_cast_or_null<OpT>(lookupSymbolIn(symbolTableOp, name));
+  }
+
+  /// Look up a symbol in the symbol table nearest to from.
+  template <typename OpT>
+  OpT lookupNearestSymbolFrom(mlir::Operation *from,
+                              mlir::SymbolRefAttr symbol) {
+    return symbolTables.lookupNearestSymbolFrom<OpT>(from, symbol);
+  }
+
+  /// Get the circuit called by a call_circuit.
+  CircuitOp getCircuitOp(CallCircuitOp callCircuitOp);
+
+  /// Get the main function of the analyzed operation, see getMainFunction in
+  /// Utils.h.
+  mlir::Operation *getMainFunction();
+
+  /// Get the symbol table of symbolTableOp for inserting and erasing symbols
+  /// while keeping the index up to date.
+  mlir::SymbolTable &getSymbolTable(mlir::Operation *symbolTableOp) {
+    return symbolTables.getSymbolTable(symbolTableOp);
+  }
+
+  /// Get the symbol tables of the index, e.g., to build a SymbolUserMap
+  /// without building the tables again.
+  mlir::SymbolTableCollection &getSymbolTables() { return symbolTables; }
+
+  void invalidate() { invalid_ = true; }
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return invalid_ || !pa.isPreserved<SymbolIndexAnalysis>();
+  }
+
+private:
+  mlir::Operation *root;
+  mlir::SymbolTableCollection symbolTables;
+  std::optional<mlir::Operation *> mainFunc;
+  bool invalid_{false};
+};
+
+} // namespace mlir::quir
+
+#endif // QUIR_SYMBOL_INDEX_ANALYSIS_H
@@ -23,6 +23,7 @@
 
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Types.h"
@@ -30,8 +31,10 @@
 
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
 
-#include <set>
+#include <optional>
+#include <vector>
 
 namespace mlir {
 class Operation;
@@ -61,9 +64,17 @@ auto getNodeType(Operation *moduleOperation) -> std::string;
 // TODO: Should be replaced by an analysis compatable struct.
 llvm::Expected<uint32_t> getNodeId(Operation *moduleOperation);
 
-// adds the qubit Ids on the physicalId or physicalIds attributes to theseIds
-void addQubitIdsFromAttr(Operation *operation, std::vector<uint> &theseIds);
-void addQubitIdsFromAttr(Operation *operation, std::set<uint> &theseIds);
+// adds the qubit Ids on the physicalId or physicalIds attributes to theseIds,
+// skipping the -1 of the qubits which the quantum decoration pass could not
+// resolve. Returns false if there were any, in which case the qubits of the
+// operation are not known.
+bool addQubitIdsFromAttr(Operation *operation, std::vector<uint> &theseIds);
+bool addQubitIdsFromAttr(Operation *operation, QubitSet &theseIds);
+
+// returns the qubit Ids an op with regions was decorated with by the quantum
+// decoration pass, unless it is undecorated or some of its qubits could not
+// be resolved, so that passes reuse the decoration rather than rewalking it
+std::optional<QubitSet> getDecoratedQubits(Operation *operation);
 
 // appends all of the qubit arguments for a callOp to vec
 template <class CallOpTy>
@@ -138,6 +149,15 @@ std::optional<Operation *> prevQuantumOrControlFlowOrNull(Operation *op);
 /// \brief Check if the operation is a quantum operation
 bool isQuantumOp(Operation *op);
 
+/// \brief Collect op and its transitive users into users, in the order of
+/// the block of op, each user being replaced by its ancestor in that block,
+/// i.e., the ops which must move along with op to keep the uses of its
+/// results dominated. Each op is visited once, without recursion, so that
+/// diamond shaped and long use chains are collected in linear time.
+/// \return false if a user is not nested in the block of op.
+bool collectTransitiveUsers(Operation *op,
+                            llvm::SmallVectorImpl<Operation *> &users);
+
 /// Construct a DurationAttr from a ConstantOp
 llvm::Expected<mlir::quir::DurationAttr>
 getDuration(mlir::quir::ConstantOp &duration);
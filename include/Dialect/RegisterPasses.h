@@ -26,17 +26,23 @@
 #include "Dialect/Pulse/IR/PulseDialect.h"
 #include "Dialect/Pulse/Transforms/Passes.h"
 #include "Dialect/QCS/IR/QCSDialect.h"
-#include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
+#include "Dialect/QCS/Utils/Passes.h"
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/Transforms/Passes.h"
 #include "HAL/PassRegistration.h"
 
 #include "mlir/InitAllPasses.h"
 
+#include "llvm/ADT/StringRef.h"
+
+#include <optional>
+
 namespace qssc::dialect {
 
-/// Register all qss-compiler passes
-inline llvm::Error registerPasses() {
+/// Register all qss-compiler passes, with the passes of the given target
+/// only if any, and those of all targets otherwise.
+inline llvm::Error
+registerPasses(std::optional<llvm::StringRef> targetName = std::nullopt) {
   // TODO: Register standalone passes here.
   llvm::Error err = llvm::Error::success();
   mlir::oq3::registerOQ3Passes();
@@ -48,8 +54,15 @@ inline llvm::Error registerPasses() {
   mlir::pulse::registerPulsePassPipeline();
   mlir::registerConversionPasses();
 
-  err = llvm::joinErrors(std::move(err), qssc::hal::registerTargetPasses());
-  err = llvm::joinErrors(std::move(err), qssc::hal::registerTargetPipelines());
+  if (targetName) {
+    err = llvm::joinErrors(
+        std::move(err),
+        qssc::hal::registerTargetPassesAndPipelines(*targetName));
+  } else {
+    err = llvm::joinErrors(std::move(err), qssc::hal::registerTargetPasses());
+    err =
+        llvm::joinErrors(std::move(err), qssc::hal::registerTargetPipelines());
+  }
 
   mlir::registerAllPasses();
   return err;
@@ -67,6 +67,7 @@ public:
   }
 
   void visit(const QASM::ASTStatementList *);
+  void visitStatement(QASM::ASTStatement *);
 
   void visit(const QASM::ASTSymbolTableEntry *);
 
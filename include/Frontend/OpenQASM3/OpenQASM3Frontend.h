@@ -27,15 +27,53 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace qssc::frontend::openqasm3 {
 
+/// @brief Options of the OpenQASM 3 frontend. These are taken from the
+/// configuration of the compilation, or from the request of another process
+/// when parsing on its behalf, rather than from process-wide options so that
+/// concurrent parses may use different options.
+/// @brief Locations of the generated operations, see
+/// qssc::config::QASMLocations
+enum class LocationMode { Full, Lines, None };
+
+struct ParseOptions {
+  /// @brief The number of shots to execute the circuit for
+  unsigned numShots = 1000;
+  /// @brief Repetition delay between shots
+  std::string shotDelay = "1ms";
+  /// @brief Include paths of the preprocessor
+  std::vector<std::string> includeDirs;
+  /// @brief Expand includes from the process-wide cache of preprocessed
+  /// include files (see QASMIncludeCache.h)
+  bool cacheIncludes = false;
+  /// @brief Precompiled gate libraries to link gate definitions from
+  std::vector<std::string> gateLibraries;
+  /// @brief Lower the program to QUIR statement by statement, stopping at
+  /// the first statement which fails to lower
+  bool streaming = false;
+  /// @brief Locations of the generated operations
+  LocationMode locations = LocationMode::Full;
+  /// @brief Duration of dt of the target in seconds. When set, durations are
+  /// emitted in dt so that converting their units to dt is a no-op
+  std::optional<double> dtTimestep;
+};
+
 /// @brief Parse an OpenQASM 3 source file and emit high-level IR in the
-/// OpenQASM 3 dialect or dump the AST
-/// @param source input source as string or filename of the source
+/// OpenQASM 3 dialect or dump the AST. When parser workers have been started
+/// (see OpenQASM3ParserPool.h) the IR is generated in a worker process which
+/// allows concurrent parses, otherwise parsing happens in-process.
+/// @param options the frontend options to parse with
+/// @param source input source as string or filename of the source, which is
+/// not copied and must outlive the call
 /// @param sourceIsFilename true when the parameter source is the name of a
 /// source file, false when the parameter is the source input
 /// @param emitRawAST whether the raw AST should be dumped
@@ -43,13 +81,28 @@ namespace qssc::frontend::openqasm3 {
 /// @param emitMLIR whether high-level IR should be emitted
 /// @param newModule ModuleOp container for emitting MLIR into
 /// @param diagnosticCb a callback that will receive emitted diagnostics
+/// @param astOstream the stream the pretty-printed AST is dumped to, stdout
+/// if null
 /// @return an llvm::Error in case of failure, or llvm::Error::success()
 /// otherwise
-llvm::Error parse(std::string const &source, bool sourceIsFilename,
-                  bool emitRawAST, bool emitPrettyAST, bool emitMLIR,
-                  mlir::ModuleOp newModule,
+llvm::Error parse(const ParseOptions &options, llvm::StringRef source,
+                  bool sourceIsFilename, bool emitRawAST, bool emitPrettyAST,
+                  bool emitMLIR, mlir::ModuleOp newModule,
                   std::optional<DiagnosticCallback> diagnosticCb,
-                  mlir::TimingScope &timing);
+                  mlir::TimingScope &timing,
+                  llvm::raw_ostream *astOstream = nullptr);
+
+/// @brief Parse an OpenQASM 3 source within the current process. The
+/// underlying parser is a process-wide singleton so in-process parses are
+/// serialized. See parse for the remaining parameters.
+/// @param options the frontend options to parse with
+llvm::Error parseInProcess(const ParseOptions &options, llvm::StringRef source,
+                           bool sourceIsFilename, bool emitRawAST,
+                           bool emitPrettyAST, bool emitMLIR,
+                           mlir::ModuleOp newModule,
+                           std::optional<DiagnosticCallback> diagnosticCb,
+                           mlir::TimingScope &timing,
+                           llvm::raw_ostream *astOstream = nullptr);
 
 }; // namespace qssc::frontend::openqasm3
 
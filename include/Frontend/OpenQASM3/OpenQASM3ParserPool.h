@@ -0,0 +1,71 @@
+//===- OpenQASM3ParserPool.h ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares a pool of OpenQASM 3 parser worker processes.
+///
+/// The qe-qasm parser relies on process-wide singletons and may only parse a
+/// single program per process at a time. Parser workers are forked copies of
+/// the compiler which each parse a program and return the generated IR as
+/// MLIR bytecode, allowing several programs to be parsed concurrently.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef OPENQASM3_PARSER_POOL_H
+#define OPENQASM3_PARSER_POOL_H
+
+#include "API/errors.h"
+#include "Frontend/OpenQASM3/OpenQASM3Frontend.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <optional>
+#include <string>
+
+namespace qssc::frontend::openqasm3 {
+
+/// @brief Fork the number of parser workers selected with
+/// --qasm-parser-workers. As the workers are forked this must be called
+/// before the process starts any threads. Only the first call has an effect.
+/// @param registry The dialect registry the workers generate IR with.
+llvm::Error startParserWorkers(const mlir::DialectRegistry &registry);
+
+/// @brief Whether any parser workers are available.
+bool hasParserWorkers();
+
+/// @brief Parse an OpenQASM 3 source in a parser worker and import the emitted
+/// IR into newModule. Falls back to parsing in-process if no worker remains.
+/// @param options the frontend options to parse with
+/// @param source input source as string or filename of the source
+/// @param sourceIsFilename true when the parameter source is the name of a
+/// source file, false when the parameter is the source input
+/// @param newModule ModuleOp container for emitting MLIR into
+/// @param diagnosticCb a callback that will receive emitted diagnostics
+/// @return an llvm::Error in case of failure, or llvm::Error::success()
+/// otherwise
+llvm::Error parseInWorker(const ParseOptions &options, llvm::StringRef source,
+                          bool sourceIsFilename, mlir::ModuleOp newModule,
+                          std::optional<DiagnosticCallback> diagnosticCb,
+                          mlir::TimingScope &timing);
+
+} // namespace qssc::frontend::openqasm3
+
+#endif // OPENQASM3_PARSER_POOL_H
@@ -19,17 +19,22 @@
 
 #include "Frontend/OpenQASM3/BaseQASM3Visitor.h"
 
+#include "llvm/Support/raw_ostream.h"
+
 namespace qssc::frontend::openqasm3 {
 
+/// Prints the AST straight into a buffered stream, e.g., the output file or
+/// the output string of a compilation, rather than building it up in
+/// strings.
 class PrintQASM3Visitor : public BaseQASM3Visitor {
 private:
-  std::ostream &vStream; // visitor output stream
+  llvm::raw_ostream &vStream; // visitor output stream
 
 public:
-  PrintQASM3Visitor(QASM::ASTStatementList *sList, std::ostream &os)
+  PrintQASM3Visitor(QASM::ASTStatementList *sList, llvm::raw_ostream &os)
       : BaseQASM3Visitor(sList), vStream(os) {}
 
-  PrintQASM3Visitor(std::ostream &os) : BaseQASM3Visitor(), vStream(os) {}
+  PrintQASM3Visitor(llvm::raw_ostream &os) : BaseQASM3Visitor(), vStream(os) {}
 
   void visit(const QASM::ASTForStatementNode *) override;
 
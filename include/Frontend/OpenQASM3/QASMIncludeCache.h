@@ -0,0 +1,96 @@
+//===- QASMIncludeCache.h ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the cache of preprocessed OpenQASM 3 include files.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef OPENQASM3_QASMINCLUDECACHE_H
+#define OPENQASM3_QASMINCLUDECACHE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qssc::frontend::openqasm3 {
+
+/// @brief A process-wide cache of preprocessed include files which lets
+/// compilations expand the include directives of their sources without
+/// reading and preprocessing the same include files again.
+///
+/// Included files are preprocessed by dropping their comments and version
+/// statement and joining their lines, so that each include directive is
+/// expanded in place on a single line and the lines of the including source
+/// are preserved for diagnostics. Entries are keyed on the path of the file
+/// and revalidated against its modification time and size, and against the
+/// hash of its contents if these changed.
+///
+/// Includes of the standard gate library and includes which cannot be
+/// resolved are left to the preprocessor of the parser.
+class QASMIncludeCache {
+public:
+  /// @brief Get the cache of this process.
+  static QASMIncludeCache &instance();
+
+  /// @brief Expand the include directives of a source.
+  /// @param source The OpenQASM 3 source.
+  /// @param includeDirs The directories to resolve includes in, in order,
+  /// before resolving them relative to the working directory.
+  /// @return The source with its includes expanded.
+  llvm::Expected<std::string>
+  expandIncludes(llvm::StringRef source,
+                 llvm::ArrayRef<std::string> includeDirs);
+
+  /// @brief Discard all cached include files.
+  void clear();
+
+private:
+  struct Entry {
+    llvm::sys::TimePoint<> modificationTime;
+    uint64_t size;
+    std::array<uint8_t, 32> hash;
+    /// The preprocessed contents of the file, which still contain its
+    /// include directives.
+    std::string preprocessed;
+  };
+
+  /// Expand the include directives of text, with the files being expanded
+  /// on the stack of includes.
+  llvm::Error expandIncludes_(llvm::StringRef text,
+                              llvm::ArrayRef<std::string> includeDirs,
+                              std::vector<std::string> &includeStack,
+                              std::string &expanded);
+
+  /// Get the entry of an include file, (re)reading it if it changed.
+  llvm::Expected<std::shared_ptr<const Entry>> getEntry_(llvm::StringRef path);
+
+  std::mutex mutex; // guards entries
+  llvm::StringMap<std::shared_ptr<const Entry>> entries;
+};
+
+} // namespace qssc::frontend::openqasm3
+
+#endif // OPENQASM3_QASMINCLUDECACHE_H
@@ -17,6 +17,7 @@
 #ifndef VISITOR_QUIR_GEN_VISITOR_H
 #define VISITOR_QUIR_GEN_VISITOR_H
 
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIREnums.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
@@ -24,19 +25,27 @@
 #include "Dialect/QUIR/Transforms/Passes.h"
 #include "Frontend/OpenQASM3/BaseQASM3Visitor.h"
 #include "Frontend/OpenQASM3/QUIRVariableBuilder.h"
+#include "Frontend/OpenQASM3/SSAValueTable.h"
 
 #include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/StringSaver.h"
 
-#include <unordered_map>
+#include <optional>
+#include <vector>
 
 namespace qssc::frontend::openqasm3 {
 
 class QUIRGenQASM3Visitor : public BaseQASM3Visitor {
 private:
-  // References to MLIR single static assignment Values
-  // (TODO needs to be refactored)
-  std::unordered_map<std::string, mlir::Value> ssaValues;
+  // References to MLIR single static assignment Values by identifier
+  SSAValueTable ssaValues;
   std::vector<mlir::Value> ssaOtherValues;
   mlir::OpBuilder builder;
   mlir::OpBuilder topLevelBuilder;
@@ -46,12 +55,26 @@ private:
   std::string filename;
   bool hasFailed{false};
   bool buildingInCircuit{false};
+  bool lineLocations{false};
+  // Duration of dt in seconds, if durations are emitted in dt
+  std::optional<double> dtTimestep;
   uint circuitCount{0};
 
+  // Precompiled modules to link gate definitions from, indexed by symbol name
+  // so that neither declarations nor linking scan their bodies
+  std::vector<mlir::SymbolTable> gateLibraries;
+  // Gates declared by the program whose definition is linked from a library
+  llvm::StringMap<mlir::func::FuncOp> libraryGates;
+
+  // Names made up while lowering, e.g., those of integer literals, which are
+  // kept for the lifetime of the visitor rather than in a string each
+  llvm::BumpPtrAllocator namesAllocator;
+  llvm::UniqueStringSaver names{namesAllocator};
+
   mlir::Location getLocation(const QASM::ASTBase *);
-  bool assign(mlir::Value &, const std::string &);
-  mlir::Value getCurrentValue(const std::string &valueName);
-  llvm::Expected<std::string>
+  bool assign(mlir::Value &, llvm::StringRef);
+  mlir::Value getCurrentValue(llvm::StringRef valueName);
+  llvm::Expected<llvm::StringRef>
   getExpressionName(const QASM::ASTExpressionNode *);
 
   /// hold intermediate expression value while visiting child nodes
@@ -66,17 +89,23 @@ private:
 
   mlir::Value createDurationRef(const mlir::Location &, uint64_t,
                                 const QASM::LengthUnit &);
+  mlir::quir::DurationAttr getDurationAttr(double value,
+                                           mlir::quir::TimeUnits units);
 
   QUIRVariableBuilder varHandler;
 
   mlir::Value createVoidValue(mlir::Location);
   mlir::Value createVoidValue(QASM::ASTBase const *node);
 
+  /// Erase the constant operands which an operation folded away, as long as
+  /// no identifier refers to them.
+  void eraseFoldedConstants(mlir::ValueRange operands);
+
   mlir::Type getCastDestinationType(const QASM::ASTCastExpressionNode *node,
                                     mlir::OpBuilder &builder);
 
-  llvm::Expected<std::string> resolveQCParam(const QASM::ASTGateNode *gateNode,
-                                             unsigned int index);
+  llvm::Expected<llvm::StringRef>
+  resolveQCParam(const QASM::ASTGateNode *gateNode, unsigned int index);
 
   /// \brief
   /// Create a diagnostic with the specified severity and location from the
@@ -93,6 +122,11 @@ private:
   mlir::InFlightDiagnostic reportError(QASM::ASTBase const *location,
                                        mlir::DiagnosticSeverity severity);
 
+  /// Find the definition of a gate with the given signature in the gate
+  /// libraries, if any.
+  mlir::func::FuncOp lookupLibraryGate(llvm::StringRef name,
+                                       mlir::FunctionType type);
+
 public:
   QUIRGenQASM3Visitor(QASM::ASTStatementList *sList, mlir::OpBuilder b,
                       mlir::ModuleOp newModule, std::string f)
@@ -119,8 +153,40 @@ public:
 
   void setInputFile(std::string);
 
+  /// \brief
+  /// Locate the generated operations at the line of their statement, without
+  /// its column, so that the operations of a line share their location.
+  /// Diagnostics are still located at the line and column of their node.
+  void setLineLocations(bool flag) { lineLocations = flag; }
+
+  /// \brief
+  /// Emit the durations of the program in dt of the given duration in
+  /// seconds, e.g., that of the target, rather than in the units they are
+  /// written in, so that they need not be converted by a pass.
+  void setDtTimestep(double dt) { dtTimestep = dt; }
+
+  /// \brief
+  /// Add a precompiled gate library, i.e., a module of gate definitions, to
+  /// link the definitions of the gates declared by the program from, instead
+  /// of generating them. Declarations whose signature differs from their
+  /// definition in the library are generated as usual. The library must
+  /// remain valid until linkGateLibraries has been called.
+  void addGateLibrary(mlir::ModuleOp library);
+
   mlir::LogicalResult walkAST();
 
+  /// \brief
+  /// Lower a single top-level statement of the AST, for lowering a program
+  /// statement by statement. Fails if this or an earlier statement failed to
+  /// lower.
+  mlir::LogicalResult walkStatement(QASM::ASTStatement *statement);
+
+  /// \brief
+  /// Link the library definitions of the declared gates used by the program
+  /// into its module, along with the symbols they reference. To be called
+  /// once the AST has been walked and the last circuit has been finished.
+  mlir::LogicalResult linkGateLibraries();
+
 protected:
   using ExpressionValueType = llvm::Expected<mlir::Value>;
 
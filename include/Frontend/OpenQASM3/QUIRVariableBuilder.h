@@ -26,13 +26,13 @@
 #include "mlir/IR/BuiltinOps.h"
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 
 #include <qasm/AST/ASTSymbolTable.h>
 #include <qasm/AST/ASTTypes.h>
 
-#include <unordered_map>
-
 namespace qssc::frontend::openqasm3 {
 
 class QUIRVariableBuilder {
@@ -202,8 +202,7 @@ public:
   /// variable handler. This function is a cludge while transitioning
   /// variable handling.
   bool tracksVariable(llvm::StringRef variableName) {
-
-    return variables.find(variableName.str()) != variables.end();
+    return variables.count(variableName);
   }
 
   /// Resolve the mlir::Type for representing a given symbol table entry.
@@ -242,9 +241,9 @@ private:
     return (useClassicalBuilder) ? classicalBuilder : builder;
   }
 
-  std::unordered_map<std::string, mlir::Type> variables;
+  llvm::StringMap<mlir::Type> variables;
 
-  std::unordered_map<mlir::Operation *, mlir::Operation *> lastDeclaration;
+  llvm::DenseMap<mlir::Operation *, mlir::Operation *> lastDeclaration;
 
   mlir::Type resolveQUIRVariableType(QASM::ASTType astType,
                                      const unsigned bits) const;
@@ -0,0 +1,87 @@
+//===- SSAValueTable.h - Scoped SSA values of identifiers -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the table of the SSA values of the identifiers in
+///  scope while generating QUIR.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef OPENQASM3_SSA_VALUE_TABLE_H
+#define OPENQASM3_SSA_VALUE_TABLE_H
+
+#include "mlir/IR/Value.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
+
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace qssc::frontend::openqasm3 {
+
+/// @brief The SSA values of the identifiers in scope, e.g., qubits,
+/// durations and classical values referenced by name. Identifiers are
+/// interned when they are assigned, so that neither lookups nor the values
+/// saved for a scope copy them.
+///
+/// A scope sees the values of the enclosing scope, and assignments within
+/// it are undone when it is left. It only saves the values of the enclosing
+/// scope once it assigns, so that blocks which merely reference identifiers
+/// do not copy the table. The values are ordered like those of a
+/// std::unordered_map keyed by std::string, which the arguments of circuits
+/// are collected in.
+class SSAValueTable {
+public:
+  using Map = std::unordered_map<std::string_view, mlir::Value>;
+
+  /// @brief Get the value of an identifier, if it is in scope.
+  std::optional<mlir::Value> lookup(llvm::StringRef name) const;
+  bool contains(llvm::StringRef name) const;
+  /// @brief Whether any identifier refers to value, in this or an enclosing
+  /// scope.
+  bool references(mlir::Value value) const;
+
+  /// @brief Assign a value to an identifier in the current scope.
+  void assign(llvm::StringRef name, mlir::Value value);
+
+  /// @brief Enter a scope seeing the values of the enclosing scope, e.g., a
+  /// block of a loop or a branch.
+  void pushScope();
+  /// @brief Enter a scope seeing none of the values of the enclosing scope,
+  /// e.g., the body of a gate.
+  void pushIsolatedScope();
+  /// @brief Leave the current scope, restoring the values of the enclosing
+  /// scope.
+  void popScope();
+
+  Map::const_iterator begin() const { return values.begin(); }
+  Map::const_iterator end() const { return values.end(); }
+
+private:
+  Map values;
+  /// The values of the enclosing scope of each scope, once it assigned.
+  std::vector<std::optional<Map>> savedScopes;
+
+  llvm::BumpPtrAllocator allocator;
+  llvm::UniqueStringSaver names{allocator};
+};
+
+} // namespace qssc::frontend::openqasm3
+
+#endif // OPENQASM3_SSA_VALUE_TABLE_H
@@ -0,0 +1,93 @@
+//===- CompilationTrace.h - Target compilation trace ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the trace of the stages of a multi-target compilation
+///  used to report its critical path and thread utilization.
+///
+//===----------------------------------------------------------------------===//
+#ifndef COMPILATIONTRACE_H
+#define COMPILATIONTRACE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qssc::hal::compile {
+
+/// @brief A trace of the stages run for the targets of a compilation. Each
+/// stage records when and on which thread it ran and the stages it depended
+/// on, from which the critical path through the target tree and the thread
+/// utilization of the compilation are computed. Stages may be recorded
+/// concurrently.
+class CompilationTrace {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stage {
+    std::string target;
+    std::string name;
+    Clock::time_point start;
+    Clock::time_point end;
+    uint64_t threadId;
+    /// Ids of the stages which had to complete before this stage started.
+    llvm::SmallVector<size_t> dependencies;
+  };
+
+  /// @brief Create a trace for a compilation.
+  /// @param numThreads The number of threads available to the compilation.
+  explicit CompilationTrace(unsigned numThreads);
+
+  /// @brief Record a stage which ran on the calling thread from start until
+  /// now.
+  /// @return The id of the stage.
+  size_t record(llvm::StringRef target, llvm::StringRef name,
+                Clock::time_point start, llvm::ArrayRef<size_t> dependencies);
+
+  /// @brief Get the ids of the stages on the critical path, i.e., the chain
+  /// of stages each of which waited on the one before it, ending in the stage
+  /// which completed last.
+  std::vector<size_t> getCriticalPath() const;
+
+  /// @brief Get the fraction of the compilation's wall time the available
+  /// threads spent running stages.
+  double getUtilization() const;
+
+  /// @brief Print the trace in the Chrome trace event format with the
+  /// critical path and utilization as metadata.
+  void print(llvm::raw_ostream &os) const;
+
+  /// @brief Write the trace to a file in the Chrome trace event format.
+  llvm::Error write(llvm::StringRef path) const;
+
+private:
+  unsigned numThreads;
+  Clock::time_point begin;
+
+  mutable std::mutex mutex; // guards stages
+  std::vector<Stage> stages;
+};
+
+} // namespace qssc::hal::compile
+#endif // COMPILATIONTRACE_H
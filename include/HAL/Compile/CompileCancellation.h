@@ -0,0 +1,73 @@
+//===- CompileCancellation.h - Cancel compilations --------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the cooperative cancellation and deadline of
+///  compilations.
+///
+//===----------------------------------------------------------------------===//
+#ifndef COMPILECANCELLATION_H
+#define COMPILECANCELLATION_H
+
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/Support/Error.h"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace qssc::hal::compile {
+
+/// @brief The cooperative cancellation and deadline of a compilation. The
+/// compilation checks it at the boundaries of its stages and between the
+/// targets of the target system, and stops with an error once it has been
+/// cancelled or its deadline has passed. A compilation is never resumed once
+/// cancelled. May be cancelled and checked concurrently.
+class CompileCancellation {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit CompileCancellation(
+      std::optional<Clock::time_point> deadline = std::nullopt)
+      : deadline(deadline) {}
+
+  /// @brief Request the compilation to stop as soon as possible.
+  void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+  /// @brief Whether the compilation has been cancelled or its deadline has
+  /// passed.
+  bool isCancelled() const;
+
+  /// @brief Get the error to stop the compilation with if it has been
+  /// cancelled, with an error code of std::errc::operation_canceled, or if
+  /// its deadline has passed, with std::errc::timed_out.
+  llvm::Error check() const;
+
+  /// @brief Skip all passes run in context once cancelled so that the pass
+  /// managers of the compilation, and the threads they run on, are released
+  /// promptly. Pass instrumentations cannot stop a pass manager, so this
+  /// handles the execution of each pass as an MLIR action instead. It
+  /// replaces any action handler of the context and must outlive the
+  /// context. The compilation then fails with check() at its next boundary.
+  void skipPassesOnceCancelled(mlir::MLIRContext *context) const;
+
+private:
+  std::atomic<bool> cancelled{false};
+  std::optional<Clock::time_point> deadline;
+};
+
+} // namespace qssc::hal::compile
+#endif // COMPILECANCELLATION_H
@@ -0,0 +1,166 @@
+//===- MetricsRegistry.h - Process-wide compiler metrics --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the registry of the counters and histograms of the
+///  compilations and bindings of a process and their export in the
+///  Prometheus and OpenMetrics text formats.
+///
+//===----------------------------------------------------------------------===//
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qssc::hal::compile {
+
+/// @brief The counters and histograms of a process, e.g., the number of
+/// compilations by outcome and the latencies of their stages. A metric is a
+/// family of series which differ in the values of their labels and is
+/// created when it is first updated. Metrics may be updated concurrently.
+///
+/// Metrics are exported in the Prometheus text format, in the OpenMetrics
+/// text format, or as JSON which another registry can merge, e.g., to collect
+/// the metrics of compile processes in the process which started them.
+class MetricsRegistry {
+public:
+  using Clock = std::chrono::steady_clock;
+  /// @brief The label names and values of a series.
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  enum class Format { Prometheus, OpenMetrics, JSON };
+
+  /// @brief The value of a histogram series.
+  struct Histogram {
+    uint64_t count = 0;
+    double sum = 0;
+    /// @brief The observations per bucket, not cumulative, with the
+    /// observations above the last bound last.
+    std::vector<uint64_t> bucketCounts;
+  };
+
+  /// @brief Get the registry of this process.
+  static MetricsRegistry &instance();
+
+  /// @brief Upper bounds for latencies, in seconds from 1ms to 5min.
+  static llvm::ArrayRef<double> getDurationBuckets();
+
+  /// @brief Upper bounds for sizes, in bytes from 1KiB to 1GiB.
+  static llvm::ArrayRef<double> getSizeBuckets();
+
+  /// @brief Add value to a counter, whose name must end in _total.
+  void increment(llvm::StringRef name, llvm::StringRef help,
+                 const Labels &labels = {}, double value = 1);
+
+  /// @brief Record an observation in a histogram with the upper bounds of
+  /// its buckets, which must be the same for all series of the histogram.
+  void observe(llvm::StringRef name, llvm::StringRef help,
+               llvm::ArrayRef<double> buckets, const Labels &labels,
+               double value);
+
+  /// @brief Record the seconds elapsed since start in a histogram with
+  /// getDurationBuckets.
+  void observeDuration(llvm::StringRef name, llvm::StringRef help,
+                       const Labels &labels, Clock::time_point start);
+
+  /// @brief Get the value of a counter series, if it exists.
+  std::optional<double> getCounter(llvm::StringRef name,
+                                   const Labels &labels = {}) const;
+
+  /// @brief Get the value of a histogram series, if it exists.
+  std::optional<Histogram> getHistogram(llvm::StringRef name,
+                                        const Labels &labels = {}) const;
+
+  /// @brief Print all metrics.
+  void print(llvm::raw_ostream &os, Format format) const;
+
+  /// @brief Get all metrics as parsed by merge.
+  llvm::json::Value toJSON() const;
+
+  /// @brief Add metrics exported as JSON, e.g., by another process, to the
+  /// metrics of this registry.
+  llvm::Error merge(const llvm::json::Value &json);
+
+  /// @brief Remove all metrics.
+  void reset();
+
+  /// @brief Exchange the metrics of this registry with those of other, e.g.,
+  /// to export the metrics of this registry and reset them at once.
+  void swap(MetricsRegistry &other);
+
+private:
+  enum class Type { Counter, Histogram };
+
+  struct Series {
+    double value = 0;
+    Histogram histogram;
+  };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::vector<double> buckets;
+    std::map<Labels, Series> series;
+  };
+
+  /// Get the series of a metric, creating it if needed. Requires the lock to
+  /// be held. Returns null if the metric exists with another type or other
+  /// buckets.
+  Series *getSeries_(llvm::StringRef name, Type type, llvm::StringRef help,
+                     llvm::ArrayRef<double> buckets, Labels labels);
+
+  void printText_(llvm::raw_ostream &os, bool openMetrics) const;
+
+  mutable std::mutex mutex; // guards families
+  std::map<std::string, Family, std::less<>> families;
+};
+
+/// @brief Records the seconds from its construction until it is stopped or
+/// destroyed in a histogram of the process registry.
+class MetricsTimer {
+public:
+  MetricsTimer(llvm::StringRef name, llvm::StringRef help,
+               MetricsRegistry::Labels labels = {});
+  MetricsTimer(const MetricsTimer &) = delete;
+  MetricsTimer &operator=(const MetricsTimer &) = delete;
+  ~MetricsTimer() { stop(); }
+
+  /// @brief Record the elapsed time, once.
+  void stop();
+
+private:
+  std::string name;
+  std::string help;
+  MetricsRegistry::Labels labels;
+  MetricsRegistry::Clock::time_point start;
+  bool stopped = false;
+};
+
+} // namespace qssc::hal::compile
+#endif // METRICSREGISTRY_H
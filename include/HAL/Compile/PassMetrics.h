@@ -0,0 +1,107 @@
+//===- PassMetrics.h - Per-pass IR size and memory metrics ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the pass instrumentation recording the size of the IR
+///  and the memory use of the compiler before and after each pass.
+///
+//===----------------------------------------------------------------------===//
+#ifndef PASSMETRICS_H
+#define PASSMETRICS_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/PassInstrumentation.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qssc::hal::compile {
+
+/// @brief The metrics of passes run by the pass managers of a compilation,
+/// i.e., the number of operations and symbols nested in the operation a pass
+/// ran on and the resident and allocated memory of the process, before and
+/// after each pass. Passes may be recorded concurrently. The memory is that
+/// of the whole process, so passes running at the same time on other threads
+/// contribute to each other's memory deltas.
+class PassMetrics {
+public:
+  enum class Format { Table, JSON };
+
+  struct Snapshot {
+    size_t numOps = 0;
+    size_t numSymbols = 0;
+    size_t residentBytes = 0;
+    size_t allocatedBytes = 0;
+  };
+
+  struct Run {
+    /// The pass manager the pass ran in, e.g., the name of a target.
+    std::string pipeline;
+    std::string pass;
+    /// The name of the operation the pass ran on.
+    std::string op;
+    Snapshot before;
+    Snapshot after;
+    bool failed = false;
+    /// The order in which the runs started.
+    size_t index = 0;
+  };
+
+  /// @brief Take a snapshot of the operations and symbols nested in op, and
+  /// of the memory of the process.
+  static Snapshot takeSnapshot(mlir::Operation *op);
+
+  /// @brief Take a snapshot of the memory of the process only.
+  static Snapshot takeMemorySnapshot();
+
+  /// @brief Create an instrumentation recording the passes of a pass manager
+  /// to these metrics, which must outlive it.
+  /// @param pipeline The name of the pass manager in the report.
+  std::unique_ptr<mlir::PassInstrumentation>
+  createInstrumentation(llvm::StringRef pipeline);
+
+  /// @brief Get the index of the next run to start.
+  size_t startRun();
+
+  void record(Run run);
+
+  /// @brief Get the runs recorded so far in the order they started.
+  std::vector<Run> getRuns() const;
+
+  /// @brief Print one row per pass of each pass manager with the metrics
+  /// summed over its runs, e.g., on each function of a module.
+  void printTable(llvm::raw_ostream &os) const;
+
+  /// @brief Print the metrics of every run as JSON.
+  void printJSON(llvm::raw_ostream &os) const;
+
+  /// @brief Write the report to a file, - for stdout.
+  llvm::Error write(llvm::StringRef path, Format format) const;
+
+private:
+  mutable std::mutex mutex; // guards runs and numStarted
+  std::vector<Run> runs;
+  size_t numStarted = 0;
+};
+
+} // namespace qssc::hal::compile
+#endif // PASSMETRICS_H
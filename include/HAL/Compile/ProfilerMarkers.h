@@ -0,0 +1,109 @@
+//===- ProfilerMarkers.h - Profiler markers of timing scopes ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the markers which external profilers, e.g., perf,
+///  VTune through ITT or Tracy, are given at the boundaries of the timing
+///  scopes of a compilation, and the timing manager which emits them.
+///
+//===----------------------------------------------------------------------===//
+#ifndef PROFILERMARKERS_H
+#define PROFILERMARKERS_H
+
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace qssc::hal::compile {
+
+/// @brief The sink of the markers of the timing scopes of a compilation.
+/// Scopes overlap across threads, e.g., the scope of a target is started on
+/// the thread which visits it and may be stopped on the thread which
+/// completes its last child, so the markers of a scope are matched by id
+/// rather than by thread. Markers may be emitted concurrently.
+class ProfilerMarkers {
+public:
+  virtual ~ProfilerMarkers() = default;
+
+  /// @brief A scope named name started on the calling thread.
+  virtual void begin(uint64_t id, llvm::StringRef name) = 0;
+  /// @brief The scope started as id stopped on the calling thread.
+  virtual void end(uint64_t id) = 0;
+
+  /// @brief Get the markers of this process, if any. The markers are
+  /// installed from the QSSC_PROFILER_MARKERS environment variable when
+  /// first requested and are one of
+  ///   perf:<file>    write timestamped markers to file, on the clock of
+  ///                  `perf record -k mono`
+  ///   library:<file> load a shared library which defines
+  ///                  `void qssc_profiler_begin(uint64_t, const char *,
+  ///                  size_t)` and `void qssc_profiler_end(uint64_t)`,
+  ///                  e.g., forwarding to ITT or Tracy
+  static ProfilerMarkers *get();
+
+  /// @brief Replace the markers of this process, e.g., from a host
+  /// application. Must not be called while compilations are running.
+  static void install(std::unique_ptr<ProfilerMarkers> markers);
+
+  /// @brief Create the markers described as by QSSC_PROFILER_MARKERS.
+  static llvm::Expected<std::unique_ptr<ProfilerMarkers>>
+  create(llvm::StringRef spec);
+};
+
+/// @brief A DefaultTimingManager which, when profiler markers are installed,
+/// emits a marker at each start and stop of its timers, whether or not
+/// timing is enabled. Without markers it is a DefaultTimingManager, i.e.,
+/// when timing is disabled its root scope is inactive and nesting a scope
+/// costs a null check.
+class ProfilingTimingManager : public mlir::DefaultTimingManager {
+public:
+  ProfilingTimingManager();
+  ~ProfilingTimingManager() override;
+
+protected:
+  std::optional<void *> rootTimer() override;
+  void startTimer(void *handle) override;
+  void stopTimer(void *handle) override;
+  void *nestTimer(void *handle, const void *id,
+                  llvm::function_ref<std::string()> nameBuilder) override;
+  void hideTimer(void *handle) override;
+
+private:
+  struct Marker {
+    /// The timer of the DefaultTimingManager, null if timing is disabled.
+    void *timer;
+    std::string name;
+    uint64_t id;
+  };
+
+  Marker *createMarker_(void *timer, std::string name);
+
+  ProfilerMarkers *markers;
+  std::mutex mutex; // guards root and allocated
+  Marker *root = nullptr;
+  std::deque<Marker> allocated;
+};
+
+} // namespace qssc::hal::compile
+#endif // PROFILERMARKERS_H
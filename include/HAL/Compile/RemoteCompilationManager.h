@@ -0,0 +1,119 @@
+//===- RemoteCompilationManager.h - Remote Scheduler ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the compilation manager which delegates the
+///  compilation of target subtrees to workers, e.g., on other hosts, and the
+///  jobs exchanged with the workers.
+///
+//===----------------------------------------------------------------------===//
+#ifndef REMOTECOMPILATIONMANAGER_H
+#define REMOTECOMPILATIONMANAGER_H
+
+#include "HAL/Compile/ThreadedCompilationManager.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace qssc::hal::compile {
+
+/// @brief The compilation of the subtree of a target by a worker.
+struct SubtreeJob {
+  /// @brief The names of the targets from the child of the target system to
+  /// the root of the subtree, separated by '/'.
+  std::string targetPath;
+  /// @brief The prefix the payload files are named with.
+  std::string payloadPrefix;
+  /// @brief Whether the worker runs the passes of the targets.
+  bool compileMLIR = true;
+  /// @brief The module of the root of the subtree as MLIR bytecode.
+  std::string moduleBytecode;
+
+  /// @brief Serialize the job, e.g., to send it to a worker.
+  std::string serialize() const;
+  static llvm::Expected<SubtreeJob> deserialize(llvm::StringRef data);
+};
+
+/// @brief The result of a SubtreeJob.
+struct SubtreeResult {
+  /// @brief The compiled module of the root of the subtree as MLIR bytecode.
+  std::string moduleBytecode;
+  /// @brief The payload files of the subtree by name.
+  std::map<std::string, std::string> files;
+
+  /// @brief Serialize the result, e.g., to return it from a worker.
+  std::string serialize() const;
+  static llvm::Expected<SubtreeResult> deserialize(llvm::StringRef data);
+};
+
+/// @brief The transport of SubtreeJobs to workers running the same target
+/// plugin and configuration, e.g., over RPC. Jobs of the subtrees of a
+/// compilation are executed concurrently.
+class SubtreeExecutor {
+public:
+  virtual ~SubtreeExecutor() = default;
+
+  /// @brief Whether the subtree of target is compiled by a worker. By
+  /// default, the subtree of each child of the target system is.
+  virtual bool accepts(Target &target);
+
+  /// @brief Compile the subtree of a job on a worker.
+  virtual llvm::Expected<SubtreeResult> execute(const SubtreeJob &job) = 0;
+};
+
+/// @brief A ThreadedCompilationManager which ships the modules of the
+/// subtrees accepted by its executor to workers, and merges their compiled
+/// modules and payload files back, compiling the remaining targets itself.
+/// The compiled module of a subtree replaces the module of its root, so that
+/// its ancestors emit as if they had compiled it. The worker side of a job
+/// is runSubtreeJob.
+///
+/// The compilation of MLIR alone, i.e., compileMLIR, is not delegated.
+class RemoteCompilationManager : public ThreadedCompilationManager {
+public:
+  RemoteCompilationManager(
+      qssc::hal::TargetSystem &target, mlir::MLIRContext *context,
+      PMBuilder pmBuilder, std::shared_ptr<SubtreeExecutor> executor,
+      std::shared_ptr<TargetPassManagerPools> passManagerPools = nullptr);
+  virtual ~RemoteCompilationManager() = default;
+  virtual const std::string getName() const override;
+
+protected:
+  virtual bool delegatesSubtree(Target &target) override;
+  virtual llvm::Expected<std::map<std::string, std::string>>
+  compileDelegatedSubtree(Target &target, mlir::ModuleOp targetModuleOp,
+                          llvm::StringRef payloadPrefix, bool doCompileMLIR,
+                          mlir::TimingScope &timing) override;
+
+private:
+  std::shared_ptr<SubtreeExecutor> executor;
+}; // class RemoteCompilationManager
+
+/// @brief Run a job on a worker with a compilation manager for the same
+/// target system as the manager which created the job. The root of the
+/// subtree must be instantiated in the target system of the worker, e.g.,
+/// from its configuration.
+llvm::Expected<SubtreeResult>
+runSubtreeJob(ThreadedCompilationManager &manager, const SubtreeJob &job);
+
+} // namespace qssc::hal::compile
+#endif // REMOTECOMPILATIONMANAGER_H
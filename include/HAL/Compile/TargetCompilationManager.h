@@ -21,12 +21,16 @@
 #ifndef TARGETCOMPILATIONMANAGER_H
 #define TARGETCOMPILATIONMANAGER_H
 
+#include "HAL/Compile/CompileCancellation.h"
+#include "HAL/Compile/PassMetrics.h"
 #include "HAL/TargetSystem.h"
 
 #include "mlir/IR/BuiltinOps.h"
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <optional>
 #include <string>
 
 using namespace qssc;
@@ -97,6 +101,32 @@ public:
   void enableTiming(mlir::TimingScope &timingScope);
   void disableTiming();
 
+  /// @brief Write a trace of the stages of each compilation for the targets
+  /// of the target system to a file in the Chrome trace event format.
+  /// @param tracePath The file to write the trace to.
+  void enableTracing(llvm::StringRef tracePath);
+
+  /// @brief Record the metrics of the passes run for the targets of the
+  /// target system.
+  /// @param passMetrics The metrics to record to, which must outlive the
+  /// target pass managers, or nullptr to stop recording.
+  void enablePassMetrics(PassMetrics *passMetrics);
+  PassMetrics *getPassMetrics() { return passMetrics; }
+
+  /// @brief Stop compiling the targets of the target system once the
+  /// compilation is cancelled. Checked before and after the passes of each
+  /// target and before it emits.
+  /// @param cancellation The cancellation of the compilation, which must
+  /// outlive it, or nullptr to compile until completion.
+  void enableCancellation(const CompileCancellation *cancellation) {
+    this->cancellation = cancellation;
+  }
+  const CompileCancellation *getCancellation() { return cancellation; }
+
+  /// @brief Verify the module of each target once its passes have run and
+  /// before it emits, for pass managers which do not verify after each pass.
+  void enableTargetVerification(bool verifyAfterTargetPasses);
+
 protected:
   bool getPrintBeforeAllTargetPasses() { return printBeforeAllTargetPasses; }
   bool getPrintAfterAllTargetPasses() { return printAfterAllTargetPasses; }
@@ -104,6 +134,12 @@ protected:
   bool getPrintAfterTargetCompileFailure() {
     return printAfterTargetCompileFailure;
   }
+  bool getVerifyAfterTargetPasses() { return verifyAfterTargetPasses; }
+  std::optional<llvm::StringRef> getTracePath() {
+    if (!tracePath.has_value())
+      return std::nullopt;
+    return llvm::StringRef(*tracePath);
+  }
 
   /// Thread-safe implementation
   virtual void printIR(llvm::Twine msg, mlir::Operation *op,
@@ -122,6 +158,14 @@ private:
   bool printBeforeAllTargetPayload = false;
   bool printAfterTargetCompileFailure = false;
 
+  bool verifyAfterTargetPasses = false;
+
+  std::optional<std::string> tracePath;
+
+  PassMetrics *passMetrics = nullptr;
+
+  const CompileCancellation *cancellation = nullptr;
+
   mlir::TimingScope rootTimer;
 
 }; // class TargetCompilationManager
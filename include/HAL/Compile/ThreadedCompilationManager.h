@@ -23,11 +23,23 @@
 
 #include "HAL/Compile/TargetCompilationManager.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 
 namespace qssc::hal::compile {
 
+/// @brief Pools of pass managers for the targets of a target system which may
+/// be shared between ThreadedCompilationManagers compiling for the same
+/// target system and context.
+class TargetPassManagerPools;
+
 /// @brief A threaded implementation of a TargetCompilationManager
 /// based on the threading pools provided by the mlir::MLIRContext.
 /// This enables compilation across disjoint subtree of compilation
@@ -48,13 +60,45 @@ protected:
   llvm::Error walkTargetThreaded(
       Target *target, mlir::TimingScope &timing,
       const TargetCompilationManager::WalkTargetFunction &walkFunc);
-  /// Threaded depth first walker for a target system modules using the current
-  /// MLIRContext's threadpool.
+  /// Threaded walker for a target system modules using the current
+  /// MLIRContext's threadpool. Each target is walked as soon as its parent has
+  /// been walked and its post children callback runs as soon as its own
+  /// children have completed, independently of the other subtrees.
   llvm::Error walkTargetModulesThreaded(
       Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
       const TargetCompilationManager::WalkTargetModulesFunction &walkFunc,
       const TargetCompilationManager::WalkTargetModulesFunction
           &postChildrenCallbackFunc);
+  /// Threaded walker for a target system modules which pipelines the
+  /// emission of each target with the walk of the remaining targets. The
+  /// emitFunc of a target runs after its walkFunc and after the emitFunc of
+  /// its parent. The children of targets which emit independently of them
+  /// are walked concurrently with the emitFunc of their parent, the children
+  /// of all other targets once it has completed. The post children callback
+  /// of a target runs once its emitFunc and its children have completed.
+  /// The children of targets for which skipChildren returns true once they
+  /// have been walked are not walked.
+  llvm::Error walkTargetModulesThreaded(
+      Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
+      const TargetCompilationManager::WalkTargetModulesFunction &walkFunc,
+      const TargetCompilationManager::WalkTargetModulesFunction &emitFunc,
+      const TargetCompilationManager::WalkTargetModulesFunction
+          &postChildrenCallbackFunc,
+      const std::function<bool(Target *)> &skipChildren = {});
+
+  /// @brief Whether the subtree of a target other than the root of a
+  /// compilation is compiled and emitted by compileDelegatedSubtree rather
+  /// than by this manager when compiling a payload. No subtree is delegated
+  /// by default.
+  virtual bool delegatesSubtree(Target &target) { return false; }
+  /// @brief Compile and emit the subtree of a delegated target elsewhere,
+  /// e.g., on another host, compiling its module in place and returning
+  /// the payload files of the subtree named with payloadPrefix. Called
+  /// concurrently for the delegated targets once their parent compiled.
+  virtual llvm::Expected<std::map<std::string, std::string>>
+  compileDelegatedSubtree(Target &target, mlir::ModuleOp targetModuleOp,
+                          llvm::StringRef payloadPrefix, bool doCompileMLIR,
+                          mlir::TimingScope &timing);
 
   virtual void printIR(llvm::Twine msg, mlir::Operation *op,
                        llvm::raw_ostream &out) override;
@@ -62,8 +106,15 @@ protected:
 public:
   using PMBuilder = std::function<llvm::Error(mlir::PassManager &)>;
 
-  ThreadedCompilationManager(qssc::hal::TargetSystem &target,
-                             mlir::MLIRContext *context, PMBuilder pmBuilder);
+  /// @brief Create a threaded compilation manager.
+  /// @param passManagerPools Pass manager pools to share with other
+  /// compilation managers for the same target system and context, allowing
+  /// them to compile concurrently without rebuilding the target pass
+  /// managers. Creates pools of its own if null.
+  ThreadedCompilationManager(
+      qssc::hal::TargetSystem &target, mlir::MLIRContext *context,
+      PMBuilder pmBuilder,
+      std::shared_ptr<TargetPassManagerPools> passManagerPools = nullptr);
   virtual ~ThreadedCompilationManager() = default;
   virtual const std::string getName() const override;
 
@@ -72,17 +123,42 @@ public:
                                      qssc::payload::Payload &payload,
                                      bool doCompileMLIR = true) override;
 
+  /// @brief Compile the subtree of a target of the target system and emit it
+  /// to the payload, as compilePayload does for the full target system.
+  /// @param root The root of the subtree, e.g., a subtree delegated to this
+  /// manager by the compilation of the full target system elsewhere.
+  /// @param moduleOp The module of the root target.
+  llvm::Error compilePayloadSubtree(Target &root, mlir::ModuleOp moduleOp,
+                                    qssc::payload::Payload &payload,
+                                    bool doCompileMLIR = true);
+
   bool isMultithreadingEnabled() {
     return getContext()->isMultithreadingEnabled();
   }
   llvm::ThreadPool &getThreadPool() { return getContext()->getThreadPool(); }
 
+  /// @brief Discard the cached target pass managers. They will be rebuilt on
+  /// the next compilation. Target pass managers are otherwise built once and
+  /// reused across all compilations performed with this manager and the
+  /// managers sharing its pass manager pools.
+  void invalidateTargetPassManagers();
+
+  /// @brief Discard the payloads of the targets emitted by previous
+  /// compilations. Targets which provide a configuration fingerprint
+  /// otherwise have their payload reused by compilations of this manager
+  /// while their module and fingerprint are unchanged.
+  void invalidateEmittedTargets();
+
+  /// @brief Get the pass manager pools of this manager to share them with
+  /// other compilation managers.
+  const std::shared_ptr<TargetPassManagerPools> &getPassManagerPools() const {
+    return passManagerPools_;
+  }
+
 private:
   // Used to store initialized and registered pass managers
   // with the context prior to compilation.
-  std::map<Target *, mlir::PassManager> targetPassManagers_;
-  // target pass manager map mutex
-  std::shared_mutex targetPassManagersMutex_;
+  std::shared_ptr<TargetPassManagerPools> passManagerPools_;
 
   // ensures we register passes with the context
   // in a threadsafe way.
@@ -91,30 +167,68 @@ private:
   // ensures we print in order when threading
   std::mutex printIRMutex_;
 
+  /// The payload files emitted for a target by a previous compilation.
+  struct EmittedTarget {
+    std::string fingerprint;
+    /// The payload prefix the files were emitted with.
+    std::string prefix;
+    std::map<std::string, std::string> files;
+  };
+
+  // guards emittedTargets_
+  std::mutex emittedTargetsMutex_;
+  std::map<Target *, std::shared_ptr<const EmittedTarget>> emittedTargets_;
+
   /// Prepare pass managers in a threaded way
   /// initializing them with the mlir context safely.
   llvm::Error buildTargetPassManagers_(Target &target,
                                        mlir::TimingScope &timing);
+  /// Build the prototype passmanager of a single target and publish it to
+  /// its pool once complete.
+  llvm::Error buildTargetPassManager_(Target &target,
+                                      mlir::TimingScope &timing);
   /// Threadsafe initialization of PM to work around
   /// non-threadsafe registration of dependent dialects.
   /// I (Thomas) believe this is related to the conversation here
   /// https://discourse.llvm.org/t/caching-and-parallel-compilation/67907
   /// and will follow up in the thread.
   void registerPassManagerWithContext_(mlir::PassManager &pm);
-  /// Thread safely get the passmanager for a target.
-  mlir::PassManager &getTargetPassManager_(Target *target);
-  /// Thread safely set the passmanager for a target.
-  mlir::PassManager &createTargetPassManager_(Target *target);
+  /// Thread safely check out a passmanager for a target from its pool,
+  /// cloning the target's prototype if all pooled ones are checked out.
+  /// Builds the prototype of targets instantiated after the pass managers
+  /// were built.
+  llvm::Expected<std::unique_ptr<mlir::PassManager>>
+  acquireTargetPassManager_(Target *target);
+  /// Thread safely return a passmanager checked out for a target to its pool.
+  void releaseTargetPassManager_(Target *target,
+                                 std::unique_ptr<mlir::PassManager> pm);
 
   /// Compiles the input module for a single target.
   llvm::Error compileMLIRTarget_(Target &target, mlir::ModuleOp targetModuleOp,
                                  mlir::TimingScope &timing);
-  /// Compiles the input payload for a single target.
-  llvm::Error compilePayloadTarget_(Target &target,
-                                    mlir::ModuleOp targetModuleOp,
-                                    qssc::payload::Payload &payload,
-                                    mlir::TimingScope &timing,
-                                    bool doCompileMLIR);
+  /// Emits the compiled module of a single target to the payload, copying
+  /// the emitted files into emittedFiles if given.
+  llvm::Error emitPayloadTarget_(
+      Target &target, mlir::ModuleOp targetModuleOp,
+      qssc::payload::Payload &payload, mlir::TimingScope &timing,
+      std::map<std::string, std::string> *emittedFiles = nullptr);
+  /// Fingerprint the input module and configuration of a target whose
+  /// payload may be reused, or return std::nullopt if it may not.
+  std::optional<std::string> fingerprintTarget_(Target &target,
+                                                mlir::ModuleOp targetModuleOp,
+                                                bool doCompileMLIR);
+  /// Thread safely look up the payload previously emitted for a target with
+  /// the given fingerprint.
+  std::shared_ptr<const EmittedTarget>
+  lookupEmittedTarget_(Target *target, llvm::StringRef fingerprint);
+  /// Thread safely store the payload emitted for a target.
+  void storeEmittedTarget_(Target *target,
+                           std::shared_ptr<const EmittedTarget> emitted);
+  /// Add the files previously emitted for a target to the payload, assigning
+  /// them to the payload group of the target.
+  void replayEmittedTarget_(const EmittedTarget &emitted,
+                            qssc::payload::Payload &payload,
+                            llvm::StringRef group);
 
   PMBuilder pmBuilder;
 
@@ -21,6 +21,7 @@
 #ifndef PASSREGISTRATION_H
 #define PASSREGISTRATION_H
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
 namespace qssc::hal {
@@ -32,6 +33,11 @@ llvm::Error registerTargetPasses();
 /// for the registered Targets with the
 /// QSSC system.
 llvm::Error registerTargetPipelines();
+/// Register the MLIR passes and pass pipelines of a single registered
+/// target, e.g., the target selected by a command line, rather than those
+/// of all targets. Does nothing for unknown targets. Targets are only
+/// registered once, so the other targets may be registered later on.
+llvm::Error registerTargetPassesAndPipelines(llvm::StringRef targetName);
 } // namespace qssc::hal
 
 #endif // PASSREGISTRATION_H
@@ -24,9 +24,21 @@
 
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <istream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 
 namespace qssc::hal {
 
@@ -41,5 +53,118 @@ protected:
 
   uint numQubits;
 };
+
+/// The formats of the files a SystemConfiguration subclass is loaded from.
+/// Beside a format of its own, e.g., text, a target may read a JSON object
+/// with a schemaVersion member, or a compact binary form starting with
+/// binaryConfigurationMagic and a little-endian uint32 schema version.
+enum class ConfigurationFormat { Text, JSON, Binary };
+
+/// The 8 bytes starting a binary configuration, the last of which is 0.
+constexpr llvm::StringLiteral binaryConfigurationMagic("QSSCCFG\0");
+
+/// @brief Detect the format of the contents of a configuration file.
+ConfigurationFormat detectConfigurationFormat(llvm::StringRef contents);
+
+/// @brief Parse a JSON configuration and check its schema version.
+llvm::Expected<llvm::json::Object>
+parseJSONConfiguration(llvm::StringRef contents, uint32_t schemaVersion);
+
+/// @brief Check the header of a binary configuration, i.e., its magic and
+/// schema version, and consume it from contents.
+llvm::Error consumeBinaryConfigurationHeader(llvm::StringRef &contents,
+                                             uint32_t schemaVersion);
+
+/// @brief Consume a little-endian uint32 from a binary configuration.
+llvm::Expected<uint32_t> consumeBinaryUInt32(llvm::StringRef &contents);
+
+void writeBinaryConfigurationHeader(llvm::raw_ostream &os,
+                                    uint32_t schemaVersion);
+void writeBinaryUInt32(llvm::raw_ostream &os, uint32_t value);
+
+/// @brief The version of a configuration file, i.e., its size and time of
+/// last modification.
+struct ConfigurationFileStamp {
+  llvm::sys::TimePoint<> modificationTime;
+  uint64_t size = 0;
+
+  bool operator==(const ConfigurationFileStamp &other) const {
+    return modificationTime == other.modificationTime && size == other.size;
+  }
+};
+
+llvm::Expected<ConfigurationFileStamp>
+getConfigurationFileStamp(llvm::StringRef path);
+
+/// @brief A process-level cache of the configurations of a target, keyed by
+/// path and file stamp, so that building a target for each compilation of a
+/// batch or server does not reparse its configuration. A configuration is
+/// reloaded once its file changes. Configurations are shared between the
+/// targets built from them, and hence immutable.
+template <typename ConfigurationT>
+class SystemConfigurationCache {
+public:
+  using Loader = llvm::function_ref<
+      llvm::Expected<std::unique_ptr<ConfigurationT>>(llvm::StringRef path)>;
+
+  static SystemConfigurationCache &instance() {
+    static SystemConfigurationCache cache;
+    return cache;
+  }
+
+  /// @brief Get the configuration at path, loading it with loader if it is
+  /// not cached or its file changed.
+  llvm::Expected<std::shared_ptr<const ConfigurationT>>
+  getOrLoad(llvm::StringRef path, Loader loader) {
+    auto stamp = getConfigurationFileStamp(path);
+    if (!stamp)
+      return stamp.takeError();
+
+    {
+      std::lock_guard<std::mutex> const lock(mutex);
+      auto it = entries.find(path.str());
+      if (it != entries.end() && it->second.first == *stamp) {
+        ++numHits;
+        return it->second.second;
+      }
+    }
+
+    // Loaded without the lock, a concurrent load of the same file may win.
+    auto loaded = loader(path);
+    if (!loaded)
+      return loaded.takeError();
+    std::shared_ptr<const ConfigurationT> configuration = std::move(*loaded);
+
+    std::lock_guard<std::mutex> const lock(mutex);
+    ++numLoads;
+    entries[path.str()] = {*stamp, configuration};
+    return configuration;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> const lock(mutex);
+    entries.clear();
+  }
+
+  size_t getNumHits() const {
+    std::lock_guard<std::mutex> const lock(mutex);
+    return numHits;
+  }
+
+  size_t getNumLoads() const {
+    std::lock_guard<std::mutex> const lock(mutex);
+    return numLoads;
+  }
+
+private:
+  SystemConfigurationCache() = default;
+
+  mutable std::mutex mutex; // guards entries and the counts
+  std::map<std::string, std::pair<ConfigurationFileStamp,
+                                  std::shared_ptr<const ConfigurationT>>>
+      entries;
+  size_t numHits = 0;
+  size_t numLoads = 0;
+};
 } // namespace qssc::hal
 #endif // QSSC_SYSTEMCONFIGURATION_H
@@ -48,40 +48,21 @@ protected:
   virtual void runOnOperation(TargetT &target) = 0;
 
   /**
-   * Gets the target system.
+   * Gets the target system, which is cached per context by the registry.
    * @return A non-owning pointer to the target system.
    */
   TargetT *getTargetSystemOrFail() {
-    auto targetInfo =
-        registry::TargetSystemRegistry::lookupPluginInfo(TargetT::name);
-    if (!targetInfo) {
-      llvm::errs() << "Error: target '" << TargetT::name
-                   << "' is not registered.\n";
+    auto target = registry::TargetSystemRegistry::lookupTarget(
+        &mlir::OperationPass<OpT>::getContext(), TargetT::name,
+        TargetT::childNames);
+    if (!target) {
+      llvm::errs() << "Error: failed to get target '" << TargetT::name
+                   << "':\n";
+      llvm::errs() << target.takeError();
       mlir::OperationPass<OpT>::signalPassFailure();
       return nullptr;
     }
 
-    auto target =
-        targetInfo.value()->getTarget(&mlir::OperationPass<OpT>::getContext());
-    if (!target) {
-      // look for a child target that matches
-      for (const auto &childName : TargetT::childNames) {
-        targetInfo =
-            registry::TargetSystemRegistry::lookupPluginInfo(childName);
-        target = targetInfo.value()->getTarget(
-            &mlir::OperationPass<OpT>::getContext());
-        if (targetInfo && target)
-          break;
-      }
-      if (!target) {
-        llvm::errs() << "Error: failed to get target '" << TargetT::name
-                     << "':\n";
-        llvm::errs() << target.takeError();
-        mlir::OperationPass<OpT>::signalPassFailure();
-        return nullptr;
-      }
-    }
-
     auto *castedTarget = dynamic_cast<TargetT *>(target.get());
     if (!castedTarget) {
       llvm::errs() << "Error: target registered as '" << TargetT::name
@@ -24,11 +24,13 @@
 
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/iterator_range.h"
+#include "llvm/Support/Error.h"
 
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
 
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
@@ -63,6 +65,7 @@ public:
   template <class TargetType>
   std::vector<TargetType *> getChildrenOfType() const {
     std::vector<TargetType *> filteredChildren;
+    const std::lock_guard<std::mutex> lock(childrenMutex_);
     for (auto &child : getChildren_())
       if (auto casted = dynamic_cast<TargetType *>(child.get()))
         filteredChildren.push_back(casted);
@@ -109,6 +112,18 @@ public:
   /// to ensure MLIR's parallelization rules are obeyed.
   /// @param pm A pass manager that will operate *only* on this target's module
   virtual llvm::Error addPasses(mlir::PassManager &pm) = 0;
+  /// @brief Hook called by the TargetCompilationManager after the passes of
+  /// this target ran on its module and before its children are walked. This
+  /// is useful for targets which only create the children the module needs,
+  /// e.g., the instruments of the nodes the module was localized to, rather
+  /// than all children the configuration allows for when constructed. It is
+  /// called by every compilation, possibly concurrently, and must keep the
+  /// children it created before as later compilations reuse them.
+  /// @param targetModuleOp The target module after application of the target's
+  /// passes.
+  virtual llvm::Error instantiateChildren(mlir::ModuleOp targetModuleOp) {
+    return llvm::Error::success();
+  }
   /// @brief Compile and emit the target outputs to the supplied payload.
   /// This will also call and populate addPasses for this target and run the
   /// corresponding pass pipeline. Will be invoked *before* emitToPayload
@@ -130,6 +145,19 @@ public:
   /// @param payload The payload to populate for this target.
   virtual llvm::Error emitToPayloadPostChildren(mlir::ModuleOp targetModuleOp,
                                                 payload::Payload &payload);
+  /// @brief Whether emitToPayload only accesses the operations of this
+  /// target's module outside of the modules of its children. The payload of
+  /// such targets is emitted concurrently with the compilation of their
+  /// children rather than before it.
+  virtual bool emitsIndependentlyOfChildren() const { return false; }
+  /// @brief Fingerprint of the configuration the compilation and payload of
+  /// this target depend on besides its module. Targets without children which
+  /// provide one have their payload reused by later compilations of an
+  /// unchanged module with an unchanged fingerprint instead of recompiling
+  /// them. Returns std::nullopt if the target must always be recompiled.
+  virtual std::optional<std::string> getConfigurationFingerprint() const {
+    return std::nullopt;
+  }
 
   virtual ~Target() = default;
 
@@ -153,6 +181,9 @@ protected:
 
   /// @brief Children targets storage.
   std::vector<std::unique_ptr<Target>> children_;
+  /// @brief Guards children_, to which children may be added while other
+  /// compilations walk them.
+  mutable std::mutex childrenMutex_;
 
 private:
   mlir::TimingScope rootTimer;
@@ -174,6 +205,7 @@ public:
   getModule(mlir::ModuleOp parentModuleOp) override;
 
   void addChild(std::unique_ptr<Target> child) {
+    const std::lock_guard<std::mutex> lock(childrenMutex_);
     children_.push_back(std::move(child));
   }
 
@@ -40,6 +40,9 @@ public:
   ~TargetSystemInfo();
 
   /// Create the target system and register it under the given context.
+  /// Targets are shared between the contexts they are created for with the
+  /// same configuration, unless its file changed in the meantime, and may be
+  /// created concurrently.
   llvm::Expected<qssc::hal::TargetSystem *>
   createTarget(mlir::MLIRContext *context,
                std::optional<PluginInfo::PluginConfiguration> configuration);
@@ -51,12 +54,18 @@ public:
   llvm::Expected<qssc::hal::TargetSystem *>
   getTarget(mlir::MLIRContext *context) const;
 
-  /// Register this target's MLIR passes with the QSSC system.
-  /// Should only be called once on initialization.
+  /// Unregister the target system of the given context, which is about to be
+  /// destroyed. The target stays shared with the other contexts it was
+  /// created for.
+  void releaseTarget(mlir::MLIRContext *context);
+
+  /// Register this target's MLIR passes with the QSSC system. Only the
+  /// first call registers them, so that targets may be registered when they
+  /// are first selected.
   llvm::Error registerTargetPasses() const;
 
-  /// Register this target's MLIR passe pipelines with the QSSC system.
-  /// Should only be called once on initialization.
+  /// Register this target's MLIR passe pipelines with the QSSC system. Only
+  /// the first call registers them.
   llvm::Error registerTargetPassPipelines() const;
 
 private:
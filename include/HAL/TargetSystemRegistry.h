@@ -19,6 +19,12 @@
 #include "Plugin/PluginRegistry.h"
 #include "TargetSystemInfo.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <string>
+
 namespace qssc::hal::registry {
 
 class TargetSystemRegistry
@@ -42,6 +48,23 @@ public:
   }
 
   static TargetSystemInfo *nullTargetSystemInfo();
+
+  /// Unregister the targets of all target systems for the given context,
+  /// which is about to be destroyed.
+  static void releaseTargets(mlir::MLIRContext *context);
+
+  /// Get the target system registered as name for the given context or,
+  /// if there is none, the first target registered for it as one of
+  /// fallbackNames. The target found is cached per context until targets are
+  /// created or released for the context, so that passes may look their
+  /// target up for each operation they run on, concurrently.
+  static llvm::Expected<TargetSystem *>
+  lookupTarget(mlir::MLIRContext *context, llvm::StringRef name,
+               llvm::ArrayRef<std::string> fallbackNames = {});
+
+  /// Forget the cached targets of the given context, or of all contexts for
+  /// nullptr, whose target is the default of every context.
+  static void invalidateTargetCache(mlir::MLIRContext *context);
 };
 
 } // namespace qssc::hal::registry
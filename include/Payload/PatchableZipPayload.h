@@ -24,14 +24,23 @@
 #include "Arguments/Arguments.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <zip.h>
 
 namespace qssc::payload {
+class MappedZipArchive;
+struct ZipIndex;
+
 class PatchableZipPayload : public PatchablePayload {
 public:
   PatchableZipPayload(std::string path, bool enableInMemory)
@@ -50,12 +59,26 @@ public:
 
   llvm::Error writeBack() override;
   llvm::Error writeString(std::string *outputString) override;
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> writeBuffer() override;
+  llvm::Error writeStringWithMembers(
+      std::string *outputString,
+      const std::map<std::string, ContentBuffer> &members) override;
   void discardChanges();
 
   using ContentBuffer = std::vector<char>;
 
   llvm::Expected<ContentBuffer &>
   readMember(llvm::StringRef path, bool markForWriteBack = true) override;
+  // view a stored member in a mapping of the payload file, or in a copy of an
+  // in memory payload. Patches to a payload file only write the pages they
+  // touch.
+  llvm::Expected<llvm::MutableArrayRef<char>>
+  readMemberInPlace(llvm::StringRef path) override;
+  // decompress the compressed members among paths in parallel, each worker
+  // reading its share of the members through an archive of its own as libzip
+  // archives may not be shared by threads
+  llvm::Error prefetchMembers(llvm::ArrayRef<std::string> paths,
+                              bool markForWriteBack = true) override;
 
   struct zip *getBackingZip() {
     if (auto err = ensureOpen()) {
@@ -74,14 +97,39 @@ private:
 
   std::string const path;
   struct zip *zip;
-  zip_source_t *inMemoryZipSource;
+  zip_source_t *inMemoryZipSource = nullptr;
   bool enableInMemory;
 
   std::unordered_map<std::string, TrackedFile> files;
+  // serializes readMember as libzip archives may not be shared by threads
+  std::mutex readMutex;
+
+  // index of the members of the payload, shared with the payloads of the
+  // same module
+  std::shared_ptr<const ZipIndex> index;
+
+  // mapping of the payload holding the members patched in place
+  std::unique_ptr<MappedZipArchive> mapped;
+  // names of the members patched in place
+  std::vector<std::string> patchedInPlace;
+  // whether the payload was written back from the mapping
+  bool writtenInPlace = false;
 
   llvm::Error ensureOpen();
+  llvm::Error ensureMapped();
+  // read the index of the members of the payload, from the cache of indices
+  // of the process where possible
+  llvm::Error ensureIndexed();
+  // open a read only archive over the payload, independent of zip
+  llvm::Expected<zip_t *> openReadOnly();
+  // whether all changed members are stored with their size unchanged, so that
+  // they can be written back in place
+  bool canWriteBackInPlace();
+  // write the changed members back in place without libzip, rewriting only
+  // the changed bytes and the checksums
+  llvm::Error writeBackInPlace();
   llvm::Error addFileToZip(zip_t *zip, const std::string &path,
-                           ContentBuffer &buf, zip_error_t &err);
+                           llvm::ArrayRef<char> buf, zip_error_t &err);
 };
 
 llvm::Error extractLibZipError(llvm::StringRef info, zip_error_t &zipError);
@@ -23,24 +23,73 @@
 
 #include <Config/QSSConfig.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace qssc::payload {
 
+// compression applied to a payload member
+struct CompressionPolicy {
+  qssc::config::PayloadCompression method =
+      qssc::config::PayloadCompression::Store;
+  // codec specific level, 0 selects the default level of the codec
+  int level = 0;
+};
+
 struct PayloadConfig {
   std::string prefix;
   std::string name;
   qssc::config::QSSVerbosity verbosity;
+  // compression of the payload members
+  CompressionPolicy compression{};
+  // optional per-member compression, overriding the above
+  std::function<CompressionPolicy(llvm::StringRef fileName)> compressionFor;
+  // form of the debug artifacts, e.g., IR dumps, emitted by the targets
+  qssc::config::PayloadDebugArtifacts debugArtifacts =
+      qssc::config::PayloadDebugArtifacts::Text;
+  // whether the files of each group, e.g., of an instrument, are archived
+  // contiguously with an index of their byte ranges, if supported
+  bool splitByGroup = false;
+  // directory of the content-addressed store of members, empty for none.
+  // Members found in the store are referred to rather than archived, if
+  // supported.
+  std::string blobStore;
 };
 
+// A stream collecting a payload file in chunks of growing size, so that the
+// contents written so far are never moved as the file grows
+class ChunkedFileStream : public llvm::raw_ostream {
+public:
+  ChunkedFileStream() = default;
+  ~ChunkedFileStream() override { flush(); }
+
+  // return the contents written so far, leaving the stream empty
+  std::string take();
+
+private:
+  void write_impl(const char *ptr, size_t size) override;
+  uint64_t current_pos() const override { return totalSize; }
+
+  std::vector<std::string> chunks;
+  size_t totalSize = 0;
+}; // class ChunkedFileStream
+
 // Payload class will wrap the QSS Payload and interface with the qss-compiler
 class Payload {
 public:
@@ -51,7 +100,11 @@ public:
       : prefix(""), name("exp"), verbosity(qssc::config::QSSVerbosity::Warn) {}
   explicit Payload(PayloadConfig config)
       : prefix(std::move(config.prefix) + "/"), name(std::move(config.name)),
-        verbosity(config.verbosity) {
+        verbosity(config.verbosity), compression(config.compression),
+        compressionFor(std::move(config.compressionFor)),
+        debugArtifacts(config.debugArtifacts),
+        splitByGroup(config.splitByGroup),
+        blobStore(std::move(config.blobStore)) {
     files.clear();
   }
   virtual ~Payload() = default;
@@ -60,6 +113,11 @@ public:
   std::string *getFile(const std::string &fName);
   // get/add the file fName and return a pointer to its data
   std::string *getFile(const char *fName);
+  // get a stream appending to the file fName. Within an emission scope the
+  // stream is private to the scope, requiring no locking, and its contents
+  // are appended to the file once the scope ends. Otherwise writes go to the
+  // file directly.
+  llvm::raw_ostream &getFileStream(const std::string &fName);
   // write all files to the stream
   virtual void write(llvm::raw_ostream &stream) = 0;
   // write all files to the stream
@@ -68,17 +126,80 @@ public:
   virtual void writePlain(std::ostream &stream) = 0;
   virtual void writePlain(llvm::raw_ostream &stream) = 0;
   virtual void addFile(llvm::StringRef filename, llvm::StringRef str) = 0;
+  // archive files in the background once they are sealed, if supported
+  virtual void enableStreaming() {}
 
   const std::string &getName() const { return name; }
+  // form of the debug artifacts targets should emit, which the instruments do
+  // not execute
+  qssc::config::PayloadDebugArtifacts getDebugArtifacts() const {
+    return debugArtifacts;
+  }
+  void setDebugArtifacts(qssc::config::PayloadDebugArtifacts artifacts) {
+    debugArtifacts = artifacts;
+  }
   const std::string &getPrefix() const { return prefix; }
 
+  // Scope of an emission to the payload on the current thread. Files added on
+  // the thread while the scope is active are sealed, i.e., declared complete,
+  // when the scope ends. If emittedFiles is given the contents of these files
+  // are copied into it by file name before they are sealed. If group is given
+  // the files are assigned to it, e.g., to the instrument emitting them.
+  class EmissionScope {
+  public:
+    explicit EmissionScope(
+        Payload &payload,
+        std::map<std::string, std::string> *emittedFiles = nullptr,
+        llvm::StringRef group = "");
+    ~EmissionScope();
+
+    EmissionScope(const EmissionScope &) = delete;
+    EmissionScope &operator=(const EmissionScope &) = delete;
+
+  private:
+    friend class Payload;
+
+    Payload &payload;
+    std::vector<std::filesystem::path> fileNames;
+    // streams of the files written in the scope
+    std::unordered_map<std::string, std::unique_ptr<ChunkedFileStream>>
+        streams;
+    std::map<std::string, std::string> *emittedFiles;
+    std::string group;
+    EmissionScope *previous;
+  }; // class EmissionScope
+
 protected:
+  // called with the files of an emission scope once they are complete
+  virtual void sealFiles(std::vector<std::filesystem::path> fileNames) {}
+  // record a file added on this thread in its active emission scope
+  void recordEmission(const std::filesystem::path &fName);
+  // return the active emission scope of this payload on this thread, if any
+  EmissionScope *findEmissionScope();
+  // append the files written to the streams of an ending emission scope
+  void commitStreams(EmissionScope &scope);
+  // copy the contents of the files of an ending emission scope
+  void copyEmittedFiles(EmissionScope &scope);
+  // assign the files of an ending emission scope to its group
+  void groupEmittedFiles(EmissionScope &scope);
+  // return the group of the file fName, empty if it has none. Requires the
+  // lock to be held.
+  std::string getGroup(const std::filesystem::path &fName) const {
+    auto pos = fileGroups.find(fName);
+    return pos == fileGroups.end() ? std::string() : pos->second;
+  }
+
   // Class mutex
   std::mutex _mtx;
 
   // return an ordered list of filenames
   auto orderedFileNames() -> std::vector<std::filesystem::path>;
 
+  // return the compression of the file fName
+  CompressionPolicy getCompression(const std::filesystem::path &fName) const {
+    return compressionFor ? compressionFor(fName.native()) : compression;
+  }
+
   // A hash function object to work with unordered_* containers:
   struct PathHash {
     std::size_t operator()(std::filesystem::path const &p) const noexcept {
@@ -89,7 +210,18 @@ protected:
   std::string prefix;
   std::string name;
   qssc::config::QSSVerbosity verbosity;
+  CompressionPolicy compression;
+  std::function<CompressionPolicy(llvm::StringRef fileName)> compressionFor;
+  qssc::config::PayloadDebugArtifacts debugArtifacts =
+      qssc::config::PayloadDebugArtifacts::Text;
+  bool splitByGroup = false;
+  std::string blobStore;
   std::unordered_map<std::filesystem::path, std::string, PathHash> files;
+  // groups of the files emitted in an emission scope with a group
+  std::unordered_map<std::filesystem::path, std::string, PathHash> fileGroups;
+  // streams of the files written outside of an emission scope
+  std::unordered_map<std::string, std::unique_ptr<llvm::raw_string_ostream>>
+      fileStreams;
 }; // class Payload
 
 // PatchablePayload for payloads that support patching after compilation
@@ -97,10 +229,47 @@ class PatchablePayload {
 public:
   virtual ~PatchablePayload() = default;
   using ContentBuffer = std::vector<char>;
+  // read a member of the payload. Implementations must allow concurrent
+  // reads of distinct members.
   virtual llvm::Expected<ContentBuffer &>
   readMember(llvm::StringRef path, bool markForWriteBack = true) = 0;
+  // view a member of the payload to be patched in place, which is only
+  // possible for members stored uncompressed. The view remains valid until
+  // the payload is written back. Members read with readMember may not be
+  // viewed.
+  virtual llvm::Expected<llvm::MutableArrayRef<char>>
+  readMemberInPlace(llvm::StringRef path) {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Payload does not support patching members in place");
+  }
+  // read the members among paths which can not be viewed in place ahead of
+  // readMember, concurrently where the payload supports it, so that patching
+  // does not wait on reading them one at a time. Members which fail to be
+  // read are left to readMember to report.
+  virtual llvm::Error prefetchMembers(llvm::ArrayRef<std::string> paths,
+                                      bool markForWriteBack = true) {
+    return llvm::Error::success();
+  }
   virtual llvm::Error writeBack() = 0;
   virtual llvm::Error writeString(std::string *outputString) = 0;
+  // hand out the payload as written back as a buffer
+  virtual llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> writeBuffer() {
+    std::string outputString;
+    if (auto err = writeString(&outputString))
+      return std::move(err);
+    return llvm::MemoryBuffer::getMemBufferCopy(outputString);
+  }
+  // write the payload with the given members replaced to the string, leaving
+  // this payload unchanged. May be called concurrently once all members have
+  // been read.
+  virtual llvm::Error
+  writeStringWithMembers(std::string *outputString,
+                         const std::map<std::string, ContentBuffer> &members) {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Payload does not support writing replaced members");
+  }
 }; // class PatchablePayload
 
 } // namespace qssc::payload
@@ -0,0 +1,100 @@
+//===- ZipPayloadReader.h - Lazy reads of zip payloads ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file declares the reader of the members of indexed zip payloads
+///  through byte range reads, e.g., of a payload held by an object store.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_ZIP_PAYLOAD_READER_H
+#define PAYLOAD_ZIP_PAYLOAD_READER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qssc::payload {
+
+// Reads single members of a zip payload written with a member index, i.e.,
+// a streamed payload whose manifest refers to "manifest/index.json", without
+// reading the rest of the payload. Opening the payload reads its last bytes,
+// whose archive comment locates the index, and then the index, which holds
+// the offset, sizes, compression method, checksum and owning target of
+// every member. Each member is then read with a single range read.
+//
+// Members of thin payloads, written with a blob store, may be held by the
+// store rather than the payload, in which case they are only listed with
+// the SHA-256 of their contents, which is the name of their blob.
+class ZipPayloadReader {
+public:
+  // read size bytes of the payload from offset
+  using RangeReader =
+      std::function<llvm::Expected<std::string>(uint64_t offset,
+                                                uint64_t size)>;
+
+  struct Member {
+    std::string name;
+    // target which emitted the member, e.g., an instrument, empty for none
+    std::string target;
+    // offset of the contents of the member in the payload
+    uint64_t offset = 0;
+    uint64_t compressedSize = 0;
+    uint64_t size = 0;
+    uint16_t method = 0;
+    uint32_t crc = 0;
+    // SHA-256 of the contents in hex
+    std::string sha256;
+    // whether the contents are held by a blob store rather than the payload
+    bool inBlobStore = false;
+  };
+
+  // open the payload of payloadSize bytes read by readRange. Fails if the
+  // payload has no member index.
+  static llvm::Expected<ZipPayloadReader> open(RangeReader readRange,
+                                               uint64_t payloadSize);
+
+  // get the members of the payload in archive order
+  const std::vector<Member> &getMembers() const { return members; }
+  // get the members emitted by target
+  std::vector<const Member *> getMembersOf(llvm::StringRef target) const;
+  // find the member named name, null if there is none
+  const Member *find(llvm::StringRef name) const;
+
+  // read and decompress the contents of the member named name, verifying
+  // their checksum. Fails for members held by a blob store.
+  llvm::Expected<std::string> readMember(llvm::StringRef name) const;
+  llvm::Expected<std::string> readMember(const Member &member) const;
+
+private:
+  ZipPayloadReader(RangeReader readRange, uint64_t payloadSize)
+      : readRange(std::move(readRange)), payloadSize(payloadSize) {}
+
+  // parse the index of the members
+  llvm::Error parseIndex(llvm::StringRef index);
+
+  RangeReader readRange;
+  uint64_t payloadSize;
+  std::vector<Member> members;
+};
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_ZIP_PAYLOAD_READER_H
@@ -15,12 +15,21 @@
 #define PLUGINREGISTRY_H
 
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ManagedStatic.h"
 
+#include <atomic>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 
 namespace qssc::plugin::registry {
 
+/// Plugins are registered while the process starts, e.g., by static
+/// initializers, after which the registry is frozen and lookups may be
+/// performed concurrently without locking. Until then lookups and
+/// registrations are serialized by a lock. The plugin infos of a frozen
+/// registry are never modified by the registry.
 template <typename PluginInfo>
 struct PluginRegistry {
 
@@ -28,9 +37,15 @@ public:
   PluginRegistry(const PluginRegistry &) = delete;
   void operator=(const PluginRegistry &) = delete;
 
+  /// @brief Register a plugin. Fails if a plugin is already registered
+  /// under name or if the registry is frozen.
   template <typename... Args>
   static bool registerPlugin(llvm::StringRef name, Args &&...args) {
     PluginRegistry &pluginRegistry = instance();
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::unique_lock const lock(pluginRegistry.mutex);
+    if (pluginRegistry.frozen.load(std::memory_order_relaxed))
+      return false;
     auto [_, inserted] =
         pluginRegistry.registry.try_emplace(name, std::forward<Args>(args)...);
     return inserted;
@@ -38,24 +53,35 @@ public:
 
   static std::optional<PluginInfo *>
   lookupPluginInfo(llvm::StringRef pluginName) {
-    PluginRegistry &pluginRegistry = instance();
-    auto it = pluginRegistry.registry.find(pluginName);
-    if (it == pluginRegistry.registry.end())
-      return std::nullopt;
-    return &it->second;
+    return instance().find(pluginName);
   }
 
   static bool pluginExists(llvm::StringRef targetName) {
-    PluginRegistry &pluginRegistry = instance();
-    auto it = pluginRegistry.registry.find(targetName);
-    return it != pluginRegistry.registry.end();
+    return instance().find(targetName).has_value();
   }
 
+  /// @brief Get the registered plugins, freezing the registry so that they
+  /// may not change while they are iterated.
   static const llvm::StringMap<PluginInfo> &registeredPlugins() {
+    freeze();
     PluginRegistry const &pluginRegistry = instance();
     return pluginRegistry.registry;
   }
 
+  /// @brief Stop accepting registrations. Lookups no longer lock afterwards.
+  static void freeze() {
+    PluginRegistry &pluginRegistry = instance();
+    if (pluginRegistry.frozen.load(std::memory_order_acquire))
+      return;
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::unique_lock const lock(pluginRegistry.mutex);
+    pluginRegistry.frozen.store(true, std::memory_order_release);
+  }
+
+  static bool isFrozen() {
+    return instance().frozen.load(std::memory_order_acquire);
+  }
+
 private:
   PluginRegistry() = default;
 
@@ -64,8 +90,25 @@ private:
     return pluginRegistry;
   }
 
+  std::optional<PluginInfo *> find(llvm::StringRef pluginName) {
+    auto lookup = [&]() -> std::optional<PluginInfo *> {
+      auto it = registry.find(pluginName);
+      if (it == registry.end())
+        return std::nullopt;
+      return &it->second;
+    };
+    if (frozen.load(std::memory_order_acquire))
+      return lookup();
+    // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
+    std::shared_lock const lock(mutex);
+    return lookup();
+  }
+
 private:
   llvm::StringMap<PluginInfo> registry;
+  // guards registry until frozen
+  std::shared_mutex mutex;
+  std::atomic<bool> frozen{false};
 };
 
 } // namespace qssc::plugin::registry
@@ -24,8 +24,11 @@
 #define QSSC_H
 
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <memory>
 #include <optional>
@@ -74,6 +77,58 @@ llvm::StringRef getResourcesDir();
 /// \returns path to static resources for target.
 llvm::SmallString<128> getTargetResourcesDir(hal::Target const *target);
 
+/// The name of the resource pack below getResourcesDir.
+constexpr llvm::StringLiteral resourcePackName = "resources.qrp";
+
+/// A single indexed file of static resources, which is mapped rather than
+/// read so that the resources are views into the pages of the pack. The
+/// pack consists of the magic "QSSCRES1", the number of resources and, for
+/// each resource, the sizes of its path and contents and the offset of its
+/// contents, followed by their paths and contents. Integers are 64 bit
+/// little endian.
+class ResourcePack {
+public:
+  /// Map the pack at path.
+  static llvm::Expected<std::unique_ptr<ResourcePack>>
+  open(llvm::StringRef path);
+
+  /// Index the pack held by buffer.
+  static llvm::Expected<std::unique_ptr<ResourcePack>>
+  create(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+  /// Write the pack of the regular files below dir, with their paths
+  /// relative to dir, omitting any resource pack of dir itself.
+  static llvm::Error write(llvm::StringRef dir, llvm::raw_ostream &os);
+
+  /// Get the resource at path, relative to the packed directory.
+  std::optional<llvm::MemoryBufferRef> lookup(llvm::StringRef path) const;
+
+  size_t size() const { return resources.size(); }
+
+private:
+  explicit ResourcePack(std::unique_ptr<llvm::MemoryBuffer> buffer)
+      : buffer(std::move(buffer)) {}
+
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  llvm::StringMap<llvm::StringRef> resources;
+};
+
+/// Provide the contents of the static resource at path, relative to
+/// getResourcesDir. The resources are served from its resource pack, which
+/// is opened once per process, if it has one, and are read from the files
+/// of the directory otherwise, each at most once per process.
+///
+/// \param path the path of the resource, with / separators.
+///
+/// eturns a view of the resource which is valid for the lifetime of the
+/// process.
+llvm::Expected<llvm::MemoryBufferRef> getResource(llvm::StringRef path);
+
+/// Provide the contents of the static resource at path, relative to
+/// getTargetResourcesDir of target, as getResource does.
+llvm::Expected<llvm::MemoryBufferRef>
+getTargetResource(hal::Target const *target, llvm::StringRef path);
+
 }; // namespace qssc
 
 #endif // QSSC_H
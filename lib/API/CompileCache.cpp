@@ -0,0 +1,246 @@
+//===- CompileCache.cpp -----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the content-addressed cache of compilation results.
+///
+//===----------------------------------------------------------------------===//
+
+#include "CompileCache.h"
+
+#include "Config/QSSConfig.h"
+#include "HAL/Compile/MetricsRegistry.h"
+#include "QSSC.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+using namespace qssc::api;
+
+namespace {
+/// Upper bound of the in-memory cache size in bytes.
+constexpr size_t maxInMemorySize = 256 * 1024 * 1024;
+
+/// Count a lookup of the cache by its result, i.e., a hit in memory or on
+/// disk, or a miss.
+void countLookup_(llvm::StringRef result) {
+  qssc::hal::compile::MetricsRegistry::instance().increment(
+      "qssc_compile_cache_lookups_total",
+      "Lookups of compilation outputs, checkpoints and parametric templates "
+      "in the compile cache",
+      {{"result", result.str()}});
+}
+
+/// Hash a length prefixed field so that adjacent fields cannot alias.
+void hashField_(llvm::SHA256 &hasher, llvm::StringRef field) {
+  uint64_t const size = field.size();
+  hasher.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(&size), sizeof(size)));
+  hasher.update(field);
+}
+
+llvm::Error hashFile_(llvm::SHA256 &hasher, llvm::StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return llvm::createStringError(buffer.getError(),
+                                   "Unable to read " + path + " for hashing");
+  hashField_(hasher, (*buffer)->getBuffer());
+  return llvm::Error::success();
+}
+
+llvm::SmallString<128> entryPath_(llvm::StringRef cacheDir,
+                                  llvm::StringRef key) {
+  llvm::SmallString<128> path(cacheDir);
+  llvm::sys::path::append(path, key);
+  return path;
+}
+
+/// Hash the target and the contents of its configuration.
+llvm::Error hashTarget_(llvm::SHA256 &hasher,
+                        const qssc::config::QSSConfig &config) {
+  hashField_(hasher, config.getTargetName().value_or(""));
+  auto targetConfigPath = config.getTargetConfigPath();
+  hashField_(hasher, targetConfigPath.value_or(""));
+  if (targetConfigPath.has_value() &&
+      llvm::sys::fs::is_regular_file(*targetConfigPath))
+    if (auto err = hashFile_(hasher, *targetConfigPath))
+      return err;
+  return llvm::Error::success();
+}
+
+/// Hash the input program.
+llvm::Error hashInput_(llvm::SHA256 &hasher,
+                       const qssc::config::QSSConfig &config) {
+  if (config.isDirectInput()) {
+    hashField_(hasher, config.getInputSource());
+    return llvm::Error::success();
+  }
+  return hashFile_(hasher, config.getInputSource());
+}
+
+/// Hash everything but the input program which determines a compilation.
+llvm::Error hashCompilation_(llvm::SHA256 &hasher,
+                             const qssc::config::QSSConfig &config,
+                             llvm::StringRef optionsKey) {
+  using namespace qssc;
+
+  hashField_(hasher, qssc::getQSSCVersion());
+  hashField_(hasher, optionsKey);
+  hashField_(hasher, config::to_string(config.getInputType()));
+  hashField_(hasher, config::to_string(config.getEmitAction()));
+
+  // Payload members are named after the output file.
+  if (config.getEmitAction() == config::EmitAction::QEM ||
+      config.getEmitAction() == config::EmitAction::QEQEM)
+    hashField_(hasher, llvm::sys::path::stem(config.getOutputFilePath()));
+
+  return hashTarget_(hasher, config);
+}
+} // anonymous namespace
+
+CompileCache &CompileCache::instance() {
+  static CompileCache cache;
+  return cache;
+}
+
+llvm::Expected<std::string>
+CompileCache::computeKey(const config::QSSConfig &config,
+                         llvm::StringRef optionsKey) {
+  llvm::SHA256 hasher;
+  if (auto err = hashCompilation_(hasher, config, optionsKey))
+    return std::move(err);
+
+  if (auto err = hashInput_(hasher, config))
+    return std::move(err);
+
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+llvm::Expected<std::string>
+CompileCache::computeCheckpointKey(const config::QSSConfig &config,
+                                   config::CheckpointStage stage,
+                                   llvm::StringRef stageOptionsKey) {
+  llvm::SHA256 hasher;
+  hashField_(hasher, "checkpoint");
+  hashField_(hasher, config::to_string(stage));
+  hashField_(hasher, qssc::getQSSCVersion());
+  hashField_(hasher, stageOptionsKey);
+  hashField_(hasher, config::to_string(config.getInputType()));
+
+  // The command line passes may include passes of the target.
+  if (stage == config::CheckpointStage::Passes)
+    if (auto err = hashTarget_(hasher, config))
+      return std::move(err);
+
+  if (auto err = hashInput_(hasher, config))
+    return std::move(err);
+
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::string CompileCache::computeTemplateKey(const config::QSSConfig &config,
+                                             llvm::StringRef optionsKey,
+                                             llvm::StringRef templateIR) {
+  llvm::SHA256 hasher;
+  hashField_(hasher, "template");
+  // Unreadable target configurations only weaken the key to their path.
+  llvm::consumeError(hashCompilation_(hasher, config, optionsKey));
+  hashField_(hasher, templateIR);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::optional<std::string>
+CompileCache::lookup(llvm::StringRef key,
+                     std::optional<llvm::StringRef> cacheDir) {
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+      countLookup_("memory-hit");
+      return it->second;
+    }
+  }
+
+  if (!cacheDir.has_value()) {
+    countLookup_("miss");
+    return std::nullopt;
+  }
+
+  auto buffer = llvm::MemoryBuffer::getFile(entryPath_(*cacheDir, key),
+                                            /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    countLookup_("miss");
+    return std::nullopt;
+  }
+
+  countLookup_("disk-hit");
+  std::string output = (*buffer)->getBuffer().str();
+  std::lock_guard<std::mutex> const lock(mutex);
+  insert_(key, output);
+  return output;
+}
+
+llvm::Error CompileCache::store(llvm::StringRef key, llvm::StringRef output,
+                                std::optional<llvm::StringRef> cacheDir) {
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    insert_(key, output);
+  }
+
+  if (!cacheDir.has_value())
+    return llvm::Error::success();
+
+  if (auto ec = llvm::sys::fs::create_directories(*cacheDir))
+    return llvm::createStringError(ec, "Unable to create compile cache " +
+                                           *cacheDir);
+
+  // Written to a temporary file and renamed so that concurrent compilers
+  // never observe partial entries.
+  return llvm::writeToOutput(entryPath_(*cacheDir, key),
+                             [&](llvm::raw_ostream &os) -> llvm::Error {
+                               os << output;
+                               return llvm::Error::success();
+                             });
+}
+
+void CompileCache::insert_(llvm::StringRef key, llvm::StringRef output) {
+  if (output.size() > maxInMemorySize || entries.count(key))
+    return;
+
+  while (totalSize + output.size() > maxInMemorySize) {
+    auto oldest = entries.find(insertionOrder.front());
+    totalSize -= oldest->second.size();
+    entries.erase(oldest);
+    insertionOrder.pop_front();
+  }
+
+  entries[key] = output.str();
+  insertionOrder.push_back(key.str());
+  totalSize += output.size();
+}
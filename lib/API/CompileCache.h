@@ -0,0 +1,110 @@
+//===- CompileCache.h -------------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the content-addressed cache of compilation results.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_COMPILE_CACHE_H
+#define QSS_COMPILER_COMPILE_CACHE_H
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace qssc::api {
+
+/// @brief A cache of compilation outputs addressed by a hash over everything
+/// that determines them: the compiler version, the command line options, the
+/// target configuration and the input program. Entries are kept in memory for
+/// the lifetime of the process and, if a cache directory is configured, on
+/// disk to be shared between processes.
+///
+/// Checkpoints of the module after intermediate stages of a compilation are
+/// cached alongside, keyed by their own hashes.
+///
+/// Note that files included by the input program are not part of the key.
+class CompileCache {
+public:
+  /// @brief Get the cache of this process.
+  static CompileCache &instance();
+
+  /// @brief Compute the cache key of a compilation.
+  /// @param config The configuration of the compilation.
+  /// @param optionsKey Key over the command line options of the compilation
+  /// excluding its input source and output path.
+  /// @return The hex encoded key.
+  static llvm::Expected<std::string> computeKey(const config::QSSConfig &config,
+                                                llvm::StringRef optionsKey);
+
+  /// @brief Compute the cache key of a parametric template, i.e., of all
+  /// compilations which only differ in the values of their parameters.
+  /// @param config The configuration of the compilation.
+  /// @param optionsKey Key over the command line options of the compilation
+  /// excluding its input source and output path.
+  /// @param templateIR The IR of the program with its parameter values removed.
+  /// @return The hex encoded key.
+  static std::string computeTemplateKey(const config::QSSConfig &config,
+                                        llvm::StringRef optionsKey,
+                                        llvm::StringRef templateIR);
+
+  /// @brief Compute the key of the checkpoint of a compilation after a stage.
+  /// Only the target of checkpoints after the command line passes is part of
+  /// the key, as these may include passes of the target.
+  /// @param config The configuration of the compilation.
+  /// @param stage The stage the checkpoint is taken after.
+  /// @param stageOptionsKey Key over the command line options which influence
+  /// the module up to the stage.
+  /// @return The hex encoded key.
+  static llvm::Expected<std::string>
+  computeCheckpointKey(const config::QSSConfig &config,
+                       config::CheckpointStage stage,
+                       llvm::StringRef stageOptionsKey);
+
+  /// @brief Look up the output for a key, first in-memory and then in the
+  /// cache directory if any.
+  std::optional<std::string> lookup(llvm::StringRef key,
+                                    std::optional<llvm::StringRef> cacheDir);
+
+  /// @brief Store the output for a key in-memory and in the cache directory if
+  /// any.
+  llvm::Error store(llvm::StringRef key, llvm::StringRef output,
+                    std::optional<llvm::StringRef> cacheDir);
+
+private:
+  /// Insert an entry in-memory, evicting the oldest entries beyond the size
+  /// limit. Requires the lock to be held.
+  void insert_(llvm::StringRef key, llvm::StringRef output);
+
+  std::mutex mutex;
+  llvm::StringMap<std::string> entries;
+  /// Keys in insertion order for eviction.
+  std::deque<std::string> insertionOrder;
+  size_t totalSize = 0;
+};
+
+} // namespace qssc::api
+
+#endif // QSS_COMPILER_COMPILE_CACHE_H
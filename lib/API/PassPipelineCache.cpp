@@ -0,0 +1,69 @@
+//===- PassPipelineCache.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the cache of the pass managers of the command line
+///  pass pipeline of a compilation session.
+///
+//===----------------------------------------------------------------------===//
+
+#include "PassPipelineCache.h"
+
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/Support/Error.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+using namespace qssc::api;
+
+llvm::Expected<std::unique_ptr<mlir::PassManager>>
+PassPipelineCache::acquire(const PMBuilder &populate) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (!available.empty()) {
+    auto pm = std::move(available.back());
+    available.pop_back();
+    return pm;
+  }
+
+  if (!prototype) {
+    // The first pass manager is handed out and a copy of it is kept as the
+    // prototype, so that the first job does not clone.
+    auto pm = std::make_unique<mlir::PassManager>(context);
+    if (auto err = configure(*pm))
+      return std::move(err);
+    if (auto err = populate(*pm))
+      return std::move(err);
+
+    prototype = std::make_unique<mlir::PassManager>(
+        context, pm->getOpAnchorName(), pm->getNesting());
+    static_cast<mlir::OpPassManager &>(*prototype) = *pm;
+    return pm;
+  }
+
+  auto pm = std::make_unique<mlir::PassManager>(
+      context, prototype->getOpAnchorName(), prototype->getNesting());
+  if (auto err = configure(*pm))
+    return std::move(err);
+  static_cast<mlir::OpPassManager &>(*pm) = *prototype;
+  return pm;
+}
+
+void PassPipelineCache::release(std::unique_ptr<mlir::PassManager> pm) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  available.push_back(std::move(pm));
+}
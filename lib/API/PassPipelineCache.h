@@ -0,0 +1,81 @@
+//===- PassPipelineCache.h --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the cache of the pass managers of the command line pass
+/// pipeline of a compilation session.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_PASS_PIPELINE_CACHE_H
+#define QSS_COMPILER_PASS_PIPELINE_CACHE_H
+
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/Support/Error.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace qssc::api {
+
+/// @brief A pool of the pass managers of a single command line pass
+/// pipeline, i.e., of the pipeline of the jobs of a session sharing their
+/// options. The pipeline is parsed once into a prototype which is never run
+/// itself. Jobs check out pass managers which are returned to the pool once
+/// they ran, so that the passes are only initialized, e.g., their frozen
+/// pattern sets are only built, once per pass manager rather than per job.
+/// Pass managers are cloned from the prototype when none are available,
+/// e.g., for the concurrent programs of a batch.
+///
+/// Pass managers keep their instrumentation for their lifetime, so that
+/// pass managers which are timed or otherwise instrumented for a job must
+/// not be returned to the pool.
+class PassPipelineCache {
+public:
+  using PMBuilder = std::function<llvm::Error(mlir::PassManager &)>;
+
+  /// @param context The context the pipeline runs in.
+  /// @param configure Configures each pass manager of the pool, e.g., from
+  /// the command line options of the pass manager.
+  PassPipelineCache(mlir::MLIRContext *context, PMBuilder configure)
+      : context(context), configure(std::move(configure)) {}
+
+  /// @brief Check out a pass manager of the pipeline.
+  /// @param populate Adds the passes of the pipeline to a pass manager. It is
+  /// only called if the prototype has not been built yet.
+  llvm::Expected<std::unique_ptr<mlir::PassManager>>
+  acquire(const PMBuilder &populate);
+
+  /// @brief Return a pass manager checked out by acquire to the pool.
+  void release(std::unique_ptr<mlir::PassManager> pm);
+
+private:
+  mlir::MLIRContext *context;
+  PMBuilder configure;
+
+  std::mutex mutex; // guards prototype and available
+  std::unique_ptr<mlir::PassManager> prototype;
+  std::vector<std::unique_ptr<mlir::PassManager>> available;
+};
+
+} // namespace qssc::api
+
+#endif // QSS_COMPILER_PASS_PIPELINE_CACHE_H
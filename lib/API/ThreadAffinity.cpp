@@ -0,0 +1,123 @@
+//===- ThreadAffinity.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the placement of compilations on the CPUs and NUMA
+///  nodes of the host.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ThreadAffinity.h"
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+llvm::Expected<std::vector<unsigned>>
+qssc::api::parseCPUList(llvm::StringRef list) {
+  auto malformed = [&]() {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Malformed CPU list: " + list);
+  };
+
+  std::vector<unsigned> cpus;
+  llvm::SmallVector<llvm::StringRef> ranges;
+  list.trim().split(ranges, ',', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (auto range : ranges) {
+    auto [firstStr, lastStr] = range.trim().split('-');
+    unsigned first = 0;
+    if (firstStr.getAsInteger(10, first))
+      return malformed();
+    unsigned last = first;
+    if (!lastStr.empty() && lastStr.getAsInteger(10, last))
+      return malformed();
+    if (last < first)
+      return malformed();
+    for (unsigned cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+llvm::Expected<std::vector<unsigned>>
+qssc::api::getNUMANodeCPUs(unsigned node) {
+  std::string const path =
+      "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+  auto buffer = llvm::MemoryBuffer::getFileAsStream(path);
+  if (!buffer)
+    return llvm::createStringError(buffer.getError(),
+                                   "Unable to read the CPUs of NUMA node " +
+                                       std::to_string(node) + " from " + path);
+  return parseCPUList((*buffer)->getBuffer());
+}
+
+llvm::Error qssc::api::applyCPUAffinity(const config::QSSConfig &config) {
+  std::vector<unsigned> cpus = config.getCPUAffinity();
+  if (config.getNUMANode().has_value()) {
+    auto nodeCPUs = getNUMANodeCPUs(*config.getNUMANode());
+    if (!nodeCPUs)
+      return nodeCPUs.takeError();
+    if (cpus.empty())
+      cpus = std::move(*nodeCPUs);
+    else
+      llvm::erase_if(cpus, [&](unsigned cpu) {
+        return !llvm::is_contained(*nodeCPUs, cpu);
+      });
+    if (cpus.empty())
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "The CPU affinity selects no CPU of NUMA node " +
+              std::to_string(*config.getNUMANode()));
+  }
+  if (cpus.empty())
+    return llvm::Error::success();
+
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (unsigned const cpu : cpus) {
+    if (cpu >= CPU_SETSIZE)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "CPU " + std::to_string(cpu) +
+                                         " is out of range");
+    CPU_SET(cpu, &set);
+  }
+  // Applies to the calling thread only on Linux.
+  if (sched_setaffinity(0, sizeof(set), &set) != 0)
+    return llvm::createStringError(
+        std::error_code(errno, std::generic_category()),
+        "Unable to set the CPU affinity of the compiler");
+  return llvm::Error::success();
+#else
+  return llvm::createStringError(
+      std::make_error_code(std::errc::not_supported),
+      "CPU affinity is not supported on this platform");
+#endif
+}
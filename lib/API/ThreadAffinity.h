@@ -0,0 +1,51 @@
+//===- ThreadAffinity.h -----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the placement of compilations on the CPUs and NUMA
+/// nodes of the host.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSS_COMPILER_THREAD_AFFINITY_H
+#define QSS_COMPILER_THREAD_AFFINITY_H
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <vector>
+
+namespace qssc::api {
+
+/// @brief Parse a list of CPUs such as "0-3,8,10-11", as listed for the NUMA
+/// nodes of Linux.
+llvm::Expected<std::vector<unsigned>> parseCPUList(llvm::StringRef list);
+
+/// @brief Get the CPUs of a NUMA node of the host.
+llvm::Expected<std::vector<unsigned>> getNUMANodeCPUs(unsigned node);
+
+/// @brief Restrict the calling thread to the CPUs selected by the CPU
+/// affinity and NUMA node of config, if any. Threads started by the calling
+/// thread from then on inherit the restriction, so this must be applied
+/// before the thread pool of the compilation starts its threads. Fails if
+/// the selection is empty or the platform does not support it.
+llvm::Error applyCPUAffinity(const config::QSSConfig &config);
+
+} // namespace qssc::api
+
+#endif // QSS_COMPILER_THREAD_AFFINITY_H
@@ -16,17 +16,29 @@
 
 #include "API/api.h"
 
+#include "CompileCache.h"
+#include "PassPipelineCache.h"
+#include "ThreadAffinity.h"
+
 #include "API/errors.h"
 #include "Arguments/Arguments.h"
 #include "Config/CLIConfig.h"
 #include "Config/QSSConfig.h"
 #include "Dialect/OQ3/Transforms/Passes.h"
 #include "Dialect/Pulse/Transforms/Passes.h"
+#include "Dialect/QCS/IR/QCSOps.h"
 #include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
+#include "Dialect/QCS/Utils/Passes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/Transforms/Passes.h"
 #include "Dialect/RegisterDialects.h"
 #include "Dialect/RegisterPasses.h"
 #include "Frontend/OpenQASM3/OpenQASM3Frontend.h"
+#include "Frontend/OpenQASM3/OpenQASM3ParserPool.h"
+#include "HAL/Compile/CompileCancellation.h"
+#include "HAL/Compile/MetricsRegistry.h"
+#include "HAL/Compile/PassMetrics.h"
+#include "HAL/Compile/ProfilerMarkers.h"
 #include "HAL/Compile/TargetCompilationManager.h"
 #include "HAL/Compile/ThreadedCompilationManager.h"
 #include "HAL/PassRegistration.h"
@@ -38,6 +50,7 @@
 #include "Plugin/PluginInfo.h"
 #include "QSSC.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Conversion/Passes.h"
 #include "mlir/IR/AsmState.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -46,6 +59,8 @@
 #include "mlir/IR/Location.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/IR/Verifier.h"
 #include "mlir/InitAllExtensions.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Parser/Parser.h"
@@ -59,24 +74,42 @@
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Tools/ParseUtilities.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Base64.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
-#include <fstream>
+#include <future>
+#include <istream>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 using namespace mlir;
 using namespace qssc::config;
@@ -211,20 +244,41 @@ llvm::Error generateQEM_(
 
   mlir::TimingScope const writePayloadTiming =
       buildQEMTiming.nest("write-payload");
+  uint64_t const payloadStart = ostream->tell();
   if (config.shouldEmitPlaintextPayload())
     payload->writePlain(*ostream);
   else
     payload->write(*ostream);
+  qssc::hal::compile::MetricsRegistry::instance().observe(
+      "qssc_payload_size_bytes", "Size of the payloads written in bytes",
+      qssc::hal::compile::MetricsRegistry::getSizeBuckets(),
+      {{"emit", config.getEmitAction() == EmitAction::QEM ? "qem" : "qeqem"}},
+      static_cast<double>(ostream->tell() - payloadStart));
 
   return llvm::Error::success();
 }
 
-/// @brief Print the output to an ostream.
+/// @brief Print the output to an ostream, as bytecode if requested.
 /// @param ostream The ostream to populate.
 /// @param moduleOp The ModuleOp to dump.
-void dumpMLIR_(llvm::raw_ostream *ostream, mlir::ModuleOp moduleOp) {
-  moduleOp.print(*ostream);
-  *ostream << '\n';
+/// @param config Compilation configuration options
+/// @return The output error if one occurred.
+llvm::Error dumpMLIR_(llvm::raw_ostream *ostream, mlir::ModuleOp moduleOp,
+                      const QSSConfig &config) {
+  if (config.getEmitAction() != EmitAction::MLIRBytecode &&
+      !config.shouldEmitBytecode()) {
+    moduleOp.print(*ostream);
+    *ostream << '\n';
+    return llvm::Error::success();
+  }
+
+  mlir::BytecodeWriterConfig writerConfig;
+  if (auto version = config.bytecodeVersionToEmit())
+    writerConfig.setDesiredBytecodeVersion(*version);
+  if (mlir::failed(mlir::writeBytecodeToFile(moduleOp, *ostream, writerConfig)))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to emit MLIR bytecode");
+  return llvm::Error::success();
 }
 
 using ErrorHandler = function_ref<LogicalResult(const Twine &)>;
@@ -286,9 +340,26 @@ llvm::Error emitMLIR_(
   }
 
   // Print the output.
-  dumpMLIR_(ostream, moduleOp);
+  return dumpMLIR_(ostream, moduleOp, config);
+}
 
-  return llvm::Error::success();
+/// @brief Open the input of config as a buffer, e.g., for the MLIR parser.
+/// The input is loaded from a file by name by default, which is memory mapped
+/// where possible. With the "--direct" option, the buffer refers to the input
+/// program of config, which is not copied.
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+openInput_(const QSSConfig &config) {
+  if (config.isDirectInput())
+    return llvm::MemoryBuffer::getMemBuffer(config.getInputSource(),
+                                            /*bufferName=*/"direct");
+
+  std::string errorMessage;
+  auto file = mlir::openInputFile(config.getInputSource(), &errorMessage);
+  if (!file)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to open input file: " +
+                                       errorMessage);
+  return std::move(file);
 }
 
 /// @brief Emit a QEM payload from the compiler
@@ -296,35 +367,34 @@ llvm::Error emitMLIR_(
 /// @param payload The payload to emit
 /// @param moduleOp The module operation to process and emit
 /// @param targetCompilationManager The target's compilation scheduler
+/// @param input The input as loaded by the frontend, if it was, which is
+///        included in the payload rather than read again
 /// @return
 llvm::Error emitQEM_(
     const QSSConfig &config, llvm::raw_ostream *ostream,
     std::unique_ptr<qssc::payload::Payload> payload, mlir::ModuleOp moduleOp,
     qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
-    mlir::TimingScope &timing) {
+    mlir::TimingScope &timing, const llvm::MemoryBuffer *input) {
   if (config.shouldIncludeSource()) {
+    llvm::StringRef fileName;
+    if (config.getInputType() == InputType::QASM)
+      fileName = "manifest/input.qasm";
+    else if (config.getInputType() == InputType::MLIR)
+      fileName = "manifest/input.mlir";
+    else
+      llvm_unreachable("Unhandled input file type");
+
     if (config.isDirectInput()) {
-      if (config.getInputType() == InputType::QASM)
-        payload->addFile("manifest/input.qasm",
-                         (config.getInputSource() + "\n").str());
-      else if (config.getInputType() == InputType::MLIR)
-        payload->addFile("manifest/input.mlir",
-                         (config.getInputSource() + "\n").str());
-      else
-        llvm_unreachable("Unhandled input file type");
-    } else { // just copy the input file
-      std::ifstream fileStream(config.getInputSource().str());
-      std::stringstream fileSS;
-      fileSS << fileStream.rdbuf();
-
-      if (config.getInputType() == InputType::QASM)
-        payload->addFile("manifest/input.qasm", fileSS.str());
-      else if (config.getInputType() == InputType::MLIR)
-        payload->addFile("manifest/input.mlir", fileSS.str());
-      else
-        llvm_unreachable("Unhandled input file type");
-
-      fileStream.close();
+      payload->addFile(fileName, (config.getInputSource() + "\n").str());
+    } else if (input) {
+      payload->addFile(fileName, input->getBuffer());
+    } else {
+      // the input was not loaded, e.g., the OpenQASM 3 frontend reads it
+      // itself, so it is mapped here rather than copied through streams
+      auto file = openInput_(config);
+      if (!file)
+        return file.takeError();
+      payload->addFile(fileName, (*file)->getBuffer());
     }
   }
 
@@ -340,13 +410,24 @@ llvm::Error emitQEM_(
 ///        Uses qssc::emitDiagnostic to forward diagnostic to the python
 ///        diagnostic callback.
 ///        Prints diagnostic to llvm::errs to mimic default handler.
+///        Warnings, notes and remarks below the verbosity level are dropped
+///        before they are formatted.
 ///  @param diagnostic MLIR diagnostic from the Diagnostic Engine
 ///  @param diagnosticCb Handle to python diagnostic callback
+///  @param verbosity Verbosity level of the compilation
 void diagEngineHandler(mlir::Diagnostic &diagnostic,
-                       std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+                       std::optional<qssc::DiagnosticCallback> diagnosticCb,
+                       qssc::config::QSSVerbosity verbosity) {
 
-  // map diagnostic severity to qssc severity
   auto severity = diagnostic.getSeverity();
+  if ((severity == mlir::DiagnosticSeverity::Warning &&
+       verbosity < qssc::config::QSSVerbosity::Warn) ||
+      ((severity == mlir::DiagnosticSeverity::Note ||
+        severity == mlir::DiagnosticSeverity::Remark) &&
+       verbosity < qssc::config::QSSVerbosity::Info))
+    return;
+
+  // map diagnostic severity to qssc severity
   qssc::Severity qssc_severity = qssc::Severity::Error;
   switch (severity) {
   case mlir::DiagnosticSeverity::Error:
@@ -387,105 +468,379 @@ void diagEngineHandler(mlir::Diagnostic &diagnostic,
   return;
 }
 
-llvm::Error compile_(int argc, char const **argv, std::string *outputString,
-                     std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+/// @brief Perform the process-wide registration of passes, dialects and
+/// command line options. Registration may only happen once per process so this
+/// is performed on the first call only and is safe to call for every job.
+/// @param targetName The target of the job, if it only needs the passes of
+/// that target. The passes of the other targets are registered by the first
+/// call without a target, after the command line options, so that they are
+/// only available to textual pass pipelines.
+/// @return The dialect registry of the compiler.
+llvm::Expected<mlir::DialectRegistry &>
+initializeCompiler_(std::optional<llvm::StringRef> targetName = std::nullopt) {
+  // The dialect plugin CLI callbacks hold on to the registry so it must live as
+  // long as the command line options.
+  static mlir::DialectRegistry registry;
+  static std::once_flag initialized;
+  static std::optional<std::string> initError;
+
+  std::call_once(initialized, [targetName]() {
+    // Register the standard passes with MLIR.
+    // Must precede the command line parsing.
+    if (auto err = qssc::dialect::registerPasses(targetName)) {
+      initError = llvm::toString(std::move(err));
+      return;
+    }
 
-  // Initialize LLVM to start.
-  llvm::InitLLVM const y(argc, argv);
+    // Register the standard dialects with MLIR and prepare a registry and pass
+    // pipeline
+    qssc::dialect::registerDialects(registry);
 
-  // Register the standard passes with MLIR.
-  // Must precede the command line parsing.
-  if (auto err = qssc::dialect::registerPasses())
-    return err;
+    // Register all extensions
+    mlir::registerAllExtensions(registry);
 
-  // Register the standard dialects with MLIR and prepare a registry and pass
-  // pipeline
-  mlir::DialectRegistry registry;
-  qssc::dialect::registerDialects(registry);
+    registerCLOpts();
+    // Register CL config builder prior to parsing
+    CLIConfigBuilder::registerCLOptions(registry);
+    llvm::cl::SetVersionPrinter(&printVersion);
+  });
 
-  // Register all extensions
-  mlir::registerAllExtensions(registry);
+  if (initError.has_value())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), *initError);
 
-  registerCLOpts();
-  // Register CL config builder prior to parsing
-  CLIConfigBuilder::registerCLOptions(registry);
-  llvm::cl::SetVersionPrinter(&printVersion);
-  llvm::cl::ParseCommandLineOptions(
-      argc, argv, "Quantum System Software (QSS) Backend Compiler\n");
+  // Targets are only registered once, so this only registers the targets
+  // which the first call skipped.
+  if (auto err =
+          targetName
+              ? qssc::hal::registerTargetPassesAndPipelines(*targetName)
+              : llvm::joinErrors(qssc::hal::registerTargetPasses(),
+                                 qssc::hal::registerTargetPipelines()))
+    return std::move(err);
+  return registry;
+}
 
-  DefaultTimingManager tm;
-  applyDefaultTimingManagerCLOptions(tm);
-  TimingScope timing = tm.getRootScope();
+/// @brief Get the target selected by the command line of a job which only
+/// needs the passes of that target, i.e., which neither lists the targets nor
+/// asks for help.
+std::optional<llvm::StringRef> getSelectedTarget_(int argc,
+                                                  char const **argv) {
+  std::optional<llvm::StringRef> targetName;
+  for (int i = 1; i < argc; ++i) {
+    llvm::StringRef arg(argv[i]);
+    if (!arg.consume_front("--"))
+      arg.consume_front("-");
+    if (arg == "show-targets" || arg.startswith("show-targets=") ||
+        arg.startswith("help") || arg == "h")
+      return std::nullopt;
+    if (arg.consume_front("target=")) {
+      targetName = arg;
+    } else if (arg == "target" && i + 1 < argc) {
+      targetName = argv[++i];
+    }
+  }
+  return targetName;
+}
 
-  // The MLIR context for this compilation event.
-  // Instantiate after parsing command line options.
-  MLIRContext context{};
+/// @brief Parse the command line of a compilation job and build its
+/// configuration. The command line options are process-wide, so jobs parse
+/// their command lines one at a time and compile from the configuration they
+/// built.
+/// @param exitOnError Exit on malformed command lines as the standalone tool
+/// does, otherwise return an error.
+llvm::Expected<QSSConfig> parseConfig_(int argc, char const **argv,
+                                       bool exitOnError) {
+  static std::mutex commandLineMutex;
+  std::lock_guard<std::mutex> const lock(commandLineMutex);
+
+  // Clear the state of any previous job in this process.
+  CLIConfigBuilder::resetCLOptions();
+  if (!llvm::cl::ParseCommandLineOptions(
+          argc, argv, "Quantum System Software (QSS) Backend Compiler\n",
+          exitOnError ? nullptr : &llvm::errs()))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to parse command line options");
 
-  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
-  auto configResult = qssc::config::buildToolConfig();
-  if (auto err = configResult.takeError())
-    return err;
-  qssc::config::QSSConfig const config = configResult.get();
-  qssc::config::setContextConfig(&context, config);
-  buildConfigTiming.stop();
+  return qssc::config::buildToolConfig();
+}
 
-  // Populate the context
-  context.appendDialectRegistry(registry);
-  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
-  context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
+/// @brief Compute a key over the command line of a job that identifies the
+/// target pass pipelines it requires. The input source and output path do not
+/// influence the pipelines and are excluded so that jobs only differing in
+/// these share pass managers.
+std::string computePipelineKey_(int argc, char const **argv,
+                                const QSSConfig &config) {
+  std::string key;
+  llvm::raw_string_ostream keyStream(key);
+  for (int i = 1; i < argc; ++i) {
+    llvm::StringRef const arg(argv[i]);
+    if (arg == config.getInputSource() || arg.startswith("-o=") ||
+        arg.startswith("--o="))
+      continue;
+    if (arg == "-o" || arg == "--o") {
+      ++i;
+      continue;
+    }
+    keyStream << arg << '\0';
+  }
+  return keyStream.str();
+}
 
-  // Register LLVM dialect and all infrastructure required for translation to
-  // LLVM IR
-  mlir::registerBuiltinDialectTranslation(context);
-  mlir::registerLLVMDialectTranslation(context);
+/// @brief Compute the key of computePipelineKey_ for a structured
+/// configuration, over all of its options but the input source and output
+/// path.
+std::string computeConfigKey_(const QSSConfig &config) {
+  QSSConfig keyConfig = config;
+  keyConfig.setInputSource("-").directInput(false).setOutputFilePath("-");
+  std::string key;
+  llvm::raw_string_ostream keyStream(key);
+  keyConfig.emit(keyStream);
+  return keyStream.str();
+}
 
-  if (config.shouldShowDialects()) {
-    showDialects_(registry);
-    return llvm::Error::success();
+/// @brief Get the options of the OpenQASM 3 frontend from the configuration
+/// of a compilation.
+qssc::frontend::openqasm3::ParseOptions
+getParseOptions_(const QSSConfig &config) {
+  qssc::frontend::openqasm3::ParseOptions options;
+  options.numShots = config.getNumShots();
+  options.shotDelay = config.getShotDelay().str();
+  options.includeDirs = config.getIncludeDirs();
+  options.cacheIncludes = config.shouldCacheQASMIncludes();
+  options.gateLibraries = config.getGateLibraries();
+  options.streaming = config.shouldStreamQASM();
+  options.dtTimestep = config.getQASMDtTimestep();
+  switch (config.getQASMLocations()) {
+  case QASMLocations::Full:
+    options.locations = qssc::frontend::openqasm3::LocationMode::Full;
+    break;
+  case QASMLocations::Lines:
+    options.locations = qssc::frontend::openqasm3::LocationMode::Lines;
+    break;
+  case QASMLocations::None:
+    options.locations = qssc::frontend::openqasm3::LocationMode::None;
+    break;
   }
+  return options;
+}
 
-  if (config.shouldShowTargets()) {
-    showTargets_();
-    return llvm::Error::success();
-  }
+class MapAngleArgumentSource : public qssc::arguments::ArgumentSource {
 
-  if (config.shouldShowPayloads()) {
-    showPayloads_();
-    return llvm::Error::success();
+public:
+  MapAngleArgumentSource(
+      const std::unordered_map<std::string, double> &parameterMap)
+      : parameterMap(parameterMap) {}
+
+  qssc::arguments::ArgumentType
+  getArgumentValue(llvm::StringRef name) const override {
+    std::string const name_{name};
+    auto pos = parameterMap.find(name_);
+
+    if (pos == parameterMap.end())
+      return std::nullopt;
+    return pos->second;
   }
 
-  if (config.shouldShowConfig()) {
-    config.emit(llvm::outs());
-    return llvm::Error::success();
+private:
+  const std::unordered_map<std::string, double> &parameterMap;
+};
+
+/// @brief Store the output of a compilation in the compile cache. Failing to
+/// persist an entry does not fail the compilation.
+void storeCachedOutput_(const QSSConfig &config, llvm::StringRef key,
+                        llvm::StringRef output) {
+  if (auto err = qssc::api::CompileCache::instance().store(
+          key, output, config.getCompileCacheDir()))
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(),
+                                "Warning: unable to cache compilation: ");
+}
+
+/// Options of the qss-compiler which only influence a compilation after its
+/// command line passes, so that checkpoints are reused when only these change.
+/// The target is part of the key of the checkpoints after the passes instead.
+constexpr llvm::StringLiteral postPassesOptions_[] = {
+    "emit",
+    "target",
+    "config",
+    "add-target-passes",
+    "plaintext-payload",
+    "include-source",
+    "compile-target-ir",
+    "bypass-payload-target-compilation",
+    "stream-payload",
+    "split-payload",
+    "payload-compression",
+    "payload-compression-level",
+    "payload-debug-artifacts",
+    "payload-blob-store",
+    "compile-cache",
+    "compile-cache-dir",
+    "parametric-templates",
+    "pass-metrics-report",
+    "pass-metrics-format",
+    "checkpoint-stages",
+    "checkpoint-dir",
+    "verbosity",
+    "print-ir-before-all-target-passes",
+    "print-ir-after-all-target-passes",
+    "print-ir-before-emit-all-target-payloads",
+    "print-ir-after-target-compile-failure",
+    "target-compile-trace"};
+
+/// @brief Compute a key over the command line options of a job which
+/// influence its module up to a checkpoint stage. Values passed as separate
+/// arguments are kept, which only prevents reusing checkpoints.
+std::string computeStageOptionsKey_(llvm::StringRef optionsKey,
+                                    CheckpointStage stage) {
+  llvm::SmallVector<llvm::StringRef> args;
+  optionsKey.split(args, '\0', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+
+  std::string key;
+  llvm::raw_string_ostream keyStream(key);
+  for (auto arg : args) {
+    llvm::StringRef const name = arg.ltrim('-').split('=').first;
+    bool const isOption = arg.startswith("-");
+    bool const isPostPasses =
+        isOption && (llvm::is_contained(postPassesOptions_, name) ||
+                     name.startswith("mlir-"));
+    bool const isPass =
+        isOption && (name == "pass-pipeline" || name == "p" ||
+                     mlir::PassInfo::lookup(name) ||
+                     mlir::PassPipelineInfo::lookup(name));
+    if (isPostPasses || (stage == CheckpointStage::Frontend && isPass))
+      continue;
+    keyStream << arg << '\0';
   }
+  return keyStream.str();
+}
 
-  // Build the target for compilation
-  auto targetResult = buildTarget_(&context, config, timing);
-  if (auto err = targetResult.takeError())
-    return err;
-  auto &target = targetResult.get();
+/// @brief Compute the key of the checkpoint of a compilation after a stage.
+/// @return The key or std::nullopt if the compilation is not checkpointed
+/// after the stage.
+std::optional<std::string> computeCheckpointKey_(const QSSConfig &config,
+                                                 llvm::StringRef optionsKey,
+                                                 CheckpointStage stage) {
+  if (!config.shouldCheckpoint(stage) ||
+      config.getEmitAction() < EmitAction::MLIR)
+    return std::nullopt;
+
+  auto key = qssc::api::CompileCache::computeCheckpointKey(
+      config, stage, computeStageOptionsKey_(optionsKey, stage));
+  if (!key) {
+    llvm::consumeError(key.takeError());
+    return std::nullopt;
+  }
+  return std::move(*key);
+}
 
-  // Set up the input, which is loaded from a file by name by default. With the
-  // "--direct" option, the input program can be provided as a string to stdin.
-  std::string errorMessage;
-  std::unique_ptr<llvm::MemoryBuffer> file;
-  if (!config.isDirectInput()) {
-    file = mlir::openInputFile(config.getInputSource(), &errorMessage);
-    if (!file) {
-      return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                     "Failed to open input file: " +
-                                         errorMessage);
-    }
-  } else {
-    file = llvm::MemoryBuffer::getMemBuffer(config.getInputSource(),
-                                            /*bufferName=*/"direct");
+/// @brief Store the module of a compilation as the checkpoint with the key.
+/// Failing to persist a checkpoint does not fail the compilation.
+void storeCheckpoint_(const QSSConfig &config, llvm::StringRef key,
+                      mlir::ModuleOp moduleOp, mlir::TimingScope &timing) {
+  mlir::TimingScope storeCheckpointTiming = timing.nest("store-checkpoint");
+  std::string bytecode;
+  llvm::raw_string_ostream bytecodeStream(bytecode);
+  if (failed(mlir::writeBytecodeToFile(moduleOp, bytecodeStream))) {
+    llvm::errs() << "Warning: unable to checkpoint compilation: failed to "
+                    "write bytecode\n";
+    return;
   }
+  bytecodeStream.flush();
+  if (auto err = qssc::api::CompileCache::instance().store(
+          key, bytecode, config.getCheckpointDir()))
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(),
+                                "Warning: unable to checkpoint compilation: ");
+}
+
+/// @brief The parametric template of a program, identifying all programs which
+/// only differ from it in the values of their parameters.
+struct ParametricTemplate {
+  /// @brief Compile cache key of the template
+  std::string key;
+  /// @brief The parameter values of this program
+  std::unordered_map<std::string, double> arguments;
+};
 
-  context.getDiagEngine().registerHandler([&](mlir::Diagnostic &diagnostic) {
-    diagEngineHandler(diagnostic, diagnosticCb);
+/// @brief Compute the parametric template of a program prior to compilation.
+/// @return The template or std::nullopt if the program has no parameters.
+std::optional<ParametricTemplate>
+computeParametricTemplate_(const QSSConfig &config, llvm::StringRef optionsKey,
+                           mlir::ModuleOp moduleOp) {
+  mlir::qcs::ParameterInitialValueAnalysis initialValues(moduleOp);
+  if (initialValues.getNames().empty())
+    return std::nullopt;
+
+  ParametricTemplate parametricTemplate;
+  for (auto &initialValue : initialValues.getNames())
+    parametricTemplate.arguments[initialValue.getKey().str()] =
+        std::get<double>(initialValue.getValue());
+
+  // The template is the program with its parameter values removed.
+  mlir::OwningOpRef<mlir::ModuleOp> templateModule = moduleOp.clone();
+  templateModule->walk([](mlir::qcs::DeclareParameterOp declareParameterOp) {
+    declareParameterOp.removeInitialValueAttr();
   });
+  std::string templateIR;
+  llvm::raw_string_ostream templateStream(templateIR);
+  templateModule->print(templateStream,
+                        mlir::OpPrintingFlags().enableDebugInfo(false));
+
+  parametricTemplate.key = qssc::api::CompileCache::computeTemplateKey(
+      config, optionsKey, templateStream.str());
+  return parametricTemplate;
+}
 
-  // Set up the output.
+/// @brief Bind the parameter values of a program to the cached payload of its
+/// parametric template.
+llvm::Expected<std::string>
+bindParametricTemplate_(llvm::StringRef templatePayload,
+                        const ParametricTemplate &parametricTemplate,
+                        qssc::arguments::BindArgumentsImplementationFactory
+                            &factory,
+                        const std::optional<qssc::DiagnosticCallback>
+                            &diagnosticCb) {
+  MapAngleArgumentSource const source(parametricTemplate.arguments);
+  std::string payload;
+  if (auto err = qssc::arguments::bindArguments(
+          templatePayload, /*payloadOutputPath=*/"", source,
+          /*treatWarningsAsErrors=*/false, /*enableInMemoryInput=*/true,
+          &payload, factory, diagnosticCb))
+    return std::move(err);
+  return payload;
+}
+
+/// @brief Compile a single program against an already prepared context and
+/// target.
+/// @param context The context of the target.
+/// @param config The configuration of the program.
+/// @param targetCompilationManager The target pass managers to compile with.
+/// These may not be used by any other program concurrently.
+/// @param optionsKey Key over the command line options of the program, used
+/// for parametric templates.
+/// @param outputString an optional buffer for the compilation result.
+/// Parametric templates are only stored if provided.
+/// @param diagnosticCb an optional callback that will receive emitted
+/// diagnostics
+/// @param exclusiveContext Whether this is the only program compiled in the
+/// context, which allows toggling the context threading while parsing.
+/// @param preparedModule The program as MLIR bytecode after the command line
+/// passes already ran on it, e.g., in another context. If provided, it is
+/// compiled instead of parsing the input.
+/// @param pipelineCache The pass managers of the command line passes, if
+/// they are reused across programs. These must not be instrumented, i.e.,
+/// timing and pass metrics must be disabled.
+llvm::Error compileProgramStages_(
+    MLIRContext &context, const QSSConfig &config,
+    qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
+    llvm::StringRef optionsKey, std::string *outputString,
+    const std::optional<qssc::DiagnosticCallback> &diagnosticCb,
+    mlir::TimingScope &timing, bool exclusiveContext,
+    llvm::StringRef preparedModule,
+    qssc::api::PassPipelineCache *pipelineCache) {
+
+  // Set up the output. The input is only opened once it is parsed: the
+  // OpenQASM 3 frontend reads its input itself and prepared modules and
+  // checkpoints do not need it at all.
+  std::string errorMessage;
   llvm::raw_ostream *ostream;
   std::optional<llvm::raw_string_ostream> outStringStream;
   auto outputFile =
@@ -515,10 +870,22 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
           payloadInfo.value()->createPluginInstance(std::nullopt).get());
     } else {
       const qssc::payload::PayloadConfig payloadConfig{
-          fNamePrefix, fNamePrefix, config.getVerbosityLevel()};
+          fNamePrefix,
+          fNamePrefix,
+          config.getVerbosityLevel(),
+          {config.getPayloadCompression(), config.getPayloadCompressionLevel()},
+          {},
+          config.getPayloadDebugArtifacts(),
+          config.shouldSplitPayload(),
+          config.getPayloadBlobStore().value_or("").str()};
       payload = std::move(
           payloadInfo.value()->createPluginInstance(payloadConfig).get());
     }
+    // payloads written to stdout are created without a configuration
+    payload->setDebugArtifacts(config.getPayloadDebugArtifacts());
+    // plaintext payloads are written from the retained files
+    if (config.shouldStreamPayload() && !config.shouldEmitPlaintextPayload())
+      payload->enableStreaming();
   }
 
   if (outputString) {
@@ -533,46 +900,116 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
     ostream = &outputFile->os();
   }
 
-  mlir::ModuleOp moduleOp;
+  // Keep the output if no errors have occurred so far
+  auto keepOutput = [&]() {
+    if (outputString) {
+      if (outputFile && config.getOutputFilePath() != "-")
+        outputFile->os() << *outputString;
+    }
+    if (outputFile && config.getOutputFilePath() != "-")
+      outputFile->keep();
+  };
 
-  if (config.getInputType() == InputType::QASM) {
+  // Owns the module of this job so that it is released with the job while the
+  // context may live on.
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+
+  // Compilations resume from the latest checkpoint of their module, if any.
+  // Parametric templates are computed prior to the command line passes, so
+  // these compilations only resume from checkpoints after the frontend.
+  std::optional<std::string> frontendCheckpointKey;
+  std::optional<std::string> passesCheckpointKey;
+  std::optional<std::string> checkpoint;
+  bool passesDone = !preparedModule.empty();
+  if (preparedModule.empty()) {
+    frontendCheckpointKey =
+        computeCheckpointKey_(config, optionsKey, CheckpointStage::Frontend);
+    passesCheckpointKey =
+        computeCheckpointKey_(config, optionsKey, CheckpointStage::Passes);
+    auto &cache = qssc::api::CompileCache::instance();
+    if (passesCheckpointKey.has_value() &&
+        !config.shouldUseParametricTemplates()) {
+      checkpoint =
+          cache.lookup(*passesCheckpointKey, config.getCheckpointDir());
+      passesDone = checkpoint.has_value();
+    }
+    if (!checkpoint.has_value() && frontendCheckpointKey.has_value())
+      checkpoint =
+          cache.lookup(*frontendCheckpointKey, config.getCheckpointDir());
+  }
+  llvm::StringRef const preparedBytecode =
+      checkpoint.has_value() ? llvm::StringRef(*checkpoint) : preparedModule;
+
+  // the MLIR input as loaded by the parser
+  std::shared_ptr<llvm::SourceMgr> sourceMgr;
+  qssc::hal::compile::MetricsTimer frontendTimer(
+      "qssc_compile_stage_duration_seconds",
+      "Seconds spent in the stages of the compilation of a program",
+      {{"stage", "frontend"}});
+  if (!preparedBytecode.empty()) {
+
+    mlir::TimingScope preparedModuleTiming =
+        timing.nest(checkpoint.has_value() ? "load-checkpoint"
+                                           : "parse-prepared-module");
+    module = mlir::parseSourceString<mlir::ModuleOp>(
+        preparedBytecode, mlir::ParserConfig(&context));
+    if (!module)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          checkpoint.has_value()
+              ? "Problem parsing the checkpoint of the program, remove it "
+                "from the checkpoint directory to recompile from scratch"
+              : "Problem parsing the prepared module");
+  } else if (config.getInputType() == InputType::QASM) {
 
     mlir::TimingScope loadQASM3Timing = timing.nest("load-qasm3");
 
     if (config.getEmitAction() >= EmitAction::MLIR) {
-      moduleOp = mlir::ModuleOp::create(FileLineColLoc::get(
+      module = mlir::ModuleOp::create(FileLineColLoc::get(
           &context,
           config.isDirectInput() ? std::string{"-"} : config.getInputSource(),
           0, 0));
     }
 
     if (auto frontendError = qssc::frontend::openqasm3::parse(
-            config.getInputSource().str(), !config.isDirectInput(),
+            getParseOptions_(config), config.getInputSource(),
+            !config.isDirectInput(),
             config.getEmitAction() == EmitAction::AST,
             config.getEmitAction() == EmitAction::ASTPretty,
-            config.getEmitAction() >= EmitAction::MLIR, moduleOp, diagnosticCb,
-            loadQASM3Timing))
+            config.getEmitAction() >= EmitAction::MLIR, module.get(),
+            diagnosticCb, loadQASM3Timing, ostream))
       return frontendError;
 
-    if (config.getEmitAction() < EmitAction::MLIR)
+    if (config.getEmitAction() < EmitAction::MLIR) {
+      // the pretty-printed AST is dumped to the output
+      if (config.getEmitAction() == EmitAction::ASTPretty)
+        keepOutput();
       return llvm::Error::success();
-  } // if input == QASM
-
-  if (config.getInputType() == InputType::MLIR) {
+    }
+  } else if (config.getInputType() == InputType::MLIR) {
 
     mlir::TimingScope mlirParserTiming = timing.nest("parse-mlir");
 
+    auto file = openInput_(config);
+    if (!file)
+      return file.takeError();
+
     // Tell sourceMgr about this buffer, which is what the parser will pick up.
-    auto sourceMgr = std::make_shared<llvm::SourceMgr>();
-    sourceMgr->AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+    // It is kept to include the input in the payload without reading it
+    // again.
+    sourceMgr = std::make_shared<llvm::SourceMgr>();
+    sourceMgr->AddNewSourceBuffer(std::move(*file), llvm::SMLoc());
 
     // Implemented following -
     // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.6/mlir/lib/Tools/mlir-opt/MlirOptMain.cpp#L333-L362
 
     // Disable multi-threading when parsing the input file. This removes the
-    // unnecessary/costly context synchronization when parsing.
+    // unnecessary/costly context synchronization when parsing. Other programs
+    // sharing the context may be running on its thread pool so it is left
+    // untouched if the context is not exclusive.
     const bool wasThreadingEnabled = context.isMultithreadingEnabled();
-    context.disableMultithreading();
+    if (exclusiveContext)
+      context.disableMultithreading();
 
     // Prepare the parser config, and attach any useful/necessary resource
     // handlers. Unhandled external resources are treated as passthrough, i.e.
@@ -606,10 +1043,22 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
           "The qss-compiler does not currently support roundtrip verification. "
           "Please use the qss-opt tool instead.");
 
-    context.enableMultithreading(wasThreadingEnabled);
+    if (exclusiveContext)
+      context.enableMultithreading(wasThreadingEnabled);
 
-    moduleOp = mlir::dyn_cast<mlir::ModuleOp>(op.release());
+    module = mlir::dyn_cast<mlir::ModuleOp>(op.release());
   } // if input == MLIR
+  frontendTimer.stop();
+
+  const auto *cancellation = targetCompilationManager.getCancellation();
+  if (cancellation)
+    if (auto err = cancellation->check())
+      return err;
+
+  if (preparedBytecode.empty() && frontendCheckpointKey.has_value())
+    storeCheckpoint_(config, *frontendCheckpointKey, module.get(), timing);
+
+  mlir::ModuleOp const moduleOp = module.get();
 
   auto errorHandler = [&](const Twine &msg) {
     // format msg to python handler as a compilation failure
@@ -623,37 +1072,111 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
   // at this point we have QUIR+Pulse in the moduleOp from either the
   // QASM/AST or MLIR file
 
-  bool verifyPasses = config.shouldVerifyPasses();
+  // Programs which only differ from a previously compiled program in their
+  // parameter values are bound to the payload of that program instead.
+  std::optional<ParametricTemplate> parametricTemplate;
+  std::optional<qssc::arguments::BindArgumentsImplementationFactory *>
+      bindFactory;
+  if (config.shouldUseParametricTemplates() &&
+      (config.getEmitAction() == EmitAction::QEM ||
+       config.getEmitAction() == EmitAction::QEQEM)) {
+    if (auto *targetSystem = dynamic_cast<qssc::hal::TargetSystem *>(
+            &targetCompilationManager.getTargetSystem()))
+      bindFactory = targetSystem->getBindArgumentsImplementationFactory();
+    if (bindFactory.has_value() && *bindFactory)
+      parametricTemplate =
+          computeParametricTemplate_(config, optionsKey, moduleOp);
+  }
 
-  auto targetCompilationManager =
-      qssc::hal::compile::ThreadedCompilationManager(
-          target, &context, [&](mlir::PassManager &pm) -> llvm::Error {
-            if (auto err = buildPassManager_(pm, verifyPasses))
-              return err;
+  if (parametricTemplate.has_value()) {
+    if (auto templatePayload = qssc::api::CompileCache::instance().lookup(
+            parametricTemplate->key, config.getCompileCacheDir())) {
+      mlir::TimingScope bindTiming = timing.nest("bind-parametric-template");
+      auto payload = bindParametricTemplate_(
+          *templatePayload, *parametricTemplate, **bindFactory, diagnosticCb);
+      if (auto err = payload.takeError())
+        return err;
+      *ostream << *payload;
+      keepOutput();
+      return llvm::Error::success();
+    }
+  }
+
+  bool const verifyPasses = config.shouldVerifyEachPass();
+
+  // Run additional passes specified on the command line, unless they already
+  // ran on the prepared module.
+  if (!passesDone) {
+    mlir::TimingScope commandLinePassesTiming =
+        timing.nest("command-line-passes");
+    qssc::hal::compile::MetricsTimer commandLinePassesTimer(
+        "qssc_compile_stage_duration_seconds",
+        "Seconds spent in the stages of the compilation of a program",
+        {{"stage", "passes"}});
+    std::unique_ptr<mlir::PassManager> pm;
+    if (pipelineCache) {
+      auto cachedPM = pipelineCache->acquire(
+          [&](mlir::PassManager &newPM) -> llvm::Error {
+            if (failed(config.setupPassPipeline(newPM)))
+              return llvm::createStringError(
+                  llvm::inconvertibleErrorCode(),
+                  "Problem adding passes to passPipeline!");
             return llvm::Error::success();
           });
-  if (mlir::failed(qssc::hal::compile::applyTargetCompilationManagerCLOptions(
-          targetCompilationManager)))
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Unable to apply target compilation options.");
-
-  // Run additional passes specified on the command line
+      if (auto err = cachedPM.takeError())
+        return err;
+      pm = std::move(*cachedPM);
+    } else {
+      pm = std::make_unique<mlir::PassManager>(&context);
+      if (auto err = buildPassManager(config, *pm, errorHandler, verifyPasses,
+                                      commandLinePassesTiming))
+        return err;
+      if (auto *passMetrics = targetCompilationManager.getPassMetrics())
+        pm->addInstrumentation(
+            passMetrics->createInstrumentation("command-line-passes"));
+    }
+    // Cached pass managers are not instrumented and are returned to the
+    // cache whether or not the pipeline succeeded.
+    auto releasePM = llvm::make_scope_exit([&]() {
+      if (pipelineCache)
+        pipelineCache->release(std::move(pm));
+    });
+
+    if (pm->size() && failed(pm->run(moduleOp)))
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Problems running the compiler pipeline!");
+    // The passes of a cancelled compilation are skipped, so its module must
+    // not be checkpointed.
+    if (cancellation)
+      if (auto err = cancellation->check())
+        return err;
+    // Without verification after each pass the module is verified once at
+    // the end of the command line passes.
+    if (pm->size() && config.shouldVerifyBoundaries()) {
+      auto verifyTiming = commandLinePassesTiming.nest("verify");
+      if (failed(mlir::verify(moduleOp)))
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            "Failed to verify the module after the compiler pipeline");
+    }
+    commandLinePassesTiming.stop();
+    commandLinePassesTimer.stop();
 
-  mlir::TimingScope commandLinePassesTiming =
-      timing.nest("command-line-passes");
-  mlir::PassManager pm(&context);
-  if (auto err = buildPassManager(config, pm, errorHandler, verifyPasses,
-                                  commandLinePassesTiming))
-    return err;
+    if (passesCheckpointKey.has_value())
+      storeCheckpoint_(config, *passesCheckpointKey, moduleOp, timing);
+  }
 
-  if (pm.size() && failed(pm.run(moduleOp)))
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Problems running the compiler pipeline!");
-  commandLinePassesTiming.stop();
+  targetCompilationManager.enableTargetVerification(
+      config.shouldVerifyBoundaries());
 
   // Prepare outputs
-  if (config.getEmitAction() == EmitAction::MLIR) {
+  qssc::hal::compile::MetricsTimer emitTimer(
+      "qssc_compile_stage_duration_seconds",
+      "Seconds spent in the stages of the compilation of a program",
+      {{"stage", "emit"}});
+  if (config.getEmitAction() == EmitAction::MLIR ||
+      config.getEmitAction() == EmitAction::MLIRBytecode) {
     if (auto err = emitMLIR_(ostream, context, moduleOp, config,
                              targetCompilationManager, errorHandler, timing))
       return err;
@@ -661,117 +1184,1934 @@ llvm::Error compile_(int argc, char const **argv, std::string *outputString,
 
   if (config.getEmitAction() == EmitAction::QEM ||
       config.getEmitAction() == EmitAction::QEQEM) {
+    const llvm::MemoryBuffer *input =
+        sourceMgr ? sourceMgr->getMemoryBuffer(sourceMgr->getMainFileID())
+                  : nullptr;
     if (auto err = emitQEM_(config, ostream, std::move(payload), moduleOp,
-                            targetCompilationManager, timing))
+                            targetCompilationManager, timing, input))
       return err;
   }
+  emitTimer.stop();
 
   // ------------------------------------------------------------
 
-  // Keep the output if no errors have occurred so far
-  if (outputString) {
-    if (outputFile && config.getOutputFilePath() != "-")
-      outputFile->os() << *outputString;
-  }
-  if (outputFile && config.getOutputFilePath() != "-")
-    outputFile->keep();
+  // Passes run while emitting are skipped as well once cancelled.
+  if (cancellation)
+    if (auto err = cancellation->check())
+      return err;
+
+  if (parametricTemplate.has_value() && outputString)
+    storeCachedOutput_(config, parametricTemplate->key, *outputString);
+
+  keepOutput();
 
   return llvm::Error::success();
 }
-} // anonymous namespace
 
-int qssc::compile(int argc, char const **argv, std::string *outputString,
-                  std::optional<DiagnosticCallback> diagnosticCb) {
-  if (auto err = compile_(argc, argv, outputString, std::move(diagnosticCb))) {
-    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
-    return 1;
-  }
+/// @brief Compile a single program as with compileProgramStages_ and record
+/// its outcome and latency in the metrics of the process.
+llvm::Error compileProgram_(
+    MLIRContext &context, const QSSConfig &config,
+    qssc::hal::compile::ThreadedCompilationManager &targetCompilationManager,
+    llvm::StringRef optionsKey, std::string *outputString,
+    const std::optional<qssc::DiagnosticCallback> &diagnosticCb,
+    mlir::TimingScope &timing, bool exclusiveContext = true,
+    llvm::StringRef preparedModule = {},
+    qssc::api::PassPipelineCache *pipelineCache = nullptr) {
+  auto &metrics = qssc::hal::compile::MetricsRegistry::instance();
+  auto const start = qssc::hal::compile::MetricsRegistry::Clock::now();
+  auto err = compileProgramStages_(
+      context, config, targetCompilationManager, optionsKey, outputString,
+      diagnosticCb, timing, exclusiveContext, preparedModule, pipelineCache);
+
+  const auto *cancellation = targetCompilationManager.getCancellation();
+  std::string const status = !err ? "success"
+                             : cancellation && cancellation->isCancelled()
+                                 ? "cancelled"
+                                 : "failure";
+  metrics.increment("qssc_compilations_total",
+                    "Compilations of programs by their status",
+                    {{"status", status}});
+  metrics.observeDuration("qssc_compile_duration_seconds",
+                          "Seconds spent compiling a program", {}, start);
+  return err;
+}
 
-  return 0;
+/// @brief Write the pass metrics of a compilation to the configured report.
+llvm::Error writePassMetrics_(
+    const QSSConfig &config,
+    const std::optional<qssc::hal::compile::PassMetrics> &metrics) {
+  if (!metrics.has_value())
+    return llvm::Error::success();
+  auto const format = config.getPassMetricsFormat() == PassMetricsFormat::JSON
+                          ? qssc::hal::compile::PassMetrics::Format::JSON
+                          : qssc::hal::compile::PassMetrics::Format::Table;
+  // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+  return metrics->write(*config.getPassMetricsReport(), format);
 }
 
-class MapAngleArgumentSource : public qssc::arguments::ArgumentSource {
+/// @brief Whether the output of a compilation may be served from the compile
+/// cache. Only outputs which are fully written to the output stream qualify.
+bool isCacheable_(const QSSConfig &config) {
+  return config.shouldUseCompileCache() &&
+         (config.getEmitAction() == EmitAction::MLIR ||
+          config.getEmitAction() == EmitAction::MLIRBytecode ||
+          config.getEmitAction() == EmitAction::QEM ||
+          config.getEmitAction() == EmitAction::QEQEM);
+}
+
+/// @brief Look up the cache key of a compilation. Compilations whose key
+/// cannot be computed, e.g., due to an unreadable input, are not cached and
+/// report their errors when compiled.
+std::optional<std::string> computeCacheKey_(const QSSConfig &config,
+                                            llvm::StringRef optionsKey) {
+  if (!isCacheable_(config))
+    return std::nullopt;
+
+  auto key = qssc::api::CompileCache::computeKey(config, optionsKey);
+  if (!key) {
+    llvm::consumeError(key.takeError());
+    return std::nullopt;
+  }
+  return std::move(*key);
+}
 
+/// @brief Deliver an output to where compileProgram_ would have emitted it.
+/// @param writeFile Whether the output still needs to be written to the output
+/// file.
+llvm::Error deliverOutput_(const QSSConfig &config, std::string output,
+                           std::string *outputString, bool writeFile) {
+  bool const toFile = config.getOutputFilePath() != "-";
+  if (!toFile && !outputString)
+    llvm::outs() << output;
+
+  if (toFile && writeFile) {
+    std::string errorMessage;
+    auto outputFile =
+        mlir::openOutputFile(config.getOutputFilePath(), &errorMessage);
+    if (!outputFile)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to open output file: " +
+                                         errorMessage);
+    outputFile->os() << output;
+    outputFile->keep();
+  }
+
+  if (outputString)
+    *outputString = std::move(output);
+  return llvm::Error::success();
+}
+
+/// @brief The compilation state that may be reused across compilation jobs.
+/// A one-shot compilation uses a session for a single job while a
+/// qssc::CompileServer keeps its session alive between jobs so that the
+/// MLIRContext, target and target pass managers are only built once.
+class CompileSession {
 public:
-  MapAngleArgumentSource(
-      const std::unordered_map<std::string, double> &parameterMap)
-      : parameterMap(parameterMap) {}
+  CompileSession() = default;
+  CompileSession(const CompileSession &) = delete;
+  CompileSession &operator=(const CompileSession &) = delete;
+  ~CompileSession() {
+    if (context) {
+      qssc::config::eraseContextConfig(context.get());
+      qssc::hal::registry::TargetSystemRegistry::releaseTargets(context.get());
+    }
+  }
 
-  qssc::arguments::ArgumentType
-  getArgumentValue(llvm::StringRef name) const override {
-    std::string const name_{name};
-    auto pos = parameterMap.find(name_);
+  /// @brief Compile a single job.
+  /// @param registry The dialect registry of the compiler.
+  /// @param config The configuration of this job.
+  /// @param pipelineKey Key identifying the target pass pipelines of this job.
+  /// Target pass managers are rebuilt whenever the key changes.
+  /// @param outputString an optional buffer for the compilation result
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics
+  llvm::Error compile(mlir::DialectRegistry &registry, const QSSConfig &config,
+                      llvm::StringRef pipelineKey, std::string *outputString,
+                      std::optional<qssc::DiagnosticCallback> diagnosticCb);
+
+  /// @brief Compile a batch of programs sharing the configuration of a single
+  /// job. The target is built once for the batch and the programs are
+  /// compiled in parallel on the context thread pool.
+  /// @param registry The dialect registry of the compiler.
+  /// @param config The configuration shared by all programs.
+  /// @param optionsKey Key over the command line options shared by all
+  /// programs, used for caching.
+  /// @param inputs The program sources, provided as with "--direct".
+  /// @param outputs Receives the compilation result of each program.
+  /// @param statuses Receives the status of each program, 0 on success.
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics of all programs
+  llvm::Error
+  compileBatch(mlir::DialectRegistry &registry, const QSSConfig &config,
+               llvm::StringRef optionsKey,
+               const std::vector<std::string> &inputs,
+               std::vector<std::string> &outputs, std::vector<int> &statuses,
+               std::optional<qssc::DiagnosticCallback> diagnosticCb);
+
+  /// @brief Compile a single program for several configurations of its
+  /// target. The program is parsed and the command line passes are run once
+  /// in the context of the session, after which a copy of the module is
+  /// compiled for each configuration in parallel. Targets are looked up by
+  /// context, so each configuration is compiled in a context of its own
+  /// sharing the thread pool of the session. The command line passes must
+  /// therefore not depend on the target.
+  /// @param registry The dialect registry of the compiler.
+  /// @param config The configuration shared by all target configurations.
+  /// @param optionsKey Key over the command line options, used for caching.
+  /// @param configPaths The target configurations to compile for.
+  /// @param outputs Receives the compilation result of each configuration.
+  /// @param statuses Receives the status of each configuration, 0 on success.
+  /// @param diagnosticCb an optional callback that will receive emitted
+  /// diagnostics of all configurations
+  llvm::Error
+  compileMultiConfig(mlir::DialectRegistry &registry, const QSSConfig &config,
+                     llvm::StringRef optionsKey,
+                     const std::vector<std::string> &configPaths,
+                     std::vector<std::string> &outputs,
+                     std::vector<int> &statuses,
+                     std::optional<qssc::DiagnosticCallback> diagnosticCb);
+
+  /// @brief Stop the compilations of the session once cancelled. The passes run
+  /// in the context of the session are skipped from then on, see
+  /// CompileCancellation::skipPassesOnceCancelled.
+  /// @param cancellation The cancellation, which must outlive the session.
+  /// Must be set before the first compilation of the session.
+  void setCancellation(
+      const qssc::hal::compile::CompileCancellation *cancellation) {
+    this->cancellation = cancellation;
+  }
 
-    if (pos == parameterMap.end())
-      return std::nullopt;
-    return pos->second;
+  /// @brief Run the passes of the session on threadPool rather than on a
+  /// thread pool of its own, if multithreading is enabled.
+  /// @param threadPool The thread pool, which must outlive the session. Must
+  /// be set before the first compilation of the session.
+  void setThreadPool(llvm::ThreadPool *threadPool) {
+    this->threadPool = threadPool;
   }
 
 private:
-  const std::unordered_map<std::string, double> &parameterMap;
+  /// Get the context, creating it on first use with the threading of config,
+  /// i.e., its thread pool, number of threads and CPU affinity. Must be
+  /// called after parsing command line options.
+  llvm::Expected<MLIRContext &> getContext_(mlir::DialectRegistry &registry,
+                                            const QSSConfig &config);
+
+  /// Get the target for the config, only building it if the target or its
+  /// configuration changed since the last job.
+  llvm::Expected<qssc::hal::TargetSystem &>
+  getTarget_(const QSSConfig &config, mlir::TimingScope &timing);
+
+  /// Get the target compilation manager, only building it if the target or
+  /// the pipeline key changed since the last job.
+  qssc::hal::compile::ThreadedCompilationManager &
+  getTargetCompilationManager_(qssc::hal::TargetSystem &target,
+                               bool verifyPasses, llvm::StringRef pipelineKey);
+
+  /// Get the pass managers of the command line passes, only building them if
+  /// the pipeline key changed since the last job.
+  qssc::api::PassPipelineCache &
+  getPassPipelineCache_(bool verifyPasses, llvm::StringRef pipelineKey);
+
+  /// The thread pool of the session if the config sets a number of threads,
+  /// which must outlive the context.
+  std::unique_ptr<llvm::ThreadPool> ownedThreadPool;
+  std::unique_ptr<MLIRContext> context;
+
+  const qssc::hal::compile::CompileCancellation *cancellation = nullptr;
+  llvm::ThreadPool *threadPool = nullptr;
+
+  /// Target name and configuration path the current target was built for.
+  std::optional<std::pair<std::string, std::string>> targetKey;
+  qssc::hal::TargetSystem *target = nullptr;
+
+  /// Pipeline key the target compilation manager was built for.
+  std::string targetCompilationManagerKey;
+  std::unique_ptr<qssc::hal::compile::ThreadedCompilationManager>
+      targetCompilationManager;
+
+  /// Pipeline key the pass managers of the command line passes were built
+  /// for. These refer to the context and are destroyed before it.
+  std::string pipelineCacheKey;
+  std::unique_ptr<qssc::api::PassPipelineCache> pipelineCache;
 };
 
-llvm::Error
-_bindArguments(std::string_view target, std::string_view configPath,
-               std::string_view moduleInput, std::string_view payloadOutputPath,
-               std::unordered_map<std::string, double> const &arguments,
-               bool treatWarningsAsErrors, bool enableInMemoryInput,
-               std::string *inMemoryOutput,
-               const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+llvm::Expected<MLIRContext &>
+CompileSession::getContext_(mlir::DialectRegistry &registry,
+                            const QSSConfig &config) {
+  if (context)
+    return *context;
 
-  MLIRContext context{};
+  // The threads of the thread pools below are started later on, by this
+  // thread, and inherit its affinity.
+  if (auto err = qssc::api::applyCPUAffinity(config))
+    return std::move(err);
 
-  qssc::hal::registry::TargetSystemInfo &targetInfo =
-      *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(target)
-           .value_or(qssc::hal::registry::TargetSystemRegistry::
-                         nullTargetSystemInfo());
+  // Parser workers are forked and must be started before the context starts
+  // any threads.
+  if (auto err = qssc::frontend::openqasm3::startParserWorkers(registry))
+    return std::move(err);
 
-  auto created = targetInfo.createTarget(&context, llvm::StringRef(configPath));
-  if (auto err = created.takeError()) {
-    return llvm::joinErrors(
-        llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                "Unable to create target!"),
-        std::move(err));
+  // Instantiate after parsing command line options.
+  context = std::make_unique<MLIRContext>();
+  context->appendDialectRegistry(registry);
+  if (context->isMultithreadingEnabled()) {
+    llvm::ThreadPool *pool = config.getThreadPool();
+    if (!pool && config.getNumThreads().has_value()) {
+      ownedThreadPool = std::make_unique<llvm::ThreadPool>(
+          llvm::hardware_concurrency(*config.getNumThreads()));
+      pool = ownedThreadPool.get();
+    }
+    if (!pool)
+      pool = threadPool;
+    if (pool) {
+      // Replace the context's own pool, whose threads are only started on
+      // first use.
+      context->disableMultithreading();
+      context->setThreadPool(*pool);
+    }
   }
 
-  auto targetInst = targetInfo.getTarget(&context);
-  if (auto err = targetInst.takeError()) {
-    return llvm::joinErrors(
-        llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                "Unable to load target!"),
-        std::move(err));
-  }
+  // Register LLVM dialect and all infrastructure required for translation to
+  // LLVM IR
+  mlir::registerBuiltinDialectTranslation(*context);
+  mlir::registerLLVMDialectTranslation(*context);
+  if (cancellation)
+    cancellation->skipPassesOnceCancelled(context.get());
+  return *context;
+}
 
-  MapAngleArgumentSource const source(arguments);
+llvm::Expected<qssc::hal::TargetSystem &>
+CompileSession::getTarget_(const QSSConfig &config, mlir::TimingScope &timing) {
+  std::pair<std::string, std::string> key{
+      config.getTargetName().value_or("").str(),
+      config.getTargetConfigPath().value_or("").str()};
+  if (target && targetKey == key)
+    return *target;
+
+  // The target is about to be replaced, invalidating anything built for it.
+  targetCompilationManager.reset();
+  target = nullptr;
+  targetKey.reset();
+
+  auto targetResult = buildTarget_(context.get(), config, timing);
+  if (auto err = targetResult.takeError())
+    return std::move(err);
 
-  auto factory = targetInst.get()->getBindArgumentsImplementationFactory();
-  if ((!factory.has_value()) || (factory.value() == nullptr)) {
-    return qssc::emitDiagnostic(
-        onDiagnostic, qssc::Severity::Error,
-        qssc::ErrorCategory::QSSLinkerNotImplemented,
-        "Unable to load bind arguments implementation for target.");
-  }
-  qssc::arguments::BindArgumentsImplementationFactory &factoryRef =
-      *factory.value();
-  return qssc::arguments::bindArguments(
-      moduleInput, payloadOutputPath, source, treatWarningsAsErrors,
-      enableInMemoryInput, inMemoryOutput, factoryRef, onDiagnostic);
+  target = &targetResult.get();
+  targetKey = std::move(key);
+  return *target;
 }
 
-int qssc::bindArguments(
-    std::string_view target, std::string_view configPath,
-    std::string_view moduleInput, std::string_view payloadOutputPath,
-    std::unordered_map<std::string, double> const &arguments,
-    bool treatWarningsAsErrors, bool enableInMemoryInput,
-    std::string *inMemoryOutput,
-    const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+qssc::hal::compile::ThreadedCompilationManager &
+CompileSession::getTargetCompilationManager_(qssc::hal::TargetSystem &target,
+                                             bool verifyPasses,
+                                             llvm::StringRef pipelineKey) {
+  if (targetCompilationManager && targetCompilationManagerKey == pipelineKey)
+    return *targetCompilationManager;
+
+  targetCompilationManager =
+      std::make_unique<qssc::hal::compile::ThreadedCompilationManager>(
+          target, context.get(),
+          [verifyPasses](mlir::PassManager &pm) -> llvm::Error {
+            if (auto err = buildPassManager_(pm, verifyPasses))
+              return err;
+            return llvm::Error::success();
+          });
+  targetCompilationManagerKey = pipelineKey.str();
+  return *targetCompilationManager;
+}
 
-  if (auto err =
-          _bindArguments(target, configPath, moduleInput, payloadOutputPath,
-                         arguments, treatWarningsAsErrors, enableInMemoryInput,
-                         inMemoryOutput, onDiagnostic)) {
-    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+qssc::api::PassPipelineCache &
+CompileSession::getPassPipelineCache_(bool verifyPasses,
+                                      llvm::StringRef pipelineKey) {
+  if (pipelineCache && pipelineCacheKey == pipelineKey)
+    return *pipelineCache;
+
+  pipelineCache = std::make_unique<qssc::api::PassPipelineCache>(
+      context.get(), [verifyPasses](mlir::PassManager &pm) -> llvm::Error {
+        return buildPassManager_(pm, verifyPasses);
+      });
+  pipelineCacheKey = pipelineKey.str();
+  return *pipelineCache;
+}
+
+llvm::Error
+CompileSession::compile(mlir::DialectRegistry &registry,
+                        const QSSConfig &config, llvm::StringRef pipelineKey,
+                        std::string *outputString,
+                        std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+
+  qssc::hal::compile::ProfilingTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  TimingScope timing = tm.getRootScope();
+
+  // The MLIR context for this compilation event.
+  auto contextResult = getContext_(registry, config);
+  if (auto err = contextResult.takeError())
+    return err;
+  MLIRContext &context = contextResult.get();
+
+  mlir::TimingScope buildConfigTiming = timing.nest("build-config");
+  qssc::config::setContextConfig(&context, config);
+  buildConfigTiming.stop();
+
+  // Populate the context
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+  context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
+
+  if (config.shouldShowDialects()) {
+    showDialects_(registry);
+    return llvm::Error::success();
+  }
+
+  if (config.shouldShowTargets()) {
+    showTargets_();
+    return llvm::Error::success();
+  }
+
+  if (config.shouldShowPayloads()) {
+    showPayloads_();
+    return llvm::Error::success();
+  }
+
+  if (config.shouldShowConfig()) {
+    config.emit(llvm::outs());
+    return llvm::Error::success();
+  }
+
+  // Identical compilations are served from the cache without building the
+  // target or running the frontend.
+  auto cacheKey = computeCacheKey_(config, pipelineKey);
+  if (cacheKey.has_value()) {
+    if (auto cachedOutput = qssc::api::CompileCache::instance().lookup(
+            *cacheKey, config.getCompileCacheDir()))
+      return deliverOutput_(config, std::move(*cachedOutput), outputString,
+                            /*writeFile=*/true);
+  }
+
+  if (cancellation)
+    if (auto err = cancellation->check())
+      return err;
+
+  // Build the target for compilation
+  auto targetResult = getTarget_(config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  auto &target = targetResult.get();
+
+  auto diagHandlerId = context.getDiagEngine().registerHandler(
+      [&](mlir::Diagnostic &diagnostic) {
+        diagEngineHandler(diagnostic, diagnosticCb,
+                          config.getVerbosityLevel());
+      });
+  // The handler refers to this job's callback and must not outlive it.
+  auto eraseDiagHandler = llvm::make_scope_exit(
+      [&]() { context.getDiagEngine().eraseHandler(diagHandlerId); });
+
+  auto &targetCompilationManager = getTargetCompilationManager_(
+      target, config.shouldVerifyEachPass(), pipelineKey);
+  if (mlir::failed(qssc::hal::compile::applyTargetCompilationManagerCLOptions(
+          targetCompilationManager)))
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Unable to apply target compilation options.");
+
+  std::optional<qssc::hal::compile::PassMetrics> passMetrics;
+  if (config.getPassMetricsReport().has_value())
+    passMetrics.emplace();
+  targetCompilationManager.enablePassMetrics(
+      passMetrics.has_value() ? &*passMetrics : nullptr);
+  targetCompilationManager.enableCancellation(cancellation);
+
+  // Timing and metrics instrumentation is attached to the target pass
+  // managers for this job only. Rebuild them for the next job rather than
+  // accumulating it.
+  auto invalidateTimedPassManagers = llvm::make_scope_exit([&]() {
+    targetCompilationManager.enablePassMetrics(nullptr);
+    if (tm.isEnabled() || passMetrics.has_value())
+      targetCompilationManager.invalidateTargetPassManagers();
+  });
+
+  // The pass managers of the command line passes are reused across jobs
+  // unless they are instrumented, as are the target pass managers.
+  qssc::api::PassPipelineCache *jobPipelineCache = nullptr;
+  if (!tm.isEnabled() && !passMetrics.has_value())
+    jobPipelineCache =
+        &getPassPipelineCache_(config.shouldVerifyEachPass(), pipelineKey);
+
+  auto compile = [&]() -> llvm::Error {
+    if (!cacheKey.has_value() && !config.shouldUseParametricTemplates())
+      return compileProgram_(context, config, targetCompilationManager,
+                             pipelineKey, outputString, diagnosticCb, timing,
+                             /*exclusiveContext=*/true, /*preparedModule=*/{},
+                             jobPipelineCache);
+
+    // Capture the output for the cache, compileProgram_ still writes it to
+    // the output file.
+    std::string output;
+    if (auto err = compileProgram_(context, config, targetCompilationManager,
+                                   pipelineKey, &output, diagnosticCb, timing,
+                                   /*exclusiveContext=*/true,
+                                   /*preparedModule=*/{}, jobPipelineCache))
+      return err;
+    if (cacheKey.has_value())
+      storeCachedOutput_(config, *cacheKey, output);
+    return deliverOutput_(config, std::move(output), outputString,
+                          /*writeFile=*/false);
+  };
+
+  // The metrics are also reported for failed compilations.
+  auto err = compile();
+  return llvm::joinErrors(std::move(err),
+                          writePassMetrics_(config, passMetrics));
+}
+
+llvm::Error CompileSession::compileBatch(
+    mlir::DialectRegistry &registry, const QSSConfig &config,
+    llvm::StringRef optionsKey, const std::vector<std::string> &inputs,
+    std::vector<std::string> &outputs, std::vector<int> &statuses,
+    std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+
+  qssc::hal::compile::ProfilingTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  TimingScope timing = tm.getRootScope();
+
+  auto contextResult = getContext_(registry, config);
+  if (auto err = contextResult.takeError())
+    return err;
+  MLIRContext &context = contextResult.get();
+  qssc::config::setContextConfig(&context, config);
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+  context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
+
+  // The target is built once and shared by all programs of the batch.
+  auto targetResult = getTarget_(config, timing);
+  if (auto err = targetResult.takeError())
+    return err;
+  auto &target = targetResult.get();
+
+  auto diagHandlerId = context.getDiagEngine().registerHandler(
+      [&](mlir::Diagnostic &diagnostic) {
+        diagEngineHandler(diagnostic, diagnosticCb,
+                          config.getVerbosityLevel());
+      });
+  auto eraseDiagHandler = llvm::make_scope_exit(
+      [&]() { context.getDiagEngine().eraseHandler(diagHandlerId); });
+
+  outputs.assign(inputs.size(), "");
+  statuses.assign(inputs.size(), 1);
+
+  bool const verifyPasses = config.shouldVerifyEachPass();
+
+  // The metrics of the passes of all programs of the batch are reported
+  // together.
+  std::optional<qssc::hal::compile::PassMetrics> passMetrics;
+  if (config.getPassMetricsReport().has_value())
+    passMetrics.emplace();
+
+  // Programs check out the target pass managers of the session from its pass
+  // manager pools, and the pass managers of the command line passes from its
+  // pipeline cache. Timing and metrics instrumentation would accumulate on
+  // pooled pass managers, so such batches build pass managers per program
+  // instead.
+  std::shared_ptr<qssc::hal::compile::TargetPassManagerPools> passManagerPools;
+  qssc::api::PassPipelineCache *batchPipelineCache = nullptr;
+  if (!tm.isEnabled() && !passMetrics.has_value()) {
+    passManagerPools =
+        getTargetCompilationManager_(target, verifyPasses, optionsKey)
+            .getPassManagerPools();
+    batchPipelineCache = &getPassPipelineCache_(verifyPasses, optionsKey);
+  }
+
+  std::mutex errorMutex;
+  llvm::Error batchError = llvm::Error::success();
+
+  mlir::parallelForEach(&context, llvm::seq<size_t>(0, inputs.size()),
+                        [&](size_t index) {
+    QSSConfig programConfig = config;
+    programConfig.setInputBuffer(inputs[index]).setOutputFilePath("-");
+
+    auto cacheKey = computeCacheKey_(programConfig, optionsKey);
+    if (cacheKey.has_value()) {
+      if (auto cachedOutput = qssc::api::CompileCache::instance().lookup(
+              *cacheKey, config.getCompileCacheDir())) {
+        outputs[index] = std::move(*cachedOutput);
+        statuses[index] = 0;
+        return;
+      }
+    }
+
+    // Compilation managers hold the state of a single compilation so each
+    // program gets its own.
+    qssc::hal::compile::ThreadedCompilationManager targetCompilationManager(
+        target, &context,
+        [verifyPasses](mlir::PassManager &pm) -> llvm::Error {
+          if (auto err = buildPassManager_(pm, verifyPasses))
+            return err;
+          return llvm::Error::success();
+        },
+        passManagerPools);
+    targetCompilationManager.enablePassMetrics(
+        passMetrics.has_value() ? &*passMetrics : nullptr);
+
+    llvm::Error err = llvm::Error::success();
+    if (mlir::failed(qssc::hal::compile::applyTargetCompilationManagerCLOptions(
+            targetCompilationManager)))
+      err = llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Unable to apply target compilation options.");
+    else
+      err = compileProgram_(context, programConfig, targetCompilationManager,
+                            optionsKey, &outputs[index], diagnosticCb, timing,
+                            /*exclusiveContext=*/false, /*preparedModule=*/{},
+                            batchPipelineCache);
+
+    if (!err) {
+      if (cacheKey.has_value())
+        storeCachedOutput_(programConfig, *cacheKey, outputs[index]);
+      statuses[index] = 0;
+      return;
+    }
+
+    std::lock_guard<std::mutex> const lock(errorMutex);
+    batchError = llvm::joinErrors(
+        std::move(batchError),
+        llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                "Program " + std::to_string(index) + ": " +
+                                    llvm::toString(std::move(err))));
+  });
+
+  return llvm::joinErrors(std::move(batchError),
+                          writePassMetrics_(config, passMetrics));
+}
+
+llvm::Error CompileSession::compileMultiConfig(
+    mlir::DialectRegistry &registry, const QSSConfig &config,
+    llvm::StringRef optionsKey, const std::vector<std::string> &configPaths,
+    std::vector<std::string> &outputs, std::vector<int> &statuses,
+    std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+
+  qssc::hal::compile::ProfilingTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  TimingScope timing = tm.getRootScope();
+
+  auto contextResult = getContext_(registry, config);
+  if (auto err = contextResult.takeError())
+    return err;
+  MLIRContext &context = contextResult.get();
+  qssc::config::setContextConfig(&context, config);
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+  context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
+
+  if (config.getEmitAction() < EmitAction::MLIR)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Multi-config compilation requires emitting MLIR or a payload.");
+
+  auto diagHandlerId = context.getDiagEngine().registerHandler(
+      [&](mlir::Diagnostic &diagnostic) {
+        diagEngineHandler(diagnostic, diagnosticCb,
+                          config.getVerbosityLevel());
+      });
+  auto eraseDiagHandler = llvm::make_scope_exit(
+      [&]() { context.getDiagEngine().eraseHandler(diagHandlerId); });
+
+  outputs.assign(configPaths.size(), "");
+  statuses.assign(configPaths.size(), 1);
+
+  bool const verifyPasses = config.shouldVerifyEachPass();
+  auto pmBuilder = [verifyPasses](mlir::PassManager &pm) -> llvm::Error {
+    if (auto err = buildPassManager_(pm, verifyPasses))
+      return err;
+    return llvm::Error::success();
+  };
+
+  // The metrics of the preparation and of all configurations are reported
+  // together.
+  std::optional<qssc::hal::compile::PassMetrics> passMetrics;
+  if (config.getPassMetricsReport().has_value())
+    passMetrics.emplace();
+
+  // Parse the program and run the command line passes once, without a
+  // target, into bytecode from which each configuration parses its copy.
+  std::string preparedModule;
+  auto prepare = [&]() -> llvm::Error {
+    mlir::TimingScope prepareTiming = timing.nest("prepare-module");
+    QSSConfig prepareConfig = config;
+    prepareConfig.setEmitAction(EmitAction::MLIRBytecode)
+        .compileTargetIR(false)
+        .useParametricTemplates(false)
+        .setOutputFilePath("-");
+
+    auto nullTarget =
+        qssc::hal::registry::TargetSystemRegistry::nullTargetSystemInfo()
+            ->createTarget(&context, std::nullopt);
+    if (auto err = nullTarget.takeError())
+      return err;
+    qssc::hal::compile::ThreadedCompilationManager prepareCompilationManager(
+        **nullTarget, &context, pmBuilder);
+    prepareCompilationManager.enablePassMetrics(
+        passMetrics.has_value() ? &*passMetrics : nullptr);
+    return compileProgram_(context, prepareConfig, prepareCompilationManager,
+                           optionsKey, &preparedModule, diagnosticCb,
+                           prepareTiming);
+  };
+  if (auto err = prepare())
+    return llvm::joinErrors(std::move(err),
+                            writePassMetrics_(config, passMetrics));
+
+  // The contexts of the configurations run their passes on the thread pool of
+  // the session.
+  llvm::ThreadPool *threadPool = context.isMultithreadingEnabled()
+                                     ? &context.getThreadPool()
+                                     : nullptr;
+
+  std::mutex errorMutex;
+  llvm::Error multiConfigError = llvm::Error::success();
+
+  mlir::parallelForEach(&context, llvm::seq<size_t>(0, configPaths.size()),
+                        [&](size_t index) {
+    QSSConfig programConfig = config;
+    programConfig.setTargetConfigPath(configPaths[index])
+        .setOutputFilePath("-");
+
+    auto compileConfig = [&]() -> llvm::Error {
+      auto cacheKey = computeCacheKey_(programConfig, optionsKey);
+      if (cacheKey.has_value()) {
+        if (auto cachedOutput = qssc::api::CompileCache::instance().lookup(
+                *cacheKey, config.getCompileCacheDir())) {
+          outputs[index] = std::move(*cachedOutput);
+          return llvm::Error::success();
+        }
+      }
+
+      MLIRContext configContext(registry, MLIRContext::Threading::DISABLED);
+      if (threadPool)
+        configContext.setThreadPool(*threadPool);
+      mlir::registerBuiltinDialectTranslation(configContext);
+      mlir::registerLLVMDialectTranslation(configContext);
+      qssc::config::setContextConfig(&configContext, programConfig);
+      auto eraseContextConfig = llvm::make_scope_exit([&]() {
+        qssc::config::eraseContextConfig(&configContext);
+        qssc::hal::registry::TargetSystemRegistry::releaseTargets(
+            &configContext);
+      });
+      configContext.allowUnregisteredDialects(
+          config.shouldAllowUnregisteredDialects());
+      configContext.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
+      configContext.getDiagEngine().registerHandler(
+          [&](mlir::Diagnostic &diagnostic) {
+            diagEngineHandler(diagnostic, diagnosticCb,
+                              config.getVerbosityLevel());
+          });
+
+      auto targetResult =
+          buildTarget_(&configContext, programConfig, timing);
+      if (auto err = targetResult.takeError())
+        return err;
+
+      qssc::hal::compile::ThreadedCompilationManager targetCompilationManager(
+          targetResult.get(), &configContext, pmBuilder);
+      targetCompilationManager.enablePassMetrics(
+          passMetrics.has_value() ? &*passMetrics : nullptr);
+      if (mlir::failed(
+              qssc::hal::compile::applyTargetCompilationManagerCLOptions(
+                  targetCompilationManager)))
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            "Unable to apply target compilation options.");
+
+      if (auto err = compileProgram_(
+              configContext, programConfig, targetCompilationManager,
+              optionsKey, &outputs[index], diagnosticCb, timing,
+              /*exclusiveContext=*/false, preparedModule))
+        return err;
+      if (cacheKey.has_value())
+        storeCachedOutput_(programConfig, *cacheKey, outputs[index]);
+      return llvm::Error::success();
+    };
+
+    auto err = compileConfig();
+    if (!err) {
+      statuses[index] = 0;
+      return;
+    }
+
+    std::lock_guard<std::mutex> const lock(errorMutex);
+    multiConfigError = llvm::joinErrors(
+        std::move(multiConfigError),
+        llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                "Configuration " + configPaths[index] + ": " +
+                                    llvm::toString(std::move(err))));
+  });
+
+  return llvm::joinErrors(std::move(multiConfigError),
+                          writePassMetrics_(config, passMetrics));
+}
+
+llvm::Error compile_(int argc, char const **argv, std::string *outputString,
+                     std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+
+  // Initialize LLVM to start.
+  llvm::InitLLVM const y(argc, argv);
+
+  // Printing the version needs neither passes nor targets.
+  if (argc == 2 && (llvm::StringRef(argv[1]) == "--version" ||
+                    llvm::StringRef(argv[1]) == "-version")) {
+    printVersion(llvm::outs());
+    return llvm::Error::success();
+  }
+
+  auto registry = initializeCompiler_(getSelectedTarget_(argc, argv));
+  if (auto err = registry.takeError())
+    return err;
+
+  auto config = parseConfig_(argc, argv, /*exitOnError=*/true);
+  if (auto err = config.takeError())
+    return err;
+
+  CompileSession session;
+  return session.compile(*registry, *config,
+                         computePipelineKey_(argc, argv, *config), outputString,
+                         std::move(diagnosticCb));
+}
+
+llvm::Error
+compileConfig_(const QSSConfig &inputConfig, std::string *outputString,
+               std::optional<qssc::DiagnosticCallback> diagnosticCb,
+               const qssc::hal::compile::CompileCancellation *cancellation =
+                   nullptr) {
+  auto registry = initializeCompiler_();
+  if (auto err = registry.takeError())
+    return err;
+
+  QSSConfig config = inputConfig;
+  if (auto err = config.computeInputType())
+    return err;
+  if (auto err = config.computeOutputType())
+    return err;
+
+  // Each compilation has a session, and so a context, of its own so that
+  // compilations may run concurrently.
+  CompileSession session;
+  session.setCancellation(cancellation);
+  return session.compile(*registry, config, computeConfigKey_(config),
+                         outputString, std::move(diagnosticCb));
+}
+
+llvm::Error
+compileConcurrent_(int argc, char const **argv, std::string *outputString,
+                   std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+  auto registry = initializeCompiler_(getSelectedTarget_(argc, argv));
+  if (auto err = registry.takeError())
+    return err;
+
+  auto config = parseConfig_(argc, argv, /*exitOnError=*/false);
+  if (auto err = config.takeError())
+    return err;
+
+  return compileConfig_(*config, outputString, std::move(diagnosticCb));
+}
+
+llvm::Error
+compileBatch_(int argc, char const **argv,
+              const std::vector<std::string> &inputs,
+              std::vector<std::string> &outputs, std::vector<int> &statuses,
+              CompileSession &session,
+              std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+  // Until compiled every program is considered failed.
+  outputs.assign(inputs.size(), "");
+  statuses.assign(inputs.size(), 1);
+
+  auto registry = initializeCompiler_();
+  if (auto err = registry.takeError())
+    return err;
+
+  auto config = parseConfig_(argc, argv, /*exitOnError=*/false);
+  if (auto err = config.takeError())
+    return err;
+
+  return session.compileBatch(*registry, *config,
+                              computePipelineKey_(argc, argv, *config), inputs,
+                              outputs, statuses, std::move(diagnosticCb));
+}
+
+llvm::Error compileMultiConfig_(
+    int argc, char const **argv, const std::vector<std::string> &configPaths,
+    std::vector<std::string> &outputs, std::vector<int> &statuses,
+    CompileSession &session,
+    std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+  // Until compiled every configuration is considered failed.
+  outputs.assign(configPaths.size(), "");
+  statuses.assign(configPaths.size(), 1);
+
+  auto registry = initializeCompiler_();
+  if (auto err = registry.takeError())
+    return err;
+
+  auto config = parseConfig_(argc, argv, /*exitOnError=*/false);
+  if (auto err = config.takeError())
+    return err;
+
+  return session.compileMultiConfig(
+      *registry, *config, computePipelineKey_(argc, argv, *config),
+      configPaths, outputs, statuses, std::move(diagnosticCb));
+}
+
+/// @brief Read a length prefixed field "<len>\n<bytes>" of the compile server
+/// protocol.
+std::optional<std::string> readServerField_(std::istream &in) {
+  size_t length;
+  if (!(in >> length) || in.get() != '\n')
+    return std::nullopt;
+  std::string field(length, '\0');
+  if (!in.read(field.data(), static_cast<std::streamsize>(length)))
+    return std::nullopt;
+  return field;
+}
+
+/// @brief Apply a request of compileJSONL on top of the base configuration
+/// of the batch.
+llvm::Error applyJSONLRequest_(const llvm::json::Object &request,
+                               QSSConfig &config) {
+  auto invalid = [](llvm::StringRef field) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid request field: " + field);
+  };
+  auto getString = [&](llvm::StringRef field, auto setter) -> llvm::Error {
+    const auto *value = request.get(field);
+    if (!value)
+      return llvm::Error::success();
+    auto str = value->getAsString();
+    if (!str)
+      return invalid(field);
+    setter(str->str());
+    return llvm::Error::success();
+  };
+
+  auto source = request.getString("source");
+  auto path = request.getString("path");
+  if (source.has_value() == path.has_value())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "A request must have exactly one of \"source\" or \"path\"");
+  config.setInputSource(source.has_value() ? source->str() : path->str())
+      .directInput(source.has_value())
+      .setOutputFilePath("-");
+
+  if (auto inputType = request.getString("inputType")) {
+    if (*inputType == to_string(InputType::QASM))
+      config.setInputType(InputType::QASM);
+    else if (*inputType == to_string(InputType::MLIR))
+      config.setInputType(InputType::MLIR);
+    else
+      return invalid("inputType");
+  } else if (request.get("inputType")) {
+    return invalid("inputType");
+  }
+
+  if (auto emit = request.getString("emit")) {
+    std::optional<EmitAction> action;
+    for (auto candidate :
+         {EmitAction::AST, EmitAction::ASTPretty, EmitAction::MLIR,
+          EmitAction::MLIRBytecode, EmitAction::WaveMem, EmitAction::QEM,
+          EmitAction::QEQEM})
+      if (*emit == to_string(candidate))
+        action = candidate;
+    if (!action)
+      return invalid("emit");
+    config.setEmitAction(*action);
+  } else if (request.get("emit")) {
+    return invalid("emit");
+  }
+
+  if (auto output = request.getString("output")) {
+    config.setOutputFilePath(output->str());
+    // The extension of the output file selects the emit action unless given.
+    EmitAction const extensionAction =
+        fileExtensionToAction(getExtension(*output));
+    if (!request.get("emit") && extensionAction != EmitAction::None)
+      config.setEmitAction(extensionAction);
+  } else if (request.get("output")) {
+    return invalid("output");
+  }
+
+  if (auto err = getString("target", [&](std::string target) {
+        config.setTargetName(std::move(target));
+      }))
+    return err;
+  if (auto err = getString("config", [&](std::string configPath) {
+        config.setTargetConfigPath(std::move(configPath));
+      }))
+    return err;
+  if (auto err = getString("shotDelay", [&](std::string delay) {
+        config.setShotDelay(std::move(delay));
+      }))
+    return err;
+  if (auto err = getString("passPipeline", [&](std::string pipeline) {
+        config.setPassPipeline(std::move(pipeline));
+      }))
+    return err;
+
+  if (const auto *numShots = request.get("numShots")) {
+    auto shots = numShots->getAsUINT64();
+    if (!shots)
+      return invalid("numShots");
+    config.setNumShots(static_cast<unsigned>(*shots));
+  }
+
+  if (const auto *includeDirs = request.get("includeDirs")) {
+    const auto *dirs = includeDirs->getAsArray();
+    if (!dirs)
+      return invalid("includeDirs");
+    std::vector<std::string> paths = config.getIncludeDirs();
+    for (const auto &dir : *dirs) {
+      auto str = dir.getAsString();
+      if (!str)
+        return invalid("includeDirs");
+      paths.push_back(str->str());
+    }
+    config.setIncludeDirs(std::move(paths));
+  }
+
+  return llvm::Error::success();
+}
+
+/// @brief A request of compileJSONL waiting for a job thread.
+struct JSONLJob_ {
+  llvm::json::Value id;
+  QSSConfig config;
+  std::chrono::steady_clock::time_point queued;
+};
+
+/// @brief Compile a request of compileJSONL and build its response.
+llvm::json::Object compileJSONLJob_(JSONLJob_ &job) {
+  using Seconds = std::chrono::duration<double>;
+  auto const started = std::chrono::steady_clock::now();
+
+  llvm::json::Object response{{"id", std::move(job.id)}};
+  llvm::json::Array diagnostics;
+  std::mutex diagnosticsMutex;
+  std::string output;
+  auto err = compileConfig_(
+      job.config, &output, [&](const qssc::Diagnostic &diagnostic) {
+        std::lock_guard<std::mutex> const lock(diagnosticsMutex);
+        diagnostics.push_back(llvm::json::Object{
+            {"severity", static_cast<int64_t>(diagnostic.severity)},
+            {"category", static_cast<int64_t>(diagnostic.category)},
+            {"message", diagnostic.toString()}});
+      });
+  auto const finished = std::chrono::steady_clock::now();
+
+  response["status"] = err ? 1 : 0;
+  if (err)
+    response["error"] = llvm::toString(std::move(err));
+  else if (job.config.getOutputFilePath() != "-")
+    response["output"] = job.config.getOutputFilePath();
+  else
+    response["payload"] = llvm::encodeBase64(output);
+  response["diagnostics"] = std::move(diagnostics);
+  response["timings"] = llvm::json::Object{
+      {"queueSeconds", Seconds(started - job.queued).count()},
+      {"compileSeconds", Seconds(finished - started).count()}};
+  return response;
+}
+} // anonymous namespace
+
+int qssc::compile(int argc, char const **argv, std::string *outputString,
+                  std::optional<DiagnosticCallback> diagnosticCb) {
+  if (auto err = compile_(argc, argv, outputString, std::move(diagnosticCb))) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::compileConcurrent(int argc, char const **argv,
+                            std::string *outputString,
+                            std::optional<DiagnosticCallback> diagnosticCb) {
+  if (auto err = compileConcurrent_(argc, argv, outputString,
+                                    std::move(diagnosticCb))) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::compile(const config::QSSConfig &config, std::string *outputString,
+                  std::optional<DiagnosticCallback> diagnosticCb) {
+  if (auto err =
+          compileConfig_(config, outputString, std::move(diagnosticCb))) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::compileBatch(int argc, char const **argv,
+                       const std::vector<std::string> &inputs,
+                       std::vector<std::string> *outputs,
+                       std::vector<int> *statuses,
+                       std::optional<DiagnosticCallback> diagnosticCb) {
+  // Initialize LLVM to start.
+  llvm::InitLLVM const y(argc, argv);
+
+  std::vector<std::string> batchOutputs;
+  std::vector<int> batchStatuses;
+  CompileSession session;
+  auto err = compileBatch_(argc, argv, inputs, batchOutputs, batchStatuses,
+                           session, std::move(diagnosticCb));
+
+  if (outputs)
+    *outputs = std::move(batchOutputs);
+  if (statuses)
+    *statuses = std::move(batchStatuses);
+
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::compileMultiConfig(int argc, char const **argv,
+                             const std::vector<std::string> &configPaths,
+                             std::vector<std::string> *outputs,
+                             std::vector<int> *statuses,
+                             std::optional<DiagnosticCallback> diagnosticCb) {
+  // Initialize LLVM to start.
+  llvm::InitLLVM const y(argc, argv);
+
+  std::vector<std::string> configOutputs;
+  std::vector<int> configStatuses;
+  CompileSession session;
+  auto err = compileMultiConfig_(argc, argv, configPaths, configOutputs,
+                                 configStatuses, session,
+                                 std::move(diagnosticCb));
+
+  if (outputs)
+    *outputs = std::move(configOutputs);
+  if (statuses)
+    *statuses = std::move(configStatuses);
+
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::compileJSONL(int argc, char const **argv, std::istream &requests,
+                       llvm::raw_ostream &responses, unsigned numJobs) {
+  // Initialize LLVM to start.
+  llvm::InitLLVM const y(argc, argv);
+
+  auto prepare = [&]() -> llvm::Expected<QSSConfig> {
+    auto registry = initializeCompiler_();
+    if (auto err = registry.takeError())
+      return std::move(err);
+    auto config = parseConfig_(argc, argv, /*exitOnError=*/false);
+    if (auto err = config.takeError())
+      return std::move(err);
+    // Parser workers are forked and must be started before the job threads.
+    if (auto err = qssc::frontend::openqasm3::startParserWorkers(*registry))
+      return std::move(err);
+    return config;
+  };
+  auto baseConfig = prepare();
+  if (auto err = baseConfig.takeError()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  // The passes of all jobs share a thread pool rather than each job starting
+  // a pool of its own.
+  std::optional<llvm::ThreadPool> passThreadPool;
+  if (!baseConfig->getThreadPool()) {
+    passThreadPool.emplace(
+        llvm::hardware_concurrency(baseConfig->getNumThreads().value_or(0)));
+    baseConfig->setThreadPool(&*passThreadPool);
+  }
+
+  if (numJobs == 0)
+    numJobs = llvm::hardware_concurrency().compute_thread_count();
+
+  std::mutex responsesMutex;
+  auto respond = [&](llvm::json::Object response) {
+    std::lock_guard<std::mutex> const lock(responsesMutex);
+    responses << llvm::json::Value(std::move(response)) << '\n';
+    responses.flush();
+  };
+
+  // Requests are read ahead of the job threads by at most one request per
+  // thread so that memory stays bounded on large inputs.
+  std::mutex queueMutex;
+  std::condition_variable queueNotEmpty;
+  std::condition_variable queueNotFull;
+  std::deque<JSONLJob_> queue;
+  bool endOfRequests = false;
+
+  std::vector<std::thread> jobThreads;
+  jobThreads.reserve(numJobs);
+  for (unsigned i = 0; i < numJobs; ++i)
+    jobThreads.emplace_back([&]() {
+      while (true) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueNotEmpty.wait(lock,
+                           [&]() { return endOfRequests || !queue.empty(); });
+        if (queue.empty())
+          return;
+        JSONLJob_ job = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        queueNotFull.notify_one();
+
+        respond(compileJSONLJob_(job));
+      }
+    });
+
+  std::string line;
+  for (int64_t index = 0; std::getline(requests, line); ++index) {
+    if (llvm::StringRef(line).trim().empty()) {
+      --index;
+      continue;
+    }
+
+    // Requests without an id are identified by their index in the stream.
+    llvm::json::Value id = index;
+    auto config = [&]() -> llvm::Expected<QSSConfig> {
+      auto request = llvm::json::parse(line);
+      if (!request)
+        return request.takeError();
+      const auto *object = request->getAsObject();
+      if (!object)
+        return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                       "A request must be a JSON object");
+      if (const auto *requestId = object->get("id"))
+        id = *requestId;
+      QSSConfig requestConfig = *baseConfig;
+      if (auto err = applyJSONLRequest_(*object, requestConfig))
+        return std::move(err);
+      return requestConfig;
+    }();
+    if (auto err = config.takeError()) {
+      respond(llvm::json::Object{{"id", std::move(id)},
+                                 {"status", 1},
+                                 {"error", llvm::toString(std::move(err))}});
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueNotFull.wait(lock, [&]() { return queue.size() < numJobs; });
+    queue.push_back(JSONLJob_{std::move(id), std::move(*config),
+                              std::chrono::steady_clock::now()});
+    lock.unlock();
+    queueNotEmpty.notify_one();
+  }
+
+  {
+    std::lock_guard<std::mutex> const lock(queueMutex);
+    endOfRequests = true;
+  }
+  queueNotEmpty.notify_all();
+  for (auto &thread : jobThreads)
+    thread.join();
+  return 0;
+}
+
+struct qssc::CompileServer::Impl {
+  explicit Impl(ContextRecyclingPolicy recyclingPolicy)
+      : recyclingPolicy(recyclingPolicy) {
+    startGeneration();
+  }
+
+  /// Run a job in the session, first replacing the session if its context is
+  /// due for recycling, and account for the memory of the job.
+  template <typename Job>
+  auto runJob(Job &&job) {
+    if (shouldRecycle())
+      recycle();
+
+    auto const before = qssc::hal::compile::PassMetrics::takeMemorySnapshot();
+    auto result = job(*session);
+    auto const after = qssc::hal::compile::PassMetrics::takeMemorySnapshot();
+
+    ++metrics.numJobs;
+    ++metrics.contextJobs;
+    metrics.lastJobAllocatedBytes =
+        delta(before.allocatedBytes, after.allocatedBytes);
+    metrics.lastJobResidentBytes =
+        delta(before.residentBytes, after.residentBytes);
+    metrics.contextAllocatedBytes =
+        delta(generationAllocatedBytes, after.allocatedBytes);
+    metrics.residentBytes = after.residentBytes;
+    return result;
+  }
+
+  bool shouldRecycle() const {
+    if (metrics.contextJobs == 0)
+      return false;
+    if (recyclingPolicy.maxJobsPerContext != 0 &&
+        metrics.contextJobs >= recyclingPolicy.maxJobsPerContext)
+      return true;
+    return recyclingPolicy.maxContextBytes != 0 &&
+           metrics.contextAllocatedBytes >=
+               static_cast<int64_t>(recyclingPolicy.maxContextBytes);
+  }
+
+  /// Replace the session, freeing the attributes and types uniqued in its
+  /// context. The dialect and target registries, the targets shared between
+  /// contexts, the compile cache and the parser workers are process-wide and
+  /// stay warm.
+  void recycle() {
+    session.reset();
+    ++metrics.contextGeneration;
+    startGeneration();
+  }
+
+  void startGeneration() {
+    session = std::make_unique<CompileSession>();
+    session->setThreadPool(&threadPool);
+    metrics.contextJobs = 0;
+    metrics.contextAllocatedBytes = 0;
+    generationAllocatedBytes =
+        qssc::hal::compile::PassMetrics::takeMemorySnapshot().allocatedBytes;
+  }
+
+  static int64_t delta(size_t before, size_t after) {
+    return static_cast<int64_t>(after) - static_cast<int64_t>(before);
+  }
+
+  ContextRecyclingPolicy recyclingPolicy;
+  CompileServerMetrics metrics;
+  /// The allocated bytes of the process when the current generation started.
+  size_t generationAllocatedBytes = 0;
+  /// Shared by the contexts of all generations, must outlive the session.
+  llvm::ThreadPool threadPool;
+  std::unique_ptr<CompileSession> session;
+};
+
+qssc::CompileServer::CompileServer(ContextRecyclingPolicy recyclingPolicy)
+    : impl(std::make_unique<Impl>(recyclingPolicy)) {}
+
+qssc::CompileServer::~CompileServer() = default;
+
+qssc::CompileServerMetrics qssc::CompileServer::getMetrics() const {
+  return impl->metrics;
+}
+
+void qssc::CompileServer::recycleContext() { impl->recycle(); }
+
+int qssc::CompileServer::compile(
+    int argc, char const **argv, std::string *outputString,
+    std::optional<DiagnosticCallback> diagnosticCb) {
+  auto compileJob = [&]() -> llvm::Error {
+    auto registry = initializeCompiler_();
+    if (auto err = registry.takeError())
+      return err;
+
+    auto config = parseConfig_(argc, argv, /*exitOnError=*/false);
+    if (auto err = config.takeError())
+      return err;
+
+    return impl->runJob([&](CompileSession &session) {
+      return session.compile(*registry, *config,
+                             computePipelineKey_(argc, argv, *config),
+                             outputString, std::move(diagnosticCb));
+    });
+  };
+
+  if (auto err = compileJob()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::CompileServer::compileBatch(
+    int argc, char const **argv, const std::vector<std::string> &inputs,
+    std::vector<std::string> *outputs, std::vector<int> *statuses,
+    std::optional<DiagnosticCallback> diagnosticCb) {
+  std::vector<std::string> batchOutputs;
+  std::vector<int> batchStatuses;
+  auto err = impl->runJob([&](CompileSession &session) {
+    return compileBatch_(argc, argv, inputs, batchOutputs, batchStatuses,
+                         session, std::move(diagnosticCb));
+  });
+
+  if (outputs)
+    *outputs = std::move(batchOutputs);
+  if (statuses)
+    *statuses = std::move(batchStatuses);
+
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
+    return 1;
+  }
+
+  return 0;
+}
+
+int qssc::CompileServer::compileMultiConfig(
+    int argc, char const **argv, const std::vector<std::string> &configPaths,
+    std::vector<std::string> *outputs, std::vector<int> *statuses,
+    std::optional<DiagnosticCallback> diagnosticCb) {
+  std::vector<std::string> configOutputs;
+  std::vector<int> configStatuses;
+  auto err = impl->runJob([&](CompileSession &session) {
+    return compileMultiConfig_(argc, argv, configPaths, configOutputs,
+                               configStatuses, session,
+                               std::move(diagnosticCb));
+  });
+
+  if (outputs)
+    *outputs = std::move(configOutputs);
+  if (statuses)
+    *statuses = std::move(configStatuses);
+
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error: ");
     return 1;
   }
+
+  return 0;
+}
+
+int qssc::CompileServer::serve(std::istream &requests,
+                               llvm::raw_ostream &responses) {
+  while (true) {
+    size_t argc;
+    if (!(requests >> argc))
+      // End of the request stream.
+      return 0;
+    if (requests.get() != '\n') {
+      llvm::errs() << "Error: malformed compile server request header\n";
+      return 1;
+    }
+
+    std::vector<std::string> args;
+    args.reserve(argc);
+    for (size_t i = 0; i < argc; ++i) {
+      auto arg = readServerField_(requests);
+      if (!arg) {
+        llvm::errs() << "Error: malformed compile server request argument\n";
+        return 1;
+      }
+      args.push_back(std::move(*arg));
+    }
+
+    std::vector<char const *> argv;
+    argv.reserve(args.size() + 1);
+    for (auto &arg : args)
+      argv.push_back(arg.c_str());
+    argv.push_back(nullptr);
+
+    std::string output;
+    int const status =
+        compile(static_cast<int>(args.size()), argv.data(), &output, {});
+
+    responses << status << ' ' << output.size() << '\n';
+    responses.write(output.data(), output.size());
+    responses.flush();
+  }
+}
+
+/// @brief Create the target and run a callback with its bind arguments
+/// implementation factory.
+/// @param cancellation Stops the binding before it patches the module once
+/// cancelled, if given.
+llvm::Error withBindArgumentsFactory_(
+    std::string_view target, std::string_view configPath,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    llvm::function_ref<
+        llvm::Error(qssc::arguments::BindArgumentsImplementationFactory &)>
+        callback,
+    const qssc::hal::compile::CompileCancellation *cancellation = nullptr) {
+
+  auto &metrics = qssc::hal::compile::MetricsRegistry::instance();
+  auto const start = qssc::hal::compile::MetricsRegistry::Clock::now();
+  bool bound = false;
+  auto recordBinding = llvm::make_scope_exit([&]() {
+    metrics.increment("qssc_bind_arguments_total",
+                      "Calls binding arguments into payloads by their status",
+                      {{"target", std::string(target)},
+                       {"status", bound ? "success" : "failure"}});
+    metrics.observeDuration("qssc_bind_arguments_duration_seconds",
+                            "Seconds spent binding arguments into payloads, "
+                            "including creating the target",
+                            {{"target", std::string(target)}}, start);
+  });
+
+  MLIRContext context{};
+
+  qssc::hal::registry::TargetSystemInfo &targetInfo =
+      *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(target)
+           .value_or(qssc::hal::registry::TargetSystemRegistry::
+                         nullTargetSystemInfo());
+
+  auto created = targetInfo.createTarget(&context, llvm::StringRef(configPath));
+  if (auto err = created.takeError()) {
+    return llvm::joinErrors(
+        llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                "Unable to create target!"),
+        std::move(err));
+  }
+
+  auto targetInst = targetInfo.getTarget(&context);
+  if (auto err = targetInst.takeError()) {
+    return llvm::joinErrors(
+        llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                "Unable to load target!"),
+        std::move(err));
+  }
+
+  auto factory = targetInst.get()->getBindArgumentsImplementationFactory();
+  if ((!factory.has_value()) || (factory.value() == nullptr)) {
+    return qssc::emitDiagnostic(
+        onDiagnostic, qssc::Severity::Error,
+        qssc::ErrorCategory::QSSLinkerNotImplemented,
+        "Unable to load bind arguments implementation for target.");
+  }
+  if (cancellation)
+    if (auto err = cancellation->check())
+      return err;
+  auto err = callback(*factory.value());
+  bound = !err;
+  return err;
+}
+
+llvm::Error
+_bindArguments(std::string_view target, std::string_view configPath,
+               std::string_view moduleInput, std::string_view payloadOutputPath,
+               std::unordered_map<std::string, double> const &arguments,
+               bool treatWarningsAsErrors, bool enableInMemoryInput,
+               std::string *inMemoryOutput,
+               const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+               bool patchInParallel) {
+
+  MapAngleArgumentSource const source(arguments);
+
+  return withBindArgumentsFactory_(
+      target, configPath, onDiagnostic,
+      [&](qssc::arguments::BindArgumentsImplementationFactory &factory) {
+        return qssc::arguments::bindArguments(
+            moduleInput, payloadOutputPath, source, treatWarningsAsErrors,
+            enableInMemoryInput, inMemoryOutput, factory, onDiagnostic,
+            patchInParallel);
+      });
+}
+
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> _bindArgumentsInMemory(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::unordered_map<std::string, double> const &arguments,
+    bool treatWarningsAsErrors,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool patchInParallel,
+    const qssc::hal::compile::CompileCancellation *cancellation = nullptr) {
+
+  MapAngleArgumentSource const source(arguments);
+
+  std::unique_ptr<llvm::MemoryBuffer> payload;
+  if (auto err = withBindArgumentsFactory_(
+          target, configPath, onDiagnostic,
+          [&](qssc::arguments::BindArgumentsImplementationFactory &factory)
+              -> llvm::Error {
+            auto payloadOrErr = qssc::arguments::bindArgumentsInMemory(
+                llvm::MemoryBufferRef(moduleInput, "circuit module"), source,
+                treatWarningsAsErrors, factory, onDiagnostic, patchInParallel);
+            if (auto err = payloadOrErr.takeError())
+              return err;
+            payload = std::move(*payloadOrErr);
+            return llvm::Error::success();
+          },
+          cancellation))
+    return std::move(err);
+  return payload;
+}
+
+llvm::Error _bindArgumentsBatch(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> &outputs, std::vector<int> &statuses,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    const std::optional<qssc::arguments::BatchResultCallback> &onResult) {
+
+  // Until bound every argument set is considered failed.
+  outputs.assign(argumentSets.size(), "");
+  statuses.assign(argumentSets.size(), 1);
+
+  std::vector<MapAngleArgumentSource> sources;
+  sources.reserve(argumentSets.size());
+  for (const auto &arguments : argumentSets)
+    sources.emplace_back(arguments);
+  std::vector<const qssc::arguments::ArgumentSource *> sourcePtrs;
+  sourcePtrs.reserve(sources.size());
+  for (const auto &source : sources)
+    sourcePtrs.push_back(&source);
+
+  return withBindArgumentsFactory_(
+      target, configPath, onDiagnostic,
+      [&](qssc::arguments::BindArgumentsImplementationFactory &factory) {
+        return qssc::arguments::bindArgumentsBatch(
+            moduleInput, sourcePtrs, treatWarningsAsErrors,
+            enableInMemoryInput, outputs, statuses, factory, onDiagnostic,
+            onResult);
+      });
+}
+
+llvm::Error _bindParameterTable(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput, std::string &table,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+
+  std::vector<MapAngleArgumentSource> sources;
+  sources.reserve(argumentSets.size());
+  for (const auto &arguments : argumentSets)
+    sources.emplace_back(arguments);
+  std::vector<const qssc::arguments::ArgumentSource *> sourcePtrs;
+  sourcePtrs.reserve(sources.size());
+  for (const auto &source : sources)
+    sourcePtrs.push_back(&source);
+
+  return withBindArgumentsFactory_(
+      target, configPath, onDiagnostic,
+      [&](qssc::arguments::BindArgumentsImplementationFactory &factory) {
+        return qssc::arguments::bindParameterTable(
+            moduleInput, sourcePtrs, treatWarningsAsErrors,
+            enableInMemoryInput, table, factory, onDiagnostic);
+      });
+}
+
+int qssc::bindArguments(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput, std::string_view payloadOutputPath,
+    std::unordered_map<std::string, double> const &arguments,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::string *inMemoryOutput,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool patchInParallel) {
+
+  if (auto err =
+          _bindArguments(target, configPath, moduleInput, payloadOutputPath,
+                         arguments, treatWarningsAsErrors, enableInMemoryInput,
+                         inMemoryOutput, onDiagnostic, patchInParallel)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+int qssc::bindArgumentsInMemory(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    std::unordered_map<std::string, double> const &arguments,
+    bool treatWarningsAsErrors,
+    std::unique_ptr<llvm::MemoryBuffer> *payloadOutput,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    bool patchInParallel) {
+
+  auto payload =
+      _bindArgumentsInMemory(target, configPath, moduleInput, arguments,
+                             treatWarningsAsErrors, onDiagnostic,
+                             patchInParallel);
+  if (auto err = payload.takeError()) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  if (payloadOutput)
+    *payloadOutput = std::move(*payload);
+  return 0;
+}
+
+int qssc::bindArgumentsBatch(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> *outputs, std::vector<int> *statuses,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+    const std::optional<qssc::arguments::BatchResultCallback> &onResult) {
+
+  std::vector<std::string> batchOutputs;
+  std::vector<int> batchStatuses;
+  auto err = _bindArgumentsBatch(target, configPath, moduleInput, argumentSets,
+                                 treatWarningsAsErrors, enableInMemoryInput,
+                                 batchOutputs, batchStatuses, onDiagnostic,
+                                 onResult);
+
+  if (outputs)
+    *outputs = std::move(batchOutputs);
+  if (statuses)
+    *statuses = std::move(batchStatuses);
+
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+int qssc::bindParameterTable(
+    std::string_view target, std::string_view configPath,
+    std::string_view moduleInput,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput, std::string *table,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+
+  std::string boundTable;
+  auto err = _bindParameterTable(target, configPath, moduleInput, argumentSets,
+                                 treatWarningsAsErrors, enableInMemoryInput,
+                                 boundTable, onDiagnostic);
+
+  if (table)
+    *table = std::move(boundTable);
+
+  if (err) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+qssc::AsyncHandle::AsyncHandle(
+    std::future<AsyncResult> result,
+    std::shared_ptr<hal::compile::CompileCancellation> cancellation)
+    : result(std::move(result)), cancellation(std::move(cancellation)) {}
+
+qssc::AsyncHandle::AsyncHandle(AsyncHandle &&) noexcept = default;
+qssc::AsyncHandle &
+qssc::AsyncHandle::operator=(AsyncHandle &&) noexcept = default;
+
+qssc::AsyncHandle::~AsyncHandle() {
+  // An abandoned job is cancelled rather than waited for until completion.
+  if (cancellation)
+    cancellation->cancel();
+}
+
+void qssc::AsyncHandle::cancel() { cancellation->cancel(); }
+
+bool qssc::AsyncHandle::waitFor(std::chrono::milliseconds timeout) const {
+  return result.wait_for(timeout) == std::future_status::ready;
+}
+
+qssc::AsyncResult qssc::AsyncHandle::get() { return result.get(); }
+
+qssc::AsyncHandle qssc::compileAsync(
+    config::QSSConfig config,
+    std::optional<std::chrono::steady_clock::time_point> deadline,
+    std::optional<DiagnosticCallback> diagnosticCb) {
+  auto cancellation =
+      std::make_shared<hal::compile::CompileCancellation>(deadline);
+  auto result = std::async(
+      std::launch::async,
+      [config = std::move(config), cancellation,
+       diagnosticCb = std::move(diagnosticCb)]() mutable {
+        AsyncResult result;
+        if (auto err = compileConfig_(config, &result.output,
+                                      std::move(diagnosticCb),
+                                      cancellation.get())) {
+          result.cancelled = cancellation->isCancelled();
+          llvm::logAllUnhandledErrors(std::move(err), llvm::errs(),
+                                      "Error: ");
+          return result;
+        }
+        result.status = 0;
+        return result;
+      });
+  return {std::move(result), std::move(cancellation)};
+}
+
+qssc::AsyncHandle qssc::bindArgumentsAsync(
+    std::string target, std::string configPath, std::string moduleInput,
+    std::unordered_map<std::string, double> arguments,
+    bool treatWarningsAsErrors,
+    std::optional<std::chrono::steady_clock::time_point> deadline,
+    std::optional<DiagnosticCallback> onDiagnostic) {
+  auto cancellation =
+      std::make_shared<hal::compile::CompileCancellation>(deadline);
+  auto result = std::async(
+      std::launch::async,
+      [target = std::move(target), configPath = std::move(configPath),
+       moduleInput = std::move(moduleInput), arguments = std::move(arguments),
+       treatWarningsAsErrors, cancellation,
+       onDiagnostic = std::move(onDiagnostic)]() {
+        AsyncResult result;
+        auto payload = _bindArgumentsInMemory(
+            target, configPath, moduleInput, arguments, treatWarningsAsErrors,
+            onDiagnostic, /*patchInParallel=*/false, cancellation.get());
+        if (auto err = payload.takeError()) {
+          result.cancelled = cancellation->isCancelled();
+          llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+          return result;
+        }
+        result.output = (*payload)->getBuffer().str();
+        result.status = 0;
+        return result;
+      });
+  return {std::move(result), std::move(cancellation)};
+}
+
+std::string qssc::exportMetrics(MetricsFormat format, bool reset) {
+  auto &metrics = hal::compile::MetricsRegistry::instance();
+  hal::compile::MetricsRegistry taken;
+  if (reset)
+    metrics.swap(taken);
+
+  using RegistryFormat = hal::compile::MetricsRegistry::Format;
+  RegistryFormat registryFormat = RegistryFormat::Prometheus;
+  if (format == MetricsFormat::OpenMetrics)
+    registryFormat = RegistryFormat::OpenMetrics;
+  else if (format == MetricsFormat::JSON)
+    registryFormat = RegistryFormat::JSON;
+
+  std::string output;
+  llvm::raw_string_ostream os(output);
+  (reset ? taken : metrics).print(os, registryFormat);
+  return os.str();
+}
+
+int qssc::mergeMetrics(std::string_view json) {
+  auto parsed = llvm::json::parse(llvm::StringRef(json.data(), json.size()));
+  if (!parsed) {
+    llvm::logAllUnhandledErrors(parsed.takeError(), llvm::errs());
+    return 1;
+  }
+  if (auto err = hal::compile::MetricsRegistry::instance().merge(*parsed)) {
+    llvm::logAllUnhandledErrors(std::move(err), llvm::errs());
+    return 1;
+  }
+  return 0;
+}
+
+qssc::CompileCostEstimate
+qssc::CompileCostModel::estimate(const CompileCostFeatures &features) const {
+  auto const targetOperations = features.numOperations * features.numTargets;
+
+  CompileCostEstimate estimate;
+  estimate.features = features;
+  estimate.seconds =
+      baseSeconds +
+      secondsPerOperation * static_cast<double>(features.numOperations) +
+      secondsPerQubit * static_cast<double>(features.numQubits) +
+      secondsPerCircuit * static_cast<double>(features.numCircuits) +
+      secondsPerTargetOperation * static_cast<double>(targetOperations);
+  estimate.peakMemoryBytes = baseBytes +
+                             bytesPerOperation * features.numOperations +
+                             bytesPerQubit * features.numQubits +
+                             bytesPerCircuit * features.numCircuits +
+                             bytesPerTargetOperation * targetOperations;
+  return estimate;
+}
+
+namespace {
+/// @brief Count the features of the program of a compilation which its
+/// compile cost is estimated from, parsing it and building its target in a
+/// context of its own.
+llvm::Expected<qssc::CompileCostFeatures> countCompileCostFeatures_(
+    mlir::DialectRegistry &registry, const QSSConfig &config,
+    std::optional<qssc::DiagnosticCallback> diagnosticCb) {
+  DefaultTimingManager tm;
+  TimingScope timing = tm.getRootScope();
+
+  MLIRContext context;
+  context.appendDialectRegistry(registry);
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+  qssc::config::setContextConfig(&context, config);
+  auto releaseContext = llvm::make_scope_exit([&]() {
+    qssc::config::eraseContextConfig(&context);
+    qssc::hal::registry::TargetSystemRegistry::releaseTargets(&context);
+  });
+
+  mlir::OwningOpRef<mlir::ModuleOp> module;
+  if (config.getInputType() == InputType::QASM) {
+    module = mlir::ModuleOp::create(UnknownLoc::get(&context));
+    if (auto err = qssc::frontend::openqasm3::parse(
+            getParseOptions_(config), config.getInputSource(),
+            !config.isDirectInput(), /*emitRawAST=*/false,
+            /*emitPrettyAST=*/false, /*emitMLIR=*/true, module.get(),
+            std::move(diagnosticCb), timing))
+      return std::move(err);
+  } else if (config.getInputType() == InputType::MLIR) {
+    auto file = openInput_(config);
+    if (!file)
+      return file.takeError();
+    auto sourceMgr = std::make_shared<llvm::SourceMgr>();
+    sourceMgr->AddNewSourceBuffer(std::move(*file), llvm::SMLoc());
+    mlir::ParserConfig const parseConfig(&context);
+    mlir::OwningOpRef<Operation *> op = mlir::parseSourceFileForTool(
+        sourceMgr, parseConfig, !config.shouldUseExplicitModule());
+    module = op ? mlir::dyn_cast<mlir::ModuleOp>(op.release()) : nullptr;
+    if (!module)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Problem parsing source file " +
+                                         config.getInputSource());
+  } else {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "The compile cost is only estimated for OpenQASM 3 and MLIR inputs");
+  }
+
+  qssc::CompileCostFeatures features;
+  module->walk([&](Operation *op) {
+    if (op == module->getOperation())
+      return;
+    ++features.numOperations;
+    if (mlir::isa<mlir::quir::DeclareQubitOp>(op))
+      ++features.numQubits;
+    else if (mlir::isa<mlir::quir::CircuitOp>(op))
+      ++features.numCircuits;
+  });
+
+  if (config.getTargetName().has_value()) {
+    auto target = buildTarget_(&context, config, timing);
+    if (!target)
+      return target.takeError();
+    std::vector<qssc::hal::Target *> pending = target->getChildren();
+    while (!pending.empty()) {
+      auto *current = pending.back();
+      pending.pop_back();
+      ++features.numTargets;
+      auto children = current->getChildren();
+      pending.insert(pending.end(), children.begin(), children.end());
+    }
+  }
+  return features;
+}
+} // anonymous namespace
+
+int qssc::estimateCompileCost(int argc, char const **argv,
+                              CompileCostEstimate *estimate,
+                              std::optional<DiagnosticCallback> diagnosticCb,
+                              const CompileCostModel &model) {
+  auto features = [&]() -> llvm::Expected<CompileCostFeatures> {
+    auto registry = initializeCompiler_(getSelectedTarget_(argc, argv));
+    if (!registry)
+      return registry.takeError();
+    auto config = parseConfig_(argc, argv, /*exitOnError=*/false);
+    if (!config)
+      return config.takeError();
+    return countCompileCostFeatures_(*registry, *config,
+                                     std::move(diagnosticCb));
+  }();
+  if (!features) {
+    llvm::logAllUnhandledErrors(features.takeError(), llvm::errs(),
+                                "Error: ");
+    return 1;
+  }
+
+  if (estimate)
+    *estimate = model.estimate(*features);
   return 0;
 }
@@ -20,38 +20,199 @@
 
 #include "Arguments/Arguments.h"
 #include "API/errors.h"
+#include "Arguments/ParameterExpression.h"
 #include "Arguments/Signature.h"
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
-#include <sstream>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 namespace qssc::arguments {
 
 using namespace payload;
 
-llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
-                             Signature &sig, ArgumentSource const &arguments,
-                             bool treatWarningsAsErrors,
-                             BindArgumentsImplementationFactory &factory,
-                             const OptDiagnosticCallback &onDiagnostic) {
+namespace {
+// read the binaries of sig with patch points ahead of patching them, the
+// failures being reported when they are read again for patching
+void prefetchBinaries(qssc::payload::PatchablePayload &payload,
+                      const Signature &sig, bool markForWriteBack) {
+  std::vector<std::string> binaryNames;
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary)
+    if (patchPoints.size() > 0)
+      binaryNames.push_back(binaryName);
+  llvm::consumeError(payload.prefetchMembers(binaryNames, markForWriteBack));
+}
+} // anonymous namespace
+
+llvm::Error patchBinary(qssc::payload::PatchablePayload *payload,
+                        const std::string &binaryName,
+                        const PatchPointVector &patchPoints,
+                        ArgumentSource const &arguments,
+                        bool treatWarningsAsErrors,
+                        BindArgumentsImplementationFactory &factory,
+                        const OptDiagnosticCallback &onDiagnostic) {
+
+  std::shared_ptr<BindArgumentsImplementation> binary;
+
+  // patch stored members in place where possible which avoids reading and
+  // writing back the whole binary
+  if (factory.supportsInPlacePatching()) {
+    auto viewOrErr = payload->readMemberInPlace(binaryName);
+    if (viewOrErr)
+      binary = std::shared_ptr<BindArgumentsImplementation>(
+          factory.create(viewOrErr.get(), onDiagnostic));
+    else
+      llvm::consumeError(viewOrErr.takeError());
+  }
+
+  if (!binary) {
+    auto binaryDataOrErr = payload->readMember(binaryName);
+
+    if (!binaryDataOrErr) {
+      auto error = binaryDataOrErr.takeError();
+      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                            qssc::ErrorCategory::QSSLinkSignatureError,
+                            "Error reading " + binaryName + " " +
+                                toString(std::move(error)));
+    }
+
+    binary = std::shared_ptr<BindArgumentsImplementation>(
+        factory.create(binaryDataOrErr.get(), onDiagnostic));
+  }
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  for (auto const &patchPoint : patchPoints)
+    if (auto err = binary->patch(patchPoint, arguments))
+      return err;
+
+  return llvm::Error::success();
+}
+
+llvm::Expected<PreparedSignature>
+PreparedSignature::prepare(const Signature &sig,
+                           const BindArgumentsImplementationFactory &factory) {
+
+  PreparedSignature prepared;
+  llvm::StringMap<uint32_t> parameterIndices;
+  llvm::StringMap<Patcher> patchers;
 
   for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
 
     if (patchPoints.size() == 0) // no patch points
       continue;
 
-    auto binaryDataOrErr = payload->readMember(binaryName);
+    auto &binary = prepared.binaries_.emplace_back();
+    binary.name = binaryName;
+    binary.offsets.reserve(patchPoints.size());
+    binary.parameters.reserve(patchPoints.size());
+    binary.patchers.reserve(patchPoints.size());
+
+    for (auto const &patchPoint : patchPoints) {
+      auto [patcher, inserted] = patchers.try_emplace(patchPoint.patchType());
+      if (inserted)
+        patcher->second = factory.getPatcher(patchPoint.patchType());
+      if (!patcher->second)
+        return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                       "No patcher for patch type %s",
+                                       patchPoint.patchType().str().c_str());
+
+      auto [parameter, newParameter] = parameterIndices.try_emplace(
+          patchPoint.expression(), prepared.parameters_.size());
+      if (newParameter)
+        prepared.parameters_.emplace_back(patchPoint.expression());
+
+      binary.offsets.push_back(patchPoint.offset());
+      binary.parameters.push_back(parameter->second);
+      binary.patchers.push_back(patcher->second);
+    }
+  }
+  return prepared;
+}
+
+std::vector<ArgumentType>
+PreparedSignature::getValues(ArgumentSource const &arguments) const {
+  std::vector<ArgumentType> values(parameters_.size());
+  arguments.getArgumentValues(parameters_, values);
+  return values;
+}
+
+llvm::Error
+PreparedSignature::apply(size_t binary, llvm::MutableArrayRef<char> contents,
+                         llvm::ArrayRef<ArgumentType> values) const {
+  auto const &[name, offsets, parameters, patchers] = binaries_[binary];
+  for (size_t i = 0, e = offsets.size(); i < e; ++i) {
+    if (offsets[i] >= contents.size())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Patch point offset %llu beyond the end "
+                                     "of %s",
+                                     (unsigned long long)offsets[i],
+                                     name.c_str());
+    if (auto err = patchers[i](contents, offsets[i], values[parameters[i]]))
+      return err;
+  }
+  return llvm::Error::success();
+}
+
+// patch a binary of a prepared signature, in place where possible
+llvm::Error patchPreparedBinary(qssc::payload::PatchablePayload *payload,
+                                const PreparedSignature &prepared,
+                                size_t binary,
+                                llvm::ArrayRef<ArgumentType> values,
+                                const OptDiagnosticCallback &onDiagnostic) {
+
+  std::string const binaryName = prepared.getBinaryName(binary).str();
+  auto viewOrErr = payload->readMemberInPlace(binaryName);
+  if (viewOrErr)
+    return prepared.apply(binary, viewOrErr.get(), values);
+  llvm::consumeError(viewOrErr.takeError());
+
+  auto binaryDataOrErr = payload->readMember(binaryName);
+  if (!binaryDataOrErr) {
+    auto error = binaryDataOrErr.takeError();
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          "Error reading " + binaryName + " " +
+                              toString(std::move(error)));
+  }
+  return prepared.apply(binary, binaryDataOrErr.get(), values);
+}
+
+llvm::Expected<DeltaBinder>
+DeltaBinder::create(qssc::payload::PatchablePayload &payload,
+                    const Signature &sig, bool treatWarningsAsErrors,
+                    BindArgumentsImplementationFactory &factory,
+                    const OptDiagnosticCallback &onDiagnostic) {
+
+  DeltaBinder binder(payload, treatWarningsAsErrors, factory, onDiagnostic);
+  binder.expressions_ = std::make_shared<ParameterExpressionCache>();
+  prefetchBinaries(payload, sig, /*markForWriteBack=*/false);
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+
+    if (patchPoints.size() == 0) // no patch points
+      continue;
+
+    // the payload itself remains unmodified
+    auto binaryDataOrErr =
+        payload.readMember(binaryName, /*markForWriteBack=*/false);
 
     if (!binaryDataOrErr) {
       auto error = binaryDataOrErr.takeError();
@@ -61,18 +222,172 @@ llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
                                 toString(std::move(error)));
     }
 
-    auto &binaryData = binaryDataOrErr.get();
+    binder.binaries_.emplace(binaryName, binaryDataOrErr.get());
+    size_t const binary = binder.binaryPatchPoints_.size();
+    binder.binaryPatchPoints_.emplace_back(binaryName, &patchPoints);
+    for (size_t index = 0; index < patchPoints.size(); ++index)
+      binder.patchPointsByParameter_[patchPoints[index].expression()]
+          .emplace_back(binary, index);
+  }
+  return binder;
+}
+
+llvm::Error DeltaBinder::bind(ArgumentSource const &boundArguments,
+                              std::string *output) {
 
-    auto binary = std::shared_ptr<BindArgumentsImplementation>(
-        factory.create(binaryData, onDiagnostic));
-    binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+  numPatched_ = 0;
+  ExpressionArgumentSource const arguments(boundArguments, *expressions_);
+
+  // the patch points of the changed parameters of each binary
+  std::vector<std::vector<size_t>> changed(binaryPatchPoints_.size());
+  for (auto const &entry : patchPointsByParameter_) {
+    llvm::StringRef const parameter = entry.getKey();
+    ArgumentType value = arguments.getArgumentValue(parameter);
+    auto [last, inserted] = lastValues_.try_emplace(parameter, value);
+    if (!inserted) {
+      if (last->second == value)
+        continue;
+      last->second = std::move(value);
+    }
+    for (auto const &[binary, index] : entry.getValue())
+      changed[binary].push_back(index);
+  }
+
+  for (size_t binary = 0; binary < changed.size(); ++binary) {
+    auto &indices = changed[binary];
+    if (indices.empty())
+      continue;
 
-    for (auto const &patchPoint : patchPoints)
-      if (auto err = binary->patch(patchPoint, arguments))
+    // patch in the order of the signature
+    llvm::sort(indices);
+    auto const &[binaryName, patchPoints] = binaryPatchPoints_[binary];
+    auto implementation = std::unique_ptr<BindArgumentsImplementation>(
+        factory_->create(binaries_.at(binaryName), onDiagnostic_));
+    implementation->setTreatWarningsAsErrors(treatWarningsAsErrors_);
+
+    for (size_t const index : indices)
+      if (auto err = implementation->patch((*patchPoints)[index], arguments)) {
+        // the binaries are partially patched
+        lastValues_.clear();
         return err;
+      }
+    numPatched_ += indices.size();
   }
 
-  return llvm::Error::success();
+  return payload_->writeStringWithMembers(output, binaries_);
+}
+
+llvm::Error updateParameters(qssc::payload::PatchablePayload *payload,
+                             Signature &sig,
+                             ArgumentSource const &boundArguments,
+                             bool treatWarningsAsErrors,
+                             BindArgumentsImplementationFactory &factory,
+                             const OptDiagnosticCallback &onDiagnostic,
+                             bool patchInParallel) {
+
+  // the values derived from parameters are evaluated once for the payload
+  ParameterExpressionCache expressions;
+  ExpressionArgumentSource const arguments(boundArguments, expressions);
+
+  // decompress the binaries up front rather than as each is patched
+  if (patchInParallel)
+    prefetchBinaries(*payload, sig, /*markForWriteBack=*/true);
+
+  // bind through the patchers of the target where it has them for all
+  // patch types of the signature
+  auto preparedOrErr = PreparedSignature::prepare(sig, factory);
+  if (preparedOrErr) {
+    auto const &prepared = *preparedOrErr;
+    auto const values = prepared.getValues(arguments);
+
+    if (!patchInParallel) {
+      for (size_t binary = 0; binary < prepared.getNumBinaries(); ++binary)
+        if (auto err = patchPreparedBinary(payload, prepared, binary, values,
+                                           onDiagnostic))
+          return err;
+      return llvm::Error::success();
+    }
+
+    std::mutex errorMutex;
+    llvm::Error errors = llvm::Error::success();
+
+    llvm::parallelFor(0, prepared.getNumBinaries(), [&](size_t binary) {
+      if (auto err = patchPreparedBinary(payload, prepared, binary, values,
+                                         onDiagnostic)) {
+        std::lock_guard<std::mutex> const lock(errorMutex);
+        errors = llvm::joinErrors(std::move(errors), std::move(err));
+      }
+    });
+
+    return errors;
+  }
+  llvm::consumeError(preparedOrErr.takeError());
+
+  if (!patchInParallel) {
+    for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary) {
+
+      if (patchPoints.size() == 0) // no patch points
+        continue;
+
+      if (auto err = patchBinary(payload, binaryName, patchPoints, arguments,
+                                 treatWarningsAsErrors, factory, onDiagnostic))
+        return err;
+    }
+
+    return llvm::Error::success();
+  }
+
+  // binaries are independent of each other and are patched concurrently
+  std::vector<const std::pair<const std::string, PatchPointVector> *> binaries;
+  for (const auto &entry : sig.patchPointsByBinary)
+    if (entry.second.size() > 0)
+      binaries.push_back(&entry);
+
+  std::mutex errorMutex;
+  llvm::Error errors = llvm::Error::success();
+
+  llvm::parallelFor(0, binaries.size(), [&](size_t index) {
+    const auto &[binaryName, patchPoints] = *binaries[index];
+    if (auto err = patchBinary(payload, binaryName, patchPoints, arguments,
+                               treatWarningsAsErrors, factory, onDiagnostic)) {
+      std::lock_guard<std::mutex> const lock(errorMutex);
+      errors = llvm::joinErrors(std::move(errors), std::move(err));
+    }
+  });
+
+  return errors;
+}
+
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+bindArgumentsInMemory(llvm::MemoryBufferRef moduleInput,
+                      ArgumentSource const &arguments,
+                      bool treatWarningsAsErrors,
+                      BindArgumentsImplementationFactory &factory,
+                      const OptDiagnosticCallback &onDiagnostic,
+                      bool patchInParallel) {
+
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  auto payload = std::unique_ptr<PatchablePayload>(
+      binary->getPayload(moduleInput.getBuffer(), /*enableInMemory=*/true));
+
+  auto sigOrError = binary->parseSignature(payload.get());
+  if (auto err = sigOrError.takeError())
+    return std::move(err);
+
+  if (auto err =
+          updateParameters(payload.get(), sigOrError.get(), arguments,
+                           treatWarningsAsErrors, factory, onDiagnostic,
+                           patchInParallel))
+    return std::move(err);
+
+  // payload is not on disk, writeBack() assembles the patched payload in
+  // memory to be handed out as a buffer
+  if (auto err = payload->writeBack())
+    return std::move(err);
+  return payload->writeBuffer();
 }
 
 llvm::Error bindArguments(llvm::StringRef moduleInput,
@@ -81,87 +396,256 @@ llvm::Error bindArguments(llvm::StringRef moduleInput,
                           bool treatWarningsAsErrors, bool enableInMemoryInput,
                           std::string *inMemoryOutput,
                           BindArgumentsImplementationFactory &factory,
-                          const OptDiagnosticCallback &onDiagnostic) {
+                          const OptDiagnosticCallback &onDiagnostic,
+                          bool patchInParallel) {
 
   bool const enableInMemoryOutput = payloadOutputPath == "";
 
-  // placeholder string for data on disk if required
-  std::string inputFromDisk;
+  if (!enableInMemoryInput && !enableInMemoryOutput) {
+    // payload on disk: copy to the link payload and patch it in place
+    std::error_code const copyError =
+        llvm::sys::fs::copy_file(moduleInput, payloadOutputPath);
+    if (copyError)
+      return llvm::make_error<llvm::StringError>(
+          "Failed to copy circuit module to payload", copyError);
+
+    auto binary = std::unique_ptr<BindArgumentsImplementation>(
+        factory.create(onDiagnostic));
+    binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+    auto payload = std::unique_ptr<PatchablePayload>(
+        binary->getPayload(payloadOutputPath, /*enableInMemory=*/false));
+
+    auto sigOrError = binary->parseSignature(payload.get());
+    if (auto err = sigOrError.takeError())
+      return err;
+
+    if (auto err =
+            updateParameters(payload.get(), sigOrError.get(), arguments,
+                             treatWarningsAsErrors, factory, onDiagnostic,
+                             patchInParallel))
+      return err;
 
+    return payload->writeBack();
+  }
+
+  // otherwise link in memory, mapping a module on disk rather than reading it
+  std::unique_ptr<llvm::MemoryBuffer> inputFromDisk;
+  llvm::MemoryBufferRef input(moduleInput, "circuit module");
   if (!enableInMemoryInput) {
-    // compile payload on disk
-    // copy to link payload if not returning in memory
-    // load from disk into string if returning in memory
-    if (!enableInMemoryOutput) {
-      std::error_code const copyError =
-          llvm::sys::fs::copy_file(moduleInput, payloadOutputPath);
-      if (copyError)
-        return llvm::make_error<llvm::StringError>(
-            "Failed to copy circuit module to payload", copyError);
-    } else {
-      // read from disk to process in memory
-      std::ostringstream buf;
-      std::ifstream const input(moduleInput.str().c_str());
-      buf << input.rdbuf();
-      inputFromDisk = buf.str();
-      moduleInput = inputFromDisk;
-      enableInMemoryInput = true;
-    }
+    auto bufferOrErr =
+        llvm::MemoryBuffer::getFile(moduleInput, /*IsText=*/false,
+                                    /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::make_error<llvm::StringError>(
+          "Failed to read circuit module", bufferOrErr.getError());
+    inputFromDisk = std::move(*bufferOrErr);
+    input = inputFromDisk->getMemBufferRef();
   }
 
-  if (!enableInMemoryOutput && enableInMemoryInput) {
-    // if payload in memory but returning on disk
-    // copy to disk and process from there
-    std::ofstream payload;
-    payload.open(payloadOutputPath.str(), std::ios::binary);
-    payload.write(moduleInput.str().c_str(), moduleInput.str().length());
-    payload.close();
-    enableInMemoryInput = false;
+  auto payloadOrErr =
+      bindArgumentsInMemory(input, arguments, treatWarningsAsErrors, factory,
+                            onDiagnostic, patchInParallel);
+  if (auto err = payloadOrErr.takeError())
+    return err;
+  auto &payload = *payloadOrErr;
+
+  if (enableInMemoryOutput) {
+    if (inMemoryOutput == nullptr)
+      return llvm::make_error<llvm::StringError>(
+          "inMemoryOutput buffer is null", llvm::inconvertibleErrorCode());
+    inMemoryOutput->assign(payload->getBufferStart(), payload->getBufferSize());
+    return llvm::Error::success();
   }
 
-  llvm::StringRef const payloadData =
-      (enableInMemoryInput) ? moduleInput : payloadOutputPath;
+  return llvm::writeToOutput(payloadOutputPath,
+                             [&](llvm::raw_ostream &os) -> llvm::Error {
+                               os << payload->getBuffer();
+                               return llvm::Error::success();
+                             });
+}
+
+llvm::Error bindArgumentsBatch(
+    llvm::StringRef moduleInput,
+    llvm::ArrayRef<const ArgumentSource *> argumentSets,
+    bool treatWarningsAsErrors, bool enableInMemoryInput,
+    std::vector<std::string> &outputs, std::vector<int> &statuses,
+    BindArgumentsImplementationFactory &factory,
+    const OptDiagnosticCallback &onDiagnostic,
+    const std::optional<BatchResultCallback> &onResult) {
+
+  // Until bound every argument set is considered failed.
+  outputs.assign(argumentSets.size(), "");
+  statuses.assign(argumentSets.size(), 1);
+
+  // the patched payloads are assembled in memory
+  std::unique_ptr<llvm::MemoryBuffer> inputFromDisk;
+  if (!enableInMemoryInput) {
+    auto bufferOrErr =
+        llvm::MemoryBuffer::getFile(moduleInput, /*IsText=*/false,
+                                    /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::make_error<llvm::StringError>(
+          "Failed to read circuit module", bufferOrErr.getError());
+    inputFromDisk = std::move(*bufferOrErr);
+    moduleInput = inputFromDisk->getBuffer();
+  }
 
   auto binary = std::unique_ptr<BindArgumentsImplementation>(
       factory.create(onDiagnostic));
   binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
 
   auto payload = std::unique_ptr<PatchablePayload>(
-      binary->getPayload(payloadData, enableInMemoryInput));
+      binary->getPayload(moduleInput, /*enableInMemory=*/true));
 
   auto sigOrError = binary->parseSignature(payload.get());
   if (auto err = sigOrError.takeError())
     return err;
+  auto &sig = sigOrError.get();
 
-  if (auto err = updateParameters(payload.get(), sigOrError.get(), arguments,
-                                  treatWarningsAsErrors, factory, onDiagnostic))
+  // read the unpatched binaries once
+  auto binderOrErr = DeltaBinder::create(*payload, sig, treatWarningsAsErrors,
+                                         factory, onDiagnostic);
+  if (auto err = binderOrErr.takeError())
     return err;
 
-  // setup linked payload I/O
-  // if enableInMemoryOutput is true:
-  //    write to string
-  // if enableInMemoryInput is true:
-  //    payload is not on disk yet, do not assume payload->writeBack()
-  //    will write the full payload to disk so: write to string,
-  //    dump string to disk and clear string
-  // if enableInMemoryInput is false:
-  //    payload was on disk originally use writeBack
-  if (auto err = payload->writeBack())
-    return err;
-  if (enableInMemoryOutput || enableInMemoryInput) {
-    if (auto err = payload->writeString(inMemoryOutput))
-      return err;
-    if (!enableInMemoryOutput) {
-      auto pathStr = payloadOutputPath.str();
-      std::ofstream out(pathStr);
-      out << inMemoryOutput;
-      out.close();
-      // clear output string
-      *inMemoryOutput = "";
+  // Bind contiguous chunks of the argument sets in parallel, each with a
+  // copy of the binder, so that the argument sets of a chunk, e.g., the
+  // neighbouring points of a sweep, only patch the parameters which differ
+  // from the previous set.
+  size_t const numChunks = std::min<size_t>(
+      argumentSets.size(), llvm::parallel::strategy.compute_thread_count());
+  size_t const chunkSize =
+      numChunks ? (argumentSets.size() + numChunks - 1) / numChunks : 0;
+
+  std::mutex errorMutex;
+  llvm::Error errors = llvm::Error::success();
+
+  llvm::parallelFor(0, numChunks, [&](size_t chunk) {
+    DeltaBinder binder = *binderOrErr;
+    size_t const end = std::min(argumentSets.size(), (chunk + 1) * chunkSize);
+    for (size_t index = chunk * chunkSize; index < end; ++index) {
+      if (auto err = binder.bind(*argumentSets[index], &outputs[index])) {
+        std::lock_guard<std::mutex> const lock(errorMutex);
+        errors = llvm::joinErrors(std::move(errors), std::move(err));
+      } else {
+        statuses[index] = 0;
+      }
+      if (onResult)
+        (*onResult)(index, statuses[index], outputs[index]);
     }
+  });
+
+  return errors;
+}
+
+llvm::Error
+bindParameterTable(llvm::StringRef moduleInput,
+                   llvm::ArrayRef<const ArgumentSource *> argumentSets,
+                   bool treatWarningsAsErrors, bool enableInMemoryInput,
+                   std::string &table,
+                   BindArgumentsImplementationFactory &factory,
+                   const OptDiagnosticCallback &onDiagnostic) {
+
+  table.clear();
+
+  std::unique_ptr<llvm::MemoryBuffer> inputFromDisk;
+  if (!enableInMemoryInput) {
+    auto bufferOrErr =
+        llvm::MemoryBuffer::getFile(moduleInput, /*IsText=*/false,
+                                    /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::make_error<llvm::StringError>(
+          "Failed to read circuit module", bufferOrErr.getError());
+    inputFromDisk = std::move(*bufferOrErr);
+    moduleInput = inputFromDisk->getBuffer();
   }
 
-  return llvm::Error::success();
+  auto binary = std::unique_ptr<BindArgumentsImplementation>(
+      factory.create(onDiagnostic));
+  binary->setTreatWarningsAsErrors(treatWarningsAsErrors);
+
+  auto payload = std::unique_ptr<PatchablePayload>(
+      binary->getPayload(moduleInput, /*enableInMemory=*/true));
+
+  auto sigOrError = binary->parseSignature(payload.get());
+  if (auto err = sigOrError.takeError())
+    return err;
+  auto &sig = sigOrError.get();
+
+  // the instrument binaries must not require patching
+  for (const auto &[binaryName, patchPoints] : sig.patchPointsByBinary)
+    if (binaryName != parameterTableMember && patchPoints.size() > 0)
+      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                            qssc::ErrorCategory::QSSLinkSignatureError,
+                            "Binary " + binaryName +
+                                " has patch points outside of the parameter "
+                                "table");
+
+  // the row of default values emitted by the target
+  auto rowOrErr = payload->readMember(parameterTableMember,
+                                      /*markForWriteBack=*/false);
+  if (!rowOrErr) {
+    auto error = rowOrErr.takeError();
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          "Error reading " + parameterTableMember.str() + " " +
+                              toString(std::move(error)));
+  }
+  auto const &defaultRow = rowOrErr.get();
+  size_t const rowSize = defaultRow.size();
+
+  auto patchPoints = sig.patchPointsByBinary.find(parameterTableMember.str());
+  if (patchPoints == sig.patchPointsByBinary.end()) {
+    // no parameters, every row holds the defaults
+    for (size_t row = 0; row < argumentSets.size(); ++row)
+      table.append(defaultRow.begin(), defaultRow.end());
+    return llvm::Error::success();
+  }
+
+  auto preparedOrErr = PreparedSignature::prepare(sig, factory);
+  const PreparedSignature *prepared = nullptr;
+  if (preparedOrErr)
+    prepared = &*preparedOrErr;
+  else
+    llvm::consumeError(preparedOrErr.takeError());
+
+  table.resize(rowSize * argumentSets.size());
+
+  std::mutex errorMutex;
+  llvm::Error errors = llvm::Error::success();
+
+  ParameterExpressionCache expressions;
+  auto patchRow = [&](ArgumentSource const &boundArguments,
+                      llvm::MutableArrayRef<char> rowContents) -> llvm::Error {
+    ExpressionArgumentSource const arguments(boundArguments, expressions);
+    llvm::copy(defaultRow, rowContents.begin());
+    if (prepared)
+      return prepared->apply(/*binary=*/0, rowContents,
+                             prepared->getValues(arguments));
+
+    std::vector<char> contents(defaultRow);
+    auto implementation = std::unique_ptr<BindArgumentsImplementation>(
+        factory.create(contents, onDiagnostic));
+    implementation->setTreatWarningsAsErrors(treatWarningsAsErrors);
+    for (auto const &patchPoint : patchPoints->second)
+      if (auto err = implementation->patch(patchPoint, arguments))
+        return err;
+    llvm::copy(contents, rowContents.begin());
+    return llvm::Error::success();
+  };
+
+  llvm::parallelFor(0, argumentSets.size(), [&](size_t row) {
+    llvm::MutableArrayRef<char> rowContents(&table[row * rowSize], rowSize);
+    if (auto err = patchRow(*argumentSets[row], rowContents)) {
+      std::lock_guard<std::mutex> const lock(errorMutex);
+      errors = llvm::joinErrors(std::move(errors), std::move(err));
+    }
+  });
+
+  if (errors)
+    table.clear();
+  return errors;
 }
 
 } // namespace qssc::arguments
@@ -0,0 +1,273 @@
+//===- ParameterExpression.cpp - Expressions over parameters ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the parsing and evaluation of the expressions over
+///  parameters of patch points
+///
+//===----------------------------------------------------------------------===//
+
+#include "Arguments/ParameterExpression.h"
+#include "Arguments/Arguments.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace qssc::arguments {
+
+class ExpressionParser {
+public:
+  ExpressionParser(llvm::StringRef text, ParameterExpression &expression)
+      : text(text), expression(expression) {}
+
+  llvm::Error parse() {
+    if (auto err = parseExpression())
+      return err;
+    if (!nextToken().empty())
+      return error("trailing tokens");
+    return llvm::Error::success();
+  }
+
+private:
+  using Kind = ParameterExpression::Kind;
+
+  // the next token, i.e., a parenthesis or a word up to the next
+  // whitespace or parenthesis
+  llvm::StringRef nextToken() {
+    text = text.ltrim();
+    if (text.empty())
+      return {};
+    size_t length = 1;
+    if (text.front() != '(' && text.front() != ')')
+      length = text.find_first_of(" \t\n()");
+    llvm::StringRef const token = text.take_front(length);
+    text = text.drop_front(token.size());
+    return token;
+  }
+
+  llvm::Error error(const llvm::Twine &message) {
+    return llvm::make_error<llvm::StringError>(
+        "Malformed parameter expression: " + message,
+        llvm::inconvertibleErrorCode());
+  }
+
+  void push(ParameterExpression::Step step) {
+    expression.steps.push_back(step);
+    switch (step.kind) {
+    case Kind::Constant:
+    case Kind::Parameter:
+      ++depth;
+      break;
+    case Kind::Add:
+    case Kind::Sub:
+    case Kind::Mul:
+    case Kind::Div:
+      --depth;
+      break;
+    case Kind::Neg:
+    case Kind::Angle:
+      break;
+    }
+    expression.maxDepth = std::max(expression.maxDepth, depth);
+  }
+
+  llvm::Error parseExpression() {
+    llvm::StringRef const token = nextToken();
+    if (token.empty())
+      return error("missing operand");
+    if (token == ")")
+      return error("unexpected ')'");
+    if (token != "(")
+      return parseLeaf(token);
+
+    llvm::StringRef const op = nextToken();
+    auto kind = llvm::StringSwitch<std::optional<Kind>>(op)
+                    .Case("add", Kind::Add)
+                    .Case("sub", Kind::Sub)
+                    .Case("mul", Kind::Mul)
+                    .Case("div", Kind::Div)
+                    .Case("neg", Kind::Neg)
+                    .Case("angle", Kind::Angle)
+                    .Default(std::nullopt);
+    if (!kind)
+      return error("unknown operation '" + op + "'");
+
+    unsigned const numOperands =
+        (*kind == Kind::Neg || *kind == Kind::Angle) ? 1 : 2;
+    for (unsigned i = 0; i < numOperands; ++i)
+      if (auto err = parseExpression())
+        return err;
+    if (nextToken() != ")")
+      return error("expected ')' after the operands of '" + op + "'");
+
+    push({*kind});
+    return llvm::Error::success();
+  }
+
+  llvm::Error parseLeaf(llvm::StringRef token) {
+    if (std::isdigit(static_cast<unsigned char>(token.front())) ||
+        token.front() == '-' || token.front() == '+' || token.front() == '.') {
+      double constant;
+      if (token.getAsDouble(constant))
+        return error("invalid number '" + token + "'");
+      push({Kind::Constant, constant});
+      return llvm::Error::success();
+    }
+
+    auto [index, inserted] = parameterIndices.try_emplace(
+        token, expression.parameters.size());
+    if (inserted)
+      expression.parameters.push_back(token.str());
+    push({Kind::Parameter, 0.0, index->second});
+    return llvm::Error::success();
+  }
+
+  llvm::StringRef text;
+  ParameterExpression &expression;
+  llvm::StringMap<uint32_t> parameterIndices;
+  size_t depth = 0;
+};
+
+llvm::Expected<ParameterExpression>
+ParameterExpression::parse(llvm::StringRef text) {
+  ParameterExpression expression;
+  ExpressionParser parser(text, expression);
+  if (auto err = parser.parse())
+    return std::move(err);
+  return expression;
+}
+
+std::optional<double> ParameterExpression::evaluate(
+    llvm::ArrayRef<std::optional<double>> values) const {
+  std::vector<double> stack;
+  stack.reserve(maxDepth);
+  for (auto const &step : steps) {
+    switch (step.kind) {
+    case Kind::Constant:
+      stack.push_back(step.constant);
+      continue;
+    case Kind::Parameter:
+      if (!values[step.parameter])
+        return std::nullopt;
+      stack.push_back(*values[step.parameter]);
+      continue;
+    case Kind::Neg:
+      stack.back() = -stack.back();
+      continue;
+    case Kind::Angle:
+      stack.back() = wrapAngle(stack.back());
+      continue;
+    case Kind::Add:
+    case Kind::Sub:
+    case Kind::Mul:
+    case Kind::Div:
+      break;
+    }
+
+    double const rhs = stack.back();
+    stack.pop_back();
+    double &lhs = stack.back();
+    switch (step.kind) {
+    case Kind::Add:
+      lhs += rhs;
+      break;
+    case Kind::Sub:
+      lhs -= rhs;
+      break;
+    case Kind::Mul:
+      lhs *= rhs;
+      break;
+    default:
+      lhs /= rhs;
+      break;
+    }
+  }
+  return stack.back();
+}
+
+ArgumentType
+ParameterExpression::evaluate(ArgumentSource const &arguments) const {
+  std::vector<ArgumentType> argumentValues(parameters.size());
+  arguments.getArgumentValues(parameters, argumentValues);
+
+  std::vector<std::optional<double>> values;
+  values.reserve(argumentValues.size());
+  for (auto const &argument : argumentValues)
+    values.push_back(std::get<std::optional<double>>(argument));
+  return evaluate(values);
+}
+
+double ParameterExpression::wrapAngle(double value) {
+  double const twoPi = 2.0 * llvm::numbers::pi;
+  double wrapped = std::fmod(value, twoPi);
+  if (wrapped < 0.0)
+    wrapped += twoPi;
+  // a tiny negative value wraps to 2*pi after rounding
+  return wrapped < twoPi ? wrapped : 0.0;
+}
+
+const ParameterExpression *ParameterExpressionCache::get(llvm::StringRef text) {
+  if (!ParameterExpression::isExpression(text))
+    return nullptr;
+
+  std::lock_guard<std::mutex> const lock(mutex);
+  auto [entry, inserted] = expressions.try_emplace(text);
+  if (inserted) {
+    auto expression = ParameterExpression::parse(text);
+    if (expression)
+      entry->second = std::move(*expression);
+    else
+      llvm::consumeError(expression.takeError());
+  }
+  return entry->second ? &*entry->second : nullptr;
+}
+
+ArgumentType
+ExpressionArgumentSource::getArgumentValue(llvm::StringRef name) const {
+  if (!ParameterExpression::isExpression(name))
+    return source.getArgumentValue(name);
+  if (const auto *expression = cache.get(name))
+    return expression->evaluate(source);
+  return std::optional<double>();
+}
+
+void ExpressionArgumentSource::getArgumentValues(
+    llvm::ArrayRef<std::string> names,
+    llvm::MutableArrayRef<ArgumentType> values) const {
+  // forward the parameters at once, as the source may look them up by index
+  source.getArgumentValues(names, values);
+  for (size_t i = 0; i < names.size(); ++i)
+    if (ParameterExpression::isExpression(names[i]))
+      values[i] = getArgumentValue(names[i]);
+}
+
+} // namespace qssc::arguments
@@ -24,19 +24,52 @@
 #include "API/errors.h"
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <sys/types.h>
 #include <tuple>
+#include <vector>
 
 namespace qssc::arguments {
 
+namespace {
+// Layout of the binary signature, see SignatureView
+constexpr llvm::StringLiteral binaryMagic("\x7fQSSCSIG");
+constexpr uint32_t binaryVersion = 2;
+constexpr size_t headerSize = 32;
+constexpr size_t patchPointSize = 16;
+constexpr size_t binarySize = 12;
+constexpr size_t stringSize = 8;
+
+llvm::Error
+extraDataDiagnostic(const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
+                    bool treatWarningsAsErrors) {
+  if (!treatWarningsAsErrors) {
+    // cast to void to discard llvm::Error
+    static_cast<void>(
+        emitDiagnostic(onDiagnostic, qssc::Severity::Warning,
+                       qssc::ErrorCategory::QSSLinkSignatureWarning,
+                       "Ignoring extra data at end of signature file"));
+    return llvm::Error::success();
+  }
+  return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                        qssc::ErrorCategory::QSSLinkSignatureWarning,
+                        "Ignoring extra data at end of signature file");
+}
+} // anonymous namespace
+
 void Signature::addParameterPatchPoint(llvm::StringRef expression,
                                        llvm::StringRef patchType,
                                        llvm::StringRef binaryComponent,
@@ -86,11 +119,103 @@ std::string Signature::serialize() {
   return s.str();
 }
 
+std::string Signature::serializeBinary() {
+  SignatureWriter writer;
+  for (auto const &[binaryName, patchPoints] : patchPointsByBinary) {
+    // the binaries are the distinct keys of the map
+    llvm::cantFail(writer.beginBinary(binaryName));
+    for (auto const &patchPoint : patchPoints)
+      writer.addPatchPoint(patchPoint.expression(), patchPoint.patchType(),
+                           patchPoint.offset());
+  }
+  return writer.serialize();
+}
+
+llvm::Error SignatureWriter::beginBinary(llvm::StringRef name) {
+  uint32_t const nameIndex = intern(name);
+  for (auto const &binary : binaries_)
+    if (binary.name == nameIndex)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Patch points of binary " + name + " were already added");
+  binaries_.push_back(
+      {nameIndex, static_cast<uint32_t>(patchPoints_.size()), 0});
+  return llvm::Error::success();
+}
+
+void SignatureWriter::addPatchPoint(llvm::StringRef expression,
+                                    llvm::StringRef patchType,
+                                    uint64_t offset) {
+  assert(!binaries_.empty() && "patch point added before any binary");
+  uint32_t const expressionIndex = intern(expression);
+  patchPoints_.push_back({offset, expressionIndex, intern(patchType)});
+  ++binaries_.back().numPatchPoints;
+}
+
+uint32_t SignatureWriter::intern(llvm::StringRef str) {
+  auto [pos, inserted] = stringIndices_.try_emplace(str, strings_.size());
+  if (inserted) {
+    strings_.push_back(pos->getKey());
+    stringDataSize_ += str.size();
+  }
+  return pos->second;
+}
+
+void SignatureWriter::write(llvm::raw_ostream &os) const {
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+
+  os << binaryMagic;
+  writer.write<uint32_t>(binaryVersion);
+  writer.write<uint32_t>(strings_.size());
+  writer.write<uint32_t>(binaries_.size());
+  writer.write<uint32_t>(patchPoints_.size());
+  writer.write<uint64_t>(stringDataSize_);
+
+  for (auto const &patchPoint : patchPoints_) {
+    writer.write<uint64_t>(patchPoint.offset);
+    writer.write<uint32_t>(patchPoint.expression);
+    writer.write<uint32_t>(patchPoint.patchType);
+  }
+
+  for (auto const &binary : binaries_) {
+    writer.write<uint32_t>(binary.name);
+    writer.write<uint32_t>(binary.firstPatchPoint);
+    writer.write<uint32_t>(binary.numPatchPoints);
+  }
+
+  uint32_t stringOffset = 0;
+  for (auto const &str : strings_) {
+    writer.write<uint32_t>(stringOffset);
+    writer.write<uint32_t>(str.size());
+    stringOffset += str.size();
+  }
+
+  for (auto const &str : strings_)
+    os << str;
+}
+
+std::string SignatureWriter::serialize() const {
+  std::string buffer;
+  llvm::raw_string_ostream os(buffer);
+  write(os);
+  return os.str();
+}
+
 llvm::Expected<Signature> Signature::deserialize(
     llvm::StringRef buffer,
     const std::optional<qssc::DiagnosticCallback> &onDiagnostic,
     bool treatWarningsAsErrors) {
 
+  if (SignatureView::isBinarySignature(buffer)) {
+    auto view = SignatureView::create(buffer, onDiagnostic);
+    if (auto err = view.takeError())
+      return std::move(err);
+    if (view->serializedSize() < buffer.size())
+      if (auto err = extraDataDiagnostic(onDiagnostic, treatWarningsAsErrors))
+        return std::move(err);
+    return view->toSignature();
+  }
+
   Signature sig;
 
   llvm::StringRef line;
@@ -176,20 +301,137 @@ llvm::Expected<Signature> Signature::deserialize(
     }
   }
 
-  if (buffer.size() > 0) {
-    if (!treatWarningsAsErrors) {
-      // cast to void to discard llvm::Error
-      static_cast<void>(
-          emitDiagnostic(onDiagnostic, qssc::Severity::Warning,
-                         qssc::ErrorCategory::QSSLinkSignatureWarning,
-                         "Ignoring extra data at end of signature file"));
-    } else {
-      return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
-                            qssc::ErrorCategory::QSSLinkSignatureWarning,
-                            "Ignoring extra data at end of signature file");
+  if (buffer.size() > 0)
+    if (auto err = extraDataDiagnostic(onDiagnostic, treatWarningsAsErrors))
+      return std::move(err);
+  return sig;
+}
+
+llvm::StringRef SignatureView::PatchPointRef::expression() const {
+  return view_.string(
+      view_.read32(view_.patchPointsPos_ + index_ * patchPointSize + 8));
+}
+
+llvm::StringRef SignatureView::PatchPointRef::patchType() const {
+  return view_.string(
+      view_.read32(view_.patchPointsPos_ + index_ * patchPointSize + 12));
+}
+
+uint64_t SignatureView::PatchPointRef::offset() const {
+  return view_.read64(view_.patchPointsPos_ + index_ * patchPointSize);
+}
+
+llvm::StringRef SignatureView::BinaryRef::name() const {
+  return view_.string(view_.read32(view_.binariesPos_ + index_ * binarySize));
+}
+
+size_t SignatureView::BinaryRef::size() const {
+  return view_.read32(view_.binariesPos_ + index_ * binarySize + 8);
+}
+
+SignatureView::PatchPointRef
+SignatureView::BinaryRef::operator[](size_t index) const {
+  size_t const firstPatchPoint =
+      view_.read32(view_.binariesPos_ + index_ * binarySize + 4);
+  return {view_, firstPatchPoint + index};
+}
+
+bool SignatureView::isBinarySignature(llvm::StringRef buffer) {
+  return buffer.startswith(binaryMagic);
+}
+
+llvm::Expected<SignatureView> SignatureView::create(
+    llvm::StringRef buffer,
+    const std::optional<qssc::DiagnosticCallback> &onDiagnostic) {
+
+  auto invalid = [&](const llvm::Twine &message) {
+    return emitDiagnostic(onDiagnostic, qssc::Severity::Error,
+                          qssc::ErrorCategory::QSSLinkSignatureError,
+                          message.str());
+  };
+
+  if (!isBinarySignature(buffer) || buffer.size() < headerSize)
+    return invalid("Invalid binary Signature header");
+
+  SignatureView view;
+  view.buffer_ = buffer;
+
+  uint32_t const version = view.read32(8);
+  if (version != binaryVersion)
+    return invalid("Invalid Signature version: " + llvm::Twine(version));
+
+  view.numStrings_ = view.read32(12);
+  view.numBinaries_ = view.read32(16);
+  view.numPatchPoints_ = view.read32(20);
+  uint64_t const stringDataSize = view.read64(24);
+
+  // sizes are computed in 64 bits and cannot overflow from 32 bit counts
+  view.patchPointsPos_ = headerSize;
+  view.binariesPos_ = view.patchPointsPos_ +
+                      static_cast<uint64_t>(view.numPatchPoints_) *
+                          patchPointSize;
+  view.stringsPos_ =
+      view.binariesPos_ + static_cast<uint64_t>(view.numBinaries_) * binarySize;
+  view.stringDataPos_ =
+      view.stringsPos_ + static_cast<uint64_t>(view.numStrings_) * stringSize;
+  if (stringDataSize > buffer.size() ||
+      view.stringDataPos_ > buffer.size() - stringDataSize)
+    return invalid("Truncated binary Signature");
+  view.serializedSize_ = view.stringDataPos_ + stringDataSize;
+
+  // validate all indices once so that accessors need not check them
+  for (uint32_t i = 0; i < view.numStrings_; ++i) {
+    uint64_t const offset = view.read32(view.stringsPos_ + i * stringSize);
+    uint64_t const size = view.read32(view.stringsPos_ + i * stringSize + 4);
+    if (offset + size > stringDataSize)
+      return invalid("Invalid string in binary Signature");
+  }
+
+  for (uint32_t i = 0; i < view.numPatchPoints_; ++i) {
+    size_t const pos = view.patchPointsPos_ + i * patchPointSize;
+    if (view.read32(pos + 8) >= view.numStrings_ ||
+        view.read32(pos + 12) >= view.numStrings_)
+      return invalid("Invalid patch point in binary Signature");
+  }
+
+  for (uint32_t i = 0; i < view.numBinaries_; ++i) {
+    size_t const pos = view.binariesPos_ + i * binarySize;
+    uint64_t const firstPatchPoint = view.read32(pos + 4);
+    uint64_t const numPatchPoints = view.read32(pos + 8);
+    if (view.read32(pos) >= view.numStrings_ ||
+        firstPatchPoint + numPatchPoints > view.numPatchPoints_)
+      return invalid("Invalid binary in binary Signature");
+  }
+
+  return view;
+}
+
+Signature SignatureView::toSignature() const {
+  Signature sig;
+  for (size_t i = 0; i < numBinaries(); ++i) {
+    auto const binaryRef = binary(i);
+    auto &patchPoints = sig.patchPointsByBinary[binaryRef.name().str()];
+    patchPoints.reserve(binaryRef.size());
+    for (size_t j = 0; j < binaryRef.size(); ++j) {
+      auto const patchPoint = binaryRef[j];
+      patchPoints.emplace_back(patchPoint.expression(), patchPoint.patchType(),
+                               patchPoint.offset());
     }
   }
   return sig;
 }
 
+uint32_t SignatureView::read32(size_t pos) const {
+  return llvm::support::endian::read32le(buffer_.data() + pos);
+}
+
+uint64_t SignatureView::read64(size_t pos) const {
+  return llvm::support::endian::read64le(buffer_.data() + pos);
+}
+
+llvm::StringRef SignatureView::string(uint32_t index) const {
+  size_t const pos = stringsPos_ + static_cast<size_t>(index) * stringSize;
+  return buffer_.substr(stringDataPos_ + read32(pos), read32(pos + 4));
+}
+
 } // namespace qssc::arguments
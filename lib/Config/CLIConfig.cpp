@@ -45,6 +45,10 @@ llvm::cl::OptionCategory
     optCat_(" qss-compiler options: opt",
             "Options that control behaviour inherited from mlir-opt.");
 
+llvm::cl::OptionCategory openqasm3Cat_(
+    " OpenQASM 3 Frontend Options",
+    "Options that control the OpenQASM 3 frontend of QSS Compiler");
+
 class BytecodeVersionParser : public llvm::cl::parser<std::optional<int64_t>> {
 public:
   BytecodeVersionParser(llvm::cl::Option &O)
@@ -109,6 +113,8 @@ struct QSSConfigCLOptions : public QSSConfig {
                                         "pretty print the AST")),
             llvm::cl::values(
                 clEnumValN(EmitAction::MLIR, "mlir", "output the MLIR dump")),
+            llvm::cl::values(clEnumValN(EmitAction::MLIRBytecode, "bytecode",
+                                        "output the MLIR as bytecode")),
             llvm::cl::values(clEnumValN(EmitAction::WaveMem, "wavemem",
                                         "output the waveform memory")),
             llvm::cl::values(
@@ -191,6 +197,254 @@ struct QSSConfigCLOptions : public QSSConfig {
             llvm::cl::init(false),
             llvm::cl::cat(qssc::config::getQSSCCLCategory()));
 
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const streamPayload(
+        "stream-payload",
+        llvm::cl::desc("Archive the payload files of each target in the "
+                       "background as soon as the target has emitted them. "
+                       "Targets may not modify their files afterwards."),
+        llvm::cl::location(streamPayloadFlag), llvm::cl::init(false),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const splitPayload(
+        "split-payload",
+        llvm::cl::desc("Archive the payload files of each instrument "
+                       "contiguously and index their byte ranges in "
+                       "manifest/groups.json, so that instruments may be "
+                       "loaded in parallel."),
+        llvm::cl::location(splitPayloadFlag), llvm::cl::init(false),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<enum PayloadCompression,
+                         /*ExternalStorage=*/true> const
+        compression(
+            "payload-compression", llvm::cl::location(payloadCompression),
+            llvm::cl::init(PayloadCompression::Store),
+            llvm::cl::desc("Compression of the payload members, members are "
+                           "compressed concurrently"),
+            llvm::cl::values(clEnumValN(PayloadCompression::Store, "store",
+                                        "store members uncompressed")),
+            llvm::cl::values(clEnumValN(PayloadCompression::Deflate,
+                                        "deflate", "compress with deflate")),
+            llvm::cl::values(clEnumValN(
+                PayloadCompression::Zstd, "zstd",
+                "compress with zstd, or deflate if zstd is unavailable")),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<int, /*ExternalStorage=*/true> const compressionLevel(
+        "payload-compression-level",
+        llvm::cl::desc("Level of the payload compression, 0 selects the "
+                       "default level of the codec"),
+        llvm::cl::location(payloadCompressionLevel), llvm::cl::init(0),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<enum PayloadDebugArtifacts,
+                         /*ExternalStorage=*/true> const
+        debugArtifacts(
+            "payload-debug-artifacts",
+            llvm::cl::location(payloadDebugArtifacts),
+            llvm::cl::init(PayloadDebugArtifacts::Text),
+            llvm::cl::desc("Form of the debug artifacts of the payload, "
+                           "such as the IR of the targets, which the "
+                           "instruments do not execute"),
+            llvm::cl::values(clEnumValN(PayloadDebugArtifacts::Text, "text",
+                                        "emit textual IR")),
+            llvm::cl::values(clEnumValN(PayloadDebugArtifacts::Bytecode,
+                                        "bytecode",
+                                        "emit MLIR bytecode and LLVM bitcode")),
+            llvm::cl::values(clEnumValN(PayloadDebugArtifacts::None, "none",
+                                        "omit the debug artifacts")),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string> payloadBlobStore_(
+        "payload-blob-store",
+        llvm::cl::desc("Directory of a content-addressed store of payload "
+                       "members. Members already in the store are referred "
+                       "to by their SHA-256 hash rather than archived, and "
+                       "the others are added to it."),
+        llvm::cl::value_desc("dir"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    payloadBlobStore_.setCallback([&](const std::string &dir) {
+      if (dir != "")
+        payloadBlobStore = dir;
+    });
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const compileCache(
+        "compile-cache",
+        llvm::cl::desc("Reuse the results of identical compilations within "
+                       "this process"),
+        llvm::cl::location(compileCacheFlag), llvm::cl::init(false),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string> compileCacheDir_(
+        "compile-cache-dir",
+        llvm::cl::desc("Directory of a persistent cache of compilation "
+                       "results, implies --compile-cache"),
+        llvm::cl::value_desc("dir"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    compileCacheDir_.setCallback([&](const std::string &dir) {
+      if (dir != "")
+        compileCacheDir = dir;
+    });
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const
+        parametricTemplates(
+            "parametric-templates",
+            llvm::cl::desc("Reuse the payload of a program only differing in "
+                           "its parameter values from a previous compilation "
+                           "by binding the new values, implies "
+                           "--compile-cache"),
+            llvm::cl::location(parametricTemplatesFlag), llvm::cl::init(false),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string> passMetricsReport_(
+        "pass-metrics-report",
+        llvm::cl::desc("Write the op count, number of symbols and memory use "
+                       "before and after each pass to a file, - for stdout"),
+        llvm::cl::value_desc("filename"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    passMetricsReport_.setCallback([&](const std::string &path) {
+      if (path != "")
+        passMetricsReport = path;
+    });
+
+    static llvm::cl::opt<enum PassMetricsFormat,
+                         /*ExternalStorage=*/true> const
+        passMetricsFormat_(
+            "pass-metrics-format", llvm::cl::location(passMetricsFormat),
+            llvm::cl::init(PassMetricsFormat::Table),
+            llvm::cl::desc("Format of the pass metrics report"),
+            llvm::cl::values(clEnumValN(PassMetricsFormat::Table, "table",
+                                        "a table of the metrics summed over "
+                                        "the runs of each pass")),
+            llvm::cl::values(clEnumValN(PassMetricsFormat::JSON, "json",
+                                        "the metrics of every run as JSON")),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::bits<CheckpointStage, /*ExternalStorage=*/true> const
+        checkpointStages_(
+            "checkpoint-stages", llvm::cl::location(checkpointStages),
+            llvm::cl::CommaSeparated,
+            llvm::cl::desc("Keep a bytecode checkpoint of the module after "
+                           "these stages, from which compilations of the same "
+                           "program only differing in later options resume"),
+            llvm::cl::values(clEnumValN(CheckpointStage::Frontend, "frontend",
+                                        "after parsing the input")),
+            llvm::cl::values(clEnumValN(CheckpointStage::Passes, "passes",
+                                        "after the command line passes")),
+            llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    static llvm::cl::opt<std::string> checkpointDir_(
+        "checkpoint-dir",
+        llvm::cl::desc("Directory to persist the checkpoints of "
+                       "--checkpoint-stages to, for retried compilations to "
+                       "resume from"),
+        llvm::cl::value_desc("dir"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+
+    checkpointDir_.setCallback([&](const std::string &dir) {
+      if (dir != "")
+        checkpointDir = dir;
+    });
+
+    static llvm::cl::opt<unsigned> numThreads_(
+        "num-threads",
+        llvm::cl::desc("The number of threads to run the passes on, 0 for "
+                       "one per hardware thread available to the compiler"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+    numThreads_.setCallback(
+        [&](const unsigned &threads) { numThreads = threads; });
+
+    static llvm::cl::list<unsigned> cpuAffinity_(
+        "cpu-affinity",
+        llvm::cl::desc("Restrict the compiler to these CPUs, e.g., 0,1,2,3"),
+        llvm::cl::CommaSeparated, llvm::cl::value_desc("cpu"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+    cpuAffinity_.setCallback(
+        [&](const unsigned &cpu) { cpuAffinity.push_back(cpu); });
+
+    static llvm::cl::opt<unsigned> numaNode_(
+        "numa-node",
+        llvm::cl::desc("Restrict the compiler to the CPUs of a NUMA node"),
+        llvm::cl::value_desc("node"),
+        llvm::cl::cat(qssc::config::getQSSCCLCategory()));
+    numaNode_.setCallback([&](const unsigned &node) { numaNode = node; });
+
+    // OpenQASM 3 frontend options
+
+    static llvm::cl::opt<unsigned, /*ExternalStorage=*/true> const numShots_(
+        "num-shots",
+        llvm::cl::desc("The number of shots to execute on the quantum "
+                       "circuit, default is 1000"),
+        llvm::cl::location(numShots), llvm::cl::init(1000),
+        llvm::cl::cat(openqasm3Cat_));
+
+    static llvm::cl::opt<std::string, /*ExternalStorage=*/true> const
+        shotDelay_(
+            "shot-delay",
+            llvm::cl::desc("Repetition delay between shots. Defaults to 1ms."),
+            llvm::cl::location(shotDelay), llvm::cl::init("1ms"),
+            llvm::cl::cat(openqasm3Cat_));
+
+    static llvm::cl::list<std::string> includeDirs_(
+        "I", llvm::cl::desc("Add <dir> to the include path"),
+        llvm::cl::value_desc("dir"), llvm::cl::cat(openqasm3Cat_));
+    includeDirs_.setCallback(
+        [&](const std::string &dir) { includeDirs.push_back(dir); });
+
+    static llvm::cl::list<std::string> gateLibraries_(
+        "qasm-gate-library",
+        llvm::cl::desc("Link the definitions of declared gates from a "
+                       "precompiled MLIR or MLIR bytecode gate library "
+                       "instead of generating them"),
+        llvm::cl::value_desc("filename"), llvm::cl::cat(openqasm3Cat_));
+    gateLibraries_.setCallback(
+        [&](const std::string &library) { gateLibraries.push_back(library); });
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const cacheIncludes(
+        "cache-qasm-includes",
+        llvm::cl::desc("Expand includes from a cache of preprocessed include "
+                       "files shared by the compilations of this process"),
+        llvm::cl::location(cacheQASMIncludesFlag), llvm::cl::init(false),
+        llvm::cl::cat(openqasm3Cat_));
+
+    static llvm::cl::opt<bool, /*ExternalStorage=*/true> const streaming(
+        "qasm-streaming",
+        llvm::cl::desc("Lower OpenQASM 3 statement by statement, stopping at "
+                       "the first failure"),
+        llvm::cl::location(streamQASMFlag), llvm::cl::init(false),
+        llvm::cl::cat(openqasm3Cat_));
+
+    static llvm::cl::opt<double> qasmDtTimestep_(
+        "qasm-dt-timestep",
+        llvm::cl::desc("Emit the durations of OpenQASM 3 programs in dt of "
+                       "this duration in seconds, i.e., that of the target, "
+                       "so that their units need not be converted"),
+        llvm::cl::value_desc("seconds"), llvm::cl::cat(openqasm3Cat_));
+    qasmDtTimestep_.setCallback(
+        [&](const double &dt) { qasmDtTimestep = dt; });
+
+    static llvm::cl::opt<enum QASMLocations, /*ExternalStorage=*/true> const
+        qasmLocations_(
+            "qasm-locations", llvm::cl::location(qasmLocations),
+            llvm::cl::init(QASMLocations::Full),
+            llvm::cl::desc("Locations of the operations generated from "
+                           "OpenQASM 3"),
+            llvm::cl::values(clEnumValN(QASMLocations::Full, "full",
+                                        "the line and column of their "
+                                        "statement")),
+            llvm::cl::values(clEnumValN(
+                QASMLocations::Lines, "lines",
+                "the line of their statement, shared by the operations of "
+                "the line")),
+            llvm::cl::values(clEnumValN(
+                QASMLocations::None, "none",
+                "none once the frontend has succeeded, for compilations "
+                "which do not need the locations of later diagnostics")),
+            llvm::cl::cat(openqasm3Cat_));
+
     // mlir-opt options
 
     static llvm::cl::opt<bool, /*ExternalStorage=*/true> const
@@ -279,6 +533,21 @@ struct QSSConfigCLOptions : public QSSConfig {
         llvm::cl::init(VERIFY_PASSES_DEFAULT),
         llvm::cl::cat(getQSSOptCLCategory()));
 
+    static llvm::cl::opt<enum VerificationMode,
+                         /*ExternalStorage=*/true> const
+        verificationModeOpt(
+            "verification-mode", llvm::cl::location(verificationMode),
+            llvm::cl::init(VerificationMode::Passes),
+            llvm::cl::desc("When to verify the module"),
+            llvm::cl::values(clEnumValN(
+                VerificationMode::Passes, "passes",
+                "after every pass if -verify-each is set, for debugging")),
+            llvm::cl::values(clEnumValN(
+                VerificationMode::Boundaries, "boundaries",
+                "only after the frontend, the command line passes and the "
+                "passes of each target")),
+            llvm::cl::cat(getQSSOptCLCategory()));
+
     static llvm::cl::opt<bool, /*ExternalStorage=*/true> const verifyRoundtrip(
         "verify-roundtrip",
         llvm::cl::desc(
@@ -340,51 +609,6 @@ struct QSSConfigCLOptions : public QSSConfig {
                      << "'. Request ignored.\n";
     });
   }
-
-  llvm::Error computeInputType() {
-    if (getInputType() == InputType::None) {
-
-      if (isDirectInput())
-        return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                       "The input source format must be "
-                                       "specified with -X for direct input.");
-
-      setInputType(fileExtensionToInputType(getExtension(getInputSource())));
-      if (getInputSource() != "-" && getInputType() == InputType::None) {
-        return llvm::createStringError(
-            llvm::inconvertibleErrorCode(),
-            "Unable to autodetect file extension type! Please specify the "
-            "input type with -X");
-      }
-    }
-
-    return llvm::Error::success();
-  }
-
-  llvm::Error computeOutputType() {
-    if (getOutputFilePath() != "-") {
-      EmitAction const extensionAction =
-          fileExtensionToAction(getExtension(getOutputFilePath()));
-      if (extensionAction == EmitAction::None &&
-          emitAction == EmitAction::None) {
-        llvm::errs() << "Cannot determine the file extension of the specified "
-                        "output file "
-                     << getOutputFilePath() << " defaulting to dumping MLIR\n";
-        setEmitAction(EmitAction::MLIR);
-      } else if (emitAction == EmitAction::None) {
-        setEmitAction(extensionAction);
-      } else if (extensionAction != getEmitAction()) {
-        llvm::errs()
-            << "Warning! The output type in the file extension doesn't "
-               "match the output type specified by --emit!";
-      }
-    } else {
-      if (emitAction == EmitAction::None)
-        setEmitAction(EmitAction::MLIR);
-    }
-
-    return llvm::Error::success();
-  }
 };
 
 } // anonymous namespace
@@ -406,6 +630,26 @@ void CLIConfigBuilder::registerCLOptions(mlir::DialectRegistry &registry) {
   mlir::tracing::DebugConfig::registerCLOptions();
 }
 
+void CLIConfigBuilder::resetCLOptions() {
+  llvm::cl::ResetAllOptionOccurrences();
+  // Options populated through callbacks are not covered by the reset above.
+  clOptionsConfig->targetName = std::nullopt;
+  clOptionsConfig->targetConfigPath = std::nullopt;
+  clOptionsConfig->compileCacheDir = std::nullopt;
+  clOptionsConfig->payloadBlobStore = std::nullopt;
+  clOptionsConfig->passMetricsReport = std::nullopt;
+  clOptionsConfig->checkpointStages = 0;
+  clOptionsConfig->checkpointDir = std::nullopt;
+  clOptionsConfig->passPlugins.clear();
+  clOptionsConfig->dialectPlugins.clear();
+  clOptionsConfig->includeDirs.clear();
+  clOptionsConfig->gateLibraries.clear();
+  clOptionsConfig->numThreads = std::nullopt;
+  clOptionsConfig->cpuAffinity.clear();
+  clOptionsConfig->numaNode = std::nullopt;
+  clOptionsConfig->qasmDtTimestep = std::nullopt;
+}
+
 llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
 
   config.setDebugConfig(clOptionsConfig->getDebugConfig());
@@ -441,12 +685,51 @@ llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
   config.compileTargetIRFlag = clOptionsConfig->compileTargetIRFlag;
   config.bypassPayloadTargetCompilationFlag =
       clOptionsConfig->bypassPayloadTargetCompilationFlag;
+  config.streamPayloadFlag = clOptionsConfig->streamPayloadFlag;
+  config.splitPayloadFlag = clOptionsConfig->splitPayloadFlag;
+  config.payloadCompression = clOptionsConfig->payloadCompression;
+  config.payloadCompressionLevel = clOptionsConfig->payloadCompressionLevel;
+  config.payloadDebugArtifacts = clOptionsConfig->payloadDebugArtifacts;
+  if (clOptionsConfig->payloadBlobStore.has_value())
+    config.payloadBlobStore = clOptionsConfig->payloadBlobStore;
+  config.compileCacheFlag = clOptionsConfig->compileCacheFlag;
+  config.parametricTemplatesFlag = clOptionsConfig->parametricTemplatesFlag;
+  if (clOptionsConfig->compileCacheDir.has_value())
+    config.compileCacheDir = clOptionsConfig->compileCacheDir;
+  if (clOptionsConfig->passMetricsReport.has_value())
+    config.passMetricsReport = clOptionsConfig->passMetricsReport;
+  config.passMetricsFormat = clOptionsConfig->passMetricsFormat;
+  config.checkpointStages = clOptionsConfig->checkpointStages;
+  if (clOptionsConfig->checkpointDir.has_value())
+    config.checkpointDir = clOptionsConfig->checkpointDir;
   config.passPlugins.insert(config.passPlugins.end(),
                             clOptionsConfig->passPlugins.begin(),
                             clOptionsConfig->passPlugins.end());
   config.dialectPlugins.insert(config.dialectPlugins.end(),
                                clOptionsConfig->dialectPlugins.begin(),
                                clOptionsConfig->dialectPlugins.end());
+  if (clOptionsConfig->numThreads.has_value())
+    config.numThreads = clOptionsConfig->numThreads;
+  config.cpuAffinity.insert(config.cpuAffinity.end(),
+                            clOptionsConfig->cpuAffinity.begin(),
+                            clOptionsConfig->cpuAffinity.end());
+  if (clOptionsConfig->numaNode.has_value())
+    config.numaNode = clOptionsConfig->numaNode;
+
+  // frontend
+  config.numShots = clOptionsConfig->numShots;
+  config.shotDelay = clOptionsConfig->shotDelay;
+  config.includeDirs.insert(config.includeDirs.end(),
+                            clOptionsConfig->includeDirs.begin(),
+                            clOptionsConfig->includeDirs.end());
+  config.gateLibraries.insert(config.gateLibraries.end(),
+                              clOptionsConfig->gateLibraries.begin(),
+                              clOptionsConfig->gateLibraries.end());
+  config.cacheQASMIncludesFlag = clOptionsConfig->cacheQASMIncludesFlag;
+  config.streamQASMFlag = clOptionsConfig->streamQASMFlag;
+  config.qasmLocations = clOptionsConfig->qasmLocations;
+  if (clOptionsConfig->qasmDtTimestep.has_value())
+    config.qasmDtTimestep = clOptionsConfig->qasmDtTimestep;
 
   // opt
   config.allowUnregisteredDialectsFlag =
@@ -462,6 +745,7 @@ llvm::Error CLIConfigBuilder::populateConfig(QSSConfig &config) {
   config.verifyDiagnosticsFlag = clOptionsConfig->verifyDiagnosticsFlag;
   config.verifyPassesFlag = clOptionsConfig->verifyPassesFlag;
   config.verifyRoundtripFlag = clOptionsConfig->verifyRoundtripFlag;
+  config.verificationMode = clOptionsConfig->verificationMode;
   config.splitInputFileFlag = clOptionsConfig->splitInputFileFlag;
   return llvm::Error::success();
 }
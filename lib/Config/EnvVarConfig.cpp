@@ -33,6 +33,9 @@ llvm::Error EnvVarConfigBuilder::populateConfig(QSSConfig &config) {
   if (auto err = populateVerbosity_(config))
     return err;
 
+  if (auto err = populateCompileCache_(config))
+    return err;
+
   return llvm::Error::success();
 }
 
@@ -68,3 +71,11 @@ llvm::Error EnvVarConfigBuilder::populateVerbosity_(QSSConfig &config) {
   }
   return llvm::Error::success();
 }
+
+llvm::Error EnvVarConfigBuilder::populateCompileCache_(QSSConfig &config) {
+  if (const char *cacheDir = std::getenv("QSSC_COMPILE_CACHE_DIR"))
+    config.compileCacheDir = cacheDir;
+  if (const char *checkpointDir = std::getenv("QSSC_CHECKPOINT_DIR"))
+    config.checkpointDir = checkpointDir;
+  return llvm::Error::success();
+}
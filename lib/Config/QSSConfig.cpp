@@ -18,11 +18,12 @@
 #include "Config/EnvVarConfig.h"
 
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Tools/Plugins/DialectPlugin.h"
 #include "mlir/Tools/Plugins/PassPlugin.h"
 
-#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -30,8 +31,10 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include <array>
+#include <mutex>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 using namespace qssc::config;
@@ -73,6 +76,82 @@ void qssc::config::QSSConfig::emit(llvm::raw_ostream &os) const {
   os << "compileTargetIR: " << shouldCompileTargetIR() << "\n";
   os << "bypassPayloadTargetCompilation: "
      << shouldBypassPayloadTargetCompilation() << "\n";
+  os << "streamPayload: " << shouldStreamPayload() << "\n";
+  os << "splitPayload: " << shouldSplitPayload() << "\n";
+  os << "payloadCompression: " << to_string(getPayloadCompression()) << "\n";
+  os << "payloadCompressionLevel: " << getPayloadCompressionLevel() << "\n";
+  os << "payloadDebugArtifacts: " << to_string(getPayloadDebugArtifacts())
+     << "\n";
+  os << "payloadBlobStore: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getPayloadBlobStore().has_value() ? getPayloadBlobStore().value()
+                                           : "None")
+     << "\n";
+  os << "compileCache: " << shouldUseCompileCache() << "\n";
+  os << "parametricTemplates: " << shouldUseParametricTemplates() << "\n";
+  os << "compileCacheDir: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getCompileCacheDir().has_value() ? getCompileCacheDir().value()
+                                          : "None")
+     << "\n";
+  os << "passMetricsReport: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getPassMetricsReport().has_value() ? getPassMetricsReport().value()
+                                            : "None")
+     << "\n";
+  os << "passMetricsFormat: " << to_string(getPassMetricsFormat()) << "\n";
+  os << "checkpointStages:";
+  for (auto stage : {CheckpointStage::Frontend, CheckpointStage::Passes})
+    if (shouldCheckpoint(stage))
+      os << " " << to_string(stage);
+  os << "\n";
+  os << "checkpointDir: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getCheckpointDir().has_value() ? getCheckpointDir().value() : "None")
+     << "\n";
+  os << "passPipeline: "
+     // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+     << (getPassPipeline().has_value() ? getPassPipeline().value() : "None")
+     << "\n";
+  os << "numThreads: ";
+  if (getNumThreads().has_value())
+    os << *getNumThreads();
+  else
+    os << "None";
+  os << "\n";
+  os << "cpuAffinity:";
+  for (unsigned const cpu : getCPUAffinity())
+    os << " " << cpu;
+  os << "\n";
+  os << "numaNode: ";
+  if (getNUMANode().has_value())
+    os << *getNUMANode();
+  else
+    os << "None";
+  os << "\n";
+  os << "\n";
+
+  // OpenQASM 3 frontend configuration
+  os << "[frontend]\n";
+  os << "numShots: " << getNumShots() << "\n";
+  os << "shotDelay: " << getShotDelay() << "\n";
+  os << "includeDirs:";
+  for (const auto &dir : getIncludeDirs())
+    os << " " << dir;
+  os << "\n";
+  os << "gateLibraries:";
+  for (const auto &library : getGateLibraries())
+    os << " " << library;
+  os << "\n";
+  os << "cacheQASMIncludes: " << shouldCacheQASMIncludes() << "\n";
+  os << "streamQASM: " << shouldStreamQASM() << "\n";
+  os << "qasmLocations: " << to_string(getQASMLocations()) << "\n";
+  os << "qasmDtTimestep: ";
+  if (getQASMDtTimestep().has_value())
+    os << *getQASMDtTimestep();
+  else
+    os << "None";
+  os << "\n";
   os << "\n";
 
   // Mlir opt configuration
@@ -89,10 +168,64 @@ void qssc::config::QSSConfig::emit(llvm::raw_ostream &os) const {
   os << "useExplicitModule: " << shouldUseExplicitModule() << "\n";
   os << "verifyDiagnostics: " << shouldVerifyDiagnostics() << "\n";
   os << "verifyPasses: " << shouldVerifyPasses() << "\n";
+  os << "verificationMode: " << to_string(getVerificationMode()) << "\n";
   os << "verifyRoundTrip: " << shouldVerifyRoundtrip() << "\n";
   os << "\n";
 }
 
+QSSConfig &QSSConfig::setPassPipeline(std::string pipeline) {
+  passPipeline = std::move(pipeline);
+  setPassPipelineSetupFn(
+      [pipeline = *passPipeline](mlir::PassManager &pm) -> mlir::LogicalResult {
+        return mlir::parsePassPipeline(pipeline, pm);
+      });
+  return *this;
+}
+
+llvm::Error QSSConfig::computeInputType() {
+  if (getInputType() == InputType::None) {
+
+    if (isDirectInput())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "The input source format must be "
+                                     "specified with -X for direct input.");
+
+    setInputType(fileExtensionToInputType(getExtension(getInputSource())));
+    if (getInputSource() != "-" && getInputType() == InputType::None) {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Unable to autodetect file extension type! Please specify the "
+          "input type with -X");
+    }
+  }
+
+  return llvm::Error::success();
+}
+
+llvm::Error QSSConfig::computeOutputType() {
+  if (getOutputFilePath() != "-") {
+    EmitAction const extensionAction =
+        fileExtensionToAction(getExtension(getOutputFilePath()));
+    if (extensionAction == EmitAction::None &&
+        emitAction == EmitAction::None) {
+      llvm::errs() << "Cannot determine the file extension of the specified "
+                      "output file "
+                   << getOutputFilePath() << " defaulting to dumping MLIR\n";
+      setEmitAction(EmitAction::MLIR);
+    } else if (emitAction == EmitAction::None) {
+      setEmitAction(extensionAction);
+    } else if (extensionAction != getEmitAction()) {
+      llvm::errs() << "Warning! The output type in the file extension doesn't "
+                      "match the output type specified by --emit!";
+    }
+  } else {
+    if (emitAction == EmitAction::None)
+      setEmitAction(EmitAction::MLIR);
+  }
+
+  return llvm::Error::success();
+}
+
 llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
                               const qssc::config::QSSConfig &config) {
   config.emit(os);
@@ -111,21 +244,31 @@ namespace {
 /// QUESTION: Rather than a global registry it seems like it would be much
 /// better to inherit the MLIRContext as QSSContext and set the configuration on
 /// this? Alternatively the QSSContext could own the MLIRContext?
-static llvm::ManagedStatic<llvm::DenseMap<mlir::MLIRContext *, QSSConfig>>
+/// Contexts may be configured concurrently, so the configurations are held by
+/// a map whose references remain valid while other contexts are inserted.
+static llvm::ManagedStatic<std::unordered_map<mlir::MLIRContext *, QSSConfig>>
     contextConfigs{};
+static llvm::ManagedStatic<std::mutex> contextConfigsMutex{};
 
 } // anonymous namespace
 
 void qssc::config::setContextConfig(mlir::MLIRContext *context,
                                     const QSSConfig &config) {
+  const std::lock_guard<std::mutex> lock(*contextConfigsMutex);
   (*contextConfigs)[context] = config;
 }
 
+void qssc::config::eraseContextConfig(mlir::MLIRContext *context) {
+  const std::lock_guard<std::mutex> lock(*contextConfigsMutex);
+  contextConfigs->erase(context);
+}
+
 llvm::Expected<const QSSConfig &>
 qssc::config::getContextConfig(mlir::MLIRContext *context) {
+  const std::lock_guard<std::mutex> lock(*contextConfigsMutex);
   auto it = contextConfigs->find(context);
   if (it != contextConfigs->end())
-    return it->getSecond();
+    return it->second;
 
   return llvm::createStringError(
       llvm::inconvertibleErrorCode(),
@@ -152,6 +295,9 @@ std::string qssc::config::to_string(const EmitAction &inAction) {
   case EmitAction::MLIR:
     return "mlir";
     break;
+  case EmitAction::MLIRBytecode:
+    return "bytecode";
+    break;
   case EmitAction::WaveMem:
     return "wmem";
     break;
@@ -182,6 +328,9 @@ std::string qssc::config::to_string(const FileExtension &inExt) {
   case FileExtension::MLIR:
     return "mlir";
     break;
+  case FileExtension::MLIRBytecode:
+    return "mlirbc";
+    break;
   case FileExtension::WaveMem:
     return "wmem";
     break;
@@ -213,12 +362,95 @@ std::string qssc::config::to_string(const InputType &inputType) {
   return "none";
 }
 
+std::string qssc::config::to_string(const PayloadCompression &inCompression) {
+  switch (inCompression) {
+  case PayloadCompression::Deflate:
+    return "deflate";
+    break;
+  case PayloadCompression::Zstd:
+    return "zstd";
+    break;
+  default:
+    return "store";
+    break;
+  }
+  return "store";
+}
+
+std::string
+qssc::config::to_string(const PayloadDebugArtifacts &inDebugArtifacts) {
+  switch (inDebugArtifacts) {
+  case PayloadDebugArtifacts::Bytecode:
+    return "bytecode";
+    break;
+  case PayloadDebugArtifacts::None:
+    return "none";
+    break;
+  default:
+    return "text";
+    break;
+  }
+  return "text";
+}
+
+std::string qssc::config::to_string(const PassMetricsFormat &inFormat) {
+  switch (inFormat) {
+  case PassMetricsFormat::JSON:
+    return "json";
+    break;
+  default:
+    return "table";
+    break;
+  }
+  return "table";
+}
+
+std::string qssc::config::to_string(const CheckpointStage &inStage) {
+  switch (inStage) {
+  case CheckpointStage::Frontend:
+    return "frontend";
+    break;
+  default:
+    return "passes";
+    break;
+  }
+  return "passes";
+}
+
+std::string qssc::config::to_string(const VerificationMode &inMode) {
+  switch (inMode) {
+  case VerificationMode::Boundaries:
+    return "boundaries";
+    break;
+  default:
+    return "passes";
+    break;
+  }
+  return "passes";
+}
+
+std::string qssc::config::to_string(const QASMLocations &inLocations) {
+  switch (inLocations) {
+  case QASMLocations::Lines:
+    return "lines";
+    break;
+  case QASMLocations::None:
+    return "none";
+    break;
+  default:
+    return "full";
+    break;
+  }
+  return "full";
+}
+
 InputType qssc::config::fileExtensionToInputType(const FileExtension &inExt) {
   switch (inExt) {
   case FileExtension::QASM:
     return InputType::QASM;
     break;
   case FileExtension::MLIR:
+  case FileExtension::MLIRBytecode:
     return InputType::MLIR;
     break;
   default:
@@ -238,6 +470,9 @@ EmitAction qssc::config::fileExtensionToAction(const FileExtension &inExt) {
   case FileExtension::MLIR:
     return EmitAction::MLIR;
     break;
+  case FileExtension::MLIRBytecode:
+    return EmitAction::MLIRBytecode;
+    break;
   case FileExtension::WaveMem:
     return EmitAction::WaveMem;
     break;
@@ -262,6 +497,8 @@ FileExtension qssc::config::strToFileExtension(const llvm::StringRef extStr) {
     return FileExtension::QASM;
   if (extStr == "mlir" || extStr == "MLIR")
     return FileExtension::MLIR;
+  if (extStr == "mlirbc" || extStr == "MLIRBC")
+    return FileExtension::MLIRBytecode;
   if (extStr == "wmem" || extStr == "WMEM")
     return FileExtension::WaveMem;
   if (extStr == "qem" || extStr == "QEM")
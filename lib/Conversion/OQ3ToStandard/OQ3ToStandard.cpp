@@ -217,6 +217,151 @@ struct CBitExtractBitOpConversionPattern
   }
 };
 
+/// Lower oq3.cbit_not to an xor with all ones, a single word-level op for the
+/// whole register.
+struct CBitNotOpConversionPattern : public OQ3ToStandardConversion<CBitNotOp> {
+  using OQ3ToStandardConversion<CBitNotOp>::OQ3ToStandardConversion;
+
+  LogicalResult
+  matchAndRewrite(CBitNotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto operand = adaptor.getOperand();
+    if (!operand.getType().isSignlessInteger())
+      return failure();
+    auto bitWidth = getCBitOrIntBitWidth(operand.getType());
+    if (bitWidth > 64)
+      return failure();
+
+    auto allOnes =
+        rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), -1, bitWidth);
+    rewriter.replaceOpWithNewOp<mlir::LLVM::XOrOp>(op, operand.getType(),
+                                                   operand, allOnes);
+    return success();
+  }
+};
+
+/// Lower oq3.cbit_popcount to the population count of the whole register,
+/// e.g., the number of ones measured into a syndrome register.
+struct CBitPopcountOpConversionPattern
+    : public OQ3ToStandardConversion<CBitPopcountOp> {
+  using OQ3ToStandardConversion<CBitPopcountOp>::OQ3ToStandardConversion;
+
+  LogicalResult
+  matchAndRewrite(CBitPopcountOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto const loc = op.getLoc();
+    auto operand = adaptor.getOperand();
+    auto resultType = op.getType().dyn_cast<mlir::IntegerType>();
+    if (!operand.getType().isSignlessInteger() || !resultType)
+      return failure();
+    auto bitWidth = getCBitOrIntBitWidth(operand.getType());
+    if (bitWidth > 64)
+      return failure();
+
+    mlir::Value count =
+        rewriter.create<mlir::LLVM::CtPopOp>(loc, operand.getType(), operand);
+    if (resultType.getWidth() > static_cast<uint>(bitWidth))
+      count = rewriter.create<mlir::LLVM::ZExtOp>(loc, resultType, count);
+    else if (resultType.getWidth() < static_cast<uint>(bitWidth))
+      count = rewriter.create<mlir::LLVM::TruncOp>(loc, resultType, count);
+    rewriter.replaceOp(op, count);
+    return success();
+  }
+};
+
+namespace {
+/// Zero-extend or truncate a shift or rotation amount to the type of the
+/// register, after reducing it modulo the width of the register when
+/// reduceModWidth is set.
+mlir::Value castShiftAmount(mlir::Value amount, mlir::Type registerType,
+                            bool reduceModWidth, mlir::Location loc,
+                            ConversionPatternRewriter &rewriter) {
+  auto amountWidth = amount.getType().getIntOrFloatBitWidth();
+  auto registerWidth = registerType.getIntOrFloatBitWidth();
+  if (reduceModWidth && amountWidth > registerWidth) {
+    auto width = rewriter.create<mlir::arith::ConstantIntOp>(loc, registerWidth,
+                                                             amountWidth);
+    amount = rewriter.create<mlir::LLVM::URemOp>(loc, amount, width);
+  }
+  if (amountWidth > registerWidth)
+    return rewriter.create<mlir::LLVM::TruncOp>(loc, registerType, amount);
+  if (amountWidth < registerWidth)
+    return rewriter.create<mlir::LLVM::ZExtOp>(loc, registerType, amount);
+  return amount;
+}
+} // anonymous namespace
+
+/// Lower oq3.cbit_lshift and oq3.cbit_rshift to logical shifts of the whole
+/// register, which yield zero when shifting by the width or more.
+template <class OQ3Op, class StdOp>
+struct CBitShiftOpConversionPattern : public OQ3ToStandardConversion<OQ3Op> {
+  using OQ3ToStandardConversion<OQ3Op>::OQ3ToStandardConversion;
+
+  LogicalResult
+  matchAndRewrite(OQ3Op op, typename OQ3Op::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto const loc = op.getLoc();
+    auto lhs = adaptor.getLhs();
+    auto rhs = adaptor.getRhs();
+    auto registerType = lhs.getType();
+    if (!registerType.isSignlessInteger() ||
+        !rhs.getType().isSignlessInteger() ||
+        this->typeConverter.convertType(op.getType()) != registerType)
+      return failure();
+    auto bitWidth = getCBitOrIntBitWidth(registerType);
+    if (bitWidth > 64)
+      return failure();
+
+    // amounts out of range select zero, so they need not be reduced
+    auto amount = castShiftAmount(rhs, registerType,
+                                  /*reduceModWidth=*/false, loc, rewriter);
+    mlir::Value shifted = rewriter.create<StdOp>(loc, lhs, amount);
+
+    // amounts too narrow to reach the width are always in range
+    auto amountWidth = rhs.getType().getIntOrFloatBitWidth();
+    if (amountWidth < 64 &&
+        (1ull << amountWidth) <= static_cast<uint64_t>(bitWidth)) {
+      rewriter.replaceOp(op, shifted);
+      return success();
+    }
+    auto outOfRange = rewriter.create<mlir::LLVM::ICmpOp>(
+        loc, mlir::LLVM::ICmpPredicate::uge, rhs,
+        rewriter.create<mlir::arith::ConstantIntOp>(loc, bitWidth,
+                                                    amountWidth));
+    auto zero = rewriter.create<mlir::arith::ConstantIntOp>(loc, 0, bitWidth);
+    rewriter.replaceOpWithNewOp<mlir::LLVM::SelectOp>(
+        op, registerType, outOfRange, zero, shifted);
+    return success();
+  }
+};
+
+/// Lower oq3.cbit_rotl and oq3.cbit_rotr to funnel shifts of the register
+/// with itself, whose amount is taken modulo the width.
+template <class OQ3Op, class StdOp>
+struct CBitRotOpConversionPattern : public OQ3ToStandardConversion<OQ3Op> {
+  using OQ3ToStandardConversion<OQ3Op>::OQ3ToStandardConversion;
+
+  LogicalResult
+  matchAndRewrite(OQ3Op op, typename OQ3Op::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto lhs = adaptor.getLhs();
+    auto rhs = adaptor.getRhs();
+    auto registerType = lhs.getType();
+    if (!registerType.isSignlessInteger() ||
+        !rhs.getType().isSignlessInteger() ||
+        this->typeConverter.convertType(op.getType()) != registerType)
+      return failure();
+    if (getCBitOrIntBitWidth(registerType) > 64)
+      return failure();
+
+    auto amount = castShiftAmount(rhs, registerType,
+                                  /*reduceModWidth=*/true, op.getLoc(),
+                                  rewriter);
+    rewriter.replaceOpWithNewOp<StdOp>(op, registerType, lhs, lhs, amount);
+    return success();
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // Cast conversion
 //===----------------------------------------------------------------------===//
@@ -436,7 +581,18 @@ void oq3::populateOQ3ToStandardConversionPatterns(
                                     LLVM::OrOp>,
       CBitBinaryOpConversionPattern<oq3::CBitXorOp,
                                     LLVM::XOrOp>,
-      CBitAssignBitOpConversionPattern>(patterns.getContext(), typeConverter);
+      CBitAssignBitOpConversionPattern,
+      CBitNotOpConversionPattern,
+      CBitPopcountOpConversionPattern,
+      CBitShiftOpConversionPattern<oq3::CBitLShiftOp,
+                                   LLVM::ShlOp>,
+      CBitShiftOpConversionPattern<oq3::CBitRShiftOp,
+                                   LLVM::LShrOp>,
+      CBitRotOpConversionPattern<oq3::CBitRotLOp,
+                                 LLVM::FshlOp>,
+      CBitRotOpConversionPattern<oq3::CBitRotROp,
+                                 LLVM::FshrOp>>(patterns.getContext(),
+                                                typeConverter);
 
   if (includeBitmapOperationPatterns) {
     patterns.add<
@@ -22,8 +22,11 @@
 
 #include "Dialect/Pulse/IR/PulseDialect.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/LoweredCircuitCache.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
+#include "Dialect/QUIR/Utils/OpDispatch.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -34,20 +37,22 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/IRMapping.h"
+#include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/OwningOpRef.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
-#include "mlir/Parser/Parser.h"
-#include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/SMLoc.h"
-#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
 #include <cassert>
@@ -56,6 +61,7 @@
 #include <memory>
 #include <string>
 #include <sys/types.h>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -68,55 +74,75 @@ using namespace mlir::pulse;
 void LoadPulseCalsPass::runOnOperation() {
 
   mlir::ModuleOp const moduleOp = getOperation();
+  symbolIndex = &getAnalysis<SymbolIndexAnalysis>();
+
+  auto *ctx = &getContext();
+  builtinGateNames = {StringAttr::get(ctx, "cx"),
+                      StringAttr::get(ctx, "u3"),
+                      StringAttr::get(ctx, "measure"),
+                      StringAttr::get(ctx, "mid_circuit_measure"),
+                      StringAttr::get(ctx, "barrier"),
+                      StringAttr::get(ctx, "delay"),
+                      StringAttr::get(ctx, "reset")};
   mlir::func::FuncOp mainFunc =
-      dyn_cast<mlir::func::FuncOp>(quir::getMainFunction(moduleOp));
+      dyn_cast<mlir::func::FuncOp>(symbolIndex->getMainFunction());
   assert(mainFunc && "could not find the main func");
 
   // check for command line override of the path to default pulse cals
   if (defaultPulseCals.hasValue())
     DEFAULT_PULSE_CALS = defaultPulseCals.getValue();
 
-  // parse the default pulse calibrations
+  // index the default pulse calibrations
   if (!DEFAULT_PULSE_CALS.empty()) {
-    LLVM_DEBUG(llvm::dbgs() << "parsing default pulse calibrations.\n");
-    if (auto err = parsePulseCalsModuleOp(DEFAULT_PULSE_CALS,
-                                          defaultPulseCalsModule)) {
+    LLVM_DEBUG(llvm::dbgs() << "indexing default pulse calibrations.\n");
+    if (auto err = loadPulseCalsIndex(DEFAULT_PULSE_CALS, defaultPulseCalsIndex,
+                                      defaultPulseCalsModule)) {
       llvm::dbgs() << err;
       return signalPassFailure();
     }
-    // add sequence Ops to pulseCalsNameToSequenceMap
-    defaultPulseCalsModule->walk([&](mlir::pulse::SequenceOp sequenceOp) {
-      auto sequenceName = sequenceOp.getSymName().str();
-      pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
-    });
   } else
     LLVM_DEBUG(llvm::dbgs()
                << "default pulse calibrations path is not specified.\n");
 
-  // parse the additional pulse calibrations
+  // index the additional pulse calibrations
   if (!ADDITIONAL_PULSE_CALS.empty()) {
-    LLVM_DEBUG(llvm::dbgs() << "parsing additional pulse calibrations.\n");
-    if (auto err = parsePulseCalsModuleOp(ADDITIONAL_PULSE_CALS,
-                                          additionalPulseCalsModule)) {
+    LLVM_DEBUG(llvm::dbgs() << "indexing additional pulse calibrations.\n");
+    if (auto err = loadPulseCalsIndex(ADDITIONAL_PULSE_CALS,
+                                      additionalPulseCalsIndex,
+                                      additionalPulseCalsModule)) {
       llvm::dbgs() << err;
       return signalPassFailure();
     }
-    // add sequence Ops to pulseCalsNameToSequenceMap
-    additionalPulseCalsModule->walk([&](mlir::pulse::SequenceOp sequenceOp) {
-      auto sequenceName = sequenceOp.getSymName().str();
-      pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
-    });
   } else
     LLVM_DEBUG(llvm::dbgs()
                << "additional pulse calibrations path is not specified.\n");
 
+  // the version of the calibrations which the circuits are lowered with,
+  // that of the indexed files and of the user specified calibrations, which
+  // the circuits lowered by QUIRToPulsePass are cached with
+  llvm::SHA256 versionHasher;
+  for (const auto *index :
+       {defaultPulseCalsIndex.get(), additionalPulseCalsIndex.get()}) {
+    versionHasher.update(index ? index->getVersion() : "");
+    versionHasher.update(llvm::ArrayRef<uint8_t>{0});
+  }
+
   // parse the user specified pulse calibrations
   LLVM_DEBUG(llvm::dbgs() << "parsing user specified pulse calibrations.\n");
+  std::string printed;
+  llvm::raw_string_ostream printedStream(printed);
   moduleOp->walk([&](mlir::pulse::SequenceOp sequenceOp) {
-    auto sequenceName = sequenceOp.getSymName().str();
-    pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
-    pulseCalsAddedToIR.insert(sequenceName);
+    pulseCalsNameToSequenceMap[sequenceOp.getSymName()] = sequenceOp;
+    pulseCalsAddedToIR.insert(sequenceOp.getSymNameAttr());
+    sequenceOp->print(printedStream,
+                      OpPrintingFlags().printGenericOpForm().useLocalScope());
   });
+  printedStream.flush();
+  versionHasher.update(printed);
+  moduleOp->setAttr(
+      LoweredCircuitCache::calsVersionAttrName,
+      StringAttr::get(ctx, llvm::toHex(versionHasher.final(),
+                                       /*LowerCase=*/true)));
 
   moduleOp->walk(
       [&](CallCircuitOp callCircOp) { loadPulseCals(callCircOp, mainFunc); });
@@ -126,25 +152,19 @@ void LoadPulseCalsPass::loadPulseCals(CallCircuitOp callCircuitOp,
                                       mlir::func::FuncOp funcOp) {
 
   auto circuitOp = getCircuitOp(callCircuitOp);
+  using Dispatcher =
+      OpDispatcher<CallCircuitOp, CallGateOp, BuiltinCXOp, Builtin_UOp,
+                   MeasureOp, mlir::quir::BarrierOp, mlir::quir::DelayOp,
+                   mlir::quir::ResetQubitOp>;
   circuitOp->walk([&](Operation *op) {
-    if (auto castOp = dyn_cast<CallCircuitOp>(op))
-      llvm_unreachable(
-          "CallCircuitOp inside another CircuitOp is not allowed in this pass");
-    else if (auto castOp = dyn_cast<CallGateOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else if (auto castOp = dyn_cast<BuiltinCXOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else if (auto castOp = dyn_cast<Builtin_UOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else if (auto castOp = dyn_cast<MeasureOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else if (auto castOp = dyn_cast<mlir::quir::BarrierOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else if (auto castOp = dyn_cast<mlir::quir::DelayOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else if (auto castOp = dyn_cast<mlir::quir::ResetQubitOp>(op))
-      loadPulseCals(castOp, callCircuitOp, funcOp);
-    else {
+    bool const dispatched = Dispatcher::get().dispatch(op, [&](auto castOp) {
+      if constexpr (std::is_same_v<decltype(castOp), CallCircuitOp>)
+        llvm_unreachable("CallCircuitOp inside another CircuitOp is not "
+                         "allowed in this pass");
+      else
+        loadPulseCals(castOp, callCircuitOp, funcOp);
+    });
+    if (!dispatched) {
       LLVM_DEBUG(llvm::dbgs() << "no pulse cal loading needed for " << op);
       assert((!op->hasTrait<mlir::quir::UnitaryOp>() and
               !op->hasTrait<mlir::quir::CPTPOp>()) &&
@@ -159,15 +179,13 @@ void LoadPulseCalsPass::loadPulseCals(CallGateOp callGateOp,
   std::vector<Value> qubitOperands;
   qubitCallOperands(callGateOp, qubitOperands);
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = callGateOp.getCalleeAttr().getValue().str();
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  assert(pulseCalsNameToSequenceMap.find(gateMangledName) !=
-             pulseCalsNameToSequenceMap.end() &&
+  auto gateName = callGateOp.getCalleeAttr().getAttr();
+  PulseCal const pulseCal = resolvePulseCal(gateName, qubits);
+  assert(pulseCal.sequence &&
          "could not find any pulse calibration for call gate");
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-  callGateOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
+  callGateOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::loadPulseCals(BuiltinCXOp CXOp,
@@ -178,15 +196,13 @@ void LoadPulseCalsPass::loadPulseCals(BuiltinCXOp CXOp,
   qubitOperands.push_back(CXOp.getControl());
   qubitOperands.push_back(CXOp.getTarget());
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = "cx";
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  assert(pulseCalsNameToSequenceMap.find(gateMangledName) !=
-             pulseCalsNameToSequenceMap.end() &&
+  auto gateName = builtinGateNames.cx;
+  PulseCal const pulseCal = resolvePulseCal(gateName, qubits);
+  assert(pulseCal.sequence &&
          "could not find any pulse calibration for the CX gate");
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-  CXOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
+  CXOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::loadPulseCals(Builtin_UOp UOp,
@@ -196,203 +212,215 @@ void LoadPulseCalsPass::loadPulseCals(Builtin_UOp UOp,
   std::vector<Value> qubitOperands;
   qubitOperands.push_back(UOp.getTarget());
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = "u3";
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  assert(pulseCalsNameToSequenceMap.find(gateMangledName) !=
-             pulseCalsNameToSequenceMap.end() &&
+  auto gateName = builtinGateNames.u3;
+  PulseCal const pulseCal = resolvePulseCal(gateName, qubits);
+  assert(pulseCal.sequence &&
          "could not find any pulse calibration for the U gate");
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-  UOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
+  UOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::loadPulseCals(MeasureOp measureOp,
                                       CallCircuitOp callCircuitOp,
                                       mlir::func::FuncOp funcOp) {
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-
   std::vector<Value> qubitOperands;
   qubitCallOperands<MeasureOp>(measureOp, qubitOperands);
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = "measure";
   // check if the measurement is marked with quir.midCircuitMeasure
-  if (measureOp->hasAttr("quir.midCircuitMeasure"))
-    gateName = "mid_circuit_measure";
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  measureOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the measurement gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the measurement gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  auto gateName = measureOp->hasAttr("quir.midCircuitMeasure")
+                      ? builtinGateNames.midCircuitMeasure
+                      : builtinGateNames.measure;
+  PulseCal const pulseCal = getOrMergePulseCal(gateName, qubits,
+                                                /*orderIndependent=*/false);
+  measureOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::loadPulseCals(mlir::quir::BarrierOp barrierOp,
                                       CallCircuitOp callCircuitOp,
                                       mlir::func::FuncOp funcOp) {
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-
   std::vector<Value> qubitOperands;
   qubitCallOperands<mlir::quir::BarrierOp>(barrierOp, qubitOperands);
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = "barrier";
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  barrierOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the barrier gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the barrier gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  auto gateName = builtinGateNames.barrier;
+  PulseCal const pulseCal = getOrMergePulseCal(gateName, qubits,
+                                                /*orderIndependent=*/true);
+  barrierOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::loadPulseCals(mlir::quir::DelayOp delayOp,
                                       CallCircuitOp callCircuitOp,
                                       mlir::func::FuncOp funcOp) {
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-
   std::vector<Value> qubitOperands;
   qubitCallOperands<mlir::quir::DelayOp>(delayOp, qubitOperands);
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = "delay";
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  delayOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the delay gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the delay gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  removeRedundantDelayArgs(mergedPulseSequenceOp, builder);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  auto gateName = builtinGateNames.delay;
+  PulseCal const pulseCal = getOrMergePulseCal(gateName, qubits,
+                                                /*orderIndependent=*/true);
+  delayOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::loadPulseCals(mlir::quir::ResetQubitOp resetOp,
                                       CallCircuitOp callCircuitOp,
                                       mlir::func::FuncOp funcOp) {
 
-  OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
-
   std::vector<Value> qubitOperands;
   qubitCallOperands<mlir::quir::ResetQubitOp>(resetOp, qubitOperands);
   std::vector<uint32_t> qubits = getQubitOperands(qubitOperands, callCircuitOp);
-  std::string gateName = "reset";
-  std::string const gateMangledName = getMangledName(gateName, qubits);
-  resetOp->setAttr("pulse.calName", builder.getStringAttr(gateMangledName));
-  if (pulseCalsNameToSequenceMap.find(gateMangledName) !=
-      pulseCalsNameToSequenceMap.end()) {
-    // found a pulse calibration for the gate
-    addPulseCalToModule(funcOp, pulseCalsNameToSequenceMap[gateMangledName]);
-    return;
-  }
-  // did not find a pulse calibration for the gate
-  // check if there exists pulse calibrations for individual qubits, and if
-  // yes, merge them and add the merged pulse sequence to the module
-  std::vector<SequenceOp> sequenceOps;
-  for (const auto &qubit : qubits) {
-    std::string const individualGateMangledName =
-        getMangledName(gateName, qubit);
-    assert(pulseCalsNameToSequenceMap.find(individualGateMangledName) !=
-               pulseCalsNameToSequenceMap.end() &&
-           "could not find pulse calibrations for the reset gate");
-    sequenceOps.push_back(
-        pulseCalsNameToSequenceMap[individualGateMangledName]);
-  }
-  SequenceOp const mergedPulseSequenceOp =
-      mergePulseSequenceOps(sequenceOps, gateMangledName);
-  pulseCalsNameToSequenceMap[gateMangledName] = mergedPulseSequenceOp;
-  addPulseCalToModule(funcOp, mergedPulseSequenceOp);
+  auto gateName = builtinGateNames.reset;
+  PulseCal const pulseCal = getOrMergePulseCal(gateName, qubits,
+                                                /*orderIndependent=*/true);
+  resetOp->setAttr("pulse.calName", pulseCal.name);
+  addPulseCalToModule(funcOp, pulseCal.sequence);
 }
 
 void LoadPulseCalsPass::addPulseCalToModule(
     mlir::func::FuncOp funcOp, mlir::pulse::SequenceOp sequenceOp) {
-  if (pulseCalsAddedToIR.find(sequenceOp.getSymName().str()) ==
-      pulseCalsAddedToIR.end()) {
+  if (!pulseCalsAddedToIR.contains(sequenceOp.getSymNameAttr())) {
     OpBuilder builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
     auto *clonedPulseCalOp = builder.clone(*sequenceOp);
     auto clonedPulseCalSequenceOp = static_cast<SequenceOp>(clonedPulseCalOp);
     clonedPulseCalSequenceOp->moveBefore(funcOp);
-    pulseCalsAddedToIR.insert(sequenceOp.getSymName().str());
+    pulseCalsAddedToIR.insert(sequenceOp.getSymNameAttr());
   } else
     LLVM_DEBUG(llvm::dbgs() << "pulse cal " << sequenceOp.getSymName().str()
                             << " is already added to IR.\n");
 }
 
-llvm::Error LoadPulseCalsPass::parsePulseCalsModuleOp(
-    std::string &pulseCalsPath,
+llvm::Error LoadPulseCalsPass::loadPulseCalsIndex(
+    std::string &pulseCalsPath, std::shared_ptr<const PulseCalsIndex> &index,
     mlir::OwningOpRef<mlir::ModuleOp> &owningOpRef) {
-  std::string errorMessage;
-  llvm::SourceMgr sourceMgr;
-  std::unique_ptr<llvm::MemoryBuffer> pulseCalsFile =
-      mlir::openInputFile(pulseCalsPath, &errorMessage);
-  if (!pulseCalsFile)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to open pulse calibrations file: " +
-                                       errorMessage);
-  sourceMgr.AddNewSourceBuffer(std::move(pulseCalsFile), llvm::SMLoc());
-  owningOpRef = mlir::parseSourceFile<mlir::ModuleOp>(sourceMgr, &getContext());
-  if (!owningOpRef)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Failed to parse pulse calibrations file: " +
-                                       pulseCalsPath);
+  // calibration files are shared by most compilations of a process, so they
+  // are only parsed and indexed again when they change
+  auto pulseCalsIndex =
+      PulseCalsCache::global().loadIndex(pulseCalsPath, &getContext());
+  if (!pulseCalsIndex)
+    return pulseCalsIndex.takeError();
+  index = std::move(*pulseCalsIndex);
+  owningOpRef = mlir::ModuleOp::create(mlir::UnknownLoc::get(&getContext()));
   return llvm::Error::success();
 }
 
+mlir::pulse::SequenceOp
+LoadPulseCalsPass::lookupPulseCal(llvm::StringRef sequenceName) {
+  auto sequenceIt = pulseCalsNameToSequenceMap.find(sequenceName);
+  if (sequenceIt != pulseCalsNameToSequenceMap.end())
+    return sequenceIt->second;
+
+  // additional pulse calibrations override the default ones
+  SequenceOp sequenceOp;
+  for (auto [index, module] :
+       {std::make_pair(additionalPulseCalsIndex.get(),
+                       additionalPulseCalsModule.get()),
+        std::make_pair(defaultPulseCalsIndex.get(),
+                       defaultPulseCalsModule.get())}) {
+    if (!index || !index->contains(sequenceName))
+      continue;
+    auto materialized = index->materialize(sequenceName, module);
+    if (!materialized) {
+      getOperation()->emitError()
+          << llvm::toString(materialized.takeError());
+      signalPassFailure();
+      return SequenceOp();
+    }
+    sequenceOp = *materialized;
+    break;
+  }
+
+  if (sequenceOp) {
+    LLVM_DEBUG(llvm::dbgs() << "deserialized pulse cal " << sequenceName
+                            << ".\n");
+    pulseCalsNameToSequenceMap[sequenceName] = sequenceOp;
+  }
+  return sequenceOp;
+}
+
+PulseCal LoadPulseCalsPass::resolvePulseCal(mlir::StringAttr gateName,
+                                            llvm::ArrayRef<uint32_t> qubits) {
+  ++numPulseCalLookups;
+  auto pulseCalIt = pulseCalsByGate.find({gateName, qubits});
+  if (pulseCalIt != pulseCalsByGate.end()) {
+    ++numPulseCalCacheHits;
+    return pulseCalIt->second;
+  }
+
+  std::string gateNameStr = gateName.str();
+  std::vector<uint32_t> qubitsVec(qubits.begin(), qubits.end());
+  auto const mangledName =
+      StringAttr::get(&getContext(), getMangledName(gateNameStr, qubitsVec));
+  PulseCal const pulseCal{mangledName, lookupPulseCal(mangledName.getValue())};
+
+  auto *qubitsStorage = pulseCalKeyAllocator.Allocate<uint32_t>(qubits.size());
+  std::copy(qubits.begin(), qubits.end(), qubitsStorage);
+  llvm::ArrayRef<uint32_t> const keyQubits(qubitsStorage, qubits.size());
+  pulseCalsByGate[{gateName, keyQubits}] = pulseCal;
+  return pulseCal;
+}
+
+PulseCal LoadPulseCalsPass::getOrMergePulseCal(mlir::StringAttr gateName,
+                                               llvm::ArrayRef<uint32_t> qubits,
+                                               bool orderIndependent) {
+  PulseCal const pulseCal = resolvePulseCal(gateName, qubits);
+  if (pulseCal.sequence)
+    return pulseCal;
+
+  // the pulse cals merged for an order independent gate are shared by all the
+  // orders of its qubits, so they are merged in the sorted order of the qubits
+  llvm::SmallVector<uint32_t> mergedQubits(qubits.begin(), qubits.end());
+  if (orderIndependent) {
+    llvm::sort(mergedQubits);
+    if (!llvm::equal(mergedQubits, qubits)) {
+      PulseCal const sortedPulseCal = resolvePulseCal(gateName, mergedQubits);
+      if (sortedPulseCal.sequence) {
+        ++numReusedMergedPulseCals;
+        recordPulseCal(gateName, qubits, sortedPulseCal);
+        return sortedPulseCal;
+      }
+    }
+  }
+
+  // did not find a pulse calibration for the gate
+  // check if there exists pulse calibrations for individual qubits, and if
+  // yes, merge them and add the merged pulse sequence to the module
+  std::vector<SequenceOp> sequenceOps;
+  for (const auto &qubit : mergedQubits) {
+    SequenceOp const individualSequenceOp =
+        resolvePulseCal(gateName, qubit).sequence;
+    assert(individualSequenceOp &&
+           "could not find pulse calibrations for the individual qubits");
+    sequenceOps.push_back(individualSequenceOp);
+  }
+
+  PulseCal mergedPulseCal = resolvePulseCal(gateName, mergedQubits);
+  mergedPulseCal.sequence =
+      mergePulseSequenceOps(sequenceOps, mergedPulseCal.name.str());
+  if (gateName.getValue() == "delay") {
+    OpBuilder builder(&getContext());
+    removeRedundantDelayArgs(mergedPulseCal.sequence, builder);
+  }
+  ++numMergedPulseCals;
+  pulseCalsNameToSequenceMap[mergedPulseCal.name.getValue()] =
+      mergedPulseCal.sequence;
+  recordPulseCal(gateName, mergedQubits, mergedPulseCal);
+  recordPulseCal(gateName, qubits, mergedPulseCal);
+  return mergedPulseCal;
+}
+
+void LoadPulseCalsPass::recordPulseCal(mlir::StringAttr gateName,
+                                       llvm::ArrayRef<uint32_t> qubits,
+                                       PulseCal pulseCal) {
+  auto pulseCalIt = pulseCalsByGate.find({gateName, qubits});
+  assert(pulseCalIt != pulseCalsByGate.end() &&
+         "the pulse cal of the gate must be resolved before it is recorded");
+  pulseCalIt->second = pulseCal;
+}
+
 mlir::pulse::SequenceOp LoadPulseCalsPass::mergePulseSequenceOps(
     std::vector<mlir::pulse::SequenceOp> &sequenceOps,
     const std::string &mergedSequenceOpName) {
@@ -649,13 +677,8 @@ LoadPulseCalsPass::getQubitOperands(std::vector<Value> &qubitOperands,
 
 mlir::quir::CircuitOp
 LoadPulseCalsPass::getCircuitOp(CallCircuitOp callCircuitOp) {
-  auto circuitAttr = callCircuitOp->getAttrOfType<FlatSymbolRefAttr>("callee");
-  assert(circuitAttr && "Requires a 'callee' symbol reference attribute");
-
-  auto circuitOp = SymbolTable::lookupNearestSymbolFrom<mlir::quir::CircuitOp>(
-      callCircuitOp, circuitAttr);
-  assert(circuitOp && "matching circuit not found");
-  return circuitOp;
+  assert(symbolIndex && "the symbol index is only available while running");
+  return symbolIndex->getCircuitOp(callCircuitOp);
 }
 
 llvm::StringRef LoadPulseCalsPass::getArgument() const {
@@ -0,0 +1,232 @@
+//===- PulseCalsCache.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements the process wide cache of parsed pulse calibration
+/// files.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SMLoc.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+llvm::ManagedStatic<PulseCalsCache> globalPulseCalsCache;
+
+llvm::Expected<OwningOpRef<ModuleOp>>
+parsePulseCalsFile(llvm::StringRef path, MLIRContext *context) {
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> pulseCalsFile =
+      openInputFile(path, &errorMessage);
+  if (!pulseCalsFile)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Failed to open pulse calibrations file: " +
+                                       errorMessage);
+  llvm::SourceMgr sourceMgr;
+  sourceMgr.AddNewSourceBuffer(std::move(pulseCalsFile), llvm::SMLoc());
+  auto module = parseSourceFile<ModuleOp>(sourceMgr, context);
+  if (!module)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   llvm::Twine("Failed to parse pulse "
+                                               "calibrations file: ") +
+                                       path);
+  return std::move(module);
+}
+} // anonymous namespace
+
+llvm::Expected<SequenceOp>
+PulseCalsIndex::materialize(llvm::StringRef name, ModuleOp module) const {
+  auto range = ranges.find(name);
+  if (range == ranges.end())
+    return SequenceOp();
+
+  ParserConfig const parserConfig(module->getContext());
+  auto sequenceModule = parseSourceString<ModuleOp>(
+      llvm::StringRef(bytecode).substr(range->second.offset,
+                                       range->second.length),
+      parserConfig, path);
+  if (!sequenceModule || sequenceModule->getBody()->empty())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   llvm::Twine("Failed to read pulse "
+                                               "calibration ") +
+                                       name + " of " + path);
+
+  auto sequenceOp = dyn_cast<SequenceOp>(sequenceModule->getBody()->front());
+  assert(sequenceOp && "indexed modules hold a single sequence");
+  sequenceOp->remove();
+  module.push_back(sequenceOp);
+  return sequenceOp;
+}
+
+PulseCalsCache &PulseCalsCache::global() { return *globalPulseCalsCache; }
+
+PulseCalsCache::Entry *
+PulseCalsCache::lookup(llvm::StringRef path,
+                       const llvm::sys::fs::file_status &status) {
+  auto entry = entries.find(path);
+  if (entry == entries.end() ||
+      entry->second.modificationTime != status.getLastModificationTime() ||
+      entry->second.size != status.getSize())
+    return nullptr;
+  return &entry->second;
+}
+
+PulseCalsCache::Entry &
+PulseCalsCache::getOrReset(llvm::StringRef path,
+                           const llvm::sys::fs::file_status &status) {
+  if (auto *entry = lookup(path, status))
+    return *entry;
+  auto &entry = entries[path];
+  entry = {status.getLastModificationTime(), status.getSize(), nullptr,
+           nullptr};
+  return entry;
+}
+
+static llvm::Error statPulseCalsFile(llvm::StringRef path,
+                                     llvm::sys::fs::file_status &status) {
+  if (auto ec = llvm::sys::fs::status(path, status))
+    return llvm::createStringError(
+        ec, llvm::Twine("Failed to open pulse calibrations file: ") + path +
+                ": " + ec.message());
+  return llvm::Error::success();
+}
+
+llvm::Expected<OwningOpRef<ModuleOp>>
+PulseCalsCache::load(llvm::StringRef path, MLIRContext *context) {
+  llvm::sys::fs::file_status status;
+  if (auto err = statPulseCalsFile(path, status))
+    return std::move(err);
+
+  std::shared_ptr<const std::string> bytecode;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (auto *entry = lookup(path, status))
+      bytecode = entry->bytecode;
+  }
+
+  if (bytecode) {
+    ParserConfig const parserConfig(context);
+    auto module = parseSourceString<ModuleOp>(*bytecode, parserConfig, path);
+    if (module)
+      return std::move(module);
+    // Fall back to the file if the bytecode cannot be read into context,
+    // e.g., as its dialects are not available.
+  }
+
+  auto module = parsePulseCalsFile(path, context);
+  if (!module)
+    return module.takeError();
+
+  auto newBytecode = std::make_shared<std::string>();
+  llvm::raw_string_ostream bytecodeStream(*newBytecode);
+  if (succeeded(writeBytecodeToFile(module->get(), bytecodeStream))) {
+    bytecodeStream.flush();
+    const std::lock_guard<std::mutex> lock(mutex);
+    getOrReset(path, status).bytecode = std::move(newBytecode);
+  }
+
+  return module;
+}
+
+llvm::Expected<std::shared_ptr<const PulseCalsIndex>>
+PulseCalsCache::loadIndex(llvm::StringRef path, MLIRContext *context) {
+  llvm::sys::fs::file_status status;
+  if (auto err = statPulseCalsFile(path, status))
+    return std::move(err);
+
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (auto *entry = lookup(path, status))
+      if (entry->index)
+        return entry->index;
+  }
+
+  auto module = parsePulseCalsFile(path, context);
+  if (!module)
+    return module.takeError();
+
+  // Move each sequence into a module of its own and append its bytecode.
+  auto index = std::make_shared<PulseCalsIndex>();
+  index->path = path.str();
+  llvm::raw_string_ostream bytecodeStream(index->bytecode);
+  llvm::SmallVector<SequenceOp> sequenceOps;
+  module->get()->walk(
+      [&](SequenceOp sequenceOp) { sequenceOps.push_back(sequenceOp); });
+  for (auto sequenceOp : sequenceOps) {
+    OwningOpRef<ModuleOp> sequenceModule =
+        ModuleOp::create(sequenceOp->getLoc());
+    sequenceOp->remove();
+    sequenceModule->push_back(sequenceOp);
+
+    size_t const offset = bytecodeStream.tell();
+    if (failed(writeBytecodeToFile(sequenceModule.get(), bytecodeStream)))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     llvm::Twine("Failed to index pulse "
+                                                 "calibrations file: ") +
+                                         path);
+    // Later sequences override earlier ones of the same name.
+    index->ranges[sequenceOp.getSymName()] = {offset,
+                                             bytecodeStream.tell() - offset};
+  }
+  bytecodeStream.flush();
+  index->version = llvm::toHex(llvm::SHA256::hash(llvm::arrayRefFromStringRef(
+                                   index->bytecode)),
+                               /*LowerCase=*/true);
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = getOrReset(path, status);
+  entry.index = std::move(index);
+  return entry.index;
+}
+
+bool PulseCalsCache::contains(llvm::StringRef path) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return entries.count(path);
+}
+
+void PulseCalsCache::clear() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+}
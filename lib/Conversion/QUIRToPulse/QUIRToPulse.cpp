@@ -25,12 +25,15 @@
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
 #include "Dialect/Pulse/IR/PulseTypes.h"
+#include "Dialect/Pulse/Utils/LoweredCircuitCache.h"
 #include "Dialect/QCS/IR/QCSOps.h"
 #include "Dialect/QUIR/IR/QUIREnums.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
@@ -38,8 +41,9 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Location.h"
+#include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/OwningOpRef.h"
-#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
@@ -49,12 +53,18 @@
 #include "mlir/Support/LLVM.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
 #include <cassert>
@@ -74,6 +84,44 @@ using namespace mlir::quir;
 using namespace mlir::oq3;
 using namespace mlir::pulse;
 
+namespace {
+/// Get a hash of the printed circuit without its locations.
+std::string getCircuitHash(CircuitOp circuitOp) {
+  std::string printed;
+  llvm::raw_string_ostream printedStream(printed);
+  circuitOp->print(printedStream,
+                   OpPrintingFlags().printGenericOpForm().useLocalScope());
+  printedStream.flush();
+  return llvm::toHex(llvm::SHA256::hash(llvm::arrayRefFromStringRef(printed)),
+                     /*LowerCase=*/true);
+}
+
+/// Get the key of the lowering of a call of the circuit of circuitHash,
+/// which hashes the version of the calibrations, the circuit and the
+/// constant durations the call passes the circuit, which the delays of the
+/// circuit are lowered with.
+std::string getCircuitKey(llvm::StringRef calsVersion,
+                          llvm::StringRef circuitHash,
+                          CallCircuitOp callCircuitOp) {
+  llvm::SHA256 hasher;
+  hasher.update(calsVersion);
+  hasher.update(llvm::ArrayRef<uint8_t>{0});
+  hasher.update(circuitHash);
+  for (auto operand : callCircuitOp.getOperands()) {
+    hasher.update(llvm::ArrayRef<uint8_t>{0});
+    if (!operand.getType().isa<DurationType>())
+      continue;
+    if (auto constantOp = operand.getDefiningOp<quir::ConstantOp>()) {
+      std::string printed;
+      llvm::raw_string_ostream printedStream(printed);
+      constantOp.getValue().print(printedStream);
+      hasher.update(printedStream.str());
+    }
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+} // anonymous namespace
+
 void QUIRToPulsePass::runOnOperation() {
 
   // check for command line override of the path to waveform container
@@ -85,16 +133,78 @@ void QUIRToPulsePass::runOnOperation() {
     parsePulseWaveformContainerOps(WAVEFORM_CONTAINER);
 
   ModuleOp moduleOp = getOperation();
+  symbolIndex = &getAnalysis<SymbolIndexAnalysis>();
   mlir::func::FuncOp mainFunc =
-      dyn_cast<mlir::func::FuncOp>(quir::getMainFunction(moduleOp));
+      dyn_cast<mlir::func::FuncOp>(symbolIndex->getMainFunction());
   assert(mainFunc && "could not find the main func");
 
   mainFuncFirstOp = &mainFunc.getBody().front().front();
-
-  // convert all QUIR circuits to Pulse sequences
+  classicalQUIROpToConvertedPulseOpMap.clear();
+  angleArgName = StringAttr::get(&getContext(), "angle");
+  durationArgName = StringAttr::get(&getContext(), "duration");
+
+  // collect the QUIR circuits to convert; looking up the circuits also
+  // builds the symbol table of the module, which is only read while the
+  // circuits are converted in parallel
+  std::vector<ConvertedCircuit> convertedCircuits;
   moduleOp->walk([&](CallCircuitOp callCircOp) {
-    convertCircuitToSequence(callCircOp, mainFunc, moduleOp);
+    auto &converted = convertedCircuits.emplace_back();
+    converted.callCircuitOp = callCircOp;
+    converted.circuitOp = getCircuitOp(callCircOp);
   });
+  symbolIndex->getSymbolTable(moduleOp);
+
+  // the circuits are only cached when lowered with calibrations of a known
+  // version, which the lowering consumes
+  auto calsVersion = moduleOp->getAttrOfType<StringAttr>(
+      LoweredCircuitCache::calsVersionAttrName);
+  moduleOp->removeAttr(LoweredCircuitCache::calsVersionAttrName);
+  if (cacheCircuits && calsVersion) {
+    // hash each circuit once however many times it is called
+    llvm::DenseMap<Operation *, size_t> circuitIndices;
+    std::vector<std::pair<CircuitOp, std::string>> circuitHashes;
+    for (auto &converted : convertedCircuits)
+      if (circuitIndices
+              .try_emplace(converted.circuitOp, circuitIndices.size())
+              .second)
+        circuitHashes.emplace_back(converted.circuitOp, "");
+    mlir::parallelForEach(&getContext(), circuitHashes, [](auto &entry) {
+      entry.second = getCircuitHash(entry.first);
+    });
+    for (auto &converted : convertedCircuits)
+      converted.cacheKey = getCircuitKey(
+          calsVersion.getValue(),
+          circuitHashes[circuitIndices[converted.circuitOp]].second,
+          converted.callCircuitOp);
+  }
+
+  // convert all QUIR circuits to Pulse sequences, reading those lowered by
+  // earlier compilations from the cache
+  auto &cache = LoweredCircuitCache::global();
+  mlir::parallelForEach(
+      &getContext(), convertedCircuits, [&](ConvertedCircuit &converted) {
+        if (converted.cacheKey.empty()) {
+          convertCircuitToSequence(converted, moduleOp);
+          return;
+        }
+        auto circuit = cache.lookup(converted.cacheKey);
+        if (circuit && loadCachedCircuit(converted, *circuit)) {
+          ++numCacheHits;
+        } else {
+          convertCircuitToSequence(converted, moduleOp);
+          cacheConvertedCircuit(converted);
+          ++numCacheMisses;
+        }
+        // the schedule of the sequence is cached along with it
+        converted.sequenceOp->setAttr(
+            LoweredCircuitCache::circuitKeyAttrName,
+            StringAttr::get(&getContext(), converted.cacheKey));
+      });
+
+  // add the sequences and the ports, mixframes and waveforms they use to the
+  // IR, in the order of the circuit calls
+  for (auto &converted : convertedCircuits)
+    materializeConvertedCircuit(converted, mainFunc);
 
   // first erase the quir call circuits
   LLVM_DEBUG(llvm::dbgs() << "\nErasing quir call circuits:\n");
@@ -126,18 +236,17 @@ void QUIRToPulsePass::runOnOperation() {
   });
 }
 
-void QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp callCircuitOp,
-                                               mlir::func::FuncOp &mainFunc,
+void QUIRToPulsePass::convertCircuitToSequence(ConvertedCircuit &converted,
                                                ModuleOp moduleOp) {
-  mlir::OpBuilder builder(mainFunc);
+  // the sequence is built detached from the module
+  mlir::OpBuilder builder(&getContext());
 
-  auto circuitOp = getCircuitOp(callCircuitOp);
-  std::string const circName = circuitOp.getSymName().str();
-  LLVM_DEBUG(llvm::dbgs() << "\nConverting QUIR circuit " << circName << ":\n");
+  auto callCircuitOp = converted.callCircuitOp;
+  auto circuitOp = converted.circuitOp;
   assert(callCircuitOp && "callCircuit op is null");
   assert(circuitOp && "circuit op is null");
-  addCallCircuitToEraseList(callCircuitOp);
-  addCircuitToEraseList(circuitOp);
+  std::string const circName = circuitOp.getSymName().str();
+  LLVM_DEBUG(llvm::dbgs() << "\nConverting QUIR circuit " << circName << ":\n");
 
   // build an empty pulse sequence
   SmallVector<Value> arguments;
@@ -148,27 +257,21 @@ void QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp callCircuitOp,
   llvm::SmallVector<mlir::Value> convertedPulseSequenceOpReturnValues;
   auto convertedPulseSequenceOp = builder.create<mlir::pulse::SequenceOp>(
       circuitOp.getLoc(), StringRef(circName + "_sequence"), funcType);
+  converted.sequenceOp = convertedPulseSequenceOp;
   auto *entryBlock = convertedPulseSequenceOp.addEntryBlock();
   auto entryBuilder = builder.atBlockBegin(entryBlock);
 
-  // reset the circuit conversion helper data structures
-  convertedSequenceOpArgIndex = 0;
-  circuitArgToConvertedSequenceArgMap.clear();
-  convertedPulseSequenceOpArgs.clear();
-  convertedPulseCallSequenceOpOperandNames.clear();
-
-  // convert quir circuit args if not already converted, and add the converted
-  // args to the the converted pulse sequence
+  // add the args of the converted pulse sequence corresponding to the angle
+  // and duration args of the circuit
   LLVM_DEBUG(llvm::dbgs() << "Processing QUIR circuit args.\n");
-  processCircuitArgs(callCircuitOp, circuitOp, convertedPulseSequenceOp,
-                     mainFunc, entryBuilder);
+  processCircuitArgs(converted, entryBuilder);
 
   circuitOp->walk([&](Operation *quirOp) {
     if (quirOp->hasAttr("pulse.calName")) {
       std::string const pulseCalName =
           quirOp->getAttrOfType<StringAttr>("pulse.calName").getValue().str();
       SmallVector<Value> pulseCalSequenceArgs;
-      Operation *findOp = SymbolTable::lookupSymbolIn(moduleOp, pulseCalName);
+      Operation *findOp = symbolIndex->lookupSymbolIn(moduleOp, pulseCalName);
       auto pulseCalSequenceOp = dyn_cast<SequenceOp>(findOp);
 
       LLVM_DEBUG(llvm::dbgs() << "Processing Pulse cal args.\n");
@@ -177,7 +280,7 @@ void QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp callCircuitOp,
       LLVM_DEBUG(llvm::dbgs() << "QUIR op Pulse cal: ");
       LLVM_DEBUG(pulseCalSequenceOp->dump());
       processPulseCalArgs(quirOp, pulseCalSequenceOp, pulseCalSequenceArgs,
-                          convertedPulseSequenceOp, mainFunc, entryBuilder);
+                          converted, entryBuilder);
 
       auto pulseCalCallSequenceOp =
           entryBuilder.create<mlir::pulse::CallSequenceOp>(
@@ -228,71 +331,156 @@ void QUIRToPulsePass::convertCircuitToSequence(CallCircuitOp callCircuitOp,
   entryBuilder.create<mlir::pulse::ReturnOp>(
       convertedPulseSequenceOp.back().back().getLoc(),
       mlir::ValueRange{convertedPulseSequenceOpReturnValues});
-  convertedPulseSequenceOp->moveBefore(mainFunc);
+  convertedPulseSequenceOp->setAttr("pulse.args",
+                                    builder.getArrayAttr(converted.argNames));
+}
+
+bool QUIRToPulsePass::loadCachedCircuit(ConvertedCircuit &converted,
+                                        const LoweredCircuit &circuit) {
+  // the calibrations the sequence calls are only added to the module, so the
+  // sequence is not verified on its own
+  ParserConfig const parserConfig(&getContext(), /*verifyAfterParse=*/false);
+  auto moduleOp = parseSourceString<ModuleOp>(circuit.bytecode, parserConfig);
+  if (!moduleOp || moduleOp->getBody()->empty())
+    return false;
+  auto sequenceOp = dyn_cast<SequenceOp>(moduleOp->getBody()->front());
+  auto argNames = sequenceOp
+                      ? sequenceOp->getAttrOfType<ArrayAttr>("pulse.args")
+                      : ArrayAttr();
+  if (!argNames)
+    return false;
+
+  // locate the operations of the cached sequence at the circuit
+  Location const loc = converted.circuitOp.getLoc();
+  sequenceOp->walk([&](Operation *op) {
+    op->setLoc(loc);
+    for (auto &region : op->getRegions())
+      for (auto &block : region)
+        for (auto argument : block.getArguments())
+          argument.setLoc(loc);
+  });
+
+  sequenceOp->remove();
+  converted.sequenceOp = sequenceOp;
+  converted.args = circuit.args;
+  converted.argNames.assign(argNames.begin(), argNames.end());
+  return true;
+}
+
+void QUIRToPulsePass::cacheConvertedCircuit(
+    const ConvertedCircuit &converted) {
+  OwningOpRef<ModuleOp> moduleOp =
+      ModuleOp::create(converted.sequenceOp->getLoc());
+  moduleOp->push_back(converted.sequenceOp->clone());
+
+  LoweredCircuit circuit;
+  llvm::raw_string_ostream bytecodeStream(circuit.bytecode);
+  if (failed(writeBytecodeToFile(moduleOp.get(), bytecodeStream)))
+    return;
+  bytecodeStream.flush();
+  circuit.args = converted.args;
+  LoweredCircuitCache::global().insert(converted.cacheKey, std::move(circuit));
+}
+
+void QUIRToPulsePass::materializeConvertedCircuit(
+    ConvertedCircuit &converted, mlir::func::FuncOp &mainFunc) {
+  mlir::OpBuilder builder(mainFunc);
+
+  auto callCircuitOp = converted.callCircuitOp;
+  auto circuitOp = converted.circuitOp;
+  addCallCircuitToEraseList(callCircuitOp);
+  addCircuitToEraseList(circuitOp);
+
+  // the qubit operands of the circuit are no longer used once converted
+  for (uint cnt = 0; cnt < circuitOp.getNumArguments(); cnt++) {
+    if (!circuitOp.getArgument(cnt).getType().isa<mlir::quir::QubitType>())
+      continue;
+    auto *qubitOp = callCircuitOp.getOperand(cnt).getDefiningOp();
+    addCircuitOperandToEraseList(qubitOp);
+  }
+
+  // convert the operands of the call, opening the ports, mixframes and
+  // waveforms the sequence uses
+  SmallVector<Value> convertedPulseSequenceOpArgs;
+  for (auto &arg : converted.args) {
+    switch (arg.kind) {
+    case ConvertedSequenceArg::Kind::Angle: {
+      auto *angleOp =
+          callCircuitOp.getOperand(arg.circuitArgIndex).getDefiningOp();
+      LLVM_DEBUG(llvm::dbgs() << "angle argument ");
+      LLVM_DEBUG(angleOp->dump());
+      convertedPulseSequenceOpArgs.push_back(
+          convertAngleToF64(angleOp, builder));
+      break;
+    }
+    case ConvertedSequenceArg::Kind::Duration: {
+      auto *durationOp =
+          callCircuitOp.getOperand(arg.circuitArgIndex).getDefiningOp();
+      LLVM_DEBUG(llvm::dbgs() << "duration argument ");
+      LLVM_DEBUG(durationOp->dump());
+      convertedPulseSequenceOpArgs.push_back(convertDurationToI64(
+          callCircuitOp, durationOp, arg.circuitArgIndex, builder, mainFunc));
+      break;
+    }
+    case ConvertedSequenceArg::Kind::MixFrame:
+      convertedPulseSequenceOpArgs.push_back(
+          addMixFrameOpToIR(arg.name, arg.portName, mainFunc, builder));
+      break;
+    case ConvertedSequenceArg::Kind::Port:
+      convertedPulseSequenceOpArgs.push_back(
+          addPortOpToIR(arg.name, mainFunc, builder));
+      break;
+    case ConvertedSequenceArg::Kind::Waveform:
+      convertedPulseSequenceOpArgs.push_back(
+          addWfrOpToIR(arg.name, mainFunc, builder));
+      break;
+    }
+  }
+
+  builder.setInsertionPoint(mainFunc);
+  builder.insert(converted.sequenceOp);
 
   // create a call sequence op for the converted pulse sequence
   auto convertedPulseCallSequenceOp =
       builder.create<mlir::pulse::CallSequenceOp>(callCircuitOp->getLoc(),
-                                                  convertedPulseSequenceOp,
+                                                  converted.sequenceOp,
                                                   convertedPulseSequenceOpArgs);
   convertedPulseCallSequenceOp->moveAfter(callCircuitOp);
-  convertedPulseSequenceOp->setAttr(
-      "pulse.args",
-      builder.getArrayAttr(convertedPulseCallSequenceOpOperandNames));
   convertedPulseCallSequenceOp->setAttr(
-      "pulse.operands",
-      builder.getArrayAttr(convertedPulseCallSequenceOpOperandNames));
+      "pulse.operands", builder.getArrayAttr(converted.argNames));
 }
 
-void QUIRToPulsePass::processCircuitArgs(
-    mlir::quir::CallCircuitOp callCircuitOp, mlir::quir::CircuitOp circuitOp,
-    SequenceOp convertedPulseSequenceOp, mlir::func::FuncOp &mainFunc,
-    mlir::OpBuilder &builder) {
+void QUIRToPulsePass::processCircuitArgs(ConvertedCircuit &converted,
+                                         mlir::OpBuilder &builder) {
+  auto circuitOp = converted.circuitOp;
+  auto convertedPulseSequenceOp = converted.sequenceOp;
   for (uint cnt = 0; cnt < circuitOp.getNumArguments(); cnt++) {
     auto arg = circuitOp.getArgument(cnt);
     auto dictArg = circuitOp.getArgAttrDict(cnt);
     mlir::Type const argumentType = arg.getType();
+    uint const convertedSequenceOpArgIndex = converted.args.size();
     if (argumentType.isa<mlir::quir::AngleType>()) {
-      auto *angleOp = callCircuitOp.getOperand(cnt).getDefiningOp();
-      LLVM_DEBUG(llvm::dbgs() << "angle argument ");
-      LLVM_DEBUG(angleOp->dump());
       convertedPulseSequenceOp.insertArgument(convertedSequenceOpArgIndex,
                                               builder.getF64Type(), dictArg,
                                               arg.getLoc());
-      circuitArgToConvertedSequenceArgMap[cnt] = convertedSequenceOpArgIndex;
-      auto convertedAngleToF64 = convertAngleToF64(angleOp, builder);
-      convertedSequenceOpArgIndex += 1;
-      convertedPulseCallSequenceOpOperandNames.push_back(
-          builder.getStringAttr("angle"));
-      convertedPulseSequenceOpArgs.push_back(convertedAngleToF64);
+      converted.circuitArgToSequenceArg[cnt] = convertedSequenceOpArgIndex;
+      converted.args.push_back({ConvertedSequenceArg::Kind::Angle, cnt});
+      converted.argNames.push_back(angleArgName);
     } else if (argumentType.isa<mlir::quir::DurationType>()) {
-      auto *durationOp = callCircuitOp.getOperand(cnt).getDefiningOp();
-      LLVM_DEBUG(llvm::dbgs() << "duration argument ");
-      LLVM_DEBUG(durationOp->dump());
       convertedPulseSequenceOp.insertArgument(convertedSequenceOpArgIndex,
                                               builder.getI64Type(), dictArg,
                                               arg.getLoc());
-      circuitArgToConvertedSequenceArgMap[cnt] = convertedSequenceOpArgIndex;
-      auto convertedDurationToI64 = convertDurationToI64(
-          callCircuitOp, durationOp, cnt, builder, mainFunc);
-      convertedSequenceOpArgIndex += 1;
-      convertedPulseCallSequenceOpOperandNames.push_back(
-          builder.getStringAttr("duration"));
-      convertedPulseSequenceOpArgs.push_back(convertedDurationToI64);
-    } else if (argumentType.isa<mlir::quir::QubitType>()) {
-      auto *qubitOp = callCircuitOp.getOperand(cnt).getDefiningOp();
-      addCircuitOperandToEraseList(qubitOp);
-    }
-
-    else
+      converted.circuitArgToSequenceArg[cnt] = convertedSequenceOpArgIndex;
+      converted.args.push_back({ConvertedSequenceArg::Kind::Duration, cnt});
+      converted.argNames.push_back(durationArgName);
+    } else if (!argumentType.isa<mlir::quir::QubitType>())
       llvm_unreachable("unkown circuit argument.");
   }
 }
 
 void QUIRToPulsePass::processPulseCalArgs(
     mlir::Operation *quirOp, SequenceOp pulseCalSequenceOp,
-    SmallVector<Value> &pulseCalSequenceArgs,
-    SequenceOp convertedPulseSequenceOp, mlir::func::FuncOp &mainFunc,
+    SmallVector<Value> &pulseCalSequenceArgs, ConvertedCircuit &converted,
     mlir::OpBuilder &builder) {
 
   // get the classical operands of the quir op
@@ -318,23 +506,26 @@ void QUIRToPulsePass::processPulseCalArgs(
       std::string const wfrName =
           argAttr[index].dyn_cast<StringAttr>().getValue().str();
       LLVM_DEBUG(llvm::dbgs() << "waveform argument " << wfrName << "\n");
-      processWfrOpArg(wfrName, convertedPulseSequenceOp, pulseCalSequenceArgs,
-                      argumentValue, mainFunc, builder);
+      processNamedArg({ConvertedSequenceArg::Kind::Waveform, 0, wfrName},
+                      argumentType, argumentValue, pulseCalSequenceArgs,
+                      converted, builder);
     } else if (argumentType.isa<MixedFrameType>()) {
       std::string const &mixFrameName =
           argAttr[index].dyn_cast<StringAttr>().getValue().str();
       std::string const &portName =
           argPortsAttr[index].dyn_cast<StringAttr>().getValue().str();
       LLVM_DEBUG(llvm::dbgs() << "mixframe argument " << mixFrameName << "\n");
-      processMixFrameOpArg(mixFrameName, portName, convertedPulseSequenceOp,
-                           pulseCalSequenceArgs, argumentValue, mainFunc,
-                           builder);
+      processNamedArg(
+          {ConvertedSequenceArg::Kind::MixFrame, 0, mixFrameName, portName},
+          argumentType, argumentValue, pulseCalSequenceArgs, converted,
+          builder);
     } else if (argumentType.isa<PortType>()) {
       std::string const &portName =
           argPortsAttr[index].dyn_cast<StringAttr>().getValue().str();
       LLVM_DEBUG(llvm::dbgs() << "port argument " << portName << "\n");
-      processPortOpArg(portName, convertedPulseSequenceOp, pulseCalSequenceArgs,
-                       argumentValue, mainFunc, builder);
+      processNamedArg({ConvertedSequenceArg::Kind::Port, 0, portName},
+                      argumentType, argumentValue, pulseCalSequenceArgs,
+                      converted, builder);
     } else if (argumentType.isa<FloatType>()) {
       assert(argAttr[index].dyn_cast<StringAttr>().getValue().str() ==
                  "angle" &&
@@ -343,8 +534,7 @@ void QUIRToPulsePass::processPulseCalArgs(
       auto nextAngle = angleOperands.front();
       LLVM_DEBUG(llvm::dbgs() << "angle argument ");
       LLVM_DEBUG(nextAngle.dump());
-      processAngleArg(nextAngle, convertedPulseSequenceOp, pulseCalSequenceArgs,
-                      builder);
+      processAngleArg(nextAngle, pulseCalSequenceArgs, converted, builder);
       angleOperands.pop();
     } else if (argumentType.isa<IntegerType>()) {
       assert(argAttr[index].dyn_cast<StringAttr>().getValue().str() ==
@@ -354,8 +544,8 @@ void QUIRToPulsePass::processPulseCalArgs(
       auto nextDuration = durationOperands.front();
       LLVM_DEBUG(llvm::dbgs() << "duration argument ");
       LLVM_DEBUG(nextDuration.dump());
-      processDurationArg(nextDuration, convertedPulseSequenceOp,
-                         pulseCalSequenceArgs, builder);
+      processDurationArg(nextDuration, pulseCalSequenceArgs, converted,
+                         builder);
       durationOperands.pop();
     } else
       llvm_unreachable("unkown argument type.");
@@ -386,160 +576,96 @@ void QUIRToPulsePass::getQUIROpClassicalOperands(
       llvm_unreachable("unkown operand.");
 }
 
-void QUIRToPulsePass::processMixFrameOpArg(
-    std::string const &mixFrameName, std::string const &portName,
-    SequenceOp convertedPulseSequenceOp,
-    SmallVector<Value> &pulseCalSequenceArgs, Value argumentValue,
-    mlir::func::FuncOp &mainFunc, mlir::OpBuilder &builder) {
-  auto mixedFrameOp =
-      addMixFrameOpToIR(mixFrameName, portName, mainFunc, builder);
-  auto it = std::find(convertedPulseCallSequenceOpOperandNames.begin(),
-                      convertedPulseCallSequenceOpOperandNames.end(),
-                      builder.getStringAttr(mixFrameName));
-  if (it == convertedPulseCallSequenceOpOperandNames.end()) {
-    convertedPulseCallSequenceOpOperandNames.push_back(
-        builder.getStringAttr(mixFrameName));
-    convertedPulseSequenceOpArgs.push_back(mixedFrameOp);
-    convertedPulseSequenceOp.insertArgument(
-        convertedSequenceOpArgIndex,
-        builder.getType<mlir::pulse::MixedFrameType>(), DictionaryAttr{},
-        argumentValue.getLoc());
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[convertedSequenceOpArgIndex]);
-    convertedSequenceOpArgIndex += 1;
-  } else {
-    uint const mixFrameOperandIndex =
-        std::distance(convertedPulseCallSequenceOpOperandNames.begin(), it);
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[mixFrameOperandIndex]);
-  }
-}
-
-void QUIRToPulsePass::processPortOpArg(std::string const &portName,
-                                       SequenceOp convertedPulseSequenceOp,
-                                       SmallVector<Value> &pulseCalSequenceArgs,
-                                       Value argumentValue,
-                                       mlir::func::FuncOp &mainFunc,
-                                       mlir::OpBuilder &builder) {
-  auto portOp = addPortOpToIR(portName, mainFunc, builder);
-  auto it = std::find(convertedPulseCallSequenceOpOperandNames.begin(),
-                      convertedPulseCallSequenceOpOperandNames.end(),
-                      builder.getStringAttr(portName));
-  if (it == convertedPulseCallSequenceOpOperandNames.end()) {
-    convertedPulseCallSequenceOpOperandNames.push_back(
-        builder.getStringAttr(portName));
-    convertedPulseSequenceOpArgs.push_back(portOp);
-    convertedPulseSequenceOp.insertArgument(
-        convertedSequenceOpArgIndex, builder.getType<mlir::pulse::PortType>(),
-        DictionaryAttr{}, argumentValue.getLoc());
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[convertedSequenceOpArgIndex]);
-    convertedSequenceOpArgIndex += 1;
-  } else {
-    uint const portOperandIndex =
-        std::distance(convertedPulseCallSequenceOpOperandNames.begin(), it);
-    pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[portOperandIndex]);
-  }
-}
-
-void QUIRToPulsePass::processWfrOpArg(std::string const &wfrName,
-                                      SequenceOp convertedPulseSequenceOp,
+void QUIRToPulsePass::processNamedArg(ConvertedSequenceArg arg,
+                                      mlir::Type argType, Value argumentValue,
                                       SmallVector<Value> &pulseCalSequenceArgs,
-                                      Value argumentValue,
-                                      mlir::func::FuncOp &mainFunc,
+                                      ConvertedCircuit &converted,
                                       mlir::OpBuilder &builder) {
-  auto wfrOp = addWfrOpToIR(wfrName, mainFunc, builder);
-  auto it = std::find(convertedPulseCallSequenceOpOperandNames.begin(),
-                      convertedPulseCallSequenceOpOperandNames.end(),
-                      builder.getStringAttr(wfrName));
-  if (it == convertedPulseCallSequenceOpOperandNames.end()) {
-    convertedPulseCallSequenceOpOperandNames.push_back(
-        builder.getStringAttr(wfrName));
-    convertedPulseSequenceOpArgs.push_back(wfrOp);
-    convertedPulseSequenceOp.insertArgument(
-        convertedSequenceOpArgIndex,
-        builder.getType<mlir::pulse::WaveformType>(), DictionaryAttr{},
-        argumentValue.getLoc());
+  auto convertedPulseSequenceOp = converted.sequenceOp;
+  // compare the names without interning them, which locks the context
+  auto it = llvm::find_if(converted.argNames, [&](mlir::Attribute name) {
+    return name.cast<StringAttr>().getValue() == arg.name;
+  });
+  if (it == converted.argNames.end()) {
+    uint const convertedSequenceOpArgIndex = converted.args.size();
+    converted.argNames.push_back(builder.getStringAttr(arg.name));
+    converted.args.push_back(std::move(arg));
+    convertedPulseSequenceOp.insertArgument(convertedSequenceOpArgIndex,
+                                            argType, DictionaryAttr{},
+                                            argumentValue.getLoc());
     pulseCalSequenceArgs.push_back(
         convertedPulseSequenceOp.getArguments()[convertedSequenceOpArgIndex]);
-    convertedSequenceOpArgIndex += 1;
   } else {
-    uint const wfrOperandIndex =
-        std::distance(convertedPulseCallSequenceOpOperandNames.begin(), it);
+    uint const operandIndex = std::distance(converted.argNames.begin(), it);
     pulseCalSequenceArgs.push_back(
-        convertedPulseSequenceOp.getArguments()[wfrOperandIndex]);
+        convertedPulseSequenceOp.getArguments()[operandIndex]);
   }
 }
 
 void QUIRToPulsePass::processAngleArg(Value nextAngleOperand,
-                                      SequenceOp convertedPulseSequenceOp,
                                       SmallVector<Value> &pulseCalSequenceArgs,
+                                      ConvertedCircuit &converted,
                                       mlir::OpBuilder &entryBuilder) {
+  auto convertedPulseSequenceOp = converted.sequenceOp;
   if (nextAngleOperand.isa<BlockArgument>()) {
     uint const circNum =
         nextAngleOperand.dyn_cast<BlockArgument>().getArgNumber();
     pulseCalSequenceArgs.push_back(
         convertedPulseSequenceOp
-            .getArguments()[circuitArgToConvertedSequenceArgMap[circNum]]);
+            .getArguments()[converted.circuitArgToSequenceArg[circNum]]);
   } else {
     auto angleOp = nextAngleOperand.getDefiningOp<mlir::quir::ConstantOp>();
-    std::string const angleLocHash =
-        std::to_string(mlir::hash_value(angleOp->getLoc()));
-    if (classicalQUIROpLocToConvertedPulseOpMap.find(angleLocHash) ==
-        classicalQUIROpLocToConvertedPulseOpMap.end()) {
+    mlir::Attribute const angleAttr = angleOp.getValue();
+    if (converted.convertedConstants.find(angleAttr) ==
+        converted.convertedConstants.end()) {
       double const angleVal =
           angleOp.getAngleValueFromConstant().convertToDouble();
       auto f64Angle = entryBuilder.create<mlir::arith::ConstantOp>(
           angleOp.getLoc(), entryBuilder.getFloatAttr(entryBuilder.getF64Type(),
                                                       llvm::APFloat(angleVal)));
-      classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = f64Angle;
+      converted.convertedConstants[angleAttr] = f64Angle;
     }
-    pulseCalSequenceArgs.push_back(
-        classicalQUIROpLocToConvertedPulseOpMap[angleLocHash]);
+    pulseCalSequenceArgs.push_back(converted.convertedConstants[angleAttr]);
   }
 }
 
 void QUIRToPulsePass::processDurationArg(
-    Value nextDurationOperand, SequenceOp convertedPulseSequenceOp,
-    SmallVector<Value> &pulseCalSequenceArgs, mlir::OpBuilder &entryBuilder) {
+    Value nextDurationOperand, SmallVector<Value> &pulseCalSequenceArgs,
+    ConvertedCircuit &converted, mlir::OpBuilder &entryBuilder) {
+  auto convertedPulseSequenceOp = converted.sequenceOp;
   if (nextDurationOperand.isa<BlockArgument>()) {
     uint const circNum =
         nextDurationOperand.dyn_cast<BlockArgument>().getArgNumber();
     pulseCalSequenceArgs.push_back(
         convertedPulseSequenceOp
-            .getArguments()[circuitArgToConvertedSequenceArgMap[circNum]]);
+            .getArguments()[converted.circuitArgToSequenceArg[circNum]]);
   } else {
     auto durationOp =
         nextDurationOperand.getDefiningOp<mlir::quir::ConstantOp>();
-    std::string const durLocHash =
-        std::to_string(mlir::hash_value(nextDurationOperand.getLoc()));
+    mlir::Attribute const durAttr = durationOp.getValue();
     auto durVal =
         quir::getDuration(durationOp).get().getDuration().convertToDouble();
     assert(durationOp.getType().dyn_cast<DurationType>().getUnits() ==
                TimeUnits::dt &&
            "this pass only accepts durations with dt unit");
 
-    if (classicalQUIROpLocToConvertedPulseOpMap.find(durLocHash) ==
-        classicalQUIROpLocToConvertedPulseOpMap.end()) {
+    if (converted.convertedConstants.find(durAttr) ==
+        converted.convertedConstants.end()) {
       auto dur64 = entryBuilder.create<mlir::arith::ConstantOp>(
           durationOp.getLoc(),
           entryBuilder.getIntegerAttr(entryBuilder.getI64Type(),
                                       uint64_t(durVal)));
-      classicalQUIROpLocToConvertedPulseOpMap[durLocHash] = dur64;
+      converted.convertedConstants[durAttr] = dur64;
     }
-    pulseCalSequenceArgs.push_back(
-        classicalQUIROpLocToConvertedPulseOpMap[durLocHash]);
+    pulseCalSequenceArgs.push_back(converted.convertedConstants[durAttr]);
   }
 }
 
 mlir::Value QUIRToPulsePass::convertAngleToF64(Operation *angleOp,
                                                mlir::OpBuilder &builder) {
   assert(angleOp && "angle op is null");
-  std::string const angleLocHash =
-      std::to_string(mlir::hash_value(angleOp->getLoc()));
-  if (classicalQUIROpLocToConvertedPulseOpMap.find(angleLocHash) ==
-      classicalQUIROpLocToConvertedPulseOpMap.end()) {
+  if (classicalQUIROpToConvertedPulseOpMap.find(angleOp) ==
+      classicalQUIROpToConvertedPulseOpMap.end()) {
     if (auto castOp = dyn_cast<quir::ConstantOp>(angleOp)) {
       addCircuitOperandToEraseList(angleOp);
       double const angleVal =
@@ -548,12 +674,12 @@ mlir::Value QUIRToPulsePass::convertAngleToF64(Operation *angleOp,
           castOp->getLoc(),
           builder.getFloatAttr(builder.getF64Type(), llvm::APFloat(angleVal)));
       f64Angle->moveAfter(castOp);
-      classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = f64Angle;
+      classicalQUIROpToConvertedPulseOpMap[angleOp] = f64Angle;
     } else if (auto castOp = dyn_cast<qcs::ParameterLoadOp>(angleOp)) {
       auto angleCastedOp = builder.create<oq3::CastOp>(
           castOp->getLoc(), builder.getF64Type(), castOp.getRes());
       angleCastedOp->moveAfter(castOp);
-      classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = angleCastedOp;
+      classicalQUIROpToConvertedPulseOpMap[angleOp] = angleCastedOp;
     } else if (auto castOp = dyn_cast<oq3::CastOp>(angleOp)) {
       addCircuitOperandToEraseList(angleOp);
       auto castOpArg = castOp.getArg();
@@ -562,23 +688,21 @@ mlir::Value QUIRToPulsePass::convertAngleToF64(Operation *angleOp,
         auto angleCastedOp = builder.create<oq3::CastOp>(
             paramCastOp->getLoc(), builder.getF64Type(), paramCastOp.getRes());
         angleCastedOp->moveAfter(paramCastOp);
-        classicalQUIROpLocToConvertedPulseOpMap[angleLocHash] = angleCastedOp;
+        classicalQUIROpToConvertedPulseOpMap[angleOp] = angleCastedOp;
       } else
         llvm_unreachable("castOp arg unknown");
     } else
       llvm_unreachable("angleOp unknown");
   }
-  return classicalQUIROpLocToConvertedPulseOpMap[angleLocHash];
+  return classicalQUIROpToConvertedPulseOpMap[angleOp];
 }
 
 mlir::Value QUIRToPulsePass::convertDurationToI64(
     mlir::quir::CallCircuitOp callCircuitOp, Operation *durationOp, uint &cnt,
     mlir::OpBuilder &builder, mlir::func::FuncOp &mainFunc) {
   assert(durationOp && "duration op is null");
-  std::string const durLocHash =
-      std::to_string(mlir::hash_value(durationOp->getLoc()));
-  if (classicalQUIROpLocToConvertedPulseOpMap.find(durLocHash) ==
-      classicalQUIROpLocToConvertedPulseOpMap.end()) {
+  if (classicalQUIROpToConvertedPulseOpMap.find(durationOp) ==
+      classicalQUIROpToConvertedPulseOpMap.end()) {
     if (auto castOp = dyn_cast<quir::ConstantOp>(durationOp)) {
       addCircuitOperandToEraseList(durationOp);
       auto durVal =
@@ -591,11 +715,11 @@ mlir::Value QUIRToPulsePass::convertDurationToI64(
           castOp->getLoc(),
           builder.getIntegerAttr(builder.getI64Type(), uint64_t(durVal)));
       I64Dur->moveAfter(castOp);
-      classicalQUIROpLocToConvertedPulseOpMap[durLocHash] = I64Dur;
+      classicalQUIROpToConvertedPulseOpMap[durationOp] = I64Dur;
     } else
       llvm_unreachable("unkown duration op");
   }
-  return classicalQUIROpLocToConvertedPulseOpMap[durLocHash];
+  return classicalQUIROpToConvertedPulseOpMap[durationOp];
 }
 
 mlir::pulse::Port_CreateOp
@@ -630,9 +754,17 @@ QUIRToPulsePass::addWfrOpToIR(std::string const &wfrName,
                               mlir::func::FuncOp &mainFunc,
                               mlir::OpBuilder &builder) {
   if (openedWfrs.find(wfrName) == openedWfrs.end()) {
-    auto *clonedOp = builder.clone(*pulseNameToWaveformMap[wfrName]);
-    auto wfrOp = dyn_cast<Waveform_CreateOp>(clonedOp);
-    wfrOp->moveBefore(mainFuncFirstOp);
+    // waveforms with the same samples share a single waveform op in main
+    auto containerWfrOp = pulseNameToWaveformMap[wfrName];
+    auto &wfrOp = openedWfrsBySamples[{containerWfrOp.getSamples(),
+                                       containerWfrOp.getScaleAttr()}];
+    if (!wfrOp) {
+      auto *clonedOp = builder.clone(*containerWfrOp);
+      wfrOp = dyn_cast<Waveform_CreateOp>(clonedOp);
+      wfrOp->moveBefore(mainFuncFirstOp);
+    } else
+      LLVM_DEBUG(llvm::dbgs() << "waveform " << wfrName
+                              << " shares the samples of another waveform\n");
     openedWfrs[wfrName] = wfrOp;
   }
   return openedWfrs[wfrName];
@@ -686,13 +818,8 @@ void QUIRToPulsePass::parsePulseWaveformContainerOps(
 
 mlir::quir::CircuitOp
 QUIRToPulsePass::getCircuitOp(CallCircuitOp callCircuitOp) {
-  auto circuitAttr = callCircuitOp->getAttrOfType<FlatSymbolRefAttr>("callee");
-  assert(circuitAttr && "Requires a 'callee' symbol reference attribute");
-
-  auto circuitOp = SymbolTable::lookupNearestSymbolFrom<mlir::quir::CircuitOp>(
-      callCircuitOp, circuitAttr);
-  assert(circuitOp && "matching circuit not found");
-  return circuitOp;
+  assert(symbolIndex && "the symbol index is only available while running");
+  return symbolIndex->getCircuitOp(callCircuitOp);
 }
 
 llvm::StringRef QUIRToPulsePass::getArgument() const { return "quir-to-pulse"; }
@@ -19,38 +19,48 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
-#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Region.h"
 #include "mlir/IR/ValueRange.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/SmallVector.h"
+
 #include <cassert>
-#include <vector>
+#include <iterator>
 
 namespace mlir::quir {
 
-// llvm.switch i32 %flag, label switchEnd [
-//     i32 caseVal_1 : label caseRegion_1
-//     i32 caseVal_2 : label caseRegion_2
+// cf.switch %flag : i32, [
+//   default: ^caseRegion_default,
+//   caseVal_1: ^caseRegion_1,
+//   caseVal_2: ^switchEnd(%yielded : i32),
 //   ...
 // ]
-// caseRegion_default:
-//     // gates
-//    cf.br switchEnd
-// caseRegion_1:
+// ^caseRegion_default:
 //     // gates
-//    cf.br switchEnd
-// caseRegion_2:
+//    cf.br ^switchEnd
+// ^caseRegion_1:
 //     // gates
-//    cf.br switchEnd
+//    cf.br ^switchEnd
 // ...
-// switchEnd:
+// ^switchEnd:
 // ...
+//
+// Regions which only yield, e.g., the cases of a feed-forward which leave
+// some of the syndromes alone, branch straight to the continuation. cf.switch
+// lowers to llvm.switch, for which the LLVM backend chooses between a jump
+// table, bit tests and a binary search depending on the density of the cases.
 struct SwitchOpLowering : public OpRewritePattern<SwitchOp> {
   using OpRewritePattern<SwitchOp>::OpRewritePattern;
 
@@ -58,6 +68,13 @@ struct SwitchOpLowering : public OpRewritePattern<SwitchOp> {
                                 PatternRewriter &rewriter) const override;
 };
 
+namespace {
+/// Whether a region consists of nothing but its terminator.
+bool onlyYields(Region &region) {
+  return region.hasOneBlock() && region.front().getOperations().size() == 1;
+}
+} // anonymous namespace
+
 LogicalResult
 SwitchOpLowering::matchAndRewrite(SwitchOp switchOp,
                                   PatternRewriter &rewriter) const {
@@ -74,40 +91,57 @@ SwitchOpLowering::matchAndRewrite(SwitchOp switchOp,
   for (auto resultType : switchOp.getResultTypes())
     results.push_back(
         continueBlock->addArgument(resultType.getType(), switchOp.getLoc()));
-  // Move blocks from the "default" region to the region containing
-  // 'quir.switch', place it before the continuation block, and branch to it.
-  auto &defaultRegion = switchOp.getDefaultRegion();
-  auto *defaultBlock = &defaultRegion.front();
-  Operation *defaultTerminator = defaultRegion.back().getTerminator();
-  ValueRange const defaultTerminatorOperands = defaultTerminator->getOperands();
-  rewriter.setInsertionPointToEnd(&defaultRegion.back());
-  rewriter.create<cf::BranchOp>(loc, continueBlock, defaultTerminatorOperands);
-  rewriter.eraseOp(defaultTerminator);
-  rewriter.inlineRegionBefore(defaultRegion, continueBlock);
-
-  // Move blocks from the "case" regions (if present) to the region containing
-  // 'quir.switch', place it before the continuation block and branch to it. It
-  // will be placed after the "default" regions.
-  auto caseBlocks = std::vector<Block *>();
-  auto *currBlock = continueBlock;
-  auto caseOperands = std::vector<mlir::ValueRange>();
-  for (auto &region : switchOp.getCaseRegions())
-    if (!region.empty()) {
-      caseOperands.emplace_back();
-      currBlock = &region.front();
-      caseBlocks.push_back(currBlock);
-      Operation *caseTerminator = region.back().getTerminator();
-      ValueRange const caseTerminatorOperands = caseTerminator->getOperands();
-      rewriter.setInsertionPointToEnd(&region.back());
-      rewriter.create<cf::BranchOp>(loc, continueBlock, caseTerminatorOperands);
-      rewriter.eraseOp(caseTerminator);
-      rewriter.inlineRegionBefore(region, continueBlock);
+
+  // Move the blocks of a region to the region containing 'quir.switch',
+  // before the continuation block, and branch from them to it. Regions which
+  // only yield are left in place and the switch branches to the continuation
+  // with the yielded values instead.
+  auto lowerRegion = [&](Region &region,
+                         SmallVector<Value> &yielded) -> Block * {
+    Operation *terminator = region.back().getTerminator();
+    if (onlyYields(region)) {
+      yielded.assign(terminator->operand_begin(), terminator->operand_end());
+      return continueBlock;
     }
+    Block *entryBlock = &region.front();
+    rewriter.setInsertionPointToEnd(&region.back());
+    rewriter.create<cf::BranchOp>(loc, continueBlock,
+                                  terminator->getOperands());
+    rewriter.eraseOp(terminator);
+    rewriter.inlineRegionBefore(region, continueBlock);
+    return entryBlock;
+  };
+
+  // The "default" region is placed first, followed by the "case" regions,
+  // unless the switch was profiled, see ApplyRuntimeProfilePass, in which
+  // case the regions are placed by decreasing execution count so that the
+  // hot cases follow the switch.
+  SmallVector<Region *> regions{&switchOp.getDefaultRegion()};
+  for (auto &region : switchOp.getCaseRegions())
+    if (!region.empty())
+      regions.push_back(&region);
+  SmallVector<unsigned> layout(llvm::seq<unsigned>(0, regions.size()));
+  if (auto counts = switchOp->getAttrOfType<DenseI64ArrayAttr>(
+          getBranchCountsAttrName());
+      counts && counts.asArrayRef().size() == switchOp->getNumRegions())
+    llvm::stable_sort(layout, [&](unsigned lhs, unsigned rhs) {
+      return counts.asArrayRef()[regions[lhs]->getRegionNumber()] >
+             counts.asArrayRef()[regions[rhs]->getRegionNumber()];
+    });
+  SmallVector<Block *> destinations(regions.size());
+  SmallVector<SmallVector<Value>> yieldedValues(regions.size());
+  for (unsigned const index : layout)
+    destinations[index] = lowerRegion(*regions[index], yieldedValues[index]);
 
+  SmallVector<Block *> caseBlocks(std::next(destinations.begin()),
+                                  destinations.end());
+  SmallVector<ValueRange> caseOperands(std::next(yieldedValues.begin()),
+                                       yieldedValues.end());
   rewriter.setInsertionPointToEnd(condBlock);
-  rewriter.create<LLVM::SwitchOp>(
-      loc, /*flag=*/switchOp.getFlag(), /*defaultDestination=*/defaultBlock,
-      /*defaultOperands=*/ValueRange(),
+  rewriter.create<cf::SwitchOp>(
+      loc, /*flag=*/switchOp.getFlag(),
+      /*defaultDestination=*/destinations.front(),
+      /*defaultOperands=*/yieldedValues.front(),
       /*caseValues=*/switchOp.getCaseValues(), /*caseDestinations=*/caseBlocks,
       /*caseOperands=*/caseOperands);
 
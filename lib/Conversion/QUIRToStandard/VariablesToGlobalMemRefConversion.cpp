@@ -30,21 +30,35 @@
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/AffineMap.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/ValueRange.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Interfaces/LoopLikeInterface.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <iterator>
 #include <optional>
+#include <string>
+#include <utility>
 
 using namespace mlir;
 using namespace mlir::oq3;
@@ -80,21 +94,156 @@ createGlobalMemrefOp(mlir::OpBuilder &builder, mlir::Location loc,
       /* alignment= */ nullptr);
 }
 
+/// The alignment of the packed variable buffers, i.e., a cache line.
+constexpr int64_t packedVariableAlignment = 64;
+
+/// The live range of a variable whose accesses all are in (the regions of)
+/// the ops of a single block, the first of them being an assignment of the
+/// block itself. The variable holds no value before begin nor after end, so
+/// that its slot may be shared with the variables live in other ranges.
+struct LiveRange {
+  mlir::Operation *begin;
+  mlir::Operation *end;
+
+  bool endsBefore(const LiveRange &other) const {
+    return end->getBlock() == other.begin->getBlock() &&
+           end->isBeforeInBlock(other.begin);
+  }
+  /// Whether any of ops, which are in the order of the block, is in range.
+  bool containsAny(llvm::ArrayRef<mlir::Operation *> ops) const {
+    const auto *opIt = llvm::lower_bound(ops, begin, [](auto *op, auto *first) {
+      return op->isBeforeInBlock(first);
+    });
+    return opIt != ops.end() && !end->isBeforeInBlock(*opIt);
+  }
+};
+
+/// Get the live range of a variable from its accesses, if it has one.
+std::optional<LiveRange> getLiveRange(llvm::ArrayRef<mlir::Operation *> users) {
+  // the first access in program order is found among the assignments, as
+  // any other access before them would read an undefined value
+  std::optional<LiveRange> range;
+  for (auto *user : users) {
+    if (!mlir::isa<VariableAssignOp>(user))
+      continue;
+    auto *block = user->getBlock();
+    if (range && block != range->begin->getBlock())
+      continue;
+    if (!range || user->isBeforeInBlock(range->begin))
+      range = LiveRange{user, user};
+  }
+  if (!range)
+    return std::nullopt;
+
+  auto *block = range->begin->getBlock();
+  for (auto *user : users) {
+    auto *ancestor = block->findAncestorOpInBlock(*user);
+    if (!ancestor || ancestor->isBeforeInBlock(range->begin))
+      return std::nullopt;
+    if (range->end->isBeforeInBlock(ancestor))
+      range->end = ancestor;
+  }
+  return range;
+}
+
+/// Assign the variables of a buffer to slots, sharing a slot between the
+/// variables whose live ranges do not overlap in a linear scan over the
+/// ranges of each block. A range holding a call keeps a slot of its own, as
+/// the callee may reenter the block and access the variables sharing it. The
+/// slots are in the order of their first variable.
+llvm::SmallVector<llvm::SmallVector<DeclareVariableOp, 1>>
+allocateSlots(llvm::ArrayRef<DeclareVariableOp> declareOps,
+              const llvm::DenseMap<mlir::StringAttr,
+                                   llvm::SmallVector<mlir::Operation *>>
+                  &accesses,
+              bool reuseSlots) {
+  llvm::SmallVector<llvm::SmallVector<DeclareVariableOp, 1>> slots;
+  llvm::MapVector<mlir::Block *,
+                  llvm::SmallVector<std::pair<LiveRange, DeclareVariableOp>>>
+      rangesByBlock;
+  for (auto declareOp : declareOps) {
+    std::optional<LiveRange> range;
+    if (reuseSlots) {
+      auto accessIt = accesses.find(declareOp.getSymNameAttr());
+      if (accessIt != accesses.end())
+        range = getLiveRange(accessIt->second);
+    }
+    if (range)
+      rangesByBlock[range->begin->getBlock()].emplace_back(*range, declareOp);
+    else
+      slots.emplace_back().push_back(declareOp);
+  }
+
+  for (auto &[block, ranges] : rangesByBlock) {
+    llvm::SmallVector<mlir::Operation *> calls;
+    for (auto &op : *block)
+      if (op.walk([](mlir::CallOpInterface) {
+              return mlir::WalkResult::interrupt();
+            }).wasInterrupted())
+        calls.push_back(&op);
+    llvm::erase_if(ranges, [&](const auto &entry) {
+      if (!entry.first.containsAny(calls))
+        return false;
+      slots.emplace_back().push_back(entry.second);
+      return true;
+    });
+
+    llvm::stable_sort(ranges, [](const auto &lhs, const auto &rhs) {
+      return lhs.first.begin->isBeforeInBlock(rhs.first.begin);
+    });
+    // the slots of the block, with the end of the range last placed in them
+    llvm::SmallVector<std::pair<LiveRange, unsigned>> blockSlots;
+    for (auto &[range, declareOp] : ranges) {
+      auto *slotIt = llvm::find_if(blockSlots, [&](const auto &slot) {
+        return slot.first.endsBefore(range);
+      });
+      if (slotIt == blockSlots.end()) {
+        blockSlots.emplace_back(range, slots.size());
+        slots.emplace_back();
+        slotIt = std::prev(blockSlots.end());
+      }
+      slotIt->first = range;
+      slots[slotIt->second].push_back(declareOp);
+    }
+  }
+  return slots;
+}
+
+/// Get the slot of the variable accessed by variableOp if it is packed.
+template <class QUIRVariableOp>
+std::optional<PackedVariableLayout::Slot>
+lookupSlot(const PackedVariableLayout *layout, QUIRVariableOp variableOp) {
+  if (!layout)
+    return std::nullopt;
+  auto slotIt = layout->slots.find(variableOp.getVariableNameAttr().getAttr());
+  if (slotIt == layout->slots.end())
+    return std::nullopt;
+  return slotIt->second;
+}
+
 struct VariableDeclarationConversionPattern
     : public OpConversionPattern<DeclareVariableOp> {
-  explicit VariableDeclarationConversionPattern(MLIRContext *ctx,
-                                                TypeConverter &typeConverter,
-                                                bool externalizeOutputVariables)
+  explicit VariableDeclarationConversionPattern(
+      MLIRContext *ctx, TypeConverter &typeConverter,
+      bool externalizeOutputVariables, const PackedVariableLayout *layout)
       : OpConversionPattern<DeclareVariableOp>(typeConverter, ctx,
                                                /*benefit=*/1),
-        externalizeOutputVariables(externalizeOutputVariables) {}
+        externalizeOutputVariables(externalizeOutputVariables),
+        layout(layout) {}
 
   bool const externalizeOutputVariables;
+  const PackedVariableLayout *layout;
 
   LogicalResult
   matchAndRewrite(DeclareVariableOp declareOp, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
 
+    // the buffer of a packed variable has been created by packVariables
+    if (layout && layout->slots.count(declareOp.getSymNameAttr())) {
+      rewriter.eraseOp(declareOp);
+      return success();
+    }
+
     auto declarationType = declareOp.getType();
     auto convertedType = typeConverter->convertType(declareOp.getType());
     if (convertedType)
@@ -170,16 +319,18 @@ struct ArrayDeclarationConversionPattern
 /// @tparam QUIRVariableOp template parameter for the type of QUIRVariableOp
 /// @param variableOp the variable operation to find or create a
 /// GetGlobalMemrefOp for
+/// @param globalName the name of the GlobalMemrefOp holding the variable
 /// @return a GetGlobalMemrefOp for the given variable op
 template <class QUIRVariableOp>
 std::optional<mlir::memref::GetGlobalOp>
 findOrCreateGetGlobalMemref(QUIRVariableOp variableOp,
+                            mlir::FlatSymbolRefAttr globalName,
                             ConversionPatternRewriter &builder) {
   mlir::OpBuilder::InsertionGuard const g(builder);
 
   auto globalMemrefOp =
       SymbolTable::lookupNearestSymbolFrom<mlir::memref::GlobalOp>(
-          variableOp, variableOp.getVariableNameAttr());
+          variableOp, globalName);
 
   if (!globalMemrefOp) {
     variableOp.emitOpError("Cannot lookup a variable declaration for " +
@@ -214,21 +365,32 @@ findOrCreateGetGlobalMemref(QUIRVariableOp variableOp,
 struct VariableUseConversionPattern
     : public OpConversionPattern<VariableLoadOp> {
   explicit VariableUseConversionPattern(MLIRContext *ctx,
-                                        TypeConverter &typeConverter)
-      : OpConversionPattern<VariableLoadOp>(typeConverter, ctx, /*benefit=*/1) {
+                                        TypeConverter &typeConverter,
+                                        const PackedVariableLayout *layout)
+      : OpConversionPattern<VariableLoadOp>(typeConverter, ctx, /*benefit=*/1),
+        layout(layout) {}
 
-  }
+  const PackedVariableLayout *layout;
 
   LogicalResult
   matchAndRewrite(VariableLoadOp useOp, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    auto varRefOrNone = findOrCreateGetGlobalMemref(useOp, rewriter);
+    auto slot = lookupSlot(layout, useOp);
+    auto varRefOrNone = findOrCreateGetGlobalMemref(
+        useOp, slot ? slot->buffer : useOp.getVariableNameAttr(), rewriter);
     if (!varRefOrNone)
       return failure();
 
     auto varRef = varRefOrNone.value();
-    auto loadOp = rewriter.create<mlir::affine::AffineLoadOp>(
-        useOp.getLoc(), varRef.getResult());
+    mlir::affine::AffineLoadOp loadOp;
+    if (slot)
+      loadOp = rewriter.create<mlir::affine::AffineLoadOp>(
+          useOp.getLoc(), varRef.getResult(),
+          AffineMap::getConstantMap(slot->index, rewriter.getContext()),
+          mlir::ValueRange{});
+    else
+      loadOp = rewriter.create<mlir::affine::AffineLoadOp>(
+          useOp.getLoc(), varRef.getResult());
 
     rewriter.replaceOp(useOp, loadOp);
     return success();
@@ -246,7 +408,8 @@ struct ArrayElementUseConversionPattern
   matchAndRewrite(UseArrayElementOp useOp, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
 
-    auto varRefOrNone = findOrCreateGetGlobalMemref(useOp, rewriter);
+    auto varRefOrNone = findOrCreateGetGlobalMemref(
+        useOp, useOp.getVariableNameAttr(), rewriter);
     if (!varRefOrNone)
       return failure();
     auto varRef = varRefOrNone.value();
@@ -264,21 +427,34 @@ struct ArrayElementUseConversionPattern
 struct VariableAssignConversionPattern
     : public OpConversionPattern<VariableAssignOp> {
   explicit VariableAssignConversionPattern(MLIRContext *ctx,
-                                           TypeConverter &typeConverter)
+                                           TypeConverter &typeConverter,
+                                           const PackedVariableLayout *layout)
       : OpConversionPattern<VariableAssignOp>(typeConverter, ctx,
-                                              /*benefit=*/1) {}
+                                              /*benefit=*/1),
+        layout(layout) {}
+
+  const PackedVariableLayout *layout;
 
   LogicalResult
   matchAndRewrite(VariableAssignOp assignOp, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    auto varRefOrNone = findOrCreateGetGlobalMemref(assignOp, rewriter);
+    auto slot = lookupSlot(layout, assignOp);
+    auto varRefOrNone = findOrCreateGetGlobalMemref(
+        assignOp, slot ? slot->buffer : assignOp.getVariableNameAttr(),
+        rewriter);
     if (!varRefOrNone)
       return failure();
     auto varRef = varRefOrNone.value();
 
-    rewriter.create<mlir::affine::AffineStoreOp>(
-        assignOp.getLoc(), adaptor.getAssignedValue(), varRef.getResult(),
-        mlir::ValueRange{});
+    if (slot)
+      rewriter.create<mlir::affine::AffineStoreOp>(
+          assignOp.getLoc(), adaptor.getAssignedValue(), varRef.getResult(),
+          AffineMap::getConstantMap(slot->index, rewriter.getContext()),
+          mlir::ValueRange{});
+    else
+      rewriter.create<mlir::affine::AffineStoreOp>(
+          assignOp.getLoc(), adaptor.getAssignedValue(), varRef.getResult(),
+          mlir::ValueRange{});
 
     rewriter.eraseOp(assignOp);
     return success();
@@ -295,7 +471,8 @@ struct ArrayElementAssignConversionPattern
   LogicalResult
   matchAndRewrite(AssignArrayElementOp assignOp, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    auto varRefOrNone = findOrCreateGetGlobalMemref(assignOp, rewriter);
+    auto varRefOrNone = findOrCreateGetGlobalMemref(
+        assignOp, assignOp.getVariableNameAttr(), rewriter);
 
     if (!varRefOrNone)
       return failure();
@@ -314,18 +491,112 @@ struct ArrayElementAssignConversionPattern
 };
 } // anonymous namespace
 
+PackedVariableLayout
+mlir::quir::packVariables(mlir::ModuleOp moduleOp,
+                          mlir::TypeConverter &typeConverter,
+                          bool reuseSlots) {
+  PackedVariableLayout layout;
+
+  // collect the static access counts of all variables in a single walk,
+  // where an access weighs 8 times more for each surrounding loop. Variables
+  // referenced by any other op are not packed.
+  llvm::DenseMap<mlir::StringAttr, uint64_t> accessCounts;
+  llvm::DenseSet<mlir::StringAttr> unpackableVariables;
+  llvm::DenseMap<mlir::StringAttr, llvm::SmallVector<mlir::Operation *>>
+      accesses;
+  auto symbolUses = mlir::SymbolTable::getSymbolUses(moduleOp);
+  if (!symbolUses)
+    return layout;
+  for (auto &use : symbolUses.value()) {
+    auto *user = use.getUser();
+    auto variableName = use.getSymbolRef().getRootReference();
+    if (!mlir::isa<VariableLoadOp, VariableAssignOp, CBitAssignBitOp>(user)) {
+      unpackableVariables.insert(variableName);
+      continue;
+    }
+
+    if (reuseSlots)
+      accesses[variableName].push_back(user);
+
+    unsigned loopDepth = 0;
+    for (auto *parentOp = user->getParentOp(); parentOp;
+         parentOp = parentOp->getParentOp())
+      if (mlir::isa<mlir::LoopLikeOpInterface>(parentOp))
+        ++loopDepth;
+    accessCounts[variableName] += uint64_t{1} << (3 * std::min(loopDepth, 20u));
+  }
+
+  // group the packable variables by element type, in declaration order
+  llvm::MapVector<mlir::Type, llvm::SmallVector<DeclareVariableOp>> buffers;
+  for (auto declareOp : moduleOp.getBody()->getOps<DeclareVariableOp>()) {
+    if (declareOp.isInputVariable() || declareOp.isOutputVariable() ||
+        unpackableVariables.contains(declareOp.getSymNameAttr()))
+      continue;
+    auto elementType = typeConverter.convertType(declareOp.getType());
+    if (!elementType)
+      elementType = declareOp.getType();
+    if (!elementType.isIntOrIndexOrFloat())
+      continue;
+    buffers[elementType].push_back(declareOp);
+  }
+
+  mlir::SymbolTable symbolTable(moduleOp);
+  mlir::OpBuilder builder(moduleOp.getContext());
+  for (auto &[elementType, declareOps] : buffers) {
+    // a single variable gains nothing from sharing a buffer
+    if (declareOps.size() < 2)
+      continue;
+
+    auto slots = allocateSlots(declareOps, accesses, reuseSlots);
+
+    // place the frequently accessed slots first
+    auto getAccessCount = [&](llvm::ArrayRef<DeclareVariableOp> slot) {
+      uint64_t count = 0;
+      for (auto declareOp : slot)
+        count += accessCounts.lookup(declareOp.getSymNameAttr());
+      return count;
+    };
+    llvm::stable_sort(slots, [&](const auto &lhs, const auto &rhs) {
+      return getAccessCount(lhs) > getAccessCount(rhs);
+    });
+
+    std::string bufferName = "__quir_packed_variables_";
+    llvm::raw_string_ostream bufferNameStream(bufferName);
+    elementType.print(bufferNameStream);
+
+    auto const bufferType = mlir::MemRefType::get(
+        {static_cast<int64_t>(slots.size())}, elementType);
+    auto bufferOp = builder.create<mlir::memref::GlobalOp>(
+        moduleOp.getLoc(), bufferNameStream.str(),
+        builder.getStringAttr("private"), bufferType,
+        /* no initialization */ builder.getUnitAttr(), /* constant= */ false,
+        builder.getI64IntegerAttr(packedVariableAlignment));
+    // uniquify the name of the buffer, if needed
+    symbolTable.insert(bufferOp, moduleOp.getBody()->begin());
+
+    auto const bufferRef =
+        mlir::FlatSymbolRefAttr::get(bufferOp.getSymNameAttr());
+    for (auto [index, slot] : llvm::enumerate(slots))
+      for (auto declareOp : slot)
+        layout.slots[declareOp.getSymNameAttr()] = {
+            bufferRef, static_cast<int64_t>(index)};
+  }
+
+  return layout;
+}
+
 void mlir::quir::populateVariableToGlobalMemRefConversionPatterns(
     RewritePatternSet &patterns, mlir::TypeConverter &typeConverter,
-    bool externalizeOutputVariables) {
+    bool externalizeOutputVariables, const PackedVariableLayout *layout) {
   auto *ctx = patterns.getContext();
   assert(ctx);
 
   patterns.add<VariableDeclarationConversionPattern>(
-      ctx, typeConverter, externalizeOutputVariables);
+      ctx, typeConverter, externalizeOutputVariables, layout);
+  patterns.add<VariableAssignConversionPattern, VariableUseConversionPattern>(
+      ctx, typeConverter, layout);
   // clang-format off
   patterns.add<
-      VariableAssignConversionPattern,
-      VariableUseConversionPattern,
       ArrayDeclarationConversionPattern,
       ArrayElementUseConversionPattern,
       ArrayElementAssignConversionPattern>(ctx, typeConverter);
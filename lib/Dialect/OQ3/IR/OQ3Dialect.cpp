@@ -14,6 +14,7 @@
 
 #include "Dialect/OQ3/IR/OQ3Dialect.h"
 
+#include "Dialect/DialectBytecode.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
@@ -55,6 +56,11 @@ struct OQ3InlinerInterface : public DialectInlinerInterface {
   }
 };
 
+// Bytecode of the dialect, whose version is to be bumped whenever bytecode
+// written by the previous version no longer parses.
+using OQ3BytecodeInterface =
+    qssc::dialect::VersionedBytecodeInterface</*Version=*/0>;
+
 void OQ3Dialect::initialize() {
 
   addOperations<
@@ -63,5 +69,5 @@ void OQ3Dialect::initialize() {
 #include "Dialect/OQ3/IR/OQ3Ops.cpp.inc"
       >();
 
-  addInterfaces<OQ3InlinerInterface>();
+  addInterfaces<OQ3InlinerInterface, OQ3BytecodeInterface>();
 }
@@ -32,6 +32,9 @@
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/SmallVector.h"
+
 #include <cassert>
 #include <optional>
 
@@ -145,6 +148,90 @@ struct AssignSingleCBitToAssignVariablePattern
     return success();
   }
 };
+
+/// This pattern folds a tree of oq3.cbit_xor of bits extracted from the same
+/// register, e.g., the parity of a syndrome register computed bit by bit,
+/// into the lowest bit of the population count of the register masked with
+/// the bits used, which lowers to a few word-level operations instead of a
+/// shift and a truncation per bit.
+struct CBitParityPattern : public OpRewritePattern<CBitXorOp> {
+  CBitParityPattern(MLIRContext *context)
+      : OpRewritePattern<CBitXorOp>(context, /*benefit=*/1) {}
+
+  LogicalResult
+  matchAndRewrite(CBitXorOp xorOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    if (!xorOp.getType().isInteger(1))
+      return failure();
+
+    // only match the root of the tree
+    for (auto *user : xorOp->getUsers())
+      if (isa<CBitXorOp>(user))
+        return failure();
+
+    mlir::Value registerValue;
+    APInt mask;
+    unsigned numBits = 0;
+    llvm::SmallVector<mlir::Value> worklist{xorOp.getLhs(), xorOp.getRhs()};
+    while (!worklist.empty()) {
+      auto value = worklist.pop_back_val();
+      if (auto innerXorOp = value.getDefiningOp<CBitXorOp>()) {
+        if (!innerXorOp->hasOneUse())
+          return failure();
+        worklist.push_back(innerXorOp.getLhs());
+        worklist.push_back(innerXorOp.getRhs());
+        continue;
+      }
+
+      auto extractBitOp = value.getDefiningOp<CBitExtractBitOp>();
+      if (!extractBitOp)
+        return failure();
+      auto cbitType =
+          extractBitOp.getOperand().getType().dyn_cast<quir::CBitType>();
+      if (!cbitType || cbitType.getWidth() > 64)
+        return failure();
+      if (!registerValue) {
+        registerValue = extractBitOp.getOperand();
+        mask = APInt::getZero(cbitType.getWidth());
+      } else if (registerValue != extractBitOp.getOperand()) {
+        return failure();
+      }
+
+      auto index = extractBitOp.getIndex().getZExtValue();
+      if (index >= mask.getBitWidth())
+        return failure();
+      // a bit used twice cancels out
+      mask.flipBit(index);
+      ++numBits;
+    }
+
+    // a single xor of two bits is cheaper than a population count
+    if (numBits < 3)
+      return failure();
+
+    auto const loc = xorOp.getLoc();
+    if (mask.isZero()) {
+      rewriter.replaceOpWithNewOp<mlir::arith::ConstantIntOp>(xorOp, 0, 1);
+      return success();
+    }
+
+    auto cbitType = registerValue.getType().cast<quir::CBitType>();
+    auto intType = rewriter.getIntegerType(cbitType.getWidth());
+    mlir::Value maskedRegister = registerValue;
+    if (!mask.isAllOnes()) {
+      auto maskOp = rewriter.create<mlir::arith::ConstantOp>(
+          loc, rewriter.getIntegerAttr(intType, mask));
+      auto maskCastOp = rewriter.create<CastOp>(loc, cbitType, maskOp);
+      maskedRegister =
+          rewriter.create<CBitAndOp>(loc, registerValue, maskCastOp);
+    }
+    auto popcountOp =
+        rewriter.create<CBitPopcountOp>(loc, intType, maskedRegister);
+    rewriter.replaceOpWithNewOp<CBitExtractBitOp>(
+        xorOp, rewriter.getI1Type(), popcountOp, rewriter.getIndexAttr(0));
+    return success();
+  }
+}; // struct CBitParityPattern
 } // anonymous namespace
 
 // This pattern is defined by the TableGen DRR in `OQ3Patterns.td`
@@ -153,6 +240,11 @@ void CBitNotOp::getCanonicalizationPatterns(RewritePatternSet &results,
   results.insert<CBitNotNotPat>(context);
 }
 
+void CBitXorOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                            MLIRContext *context) {
+  results.insert<CBitParityPattern>(context);
+}
+
 void CastOp::getCanonicalizationPatterns(RewritePatternSet &results,
                                          MLIRContext *context) {
   results.insert<CastToSameType>(context);
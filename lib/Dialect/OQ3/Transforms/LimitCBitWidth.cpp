@@ -25,6 +25,7 @@
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
@@ -40,64 +41,74 @@
 
 using namespace mlir::oq3;
 
-void LimitCBitWidthPass::addNewDeclareVariableOps(
-    Operation *module, DeclareVariableOp op, uint numRegistersRequired,
-    uint numRemainingBits,
-    llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters,
-    mlir::SymbolTableCollection &symbolTableCol) {
+std::string
+LimitCBitWidthPass::getUniqueVariableName(const std::string &variableName,
+                                          mlir::SymbolTable &symbolTable) {
+  auto isTaken = [&](llvm::StringRef name) {
+    return symbolTable.lookup(name) || newVariableNames_.contains(name);
+  };
+
+  // add additional digits if symbol name is found, resuming from the last
+  // digits tried for this name
+  std::string newVariableName = variableName;
+  if (isTaken(newVariableName)) {
+    uint &extraInt = nextSuffix_[variableName];
+    do {
+      newVariableName = variableName + std::to_string(extraInt++);
+    } while (isTaken(newVariableName));
+  }
+  newVariableNames_.insert(newVariableName);
+  return newVariableName;
+}
+
+LimitCBitWidthPass::SplitRegisters
+LimitCBitWidthPass::addNewDeclareVariableOps(DeclareVariableOp op,
+                                             mlir::SymbolTable &symbolTable) {
   auto variableName = op.getSymName();
+  uint const width = op.getType().cast<quir::CBitType>().getWidth();
+  uint const numRegistersRequired =
+      (width + MAX_CBIT_WIDTH - 1) / MAX_CBIT_WIDTH;
+  uint const numRemainingBits =
+      width - (numRegistersRequired - 1) * MAX_CBIT_WIDTH;
 
   // create new registers with _# added to end
-  // add additional "_" if symbol name is found
   OpBuilder builder(op);
-  newRegisters.clear();
+  SplitRegisters newRegisters;
   for (uint regNum = 0; regNum < numRegistersRequired; regNum++) {
-    std::string newVariableName =
-        variableName.str() + "_" + std::to_string(regNum);
-    auto *findOp =
-        symbolTableCol.getSymbolTable(module).lookup(newVariableName);
-    if (findOp) {
-      uint extraInt = 0;
-      std::string const baseVariableName = newVariableName;
-      while (findOp) {
-        newVariableName = baseVariableName + std::to_string(extraInt++);
-        findOp = symbolTableCol.getSymbolTable(module).lookup(newVariableName);
-      }
-    }
+    std::string const newVariableName = getUniqueVariableName(
+        variableName.str() + "_" + std::to_string(regNum), symbolTable);
 
     uint const bitWidth =
         getNewRegisterWidth(regNum, numRegistersRequired, numRemainingBits);
     auto newCbitType = builder.getType<mlir::quir::CBitType>(bitWidth);
-    newRegisters.push_back(builder.create<DeclareVariableOp>(
-        op->getLoc(), newVariableName, mlir::TypeAttr::get(newCbitType)));
+    builder.create<DeclareVariableOp>(op->getLoc(), newVariableName,
+                                      mlir::TypeAttr::get(newCbitType));
+    newRegisters.names.push_back(
+        mlir::FlatSymbolRefAttr::get(builder.getContext(), newVariableName));
+    newRegisters.types.push_back(newCbitType);
   }
+  return newRegisters;
 }
 
-void LimitCBitWidthPass::processOp(
-    CBitAssignBitOp cbitAssignOp, uint numRegistersRequired,
-    uint numRemainingBits,
-    llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters) {
+void LimitCBitWidthPass::processOp(CBitAssignBitOp cbitAssignOp,
+                                   const SplitRegisters &newRegisters) {
   uint64_t index;
   uint64_t reg;
   std::tie(reg, index) = remapBit(cbitAssignOp.getIndex());
-  auto width =
-      newRegisters[reg].getType().dyn_cast<quir::CBitType>().getWidth();
+  auto width = newRegisters.types[reg].getWidth();
   auto value = cbitAssignOp.getAssignedBit();
 
   OpBuilder builder(cbitAssignOp);
   builder.create<CBitAssignBitOp>(
-      cbitAssignOp->getLoc(),
-      mlir::SymbolRefAttr::get(
-          builder.getStringAttr(newRegisters[reg].getSymName())),
+      cbitAssignOp->getLoc(), newRegisters.names[reg],
       builder.getIndexAttr(index), builder.getIndexAttr(width), value);
 
   eraseList_.push_back(cbitAssignOp);
 }
 
-void LimitCBitWidthPass::processOp(
-    VariableAssignOp variableAssignOp, uint orgWidth, uint numRegistersRequired,
-    uint numRemainingBits,
-    llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters) {
+void LimitCBitWidthPass::processOp(VariableAssignOp variableAssignOp,
+                                   uint orgWidth,
+                                   const SplitRegisters &newRegisters) {
   auto castOp = dyn_cast<oq3::CastOp>(
       variableAssignOp.getAssignedValue().getDefiningOp());
   if (!castOp) {
@@ -126,49 +137,40 @@ void LimitCBitWidthPass::processOp(
 
   APInt const apInt = intAttr.getValue();
 
-  for (uint regNum = 0; regNum < numRegistersRequired; regNum++) {
-    uint const bitWidth =
-        getNewRegisterWidth(regNum, numRegistersRequired, numRemainingBits);
+  for (uint regNum = 0; regNum < newRegisters.size(); regNum++) {
+    uint const bitWidth = newRegisters.types[regNum].getWidth();
     auto subPart = apInt.extractBits(bitWidth, regNum * MAX_CBIT_WIDTH);
     auto initializerVal = builder.create<mlir::arith::ConstantOp>(
         constantOp->getLoc(),
         builder.getIntegerAttr(builder.getIntegerType(bitWidth), subPart));
 
     auto newCastOp = builder.create<mlir::oq3::CastOp>(
-        constantOp->getLoc(), builder.getType<mlir::quir::CBitType>(bitWidth),
-        initializerVal);
+        constantOp->getLoc(), newRegisters.types[regNum], initializerVal);
 
     builder.create<VariableAssignOp>(variableAssignOp->getLoc(),
-                                     newRegisters[regNum].getSymName(),
-                                     newCastOp);
+                                     newRegisters.names[regNum], newCastOp);
   }
   eraseList_.push_back(variableAssignOp);
 }
 
-void LimitCBitWidthPass::processOp(
-    VariableLoadOp variableLoadOp, uint numRegistersRequired,
-    uint numRemainingBits,
-    llvm::SmallVector<mlir::oq3::DeclareVariableOp> &newRegisters) {
-  // load all of the registers
-  llvm::SmallVector<VariableLoadOp> newVariableLoads;
+void LimitCBitWidthPass::processOp(VariableLoadOp variableLoadOp,
+                                   const SplitRegisters &newRegisters) {
+  // only load the registers holding the bits extracted
+  llvm::SmallVector<VariableLoadOp> newVariableLoads(newRegisters.size());
   OpBuilder builder(variableLoadOp);
-  for (uint regNum = 0; regNum < numRegistersRequired; regNum++) {
-    uint const bitWidth =
-        getNewRegisterWidth(regNum, numRegistersRequired, numRemainingBits);
-    newVariableLoads.push_back(builder.create<VariableLoadOp>(
-        variableLoadOp.getLoc(),
-        builder.getType<mlir::quir::CBitType>(bitWidth),
-        newRegisters[regNum].getSymName()));
-  }
-
   for (auto *loadUse : variableLoadOp->getUsers()) {
     auto extractBitOp = dyn_cast<CBitExtractBitOp>(loadUse);
     if (extractBitOp) {
       uint64_t reg;
       uint64_t remain;
       std::tie(reg, remain) = remapBit(extractBitOp.getIndex());
+      auto &newVariableLoad = newVariableLoads[reg];
+      if (!newVariableLoad)
+        newVariableLoad = builder.create<VariableLoadOp>(
+            variableLoadOp.getLoc(), newRegisters.types[reg],
+            newRegisters.names[reg]);
       auto newExtract = builder.create<CBitExtractBitOp>(
-          extractBitOp->getLoc(), builder.getI1Type(), newVariableLoads[reg],
+          extractBitOp->getLoc(), builder.getI1Type(), newVariableLoad,
           builder.getIndexAttr(remain));
       extractBitOp->replaceAllUsesWith(newExtract);
       eraseList_.push_back(extractBitOp);
@@ -200,6 +202,8 @@ uint LimitCBitWidthPass::getNewRegisterWidth(uint regNum,
 void LimitCBitWidthPass::runOnOperation() {
 
   eraseList_.clear();
+  newVariableNames_.clear();
+  nextSuffix_.clear();
 
   // check for command line override of MAX_CBIT_WIDTH
   if (maxCBitWidthOption.hasValue())
@@ -207,42 +211,48 @@ void LimitCBitWidthPass::runOnOperation() {
 
   Operation *module = getOperation();
 
-  mlir::SymbolTableCollection symbolTableCol;
-
+  // look for declare variables of CBitType and Width > MAX_CBIT_WIDTH
+  llvm::SmallVector<DeclareVariableOp> wideVariables;
   module->walk([&](DeclareVariableOp op) {
-    // look for declare variables of CBitType and Width > 64
     auto cbitType = op.getType().dyn_cast<quir::CBitType>();
-    if (!cbitType || cbitType.getWidth() <= MAX_CBIT_WIDTH)
-      return;
-
-    uint const orgWidth = cbitType.getWidth();
-    uint const numRegistersRequired = cbitType.getWidth() / MAX_CBIT_WIDTH + 1;
-    uint const numRemainingBits = cbitType.getWidth() % MAX_CBIT_WIDTH;
-    llvm::SmallVector<mlir::oq3::DeclareVariableOp> newRegisters;
-
-    addNewDeclareVariableOps(module, op, numRegistersRequired, numRemainingBits,
-                             newRegisters, symbolTableCol);
-
-    if (auto rangeOrNone = SymbolTable::getSymbolUses(op, module))
-      for (auto &use : rangeOrNone.value()) {
-        auto *user = use.getUser();
-        if (auto variableAssignOp = dyn_cast<VariableAssignOp>(user))
-          processOp(variableAssignOp, orgWidth, numRegistersRequired,
-                    numRemainingBits, newRegisters);
-        else if (auto cbitAssignOp = dyn_cast<CBitAssignBitOp>(user))
-          processOp(cbitAssignOp, numRegistersRequired, numRemainingBits,
-                    newRegisters);
-        else if (auto variableLoadOp = dyn_cast<VariableLoadOp>(user))
-          processOp(variableLoadOp, numRegistersRequired, numRemainingBits,
-                    newRegisters);
-        else {
-          llvm::errs() << "Unhandled use type: ";
-          use.getUser()->dump();
-          assert(false);
-        }
+    if (cbitType && cbitType.getWidth() > MAX_CBIT_WIDTH)
+      wideVariables.push_back(op);
+  });
+  if (wideVariables.empty())
+    return;
+
+  // bucket the uses of the wide variables in a single walk of the module
+  llvm::DenseMap<mlir::StringAttr, llvm::SmallVector<Operation *>> users;
+  for (auto op : wideVariables)
+    users[op.getSymNameAttr()];
+  if (auto uses = SymbolTable::getSymbolUses(module))
+    for (auto &use : uses.value()) {
+      auto search = users.find(use.getSymbolRef().getRootReference());
+      if (search != users.end())
+        search->second.push_back(use.getUser());
+    }
+
+  mlir::SymbolTable symbolTable(module);
+
+  for (auto op : wideVariables) {
+    uint const orgWidth = op.getType().cast<quir::CBitType>().getWidth();
+    auto newRegisters = addNewDeclareVariableOps(op, symbolTable);
+
+    for (auto *user : users[op.getSymNameAttr()]) {
+      if (auto variableAssignOp = dyn_cast<VariableAssignOp>(user))
+        processOp(variableAssignOp, orgWidth, newRegisters);
+      else if (auto cbitAssignOp = dyn_cast<CBitAssignBitOp>(user))
+        processOp(cbitAssignOp, newRegisters);
+      else if (auto variableLoadOp = dyn_cast<VariableLoadOp>(user))
+        processOp(variableLoadOp, newRegisters);
+      else {
+        llvm::errs() << "Unhandled use type: ";
+        user->dump();
+        assert(false);
       }
+    }
     eraseList_.push_back(op);
-  });
+  }
 
   for (auto *op : eraseList_) {
     assert(op->use_empty() && "operation usage expected to be empty");
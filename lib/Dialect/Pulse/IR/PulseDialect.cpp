@@ -20,6 +20,7 @@
 
 #include "Dialect/Pulse/IR/PulseDialect.h"
 
+#include "Dialect/DialectBytecode.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/Pulse/IR/PulseAttributes.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
@@ -41,6 +42,11 @@
 
 namespace mlir::pulse {
 
+// Bytecode of the dialect, whose version is to be bumped whenever bytecode
+// written by the previous version no longer parses.
+using PulseBytecodeInterface =
+    qssc::dialect::VersionedBytecodeInterface</*Version=*/0>;
+
 void pulse::PulseDialect::initialize() {
 
   addTypes<
@@ -60,6 +66,8 @@ void pulse::PulseDialect::initialize() {
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/Pulse/IR/Pulse.cpp.inc"
       >();
+
+  addInterfaces<PulseBytecodeInterface>();
 }
 
 } // namespace mlir::pulse
@@ -21,6 +21,7 @@
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Block.h"
 #include "mlir/IR/Builders.h"
@@ -38,6 +39,10 @@
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
@@ -45,10 +50,14 @@
 #include "llvm/Support/Error.h"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace mlir::pulse {
 
@@ -134,6 +143,18 @@ mlir::LogicalResult CaptureOp::verify() {
   return success();
 }
 
+mlir::LogicalResult MultiplexedCaptureOp::verify() {
+  if ((*this).getTargets().empty())
+    return emitOpError("expects at least one target");
+  if ((*this).getTargets().size() != (*this).getOuts().size())
+    return emitOpError("expects a result for each target");
+  for (auto target : (*this).getTargets())
+    if (!target.isa<BlockArgument>())
+      return emitOpError("Target is not a block argument; Target needs to "
+                         "be an argument of pulse.sequence");
+  return success();
+}
+
 mlir::LogicalResult DelayOp::verify() {
   auto durDeclOp = dyn_cast_or_null<mlir::arith::ConstantIntOp>(
       (*this).getDur().getDefiningOp());
@@ -181,9 +202,97 @@ mlir::LogicalResult Waveform_CreateOp::verify() {
   if (auto err = durOrError.takeError())
     return emitOpError(toString(std::move(err)));
 
+  // Check the size of the samples of a dense resource, if available
+  if (auto resourceSamples = getSamples().dyn_cast<DenseResourceElementsAttr>())
+    if (AsmResourceBlob *blob = resourceSamples.getRawHandle().getBlob()) {
+      auto const numBytes =
+          static_cast<size_t>(resourceSamples.getNumElements()) *
+          (attrType.getElementType().getIntOrFloatBitWidth() / 8);
+      if (blob->getData().size() != numBytes)
+        return emitOpError() << ", which declares a sample waveform, has "
+                             << blob->getData().size()
+                             << " bytes of samples but expects " << numBytes;
+    }
+
   return mlir::success();
 }
 
+double Waveform_CreateOp::getSampleScale() {
+  if (auto scaleAttr = getScaleAttr())
+    return scaleAttr.getValueAsDouble();
+  // i16 codes span the full scale [-1, 1]
+  if (getSamples().getElementType().isSignlessInteger(16))
+    return 1.0 / std::numeric_limits<int16_t>::max();
+  return 1.0;
+}
+
+llvm::Expected<std::vector<double>> Waveform_CreateOp::getSampleValues() {
+  auto samples = getSamples();
+  Type const elementType = samples.getElementType();
+  double const scale = getSampleScale();
+  auto const numElements = static_cast<size_t>(samples.getNumElements());
+
+  std::vector<double> values;
+  values.reserve(numElements);
+  auto toDouble = [](llvm::APFloat value) {
+    bool losesInfo = false;
+    value.convert(llvm::APFloat::IEEEdouble(),
+                  llvm::APFloat::rmNearestTiesToEven, &losesInfo);
+    return value.convertToDouble();
+  };
+
+  if (auto denseSamples = samples.dyn_cast<DenseElementsAttr>()) {
+    if (elementType.isF64())
+      for (double const value : denseSamples.getValues<double>())
+        values.push_back(value * scale);
+    else if (elementType.isF16())
+      for (const auto &value : denseSamples.getValues<llvm::APFloat>())
+        values.push_back(toDouble(value) * scale);
+    else
+      for (int16_t const code : denseSamples.getValues<int16_t>())
+        values.push_back(code * scale);
+    return values;
+  }
+
+  // the samples of a dense resource are stored in the byte order of the host
+  auto resourceSamples = samples.cast<DenseResourceElementsAttr>();
+  AsmResourceBlob *blob = resourceSamples.getRawHandle().getBlob();
+  if (!blob)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "the samples of dense resource " +
+            resourceSamples.getRawHandle().getKey() + " are not available");
+  llvm::ArrayRef<char> const data = blob->getData();
+  size_t const width = elementType.getIntOrFloatBitWidth() / 8;
+  if (data.size() != numElements * width)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "the samples of dense resource " +
+            resourceSamples.getRawHandle().getKey() + " have " +
+            std::to_string(data.size()) + " bytes but expect " +
+            std::to_string(numElements * width));
+
+  for (size_t i = 0; i < numElements; ++i) {
+    const char *element = data.data() + i * width;
+    if (elementType.isF64()) {
+      double value;
+      std::memcpy(&value, element, sizeof(value));
+      values.push_back(value * scale);
+      continue;
+    }
+    uint16_t bits;
+    std::memcpy(&bits, element, sizeof(bits));
+    if (elementType.isF16())
+      values.push_back(
+          toDouble(llvm::APFloat(llvm::APFloat::IEEEhalf(),
+                                 llvm::APInt(16, bits))) *
+          scale);
+    else
+      values.push_back(static_cast<int16_t>(bits) * scale);
+  }
+  return values;
+}
+
 //===----------------------------------------------------------------------===//
 //
 // end Waveform_CreateOp
@@ -593,8 +702,10 @@ llvm::Expected<std::string> PlayOp::getWaveformHash(CallSequenceOp callOp) {
   }
 
   if (wfrOp && targetOp) {
-    auto targetHash = mlir::hash_value(targetOp->getLoc());
-    auto wfrHash = mlir::hash_value(wfrOp->getLoc());
+    // hash the ops rather than their locations, which may be shared by
+    // other ops or stripped
+    auto targetHash = llvm::hash_value(targetOp);
+    auto wfrHash = llvm::hash_value(wfrOp);
     return std::to_string(targetHash) + "_" + std::to_string(wfrHash);
   }
 
@@ -0,0 +1,168 @@
+//===- ApplyRuntimeProfile.cpp - Apply a runtime profile --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass applying the profile of a program measured
+///  by running it on hardware.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/ApplyRuntimeProfile.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Transforms/FeedForwardLatency.h"
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+struct RuntimeProfile {
+  // the measured durations of the sequences in dt, by name
+  std::map<std::string, uint64_t> sequences;
+  // the execution counts of the regions of the conditionals, by location
+  std::map<std::string, std::vector<uint64_t>> branches;
+};
+
+bool fromJSON(const llvm::json::Value &value, RuntimeProfile &profile,
+              llvm::json::Path path) {
+  llvm::json::ObjectMapper mapper(value, path);
+  return mapper && mapper.mapOptional("sequences", profile.sequences) &&
+         mapper.mapOptional("branches", profile.branches);
+}
+
+llvm::Expected<RuntimeProfile> readRuntimeProfile(llvm::StringRef filename) {
+  auto buffer = llvm::MemoryBuffer::getFile(filename, /*IsText=*/true);
+  if (!buffer)
+    return llvm::createStringError(buffer.getError(),
+                                   "Failed to open " + filename);
+  llvm::json::Path::Root root("profile");
+  RuntimeProfile profile;
+  auto json = llvm::json::parse((*buffer)->getBuffer());
+  if (!json)
+    return json.takeError();
+  if (!fromJSON(*json, profile, root))
+    return root.getError();
+  return profile;
+}
+
+/// Swap the then and else regions of ifOp, negating its condition.
+void swapRegions(scf::IfOp ifOp) {
+  OpBuilder builder(ifOp);
+  auto loc = ifOp.getLoc();
+  Value const trueValue =
+      builder.create<arith::ConstantIntOp>(loc, /*value=*/1, /*width=*/1);
+  Value const negated =
+      builder.create<arith::XOrIOp>(loc, ifOp.getCondition(), trueValue);
+  ifOp.getConditionMutable().assign(negated);
+
+  Region thenBody;
+  thenBody.takeBody(ifOp.getThenRegion());
+  ifOp.getThenRegion().takeBody(ifOp.getElseRegion());
+  ifOp.getElseRegion().takeBody(thenBody);
+}
+} // anonymous namespace
+
+void ApplyRuntimeProfilePass::getDependentDialects(
+    DialectRegistry &registry) const {
+  registry.insert<arith::ArithDialect>();
+}
+
+void ApplyRuntimeProfilePass::runOnOperation() {
+  auto profile = readRuntimeProfile(profileFile);
+  if (!profile) {
+    getOperation()->emitError() << "Failed to read the runtime profile: "
+                                << llvm::toString(profile.takeError());
+    signalPassFailure();
+    return;
+  }
+
+  auto *ctx = &getContext();
+  auto i64Type = IntegerType::get(ctx, 64);
+  getOperation()->walk([&](Operation *op) {
+    if (auto sequenceOp = dyn_cast<SequenceOp>(op)) {
+      auto it = profile->sequences.find(sequenceOp.getSymName().str());
+      if (it == profile->sequences.end())
+        return;
+      sequenceOp->setAttr("pulse.measuredDuration",
+                          IntegerAttr::get(i64Type, it->second));
+      ++numSequencesProfiled;
+      return;
+    }
+
+    if (!isa<scf::IfOp, quir::SwitchOp>(op))
+      return;
+    auto it = profile->branches.find(printConditionalLocation(op->getLoc()));
+    if (it == profile->branches.end())
+      return;
+    auto const &counts = it->second;
+    if (counts.size() != op->getNumRegions()) {
+      op->emitWarning() << "runtime profile has " << counts.size()
+                        << " branch counts for " << op->getNumRegions()
+                        << " regions, ignoring them";
+      return;
+    }
+
+    llvm::SmallVector<int64_t> branchCounts(counts.begin(), counts.end());
+    auto ifOp = dyn_cast<scf::IfOp>(op);
+    if (ifOp && !ifOp.getElseRegion().empty() &&
+        branchCounts[1] > branchCounts[0]) {
+      swapRegions(ifOp);
+      std::swap(branchCounts[0], branchCounts[1]);
+      ++numBranchesSwapped;
+    }
+    op->setAttr(quir::getBranchCountsAttrName(),
+                DenseI64ArrayAttr::get(ctx, branchCounts));
+    ++numBranchesProfiled;
+  });
+} // runOnOperation
+
+llvm::StringRef ApplyRuntimeProfilePass::getArgument() const {
+  return "pulse-apply-runtime-profile";
+}
+
+llvm::StringRef ApplyRuntimeProfilePass::getDescription() const {
+  return "Apply the sequence durations and branch counts measured by running "
+         "the program on hardware";
+}
+
+llvm::StringRef ApplyRuntimeProfilePass::getName() const {
+  return "Apply Runtime Profile Pass";
+}
@@ -21,8 +21,8 @@
 
 #include "Dialect/Pulse/Transforms/ClassicalOnlyDetection.h"
 
-#include "Dialect/Pulse/IR/PulseDialect.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/ClassicalOnlyAnalysis.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -30,7 +30,6 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Operation.h"
-#include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
 
 #include "llvm/ADT/StringRef.h"
@@ -41,38 +40,29 @@ using namespace mlir::pulse;
 
 namespace mlir::pulse {
 
-// detects whether or not an operation contains pulse operations inside
-auto ClassicalOnlyDetectionPass::hasPulseSubOps(Operation *inOp) -> bool {
-  bool retVal = false;
-  inOp->walk([&](Operation *op) {
-    if (llvm::isa<pulse::PulseDialect>(op->getDialect())) {
-      retVal = true;
-      return WalkResult::interrupt();
-    }
-    return WalkResult::advance();
-  });
-  return retVal;
-} // ClassicalOnlyDetectionPass::hasPulseSubOps
-
 // Entry point for the ClassicalOnlyDetectionPass pass
 void ClassicalOnlyDetectionPass::runOnOperation() {
   // This pass is only called on the top-level module Op
   Operation *moduleOperation = getOperation();
   OpBuilder b(moduleOperation);
+  auto &classicalOnlyAnalysis = getAnalysis<ClassicalOnlyAnalysis>();
 
   moduleOperation->walk([&](Operation *op) {
-    if (dyn_cast<scf::IfOp>(op) || dyn_cast<scf::ForOp>(op) ||
-        dyn_cast<quir::SwitchOp>(op) || dyn_cast<SequenceOp>(op) ||
-        dyn_cast<mlir::func::FuncOp>(op)) {
+    if (isa<scf::IfOp, scf::ForOp, quir::SwitchOp, SequenceOp,
+            mlir::func::FuncOp>(op)) {
       // check for a pre-existing classicalOnly attribute
       // only update if the attribute does not exist or it is true
       // indicating that no quantum ops have been identified yet
       auto attrName = llvm::StringRef("quir.classicalOnly");
       auto classicalOnlyAttr = op->getAttrOfType<BoolAttr>(attrName);
       if (!classicalOnlyAttr || classicalOnlyAttr.getValue())
-        op->setAttr(attrName, b.getBoolAttr(!hasPulseSubOps(op)));
+        op->setAttr(attrName,
+                    b.getBoolAttr(!classicalOnlyAnalysis.hasPulseOps(op)));
     }
   });
+
+  // only attributes were set
+  markAnalysesPreserved<ClassicalOnlyAnalysis>();
 } // ClassicalOnlyDetectionPass::runOnOperation
 
 llvm::StringRef ClassicalOnlyDetectionPass::getArgument() const {
@@ -0,0 +1,233 @@
+//===- CoalesceDelays.cpp - Coalesce delays on the same targets -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for coalescing the quir.delay,
+///  qcs.delay_cycles and pulse.delay ops on the same targets which are
+///  separated by operations on other targets.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/CoalesceDelays.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::pulse;
+using mlir::quir::QubitOpInterface;
+using mlir::quir::QubitSet;
+
+namespace {
+/// Erase the constant defining a duration which is no longer used.
+void eraseIfUnused(Value duration) {
+  Operation *definingOp = duration.getDefiningOp();
+  if (definingOp && definingOp->use_empty() &&
+      definingOp->hasTrait<OpTrait::ConstantLike>())
+    definingOp->erase();
+}
+
+bool haveSameQubits(ValueRange lhs, ValueRange rhs) {
+  if (lhs.size() != rhs.size())
+    return false;
+  llvm::SmallPtrSet<void *, 4> lhsQubits;
+  for (Value const qubit : lhs)
+    lhsQubits.insert(qubit.getAsOpaquePointer());
+  return llvm::all_of(rhs, [&](Value qubit) {
+    return lhsQubits.contains(qubit.getAsOpaquePointer());
+  });
+}
+
+/// Merge next into first if both have constant durations of the same type.
+bool mergeInto(quir::DelayOp first, quir::DelayOp next) {
+  if (first.getTime().getType() != next.getTime().getType() ||
+      !haveSameQubits(first.getQubits(), next.getQubits()))
+    return false;
+  auto firstConstant = first.getTime().getDefiningOp<quir::ConstantOp>();
+  auto nextConstant = next.getTime().getDefiningOp<quir::ConstantOp>();
+  if (!firstConstant || !nextConstant)
+    return false;
+  auto firstDuration = firstConstant.getValue().dyn_cast<quir::DurationAttr>();
+  auto nextDuration = nextConstant.getValue().dyn_cast<quir::DurationAttr>();
+  if (!firstDuration || !nextDuration)
+    return false;
+
+  llvm::APFloat sum = firstDuration.getDuration();
+  sum.add(nextDuration.getDuration(), llvm::APFloat::rmNearestTiesToEven);
+  OpBuilder builder(first);
+  auto sumConstant = builder.create<quir::ConstantOp>(
+      first->getLoc(),
+      quir::DurationAttr::get(builder.getContext(), firstDuration.getType(),
+                              sum));
+  Value const firstTime = first.getTime();
+  Value const nextTime = next.getTime();
+  first.getTimeMutable().assign(sumConstant.getResult());
+  next->erase();
+  eraseIfUnused(firstTime);
+  eraseIfUnused(nextTime);
+  return true;
+}
+
+bool mergeInto(qcs::DelayCyclesOp first, qcs::DelayCyclesOp next) {
+  if (!haveSameQubits(first.getQubits(), next.getQubits()))
+    return false;
+  first.setTime(first.getTime() + next.getTime());
+  next->erase();
+  return true;
+}
+
+bool mergeInto(DelayOp first, DelayOp next) {
+  if (first.getTarget() != next.getTarget() ||
+      first.getDur().getType() != next.getDur().getType())
+    return false;
+  llvm::APInt firstDuration;
+  llvm::APInt nextDuration;
+  if (!matchPattern(first.getDur(), m_ConstantInt(&firstDuration)) ||
+      !matchPattern(next.getDur(), m_ConstantInt(&nextDuration)))
+    return false;
+
+  OpBuilder builder(first);
+  auto sumConstant = builder.create<arith::ConstantOp>(
+      first->getLoc(),
+      builder.getIntegerAttr(first.getDur().getType(),
+                             firstDuration + nextDuration));
+  Value const firstDur = first.getDur();
+  Value const nextDur = next.getDur();
+  first.getDurMutable().assign(sumConstant.getResult());
+  next->erase();
+  eraseIfUnused(firstDur);
+  eraseIfUnused(nextDur);
+  return true;
+}
+
+/// Whether op, or an operation nested in it, may operate on the qubits of a
+/// quir.delay or qcs.delay_cycles, all qubits if there are none.
+bool operatesOnQubits(Operation *op, const QubitSet &qubits) {
+  return op
+      ->walk([&](Operation *nested) {
+        if (isa<quir::BarrierOp, qcs::SynchronizeOp>(nested))
+          return WalkResult::interrupt();
+        if (auto qubitOp = dyn_cast<QubitOpInterface>(nested)) {
+          QubitSet const operated = qubitOp.getOperatedQubits();
+          // delays of all qubits
+          if (isa<quir::DelayOp, qcs::DelayCyclesOp>(nested) &&
+              operated.empty())
+            return WalkResult::interrupt();
+          if (qubits.empty() ? !operated.empty() : operated.overlaps(qubits))
+            return WalkResult::interrupt();
+        } else if (isa<CallOpInterface>(nested)) {
+          return WalkResult::interrupt();
+        }
+        return WalkResult::advance();
+      })
+      .wasInterrupted();
+}
+
+/// Whether op, or an operation nested in it, may operate on the frame of a
+/// pulse.delay, i.e., an argument of its sequence.
+bool operatesOnFrame(Operation *op, DelayOp delayOp) {
+  Value const target = delayOp.getTarget();
+  return op
+      ->walk([&](Operation *nested) {
+        if (isa<BarrierOp>(nested) ||
+            llvm::is_contained(nested->getOperands(), target))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      })
+      .wasInterrupted();
+}
+
+bool operatesOnTargets(Operation *op, Operation *delayOp) {
+  if (op->hasTrait<OpTrait::IsTerminator>())
+    return true;
+  if (auto pulseDelayOp = dyn_cast<DelayOp>(delayOp))
+    return operatesOnFrame(op, pulseDelayOp);
+  return operatesOnQubits(op,
+                          QubitOpInterface::getOperatedQubits(delayOp));
+}
+
+bool mergeInto(Operation *first, Operation *next) {
+  if (first->getName() != next->getName())
+    return false;
+  if (auto delayOp = dyn_cast<quir::DelayOp>(first))
+    return mergeInto(delayOp, cast<quir::DelayOp>(next));
+  if (auto delayCyclesOp = dyn_cast<qcs::DelayCyclesOp>(first))
+    return mergeInto(delayCyclesOp, cast<qcs::DelayCyclesOp>(next));
+  return mergeInto(cast<DelayOp>(first), cast<DelayOp>(next));
+}
+} // anonymous namespace
+
+void CoalesceDelaysPass::runOnOperation() {
+  llvm::SmallVector<Block *> blocks;
+  getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+
+  for (Block *block : blocks) {
+    for (Operation *op = block->empty() ? nullptr : &block->front(); op;
+         op = op->getNextNode()) {
+      if (!isa<quir::DelayOp, qcs::DelayCyclesOp, DelayOp>(op))
+        continue;
+
+      // Merge the later delays on the same targets into this one until an
+      // operation on its targets. Only constants before next are erased.
+      Operation *next = op->getNextNode();
+      while (next) {
+        Operation *following = next->getNextNode();
+        if (mergeInto(op, next)) {
+          ++numDelaysCoalesced;
+        } else if (operatesOnTargets(next, op)) {
+          break;
+        }
+        next = following;
+      }
+    }
+  }
+} // runOnOperation
+
+llvm::StringRef CoalesceDelaysPass::getArgument() const {
+  return "coalesce-delays";
+}
+
+llvm::StringRef CoalesceDelaysPass::getDescription() const {
+  return "Coalesce the quir.delay, qcs.delay_cycles and pulse.delay ops on the "
+         "same targets across operations on other targets";
+}
+
+llvm::StringRef CoalesceDelaysPass::getName() const {
+  return "Coalesce Delays Pass";
+}
@@ -0,0 +1,184 @@
+//===- DeduplicateWaveforms.cpp - Share identical waveforms -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for sharing a single definition between
+///  waveforms with identical contents.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/DeduplicateWaveforms.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+
+#include <cstdint>
+#include <vector>
+
+#define DEBUG_TYPE "DeduplicateWaveforms"
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+
+/// The contents of a waveform op: its name, result type, samples and scale
+/// attributes and operands, where constant operands are replaced by their
+/// value. Attributes and types are uniqued by the context, so contents are
+/// compared and hashed by pointer without looking at the samples. Samples in
+/// distinct dense resources are distinct.
+struct WaveformContents {
+  OperationName name;
+  Type type;
+  Attribute samples;
+  Attribute scale;
+  llvm::SmallVector<const void *, 4> operands;
+
+  bool operator==(const WaveformContents &other) const {
+    return name == other.name && type == other.type &&
+           samples == other.samples && scale == other.scale &&
+           operands == other.operands;
+  }
+};
+
+struct WaveformContentsInfo {
+  static WaveformContents getEmptyKey() {
+    return {llvm::DenseMapInfo<OperationName>::getEmptyKey(), {}, {}, {}, {}};
+  }
+  static WaveformContents getTombstoneKey() {
+    return {
+        llvm::DenseMapInfo<OperationName>::getTombstoneKey(), {}, {}, {}, {}};
+  }
+  static unsigned getHashValue(const WaveformContents &contents) {
+    return llvm::hash_combine(
+        contents.name, contents.type, contents.samples, contents.scale,
+        llvm::hash_combine_range(contents.operands.begin(),
+                                 contents.operands.end()));
+  }
+  static bool isEqual(const WaveformContents &lhs,
+                      const WaveformContents &rhs) {
+    return lhs == rhs;
+  }
+};
+
+bool isWaveformOp(Operation *op) {
+  return isa<Waveform_CreateOp, GaussianOp, GaussianSquareOp, DragOp,
+             ConstOp, Kernel_CreateOp>(op);
+}
+
+WaveformContents getContents(Operation *op) {
+  WaveformContents contents{
+      op->getName(), op->getResult(0).getType(), {}, {}, {}};
+  if (auto createOp = dyn_cast<Waveform_CreateOp>(op)) {
+    contents.samples = createOp.getSamples();
+    contents.scale = createOp.getScaleAttr();
+  }
+  for (auto operand : op->getOperands()) {
+    Attribute value;
+    if (matchPattern(operand, m_Constant(&value)))
+      contents.operands.push_back(value.getAsOpaquePointer());
+    else
+      contents.operands.push_back(operand.getAsOpaquePointer());
+  }
+  return contents;
+}
+
+/// The number of bytes of the samples of the waveform, if known before
+/// the waveform is generated.
+uint64_t getSampleBytes(Operation *op) {
+  if (auto createOp = dyn_cast<Waveform_CreateOp>(op)) {
+    auto samples = createOp.getSamples();
+    return samples.getNumElements() *
+           samples.getElementType().getIntOrFloatBitWidth() / 8;
+  }
+  // parametric waveforms have the duration as first operand, and complex
+  // double samples
+  APInt duration;
+  if (op->getNumOperands() &&
+      matchPattern(op->getOperand(0), m_ConstantInt(&duration)))
+    return duration.getZExtValue() * 2 * sizeof(double);
+  return 0;
+}
+
+} // anonymous namespace
+
+void DeduplicateWaveformsPass::runOnOperation() {
+  auto &dominance = getAnalysis<DominanceInfo>();
+
+  // the waveforms defined so far for each contents, in pre-order so that an
+  // op is visited after all the ops that may dominate it
+  llvm::DenseMap<WaveformContents, llvm::SmallVector<Operation *, 1>,
+                 WaveformContentsInfo>
+      definitions;
+  std::vector<Operation *> duplicates;
+
+  getOperation()->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (isa<WaveformContainerOp>(op))
+      return WalkResult::skip();
+    if (!isWaveformOp(op))
+      return WalkResult::advance();
+
+    auto &candidates = definitions[getContents(op)];
+    for (Operation *definition : candidates) {
+      if (!dominance.properlyDominates(definition, op))
+        continue;
+      LLVM_DEBUG(llvm::dbgs() << "replacing " << *op << " with "
+                              << *definition << "\n");
+      op->getResult(0).replaceAllUsesWith(definition->getResult(0));
+      duplicates.push_back(op);
+      if (isa<Kernel_CreateOp>(op)) {
+        ++numKernelsDeduplicated;
+      } else {
+        ++numWaveformsDeduplicated;
+        numSampleBytesSaved += getSampleBytes(op);
+      }
+      return WalkResult::advance();
+    }
+    candidates.push_back(op);
+    return WalkResult::advance();
+  });
+
+  for (auto *op : duplicates)
+    op->erase();
+
+  if (duplicates.empty())
+    markAllAnalysesPreserved();
+}
+
+llvm::StringRef DeduplicateWaveformsPass::getArgument() const {
+  return "pulse-deduplicate-waveforms";
+}
+
+llvm::StringRef DeduplicateWaveformsPass::getDescription() const {
+  return "Share a single definition between waveforms with identical samples "
+         "or parameters";
+}
+
+llvm::StringRef DeduplicateWaveformsPass::getName() const {
+  return "Deduplicate Waveforms Pass";
+}
@@ -0,0 +1,97 @@
+//===- EliminateBarriers.cpp - Erase and narrow pulse barriers --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass erasing the pulse barriers which do not
+///  constrain the operations after them and narrowing the others.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/EliminateBarriers.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/IR/PulseTypes.h"
+#include "Dialect/QUIR/Utils/BarrierElimination.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <optional>
+
+using namespace mlir;
+using namespace mlir::pulse;
+using mlir::quir::Alignment;
+
+namespace {
+bool isFrame(Value value) {
+  return value.getType().isa<FrameType, MixedFrameType>();
+}
+
+std::optional<llvm::SmallVector<Value, 4>> getUsedFrames(Operation *op) {
+  // the end of the sequence
+  if (op->hasTrait<OpTrait::IsTerminator>())
+    return std::nullopt;
+  llvm::SmallVector<Value, 4> frames;
+  op->walk([&](Operation *nested) {
+    for (Value const operand : nested->getOperands())
+      if (isFrame(operand) && !llvm::is_contained(frames, operand))
+        frames.push_back(operand);
+  });
+  return frames;
+}
+
+std::optional<Alignment<Value>> getAlignment(Operation *op) {
+  auto barrierOp = dyn_cast<BarrierOp>(op);
+  if (!barrierOp)
+    return std::nullopt;
+  Alignment<Value> alignment;
+  alignment.resources.append(barrierOp.getFrames().begin(),
+                             barrierOp.getFrames().end());
+  return alignment;
+}
+} // anonymous namespace
+
+void EliminateBarriersPass::runOnOperation() {
+  llvm::SetVector<Block *> blocks;
+  getOperation()->walk(
+      [&](BarrierOp barrierOp) { blocks.insert(barrierOp->getBlock()); });
+
+  quir::BarrierModel<Value> const model{getUsedFrames, getAlignment};
+  for (Block *block : blocks) {
+    auto statistics = quir::eliminateBarriers<BarrierOp>(*block, model);
+    numBarriersErased += statistics.numErased;
+    numBarriersNarrowed += statistics.numNarrowed;
+  }
+} // EliminateBarriersPass::runOnOperation
+
+llvm::StringRef EliminateBarriersPass::getArgument() const {
+  return "pulse-eliminate-barriers";
+}
+
+llvm::StringRef EliminateBarriersPass::getDescription() const {
+  return "Erase the pulse barriers which do not delay any operation and "
+         "narrow the others to the frames they delay";
+}
+
+llvm::StringRef EliminateBarriersPass::getName() const {
+  return "Eliminate Pulse Barriers Pass";
+}
@@ -0,0 +1,318 @@
+//===- FeedForwardLatency.cpp - Report feed-forward latencies ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass reporting the latency from the measurements
+///  to the conditionals depending on them.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/FeedForwardLatency.h"
+
+#include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/SequenceDurationAnalysis.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/FunctionInterfaces.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+/// The latency of the sequences called in a range of operations, which is
+/// not exact if the calls are nested in control flow or lack a duration.
+struct Latency {
+  uint64_t duration = 0;
+  bool exact = true;
+};
+
+class FeedForwardLatencyAnalyzer {
+public:
+  FeedForwardLatencyAnalyzer(SequenceDurationAnalysis &sequenceDurations,
+                             uint64_t hopLatency)
+      : sequenceDurations(sequenceDurations), hopLatency(hopLatency) {}
+
+  /// Get the report of conditionalOp, or none if its condition does not
+  /// depend on a measurement.
+  std::optional<llvm::json::Object> analyze(Operation *conditionalOp,
+                                            Value condition);
+
+private:
+  /// Collect the measurements and receives value depends on. Return false if
+  /// a dependency could not be followed, e.g., through a block argument.
+  bool collectSources(Value value, llvm::SmallVectorImpl<Operation *> &sources);
+
+  /// Add the latency of the operations in [begin, end) of a block.
+  void addLatency(Block::iterator begin, Block::iterator end,
+                  Latency &latency);
+
+  /// Get the latency from the end of sourceOp to the start of conditionalOp,
+  /// or none if sourceOp does not run before conditionalOp in the same
+  /// iteration, i.e., when it is carried by a loop.
+  std::optional<Latency> getLatency(Operation *sourceOp,
+                                    Operation *conditionalOp);
+
+  SequenceDurationAnalysis &sequenceDurations;
+  uint64_t hopLatency;
+};
+
+/// Whether op is a measurement or receives a value from another node.
+bool isSource(Operation *op) {
+  return isa<quir::MeasureOp, CallSequenceOp, qcs::RecvOp>(op);
+}
+
+/// Find the last assignment of the variable loaded by loadOp before it,
+/// within the blocks enclosing loadOp. Return a null op if the variable may
+/// be assigned in between by nested control flow, or is not assigned.
+oq3::VariableAssignOp findAssignment(oq3::VariableLoadOp loadOp) {
+  auto name = loadOp.getVariableNameAttr();
+  for (Operation *op = loadOp; op; op = op->getParentOp()) {
+    for (Operation *prev = op->getPrevNode(); prev;
+         prev = prev->getPrevNode()) {
+      if (auto assignOp = dyn_cast<oq3::VariableAssignOp>(prev))
+        if (assignOp.getVariableNameAttr() == name)
+          return assignOp;
+      if (prev->getNumRegions() == 0)
+        continue;
+      bool const assigns =
+          prev->walk([&](oq3::VariableAssignOp assignOp) {
+                return assignOp.getVariableNameAttr() == name
+                           ? WalkResult::interrupt()
+                           : WalkResult::advance();
+              })
+              .wasInterrupted();
+      if (assigns)
+        return {};
+    }
+    if (isa<FunctionOpInterface>(op))
+      break;
+  }
+  return {};
+}
+
+} // anonymous namespace
+
+std::string mlir::pulse::printConditionalLocation(Location loc) {
+  if (auto fileLoc = loc.dyn_cast<FileLineColLoc>())
+    return llvm::formatv("{0}:{1}:{2}", fileLoc.getFilename().getValue(),
+                         fileLoc.getLine(), fileLoc.getColumn())
+        .str();
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  loc.print(os);
+  return os.str();
+}
+
+bool FeedForwardLatencyAnalyzer::collectSources(
+    Value value, llvm::SmallVectorImpl<Operation *> &sources) {
+  bool followed = true;
+  llvm::SmallVector<Value> worklist{value};
+  llvm::SmallPtrSet<Operation *, 8> visited;
+  while (!worklist.empty()) {
+    Value const current = worklist.pop_back_val();
+    Operation *definingOp = current.getDefiningOp();
+    if (!definingOp) {
+      followed = false;
+      continue;
+    }
+    if (!visited.insert(definingOp).second)
+      continue;
+    if (isSource(definingOp)) {
+      sources.push_back(definingOp);
+      continue;
+    }
+    if (auto loadOp = dyn_cast<oq3::VariableLoadOp>(definingOp)) {
+      if (auto assignOp = findAssignment(loadOp))
+        worklist.push_back(assignOp.getAssignedValue());
+      else
+        followed = false;
+      continue;
+    }
+    // values yielded by nested control flow are not followed
+    if (definingOp->getNumRegions() != 0)
+      followed = false;
+    worklist.append(definingOp->operand_begin(), definingOp->operand_end());
+  }
+  return followed;
+}
+
+void FeedForwardLatencyAnalyzer::addLatency(Block::iterator begin,
+                                            Block::iterator end,
+                                            Latency &latency) {
+  for (Operation &op : llvm::make_range(begin, end)) {
+    op.walk([&](CallSequenceOp callSequenceOp) {
+      if (callSequenceOp != &op)
+        latency.exact = false;
+      auto durOrError = sequenceDurations.getDuration(callSequenceOp);
+      if (auto err = durOrError.takeError()) {
+        llvm::consumeError(std::move(err));
+        latency.exact = false;
+        return;
+      }
+      latency.duration += *durOrError;
+    });
+  }
+}
+
+std::optional<Latency>
+FeedForwardLatencyAnalyzer::getLatency(Operation *sourceOp,
+                                       Operation *conditionalOp) {
+  // the ancestors of sourceOp and conditionalOp in the same block
+  Operation *sourceAncestor = sourceOp;
+  Operation *conditionalAncestor = nullptr;
+  for (; sourceAncestor; sourceAncestor = sourceAncestor->getParentOp()) {
+    if (Block *block = sourceAncestor->getBlock())
+      conditionalAncestor = block->findAncestorOpInBlock(*conditionalOp);
+    if (conditionalAncestor)
+      break;
+  }
+  if (!conditionalAncestor || conditionalAncestor == sourceAncestor ||
+      !sourceAncestor->isBeforeInBlock(conditionalAncestor))
+    return std::nullopt;
+
+  Latency latency;
+  for (Operation *op = sourceOp; op != sourceAncestor; op = op->getParentOp())
+    addLatency(std::next(op->getIterator()), op->getBlock()->end(), latency);
+  addLatency(std::next(sourceAncestor->getIterator()),
+             conditionalAncestor->getIterator(), latency);
+  for (Operation *op = conditionalOp; op != conditionalAncestor;
+       op = op->getParentOp())
+    addLatency(op->getBlock()->begin(), op->getIterator(), latency);
+  return latency;
+}
+
+std::optional<llvm::json::Object>
+FeedForwardLatencyAnalyzer::analyze(Operation *conditionalOp,
+                                    Value condition) {
+  llvm::SmallVector<Operation *> sourceOps;
+  bool exact = collectSources(condition, sourceOps);
+  if (sourceOps.empty())
+    return std::nullopt;
+
+  uint64_t criticalLatency = 0;
+  llvm::json::Array sources;
+  for (Operation *sourceOp : sourceOps) {
+    auto latency = getLatency(sourceOp, conditionalOp);
+    if (!latency) {
+      exact = false;
+      continue;
+    }
+    uint64_t const hops = isa<qcs::RecvOp>(sourceOp) ? 1 : 0;
+    uint64_t const sourceLatency = latency->duration + hops * hopLatency;
+    criticalLatency = std::max(criticalLatency, sourceLatency);
+    exact &= latency->exact;
+
+    llvm::json::Object source{
+        {"op", sourceOp->getName().getStringRef()},
+        {"loc", printConditionalLocation(sourceOp->getLoc())},
+        {"latency", static_cast<int64_t>(sourceLatency)},
+        {"hops", static_cast<int64_t>(hops)},
+        {"exact", latency->exact}};
+    if (auto callSequenceOp = dyn_cast<CallSequenceOp>(sourceOp))
+      source["callee"] = callSequenceOp.getCallee();
+    sources.push_back(std::move(source));
+  }
+  if (sources.empty())
+    return std::nullopt;
+
+  llvm::json::Object report{
+      {"op", conditionalOp->getName().getStringRef()},
+      {"loc", printConditionalLocation(conditionalOp->getLoc())},
+      {"latency", static_cast<int64_t>(criticalLatency)},
+      {"exact", exact},
+      {"sources", std::move(sources)}};
+  if (auto funcOp = conditionalOp->getParentOfType<FunctionOpInterface>())
+    report["function"] = funcOp.getName();
+  if (auto moduleOp = conditionalOp->getParentOfType<ModuleOp>())
+    if (auto nodeId = moduleOp->getAttrOfType<IntegerAttr>("quir.nodeId"))
+      report["nodeId"] = nodeId.getInt();
+  return report;
+}
+
+void FeedForwardLatencyPass::runOnOperation() {
+  auto &sequenceDurations = getAnalysis<SequenceDurationAnalysis>();
+  FeedForwardLatencyAnalyzer analyzer(sequenceDurations, hopLatency);
+
+  llvm::json::Array conditionals;
+  getOperation()->walk([&](Operation *op) {
+    Value condition;
+    if (auto ifOp = dyn_cast<scf::IfOp>(op))
+      condition = ifOp.getCondition();
+    else if (auto switchOp = dyn_cast<quir::SwitchOp>(op))
+      condition = switchOp.getFlag();
+    else
+      return;
+    if (auto report = analyzer.analyze(op, condition)) {
+      conditionals.push_back(std::move(*report));
+      ++numConditionals;
+    }
+  });
+
+  auto err =
+      llvm::writeToOutput(outputFile, [&](llvm::raw_ostream &os) {
+        os << llvm::formatv("{0:2}\n",
+                            llvm::json::Value(llvm::json::Object{
+                                {"conditionals", std::move(conditionals)}}));
+        return llvm::Error::success();
+      });
+  if (err) {
+    getOperation()->emitError()
+        << "Failed to write the feed-forward latency report: "
+        << llvm::toString(std::move(err));
+    signalPassFailure();
+    return;
+  }
+
+  markAllAnalysesPreserved();
+} // runOnOperation
+
+llvm::StringRef FeedForwardLatencyPass::getArgument() const {
+  return "pulse-feed-forward-latency";
+}
+
+llvm::StringRef FeedForwardLatencyPass::getDescription() const {
+  return "Report the latency from the measurements to the conditionals "
+         "depending on them as JSON";
+}
+
+llvm::StringRef FeedForwardLatencyPass::getName() const {
+  return "Feed-Forward Latency Pass";
+}
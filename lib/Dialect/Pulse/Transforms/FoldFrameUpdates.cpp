@@ -0,0 +1,165 @@
+//===- FoldFrameUpdates.cpp - Fold phase and frequency updates --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for folding the chains of phase and
+///  frequency updates of a frame into a single update.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/FoldFrameUpdates.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+/// The property of a frame which an update sets or shifts.
+enum class Property { Phase = 0, Frequency = 1 };
+
+std::optional<Property> getUpdatedProperty(Operation *op) {
+  if (isa<SetPhaseOp, ShiftPhaseOp>(op))
+    return Property::Phase;
+  if (isa<SetFrequencyOp, ShiftFrequencyOp>(op))
+    return Property::Frequency;
+  return std::nullopt;
+}
+
+// all updates have the frame as first and the value as second operand
+Value getFrame(Operation *update) { return update->getOperand(0); }
+Value getValue(Operation *update) { return update->getOperand(1); }
+
+/// Erase the constant defining a value which is no longer used.
+void eraseIfUnused(Value value) {
+  Operation *definingOp = value.getDefiningOp();
+  if (definingOp && definingOp->use_empty() &&
+      definingOp->hasTrait<OpTrait::ConstantLike>())
+    definingOp->erase();
+}
+
+/// Fold update into next, the next update of the same property of its
+/// frame. Returns the update which replaces both, or null if they cannot be
+/// folded.
+Operation *fold(Operation *update, Operation *next, Property property) {
+  if (property == Property::Frequency &&
+      PulseOpSchedulingInterface::getTimepoint(update) !=
+          PulseOpSchedulingInterface::getTimepoint(next))
+    return nullptr;
+
+  Value const updateValue = getValue(update);
+  if (isa<SetPhaseOp, SetFrequencyOp>(next)) {
+    update->erase();
+    eraseIfUnused(updateValue);
+    return next;
+  }
+
+  llvm::APFloat sum(0.0);
+  llvm::APFloat offset(0.0);
+  if (!matchPattern(updateValue, m_ConstantFloat(&sum)) ||
+      !matchPattern(getValue(next), m_ConstantFloat(&offset)))
+    return nullptr;
+  sum.add(offset, llvm::APFloat::rmNearestTiesToEven);
+
+  // a set then a shift is a set, two shifts are a shift
+  OpBuilder builder(next);
+  auto sumConstant = builder.create<arith::ConstantFloatOp>(
+      next->getLoc(), sum, builder.getF64Type());
+  OperationState state(next->getLoc(), update->getName());
+  state.addOperands({getFrame(next), sumConstant.getResult()});
+  state.addAttributes(next->getAttrs());
+  Operation *folded = builder.create(state);
+
+  Value const nextValue = getValue(next);
+  next->erase();
+  update->erase();
+  eraseIfUnused(updateValue);
+  eraseIfUnused(nextValue);
+  return folded;
+}
+
+/// Whether op may observe the frames of the updates before it, or the order
+/// of the updates of other frames.
+bool mayObserveAllFrames(Operation *op) {
+  return op->getNumRegions() || op->hasTrait<OpTrait::IsTerminator>() ||
+         isa<BarrierOp, CallOpInterface>(op);
+}
+} // anonymous namespace
+
+void FoldFrameUpdatesPass::runOnOperation() {
+  llvm::SmallVector<Block *> blocks;
+  getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+
+  for (Block *block : blocks) {
+    // the last update of each property of each frame since the last
+    // operation which may observe the frame
+    llvm::DenseMap<Value, std::array<Operation *, 2>> lastUpdates;
+
+    for (Operation *op = block->empty() ? nullptr : &block->front(); op;
+         op = op->getNextNode()) {
+      if (auto property = getUpdatedProperty(op)) {
+        Operation *&last =
+            lastUpdates[getFrame(op)][static_cast<size_t>(*property)];
+        if (last)
+          if (Operation *folded = fold(last, op, *property)) {
+            ++numUpdatesFolded;
+            op = folded;
+          }
+        last = op;
+        continue;
+      }
+
+      if (mayObserveAllFrames(op)) {
+        lastUpdates.clear();
+        continue;
+      }
+      for (Value const operand : op->getOperands())
+        lastUpdates.erase(operand);
+    }
+  }
+} // runOnOperation
+
+llvm::StringRef FoldFrameUpdatesPass::getArgument() const {
+  return "pulse-fold-frame-updates";
+}
+
+llvm::StringRef FoldFrameUpdatesPass::getDescription() const {
+  return "Fold the chains of phase and frequency updates of a frame into a "
+         "single update";
+}
+
+llvm::StringRef FoldFrameUpdatesPass::getName() const {
+  return "Fold Frame Updates Pass";
+}
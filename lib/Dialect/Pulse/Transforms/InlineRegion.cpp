@@ -24,14 +24,23 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/DialectInterface.h"
 #include "mlir/IR/IRMapping.h"
-#include "mlir/IR/Visitors.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/InliningUtils.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
 namespace mlir::pulse {
 
 class DialectAgnosticInlinerInterface : public InlinerInterface {
@@ -54,40 +63,114 @@ class DialectAgnosticInlinerInterface : public InlinerInterface {
   }
 };
 
+namespace {
+/// The calls of a function to the functions of the module, which are the
+/// calls it inlines.
+struct FunctionCalls {
+  mlir::func::FuncOp function;
+  llvm::SmallVector<std::pair<func::CallOp, mlir::func::FuncOp>> calls;
+  // the length of the longest chain of calls from the function, i.e., 0 if
+  // it calls no function, once computed
+  std::optional<unsigned> height;
+};
+
+/// Compute the height of the function of functionCalls in the call graph,
+/// dropping the recursive calls, i.e., the calls to the functions whose
+/// height is being computed.
+unsigned computeHeight(
+    FunctionCalls &functionCalls,
+    llvm::DenseMap<mlir::func::FuncOp, FunctionCalls *> &functions,
+    llvm::DenseSet<mlir::func::FuncOp> &visiting) {
+  if (functionCalls.height)
+    return *functionCalls.height;
+
+  visiting.insert(functionCalls.function);
+  unsigned height = 0;
+  llvm::erase_if(functionCalls.calls, [&](const auto &call) {
+    if (visiting.contains(call.second))
+      return true;
+    unsigned const calleeHeight =
+        computeHeight(*functions[call.second], functions, visiting);
+    height = std::max(height, calleeHeight + 1);
+    return false;
+  });
+  visiting.erase(functionCalls.function);
+
+  functionCalls.height = height;
+  return height;
+}
+} // anonymous namespace
+
 void InlineRegionPass::runOnOperation() {
 
   auto module = getOperation();
+  SymbolTable symbolTable(module);
+
+  // find the calls of each function through the symbol table of the module
+  std::vector<FunctionCalls> functionCalls;
+  llvm::DenseSet<mlir::func::FuncOp> callees;
+  for (auto function : module.getOps<mlir::func::FuncOp>()) {
+    auto &calls = functionCalls.emplace_back();
+    calls.function = function;
+    for (auto caller : function.getOps<func::CallOp>())
+      if (auto callee =
+              symbolTable.lookup<mlir::func::FuncOp>(caller.getCallee())) {
+        calls.calls.emplace_back(caller, callee);
+        callees.insert(callee);
+      }
+  }
+
+  llvm::DenseMap<mlir::func::FuncOp, FunctionCalls *> functions;
+  for (auto &calls : functionCalls)
+    functions[calls.function] = &calls;
+
+  // Inline the functions bottom-up, so that the callees of a function have
+  // inlined their own callees by the time the function inlines them. The
+  // functions of the same height do not call each other, so they are
+  // inlined in parallel.
+  std::vector<std::vector<FunctionCalls *>> heights;
+  llvm::DenseSet<mlir::func::FuncOp> visiting;
+  for (auto &calls : functionCalls) {
+    unsigned const height = computeHeight(calls, functions, visiting);
+    if (height == 0)
+      continue;
+    if (heights.size() < height)
+      heights.resize(height);
+    heights[height - 1].push_back(&calls);
+  }
 
-  for (auto function :
-       llvm::make_early_inc_range(module.getOps<mlir::func::FuncOp>())) {
-
-    // Build the inliner interface.
-    DialectAgnosticInlinerInterface interface(&getContext());
-
-    for (auto caller :
-         llvm::make_early_inc_range(function.getOps<func::CallOp>())) {
-      auto callee = dyn_cast_or_null<mlir::func::FuncOp>(
-          module.lookupSymbol(caller.getCallee()));
-      if (!callee)
-        continue;
-
-      // Inline the functional region operation, but only clone the internal
-      // region if there is more than one use.
-      if (failed(inlineRegion(interface, &callee.getBody(), caller,
-                              caller.getArgOperands(), caller.getResults(),
-                              caller.getLoc(),
-                              /*shouldCloneInlinedRegion=*/true)))
-        continue;
-
-      // If the inlining was successful then erase the call and callee if
-      // possible.
-      caller->dropAllDefinedValueUses();
-      caller->dropAllReferences();
-      caller.erase();
-      if (callee.use_empty())
-        callee.erase();
-    }
+  for (auto &functionsOfHeight : heights) {
+    mlir::parallelForEach(
+        &getContext(), functionsOfHeight, [&](FunctionCalls *calls) {
+          // Build the inliner interface.
+          DialectAgnosticInlinerInterface interface(&getContext());
+
+          for (auto [caller, callee] : calls->calls) {
+            // Inline the functional region operation, cloning the region
+            // as the callee may have other uses.
+            if (failed(inlineRegion(interface, &callee.getBody(),
+                                    caller, caller.getArgOperands(),
+                                    caller.getResults(), caller.getLoc(),
+                                    /*shouldCloneInlinedRegion=*/true)))
+              continue;
+
+            // If the inlining was successful then erase the call.
+            caller->dropAllDefinedValueUses();
+            caller->dropAllReferences();
+            caller.erase();
+          }
+        });
   }
+
+  // erase the callees which are no longer referenced
+  llvm::DenseSet<StringAttr> referenced;
+  if (auto uses = SymbolTable::getSymbolUses(&module.getBodyRegion()))
+    for (const auto &use : *uses)
+      referenced.insert(use.getSymbolRef().getRootReference());
+  for (auto &calls : functionCalls)
+    if (callees.contains(calls.function) &&
+        !referenced.contains(calls.function.getSymNameAttr()))
+      symbolTable.erase(calls.function);
 }
 
 llvm::StringRef InlineRegionPass::getArgument() const { return "pulse-inline"; }
@@ -22,16 +22,19 @@
 #include "Dialect/Pulse/Transforms/LabelPlayOpDurations.h"
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/SequenceDurationAnalysis.h"
 
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
 
 #include <cstdint>
-#include <string>
-#include <unordered_map>
-#include <vector>
 
 using namespace mlir;
 using namespace mlir::pulse;
@@ -40,38 +43,57 @@ void LabelPlayOpDurationsPass::runOnOperation() {
 
   // all PlayOps are assumed to be inside of a pulse.sequence
   // pass builds a mapping of sequence name , argument number to duration
-  // for all play operations using call_sequences
+  // for all play operations using call_sequences, from the first call of
+  // each sequence
   //
   // pass then searches for all play operations and assigns the durations using
   // the mapping
 
   Operation *module = getOperation();
+  auto &sequenceDurations = getAnalysis<SequenceDurationAnalysis>();
 
-  std::unordered_map<std::string, std::vector<uint64_t>> argumentToDuration;
+  llvm::DenseMap<StringAttr, llvm::SmallVector<uint64_t, 8>>
+      argumentToDuration;
 
   module->walk([&](CallSequenceOp callSequenceOp) {
-    auto callee = callSequenceOp.getCallee().str();
-
-    for (const auto &operand : callSequenceOp->getOperands()) {
-
-      uint64_t duration = 0;
-      auto *defOp = operand.getDefiningOp();
-      if (defOp)
-        if (auto waveformOp = dyn_cast<Waveform_CreateOp>(defOp))
-          duration = waveformOp.getDuration(nullptr /*callSequenceOp*/).get();
-
-      argumentToDuration[callee].push_back(duration);
+    auto sequenceOp = sequenceDurations.getSequenceOp(callSequenceOp);
+    if (!sequenceOp)
+      return;
+    auto [it, inserted] =
+        argumentToDuration.try_emplace(sequenceOp.getSymNameAttr());
+    if (!inserted)
+      return;
+
+    auto &durations = it->second;
+    durations.resize(callSequenceOp->getNumOperands(), 0);
+    for (const auto &[index, operand] :
+         llvm::enumerate(callSequenceOp->getOperands())) {
+      auto waveformOp = operand.getDefiningOp<Waveform_CreateOp>();
+      if (!waveformOp)
+        continue;
+      auto duration = waveformOp.getDuration(nullptr /*callSequenceOp*/);
+      if (duration)
+        durations[index] = *duration;
+      else
+        llvm::consumeError(duration.takeError());
     }
   });
 
   module->walk([&](PlayOp playOp) {
     auto sequenceOp = playOp->getParentOfType<mlir::pulse::SequenceOp>();
-    auto sequenceStr = sequenceOp.getSymName().str();
-    auto wfArgNumber = playOp.getWfr().dyn_cast<BlockArgument>().getArgNumber();
-    auto duration = argumentToDuration[sequenceStr][wfArgNumber];
-    mlir::pulse::PulseOpSchedulingInterface::setDuration(playOp, duration);
+    auto wfArg = playOp.getWfr().dyn_cast<BlockArgument>();
+    if (!sequenceOp || !wfArg)
+      return;
+    auto durations = argumentToDuration.find(sequenceOp.getSymNameAttr());
+    if (durations == argumentToDuration.end() ||
+        wfArg.getArgNumber() >= durations->second.size())
+      return;
+    mlir::pulse::PulseOpSchedulingInterface::setDuration(
+        playOp, durations->second[wfArg.getArgNumber()]);
   });
 
+  // only the durations of play operations were set
+  markAnalysesPreserved<SequenceDurationAnalysis>();
 } // runOnOperation
 
 llvm::StringRef LabelPlayOpDurationsPass::getArgument() const {
@@ -0,0 +1,123 @@
+//===- MergeCaptures.cpp - Merge simultaneous captures ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for merging the simultaneous pulse.capture
+///  ops on the frames of the same port into a pulse.multiplexed_capture.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/MergeCaptures.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Types.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+/// Replace captures, on distinct frames, with a multiplexed capture of
+/// their frames at the first of them.
+void merge(llvm::ArrayRef<CaptureOp> captures) {
+  CaptureOp first = captures.front();
+  llvm::SmallVector<Value> targets;
+  llvm::SmallVector<Type> types;
+  for (auto captureOp : captures) {
+    targets.push_back(captureOp.getTarget());
+    types.push_back(captureOp.getType());
+  }
+
+  OpBuilder builder(first);
+  auto multiplexedOp =
+      builder.create<MultiplexedCaptureOp>(first.getLoc(), types, targets);
+  // the captures share the timepoint of the first
+  multiplexedOp->setAttrs(first->getAttrs());
+  for (auto [captureOp, result] :
+       llvm::zip(captures, multiplexedOp.getOuts())) {
+    captureOp.getOut().replaceAllUsesWith(result);
+    captureOp->erase();
+  }
+}
+} // anonymous namespace
+
+void MergeCapturesPass::runOnOperation() {
+  SequenceOp sequenceOp = getOperation();
+  auto argPorts = sequenceOp->getAttrOfType<ArrayAttr>("pulse.argPorts");
+  if (!argPorts)
+    return;
+
+  llvm::SmallVector<Block *> blocks;
+  sequenceOp->walk([&](Block *block) { blocks.push_back(block); });
+
+  for (Block *block : blocks) {
+    // the captures of the frames of each port at each timepoint, in block
+    // order
+    llvm::MapVector<std::pair<int64_t, Attribute>,
+                    llvm::SmallVector<CaptureOp>>
+        simultaneous;
+    for (auto captureOp : block->getOps<CaptureOp>()) {
+      auto timepoint = PulseOpSchedulingInterface::getTimepoint(captureOp);
+      auto argument = captureOp.getTarget().dyn_cast<BlockArgument>();
+      if (!timepoint || !argument ||
+          argument.getOwner()->getParentOp() != sequenceOp ||
+          argument.getArgNumber() >= argPorts.size())
+        continue;
+
+      auto &captures =
+          simultaneous[{*timepoint, argPorts[argument.getArgNumber()]}];
+      // a frame captures once at a time
+      if (llvm::none_of(captures, [&](CaptureOp other) {
+            return other.getTarget() == captureOp.getTarget();
+          }))
+        captures.push_back(captureOp);
+    }
+
+    for (auto &entry : simultaneous) {
+      auto &captures = entry.second;
+      if (captures.size() < 2)
+        continue;
+      numCapturesMerged += captures.size();
+      merge(captures);
+    }
+  }
+} // runOnOperation
+
+llvm::StringRef MergeCapturesPass::getArgument() const {
+  return "pulse-merge-captures";
+}
+
+llvm::StringRef MergeCapturesPass::getDescription() const {
+  return "Merge the simultaneous captures on the frames of the same port "
+         "into a multiplexed capture";
+}
+
+llvm::StringRef MergeCapturesPass::getName() const {
+  return "Merge Captures Pass";
+}
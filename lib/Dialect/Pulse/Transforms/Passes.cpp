@@ -23,10 +23,19 @@
 #include "Conversion/QUIRToPulse/LoadPulseCals.h"
 #include "Conversion/QUIRToPulse/QUIRToPulse.h"
 
+#include "Dialect/Pulse/Transforms/ApplyRuntimeProfile.h"
 #include "Dialect/Pulse/Transforms/ClassicalOnlyDetection.h"
+#include "Dialect/Pulse/Transforms/CoalesceDelays.h"
+#include "Dialect/Pulse/Transforms/DeduplicateWaveforms.h"
+#include "Dialect/Pulse/Transforms/EliminateBarriers.h"
+#include "Dialect/Pulse/Transforms/FeedForwardLatency.h"
+#include "Dialect/Pulse/Transforms/FoldFrameUpdates.h"
 #include "Dialect/Pulse/Transforms/LabelPlayOpDurations.h"
+#include "Dialect/Pulse/Transforms/MergeCaptures.h"
 #include "Dialect/Pulse/Transforms/MergeDelays.h"
 #include "Dialect/Pulse/Transforms/RemoveUnusedArguments.h"
+#include "Dialect/Pulse/Transforms/RerollSequences.h"
+#include "Dialect/Pulse/Transforms/SampleWaveforms.h"
 #include "Dialect/Pulse/Transforms/SchedulePort.h"
 
 #include "Dialect/Pulse/Transforms/Scheduling.h"
@@ -46,6 +55,15 @@ void registerPulsePasses() {
   PassRegistration<SchedulePortPass>();
   PassRegistration<QuantumCircuitPulseSchedulingPass>();
   PassRegistration<ClassicalOnlyDetectionPass>();
+  PassRegistration<DeduplicateWaveformsPass>();
+  PassRegistration<SampleWaveformsPass>();
+  PassRegistration<CoalesceDelaysPass>();
+  PassRegistration<FeedForwardLatencyPass>();
+  PassRegistration<RerollSequencesPass>();
+  PassRegistration<FoldFrameUpdatesPass>();
+  PassRegistration<MergeCapturesPass>();
+  PassRegistration<EliminateBarriersPass>();
+  PassRegistration<ApplyRuntimeProfilePass>();
 }
 
 void registerPulsePassPipeline() {
@@ -24,22 +24,24 @@
 #include "Dialect/Pulse/IR/PulseOps.h"
 
 #include "mlir/IR/BuiltinOps.h"
-#include "mlir/IR/MLIRContext.h"
-#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/SymbolTable.h"
-#include "mlir/IR/Visitors.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
-#include "mlir/Support/LogicalResult.h"
-#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include <cassert>
-#include <utility>
+#include <algorithm>
+#include <optional>
 #include <vector>
 
 #define DEBUG_TYPE "RemoveUnusedArguments"
@@ -48,104 +50,138 @@ using namespace mlir;
 using namespace mlir::pulse;
 
 namespace {
+/// A sequence, the sequences it calls and the arguments erased from it.
+struct SequenceCallees {
+  SequenceOp sequence;
+  llvm::SmallVector<SequenceOp> callees;
+  // the length of the longest chain of calls from the sequence, i.e., 0 if
+  // it calls no sequence, once computed
+  std::optional<unsigned> height;
+  llvm::BitVector erasedArguments;
+};
+
+/// Compute the height of the sequence of sequenceCallees in the call graph,
+/// dropping the recursive calls, i.e., the calls to the sequences whose
+/// height is being computed.
+unsigned computeHeight(SequenceCallees &sequenceCallees,
+                       llvm::DenseMap<SequenceOp, SequenceCallees *> &sequences,
+                       llvm::DenseSet<SequenceOp> &visiting) {
+  if (sequenceCallees.height)
+    return *sequenceCallees.height;
+
+  visiting.insert(sequenceCallees.sequence);
+  unsigned height = 0;
+  llvm::erase_if(sequenceCallees.callees, [&](SequenceOp callee) {
+    if (visiting.contains(callee))
+      return true;
+    unsigned const calleeHeight =
+        computeHeight(*sequences[callee], sequences, visiting);
+    height = std::max(height, calleeHeight + 1);
+    return false;
+  });
+  visiting.erase(sequenceCallees.sequence);
 
-struct RemoveUnusedArgumentsPattern
-    : public OpRewritePattern<pulse::CallSequenceOp> {
-  explicit RemoveUnusedArgumentsPattern(MLIRContext *ctx)
-      : OpRewritePattern<pulse::CallSequenceOp>(ctx) {}
-  LogicalResult matchAndRewrite(pulse::CallSequenceOp callSequenceOp,
-                                PatternRewriter &rewriter) const override {
-
-    LLVM_DEBUG(llvm::errs() << "Matching: ");
-    LLVM_DEBUG(callSequenceOp.dump());
-
-    Operation *findOp = SymbolTable::lookupNearestSymbolFrom<SequenceOp>(
-        callSequenceOp, callSequenceOp.getCalleeAttr());
-
-    if (!findOp)
-      return failure();
-
-    SequenceOp sequenceOp = dyn_cast<SequenceOp>(findOp);
-
-    llvm::BitVector argIndicesBV(sequenceOp.getNumArguments());
-    std::vector<Operation *> testEraseList;
+  sequenceCallees.height = height;
+  return height;
+}
 
-    for (auto const &argumentResult :
-         llvm::enumerate(sequenceOp.getArguments())) {
-      if (argumentResult.value().use_empty()) {
-        auto index = argumentResult.index();
-        argIndicesBV.set(index);
-        LLVM_DEBUG(llvm::errs() << "Removing argument: ");
-        LLVM_DEBUG(argumentResult.value().dump());
+/// Whether the arguments of a sequence may be removed, i.e., the sequence
+/// is called and only referenced by its calls.
+bool hasOnlyCalls(SequenceOp sequenceOp, const SymbolUserMap &symbolUsers) {
+  auto users = symbolUsers.getUsers(sequenceOp);
+  return !users.empty() && llvm::all_of(users, [](Operation *user) {
+    return isa<CallSequenceOp>(user);
+  });
+}
 
-        auto *argOp = callSequenceOp.getOperand(index).getDefiningOp();
-        if (argOp)
-          testEraseList.push_back(argOp);
-      }
-    }
+/// Erase the unused arguments of a sequence which is only referenced by its
+/// calls.
+void eraseArguments(SequenceCallees &sequenceCallees,
+                    const SymbolUserMap &symbolUsers) {
+  SequenceOp sequenceOp = sequenceCallees.sequence;
+  if (!hasOnlyCalls(sequenceOp, symbolUsers))
+    return;
 
-    // indicate match failure if there are no unused arguments
-    if (argIndicesBV.none())
-      return failure();
-
-    // rewrite - removed arguments and matching operands
-    sequenceOp.eraseArguments(argIndicesBV);
-    callSequenceOp->eraseOperands(argIndicesBV);
-
-    // check for other CallSequenceOps calling the same sequence
-    auto moduleOp = sequenceOp->getParentOfType<mlir::ModuleOp>();
-    assert(moduleOp && "Operation outside of a Module");
-    moduleOp->walk([&](pulse::CallSequenceOp op) {
-      if (op == callSequenceOp)
-        return;
-      if (op.getCallee() != sequenceOp.getSymName())
-        return;
-      // verify that the sequence and the new callSequenceOp are in
-      // the same module
-      auto checkModuleOp = op->getParentOfType<mlir::ModuleOp>();
-      if (checkModuleOp != moduleOp)
-        return;
-      op->eraseOperands(argIndicesBV);
-    });
+  llvm::BitVector unused(sequenceOp.getNumArguments());
+  for (auto const &argument : llvm::enumerate(sequenceOp.getArguments()))
+    if (argument.value().use_empty())
+      unused.set(argument.index());
+  if (unused.none())
+    return;
 
-    // remove defining ops if the have no usage
-    for (auto *argOp : testEraseList)
-      if (argOp->use_empty())
-        rewriter.eraseOp(argOp);
+  sequenceOp.eraseArguments(unused);
+  sequenceCallees.erasedArguments = std::move(unused);
+}
 
-    return success();
+/// Erase the operands of the calls of a sequence for its erased arguments,
+/// and the operations defining them which are no longer used.
+void eraseOperands(const SequenceCallees &sequenceCallees,
+                   const SymbolUserMap &symbolUsers) {
+  const llvm::BitVector &erased = sequenceCallees.erasedArguments;
+  llvm::SetVector<Operation *> definingOps;
+  for (Operation *user : symbolUsers.getUsers(sequenceCallees.sequence)) {
+    LLVM_DEBUG(llvm::dbgs() << "Removing operands of: " << *user << "\n");
+    for (unsigned const index : erased.set_bits())
+      if (Operation *definingOp = user->getOperand(index).getDefiningOp())
+        definingOps.insert(definingOp);
+    user->eraseOperands(erased);
   }
-}; // struct RemoveUnusedArgumentsPattern
 
+  for (Operation *definingOp : definingOps)
+    if (isOpTriviallyDead(definingOp))
+      definingOp->erase();
+}
 } // end anonymous namespace
 
 void RemoveUnusedArgumentsPass::runOnOperation() {
-
-  bool runPattern = false;
-  auto op = getOperation();
-
-  // test for the presence of at least one CallSequenceOp
-  // if a CallSequenceOp exists run the pattern
-  // if not return early to save time
-  op->walk([&](CallSequenceOp csOp) {
-    runPattern = true;
-    return WalkResult::interrupt();
+  ModuleOp moduleOp = getOperation();
+
+  // find the callers of each sequence once, rather than walking the module
+  // for the callers of each sequence
+  SymbolTableCollection symbolTables;
+  SymbolUserMap const symbolUsers(symbolTables, moduleOp);
+
+  std::vector<SequenceCallees> sequenceCallees;
+  moduleOp->walk([&](SequenceOp sequenceOp) {
+    auto &callees = sequenceCallees.emplace_back();
+    callees.sequence = sequenceOp;
+    sequenceOp->walk([&](CallSequenceOp callSequenceOp) {
+      if (auto callee = symbolTables.lookupNearestSymbolFrom<SequenceOp>(
+              callSequenceOp, callSequenceOp.getCalleeAttr()))
+        callees.callees.push_back(callee);
+    });
   });
 
-  if (!runPattern)
-    return;
-
-  RewritePatternSet patterns(&getContext());
-
-  patterns.add<RemoveUnusedArgumentsPattern>(&getContext());
-
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
+  llvm::DenseMap<SequenceOp, SequenceCallees *> sequences;
+  for (auto &callees : sequenceCallees)
+    sequences[callees.sequence] = &callees;
+
+  // Remove the arguments bottom-up, as erasing the operands of the calls of
+  // a sequence may leave arguments of its callers unused. The sequences of
+  // the same height do not call each other, so their arguments are erased
+  // in parallel. The operands of their calls are erased sequentially, as
+  // calls of different sequences may share operands.
+  std::vector<std::vector<SequenceCallees *>> heights;
+  llvm::DenseSet<SequenceOp> visiting;
+  for (auto &callees : sequenceCallees) {
+    unsigned const height = computeHeight(callees, sequences, visiting);
+    if (heights.size() <= height)
+      heights.resize(height + 1);
+    heights[height].push_back(&callees);
+  }
 
-  if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns),
-                                          config)))
-    signalPassFailure();
+  for (auto &sequencesOfHeight : heights) {
+    mlir::parallelForEach(&getContext(), sequencesOfHeight,
+                          [&](SequenceCallees *callees) {
+                            eraseArguments(*callees, symbolUsers);
+                          });
+    for (auto *callees : sequencesOfHeight) {
+      if (callees->erasedArguments.none())
+        continue;
+      numArgumentsRemoved += callees->erasedArguments.count();
+      eraseOperands(*callees, symbolUsers);
+    }
+  }
 }
 
 llvm::StringRef RemoveUnusedArgumentsPass::getArgument() const {
@@ -0,0 +1,267 @@
+//===- RerollSequences.cpp - Reroll repeated pulse operations ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for rerolling runs of repeated pulse
+///  operations into a single repeated pulse.call_sequence.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/RerollSequences.h"
+
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/SequenceDurationAnalysis.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+using Timepoint = std::optional<int64_t>;
+
+/// A run of a pattern of operations repeated back to back.
+struct Run {
+  size_t patternLength = 1;
+  unsigned repeats = 1;
+  // the samples from the start of a repetition to the start of the next,
+  // if the operations are scheduled
+  Timepoint period;
+};
+
+/// Whether op may be part of a rerolled pattern.
+bool isRerollable(Operation *op) {
+  if (auto callSequenceOp = dyn_cast<CallSequenceOp>(op))
+    return callSequenceOp->getNumResults() == 0;
+  return isa<PlayOp, DelayOp, BarrierOp, ShiftPhaseOp, SetPhaseOp,
+             ShiftFrequencyOp, SetFrequencyOp, SetAmplitudeOp>(op);
+}
+
+Timepoint getTimepoint(Operation *op) {
+  return PulseOpSchedulingInterface::getTimepoint(op);
+}
+
+/// Whether op repeats other, i.e., has the same name, operands and
+/// attributes other than its timepoint.
+bool isRepetition(Operation *op, Operation *other) {
+  if (op->getName() != other->getName() ||
+      !llvm::equal(op->getOperands(), other->getOperands()) ||
+      getTimepoint(op).has_value() != getTimepoint(other).has_value())
+    return false;
+  auto withoutTimepoint = [](Operation *op) {
+    return llvm::make_filter_range(op->getAttrs(), [](NamedAttribute attr) {
+      return attr.getName() != "pulse.timepoint";
+    });
+  };
+  return llvm::equal(withoutTimepoint(op), withoutTimepoint(other));
+}
+
+/// Get the run of the leading patternLength operations of ops.
+Run getRun(llvm::ArrayRef<Operation *> ops, size_t patternLength) {
+  Run run{patternLength, 1, std::nullopt};
+  for (; (run.repeats + 1) * patternLength <= ops.size(); ++run.repeats) {
+    size_t const offset = run.repeats * patternLength;
+    for (size_t j = 0; j < patternLength; ++j) {
+      Operation *op = ops[j];
+      Operation *repetition = ops[offset + j];
+      if (!isRepetition(op, repetition))
+        return run;
+      auto timepoint = getTimepoint(op);
+      if (!timepoint)
+        continue;
+      int64_t const delta = *getTimepoint(repetition) - *timepoint;
+      if (!run.period && delta > 0)
+        run.period = delta;
+      if (!run.period || delta != run.repeats * *run.period)
+        return run;
+    }
+  }
+  return run;
+}
+
+/// Get the run of ops covering the most operations, preferring shorter
+/// patterns.
+Run getLongestRun(llvm::ArrayRef<Operation *> ops, size_t maxPatternLength) {
+  Run best;
+  for (size_t patternLength = 1;
+       patternLength <= maxPatternLength && 2 * patternLength <= ops.size();
+       ++patternLength) {
+    Run const run = getRun(ops, patternLength);
+    if (run.repeats > 1 && run.patternLength * run.repeats >
+                               best.patternLength * best.repeats)
+      best = run;
+  }
+  return best;
+}
+
+/// Outline pattern into a new sequence, taking the values used by pattern
+/// as arguments, and return the sequence and its arguments.
+std::pair<SequenceOp, llvm::SmallVector<Value>>
+outline(llvm::ArrayRef<Operation *> pattern, Timepoint period,
+        SymbolTable &symbolTable) {
+  llvm::SetVector<Value> arguments;
+  for (Operation *op : pattern)
+    arguments.insert(op->operand_begin(), op->operand_end());
+  llvm::SmallVector<Type> argumentTypes;
+  for (Value argument : arguments)
+    argumentTypes.push_back(argument.getType());
+
+  Operation *firstOp = pattern.front();
+  std::string name = "repeat";
+  if (auto parentOp = firstOp->getParentOfType<SymbolOpInterface>())
+    name = (parentOp.getName() + "_" + name).str();
+  auto sequenceOp = SequenceOp::create(
+      firstOp->getLoc(), name,
+      FunctionType::get(firstOp->getContext(), argumentTypes, {}));
+  symbolTable.insert(sequenceOp);
+  if (period)
+    PulseOpSchedulingInterface::setDuration(sequenceOp, *period);
+
+  Block *entryBlock = sequenceOp.addEntryBlock();
+  IRMapping mapping;
+  mapping.map(arguments.getArrayRef(), entryBlock->getArguments());
+  auto builder = OpBuilder::atBlockEnd(entryBlock);
+  Timepoint const start = getTimepoint(firstOp);
+  for (Operation *op : pattern) {
+    Operation *clonedOp = builder.clone(*op, mapping);
+    if (start)
+      PulseOpSchedulingInterface::setTimepoint(clonedOp,
+                                               *getTimepoint(op) - *start);
+  }
+  builder.create<ReturnOp>(firstOp->getLoc());
+
+  return {sequenceOp, llvm::SmallVector<Value>(arguments.getArrayRef())};
+}
+
+/// Whether a single call repeated every period samples can repeat in place,
+/// i.e., the call, with its own repetitions, lasts period samples.
+bool repeatsInPlace(CallSequenceOp callSequenceOp, Timepoint period,
+                    SequenceDurationAnalysis &sequenceDurations) {
+  if (!period)
+    return true;
+  auto duration = sequenceDurations.getDuration(callSequenceOp);
+  if (!duration) {
+    llvm::consumeError(duration.takeError());
+    return false;
+  }
+  return static_cast<int64_t>(*duration) == *period;
+}
+} // anonymous namespace
+
+llvm::StringRef mlir::pulse::getRepeatAttrName() { return "pulse.repeat"; }
+
+void RerollSequencesPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SymbolTable symbolTable(module);
+  auto &sequenceDurations = getAnalysis<SequenceDurationAnalysis>();
+  OpBuilder builder(module);
+
+  // find the runs of rerollable operations of each block before rewriting
+  std::vector<llvm::SmallVector<Operation *>> segments;
+  module->walk([&](Block *block) {
+    llvm::SmallVector<Operation *> segment;
+    for (Operation &op : *block) {
+      if (isRerollable(&op)) {
+        segment.push_back(&op);
+        continue;
+      }
+      if (segment.size() >= 2)
+        segments.push_back(std::move(segment));
+      segment.clear();
+    }
+    if (segment.size() >= 2)
+      segments.push_back(std::move(segment));
+  });
+
+  for (auto &segment : segments) {
+    llvm::ArrayRef<Operation *> ops = segment;
+    while (ops.size() >= 2) {
+      Run const run = getLongestRun(ops, maxPatternLength);
+      size_t const runLength = run.patternLength * run.repeats;
+      if (run.repeats < 2 || run.repeats < minRepeats) {
+        ops = ops.drop_front();
+        continue;
+      }
+
+      auto pattern = ops.take_front(run.patternLength);
+      auto runOps = ops.take_front(runLength);
+      ops = ops.drop_front(runLength);
+
+      Operation *firstOp = pattern.front();
+      auto callSequenceOp = dyn_cast<CallSequenceOp>(firstOp);
+      if (run.patternLength == 1 && callSequenceOp &&
+          repeatsInPlace(callSequenceOp, run.period, sequenceDurations)) {
+        // repeat the call in place, keeping its own repetitions
+        uint64_t repeats = run.repeats;
+        if (auto repeatAttr =
+                firstOp->getAttrOfType<IntegerAttr>(getRepeatAttrName()))
+          repeats *= repeatAttr.getInt();
+        firstOp->setAttr(getRepeatAttrName(),
+                         builder.getI64IntegerAttr(repeats));
+        for (Operation *op : runOps.drop_front())
+          op->erase();
+      } else {
+        auto [sequenceOp, arguments] =
+            outline(pattern, run.period, symbolTable);
+        builder.setInsertionPoint(firstOp);
+        auto repeatedOp = builder.create<CallSequenceOp>(
+            firstOp->getLoc(), sequenceOp, arguments);
+        repeatedOp->setAttr(getRepeatAttrName(),
+                            builder.getI64IntegerAttr(run.repeats));
+        if (auto timepoint = getTimepoint(firstOp))
+          PulseOpSchedulingInterface::setTimepoint(repeatedOp, *timepoint);
+        for (Operation *op : runOps)
+          op->erase();
+      }
+
+      ++numRunsRerolled;
+      numOpsRerolled += runLength;
+    }
+  }
+} // runOnOperation
+
+llvm::StringRef RerollSequencesPass::getArgument() const {
+  return "pulse-reroll-sequences";
+}
+
+llvm::StringRef RerollSequencesPass::getDescription() const {
+  return "Replace runs of repeated pulse operations by a single "
+         "pulse.call_sequence with a pulse.repeat attribute";
+}
+
+llvm::StringRef RerollSequencesPass::getName() const {
+  return "Reroll Sequences Pass";
+}
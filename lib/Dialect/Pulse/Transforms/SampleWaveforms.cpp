@@ -0,0 +1,204 @@
+//===- SampleWaveforms.cpp - Fold parametric waveforms ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for folding the parametric waveforms with
+///  constant parameters into sample waveforms.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Transforms/SampleWaveforms.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+#include "Dialect/Pulse/Utils/WaveformSamples.h"
+
+#include "mlir/Dialect/Complex/IR/Complex.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <complex>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+
+std::optional<int64_t> getConstantInt(Value value) {
+  APInt intValue;
+  if (!matchPattern(value, m_ConstantInt(&intValue)))
+    return std::nullopt;
+  return intValue.getSExtValue();
+}
+
+std::optional<double> getConstantFloat(Value value) {
+  APFloat floatValue(0.0);
+  if (!matchPattern(value, m_ConstantFloat(&floatValue)))
+    return std::nullopt;
+  return floatValue.convertToDouble();
+}
+
+/// Get the value of an amplitude created by complex.constant or by
+/// complex.create of constant parts.
+std::optional<std::complex<double>> getConstantComplex(Value value) {
+  if (auto createOp = value.getDefiningOp<complex::CreateOp>()) {
+    auto real = getConstantFloat(createOp.getReal());
+    auto imag = getConstantFloat(createOp.getImaginary());
+    if (!real || !imag)
+      return std::nullopt;
+    return std::complex<double>(*real, *imag);
+  }
+
+  ArrayAttr parts;
+  if (!matchPattern(value, m_Constant(&parts)) || parts.size() != 2)
+    return std::nullopt;
+  auto real = parts[0].dyn_cast<FloatAttr>();
+  auto imag = parts[1].dyn_cast<FloatAttr>();
+  if (!real || !imag)
+    return std::nullopt;
+  return std::complex<double>(real.getValueAsDouble(),
+                              imag.getValueAsDouble());
+}
+
+std::optional<double> getConstantSigma(Value sigma) {
+  auto sigmaValue = getConstantInt(sigma);
+  if (!sigmaValue || *sigmaValue <= 0)
+    return std::nullopt;
+  return static_cast<double>(*sigmaValue);
+}
+
+LogicalResult sample(ConstOp /*op*/, std::complex<double> amp,
+                     llvm::MutableArrayRef<double> samples) {
+  sampleConstWaveform(amp, samples);
+  return success();
+}
+
+LogicalResult sample(GaussianOp op, std::complex<double> amp,
+                     llvm::MutableArrayRef<double> samples) {
+  auto sigma = getConstantSigma(op.getSigma());
+  if (!sigma)
+    return failure();
+  sampleGaussianWaveform(amp, *sigma, samples);
+  return success();
+}
+
+LogicalResult sample(GaussianSquareOp op, std::complex<double> amp,
+                     llvm::MutableArrayRef<double> samples) {
+  auto sigma = getConstantSigma(op.getSigma());
+  auto width = getConstantInt(op.getWidth());
+  if (!sigma || !width || *width < 0 ||
+      static_cast<size_t>(*width) > samples.size() / 2)
+    return failure();
+  sampleGaussianSquareWaveform(amp, *sigma, static_cast<double>(*width),
+                               samples);
+  return success();
+}
+
+LogicalResult sample(DragOp op, std::complex<double> amp,
+                     llvm::MutableArrayRef<double> samples) {
+  auto sigma = getConstantSigma(op.getSigma());
+  auto beta = getConstantFloat(op.getBeta());
+  if (!sigma || !beta)
+    return failure();
+  sampleDragWaveform(amp, *sigma, *beta, samples);
+  return success();
+}
+
+// This pattern replaces a parametric waveform op whose parameters are all
+// constant by a pulse.create_waveform with its samples
+template <typename WaveformOp>
+struct SampleWaveformPattern : public OpRewritePattern<WaveformOp> {
+  SampleWaveformPattern(MLIRContext *ctx, unsigned maxSamples,
+                        SampleFormat format, bool useResources)
+      : OpRewritePattern<WaveformOp>(ctx), maxSamples(maxSamples),
+        format(format), useResources(useResources) {}
+
+  LogicalResult matchAndRewrite(WaveformOp op,
+                                PatternRewriter &rewriter) const override {
+    auto dur = getConstantInt(op.getDur());
+    if (!dur || *dur < 0 ||
+        (maxSamples && *dur > static_cast<int64_t>(maxSamples)))
+      return failure();
+    auto amp = getConstantComplex(op.getAmp());
+    if (!amp)
+      return failure();
+
+    std::vector<double> samples(2 * *dur);
+    if (failed(sample(op, *amp, samples)))
+      return failure();
+
+    auto stored =
+        storeSamples(rewriter.getContext(), samples, format, useResources);
+    rewriter.replaceOpWithNewOp<Waveform_CreateOp>(
+        op, op.getType(), stored.samples, stored.scale);
+    return success();
+  }
+
+  unsigned maxSamples;
+  SampleFormat format;
+  bool useResources;
+};
+} // anonymous namespace
+
+void mlir::pulse::populateSampleWaveformsPatterns(RewritePatternSet &patterns,
+                                                  unsigned maxSamples,
+                                                  SampleFormat format,
+                                                  bool useResources) {
+  patterns.add<SampleWaveformPattern<ConstOp>, SampleWaveformPattern<DragOp>,
+               SampleWaveformPattern<GaussianOp>,
+               SampleWaveformPattern<GaussianSquareOp>>(
+      patterns.getContext(), maxSamples, format, useResources);
+}
+
+void SampleWaveformsPass::runOnOperation() {
+  RewritePatternSet patterns(&getContext());
+  populateSampleWaveformsPatterns(patterns, maxSamples, sampleFormat,
+                                  useResources);
+
+  mlir::GreedyRewriteConfig config;
+  // Disable to improve performance
+  config.enableRegionSimplification = false;
+
+  if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns),
+                                          config)))
+    signalPassFailure();
+}
+
+llvm::StringRef SampleWaveformsPass::getArgument() const {
+  return "pulse-sample-waveforms";
+}
+
+llvm::StringRef SampleWaveformsPass::getDescription() const {
+  return "Fold parametric waveforms with constant parameters into sample "
+         "waveforms";
+}
+
+llvm::StringRef SampleWaveformsPass::getName() const {
+  return "Sample Waveforms Pass";
+}
@@ -33,19 +33,24 @@
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/IR/Block.h"
-#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/Region.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #define DEBUG_TYPE "SchedulePortPass"
 
@@ -73,15 +78,22 @@ uint64_t SchedulePortPass::processCall(CallSequenceOp &callSequenceOp,
     callSequenceOp->emitError()
         << "Unable to find callee symbol " << callee << ".";
     signalPassFailure();
+    return 0;
   }
 
   auto sequenceOp = sequenceOpIter->second;
 
   uint64_t calleeDuration;
-  if (updateNestedSequences)
+  if (updateNestedSequences) {
     calleeDuration = updateSequence(sequenceOp);
-  else
-    calleeDuration = processSequence(sequenceOp);
+  } else {
+    // schedule each sequence once, as its delays are erased when scheduled
+    auto [durationIter, inserted] =
+        sequenceDurations.try_emplace(sequenceOp, 0);
+    if (inserted)
+      durationIter->second = processSequence(sequenceOp);
+    calleeDuration = durationIter->second;
+  }
   PulseOpSchedulingInterface::setDuration(callSequenceOp, calleeDuration);
 
   INDENT_DEBUG("====  processCall - end  ====================\n");
@@ -92,20 +104,29 @@ uint64_t SchedulePortPass::processCall(CallSequenceOp &callSequenceOp,
 
 uint64_t SchedulePortPass::processSequence(SequenceOp sequenceOp) {
 
-  mlir::OpBuilder builder(sequenceOp);
-
-  uint32_t numMixedFrames = 0;
-  auto mixedFrameSequences = buildMixedFrameMap(sequenceOp, numMixedFrames);
-
-  int64_t maxTime = 0;
+  MixedFrameTimeline timeline;
+  if (failed(buildMixedFrameTimeline(sequenceOp, timeline))) {
+    signalPassFailure();
+    return 0;
+  }
 
-  addTimepoints(builder, mixedFrameSequences, maxTime);
+  timepointMap_t timepoints;
+  int64_t const maxTime = addTimepoints(timeline, timepoints);
 
   // remove all DelayOps - they are no longer required now that we have
   // timepoints
-  sequenceOp->walk([&](DelayOp op) { op->erase(); });
+  sequenceOp->walk([&](DelayOp op) {
+    timepoints.erase(op);
+    op->erase();
+  });
 
-  sortOpsByTimepoint(sequenceOp);
+  for (auto [op, timepoint] : timepoints)
+    PulseOpSchedulingInterface::setTimepoint(op, timepoint);
+
+  if (failed(sortOpsByTimepoint(sequenceOp, timepoints))) {
+    signalPassFailure();
+    return 0;
+  }
 
   // clean up
   sequenceOp->walk([&](arith::ConstantOp op) {
@@ -157,29 +178,15 @@ uint64_t SchedulePortPass::updateSequence(SequenceOp sequenceOp) {
   return returnTimepoint;
 }
 
-SchedulePortPass::mixedFrameMap_t
-SchedulePortPass::buildMixedFrameMap(SequenceOp &sequenceOp,
-                                     uint32_t &numMixedFrames) {
-
-  // build a map between mixed frame (as represented by the arg index)
-  // and a vector of operations on that mixed frame
-
-  // process sequence arguments to initialize map with empty vectors
-  mixedFrameMap_t mixedFrameSequences;
-  for (auto const &argumentResult :
-       llvm::enumerate(sequenceOp.getArguments())) {
-    auto index = argumentResult.index();
-    auto argumentType = argumentResult.value().getType();
-    if (argumentType.isa<MixedFrameType>()) {
-      numMixedFrames++;
-      mixedFrameSequences[index] = {};
-    }
-  }
+mlir::LogicalResult
+SchedulePortPass::buildMixedFrameTimeline(SequenceOp &sequenceOp,
+                                          MixedFrameTimeline &timeline) {
 
-  // build vectors of operations on each mixed frame and push onto the
-  // corresponding vector in the map
+  // build the operations on each mixed frame, as represented by the arg
+  // index, in block order
   //
   // currently only considering DelayOp and PlayOp
+  llvm::SmallVector<std::pair<unsigned, Operation *>> frameOps;
   for (Region &region : sequenceOp->getRegions()) {
     for (Block &block : region.getBlocks()) {
       for (Operation &op : block.getOperations()) {
@@ -204,120 +211,172 @@ SchedulePortPass::buildMixedFrameMap(SequenceOp &sequenceOp,
             target = castOp.getTarget();
 
           auto blockArg = target.cast<BlockArgument>();
-          auto index = blockArg.getArgNumber();
-
-          mixedFrameSequences[index].push_back(&op);
+          frameOps.emplace_back(blockArg.getArgNumber(), &op);
         } else if (auto castOp = dyn_cast<CallSequenceOp>(op)) {
-          // add a call sequence to all mixedFrameSequences for
-          // mixedFrames passed to it
+          // add a call sequence to the operations of all the mixedFrames
+          // passed to it
           for (auto operand : castOp.getOperands()) {
             auto operandType = operand.getType();
             if (operandType.isa<MixedFrameType>()) {
               auto blockArg = operand.cast<BlockArgument>();
-              auto index = blockArg.getArgNumber();
-              mixedFrameSequences[index].push_back(&op);
+              frameOps.emplace_back(blockArg.getArgNumber(), &op);
             }
           }
         }
       }
     }
   }
-  return mixedFrameSequences;
-} // buildMixedFrameMap
 
-void SchedulePortPass::addTimepoints(mlir::OpBuilder &builder,
-                                     mixedFrameMap_t &mixedFrameSequences,
-                                     int64_t &maxTime) {
+  // lay the operations out frame by frame, keeping the block order within
+  // each frame
+  unsigned const numFrames = sequenceOp.getNumArguments();
+  timeline.frameBegins.assign(numFrames + 1, 0);
+  for (auto const &frameOp : frameOps)
+    ++timeline.frameBegins[frameOp.first + 1];
+  for (unsigned frame = 0; frame < numFrames; ++frame)
+    timeline.frameBegins[frame + 1] += timeline.frameBegins[frame];
+
+  timeline.ops.resize(frameOps.size());
+  timeline.starts.assign(frameOps.size(), 0);
+  timeline.durations.assign(frameOps.size(), 0);
+  std::vector<unsigned> frameEnds(timeline.frameBegins.begin(),
+                                  timeline.frameBegins.end() - 1);
+  for (auto const &[frame, op] : frameOps) {
+    unsigned const position = frameEnds[frame]++;
+    timeline.ops[position] = op;
+
+    // only DelayOps and PlayOps advance the time on their mixed frame
+    if (auto delayOp = dyn_cast<DelayOp>(op)) {
+      llvm::Expected<uint64_t> durOrError =
+          PulseOpSchedulingInterface::getDuration<DelayOp>(delayOp);
+      if (auto err = durOrError.takeError()) {
+        delayOp.emitError() << toString(std::move(err));
+        return failure();
+      }
+      timeline.durations[position] = durOrError.get();
+    } else if (auto playOp = dyn_cast<PlayOp>(op)) {
+      llvm::Expected<uint64_t> durOrError =
+          playOp.getDuration(nullptr /*callSequenceOp*/);
+      if (auto err = durOrError.takeError()) {
+        playOp.emitError() << toString(std::move(err));
+        return failure();
+      }
+      timeline.durations[position] = durOrError.get();
+    }
+  }
+  return success();
+} // buildMixedFrameTimeline
+
+int64_t SchedulePortPass::addTimepoints(MixedFrameTimeline &timeline,
+                                        timepointMap_t &timepoints) {
 
-  // add timepoint to operations in mixedFrameSequences where timepoints
-  // are calculated based on the duration of delayOps
+  // calculate the timepoints of the operations in the timeline based on the
+  // duration of delayOps
   //
-  // Timepoints start at 0 for each mixed frame vector and are calculated
-  // independently for each mixed frame.
+  // Timepoints start at 0 for each mixed frame and are calculated
+  // independently for each mixed frame, except that no operation starts
+  // before an existing timepoint, e.g., that of a call sequence on a mixed
+  // frame visited earlier.
 
-  for (const auto &index : mixedFrameSequences) {
+  int64_t maxTime = 0;
+  for (unsigned frame = 0; frame + 1 < timeline.frameBegins.size(); ++frame) {
     int64_t currentTimepoint = 0;
-    for (auto *op : index.second) {
-      auto existingTimepoint = PulseOpSchedulingInterface::getTimepoint(op);
+    for (unsigned position = timeline.frameBegins[frame];
+         position < timeline.frameBegins[frame + 1]; ++position) {
+      auto *op = timeline.ops[position];
+      auto [timepointIter, inserted] = timepoints.try_emplace(op, 0);
+      auto existingTimepoint =
+          inserted ? PulseOpSchedulingInterface::getTimepoint(op)
+                   : std::optional<int64_t>(timepointIter->second);
       if (existingTimepoint.has_value())
         if (existingTimepoint.value() > currentTimepoint)
           currentTimepoint = existingTimepoint.value();
 
-      // set attribute on op with current timepoint
-      PulseOpSchedulingInterface::setTimepoint(op, currentTimepoint);
-
-      // update currentTimepoint if DelayOp or playOp
-      if (auto delayOp = dyn_cast<DelayOp>(op)) {
-        llvm::Expected<uint64_t> durOrError =
-            PulseOpSchedulingInterface::getDuration<DelayOp>(delayOp);
-        if (auto err = durOrError.takeError()) {
-          delayOp.emitError() << toString(std::move(err));
-          signalPassFailure();
-        }
-        currentTimepoint += durOrError.get();
-      } else if (auto playOp = dyn_cast<PlayOp>(op)) {
-        llvm::Expected<uint64_t> durOrError =
-            playOp.getDuration(nullptr /*callSequenceOp*/);
-        if (auto err = durOrError.takeError()) {
-          playOp.emitError() << toString(std::move(err));
-          signalPassFailure();
-        }
-        currentTimepoint += durOrError.get();
-      }
+      timepointIter->second = currentTimepoint;
+      timeline.starts[position] = currentTimepoint;
+      currentTimepoint += timeline.durations[position];
     }
     if (currentTimepoint > maxTime)
       maxTime = currentTimepoint;
   }
+  return maxTime;
 } // addTimepoints
 
-void SchedulePortPass::sortOpsByTimepoint(SequenceOp &sequenceOp) {
+mlir::LogicalResult
+SchedulePortPass::sortOpsByTimepoint(SequenceOp &sequenceOp,
+                                     const timepointMap_t &timepoints) {
   // sort updated ops so that ops across mixed frame are in the correct
   // sequence with respect to timepoint on a single port.
-
-  // sort ops by timepoint
+  //
+  // The ops are relinked once in their final order: integer constants,
+  // then the other ops which do not depend on ops with a timepoint, then the
+  // ops with a timepoint ordered by timepoint, keeping the block order of
+  // ops with the same timepoint, and last the remaining ops.
   for (Region &region : sequenceOp->getRegions()) {
     for (Block &block : region.getBlocks()) {
-      auto &blockOps = block.getOperations();
-      blockOps.sort(
-          [&](Operation &op1, Operation &op2) {
-            // put constants ahead of everything else
-            if (isa<arith::ConstantIntOp>(op1) &&
-                !isa<arith::ConstantIntOp>(op2))
-              return true;
-
-            bool const testOp1 = (op1.hasTrait<mlir::pulse::HasTargetFrame>() ||
-                                  isa<CallSequenceOp>(op1));
-            bool const testOp2 = (op2.hasTrait<mlir::pulse::HasTargetFrame>() ||
-                                  isa<CallSequenceOp>(op2));
-
-            if (!testOp1 || !testOp2)
-              return false;
-
-            std::optional<int64_t> currentTimepoint =
-                PulseOpSchedulingInterface::getTimepoint(&op1);
-            if (!currentTimepoint.has_value()) {
-              op1.emitError()
-                  << "Operation does not have a pulse.timepoint attribute.";
-              signalPassFailure();
-            }
-            std::optional<int64_t> nextTimepoint =
-                PulseOpSchedulingInterface::getTimepoint(&op2);
-            if (!nextTimepoint.has_value()) {
-              op2.emitError()
-                  << "Operation does not have a pulse.timepoint attribute.";
-              signalPassFailure();
-            }
+      llvm::SmallVector<Operation *> constantOps;
+      llvm::SmallVector<Operation *> leadingOps;
+      llvm::SmallVector<std::pair<int64_t, Operation *>> timedOps;
+      llvm::SmallVector<Operation *> trailingOps;
+      llvm::SmallPtrSet<Operation *, 16> dependsOnTimedOps;
 
-            // order by timepoint
-            return currentTimepoint.value() < nextTimepoint.value();
-          }); // blockOps.sort
+      for (Operation &op : block.getOperations()) {
+        if (isa<arith::ConstantIntOp>(op)) {
+          constantOps.push_back(&op);
+          continue;
+        }
+
+        if (op.hasTrait<mlir::pulse::HasTargetFrame>() ||
+            isa<CallSequenceOp>(op)) {
+          auto timepointIter = timepoints.find(&op);
+          auto timepoint = timepointIter != timepoints.end()
+                               ? std::optional<int64_t>(timepointIter->second)
+                               : PulseOpSchedulingInterface::getTimepoint(&op);
+          if (!timepoint.has_value())
+            return op.emitError()
+                   << "Operation does not have a pulse.timepoint attribute.";
+          timedOps.emplace_back(timepoint.value(), &op);
+          dependsOnTimedOps.insert(&op);
+          continue;
+        }
+
+        bool const isTrailing =
+            op.hasTrait<OpTrait::IsTerminator>() ||
+            llvm::any_of(op.getOperands(), [&](Value operand) {
+              return dependsOnTimedOps.contains(operand.getDefiningOp());
+            });
+        if (isTrailing) {
+          trailingOps.push_back(&op);
+          dependsOnTimedOps.insert(&op);
+        } else {
+          leadingOps.push_back(&op);
+        }
+      }
+
+      std::stable_sort(timedOps.begin(), timedOps.end(),
+                       [](auto const &op1, auto const &op2) {
+                         return op1.first < op2.first;
+                       });
+
+      // moving each op to the end of the block in turn leaves them in order
+      auto &blockOps = block.getOperations();
+      auto moveToEnd = [&](Operation *op) {
+        blockOps.splice(blockOps.end(), blockOps, op->getIterator());
+      };
+      llvm::for_each(constantOps, moveToEnd);
+      llvm::for_each(leadingOps, moveToEnd);
+      for (auto const &timedOp : timedOps)
+        moveToEnd(timedOp.second);
+      llvm::for_each(trailingOps, moveToEnd);
     }
   }
-} // sortOpsByType
+  return success();
+} // sortOpsByTimepoint
 
 void SchedulePortPass::runOnOperation() {
 
   Operation *module = getOperation();
+  sequenceDurations.clear();
 
   module->walk(
       [&](mlir::pulse::SequenceOp op) { sequenceOps[op.getSymName()] = op; });
@@ -22,22 +22,35 @@
 #include "Dialect/Pulse/Transforms/Scheduling.h"
 #include "Dialect/Pulse/IR/PulseInterfaces.h"
 #include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Utils/LoweredCircuitCache.h"
+#include "Dialect/Pulse/Utils/SequenceDurationAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
-#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
-#include <string>
+#include <iterator>
 #include <utility>
+#include <vector>
 
 #define DEBUG_TYPE "SchedulingDebug"
 
@@ -56,154 +69,361 @@ void QuantumCircuitPulseSchedulingPass::runOnOperation() {
   }
 
   ModuleOp const moduleOp = getOperation();
+  auto &sequenceDurations = getAnalysis<SequenceDurationAnalysis>();
+  portIds.clear();
+  portNames.clear();
 
-  // schedule all the quantum circuits which are root call sequence ops
-  moduleOp->walk([&](mlir::pulse::CallSequenceOp callSequenceOp) {
-    // return if the call sequence op is not a root op
+  // collect the quantum circuits, which are called by root call sequence ops,
+  // scheduling each circuit once however many times it is called
+  std::vector<CircuitSchedule> schedules;
+  llvm::DenseMap<Operation *, size_t> scheduleIndices;
+  std::vector<std::pair<CallSequenceOp, size_t>> circuitCalls;
+  auto result = moduleOp->walk([&](CallSequenceOp callSequenceOp) {
+    // skip the call sequence op if it is not a root op
     if (isa<SequenceOp>(callSequenceOp->getParentOp()))
-      return;
-    switch (SCHEDULING_METHOD) {
-    case ALAP:
-      scheduleAlap(callSequenceOp);
-      break;
-    default:
-      llvm_unreachable("scheduling method not supported currently");
+      return WalkResult::advance();
+    auto circuitSequenceOp = sequenceDurations.getSequenceOp(callSequenceOp);
+    assert(circuitSequenceOp && "matching sequence not found");
+    auto [it, inserted] =
+        scheduleIndices.try_emplace(circuitSequenceOp.getOperation(),
+                                    schedules.size());
+    if (inserted) {
+      schedules.emplace_back();
+      if (!loadCachedSchedule(circuitSequenceOp, schedules.back()) &&
+          failed(collectGateCalls(circuitSequenceOp, schedules.back(),
+                                  sequenceDurations)))
+        return WalkResult::interrupt();
     }
+    circuitCalls.emplace_back(callSequenceOp, it->second);
+    return WalkResult::advance();
   });
+  if (result.wasInterrupted()) {
+    signalPassFailure();
+    return;
+  }
+
+  // the circuits are scheduled independently of each other, without touching
+  // the IR, other than those whose schedules are cached
+  mlir::parallelForEach(&getContext(), schedules,
+                        [&](CircuitSchedule &schedule) {
+                          if (schedule.cached)
+                            return;
+                          switch (SCHEDULING_METHOD) {
+                          case ALAP:
+                            scheduleAlap(schedule);
+                            break;
+                          case ASAP:
+                            scheduleAsap(schedule);
+                            break;
+                          }
+                          collectPortUsages(schedule);
+                          cacheSchedule(schedule);
+                        });
+
+  for (auto &schedule : schedules) {
+    // a circuit measured on hardware to take longer than its schedule, see
+    // ApplyRuntimeProfilePass, keeps its gates where they are scheduled, and
+    // thus its timepoint, but its calls last the measured duration
+    if (auto measured = schedule.sequenceOp->getAttrOfType<IntegerAttr>(
+            "pulse.measuredDuration"))
+      schedule.duration = std::max(schedule.duration, measured.getInt());
+    LLVM_DEBUG(llvm::dbgs() << "\nscheduled "
+                            << schedule.sequenceOp.getSymName()
+                            << " with duration " << schedule.duration << "\n");
+    for (auto &gateCall : schedule.gateCalls)
+      PulseOpSchedulingInterface::setTimepoint(gateCall.callSequenceOp,
+                                               gateCall.timepoint);
+  }
+
+  for (auto [callSequenceOp, scheduleIndex] : circuitCalls) {
+    auto const &schedule = schedules[scheduleIndex];
+    // setting duration of the quantum call circuit
+    PulseOpSchedulingInterface::setDuration(callSequenceOp, schedule.duration);
+    // setting timepoint of the quantum call circuit, which later passes need
+    // to add as an offset to the timepoints of its gates to determine their
+    // effective timepoints
+    PulseOpSchedulingInterface::setTimepoint(callSequenceOp,
+                                             schedule.timepoint);
+  }
+
+  if (globalScheduling)
+    scheduleCircuitCalls(circuitCalls, schedules);
+
+  // only the timepoints and durations of calls are set
+  markAnalysesPreserved<SequenceDurationAnalysis>();
 }
 
-void QuantumCircuitPulseSchedulingPass::scheduleAlap(
-    mlir::pulse::CallSequenceOp quantumCircuitCallSequenceOp) {
-
-  auto quantumCircuitSequenceOp = getSequenceOp(quantumCircuitCallSequenceOp);
-  std::string const sequenceName = quantumCircuitSequenceOp.getSymName().str();
-  LLVM_DEBUG(llvm::dbgs() << "\nscheduling " << sequenceName << "\n");
-
-  int totalDurationOfQuantumCircuitNegative = 0;
-  portNameToNextAvailabilityMap.clear();
-
-  // get the MLIR block of the quantum circuit
-  auto quantumCircuitSequenceOpBlock =
-      quantumCircuitSequenceOp.getBody().begin();
-  // go over the MLIR operation of the block in reverse order, and find
-  // CallSequenceOps, each of which corresponds to a quantum gate. for each
-  // CallSequenceOps, we add a timepoint based on the availability of involved
-  // ports; timepoints are <=0 because we're walking in reverse order. Note this
-  // pass assumes that the operations inside these CallSequenceOps are already
-  // scheduled
-  for (auto opIt = quantumCircuitSequenceOpBlock->rbegin(),
-            opEnd = quantumCircuitSequenceOpBlock->rend();
-       opIt != opEnd; ++opIt) {
-    auto &op = *opIt;
-    if (auto quantumGateCallSequenceOp =
-            dyn_cast<mlir::pulse::CallSequenceOp>(op)) {
-      // find quantum gate SequenceOp
-      auto quantumGateSequenceOp = getSequenceOp(quantumGateCallSequenceOp);
-      const std::string quantumGateSequenceName =
-          quantumGateSequenceOp.getSymName().str();
-      LLVM_DEBUG(llvm::dbgs() << "\tprocessing inner sequence "
-                              << quantumGateSequenceName << "\n");
-
-      // find ports of the quantum gate SequenceOp
-      auto portsOrError =
-          PulseOpSchedulingInterface::getPorts(quantumGateSequenceOp);
-      if (auto err = portsOrError.takeError()) {
-        quantumGateSequenceOp.emitError() << toString(std::move(err));
-        signalPassFailure();
-      }
-      auto ports = portsOrError.get();
-
-      // find duration of the quantum gate callSequenceOp
-      llvm::Expected<uint64_t> durOrError =
-          quantumGateSequenceOp.getDuration(quantumGateCallSequenceOp);
-      if (auto err = durOrError.takeError()) {
-        quantumGateSequenceOp.emitError() << toString(std::move(err));
-        signalPassFailure();
-      }
-      const uint64_t quantumGateCallSequenceOpDuration = durOrError.get();
-      LLVM_DEBUG(llvm::dbgs() << "\t\tduration "
-                              << quantumGateCallSequenceOpDuration << "\n");
-
-      // find next available time for all the ports
-      const int nextAvailableTimeOfAllPorts =
-          getNextAvailableTimeOfPorts(ports);
-      LLVM_DEBUG(llvm::dbgs() << "\t\tnext availability is at "
-                              << nextAvailableTimeOfAllPorts << "\n");
-
-      // find the updated available time, i.e., when the current quantum gate
-      // will be scheduled
-      const int updatedAvailableTime =
-          nextAvailableTimeOfAllPorts - quantumGateCallSequenceOpDuration;
-      LLVM_DEBUG(llvm::dbgs() << "\t\tcurrent gate scheduled at "
-                              << updatedAvailableTime << "\n");
-      // update the port availability map
-      updatePortAvailabilityMap(ports, updatedAvailableTime);
-
-      // keep track of total duration of the quantum circuit
-      if (updatedAvailableTime < totalDurationOfQuantumCircuitNegative)
-        totalDurationOfQuantumCircuitNegative = updatedAvailableTime;
-
-      // set the timepoint of quantum gate
-      PulseOpSchedulingInterface::setTimepoint(quantumGateCallSequenceOp,
-                                               updatedAvailableTime);
+mlir::LogicalResult QuantumCircuitPulseSchedulingPass::collectGateCalls(
+    SequenceOp circuitSequenceOp, CircuitSchedule &schedule,
+    SequenceDurationAnalysis &sequenceDurations) {
+  schedule.sequenceOp = circuitSequenceOp;
+
+  // each CallSequenceOp of the circuit corresponds to a quantum gate. Note
+  // this pass assumes that the operations inside these CallSequenceOps are
+  // already scheduled
+  for (auto quantumGateCallSequenceOp :
+       circuitSequenceOp.getBody().front().getOps<CallSequenceOp>()) {
+    auto quantumGateSequenceOp =
+        sequenceDurations.getSequenceOp(quantumGateCallSequenceOp);
+    assert(quantumGateSequenceOp && "matching sequence not found");
+
+    // find ports of the quantum gate SequenceOp
+    auto portsOrError = sequenceDurations.getPorts(quantumGateCallSequenceOp);
+    if (auto err = portsOrError.takeError()) {
+      quantumGateSequenceOp.emitError() << toString(std::move(err));
+      return failure();
+    }
+
+    // find duration of the quantum gate callSequenceOp
+    llvm::Expected<uint64_t> durOrError =
+        sequenceDurations.getDuration(quantumGateCallSequenceOp);
+    if (auto err = durOrError.takeError()) {
+      quantumGateSequenceOp.emitError() << toString(std::move(err));
+      return failure();
     }
+
+    GateCall gateCall{quantumGateCallSequenceOp, durOrError.get(), {}};
+    for (auto attr : portsOrError.get()) {
+      auto portName = attr.dyn_cast<StringAttr>();
+      if (portName && !portName.getValue().empty())
+        gateCall.portIds.push_back(getPortId(portName));
+    }
+    schedule.gateCalls.push_back(std::move(gateCall));
+  }
+  return success();
+}
+
+bool QuantumCircuitPulseSchedulingPass::loadCachedSchedule(
+    SequenceOp circuitSequenceOp, CircuitSchedule &schedule) {
+  auto cacheKey = circuitSequenceOp->getAttrOfType<StringAttr>(
+      LoweredCircuitCache::circuitKeyAttrName);
+  if (!cacheKey)
+    return false;
+  schedule.cacheKey = cacheKey.getValue();
+  auto cached = LoweredCircuitCache::global().lookupSchedule(
+      schedule.cacheKey, getSchedulingMethodName());
+  if (!cached)
+    return false;
+
+  // the gate calls of the cached sequence are those it was scheduled with,
+  // unless a pass changed the sequence since
+  auto gateCallOps =
+      circuitSequenceOp.getBody().front().getOps<CallSequenceOp>();
+  if (static_cast<size_t>(std::distance(gateCallOps.begin(),
+                                        gateCallOps.end())) !=
+      cached->gateTimepoints.size())
+    return false;
+
+  schedule.sequenceOp = circuitSequenceOp;
+  for (auto [gateCallOp, timepoint] :
+       llvm::zip(gateCallOps, cached->gateTimepoints)) {
+    GateCall gateCall{gateCallOp, 0, {}};
+    gateCall.timepoint = timepoint;
+    schedule.gateCalls.push_back(std::move(gateCall));
   }
+  schedule.duration = cached->duration;
+  schedule.timepoint = cached->timepoint;
+  for (auto const &usage : cached->portUsages)
+    schedule.portUsages.push_back(
+        {getPortId(StringAttr::get(&getContext(), usage.portName)),
+         usage.begin, usage.end});
+  schedule.cached = true;
+  ++numCacheHits;
+  return true;
+}
 
-  // multiply by -1 so that quantum circuit duration becomes positive
-  const int totalDurationOfQuantumCircuit =
-      -totalDurationOfQuantumCircuitNegative;
-  LLVM_DEBUG(llvm::dbgs() << "\ttotal duration of quantum circuit "
-                          << totalDurationOfQuantumCircuit << "\n");
-
-  // setting duration of the quantum call circuit
-  PulseOpSchedulingInterface::setDuration(quantumCircuitCallSequenceOp,
-                                          totalDurationOfQuantumCircuit);
-  // setting timepoint of the quantum call circuit; at this point, we can add
-  // totalDurationOfQuantumCircuit to above <=0 timepoints, so that they become
-  // >=0, however, that would require walking the IR again. Instead, we add a
-  // postive timepoint to the parent op, i.e., quantum circuit call sequence op,
-  // and later passes would need to add this value as an offset to determine the
-  // effective timepoints
-  PulseOpSchedulingInterface::setTimepoint(quantumCircuitCallSequenceOp,
-                                           totalDurationOfQuantumCircuit);
+void QuantumCircuitPulseSchedulingPass::cacheSchedule(
+    const CircuitSchedule &schedule) const {
+  if (schedule.cacheKey.empty())
+    return;
+  LoweredCircuitSchedule cached;
+  for (auto const &gateCall : schedule.gateCalls)
+    cached.gateTimepoints.push_back(gateCall.timepoint);
+  cached.duration = schedule.duration;
+  cached.timepoint = schedule.timepoint;
+  for (auto const &usage : schedule.portUsages)
+    cached.portUsages.push_back(
+        {portNames[usage.portId].str(), usage.begin, usage.end});
+  LoweredCircuitCache::global().insertSchedule(
+      schedule.cacheKey, getSchedulingMethodName(), std::move(cached));
 }
 
-int QuantumCircuitPulseSchedulingPass::getNextAvailableTimeOfPorts(
-    mlir::ArrayAttr ports) {
-  int nextAvailableTimeOfAllPorts = 0;
-  for (auto attr : ports) {
-    const std::string portName = attr.dyn_cast<StringAttr>().getValue().str();
-    if (portName.empty())
-      continue;
-    if (portNameToNextAvailabilityMap.find(portName) !=
-        portNameToNextAvailabilityMap.end()) {
-      if (portNameToNextAvailabilityMap[portName] < nextAvailableTimeOfAllPorts)
-        nextAvailableTimeOfAllPorts = portNameToNextAvailabilityMap[portName];
-    }
+unsigned QuantumCircuitPulseSchedulingPass::getPortId(StringAttr portName) {
+  auto [it, inserted] = portIds.try_emplace(portName, portIds.size());
+  if (inserted)
+    portNames.push_back(portName);
+  return it->second;
+}
+
+llvm::StringRef
+QuantumCircuitPulseSchedulingPass::getSchedulingMethodName() const {
+  switch (SCHEDULING_METHOD) {
+  case ALAP:
+    return "alap";
+  case ASAP:
+    return "asap";
   }
-  return nextAvailableTimeOfAllPorts;
+  llvm_unreachable("unknown scheduling method");
 }
 
-void QuantumCircuitPulseSchedulingPass::updatePortAvailabilityMap(
-    mlir::ArrayAttr ports, int updatedAvailableTime) {
-  for (auto attr : ports) {
-    const std::string portName = attr.dyn_cast<StringAttr>().getValue().str();
-    if (portName.empty())
-      continue;
-    portNameToNextAvailabilityMap[portName] = updatedAvailableTime;
+void QuantumCircuitPulseSchedulingPass::scheduleAlap(
+    CircuitSchedule &schedule) const {
+  // go over the gates in reverse order, adding a timepoint to each based on
+  // the availability of involved ports; timepoints are <=0 because we're
+  // walking in reverse order
+  std::vector<int64_t> portAvailability(portIds.size(), 0);
+  int64_t totalDurationOfQuantumCircuitNegative = 0;
+  for (auto &gateCall : llvm::reverse(schedule.gateCalls)) {
+    // find next available time for all the ports
+    int64_t nextAvailableTimeOfAllPorts = 0;
+    for (unsigned const portId : gateCall.portIds)
+      nextAvailableTimeOfAllPorts =
+          std::min(nextAvailableTimeOfAllPorts, portAvailability[portId]);
+
+    // the current quantum gate is scheduled to end when its ports become
+    // available
+    gateCall.timepoint =
+        nextAvailableTimeOfAllPorts - static_cast<int64_t>(gateCall.duration);
+    for (unsigned const portId : gateCall.portIds)
+      portAvailability[portId] = gateCall.timepoint;
+
+    totalDurationOfQuantumCircuitNegative =
+        std::min(totalDurationOfQuantumCircuitNegative, gateCall.timepoint);
   }
+
+  // multiply by -1 so that quantum circuit duration becomes positive. We
+  // could add the duration to the above <=0 timepoints so that they become
+  // >=0, however, we add it as the timepoint of the quantum circuit call
+  // instead
+  schedule.duration = -totalDurationOfQuantumCircuitNegative;
+  schedule.timepoint = schedule.duration;
 }
 
-mlir::pulse::SequenceOp QuantumCircuitPulseSchedulingPass::getSequenceOp(
-    mlir::pulse::CallSequenceOp callSequenceOp) {
-  auto seqAttr = callSequenceOp->getAttrOfType<FlatSymbolRefAttr>("callee");
-  assert(seqAttr && "Requires a 'callee' symbol reference attribute");
+void QuantumCircuitPulseSchedulingPass::scheduleAsap(
+    CircuitSchedule &schedule) const {
+  // go over the gates in order, scheduling each as soon as all its ports are
+  // available; timepoints are >=0 so the quantum circuit call gets a zero
+  // timepoint
+  std::vector<int64_t> portAvailability(portIds.size(), 0);
+  int64_t totalDurationOfQuantumCircuit = 0;
+  for (auto &gateCall : schedule.gateCalls) {
+    int64_t nextAvailableTimeOfAllPorts = 0;
+    for (unsigned const portId : gateCall.portIds)
+      nextAvailableTimeOfAllPorts =
+          std::max(nextAvailableTimeOfAllPorts, portAvailability[portId]);
+
+    gateCall.timepoint = nextAvailableTimeOfAllPorts;
+    int64_t const endTime =
+        gateCall.timepoint + static_cast<int64_t>(gateCall.duration);
+    for (unsigned const portId : gateCall.portIds)
+      portAvailability[portId] = endTime;
 
-  auto sequenceOp =
-      SymbolTable::lookupNearestSymbolFrom<mlir::pulse::SequenceOp>(
-          callSequenceOp, seqAttr);
-  assert(sequenceOp && "matching sequence not found");
-  return sequenceOp;
+    totalDurationOfQuantumCircuit =
+        std::max(totalDurationOfQuantumCircuit, endTime);
+  }
+
+  schedule.duration = totalDurationOfQuantumCircuit;
+  schedule.timepoint = 0;
+}
+
+void QuantumCircuitPulseSchedulingPass::collectPortUsages(
+    CircuitSchedule &schedule) {
+  // the timepoints of the gates are offset by that of the circuit calls
+  llvm::DenseMap<unsigned, size_t> usageIndices;
+  for (auto const &gateCall : schedule.gateCalls) {
+    int64_t const begin = schedule.timepoint + gateCall.timepoint;
+    int64_t const end = begin + static_cast<int64_t>(gateCall.duration);
+    for (unsigned const portId : gateCall.portIds) {
+      auto [it, inserted] =
+          usageIndices.try_emplace(portId, schedule.portUsages.size());
+      if (inserted) {
+        schedule.portUsages.push_back({portId, begin, end});
+        continue;
+      }
+      auto &usage = schedule.portUsages[it->second];
+      usage.begin = std::min(usage.begin, begin);
+      usage.end = std::max(usage.end, end);
+    }
+  }
+}
+
+namespace {
+/// Whether callSequenceOp, following previousOp, may overlap with the calls
+/// of the run started by runStartOp, i.e., whether they are in the same
+/// block, only side-effect free operations without regions are in between,
+/// and the operands of callSequenceOp are defined before the run, e.g., not
+/// by the measurements of its calls.
+bool continuesRun(CallSequenceOp runStartOp, CallSequenceOp previousOp,
+                  CallSequenceOp callSequenceOp) {
+  if (callSequenceOp->getBlock() != previousOp->getBlock())
+    return false;
+  for (Operation *op = previousOp->getNextNode(); op != callSequenceOp;
+       op = op->getNextNode())
+    if (!op || op->getNumRegions() != 0 || !isMemoryEffectFree(op))
+      return false;
+  return llvm::none_of(callSequenceOp->getOperands(), [&](Value operand) {
+    Operation *definingOp = operand.getDefiningOp();
+    return definingOp && definingOp->getBlock() == runStartOp->getBlock() &&
+           !definingOp->isBeforeInBlock(runStartOp);
+  });
+}
+} // anonymous namespace
+
+void QuantumCircuitPulseSchedulingPass::scheduleCircuitCalls(
+    llvm::ArrayRef<std::pair<CallSequenceOp, size_t>> circuitCalls,
+    llvm::ArrayRef<CircuitSchedule> schedules) const {
+  // the circuits keep their schedules, shared by their calls, and each call
+  // starts as soon as the ports of its circuit are free, in order of the
+  // calls. The times are relative to the start of the run of calls
+  std::vector<int64_t> portAvailability(portIds.size(), 0);
+  std::vector<int64_t> starts;
+  size_t runBegin = 0;
+  int64_t runEnd = 0;
+
+  // the duration of a call of a run is the time until the next one starts,
+  // and that of the last one the time until all calls of the run end
+  auto finishRun = [&](size_t runEndIndex) {
+    for (size_t i = runBegin; i < runEndIndex; ++i) {
+      int64_t const start = starts[i - runBegin];
+      int64_t const next =
+          i + 1 < runEndIndex ? starts[i + 1 - runBegin] : runEnd;
+      PulseOpSchedulingInterface::setDuration(circuitCalls[i].first,
+                                              next - start);
+    }
+    LLVM_DEBUG(llvm::dbgs() << "scheduled " << runEndIndex - runBegin
+                            << " circuit calls with duration " << runEnd
+                            << "\n");
+  };
+
+  for (size_t i = 0; i < circuitCalls.size(); ++i) {
+    auto [callSequenceOp, scheduleIndex] = circuitCalls[i];
+    // a repeated call, see RerollSequencesPass, keeps the duration of a
+    // single run of its circuit and is thus not overlapped with others
+    auto isRepeated = [](CallSequenceOp op) {
+      return SequenceDurationAnalysis::getRepeats(op) != 1;
+    };
+    if (i != runBegin &&
+        (isRepeated(callSequenceOp) || isRepeated(circuitCalls[i - 1].first) ||
+         !continuesRun(circuitCalls[runBegin].first, circuitCalls[i - 1].first,
+                       callSequenceOp))) {
+      finishRun(i);
+      runBegin = i;
+      starts.clear();
+      runEnd = 0;
+      std::fill(portAvailability.begin(), portAvailability.end(), 0);
+    }
+
+    auto const &schedule = schedules[scheduleIndex];
+    int64_t start = starts.empty() ? 0 : starts.back();
+    for (auto const &usage : schedule.portUsages)
+      start = std::max(start, portAvailability[usage.portId] - usage.begin);
+    for (auto const &usage : schedule.portUsages)
+      portAvailability[usage.portId] = start + usage.end;
+    runEnd = std::max(runEnd, start + schedule.duration);
+    starts.push_back(start);
+  }
+  if (!circuitCalls.empty())
+    finishRun(circuitCalls.size());
 }
 
 llvm::StringRef QuantumCircuitPulseSchedulingPass::getArgument() const {
@@ -0,0 +1,52 @@
+//===- ClassicalOnlyAnalysis.cpp - Operations without pulse ops -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the analysis which finds the operations containing
+///  Pulse dialect operations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Utils/ClassicalOnlyAnalysis.h"
+
+#include "Dialect/Pulse/IR/PulseDialect.h"
+
+#include "mlir/IR/Operation.h"
+
+#include "llvm/Support/Casting.h"
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+bool isPulseOp(Operation *op) {
+  return llvm::isa_and_nonnull<PulseDialect>(op->getDialect());
+}
+} // anonymous namespace
+
+ClassicalOnlyAnalysis::ClassicalOnlyAnalysis(Operation *op) {
+  // The walk is post-order, so an operation has been marked by the
+  // operations nested in it by the time it is visited.
+  op->walk([&](Operation *nestedOp) {
+    if (nestedOp == op || !hasPulseOps(nestedOp))
+      return;
+    if (Operation *parentOp = nestedOp->getParentOp())
+      withPulseOps.insert(parentOp);
+  });
+}
+
+bool ClassicalOnlyAnalysis::hasPulseOps(Operation *op) const {
+  return isPulseOp(op) || withPulseOps.contains(op);
+}
@@ -0,0 +1,103 @@
+//===- LoweredCircuitCache.cpp - Cache of lowered circuits ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the process wide cache of the pulse sequences which
+///  quir circuits were lowered to, and of their schedules.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Utils/LoweredCircuitCache.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+using namespace mlir::pulse;
+
+namespace {
+llvm::ManagedStatic<LoweredCircuitCache> globalLoweredCircuitCache;
+
+std::string getScheduleKey(llvm::StringRef key, llvm::StringRef method) {
+  return (key + "/" + method).str();
+}
+} // anonymous namespace
+
+LoweredCircuitCache &LoweredCircuitCache::global() {
+  return *globalLoweredCircuitCache;
+}
+
+std::shared_ptr<const LoweredCircuit>
+LoweredCircuitCache::lookup(llvm::StringRef key) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto entry = circuits.find(key);
+  if (entry == circuits.end())
+    return nullptr;
+  return entry->second;
+}
+
+void LoweredCircuitCache::insert(llvm::StringRef key, LoweredCircuit circuit) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto replaced = circuits.find(key);
+  size_t const replacedBytes =
+      replaced == circuits.end() ? 0 : replaced->second->bytecode.size();
+  if (numBytes - replacedBytes + circuit.bytecode.size() > maxBytes) {
+    circuits.clear();
+    schedules.clear();
+    numBytes = 0;
+  } else
+    numBytes -= replacedBytes;
+  numBytes += circuit.bytecode.size();
+  circuits[key] = std::make_shared<const LoweredCircuit>(std::move(circuit));
+}
+
+std::shared_ptr<const LoweredCircuitSchedule>
+LoweredCircuitCache::lookupSchedule(llvm::StringRef key,
+                                    llvm::StringRef method) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto entry = schedules.find(getScheduleKey(key, method));
+  if (entry == schedules.end())
+    return nullptr;
+  return entry->second;
+}
+
+void LoweredCircuitCache::insertSchedule(llvm::StringRef key,
+                                         llvm::StringRef method,
+                                         LoweredCircuitSchedule schedule) {
+  // a schedule is only kept along with its circuit
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (!circuits.count(key))
+    return;
+  schedules[getScheduleKey(key, method)] =
+      std::make_shared<const LoweredCircuitSchedule>(std::move(schedule));
+}
+
+size_t LoweredCircuitCache::size() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return circuits.size();
+}
+
+void LoweredCircuitCache::clear() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  circuits.clear();
+  schedules.clear();
+  numBytes = 0;
+}
@@ -0,0 +1,98 @@
+//===- SequenceDurationAnalysis.cpp - Cached sequence durations -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the analysis which caches the callee, duration and
+///  ports of the sequences called by pulse.call_sequence ops.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Utils/SequenceDurationAnalysis.h"
+
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+
+#include "llvm/Support/Error.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+SequenceDurationAnalysis::SequenceDurationAnalysis(Operation * /*op*/) {}
+
+const SequenceDurationAnalysis::SequenceInfo &
+SequenceDurationAnalysis::getSequenceInfo(CallSequenceOp callSequenceOp) {
+  auto sequenceOp = symbolTables.lookupNearestSymbolFrom<SequenceOp>(
+      callSequenceOp, callSequenceOp.getCalleeAttr());
+  auto [it, inserted] = sequences.try_emplace(sequenceOp.getOperation());
+  auto &info = it->second;
+  if (!inserted || !sequenceOp)
+    return info;
+
+  info.sequenceOp = sequenceOp;
+  if (auto duration =
+          sequenceOp->getAttrOfType<IntegerAttr>("pulse.duration"))
+    info.duration = static_cast<uint64_t>(duration.getInt());
+  // a duration measured on hardware, see ApplyRuntimeProfilePass, only
+  // lengthens the sequence
+  if (auto measured =
+          sequenceOp->getAttrOfType<IntegerAttr>("pulse.measuredDuration"))
+    if (info.duration)
+      info.duration = std::max(*info.duration,
+                               static_cast<uint64_t>(measured.getInt()));
+  info.ports = sequenceOp->getAttrOfType<ArrayAttr>("pulse.argPorts");
+  return info;
+}
+
+SequenceOp
+SequenceDurationAnalysis::getSequenceOp(CallSequenceOp callSequenceOp) {
+  return getSequenceInfo(callSequenceOp).sequenceOp;
+}
+
+llvm::Expected<uint64_t>
+SequenceDurationAnalysis::getDuration(CallSequenceOp callSequenceOp) {
+  // as in SequenceOp::getDuration, the duration of the call is only used for
+  // the sequences whose duration depends on their arguments
+  const auto &info = getSequenceInfo(callSequenceOp);
+  if (info.duration)
+    return *info.duration * getRepeats(callSequenceOp);
+  if (auto duration =
+          callSequenceOp->getAttrOfType<IntegerAttr>("pulse.duration"))
+    return static_cast<uint64_t>(duration.getInt()) *
+           getRepeats(callSequenceOp);
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Operation does not have a pulse.duration attribute.");
+}
+
+uint64_t SequenceDurationAnalysis::getRepeats(CallSequenceOp callSequenceOp) {
+  if (auto repeat = callSequenceOp->getAttrOfType<IntegerAttr>("pulse.repeat"))
+    return static_cast<uint64_t>(repeat.getInt());
+  return 1;
+}
+
+llvm::Expected<ArrayAttr>
+SequenceDurationAnalysis::getPorts(CallSequenceOp callSequenceOp) {
+  const auto &info = getSequenceInfo(callSequenceOp);
+  if (info.ports)
+    return info.ports;
+  return llvm::createStringError(
+      llvm::inconvertibleErrorCode(),
+      "Operation does not have a pulse.argPorts attribute.");
+}
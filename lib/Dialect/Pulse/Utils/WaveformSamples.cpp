@@ -0,0 +1,111 @@
+//===- WaveformSamples.cpp - Storage of waveform samples --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the storage of the samples of pulse.create_waveform
+///  ops.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Utils/WaveformSamples.h"
+
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/ArrayRef.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+namespace {
+/// Append the bytes of value to buffer, in the byte order of the host.
+template <typename T>
+void append(std::vector<char> &buffer, T value) {
+  size_t const offset = buffer.size();
+  buffer.resize(offset + sizeof(T));
+  std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+} // anonymous namespace
+
+WaveformSamples mlir::pulse::storeSamples(MLIRContext *context,
+                                          llvm::ArrayRef<double> samples,
+                                          SampleFormat format,
+                                          bool useResource) {
+  WaveformSamples stored;
+  Type elementType;
+  size_t width = 0;
+  std::vector<char> buffer;
+
+  switch (format) {
+  case SampleFormat::F64:
+    elementType = Float64Type::get(context);
+    width = sizeof(double);
+    buffer.reserve(samples.size() * width);
+    for (double const sample : samples)
+      append(buffer, sample);
+    break;
+  case SampleFormat::F16:
+    elementType = Float16Type::get(context);
+    width = sizeof(uint16_t);
+    buffer.reserve(samples.size() * width);
+    for (double const sample : samples) {
+      llvm::APFloat value(sample);
+      bool losesInfo = false;
+      value.convert(llvm::APFloat::IEEEhalf(),
+                    llvm::APFloat::rmNearestTiesToEven, &losesInfo);
+      append(buffer,
+             static_cast<uint16_t>(value.bitcastToAPInt().getZExtValue()));
+    }
+    break;
+  case SampleFormat::I16: {
+    elementType = IntegerType::get(context, 16);
+    width = sizeof(int16_t);
+    double maxMagnitude = 1.0;
+    for (double const sample : samples)
+      maxMagnitude = std::max(maxMagnitude, std::abs(sample));
+    double const maxCode = std::numeric_limits<int16_t>::max();
+    if (maxMagnitude > 1.0)
+      stored.scale =
+          FloatAttr::get(Float64Type::get(context), maxMagnitude / maxCode);
+    buffer.reserve(samples.size() * width);
+    for (double const sample : samples)
+      append(buffer, static_cast<int16_t>(std::clamp(
+                         std::round(sample / maxMagnitude * maxCode),
+                         -maxCode, maxCode)));
+    break;
+  }
+  }
+
+  auto samplesType = RankedTensorType::get(
+      {static_cast<int64_t>(samples.size() / 2), 2}, elementType);
+  if (useResource)
+    stored.samples = DenseResourceElementsAttr::get(
+        samplesType, "pulse_waveform",
+        HeapAsmResourceBlob::allocateAndCopyWithAlign(buffer, width));
+  else
+    stored.samples = DenseElementsAttr::getFromRawBuffer(samplesType, buffer);
+  return stored;
+}
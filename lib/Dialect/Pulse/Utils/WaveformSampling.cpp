@@ -0,0 +1,251 @@
+//===- WaveformSampling.cpp - Parametric waveform samples -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the evaluation of the samples of the parametric
+///  waveforms of the Pulse dialect.
+///
+///  Evaluating the exponentials dominates the cost of the Gaussian based
+///  waveforms, so they are evaluated in blocks by an AVX2 or NEON kernel,
+///  selected for the host at run time, with a scalar fallback.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PULSE_SAMPLING_AVX2
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define PULSE_SAMPLING_NEON
+#include <arm_neon.h>
+#endif
+
+namespace mlir::pulse {
+
+namespace {
+
+// exp(x) = 2^k * exp(r) with k = round(x / ln 2) and |r| <= ln(2) / 2, where
+// ln 2 is split in two to compute r exactly and exp(r) is approximated by
+// its Taylor polynomial of degree 13, accurate to about an ulp. Arguments
+// outside [minExpArg, maxExpArg], for which 2^k is not a normal double, and
+// NaNs are left to std::exp.
+constexpr double log2e = 1.4426950408889634;
+constexpr double ln2Hi = 6.93147180369123816490e-01;
+constexpr double ln2Lo = 1.90821492927058770002e-10;
+constexpr double minExpArg = -708.0;
+constexpr double maxExpArg = 709.0;
+constexpr std::array<double, 14> expCoefficients = {
+    1.0,
+    1.0,
+    1.0 / 2,
+    1.0 / 6,
+    1.0 / 24,
+    1.0 / 120,
+    1.0 / 720,
+    1.0 / 5040,
+    1.0 / 40320,
+    1.0 / 362880,
+    1.0 / 3628800,
+    1.0 / 39916800,
+    1.0 / 479001600,
+    1.0 / 6227020800};
+
+/// The number of samples whose exponentials are evaluated at once.
+constexpr size_t blockSize = 256;
+
+void expScalar(double *values, size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    values[i] = std::exp(values[i]);
+}
+
+#if defined(PULSE_SAMPLING_AVX2)
+__attribute__((target("avx2,fma"))) void expAvx2(double *values,
+                                                 size_t size) {
+  __m256d const log2eVec = _mm256_set1_pd(log2e);
+  __m256d const ln2HiVec = _mm256_set1_pd(ln2Hi);
+  __m256d const ln2LoVec = _mm256_set1_pd(ln2Lo);
+  __m256d const minArgVec = _mm256_set1_pd(minExpArg);
+  __m256d const maxArgVec = _mm256_set1_pd(maxExpArg);
+  __m256i const biasVec = _mm256_set1_epi64x(1023);
+
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256d const x = _mm256_loadu_pd(values + i);
+    __m256d const inRange =
+        _mm256_and_pd(_mm256_cmp_pd(x, minArgVec, _CMP_GE_OQ),
+                      _mm256_cmp_pd(x, maxArgVec, _CMP_LE_OQ));
+    if (_mm256_movemask_pd(inRange) != 0xf) {
+      expScalar(values + i, 4);
+      continue;
+    }
+
+    __m256d const k = _mm256_round_pd(_mm256_mul_pd(x, log2eVec),
+                                      _MM_FROUND_TO_NEAREST_INT |
+                                          _MM_FROUND_NO_EXC);
+    __m256d const r =
+        _mm256_fnmadd_pd(k, ln2LoVec, _mm256_fnmadd_pd(k, ln2HiVec, x));
+    __m256d p = _mm256_set1_pd(expCoefficients.back());
+    for (size_t c = expCoefficients.size() - 1; c-- > 0;)
+      p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(expCoefficients[c]));
+
+    __m256i const exponent = _mm256_add_epi64(
+        _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k)), biasVec);
+    __m256d const scale = _mm256_castsi256_pd(_mm256_slli_epi64(exponent, 52));
+    _mm256_storeu_pd(values + i, _mm256_mul_pd(p, scale));
+  }
+  expScalar(values + i, size - i);
+}
+#elif defined(PULSE_SAMPLING_NEON)
+void expNeon(double *values, size_t size) {
+  float64x2_t const log2eVec = vdupq_n_f64(log2e);
+  float64x2_t const ln2HiVec = vdupq_n_f64(ln2Hi);
+  float64x2_t const ln2LoVec = vdupq_n_f64(ln2Lo);
+  float64x2_t const minArgVec = vdupq_n_f64(minExpArg);
+  float64x2_t const maxArgVec = vdupq_n_f64(maxExpArg);
+  int64x2_t const biasVec = vdupq_n_s64(1023);
+
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    float64x2_t const x = vld1q_f64(values + i);
+    uint64x2_t const inRange =
+        vandq_u64(vcgeq_f64(x, minArgVec), vcleq_f64(x, maxArgVec));
+    if (!vgetq_lane_u64(inRange, 0) || !vgetq_lane_u64(inRange, 1)) {
+      expScalar(values + i, 2);
+      continue;
+    }
+
+    float64x2_t const k = vrndnq_f64(vmulq_f64(x, log2eVec));
+    float64x2_t const r = vfmsq_f64(vfmsq_f64(x, k, ln2HiVec), k, ln2LoVec);
+    float64x2_t p = vdupq_n_f64(expCoefficients.back());
+    for (size_t c = expCoefficients.size() - 1; c-- > 0;)
+      p = vfmaq_f64(vdupq_n_f64(expCoefficients[c]), p, r);
+
+    int64x2_t const exponent = vaddq_s64(vcvtq_s64_f64(k), biasVec);
+    float64x2_t const scale = vreinterpretq_f64_s64(vshlq_n_s64(exponent, 52));
+    vst1q_f64(values + i, vmulq_f64(p, scale));
+  }
+  expScalar(values + i, size - i);
+}
+#endif
+
+struct ExpKernel {
+  llvm::StringRef name;
+  void (*exp)(double *values, size_t size);
+};
+
+const ExpKernel &getExpKernel() {
+  static const ExpKernel kernel = []() -> ExpKernel {
+#if defined(PULSE_SAMPLING_AVX2)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return {"avx2", expAvx2};
+#elif defined(PULSE_SAMPLING_NEON)
+    return {"neon", expNeon};
+#endif
+    return {"scalar", expScalar};
+  }();
+  return kernel;
+}
+
+/// Write amp * (g(t) + i * beta * g'(t)), where g is 1 on the flat top
+/// [center - width / 2, center + width / 2] and falls off on either side as
+/// a Gaussian of standard deviation sigma, lifted to be zero at times -1 and
+/// dur + 1. Both edges are at the same distance from the flat top.
+void sampleLiftedGaussian(std::complex<double> amp, double sigma,
+                          double width, double beta,
+                          llvm::MutableArrayRef<double> samples) {
+  assert(samples.size() % 2 == 0 && "samples must be [real, imag] pairs");
+  assert(sigma > 0 && "sigma must be positive");
+  assert(width >= 0 && "width must not be negative");
+
+  size_t const dur = samples.size() / 2;
+  double const center = static_cast<double>(dur) / 2;
+  double const flatBegin = center - width / 2;
+  double const flatEnd = center + width / 2;
+
+  double const zeroDistance = (-1.0 - flatBegin) / sigma;
+  double const offset = std::exp(-0.5 * zeroDistance * zeroDistance);
+  double const scale = 1.0 / (1.0 - offset);
+  double const derivativeScale = -beta * scale / (sigma * sigma);
+
+  auto const &kernel = getExpKernel();
+  std::array<double, blockSize> distances;
+  std::array<double, blockSize> envelopes;
+  for (size_t begin = 0; begin < dur; begin += blockSize) {
+    size_t const count = std::min(blockSize, dur - begin);
+    for (size_t i = 0; i < count; ++i) {
+      double const time = static_cast<double>(begin + i) + 0.5;
+      double const distance =
+          std::min(time - flatBegin, 0.0) + std::max(time - flatEnd, 0.0);
+      double const x = distance / sigma;
+      distances[i] = distance;
+      envelopes[i] = -0.5 * x * x;
+    }
+    kernel.exp(envelopes.data(), count);
+
+    double *out = samples.data() + 2 * begin;
+    for (size_t i = 0; i < count; ++i) {
+      double const real = (envelopes[i] - offset) * scale;
+      double const imag = derivativeScale * distances[i] * envelopes[i];
+      out[2 * i] = amp.real() * real - amp.imag() * imag;
+      out[2 * i + 1] = amp.imag() * real + amp.real() * imag;
+    }
+  }
+}
+
+} // anonymous namespace
+
+void sampleConstWaveform(std::complex<double> amp,
+                         llvm::MutableArrayRef<double> samples) {
+  assert(samples.size() % 2 == 0 && "samples must be [real, imag] pairs");
+  for (size_t i = 0; i < samples.size(); i += 2) {
+    samples[i] = amp.real();
+    samples[i + 1] = amp.imag();
+  }
+}
+
+void sampleGaussianWaveform(std::complex<double> amp, double sigma,
+                            llvm::MutableArrayRef<double> samples) {
+  sampleLiftedGaussian(amp, sigma, /*width=*/0.0, /*beta=*/0.0, samples);
+}
+
+void sampleGaussianSquareWaveform(std::complex<double> amp, double sigma,
+                                  double width,
+                                  llvm::MutableArrayRef<double> samples) {
+  sampleLiftedGaussian(amp, sigma, width, /*beta=*/0.0, samples);
+}
+
+void sampleDragWaveform(std::complex<double> amp, double sigma, double beta,
+                        llvm::MutableArrayRef<double> samples) {
+  sampleLiftedGaussian(amp, sigma, /*width=*/0.0, beta, samples);
+}
+
+void expInPlace(llvm::MutableArrayRef<double> values) {
+  getExpKernel().exp(values.data(), values.size());
+}
+
+llvm::StringRef getWaveformSamplingKernel() { return getExpKernel().name; }
+
+} // namespace mlir::pulse
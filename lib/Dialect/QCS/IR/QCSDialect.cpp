@@ -20,6 +20,7 @@
 
 #include "Dialect/QCS/IR/QCSDialect.h"
 
+#include "Dialect/DialectBytecode.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/QCS/IR/QCSAttributes.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
@@ -38,6 +39,11 @@ using namespace mlir::qcs;
 // Quantum Control System dialect
 //===----------------------------------------------------------------------===//
 
+// Bytecode of the dialect, whose version is to be bumped whenever bytecode
+// written by the previous version no longer parses.
+using QCSBytecodeInterface =
+    qssc::dialect::VersionedBytecodeInterface</*Version=*/0>;
+
 void QCSDialect::initialize() {
 
   addOperations<
@@ -45,4 +51,6 @@ void QCSDialect::initialize() {
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/QCS/IR/QCSOps.cpp.inc"
       >();
+
+  addInterfaces<QCSBytecodeInterface>();
 }
@@ -0,0 +1,344 @@
+//===- FoldParameterExpressions.cpp - Fold parameter arithmetic -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass folding the arithmetic over parameters into
+///  parameters derived from them, which are evaluated when the arguments of
+///  the program are bound.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QCS/Utils/FoldParameterExpressions.h"
+
+#include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cctype>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::qcs;
+
+namespace {
+/// Expressions longer than this are left to the controllers, as expressions
+/// grow exponentially with the depth of computations which reuse their
+/// intermediate results.
+constexpr size_t maxExpressionLength = 4096;
+
+/// An expression over parameters computing a value of the program.
+struct Expression {
+  /// The expression in the prefix form of the argument binder.
+  std::string text;
+  /// The value of the expression over the initial values of its parameters.
+  double initialValue;
+  /// The declaration of the first parameter of the expression, null if the
+  /// expression is constant.
+  DeclareParameterOp declaration;
+};
+
+/// Wrap an angle to [0, 2*pi), as (angle x) does when arguments are bound.
+double wrapAngle(double value) {
+  double const twoPi = 2.0 * llvm::numbers::pi;
+  double wrapped = std::fmod(value, twoPi);
+  if (wrapped < 0.0)
+    wrapped += twoPi;
+  return wrapped;
+}
+
+bool isParameterType(Type type) {
+  return type.isa<quir::AngleType>() || type.isF64();
+}
+
+/// Whether name may be a leaf of an expression, i.e., whether the argument
+/// binder reads it as the name of a parameter.
+bool isParameterName(llvm::StringRef name) {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name.front())) ||
+      name.front() == '-' || name.front() == '+' || name.front() == '.')
+    return false;
+  return llvm::none_of(name, [](char c) {
+    return c == '(' || c == ')' || std::isspace(static_cast<unsigned char>(c));
+  });
+}
+
+DeclareParameterOp lookupDeclaration(ParameterLoadOp loadOp) {
+  auto name = loadOp.getParameterNameAttr();
+  for (Operation *scope = loadOp; scope;
+       scope = scope->getParentOfType<ModuleOp>())
+    if (auto declOp =
+            SymbolTable::lookupNearestSymbolFrom<DeclareParameterOp>(scope,
+                                                                     name))
+      return declOp;
+  return nullptr;
+}
+
+std::optional<double> getInitialValue(DeclareParameterOp declOp) {
+  auto initialValue = declOp.getInitialValue();
+  if (!initialValue)
+    return std::nullopt;
+  if (auto angleAttr = initialValue->dyn_cast<quir::AngleAttr>())
+    return angleAttr.getValue().convertToDouble();
+  if (auto floatAttr = initialValue->dyn_cast<FloatAttr>())
+    return floatAttr.getValue().convertToDouble();
+  return std::nullopt;
+}
+
+/// The expressions of the values of a program, built on demand.
+class ExpressionBuilder {
+public:
+  /// The expression of value, null if value is not computed from parameters
+  /// and constants by arithmetic the argument binder evaluates.
+  const Expression *get(Value value) {
+    auto it = expressions.find(value);
+    if (it == expressions.end())
+      it = expressions.try_emplace(value, build(value)).first;
+    return it->second.get();
+  }
+
+  /// Whether the result of op is computed by the argument binder, i.e., op
+  /// is folded into the expressions of its users.
+  bool isFolded(Operation *op) {
+    return op->getNumResults() == 1 && get(op->getResult(0));
+  }
+
+private:
+  std::unique_ptr<Expression> build(Value value);
+
+  std::unique_ptr<Expression> constant(double value) {
+    if (!std::isfinite(value))
+      return nullptr;
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    os << llvm::format("%.17g", value);
+    os.flush();
+    return std::make_unique<Expression>(
+        Expression{std::move(text), value, nullptr});
+  }
+
+  llvm::DenseMap<Value, std::unique_ptr<Expression>> expressions;
+}; // class ExpressionBuilder
+
+std::unique_ptr<Expression> ExpressionBuilder::build(Value value) {
+  Operation *op = value.getDefiningOp();
+  if (!op || op->getNumResults() != 1 || !isParameterType(value.getType()))
+    return nullptr;
+
+  if (auto loadOp = dyn_cast<ParameterLoadOp>(op)) {
+    auto name = loadOp.getParameterName();
+    // a parameter derived by an earlier run is inlined as its expression
+    if (!name.startswith("(") && !isParameterName(name))
+      return nullptr;
+    auto declOp = lookupDeclaration(loadOp);
+    if (!declOp)
+      return nullptr;
+    auto initialValue = getInitialValue(declOp);
+    if (!initialValue)
+      return nullptr;
+    return std::make_unique<Expression>(
+        Expression{name.str(), *initialValue, declOp});
+  }
+
+  if (auto constantOp = dyn_cast<quir::ConstantOp>(op)) {
+    if (auto angleAttr = constantOp.getValue().dyn_cast<quir::AngleAttr>())
+      return constant(angleAttr.getValue().convertToDouble());
+    return nullptr;
+  }
+  if (auto constantOp = dyn_cast<arith::ConstantOp>(op)) {
+    if (auto floatAttr = constantOp.getValue().dyn_cast<FloatAttr>())
+      return constant(floatAttr.getValue().convertToDouble());
+    return nullptr;
+  }
+
+  llvm::StringRef const mnemonic =
+      llvm::TypeSwitch<Operation *, llvm::StringRef>(op)
+          .Case<oq3::AngleAddOp, arith::AddFOp>([](auto) { return "add"; })
+          .Case<oq3::AngleSubOp, arith::SubFOp>([](auto) { return "sub"; })
+          .Case<oq3::AngleMulOp, arith::MulFOp>([](auto) { return "mul"; })
+          .Case<oq3::AngleDivOp, arith::DivFOp>([](auto) { return "div"; })
+          .Case<arith::NegFOp>([](auto) { return "neg"; })
+          .Case<oq3::CastOp>([](auto) { return "angle"; })
+          .Default([](Operation *) { return ""; });
+  if (mnemonic.empty())
+    return nullptr;
+
+  // the operands may be built after this one, so their expressions are
+  // copied before those of the other operands are built
+  std::string text = "(";
+  text += mnemonic;
+  SmallVector<double, 2> operands;
+  DeclareParameterOp declaration;
+  for (Value operand : op->getOperands()) {
+    const auto *expression = get(operand);
+    if (!expression)
+      return nullptr;
+    text += ' ';
+    text += expression->text;
+    operands.push_back(expression->initialValue);
+    if (!declaration)
+      declaration = expression->declaration;
+  }
+  text += ')';
+
+  double initialValue = operands.front();
+  if (mnemonic == "add")
+    initialValue = operands[0] + operands[1];
+  else if (mnemonic == "sub")
+    initialValue = operands[0] - operands[1];
+  else if (mnemonic == "mul")
+    initialValue = operands[0] * operands[1];
+  else if (mnemonic == "div")
+    initialValue = operands[0] / operands[1];
+  else if (mnemonic == "neg")
+    initialValue = -operands[0];
+
+  // casts between angles, and from angles to floats, keep the value of
+  // their operand
+  if (isa<oq3::CastOp>(op) && !(value.getType().isa<quir::AngleType>() &&
+                                op->getOperand(0).getType().isF64())) {
+    text = get(op->getOperand(0))->text;
+  } else if (value.getType().isa<quir::AngleType>()) {
+    if (!isa<oq3::CastOp>(op))
+      text = "(angle " + text + ")";
+    initialValue = wrapAngle(initialValue);
+  }
+
+  if (text.size() > maxExpressionLength || !std::isfinite(initialValue))
+    return nullptr;
+  return std::make_unique<Expression>(
+      Expression{std::move(text), initialValue, declaration});
+}
+
+/// Get the declaration of the parameter derived by expression, next to that
+/// of its first parameter, creating it if needed. Null if the name of the
+/// parameter is declared with another type.
+DeclareParameterOp getOrCreateDeclaration(const Expression &expression,
+                                          Type type) {
+  auto *symbolTableOp = expression.declaration->getParentOp();
+  auto *existing = SymbolTable::lookupSymbolIn(symbolTableOp, expression.text);
+  if (existing) {
+    auto declOp = dyn_cast<DeclareParameterOp>(existing);
+    if (declOp && declOp.getType() == type)
+      return declOp;
+    return nullptr;
+  }
+
+  OpBuilder builder(expression.declaration->getContext());
+  builder.setInsertionPointAfter(expression.declaration);
+  Attribute initialValue;
+  if (auto angleType = type.dyn_cast<quir::AngleType>())
+    initialValue = quir::AngleAttr::get(builder.getContext(), angleType,
+                                        llvm::APFloat(expression.initialValue));
+  else
+    initialValue = builder.getFloatAttr(type, expression.initialValue);
+  return builder.create<DeclareParameterOp>(expression.declaration->getLoc(),
+                                            expression.text,
+                                            TypeAttr::get(type), initialValue);
+}
+} // anonymous namespace
+
+void FoldParameterExpressionsPass::runOnOperation() {
+  ExpressionBuilder builder;
+
+  // The roots of the expressions are the results which depend on parameters
+  // and are used by operations the argument binder does not compute, e.g.,
+  // the angles of gate calls. Their users are replaced once all roots are
+  // found, as the expressions of the roots refer to the operations which
+  // compute them.
+  SmallVector<std::pair<Operation *, const Expression *>> roots;
+  llvm::DenseSet<Operation *> folded;
+  getOperation()->walk([&](Operation *op) {
+    if (!builder.isFolded(op))
+      return;
+    folded.insert(op);
+    if (isa<ParameterLoadOp, quir::ConstantOp, arith::ConstantOp>(op))
+      return;
+    const auto *expression = builder.get(op->getResult(0));
+    if (!expression->declaration)
+      return;
+    if (llvm::any_of(op->getUsers(),
+                     [&](Operation *user) { return !builder.isFolded(user); }))
+      roots.emplace_back(op, expression);
+  });
+
+  for (auto [op, expression] : roots) {
+    Value result = op->getResult(0);
+    auto declOp = getOrCreateDeclaration(*expression, result.getType());
+    if (!declOp)
+      continue;
+
+    OpBuilder opBuilder(op);
+    auto loadOp = opBuilder.create<ParameterLoadOp>(
+        op->getLoc(), result.getType(),
+        FlatSymbolRefAttr::get(declOp.getSymNameAttr()));
+    result.replaceUsesWithIf(loadOp.getResult(), [&](OpOperand &use) {
+      return !builder.isFolded(use.getOwner());
+    });
+    ++numExpressionsFolded;
+  }
+
+  // erase the computations, loads and constants left without users
+  SmallVector<Operation *> worklist(folded.begin(), folded.end());
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    // an operation is pushed once per erased user, and may be erased already
+    if (!folded.contains(op) || !isOpTriviallyDead(op))
+      continue;
+    folded.erase(op);
+    for (Value operand : op->getOperands())
+      if (auto *definingOp = operand.getDefiningOp())
+        if (folded.contains(definingOp))
+          worklist.push_back(definingOp);
+    op->erase();
+  }
+} // FoldParameterExpressionsPass::runOnOperation
+
+llvm::StringRef FoldParameterExpressionsPass::getArgument() const {
+  return "qcs-fold-parameter-expressions";
+}
+
+llvm::StringRef FoldParameterExpressionsPass::getDescription() const {
+  return "Fold the arithmetic over parameters into derived parameters "
+         "evaluated when the arguments are bound";
+}
+
+llvm::StringRef FoldParameterExpressionsPass::getName() const {
+  return "Fold Parameter Expressions Pass";
+}
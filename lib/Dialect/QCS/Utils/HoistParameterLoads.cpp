@@ -0,0 +1,104 @@
+//===- HoistParameterLoads.cpp - Hoist parameters out of shots --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass hoisting the parameter loads of a shot loop,
+///  and the computations which only depend on them, in front of the loop.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QCS/Utils/HoistParameterLoads.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QCS/Utils/ShotLoop.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Transforms/LoopInvariantCodeMotionUtils.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+using namespace mlir;
+using namespace mlir::qcs;
+
+namespace {
+/// Whether op may be computed once in front of the shot loop rather than in
+/// every shot, given that its operands are. Operations with regions are left
+/// in place, as their regions may hold the side effects of a shot.
+bool isShotInvariant(Operation *op) {
+  if (isa<ParameterLoadOp>(op))
+    return true;
+  return op->getNumRegions() == 0 && isMemoryEffectFree(op);
+}
+} // anonymous namespace
+
+void HoistParameterLoadsPass::runOnOperation() {
+  SmallVector<scf::ForOp> shotLoops;
+  getOperation()->walk([&](scf::ForOp forOp) {
+    if (isShotLoop(forOp))
+      shotLoops.push_back(forOp);
+  });
+
+  for (auto shotLoop : shotLoops) {
+    Region &body = shotLoop.getRegion();
+
+    // Parameter loads have no operands, so those nested in the control flow
+    // of the shot body are hoisted as well as the others. The computations
+    // which depend on them stay in their regions, as they may not execute in
+    // every shot.
+    SmallVector<ParameterLoadOp> nestedLoads;
+    body.walk([&](ParameterLoadOp loadOp) {
+      if (loadOp->getParentRegion() != &body)
+        nestedLoads.push_back(loadOp);
+    });
+    for (auto loadOp : nestedLoads) {
+      loadOp->moveBefore(shotLoop);
+      ++numParameterLoadsHoisted;
+    }
+
+    moveLoopInvariantCode(
+        {&body},
+        [&](Value value, Region *) {
+          return shotLoop.isDefinedOutsideOfLoop(value);
+        },
+        [&](Operation *op, Region *) { return isShotInvariant(op); },
+        [&](Operation *op, Region *) {
+          op->moveBefore(shotLoop);
+          if (isa<ParameterLoadOp>(op))
+            ++numParameterLoadsHoisted;
+          else
+            ++numOpsHoisted;
+        });
+  }
+} // HoistParameterLoadsPass::runOnOperation
+
+llvm::StringRef HoistParameterLoadsPass::getArgument() const {
+  return "qcs-hoist-parameter-loads";
+}
+
+llvm::StringRef HoistParameterLoadsPass::getDescription() const {
+  return "Hoist the parameter loads of shot loops, and the side-effect free "
+         "operations which only depend on them, in front of the loops";
+}
+
+llvm::StringRef HoistParameterLoadsPass::getName() const {
+  return "Hoist Parameter Loads Pass";
+}
@@ -0,0 +1,219 @@
+//===- NarrowSynchronizations.cpp - Narrow qcs.synchronize ops --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass narrowing synchronizations to the qubits
+///  whose controllers depend on them.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QCS/Utils/NarrowSynchronizations.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/ValueRange.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <optional>
+
+using namespace mlir;
+using namespace mlir::qcs;
+using mlir::quir::QubitOpInterface;
+using mlir::quir::QubitSet;
+
+namespace {
+/// Get the qubits an operation uses, nested in its regions, on the
+/// quir.physicalId(s) attributes of the control flow dispatched to the
+/// controllers of a qcs.parallel_control_flow, or through the results of
+/// the measurements it consumes. Returns std::nullopt if they are not known,
+/// e.g., if a qubit operand or decoration could not be resolved.
+std::optional<QubitSet> getUsedQubits(Operation *op) {
+  QubitSet qubits;
+  bool known = true;
+  op->walk<WalkOrder::PreOrder>([&](Operation *nested) {
+    if (auto synchronizeOp = dyn_cast<SynchronizeOp>(nested)) {
+      // a nested synchronization of all qubits
+      if (synchronizeOp.getQubits().empty()) {
+        known = false;
+        return WalkResult::interrupt();
+      }
+    }
+    if (auto qubitOp = dyn_cast<QubitOpInterface>(nested)) {
+      qubits |= qubitOp.getOperatedQubits();
+    } else if (isa<CallOpInterface>(nested)) {
+      // e.g., a subroutine whose qubit operands were removed
+      known = false;
+      return WalkResult::interrupt();
+    }
+    // e.g., control flow on a qubit the quantum decoration could not resolve
+    if (!quir::addQubitIdsFromAttr(nested, qubits)) {
+      known = false;
+      return WalkResult::interrupt();
+    }
+    for (Value const operand : nested->getOperands()) {
+      if (operand.getType().isa<quir::QubitType>() &&
+          !quir::lookupQubitId(operand)) {
+        known = false;
+        return WalkResult::interrupt();
+      }
+      if (auto producer = operand.getDefiningOp<QubitOpInterface>())
+        qubits |= producer.getOperatedQubits();
+    }
+    return WalkResult::advance();
+  });
+  if (!known)
+    return std::nullopt;
+  return qubits;
+}
+
+/// Get the qubits whose controllers still need the synchronization, given
+/// the final form of the later synchronizations of its block. Returns
+/// std::nullopt if all of them may.
+std::optional<QubitSet> getNeededQubits(SynchronizeOp synchronizeOp) {
+  bool const synchronizesAll = synchronizeOp.getQubits().empty();
+  QubitSet const synchronized = synchronizeOp.getOperatedQubits();
+  auto isSynchronized = [&](uint32_t id) {
+    return synchronizesAll || synchronized.contains(id);
+  };
+
+  // the qubits used before a later synchronization covers them, and the
+  // qubits covered by a later synchronization before they are used
+  QubitSet needed;
+  QubitSet covered;
+  for (Operation *op = synchronizeOp->getNextNode(); op;
+       op = op->getNextNode()) {
+    if (auto nextSynchronizeOp = dyn_cast<SynchronizeOp>(op)) {
+      if (nextSynchronizeOp.getQubits().empty())
+        return needed;
+      for (uint32_t const id : nextSynchronizeOp.getOperatedQubits())
+        if (!needed.contains(id))
+          covered.insert(id);
+      if (!synchronizesAll &&
+          ((needed | covered) & synchronized) == synchronized)
+        return needed;
+      continue;
+    }
+
+    auto usedQubits = getUsedQubits(op);
+    if (!usedQubits)
+      return std::nullopt;
+    for (uint32_t const id : *usedQubits)
+      if (isSynchronized(id) && !covered.contains(id))
+        needed.insert(id);
+  }
+
+  // The qubits not covered by the end of the block are needed, which are
+  // not known for a synchronization of all qubits.
+  if (synchronizesAll)
+    return std::nullopt;
+  for (uint32_t const id : synchronized)
+    if (!covered.contains(id))
+      needed.insert(id);
+  return needed;
+}
+} // anonymous namespace
+
+void NarrowSynchronizationsPass::runOnOperation() {
+  // The blocks with synchronizations, their synchronizations in order.
+  llvm::SmallVector<Block *> blocks;
+  llvm::DenseMap<Block *, llvm::SmallVector<SynchronizeOp>> synchronizeOps;
+  getOperation()->walk([&](SynchronizeOp synchronizeOp) {
+    auto &blockSynchronizeOps = synchronizeOps[synchronizeOp->getBlock()];
+    if (blockSynchronizeOps.empty())
+      blocks.push_back(synchronizeOp->getBlock());
+    blockSynchronizeOps.push_back(synchronizeOp);
+  });
+
+  // the qubits declared with an id, for narrowing synchronizations of all
+  // qubits
+  llvm::SmallVector<quir::DeclareQubitOp> declareQubitOps;
+  getOperation()->walk([&](quir::DeclareQubitOp declareQubitOp) {
+    if (declareQubitOp.getId().has_value())
+      declareQubitOps.push_back(declareQubitOp);
+  });
+  DominanceInfo const dominanceInfo(getOperation());
+
+  for (Block *block : blocks) {
+    // Later synchronizations are narrowed first, as the earlier ones depend
+    // on the qubits they still cover.
+    for (auto synchronizeOp : llvm::reverse(synchronizeOps[block])) {
+      auto needed = getNeededQubits(synchronizeOp);
+      if (!needed)
+        continue;
+      if (needed->empty()) {
+        synchronizeOp->erase();
+        ++numSynchronizationsEliminated;
+        continue;
+      }
+
+      llvm::SmallVector<Value> qubits;
+      QubitSet found;
+      if (synchronizeOp.getQubits().empty()) {
+        for (auto declareQubitOp : declareQubitOps) {
+          uint32_t const id = *declareQubitOp.getId();
+          if (needed->contains(id) && !found.contains(id) &&
+              dominanceInfo.properlyDominates(declareQubitOp.getOperation(),
+                                              synchronizeOp)) {
+            qubits.push_back(declareQubitOp.getRes());
+            found.insert(id);
+          }
+        }
+        // some qubit could not be referenced here
+        if (found != *needed)
+          continue;
+      } else {
+        for (Value const qubit : synchronizeOp.getQubits()) {
+          auto id = quir::lookupQubitId(qubit);
+          if (!id || needed->contains(*id))
+            qubits.push_back(qubit);
+        }
+        if (qubits.size() == synchronizeOp.getQubits().size())
+          continue;
+      }
+
+      synchronizeOp.getQubitsMutable().assign(qubits);
+      ++numSynchronizationsNarrowed;
+    }
+  }
+} // NarrowSynchronizationsPass::runOnOperation
+
+llvm::StringRef NarrowSynchronizationsPass::getArgument() const {
+  return "qcs-narrow-synchronizations";
+}
+
+llvm::StringRef NarrowSynchronizationsPass::getDescription() const {
+  return "Narrow synchronizations to the qubits whose controllers depend on "
+         "them and erase the others";
+}
+
+llvm::StringRef NarrowSynchronizationsPass::getName() const {
+  return "Narrow Synchronizations Pass";
+}
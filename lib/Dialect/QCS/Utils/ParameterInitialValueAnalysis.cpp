@@ -11,8 +11,8 @@
 /// This file defines a MLIR Analysis for parameter inputs which
 /// caches the initial_value of the input parameter
 ///
-/// Note: by default this analysis is always treated as valid unless
-/// the invalidate() method is called.
+/// Note: this analysis is invalidated by the passes which do not preserve
+/// it, see ParameterInitialValueAnalysis.h.
 ///
 //===----------------------------------------------------------------------===//
 
@@ -24,7 +24,6 @@
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Operation.h"
-#include "mlir/Pass/PassRegistry.h"
 #include "mlir/Support/LLVM.h"
 
 #include "llvm/ADT/StringRef.h"
@@ -33,6 +32,29 @@
 
 using namespace mlir::qcs;
 
+namespace {
+double getParameterInitialValue(DeclareParameterOp declareParameterOp) {
+  double initial_value = 0.0;
+  if (declareParameterOp.getInitialValue().has_value()) {
+    auto angleAttr = declareParameterOp.getInitialValue()
+                         .value()
+                         .dyn_cast<mlir::quir::AngleAttr>();
+    auto floatAttr =
+        declareParameterOp.getInitialValue().value().dyn_cast<FloatAttr>();
+    if (!(angleAttr || floatAttr))
+      declareParameterOp.emitError("Parameters are currently limited to "
+                                   "angles or float[64] only.");
+
+    if (angleAttr)
+      initial_value = angleAttr.getValue().convertToDouble();
+
+    if (floatAttr)
+      initial_value = floatAttr.getValue().convertToDouble();
+  }
+  return initial_value;
+}
+} // anonymous namespace
+
 ParameterInitialValueAnalysis::ParameterInitialValueAnalysis(
     mlir::Operation *moduleOp) {
 
@@ -54,37 +76,33 @@ ParameterInitialValueAnalysis::ParameterInitialValueAnalysis(
 
   for (auto &region : moduleOp->getRegions())
     for (auto &block : region.getBlocks())
-      for (auto &op : block.getOperations()) {
-        auto declareParameterOp = dyn_cast<DeclareParameterOp>(op);
-        if (!declareParameterOp)
-          continue;
-
-        // moduleOp->walk([&](DeclareParameterOp declareParameterOp) {
-        double initial_value = 0.0;
-        if (declareParameterOp.getInitialValue().has_value()) {
-          auto angleAttr = declareParameterOp.getInitialValue()
-                               .value()
-                               .dyn_cast<mlir::quir::AngleAttr>();
-          auto floatAttr = declareParameterOp.getInitialValue()
-                               .value()
-                               .dyn_cast<FloatAttr>();
-          if (!(angleAttr || floatAttr))
-            declareParameterOp.emitError("Parameters are currently limited to "
-                                         "angles or float[64] only.");
-
-          if (angleAttr)
-            initial_value = angleAttr.getValue().convertToDouble();
-
-          if (floatAttr)
-            initial_value = floatAttr.getValue().convertToDouble();
-        }
-        initial_values_[declareParameterOp.getSymName()] = initial_value;
-      }
+      for (auto &op : block.getOperations())
+        if (auto declareParameterOp = dyn_cast<DeclareParameterOp>(op))
+          updateParameter(declareParameterOp);
   invalid_ = false;
 }
 
+void ParameterInitialValueAnalysis::updateParameter(
+    DeclareParameterOp declareParameterOp) {
+  initial_values_[declareParameterOp.getSymName()] =
+      getParameterInitialValue(declareParameterOp);
+}
+
+void ParameterInitialValueAnalysis::Listener::notifyOperationInserted(
+    Operation *op) {
+  if (auto declareParameterOp = dyn_cast<DeclareParameterOp>(op))
+    analysis.updateParameter(declareParameterOp);
+}
+
+void ParameterInitialValueAnalysis::Listener::notifyOperationRemoved(
+    Operation *op) {
+  if (auto declareParameterOp = dyn_cast<DeclareParameterOp>(op))
+    analysis.eraseParameter(declareParameterOp.getSymName());
+}
+
 void ParameterInitialValueAnalysisPass::runOnOperation() {
   getAnalysis<ParameterInitialValueAnalysis>();
+  markAllAnalysesPreserved();
 } // ParameterInitialValueAnalysisPass::runOnOperation()
 
 llvm::StringRef ParameterInitialValueAnalysisPass::getArgument() const {
@@ -98,9 +116,3 @@ llvm::StringRef ParameterInitialValueAnalysisPass::getDescription() const {
 llvm::StringRef ParameterInitialValueAnalysisPass::getName() const {
   return "Parameters Initial Value Analysis Pass";
 }
-
-// TODO: move registerQCSPasses to separate source file if additional passes
-// are added to the QCS Dialect
-void mlir::qcs::registerQCSPasses() {
-  PassRegistration<mlir::qcs::ParameterInitialValueAnalysisPass>();
-}
@@ -0,0 +1,40 @@
+//===- Passes.cpp - QCS Passes ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QCS/Utils/Passes.h"
+#include "Dialect/QCS/Utils/FoldParameterExpressions.h"
+#include "Dialect/QCS/Utils/HoistParameterLoads.h"
+#include "Dialect/QCS/Utils/NarrowSynchronizations.h"
+#include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
+
+#include "mlir/Pass/PassRegistry.h"
+
+namespace mlir::qcs {
+
+void registerQCSPasses() {
+  //===----------------------------------------------------------------------===//
+  // Analysis Passes
+  //===----------------------------------------------------------------------===//
+  PassRegistration<ParameterInitialValueAnalysisPass>();
+
+  //===----------------------------------------------------------------------===//
+  // Transform Passes
+  //===----------------------------------------------------------------------===//
+  PassRegistration<FoldParameterExpressionsPass>();
+  PassRegistration<HoistParameterLoadsPass>();
+  PassRegistration<NarrowSynchronizationsPass>();
+}
+} // end namespace mlir::qcs
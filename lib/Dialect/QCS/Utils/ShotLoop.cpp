@@ -0,0 +1,94 @@
+//===- ShotLoop.cpp - Shot loop utilities -----------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file implements utilities for the shot loop of a program.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QCS/Utils/ShotLoop.h"
+
+#include "Dialect/QCS/IR/QCSAttributes.h"
+#include "Dialect/QCS/IR/QCSOps.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Visitors.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace mlir::qcs {
+
+bool isShotLoop(Operation *op) {
+  return isa<scf::ForOp>(op) && op->hasAttr(getShotLoopAttrName());
+} // isShotLoop
+
+scf::ForOp getShotLoop(Operation *op) {
+  scf::ForOp shotLoop;
+  op->walk<WalkOrder::PreOrder>([&](scf::ForOp forOp) {
+    if (!isShotLoop(forOp))
+      return WalkResult::advance();
+    shotLoop = forOp;
+    return WalkResult::interrupt();
+  });
+  return shotLoop;
+} // getShotLoop
+
+scf::ForOp getEnclosingShotLoop(Operation *op) {
+  for (auto forOp = op->getParentOfType<scf::ForOp>(); forOp;
+       forOp = forOp->getParentOfType<scf::ForOp>())
+    if (isShotLoop(forOp))
+      return forOp;
+  return nullptr;
+} // getEnclosingShotLoop
+
+ShotInitOp getShotInit(scf::ForOp shotLoop) {
+  auto shotInits = shotLoop.getBody()->getOps<ShotInitOp>();
+  if (shotInits.empty())
+    return nullptr;
+  return *shotInits.begin();
+} // getShotInit
+
+std::optional<uint32_t> getNumShots(scf::ForOp shotLoop) {
+  auto shotInit = getShotInit(shotLoop);
+  if (!shotInit)
+    return std::nullopt;
+  auto numShots = shotInit->getAttrOfType<IntegerAttr>(getNumShotsAttrName());
+  if (!numShots)
+    return std::nullopt;
+  return numShots.getInt();
+} // getNumShots
+
+void setNumShots(scf::ForOp shotLoop, uint32_t numShots) {
+  OpBuilder builder(shotLoop);
+  auto oldUpperBound = shotLoop.getUpperBound();
+  auto upperBound = builder.create<arith::ConstantOp>(
+      shotLoop.getLoc(), builder.getIndexType(),
+      builder.getIndexAttr(numShots));
+  shotLoop.setUpperBound(upperBound);
+  if (auto *oldUpperBoundOp = oldUpperBound.getDefiningOp())
+    if (isa<arith::ConstantOp>(oldUpperBoundOp) && oldUpperBoundOp->use_empty())
+      oldUpperBoundOp->erase();
+
+  if (auto shotInit = getShotInit(shotLoop))
+    shotInit->setAttr(getNumShotsAttrName(),
+                      builder.getI32IntegerAttr(numShots));
+} // setNumShots
+
+} // namespace mlir::qcs
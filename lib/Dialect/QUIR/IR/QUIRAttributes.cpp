@@ -17,10 +17,10 @@
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 
 #include "Dialect/QUIR/IR/QUIREnums.h"
+#include "Dialect/QUIR/IR/QUIRTimeUnits.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 
 #include "llvm/ADT/APFloat.h"
-#include "llvm/Support/ErrorHandling.h"
 
 #include <cstdint>
 
@@ -31,67 +31,6 @@ using namespace mlir::quir;
 // DurationAttr
 //===----------------------------------------------------------------------===//
 
-namespace {
-/// Convert input value (in units of inputUnits) to target units
-double convertToSeconds(const double value, const TimeUnits inputUnits,
-                        const double dt = 1.) {
-  switch (inputUnits) {
-  case TimeUnits::dt:
-    return value * dt;
-    break;
-  case TimeUnits::fs:
-    return value / 1.e15;
-    break;
-  case TimeUnits::ps:
-    return value / 1.e12;
-    break;
-  case TimeUnits::ns:
-    return value / 1.e9;
-    break;
-  case TimeUnits::us:
-    return value / 1.e6;
-    break;
-  case TimeUnits::ms:
-    return value / 1.e3;
-    break;
-  case TimeUnits::s:
-    return value;
-    break;
-  }
-  llvm_unreachable("unhandled TimeUnits conversion.");
-}
-
-/// Convert input value (in units of seconds) to target outputUnits
-double convertFromSeconds(const double value, const TimeUnits outputUnits,
-                          const double dt = 1.) {
-  switch (outputUnits) {
-  case TimeUnits::dt:
-    return value / dt;
-    break;
-  case TimeUnits::fs:
-    return value * 1.e15;
-    break;
-  case TimeUnits::ps:
-    return value * 1.e12;
-    break;
-  case TimeUnits::ns:
-    return value * 1.e9;
-    break;
-  case TimeUnits::us:
-    return value * 1.e6;
-    break;
-  case TimeUnits::ms:
-    return value * 1.e3;
-    break;
-  case TimeUnits::s:
-    return value;
-    break;
-  }
-  llvm_unreachable("unhandled TimeUnits conversion.");
-}
-
-} // anonymous namespace
-
 double DurationAttr::getDtFromSchedulingRate(const double schedulingRate) {
   return 1. / schedulingRate;
 }
@@ -103,11 +42,7 @@ double DurationAttr::getSchedulingRateFromDt(const double dt) {
 double DurationAttr::convertUnitsToUnits(double value, TimeUnits inputUnits,
                                          TimeUnits outputUnits,
                                          const double dt) {
-  // Check if we can avoid the conversion.
-  if (inputUnits == outputUnits)
-    return value;
-  double const seconds = convertToSeconds(value, inputUnits, dt);
-  return convertFromSeconds(seconds, outputUnits, dt);
+  return getTimeUnitsConversion(inputUnits, outputUnits)(value, dt);
 }
 
 uint64_t DurationAttr::getSchedulingCycles(const double dt) {
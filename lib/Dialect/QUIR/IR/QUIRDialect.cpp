@@ -20,6 +20,7 @@
 
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 
+#include "Dialect/DialectBytecode.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 // NOLINTNEXTLINE(misc-include-cleaner): Required for MLIR registrations
@@ -101,6 +102,11 @@ struct QuirInlinerInterface : public DialectInlinerInterface {
   }
 };
 
+// Bytecode of the dialect, whose version is to be bumped whenever bytecode
+// written by the previous version no longer parses.
+using QUIRBytecodeInterface =
+    qssc::dialect::VersionedBytecodeInterface</*Version=*/0>;
+
 void quir::QUIRDialect::initialize() {
 
   addTypes<
@@ -121,7 +127,7 @@ void quir::QUIRDialect::initialize() {
 #include "Dialect/QUIR/IR/QUIRAttributes.cpp.inc"
       >();
 
-  addInterfaces<QuirInlinerInterface>();
+  addInterfaces<QuirInlinerInterface, QUIRBytecodeInterface>();
 }
 
 template <typename QUIRType>
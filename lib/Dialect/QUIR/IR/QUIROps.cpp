@@ -21,6 +21,7 @@
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -74,8 +75,8 @@ uint lookupQubitIdHandleError_(const Value &val) {
 } // anonymous namespace
 
 template <class Op>
-std::set<uint32_t> getQubitIds(Op &op) {
-  std::set<uint32_t> opQubits;
+QubitSet getQubitIds(Op &op) {
+  QubitSet opQubits;
   std::vector<Value> vals;
   qubitCallOperands<Op>(op, vals);
   for (auto qubit : vals) {
@@ -89,8 +90,8 @@ std::set<uint32_t> getQubitIds(Op &op) {
 // BuiltinCXOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> BuiltinCXOp::getOperatedQubits() {
-  std::set<uint32_t> opQubits;
+QubitSet BuiltinCXOp::getOperatedQubits() {
+  QubitSet opQubits;
   opQubits.insert(lookupQubitIdHandleError_(getControl()));
   opQubits.insert(lookupQubitIdHandleError_(getTarget()));
   return opQubits;
@@ -100,8 +101,8 @@ std::set<uint32_t> BuiltinCXOp::getOperatedQubits() {
 // Builtin_UOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> Builtin_UOp::getOperatedQubits() {
-  std::set<uint32_t> opQubits;
+QubitSet Builtin_UOp::getOperatedQubits() {
+  QubitSet opQubits;
   opQubits.insert(lookupQubitIdHandleError_(getTarget()));
   return opQubits;
 }
@@ -110,7 +111,7 @@ std::set<uint32_t> Builtin_UOp::getOperatedQubits() {
 // CallGateOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> CallGateOp::getOperatedQubits() {
+QubitSet CallGateOp::getOperatedQubits() {
   return getQubitIds<CallGateOp>(*this);
 }
 
@@ -122,7 +123,7 @@ auto CallGateOp::getCalleeType() -> FunctionType {
 // MeasureOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> MeasureOp::getOperatedQubits() {
+QubitSet MeasureOp::getOperatedQubits() {
   return getQubitIds<MeasureOp>(*this);
 }
 
@@ -130,7 +131,7 @@ std::set<uint32_t> MeasureOp::getOperatedQubits() {
 // ResetOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> ResetQubitOp::getOperatedQubits() {
+QubitSet ResetQubitOp::getOperatedQubits() {
   return getQubitIds<ResetQubitOp>(*this);
 }
 
@@ -140,7 +141,7 @@ std::set<uint32_t> ResetQubitOp::getOperatedQubits() {
 // TODO: Move to `System` dialect once "lower qubits to channels/ports."
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> qcs::SynchronizeOp::getOperatedQubits() {
+QubitSet qcs::SynchronizeOp::getOperatedQubits() {
   return getQubitIds<qcs::SynchronizeOp>(*this);
 }
 
@@ -148,7 +149,7 @@ std::set<uint32_t> qcs::SynchronizeOp::getOperatedQubits() {
 // DelayOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> DelayOp::getOperatedQubits() {
+QubitSet DelayOp::getOperatedQubits() {
   return getQubitIds<DelayOp>(*this);
 }
 
@@ -158,7 +159,7 @@ std::set<uint32_t> DelayOp::getOperatedQubits() {
 // TODO: Move to `System` dialect once "lower qubits to channels/ports."
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> qcs::DelayCyclesOp::getOperatedQubits() {
+QubitSet qcs::DelayCyclesOp::getOperatedQubits() {
   return getQubitIds<qcs::DelayCyclesOp>(*this);
 }
 
@@ -166,7 +167,7 @@ std::set<uint32_t> qcs::DelayCyclesOp::getOperatedQubits() {
 // BarrierOp
 //===----------------------------------------------------------------------===//
 
-std::set<uint32_t> BarrierOp::getOperatedQubits() {
+QubitSet BarrierOp::getOperatedQubits() {
   return getQubitIds<BarrierOp>(*this);
 }
 
@@ -313,7 +314,7 @@ CallCircuitOp::verifySymbolUses(SymbolTableCollection &symbolTable) {
   return success();
 }
 
-std::set<uint32_t> CallCircuitOp::getOperatedQubits() {
+QubitSet CallCircuitOp::getOperatedQubits() {
   return getQubitIds<CallCircuitOp>(*this);
 }
 
@@ -23,6 +23,7 @@
 
 #include "Dialect/QCS/IR/QCSAttributes.h"
 #include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QCS/Utils/ShotLoop.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -57,6 +58,13 @@ void AddShotLoopPass::runOnOperation() {
     return;
   }
 
+  // the shot body is compiled once and repeated, so a main which already
+  // has a shot loop only needs its number of shots updated
+  if (auto shotLoop = getShotLoop(mainFunc)) {
+    setNumShots(shotLoop, numShots);
+    return;
+  }
+
   // start the builder outside the main function so we aren't cloning or
   // building into the same region that we are copying from
   OpBuilder build = OpBuilder::atBlockBegin(moduleOp.getBody());
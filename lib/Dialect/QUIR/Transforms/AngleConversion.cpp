@@ -62,6 +62,9 @@ struct AngleConversion : public OpRewritePattern<quir::CallGateOp> {
     mlir::func::FuncOp funcOp = findOp->second;
     FunctionType const fType = funcOp.getFunctionType();
 
+    // only report the calls which were updated, otherwise the greedy driver
+    // revisits every call until it reaches its iteration limit
+    bool changed = false;
     for (const auto &pair : llvm::enumerate(callGateOp.getArgOperands())) {
       auto value = pair.value();
       auto index = pair.index();
@@ -75,10 +78,11 @@ struct AngleConversion : public OpRewritePattern<quir::CallGateOp> {
                                              funcType.dyn_cast<AngleType>(),
                                              constVal));
           value.setType(funcType);
+          changed = true;
         }
       }
     }
-    return success();
+    return success(changed);
   }
 
 private:
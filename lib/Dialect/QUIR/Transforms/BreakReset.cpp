@@ -27,7 +27,9 @@
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/ValueRange.h"
@@ -37,6 +39,7 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -55,9 +58,9 @@ namespace {
 struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
 
   explicit BreakResetsPattern(MLIRContext *ctx, uint numIterations,
-                              uint delayCycles)
+                              uint delayCycles, bool batchCorrections)
       : OpRewritePattern<ResetQubitOp>(ctx), numIterations_(numIterations),
-        delayCycles_(delayCycles) {}
+        delayCycles_(delayCycles), batchCorrections_(batchCorrections) {}
 
   LogicalResult matchAndRewrite(ResetQubitOp resetOp,
                                 PatternRewriter &rewriter) const override {
@@ -87,15 +90,30 @@ struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
                                           rewriter.getI1Type());
 
     for (uint iteration = 0; iteration < numIterations_; iteration++) {
+      // the qubits of a parallel reset wait for the same duration, so that a
+      // single delay precedes their shared measurement
       if (delayCycles_ > 0 && iteration > 0)
-        for (auto qubit : resetOp.getQubits())
-          rewriter.create<DelayOp>(resetOp.getLoc(),
-                                   constantDurationOp.getResult(), qubit);
+        rewriter.create<DelayOp>(resetOp.getLoc(),
+                                 constantDurationOp.getResult(),
+                                 resetOp.getQubits());
 
       auto measureOp = rewriter.create<MeasureOp>(
           resetOp.getLoc(), TypeRange(typeVec), resetOp.getQubits());
       measureOp->setAttr(getNoReportRuntimeAttrName(), rewriter.getUnitAttr());
 
+      // nest the corrections in a single branch on whether any qubit needs
+      // one, so that an iteration with no qubit measured 1 costs one branch
+      auto savedIterationPoint = rewriter.saveInsertionPoint();
+      if (batchCorrections_ && measureOp.getNumResults() > 1) {
+        Value anyOne = measureOp.getResult(0);
+        for (auto result : llvm::drop_begin(measureOp.getResults()))
+          anyOne =
+              rewriter.create<arith::OrIOp>(resetOp.getLoc(), anyOne, result);
+        auto anyIfOp =
+            rewriter.create<scf::IfOp>(resetOp.getLoc(), anyOne, false);
+        rewriter.setInsertionPointToStart(anyIfOp.getBody(0));
+      }
+
       size_t i = 0;
       for (auto qubit : resetOp.getQubits()) {
         auto ifOp = rewriter.create<scf::IfOp>(resetOp.getLoc(),
@@ -109,6 +127,7 @@ struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
         i++;
         rewriter.restoreInsertionPoint(savedInsertionPoint);
       }
+      rewriter.restoreInsertionPoint(savedIterationPoint);
     }
 
     rewriter.eraseOp(resetOp);
@@ -118,6 +137,7 @@ struct BreakResetsPattern : public OpRewritePattern<ResetQubitOp> {
 private:
   uint numIterations_;
   uint delayCycles_;
+  bool batchCorrections_;
 }; // BreakResetsPattern
 } // anonymous namespace
 
@@ -131,13 +151,18 @@ void BreakResetPass::runOnOperation() {
   // Disable to improve performance
   config.enableRegionSimplification = false;
 
-  patterns.add<BreakResetsPattern>(&getContext(), numIterations, delayCycles);
+  patterns.add<BreakResetsPattern>(&getContext(), numIterations, delayCycles,
+                                   batchCorrections);
 
   if (mlir::failed(applyPatternsAndFoldGreedily(getOperation(),
                                                 std::move(patterns), config)))
     signalPassFailure();
 } // BreakResetPass::runOnOperation
 
+void BreakResetPass::getDependentDialects(DialectRegistry &registry) const {
+  registry.insert<arith::ArithDialect, scf::SCFDialect>();
+}
+
 llvm::StringRef BreakResetPass::getArgument() const { return "break-reset"; }
 llvm::StringRef BreakResetPass::getDescription() const {
   return "Break reset ops into repeated measure and conditional x gate calls";
@@ -0,0 +1,218 @@
+//===- CacheFunctions.cpp - Cache optimized functions -----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for running a pipeline on the functions and
+///  circuits of a module, reusing the results of the compilations of the
+///  process for the functions and circuits they already optimized.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/CacheFunctions.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#define DEBUG_TYPE "CacheFunctions"
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+llvm::ManagedStatic<FunctionCache> globalFunctionCache;
+
+/// Get the key of a function optimized by pipeline, which hashes the
+/// pipeline and the printed function without its locations.
+std::string getKey(llvm::StringRef pipeline, Operation *functionOp) {
+  std::string printed;
+  llvm::raw_string_ostream printedStream(printed);
+  functionOp->print(printedStream,
+                    OpPrintingFlags().printGenericOpForm().useLocalScope());
+  printedStream.flush();
+
+  llvm::SHA256 hasher;
+  hasher.update(pipeline);
+  hasher.update(llvm::ArrayRef<uint8_t>{0});
+  hasher.update(printed);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+/// Serialize a function as the bytecode of a module holding a copy of it.
+LogicalResult serialize(Operation *functionOp, std::string &bytecode) {
+  OwningOpRef<ModuleOp> moduleOp = ModuleOp::create(functionOp->getLoc());
+  moduleOp->push_back(functionOp->clone());
+  llvm::raw_string_ostream bytecodeStream(bytecode);
+  return writeBytecodeToFile(moduleOp.get(), bytecodeStream);
+}
+
+/// Replace a function with the cached function of bytecode, locating its
+/// operations at the function.
+LogicalResult splice(Operation *functionOp, llvm::StringRef bytecode) {
+  ParserConfig const parserConfig(functionOp->getContext());
+  auto moduleOp = parseSourceString<ModuleOp>(bytecode, parserConfig);
+  if (!moduleOp || moduleOp->getBody()->empty())
+    return failure();
+
+  Operation *cachedOp = &moduleOp->getBody()->front();
+  if (cachedOp->getName() != functionOp->getName())
+    return failure();
+  Location const loc = functionOp->getLoc();
+  cachedOp->walk([&](Operation *op) {
+    op->setLoc(loc);
+    for (auto &region : op->getRegions())
+      for (auto &block : region)
+        for (auto argument : block.getArguments())
+          argument.setLoc(loc);
+  });
+
+  cachedOp->remove();
+  functionOp->getBlock()->getOperations().insert(functionOp->getIterator(),
+                                                 cachedOp);
+  functionOp->erase();
+  return success();
+}
+
+} // anonymous namespace
+
+FunctionCache &FunctionCache::global() { return *globalFunctionCache; }
+
+std::shared_ptr<const std::string>
+FunctionCache::lookup(llvm::StringRef key) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto entry = entries.find(key);
+  if (entry == entries.end())
+    return nullptr;
+  return entry->second;
+}
+
+void FunctionCache::insert(llvm::StringRef key, std::string bytecode) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (numBytes + bytecode.size() > maxBytes) {
+    entries.clear();
+    numBytes = 0;
+  }
+  numBytes += bytecode.size();
+  auto &entry = entries[key];
+  if (entry)
+    numBytes -= entry->size();
+  entry = std::make_shared<const std::string>(std::move(bytecode));
+}
+
+size_t FunctionCache::size() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return entries.size();
+}
+
+void FunctionCache::clear() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  numBytes = 0;
+}
+
+LogicalResult CacheFunctionsPass::initialize(MLIRContext *context) {
+  funcPipeline.emplace(func::FuncOp::getOperationName());
+  circuitPipeline.emplace(CircuitOp::getOperationName());
+  if (failed(parsePassPipeline(pipeline, *funcPipeline)) ||
+      failed(parsePassPipeline(pipeline, *circuitPipeline)))
+    return failure();
+  return success();
+}
+
+void CacheFunctionsPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  OpPassManager pm(func::FuncOp::getOperationName());
+  if (succeeded(parsePassPipeline(pipeline, pm, llvm::nulls())))
+    pm.getDependentDialects(registry);
+}
+
+void CacheFunctionsPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+  auto &cache = FunctionCache::global();
+
+  // splicing cached functions modifies the body of the module
+  llvm::SmallVector<Operation *> functionOps;
+  for (Operation &op : moduleOp.getOps()) {
+    if (auto funcOp = dyn_cast<func::FuncOp>(op)) {
+      if (!funcOp.isExternal() && funcOp.getSymName() != "main")
+        functionOps.push_back(&op);
+    } else if (auto circuitOp = dyn_cast<CircuitOp>(op)) {
+      if (!circuitOp.isExternal())
+        functionOps.push_back(&op);
+    }
+  }
+
+  for (Operation *functionOp : functionOps) {
+    std::string const key = getKey(pipeline, functionOp);
+    if (auto bytecode = cache.lookup(key))
+      if (succeeded(splice(functionOp, *bytecode))) {
+        ++numCacheHits;
+        continue;
+      }
+
+    ++numCacheMisses;
+    auto &functionPipeline =
+        isa<CircuitOp>(functionOp) ? *circuitPipeline : *funcPipeline;
+    if (failed(runPipeline(functionPipeline, functionOp))) {
+      signalPassFailure();
+      return;
+    }
+
+    std::string bytecode;
+    if (succeeded(serialize(functionOp, bytecode)))
+      cache.insert(key, std::move(bytecode));
+    else
+      LLVM_DEBUG(llvm::dbgs() << "unable to cache function\n");
+  }
+}
+
+llvm::StringRef CacheFunctionsPass::getArgument() const {
+  return "quir-cache-functions";
+}
+
+llvm::StringRef CacheFunctionsPass::getDescription() const {
+  return "Run a pipeline on the functions and circuits of the module, reusing "
+         "the results of the earlier compilations of the process";
+}
+
+llvm::StringRef CacheFunctionsPass::getName() const {
+  return "Cache Functions Pass";
+}
@@ -24,17 +24,23 @@
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIREnums.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTimeUnits.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/FunctionInterfaces.h"
 #include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Visitors.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 
@@ -261,8 +267,59 @@ bool checkTypeNeedsConversion(mlir::Type type, TimeUnits targetConvertUnits) {
   return false;
 } // checkTypeNeedsConversion
 
+/// Whether any duration within op is not in targetUnits, i.e., whether the
+/// dialect conversion has anything to do. Operands are checked through the
+/// results and block arguments defining them.
+bool needsDurationConversion(Operation *op, TimeUnits targetUnits) {
+  auto needsConversion = [&](Type type) {
+    return checkTypeNeedsConversion(type, targetUnits);
+  };
+  auto result = op->walk([&](Operation *nestedOp) {
+    if (auto funcOp = dyn_cast<FunctionOpInterface>(nestedOp))
+      if (llvm::any_of(funcOp.getResultTypes(), needsConversion))
+        return WalkResult::interrupt();
+    if (llvm::any_of(nestedOp->getResultTypes(), needsConversion))
+      return WalkResult::interrupt();
+    for (Region &region : nestedOp->getRegions())
+      for (Block &block : region)
+        if (llvm::any_of(block.getArgumentTypes(), needsConversion))
+          return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
 } // anonymous namespace
 
+unsigned mlir::quir::convertDurationConstants(Operation *op,
+                                              TimeUnits targetUnits,
+                                              double dtTimestep) {
+  MLIRContext *ctx = op->getContext();
+  auto targetType = DurationType::get(ctx, targetUnits);
+
+  // delay-dense circuits repeat a few durations, convert each of them once
+  llvm::DenseMap<Attribute, DurationAttr> convertedDurations;
+  unsigned numConverted = 0;
+  op->walk([&](quir::ConstantOp constantOp) {
+    auto duration = constantOp.getValue().dyn_cast<DurationAttr>();
+    if (!duration || duration.getType().getUnits() == targetUnits)
+      return;
+
+    auto &converted = convertedDurations[duration];
+    if (!converted) {
+      auto conversion =
+          getTimeUnitsConversion(duration.getType().getUnits(), targetUnits);
+      double const value =
+          conversion(duration.getDuration().convertToDouble(), dtTimestep);
+      converted = DurationAttr::get(ctx, targetType, llvm::APFloat(value));
+    }
+    constantOp.setValueAttr(converted);
+    constantOp.getResult().setType(targetType);
+    ++numConverted;
+  });
+  return numConverted;
+}
+
 void ConvertDurationUnitsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
@@ -271,6 +328,16 @@ void ConvertDurationUnitsPass::runOnOperation() {
 
   double const dtConversion = getDtTimestep();
 
+  // Convert the duration constants in place up front so that the dialect
+  // conversion below only has to update the types of their users.
+  numDurationsConverted += convertDurationConstants(
+      moduleOperation, targetConvertUnits, dtConversion);
+
+  // Durations emitted in the target units, e.g., by the frontend, leave
+  // nothing to convert
+  if (!needsDurationConversion(moduleOperation, targetConvertUnits))
+    return;
+
   auto &context = getContext();
   ConversionTarget target(context);
 
@@ -0,0 +1,151 @@
+//===- DeduplicateCircuits.cpp - Share identical circuits -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for replacing the circuits which are
+///  structurally identical to an earlier circuit by that circuit.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/DeduplicateCircuits.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Debug.h"
+
+#include <utility>
+#include <vector>
+
+#define DEBUG_TYPE "DeduplicateCircuits"
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+/// The attributes of a circuit other than its symbol name, which include
+/// its type and its argument and result attributes, and the circuit itself.
+/// Circuits are equal if they have the same attributes and bodies equivalent
+/// up to the renaming of their values.
+struct CircuitContents {
+  Operation *circuitOp;
+  DictionaryAttr attrs;
+  unsigned hash;
+};
+
+struct CircuitContentsInfo {
+  static CircuitContents getEmptyKey() {
+    return {llvm::DenseMapInfo<Operation *>::getEmptyKey(), {}, 0};
+  }
+  static CircuitContents getTombstoneKey() {
+    return {llvm::DenseMapInfo<Operation *>::getTombstoneKey(), {}, 0};
+  }
+  static unsigned getHashValue(const CircuitContents &contents) {
+    return contents.hash;
+  }
+  static bool isEqual(const CircuitContents &lhs,
+                      const CircuitContents &rhs) {
+    if (lhs.circuitOp == rhs.circuitOp)
+      return true;
+    if (lhs.circuitOp == getEmptyKey().circuitOp ||
+        lhs.circuitOp == getTombstoneKey().circuitOp ||
+        rhs.circuitOp == getEmptyKey().circuitOp ||
+        rhs.circuitOp == getTombstoneKey().circuitOp)
+      return false;
+    return lhs.hash == rhs.hash && lhs.attrs == rhs.attrs &&
+           OperationEquivalence::isRegionEquivalentTo(
+               &lhs.circuitOp->getRegion(0), &rhs.circuitOp->getRegion(0),
+               OperationEquivalence::IgnoreLocations);
+  }
+};
+
+/// Get the contents of a circuit, whose hash combines its attributes and
+/// the ops of its body, ignoring their operands and results.
+CircuitContents getContents(CircuitOp circuitOp) {
+  NamedAttrList attrs(circuitOp->getAttrDictionary());
+  attrs.erase(SymbolTable::getSymbolAttrName());
+  CircuitContents contents{circuitOp,
+                           attrs.getDictionary(circuitOp.getContext()), 0};
+
+  llvm::hash_code hash = llvm::hash_value(contents.attrs.getAsOpaquePointer());
+  circuitOp.getBody().walk([&](Operation *op) {
+    hash = llvm::hash_combine(
+        hash, OperationEquivalence::computeHash(
+                  op, OperationEquivalence::ignoreHashValue,
+                  OperationEquivalence::ignoreHashValue,
+                  OperationEquivalence::IgnoreLocations));
+  });
+  contents.hash = hash;
+  return contents;
+}
+
+} // anonymous namespace
+
+void DeduplicateCircuitsPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+
+  // the first circuit of the module with each contents
+  llvm::DenseMap<CircuitContents, CircuitOp, CircuitContentsInfo> canonicals;
+  std::vector<std::pair<CircuitOp, CircuitOp>> duplicates;
+
+  for (auto circuitOp : moduleOp.getOps<CircuitOp>()) {
+    if (circuitOp.isExternal())
+      continue;
+    auto [canonicalIter, inserted] =
+        canonicals.try_emplace(getContents(circuitOp), circuitOp);
+    if (!inserted)
+      duplicates.emplace_back(circuitOp, canonicalIter->second);
+  }
+
+  if (duplicates.empty()) {
+    markAllAnalysesPreserved();
+    return;
+  }
+
+  // collect the users of all the symbols at once rather than walking the
+  // module for each duplicate
+  SymbolTableCollection symbolTables;
+  SymbolUserMap symbolUsers(symbolTables, moduleOp);
+  for (auto [circuitOp, canonicalOp] : duplicates) {
+    LLVM_DEBUG(llvm::dbgs() << "replacing circuit " << circuitOp.getSymName()
+                            << " with " << canonicalOp.getSymName() << "\n");
+    symbolUsers.replaceAllUsesWith(circuitOp, canonicalOp.getSymNameAttr());
+    circuitOp->erase();
+    ++numCircuitsDeduplicated;
+  }
+}
+
+llvm::StringRef DeduplicateCircuitsPass::getArgument() const {
+  return "deduplicate-circuits";
+}
+
+llvm::StringRef DeduplicateCircuitsPass::getDescription() const {
+  return "Replace the circuits which are structurally identical to an "
+         "earlier circuit by that circuit";
+}
+
+llvm::StringRef DeduplicateCircuitsPass::getName() const {
+  return "Deduplicate Circuits Pass";
+}
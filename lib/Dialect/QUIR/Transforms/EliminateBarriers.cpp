@@ -0,0 +1,134 @@
+//===- EliminateBarriers.cpp - Erase and narrow QUIR barriers ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass erasing the barriers which do not constrain
+///  the operations after them and narrowing the others.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/EliminateBarriers.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/BarrierElimination.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <optional>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+/// Get the qubits an operation uses, nested in its regions or through the
+/// results of the measurements it consumes. Returns std::nullopt if they are
+/// not known, e.g., if a qubit operand or decoration could not be resolved.
+std::optional<llvm::SmallVector<uint32_t, 4>> getUsedQubits(Operation *op) {
+  QubitSet qubits;
+  bool known = true;
+  op->walk<WalkOrder::PreOrder>([&](Operation *nested) {
+    if (auto synchronizeOp = dyn_cast<qcs::SynchronizeOp>(nested)) {
+      if (synchronizeOp.getQubits().empty()) {
+        known = false;
+        return WalkResult::interrupt();
+      }
+    }
+    if (auto qubitOp = dyn_cast<QubitOpInterface>(nested)) {
+      qubits |= qubitOp.getOperatedQubits();
+    } else if (isa<CallOpInterface>(nested)) {
+      known = false;
+      return WalkResult::interrupt();
+    }
+    // e.g., control flow on a qubit the quantum decoration could not resolve
+    if (!addQubitIdsFromAttr(nested, qubits)) {
+      known = false;
+      return WalkResult::interrupt();
+    }
+    for (Value const operand : nested->getOperands()) {
+      if (operand.getType().isa<QubitType>() && !lookupQubitId(operand)) {
+        known = false;
+        return WalkResult::interrupt();
+      }
+      if (auto producer = operand.getDefiningOp<QubitOpInterface>())
+        qubits |= producer.getOperatedQubits();
+    }
+    return WalkResult::advance();
+  });
+  if (!known)
+    return std::nullopt;
+  return llvm::SmallVector<uint32_t, 4>(qubits.begin(), qubits.end());
+}
+
+std::optional<Alignment<uint32_t>> getAlignment(Operation *op) {
+  Alignment<uint32_t> alignment;
+  if (auto barrierOp = dyn_cast<BarrierOp>(op)) {
+    for (Value const qubit : barrierOp.getQubits()) {
+      auto id = lookupQubitId(qubit);
+      if (!id)
+        return std::nullopt;
+      alignment.resources.push_back(*id);
+    }
+    return alignment;
+  }
+  if (auto synchronizeOp = dyn_cast<qcs::SynchronizeOp>(op)) {
+    alignment.all = synchronizeOp.getQubits().empty();
+    for (uint32_t const id : synchronizeOp.getOperatedQubits())
+      alignment.resources.push_back(id);
+    return alignment;
+  }
+  return std::nullopt;
+}
+} // anonymous namespace
+
+void EliminateBarriersPass::runOnOperation() {
+  llvm::SetVector<Block *> blocks;
+  getOperation()->walk(
+      [&](BarrierOp barrierOp) { blocks.insert(barrierOp->getBlock()); });
+
+  BarrierModel<uint32_t> const model{getUsedQubits, getAlignment};
+  for (Block *block : blocks) {
+    auto statistics = eliminateBarriers<BarrierOp>(*block, model);
+    numBarriersErased += statistics.numErased;
+    numBarriersNarrowed += statistics.numNarrowed;
+  }
+} // EliminateBarriersPass::runOnOperation
+
+llvm::StringRef EliminateBarriersPass::getArgument() const {
+  return "quir-eliminate-barriers";
+}
+
+llvm::StringRef EliminateBarriersPass::getDescription() const {
+  return "Erase the barriers which do not delay any operation and narrow "
+         "the others to the qubits they delay";
+}
+
+llvm::StringRef EliminateBarriersPass::getName() const {
+  return "Eliminate Barriers Pass";
+}
@@ -23,6 +23,7 @@
 #include "Dialect/QUIR/Transforms/FunctionArgumentSpecialization.h"
 
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -39,7 +40,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include "llvm/Support/Debug.h"
-#include <deque>
+#include <cstddef>
 #include <string>
 
 #define DEBUG_TYPE "QUIRFunctionArgumentSpecialization"
@@ -47,9 +48,26 @@
 using namespace mlir;
 using namespace mlir::quir;
 
+namespace {
+bool isSpecializableCall(Operation *op) {
+  return isa<CallGateOp, CallDefCalGateOp, CallDefcalMeasureOp,
+             CallSubroutineOp>(op);
+}
+} // anonymous namespace
+
+void FunctionArgumentSpecializationPass::addCallsOf(
+    mlir::func::FuncOp funcOp, CallWorkList &callWorkList) {
+  if (!visitedFuncs.insert(funcOp).second)
+    return;
+  funcOp->walk([&](Operation *op) {
+    if (isSpecializableCall(op))
+      callWorkList.push_back(op);
+  });
+} // addCallsOf
+
 template <class CallOpTy>
 void FunctionArgumentSpecializationPass::processCallOp(
-    Operation *op, std::deque<Operation *> &callWorkList) {
+    Operation *op, CallWorkList &callWorkList) {
   CallOpTy callOp = dyn_cast<CallOpTy>(op);
   if (!callOp) {
     llvm::errs() << "Something really wrong in processCallOp<CalLOpTy>()!\n";
@@ -59,7 +77,7 @@ void FunctionArgumentSpecializationPass::processCallOp(
   Operation *moduleOp =
       callOp->template getParentOfType<ModuleOp>().getOperation();
   // look for func def match
-  Operation *findOp = SymbolTable::lookupSymbolIn(moduleOp, callOp.getCallee());
+  Operation *findOp = symbolIndex->lookupSymbolIn(moduleOp, callOp.getCallee());
   if (findOp) {
     mlir::func::FuncOp funcOp = dyn_cast<mlir::func::FuncOp>(findOp);
     if (!funcOp)
@@ -72,14 +90,13 @@ void FunctionArgumentSpecializationPass::processCallOp(
       FunctionType funcType = funcOp.getFunctionType();
       if (callType == funcType) {
         // add calls inside this func def to the work list
-        findOp->walk([&](Operation *op) {
-          if (dyn_cast<CallGateOp>(op) || dyn_cast<CallDefCalGateOp>(op) ||
-              dyn_cast<CallDefcalMeasureOp>(op) ||
-              dyn_cast<CallSubroutineOp>(op))
-            callWorkList.push_back(op);
-        });
+        addCallsOf(funcOp, callWorkList);
       } else if (quirFunctionTypeMatch(callType, funcType)) {
-        copyFuncAndSpecialize<CallOpTy>(funcOp, callOp, callWorkList);
+        auto specialization = specializations.find({funcOp, callType});
+        if (specialization != specializations.end())
+          callOp->setAttr("callee", specialization->second);
+        else
+          copyFuncAndSpecialize<CallOpTy>(funcOp, callOp, callWorkList);
       } else {
         llvm::errs() << "Fundamental type mismatch between call to "
                      << callOp.getCallee() << " and func def "
@@ -95,7 +112,7 @@ void FunctionArgumentSpecializationPass::processCallOp(
 
 template <class T1, class T2, class... Rest>
 void FunctionArgumentSpecializationPass::processCallOp(
-    Operation *op, std::deque<Operation *> &callWorkList) {
+    Operation *op, CallWorkList &callWorkList) {
   if (dyn_cast<T1>(op))
     processCallOp<T1>(op, callWorkList);
   else
@@ -104,8 +121,7 @@ void FunctionArgumentSpecializationPass::processCallOp(
 
 template <class CallOpTy>
 void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
-    mlir::func::FuncOp inFunc, CallOpTy callOp,
-    std::deque<Operation *> &callWorkList) {
+    mlir::func::FuncOp inFunc, CallOpTy callOp, CallWorkList &callWorkList) {
   OpBuilder b(inFunc);
 
   std::string newName = SymbolRefAttr::get(inFunc).getLeafReference().str();
@@ -114,12 +130,14 @@ void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
     ss << "_" << callOperand.getType();
     newName = ss.str();
   }
+  auto newCallee =
+      FlatSymbolRefAttr::get(callOp.getContext(), llvm::StringRef(newName));
+  specializations[{inFunc, callOp.getCalleeType()}] = newCallee;
   // Check if the specialized function aleady exists
-  if (SymbolTable::lookupSymbolIn(inFunc->getParentOp(),
+  if (symbolIndex->lookupSymbolIn(inFunc->getParentOp(),
                                   llvm::StringRef(newName))) {
     // function found, nothing to do
-    callOp->setAttr("callee", FlatSymbolRefAttr::get(callOp.getContext(),
-                                                     llvm::StringRef(newName)));
+    callOp->setAttr("callee", newCallee);
     return;
   }
 
@@ -127,6 +145,8 @@ void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
   newFunc->moveBefore(inFunc);
   newFunc->setAttr(SymbolTable::getSymbolAttrName(),
                    StringAttr::get(newFunc.getContext(), newName));
+  // keep the symbol index up to date with the specialized function
+  symbolIndex->getSymbolTable(inFunc->getParentOp()).insert(newFunc);
   newFunc.setType(callOp.getCalleeType());
   Block &entryBlock = newFunc.front();
   auto callArgTypeIter = callOp.operand_type_begin();
@@ -135,25 +155,21 @@ void FunctionArgumentSpecializationPass::copyFuncAndSpecialize(
     ++callArgTypeIter;
   }
 
-  callOp->setAttr("callee", FlatSymbolRefAttr::get(callOp.getContext(),
-                                                   llvm::StringRef(newName)));
+  callOp->setAttr("callee", newCallee);
 
   // search for all callOps within the cloned function and add them to the
   // work list
-  newFunc.getOperation()->walk([&](Operation *op) {
-    if (dyn_cast<CallGateOp>(op) || dyn_cast<CallDefCalGateOp>(op) ||
-        dyn_cast<CallDefcalMeasureOp>(op) || dyn_cast<CallSubroutineOp>(op)) {
-      callWorkList.push_back(op);
-    }
-  });
+  addCallsOf(newFunc, callWorkList);
 } // copyFuncAndSpecialize
 
 // Entry point for the pass.
 void FunctionArgumentSpecializationPass::runOnOperation() {
   // This pass is only called on module Ops
-  Operation *moduleOp = getOperation();
-  Operation *mainFunc = getMainFunction(moduleOp);
-  std::deque<Operation *> callWorkList;
+  symbolIndex = &getAnalysis<SymbolIndexAnalysis>();
+  Operation *mainFunc = symbolIndex->getMainFunction();
+  specializations.clear();
+  visitedFuncs.clear();
+  CallWorkList callWorkList;
 
   if (!mainFunc) {
     llvm::errs()
@@ -162,17 +178,17 @@ void FunctionArgumentSpecializationPass::runOnOperation() {
   }
 
   mainFunc->walk([&](Operation *op) {
-    if (dyn_cast<CallGateOp>(op) || dyn_cast<CallDefCalGateOp>(op) ||
-        dyn_cast<CallDefcalMeasureOp>(op) || dyn_cast<CallSubroutineOp>(op))
+    if (isSpecializableCall(op))
       callWorkList.push_back(op);
   });
 
-  while (!callWorkList.empty()) {
-    Operation *op = callWorkList.front();
-    callWorkList.pop_front();
+  // calls are added while the work list is processed, in order
+  for (size_t i = 0; i < callWorkList.size(); ++i)
     processCallOp<CallGateOp, CallDefCalGateOp, CallDefcalMeasureOp,
-                  CallSubroutineOp>(op, callWorkList);
-  } // while !callWorkList.empty()
+                  CallSubroutineOp>(callWorkList[i], callWorkList);
+
+  // specialized functions were added to the symbol index as they were created
+  markAnalysesPreserved<SymbolIndexAnalysis>();
 } // runOnOperation
 
 llvm::StringRef FunctionArgumentSpecializationPass::getArgument() const {
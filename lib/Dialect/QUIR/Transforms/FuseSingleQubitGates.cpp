@@ -0,0 +1,340 @@
+//===- FuseSingleQubitGates.cpp - Fuse single qubit gates -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for fusing the runs of single qubit gates
+///  with known angles into a single quir.builtin_U.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/FuseSingleQubitGates.h"
+
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <optional>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+using Complex = std::complex<double>;
+
+/// The tolerance of the comparisons of the entries of unitaries, well above
+/// the rounding errors of the products of a few thousand gates.
+constexpr double tolerance = 1e-9;
+
+double wrapAngle(double value) {
+  double const twoPi = 2.0 * llvm::numbers::pi;
+  double wrapped = std::fmod(value, twoPi);
+  if (wrapped < 0.0)
+    wrapped += twoPi;
+  return wrapped;
+}
+
+/// A single qubit unitary up to a global phase, as a row-major matrix.
+struct Unitary {
+  std::array<Complex, 4> m;
+
+  /// The unitary of U(theta, phi, lambda), as defined by OpenQASM 3.
+  static Unitary fromAngles(double theta, double phi, double lambda) {
+    double const c = std::cos(theta / 2.0);
+    double const s = std::sin(theta / 2.0);
+    return {{Complex(c, 0.0), -std::polar(s, lambda), std::polar(s, phi),
+             std::polar(c, phi + lambda)}};
+  }
+
+  /// The unitary of applying this one and then next.
+  Unitary then(const Unitary &next) const {
+    auto const &n = next.m;
+    return {{n[0] * m[0] + n[1] * m[2], n[0] * m[1] + n[1] * m[3],
+             n[2] * m[0] + n[3] * m[2], n[2] * m[1] + n[3] * m[3]}};
+  }
+
+  bool isIdentity() const {
+    return std::abs(m[1]) < tolerance && std::abs(m[2]) < tolerance &&
+           std::abs(m[0] - m[3]) < tolerance;
+  }
+
+  /// The angles theta, phi and lambda of U with this unitary, wrapped to
+  /// [0, 2*pi). The phases which are undetermined at theta = 0 or pi are
+  /// carried by lambda and phi respectively.
+  std::array<double, 3> toAngles() const {
+    double const c = std::abs(m[0]);
+    double const s = std::abs(m[2]);
+    double const theta = 2.0 * std::atan2(s, c);
+    double phi = 0.0;
+    double lambda = 0.0;
+    if (s < tolerance) {
+      lambda = std::arg(m[3]) - std::arg(m[0]);
+    } else if (c < tolerance) {
+      phi = std::arg(m[2]) - std::arg(-m[1]);
+    } else {
+      double const phase = std::arg(m[0]);
+      phi = std::arg(m[2]) - phase;
+      lambda = std::arg(-m[1]) - phase;
+    }
+    return {wrapAngle(theta), wrapAngle(phi), wrapAngle(lambda)};
+  }
+};
+
+std::optional<double> getConstantAngle(Value value) {
+  if (auto constantOp = value.getDefiningOp<quir::ConstantOp>())
+    if (auto angleAttr = constantOp.getValue().dyn_cast<AngleAttr>())
+      return angleAttr.getValue().convertToDouble();
+  return std::nullopt;
+}
+
+std::optional<Unitary> getUnitary(Builtin_UOp uOp,
+                                  const llvm::DenseMap<Value, double> &angles) {
+  std::array<double, 3> values;
+  Value const operands[] = {uOp.getTheta(), uOp.getPhi(), uOp.getLambda()};
+  for (auto [value, operand] : llvm::zip(values, operands)) {
+    auto angle = angles.find(operand);
+    if (angle != angles.end()) {
+      value = angle->second;
+      continue;
+    }
+    auto constant = getConstantAngle(operand);
+    if (!constant)
+      return std::nullopt;
+    value = *constant;
+  }
+  return Unitary::fromAngles(values[0], values[1], values[2]);
+}
+
+/// The unitary of a call of a gate whose body is nothing but builtin_U of
+/// its qubit, over its angle arguments and constants.
+std::optional<Unitary> getUnitary(CallGateOp callGateOp) {
+  auto funcOp = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+      callGateOp, callGateOp.getCalleeAttr());
+  if (!funcOp || funcOp.isExternal() || !funcOp.getBody().hasOneBlock() ||
+      funcOp.getNumArguments() != callGateOp->getNumOperands())
+    return std::nullopt;
+
+  Value qubit;
+  llvm::DenseMap<Value, double> angles;
+  for (auto [argument, operand] :
+       llvm::zip(funcOp.getArguments(), callGateOp->getOperands())) {
+    if (argument.getType().isa<QubitType>()) {
+      if (qubit)
+        return std::nullopt;
+      qubit = argument;
+      continue;
+    }
+    auto angle = getConstantAngle(operand);
+    if (!angle)
+      return std::nullopt;
+    angles[argument] = *angle;
+  }
+
+  std::optional<Unitary> unitary;
+  for (Operation &op : funcOp.getBody().front()) {
+    if (isa<quir::ConstantOp>(op) ||
+        (isa<func::ReturnOp>(op) && op.getNumOperands() == 0))
+      continue;
+    auto uOp = dyn_cast<Builtin_UOp>(op);
+    if (!uOp || uOp.getTarget() != qubit)
+      return std::nullopt;
+    auto next = getUnitary(uOp, angles);
+    if (!next)
+      return std::nullopt;
+    unitary = unitary ? unitary->then(*next) : *next;
+  }
+  return unitary;
+}
+
+std::optional<Unitary> getUnitary(Operation *op) {
+  if (auto uOp = dyn_cast<Builtin_UOp>(op))
+    return getUnitary(uOp, {});
+  if (auto callGateOp = dyn_cast<CallGateOp>(op))
+    return getUnitary(callGateOp);
+  return std::nullopt;
+}
+
+/// The angle type of the fused gate of a run, that of its first angle.
+Type getAngleType(llvm::ArrayRef<Operation *> ops) {
+  for (Operation *op : ops)
+    for (Value operand : op->getOperands())
+      if (operand.getType().isa<AngleType>())
+        return operand.getType();
+  return AngleType::get(ops.front()->getContext(), 64);
+}
+
+/// Fuses the runs of single qubit gates of a block.
+class BlockFuser {
+public:
+  void fuse(Block &block);
+
+  unsigned numGatesFused = 0;
+  unsigned numGatesErased = 0;
+  unsigned numCXCancelled = 0;
+
+private:
+  struct Run {
+    llvm::SmallVector<Operation *, 4> ops;
+    Unitary unitary;
+  };
+
+  void flush(Value qubit);
+  void flushAll();
+
+  llvm::MapVector<Value, Run> runs;
+  /// The last operation on each qubit, if known.
+  llvm::DenseMap<Value, Operation *> lastOps;
+}; // class BlockFuser
+
+void BlockFuser::fuse(Block &block) {
+  for (Operation &op : llvm::make_early_inc_range(block)) {
+    // the gates of the regions of op may apply to the qubits of the runs
+    if (op.getNumRegions() != 0) {
+      flushAll();
+      continue;
+    }
+
+    llvm::SmallVector<Value, 2> qubits;
+    for (Value operand : op.getOperands())
+      if (operand.getType().isa<QubitType>())
+        qubits.push_back(operand);
+    if (qubits.empty()) {
+      if (!isMemoryEffectFree(&op))
+        flushAll();
+      continue;
+    }
+
+    if (qubits.size() == 1) {
+      if (auto unitary = getUnitary(&op)) {
+        auto &run = runs[qubits.front()];
+        run.unitary = run.ops.empty() ? *unitary : run.unitary.then(*unitary);
+        run.ops.push_back(&op);
+        lastOps[qubits.front()] = &op;
+        continue;
+      }
+    }
+
+    for (Value qubit : qubits)
+      flush(qubit);
+
+    if (auto cxOp = dyn_cast<BuiltinCXOp>(op)) {
+      auto previousOp =
+          dyn_cast_or_null<BuiltinCXOp>(lastOps.lookup(cxOp.getControl()));
+      if (previousOp && lastOps.lookup(cxOp.getTarget()) == previousOp &&
+          previousOp.getControl() == cxOp.getControl() &&
+          previousOp.getTarget() == cxOp.getTarget()) {
+        lastOps.erase(cxOp.getControl());
+        lastOps.erase(cxOp.getTarget());
+        previousOp->erase();
+        cxOp->erase();
+        ++numCXCancelled;
+        continue;
+      }
+    }
+
+    for (Value qubit : qubits)
+      lastOps[qubit] = &op;
+  }
+  flushAll();
+}
+
+void BlockFuser::flush(Value qubit) {
+  auto it = runs.find(qubit);
+  if (it == runs.end())
+    return;
+  Run run = std::move(it->second);
+  runs.erase(it);
+
+  if (run.unitary.isIdentity()) {
+    lastOps.erase(qubit);
+    for (Operation *op : run.ops)
+      op->erase();
+    numGatesErased += run.ops.size();
+    return;
+  }
+  if (run.ops.size() < 2)
+    return;
+
+  // the fused gate takes the place of the last gate of the run
+  Operation *lastOp = run.ops.back();
+  OpBuilder builder(lastOp);
+  auto angleType = getAngleType(run.ops);
+  llvm::SmallVector<Value, 3> angles;
+  for (double const angle : run.unitary.toAngles())
+    angles.push_back(builder.create<quir::ConstantOp>(
+        lastOp->getLoc(),
+        AngleAttr::get(builder.getContext(), angleType.cast<AngleType>(),
+                       llvm::APFloat(angle))));
+  auto fusedOp = builder.create<Builtin_UOp>(lastOp->getLoc(), qubit,
+                                             angles[0], angles[1], angles[2]);
+  for (Operation *op : run.ops)
+    op->erase();
+  numGatesFused += run.ops.size();
+  lastOps[qubit] = fusedOp;
+}
+
+void BlockFuser::flushAll() {
+  while (!runs.empty())
+    flush(runs.front().first);
+  lastOps.clear();
+}
+} // anonymous namespace
+
+void FuseSingleQubitGatesPass::runOnOperation() {
+  // the blocks are collected first, as fusing erases operations
+  llvm::SmallVector<Block *> blocks;
+  getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+
+  for (Block *block : blocks) {
+    BlockFuser fuser;
+    fuser.fuse(*block);
+    numGatesFused += fuser.numGatesFused;
+    numGatesErased += fuser.numGatesErased;
+    numCXCancelled += fuser.numCXCancelled;
+  }
+} // FuseSingleQubitGatesPass::runOnOperation
+
+llvm::StringRef FuseSingleQubitGatesPass::getArgument() const {
+  return "quir-fuse-single-qubit-gates";
+}
+
+llvm::StringRef FuseSingleQubitGatesPass::getDescription() const {
+  return "Fuse the runs of single qubit gates with constant angles into a "
+         "single builtin_U, and cancel consecutive pairs of CX gates";
+}
+
+llvm::StringRef FuseSingleQubitGatesPass::getName() const {
+  return "Fuse Single Qubit Gates Pass";
+}
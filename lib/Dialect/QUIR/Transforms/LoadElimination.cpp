@@ -72,7 +72,7 @@ void LoadEliminationPass::runOnOperation() {
           return false;
         });
 
-    if (numAssignments > 1)
+    if (numAssignments != 1)
       return WalkResult::advance();
 
     // only support assignment by VariableAssignOp, for now
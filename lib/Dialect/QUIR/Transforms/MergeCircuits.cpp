@@ -24,9 +24,12 @@
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/QubitFootprintAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/Attributes.h"
+#include "mlir/IR/Block.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/MLIRContext.h"
@@ -37,11 +40,14 @@
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 #include "mlir/IR/ValueRange.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
@@ -49,10 +55,8 @@
 #include <algorithm>
 #include <cassert>
 #include <optional>
-#include <set>
 #include <string>
 #include <sys/types.h>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -61,24 +65,17 @@ using namespace mlir::quir;
 
 namespace {
 
-using MoveListVec = std::vector<Operation *>;
-bool moveUsers(Operation *curOp, MoveListVec &moveList) {
-  moveList.push_back(curOp);
-  for (auto *user : curOp->getUsers())
-    if (!moveUsers(user, moveList))
-      return false;
-  return true;
-}
-
 // This pattern matches on two CallCircuitOps separated by non-quantum ops
 struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
   explicit CircuitAndCircuitPattern(MLIRContext *ctx,
-                                    llvm::StringMap<Operation *> &symbolMap)
-      : OpRewritePattern<CallCircuitOp>(ctx) {
+                                    llvm::StringMap<Operation *> &symbolMap,
+                                    QubitFootprintAnalysis &footprints)
+      : OpRewritePattern<CallCircuitOp>(ctx), footprints(footprints) {
     _symbolMap = &symbolMap;
   }
 
   llvm::StringMap<Operation *> *_symbolMap;
+  QubitFootprintAnalysis &footprints;
 
   LogicalResult matchAndRewrite(CallCircuitOp callCircuitOp,
                                 PatternRewriter &rewriter) const override {
@@ -87,6 +84,7 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
     Operation *searchOp = callCircuitOp.getOperation();
     std::optional<Operation *> secondOp;
     CallCircuitOp nextCallCircuitOp;
+    QubitSet const firstQubits = footprints.getOperatedQubits(callCircuitOp);
     while (true) {
       secondOp = nextQuantumOpOrNull(searchOp);
       if (!secondOp)
@@ -99,10 +97,7 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
       // check for overlap in qubits between the circuit and the
       // next quantum circuit which is not a CallCircuit
       // fail if there is overlap
-      std::set<uint> firstQubits =
-          QubitOpInterface::getOperatedQubits(callCircuitOp);
-      std::set<uint> secondQubits =
-          QubitOpInterface::getOperatedQubits(*secondOp);
+      QubitSet const secondQubits = footprints.getOperatedQubits(*secondOp);
 
       if (QubitOpInterface::qubitSetsOverlap(firstQubits, secondQubits))
         return failure();
@@ -112,7 +107,7 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
 
     Operation *insertOp = *secondOp;
 
-    MoveListVec moveList;
+    llvm::SmallVector<Operation *> moveList;
 
     // Move first CallCircuitOp after nodes until a user of the
     // CallCircuitOp or the second CallCircuitOp is reached
@@ -128,10 +123,12 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
             callCircuitOp->user_end())
           break;
 
-        okToMoveUsers = moveUsers(curOp, moveList);
+        okToMoveUsers = collectTransitiveUsers(curOp, moveList);
         if (okToMoveUsers)
           for (auto *op : moveList) {
+            Block *oldBlock = op->getBlock();
             op->moveAfter(insertOp);
+            footprints.notifyOperationMoved(op, oldBlock);
             insertOp = op;
           }
       }
@@ -161,6 +158,10 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
       curOp = nextCallCircuitOp->getPrevNode();
     }
 
+    // The remaining moves above only reorder the block
+    footprints.notifyOperationMoved(callCircuitOp,
+                                    nextCallCircuitOp->getBlock());
+
     if (callCircuitOp->getNextNode() != nextCallCircuitOp)
       return failure();
 
@@ -170,7 +171,9 @@ struct CircuitAndCircuitPattern : public OpRewritePattern<CallCircuitOp> {
 };  // struct CircuitAndCircuitPattern
 
 template <class FirstOp, class SecondOp>
-std::optional<SecondOp> getNextOpAndCompareOverlap(FirstOp firstOp) {
+std::optional<SecondOp>
+getNextOpAndCompareOverlap(FirstOp firstOp,
+                           QubitFootprintAnalysis &footprints) {
   std::optional<Operation *> secondOp = nextQuantumOpOrNull(firstOp);
   if (!secondOp)
     return std::nullopt;
@@ -180,9 +183,8 @@ std::optional<SecondOp> getNextOpAndCompareOverlap(FirstOp firstOp) {
     return std::nullopt;
 
   // Check for overlap between currQubits and what's operated on by nextOp
-  std::set<uint> firstQubits = QubitOpInterface::getOperatedQubits(firstOp);
-  std::set<uint> secondQubits =
-      QubitOpInterface::getOperatedQubits(secondOpByClass);
+  QubitSet const firstQubits = footprints.getOperatedQubits(firstOp);
+  QubitSet const secondQubits = footprints.getOperatedQubits(secondOpByClass);
 
   if (QubitOpInterface::qubitSetsOverlap(firstQubits, secondQubits))
     return std::nullopt;
@@ -192,8 +194,11 @@ std::optional<SecondOp> getNextOpAndCompareOverlap(FirstOp firstOp) {
 // This pattern matches on a BarrierOp follows by a CallCircuitOp separated by
 // non-quantum ops
 struct BarrierAndCircuitPattern : public OpRewritePattern<BarrierOp> {
-  explicit BarrierAndCircuitPattern(MLIRContext *ctx)
-      : OpRewritePattern<BarrierOp>(ctx) {}
+  explicit BarrierAndCircuitPattern(MLIRContext *ctx,
+                                    QubitFootprintAnalysis &footprints)
+      : OpRewritePattern<BarrierOp>(ctx), footprints(footprints) {}
+
+  QubitFootprintAnalysis &footprints;
 
   LogicalResult matchAndRewrite(BarrierOp barrierOp,
                                 PatternRewriter &rewriter) const override {
@@ -204,12 +209,13 @@ struct BarrierAndCircuitPattern : public OpRewritePattern<BarrierOp> {
     if (!prevCallCircuitOp)
       return failure();
 
-    auto callCircuitOp =
-        getNextOpAndCompareOverlap<BarrierOp, CallCircuitOp>(barrierOp);
+    auto callCircuitOp = getNextOpAndCompareOverlap<BarrierOp, CallCircuitOp>(
+        barrierOp, footprints);
     if (!callCircuitOp.has_value())
       return failure();
 
     barrierOp->moveAfter(callCircuitOp.value().getOperation());
+    footprints.notifyOperationMoved(barrierOp, barrierOp->getBlock());
 
     return success();
   } // matchAndRewrite
@@ -218,14 +224,17 @@ struct BarrierAndCircuitPattern : public OpRewritePattern<BarrierOp> {
 // This pattern matches on a CallCircuitOp followed by a BarrierOp separated by
 // non-quantum ops
 struct CircuitAndBarrierPattern : public OpRewritePattern<CallCircuitOp> {
-  explicit CircuitAndBarrierPattern(MLIRContext *ctx)
-      : OpRewritePattern<CallCircuitOp>(ctx) {}
+  explicit CircuitAndBarrierPattern(MLIRContext *ctx,
+                                    QubitFootprintAnalysis &footprints)
+      : OpRewritePattern<CallCircuitOp>(ctx), footprints(footprints) {}
+
+  QubitFootprintAnalysis &footprints;
 
   LogicalResult matchAndRewrite(CallCircuitOp callCircuitOp,
                                 PatternRewriter &rewriter) const override {
 
-    auto barrierOp =
-        getNextOpAndCompareOverlap<CallCircuitOp, BarrierOp>(callCircuitOp);
+    auto barrierOp = getNextOpAndCompareOverlap<CallCircuitOp, BarrierOp>(
+        callCircuitOp, footprints);
     if (!barrierOp.has_value())
       return failure();
 
@@ -237,6 +246,8 @@ struct CircuitAndBarrierPattern : public OpRewritePattern<CallCircuitOp> {
       return failure();
 
     barrierOperation->moveBefore(callCircuitOp);
+    footprints.notifyOperationMoved(barrierOperation,
+                                    barrierOperation->getBlock());
 
     return success();
   } // matchAndRewrite
@@ -261,10 +272,19 @@ MergeCircuitsPass::getCircuitOp(CallCircuitOp callCircuitOp,
 LogicalResult MergeCircuitsPass::mergeCallCircuits(
     PatternRewriter &rewriter, CallCircuitOp callCircuitOp,
     CallCircuitOp nextCallCircuitOp, llvm::StringMap<Operation *> *symbolMap) {
-  auto circuitOp = getCircuitOp(callCircuitOp, symbolMap);
-  auto nextCircuitOp = getCircuitOp(nextCallCircuitOp, symbolMap);
+  mergeCallCircuits(rewriter, {callCircuitOp, nextCallCircuitOp}, symbolMap);
+  return success();
+}
+
+CallCircuitOp MergeCircuitsPass::mergeCallCircuits(
+    RewriterBase &rewriter, llvm::ArrayRef<CallCircuitOp> callCircuitOps,
+    llvm::StringMap<Operation *> *symbolMap) {
+  assert(callCircuitOps.size() > 1 && "at least two call_circuits required");
+  auto firstCallCircuitOp = callCircuitOps.front();
+  auto circuitOp = getCircuitOp(firstCallCircuitOp, symbolMap);
+  auto lastCircuitOp = getCircuitOp(callCircuitOps.back(), symbolMap);
 
-  rewriter.setInsertionPointAfter(nextCircuitOp);
+  rewriter.setInsertionPointAfter(lastCircuitOp);
 
   llvm::SmallVector<Type> outputTypes;
   llvm::SmallVector<Value> outputValues;
@@ -272,69 +292,70 @@ LogicalResult MergeCircuitsPass::mergeCallCircuits(
   // merge the call_circuits
   // collect their input values
   llvm::SmallVector<Value> callInputValues;
-  callInputValues.append(callCircuitOp->getOperands().begin(),
-                         callCircuitOp.getOperands().end());
-
-  llvm::SmallVector<int> insertedArguments;
-  std::unordered_map<int, int> reusedArguments;
-  int index = 0;
-  for (auto inputValue : nextCallCircuitOp->getOperands()) {
-    auto *search = find(callInputValues, inputValue);
-    if (search == callInputValues.end()) {
-      callInputValues.push_back(inputValue);
-      insertedArguments.push_back(index);
-    } else {
-      int const originalIndex = search - callInputValues.begin();
-      reusedArguments[index] = originalIndex;
-    }
-    index++;
-  }
+  callInputValues.append(firstCallCircuitOp->getOperands().begin(),
+                         firstCallCircuitOp.getOperands().end());
 
   // merge circuit names
-  std::string const newName =
-      (circuitOp.getSymName() + "_" + nextCircuitOp.getSymName()).str();
+  std::string newName = circuitOp.getSymName().str();
 
   // create new circuit operation by cloning first circuit
   CircuitOp newCircuitOp = cast<CircuitOp>(rewriter.clone(*circuitOp));
-  newCircuitOp->setAttr(SymbolTable::getSymbolAttrName(),
-                        StringAttr::get(circuitOp->getContext(), newName));
 
-  // store original return operations for later use
-  quir::ReturnOp returnOp;
+  // collect all of the first circuit's ids
+  std::vector<int> allIds;
+  auto theseIdsAttr = newCircuitOp->getAttrOfType<ArrayAttr>(
+      mlir::quir::getPhysicalIdsAttrName());
+  for (Attribute const valAttr : theseIdsAttr) {
+    auto intAttr = valAttr.dyn_cast<IntegerAttr>();
+    allIds.push_back(intAttr.getInt());
+  }
+
+  // store the last original return operation for later use
   quir::ReturnOp nextReturnOp;
+  circuitOp->walk([&](quir::ReturnOp r) { nextReturnOp = r; });
+
+  for (auto nextCallCircuitOp : callCircuitOps.drop_front()) {
+    auto nextCircuitOp = getCircuitOp(nextCallCircuitOp, symbolMap);
+    newName += "_";
+    newName += nextCircuitOp.getSymName();
+
+    // map original arguments for new circuit based on original circuit
+    // argument numbers, reusing the arguments of repeated input values
+    IRMapping mapper;
+    for (const auto &input :
+         llvm::enumerate(nextCallCircuitOp->getOperands())) {
+      auto arg = nextCircuitOp.getArgument(input.index());
+      auto *search = find(callInputValues, input.value());
+      unsigned const argumentIndex = search - callInputValues.begin();
+      if (search == callInputValues.end()) {
+        callInputValues.push_back(input.value());
+        newCircuitOp.insertArgument(argumentIndex, arg.getType(),
+                                    nextCircuitOp.getArgAttrDict(input.index()),
+                                    arg.getLoc());
+      }
+      mapper.map(arg, newCircuitOp.getArgument(argumentIndex));
+    }
 
-  circuitOp->walk([&](quir::ReturnOp r) { returnOp = r; });
-  nextCircuitOp->walk([&](quir::ReturnOp r) { nextReturnOp = r; });
-
-  // map original arguments for new circuit based on original circuit
-  // argument numbers
-  IRMapping mapper;
-  auto baseArgNum = newCircuitOp.getNumArguments();
-  int insertedCount = 0;
-  for (uint cnt = 0; cnt < nextCircuitOp.getNumArguments(); cnt++) {
-    auto arg = nextCircuitOp.getArgument(cnt);
-    int argumentIndex = 0;
-    if (find(insertedArguments, cnt) != insertedArguments.end()) {
-      auto dictArg = nextCircuitOp.getArgAttrDict(cnt);
-      newCircuitOp.insertArgument(baseArgNum + insertedCount, arg.getType(),
-                                  dictArg, arg.getLoc());
-      argumentIndex = baseArgNum + insertedCount;
-      insertedCount++;
-    } else {
-      argumentIndex = reusedArguments[cnt];
+    // copy the next circuit into the new circuit
+    rewriter.setInsertionPointToEnd(&newCircuitOp.back());
+    for (auto &block : nextCircuitOp.getBody().getBlocks())
+      for (auto &op : block.getOperations())
+        rewriter.clone(op, mapper);
+    nextCircuitOp->walk([&](quir::ReturnOp r) { nextReturnOp = r; });
+
+    // add IDs from the next circuit if not already present
+    auto newIdsAttr = nextCircuitOp->getAttrOfType<ArrayAttr>(
+        mlir::quir::getPhysicalIdsAttrName());
+    for (Attribute const valAttr : newIdsAttr) {
+      auto intAttr = valAttr.dyn_cast<IntegerAttr>();
+      auto result = std::find(begin(allIds), end(allIds), intAttr.getInt());
+      if (result == end(allIds))
+        allIds.push_back(intAttr.getInt());
     }
-    mapper.map(arg, newCircuitOp.getArgument(argumentIndex));
   }
 
-  // find return op in new circuit and copy second circuit into the
-  // new circuit
-  quir::ReturnOp newReturnOp;
-  newCircuitOp->walk([&](quir::ReturnOp r) { newReturnOp = r; });
-  rewriter.setInsertionPointAfter(newReturnOp);
-
-  for (auto &block : nextCircuitOp.getBody().getBlocks())
-    for (auto &op : block.getOperations())
-      rewriter.clone(op, mapper);
+  newCircuitOp->setAttr(SymbolTable::getSymbolAttrName(),
+                        StringAttr::get(circuitOp->getContext(), newName));
 
   // remove any existing return operations from new circuit
   // collect their output types and values into vectors
@@ -356,49 +377,100 @@ LogicalResult MergeCircuitsPass::mergeCallCircuits(
       /*results=*/ArrayRef<Type>(outputTypes)));
 
   // merge the physical ID attributes
-  auto theseIdsAttr = newCircuitOp->getAttrOfType<ArrayAttr>(
-      mlir::quir::getPhysicalIdsAttrName());
-
-  auto newIdsAttr = nextCircuitOp->getAttrOfType<ArrayAttr>(
-      mlir::quir::getPhysicalIdsAttrName());
-
-  // collect all of the first circuit's ids
-  std::vector<int> allIds;
-  for (Attribute const valAttr : theseIdsAttr) {
-    auto intAttr = valAttr.dyn_cast<IntegerAttr>();
-    allIds.push_back(intAttr.getInt());
-  }
-
-  // add IDs from the second circuit if not from the first
-  for (Attribute const valAttr : newIdsAttr) {
-    auto intAttr = valAttr.dyn_cast<IntegerAttr>();
-    auto result = std::find(begin(allIds), end(allIds), intAttr.getInt());
-    if (result == end(allIds))
-      allIds.push_back(intAttr.getInt());
-  }
-
   newCircuitOp->setAttr(mlir::quir::getPhysicalIdsAttrName(),
                         rewriter.getI32ArrayAttr(ArrayRef<int>(allIds)));
 
-  rewriter.setInsertionPointAfter(nextCallCircuitOp);
+  rewriter.setInsertionPointAfter(callCircuitOps.back());
   auto newCallOp = rewriter.create<mlir::quir::CallCircuitOp>(
-      callCircuitOp->getLoc(), newName, TypeRange(outputTypes),
+      firstCallCircuitOp->getLoc(), newName, TypeRange(outputTypes),
       ValueRange(callInputValues));
 
   // dice the output so we can specify which results to replace
-  auto iterSep = newCallOp.result_begin() + callCircuitOp.getNumResults();
-  rewriter.replaceOp(callCircuitOp,
-                     ResultRange(newCallOp.result_begin(), iterSep));
-  rewriter.replaceOp(nextCallCircuitOp,
-                     ResultRange(iterSep, newCallOp.result_end()));
+  auto resultIter = newCallOp.result_begin();
+  for (auto callCircuitOp : callCircuitOps) {
+    auto iterSep = resultIter + callCircuitOp.getNumResults();
+    rewriter.replaceOp(callCircuitOp, ResultRange(resultIter, iterSep));
+    resultIter = iterSep;
+  }
 
   // add new name to symbolMap
   // do not remove old in case the are multiple calls
   (*symbolMap)[newName] = newCircuitOp.getOperation();
 
-  return success();
+  return newCallOp;
+}
+
+namespace {
+
+/// A run of call_circuits of a block which may be merged into one call, and
+/// the operations between them using their results, which must be moved
+/// after the merged call.
+struct MergeableRun {
+  llvm::SmallVector<CallCircuitOp> callCircuitOps;
+  llvm::SmallVector<Operation *> users;
+};
+
+/// Collect the maximal runs of call_circuits of block which may be merged.
+/// A run ends at control flow, at quantum operations sharing qubits with the
+/// run and at operations depending on the results of the run which cannot be
+/// moved after it.
+void collectMergeableRuns(Block &block, QubitFootprintAnalysis &footprints,
+                          std::vector<MergeableRun> &runs) {
+  MergeableRun run;
+  QubitSet runQubits;
+  llvm::SmallPtrSet<Operation *, 8> dependents;
+  llvm::SmallVector<Operation *> pendingUsers;
+
+  auto addDependentUsers = [&](Operation *op) {
+    for (Operation *user : op->getUsers())
+      if (Operation *ancestor = block.findAncestorOpInBlock(*user))
+        dependents.insert(ancestor);
+  };
+
+  auto endRun = [&]() {
+    if (run.callCircuitOps.size() > 1)
+      runs.push_back(std::move(run));
+    run = MergeableRun();
+    runQubits.clear();
+    dependents.clear();
+    pendingUsers.clear();
+  };
+
+  for (Operation &op : block) {
+    bool const isDependent = dependents.contains(&op);
+
+    if (auto callCircuitOp = dyn_cast<CallCircuitOp>(op)) {
+      if (isDependent)
+        endRun();
+      run.users.append(pendingUsers.begin(), pendingUsers.end());
+      pendingUsers.clear();
+      run.callCircuitOps.push_back(callCircuitOp);
+      runQubits |= footprints.getOperatedQubits(callCircuitOp);
+      addDependentUsers(callCircuitOp);
+      continue;
+    }
+
+    if (run.callCircuitOps.empty())
+      continue;
+
+    if (op.hasTrait<::mlir::RegionBranchOpInterface::Trait>() ||
+        (isQuantumOp(&op) &&
+         (isDependent ||
+          runQubits.overlaps(footprints.getOperatedQubits(&op))))) {
+      endRun();
+      continue;
+    }
+
+    if (isDependent) {
+      pendingUsers.push_back(&op);
+      addDependentUsers(&op);
+    }
+  }
+  endRun();
 }
 
+} // end anonymous namespace
+
 void MergeCircuitsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
@@ -408,18 +480,46 @@ void MergeCircuitsPass::runOnOperation() {
     circuitOpsMap[circuitOp.getSymName()] = circuitOp.getOperation();
   });
 
+  auto &footprints = getAnalysis<QubitFootprintAnalysis>();
+
   RewritePatternSet patterns(&getContext());
-  patterns.add<CircuitAndCircuitPattern>(&getContext(), circuitOpsMap);
-  patterns.add<BarrierAndCircuitPattern>(&getContext());
-  patterns.add<CircuitAndBarrierPattern>(&getContext());
+  // The single sweep merges the circuits itself, after moving barriers out
+  // of the way
+  if (!singleSweep)
+    patterns.add<CountedPattern<CircuitAndCircuitPattern>>(
+        numCircuitAndCircuitMerges, &getContext(), circuitOpsMap, footprints);
+  patterns.add<CountedPattern<BarrierAndCircuitPattern>>(
+      numBarrierAndCircuitMoves, &getContext(), footprints);
+  patterns.add<CountedPattern<CircuitAndBarrierPattern>>(
+      numCircuitAndBarrierMoves, &getContext(), footprints);
+
+  mlir::GreedyRewriteConfig config = rewriteOptions.getConfig();
+  // Keep the cached qubit footprints up to date with the rewrites
+  config.listener = footprints.getListener();
+
+  if (failed(applyPatternsGreedily(moduleOperation, std::move(patterns),
+                                   config, rewriteStatistics))) {
+    signalPassFailure();
+    return;
+  }
 
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
+  if (!singleSweep)
+    return;
 
-  if (failed(applyPatternsAndFoldGreedily(moduleOperation, std::move(patterns),
-                                          config)))
-    signalPassFailure();
+  std::vector<MergeableRun> runs;
+  moduleOperation->walk([&](Block *block) {
+    collectMergeableRuns(*block, footprints, runs);
+  });
+
+  IRRewriter rewriter(&getContext());
+  for (auto &run : runs) {
+    Operation *insertOp =
+        mergeCallCircuits(rewriter, run.callCircuitOps, &circuitOpsMap);
+    for (Operation *user : run.users) {
+      user->moveAfter(insertOp);
+      insertOp = user;
+    }
+  }
 } // runOnOperation
 
 llvm::StringRef MergeCircuitsPass::getArgument() const {
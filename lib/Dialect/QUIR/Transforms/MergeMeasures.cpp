@@ -23,94 +23,122 @@
 
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/ValueRange.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <algorithm>
-#include <iterator>
+#include <cstddef>
 #include <optional>
-#include <set>
 #include <sys/types.h>
-#include <unordered_set>
-#include <utility>
 #include <vector>
 
 using namespace mlir;
 using namespace mlir::quir;
 
 namespace {
-// This pattern matches on two MeasureOps that are only interspersed by
-// classical non-control flow ops and merges them into one measure op
+// Merge the measurements of group, the first of which is measureOp, into a
+// single measure op at the position of measureOp, copying their operands once
+
+static void mergeMeasurements(PatternRewriter &rewriter,
+                              ArrayRef<MeasureOp> group) {
+  size_t numResults = 0;
+  for (auto measureOp : group)
+    numResults += measureOp.getNumResults();
 
-static void mergeMeasurements(PatternRewriter &rewriter, MeasureOp measureOp,
-                              MeasureOp nextMeasureOp) {
   // good to merge
   std::vector<Type> typeVec;
   std::vector<Value> valVec;
-  typeVec.reserve(measureOp.getNumResults() + nextMeasureOp.getNumResults());
-  valVec.reserve(measureOp.getNumResults() + nextMeasureOp.getNumResults());
-
-  typeVec.insert(typeVec.end(), measureOp.result_type_begin(),
-                 measureOp.result_type_end());
-  typeVec.insert(typeVec.end(), nextMeasureOp.result_type_begin(),
-                 nextMeasureOp.result_type_end());
-  valVec.insert(valVec.end(), measureOp.getQubits().begin(),
-                measureOp.getQubits().end());
-  valVec.insert(valVec.end(), nextMeasureOp.getQubits().begin(),
-                nextMeasureOp.getQubits().end());
-
+  typeVec.reserve(numResults);
+  valVec.reserve(numResults);
+  for (auto measureOp : group) {
+    typeVec.insert(typeVec.end(), measureOp.result_type_begin(),
+                   measureOp.result_type_end());
+    valVec.insert(valVec.end(), measureOp.getQubits().begin(),
+                  measureOp.getQubits().end());
+  }
+
+  MeasureOp const measureOp = group.front();
   auto mergedOp = rewriter.create<MeasureOp>(
       measureOp.getLoc(), TypeRange(typeVec), ValueRange(valVec));
 
   // dice the output so we can specify which results to replace
-  auto iterSep = mergedOp.getOuts().begin() + measureOp.getNumResults();
-  rewriter.replaceOp(measureOp,
-                     ResultRange(mergedOp.getOuts().begin(), iterSep));
-  rewriter.replaceOp(nextMeasureOp,
-                     ResultRange(iterSep, mergedOp.getOuts().end()));
+  auto iterBegin = mergedOp.getOuts().begin();
+  for (auto groupOp : group) {
+    auto iterSep = iterBegin + groupOp.getNumResults();
+    rewriter.replaceOp(groupOp, ResultRange(iterBegin, iterSep));
+    iterBegin = iterSep;
+  }
+}
+
+// Whether a measurement of numQubits qubits may join a group of groupWidth
+// qubits, with maxWidth 0 for groups of any width
+static bool fitsGroup(size_t groupWidth, size_t numQubits, unsigned maxWidth) {
+  return maxWidth == 0 || groupWidth + numQubits <= maxWidth;
 }
 
+// This pattern matches on a run of MeasureOps that are only interspersed by
+// classical non-control flow ops and merges them into one measure op of up
+// to maxWidth qubits
 struct MeasureAndMeasureLexographicalPattern
     : public OpRewritePattern<MeasureOp> {
-  explicit MeasureAndMeasureLexographicalPattern(MLIRContext *ctx)
-      : OpRewritePattern<MeasureOp>(ctx) {}
+  MeasureAndMeasureLexographicalPattern(MLIRContext *ctx, unsigned maxWidth)
+      : OpRewritePattern<MeasureOp>(ctx), maxWidth(maxWidth) {}
+
+  unsigned maxWidth;
 
   LogicalResult matchAndRewrite(MeasureOp measureOp,
                                 PatternRewriter &rewriter) const override {
-    std::optional<Operation *> nextQuantumOp = nextQuantumOpOrNull(measureOp);
-    if (!nextQuantumOp)
+    // make sure the measurements of the group aren't working on the same
+    // qubit and that we can resolve them all
+    QubitSet measureIds;
+    auto addIds = [&](MeasureOp op) {
+      QubitSet opIds;
+      for (auto qubit : op.getQubits()) {
+        std::optional<uint> id = lookupQubitId(qubit);
+        if (!id || measureIds.contains(*id))
+          return false;
+        opIds.insert(*id);
+      }
+      measureIds |= opIds;
+      return true;
+    };
+    if (!addIds(measureOp))
       return failure();
 
-    auto nextMeasureOp = dyn_cast<MeasureOp>(*nextQuantumOp);
-    if (!nextMeasureOp)
-      return failure();
-
-    // found a measure and a measure, now make sure they aren't working on the
-    // same qubit and that we can resolve them both
-    std::unordered_set<uint> measureIds;
-    for (auto qubit : measureOp.getQubits()) {
-      std::optional<uint> id = lookupQubitId(qubit);
-      if (!id)
-        return failure();
-      measureIds.emplace(*id);
-    }
-    for (auto qubit : nextMeasureOp.getQubits()) {
-      std::optional<uint> id = lookupQubitId(qubit);
-      if (!id || measureIds.count(*id))
-        return failure();
+    llvm::SmallVector<MeasureOp> group{measureOp};
+    size_t groupWidth = measureOp.getQubits().size();
+    while (true) {
+      std::optional<Operation *> nextQuantumOp =
+          nextQuantumOpOrNull(group.back());
+      if (!nextQuantumOp)
+        break;
+
+      auto nextMeasureOp = dyn_cast<MeasureOp>(*nextQuantumOp);
+      if (!nextMeasureOp ||
+          !fitsGroup(groupWidth, nextMeasureOp.getQubits().size(),
+                     maxWidth) ||
+          !addIds(nextMeasureOp))
+        break;
+
+      group.push_back(nextMeasureOp);
+      groupWidth += nextMeasureOp.getQubits().size();
     }
+    if (group.size() < 2)
+      return failure();
 
-    // good to merge
-    mergeMeasurements(rewriter, measureOp, nextMeasureOp);
+    mergeMeasurements(rewriter, group);
 
     return success();
   } // matchAndRewrite
@@ -121,14 +149,16 @@ void MergeMeasuresLexographicalPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
   RewritePatternSet patterns(&getContext());
-  patterns.add<MeasureAndMeasureLexographicalPattern>(&getContext());
-
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  if (failed(applyPatternsAndFoldGreedily(moduleOperation, std::move(patterns),
-                                          config)))
+  patterns.add<CountedPattern<MeasureAndMeasureLexographicalPattern>>(
+      numMeasuresMerged, &getContext(), maxWidth);
+  FrozenRewritePatternSet const frozenPatterns(std::move(patterns));
+
+  // measurements are only merged within their block
+  auto merge = [&](Operation *op) {
+    return applyPatternsGreedily(op, frozenPatterns,
+                                 rewriteOptions.getConfig(), rewriteStatistics);
+  };
+  if (failed(parallelForEachIsolatedOp(moduleOperation, merge)))
     signalPassFailure();
 } // runOnOperation
 
@@ -145,46 +175,54 @@ llvm::StringRef MergeMeasuresLexographicalPass::getName() const {
 }
 
 namespace {
-// This pattern matches on two MeasureOps that are only interspersed by
-// classical non-control flow ops and merges them into one measure op
+// This pattern matches on a run of MeasureOps whose qubits are not operated
+// on along the topological path between them and merges them into one
+// measure op of up to maxWidth qubits
 struct MeasureAndMeasureTopologicalPattern
     : public OpRewritePattern<MeasureOp> {
-  explicit MeasureAndMeasureTopologicalPattern(MLIRContext *ctx)
-      : OpRewritePattern<MeasureOp>(ctx) {}
+  MeasureAndMeasureTopologicalPattern(MLIRContext *ctx, unsigned maxWidth)
+      : OpRewritePattern<MeasureOp>(ctx), maxWidth(maxWidth) {}
+
+  unsigned maxWidth;
 
   LogicalResult matchAndRewrite(MeasureOp measureOp,
                                 PatternRewriter &rewriter) const override {
     // Accumulate qubits in measurement set
-    std::set<uint> currMeasureQubits = measureOp.getOperatedQubits();
-
-    // Find the next measurement operation accumulating qubits along the
-    // topological path if it exists
-    auto [nextMeasureOpt, observedQubits] =
-        QubitOpInterface::getNextQubitOpOfTypeWithQubits<MeasureOp>(measureOp);
-    if (!nextMeasureOpt.has_value())
-      return failure();
-
-    // If any qubit along path touches the same qubits we cannot merge the next
-    // measurement.
-    currMeasureQubits.insert(observedQubits.begin(), observedQubits.end());
-
-    // found a measure and a measure, now make sure they aren't working on the
-    // same qubit and that we can resolve them both
-    MeasureOp nextMeasureOp = nextMeasureOpt.value();
-    auto nextMeasureQubits = nextMeasureOp.getOperatedQubits();
-
-    // If there is an intersection we cannot merge
-    std::set<int> mergeMeasureIntersection;
-    std::set_intersection(currMeasureQubits.begin(), currMeasureQubits.end(),
-                          nextMeasureQubits.begin(), nextMeasureQubits.end(),
-                          std::inserter(mergeMeasureIntersection,
-                                        mergeMeasureIntersection.begin()));
-
-    if (!mergeMeasureIntersection.empty())
+    QubitSet currMeasureQubits = measureOp.getOperatedQubits();
+
+    llvm::SmallVector<MeasureOp> group{measureOp};
+    size_t groupWidth = measureOp.getQubits().size();
+    while (true) {
+      // Find the next measurement operation accumulating qubits along the
+      // topological path if it exists
+      auto [nextMeasureOpt, observedQubits] =
+          QubitOpInterface::getNextQubitOpOfTypeWithQubits<MeasureOp>(
+              group.back());
+      if (!nextMeasureOpt.has_value())
+        break;
+
+      // If any qubit along path touches the same qubits we cannot merge the
+      // next measurement.
+      currMeasureQubits |= observedQubits;
+
+      // found a measure and a measure, now make sure they aren't working on
+      // the same qubit
+      MeasureOp const nextMeasureOp = nextMeasureOpt.value();
+      auto nextMeasureQubits = nextMeasureOp.getOperatedQubits();
+
+      // If there is an intersection we cannot merge
+      if (currMeasureQubits.overlaps(nextMeasureQubits) ||
+          !fitsGroup(groupWidth, nextMeasureOp.getQubits().size(), maxWidth))
+        break;
+
+      currMeasureQubits |= nextMeasureQubits;
+      group.push_back(nextMeasureOp);
+      groupWidth += nextMeasureOp.getQubits().size();
+    }
+    if (group.size() < 2)
       return failure();
 
-    // good to merge
-    mergeMeasurements(rewriter, measureOp, nextMeasureOp);
+    mergeMeasurements(rewriter, group);
 
     return success();
   } // matchAndRewrite
@@ -195,14 +233,16 @@ void MergeMeasuresTopologicalPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
   RewritePatternSet patterns(&getContext());
-  patterns.add<MeasureAndMeasureTopologicalPattern>(&getContext());
-
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  if (failed(applyPatternsAndFoldGreedily(moduleOperation, std::move(patterns),
-                                          config)))
+  patterns.add<CountedPattern<MeasureAndMeasureTopologicalPattern>>(
+      numMeasuresMerged, &getContext(), maxWidth);
+  FrozenRewritePatternSet const frozenPatterns(std::move(patterns));
+
+  // measurements are only merged within their block
+  auto merge = [&](Operation *op) {
+    return applyPatternsGreedily(op, frozenPatterns,
+                                 rewriteOptions.getConfig(), rewriteStatistics);
+  };
+  if (failed(parallelForEachIsolatedOp(moduleOperation, merge)))
     signalPassFailure();
 } // runOnOperation
 
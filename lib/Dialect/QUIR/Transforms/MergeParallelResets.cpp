@@ -23,23 +23,21 @@
 
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/QubitFootprintAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
-#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include "mlir/Support/LLVM.h"
-#include "mlir/Support/LogicalResult.h"
-#include "mlir/Transforms/DialectConversion.h"
-#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <algorithm>
-#include <iterator>
 #include <optional>
-#include <set>
-#include <sys/types.h>
-#include <unordered_set>
-#include <utility>
 #include <vector>
 
 using namespace mlir;
@@ -47,73 +45,138 @@ using namespace mlir::quir;
 
 namespace {
 
-// This pattern merges qubit reset operations that can be parallelized into a
-// single reset op lexicographically.
-struct MergeResetsLexicographicPattern : public OpRewritePattern<ResetQubitOp> {
+/// Resets of a block to merge into a single reset, collected from the last
+/// one to the first one, and the reset whose place the merged reset takes.
+struct ResetGroup {
+  llvm::SmallVector<ResetQubitOp> resetOps;
+  ResetQubitOp anchorOp;
+  /// The qubits of the resets.
+  QubitSet qubits;
+};
+
+/// Keep group if it has more than one reset to merge, and start a new one.
+void closeGroup(ResetGroup &group, std::vector<ResetGroup> &groups) {
+  if (group.resetOps.size() > 1)
+    groups.push_back(std::move(group));
+  group = ResetGroup();
+}
+
+void startGroup(ResetGroup &group, ResetQubitOp resetOp, QubitSet qubits) {
+  group.resetOps.push_back(resetOp);
+  group.anchorOp = resetOp;
+  group.qubits = std::move(qubits);
+}
 
-  explicit MergeResetsLexicographicPattern(MLIRContext *ctx)
-      : OpRewritePattern<ResetQubitOp>(ctx) {}
+/// Replace the resets of each group with a single reset of their qubits in
+/// program order, in place of the anchor of the group.
+void mergeGroups(std::vector<ResetGroup> &groups) {
+  for (auto &group : groups) {
+    llvm::SmallVector<Value> qubits;
+    for (auto resetOp : llvm::reverse(group.resetOps))
+      qubits.append(resetOp.getQubits().begin(), resetOp.getQubits().end());
+    group.anchorOp.getQubitsMutable().assign(qubits);
+    for (auto resetOp : group.resetOps)
+      if (resetOp != group.anchorOp)
+        resetOp->erase();
+  }
+}
 
-  LogicalResult matchAndRewrite(ResetQubitOp resetOp,
-                                PatternRewriter &rewriter) const override {
-    std::unordered_set<uint> qubitIds;
-    qubitIds.reserve(resetOp.getQubits().size());
+/// Get the ids of the qubits of resetOp, or none if one is not known.
+std::optional<QubitSet> lookupQubitIds(ResetQubitOp resetOp) {
+  QubitSet ids;
+  for (auto qubit : resetOp.getQubits()) {
+    auto id = lookupQubitId(qubit);
+    if (!id)
+      return std::nullopt;
+    ids.insert(*id);
+  }
+  return ids;
+}
 
-    for (auto qubit : resetOp.getQubits()) {
-      auto id = lookupQubitId(qubit);
-      if (!id)
-        return failure();
-      qubitIds.emplace(*id);
+// Merge the qubit reset operations of a block that can be parallelized into a
+// single reset op lexicographically, i.e., the resets on distinct qubits with
+// no other quantum operation or control flow in between. The block is swept
+// once from its end, keeping the group of resets which the previous reset
+// may join, so the cost is linear in the number of operations.
+void collectLexicographicGroups(Block &block, std::vector<ResetGroup> &groups) {
+  ResetGroup group;
+  for (Operation &op : llvm::reverse(block)) {
+    if (auto resetOp = dyn_cast<ResetQubitOp>(op)) {
+      auto ids = lookupQubitIds(resetOp);
+      if (!ids) {
+        closeGroup(group, groups);
+        continue;
+      }
+      if (group.resetOps.empty() || group.qubits.overlaps(*ids)) {
+        closeGroup(group, groups);
+        startGroup(group, resetOp, std::move(*ids));
+        continue;
+      }
+      group.resetOps.push_back(resetOp);
+      group.anchorOp = resetOp;
+      group.qubits |= *ids;
+      continue;
     }
-
-    // identify additional reset operations that may happen in parallel and can
-    // be merged
-    auto resetQubitOperands = resetOp.getQubitsMutable();
-
-    std::optional<Operation *> nextQuantumOp = nextQuantumOpOrNull(resetOp);
-    if (!nextQuantumOp)
-      return failure();
-
-    auto nextResetOp = dyn_cast<ResetQubitOp>(*nextQuantumOp);
-    if (!nextResetOp)
-      return failure();
-
-    // check if we can add this reset
-    if (!std::all_of(nextResetOp.getQubits().begin(),
-                     nextResetOp.getQubits().end(), [&](auto qubit) {
-                       // can merge this adjacent qubit reset op when we can
-                       // lookup all of its qubits' ids and these are not
-                       // overlapping with the qubit ids in resetOp or other
-                       // qubit resets that we want to merge
-                       auto id = lookupQubitId(qubit);
-                       return id && (qubitIds.count(*id) == 0);
-                     }))
-      return failure();
-
-    // good to merge
-    for (auto qubit : nextResetOp.getQubits())
-      resetQubitOperands.append(qubit);
-    rewriter.eraseOp(nextResetOp);
-    return success();
+    if (isQuantumOp(&op) ||
+        op.hasTrait<::mlir::RegionBranchOpInterface::Trait>())
+      closeGroup(group, groups);
   }
+  closeGroup(group, groups);
+}
 
-}; // MergeResetsLexicographicPattern
-} // anonymous namespace
+// Merge the qubit reset operations of a block that can be parallelized into a
+// single reset op topologically, i.e., a reset is hoisted to the previous
+// reset, or the previous reset deferred to it, if the operations in between
+// do not operate on its qubits. The block is swept once from its end,
+// keeping the group of resets which the previous reset may join and the
+// qubits operated on since the place of the group, so the cost is linear in
+// the number of operations.
+void collectTopologicalGroups(Block &block, QubitFootprintAnalysis &footprints,
+                              std::vector<ResetGroup> &groups) {
+  ResetGroup group;
+  QubitSet observedQubits;
+  for (Operation &op : llvm::reverse(block)) {
+    auto resetOp = dyn_cast<ResetQubitOp>(op);
+    if (!resetOp) {
+      if (!group.resetOps.empty())
+        observedQubits |= footprints.getOperatedQubits(&op);
+      continue;
+    }
 
-void MergeResetsLexicographicPass::runOnOperation() {
-  mlir::RewritePatternSet patterns(&getContext());
-  mlir::GreedyRewriteConfig config;
+    QubitSet qubits = resetOp.getOperatedQubits();
+    if (group.resetOps.empty()) {
+      startGroup(group, resetOp, std::move(qubits));
+      continue;
+    }
 
-  // Bottom up traversal is 3x as fast
-  config.useTopDownTraversal = false;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
+    // There are 2 possible merge directions; we can hoist the group to merge
+    // with this reset (if nothing uses the qubits of the group between here
+    // and the group), or we can defer this reset to the group (if nothing
+    // uses the qubits of this reset in between). Prefer hoisting.
+    if (!(qubits | observedQubits).overlaps(group.qubits)) {
+      group.resetOps.push_back(resetOp);
+      group.anchorOp = resetOp;
+      group.qubits |= qubits;
+      observedQubits.clear();
+    } else if (!(group.qubits | observedQubits).overlaps(qubits)) {
+      group.resetOps.push_back(resetOp);
+      group.qubits |= qubits;
+    } else {
+      closeGroup(group, groups);
+      startGroup(group, resetOp, std::move(qubits));
+      observedQubits.clear();
+    }
+  }
+  closeGroup(group, groups);
+}
 
-  patterns.add<MergeResetsLexicographicPattern>(&getContext());
+} // anonymous namespace
 
-  if (mlir::failed(applyPatternsAndFoldGreedily(getOperation(),
-                                                std::move(patterns), config)))
-    signalPassFailure();
+void MergeResetsLexicographicPass::runOnOperation() {
+  std::vector<ResetGroup> groups;
+  getOperation()->walk(
+      [&](Block *block) { collectLexicographicGroups(*block, groups); });
+  mergeGroups(groups);
 } // MergeResetsLexicographicPass::runOnOperation
 
 llvm::StringRef MergeResetsLexicographicPass::getArgument() const {
@@ -128,105 +191,13 @@ llvm::StringRef MergeResetsLexicographicPass::getName() const {
   return "Merge Resets Lexicographical Pass";
 }
 
-namespace {
-// This pattern merges qubit reset operations that can be parallelized into a
-// single reset op topologically.
-struct MergeResetsTopologicalPattern : public OpRewritePattern<ResetQubitOp> {
-
-  explicit MergeResetsTopologicalPattern(MLIRContext *ctx)
-      : OpRewritePattern<ResetQubitOp>(ctx) {}
-
-  LogicalResult matchAndRewrite(ResetQubitOp resetOp,
-                                PatternRewriter &rewriter) const override {
-    // Find the next measurement operation accumulating qubits along the
-    // topological path if it exists
-    auto [nextResetOpt, observedQubits] =
-        QubitOpInterface::getNextQubitOpOfTypeWithQubits<ResetQubitOp>(resetOp);
-    if (!nextResetOpt.has_value())
-      return failure();
-
-    ResetQubitOp nextResetOp = nextResetOpt.value();
-
-    // There are 2 possible merge directions; we can hoist the next reset
-    // to merge with this one (if nothing uses the future qubit between here
-    // and the next reset), or we can delay this reset until the next one (if
-    // nothing uses this qubit between here and the next reset). Both options
-    // are possible because the reset operation doesn't produce a result, so
-    // deferring it is trivial.
-
-    // Get the qubits used in both this reset and the next
-    auto curQubits = resetOp.getOperatedQubits();
-    auto nextQubits = nextResetOp.getOperatedQubits();
-
-    // Form a forward set (all qubits used between here and the next
-    // reset, including this operation) and a backward set (all qubits
-    // used between here and the next reset, including the next)
-    std::set<uint> fwdQubits = curQubits;
-    fwdQubits.insert(observedQubits.begin(), observedQubits.end());
-    std::set<uint> backQubits = nextQubits;
-    backQubits.insert(observedQubits.begin(), observedQubits.end());
-
-    // If any qubit along path touches the same qubits we cannot merge in
-    // that direction, so check for intersections
-    std::set<int> mergeFwdIntersection;
-    std::set_intersection(
-        fwdQubits.begin(), fwdQubits.end(), nextQubits.begin(),
-        nextQubits.end(),
-        std::inserter(mergeFwdIntersection, mergeFwdIntersection.begin()));
-
-    std::set<int> mergeBackIntersection;
-    std::set_intersection(
-        backQubits.begin(), backQubits.end(), curQubits.begin(),
-        curQubits.end(),
-        std::inserter(mergeBackIntersection, mergeBackIntersection.begin()));
-
-    if (!mergeFwdIntersection.empty() && !mergeBackIntersection.empty())
-      // Can't merge in EITHER direction
-      return failure();
-
-    // good to merge one way or the other. Prefer hoisting the next reset.
-    if (mergeFwdIntersection.empty()) {
-      // Hoist the next reset into this one
-      auto resetQubitOperands = resetOp.getQubitsMutable();
-      for (auto qubit : nextResetOp.getQubits())
-        resetQubitOperands.append(qubit);
-      rewriter.eraseOp(nextResetOp);
-    } else {
-      // Defer this reset into the next one. We want to insert at the
-      // front (to keep the order right), so replace this instruction
-      // with a new ResetOp
-      std::vector<Value> opVec;
-      opVec.reserve(resetOp.getNumOperands() + nextResetOp.getNumOperands());
-      opVec.insert(opVec.end(), resetOp.getOperands().begin(),
-                   resetOp.getOperands().end());
-      opVec.insert(opVec.end(), nextResetOp.getOperands().begin(),
-                   nextResetOp.getOperands().end());
-
-      rewriter.setInsertionPoint(nextResetOp);
-      rewriter.create<ResetQubitOp>(nextResetOp.getLoc(), opVec);
-      rewriter.eraseOp(nextResetOp);
-      rewriter.eraseOp(resetOp);
-    }
-    return success();
-  }
-
-}; // MergeResetsTopologicalPattern
-} // anonymous namespace
-
 void MergeResetsTopologicalPass::runOnOperation() {
-  mlir::RewritePatternSet patterns(&getContext());
-  mlir::GreedyRewriteConfig config;
-
-  // Bottom up traversal is 3x as fast
-  config.useTopDownTraversal = false;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  patterns.add<MergeResetsTopologicalPattern>(&getContext());
-
-  if (mlir::failed(applyPatternsAndFoldGreedily(getOperation(),
-                                                std::move(patterns), config)))
-    signalPassFailure();
+  auto &footprints = getAnalysis<QubitFootprintAnalysis>();
+  std::vector<ResetGroup> groups;
+  getOperation()->walk([&](Block *block) {
+    collectTopologicalGroups(*block, footprints, groups);
+  });
+  mergeGroups(groups);
 } // MergeResetsTopologicalPass::runOnOperation
 
 llvm::StringRef MergeResetsTopologicalPass::getArgument() const {
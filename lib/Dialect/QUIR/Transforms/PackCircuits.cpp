@@ -0,0 +1,305 @@
+//===- PackCircuits.cpp - Pack independent circuits -------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for packing the independent circuits of a
+///  block into wider circuits.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/PackCircuits.h"
+
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/MergeCircuits.h"
+#include "Dialect/QUIR/Utils/QubitFootprintAnalysis.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+
+/// How an operation is ordered with the other operations of its block.
+enum class Ordering {
+  /// By its operands only, e.g., pure or non-interfering operations.
+  Values,
+  /// By its operands and the operations on the same qubits.
+  Qubits,
+  /// By its operands and the other operations with memory effects, e.g.,
+  /// the assignments of classical variables.
+  Effects,
+  /// Not reordered with any operation, e.g., control flow.
+  Boundary,
+};
+
+Ordering getOrdering(Operation *op, QubitFootprintAnalysis &footprints) {
+  if (op->getNumRegions() != 0 || op->hasTrait<OpTrait::IsTerminator>())
+    return Ordering::Boundary;
+  if (isQuantumOp(op) || isa<QubitOpInterface>(op))
+    return footprints.getOperatedQubits(op).empty() ? Ordering::Boundary
+                                                    : Ordering::Qubits;
+  auto effectInterface = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!effectInterface)
+    return Ordering::Boundary;
+  llvm::SmallVector<MemoryEffects::EffectInstance> effects;
+  effectInterface.getEffects(effects);
+  bool const nonInterfering =
+      llvm::all_of(effects, [](const MemoryEffects::EffectInstance &effect) {
+        return isa<MemoryEffects::Free>(effect.getEffect());
+      });
+  return nonInterfering ? Ordering::Values : Ordering::Effects;
+}
+
+/// Packs the call_circuits of the operations of a block between two
+/// boundaries, which may be reordered as long as their dependencies are
+/// kept.
+class SegmentPacker {
+public:
+  SegmentPacker(QubitFootprintAnalysis &footprints, unsigned maxWidth)
+      : footprints(footprints), maxWidth(maxWidth) {}
+
+  /// Reorder ops, which are followed by the operation before, or by the end
+  /// of the block if before is null, and collect the groups of call_circuits
+  /// made adjacent which are to be merged.
+  void pack(llvm::ArrayRef<Operation *> ops, Operation *before,
+            std::vector<llvm::SmallVector<CallCircuitOp>> &groups);
+
+private:
+  /// Build the edges between ops and the depth of each of them in the graph.
+  void buildGraph(llvm::ArrayRef<Operation *> ops);
+
+  /// Group the call_circuits at the same depth, in program order, up to
+  /// maxWidth qubits per group. Each other operation is a unit of its own.
+  void buildUnits(llvm::ArrayRef<Operation *> ops);
+
+  /// Sort the units topologically, keeping the program order where the
+  /// dependencies allow it.
+  std::vector<unsigned> sortUnits();
+
+  QubitFootprintAnalysis &footprints;
+  unsigned maxWidth;
+
+  llvm::DenseMap<Operation *, unsigned> indices;
+  std::vector<llvm::SmallVector<unsigned>> preds;
+  std::vector<unsigned> depths;
+
+  /// The operations of each unit in program order, and the unit of each
+  /// operation.
+  std::vector<llvm::SmallVector<unsigned>> units;
+  std::vector<unsigned> unitOf;
+};
+
+void SegmentPacker::buildGraph(llvm::ArrayRef<Operation *> ops) {
+  indices.clear();
+  preds.assign(ops.size(), {});
+  depths.assign(ops.size(), 0);
+
+  llvm::DenseMap<uint32_t, unsigned> lastOnQubit;
+  std::optional<unsigned> lastWithEffects;
+  for (auto [index, op] : llvm::enumerate(ops)) {
+    auto &opPreds = preds[index];
+    for (Value const operand : op->getOperands())
+      if (Operation *definingOp = operand.getDefiningOp()) {
+        auto it = indices.find(definingOp);
+        if (it != indices.end())
+          opPreds.push_back(it->second);
+      }
+
+    Ordering const ordering = getOrdering(op, footprints);
+    if (ordering == Ordering::Qubits) {
+      for (uint32_t const qubit : footprints.getOperatedQubits(op)) {
+        auto [it, inserted] = lastOnQubit.try_emplace(qubit, index);
+        if (!inserted) {
+          opPreds.push_back(it->second);
+          it->second = index;
+        }
+      }
+    } else if (ordering == Ordering::Effects) {
+      if (lastWithEffects)
+        opPreds.push_back(*lastWithEffects);
+      lastWithEffects = index;
+    }
+
+    for (unsigned const pred : opPreds)
+      depths[index] = std::max(depths[index], depths[pred] + 1);
+    indices[op] = index;
+  }
+}
+
+void SegmentPacker::buildUnits(llvm::ArrayRef<Operation *> ops) {
+  units.clear();
+  unitOf.assign(ops.size(), 0);
+
+  // the open group of each depth with its number of qubits
+  llvm::DenseMap<unsigned, std::pair<unsigned, size_t>> openGroups;
+  for (auto [index, op] : llvm::enumerate(ops)) {
+    if (!isa<CallCircuitOp>(op)) {
+      unitOf[index] = units.size();
+      units.push_back({static_cast<unsigned>(index)});
+      continue;
+    }
+
+    size_t const width = footprints.getOperatedQubits(op).size();
+    auto it = openGroups.find(depths[index]);
+    if (it != openGroups.end() &&
+        (maxWidth == 0 || it->second.second + width <= maxWidth)) {
+      unitOf[index] = it->second.first;
+      units[it->second.first].push_back(static_cast<unsigned>(index));
+      it->second.second += width;
+      continue;
+    }
+    unitOf[index] = units.size();
+    openGroups[depths[index]] = {units.size(), width};
+    units.push_back({static_cast<unsigned>(index)});
+  }
+}
+
+std::vector<unsigned> SegmentPacker::sortUnits() {
+  // The operations of a unit are at the same depth, so they do not depend on
+  // each other and the graph of the units has no cycles.
+  std::vector<llvm::SmallVector<unsigned>> succs(units.size());
+  std::vector<unsigned> numPreds(units.size(), 0);
+  for (auto [index, opPreds] : llvm::enumerate(preds))
+    for (unsigned const pred : opPreds)
+      if (unitOf[pred] != unitOf[index]) {
+        succs[unitOf[pred]].push_back(unitOf[index]);
+        ++numPreds[unitOf[index]];
+      }
+
+  // units are numbered in the program order of their first operation
+  std::priority_queue<unsigned, std::vector<unsigned>, std::greater<>> ready;
+  for (unsigned unit = 0; unit < units.size(); ++unit)
+    if (numPreds[unit] == 0)
+      ready.push(unit);
+
+  std::vector<unsigned> order;
+  order.reserve(units.size());
+  while (!ready.empty()) {
+    unsigned const unit = ready.top();
+    ready.pop();
+    order.push_back(unit);
+    for (unsigned const succ : succs[unit])
+      if (--numPreds[succ] == 0)
+        ready.push(succ);
+  }
+  assert(order.size() == units.size() && "the units must not have cycles");
+  return order;
+}
+
+void SegmentPacker::pack(
+    llvm::ArrayRef<Operation *> ops, Operation *before,
+    std::vector<llvm::SmallVector<CallCircuitOp>> &groups) {
+  if (llvm::count_if(ops, [](Operation *op) {
+        return isa<CallCircuitOp>(op);
+      }) < 2)
+    return;
+
+  buildGraph(ops);
+  buildUnits(ops);
+  if (units.size() == ops.size())
+    return;
+
+  Block *block = ops.front()->getBlock();
+  for (unsigned const unit : sortUnits()) {
+    if (units[unit].size() > 1) {
+      auto &group = groups.emplace_back();
+      for (unsigned const index : units[unit])
+        group.push_back(cast<CallCircuitOp>(ops[index]));
+    }
+    for (unsigned const index : units[unit]) {
+      if (before)
+        ops[index]->moveBefore(before);
+      else
+        ops[index]->moveBefore(block, block->end());
+    }
+  }
+  footprints.notifyOperationMoved(ops.front(), block);
+}
+
+} // anonymous namespace
+
+void PackCircuitsPass::runOnOperation() {
+  Operation *moduleOperation = getOperation();
+
+  llvm::StringMap<Operation *> circuitOpsMap;
+  moduleOperation->walk([&](CircuitOp circuitOp) {
+    circuitOpsMap[circuitOp.getSymName()] = circuitOp.getOperation();
+  });
+
+  auto &footprints = getAnalysis<QubitFootprintAnalysis>();
+  SegmentPacker packer(footprints, maxWidth);
+
+  std::vector<llvm::SmallVector<CallCircuitOp>> groups;
+  moduleOperation->walk([&](Block *block) {
+    llvm::SmallVector<Operation *> segment;
+    // the boundaries are collected first as the segments are reordered
+    llvm::SmallVector<Operation *> ops;
+    for (Operation &op : *block)
+      ops.push_back(&op);
+    for (Operation *op : ops) {
+      if (getOrdering(op, footprints) != Ordering::Boundary) {
+        segment.push_back(op);
+        continue;
+      }
+      packer.pack(segment, op, groups);
+      segment.clear();
+    }
+    packer.pack(segment, nullptr, groups);
+  });
+
+  IRRewriter rewriter(&getContext(), footprints.getListener());
+  for (auto &group : groups) {
+    MergeCircuitsPass::mergeCallCircuits(rewriter, group, &circuitOpsMap);
+    numCircuitsPacked += group.size() - 1;
+  }
+} // runOnOperation
+
+llvm::StringRef PackCircuitsPass::getArgument() const {
+  return "pack-circuits";
+}
+
+llvm::StringRef PackCircuitsPass::getDescription() const {
+  return "Pack the independent call_circuits on disjoint qubits into calls "
+         "of wider circuits";
+}
+
+llvm::StringRef PackCircuitsPass::getName() const {
+  return "Pack Circuits Pass";
+}
@@ -16,25 +16,35 @@
 
 #include "Dialect/QUIR/Transforms/Passes.h"
 #include "Dialect/OQ3/IR/OQ3Ops.h"
+#include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTestInterfaces.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
 #include "Dialect/QUIR/Transforms/AddShotLoop.h"
 #include "Dialect/QUIR/Transforms/AngleConversion.h"
 #include "Dialect/QUIR/Transforms/BreakReset.h"
+#include "Dialect/QUIR/Transforms/CacheFunctions.h"
 #include "Dialect/QUIR/Transforms/ConvertDurationUnits.h"
+#include "Dialect/QUIR/Transforms/DeduplicateCircuits.h"
+#include "Dialect/QUIR/Transforms/EliminateBarriers.h"
 #include "Dialect/QUIR/Transforms/FunctionArgumentSpecialization.h"
+#include "Dialect/QUIR/Transforms/FuseSingleQubitGates.h"
 #include "Dialect/QUIR/Transforms/LoadElimination.h"
 #include "Dialect/QUIR/Transforms/MergeCircuits.h"
 #include "Dialect/QUIR/Transforms/MergeMeasures.h"
 #include "Dialect/QUIR/Transforms/MergeParallelResets.h"
+#include "Dialect/QUIR/Transforms/PackCircuits.h"
+#include "Dialect/QUIR/Transforms/PipelineShotLoop.h"
+#include "Dialect/QUIR/Transforms/QUIRCircuitAnalysis.h"
 #include "Dialect/QUIR/Transforms/QuantumDecoration.h"
 #include "Dialect/QUIR/Transforms/RemoveQubitOperands.h"
+#include "Dialect/QUIR/Transforms/RemoveUnusedQubits.h"
 #include "Dialect/QUIR/Transforms/ReorderCircuits.h"
 #include "Dialect/QUIR/Transforms/ReorderMeasurements.h"
 #include "Dialect/QUIR/Transforms/SubroutineCloning.h"
 #include "Dialect/QUIR/Transforms/UnusedVariable.h"
 #include "Dialect/QUIR/Transforms/VariableElimination.h"
+#include "Dialect/QUIR/Utils/ClassicalOnlyAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -149,55 +159,24 @@ struct TestPrintNestingPass
 }; // end struct TestPrintNestingPass
 
 ///////////////// ClassicalOnlyDetectionPass functions /////////////////////
-// detects whether or not an operation contains quantum operations inside
-auto ClassicalOnlyDetectionPass::hasQuantumSubOps(Operation *inOp) -> bool {
-  bool retVal = true;
-  inOp->walk([&](Operation *op) {
-    if (dyn_cast<BuiltinCXOp>(op) || dyn_cast<Builtin_UOp>(op) ||
-        dyn_cast<CallDefCalGateOp>(op) || dyn_cast<CallDefcalMeasureOp>(op) ||
-        dyn_cast<DelayOp>(op) || dyn_cast<CallGateOp>(op) ||
-        dyn_cast<MeasureOp>(op) || dyn_cast<DeclareQubitOp>(op) ||
-        dyn_cast<ResetQubitOp>(op) || dyn_cast<CallCircuitOp>(op)) {
-      retVal = false;
-      return WalkResult::interrupt();
-    }
-    return WalkResult::advance();
-  });
-  return retVal;
-} // ClassicalOnlyDetectionPass::hasQuantumSubOps
-
 // Entry point for the ClassicalOnlyDetectionPass pass
 void ClassicalOnlyDetectionPass::runOnOperation() {
   // This pass is only called on the top-level module Op
   Operation *moduleOperation = getOperation();
   OpBuilder b(moduleOperation);
+  auto &classicalOnlyAnalysis = getAnalysis<ClassicalOnlyAnalysis>();
 
   moduleOperation->walk([&](Operation *op) {
-    if (dyn_cast<scf::IfOp>(op) || dyn_cast<scf::ForOp>(op) ||
-        dyn_cast<scf::WhileOp>(op) || dyn_cast<quir::SwitchOp>(op) ||
-        dyn_cast<quir::CircuitOp>(op))
+    if (isa<scf::IfOp, scf::ForOp, scf::WhileOp, quir::SwitchOp,
+            quir::CircuitOp, mlir::func::FuncOp>(op))
       op->setAttr(llvm::StringRef("quir.classicalOnly"),
-                  b.getBoolAttr(hasQuantumSubOps(op)));
-    if (auto funcOp = dyn_cast<mlir::func::FuncOp>(op)) {
-      // just check the arguments for qubitType values
-      FunctionType const fType = funcOp.getFunctionType();
-      bool const isMain =
-          SymbolRefAttr::get(funcOp).getLeafReference() == "main";
-      bool quantumOperands = false;
-      for (auto argType : fType.getInputs()) {
-        if (argType.isa<QubitType>()) {
-          quantumOperands = true;
-          break;
-        }
-      }
-      bool quantumDeclarations = false;
-      funcOp->walk([&](DeclareQubitOp op) { quantumDeclarations = true; });
-      funcOp->walk([&](CallCircuitOp op) { quantumDeclarations = true; });
-      op->setAttr(
-          llvm::StringRef("quir.classicalOnly"),
-          b.getBoolAttr(!quantumOperands && !quantumDeclarations && !isMain));
-    } // if funcOp
+                  b.getBoolAttr(classicalOnlyAnalysis.isClassicalOnly(op)));
   });
+
+  // only attributes were set
+  markAnalysesPreserved<ClassicalOnlyAnalysis,
+                        qcs::ParameterInitialValueAnalysis,
+                        QUIRCircuitAnalysis>();
 } // ClassicalOnlyDetectionPass::runOnOperation
 
 llvm::StringRef ClassicalOnlyDetectionPass::getArgument() const {
@@ -278,18 +257,25 @@ void registerQuirPasses() {
   //===----------------------------------------------------------------------===//
   PassRegistration<quir::TestPrintNestingPass>();
   PassRegistration<quir::FunctionArgumentSpecializationPass>();
+  PassRegistration<quir::FuseSingleQubitGatesPass>();
+  PassRegistration<quir::EliminateBarriersPass>();
   PassRegistration<quir::ClassicalOnlyDetectionPass>();
   PassRegistration<quir::BreakResetPass>();
+  PassRegistration<quir::CacheFunctionsPass>();
   PassRegistration<quir::MergeResetsLexicographicPass>();
   PassRegistration<quir::MergeResetsTopologicalPass>();
   PassRegistration<quir::SubroutineCloningPass>();
   PassRegistration<quir::RemoveQubitOperandsPass>();
+  PassRegistration<quir::RemoveUnusedQubitsPass>();
   PassRegistration<quir::UnusedVariablePass>();
   PassRegistration<quir::AddShotLoopPass>();
+  PassRegistration<quir::PipelineShotLoopPass>();
   PassRegistration<quir::QuantumDecorationPass>();
   PassRegistration<quir::ReorderMeasurementsPass>();
   PassRegistration<quir::ReorderCircuitsPass>();
   PassRegistration<quir::MergeCircuitsPass>();
+  PassRegistration<quir::PackCircuitsPass>();
+  PassRegistration<quir::DeduplicateCircuitsPass>();
   PassRegistration<quir::MergeMeasuresLexographicalPass>();
   PassRegistration<quir::MergeMeasuresTopologicalPass>();
   PassRegistration<quir::QUIRAngleConversionPass>();
@@ -0,0 +1,164 @@
+//===- PipelineShotLoop.cpp - Overlap shots with their tails ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the pass for overlapping the classical tail of each
+//  shot with the shot delay of the next one
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/PipelineShotLoop.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+#include "Dialect/QCS/Utils/ShotLoop.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <iterator>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+/// Whether op is a shot delay, i.e., a delay of all qubits.
+bool isShotDelay(Operation *op) {
+  if (auto delayOp = dyn_cast<DelayOp>(op))
+    return delayOp.getQubits().empty();
+  if (auto delayCyclesOp = dyn_cast<qcs::DelayCyclesOp>(op))
+    return delayCyclesOp.getQubits().empty();
+  return false;
+}
+
+/// Whether op or an op nested in it takes time on the target or operates on
+/// qubits, so that it may not run while a shot delay elapses. Calls are
+/// assumed to, as their callees may.
+bool isTimed(Operation *op) {
+  auto isQubit = [](Type type) { return type.isa<QubitType>(); };
+  auto result = op->walk([&](Operation *nestedOp) {
+    if (isQuantumOp(nestedOp) ||
+        isa<qcs::ShotInitOp, qcs::SynchronizeOp, CallOpInterface>(nestedOp) ||
+        llvm::any_of(nestedOp->getOperandTypes(), isQubit) ||
+        llvm::any_of(nestedOp->getResultTypes(), isQubit))
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+/// Whether value is the same for all the shots of shotLoop, i.e., it is
+/// defined outside of it or by a constant of its body.
+bool isShotInvariant(Value value, scf::ForOp shotLoop) {
+  if (!shotLoop.getRegion().isAncestor(value.getParentRegion()))
+    return true;
+  Operation *definingOp = value.getDefiningOp();
+  return definingOp && definingOp->getBlock() == shotLoop.getBody() &&
+         definingOp->hasTrait<OpTrait::ConstantLike>();
+}
+} // anonymous namespace
+
+bool PipelineShotLoopPass::pipelineShotLoop(scf::ForOp shotLoop) {
+  auto shotInit = qcs::getShotInit(shotLoop);
+  Block *body = shotLoop.getBody();
+  if (!shotInit || shotInit->getBlock() != body)
+    return false;
+
+  // the shot delays ahead of the shot body
+  SmallVector<Operation *> shotDelays;
+  for (Operation &op :
+       llvm::make_range(body->begin(), shotInit->getIterator())) {
+    if (!isShotDelay(&op))
+      continue;
+    if (!llvm::all_of(op.getOperands(), [&](Value operand) {
+          return isShotInvariant(operand, shotLoop);
+        }))
+      return false;
+    shotDelays.push_back(&op);
+  }
+  if (shotDelays.empty())
+    return false;
+
+  // the classical tail of the shot follows its last timed operation
+  Operation *lastTimedOp = shotInit;
+  for (Operation &op : llvm::make_range(std::next(shotInit->getIterator()),
+                                        body->getTerminator()->getIterator()))
+    if (isTimed(&op))
+      lastTimedOp = &op;
+  if (lastTimedOp->getNextNode() == body->getTerminator())
+    return false;
+
+  // the first shot is still delayed, ahead of the loop
+  OpBuilder builder(shotLoop);
+  IRMapping mapper;
+  for (auto *delayOp : shotDelays) {
+    for (auto operand : delayOp->getOperands()) {
+      Operation *definingOp = operand.getDefiningOp();
+      if (definingOp && definingOp->getBlock() == body &&
+          !mapper.contains(operand))
+        builder.clone(*definingOp, mapper);
+    }
+    builder.clone(*delayOp, mapper);
+  }
+
+  // the shot delays now delay the next shot, while the tail of the current
+  // one runs
+  Operation *insertionPoint = lastTimedOp;
+  for (auto *delayOp : shotDelays) {
+    delayOp->moveAfter(insertionPoint);
+    insertionPoint = delayOp;
+  }
+  return true;
+}
+
+// Entry point for the pass.
+void PipelineShotLoopPass::runOnOperation() {
+  SmallVector<scf::ForOp> shotLoops;
+  getOperation()->walk([&](scf::ForOp forOp) {
+    if (qcs::isShotLoop(forOp))
+      shotLoops.push_back(forOp);
+  });
+
+  for (auto shotLoop : shotLoops)
+    if (pipelineShotLoop(shotLoop))
+      ++numPipelinedLoops;
+} // runOnOperation
+
+llvm::StringRef PipelineShotLoopPass::getArgument() const {
+  return "pipeline-shot-loop";
+}
+llvm::StringRef PipelineShotLoopPass::getDescription() const {
+  return "Move the shot delays of shot loops after the last quantum operation "
+         "of their shots, so that the classical work ending a shot runs "
+         "while the delay before the next shot elapses";
+}
+
+llvm::StringRef PipelineShotLoopPass::getName() const {
+  return "Pipeline Shot Loop Pass";
+}
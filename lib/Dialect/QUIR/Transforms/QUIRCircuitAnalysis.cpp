@@ -26,6 +26,7 @@
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Pass/Pass.h"
@@ -35,9 +36,7 @@
 #include "llvm/Support/Error.h"
 
 #include <cassert>
-#include <map>
-#include <sys/types.h>
-#include <unordered_map>
+#include <optional>
 #include <utility>
 
 using namespace mlir;
@@ -77,9 +76,8 @@ angleValToDouble(mlir::Value inVal,
           argNum, mlir::quir::getAngleAttrName());
       return argAttr.getValue().convertToDouble();
     }
-    auto parentModuleOp = circuitOp->getParentOfType<mlir::ModuleOp>();
     return std::get<QUIRCircuitAnalysisEntry::ANGLE>(
-        circuitAnalysis->getAnalysisMap()[parentModuleOp][circuitOp][argNum]);
+        circuitAnalysis->getOperandAttributes(circuitOp, argNum));
   }
 
   if (auto castOp = inVal.getDefiningOp<mlir::oq3::CastOp>()) {
@@ -151,7 +149,6 @@ QUIRCircuitAnalysis::QUIRCircuitAnalysis(mlir::Operation *moduleOp,
 
   bool runGetAnalysis = true;
 
-  mlir::qcs::ParameterInitialValueAnalysis *nameAnalysis;
   auto topLevelModuleOp = moduleOp->getParentOfType<ModuleOp>();
   if (topLevelModuleOp) {
     auto nameAnalysisOptional =
@@ -166,59 +163,111 @@ QUIRCircuitAnalysis::QUIRCircuitAnalysis(mlir::Operation *moduleOp,
   if (runGetAnalysis)
     nameAnalysis = &am.getAnalysis<mlir::qcs::ParameterInitialValueAnalysis>();
 
-  std::unordered_map<mlir::Operation *, std::map<llvm::StringRef, Operation *>>
-      circuitOps;
+  // only record the last call to each circuit, the attributes of its
+  // operands are evaluated when queried
+  SymbolTableCollection symbolTables;
+  moduleOp->walk([&](CallCircuitOp callCircuitOp) {
+    auto circuitOp = symbolTables.lookupNearestSymbolFrom<CircuitOp>(
+        callCircuitOp, callCircuitOp.getCalleeAttr());
 
-  moduleOp->walk([&](CircuitOp circuitOp) {
-    circuitOps[circuitOp->getParentOfType<ModuleOp>()][circuitOp.getSymName()] =
-        circuitOp.getOperation();
+    if (!circuitOp) {
+      callCircuitOp->emitOpError("Could not find circuit.");
+      return;
+    }
+
+    circuits[circuitOp] = {callCircuitOp, std::nullopt};
   });
+  invalid_ = false;
+}
 
-  moduleOp->walk([&](CallCircuitOp callCircuitOp) {
-    auto search = circuitOps[callCircuitOp->getParentOfType<ModuleOp>()].find(
-        callCircuitOp.getCalleeAttr().getValue());
+void QUIRCircuitAnalysis::updateCall(CallCircuitOp callCircuitOp) {
+  auto circuitOp = SymbolTable::lookupNearestSymbolFrom<CircuitOp>(
+      callCircuitOp, callCircuitOp.getCalleeAttr());
+  if (circuitOp)
+    circuits[circuitOp] = {callCircuitOp, std::nullopt};
+}
 
-    if (search ==
-        circuitOps[callCircuitOp->getParentOfType<ModuleOp>()].end()) {
-      callCircuitOp->emitOpError("Could not find circuit.");
+void QUIRCircuitAnalysis::invalidateCircuit(CircuitOp circuitOp) {
+  auto search = circuits.find(circuitOp);
+  if (search != circuits.end())
+    search->second.operandsBegin = std::nullopt;
+}
+
+void QUIRCircuitAnalysis::eraseNested(Operation *op) {
+  if (circuits.empty())
+    return;
+  op->walk([&](Operation *nestedOp) {
+    if (isa<CircuitOp>(nestedOp)) {
+      circuits.erase(nestedOp);
       return;
     }
+    auto callCircuitOp = dyn_cast<CallCircuitOp>(nestedOp);
+    if (!callCircuitOp)
+      return;
+    auto circuitOp = SymbolTable::lookupNearestSymbolFrom<CircuitOp>(
+        callCircuitOp, callCircuitOp.getCalleeAttr());
+    auto search = circuits.find(circuitOp);
+    if (search != circuits.end() &&
+        search->second.callCircuitOp == callCircuitOp)
+      circuits.erase(search);
+  });
+}
 
-    auto circuitOp = dyn_cast<CircuitOp>(search->second);
-    auto parentModuleOp = circuitOp->getParentOfType<ModuleOp>();
+void QUIRCircuitAnalysis::Listener::notifyOperationInserted(Operation *op) {
+  if (auto callCircuitOp = dyn_cast<CallCircuitOp>(op))
+    analysis.updateCall(callCircuitOp);
+}
 
-    for (uint ii = 0; ii < callCircuitOp.getOperands().size(); ++ii) {
+void QUIRCircuitAnalysis::Listener::notifyOperationRemoved(Operation *op) {
+  analysis.eraseNested(op);
+}
 
-      double value = 0;
-      llvm::StringRef parameterName = {};
-      quir::DurationAttr duration;
+OperandAttributes
+QUIRCircuitAnalysis::getOperandAttributes(CircuitOp circuitOp,
+                                          unsigned argNum) {
+
+  auto search = circuits.find(circuitOp);
+  if (search == circuits.end())
+    return {};
+  auto &entry = search->second;
+  auto callCircuitOp = cast<CallCircuitOp>(entry.callCircuitOp);
+  if (argNum >= callCircuitOp->getNumOperands())
+    return {};
+
+  if (!entry.operandsBegin) {
+    entry.operandsBegin = operandAttributes.size();
+    operandAttributes.resize(operandAttributes.size() +
+                             callCircuitOp->getNumOperands());
+  }
 
-      auto operand = callCircuitOp.getOperands()[ii];
+  auto &attributes = operandAttributes[*entry.operandsBegin + argNum];
+  if (attributes)
+    return *attributes;
 
-      // cache angle values and parameter names
-      if (auto angType = operand.getType().dyn_cast<quir::AngleType>()) {
+  double value = 0;
+  llvm::StringRef parameterName = {};
+  quir::DurationAttr duration;
 
-        value = getAngleValue(operand, nameAnalysis);
-        parameterName = getParameterName(operand);
-        circuitOperands[parentModuleOp][circuitOp][ii] = {value, parameterName,
-                                                          duration};
-      }
+  auto operand = callCircuitOp->getOperand(argNum);
 
-      // cache durations
-      if (auto durType = operand.getType().dyn_cast<quir::DurationType>()) {
+  // cache angle values and parameter names
+  if (operand.getType().isa<quir::AngleType>()) {
+    value = getAngleValue(operand, nameAnalysis);
+    parameterName = getParameterName(operand);
+  }
 
-        duration = getDuration(operand);
-        circuitOperands[parentModuleOp][circuitOp][ii] = {value, parameterName,
-                                                          duration};
-      }
-    }
-  });
-  invalid_ = false;
+  // cache durations
+  if (operand.getType().isa<quir::DurationType>())
+    duration = getDuration(operand);
+
+  attributes = OperandAttributes{value, parameterName, duration};
+  return *attributes;
 }
 
 void QUIRCircuitAnalysisPass::runOnOperation() {
   mlir::Pass::getAnalysis<QUIRCircuitAnalysis>();
-} // ParameterInitialValueAnalysisPass::runOnOperation()
+  markAllAnalysesPreserved();
+} // QUIRCircuitAnalysisPass::runOnOperation()
 
 llvm::StringRef QUIRCircuitAnalysisPass::getArgument() const {
   return "quir-circuit-analysis";
@@ -21,151 +21,154 @@
 
 #include "Dialect/QUIR/Transforms/QuantumDecoration.h"
 
+#include "Dialect/QCS/Utils/ParameterInitialValueAnalysis.h"
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Transforms/QUIRCircuitAnalysis.h"
+#include "Dialect/QUIR/Utils/OpDispatch.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Block.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Region.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
 #include "llvm/ADT/StringRef.h"
 
-#include <algorithm>
-#include <unordered_set>
+#include <cstdint>
 #include <vector>
 
 using namespace mlir;
 using namespace mlir::quir;
 
-namespace {
-int lookupOrMinus1(Value arg) {
-  auto id = lookupQubitId(arg);
+void QuantumDecorationPass::QubitFootprint::insert(Value qubit) {
+  auto id = lookupQubitId(qubit);
   if (id)
-    return static_cast<int>(*id);
-  return -1;
+    ids.insert(static_cast<uint32_t>(*id));
+  else
+    unresolved = true;
 }
-} // end anonymous namespace
 
 void QuantumDecorationPass::processOp(Operation *op,
-                                      std::unordered_set<int> &retSet) {
-  if (auto castOp = dyn_cast<BuiltinCXOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<Builtin_UOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<CallDefCalGateOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<CallGateOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<BarrierOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<MeasureOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<CallDefcalMeasureOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<DelayOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<ResetQubitOp>(op))
-    processOp(castOp, retSet);
-  else if (auto castOp = dyn_cast<CallCircuitOp>(op))
-    processOp(castOp, retSet);
+                                      QubitFootprint &footprint) {
+  using Dispatcher =
+      OpDispatcher<BuiltinCXOp, Builtin_UOp, CallDefCalGateOp, CallGateOp,
+                   BarrierOp, MeasureOp, CallDefcalMeasureOp, DelayOp,
+                   ResetQubitOp, CallCircuitOp>;
+  Dispatcher::get().dispatch(
+      op, [&](auto castOp) { processOp(castOp, footprint); });
 } // processOp Operation *
 
 void QuantumDecorationPass::processOp(Builtin_UOp builtinUOp,
-                                      std::unordered_set<int> &retSet) {
-  retSet.emplace(lookupOrMinus1(builtinUOp.getTarget()));
+                                      QubitFootprint &footprint) {
+  footprint.insert(builtinUOp.getTarget());
 } // processOp Builtin_UOp
 
 void QuantumDecorationPass::processOp(BuiltinCXOp builtinCXOp,
-                                      std::unordered_set<int> &retSet) {
-  retSet.emplace(lookupOrMinus1(builtinCXOp.getControl()));
-  retSet.emplace(lookupOrMinus1(builtinCXOp.getTarget()));
+                                      QubitFootprint &footprint) {
+  footprint.insert(builtinCXOp.getControl());
+  footprint.insert(builtinCXOp.getTarget());
 } // processOp BuiltinCXOp
 
 void QuantumDecorationPass::processOp(MeasureOp measureOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   for (auto qubit : measureOp.getQubits())
-    retSet.emplace(lookupOrMinus1(qubit));
+    footprint.insert(qubit);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(CallDefcalMeasureOp measureOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(measureOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    footprint.insert(val);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(DelayOp delayOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   for (auto qubit_operand : delayOp.getQubits())
-    retSet.emplace(lookupOrMinus1(qubit_operand));
+    footprint.insert(qubit_operand);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(ResetQubitOp resetOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   for (auto qubit : resetOp.getQubits())
-    retSet.emplace(lookupOrMinus1(qubit));
+    footprint.insert(qubit);
 } // processOp MeasureOp
 
 void QuantumDecorationPass::processOp(CallDefCalGateOp callOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(callOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    footprint.insert(val);
 } // processOp CallGateOp
 
 void QuantumDecorationPass::processOp(CallGateOp callOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(callOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    footprint.insert(val);
 } // processOp CallGateOp
 
 void QuantumDecorationPass::processOp(BarrierOp barrierOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(barrierOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    footprint.insert(val);
 } // processOp BarrierOp
 
 void QuantumDecorationPass::processOp(CallCircuitOp callOp,
-                                      std::unordered_set<int> &retSet) {
+                                      QubitFootprint &footprint) {
   std::vector<Value> qubitOperands;
   qubitCallOperands(callOp, qubitOperands);
 
   for (Value const &val : qubitOperands)
-    retSet.emplace(lookupOrMinus1(val));
+    footprint.insert(val);
 } // processOp CallGateOp
 
+QuantumDecorationPass::QubitFootprint
+QuantumDecorationPass::decorate(Operation *op, OpBuilder &build) {
+  QubitFootprint footprint;
+  processOp(op, footprint);
+  for (Region &region : op->getRegions())
+    for (Block &block : region)
+      for (Operation &nestedOp : block)
+        footprint |= decorate(&nestedOp, build);
+
+  if (isa<scf::IfOp, scf::ForOp, quir::SwitchOp, quir::CircuitOp>(op)) {
+    // the ids iterate in ascending order, after the unresolved -1
+    std::vector<int> qubitVec;
+    qubitVec.reserve(footprint.ids.size() + 1);
+    if (footprint.unresolved)
+      qubitVec.push_back(-1);
+    for (uint32_t const id : footprint.ids)
+      qubitVec.push_back(static_cast<int>(id));
+    op->setAttr(mlir::quir::getPhysicalIdsAttrName(),
+                build.getI32ArrayAttr(ArrayRef<int>(qubitVec)));
+  }
+  return footprint;
+} // decorate
+
 void QuantumDecorationPass::runOnOperation() {
   ModuleOp const moduleOp = getOperation();
   OpBuilder build(moduleOp);
 
-  moduleOp->walk([&](Operation *op) {
-    if (dyn_cast<scf::IfOp>(op) || dyn_cast<scf::ForOp>(op) ||
-        dyn_cast<quir::SwitchOp>(op) || dyn_cast<quir::CircuitOp>(op)) {
-      std::unordered_set<int> involvedQubits;
-      op->walk([&](Operation *subOp) { processOp(subOp, involvedQubits); });
-      std::vector<int> qubitVec;
-      qubitVec.reserve(involvedQubits.size());
-      qubitVec.insert(qubitVec.begin(), involvedQubits.begin(),
-                      involvedQubits.end());
-      std::sort(qubitVec.begin(), qubitVec.end());
-      op->setAttr(mlir::quir::getPhysicalIdsAttrName(),
-                  build.getI32ArrayAttr(ArrayRef<int>(qubitVec)));
-    }
-  });
+  decorate(moduleOp, build);
 
+  // only attributes were set
+  markAnalysesPreserved<qcs::ParameterInitialValueAnalysis,
+                        QUIRCircuitAnalysis>();
 } // runOnOperation
 
 llvm::StringRef QuantumDecorationPass::getArgument() const {
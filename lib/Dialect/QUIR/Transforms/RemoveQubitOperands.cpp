@@ -25,6 +25,7 @@
 #include "Dialect/QUIR/IR/QUIRAttributes.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -100,59 +101,71 @@ void RemoveQubitOperandsPass::addQubitDeclarations(mlir::func::FuncOp funcOp) {
   }
 } // addQubitDeclarations
 
-void RemoveQubitOperandsPass::processCallOp(Operation *op) {
-  auto callOp = dyn_cast<CallSubroutineOp>(op);
-  llvm::BitVector qIndicesBV(callOp->getNumOperands());
-
-  qubitArgIndices(callOp, qIndicesBV);
-
-  // look for func def match
-  Operation *findOp =
-      SymbolTable::lookupSymbolIn(moduleOperation, callOp.getCallee());
-  auto funcOp = dyn_cast<mlir::func::FuncOp>(findOp);
-
-  if (!qIndicesBV.empty()) // some qubit args
-    callOp->eraseOperands(qIndicesBV);
-
-  if (alreadyProcessed.count(findOp))
+void RemoveQubitOperandsPass::enqueueCallees(Operation *op) {
+  op->walk([&](CallSubroutineOp callOp) {
+    Operation *findOp =
+        symbolIndex->lookupSymbolIn(moduleOperation, callOp.getCallee());
+    if (findOp && alreadyProcessed.insert(findOp).second)
+      funcWorkList.push_back(findOp);
+  });
+} // enqueueCallees
+
+void RemoveQubitOperandsPass::processFuncOp(Operation *op,
+                                            SymbolUserMap &symbolUsers) {
+  auto funcOp = dyn_cast<mlir::func::FuncOp>(op);
+  if (!funcOp || funcOp.isExternal())
     return;
 
-  alreadyProcessed.emplace(findOp);
+  llvm::BitVector qIndicesBV(funcOp.getNumArguments());
+  for (auto arg : funcOp.getArguments())
+    if (arg.getType().isa<QubitType>())
+      qIndicesBV.set(arg.getArgNumber());
 
-  if (qIndicesBV.empty()) // no qubit args
-    return;
+  if (qIndicesBV.any()) {
+    addQubitDeclarations(funcOp);
+    funcOp.eraseArguments(qIndicesBV);
 
-  addQubitDeclarations(funcOp);
-
-  if (qIndicesBV.size() < funcOp.getNumArguments())
-    qIndicesBV.resize(funcOp.getNumArguments());
-  funcOp.eraseArguments(qIndicesBV);
+    // update all of the callers along with the signature, whether or not
+    // they are reachable from main, so that they remain valid
+    for (Operation *userOp : symbolUsers.getUsers(funcOp))
+      if (auto callOp = dyn_cast<CallSubroutineOp>(userOp))
+        callOp->eraseOperands(qIndicesBV);
+  }
 
-  findOp->walk([&](CallSubroutineOp op) { callWorkList.push_back(op); });
-} // processCallOp
+  enqueueCallees(funcOp);
+} // processFuncOp
 
 // Entry point for the pass.
 void RemoveQubitOperandsPass::runOnOperation() {
   moduleOperation = getOperation();
-  Operation *mainFunc = getMainFunction(moduleOperation);
-  callWorkList.clear();
+  symbolIndex = &getAnalysis<SymbolIndexAnalysis>();
+  Operation *mainFunc = symbolIndex->getMainFunction();
+  funcWorkList.clear();
+  alreadyProcessed.clear();
 
   if (!mainFunc) {
     llvm::errs() << "No main function found, cannot remove qubit arguments!\n";
     return signalPassFailure();
   }
 
-  mainFunc->walk([&](CallSubroutineOp op) { callWorkList.push_back(op); });
+  // resolve the callers of all of the subroutines in a single walk of the
+  // module, rather than looking up the callee of each call
+  SymbolUserMap symbolUsers(symbolIndex->getSymbolTables(), moduleOperation);
 
-  while (!callWorkList.empty()) {
-    Operation *op = callWorkList.front();
-    callWorkList.pop_front();
-    processCallOp(op);
+  enqueueCallees(mainFunc);
+
+  while (!funcWorkList.empty()) {
+    Operation *op = funcWorkList.front();
+    funcWorkList.pop_front();
+    processFuncOp(op, symbolUsers);
   }
 
   // All subroutine defs that have been cloned are no longer needed
   for (Operation *op : clonedFuncs)
-    op->erase();
+    symbolIndex->getSymbolTable(moduleOperation).erase(op);
+
+  // only the signatures of subroutines have changed
+  markAnalysesPreserved<SymbolIndexAnalysis>();
 
 } // runOnOperation
 
@@ -0,0 +1,117 @@
+//===- RemoveUnusedQubits.cpp - Remove unused qubits ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass for removing the declarations of unused
+///  qubits and, optionally, the operations on otherwise idle qubits.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Transforms/RemoveUnusedQubits.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <map>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+namespace {
+/// Whether an operation only keeps an otherwise idle qubit busy.
+bool isIdleOperation(Operation *op) {
+  return isa<ResetQubitOp, DelayOp, BarrierOp>(op);
+}
+
+/// Remove qubit from the operands of an idle operation, erasing the operation
+/// if no qubit is left, as the operation would apply to all qubits otherwise.
+/// Returns whether the operation was erased.
+bool removeQubitOperand(Operation *op, Value qubit) {
+  llvm::BitVector erased(op->getNumOperands());
+  for (auto &operand : op->getOpOperands())
+    if (operand.get() == qubit)
+      erased.set(operand.getOperandNumber());
+  op->eraseOperands(erased);
+
+  if (llvm::any_of(op->getOperandTypes(),
+                   [](Type type) { return type.isa<QubitType>(); }))
+    return false;
+  op->erase();
+  return true;
+}
+} // anonymous namespace
+
+void RemoveUnusedQubitsPass::runOnOperation() {
+  // the declarations of each physical qubit, and of each qubit without an id
+  // separately
+  std::map<uint32_t, SmallVector<DeclareQubitOp>> physicalQubits;
+  SmallVector<SmallVector<DeclareQubitOp>> otherQubits;
+  getOperation()->walk([&](DeclareQubitOp declOp) {
+    if (auto id = declOp.getId())
+      physicalQubits[*id].push_back(declOp);
+    else
+      otherQubits.push_back({declOp});
+  });
+
+  auto isUsed = [&](DeclareQubitOp declOp) {
+    return llvm::any_of(declOp->getUsers(), [&](Operation *user) {
+      return !removeIdleOperations || !isIdleOperation(user);
+    });
+  };
+  auto removeUnused = [&](ArrayRef<DeclareQubitOp> declOps) {
+    if (llvm::any_of(declOps, isUsed))
+      return;
+    for (auto declOp : declOps) {
+      // an operation may use the qubit more than once
+      llvm::SmallSetVector<Operation *, 4> const users(declOp->user_begin(),
+                                                       declOp->user_end());
+      for (auto *user : users)
+        if (removeQubitOperand(user, declOp.getRes()))
+          ++numOperationsRemoved;
+      declOp->erase();
+    }
+    ++numQubitsRemoved;
+  };
+
+  for (auto &[id, declOps] : physicalQubits)
+    removeUnused(declOps);
+  for (auto &declOps : otherQubits)
+    removeUnused(declOps);
+} // RemoveUnusedQubitsPass::runOnOperation
+
+llvm::StringRef RemoveUnusedQubitsPass::getArgument() const {
+  return "remove-unused-qubits";
+}
+
+llvm::StringRef RemoveUnusedQubitsPass::getDescription() const {
+  return "Remove the declarations of unused qubits and, optionally, the "
+         "resets, delays and barriers of otherwise idle qubits";
+}
+
+llvm::StringRef RemoveUnusedQubitsPass::getName() const {
+  return "Remove Unused Qubits Pass";
+}
@@ -15,29 +15,45 @@
 //===----------------------------------------------------------------------===//
 ///
 ///  This file implements the pass for moving call_circuits as late as possible
+///  and for list scheduling the call_circuits and measurements of a block
 ///
 //===----------------------------------------------------------------------===//
 
 #include "Dialect/QUIR/Transforms/ReorderCircuits.h"
 
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include <set>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <queue>
 #include <sys/types.h>
 #include <utility>
+#include <vector>
 
 #define DEBUG_TYPE "QUIRReorderMeasurements"
 
@@ -58,7 +74,7 @@ struct ReorderCircuitsAndNonCircuitPat
                                 PatternRewriter &rewriter) const override {
 
     // Accumulate qubits in measurement set
-    std::set<uint> const currQubits = callCircuitOp.getOperatedQubits();
+    QubitSet const currQubits = callCircuitOp.getOperatedQubits();
     LLVM_DEBUG(llvm::dbgs() << "Matching on call_circuit for qubits:\t");
     LLVM_DEBUG(for (const uint id : currQubits) llvm::dbgs() << id << " ");
     LLVM_DEBUG(llvm::dbgs() << "\n");
@@ -79,14 +95,229 @@ struct ReorderCircuitsAndNonCircuitPat
     return failure();
   } // matchAndRewrite
 };  // struct ReorderCircuitsAndNonCircuitPat
+
+// Schedules the operations of a block from their dependence DAG, each as
+// soon as the operations it depends on have completed. Operations on the
+// same qubits keep their order, as do the classical operations with memory
+// effects which conflict, while operations which are not known to commute
+// with the others, e.g., calls and control flow, order all around them.
+class CircuitListScheduler {
+public:
+  /// Reorder the operations of block, other than its terminator.
+  /// @return Whether the order changed.
+  bool schedule(Block &block);
+
+private:
+  enum class Kind { Pure, Quantum, Reader, Writer, Barrier };
+
+  Kind classify(Operation *op, QubitSet &qubits);
+  /// The duration of a quantum operation, the pulse.duration of the call or
+  /// its callee for call_circuits where they have one and 1 otherwise.
+  uint64_t getDuration(Operation *op);
+
+  SymbolTableCollection symbolTables;
+  // the durations of the callees of call_circuits
+  llvm::DenseMap<Attribute, uint64_t> circuitDurations;
+}; // class CircuitListScheduler
+
+CircuitListScheduler::Kind CircuitListScheduler::classify(Operation *op,
+                                                          QubitSet &qubits) {
+  if (isMemoryEffectFree(op))
+    return Kind::Pure;
+  if (op->getNumRegions() == 0) {
+    if (auto qubitOp = dyn_cast<QubitOpInterface>(op)) {
+      qubits = qubitOp.getOperatedQubits();
+      return qubits.empty() ? Kind::Barrier : Kind::Quantum;
+    }
+    if (auto effectOp = dyn_cast<MemoryEffectOpInterface>(op)) {
+      // e.g., quir.declare_qubit, which does not interfere with others
+      if (effectOp.onlyHasEffect<MemoryEffects::Free>())
+        return Kind::Pure;
+      return effectOp.onlyHasEffect<MemoryEffects::Read>() ? Kind::Reader
+                                                           : Kind::Writer;
+    }
+  }
+  return Kind::Barrier;
+}
+
+uint64_t CircuitListScheduler::getDuration(Operation *op) {
+  auto callCircuitOp = dyn_cast<CallCircuitOp>(op);
+  if (!callCircuitOp)
+    return 1;
+  if (auto duration = op->getAttrOfType<IntegerAttr>("pulse.duration"))
+    return duration.getInt();
+
+  auto [duration, inserted] =
+      circuitDurations.try_emplace(callCircuitOp.getCalleeAttr(), 1);
+  if (inserted) {
+    auto circuitOp = symbolTables.lookupNearestSymbolFrom<CircuitOp>(
+        op, callCircuitOp.getCalleeAttr());
+    if (circuitOp)
+      if (auto attr = circuitOp->getAttrOfType<IntegerAttr>("pulse.duration"))
+        duration->second = attr.getInt();
+  }
+  return duration->second;
+}
+
+bool CircuitListScheduler::schedule(Block &block) {
+  llvm::SmallVector<Operation *> ops;
+  for (auto &op : block)
+    if (!op.hasTrait<OpTrait::IsTerminator>())
+      ops.push_back(&op);
+  size_t const numOps = ops.size();
+  if (numOps < 2)
+    return false;
+
+  llvm::DenseMap<Operation *, unsigned> indices;
+  for (auto [index, op] : llvm::enumerate(ops))
+    indices[op] = index;
+
+  // the edges of the DAG, which lead from earlier to later operations
+  std::vector<llvm::SmallVector<unsigned, 4>> successors(numOps);
+  std::vector<unsigned> numPredecessors(numOps, 0);
+  auto addEdge = [&](unsigned from, unsigned to) {
+    if (from == to)
+      return;
+    successors[from].push_back(to);
+    ++numPredecessors[to];
+  };
+
+  std::vector<uint64_t> durations(numOps, 0);
+  // the last operations of each kind, so that each operation only depends
+  // on the operations it must follow directly
+  std::optional<unsigned> lastBarrier;
+  std::optional<unsigned> lastWriter;
+  llvm::SmallVector<unsigned> readers;
+  llvm::SmallVector<unsigned> sinceBarrier;
+  llvm::DenseMap<uint32_t, unsigned> lastOnQubit;
+
+  for (auto [index, op] : llvm::enumerate(ops)) {
+    op->walk([&, index = index](Operation *nestedOp) {
+      for (Value operand : nestedOp->getOperands()) {
+        Operation *defOp = operand.getDefiningOp();
+        if (!defOp)
+          continue;
+        if (auto *ancestor = block.findAncestorOpInBlock(*defOp)) {
+          auto pos = indices.find(ancestor);
+          if (pos != indices.end())
+            addEdge(pos->second, index);
+        }
+      }
+    });
+
+    QubitSet qubits;
+    auto const kind = classify(op, qubits);
+    if (kind != Kind::Pure && kind != Kind::Barrier) {
+      if (lastBarrier)
+        addEdge(*lastBarrier, index);
+      sinceBarrier.push_back(index);
+    }
+
+    switch (kind) {
+    case Kind::Pure:
+      break;
+    case Kind::Quantum:
+      durations[index] = getDuration(op);
+      for (uint32_t const qubit : qubits) {
+        auto [last, inserted] = lastOnQubit.try_emplace(qubit, index);
+        if (!inserted) {
+          addEdge(last->second, index);
+          last->second = index;
+        }
+      }
+      break;
+    case Kind::Reader:
+      if (lastWriter)
+        addEdge(*lastWriter, index);
+      readers.push_back(index);
+      break;
+    case Kind::Writer:
+      if (lastWriter)
+        addEdge(*lastWriter, index);
+      for (unsigned const reader : readers)
+        addEdge(reader, index);
+      readers.clear();
+      lastWriter = index;
+      break;
+    case Kind::Barrier:
+      if (lastBarrier)
+        addEdge(*lastBarrier, index);
+      for (unsigned const previous : sinceBarrier)
+        addEdge(previous, index);
+      sinceBarrier.clear();
+      readers.clear();
+      lastOnQubit.clear();
+      lastWriter.reset();
+      lastBarrier = index;
+      break;
+    }
+  }
+
+  // the duration of the longest path from each operation to the end of the
+  // block, which the operations on the critical path are scheduled by first
+  std::vector<uint64_t> priorities(numOps, 0);
+  for (size_t index = numOps; index-- > 0;) {
+    uint64_t longest = 0;
+    for (unsigned const successor : successors[index])
+      longest = std::max(longest, priorities[successor]);
+    priorities[index] = durations[index] + longest;
+  }
+
+  // Schedule the ready operation which starts first, classical operations
+  // ahead of the quantum operations starting at the same time so that those
+  // are adjacent, quantum operations by priority and otherwise in the
+  // original order.
+  std::vector<uint64_t> starts(numOps, 0);
+  auto after = [&](unsigned lhs, unsigned rhs) {
+    if (starts[lhs] != starts[rhs])
+      return starts[lhs] > starts[rhs];
+    bool const lhsClassical = durations[lhs] == 0;
+    if (lhsClassical != (durations[rhs] == 0))
+      return !lhsClassical;
+    if (!lhsClassical && priorities[lhs] != priorities[rhs])
+      return priorities[lhs] < priorities[rhs];
+    return lhs > rhs;
+  };
+  std::priority_queue<unsigned, std::vector<unsigned>, decltype(after)> ready(
+      after);
+  for (size_t index = 0; index < numOps; ++index)
+    if (numPredecessors[index] == 0)
+      ready.push(index);
+
+  llvm::SmallVector<unsigned> order;
+  order.reserve(numOps);
+  while (!ready.empty()) {
+    unsigned const index = ready.top();
+    ready.pop();
+    order.push_back(index);
+    uint64_t const end = starts[index] + durations[index];
+    for (unsigned const successor : successors[index]) {
+      starts[successor] = std::max(starts[successor], end);
+      if (--numPredecessors[successor] == 0)
+        ready.push(successor);
+    }
+  }
+  assert(order.size() == numOps && "expect the dependences to be acyclic");
+
+  bool changed = false;
+  for (auto [position, index] : llvm::enumerate(order))
+    changed |= position != index;
+  if (!changed)
+    return false;
+
+  // move the operations into their new order in one pass over the block
+  auto insertPoint = block.end();
+  if (!block.empty() && block.back().hasTrait<OpTrait::IsTerminator>())
+    insertPoint = block.back().getIterator();
+  for (unsigned const index : order)
+    ops[index]->moveBefore(&block, insertPoint);
+  return true;
+}
 } // anonymous namespace
 
 void ReorderCircuitsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
-  RewritePatternSet patterns(&getContext());
-  patterns.add<ReorderCircuitsAndNonCircuitPat>(&getContext());
-
   mlir::func::FuncOp mainFunc =
       dyn_cast<mlir::func::FuncOp>(getMainFunction(moduleOperation));
 
@@ -96,6 +327,22 @@ void ReorderCircuitsPass::runOnOperation() {
     return;
   }
 
+  if (listSchedule) {
+    // each block of the main function is scheduled once, after its nested
+    // blocks
+    CircuitListScheduler scheduler;
+    mainFunc->walk([&](Block *block) {
+      if (scheduler.schedule(*block))
+        LLVM_DEBUG(llvm::dbgs() << "Rescheduled a block of "
+                                << block->getOperations().size()
+                                << " operations\n");
+    });
+    return;
+  }
+
+  RewritePatternSet patterns(&getContext());
+  patterns.add<ReorderCircuitsAndNonCircuitPat>(&getContext());
+
   // only run this pass on call_circuits within the main body of the program
   // there may be call_circuits within circuits that have not been properly
   // labeled with their qubit arguments
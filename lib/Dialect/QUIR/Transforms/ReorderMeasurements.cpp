@@ -24,6 +24,8 @@
 #include "Dialect/QUIR/IR/QUIRInterfaces.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/QubitFootprintAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/IR/PatternMatch.h"
@@ -34,13 +36,15 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 
 #include <iterator>
-#include <set>
 #include <sys/types.h>
 #include <utility>
-#include <vector>
 
 #define DEBUG_TYPE "QUIRReorderMeasurements"
 
@@ -49,64 +53,118 @@ using namespace mlir::quir;
 
 namespace {
 
-using MoveListVec = std::vector<Operation *>;
-
-bool mayMoveVariableLoadOp(MeasureOp measureOp,
-                           oq3::VariableLoadOp variableLoadOp,
-                           MoveListVec &moveList);
-bool mayMoveCastOp(MeasureOp measureOp, oq3::CastOp castOp,
-                   MoveListVec &moveList);
-
-bool mayMoveVariableLoadOp(MeasureOp measureOp,
-                           oq3::VariableLoadOp variableLoadOp,
-                           MoveListVec &moveList) {
-  // find corresponding variable assign
-  // move variableLoad if the assign is before the measure
-  bool moveVariableLoadOp = true;
-  auto *currentBlock = variableLoadOp->getBlock();
-  currentBlock->walk([&](oq3::VariableAssignOp assignOp) {
-    if (assignOp.getVariableName() == variableLoadOp.getVariableName()) {
-      moveVariableLoadOp = assignOp->isBeforeInBlock(measureOp);
-      if (!moveVariableLoadOp) {
-        auto assignCastOp =
-            dyn_cast<oq3::CastOp>(assignOp.getAssignedValue().getDefiningOp());
-        if (assignCastOp)
-          moveVariableLoadOp = mayMoveCastOp(measureOp, assignCastOp, moveList);
-      }
-      return WalkResult::interrupt();
-    }
-    return WalkResult::advance();
+using MoveListVec = llvm::SmallVector<Operation *>;
+
+/// Collects the chains of variable loads and casts which the operands of the
+/// ops following a measurement are defined by and which may be hoisted above
+/// the measurement, i.e., the chains which do not depend on the result of the
+/// measurement. The first assignment of each variable in a block is cached,
+/// and thus shared across the applications of the pattern, as the pass
+/// neither moves nor erases assignments.
+class HoistableDefinitions {
+public:
+  /// Collect the chain of defOp into moveList, in program order.
+  /// @return false if the chain may not be hoisted above measureOp.
+  bool collect(MeasureOp measureOp, Operation *defOp, MoveListVec &moveList);
+
+private:
+  /// The first assignment of the variable of loadOp nested in block, or null
+  /// if there is none.
+  Operation *getFirstAssign(Block *block, oq3::VariableLoadOp loadOp);
+
+  llvm::DenseMap<std::pair<Block *, StringAttr>, Operation *> firstAssigns;
+};
+
+Operation *HoistableDefinitions::getFirstAssign(Block *block,
+                                                oq3::VariableLoadOp loadOp) {
+  auto name = loadOp.getVariableNameAttr().getAttr();
+  auto [it, inserted] = firstAssigns.try_emplace({block, name}, nullptr);
+  if (!inserted)
+    return it->second;
+
+  block->walk([&](oq3::VariableAssignOp assignOp) {
+    if (assignOp.getVariableNameAttr().getAttr() != name)
+      return WalkResult::advance();
+    it->second = assignOp;
+    return WalkResult::interrupt();
   });
-  if (moveVariableLoadOp)
-    moveList.push_back(variableLoadOp);
-  return moveVariableLoadOp;
+  return it->second;
 }
 
-bool mayMoveCastOp(MeasureOp measureOp, oq3::CastOp castOp,
-                   MoveListVec &moveList) {
-  bool moveCastOp = false;
-  auto variableLoadOp =
-      dyn_cast<oq3::VariableLoadOp>(castOp.getArg().getDefiningOp());
-  if (variableLoadOp)
-    moveCastOp = mayMoveVariableLoadOp(measureOp, variableLoadOp, moveList);
-  auto castMeasureOp = dyn_cast<MeasureOp>(castOp.getArg().getDefiningOp());
-  if (castMeasureOp)
-    moveCastOp = ((castMeasureOp != measureOp) &&
-                  (castMeasureOp->isBeforeInBlock(measureOp) ||
-                   castMeasureOp->getBlock() != castOp->getBlock()));
-
-  if (moveCastOp)
-    moveList.push_back(castOp);
-
-  return moveCastOp;
+bool HoistableDefinitions::collect(MeasureOp measureOp, Operation *defOp,
+                                   MoveListVec &moveList) {
+  // The chain alternates between a load of a variable, whose value may be
+  // hoisted if the variable is assigned before the measurement or if the
+  // cast it is assigned may be hoisted, and a cast, which may be hoisted if it
+  // casts a hoistable load or an earlier measurement. The chain is followed
+  // iteratively and stops on cycles, e.g., a variable assigned a cast of a
+  // load of itself.
+  MoveListVec chain;
+  llvm::SmallPtrSet<Operation *, 8> visited;
+  Operation *op = defOp;
+  while (true) {
+    if (!visited.insert(op).second)
+      return false;
+    chain.push_back(op);
+
+    if (auto loadOp = dyn_cast<oq3::VariableLoadOp>(op)) {
+      Block *block = loadOp->getBlock();
+      // find the corresponding variable assign
+      auto *assignOp = getFirstAssign(block, loadOp);
+      if (!assignOp)
+        break;
+      // move the load if the assign is before the measure
+      auto *measureAncestor = block->findAncestorOpInBlock(*measureOp);
+      if (!measureAncestor)
+        return false;
+      if (block->findAncestorOpInBlock(*assignOp)->isBeforeInBlock(
+              measureAncestor))
+        break;
+      auto assignCastOp = cast<oq3::VariableAssignOp>(assignOp)
+                              .getAssignedValue()
+                              .getDefiningOp<oq3::CastOp>();
+      if (!assignCastOp)
+        return false;
+      op = assignCastOp;
+      continue;
+    }
+
+    auto castOp = dyn_cast<oq3::CastOp>(op);
+    if (!castOp)
+      return false;
+    Operation *argOp = castOp.getArg().getDefiningOp();
+    if (isa_and_nonnull<oq3::VariableLoadOp>(argOp)) {
+      op = argOp;
+      continue;
+    }
+    auto castMeasureOp = dyn_cast_or_null<MeasureOp>(argOp);
+    if (!castMeasureOp || castMeasureOp == measureOp)
+      return false;
+    if (castMeasureOp->getBlock() != castOp->getBlock())
+      break;
+    if (castMeasureOp->getBlock() == measureOp->getBlock() &&
+        castMeasureOp->isBeforeInBlock(measureOp))
+      break;
+    return false;
+  }
+
+  // the definitions come first
+  moveList.append(chain.rbegin(), chain.rend());
+  return true;
 }
 
 // This pattern matches on a measure op and a non-measure op and moves the
 // non-measure op to occur earlier lexicographically if that does not change
 // the topological ordering
 struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
-  explicit ReorderMeasureAndNonMeasurePat(MLIRContext *ctx)
-      : OpRewritePattern<MeasureOp>(ctx) {}
+  explicit ReorderMeasureAndNonMeasurePat(MLIRContext *ctx,
+                                          QubitFootprintAnalysis &footprints,
+                                          HoistableDefinitions &definitions)
+      : OpRewritePattern<MeasureOp>(ctx), footprints(footprints),
+        definitions(definitions) {}
+
+  QubitFootprintAnalysis &footprints;
+  HoistableDefinitions &definitions;
 
   LogicalResult matchAndRewrite(MeasureOp measureOp,
                                 PatternRewriter &rewriter) const override {
@@ -116,7 +174,7 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
 
     do {
       // Accumulate qubits in measurement set
-      std::set<uint> currQubits = measureOp.getOperatedQubits();
+      QubitSet currQubits = footprints.getOperatedQubits(measureOp);
       LLVM_DEBUG(llvm::dbgs() << "Matching on measurement for qubits:\t");
       LLVM_DEBUG(for (const uint id : currQubits) llvm::dbgs() << id << " ");
       LLVM_DEBUG(llvm::dbgs() << "\n");
@@ -129,7 +187,10 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
       // for control flow ops, continue, but add the operated qubits of the
       // control flow block to the currQubits set
       while (nextOp->hasTrait<::mlir::RegionBranchOpInterface::Trait>()) {
-        addQubitIdsFromAttr(nextOp, currQubits);
+        if (auto decorated = getDecoratedQubits(nextOp))
+          currQubits |= *decorated;
+        else
+          currQubits |= footprints.getOperatedQubits(nextOp);
 
         // now find the next next op
         auto nextNextOpt = nextQuantumOrControlFlowOrNull(nextOp);
@@ -145,7 +206,7 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
         break;
 
       // Check for overlap between currQubits and what's operated on by nextOp
-      std::set<uint> nextQubits = QubitOpInterface::getOperatedQubits(nextOp);
+      QubitSet const nextQubits = footprints.getOperatedQubits(nextOp);
       if (QubitOpInterface::qubitSetsOverlap(currQubits, nextQubits))
         break;
 
@@ -160,24 +221,19 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
           if (defOp->getBlock() == measBlock &&
               measureOp->isBeforeInBlock(defOp)) {
 
-            bool moveOps = false;
-
-            // if the defining op is a variable load attempt to move it above
-            // the measurement
-            auto variableLoadOp = dyn_cast<oq3::VariableLoadOp>(defOp);
-            if (variableLoadOp) {
-              moveOps =
-                  mayMoveVariableLoadOp(measureOp, variableLoadOp, moveList);
-            }
-
-            auto castOp = dyn_cast<oq3::CastOp>(defOp);
-            if (castOp)
-              moveOps = mayMoveCastOp(measureOp, castOp, moveList);
+            // if the defining op is a variable load or a cast attempt to move
+            // it above the measurement
+            moveList.clear();
+            bool const moveOps =
+                isa<oq3::VariableLoadOp, oq3::CastOp>(defOp) &&
+                definitions.collect(measureOp, defOp, moveList);
 
             if (moveOps) {
               Operation *mbOp = measureOp.getOperation();
               for (auto op = moveList.rbegin(); op != moveList.rend(); ++op) {
+                Block *oldBlock = (*op)->getBlock();
                 (*op)->moveBefore(mbOp);
+                footprints.notifyOperationMoved(*op, oldBlock);
                 mbOp = *op;
               }
               continue;
@@ -194,13 +250,14 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
       LLVM_DEBUG(nextOp->dump());
       LLVM_DEBUG(llvm::dbgs() << "on qubits:\t");
       LLVM_DEBUG(for (const uint id // this is ugly but clang-format insists
-                      : QubitOpInterface::getOperatedQubits(nextOp)) {
+                      : footprints.getOperatedQubits(nextOp)) {
         llvm::dbgs() << id << " ";
       });
       LLVM_DEBUG(llvm::dbgs() << "\n\n");
 
       // good to move the nextOp before the measureOp
       nextOp->moveBefore(measureOp);
+      footprints.notifyOperationMoved(nextOp, measBlock);
       anyMove = true;
     } while (true);
 
@@ -215,15 +272,26 @@ struct ReorderMeasureAndNonMeasurePat : public OpRewritePattern<MeasureOp> {
 void ReorderMeasurementsPass::runOnOperation() {
   Operation *moduleOperation = getOperation();
 
-  RewritePatternSet patterns(&getContext());
-  patterns.add<ReorderMeasureAndNonMeasurePat>(&getContext());
+  // Measurements are only moved within their block, so the functions and
+  // circuits of a module are reordered in parallel, each with footprints of
+  // its own as the analysis is not thread safe
+  auto reorder = [&](Operation *op) -> LogicalResult {
+    QubitFootprintAnalysis footprints(op);
+    HoistableDefinitions definitions;
+
+    RewritePatternSet patterns(&getContext());
+    patterns.add<CountedPattern<ReorderMeasureAndNonMeasurePat>>(
+        numMeasuresReordered, &getContext(), footprints, definitions);
+
+    mlir::GreedyRewriteConfig config = rewriteOptions.getConfig();
+    // Keep the cached qubit footprints up to date with the rewrites
+    config.listener = footprints.getListener();
 
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
+    return applyPatternsGreedily(op, std::move(patterns), config,
+                                 rewriteStatistics);
+  };
 
-  if (failed(applyPatternsAndFoldGreedily(moduleOperation, std::move(patterns),
-                                          config)))
+  if (failed(parallelForEachIsolatedOp(moduleOperation, reorder)))
     signalPassFailure();
 } // runOnOperation
 
@@ -31,17 +31,20 @@
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Attributes.h"
-#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <string>
-#include <sys/types.h>
+#include <utility>
 #include <vector>
 
 using namespace mlir;
@@ -87,9 +90,9 @@ auto SubroutineCloningPass::lookupQubitId(const Value val) -> int {
 } // lookupQubitId
 
 template <class CallLikeOp>
-auto SubroutineCloningPass::getMangledName(Operation *op) -> std::string {
-  auto callOp = dyn_cast<CallLikeOp>(op);
-  std::string mangledName = callOp.getCallee().str();
+auto SubroutineCloningPass::getSpecializationKey(CallLikeOp callOp)
+    -> SpecializationKey {
+  SpecializationKey key{callOp.getCalleeAttr().getAttr(), {}};
 
   std::vector<Value> qOperands;
   qubitCallOperands(callOp, qOperands);
@@ -101,114 +104,140 @@ auto SubroutineCloningPass::getMangledName(Operation *op) -> std::string {
       callOp->print(llvm::errs());
     }
 
-    mangledName += "_q" + std::to_string(qId);
+    key.qubitIds.push_back(qId);
   }
 
+  return key;
+} // getSpecializationKey
+
+auto SubroutineCloningPass::getMangledName(const SpecializationKey &key)
+    -> std::string {
+  std::string mangledName = key.callee.str();
+  for (int const qId : key.qubitIds)
+    mangledName += "_q" + std::to_string(qId);
   return mangledName;
 } // getMangledName
 
 template <class CallLikeOp, class FuncLikeOp>
-void SubroutineCloningPass::processCallOp(Operation *op,
-                                          SymbolOpMap &symbolOps) {
-  auto callOp = dyn_cast<CallLikeOp>(op);
-  OpBuilder build(moduleOperation->getRegion(0));
-
-  // look for func def match
-  auto search = symbolOps.find(callOp.getCallee());
-
-  if (search == symbolOps.end()) {
-    callOp->emitOpError() << "No matching function def found for "
-                          << callOp.getCallee() << "\n";
-    return signalPassFailure();
-  }
+void SubroutineCloningPass::processCallOps(std::vector<Operation *> callOps,
+                                           SymbolOpMap &symbolOps) {
+  // a specialization to clone, along with the calls within its clone
+  struct Clone {
+    Operation *findOp;
+    SpecializationKey key;
+    StringAttr mangledName;
+    Operation *newFunc = nullptr;
+    std::vector<Operation *> callOps;
+  };
+
+  // process the calls level by level: the calls within the clones of a level
+  // make up the next level
+  while (!callOps.empty()) {
+    // resolve the callee of each call, and collect the specializations which
+    // do not exist yet in the order of their first call
+    std::vector<Clone> clones;
+    llvm::StringSet<> cloneNames;
+    for (Operation *op : callOps) {
+      auto callOp = cast<CallLikeOp>(op);
+
+      // look for func def match
+      auto search = symbolOps.find(callOp.getCallee());
+      if (search == symbolOps.end() || !search->second) {
+        callOp->emitOpError() << "No matching function def found for "
+                              << callOp.getCallee() << "\n";
+        return signalPassFailure();
+      }
 
-  Operation *findOp = search->second;
-  if (findOp) {
-    std::vector<Value> qOperands;
-    qubitCallOperands(callOp, qOperands);
-
-    // first get the mangled name
-    std::string const mangledName = getMangledName<CallLikeOp>(callOp);
-    callOp->setAttr("callee",
-                    FlatSymbolRefAttr::get(&getContext(), mangledName));
-
-    // does the mangled function already exist?
-    if (symbolOps.find(mangledName) != symbolOps.end())
-      return;
-
-    // clone the func def with the new name
-    FuncLikeOp newFunc = cast<FuncLikeOp>(build.clone(*findOp));
-    newFunc->moveBefore(findOp);
-    clonedFuncs.emplace(findOp);
-    newFunc->setAttr(SymbolTable::getSymbolAttrName(),
-                     StringAttr::get(&getContext(), mangledName));
-
-    // add qubit ID attributes to all the arguments
-    for (uint ii = 0; ii < callOp.getOperands().size(); ++ii) {
-      if (callOp.getOperands()[ii].getType().template isa<QubitType>()) {
-        int const qId =
-            lookupQubitId(callOp.getOperands()[ii]); // copy qubitId from call
-        newFunc.setArgAttrs(
-            ii, ArrayRef({NamedAttribute(
-                    StringAttr::get(&getContext(),
-                                    mlir::quir::getPhysicalIdAttrName()),
-                    build.getI32IntegerAttr(qId))}));
+      auto key = getSpecializationKey(callOp);
+      auto [specializationIter, inserted] = specializations.try_emplace(key);
+      if (inserted) {
+        std::string const mangledName = getMangledName(key);
+        specializationIter->second =
+            FlatSymbolRefAttr::get(&getContext(), mangledName);
+
+        // does the mangled function already exist?
+        if (symbolOps.find(mangledName) == symbolOps.end() &&
+            cloneNames.insert(mangledName).second)
+          clones.push_back({search->second, std::move(key),
+                            specializationIter->second.getAttr()});
       }
+      callOp->setAttr("callee", specializationIter->second);
     }
 
-    // add calls within the new func def to the callWorkList
-    newFunc->walk([&](CallLikeOp op) { callWorkList.push_back(op); });
+    // clone the func defs of the new specializations with their new names,
+    // detached from the module
+    mlir::parallelForEach(&getContext(), clones, [&](Clone &clone) {
+      auto newFunc = cast<FuncLikeOp>(clone.findOp->clone());
+      newFunc->setAttr(SymbolTable::getSymbolAttrName(), clone.mangledName);
+
+      // add qubit ID attributes to all the qubit arguments
+      auto const qubitIdAttrName =
+          StringAttr::get(&getContext(), mlir::quir::getPhysicalIdAttrName());
+      auto const *qId = clone.key.qubitIds.begin();
+      for (auto const &input :
+           llvm::enumerate(newFunc.getFunctionType().getInputs())) {
+        if (input.value().template isa<QubitType>() &&
+            qId != clone.key.qubitIds.end())
+          newFunc.setArgAttrs(
+              input.index(),
+              ArrayRef({NamedAttribute(
+                  qubitIdAttrName,
+                  IntegerAttr::get(IntegerType::get(&getContext(), 32),
+                                   *qId++))}));
+      }
 
-    symbolOps[mangledName] = newFunc.getOperation();
+      // collect the calls within the new func def for the next level
+      newFunc->walk([&](CallLikeOp op) { clone.callOps.push_back(op); });
+      clone.newFunc = newFunc.getOperation();
+    });
 
-  } else { // matching function not found
-    callOp->emitOpError() << "No matching function def found for "
-                          << callOp.getCallee() << "\n";
-    return signalPassFailure();
+    // add the clones to the module in order
+    callOps.clear();
+    for (auto &clone : clones) {
+      clone.findOp->getBlock()->getOperations().insert(
+          clone.findOp->getIterator(), clone.newFunc);
+      clonedFuncs.emplace(clone.findOp);
+      symbolOps[clone.mangledName] = clone.newFunc;
+      callOps.insert(callOps.end(), clone.callOps.begin(),
+                     clone.callOps.end());
+    }
   }
-
-} // processCallOp
+} // processCallOps
 
 // Entry point for the pass.
 void SubroutineCloningPass::runOnOperation() {
   moduleOperation = getOperation();
   Operation *mainFunc = getMainFunction(moduleOperation);
-  callWorkList.clear();
+  clonedFuncs.clear();
+  specializations.clear();
 
   if (!mainFunc) {
     llvm::errs() << "No main function found, cannot clone subroutines!\n";
     return signalPassFailure();
   }
 
-  mainFunc->walk([&](CallSubroutineOp op) { callWorkList.push_back(op); });
+  std::vector<Operation *> callOps;
+  mainFunc->walk([&](CallSubroutineOp op) { callOps.push_back(op); });
 
   SymbolOpMap symbolOps;
 
-  if (!callWorkList.empty()) {
+  if (!callOps.empty()) {
     moduleOperation->walk([&](mlir::func::FuncOp functionOp) {
       symbolOps[functionOp.getSymName()] = functionOp.getOperation();
     });
+    processCallOps<CallSubroutineOp, mlir::func::FuncOp>(std::move(callOps),
+                                                         symbolOps);
   }
 
-  while (!callWorkList.empty()) {
-    Operation *op = callWorkList.front();
-    callWorkList.pop_front();
-    processCallOp<CallSubroutineOp, mlir::func::FuncOp>(op, symbolOps);
-  }
-
-  mainFunc->walk([&](CallCircuitOp op) { callWorkList.push_back(op); });
+  callOps.clear();
+  mainFunc->walk([&](CallCircuitOp op) { callOps.push_back(op); });
 
-  if (!callWorkList.empty()) {
+  if (!callOps.empty()) {
     symbolOps.clear();
     moduleOperation->walk([&](CircuitOp circuitOp) {
       symbolOps[circuitOp.getSymName()] = circuitOp.getOperation();
     });
-  }
-
-  while (!callWorkList.empty()) {
-    Operation *op = callWorkList.front();
-    callWorkList.pop_front();
-    processCallOp<CallCircuitOp, CircuitOp>(op, symbolOps);
+    processCallOps<CallCircuitOp, CircuitOp>(std::move(callOps), symbolOps);
   }
 
   // All subroutine defs that have been cloned are no longer needed
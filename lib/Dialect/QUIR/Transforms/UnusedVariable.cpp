@@ -23,74 +23,65 @@
 
 #include "Dialect/OQ3/IR/OQ3Ops.h"
 
-#include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/Support/LLVM.h"
-#include "mlir/Support/LogicalResult.h"
-#include "mlir/Transforms/DialectConversion.h"
-#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringRef.h"
 
-#include <utility>
-
 using namespace mlir;
 using namespace quir;
 using namespace oq3;
 
 namespace {
-/// This pattern matches on variable declarations that are not marked 'output'
-/// and are not followed by a use of the same variable, and removes them
-struct UnusedVariablePat : public OpRewritePattern<DeclareVariableOp> {
-  UnusedVariablePat(MLIRContext *context, mlir::SymbolUserMap &symbolUses)
-      : OpRewritePattern<DeclareVariableOp>(context, /*benefit=*/1),
-        symbolUses(symbolUses) {}
-  mlir::SymbolUserMap &symbolUses;
-  LogicalResult
-  matchAndRewrite(DeclareVariableOp declOp,
-                  mlir::PatternRewriter &rewriter) const override {
-    if (declOp.isOutputVariable())
-      return failure();
-
-    // iterate through uses
-    for (auto *useOp : symbolUses.getUsers(declOp)) {
-      if (auto useVariable = dyn_cast<VariableLoadOp>(useOp)) {
-        if (!useVariable || !useVariable.use_empty())
-          return failure();
-      }
-    }
-
-    // No uses found, so now we can erase all references (just stores) and the
-    // declaration
-    for (auto *useOp : symbolUses.getUsers(declOp))
-      rewriter.eraseOp(useOp);
-
-    rewriter.eraseOp(declOp);
-    return success();
-  } // matchAndRewrite
-
-}; // struct UnusedVariablePat
+/// Whether declOp is not marked 'output' and none of its loads are used.
+bool isUnusedVariable(DeclareVariableOp declOp,
+                      mlir::SymbolUserMap &symbolUsers) {
+  if (declOp.isOutputVariable())
+    return false;
+
+  for (auto *useOp : symbolUsers.getUsers(declOp))
+    if (auto useVariable = dyn_cast<VariableLoadOp>(useOp))
+      if (!useVariable.use_empty())
+        return false;
+  return true;
+} // isUnusedVariable
 } // anonymous namespace
 
 ///
 /// \brief Entry point for the pass.
 void UnusedVariablePass::runOnOperation() {
-  RewritePatternSet patterns(&getContext());
-  mlir::GreedyRewriteConfig config;
-  mlir::SymbolTableCollection symbolTable;
-  mlir::SymbolUserMap symbolUsers(symbolTable, getOperation());
-
-  // use cheaper top-down traversal (in this case, bottom-up would not behave
-  // any differently)
-  config.useTopDownTraversal = true;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  patterns.add<UnusedVariablePat>(&getContext(), symbolUsers);
+  mlir::SymbolTableCollection symbolTables;
+  mlir::SymbolUserMap symbolUsers(symbolTables, getOperation());
+
+  llvm::SetVector<Operation *> worklist;
+  getOperation()->walk(
+      [&](DeclareVariableOp declOp) { worklist.insert(declOp); });
+
+  while (!worklist.empty()) {
+    auto declOp = cast<DeclareVariableOp>(worklist.pop_back_val());
+    if (!isUnusedVariable(declOp, symbolUsers))
+      continue;
+
+    // No uses found, so now we can erase all references (just stores and
+    // unused loads) and the declaration
+    for (auto *useOp : symbolUsers.getUsers(declOp)) {
+      // erasing an assignment may leave a load of another variable unused,
+      // which may then be removed as well
+      for (auto operand : useOp->getOperands()) {
+        auto loadOp = operand.getDefiningOp<VariableLoadOp>();
+        if (!loadOp || !operand.hasOneUse())
+          continue;
+        if (auto *loadedOp = symbolTables.lookupNearestSymbolFrom(
+                loadOp, loadOp.getVariableNameAttr()))
+          if (isa<DeclareVariableOp>(loadedOp) && loadedOp != declOp)
+            worklist.insert(loadedOp);
+      }
+      useOp->erase();
+    }
 
-  if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns),
-                                          config)))
-    signalPassFailure();
+    declOp->erase();
+  }
 }
 
 llvm::StringRef UnusedVariablePass::getArgument() const {
@@ -34,18 +34,24 @@
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
-#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
@@ -85,18 +91,6 @@ public:
   }
 };
 
-struct MemrefGlobalToAllocaPattern
-    : public OpRewritePattern<mlir::memref::GetGlobalOp> {
-  MemrefGlobalToAllocaPattern(MLIRContext *context, mlir::Operation *toplevel)
-      : OpRewritePattern<mlir::memref::GetGlobalOp>(context, /* benefit*/ 1),
-        toplevel(toplevel) {}
-
-  LogicalResult matchAndRewrite(mlir::memref::GetGlobalOp,
-                                mlir::PatternRewriter &rewriter) const override;
-
-  mlir::Operation *toplevel;
-};
-
 /// Materialize OQ3 casts to !quir.angle into a new cast when the argument can
 /// be type-converted to integer.
 struct MaterializeIntToAngleCastPattern
@@ -143,7 +137,9 @@ struct MaterializeBitOpForInt : public OpConversionPattern<OperationType> {
 
 mlir::LogicalResult convertQuirVariables(mlir::MLIRContext &context,
                                          mlir::Operation *top,
-                                         bool externalizeOutputVariables) {
+                                         bool externalizeOutputVariables,
+                                         bool packPrivateVariables,
+                                         bool reuseVariableSlots) {
 
   // This conversion step gets rid of QUIR variables and classical bit
   // registers. These two concepts should be in the OpenQASM 3 dialect.
@@ -163,8 +159,15 @@ mlir::LogicalResult convertQuirVariables(mlir::MLIRContext &context,
   // TODO add additional QUIR variable operations here
   RewritePatternSet patterns(&context);
 
+  quir::PackedVariableLayout layout;
+  if (packPrivateVariables)
+    if (auto moduleOp = mlir::dyn_cast<mlir::ModuleOp>(top))
+      layout =
+          quir::packVariables(moduleOp, typeConverter, reuseVariableSlots);
+
   quir::populateVariableToGlobalMemRefConversionPatterns(
-      patterns, typeConverter, externalizeOutputVariables);
+      patterns, typeConverter, externalizeOutputVariables,
+      packPrivateVariables ? &layout : nullptr);
 
   // Convert `CBit` type and operations
   oq3::populateOQ3ToStandardConversionPatterns(typeConverter, patterns, false);
@@ -217,133 +220,128 @@ mlir::LogicalResult convertQuirVariables(mlir::MLIRContext &context,
   return applyPartialConversion(top, target, std::move(patterns));
 }
 
-LogicalResult MemrefGlobalToAllocaPattern::matchAndRewrite(
-    mlir::memref::GetGlobalOp op, mlir::PatternRewriter &rewriter) const {
-
-  // Check that the global memref is only used by this GetGlobalOp
-  auto global =
-      mlir::SymbolTable::lookupNearestSymbolFrom<mlir::memref::GlobalOp>(
-          op, op.getNameAttr());
-
-  if (!global)
-    return failure();
-  if (!global.isPrivate())
-    return failure();
-
-  auto uses = global.getSymbolUses(toplevel);
-
-  if (!uses)
-    return failure();
-
-  for (auto &use : uses.value()) {
-    assert(use.getSymbolRef() == op.getNameAttr() && "found wrong symbol");
-    if (use.getUser() != op) // other reference to the global memref
-      return failure();
+/// Replace each private memref.global which is only used by a single
+/// memref.get_global with a memref.alloca in place of the latter.
+///
+/// The uses of all the symbols are collected in a single walk and the
+/// globals are looked up in a cached symbol table, so that large modules
+/// are not walked once per memref.get_global.
+void convertIsolatedMemrefGlobalToAlloca(mlir::Operation *top) {
+
+  auto symbolUses = mlir::SymbolTable::getSymbolUses(top);
+  if (!symbolUses)
+    return;
+
+  llvm::DenseMap<mlir::StringAttr, llvm::SmallVector<mlir::Operation *, 1>>
+      symbolUsers;
+  for (auto &use : symbolUses.value())
+    symbolUsers[use.getSymbolRef().getRootReference()].push_back(
+        use.getUser());
+
+  llvm::SmallVector<mlir::memref::GetGlobalOp> getGlobalOps;
+  top->walk(
+      [&](mlir::memref::GetGlobalOp op) { getGlobalOps.push_back(op); });
+
+  mlir::SymbolTableCollection symbolTables;
+  for (auto op : getGlobalOps) {
+    // Check that the global memref is only used by this GetGlobalOp
+    auto global = symbolTables.lookupNearestSymbolFrom<mlir::memref::GlobalOp>(
+        op, op.getNameAttr());
+
+    if (!global)
+      continue;
+    if (!global.isPrivate())
+      continue;
+
+    auto &users = symbolUsers[op.getNameAttr().getAttr()];
+    if (llvm::any_of(users, [&](mlir::Operation *user) { return user != op; }))
+      continue; // other reference to the global memref
+
+    auto mrt = op.getResult().getType().dyn_cast<mlir::MemRefType>();
+
+    assert(mrt && "expect result of a GetGlobalOp to be of MemRefType");
+    if (!mrt)
+      continue;
+
+    mlir::OpBuilder builder(op);
+    auto allocaOp = builder.create<mlir::memref::AllocaOp>(
+        op.getLoc(), mrt, global.getAlignmentAttr());
+    op.getResult().replaceAllUsesWith(allocaOp.getResult());
+    op->erase();
+    symbolTables.getSymbolTable(global->getParentOp()).erase(global);
   }
-
-  auto mrt = op.getResult().getType().dyn_cast<mlir::MemRefType>();
-
-  assert(mrt && "expect result of a GetGlobalOp to be of MemRefType");
-  if (!mrt)
-    return failure();
-
-  rewriter.replaceOpWithNewOp<mlir::memref::AllocaOp>(
-      op, mrt, global.getAlignmentAttr());
-  rewriter.eraseOp(global);
-  return success();
-}
-
-mlir::LogicalResult
-convertIsolatedMemrefGlobalToAlloca(mlir::MLIRContext &context,
-                                    mlir::Operation *top) {
-
-  RewritePatternSet patterns(&context);
-
-  patterns.add<MemrefGlobalToAllocaPattern>(&context, top);
-  mlir::GreedyRewriteConfig config;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  config.useTopDownTraversal = true;
-
-  return applyPatternsAndFoldGreedily(top, std::move(patterns), config);
 }
 
-struct RemoveAllocaWithIsolatedStoresPattern
-    : public OpRewritePattern<mlir::memref::AllocaOp> {
-  RemoveAllocaWithIsolatedStoresPattern(MLIRContext *context,
-                                        mlir::Operation *toplevel)
-      : OpRewritePattern<mlir::memref::AllocaOp>(context, /* benefit*/ 1),
-        toplevel(toplevel) {}
-
-  LogicalResult matchAndRewrite(mlir::memref::AllocaOp,
-                                mlir::PatternRewriter &rewriter) const override;
-
-  mlir::Operation *toplevel;
-};
-
-LogicalResult RemoveAllocaWithIsolatedStoresPattern::matchAndRewrite(
-    mlir::memref::AllocaOp op, mlir::PatternRewriter &rewriter) const {
-
-  llvm::SmallVector<mlir::Operation *> usersToErase;
-
-  // Check that the only users are store operations
-  // push to small vector for erasing
-  for (auto *user : op.getResult().getUsers()) {
-    usersToErase.push_back(user);
-    if (!mlir::isa<mlir::affine::AffineStoreOp>(user))
-      return failure();
+/// Erase each memref.alloca whose only users are affine.store ops, along
+/// with its stores and the ops computing the stored values which become
+/// trivially dead, in a single sweep over a work list. Erasing a dead load
+/// revisits its alloca, which may then only have stores left.
+void dropAllocaWithIsolatedStores(mlir::Operation *top) {
+
+  llvm::SetVector<mlir::Operation *> workList;
+  top->walk([&](mlir::memref::AllocaOp op) { workList.insert(op); });
+
+  while (!workList.empty()) {
+    auto *op = workList.pop_back_val();
+
+    if (auto allocaOp = mlir::dyn_cast<mlir::memref::AllocaOp>(op)) {
+      // Check that the only users are store operations
+      if (!llvm::all_of(allocaOp.getResult().getUsers(),
+                        [](mlir::Operation *user) {
+                          return mlir::isa<mlir::affine::AffineStoreOp>(user);
+                        }))
+        continue;
+
+      // Drop all users
+      for (auto *user :
+           llvm::make_early_inc_range(allocaOp.getResult().getUsers())) {
+        auto storedValue =
+            mlir::cast<mlir::affine::AffineStoreOp>(user).getValueToStore();
+        user->erase();
+        if (auto *storedValueOp = storedValue.getDefiningOp())
+          workList.insert(storedValueOp);
+      }
+
+      // and remove the alloca
+      op->erase();
+      continue;
+    }
+
+    // erase the ops which only computed stored values
+    if (!mlir::isOpTriviallyDead(op))
+      continue;
+    for (auto operand : op->getOperands())
+      if (auto *operandOp = operand.getDefiningOp())
+        workList.insert(operandOp);
+    op->erase();
   }
-
-  // Drop all users
-  for (auto *user : usersToErase)
-    rewriter.eraseOp(user);
-
-  // and remove the alloca
-  rewriter.eraseOp(op);
-  return success();
-}
-
-mlir::LogicalResult dropAllocaWithIsolatedStores(mlir::MLIRContext &context,
-                                                 mlir::Operation *top) {
-
-  RewritePatternSet patterns(&context);
-
-  patterns.add<RemoveAllocaWithIsolatedStoresPattern>(&context, top);
-  mlir::GreedyRewriteConfig config;
-
-  config.useTopDownTraversal = true;
-  // Disable to improve performance
-  config.enableRegionSimplification = false;
-
-  return applyPatternsAndFoldGreedily(top, std::move(patterns), config);
 }
 
 } // anonymous namespace
 
 void VariableEliminationPass::runOnOperation() {
 
-  if (failed(convertQuirVariables(getContext(), getOperation(),
-                                  externalizeOutputVariables)))
+  // variables are module level symbols, so they are converted for the whole
+  // module at once
+  if (failed(convertQuirVariables(
+          getContext(), getOperation(), externalizeOutputVariables,
+          packVariables || reuseVariableSlots, reuseVariableSlots)))
     return signalPassFailure();
 
-  if (failed(convertIsolatedMemrefGlobalToAlloca(getContext(), getOperation())))
-    return signalPassFailure();
+  convertIsolatedMemrefGlobalToAlloca(getOperation());
 
-  auto &domInfo = getAnalysis<DominanceInfo>();
-  auto &postDomInfo = getAnalysis<PostDominanceInfo>();
-
-  WalkResult const result = getOperation()->walk([&](mlir::func::FuncOp func) {
+  // the variables of each function are now local to it, so forward the
+  // stores to the loads of the functions in parallel
+  llvm::SmallVector<mlir::func::FuncOp> funcOps;
+  getOperation()->walk(
+      [&](mlir::func::FuncOp func) { funcOps.push_back(func); });
+  mlir::parallelForEach(&getContext(), funcOps, [&](mlir::func::FuncOp func) {
+    DominanceInfo domInfo(func);
+    PostDominanceInfo postDomInfo(func);
     mlir::affine::affineScalarReplace(func, domInfo, postDomInfo);
-
-    return WalkResult::advance();
   });
 
-  if (result.wasInterrupted())
-    return signalPassFailure();
-
-  if (failed(dropAllocaWithIsolatedStores(getContext(), getOperation())))
-    return signalPassFailure();
+  dropAllocaWithIsolatedStores(getOperation());
 }
 
 llvm::StringRef VariableEliminationPass::getArgument() const {
@@ -0,0 +1,78 @@
+//===- ClassicalOnlyAnalysis.cpp - Classical only operations ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the analysis which finds the operations containing
+//  quantum operations
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Utils/ClassicalOnlyAnalysis.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Operation.h"
+
+#include "llvm/Support/Casting.h"
+
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+ClassicalOnlyAnalysis::ClassicalOnlyAnalysis(Operation *op) {
+  // The walk is post-order, so the contents of the operations nested in an
+  // operation have been added to its entry by the time it is visited.
+  op->walk([&](Operation *nestedOp) {
+    uint8_t nestedContents = getOwnContents(nestedOp);
+    if (nestedOp->getNumRegions() != 0)
+      nestedContents = contents[nestedOp] |= nestedContents;
+    if (nestedOp == op || nestedContents == 0)
+      return;
+    if (Operation *parentOp = nestedOp->getParentOp())
+      contents[parentOp] |= nestedContents;
+  });
+}
+
+uint8_t ClassicalOnlyAnalysis::getOwnContents(Operation *op) {
+  if (isa<DeclareQubitOp, CallCircuitOp>(op))
+    return QuantumOps | QubitDeclarations;
+  if (isa<BuiltinCXOp, Builtin_UOp, CallDefCalGateOp, CallDefcalMeasureOp,
+          DelayOp, CallGateOp, MeasureOp, ResetQubitOp>(op))
+    return QuantumOps;
+  return 0;
+}
+
+uint8_t ClassicalOnlyAnalysis::getContents(Operation *op) const {
+  if (op->getNumRegions() == 0)
+    return getOwnContents(op);
+  return contents.lookup(op);
+}
+
+bool ClassicalOnlyAnalysis::isClassicalOnly(Operation *op) const {
+  auto funcOp = dyn_cast<func::FuncOp>(op);
+  if (!funcOp)
+    return !hasQuantumOps(op);
+
+  if (funcOp.getSymName() == "main")
+    return false;
+  for (auto argType : funcOp.getFunctionType().getInputs())
+    if (argType.isa<QubitType>())
+      return false;
+  return !hasQubitDeclarations(op);
+}
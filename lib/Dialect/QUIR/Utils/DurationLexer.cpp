@@ -0,0 +1,156 @@
+//===- DurationLexer.cpp - QUIR duration literal lexer ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the lexer for duration literals
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Utils/DurationLexer.h"
+
+#include "Dialect/QUIR/IR/QUIREnums.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+using namespace mlir::quir;
+
+namespace {
+
+enum CharClass : uint8_t { Other = 0, Digit, Dot, Alpha };
+
+constexpr std::array<CharClass, 256> makeCharClasses() {
+  std::array<CharClass, 256> classes{};
+  for (char c = '0'; c <= '9'; ++c)
+    classes[static_cast<unsigned char>(c)] = Digit;
+  for (char c = 'a'; c <= 'z'; ++c)
+    classes[static_cast<unsigned char>(c)] = Alpha;
+  for (char c = 'A'; c <= 'Z'; ++c)
+    classes[static_cast<unsigned char>(c)] = Alpha;
+  classes[static_cast<unsigned char>('.')] = Dot;
+  return classes;
+}
+
+constexpr std::array<CharClass, 256> charClasses = makeCharClasses();
+
+CharClass classify(char c) {
+  return charClasses[static_cast<unsigned char>(c)];
+}
+
+struct UnitEntry {
+  llvm::StringLiteral name;
+  TimeUnits units;
+};
+
+// Lower case spellings of the units, the empty string being seconds.
+constexpr std::array<UnitEntry, 8> unitTable{{{"", TimeUnits::s},
+                                             {"dt", TimeUnits::dt},
+                                             {"s", TimeUnits::s},
+                                             {"ms", TimeUnits::ms},
+                                             {"us", TimeUnits::us},
+                                             {"ns", TimeUnits::ns},
+                                             {"ps", TimeUnits::ps},
+                                             {"fs", TimeUnits::fs}}};
+
+// Powers of ten which are exact doubles.
+constexpr std::array<double, 23> exactPowersOfTen{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Mantissas below 2^53 are exact doubles.
+constexpr uint64_t maxExactMantissa = uint64_t{1} << 53;
+
+/// Convert a lexed decimal number to a double. Numbers with an exact mantissa
+/// and power of ten are divided directly, which rounds correctly, and the
+/// rest are left to strtod.
+std::optional<double> convertNumber(llvm::StringRef number, uint64_t mantissa,
+                                    bool mantissaExact, size_t fractionDigits) {
+  if (mantissaExact && fractionDigits < exactPowersOfTen.size())
+    return static_cast<double>(mantissa) / exactPowersOfTen[fractionDigits];
+
+  double value;
+  if (number.getAsDouble(value, /*AllowInexact=*/true))
+    return std::nullopt;
+  return value;
+}
+
+} // anonymous namespace
+
+std::optional<TimeUnits> mlir::quir::lexTimeUnits(llvm::StringRef units) {
+  for (const auto &entry : unitTable)
+    if (units.equals_insensitive(entry.name))
+      return entry.units;
+  return std::nullopt;
+}
+
+llvm::Expected<std::pair<double, TimeUnits>>
+mlir::quir::lexDuration(llvm::StringRef duration) {
+  auto error = [&]() {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        llvm::Twine("Unable to parse duration from ") + duration);
+  };
+
+  // [0-9]*([.][0-9]+)?
+  size_t pos = 0;
+  uint64_t mantissa = 0;
+  bool mantissaExact = true;
+  size_t numDigits = 0;
+  size_t fractionDigits = 0;
+  bool inFraction = false;
+  for (; pos < duration.size(); ++pos) {
+    auto const charClass = classify(duration[pos]);
+    if (charClass == Dot && !inFraction) {
+      inFraction = true;
+      continue;
+    }
+    if (charClass != Digit)
+      break;
+
+    ++numDigits;
+    if (inFraction)
+      ++fractionDigits;
+    mantissa = mantissa * 10 + static_cast<uint64_t>(duration[pos] - '0');
+    if (mantissa >= maxExactMantissa)
+      mantissaExact = false;
+  }
+  // The number must end in a digit.
+  if (numDigits == 0 || (inFraction && fractionDigits == 0))
+    return error();
+
+  auto const number = duration.take_front(pos);
+  auto const unitStr = duration.drop_front(pos);
+  for (char const c : unitStr)
+    if (classify(c) != Alpha)
+      return error();
+
+  auto value = convertNumber(number, mantissa, mantissaExact, fractionDigits);
+  if (!value)
+    return error();
+
+  if (auto units = lexTimeUnits(unitStr))
+    return std::make_pair(*value, *units);
+
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 llvm::Twine("Unknown duration unit ") +
+                                     unitStr);
+}
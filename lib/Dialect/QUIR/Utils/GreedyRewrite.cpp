@@ -0,0 +1,124 @@
+//===- GreedyRewrite.cpp - Instrumented greedy rewrites ---------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the pass options and statistics of the greedy
+//  rewrites of the QUIR passes
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Utils/GreedyRewrite.h"
+
+#include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <chrono>
+#include <cstdint>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+GreedyRewriteOptions::GreedyRewriteOptions(Pass &pass,
+                                           bool regionSimplificationDefault)
+    : maxIterations(pass, "max-iterations",
+                    llvm::cl::desc("Maximum number of iterations of the "
+                                   "greedy rewrites, -1 for no limit"),
+                    llvm::cl::init(GreedyRewriteConfig().maxIterations)),
+      topDown(pass, "top-down",
+              llvm::cl::desc("Visit the operations top-down rather than "
+                             "bottom-up in each iteration"),
+              llvm::cl::init(GreedyRewriteConfig().useTopDownTraversal)),
+      regionSimplification(
+          pass, "region-simplification",
+          llvm::cl::desc("Simplify the regions after each iteration"),
+          llvm::cl::init(regionSimplificationDefault)) {}
+
+GreedyRewriteConfig GreedyRewriteOptions::getConfig() const {
+  GreedyRewriteConfig config;
+  config.maxIterations = maxIterations;
+  config.useTopDownTraversal = topDown;
+  config.enableRegionSimplification = regionSimplification;
+  return config;
+}
+
+GreedyRewriteStatistics::GreedyRewriteStatistics(Pass &pass)
+    : numIterations(&pass, "num-rewrite-iterations",
+                    "Number of iterations of the greedy rewrites"),
+      numNonConvergences(&pass, "num-rewrite-nonconvergences",
+                         "Number of greedy rewrites stopped at the maximum "
+                         "number of iterations"),
+      rewriteMicroseconds(&pass, "rewrite-microseconds",
+                          "Microseconds spent in the greedy rewrites") {}
+
+LogicalResult
+mlir::quir::applyPatternsGreedily(Operation *op,
+                                  const FrozenRewritePatternSet &patterns,
+                                  GreedyRewriteConfig config,
+                                  GreedyRewriteStatistics &statistics) {
+  auto const started = std::chrono::steady_clock::now();
+  int64_t const maxIterations = config.maxIterations;
+  config.maxIterations = 1;
+
+  // each call runs a single iteration, which reports whether it changed the
+  // IR, and the rewrites have converged once an iteration changes nothing
+  bool changed = true;
+  int64_t iteration = 0;
+  while (changed && (maxIterations == GreedyRewriteConfig::kNoLimit ||
+                     iteration < maxIterations)) {
+    changed = false;
+    (void)applyPatternsAndFoldGreedily(op, patterns, config, &changed);
+    ++iteration;
+  }
+
+  statistics.numIterations += iteration;
+  statistics.rewriteMicroseconds +=
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - started)
+          .count();
+  if (!changed)
+    return success();
+
+  ++statistics.numNonConvergences;
+  return op->emitError() << "greedy rewrites did not converge within "
+                         << maxIterations << " iterations";
+}
+
+LogicalResult mlir::quir::parallelForEachIsolatedOp(
+    Operation *op, llvm::function_ref<LogicalResult(Operation *)> fn) {
+  llvm::SmallVector<Operation *> isolatedOps;
+  for (auto &region : op->getRegions()) {
+    for (auto &nestedOp : region.getOps()) {
+      if (nestedOp.getNumRegions() == 0)
+        continue;
+      // rewrites of an op which is not isolated may reach across its siblings
+      if (!nestedOp.hasTrait<OpTrait::IsIsolatedFromAbove>())
+        return fn(op);
+      isolatedOps.push_back(&nestedOp);
+    }
+  }
+  if (isolatedOps.empty())
+    return fn(op);
+
+  return failableParallelForEach(op->getContext(), isolatedOps, fn);
+}
@@ -0,0 +1,159 @@
+//===- QubitFootprintAnalysis.cpp - Cached operated qubits ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the analysis which caches the qubits operated on by
+//  operations
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Utils/QubitFootprintAnalysis.h"
+
+#include "Dialect/QUIR/IR/QUIRInterfaces.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+
+#include "llvm/Support/MathExtras.h"
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+QubitFootprintAnalysis::QubitFootprintAnalysis(Operation * /*op*/)
+    : listener(*this) {}
+
+QubitSet QubitFootprintAnalysis::getOperatedQubits(Operation *op) {
+  auto cached = footprints.find(op);
+  if (cached != footprints.end())
+    return cached->second;
+
+  QubitSet opQubits;
+  if (auto interface = dyn_cast<QubitOpInterface>(op)) {
+    opQubits = interface.getOperatedQubits();
+  } else {
+    for (Region &region : op->getRegions())
+      for (Block &block : region)
+        for (Operation &nestedOp : block)
+          opQubits |= getOperatedQubits(&nestedOp);
+  }
+
+  // Nested lookups may have grown the map, so insert rather than keeping an
+  // iterator from the lookup above.
+  footprints.try_emplace(op, opQubits);
+  return opQubits;
+}
+
+const QubitFootprintAnalysis::BlockRanges &
+QubitFootprintAnalysis::getBlockRanges(Block *block) {
+  auto cached = blockRanges.find(block);
+  if (cached != blockRanges.end())
+    return cached->second;
+
+  BlockRanges ranges;
+  std::vector<QubitSet> singles;
+  for (Operation &op : *block) {
+    ranges.positions[&op] = singles.size();
+    singles.push_back(getOperatedQubits(&op));
+  }
+  size_t const numOps = singles.size();
+  ranges.levels.push_back(std::move(singles));
+
+  // levels[k][i] is the union over [i, i + 2^k).
+  for (size_t width = 2; width <= numOps; width *= 2) {
+    auto const &prev = ranges.levels.back();
+    std::vector<QubitSet> level;
+    level.reserve(numOps - width + 1);
+    for (size_t i = 0; i + width <= numOps; ++i)
+      level.push_back(prev[i] | prev[i + width / 2]);
+    ranges.levels.push_back(std::move(level));
+  }
+
+  return blockRanges.try_emplace(block, std::move(ranges)).first->second;
+}
+
+QubitSet QubitFootprintAnalysis::getQubitsBetween(Operation *first,
+                                                  Operation *second) {
+  assert(first->getBlock() == second->getBlock() &&
+         "operations must be in the same block");
+  assert((first == second || first->isBeforeInBlock(second)) &&
+         "first must be before second");
+  const auto &ranges = getBlockRanges(first->getBlock());
+  unsigned const begin = ranges.positions.lookup(first) + 1;
+  unsigned const end = ranges.positions.lookup(second);
+  if (begin >= end)
+    return {};
+
+  // Cover [begin, end) with two possibly overlapping power of two ranges.
+  unsigned const level = llvm::Log2_32(end - begin);
+  const auto &ops = ranges.levels[level];
+  return ops[begin] | ops[end - (1u << level)];
+}
+
+void QubitFootprintAnalysis::eraseNested(Operation *op) {
+  op->walk([&](Operation *nestedOp) {
+    footprints.erase(nestedOp);
+    for (Region &region : nestedOp->getRegions())
+      for (Block &block : region)
+        blockRanges.erase(&block);
+  });
+}
+
+void QubitFootprintAnalysis::invalidateEnclosing(Block *block) {
+  while (block) {
+    blockRanges.erase(block);
+    Operation *parentOp = block->getParentOp();
+    if (!parentOp)
+      return;
+    footprints.erase(parentOp);
+    block = parentOp->getBlock();
+  }
+}
+
+void QubitFootprintAnalysis::notifyOperationMoved(Operation *op,
+                                                  Block *oldBlock) {
+  // Reordering a block leaves the footprints of the operations enclosing it
+  // unchanged.
+  if (op->getBlock() == oldBlock) {
+    blockRanges.erase(oldBlock);
+    return;
+  }
+  invalidateEnclosing(oldBlock);
+  invalidateEnclosing(op->getBlock());
+}
+
+void QubitFootprintAnalysis::Listener::notifyOperationInserted(
+    Operation *op) {
+  analysis.eraseNested(op);
+  analysis.invalidateEnclosing(op->getBlock());
+}
+
+void QubitFootprintAnalysis::Listener::notifyOperationModified(
+    Operation *op) {
+  analysis.eraseNested(op);
+  analysis.invalidateEnclosing(op->getBlock());
+}
+
+void QubitFootprintAnalysis::Listener::notifyOperationRemoved(
+    Operation *op) {
+  // The erased operations may be reallocated at the same addresses.
+  analysis.eraseNested(op);
+  analysis.invalidateEnclosing(op->getBlock());
+}
@@ -0,0 +1,63 @@
+//===- SymbolIndexAnalysis.cpp - Cached module symbol lookups ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the analysis which indexes the symbols of a module
+//
+//===----------------------------------------------------------------------===//
+
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
+
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cassert>
+
+using namespace mlir;
+using namespace mlir::quir;
+
+SymbolIndexAnalysis::SymbolIndexAnalysis(Operation *op) : root(op) {}
+
+Operation *SymbolIndexAnalysis::lookupSymbolIn(Operation *symbolTableOp,
+                                               llvm::StringRef name) {
+  return symbolTables.getSymbolTable(symbolTableOp).lookup(name);
+}
+
+Operation *SymbolIndexAnalysis::lookupSymbolIn(Operation *symbolTableOp,
+                                               SymbolRefAttr symbol) {
+  return symbolTables.lookupSymbolIn(symbolTableOp, symbol);
+}
+
+CircuitOp SymbolIndexAnalysis::getCircuitOp(CallCircuitOp callCircuitOp) {
+  auto circuitAttr = callCircuitOp->getAttrOfType<FlatSymbolRefAttr>("callee");
+  assert(circuitAttr && "Requires a 'callee' symbol reference attribute");
+
+  auto circuitOp =
+      lookupNearestSymbolFrom<CircuitOp>(callCircuitOp, circuitAttr);
+  assert(circuitOp && "matching circuit not found");
+  return circuitOp;
+}
+
+Operation *SymbolIndexAnalysis::getMainFunction() {
+  if (!mainFunc)
+    mainFunc = quir::getMainFunction(root);
+  return *mainFunc;
+}
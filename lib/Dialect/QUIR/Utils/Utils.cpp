@@ -36,6 +36,9 @@
 #include "mlir/Support/LLVM.h"
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
@@ -44,7 +47,6 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
-#include <set>
 #include <string>
 #include <sys/types.h>
 #include <tuple>
@@ -125,37 +127,66 @@ llvm::Expected<uint32_t> getNodeId(Operation *moduleOperation) {
 } // getNodeType
 
 // adds the qubit Ids on the physicalId or physicalIds attributes to theseIds
-void addQubitIdsFromAttr(Operation *operation, std::vector<uint> &theseIds) {
+bool addQubitIdsFromAttr(Operation *operation, std::vector<uint> &theseIds) {
   auto thisIdAttr = operation->getAttrOfType<IntegerAttr>(
       mlir::quir::getPhysicalIdAttrName());
   auto theseIdsAttr =
       operation->getAttrOfType<ArrayAttr>(mlir::quir::getPhysicalIdsAttrName());
-  if (thisIdAttr)
-    theseIds.push_back(thisIdAttr.getInt());
-  if (theseIdsAttr) {
-    for (Attribute const valAttr : theseIdsAttr) {
-      auto intAttr = valAttr.dyn_cast<IntegerAttr>();
-      theseIds.push_back(intAttr.getInt());
+  // the quantum decoration pass sets -1 for the qubits it cannot resolve
+  bool resolved = true;
+  auto addId = [&](IntegerAttr intAttr) {
+    if (!intAttr || intAttr.getInt() < 0) {
+      resolved = false;
+      return;
     }
-  }
+    theseIds.push_back(intAttr.getInt());
+  };
+  if (thisIdAttr)
+    addId(thisIdAttr);
+  if (theseIdsAttr)
+    for (Attribute const valAttr : theseIdsAttr)
+      addId(valAttr.dyn_cast<IntegerAttr>());
+  return resolved;
 } // addQubitIdsFromAttr
 
 // adds the qubit Ids on the physicalId or physicalIds attributes to theseIds
-void addQubitIdsFromAttr(Operation *operation, std::set<uint> &theseIds) {
+bool addQubitIdsFromAttr(Operation *operation, QubitSet &theseIds) {
   auto thisIdAttr = operation->getAttrOfType<IntegerAttr>(
       mlir::quir::getPhysicalIdAttrName());
   auto theseIdsAttr =
       operation->getAttrOfType<ArrayAttr>(mlir::quir::getPhysicalIdsAttrName());
-  if (thisIdAttr)
-    theseIds.emplace(thisIdAttr.getInt());
-  if (theseIdsAttr) {
-    for (Attribute const valAttr : theseIdsAttr) {
-      auto intAttr = valAttr.dyn_cast<IntegerAttr>();
-      theseIds.emplace(intAttr.getInt());
+  // the quantum decoration pass sets -1 for the qubits it cannot resolve
+  bool resolved = true;
+  auto addId = [&](IntegerAttr intAttr) {
+    if (!intAttr || intAttr.getInt() < 0) {
+      resolved = false;
+      return;
     }
-  }
+    theseIds.insert(intAttr.getInt());
+  };
+  if (thisIdAttr)
+    addId(thisIdAttr);
+  if (theseIdsAttr)
+    for (Attribute const valAttr : theseIdsAttr)
+      addId(valAttr.dyn_cast<IntegerAttr>());
+  return resolved;
 } // addQubitIdsFromAttr
 
+std::optional<QubitSet> getDecoratedQubits(Operation *operation) {
+  auto theseIdsAttr =
+      operation->getAttrOfType<ArrayAttr>(mlir::quir::getPhysicalIdsAttrName());
+  if (!theseIdsAttr)
+    return std::nullopt;
+  QubitSet theseIds;
+  for (Attribute const valAttr : theseIdsAttr) {
+    auto intAttr = valAttr.dyn_cast<IntegerAttr>();
+    if (!intAttr || intAttr.getInt() < 0)
+      return std::nullopt;
+    theseIds.insert(intAttr.getInt());
+  }
+  return theseIds;
+} // getDecoratedQubits
+
 // returns a vector of all of the classical arguments for a callOp
 template <class CallOpTy>
 void classicalCallOperands(CallOpTy &callOp, std::vector<Value> &vec) {
@@ -275,6 +306,30 @@ std::optional<Operation *> nextQuantumOpOrNull(Operation *op) {
   return std::nullopt;
 } // nextQuantumOpOrNull
 
+bool collectTransitiveUsers(Operation *op,
+                            llvm::SmallVectorImpl<Operation *> &users) {
+  Block *block = op->getBlock();
+  llvm::SmallPtrSet<Operation *, 16> visited;
+  llvm::SmallVector<Operation *> workList{op};
+  visited.insert(op);
+  users.clear();
+  while (!workList.empty()) {
+    Operation *curOp = workList.pop_back_val();
+    users.push_back(curOp);
+    for (Operation *user : curOp->getUsers()) {
+      Operation *ancestor = block->findAncestorOpInBlock(*user);
+      if (!ancestor)
+        return false;
+      if (visited.insert(ancestor).second)
+        workList.push_back(ancestor);
+    }
+  }
+  llvm::sort(users, [](Operation *lhs, Operation *rhs) {
+    return lhs->isBeforeInBlock(rhs);
+  });
+  return true;
+} // collectTransitiveUsers
+
 std::optional<Operation *> prevQuantumOpOrNull(Operation *op) {
   Operation *curOp = op;
   while (Operation *prevOp = curOp->getPrevNode()) {
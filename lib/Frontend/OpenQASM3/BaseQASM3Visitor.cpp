@@ -104,15 +104,19 @@ void BaseQASM3Visitor::setStatementList(ASTStatementList *list) {
 void BaseQASM3Visitor::walkAST() { visit(statementList); }
 
 void BaseQASM3Visitor::visit(const ASTStatementList *list) {
-  for (ASTStatement *i : *list) {
-    if (auto *declNode = dynamic_cast<ASTDeclarationNode *>(i)) {
-      visit(declNode);
-    } else if (auto *statementNode = dynamic_cast<ASTStatementNode *>(i)) {
-      visit(statementNode);
-    } else {
-      throw std::runtime_error("Could not cast ASTStatement to "
-                               "ASTDeclarationNode or ASTStatementNode.\n");
-    }
+  for (ASTStatement *i : *list)
+    visitStatement(i);
+}
+
+void BaseQASM3Visitor::visitStatement(ASTStatement *statement) {
+  if (auto *declNode = dynamic_cast<ASTDeclarationNode *>(statement)) {
+    visit(declNode);
+  } else if (auto *statementNode =
+                 dynamic_cast<ASTStatementNode *>(statement)) {
+    visit(statementNode);
+  } else {
+    throw std::runtime_error("Could not cast ASTStatement to "
+                             "ASTDeclarationNode or ASTStatementNode.\n");
   }
 }
 
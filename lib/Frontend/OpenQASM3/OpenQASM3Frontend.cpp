@@ -23,20 +23,28 @@
 #include "API/errors.h"
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIREnums.h"
+#include "Dialect/QUIR/Utils/DurationLexer.h"
+#include "Frontend/OpenQASM3/OpenQASM3ParserPool.h"
 #include "Frontend/OpenQASM3/PrintQASM3Visitor.h"
+#include "Frontend/OpenQASM3/QASMIncludeCache.h"
 #include "Frontend/OpenQASM3/QUIRGenQASM3Visitor.h"
 
 #include "mlir/Dialect/Complex/IR/Complex.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
 #include "mlir/IR/Verifier.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
-#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SMLoc.h"
@@ -45,7 +53,6 @@
 
 #include <cassert>
 #include <exception>
-#include <iostream>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -55,81 +62,70 @@
 #include <qasm/Frontend/QasmDiagnosticEmitter.h>
 #include <qasm/Frontend/QasmParser.h>
 #include <qasm/QPP/QasmPP.h>
-#include <regex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <sys/types.h>
 #include <utility>
+#include <vector>
 
 namespace {
 
-llvm::cl::OptionCategory openqasm3Cat(
-    " OpenQASM 3 Frontend Options",
-    "Options that control the OpenQASM 3 frontend of QSS Compiler");
-
-llvm::cl::opt<uint>
-    numShots("num-shots",
-             llvm::cl::desc("The number of shots to execute on the quantum "
-                            "circuit, default is 1000"),
-             llvm::cl::init(1000), llvm::cl::cat(openqasm3Cat));
-
-llvm::cl::opt<std::string> shotDelay(
-    "shot-delay",
-    llvm::cl::desc("Repetition delay between shots. Defaults to 1ms."),
-    llvm::cl::init("1ms"), llvm::cl::cat(openqasm3Cat));
-
-llvm::cl::list<std::string>
-    includeDirs("I", llvm::cl::desc("Add <dir> to the include path"),
-                llvm::cl::value_desc("dir"), llvm::cl::cat(openqasm3Cat));
-
 qssc::DiagnosticCallback *diagnosticCallback_;
 llvm::SourceMgr *sourceMgr_;
 
 std::mutex qasmParserLock;
-
-std::regex durationRe("^([0-9]*[.]?[0-9]+)([a-zA-Z]*)");
-
-llvm::Expected<std::pair<double, mlir::quir::TimeUnits>>
-parseDurationStr(const std::string &durationStr) {
-  std::smatch m;
-  std::regex_match(durationStr, m, durationRe);
-  if (m.size() != 3)
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        llvm::Twine("Unable to parse duration from ") + durationStr);
-
-  double const parsedDuration = std::stod(m[1]);
-  // Convert all units to lower case.
-  auto unitStr = m[2].str();
-  auto lowerUnitStr = llvm::StringRef(unitStr).lower();
-  if (lowerUnitStr == "")
-    // Empty case is SI
-    lowerUnitStr = "s";
-
-  if (auto parsedUnits = mlir::quir::symbolizeTimeUnits(lowerUnitStr))
-    return std::make_pair(parsedDuration, parsedUnits.value());
-
-  return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                 llvm::Twine("Unknown duration unit ") +
-                                     unitStr);
+// Include paths added to the preprocessor, which keeps them for the lifetime
+// of the process. Guarded by qasmParserLock.
+llvm::StringSet<> addedIncludeDirs;
+
+/// Replace the locations of the operations and block arguments of a module
+/// with the unknown location, so that the passes do not fuse and print them.
+void stripLocations_(mlir::ModuleOp module) {
+  auto unknownLoc = mlir::UnknownLoc::get(module.getContext());
+  module->walk([&](mlir::Operation *op) {
+    op->setLoc(unknownLoc);
+    for (auto &region : op->getRegions())
+      for (auto &block : region)
+        for (auto argument : block.getArguments())
+          argument.setLoc(unknownLoc);
+  });
 }
 
 } // anonymous namespace
 
 llvm::Error qssc::frontend::openqasm3::parse(
-    std::string const &source, bool sourceIsFilename, bool emitRawAST,
-    bool emitPrettyAST, bool emitMLIR, mlir::ModuleOp newModule,
+    const ParseOptions &options, llvm::StringRef source, bool sourceIsFilename,
+    bool emitRawAST, bool emitPrettyAST, bool emitMLIR,
+    mlir::ModuleOp newModule,
+    std::optional<qssc::DiagnosticCallback> diagnosticCallback,
+    mlir::TimingScope &timing, llvm::raw_ostream *astOstream) {
+
+  // Dumping the AST requires the AST of this process.
+  if (emitMLIR && !emitRawAST && !emitPrettyAST && hasParserWorkers())
+    return parseInWorker(options, source, sourceIsFilename, newModule,
+                         std::move(diagnosticCallback), timing);
+
+  return parseInProcess(options, source, sourceIsFilename, emitRawAST,
+                        emitPrettyAST, emitMLIR, newModule,
+                        std::move(diagnosticCallback), timing, astOstream);
+}
+
+llvm::Error qssc::frontend::openqasm3::parseInProcess(
+    const ParseOptions &options, llvm::StringRef source, bool sourceIsFilename,
+    bool emitRawAST, bool emitPrettyAST, bool emitMLIR,
+    mlir::ModuleOp newModule,
     std::optional<qssc::DiagnosticCallback> diagnosticCallback,
-    mlir::TimingScope &timing) {
+    mlir::TimingScope &timing, llvm::raw_ostream *astOstream) {
 
   mlir::TimingScope qasm3ParseTiming = timing.nest("parse-qasm3");
 
   // The QASM parser can only be called from a single thread.
-  std::lock_guard<std::mutex> const qasmParserLockGuard(qasmParserLock);
+  std::unique_lock<std::mutex> qasmParserLockGuard(qasmParserLock);
 
-  for (const auto &dirStr : includeDirs)
-    QASM::QasmPreprocessor::Instance().AddIncludePath(dirStr);
+  for (const auto &dirStr : options.includeDirs)
+    if (addedIncludeDirs.insert(dirStr).second)
+      QASM::QasmPreprocessor::Instance().AddIncludePath(dirStr);
 
   QASM::ASTParser parser;
   auto root = std::unique_ptr<QASM::ASTRoot>(nullptr);
@@ -216,7 +212,7 @@ llvm::Error qssc::frontend::openqasm3::parse(
 
   try {
     if (sourceIsFilename) {
-      QASM::QasmPreprocessor::Instance().SetTranslationUnit(source);
+      QASM::QasmPreprocessor::Instance().SetTranslationUnit(source.str());
 
       std::string errorMessage;
       auto file = mlir::openInputFile(source, &errorMessage);
@@ -226,15 +222,43 @@ llvm::Error qssc::frontend::openqasm3::parse(
                                        "Failed to open input file: " +
                                            errorMessage);
 
+      std::optional<std::string> expandedSource;
+      if (options.cacheIncludes) {
+        mlir::TimingScope expandTiming =
+            qasm3ParseTiming.nest("expand-includes");
+        auto expanded = QASMIncludeCache::instance().expandIncludes(
+            file->getBuffer(), options.includeDirs);
+        if (auto err = expanded.takeError())
+          return err;
+        expandedSource = std::move(*expanded);
+        expandTiming.stop();
+      }
+
       sourceMgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
 
-      root.reset(parser.ParseAST());
+      if (expandedSource)
+        root.reset(parser.ParseAST(*expandedSource));
+      else
+        root.reset(parser.ParseAST());
+
+    } else if (options.cacheIncludes) {
+      mlir::TimingScope expandTiming = qasm3ParseTiming.nest("expand-includes");
+      auto expanded = QASMIncludeCache::instance().expandIncludes(
+          source, options.includeDirs);
+      if (auto err = expanded.takeError())
+        return err;
+      expandTiming.stop();
 
+      auto sourceBuffer = llvm::MemoryBuffer::getMemBuffer(source, "", false);
+
+      sourceMgr.AddNewSourceBuffer(std::move(sourceBuffer), llvm::SMLoc());
+      root.reset(parser.ParseAST(*expanded));
     } else {
       auto sourceBuffer = llvm::MemoryBuffer::getMemBuffer(source, "", false);
 
       sourceMgr.AddNewSourceBuffer(std::move(sourceBuffer), llvm::SMLoc());
-      root.reset(parser.ParseAST(source));
+      // The parser only takes its input as a string.
+      root.reset(parser.ParseAST(source.str()));
     }
   } catch (std::exception &e) {
     return llvm::createStringError(
@@ -253,7 +277,8 @@ llvm::Error qssc::frontend::openqasm3::parse(
 
   if (emitPrettyAST) {
     auto *statementList = QASM::ASTStatementBuilder::Instance().List();
-    qssc::frontend::openqasm3::PrintQASM3Visitor visitor(std::cout);
+    qssc::frontend::openqasm3::PrintQASM3Visitor visitor(
+        astOstream ? *astOstream : llvm::outs());
 
     visitor.setStatementList(statementList);
     visitor.walkAST();
@@ -276,28 +301,66 @@ llvm::Error qssc::frontend::openqasm3::parse(
     qssc::frontend::openqasm3::QUIRGenQASM3Visitor visitor(builder, newModule,
                                                            /*filename=*/"");
 
-    auto result = parseDurationStr(shotDelay);
+    // Keep the gate libraries alive until their gates have been linked.
+    std::vector<mlir::OwningOpRef<mlir::ModuleOp>> libraries;
+    if (!options.gateLibraries.empty()) {
+      mlir::TimingScope loadLibrariesTiming =
+          qasm3ToMlirTiming.nest("load-gate-libraries");
+      mlir::ParserConfig const parserConfig(context);
+      for (const auto &libraryPath : options.gateLibraries) {
+        auto library =
+            mlir::parseSourceFile<mlir::ModuleOp>(libraryPath, parserConfig);
+        if (!library)
+          return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "Failed to load gate library " +
+                                             libraryPath);
+        visitor.addGateLibrary(library.get());
+        libraries.push_back(std::move(library));
+      }
+      loadLibrariesTiming.stop();
+    }
+
+    auto result = mlir::quir::lexDuration(options.shotDelay);
     if (auto err = result.takeError())
       return err;
 
     const auto [shotDelayValue, shotDelayUnits] = *result;
-    visitor.initialize(numShots, shotDelayValue, shotDelayUnits);
+    visitor.initialize(options.numShots, shotDelayValue, shotDelayUnits);
     visitor.setStatementList(statementList);
-    visitor.setInputFile(sourceIsFilename ? source : "-");
-
-    if (failed(visitor.walkAST()))
+    visitor.setInputFile(sourceIsFilename ? source.str() : "-");
+    visitor.setLineLocations(options.locations != LocationMode::Full);
+    if (options.dtTimestep)
+      visitor.setDtTimestep(*options.dtTimestep);
+
+    if (options.streaming) {
+      for (QASM::ASTStatement *statement : *statementList)
+        if (failed(visitor.walkStatement(statement)))
+          return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "Failed to emit QUIR");
+    } else if (failed(visitor.walkAST())) {
       return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                      "Failed to emit QUIR");
+    }
     // make sure to finish the in progress quir.circuit
     visitor.finishCircuit();
+
+    // The program no longer refers to the AST, so do not keep it and the
+    // parser while linking and verifying the program.
+    root.reset();
+    qasmParserLockGuard.unlock();
+    if (mlir::failed(visitor.linkGateLibraries()))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to link gate libraries");
     if (mlir::failed(mlir::verify(newModule))) {
       newModule.dump();
 
       return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                      "Failed to verify generated QUIR");
     }
+    if (options.locations == LocationMode::None)
+      stripLocations_(newModule);
     qasm3ToMlirTiming.stop();
   }
 
   return llvm::Error::success();
-} // parse
+} // parseInProcess
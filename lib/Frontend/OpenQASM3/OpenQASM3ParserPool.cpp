@@ -0,0 +1,497 @@
+//===- OpenQASM3ParserPool.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pool of OpenQASM 3 parser worker processes.
+///
+///  Each worker is connected to the compiler through a socket pair over which
+///  messages of a one byte kind, an eight byte length and the payload are
+///  exchanged. A request is a sequence of option and source messages closed by
+///  an end message. The worker answers with any number of diagnostic messages
+///  followed by either a module or an error message.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Frontend/OpenQASM3/OpenQASM3ParserPool.h"
+
+#include "API/errors.h"
+#include "Frontend/OpenQASM3/OpenQASM3Frontend.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace qssc::frontend::openqasm3;
+
+namespace {
+
+llvm::cl::OptionCategory parserWorkersCat(
+    " OpenQASM 3 Parser Worker Options",
+    "Options that control the OpenQASM 3 parser worker processes");
+
+llvm::cl::opt<unsigned> numParserWorkers(
+    "qasm-parser-workers",
+    llvm::cl::desc("Number of forked OpenQASM 3 parser worker processes used "
+                   "to parse programs concurrently. By default programs are "
+                   "parsed in-process one at a time."),
+    llvm::cl::init(0), llvm::cl::cat(parserWorkersCat));
+
+/// Kinds of the messages exchanged with a parser worker.
+enum class MessageKind : char {
+  // Requests
+  SourceFile = 'F',
+  SourceString = 'S',
+  NumShots = 'N',
+  ShotDelay = 'T',
+  IncludeDir = 'I',
+  CacheIncludes = 'C',
+  GateLibrary = 'L',
+  Streaming = 'R',
+  Locations = 'O',
+  DtTimestep = 'U',
+  End = 'E',
+  // Responses
+  Diagnostic = 'D',
+  Module = 'M',
+  Error = 'X',
+};
+
+struct Message {
+  MessageKind kind;
+  std::string payload;
+};
+
+bool writeAll_(int fd, const char *data, size_t size) {
+#ifdef MSG_NOSIGNAL
+  // A worker may have exited, which must not raise SIGPIPE in the compiler.
+  int const flags = MSG_NOSIGNAL;
+#else
+  int const flags = 0;
+#endif
+  while (size > 0) {
+    ssize_t const written = send(fd, data, size, flags);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool readAll_(int fd, char *data, size_t size) {
+  while (size > 0) {
+    ssize_t const numRead = read(fd, data, size);
+    if (numRead < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (numRead == 0)
+      return false;
+    data += numRead;
+    size -= static_cast<size_t>(numRead);
+  }
+  return true;
+}
+
+bool writeMessage_(int fd, MessageKind kind, llvm::StringRef payload) {
+  char const kindByte = static_cast<char>(kind);
+  uint64_t const size = payload.size();
+  return writeAll_(fd, &kindByte, sizeof(kindByte)) &&
+         writeAll_(fd, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+         writeAll_(fd, payload.data(), payload.size());
+}
+
+std::optional<Message> readMessage_(int fd) {
+  char kindByte;
+  uint64_t size;
+  if (!readAll_(fd, &kindByte, sizeof(kindByte)) ||
+      !readAll_(fd, reinterpret_cast<char *>(&size), sizeof(size)))
+    return std::nullopt;
+
+  Message message{static_cast<MessageKind>(kindByte), std::string(size, '\0')};
+  if (!readAll_(fd, message.payload.data(), size))
+    return std::nullopt;
+  return message;
+}
+
+std::string encodeDiagnostic_(const qssc::Diagnostic &diagnostic) {
+  return std::to_string(static_cast<int>(diagnostic.severity)) + "\n" +
+         std::to_string(static_cast<int>(diagnostic.category)) + "\n" +
+         diagnostic.message;
+}
+
+std::optional<qssc::Diagnostic> decodeDiagnostic_(llvm::StringRef encoded) {
+  auto [severityStr, rest] = encoded.split('\n');
+  auto [categoryStr, message] = rest.split('\n');
+  int severity;
+  int category;
+  if (severityStr.getAsInteger(10, severity) ||
+      categoryStr.getAsInteger(10, category))
+    return std::nullopt;
+  return qssc::Diagnostic(static_cast<qssc::Severity>(severity),
+                          static_cast<qssc::ErrorCategory>(category),
+                          message.str());
+}
+
+struct ParseRequest {
+  ParseOptions options;
+  std::string source;
+  bool sourceIsFilename = false;
+};
+
+/// Write a request to a worker. The source is written from the buffer of the
+/// caller rather than copied into a ParseRequest.
+bool writeRequest_(int fd, const ParseOptions &options, llvm::StringRef source,
+                   bool sourceIsFilename) {
+  if (!writeMessage_(fd,
+                     sourceIsFilename ? MessageKind::SourceFile
+                                      : MessageKind::SourceString,
+                     source) ||
+      !writeMessage_(fd, MessageKind::NumShots,
+                     std::to_string(options.numShots)) ||
+      !writeMessage_(fd, MessageKind::ShotDelay, options.shotDelay))
+    return false;
+  for (const auto &includeDir : options.includeDirs)
+    if (!writeMessage_(fd, MessageKind::IncludeDir, includeDir))
+      return false;
+  for (const auto &gateLibrary : options.gateLibraries)
+    if (!writeMessage_(fd, MessageKind::GateLibrary, gateLibrary))
+      return false;
+  if (options.cacheIncludes &&
+      !writeMessage_(fd, MessageKind::CacheIncludes, ""))
+    return false;
+  if (options.streaming && !writeMessage_(fd, MessageKind::Streaming, ""))
+    return false;
+  if (options.locations != LocationMode::Full &&
+      !writeMessage_(fd, MessageKind::Locations,
+                     options.locations == LocationMode::Lines ? "lines"
+                                                              : "none"))
+    return false;
+  if (options.dtTimestep) {
+    // hexadecimal floating point keeps every bit of the timestep
+    std::string dtTimestep;
+    llvm::raw_string_ostream(dtTimestep)
+        << llvm::format("%a", *options.dtTimestep);
+    if (!writeMessage_(fd, MessageKind::DtTimestep, dtTimestep))
+      return false;
+  }
+  return writeMessage_(fd, MessageKind::End, "");
+}
+
+std::optional<ParseRequest> readRequest_(int fd) {
+  ParseRequest request;
+  while (auto message = readMessage_(fd)) {
+    switch (message->kind) {
+    case MessageKind::SourceFile:
+    case MessageKind::SourceString:
+      request.sourceIsFilename = message->kind == MessageKind::SourceFile;
+      request.source = std::move(message->payload);
+      break;
+    case MessageKind::NumShots:
+      if (llvm::StringRef(message->payload)
+              .getAsInteger(10, request.options.numShots))
+        return std::nullopt;
+      break;
+    case MessageKind::ShotDelay:
+      request.options.shotDelay = std::move(message->payload);
+      break;
+    case MessageKind::IncludeDir:
+      request.options.includeDirs.push_back(std::move(message->payload));
+      break;
+    case MessageKind::GateLibrary:
+      request.options.gateLibraries.push_back(std::move(message->payload));
+      break;
+    case MessageKind::CacheIncludes:
+      request.options.cacheIncludes = true;
+      break;
+    case MessageKind::Streaming:
+      request.options.streaming = true;
+      break;
+    case MessageKind::Locations:
+      request.options.locations = message->payload == "lines"
+                                      ? LocationMode::Lines
+                                      : LocationMode::None;
+      break;
+    case MessageKind::DtTimestep: {
+      double dtTimestep = 0.;
+      if (llvm::StringRef(message->payload).getAsDouble(dtTimestep))
+        return std::nullopt;
+      request.options.dtTimestep = dtTimestep;
+      break;
+    }
+    case MessageKind::End:
+      return request;
+    default:
+      return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+/// Serve parse requests until the compiler closes its end of the socket.
+[[noreturn]] void runWorker_(int fd, const mlir::DialectRegistry &registry) {
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+
+  while (auto request = readRequest_(fd)) {
+    mlir::OwningOpRef<mlir::ModuleOp> module =
+        mlir::ModuleOp::create(mlir::UnknownLoc::get(&context));
+    qssc::DiagnosticCallback const forwardDiagnostic =
+        [fd](const qssc::Diagnostic &diagnostic) {
+          (void)writeMessage_(fd, MessageKind::Diagnostic,
+                              encodeDiagnostic_(diagnostic));
+        };
+
+    mlir::TimingScope timing;
+    auto err = parseInProcess(request->options, request->source,
+                              request->sourceIsFilename, /*emitRawAST=*/false,
+                              /*emitPrettyAST=*/false, /*emitMLIR=*/true,
+                              module.get(), forwardDiagnostic, timing);
+
+    bool sent;
+    if (err) {
+      sent = writeMessage_(fd, MessageKind::Error,
+                           llvm::toString(std::move(err)));
+    } else {
+      std::string bytecode;
+      llvm::raw_string_ostream bytecodeStream(bytecode);
+      if (mlir::failed(mlir::writeBytecodeToFile(*module, bytecodeStream)))
+        sent = writeMessage_(fd, MessageKind::Error,
+                             "Failed to serialize the generated QUIR");
+      else
+        sent = writeMessage_(fd, MessageKind::Module, bytecodeStream.str());
+    }
+    if (!sent)
+      break;
+  }
+
+  // Skip the exit handlers of the forked compiler state.
+  _exit(0);
+}
+
+struct ParserWorker {
+  pid_t pid;
+  int fd;
+};
+
+/// The parser workers of this process. Workers are handed out to a single
+/// parse at a time.
+class ParserWorkerPool {
+public:
+  ~ParserWorkerPool() {
+    // Closing the sockets ends the workers.
+    for (auto &worker : idleWorkers) {
+      close(worker.fd);
+      waitpid(worker.pid, nullptr, 0);
+    }
+  }
+
+  llvm::Error start(const mlir::DialectRegistry &registry,
+                    unsigned numWorkers) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    if (started)
+      return llvm::Error::success();
+    started = true;
+
+    for (unsigned i = 0; i < numWorkers; ++i) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return llvm::createStringError(
+            std::error_code(errno, std::generic_category()),
+            "Failed to create an OpenQASM 3 parser worker socket");
+
+#ifdef SO_NOSIGPIPE
+      int const noSigPipe = 1;
+      setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe,
+                 sizeof(noSigPipe));
+#endif
+
+      pid_t const pid = fork();
+      if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return llvm::createStringError(
+            std::error_code(errno, std::generic_category()),
+            "Failed to fork an OpenQASM 3 parser worker");
+      }
+
+      if (pid == 0) {
+        // Only keep this worker's end of its own socket.
+        close(fds[0]);
+        for (auto &worker : idleWorkers)
+          close(worker.fd);
+        runWorker_(fds[1], registry);
+      }
+
+      close(fds[1]);
+      idleWorkers.push_back({pid, fds[0]});
+      ++numLiveWorkers;
+    }
+
+    return llvm::Error::success();
+  }
+
+  bool hasWorkers() {
+    std::lock_guard<std::mutex> const lock(mutex);
+    return numLiveWorkers > 0;
+  }
+
+  /// Wait for an idle worker. Returns std::nullopt if there are no workers.
+  std::optional<ParserWorker> acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(
+        lock, [&]() { return !idleWorkers.empty() || numLiveWorkers == 0; });
+    if (idleWorkers.empty())
+      return std::nullopt;
+    auto worker = idleWorkers.back();
+    idleWorkers.pop_back();
+    return worker;
+  }
+
+  /// Return a worker to the pool, retiring it if it is no longer usable.
+  void release(ParserWorker worker, bool usable) {
+    {
+      std::lock_guard<std::mutex> const lock(mutex);
+      if (usable) {
+        idleWorkers.push_back(worker);
+      } else {
+        close(worker.fd);
+        waitpid(worker.pid, nullptr, 0);
+        --numLiveWorkers;
+      }
+    }
+    idleCondition.notify_all();
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable idleCondition;
+  std::vector<ParserWorker> idleWorkers;
+  size_t numLiveWorkers = 0;
+  bool started = false;
+};
+
+llvm::ManagedStatic<ParserWorkerPool> workerPool;
+
+} // anonymous namespace
+
+llvm::Error qssc::frontend::openqasm3::startParserWorkers(
+    const mlir::DialectRegistry &registry) {
+  return workerPool->start(registry, numParserWorkers);
+}
+
+bool qssc::frontend::openqasm3::hasParserWorkers() {
+  return workerPool->hasWorkers();
+}
+
+llvm::Error qssc::frontend::openqasm3::parseInWorker(
+    const ParseOptions &options, llvm::StringRef source, bool sourceIsFilename,
+    mlir::ModuleOp newModule,
+    std::optional<DiagnosticCallback> diagnosticCb,
+    mlir::TimingScope &timing) {
+
+  auto worker = workerPool->acquire();
+  if (!worker)
+    return parseInProcess(options, source, sourceIsFilename,
+                          /*emitRawAST=*/false, /*emitPrettyAST=*/false,
+                          /*emitMLIR=*/true, newModule, std::move(diagnosticCb),
+                          timing);
+
+  mlir::TimingScope qasm3ParseTiming = timing.nest("parse-qasm3-worker");
+
+  std::optional<std::string> bytecode;
+  std::optional<std::string> errorMessage;
+  bool usable = writeRequest_(worker->fd, options, source, sourceIsFilename);
+  while (usable && !bytecode && !errorMessage) {
+    auto message = readMessage_(worker->fd);
+    if (!message) {
+      usable = false;
+      break;
+    }
+
+    switch (message->kind) {
+    case MessageKind::Diagnostic:
+      if (auto diagnostic = decodeDiagnostic_(message->payload))
+        if (diagnosticCb)
+          (*diagnosticCb)(*diagnostic);
+      break;
+    case MessageKind::Module:
+      bytecode = std::move(message->payload);
+      break;
+    case MessageKind::Error:
+      errorMessage = std::move(message->payload);
+      break;
+    default:
+      usable = false;
+      break;
+    }
+  }
+  workerPool->release(*worker, usable);
+
+  if (errorMessage)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   *errorMessage);
+  if (!bytecode)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "OpenQASM 3 parser worker exited before delivering a result");
+
+  qasm3ParseTiming.stop();
+  mlir::TimingScope importTiming = timing.nest("import-qasm3-worker-mlir");
+
+  mlir::ParserConfig const parserConfig(newModule.getContext());
+  auto parsedModule = mlir::parseSourceString<mlir::ModuleOp>(
+      *bytecode, parserConfig, "qasm-parser-worker");
+  if (!parsedModule)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Failed to import the QUIR generated by an OpenQASM 3 parser worker");
+
+  for (auto attr : (*parsedModule)->getAttrs())
+    newModule->setAttr(attr.getName(), attr.getValue());
+  newModule.getBody()->getOperations().splice(
+      newModule.getBody()->end(), parsedModule->getBody()->getOperations());
+
+  return llvm::Error::success();
+}
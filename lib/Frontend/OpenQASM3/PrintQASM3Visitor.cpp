@@ -30,6 +30,7 @@
 
 #include "Frontend/OpenQASM3/BaseQASM3Visitor.h"
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -489,10 +490,11 @@ void PrintQASM3Visitor::visit(const ASTCBitNode *node) {
 
   const std::string &name = identifier->GetName();
   const unsigned bits = identifier->GetBits();
-  std::string value = node->AsString();
-
+  std::string const bitString = node->AsString();
+  // print the low bits in place rather than copying them out
+  llvm::StringRef value = bitString;
   if (bits < value.size())
-    value = value.substr(value.size() - bits);
+    value = value.take_back(bits);
   vStream << "CBitNode(name=" << name << ", bits=" << bits;
   if (node->IsSet(0))
     vStream << ", value=" << value;
@@ -592,24 +594,24 @@ void PrintQASM3Visitor::visit(const ASTFloatNode *node) {
 
 void PrintQASM3Visitor::visit(const ASTMPDecimalNode *node) {
   const unsigned bits = node->GetIdentifier()->GetBits();
-  std::string const val = node->GetValue();
   vStream << "MPDecimalNode(name=" << node->GetName();
   if (!node->IsNan())
-    vStream << ", value=" << val;
+    vStream << ", value=" << node->GetValue();
   vStream << ", bits=" << bits << ")";
 }
 
 void PrintQASM3Visitor::visit(const ASTMPComplexNode *node) {
   const std::string &name = node->GetName();
-  const std::string val = node->GetValue();
   const unsigned bits = node->GetIdentifier()->GetBits();
-  int const position = val.find(' ');
-  std::string const real = val.substr(1, position - 1);
-  std::string const imag =
-      val.substr(position + 1, val.length() - position - 2);
 
   vStream << "MPComplexNode(name=" << name;
   if (!node->IsNan()) {
+    std::string const value = node->GetValue();
+    llvm::StringRef const val = value;
+    size_t const position = val.find(' ');
+    llvm::StringRef const real = val.substr(1, position - 1);
+    llvm::StringRef const imag =
+        val.substr(position + 1, val.length() - position - 2);
     vStream << ", value=";
     vStream << real << " + " << imag << " im";
   }
@@ -617,11 +619,13 @@ void PrintQASM3Visitor::visit(const ASTMPComplexNode *node) {
 }
 
 void PrintQASM3Visitor::visit(const ASTAngleNode *node) {
-  std::string val = node->GetValue();
   const unsigned bits = node->GetBits();
+  vStream << "AngleNode(value=";
   if (node->IsNan())
-    val = "0.0";
-  vStream << "AngleNode(value=" << val << ", bits=" << bits << ")";
+    vStream << "0.0";
+  else
+    vStream << node->GetValue();
+  vStream << ", bits=" << bits << ")";
 }
 
 void PrintQASM3Visitor::visit(const ASTBoolNode *node) {
@@ -0,0 +1,258 @@
+//===- QASMIncludeCache.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the cache of preprocessed OpenQASM 3 include files.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Frontend/OpenQASM3/QASMIncludeCache.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace qssc::frontend::openqasm3;
+
+namespace {
+/// The standard gate library, which is provided by the parser.
+constexpr llvm::StringLiteral standardGateLibrary = "stdgates.inc";
+
+struct IncludeDirective {
+  /// Offsets of the directive in the including text.
+  size_t begin;
+  size_t end;
+  llvm::StringRef name;
+};
+
+bool isIdentifierChar_(char c) {
+  return llvm::isAlnum(c) || c == '_' || c == '$';
+}
+
+/// Find the end of the comment or string literal starting at pos, if any.
+std::optional<size_t> skipLiteral_(llvm::StringRef text, size_t pos) {
+  auto rest = text.drop_front(pos);
+  if (rest.startswith("//"))
+    return text.find('\n', pos);
+  if (rest.startswith("/*")) {
+    auto end = text.find("*/", pos + 2);
+    return end == llvm::StringRef::npos ? end : end + 2;
+  }
+  if (rest.startswith("\"")) {
+    auto end = text.find('"', pos + 1);
+    return end == llvm::StringRef::npos ? end : end + 1;
+  }
+  return std::nullopt;
+}
+
+/// Find the include directives of text outside of comments and strings.
+std::vector<IncludeDirective> findIncludes_(llvm::StringRef text) {
+  std::vector<IncludeDirective> includes;
+  constexpr llvm::StringLiteral whitespace = " \t\r\n";
+
+  size_t pos = 0;
+  while (pos < text.size()) {
+    if (auto end = skipLiteral_(text, pos)) {
+      pos = *end;
+      continue;
+    }
+    if (!isIdentifierChar_(text[pos])) {
+      ++pos;
+      continue;
+    }
+
+    size_t const begin = pos;
+    while (pos < text.size() && isIdentifierChar_(text[pos]))
+      ++pos;
+    if (text.slice(begin, pos) != "include")
+      continue;
+
+    // include "<name>";
+    size_t const nameBegin = text.find_first_not_of(whitespace, pos);
+    if (nameBegin == llvm::StringRef::npos || text[nameBegin] != '"')
+      continue;
+    size_t const nameEnd = text.find('"', nameBegin + 1);
+    if (nameEnd == llvm::StringRef::npos)
+      continue;
+    size_t const end = text.find_first_not_of(whitespace, nameEnd + 1);
+    if (end == llvm::StringRef::npos || text[end] != ';')
+      continue;
+
+    includes.push_back({begin, end + 1, text.slice(nameBegin + 1, nameEnd)});
+    pos = end + 1;
+  }
+  return includes;
+}
+
+/// Drop the comments and version statement of an included file and join its
+/// lines.
+std::string preprocess_(llvm::StringRef contents) {
+  std::string joined;
+  joined.reserve(contents.size());
+
+  size_t pos = 0;
+  while (pos < contents.size()) {
+    if (auto end = skipLiteral_(contents, pos)) {
+      if (contents[pos] == '"')
+        joined += contents.slice(pos, *end);
+      else
+        joined += ' ';
+      pos = *end;
+      continue;
+    }
+    char const c = contents[pos++];
+    joined += (c == '\n' || c == '\r') ? ' ' : c;
+  }
+
+  llvm::StringRef text = llvm::StringRef(joined).ltrim();
+  if (text.startswith("OPENQASM") &&
+      (text.size() == 8 || !isIdentifierChar_(text[8])))
+    text = text.drop_front(std::min(text.find(';'), text.size() - 1) + 1);
+  return text.str();
+}
+
+/// Resolve an include against the include directories and then the working
+/// directory.
+std::optional<std::string>
+resolveInclude_(llvm::StringRef name, llvm::ArrayRef<std::string> includeDirs) {
+  auto canonical = [](llvm::StringRef path) -> std::string {
+    llvm::SmallString<128> realPath;
+    if (llvm::sys::fs::real_path(path, realPath))
+      return path.str();
+    return std::string(realPath);
+  };
+
+  if (!llvm::sys::path::is_absolute(name)) {
+    for (const auto &dir : includeDirs) {
+      llvm::SmallString<128> path(dir);
+      llvm::sys::path::append(path, name);
+      if (llvm::sys::fs::is_regular_file(path))
+        return canonical(path);
+    }
+  }
+  if (llvm::sys::fs::is_regular_file(name))
+    return canonical(name);
+  return std::nullopt;
+}
+} // anonymous namespace
+
+QASMIncludeCache &QASMIncludeCache::instance() {
+  static QASMIncludeCache cache;
+  return cache;
+}
+
+llvm::Expected<std::string>
+QASMIncludeCache::expandIncludes(llvm::StringRef source,
+                                 llvm::ArrayRef<std::string> includeDirs) {
+  std::string expanded;
+  expanded.reserve(source.size());
+  std::vector<std::string> includeStack;
+  if (auto err = expandIncludes_(source, includeDirs, includeStack, expanded))
+    return std::move(err);
+  return expanded;
+}
+
+void QASMIncludeCache::clear() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+}
+
+llvm::Error
+QASMIncludeCache::expandIncludes_(llvm::StringRef text,
+                                  llvm::ArrayRef<std::string> includeDirs,
+                                  std::vector<std::string> &includeStack,
+                                  std::string &expanded) {
+  size_t last = 0;
+  for (const auto &include : findIncludes_(text)) {
+    if (include.name == standardGateLibrary)
+      continue;
+    auto path = resolveInclude_(include.name, includeDirs);
+    if (!path)
+      continue;
+    if (llvm::is_contained(includeStack, *path))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Cyclic include of " + *path);
+
+    auto entry = getEntry_(*path);
+    if (!entry)
+      return entry.takeError();
+
+    expanded += text.slice(last, include.begin);
+    includeStack.push_back(*path);
+    if (auto err = expandIncludes_((*entry)->preprocessed, includeDirs,
+                                   includeStack, expanded))
+      return err;
+    includeStack.pop_back();
+    // Keep the lines of the including text.
+    expanded.append(text.slice(include.begin, include.end).count('\n'), '\n');
+    last = include.end;
+  }
+  expanded += text.drop_front(last);
+  return llvm::Error::success();
+}
+
+auto QASMIncludeCache::getEntry_(llvm::StringRef path)
+    -> llvm::Expected<std::shared_ptr<const Entry>> {
+  llvm::sys::fs::file_status status;
+  if (auto ec = llvm::sys::fs::status(path, status))
+    return llvm::createStringError(ec, "Unable to stat include file " + path);
+
+  std::shared_ptr<const Entry> cached;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto pos = entries.find(path);
+    if (pos != entries.end()) {
+      cached = pos->second;
+      if (cached->modificationTime == status.getLastModificationTime() &&
+          cached->size == status.getSize())
+        return cached;
+    }
+  }
+
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (!buffer)
+    return llvm::createStringError(buffer.getError(),
+                                   "Unable to read include file " + path);
+  auto contents = (*buffer)->getBuffer();
+
+  auto entry = std::make_shared<Entry>();
+  entry->modificationTime = status.getLastModificationTime();
+  entry->size = status.getSize();
+  entry->hash = llvm::SHA256::hash(llvm::arrayRefFromStringRef(contents));
+  // Files which were merely touched need not be preprocessed again.
+  if (cached && cached->hash == entry->hash)
+    entry->preprocessed = cached->preprocessed;
+  else
+    entry->preprocessed = preprocess_(contents);
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  entries[path] = entry;
+  return entry;
+}
@@ -68,9 +68,13 @@
 #include "mlir/Support/LogicalResult.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -113,7 +117,6 @@
 #include <stdexcept>
 #include <string>
 #include <sys/types.h>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -148,30 +151,31 @@ llvm::cl::opt<bool> debugCircuits("debug-circuits",
 
 auto QUIRGenQASM3Visitor::getLocation(const ASTBase *node) -> Location {
   return mlir::FileLineColLoc::get(builder.getContext(), filename,
-                                   node->GetLineNo(), node->GetColNo());
+                                   node->GetLineNo(),
+                                   lineLocations ? 0 : node->GetColNo());
 }
 
-auto QUIRGenQASM3Visitor::assign(Value &val, const std::string &valName)
+auto QUIRGenQASM3Visitor::assign(Value &val, llvm::StringRef valName)
     -> bool {
-  if (ssaValues.find(valName) != ssaValues.end()) {
-    val = ssaValues[valName];
+  if (auto value = ssaValues.lookup(valName)) {
+    val = *value;
     return true;
   }
   return false;
 }
 
-mlir::Value QUIRGenQASM3Visitor::getCurrentValue(const std::string &valueName) {
+mlir::Value QUIRGenQASM3Visitor::getCurrentValue(llvm::StringRef valueName) {
 
-  auto pos = ssaValues.find(valueName);
-  if (pos == ssaValues.end()) {
+  auto value = ssaValues.lookup(valueName);
+  if (!value) {
     llvm::errs() << "Missing SSA assignment for " << valueName << "\n";
     newModule.dump();
     llvm::report_fatal_error("Missing SSA assignment");
   }
-  return pos->second;
+  return *value;
 }
 
-llvm::Expected<std::string>
+llvm::Expected<llvm::StringRef>
 QUIRGenQASM3Visitor::getExpressionName(const ASTExpressionNode *node) {
 
   if (const auto *refNode =
@@ -181,8 +185,8 @@ QUIRGenQASM3Visitor::getExpressionName(const ASTExpressionNode *node) {
     unsigned const bits = intNode->GetBits();
     int64_t const value = intNode->IsSigned() ? intNode->GetSignedValue()
                                               : intNode->GetUnsignedValue();
-    return intNode->GetName() + std::to_string(value) + "_i" +
-           std::to_string(bits);
+    return names.save(llvm::Twine(intNode->GetName()) + llvm::Twine(value) +
+                      "_i" + llvm::Twine(bits));
   }
   if (const auto *idNode =
           dynamic_cast<const ASTIdentifierNode *>(node->GetExpression()))
@@ -247,17 +251,26 @@ auto QUIRGenQASM3Visitor::createDurationRef(const Location &location,
                                             const LengthUnit &durationUnit)
     -> Value {
   auto ssa = circuitParentBuilder.create<quir::ConstantOp>(
-      location, DurationAttr::get(builder.getContext(),
-                                  builder.getType<DurationType>(
-                                      getDurationTimeUnits(durationUnit)),
-                                  /* cast to int first to address ambiguity in
-                                     uint cast across platforms */
-                                  llvm::APFloat(static_cast<double>(
-                                      static_cast<int64_t>(durationValue)))));
+      location, getDurationAttr(
+                    /* cast to int first to address ambiguity in uint cast
+                       across platforms */
+                    static_cast<double>(static_cast<int64_t>(durationValue)),
+                    getDurationTimeUnits(durationUnit)));
   ssaOtherValues.push_back(ssa);
   return ssa;
 }
 
+auto QUIRGenQASM3Visitor::getDurationAttr(double value, TimeUnits units)
+    -> DurationAttr {
+  auto duration =
+      DurationAttr::get(builder.getContext(),
+                        builder.getType<DurationType>(units),
+                        llvm::APFloat(value));
+  if (dtTimestep && units != TimeUnits::dt)
+    return duration.getConvertedDurationAttr(TimeUnits::dt, *dtTimestep);
+  return duration;
+}
+
 void QUIRGenQASM3Visitor::initialize(
     uint numShots, const double &shotDelay,
     const mlir::quir::TimeUnits &shotDelayUnits) {
@@ -305,10 +318,7 @@ void QUIRGenQASM3Visitor::initialize(
     builder.setInsertionPointToStart(&forOp.getRegion().front());
     // Add the shot delay to all qubits
     auto duration = builder.create<quir::ConstantOp>(
-        initialLocation,
-        DurationAttr::get(builder.getContext(),
-                          builder.getType<DurationType>(shotDelayUnits),
-                          llvm::APFloat(shotDelay)));
+        initialLocation, getDurationAttr(shotDelay, shotDelayUnits));
     builder.create<DelayOp>(initialLocation, duration, ValueRange({}));
   }
   // init shots even when there's no loop, so we always get a sync_trigger
@@ -341,6 +351,96 @@ mlir::LogicalResult QUIRGenQASM3Visitor::walkAST() {
   return hasFailed ? mlir::failure() : mlir::success();
 }
 
+mlir::LogicalResult
+QUIRGenQASM3Visitor::walkStatement(QASM::ASTStatement *statement) {
+  visitStatement(statement);
+  return hasFailed ? mlir::failure() : mlir::success();
+}
+
+void QUIRGenQASM3Visitor::addGateLibrary(mlir::ModuleOp library) {
+  gateLibraries.emplace_back(library);
+}
+
+mlir::func::FuncOp
+QUIRGenQASM3Visitor::lookupLibraryGate(llvm::StringRef name,
+                                       mlir::FunctionType type) {
+  for (auto &library : gateLibraries)
+    if (auto gate = library.lookup<mlir::func::FuncOp>(name))
+      if (!gate.isExternal() && gate.getFunctionType() == type)
+        return gate;
+  return nullptr;
+}
+
+mlir::LogicalResult QUIRGenQASM3Visitor::linkGateLibraries() {
+  if (libraryGates.empty())
+    return mlir::success();
+
+  mlir::SymbolTable symbolTable(newModule);
+  OpBuilder linkBuilder = OpBuilder::atBlockBegin(newModule.getBody());
+  // Library symbols by the name of their copy in the module
+  llvm::DenseMap<mlir::Operation *, mlir::StringAttr> linked;
+  // Copies whose references into their library remain to be resolved
+  SmallVector<std::pair<mlir::Operation *, mlir::SymbolTable *>> worklist;
+
+  // Only the declared gates which are used are linked.
+  llvm::StringSet<> used;
+  if (auto uses = SymbolTable::getSymbolUses(newModule.getOperation()))
+    for (const auto &use : *uses)
+      used.insert(use.getSymbolRef().getRootReference().getValue());
+
+  for (const auto &entry : libraryGates) {
+    if (!used.contains(entry.getKey()))
+      continue;
+    if (symbolTable.lookup(entry.getKey()))
+      return newModule.emitError()
+             << "library definition of gate " << entry.getKey()
+             << " conflicts with a symbol of the program";
+
+    auto gate = entry.getValue();
+    auto library = llvm::find_if(gateLibraries, [&](const auto &table) {
+      return table.getOp() == gate->getParentOp();
+    });
+    assert(library != gateLibraries.end() && "gate of an unknown library");
+    auto *copy = linkBuilder.clone(*gate);
+    linked[gate] = symbolTable.insert(copy);
+    worklist.emplace_back(copy, &*library);
+  }
+
+  while (!worklist.empty()) {
+    auto [copy, library] = worklist.pop_back_val();
+    auto uses = SymbolTable::getSymbolUses(copy);
+    if (!uses)
+      continue;
+
+    llvm::SmallDenseSet<mlir::StringAttr> resolved;
+    SmallVector<std::pair<mlir::StringAttr, mlir::StringAttr>> renamed;
+    for (const auto &use : *uses) {
+      auto name = use.getSymbolRef().getRootReference();
+      if (!resolved.insert(name).second)
+        continue;
+      auto *symbol = library->lookup(name);
+      if (!symbol)
+        continue;
+
+      auto pos = linked.find(symbol);
+      if (pos == linked.end()) {
+        // Symbols colliding with those of the program are renamed.
+        auto *symbolCopy = linkBuilder.clone(*symbol);
+        pos = linked.try_emplace(symbol, symbolTable.insert(symbolCopy)).first;
+        worklist.emplace_back(symbolCopy, library);
+      }
+      if (pos->second != name)
+        renamed.emplace_back(name, pos->second);
+    }
+
+    for (auto [from, to] : renamed)
+      if (failed(SymbolTable::replaceAllSymbolUses(from, to, copy)))
+        return copy->emitError() << "failed to rename linked symbol " << from;
+  }
+
+  return mlir::success();
+}
+
 mlir::InFlightDiagnostic
 QUIRGenQASM3Visitor::reportError(ASTBase const *location,
                                  mlir::DiagnosticSeverity severity) {
@@ -349,7 +449,10 @@ QUIRGenQASM3Visitor::reportError(ASTBase const *location,
 
   if (severity == mlir::DiagnosticSeverity::Error)
     hasFailed = true;
-  return engine.emit(getLocation(location), severity);
+  return engine.emit(mlir::FileLineColLoc::get(builder.getContext(), filename,
+                                               location->GetLineNo(),
+                                               location->GetColNo()),
+                     severity);
 }
 
 void QUIRGenQASM3Visitor::visit(const ASTForStatementNode *node) {
@@ -396,12 +499,10 @@ void QUIRGenQASM3Visitor::visit(const ASTForStatementNode *node) {
   // Adding induction variable to SSA values map
   const ASTIntNode *indVar = loop->GetIndVar();
   Value const forOpIndVar = forOp.getInductionVar();
-  ssaValues[indVar->GetName()] = forOpIndVar;
+  ssaValues.assign(indVar->GetName(), forOpIndVar);
 
-  // Dictionary of SSA values used inside "for"
-  std::unordered_map<std::string, mlir::Value> forSsaValues = ssaValues;
-  // Save previous SSA values so we can restore them outside the for scope
-  std::swap(ssaValues, forSsaValues);
+  // SSA values assigned inside "for" are restored outside the for scope
+  ssaValues.pushScope();
 
   // set up the builders to point to the proper places
   OpBuilder const b(&forOp.getRegion());
@@ -419,7 +520,7 @@ void QUIRGenQASM3Visitor::visit(const ASTForStatementNode *node) {
   // Set the builder to add the next operations after the for loop.
   builder.setInsertionPointAfter(forOp);
   circuitParentBuilder.setInsertionPointAfter(forOp);
-  std::swap(ssaValues, forSsaValues);
+  ssaValues.popScope();
 }
 
 void QUIRGenQASM3Visitor::visit(const ASTForLoopNode *node) {
@@ -457,10 +558,8 @@ void QUIRGenQASM3Visitor::visit(const ASTIfStatementNode *node) {
   // Save current level OpBuilder
   OpBuilder const prevBuilder = builder;
 
-  // Dictionary of SSA values used inside "if"
-  std::unordered_map<std::string, mlir::Value> ifSsaValues = ssaValues;
-  // Save previous SSA values so we can restore them outside the if scope
-  std::swap(ssaValues, ifSsaValues);
+  // SSA values assigned inside "if" are restored outside the if scope
+  ssaValues.pushScope();
 
   // New OpBuilder for the if statement Region
   OpBuilder const ifRegionBuilder(ifOp.getThenRegion());
@@ -482,14 +581,12 @@ void QUIRGenQASM3Visitor::visit(const ASTIfStatementNode *node) {
 
   builder = prevBuilder;
   circuitParentBuilder = builder;
-  std::swap(ssaValues, ifSsaValues);
+  ssaValues.popScope();
 
   // Else
   if (hasElse) {
-    // Dictionary of SSA values used inside "else"
-    std::unordered_map<std::string, mlir::Value> elseSsaValues = ssaValues;
-    // Save previous SSA values so we can restore them outside the else scope
-    std::swap(ssaValues, elseSsaValues);
+    // SSA values assigned inside "else" are restored outside the else scope
+    ssaValues.pushScope();
 
     // Save current level OpBuilder
     OpBuilder const elseBuilder = builder;
@@ -512,7 +609,7 @@ void QUIRGenQASM3Visitor::visit(const ASTIfStatementNode *node) {
 
     builder = elseBuilder;
     circuitParentBuilder = builder;
-    std::swap(ssaValues, elseSsaValues);
+    ssaValues.popScope();
   }
 }
 
@@ -730,33 +827,38 @@ void QUIRGenQASM3Visitor::visit(const ASTGateDeclarationNode *node) {
     inputs[i + numQubits] = builder.getType<AngleType>(bits);
   }
   auto inputsRef = ArrayRef<Type>(inputs.data(), inputs.size());
+  auto gateType = builder.getFunctionType(
+      /*inputs=*/inputsRef,
+      /*results=*/ArrayRef<Type>());
+
+  // Gates defined by a library are linked once the program has been walked.
+  if (auto libraryGate = lookupLibraryGate(gateNode->GetName(), gateType)) {
+    libraryGates[gateNode->GetName()] = libraryGate;
+    return;
+  }
 
   auto func = topLevelBuilder.create<mlir::func::FuncOp>(
-      getLocation(node), gateNode->GetName(),
-      builder.getFunctionType(
-          /*inputs=*/inputsRef,
-          /*results=*/ArrayRef<Type>()));
+      getLocation(node), gateNode->GetName(), gateType);
   func.addEntryBlock();
 
-  // TODO this wants to be a symbol table that now enters a new scope
-  // Store argument Values so we can reference them within this gate
-  std::unordered_map<std::string, mlir::Value> gateSsaValues;
+  // The gate only sees its arguments, store their Values so we can reference
+  // them within this gate
+  ssaValues.pushIsolatedScope();
   unsigned i = 0;
   MutableArrayRef<BlockArgument> const arguments =
       func.getBody().getArguments();
   for (BlockArgument *arg = arguments.begin(); arg < arguments.end(); arg++) {
     if (i < numQubits) {
-      gateSsaValues[gateNode->GetQubit(i)->GetGateQubitName()] = *arg;
+      ssaValues.assign(gateNode->GetQubit(i)->GetGateQubitName(), *arg);
     } else {
-      gateSsaValues[gateNode->GetParam(i - numQubits)->GetGateParamName()] =
-          *arg;
+      ssaValues.assign(gateNode->GetParam(i - numQubits)->GetGateParamName(),
+                       *arg);
     }
     i++;
   }
 
-  // Save the current builder, temporarily swap the available Values
+  // Save the current builder
   OpBuilder const prevBuilder = builder;
-  std::swap(ssaValues, gateSsaValues);
 
   // New OpBuilder for the gate declaration Region
   OpBuilder const gateDeclarationBuilder(func.getBody());
@@ -775,7 +877,7 @@ void QUIRGenQASM3Visitor::visit(const ASTGateDeclarationNode *node) {
   // Restore SSA Values and OpBuilder as we exit the function
   builder = prevBuilder;
   circuitParentBuilder = builder;
-  std::swap(ssaValues, gateSsaValues);
+  ssaValues.popScope();
 }
 
 void QUIRGenQASM3Visitor::visit(const ASTGenericGateOpNode *node) {
@@ -783,7 +885,7 @@ void QUIRGenQASM3Visitor::visit(const ASTGenericGateOpNode *node) {
   visit(gateNode);
 }
 
-llvm::Expected<std::string>
+llvm::Expected<llvm::StringRef>
 QUIRGenQASM3Visitor::resolveQCParam(const ASTGateNode *gateNode,
                                     unsigned int index) {
   auto *qcParam = gateNode->GetQCParams()[index];
@@ -1272,7 +1374,7 @@ QUIRGenQASM3Visitor::visit_(const ASTQubitContainerNode *node) {
                            getLocation(node), builder.getType<QubitType>(size),
                            builder.getIntegerAttr(builder.getI32Type(), id))
                        .getRes();
-  ssaValues[qId] = qubitRef;
+  ssaValues.assign(qId, qubitRef);
   return qubitRef;
 }
 
@@ -1343,7 +1445,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTDurationNode *node) {
   switchCircuit(true, getLocation(node));
   // TODO this node may refer to an identifier, not just the encoded value. Fix
   // when replacing the use of ssaValues.
-  if (ssaValues.find(node->GetName()) != ssaValues.end()) {
+  if (ssaValues.contains(node->GetName())) {
     reportError(node, mlir::DiagnosticSeverity::Error)
         << "ASTDurationNode referring to a previously declared duration is not "
         << "supported yet.";
@@ -1352,7 +1454,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTDurationNode *node) {
   const auto durationRef = createDurationRef(
       getLocation(node), node->GetDuration(), node->GetLengthUnit());
 
-  ssaValues[node->GetName()] = durationRef;
+  ssaValues.assign(node->GetName(), durationRef);
   return durationRef;
 }
 
@@ -1370,7 +1472,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTStretchNode *node) {
 
   const Value stretchRef = builder.create<DeclareStretchOp>(
       getLocation(node), builder.getType<StretchType>());
-  ssaValues[node->GetName()] = stretchRef;
+  ssaValues.assign(node->GetName(), stretchRef);
   return stretchRef;
 }
 
@@ -1389,7 +1491,7 @@ QUIRGenQASM3Visitor::visit_(const ASTIdentifierRefNode *node) {
       // single cbit out of a cbit register
       auto cbit = varHandler.generateVariableUse(getLocation(node),
                                                  variableName, symTableEntry);
-      return builder.create<oq3::CBitExtractBitOp>(
+      return builder.createOrFold<oq3::CBitExtractBitOp>(
           getLocation(node), builder.getI1Type(), cbit,
           builder.getIndexAttr(node->GetIndex()));
     }
@@ -1407,7 +1509,7 @@ QUIRGenQASM3Visitor::visit_(const ASTIdentifierRefNode *node) {
 
   Value loadOpRef =
       builder.create<mlir::memref::LoadOp>(getLocation(node), memRef, indexRef);
-  ssaValues[node->GetName()] = loadOpRef;
+  ssaValues.assign(node->GetName(), loadOpRef);
   return loadOpRef;
 }
 
@@ -1440,13 +1542,13 @@ QUIRGenQASM3Visitor::handleAssign(const ASTBinaryOpNode *node) {
   }
   Value const rightRef = rightRefOrError.get();
 
-  llvm::Expected<std::string> leftNameOrError = getExpressionName(left);
+  llvm::Expected<llvm::StringRef> leftNameOrError = getExpressionName(left);
   if (!leftNameOrError) {
     assert(hasFailed && "getExpressionName returned an error but did not set "
                         "the state to failed.");
     return createVoidValue(node);
   }
-  std::string const leftName = leftNameOrError.get();
+  llvm::StringRef const leftName = leftNameOrError.get();
 
   if (left->GetASTType() != ASTTypeIdentifier) {
     reportError(node, mlir::DiagnosticSeverity::Error)
@@ -1485,7 +1587,7 @@ QUIRGenQASM3Visitor::handleAssign(const ASTBinaryOpNode *node) {
       opRef = builder.create<CastOp>(getLocation(left), leftRef.getType(),
                                      rightRef);
     }
-    ssaValues[left->GetIdentifier()->GetName()] = opRef;
+    ssaValues.assign(left->GetIdentifier()->GetName(), opRef);
     return opRef;
   }
 
@@ -1672,11 +1774,11 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTBinaryOpNode *node) {
 
   switch (node->GetOpType()) {
   case ASTOpTypeLogicalOr:
-    opRef = builder.create<mlir::arith::OrIOp>(loc, leftRef, rightRef);
+    opRef = builder.createOrFold<mlir::arith::OrIOp>(loc, leftRef, rightRef);
     break;
 
   case ASTOpTypeLogicalAnd:
-    opRef = builder.create<mlir::arith::AndIOp>(loc, leftRef, rightRef);
+    opRef = builder.createOrFold<mlir::arith::AndIOp>(loc, leftRef, rightRef);
     break;
 
   case ASTOpTypeBitAnd:
@@ -1700,7 +1802,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTBinaryOpNode *node) {
   case ASTOpTypeLE:
   case ASTOpTypeGT:
   case ASTOpTypeGE:
-    opRef = builder.create<mlir::arith::CmpIOp>(
+    opRef = builder.createOrFold<mlir::arith::CmpIOp>(
         loc, getComparisonPredicate(node->GetOpType()), leftRef, rightRef);
     break;
 
@@ -1711,6 +1813,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTBinaryOpNode *node) {
     return createVoidValue(node);
   }
 
+  eraseFoldedConstants({leftRef, rightRef});
   return opRef;
 }
 
@@ -1819,8 +1922,10 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTUnaryOpNode *node) {
     auto constantTrue =
         builder.create<mlir::arith::ConstantOp>(loc, builder.getBoolAttr(true));
 
-    return builder.create<mlir::arith::CmpIOp>(loc, CmpIPredicate::ne,
-                                               targetValue, constantTrue);
+    Value const notRef = builder.createOrFold<mlir::arith::CmpIOp>(
+        loc, CmpIPredicate::ne, targetValue, constantTrue);
+    eraseFoldedConstants({targetValue, constantTrue});
+    return notRef;
   }
 
   default:
@@ -1880,13 +1985,13 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTMPIntegerNode *node) {
                                           node->GetIdentifier());
   }
 
-  llvm::Expected<std::string> nameOrError = getExpressionName(node);
+  llvm::Expected<llvm::StringRef> nameOrError = getExpressionName(node);
   if (!nameOrError) {
     assert(hasFailed && "getExpressionName returned an error but did not set "
                         "the state to failed.");
     return createVoidValue(node);
   }
-  std::string const name = nameOrError.get();
+  llvm::StringRef const name = nameOrError.get();
 
   const unsigned bits = node->GetBits();
   bool const isSigned = node->IsSigned();
@@ -1976,7 +2081,7 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTMPDecimalNode *node) {
   switchCircuit(false, getLocation(node));
   // TODO this node may refer to an identifier, not just the encoded value. Fix
   // when replacing the use of ssaValues.
-  if (ssaValues.find(node->GetName()) != ssaValues.end()) {
+  if (ssaValues.contains(node->GetName())) {
     reportError(node, mlir::DiagnosticSeverity::Error)
         << "ASTMPDecimalNode referring to a previously declared duration is "
         << "not supported yet.";
@@ -1990,15 +2095,15 @@ ExpressionValueType QUIRGenQASM3Visitor::visit_(const ASTMPComplexNode *node) {
   switchCircuit(false, getLocation(node));
   // TODO this node may refer to an identifier, not just the encoded value. Fix
   // when replacing the use of ssaValues.
-  llvm::Expected<std::string> nameOrError = getExpressionName(node);
+  llvm::Expected<llvm::StringRef> nameOrError = getExpressionName(node);
   if (!nameOrError) {
     assert(hasFailed && "getExpressionName returned an error but did not set "
                         "the state to failed.");
     return createVoidValue(node);
   }
-  std::string const name = nameOrError.get();
+  llvm::StringRef const name = nameOrError.get();
 
-  if (ssaValues.find(name) != ssaValues.end()) {
+  if (ssaValues.contains(name)) {
     reportError(node, mlir::DiagnosticSeverity::Error)
         << "ASTMPComplexNode referring to a previously declared duration is "
         << "not supported yet.";
@@ -2112,7 +2217,7 @@ QUIRGenQASM3Visitor::visit_(const ASTCastExpressionNode *node) {
 
   Value opRef = builder.create<CastOp>(
       getLocation(node), getCastDestinationType(node, builder), operandRef);
-  ssaValues[node->GetIdentifier()->GetName()] = opRef;
+  ssaValues.assign(node->GetIdentifier()->GetName(), opRef);
   return opRef;
 }
 
@@ -2125,6 +2230,20 @@ mlir::Value QUIRGenQASM3Visitor::createVoidValue(QASM::ASTBase const *node) {
   return createVoidValue(getLocation(node));
 }
 
+void QUIRGenQASM3Visitor::eraseFoldedConstants(mlir::ValueRange operands) {
+  // Constants an identifier refers to are still needed for later references.
+  llvm::SmallPtrSet<mlir::Operation *, 2> unusedConstants;
+  for (Value const operand : operands)
+    if (auto constantOp = operand.getDefiningOp<mlir::arith::ConstantOp>())
+      if (constantOp->use_empty() && !ssaValues.references(operand))
+        unusedConstants.insert(constantOp);
+
+  for (auto *constantOp : unusedConstants) {
+    llvm::erase_value(ssaOtherValues, constantOp->getResult(0));
+    constantOp->erase();
+  }
+}
+
 void QUIRGenQASM3Visitor::startCircuit(mlir::Location location) {
 
   if (!enableCircuits)
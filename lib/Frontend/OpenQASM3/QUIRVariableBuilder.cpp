@@ -67,16 +67,17 @@ void QUIRVariableBuilder::generateVariableDeclaration(
   auto declareOp = builder.create<mlir::oq3::DeclareVariableOp>(
       location, variableName, mlir::TypeAttr::get(type));
 
-  if (lastDeclaration.count(surroundingModuleOp))
-    declareOp->moveAfter(lastDeclaration[surroundingModuleOp]);
+  auto &last = lastDeclaration[surroundingModuleOp];
+  if (last)
+    declareOp->moveAfter(last);
 
-  lastDeclaration[surroundingModuleOp] = declareOp; // save this to insert after
+  last = declareOp; // save this to insert after
 
   if (isInputVariable)
     declareOp.setInputAttr(builder.getUnitAttr());
   if (isOutputVariable)
     declareOp.setOutputAttr(builder.getUnitAttr());
-  variables.emplace(variableName.str(), type);
+  variables.try_emplace(variableName, type);
 }
 
 void QUIRVariableBuilder::generateParameterDeclaration(
@@ -148,8 +149,8 @@ void QUIRVariableBuilder::generateArrayVariableDeclaration(
   builder.create<mlir::oq3::DeclareArrayOp>(
       location, builder.getStringAttr(variableName),
       mlir::TypeAttr::get(elementType), builder.getIndexAttr(width));
-  variables.emplace(
-      variableName.str(),
+  variables.try_emplace(
+      variableName,
       mlir::RankedTensorType::get(mlir::ArrayRef<int64_t>{width}, elementType));
 }
 
@@ -0,0 +1,87 @@
+//===- SSAValueTable.cpp - Scoped SSA values of identifiers -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the table of the SSA values of the identifiers in
+///  scope while generating QUIR.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Frontend/OpenQASM3/SSAValueTable.h"
+
+#include "mlir/IR/Value.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cassert>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+using namespace qssc::frontend::openqasm3;
+
+std::optional<mlir::Value>
+SSAValueTable::lookup(llvm::StringRef name) const {
+  auto pos = values.find(std::string_view(name.data(), name.size()));
+  if (pos == values.end())
+    return std::nullopt;
+  return pos->second;
+}
+
+bool SSAValueTable::contains(llvm::StringRef name) const {
+  return values.count(std::string_view(name.data(), name.size()));
+}
+
+bool SSAValueTable::references(mlir::Value value) const {
+  auto refersTo = [&](const Map &map) {
+    return llvm::any_of(map, [&](const auto &pair) {
+      return pair.second == value;
+    });
+  };
+  if (refersTo(values))
+    return true;
+  return llvm::any_of(savedScopes, [&](const std::optional<Map> &saved) {
+    return saved.has_value() && refersTo(*saved);
+  });
+}
+
+void SSAValueTable::assign(llvm::StringRef name, mlir::Value value) {
+  // save the values of the enclosing scope before the first assignment
+  if (!savedScopes.empty() && !savedScopes.back().has_value())
+    savedScopes.back() = values;
+
+  auto pos = values.find(std::string_view(name.data(), name.size()));
+  if (pos != values.end()) {
+    pos->second = value;
+    return;
+  }
+  llvm::StringRef const interned = names.save(name);
+  values.emplace(std::string_view(interned.data(), interned.size()), value);
+}
+
+void SSAValueTable::pushScope() { savedScopes.emplace_back(); }
+
+void SSAValueTable::pushIsolatedScope() {
+  savedScopes.emplace_back(std::move(values));
+  values = Map();
+}
+
+void SSAValueTable::popScope() {
+  assert(!savedScopes.empty() && "no scope to leave");
+  if (savedScopes.back().has_value())
+    values = std::move(*savedScopes.back());
+  savedScopes.pop_back();
+}
@@ -0,0 +1,181 @@
+//===- CompilationTrace.cpp - Target compilation trace ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the trace of the stages of a multi-target
+///  compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/CompilationTrace.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace qssc::hal::compile;
+
+namespace {
+int64_t toMicroseconds(CompilationTrace::Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
+/// The critical path among stages, walking back from the stage which ended
+/// last through the dependency of each stage which ended last.
+std::vector<size_t>
+criticalPath(const std::vector<CompilationTrace::Stage> &stages) {
+  std::vector<size_t> path;
+  if (stages.empty())
+    return path;
+
+  auto endsBefore = [&](size_t lhs, size_t rhs) {
+    return stages[lhs].end < stages[rhs].end;
+  };
+
+  size_t current = 0;
+  for (size_t id = 1; id < stages.size(); ++id)
+    if (endsBefore(current, id))
+      current = id;
+
+  while (true) {
+    path.push_back(current);
+    const auto &dependencies = stages[current].dependencies;
+    if (dependencies.empty())
+      break;
+    current = *std::max_element(dependencies.begin(), dependencies.end(),
+                                endsBefore);
+  }
+
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+double utilization(const std::vector<CompilationTrace::Stage> &stages,
+                   unsigned numThreads) {
+  if (stages.empty() || numThreads == 0)
+    return 0.0;
+
+  auto start = stages.front().start;
+  auto end = stages.front().end;
+  CompilationTrace::Clock::duration busy{0};
+  for (const auto &stage : stages) {
+    start = std::min(start, stage.start);
+    end = std::max(end, stage.end);
+    busy += stage.end - stage.start;
+  }
+
+  auto const wall = std::chrono::duration<double>(end - start).count();
+  if (wall <= 0.0)
+    return 0.0;
+  return std::chrono::duration<double>(busy).count() / (wall * numThreads);
+}
+} // anonymous namespace
+
+CompilationTrace::CompilationTrace(unsigned numThreads)
+    : numThreads(numThreads), begin(Clock::now()) {}
+
+size_t CompilationTrace::record(llvm::StringRef target, llvm::StringRef name,
+                                Clock::time_point start,
+                                llvm::ArrayRef<size_t> dependencies) {
+  auto const end = Clock::now();
+  const std::lock_guard<std::mutex> lock(mutex);
+  stages.push_back({target.str(), name.str(), start, end,
+                    llvm::get_threadid(),
+                    llvm::SmallVector<size_t>(dependencies)});
+  return stages.size() - 1;
+}
+
+std::vector<size_t> CompilationTrace::getCriticalPath() const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return criticalPath(stages);
+}
+
+double CompilationTrace::getUtilization() const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return utilization(stages, numThreads);
+}
+
+void CompilationTrace::print(llvm::raw_ostream &os) const {
+  const std::lock_guard<std::mutex> lock(mutex);
+
+  auto const path = criticalPath(stages);
+  llvm::DenseSet<size_t> const critical(path.begin(), path.end());
+
+  // Number threads in order of appearance rather than by their system ids.
+  llvm::DenseMap<uint64_t, int64_t> threadNumbers;
+  for (const auto &stage : stages)
+    threadNumbers.try_emplace(stage.threadId, threadNumbers.size());
+
+  llvm::json::OStream json(os, /*IndentSize=*/2);
+  json.object([&]() {
+    json.attributeArray("traceEvents", [&]() {
+      for (size_t id = 0; id < stages.size(); ++id) {
+        const auto &stage = stages[id];
+        json.object([&]() {
+          json.attribute("name", stage.target + ": " + stage.name);
+          json.attribute("cat", stage.name);
+          json.attribute("ph", "X");
+          json.attribute("ts", toMicroseconds(stage.start - begin));
+          json.attribute("dur", toMicroseconds(stage.end - stage.start));
+          json.attribute("pid", 1);
+          json.attribute("tid", threadNumbers[stage.threadId]);
+          json.attributeObject("args", [&]() {
+            json.attribute("target", stage.target);
+            json.attribute("critical", critical.contains(id));
+          });
+        });
+      }
+    });
+
+    json.attributeObject("otherData", [&]() {
+      json.attribute("threads", static_cast<int64_t>(numThreads));
+      json.attribute("utilization", utilization(stages, numThreads));
+      Clock::duration criticalDuration{0};
+      json.attributeArray("criticalPath", [&]() {
+        for (auto id : path) {
+          const auto &stage = stages[id];
+          criticalDuration += stage.end - stage.start;
+          json.object([&]() {
+            json.attribute("target", stage.target);
+            json.attribute("stage", stage.name);
+            json.attribute("dur", toMicroseconds(stage.end - stage.start));
+          });
+        }
+      });
+      json.attribute("criticalPathDur", toMicroseconds(criticalDuration));
+    });
+  });
+  os << "\n";
+}
+
+llvm::Error CompilationTrace::write(llvm::StringRef path) const {
+  return llvm::writeToOutput(path, [&](llvm::raw_ostream &os) -> llvm::Error {
+    print(os);
+    return llvm::Error::success();
+  });
+}
@@ -0,0 +1,65 @@
+//===- CompileCancellation.cpp - Cancel compilations ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the cooperative cancellation and deadline of
+///  compilations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/CompileCancellation.h"
+
+#include "mlir/IR/Action.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/TypeID.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/Support/Error.h"
+
+#include <atomic>
+#include <system_error>
+
+using namespace qssc::hal::compile;
+
+bool CompileCancellation::isCancelled() const {
+  return cancelled.load(std::memory_order_relaxed) ||
+         (deadline.has_value() && Clock::now() >= *deadline);
+}
+
+llvm::Error CompileCancellation::check() const {
+  if (cancelled.load(std::memory_order_relaxed))
+    return llvm::createStringError(
+        std::make_error_code(std::errc::operation_canceled),
+        "Compilation cancelled");
+  if (deadline.has_value() && Clock::now() >= *deadline)
+    return llvm::createStringError(
+        std::make_error_code(std::errc::timed_out),
+        "Compilation deadline exceeded");
+  return llvm::Error::success();
+}
+
+void CompileCancellation::skipPassesOnceCancelled(
+    mlir::MLIRContext *context) const {
+  context->registerActionHandler(
+      [this](llvm::function_ref<void()> transform,
+             const mlir::tracing::Action &action) {
+        if (action.getActionID() ==
+                mlir::TypeID::get<mlir::PassExecutionAction>() &&
+            isCancelled())
+          return;
+        transform();
+      });
+}
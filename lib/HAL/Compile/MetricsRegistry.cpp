@@ -0,0 +1,395 @@
+//===- MetricsRegistry.cpp - Process-wide compiler metrics ------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the registry of the counters and histograms of the
+///  compilations and bindings of a process.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/MetricsRegistry.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace qssc::hal::compile;
+
+namespace {
+constexpr double durationBuckets[] = {0.001, 0.0025, 0.005, 0.01, 0.025,
+                                      0.05,  0.1,    0.25,  0.5,  1,
+                                      2.5,   5,      10,    30,   60,
+                                      120,   300};
+
+constexpr double sizeBuckets[] = {1 << 10, 1 << 12, 1 << 14, 1 << 16,
+                                  1 << 18, 1 << 20, 1 << 22, 1 << 24,
+                                  1 << 26, 1 << 28, 1 << 30};
+
+MetricsRegistry::Labels normalize(MetricsRegistry::Labels labels) {
+  std::sort(labels.begin(), labels.end());
+  return labels;
+}
+
+void printEscaped(llvm::raw_ostream &os, llvm::StringRef str, bool quotes) {
+  for (char const c : str) {
+    if (c == '\\')
+      os << "\\\\";
+    else if (c == '\n')
+      os << "\\n";
+    else if (quotes && c == '"')
+      os << "\\\"";
+    else
+      os << c;
+  }
+}
+
+void printValue(llvm::raw_ostream &os, double value) {
+  if (std::isinf(value))
+    os << (value > 0 ? "+Inf" : "-Inf");
+  else
+    os << llvm::format("%.15g", value);
+}
+
+/// Print the labels of a series, with an additional le label for buckets.
+void printLabels(llvm::raw_ostream &os, const MetricsRegistry::Labels &labels,
+                 std::optional<double> le = std::nullopt) {
+  if (labels.empty() && !le)
+    return;
+  os << "{";
+  llvm::ListSeparator sep(",");
+  for (const auto &[name, value] : labels) {
+    os << sep << name << "=\"";
+    printEscaped(os, value, /*quotes=*/true);
+    os << "\"";
+  }
+  if (le) {
+    os << sep << "le=\"";
+    printValue(os, *le);
+    os << "\"";
+  }
+  os << "}";
+}
+
+llvm::Error malformed(const llvm::Twine &msg) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Malformed metrics: " + msg);
+}
+} // anonymous namespace
+
+MetricsRegistry &MetricsRegistry::instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+llvm::ArrayRef<double> MetricsRegistry::getDurationBuckets() {
+  return durationBuckets;
+}
+
+llvm::ArrayRef<double> MetricsRegistry::getSizeBuckets() {
+  return sizeBuckets;
+}
+
+MetricsRegistry::Series *
+MetricsRegistry::getSeries_(llvm::StringRef name, Type type,
+                            llvm::StringRef help,
+                            llvm::ArrayRef<double> buckets, Labels labels) {
+  auto it = families.find(name);
+  if (it == families.end())
+    it = families
+             .emplace(name.str(), Family{type, help.str(), buckets.vec(), {}})
+             .first;
+  Family &family = it->second;
+  if (family.type != type || llvm::ArrayRef(family.buckets) != buckets)
+    return nullptr;
+
+  auto [pos, inserted] =
+      family.series.try_emplace(normalize(std::move(labels)));
+  if (inserted && type == Type::Histogram)
+    pos->second.histogram.bucketCounts.assign(buckets.size() + 1, 0);
+  return &pos->second;
+}
+
+void MetricsRegistry::increment(llvm::StringRef name, llvm::StringRef help,
+                                const Labels &labels, double value) {
+  assert(name.endswith("_total") && "counter names must end in _total");
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto *series = getSeries_(name, Type::Counter, help, {}, labels);
+  assert(series && "metric registered with another type");
+  if (series)
+    series->value += value;
+}
+
+void MetricsRegistry::observe(llvm::StringRef name, llvm::StringRef help,
+                              llvm::ArrayRef<double> buckets,
+                              const Labels &labels, double value) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto *series = getSeries_(name, Type::Histogram, help, buckets, labels);
+  assert(series && "metric registered with another type or buckets");
+  if (!series)
+    return;
+  // the bounds are inclusive
+  size_t const bucket =
+      std::lower_bound(buckets.begin(), buckets.end(), value) -
+      buckets.begin();
+  ++series->histogram.bucketCounts[bucket];
+  ++series->histogram.count;
+  series->histogram.sum += value;
+}
+
+void MetricsRegistry::observeDuration(llvm::StringRef name,
+                                      llvm::StringRef help,
+                                      const Labels &labels,
+                                      Clock::time_point start) {
+  std::chrono::duration<double> const elapsed = Clock::now() - start;
+  observe(name, help, getDurationBuckets(), labels, elapsed.count());
+}
+
+std::optional<double> MetricsRegistry::getCounter(llvm::StringRef name,
+                                                  const Labels &labels) const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto it = families.find(name);
+  if (it == families.end() || it->second.type != Type::Counter)
+    return std::nullopt;
+  auto pos = it->second.series.find(normalize(labels));
+  if (pos == it->second.series.end())
+    return std::nullopt;
+  return pos->second.value;
+}
+
+std::optional<MetricsRegistry::Histogram>
+MetricsRegistry::getHistogram(llvm::StringRef name,
+                              const Labels &labels) const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto it = families.find(name);
+  if (it == families.end() || it->second.type != Type::Histogram)
+    return std::nullopt;
+  auto pos = it->second.series.find(normalize(labels));
+  if (pos == it->second.series.end())
+    return std::nullopt;
+  return pos->second.histogram;
+}
+
+void MetricsRegistry::printText_(llvm::raw_ostream &os,
+                                 bool openMetrics) const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  for (const auto &[name, family] : families) {
+    bool const isCounter = family.type == Type::Counter;
+    // OpenMetrics names counter families without their _total suffix.
+    llvm::StringRef familyName = name;
+    if (openMetrics && isCounter)
+      familyName.consume_back("_total");
+
+    os << "# HELP " << familyName << " ";
+    printEscaped(os, family.help, /*quotes=*/false);
+    os << "\n# TYPE " << familyName << " "
+       << (isCounter ? "counter" : "histogram") << "\n";
+
+    for (const auto &[labels, series] : family.series) {
+      if (isCounter) {
+        os << name;
+        printLabels(os, labels);
+        os << " ";
+        printValue(os, series.value);
+        os << "\n";
+        continue;
+      }
+
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i <= family.buckets.size(); ++i) {
+        cumulative += series.histogram.bucketCounts[i];
+        os << name << "_bucket";
+        printLabels(os, labels,
+                    i < family.buckets.size() ? family.buckets[i]
+                                              : HUGE_VAL);
+        os << " " << cumulative << "\n";
+      }
+      os << name << "_sum";
+      printLabels(os, labels);
+      os << " ";
+      printValue(os, series.histogram.sum);
+      os << "\n" << name << "_count";
+      printLabels(os, labels);
+      os << " " << series.histogram.count << "\n";
+    }
+  }
+  if (openMetrics)
+    os << "# EOF\n";
+}
+
+void MetricsRegistry::print(llvm::raw_ostream &os, Format format) const {
+  if (format == Format::JSON)
+    os << llvm::formatv("{0:2}\n", toJSON());
+  else
+    printText_(os, format == Format::OpenMetrics);
+}
+
+llvm::json::Value MetricsRegistry::toJSON() const {
+  const std::lock_guard<std::mutex> lock(mutex);
+  llvm::json::Array jsonFamilies;
+  for (const auto &[name, family] : families) {
+    bool const isCounter = family.type == Type::Counter;
+    llvm::json::Array jsonSeries;
+    for (const auto &[labels, series] : family.series) {
+      llvm::json::Object jsonLabels;
+      for (const auto &[labelName, labelValue] : labels)
+        jsonLabels[labelName] = labelValue;
+      llvm::json::Object jsonSample{{"labels", std::move(jsonLabels)}};
+      if (isCounter) {
+        jsonSample["value"] = series.value;
+      } else {
+        jsonSample["count"] = static_cast<int64_t>(series.histogram.count);
+        jsonSample["sum"] = series.histogram.sum;
+        llvm::json::Array bucketCounts;
+        for (uint64_t const count : series.histogram.bucketCounts)
+          bucketCounts.push_back(static_cast<int64_t>(count));
+        jsonSample["buckets"] = std::move(bucketCounts);
+      }
+      jsonSeries.push_back(std::move(jsonSample));
+    }
+    llvm::json::Object jsonFamily{{"name", name},
+                                  {"type", isCounter ? "counter" : "histogram"},
+                                  {"help", family.help},
+                                  {"series", std::move(jsonSeries)}};
+    if (!isCounter)
+      jsonFamily["buckets"] = llvm::json::Array(family.buckets);
+    jsonFamilies.push_back(std::move(jsonFamily));
+  }
+  return llvm::json::Object{{"metrics", std::move(jsonFamilies)}};
+}
+
+llvm::Error MetricsRegistry::merge(const llvm::json::Value &json) {
+  const auto *root = json.getAsObject();
+  const auto *jsonFamilies = root ? root->getArray("metrics") : nullptr;
+  if (!jsonFamilies)
+    return malformed("expected an object with a metrics array");
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  for (const auto &jsonFamilyValue : *jsonFamilies) {
+    const auto *jsonFamily = jsonFamilyValue.getAsObject();
+    if (!jsonFamily)
+      return malformed("expected a metric object");
+    auto name = jsonFamily->getString("name");
+    auto type = jsonFamily->getString("type");
+    const auto *jsonSeries = jsonFamily->getArray("series");
+    if (!name || !type || !jsonSeries)
+      return malformed("expected the name, type and series of a metric");
+    bool const isCounter = *type == "counter";
+    if (!isCounter && *type != "histogram")
+      return malformed("unknown type " + *type + " of metric " + *name);
+
+    std::vector<double> buckets;
+    if (!isCounter) {
+      const auto *jsonBuckets = jsonFamily->getArray("buckets");
+      if (!jsonBuckets)
+        return malformed("expected the buckets of histogram " + *name);
+      for (const auto &bound : *jsonBuckets) {
+        auto number = bound.getAsNumber();
+        if (!number)
+          return malformed("expected a bucket bound of histogram " + *name);
+        buckets.push_back(*number);
+      }
+    }
+
+    for (const auto &jsonSampleValue : *jsonSeries) {
+      const auto *jsonSample = jsonSampleValue.getAsObject();
+      const auto *jsonLabels =
+          jsonSample ? jsonSample->getObject("labels") : nullptr;
+      if (!jsonLabels)
+        return malformed("expected the labels of a series of " + *name);
+      Labels labels;
+      for (const auto &[labelName, labelValue] : *jsonLabels) {
+        auto value = labelValue.getAsString();
+        if (!value)
+          return malformed("expected a string label of " + *name);
+        labels.emplace_back(labelName.str(), value->str());
+      }
+
+      auto *series = getSeries_(*name,
+                                isCounter ? Type::Counter : Type::Histogram,
+                                jsonFamily->getString("help").value_or(""),
+                                buckets, std::move(labels));
+      if (!series)
+        return malformed("metric " + *name +
+                         " exists with another type or buckets");
+
+      if (isCounter) {
+        auto value = jsonSample->getNumber("value");
+        if (!value)
+          return malformed("expected the value of a series of " + *name);
+        series->value += *value;
+        continue;
+      }
+
+      auto count = jsonSample->getInteger("count");
+      auto sum = jsonSample->getNumber("sum");
+      const auto *bucketCounts = jsonSample->getArray("buckets");
+      if (!count || !sum || !bucketCounts ||
+          bucketCounts->size() != buckets.size() + 1)
+        return malformed("expected the count, sum and bucket counts of a "
+                         "series of " +
+                         *name);
+      for (auto [index, bucketCount] : llvm::enumerate(*bucketCounts)) {
+        auto value = bucketCount.getAsInteger();
+        if (!value)
+          return malformed("expected a bucket count of " + *name);
+        series->histogram.bucketCounts[index] += *value;
+      }
+      series->histogram.count += *count;
+      series->histogram.sum += *sum;
+    }
+  }
+  return llvm::Error::success();
+}
+
+void MetricsRegistry::reset() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  families.clear();
+}
+
+void MetricsRegistry::swap(MetricsRegistry &other) {
+  const std::scoped_lock lock(mutex, other.mutex);
+  families.swap(other.families);
+}
+
+MetricsTimer::MetricsTimer(llvm::StringRef name, llvm::StringRef help,
+                           MetricsRegistry::Labels labels)
+    : name(name), help(help), labels(std::move(labels)),
+      start(MetricsRegistry::Clock::now()) {}
+
+void MetricsTimer::stop() {
+  if (stopped)
+    return;
+  stopped = true;
+  MetricsRegistry::instance().observeDuration(name, help, labels, start);
+}
@@ -0,0 +1,258 @@
+//===- PassMetrics.cpp - Per-pass IR size and memory metrics ----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the pass instrumentation recording the size of the
+///  IR and the memory use of the compiler before and after each pass.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/PassMetrics.h"
+
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+using namespace qssc::hal::compile;
+
+namespace {
+/// Get the resident set size of the process, or 0 where it is not known.
+size_t getResidentBytes() {
+#if defined(__linux__)
+  // The second field of statm is the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  size_t totalPages = 0;
+  size_t residentPages = 0;
+  if (statm >> totalPages >> residentPages)
+    return residentPages * llvm::sys::Process::getPageSizeEstimate();
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    return info.resident_size;
+#endif
+  return 0;
+}
+
+int64_t delta(size_t before, size_t after) {
+  return static_cast<int64_t>(after) - static_cast<int64_t>(before);
+}
+
+llvm::json::Object toJSON(const PassMetrics::Snapshot &snapshot) {
+  return llvm::json::Object{
+      {"ops", static_cast<int64_t>(snapshot.numOps)},
+      {"symbols", static_cast<int64_t>(snapshot.numSymbols)},
+      {"residentBytes", static_cast<int64_t>(snapshot.residentBytes)},
+      {"allocatedBytes", static_cast<int64_t>(snapshot.allocatedBytes)}};
+}
+
+class PassMetricsInstrumentation : public mlir::PassInstrumentation {
+public:
+  PassMetricsInstrumentation(PassMetrics &metrics, llvm::StringRef pipeline)
+      : metrics(metrics), pipeline(pipeline.str()) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    if (isAdaptor(pass))
+      return;
+    size_t const index = metrics.startRun();
+    auto snapshot = PassMetrics::takeSnapshot(op);
+    std::lock_guard<std::mutex> const lock(mutex);
+    pending[{pass, op}] = {index, snapshot};
+  }
+
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    finishRun(pass, op, /*failed=*/false);
+  }
+
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+    finishRun(pass, op, /*failed=*/true);
+  }
+
+private:
+  /// The adaptors running the nested pass managers on each nested operation
+  /// are not of interest on their own. Their type is private to MLIR.
+  static bool isAdaptor(mlir::Pass *pass) {
+    return pass->getName() == "mlir::detail::OpToOpPassAdaptor";
+  }
+
+  void finishRun(mlir::Pass *pass, mlir::Operation *op, bool failed) {
+    if (isAdaptor(pass))
+      return;
+    auto after = PassMetrics::takeSnapshot(op);
+
+    PassMetrics::Run run;
+    {
+      std::lock_guard<std::mutex> const lock(mutex);
+      auto it = pending.find({pass, op});
+      if (it == pending.end())
+        return;
+      run.index = it->second.first;
+      run.before = it->second.second;
+      pending.erase(it);
+    }
+    run.pipeline = pipeline;
+    run.pass = pass->getName().str();
+    run.op = op->getName().getStringRef().str();
+    run.after = after;
+    run.failed = failed;
+    metrics.record(std::move(run));
+  }
+
+  PassMetrics &metrics;
+  std::string pipeline;
+
+  std::mutex mutex; // guards pending
+  /// The index and snapshot of the running passes, which may run
+  /// concurrently on different operations.
+  llvm::DenseMap<std::pair<mlir::Pass *, mlir::Operation *>,
+                 std::pair<size_t, PassMetrics::Snapshot>>
+      pending;
+};
+} // anonymous namespace
+
+PassMetrics::Snapshot PassMetrics::takeSnapshot(mlir::Operation *op) {
+  Snapshot snapshot = takeMemorySnapshot();
+  op->walk([&](mlir::Operation *nested) {
+    ++snapshot.numOps;
+    if (llvm::isa<mlir::SymbolOpInterface>(nested))
+      ++snapshot.numSymbols;
+  });
+  return snapshot;
+}
+
+PassMetrics::Snapshot PassMetrics::takeMemorySnapshot() {
+  Snapshot snapshot;
+  snapshot.residentBytes = getResidentBytes();
+  snapshot.allocatedBytes = llvm::sys::Process::GetMallocUsage();
+  return snapshot;
+}
+
+std::unique_ptr<mlir::PassInstrumentation>
+PassMetrics::createInstrumentation(llvm::StringRef pipeline) {
+  return std::make_unique<PassMetricsInstrumentation>(*this, pipeline);
+}
+
+size_t PassMetrics::startRun() {
+  std::lock_guard<std::mutex> const lock(mutex);
+  return numStarted++;
+}
+
+void PassMetrics::record(Run run) {
+  std::lock_guard<std::mutex> const lock(mutex);
+  runs.push_back(std::move(run));
+}
+
+std::vector<PassMetrics::Run> PassMetrics::getRuns() const {
+  std::vector<Run> sorted;
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    sorted = runs;
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const Run &lhs, const Run &rhs) {
+    return lhs.index < rhs.index;
+  });
+  return sorted;
+}
+
+void PassMetrics::printTable(llvm::raw_ostream &os) const {
+  struct Row {
+    size_t numRuns = 0;
+    size_t numOps = 0;
+    int64_t opsDelta = 0;
+    size_t numSymbols = 0;
+    int64_t symbolsDelta = 0;
+    int64_t residentDelta = 0;
+    int64_t allocatedDelta = 0;
+  };
+
+  // Rows in the order the passes first started.
+  using Key = std::pair<std::string, std::string>;
+  llvm::MapVector<Key, Row, std::map<Key, unsigned>> rows;
+  for (const auto &run : getRuns()) {
+    auto &row = rows[{run.pipeline, run.pass}];
+    ++row.numRuns;
+    row.numOps += run.after.numOps;
+    row.opsDelta += delta(run.before.numOps, run.after.numOps);
+    row.numSymbols += run.after.numSymbols;
+    row.symbolsDelta += delta(run.before.numSymbols, run.after.numSymbols);
+    row.residentDelta +=
+        delta(run.before.residentBytes, run.after.residentBytes);
+    row.allocatedDelta +=
+        delta(run.before.allocatedBytes, run.after.allocatedBytes);
+  }
+
+  os << "===" << std::string(73, '-') << "===\n";
+  os << "                              Pass metrics report\n";
+  os << "===" << std::string(73, '-') << "===\n";
+  os << llvm::formatv("{0,6} {1,9} {2,9} {3,8} {4,8} {5,11} {6,11}  {7}\n",
+                      "Runs", "Ops", "dOps", "Symbols", "dSymbols",
+                      "dRSS(KiB)", "dAlloc(KiB)", "Pipeline: Pass");
+  for (const auto &[key, row] : rows)
+    os << llvm::formatv(
+        "{0,6} {1,9} {2,9} {3,8} {4,8} {5,11} {6,11}  {7}: {8}\n",
+        row.numRuns, row.numOps, row.opsDelta, row.numSymbols,
+        row.symbolsDelta, row.residentDelta / 1024, row.allocatedDelta / 1024,
+        key.first, key.second);
+}
+
+void PassMetrics::printJSON(llvm::raw_ostream &os) const {
+  llvm::json::Array jsonRuns;
+  for (const auto &run : getRuns())
+    jsonRuns.push_back(llvm::json::Object{{"pipeline", run.pipeline},
+                                          {"pass", run.pass},
+                                          {"op", run.op},
+                                          {"failed", run.failed},
+                                          {"before", toJSON(run.before)},
+                                          {"after", toJSON(run.after)}});
+  os << llvm::formatv(
+      "{0:2}\n", llvm::json::Value(llvm::json::Object{
+                     {"runs", std::move(jsonRuns)}}));
+}
+
+llvm::Error PassMetrics::write(llvm::StringRef path, Format format) const {
+  return llvm::writeToOutput(path, [&](llvm::raw_ostream &os) -> llvm::Error {
+    if (format == Format::JSON)
+      printJSON(os);
+    else
+      printTable(os);
+    return llvm::Error::success();
+  });
+}
@@ -0,0 +1,245 @@
+//===- ProfilerMarkers.cpp - Profiler markers of timing scopes --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the markers which external profilers are given at
+///  the boundaries of the timing scopes of a compilation.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/ProfilerMarkers.h"
+
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+using namespace qssc::hal::compile;
+
+namespace {
+llvm::Error makeError(const llvm::Twine &message) {
+  return llvm::make_error<llvm::StringError>(message,
+                                             llvm::inconvertibleErrorCode());
+}
+
+/// Timestamped markers in a file, one per line as
+///   <nanoseconds> B <id> <thread> <name>
+///   <nanoseconds> E <id> <thread>
+/// The timestamps are of the monotonic clock, which is the clock of
+/// `perf record -k mono`, so the markers can be laid over its samples.
+class PerfMarkers : public ProfilerMarkers {
+public:
+  explicit PerfMarkers(std::unique_ptr<llvm::raw_fd_ostream> os)
+      : os(std::move(os)) {}
+
+  void begin(uint64_t id, llvm::StringRef name) override {
+    auto const now = timestamp();
+    const std::lock_guard<std::mutex> lock(mutex);
+    *os << now << " B " << id << " " << llvm::get_threadid() << " " << name
+        << "\n";
+  }
+
+  void end(uint64_t id) override {
+    auto const now = timestamp();
+    const std::lock_guard<std::mutex> lock(mutex);
+    *os << now << " E " << id << " " << llvm::get_threadid() << "\n";
+  }
+
+private:
+  static int64_t timestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  std::mutex mutex; // guards os
+  std::unique_ptr<llvm::raw_fd_ostream> os;
+};
+
+/// Markers forwarded to the functions of a shared library.
+class LibraryMarkers : public ProfilerMarkers {
+public:
+  using BeginFn = void (*)(uint64_t, const char *, size_t);
+  using EndFn = void (*)(uint64_t);
+
+  LibraryMarkers(BeginFn beginFn, EndFn endFn)
+      : beginFn(beginFn), endFn(endFn) {}
+
+  void begin(uint64_t id, llvm::StringRef name) override {
+    beginFn(id, name.data(), name.size());
+  }
+
+  void end(uint64_t id) override { endFn(id); }
+
+private:
+  BeginFn beginFn;
+  EndFn endFn;
+};
+
+std::unique_ptr<ProfilerMarkers> &processMarkers() {
+  static std::unique_ptr<ProfilerMarkers> markers = []() {
+    const char *spec = std::getenv("QSSC_PROFILER_MARKERS");
+    if (!spec || !*spec)
+      return std::unique_ptr<ProfilerMarkers>();
+    auto markers = ProfilerMarkers::create(spec);
+    if (!markers) {
+      llvm::errs() << "Ignoring QSSC_PROFILER_MARKERS: "
+                   << llvm::toString(markers.takeError()) << "\n";
+      return std::unique_ptr<ProfilerMarkers>();
+    }
+    return std::move(*markers);
+  }();
+  return markers;
+}
+
+// Ids are unique across the compilations of the process, which may share
+// markers.
+std::atomic<uint64_t> nextMarkerId{0};
+} // anonymous namespace
+
+ProfilerMarkers *ProfilerMarkers::get() { return processMarkers().get(); }
+
+void ProfilerMarkers::install(std::unique_ptr<ProfilerMarkers> markers) {
+  processMarkers() = std::move(markers);
+}
+
+llvm::Expected<std::unique_ptr<ProfilerMarkers>>
+ProfilerMarkers::create(llvm::StringRef spec) {
+  auto [kind, path] = spec.split(':');
+  if (path.empty())
+    return makeError("Profiler markers must be perf:<file> or "
+                     "library:<file>, got " +
+                     spec);
+
+  if (kind == "perf") {
+    std::error_code ec;
+    auto os = std::make_unique<llvm::raw_fd_ostream>(path, ec,
+                                                     llvm::sys::fs::OF_Text);
+    if (ec)
+      return makeError("Unable to open " + path + ": " + ec.message());
+    os->SetUnbuffered();
+    return std::make_unique<PerfMarkers>(std::move(os));
+  }
+
+  if (kind == "library") {
+    std::string errMsg;
+    auto library =
+        llvm::sys::DynamicLibrary::getPermanentLibrary(path.str().c_str(),
+                                                       &errMsg);
+    if (!library.isValid())
+      return makeError("Unable to load " + path + ": " + errMsg);
+    auto *beginFn = reinterpret_cast<LibraryMarkers::BeginFn>(
+        library.getAddressOfSymbol("qssc_profiler_begin"));
+    auto *endFn = reinterpret_cast<LibraryMarkers::EndFn>(
+        library.getAddressOfSymbol("qssc_profiler_end"));
+    if (!beginFn || !endFn)
+      return makeError(path + " does not define qssc_profiler_begin and "
+                              "qssc_profiler_end");
+    return std::make_unique<LibraryMarkers>(beginFn, endFn);
+  }
+
+  return makeError("Unknown profiler markers " + kind);
+}
+
+ProfilingTimingManager::ProfilingTimingManager()
+    : markers(ProfilerMarkers::get()) {}
+
+ProfilingTimingManager::~ProfilingTimingManager() = default;
+
+ProfilingTimingManager::Marker *
+ProfilingTimingManager::createMarker_(void *timer, std::string name) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return &allocated.emplace_back(
+      Marker{timer, std::move(name), nextMarkerId.fetch_add(1)});
+}
+
+std::optional<void *> ProfilingTimingManager::rootTimer() {
+  auto timer = DefaultTimingManager::rootTimer();
+  if (!markers)
+    return timer;
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (!root)
+    root = &allocated.emplace_back(
+        Marker{timer.value_or(nullptr), "qssc", nextMarkerId.fetch_add(1)});
+  return root;
+}
+
+void ProfilingTimingManager::startTimer(void *handle) {
+  if (!markers) {
+    DefaultTimingManager::startTimer(handle);
+    return;
+  }
+
+  auto *marker = static_cast<Marker *>(handle);
+  if (marker->timer)
+    DefaultTimingManager::startTimer(marker->timer);
+  markers->begin(marker->id, marker->name);
+}
+
+void ProfilingTimingManager::stopTimer(void *handle) {
+  if (!markers) {
+    DefaultTimingManager::stopTimer(handle);
+    return;
+  }
+
+  auto *marker = static_cast<Marker *>(handle);
+  markers->end(marker->id);
+  if (marker->timer)
+    DefaultTimingManager::stopTimer(marker->timer);
+}
+
+void *ProfilingTimingManager::nestTimer(
+    void *handle, const void *id,
+    llvm::function_ref<std::string()> nameBuilder) {
+  if (!markers)
+    return DefaultTimingManager::nestTimer(handle, id, nameBuilder);
+
+  auto *parent = static_cast<Marker *>(handle);
+  void *timer = parent->timer
+                    ? DefaultTimingManager::nestTimer(parent->timer, id,
+                                                      nameBuilder)
+                    : nullptr;
+  return createMarker_(timer, nameBuilder());
+}
+
+void ProfilingTimingManager::hideTimer(void *handle) {
+  if (!markers) {
+    DefaultTimingManager::hideTimer(handle);
+    return;
+  }
+
+  auto *marker = static_cast<Marker *>(handle);
+  if (marker->timer)
+    DefaultTimingManager::hideTimer(marker->timer);
+}
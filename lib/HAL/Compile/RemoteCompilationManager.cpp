@@ -0,0 +1,321 @@
+//===- RemoteCompilationManager.cpp -----------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+///  This file implements the compilation manager which delegates the
+///  compilation of target subtrees to workers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "HAL/Compile/RemoteCompilationManager.h"
+
+#include "HAL/Compile/MetricsRegistry.h"
+#include "HAL/Compile/ThreadedCompilationManager.h"
+#include "HAL/TargetSystem.h"
+#include "Payload/Payload.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+using namespace qssc;
+using namespace qssc::hal::compile;
+
+namespace {
+constexpr llvm::StringLiteral jobMagic = "QSSCJOB1";
+constexpr llvm::StringLiteral resultMagic = "QSSCRES1";
+
+llvm::Error makeError(const llvm::Twine &message) {
+  return llvm::make_error<llvm::StringError>(message,
+                                             llvm::inconvertibleErrorCode());
+}
+
+/// Length prefixed fields of a serialized job or result.
+class FieldWriter {
+public:
+  explicit FieldWriter(llvm::StringRef magic)
+      : os(data), writer(os, llvm::support::little) {
+    os << magic;
+  }
+
+  void write(llvm::StringRef field) {
+    writer.write<uint64_t>(field.size());
+    os << field;
+  }
+  void write(uint64_t value) { writer.write<uint64_t>(value); }
+
+  std::string take() {
+    os.flush();
+    return std::move(data);
+  }
+
+private:
+  std::string data;
+  llvm::raw_string_ostream os;
+  llvm::support::endian::Writer writer;
+};
+
+class FieldReader {
+public:
+  explicit FieldReader(llvm::StringRef data) : data(data) {}
+
+  bool readMagic(llvm::StringRef magic) { return data.consume_front(magic); }
+
+  bool read(uint64_t &value) {
+    if (data.size() < sizeof(uint64_t))
+      return false;
+    value = llvm::support::endian::read64le(data.data());
+    data = data.drop_front(sizeof(uint64_t));
+    return true;
+  }
+  bool read(std::string &field) {
+    uint64_t size = 0;
+    if (!read(size) || data.size() < size)
+      return false;
+    field = data.take_front(size).str();
+    data = data.drop_front(size);
+    return true;
+  }
+
+  bool atEnd() const { return data.empty(); }
+
+private:
+  llvm::StringRef data;
+};
+
+/// A payload which only collects the files the targets of a subtree emit.
+class CollectingPayload : public qssc::payload::Payload {
+public:
+  explicit CollectingPayload(std::string payloadPrefix) {
+    prefix = std::move(payloadPrefix);
+  }
+
+  void write(llvm::raw_ostream &stream) override {}
+  void write(std::ostream &stream) override {}
+  void writePlain(std::ostream &stream) override {}
+  void writePlain(llvm::raw_ostream &stream) override {}
+
+  void addFile(llvm::StringRef filename, llvm::StringRef str) override {
+    const std::lock_guard<std::mutex> lock(_mtx);
+    recordEmission(filename.str());
+    files[filename.str()] = str;
+  }
+
+  std::map<std::string, std::string> takeFiles() {
+    const std::lock_guard<std::mutex> lock(_mtx);
+    fileStreams.clear();
+    std::map<std::string, std::string> taken;
+    for (auto &[fName, contents] : files)
+      taken.emplace(fName.string(), std::move(contents));
+    files.clear();
+    return taken;
+  }
+};
+
+/// The names of the targets from the child of the root of the target tree to
+/// target.
+std::string getTargetPath(hal::Target &target) {
+  llvm::SmallVector<llvm::StringRef> names;
+  for (auto *current = &target; current->getParent();
+       current = current->getParent())
+    names.push_back(current->getName());
+
+  std::string path;
+  for (auto name = names.rbegin(); name != names.rend(); ++name) {
+    if (!path.empty())
+      path += '/';
+    path += *name;
+  }
+  return path;
+}
+
+llvm::Expected<mlir::OwningOpRef<mlir::ModuleOp>>
+parseModule(llvm::StringRef bytecode, mlir::MLIRContext *context) {
+  mlir::ParserConfig const config(context);
+  auto moduleOp = mlir::parseSourceString<mlir::ModuleOp>(bytecode, config);
+  if (!moduleOp)
+    return makeError("Unable to parse the module of a target subtree");
+  return std::move(moduleOp);
+}
+
+llvm::Error writeModule(mlir::ModuleOp moduleOp, std::string &bytecode) {
+  llvm::raw_string_ostream os(bytecode);
+  if (mlir::failed(mlir::writeBytecodeToFile(moduleOp, os)))
+    return makeError("Unable to serialize the module of a target subtree");
+  os.flush();
+  return llvm::Error::success();
+}
+} // anonymous namespace
+
+std::string SubtreeJob::serialize() const {
+  FieldWriter writer(jobMagic);
+  writer.write(targetPath);
+  writer.write(payloadPrefix);
+  writer.write(static_cast<uint64_t>(compileMLIR));
+  writer.write(moduleBytecode);
+  return writer.take();
+}
+
+llvm::Expected<SubtreeJob> SubtreeJob::deserialize(llvm::StringRef data) {
+  FieldReader reader(data);
+  SubtreeJob job;
+  uint64_t compileMLIR = 0;
+  if (!reader.readMagic(jobMagic) || !reader.read(job.targetPath) ||
+      !reader.read(job.payloadPrefix) || !reader.read(compileMLIR) ||
+      !reader.read(job.moduleBytecode) || !reader.atEnd())
+    return makeError("Invalid target subtree job");
+  job.compileMLIR = compileMLIR != 0;
+  return job;
+}
+
+std::string SubtreeResult::serialize() const {
+  FieldWriter writer(resultMagic);
+  writer.write(moduleBytecode);
+  writer.write(static_cast<uint64_t>(files.size()));
+  for (const auto &[name, contents] : files) {
+    writer.write(name);
+    writer.write(contents);
+  }
+  return writer.take();
+}
+
+llvm::Expected<SubtreeResult> SubtreeResult::deserialize(llvm::StringRef data) {
+  FieldReader reader(data);
+  SubtreeResult result;
+  uint64_t numFiles = 0;
+  if (!reader.readMagic(resultMagic) || !reader.read(result.moduleBytecode) ||
+      !reader.read(numFiles))
+    return makeError("Invalid target subtree result");
+  for (uint64_t i = 0; i < numFiles; ++i) {
+    std::string name;
+    std::string contents;
+    if (!reader.read(name) || !reader.read(contents))
+      return makeError("Invalid target subtree result");
+    result.files[std::move(name)] = std::move(contents);
+  }
+  if (!reader.atEnd())
+    return makeError("Invalid target subtree result");
+  return result;
+}
+
+bool SubtreeExecutor::accepts(Target &target) {
+  return target.getParent() && !target.getParent()->getParent();
+}
+
+RemoteCompilationManager::RemoteCompilationManager(
+    qssc::hal::TargetSystem &target, mlir::MLIRContext *context,
+    PMBuilder pmBuilder, std::shared_ptr<SubtreeExecutor> executor,
+    std::shared_ptr<TargetPassManagerPools> passManagerPools)
+    : ThreadedCompilationManager(target, context, std::move(pmBuilder),
+                                 std::move(passManagerPools)),
+      executor(std::move(executor)) {}
+
+const std::string RemoteCompilationManager::getName() const {
+  return "RemoteCompilationManager";
+}
+
+bool RemoteCompilationManager::delegatesSubtree(Target &target) {
+  return executor && executor->accepts(target);
+}
+
+llvm::Expected<std::map<std::string, std::string>>
+RemoteCompilationManager::compileDelegatedSubtree(
+    Target &target, mlir::ModuleOp targetModuleOp,
+    llvm::StringRef payloadPrefix, bool doCompileMLIR,
+    mlir::TimingScope &timing) {
+  auto remoteTiming = timing.nest("remote");
+  MetricsTimer const remoteTimer(
+      "qssc_target_stage_duration_seconds",
+      "Seconds spent in the stages of the compilation of a target",
+      {{"target", target.getName().str()}, {"stage", "remote"}});
+
+  SubtreeJob job;
+  job.targetPath = getTargetPath(target);
+  job.payloadPrefix = payloadPrefix.str();
+  job.compileMLIR = doCompileMLIR;
+  if (auto err = writeModule(targetModuleOp, job.moduleBytecode))
+    return std::move(err);
+
+  auto result = executor->execute(job);
+  if (!result)
+    return llvm::joinErrors(
+        makeError("Remote compilation of target " + target.getName() +
+                  " failed"),
+        result.takeError());
+
+  // The dialects of the compiled module were loaded when the pass managers
+  // of the subtree were built.
+  auto compiled = parseModule(result->moduleBytecode, getContext());
+  if (!compiled)
+    return compiled.takeError();
+  targetModuleOp.getBodyRegion().takeBody((*compiled)->getBodyRegion());
+  targetModuleOp->setAttrs((*compiled)->getAttrDictionary());
+
+  MetricsRegistry::instance().increment(
+      "qssc_remote_subtrees_total", "Target subtrees compiled by workers",
+      {{"target", target.getName().str()}});
+  return std::move(result->files);
+}
+
+llvm::Expected<SubtreeResult>
+qssc::hal::compile::runSubtreeJob(ThreadedCompilationManager &manager,
+                                  const SubtreeJob &job) {
+  hal::Target *target = &manager.getTargetSystem();
+  llvm::SmallVector<llvm::StringRef> names;
+  llvm::StringRef(job.targetPath).split(names, '/', /*MaxSplit=*/-1,
+                                         /*KeepEmpty=*/false);
+  for (auto name : names) {
+    hal::Target *child = nullptr;
+    for (auto *candidate : target->getChildren())
+      if (candidate->getName() == name)
+        child = candidate;
+    if (!child)
+      return makeError("Unknown target " + job.targetPath);
+    target = child;
+  }
+
+  auto moduleOp = parseModule(job.moduleBytecode, manager.getContext());
+  if (!moduleOp)
+    return moduleOp.takeError();
+
+  CollectingPayload payload(job.payloadPrefix);
+  if (auto err = manager.compilePayloadSubtree(*target, moduleOp->get(),
+                                               payload, job.compileMLIR))
+    return std::move(err);
+
+  SubtreeResult result;
+  if (auto err = writeModule(moduleOp->get(), result.moduleBytecode))
+    return std::move(err);
+  result.files = payload.takeFiles();
+  return result;
+}
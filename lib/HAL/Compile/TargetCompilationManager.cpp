@@ -28,6 +28,8 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <string>
+
 #include "HAL/Compile/TargetCompilationManager.h"
 #include "HAL/TargetSystem.h"
 
@@ -55,6 +57,15 @@ struct TargetCompilationManagerOptions {
       "print-ir-after-target-compile-failure",
       llvm::cl::desc("Print IR after failure of applying target compilation"),
       llvm::cl::init(false)};
+
+  //===--------------------------------------------------------------------===//
+  // Tracing
+  //===--------------------------------------------------------------------===//
+  llvm::cl::opt<std::string> traceFile{
+      "target-compile-trace",
+      llvm::cl::desc("Write a Chrome trace of the target compilation stages "
+                     "with its critical path and thread utilization"),
+      llvm::cl::value_desc("filename"), llvm::cl::init("")};
 };
 
 llvm::ManagedStatic<TargetCompilationManagerOptions> options;
@@ -77,6 +88,9 @@ mlir::LogicalResult qssc::hal::compile::applyTargetCompilationManagerCLOptions(
                              options->printBeforeAllTargetPayload,
                              options->printAfterTargetCompileFailure);
 
+  if (!options->traceFile.empty())
+    scheduler.enableTracing(options->traceFile);
+
   return mlir::success();
 }
 
@@ -92,6 +106,9 @@ llvm::Error TargetCompilationManager::walkTargetModules(
   if (auto err = walkFunc(target, targetModuleOp, timing))
     return err;
 
+  if (auto err = target->instantiateChildren(targetModuleOp))
+    return err;
+
   for (auto *child : target->getChildren()) {
     // Recurse on the target
     auto childModuleOp = child->getModule(targetModuleOp);
@@ -134,6 +151,19 @@ void TargetCompilationManager::enableIRPrinting(
   this->printAfterTargetCompileFailure = printAfterTargetCompileFailure;
 }
 
+void TargetCompilationManager::enableTracing(llvm::StringRef tracePath) {
+  this->tracePath = tracePath.str();
+}
+
+void TargetCompilationManager::enablePassMetrics(PassMetrics *passMetrics) {
+  this->passMetrics = passMetrics;
+}
+
+void TargetCompilationManager::enableTargetVerification(
+    bool verifyAfterTargetPasses) {
+  this->verifyAfterTargetPasses = verifyAfterTargetPasses;
+}
+
 void TargetCompilationManager::printIR(llvm::Twine msg, mlir::Operation *op,
                                        llvm::raw_ostream &out) {
   out << "// -----// ";
@@ -153,5 +183,8 @@ void TargetCompilationManager::enableTiming(mlir::TimingScope &timingScope) {
 void TargetCompilationManager::disableTiming() { rootTimer.stop(); }
 
 mlir::TimingScope TargetCompilationManager::getTimer(llvm::StringRef name) {
+  // Without timing or profiler markers the root timer is inactive.
+  if (!rootTimer)
+    return mlir::TimingScope();
   return rootTimer.nest(name);
 }
@@ -16,6 +16,9 @@
 
 #include "HAL/Compile/ThreadedCompilationManager.h"
 
+#include "HAL/Compile/CompilationTrace.h"
+#include "HAL/Compile/MetricsRegistry.h"
+#include "HAL/Compile/PassMetrics.h"
 #include "HAL/Compile/TargetCompilationManager.h"
 #include "HAL/TargetSystem.h"
 #include "Payload/Payload.h"
@@ -24,89 +27,360 @@
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/Threading.h"
+#include "mlir/IR/Verifier.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 using namespace qssc;
 using namespace qssc::hal::compile;
 
+namespace qssc::hal::compile {
+/// Each target has a prototype pass manager which is built from the target and
+/// registered with the context once, and is never run itself. Compilations
+/// check out pass managers cloned from the prototype, so that compilations for
+/// the same target may run concurrently without rebuilding the target's
+/// pipeline or modifying the context.
+class TargetPassManagerPools {
+public:
+  struct Pool {
+    explicit Pool(mlir::MLIRContext *context) : prototype(context) {}
+
+    mlir::PassManager prototype;
+    std::mutex mutex; // guards available
+    std::vector<std::unique_ptr<mlir::PassManager>> available;
+  };
+
+  // serializes building the pools of all targets
+  std::mutex buildMutex;
+  // guards pools and built
+  std::shared_mutex mutex;
+  std::map<Target *, Pool> pools;
+  // whether pools has been populated for the targets instantiated upfront
+  bool built = false;
+};
+} // namespace qssc::hal::compile
+
 ThreadedCompilationManager::ThreadedCompilationManager(
     qssc::hal::TargetSystem &target, mlir::MLIRContext *context,
-    ThreadedCompilationManager::PMBuilder pmBuilder)
+    ThreadedCompilationManager::PMBuilder pmBuilder,
+    std::shared_ptr<TargetPassManagerPools> passManagerPools)
     : TargetCompilationManager(target, context),
+      passManagerPools_(passManagerPools
+                            ? std::move(passManagerPools)
+                            : std::make_shared<TargetPassManagerPools>()),
       pmBuilder(std::move(pmBuilder)) {}
 
 const std::string ThreadedCompilationManager::getName() const {
   return "ThreadedCompilationManager";
 }
 
+namespace {
+using SharedLock = std::shared_lock<std::shared_mutex>;
+using UniqueLock = std::unique_lock<std::shared_mutex>;
+using MutexLock = std::unique_lock<std::mutex>;
+
+/// Lock mutex, recording the time spent waiting for it in the process metrics
+/// under name if another thread held it. Uncontended locks are not recorded
+/// so that measuring contention does not serialize the threads on the
+/// metrics registry.
+template <typename LockT>
+LockT lockRecordingContention(typename LockT::mutex_type &mutex,
+                              llvm::StringRef name) {
+  LockT lock(mutex, std::try_to_lock);
+  if (lock.owns_lock())
+    return lock;
+
+  auto const start = MetricsRegistry::Clock::now();
+  lock.lock();
+  std::chrono::duration<double> const waited =
+      MetricsRegistry::Clock::now() - start;
+  MetricsRegistry::Labels const labels{{"lock", name.str()}};
+  auto &metrics = MetricsRegistry::instance();
+  metrics.increment("qssc_compile_lock_contentions_total",
+                    "Acquisitions of a lock of the threaded compilation "
+                    "manager held by another thread",
+                    labels);
+  metrics.increment("qssc_compile_lock_wait_seconds_total",
+                    "Seconds spent waiting for a lock of the threaded "
+                    "compilation manager held by another thread",
+                    labels, waited.count());
+  return lock;
+}
+
+/// A target of a walk over the target modules. The target is visited in a task
+/// of its own once its parent has been visited, emitted once it has been
+/// visited and its parent has emitted, and its post children callback runs
+/// once both its emission and its last child subtree completed.
+struct TargetWalkNode {
+  TargetWalkNode(hal::Target *target, mlir::ModuleOp moduleOp,
+                 TargetWalkNode *parent, mlir::TimingScope *parentTiming,
+                 unsigned pendingEmit)
+      : target(target), moduleOp(moduleOp), parent(parent),
+        parentTiming(parentTiming), pendingEmit(pendingEmit) {}
+
+  hal::Target *target;
+  mlir::ModuleOp moduleOp;
+  TargetWalkNode *parent;
+  mlir::TimingScope *parentTiming;
+  mlir::TimingScope timing;
+  mlir::TimingScope childrenTiming;
+  llvm::SmallVector<TargetWalkNode *> children;
+  // whether the children are visited while the target emits rather than after
+  bool emitsConcurrently = false;
+  // the visit of the target and the emission of its parent
+  std::atomic<unsigned> pendingEmit;
+  // the emission of the target and its children
+  std::atomic<size_t> pending{0};
+  // whether the target or any of its children failed
+  std::atomic<bool> failed{false};
+  // ids of the traced stages of the target
+  std::optional<size_t> visitStage;
+  std::optional<size_t> emitStage;
+  std::optional<size_t> postStage;
+};
+
+/// The payload group of the files of a target, i.e., the name of the
+/// instrument subtree, a child of the system, the target belongs to.
+std::string getPayloadGroup(const hal::Target &target) {
+  const hal::Target *instrument = &target;
+  while (instrument->getParent() && instrument->getParent()->getParent())
+    instrument = instrument->getParent();
+  return instrument->getName().str();
+}
+} // anonymous namespace
+
 llvm::Error ThreadedCompilationManager::walkTargetModulesThreaded(
     Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
     const WalkTargetModulesFunction &walkFunc,
     const WalkTargetModulesFunction &postChildrenCallbackFunc) {
+  return walkTargetModulesThreaded(target, targetModuleOp, timing, walkFunc,
+                                   /*emitFunc=*/{}, postChildrenCallbackFunc);
+}
 
-  auto parentTiming = timing.nest(target->getName());
+llvm::Error ThreadedCompilationManager::walkTargetModulesThreaded(
+    Target *target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing,
+    const WalkTargetModulesFunction &walkFunc,
+    const WalkTargetModulesFunction &emitFunc,
+    const WalkTargetModulesFunction &postChildrenCallbackFunc,
+    const std::function<bool(Target *)> &skipChildren) {
+
+  // The targets form a task graph in which the visit of a target depends on
+  // the visit of its parent, the emission of a target on its own visit and the
+  // emission of its parent, and the post children callback of a target on its
+  // emission and all of its children. Tasks are scheduled on the context's
+  // threadpool as soon as their dependencies are met rather than level by
+  // level, so that independent subtrees never wait on each other and no
+  // thread blocks waiting for children.
+  //
+  // Children are visited after the emission of their parent unless the parent
+  // emits independently of them, in which case the emission of the parent
+  // overlaps with the compilation of its children.
+  std::mutex mutex; // guards nodes and errors
+  std::deque<TargetWalkNode> nodes;
+  llvm::Error errors = llvm::Error::success();
+
+  // By utilizing the MLIR threadpool, we automatically inherit the
+  // multiprocessing settings from the context.
+  std::optional<llvm::ThreadPoolTaskGroup> tasks;
+  if (isMultithreadingEnabled())
+    tasks.emplace(getThreadPool());
+
+  auto schedule = [&](std::function<void()> task) {
+    if (tasks)
+      tasks->async(std::move(task));
+    else
+      task();
+  };
 
-  if (auto err = walkFunc(target, targetModuleOp, parentTiming))
+  std::optional<CompilationTrace> trace;
+  if (getTracePath())
+    trace.emplace(isMultithreadingEnabled() ? getThreadPool().getThreadCount()
+                                            : 1);
+
+  // Run a stage of a target, recording it with the stages it waited on if
+  // tracing.
+  auto runStage = [&](TargetWalkNode &node, llvm::StringRef name,
+                      const WalkTargetModulesFunction &func,
+                      std::optional<size_t> &stage,
+                      llvm::ArrayRef<std::optional<size_t>> waitedOn) {
+    if (!trace)
+      return func(node.target, node.moduleOp, node.timing);
+
+    auto const start = CompilationTrace::Clock::now();
+    auto err = func(node.target, node.moduleOp, node.timing);
+    llvm::SmallVector<size_t> dependencies;
+    for (auto dependency : waitedOn)
+      if (dependency)
+        dependencies.push_back(*dependency);
+    stage = trace->record(node.target->getName(), name, start, dependencies);
     return err;
+  };
 
-  // Get child modules in a non-threaded fashion to preserve
-  // MLIR parallelization rules
-  auto children = target->getChildren();
+  // The last stage of a target before its post children callback.
+  auto lastStage = [](TargetWalkNode &node) {
+    return node.emitStage ? node.emitStage : node.visitStage;
+  };
 
-  // Check if there are children to walk. If not exit early
-  if (children.size()) {
+  auto recordError = [&](TargetWalkNode &node, llvm::Error err) {
+    node.failed = true;
+    const std::lock_guard<std::mutex> lock(mutex);
+    errors = llvm::joinErrors(std::move(errors), std::move(err));
+  };
+
+  // Complete a node once it has emitted and all of its children completed
+  // and, as long as it is the last dependency of its parent to complete, its
+  // parent on this thread.
+  auto complete = [&](TargetWalkNode &node) {
+    for (auto *current = &node; current; current = current->parent) {
+      current->childrenTiming.stop();
+      if (!current->failed) {
+        llvm::SmallVector<std::optional<size_t>> waitedOn{
+            lastStage(*current)};
+        for (auto *childNode : current->children)
+          waitedOn.push_back(childNode->postStage);
+        if (auto err = runStage(*current, "post-children",
+                                postChildrenCallbackFunc, current->postStage,
+                                waitedOn))
+          recordError(*current, std::move(err));
+      }
+      current->timing.stop();
+
+      auto *parent = current->parent;
+      if (!parent)
+        return;
+      if (current->failed)
+        parent->failed = true;
+      if (parent->pending.fetch_sub(1) != 1)
+        return; // siblings or the parent's emission remain
+    }
+  };
+
+  std::function<void(TargetWalkNode &)> visit;
+  std::function<void(TargetWalkNode &)> emit;
 
-    auto childrenTiming = parentTiming.nest("children");
+  auto visitChildren = [&](TargetWalkNode &node) {
+    if (node.children.empty())
+      return;
+
+    node.childrenTiming = node.timing.nest("children");
+    for (auto *childNode : node.children)
+      schedule([&visit, childNode]() { visit(*childNode); });
+  };
 
-    std::unordered_map<Target *, mlir::ModuleOp> childrenModules;
-    for (auto *childTarget : children) {
-      auto childModuleOp = childTarget->getModule(targetModuleOp);
-      if (auto err = childModuleOp.takeError())
-        return err;
-      childrenModules[childTarget] = *childModuleOp;
+  emit = [&](TargetWalkNode &node) {
+    bool const parentFailed = node.parent && node.parent->failed;
+    auto const parentEmitStage =
+        node.parent ? node.parent->emitStage : std::nullopt;
+    if (emitFunc && !node.failed && !parentFailed)
+      if (auto err = runStage(node, "emit", emitFunc, node.emitStage,
+                              {node.visitStage, parentEmitStage}))
+        recordError(node, std::move(err));
+
+    if (!node.emitsConcurrently) {
+      if (node.failed)
+        node.pending = 1; // the children are never visited
+      else
+        visitChildren(node);
+    } else {
+      for (auto *childNode : node.children)
+        if (childNode->pendingEmit.fetch_sub(1) == 1)
+          schedule([&emit, childNode]() { emit(*childNode); });
     }
 
-    auto parallelWalkFunc = [&](Target *childTarget) {
-      // Recurse on this target's children in a depth first fashion.
+    if (node.pending.fetch_sub(1) == 1)
+      complete(node);
+  };
 
-      if (auto err = walkTargetModulesThreaded(
-              childTarget, childrenModules[childTarget], childrenTiming,
-              walkFunc, postChildrenCallbackFunc)) {
-        llvm::errs() << err << "\n";
-        return mlir::failure();
+  visit = [&](TargetWalkNode &node) {
+    node.timing = node.parentTiming->nest(node.target->getName());
+    node.emitsConcurrently =
+        !emitFunc || node.target->emitsIndependentlyOfChildren();
+
+    // Children of targets which do not emit concurrently wait on their
+    // parent's emission.
+    std::optional<size_t> parentStage;
+    if (node.parent)
+      parentStage = node.parent->emitsConcurrently ? node.parent->visitStage
+                                                   : lastStage(*node.parent);
+
+    if (auto err = runStage(node, "compile", walkFunc, node.visitStage,
+                            {parentStage})) {
+      recordError(node, std::move(err));
+    } else if (skipChildren && skipChildren(node.target)) {
+      // the subtree of the target was walked as a whole
+    } else if (auto err = node.target->instantiateChildren(node.moduleOp)) {
+      recordError(node, std::move(err));
+    } else {
+      // Get child modules before scheduling any child to preserve MLIR
+      // parallelization rules
+      llvm::SmallVector<std::pair<hal::Target *, mlir::ModuleOp>> children;
+      for (auto *childTarget : node.target->getChildren()) {
+        auto childModuleOp = childTarget->getModule(node.moduleOp);
+        if (auto err = childModuleOp.takeError()) {
+          recordError(node, std::move(err));
+          children.clear();
+          break;
+        }
+        children.emplace_back(childTarget, *childModuleOp);
       }
 
-      return mlir::success();
-    };
+      // Children of a concurrently emitting target also wait on its emission.
+      unsigned const childPendingEmit = node.emitsConcurrently ? 2 : 1;
+      const std::lock_guard<std::mutex> lock(mutex);
+      for (auto &[childTarget, childModuleOp] : children)
+        node.children.push_back(
+            &nodes.emplace_back(childTarget, childModuleOp, &node,
+                                &node.childrenTiming, childPendingEmit));
+    }
 
-    // By utilizing the MLIR parallelism methods, we automatically inherit the
-    // multiprocessing settings from the context.
-    if (mlir::failed(mlir::failableParallelForEach(getContext(), children,
-                                                   parallelWalkFunc)))
-      return llvm::createStringError(
-          llvm::inconvertibleErrorCode(),
-          "Problems encountered while walking children of target " +
-              target->getName());
-  }
+    node.pending = node.children.size() + 1;
+    if (node.emitsConcurrently)
+      visitChildren(node);
 
-  if (auto err = postChildrenCallbackFunc(target, targetModuleOp, parentTiming))
-    return err;
+    if (node.pendingEmit.fetch_sub(1) == 1)
+      emit(node);
+  };
 
-  return llvm::Error::success();
+  TargetWalkNode root(target, targetModuleOp, nullptr, &timing,
+                      /*pendingEmit=*/1);
+  visit(root);
+  if (tasks)
+    tasks->wait();
+
+  if (trace)
+    if (auto err = trace->write(*getTracePath()))
+      errors = llvm::joinErrors(std::move(errors), std::move(err));
+
+  return errors;
 }
 
 llvm::Error ThreadedCompilationManager::walkTargetThreaded(
@@ -151,6 +425,16 @@ llvm::Error ThreadedCompilationManager::walkTargetThreaded(
 llvm::Error ThreadedCompilationManager::buildTargetPassManagers_(
     Target &target, mlir::TimingScope &timing) {
 
+  // Pass managers are reusable across compilations and are only built once.
+  auto const buildLock = lockRecordingContention<MutexLock>(
+      passManagerPools_->buildMutex, "pass-manager-build");
+  {
+    auto const lock = lockRecordingContention<SharedLock>(
+        passManagerPools_->mutex, "pass-manager-pools");
+    if (passManagerPools_->built)
+      return llvm::Error::success();
+  }
+
   auto buildPMTiming = timing.nest("build-target-pass-managers");
 
   // Create dummy timing scope for pass manager building
@@ -159,24 +443,61 @@ llvm::Error ThreadedCompilationManager::buildTargetPassManagers_(
 
   auto threadedBuildTargetPassManager =
       [&](hal::Target *target, mlir::TimingScope &timing) -> llvm::Error {
-    auto &pm = createTargetPassManager_(target);
+    return buildTargetPassManager_(*target, timing);
+  };
 
-    if (auto err = pmBuilder(pm))
-      return err;
+  if (auto err = walkTargetThreaded(&getTargetSystem(), targetsTiming,
+                                    threadedBuildTargetPassManager))
+    return err;
 
-    target->enableTiming(timing);
-    if (auto err = target->addPasses(pm))
-      return err;
-    target->disableTiming();
+  auto const lock = lockRecordingContention<UniqueLock>(
+      passManagerPools_->mutex, "pass-manager-pools");
+  passManagerPools_->built = true;
+  return llvm::Error::success();
+}
 
-    registerPassManagerWithContext_(pm);
+llvm::Error
+ThreadedCompilationManager::buildTargetPassManager_(Target &target,
+                                                    mlir::TimingScope &timing) {
+  // The prototype is only published to the pools once complete as
+  // compilations may check out pass managers of other targets meanwhile.
+  mlir::PassManager prototype(getContext());
+  if (auto err = pmBuilder(prototype))
+    return err;
 
-    return llvm::Error::success();
-  };
+  target.enableTiming(timing);
+  if (auto err = target.addPasses(prototype))
+    return err;
+  target.disableTiming();
 
-  auto err = walkTargetThreaded(&getTargetSystem(), targetsTiming,
-                                threadedBuildTargetPassManager);
-  return err;
+  registerPassManagerWithContext_(prototype);
+
+  // Seed the pool so that the first compilation does not clone.
+  auto pm = std::make_unique<mlir::PassManager>(
+      getContext(), prototype.getOpAnchorName(), prototype.getNesting());
+  if (auto err = pmBuilder(*pm))
+    return err;
+  static_cast<mlir::OpPassManager &>(*pm) = prototype;
+
+  auto const lock = lockRecordingContention<UniqueLock>(
+      passManagerPools_->mutex, "pass-manager-pools");
+  auto &pool =
+      passManagerPools_->pools.try_emplace(&target, getContext()).first->second;
+  static_cast<mlir::OpPassManager &>(pool.prototype) = prototype;
+  pool.available.push_back(std::move(pm));
+  return llvm::Error::success();
+}
+
+void ThreadedCompilationManager::invalidateTargetPassManagers() {
+  auto const lock = lockRecordingContention<UniqueLock>(
+      passManagerPools_->mutex, "pass-manager-pools");
+  passManagerPools_->pools.clear();
+  passManagerPools_->built = false;
+}
+
+void ThreadedCompilationManager::invalidateEmittedTargets() {
+  const std::lock_guard<std::mutex> lock(emittedTargetsMutex_);
+  emittedTargets_.clear();
 }
 
 // Mirroring mlir::PassManager::run() we register all of the pass's dependent
@@ -190,25 +511,75 @@ void ThreadedCompilationManager::registerPassManagerWithContext_(
   pm.getDependentDialects(dependentDialects);
   auto *context = getContext();
 
-  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
-  std::unique_lock const lock(contextMutex_);
+  auto const lock =
+      lockRecordingContention<MutexLock>(contextMutex_, "context");
   context->appendDialectRegistry(dependentDialects);
   for (llvm::StringRef const name : dependentDialects.getDialectNames())
     context->getOrLoadDialect(name);
 }
 
-mlir::PassManager &
-ThreadedCompilationManager::getTargetPassManager_(Target *target) {
-  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
-  std::shared_lock const lock(targetPassManagersMutex_);
-  return targetPassManagers_.at(target);
+llvm::Expected<std::unique_ptr<mlir::PassManager>>
+ThreadedCompilationManager::acquireTargetPassManager_(Target *target) {
+  {
+    auto const lock = lockRecordingContention<SharedLock>(
+        passManagerPools_->mutex, "pass-manager-pools");
+    auto it = passManagerPools_->pools.find(target);
+    if (it != passManagerPools_->pools.end()) {
+      auto &pool = it->second;
+      {
+        auto const poolLock =
+            lockRecordingContention<MutexLock>(pool.mutex, "pass-manager-pool");
+        if (!pool.available.empty()) {
+          auto pm = std::move(pool.available.back());
+          pool.available.pop_back();
+          return pm;
+        }
+      }
+
+      // The clone has the same dependent dialects as the prototype which
+      // have already been registered with the context.
+      auto pm = std::make_unique<mlir::PassManager>(
+          getContext(), pool.prototype.getOpAnchorName(),
+          pool.prototype.getNesting());
+      if (auto err = pmBuilder(*pm))
+        return std::move(err);
+      static_cast<mlir::OpPassManager &>(*pm) = pool.prototype;
+      return pm;
+    }
+  }
+
+  // Targets instantiated after the pass managers were built, e.g., the
+  // children a target only creates for the modules it compiled, have theirs
+  // built on first use.
+  {
+    auto const buildLock = lockRecordingContention<MutexLock>(
+        passManagerPools_->buildMutex, "pass-manager-build");
+    bool isBuilt = false;
+    {
+      auto const lock = lockRecordingContention<SharedLock>(
+          passManagerPools_->mutex, "pass-manager-pools");
+      isBuilt = passManagerPools_->pools.count(target);
+    }
+    if (!isBuilt) {
+      auto timing = mlir::TimingScope();
+      if (auto err = buildTargetPassManager_(*target, timing))
+        return std::move(err);
+    }
+  }
+  return acquireTargetPassManager_(target);
 }
 
-mlir::PassManager &
-ThreadedCompilationManager::createTargetPassManager_(Target *target) {
-  // NOLINTNEXTLINE(clang-diagnostic-ctad-maybe-unsupported)
-  std::unique_lock const lock(targetPassManagersMutex_);
-  return targetPassManagers_.emplace(target, getContext()).first->second;
+void ThreadedCompilationManager::releaseTargetPassManager_(
+    Target *target, std::unique_ptr<mlir::PassManager> pm) {
+  auto const lock = lockRecordingContention<SharedLock>(
+      passManagerPools_->mutex, "pass-manager-pools");
+  auto it = passManagerPools_->pools.find(target);
+  // Pass managers checked out before invalidation are discarded.
+  if (it == passManagerPools_->pools.end())
+    return;
+  auto const poolLock =
+      lockRecordingContention<MutexLock>(it->second.mutex, "pass-manager-pool");
+  it->second.available.push_back(std::move(pm));
 }
 
 llvm::Error ThreadedCompilationManager::compileMLIR(mlir::ModuleOp moduleOp) {
@@ -247,13 +618,29 @@ llvm::Error ThreadedCompilationManager::compileMLIR(mlir::ModuleOp moduleOp) {
 
 llvm::Error ThreadedCompilationManager::compileMLIRTarget_(
     Target &target, mlir::ModuleOp targetModuleOp, mlir::TimingScope &timing) {
+  if (const auto *cancellation = getCancellation())
+    if (auto err = cancellation->check())
+      return err;
+
   if (getPrintBeforeAllTargetPasses())
     printIR("IR dump before running passes for target " + target.getName(),
             targetModuleOp, llvm::outs());
 
   auto targetPassesTiming = timing.nest("passes");
-  mlir::PassManager &pm = getTargetPassManager_(&target);
+  MetricsTimer const targetPassesTimer(
+      "qssc_target_stage_duration_seconds",
+      "Seconds spent in the stages of the compilation of a target",
+      {{"target", target.getName().str()}, {"stage", "passes"}});
+  auto pmOrError = acquireTargetPassManager_(&target);
+  if (auto err = pmOrError.takeError())
+    return err;
+  auto releasePM = llvm::make_scope_exit([&]() {
+    releaseTargetPassManager_(&target, std::move(*pmOrError));
+  });
+  mlir::PassManager &pm = **pmOrError;
   pm.enableTiming(targetPassesTiming);
+  if (auto *passMetrics = getPassMetrics())
+    pm.addInstrumentation(passMetrics->createInstrumentation(target.getName()));
 
   if (mlir::failed(pm.run(targetModuleOp))) {
     if (getPrintAfterTargetCompileFailure())
@@ -265,6 +652,21 @@ llvm::Error ThreadedCompilationManager::compileMLIRTarget_(
         "Problems running the pass pipeline for target " + target.getName());
   }
 
+  // The passes of a cancelled compilation are skipped, see
+  // CompileCancellation::skipPassesOnceCancelled.
+  if (const auto *cancellation = getCancellation())
+    if (auto err = cancellation->check())
+      return err;
+
+  if (getVerifyAfterTargetPasses()) {
+    auto verifyTiming = targetPassesTiming.nest("verify");
+    if (mlir::failed(mlir::verify(targetModuleOp)))
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Failed to verify the module of target " + target.getName() +
+              " after its passes");
+  }
+
   if (getPrintAfterAllTargetPasses())
     printIR("IR dump after running passes for target " + target.getName(),
             targetModuleOp, llvm::outs());
@@ -276,6 +678,23 @@ llvm::Error
 ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
                                            qssc::payload::Payload &payload,
                                            bool doCompileMLIR) {
+  return compilePayloadSubtree(getTargetSystem(), moduleOp, payload,
+                               doCompileMLIR);
+}
+
+llvm::Expected<std::map<std::string, std::string>>
+ThreadedCompilationManager::compileDelegatedSubtree(
+    Target &target, mlir::ModuleOp targetModuleOp,
+    llvm::StringRef payloadPrefix, bool doCompileMLIR,
+    mlir::TimingScope &timing) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Unable to delegate the subtree of target " +
+                                     target.getName());
+}
+
+llvm::Error ThreadedCompilationManager::compilePayloadSubtree(
+    Target &root, mlir::ModuleOp moduleOp, qssc::payload::Payload &payload,
+    bool doCompileMLIR) {
 
   auto compilePayloadTiming = getTimer("compile-payload");
 
@@ -286,20 +705,107 @@ ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
   if (auto err = buildTargetPassManagers_(target, compilePayloadTiming))
     return err;
 
+  // The fingerprints of the targets whose payload may be reused, along with
+  // their previously emitted payload if it is still valid. Targets are
+  // fingerprinted before they are compiled as their modules change in place.
+  // Delegated subtrees are replayed like reused payloads once compiled.
+  struct TargetEmission {
+    std::string fingerprint;
+    std::shared_ptr<const EmittedTarget> reused;
+    bool delegated = false;
+  };
+  std::mutex emissionsMutex; // guards emissions
+  std::map<Target *, TargetEmission> emissions;
+
+  auto isDelegated = [&](hal::Target *target) {
+    const std::lock_guard<std::mutex> lock(emissionsMutex);
+    auto pos = emissions.find(target);
+    return pos != emissions.end() && pos->second.delegated;
+  };
+
   auto threadedCompilePayloadTarget =
       [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
           mlir::TimingScope &timing) -> llvm::Error {
-    if (auto err = compilePayloadTarget_(*target, targetModuleOp, payload,
-                                         timing, doCompileMLIR))
+    if (target != &root && delegatesSubtree(*target)) {
+      if (const auto *cancellation = getCancellation())
+        if (auto err = cancellation->check())
+          return err;
+      auto delegated = std::make_shared<EmittedTarget>();
+      delegated->prefix = payload.getPrefix();
+      auto files = compileDelegatedSubtree(*target, targetModuleOp,
+                                           delegated->prefix, doCompileMLIR,
+                                           timing);
+      if (!files)
+        return files.takeError();
+      delegated->files = std::move(*files);
+      const std::lock_guard<std::mutex> lock(emissionsMutex);
+      emissions[target] = {"", std::move(delegated), /*delegated=*/true};
+      return llvm::Error::success();
+    }
+
+    if (auto fingerprint =
+            fingerprintTarget_(*target, targetModuleOp, doCompileMLIR)) {
+      auto reused = lookupEmittedTarget_(target, *fingerprint);
+      bool const isReused = reused != nullptr;
+      MetricsRegistry::instance().increment(
+          "qssc_target_payload_reuses_total",
+          "Lookups of the previously emitted payload of a target",
+          {{"target", target->getName().str()},
+           {"result", isReused ? "hit" : "miss"}});
+      {
+        const std::lock_guard<std::mutex> lock(emissionsMutex);
+        emissions[target] = {std::move(*fingerprint), std::move(reused)};
+      }
+      if (isReused)
+        return llvm::Error::success();
+    }
+
+    if (!doCompileMLIR)
+      return llvm::Error::success();
+    return compileMLIRTarget_(*target, targetModuleOp, timing);
+  };
+
+  auto threadedEmitPayloadTarget =
+      [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
+          mlir::TimingScope &timing) -> llvm::Error {
+    std::optional<TargetEmission> emission;
+    {
+      const std::lock_guard<std::mutex> lock(emissionsMutex);
+      auto pos = emissions.find(target);
+      if (pos != emissions.end())
+        emission = pos->second;
+    }
+
+    if (!emission)
+      return emitPayloadTarget_(*target, targetModuleOp, payload, timing);
+
+    if (emission->reused) {
+      replayEmittedTarget_(*emission->reused, payload,
+                           getPayloadGroup(*target));
+      return llvm::Error::success();
+    }
+
+    auto emitted = std::make_shared<EmittedTarget>();
+    emitted->fingerprint = std::move(emission->fingerprint);
+    emitted->prefix = payload.getPrefix();
+    if (auto err = emitPayloadTarget_(*target, targetModuleOp, payload, timing,
+                                      &emitted->files))
       return err;
+    storeEmittedTarget_(target, std::move(emitted));
     return llvm::Error::success();
   };
 
   auto postChildrenEmitToPayload =
       [&](hal::Target *target, mlir::ModuleOp targetModuleOp,
           mlir::TimingScope &timing) -> llvm::Error {
+    // emitted with its subtree
+    if (isDelegated(target))
+      return llvm::Error::success();
+
     auto emitToPayloadTiming = timing.nest("emit-to-payload-post-children");
     target->enableTiming(emitToPayloadTiming);
+    qssc::payload::Payload::EmissionScope const emissionScope(
+        payload, /*emittedFiles=*/nullptr, getPayloadGroup(*target));
     if (auto err = target->emitToPayloadPostChildren(targetModuleOp, payload))
       return err;
     target->disableTiming();
@@ -308,19 +814,19 @@ ThreadedCompilationManager::compilePayload(mlir::ModuleOp moduleOp,
   };
 
   auto targetsTiming = compilePayloadTiming.nest("compile-system");
-  auto err = walkTargetModulesThreaded(&target, moduleOp, targetsTiming,
-                                       threadedCompilePayloadTarget,
-                                       postChildrenEmitToPayload);
+  auto err = walkTargetModulesThreaded(
+      &root, moduleOp, targetsTiming, threadedCompilePayloadTarget,
+      threadedEmitPayloadTarget, postChildrenEmitToPayload, isDelegated);
   return err;
 }
 
-llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
+llvm::Error ThreadedCompilationManager::emitPayloadTarget_(
     Target &target, mlir::ModuleOp targetModuleOp,
     qssc::payload::Payload &payload, mlir::TimingScope &timing,
-    bool doCompileMLIR) {
+    std::map<std::string, std::string> *emittedFiles) {
 
-  if (doCompileMLIR)
-    if (auto err = compileMLIRTarget_(target, targetModuleOp, timing))
+  if (const auto *cancellation = getCancellation())
+    if (auto err = cancellation->check())
       return err;
 
   if (getPrintBeforeAllTargetPayload())
@@ -328,7 +834,15 @@ llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
             targetModuleOp, llvm::outs());
 
   auto emitToPayloadTiming = timing.nest("emit-to-payload");
+  MetricsTimer const emitToPayloadTimer(
+      "qssc_target_stage_duration_seconds",
+      "Seconds spent in the stages of the compilation of a target",
+      {{"target", target.getName().str()}, {"stage", "emit"}});
   target.enableTiming(emitToPayloadTiming);
+  // The files of the target are complete once it has emitted them which lets
+  // streaming payloads archive them while the remaining targets compile.
+  qssc::payload::Payload::EmissionScope const emissionScope(
+      payload, emittedFiles, getPayloadGroup(target));
   if (auto err = target.emitToPayload(targetModuleOp, payload)) {
     if (getPrintAfterTargetCompileFailure())
       printIR("IR dump after failure emitting payload for target " +
@@ -338,11 +852,86 @@ llvm::Error ThreadedCompilationManager::compilePayloadTarget_(
   }
   target.disableTiming();
 
+  // Targets may run passes of their own while emitting, which are skipped
+  // once cancelled, so the payload of the target is dropped rather than
+  // reused by later compilations.
+  if (const auto *cancellation = getCancellation())
+    if (auto err = cancellation->check())
+      return err;
+
   return llvm::Error::success();
 }
 
+std::optional<std::string> ThreadedCompilationManager::fingerprintTarget_(
+    Target &target, mlir::ModuleOp targetModuleOp, bool doCompileMLIR) {
+  // The payload of a target with children may depend on their modules and
+  // requested IR dumps must see the target compile.
+  if (target.getNumChildren() > 0 || getPrintBeforeAllTargetPasses() ||
+      getPrintAfterAllTargetPasses() || getPrintBeforeAllTargetPayload())
+    return std::nullopt;
+
+  auto configurationFingerprint = target.getConfigurationFingerprint();
+  if (!configurationFingerprint)
+    return std::nullopt;
+
+  std::string moduleIR;
+  llvm::raw_string_ostream moduleStream(moduleIR);
+  targetModuleOp->print(moduleStream, mlir::OpPrintingFlags()
+                                          .enableDebugInfo()
+                                          .printGenericOpForm()
+                                          .useLocalScope());
+  moduleStream.flush();
+
+  llvm::SHA256 hasher;
+  // Length prefix the fields so that adjacent fields cannot alias.
+  auto hashField = [&](llvm::StringRef field) {
+    uint64_t const size = field.size();
+    hasher.update(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(&size), sizeof(size)));
+    hasher.update(field);
+  };
+  hashField(target.getName());
+  hashField(*configurationFingerprint);
+  hashField(doCompileMLIR ? "compile" : "bypass");
+  hashField(moduleIR);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+auto ThreadedCompilationManager::lookupEmittedTarget_(
+    Target *target, llvm::StringRef fingerprint)
+    -> std::shared_ptr<const EmittedTarget> {
+  const std::lock_guard<std::mutex> lock(emittedTargetsMutex_);
+  auto pos = emittedTargets_.find(target);
+  if (pos == emittedTargets_.end() || pos->second->fingerprint != fingerprint)
+    return nullptr;
+  return pos->second;
+}
+
+void ThreadedCompilationManager::storeEmittedTarget_(
+    Target *target, std::shared_ptr<const EmittedTarget> emitted) {
+  const std::lock_guard<std::mutex> lock(emittedTargetsMutex_);
+  emittedTargets_[target] = std::move(emitted);
+}
+
+void ThreadedCompilationManager::replayEmittedTarget_(
+    const EmittedTarget &emitted, qssc::payload::Payload &payload,
+    llvm::StringRef group) {
+  // The files are sealed together as if the target had emitted them.
+  qssc::payload::Payload::EmissionScope const emissionScope(
+      payload, /*emittedFiles=*/nullptr, group);
+  for (const auto &[fileName, contents] : emitted.files) {
+    llvm::StringRef name(fileName);
+    // Members are named after the output of the compilation.
+    if (name.consume_front(emitted.prefix))
+      payload.addFile(payload.getPrefix() + name.str(), contents);
+    else
+      payload.addFile(name, contents);
+  }
+}
+
 void ThreadedCompilationManager::printIR(llvm::Twine msg, mlir::Operation *op,
                                          llvm::raw_ostream &out) {
-  const std::lock_guard<std::mutex> lock(printIRMutex_);
+  auto const lock =
+      lockRecordingContention<MutexLock>(printIRMutex_, "print-ir");
   TargetCompilationManager::printIR(msg, op, out);
 }
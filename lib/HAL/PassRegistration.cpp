@@ -17,6 +17,7 @@
 #include "HAL/PassRegistration.h"
 #include "HAL/TargetSystemRegistry.h"
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
 #include <utility>
@@ -43,3 +44,11 @@ llvm::Error hal::registerTargetPipelines() {
   }
   return err;
 }
+
+llvm::Error hal::registerTargetPassesAndPipelines(llvm::StringRef targetName) {
+  auto target = registry::TargetSystemRegistry::lookupPluginInfo(targetName);
+  if (!target.has_value())
+    return llvm::Error::success();
+  return llvm::joinErrors(target.value()->registerTargetPasses(),
+                          target.value()->registerTargetPassPipelines());
+}
@@ -20,4 +20,99 @@
 
 #include "HAL/SystemConfiguration.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <system_error>
+
+using namespace qssc::hal;
+
 qssc::hal::SystemConfiguration::~SystemConfiguration() = default;
+
+ConfigurationFormat
+qssc::hal::detectConfigurationFormat(llvm::StringRef contents) {
+  if (contents.startswith(binaryConfigurationMagic))
+    return ConfigurationFormat::Binary;
+  if (contents.ltrim().startswith("{"))
+    return ConfigurationFormat::JSON;
+  return ConfigurationFormat::Text;
+}
+
+llvm::Expected<llvm::json::Object>
+qssc::hal::parseJSONConfiguration(llvm::StringRef contents,
+                                  uint32_t schemaVersion) {
+  auto value = llvm::json::parse(contents);
+  if (!value)
+    return value.takeError();
+  auto *object = value->getAsObject();
+  if (!object)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Configuration must be a JSON object");
+  auto version = object->getInteger("schemaVersion");
+  if (!version)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Configuration has no schemaVersion");
+  if (*version != schemaVersion)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Unsupported configuration schemaVersion %lld, expected %u",
+        static_cast<long long>(*version), schemaVersion);
+  return std::move(*object);
+}
+
+llvm::Error
+qssc::hal::consumeBinaryConfigurationHeader(llvm::StringRef &contents,
+                                            uint32_t schemaVersion) {
+  if (!contents.consume_front(binaryConfigurationMagic))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Not a binary configuration");
+  auto version = consumeBinaryUInt32(contents);
+  if (!version)
+    return version.takeError();
+  if (*version != schemaVersion)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Unsupported binary configuration schema version %u, expected %u",
+        *version, schemaVersion);
+  return llvm::Error::success();
+}
+
+llvm::Expected<uint32_t>
+qssc::hal::consumeBinaryUInt32(llvm::StringRef &contents) {
+  if (contents.size() < sizeof(uint32_t))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Truncated binary configuration");
+  uint32_t const value =
+      llvm::support::endian::read32le(contents.bytes_begin());
+  contents = contents.drop_front(sizeof(uint32_t));
+  return value;
+}
+
+void qssc::hal::writeBinaryConfigurationHeader(llvm::raw_ostream &os,
+                                               uint32_t schemaVersion) {
+  os << binaryConfigurationMagic;
+  writeBinaryUInt32(os, schemaVersion);
+}
+
+void qssc::hal::writeBinaryUInt32(llvm::raw_ostream &os, uint32_t value) {
+  char bytes[sizeof(uint32_t)];
+  llvm::support::endian::write32le(bytes, value);
+  os.write(bytes, sizeof(bytes));
+}
+
+llvm::Expected<ConfigurationFileStamp>
+qssc::hal::getConfigurationFileStamp(llvm::StringRef path) {
+  llvm::sys::fs::file_status status;
+  if (std::error_code const err = llvm::sys::fs::status(path, status))
+    return llvm::createStringError(err, "Problem opening file %s",
+                                   path.str().c_str());
+  ConfigurationFileStamp stamp;
+  stamp.modificationTime = status.getLastModificationTime();
+  stamp.size = status.getSize();
+  return stamp;
+}
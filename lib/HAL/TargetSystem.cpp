@@ -48,6 +48,9 @@ void Target::enableTiming(mlir::TimingScope &timingScope) {
 void Target::disableTiming() { rootTimer.stop(); }
 
 mlir::TimingScope Target::getTimer(llvm::StringRef name) {
+  // Without timing or profiler markers the root timer is inactive.
+  if (!rootTimer)
+    return mlir::TimingScope();
   return rootTimer.nest(name);
 }
 
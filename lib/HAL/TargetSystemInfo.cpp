@@ -14,7 +14,9 @@
 
 #include "HAL/TargetSystemInfo.h"
 
+#include "HAL/SystemConfiguration.h"
 #include "HAL/TargetSystem.h"
+#include "HAL/TargetSystemRegistry.h"
 
 #include "mlir/IR/MLIRContext.h"
 
@@ -22,8 +24,11 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <utility>
 
 // Inject static initialization headers from targets. We need to include them in
@@ -38,8 +43,21 @@ using namespace qssc::hal::registry;
 /// members.
 /// Details: https://en.cppreference.com/w/cpp/language/pimpl
 struct TargetSystemInfo::Impl {
-  llvm::DenseMap<mlir::MLIRContext *, std::unique_ptr<TargetSystem>>
+  /// A target created for a configuration, along with the stamp of its
+  /// configuration file when it was created if it could be read.
+  struct SharedTarget {
+    std::optional<ConfigurationFileStamp> stamp;
+    std::shared_ptr<TargetSystem> target;
+  };
+
+  mutable std::mutex mutex; // guards managedTargets and sharedTargets
+  llvm::DenseMap<mlir::MLIRContext *, std::shared_ptr<TargetSystem>>
       managedTargets{};
+  /// The targets by configuration path, "" without configuration.
+  std::map<std::string, SharedTarget> sharedTargets{};
+
+  mutable std::once_flag passesRegistered;
+  mutable std::once_flag passPipelinesRegistered;
 };
 
 TargetSystemInfo::TargetSystemInfo(
@@ -55,15 +73,47 @@ TargetSystemInfo::~TargetSystemInfo() = default;
 llvm::Expected<qssc::hal::TargetSystem *> TargetSystemInfo::createTarget(
     mlir::MLIRContext *context,
     std::optional<PluginInfo::PluginConfiguration> configuration) {
-  auto target = PluginInfo::createPluginInstance(configuration);
-  if (!target)
-    return target.takeError();
-  impl->managedTargets[context] = std::move(target.get());
-  return impl->managedTargets[context].get();
+  std::string const key = configuration ? configuration->str() : "";
+  std::optional<ConfigurationFileStamp> stamp;
+  if (configuration) {
+    auto fileStamp = getConfigurationFileStamp(*configuration);
+    if (fileStamp)
+      stamp = *fileStamp;
+    else
+      llvm::consumeError(fileStamp.takeError());
+  }
+
+  std::shared_ptr<TargetSystem> shared;
+  {
+    const std::lock_guard<std::mutex> lock(impl->mutex);
+    auto it = impl->sharedTargets.find(key);
+    if (it != impl->sharedTargets.end() && it->second.stamp == stamp)
+      shared = it->second.target;
+  }
+
+  // Created without the lock as concurrent jobs may create other targets.
+  if (!shared) {
+    auto target = PluginInfo::createPluginInstance(configuration);
+    if (!target)
+      return target.takeError();
+    shared = std::move(target.get());
+  }
+
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  auto &sharedTarget = impl->sharedTargets[key];
+  // A concurrent creation for the same configuration may have won.
+  if (sharedTarget.target && sharedTarget.stamp == stamp)
+    shared = sharedTarget.target;
+  else
+    sharedTarget = {stamp, shared};
+  impl->managedTargets[context] = shared;
+  TargetSystemRegistry::invalidateTargetCache(context);
+  return shared.get();
 }
 
 llvm::Expected<qssc::hal::TargetSystem *>
 TargetSystemInfo::getTarget(mlir::MLIRContext *context) const {
+  const std::lock_guard<std::mutex> lock(impl->mutex);
   auto it = impl->managedTargets.find(context);
   if (it != impl->managedTargets.end())
     return it->getSecond().get();
@@ -78,10 +128,26 @@ TargetSystemInfo::getTarget(mlir::MLIRContext *context) const {
                                      "' registered for the given context.\n");
 }
 
+void TargetSystemInfo::releaseTarget(mlir::MLIRContext *context) {
+  const std::lock_guard<std::mutex> lock(impl->mutex);
+  impl->managedTargets.erase(context);
+  TargetSystemRegistry::invalidateTargetCache(context);
+}
+
 llvm::Error TargetSystemInfo::registerTargetPasses() const {
-  return passRegistrar();
+  llvm::Error err = llvm::Error::success();
+  std::call_once(impl->passesRegistered, [&]() {
+    llvm::cantFail(std::move(err));
+    err = passRegistrar();
+  });
+  return err;
 }
 
 llvm::Error TargetSystemInfo::registerTargetPassPipelines() const {
-  return passPipelineRegistrar();
+  llvm::Error err = llvm::Error::success();
+  std::call_once(impl->passPipelinesRegistered, [&]() {
+    llvm::cantFail(std::move(err));
+    err = passPipelineRegistrar();
+  });
+  return err;
 }
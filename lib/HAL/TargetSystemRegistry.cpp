@@ -21,11 +21,19 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/PassManager.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
 
 using namespace qssc::hal::registry;
 
@@ -45,6 +53,22 @@ public:
     return llvm::Error::success();
   }
 };
+
+/// The targets found by lookupTarget by context and name. Each invalidation
+/// advances the generation, so that targets found concurrently with it are
+/// not cached.
+struct TargetCache {
+  std::shared_mutex mutex; // guards targets and generation
+  llvm::DenseMap<std::pair<mlir::MLIRContext *, llvm::StringRef>,
+                 qssc::hal::TargetSystem *>
+      targets;
+  uint64_t generation = 0;
+};
+
+TargetCache &targetCache() {
+  static TargetCache cache;
+  return cache;
+}
 } // namespace
 
 TargetSystemInfo *TargetSystemRegistry::nullTargetSystemInfo() {
@@ -58,3 +82,69 @@ TargetSystemInfo *TargetSystemRegistry::nullTargetSystemInfo() {
       []() { return llvm::Error::success(); });
   return nullTarget.get();
 }
+
+void TargetSystemRegistry::releaseTargets(mlir::MLIRContext *context) {
+  for (const auto &target : registeredPlugins())
+    if (auto info = lookupPluginInfo(target.getKey()))
+      (*info)->releaseTarget(context);
+  nullTargetSystemInfo()->releaseTarget(context);
+}
+
+llvm::Expected<qssc::hal::TargetSystem *>
+TargetSystemRegistry::lookupTarget(mlir::MLIRContext *context,
+                                   llvm::StringRef name,
+                                   llvm::ArrayRef<std::string> fallbackNames) {
+  auto &cache = targetCache();
+  uint64_t generation = 0;
+  {
+    const std::shared_lock<std::shared_mutex> lock(cache.mutex);
+    auto it = cache.targets.find({context, name});
+    if (it != cache.targets.end())
+      return it->second;
+    generation = cache.generation;
+  }
+
+  auto targetInfo = lookupPluginInfo(name);
+  if (!targetInfo)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Error: target '" + name +
+                                       "' is not registered.\n");
+
+  auto target = targetInfo.value()->getTarget(context);
+  if (!target) {
+    // look for a fallback target that matches
+    for (const auto &fallbackName : fallbackNames) {
+      auto fallbackInfo = lookupPluginInfo(fallbackName);
+      if (!fallbackInfo)
+        continue;
+      llvm::consumeError(target.takeError());
+      target = fallbackInfo.value()->getTarget(context);
+      if (target)
+        break;
+    }
+    if (!target)
+      return target.takeError();
+  }
+
+  // The name of the plugin outlives the cache, unlike the name looked up.
+  const std::unique_lock<std::shared_mutex> lock(cache.mutex);
+  if (cache.generation == generation)
+    cache.targets[{context, targetInfo.value()->getName()}] = *target;
+  return *target;
+}
+
+void TargetSystemRegistry::invalidateTargetCache(mlir::MLIRContext *context) {
+  auto &cache = targetCache();
+  const std::unique_lock<std::shared_mutex> lock(cache.mutex);
+  ++cache.generation;
+  if (!context) {
+    cache.targets.clear();
+    return;
+  }
+  llvm::SmallVector<std::pair<mlir::MLIRContext *, llvm::StringRef>> stale;
+  for (const auto &entry : cache.targets)
+    if (entry.first.first == context)
+      stale.push_back(entry.first);
+  for (const auto &key : stale)
+    cache.targets.erase(key);
+}
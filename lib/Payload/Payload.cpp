@@ -20,10 +20,16 @@
 
 #include "Payload/Payload.h"
 
+#include "llvm/ADT/StringRef.h"
+
 #include <algorithm>
+#include <cstddef>
 #include <filesystem>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Inject static initialization headers from payloads. We need to include them
@@ -34,9 +40,128 @@
 using namespace qssc::payload;
 namespace fs = std::filesystem;
 
+namespace {
+// innermost emission scope of this thread
+thread_local Payload::EmissionScope *activeEmissionScope = nullptr;
+} // end anonymous namespace
+
+Payload::EmissionScope::EmissionScope(
+    Payload &payload, std::map<std::string, std::string> *emittedFiles,
+    llvm::StringRef group)
+    : payload(payload), emittedFiles(emittedFiles), group(group),
+      previous(activeEmissionScope) {
+  activeEmissionScope = this;
+}
+
+Payload::EmissionScope::~EmissionScope() {
+  activeEmissionScope = previous;
+  payload.commitStreams(*this);
+  if (emittedFiles)
+    payload.copyEmittedFiles(*this);
+  if (!group.empty())
+    payload.groupEmittedFiles(*this);
+  payload.sealFiles(std::move(fileNames));
+}
+
+auto Payload::findEmissionScope() -> EmissionScope * {
+  // scopes of other payloads may be nested when threads are shared
+  for (auto *scope = activeEmissionScope; scope; scope = scope->previous)
+    if (&scope->payload == this)
+      return scope;
+  return nullptr;
+}
+
+void Payload::recordEmission(const fs::path &fName) {
+  if (auto *scope = findEmissionScope())
+    scope->fileNames.push_back(fName);
+}
+
+void Payload::commitStreams(EmissionScope &scope) {
+  if (scope.streams.empty())
+    return;
+
+  const std::lock_guard<std::mutex> lock(_mtx);
+  for (auto &[key, stream] : scope.streams) {
+    auto &file = files[key];
+    if (file.empty())
+      file = stream->take();
+    else
+      file += stream->take();
+    scope.fileNames.emplace_back(key);
+  }
+  scope.streams.clear();
+}
+
+void Payload::copyEmittedFiles(EmissionScope &scope) {
+  const std::lock_guard<std::mutex> lock(_mtx);
+  for (const auto &fName : scope.fileNames) {
+    auto pos = files.find(fName);
+    if (pos != files.end())
+      (*scope.emittedFiles)[fName.native()] = pos->second;
+  }
+}
+
+void Payload::groupEmittedFiles(EmissionScope &scope) {
+  const std::lock_guard<std::mutex> lock(_mtx);
+  for (const auto &fName : scope.fileNames)
+    fileGroups[fName] = scope.group;
+}
+
+auto Payload::getFileStream(const std::string &fName) -> llvm::raw_ostream & {
+  const std::string key = prefix + fName;
+
+  if (auto *scope = findEmissionScope()) {
+    auto &stream = scope->streams[key];
+    if (!stream)
+      stream = std::make_unique<ChunkedFileStream>();
+    return *stream;
+  }
+
+  const std::lock_guard<std::mutex> lock(_mtx);
+  auto &stream = fileStreams[key];
+  if (!stream)
+    stream = std::make_unique<llvm::raw_string_ostream>(files[key]);
+  return *stream;
+}
+
+void ChunkedFileStream::write_impl(const char *ptr, size_t size) {
+  constexpr size_t minChunkSize = 64 * 1024;
+
+  while (size > 0) {
+    if (chunks.empty() || chunks.back().size() == chunks.back().capacity()) {
+      // grow geometrically to bound the number of chunks
+      chunks.emplace_back();
+      chunks.back().reserve(std::max(minChunkSize, totalSize));
+    }
+    auto &chunk = chunks.back();
+    size_t const count = std::min(size, chunk.capacity() - chunk.size());
+    chunk.append(ptr, count);
+    ptr += count;
+    size -= count;
+    totalSize += count;
+  }
+}
+
+std::string ChunkedFileStream::take() {
+  flush();
+
+  std::string contents;
+  if (chunks.size() == 1) {
+    contents = std::move(chunks.front());
+  } else {
+    contents.reserve(totalSize);
+    for (auto &chunk : chunks)
+      contents += chunk;
+  }
+  chunks.clear();
+  totalSize = 0;
+  return contents;
+}
+
 auto Payload::getFile(const std::string &fName) -> std::string * {
   const std::lock_guard<std::mutex> lock(_mtx);
   const std::string key = prefix + fName;
+  recordEmission(key);
   files.try_emplace(key);
   return &files[key];
 }
@@ -44,6 +169,7 @@ auto Payload::getFile(const std::string &fName) -> std::string * {
 auto Payload::getFile(const char *fName) -> std::string * {
   const std::lock_guard<std::mutex> lock(_mtx);
   const std::string key = prefix + fName;
+  recordEmission(key);
   files.try_emplace(key);
   return &files[key];
 }
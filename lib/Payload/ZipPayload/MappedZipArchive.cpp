@@ -0,0 +1,272 @@
+//===- MappedZipArchive.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the MappedZipArchive class
+///
+//===----------------------------------------------------------------------===//
+
+#include "MappedZipArchive.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/xxhash.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+using namespace qssc::payload;
+using namespace llvm::support::endian;
+
+namespace {
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+constexpr size_t localFileHeaderSize = 30;
+constexpr size_t centralDirectoryEntrySize = 46;
+constexpr size_t endOfCentralDirectorySize = 22;
+constexpr size_t maxCommentSize = 0xffff;
+constexpr uint16_t storedMethod = 0;
+// general purpose flags of encrypted members and of members followed by a
+// data descriptor, neither of which can be patched in place
+constexpr uint16_t encryptedFlag = 1 << 0;
+constexpr uint16_t dataDescriptorFlag = 1 << 3;
+// sizes and offsets deferred to zip64 extensions
+constexpr uint32_t zip64Marker = 0xffffffff;
+
+// indices kept by the cache of the process, which is emptied once full
+constexpr size_t maxCachedIndices = 64;
+
+llvm::Error malformedError(llvm::StringRef detail) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Malformed zip archive: " + detail);
+}
+
+// The indices of the archives read by the process keyed on the hash of
+// their central directory
+class ZipIndexCache {
+public:
+  static ZipIndexCache &instance() {
+    static ZipIndexCache cache;
+    return cache;
+  }
+
+  std::shared_ptr<const ZipIndex> lookup(uint64_t hash,
+                                         llvm::StringRef centralDirectory) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto pos = indices.find(hash);
+    if (pos == indices.end() ||
+        pos->second->centralDirectory != centralDirectory)
+      return nullptr;
+    return pos->second;
+  }
+
+  void insert(uint64_t hash, std::shared_ptr<const ZipIndex> index) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    if (indices.size() >= maxCachedIndices)
+      indices.clear();
+    indices[hash] = std::move(index);
+  }
+
+private:
+  std::mutex mutex;
+  std::unordered_map<uint64_t, std::shared_ptr<const ZipIndex>> indices;
+};
+} // end anonymous namespace
+
+llvm::Expected<std::unique_ptr<MappedZipArchive>>
+MappedZipArchive::mapShared(llvm::StringRef path) {
+  auto bufferOrErr = llvm::WriteThroughMemoryBuffer::getFile(path);
+  if (!bufferOrErr)
+    return llvm::createStringError(bufferOrErr.getError(),
+                                   "Unable to map payload " + path);
+
+  auto &buffer = *bufferOrErr;
+  llvm::MutableArrayRef<char> const data(buffer->getBufferStart(),
+                                         buffer->getBufferSize());
+  std::unique_ptr<MappedZipArchive> archive(
+      new MappedZipArchive(std::move(buffer), data));
+  if (auto err = archive->parse())
+    return std::move(err);
+  return std::move(archive);
+}
+
+llvm::Expected<std::unique_ptr<MappedZipArchive>>
+MappedZipArchive::copyOf(llvm::StringRef data) {
+  auto buffer = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(data.size());
+  if (!buffer)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to allocate payload buffer");
+  std::memcpy(buffer->getBufferStart(), data.data(), data.size());
+
+  llvm::MutableArrayRef<char> const view(buffer->getBufferStart(),
+                                         buffer->getBufferSize());
+  std::unique_ptr<MappedZipArchive> archive(
+      new MappedZipArchive(std::move(buffer), view));
+  if (auto err = archive->parse())
+    return std::move(err);
+  return std::move(archive);
+}
+
+llvm::Expected<std::shared_ptr<const ZipIndex>>
+MappedZipArchive::readIndex(llvm::ArrayRef<char> data) {
+  if (data.size() < endOfCentralDirectorySize)
+    return malformedError("missing end of central directory");
+
+  // the end of central directory record is followed by a comment of up to
+  // 64KiB
+  size_t const last = data.size() - endOfCentralDirectorySize;
+  size_t const first = last > maxCommentSize ? last - maxCommentSize : 0;
+  const char *eocd = nullptr;
+  for (size_t pos = last + 1; pos-- > first;) {
+    if (read32le(&data[pos]) == endOfCentralDirectorySignature) {
+      eocd = &data[pos];
+      break;
+    }
+  }
+  if (!eocd)
+    return malformedError("missing end of central directory");
+
+  uint16_t const numEntries = read16le(eocd + 10);
+  uint32_t const centralDirectorySize = read32le(eocd + 12);
+  uint32_t const centralDirectoryOffset = read32le(eocd + 16);
+  if (numEntries == 0xffff || centralDirectoryOffset == zip64Marker)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "zip64 archives are not supported");
+
+  size_t const end = eocd - data.data();
+  if (static_cast<uint64_t>(centralDirectoryOffset) + centralDirectorySize >
+      end)
+    return malformedError("central directory out of bounds");
+
+  // the key includes the end of central directory record as the offsets of
+  // the central directory entries are relative to it
+  llvm::StringRef const centralDirectory(data.data() + centralDirectoryOffset,
+                                         data.size() - centralDirectoryOffset);
+  uint64_t const hash = llvm::xxHash64(centralDirectory);
+  auto &cache = ZipIndexCache::instance();
+  if (auto index = cache.lookup(hash, centralDirectory))
+    return index;
+
+  auto index = std::make_shared<ZipIndex>();
+  index->centralDirectory = centralDirectory.str();
+  size_t pos = centralDirectoryOffset;
+  for (unsigned i = 0; i < numEntries; ++i) {
+    if (pos + centralDirectoryEntrySize > end ||
+        read32le(&data[pos]) != centralDirectorySignature)
+      return malformedError("truncated central directory");
+
+    const char *entry = &data[pos];
+    uint16_t const nameLength = read16le(entry + 28);
+    uint16_t const extraLength = read16le(entry + 30);
+    uint16_t const commentLength = read16le(entry + 32);
+    size_t const entrySize =
+        centralDirectoryEntrySize + nameLength + extraLength + commentLength;
+    if (pos + entrySize > end)
+      return malformedError("truncated central directory");
+
+    llvm::StringRef const name(entry + centralDirectoryEntrySize, nameLength);
+    index->members[name] = Member{read16le(entry + 10), read16le(entry + 8),
+                                  read32le(entry + 16),  read32le(entry + 20),
+                                  read32le(entry + 24),  read32le(entry + 42),
+                                  pos,                   i};
+    pos += entrySize;
+  }
+
+  cache.insert(hash, index);
+  return index;
+}
+
+llvm::Error MappedZipArchive::parse() {
+  auto indexOrErr = readIndex(data);
+  if (!indexOrErr)
+    return indexOrErr.takeError();
+
+  // members are updated when patched in place
+  members = (*indexOrErr)->members;
+  return llvm::Error::success();
+}
+
+llvm::Expected<MappedZipArchive::Member &>
+MappedZipArchive::find(llvm::StringRef name) {
+  auto pos = members.find(name);
+  if (pos == members.end())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "No member " + name + " in payload");
+  return pos->second;
+}
+
+llvm::Expected<llvm::MutableArrayRef<char>>
+MappedZipArchive::contents(Member &member) {
+  if (member.method != storedMethod ||
+      (member.flags & (encryptedFlag | dataDescriptorFlag)) ||
+      member.compressedSize != member.size || member.size == zip64Marker ||
+      member.localHeaderOffset == zip64Marker)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Member can not be viewed in place");
+
+  uint64_t const header = member.localHeaderOffset;
+  if (header + localFileHeaderSize > data.size() ||
+      read32le(&data[header]) != localFileHeaderSignature)
+    return malformedError("missing local file header");
+
+  uint64_t const dataOffset = header + localFileHeaderSize +
+                              read16le(&data[header + 26]) +
+                              read16le(&data[header + 28]);
+  if (dataOffset + member.size > data.size())
+    return malformedError("member contents out of bounds");
+
+  member.dataOffset = dataOffset;
+  return data.slice(dataOffset, member.size);
+}
+
+void MappedZipArchive::replaceContents(const Member &member,
+                                       llvm::ArrayRef<char> contents) {
+  assert(contents.size() == member.size && "replacing contents of other size");
+  char *dest = &data[member.dataOffset];
+
+  // only write the differing ranges so that unchanged pages stay clean
+  size_t pos = 0;
+  while (pos < contents.size()) {
+    if (dest[pos] == contents[pos]) {
+      ++pos;
+      continue;
+    }
+    size_t end = pos + 1;
+    while (end < contents.size() && dest[end] != contents[end])
+      ++end;
+    std::memcpy(dest + pos, contents.data() + pos, end - pos);
+    pos = end;
+  }
+}
+
+void MappedZipArchive::updateCRC(Member &member) {
+  auto const view = data.slice(member.dataOffset, member.size);
+  member.crc = llvm::crc32(llvm::arrayRefFromStringRef(
+      llvm::StringRef(view.data(), view.size())));
+  write32le(&data[member.localHeaderOffset + 14], member.crc);
+  write32le(&data[member.centralHeaderOffset + 16], member.crc);
+}
@@ -0,0 +1,117 @@
+//===- MappedZipArchive.h ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares the MappedZipArchive class
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_MAPPEDZIPARCHIVE_H
+#define PAYLOAD_MAPPEDZIPARCHIVE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace qssc::payload {
+struct ZipIndex;
+
+// Random access to the members of a zip archive held in writable memory,
+// either a shared mapping of a file or a private copy of an in-memory archive.
+// Stored members are exposed as views into the archive that may be patched in
+// place, after which updateCRC() refreshes their checksums. Changes to a mapped
+// file only write the pages they touch.
+class MappedZipArchive {
+public:
+  struct Member {
+    uint16_t method;
+    uint16_t flags;
+    uint32_t crc;
+    uint64_t compressedSize;
+    uint64_t size;
+    uint64_t localHeaderOffset;
+    uint64_t centralHeaderOffset;
+    // position in the central directory, i.e., the libzip index
+    uint64_t index;
+    // offset of the contents, known once they have been viewed
+    uint64_t dataOffset = 0;
+  };
+
+  // get the index of the members of the archive data by name. Indices are
+  // cached by the process keyed on the central directory of the archive,
+  // which holds the checksums of all members, so that the payloads of
+  // repeated bindings of the same module, on disk or in memory, only read
+  // their central directory once.
+  static llvm::Expected<std::shared_ptr<const ZipIndex>>
+  readIndex(llvm::ArrayRef<char> data);
+
+  // map the archive file at path, writing changes through to the file
+  static llvm::Expected<std::unique_ptr<MappedZipArchive>>
+  mapShared(llvm::StringRef path);
+  // copy the in-memory archive data
+  static llvm::Expected<std::unique_ptr<MappedZipArchive>>
+  copyOf(llvm::StringRef data);
+
+  // find the member named name
+  llvm::Expected<Member &> find(llvm::StringRef name);
+  // return a view of the contents of a stored member for patching in place
+  llvm::Expected<llvm::MutableArrayRef<char>> contents(Member &member);
+  // copy the ranges of contents that differ from the member viewed with
+  // contents(), which must be of the same size
+  void replaceContents(const Member &member, llvm::ArrayRef<char> contents);
+  // recompute the checksum of a member viewed with contents() and patched in
+  // place
+  void updateCRC(Member &member);
+
+  // the archive including the changes made in place
+  llvm::StringRef getBuffer() const { return {data.data(), data.size()}; }
+  // hand out the archive including the changes made in place, the archive may
+  // no longer be used afterwards
+  std::unique_ptr<llvm::MemoryBuffer> takeBuffer() {
+    data = {};
+    return std::move(buffer);
+  }
+
+private:
+  MappedZipArchive(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                   llvm::MutableArrayRef<char> data)
+      : buffer(std::move(buffer)), data(data) {}
+
+  // read the central directory, through the cache of indices
+  llvm::Error parse();
+
+  // owner of the writable memory of the archive
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  llvm::MutableArrayRef<char> data;
+  llvm::StringMap<Member> members;
+}; // class MappedZipArchive
+
+// The members of an archive by name as read from its central directory
+struct ZipIndex {
+  // the central directory and end of central directory record the index
+  // was read from
+  std::string centralDirectory;
+  llvm::StringMap<MappedZipArchive::Member> members;
+};
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_MAPPEDZIPARCHIVE_H
@@ -21,22 +21,32 @@
 
 #include "Payload/PatchableZipPayload.h"
 
+#include "MappedZipArchive.h"
 #include "ZipUtil.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstdlib>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <system_error>
 #include <utility>
+#include <vector>
 #include <zip.h>
 #include <zipconf.h>
 
@@ -68,6 +78,65 @@ llvm::Expected<std::string> readFileFromZip(zip_t *zip, zip_stat_t &zs) {
   return fileBuf;
 }
 
+namespace {
+std::string locateInMemoryMember(zip_t *zip, llvm::StringRef path) {
+  if (zip_name_locate(zip, path.str().c_str(), ZIP_FL_ENC_UTF_8) != -1)
+    return path.str();
+
+  // in memory payload does not have leading directory so attempt to remove
+  auto index = path.find("/") + 1;
+  return path.substr(index).str();
+}
+
+// find the member at path in index, setting pathStr to its name
+const MappedZipArchive::Member *lookupMember(const ZipIndex &index,
+                                             llvm::StringRef path,
+                                             bool enableInMemory,
+                                             std::string &pathStr) {
+  pathStr = path.str();
+  auto entry = index.members.find(pathStr);
+  if (entry == index.members.end() && enableInMemory) {
+    // in memory payload does not have leading directory so attempt to remove
+    pathStr = path.substr(path.find("/") + 1).str();
+    entry = index.members.find(pathStr);
+  }
+  if (entry == index.members.end())
+    return nullptr;
+  return &entry->second;
+}
+
+// read the size bytes of the member at index of zip
+llvm::Expected<PatchableZipPayload::ContentBuffer>
+readIndexedMember(zip_t *zip, zip_uint64_t index, zip_uint64_t size) {
+  auto *zipFile = zip_fopen_index(zip, index, 0);
+
+  if (!zipFile) {
+    auto *err = zip_get_error(zip);
+    return extractLibZipError("Opening file within zip", *err);
+  }
+
+  PatchableZipPayload::ContentBuffer fileBuf(size, 0);
+
+  if (zip_fread(zipFile, (void *)fileBuf.data(), fileBuf.size()) !=
+      (zip_int64_t)fileBuf.size()) {
+    auto *err = zip_file_get_error(zipFile);
+
+    zip_fclose(zipFile);
+
+    return extractLibZipError("Reading data from file within zip", *err);
+  }
+
+  if (auto errorCode = zip_fclose(zipFile) != 0) {
+    zip_error_t err;
+
+    zip_error_init_with_code(&err, errorCode);
+    return extractLibZipError("Closing file in zip", err);
+  }
+
+  return fileBuf;
+}
+} // anonymous namespace
+
 llvm::Error extractLibZipError(llvm::StringRef info, zip_error_t &zipError) {
   std::string errorMsg;
   llvm::raw_string_ostream errorMsgStream(errorMsg);
@@ -134,9 +203,50 @@ void PatchableZipPayload::discardChanges() {
   zip = nullptr;
 }
 
+llvm::Error PatchableZipPayload::ensureMapped() {
+  if (mapped) // already mapped
+    return llvm::Error::success();
+
+  auto archiveOrErr = enableInMemory ? MappedZipArchive::copyOf(path)
+                                     : MappedZipArchive::mapShared(path);
+  if (!archiveOrErr)
+    return archiveOrErr.takeError();
+  mapped = std::move(archiveOrErr.get());
+  return llvm::Error::success();
+}
+
+llvm::Error PatchableZipPayload::ensureIndexed() {
+  if (index) // already indexed
+    return llvm::Error::success();
+
+  if (enableInMemory) {
+    auto indexOrErr =
+        MappedZipArchive::readIndex(llvm::ArrayRef(path.data(), path.size()));
+    if (!indexOrErr)
+      return indexOrErr.takeError();
+    index = std::move(indexOrErr.get());
+    return llvm::Error::success();
+  }
+
+  // only the pages of the central directory are read from the mapping
+  auto bufferOrErr =
+      llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  if (!bufferOrErr)
+    return llvm::createStringError(bufferOrErr.getError(),
+                                   "Unable to read payload " + path);
+  auto const buffer = (*bufferOrErr)->getBuffer();
+  auto indexOrErr =
+      MappedZipArchive::readIndex(llvm::ArrayRef(buffer.data(), buffer.size()));
+  if (!indexOrErr)
+    return indexOrErr.takeError();
+  index = std::move(indexOrErr.get());
+  return llvm::Error::success();
+}
+
 llvm::Error PatchableZipPayload::addFileToZip(zip_t *zip,
                                               const std::string &path,
-                                              ContentBuffer &buf,
+                                              llvm::ArrayRef<char> buf,
                                               zip_error_t &err) {
 
   zip_source_t *src = zip_source_buffer_create(buf.data(), buf.size(), 0, &err);
@@ -156,7 +266,66 @@ llvm::Error PatchableZipPayload::addFileToZip(zip_t *zip,
   return llvm::Error::success();
 }
 
+bool PatchableZipPayload::canWriteBackInPlace() {
+  if (auto err = ensureMapped()) {
+    llvm::consumeError(std::move(err));
+    return false;
+  }
+
+  // members read into buffers must be stored and keep their size
+  for (auto &[name, file] : files) {
+    if (!file.writeBack)
+      continue;
+    auto memberOrErr = mapped->find(name);
+    if (!memberOrErr) {
+      llvm::consumeError(memberOrErr.takeError());
+      return false;
+    }
+    auto viewOrErr = mapped->contents(memberOrErr.get());
+    if (!viewOrErr) {
+      llvm::consumeError(viewOrErr.takeError());
+      return false;
+    }
+    if (viewOrErr->size() != file.buf.size())
+      return false;
+  }
+  return true;
+}
+
+llvm::Error PatchableZipPayload::writeBackInPlace() {
+  for (auto &[name, file] : files) {
+    if (!file.writeBack)
+      continue;
+    auto memberOrErr = mapped->find(name);
+    if (!memberOrErr)
+      return memberOrErr.takeError();
+    mapped->replaceContents(memberOrErr.get(), file.buf);
+    mapped->updateCRC(memberOrErr.get());
+  }
+
+  for (auto &name : patchedInPlace) {
+    auto memberOrErr = mapped->find(name);
+    if (!memberOrErr)
+      return memberOrErr.takeError();
+    mapped->updateCRC(memberOrErr.get());
+  }
+
+  // the archive opened with libzip is left unchanged
+  discardChanges();
+  inMemoryZipSource = nullptr;
+
+  writtenInPlace = true;
+  return llvm::Error::success();
+}
+
 llvm::Error PatchableZipPayload::writeBack() {
+  bool const pendingChanges =
+      !patchedInPlace.empty() ||
+      llvm::any_of(files,
+                   [](const auto &item) { return item.second.writeBack; });
+  if (pendingChanges && canWriteBackInPlace())
+    return writeBackInPlace();
+
   if (zip == nullptr) // no changes pending, thus no operation
     return llvm::Error::success();
 
@@ -175,6 +344,18 @@ llvm::Error PatchableZipPayload::writeBack() {
       return error;
   }
 
+  // members patched in place are written along with the other changes
+  for (auto &name : patchedInPlace) {
+    auto memberOrErr = mapped->find(name);
+    if (!memberOrErr)
+      return memberOrErr.takeError();
+    auto viewOrErr = mapped->contents(memberOrErr.get());
+    if (!viewOrErr)
+      return viewOrErr.takeError();
+    if (auto error = addFileToZip(zip, name, viewOrErr.get(), err))
+      return error;
+  }
+
   zip_error_fini(&err);
 
   if (inMemoryZipSource)
@@ -199,7 +380,9 @@ llvm::Error PatchableZipPayload::writeString(std::string *outputString) {
   llvm::raw_ostream *ostream = std::addressof(outStringStream.value());
   ;
 
-  if (inMemoryZipSource) {
+  if (writtenInPlace && enableInMemory) {
+    ostream->write(mapped->getBuffer().data(), mapped->getBuffer().size());
+  } else if (inMemoryZipSource) {
     // read from in memory source
     zip_int64_t sz;
     char *outbuffer =
@@ -221,8 +404,109 @@ llvm::Error PatchableZipPayload::writeString(std::string *outputString) {
   return llvm::Error::success();
 }
 
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+PatchableZipPayload::writeBuffer() {
+  if (writtenInPlace && enableInMemory)
+    return mapped->takeBuffer();
+
+  if (!inMemoryZipSource) {
+    // map the payload written back to disk
+    auto bufferOrErr =
+        llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                    /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::make_error<llvm::StringError>("reading payload file",
+                                                 bufferOrErr.getError());
+    return std::move(*bufferOrErr);
+  }
+
+  // read the in memory source directly into the output buffer
+  zip_source_t *src = inMemoryZipSource;
+  inMemoryZipSource = nullptr;
+  auto freeSource = llvm::make_scope_exit([&]() { zip_source_free(src); });
+
+  if (zip_source_open(src) < 0)
+    return extractLibZipError("Opening payload for reading",
+                              *zip_source_error(src));
+  auto closeSource = llvm::make_scope_exit([&]() { zip_source_close(src); });
+
+  zip_int64_t sz = -1;
+  if (zip_source_seek(src, 0, SEEK_END) == 0)
+    sz = zip_source_tell(src);
+  if (sz < 0 || zip_source_seek(src, 0, SEEK_SET) < 0)
+    return extractLibZipError("Seeking in payload", *zip_source_error(src));
+
+  auto buffer = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(sz);
+  if (!buffer)
+    return llvm::make_error<llvm::StringError>(
+        "Unable to allocate output buffer for payload",
+        llvm::inconvertibleErrorCode());
+
+  if (zip_source_read(src, buffer->getBufferStart(), sz) != sz)
+    return extractLibZipError("Reading payload", *zip_source_error(src));
+
+  return std::unique_ptr<llvm::MemoryBuffer>(std::move(buffer));
+}
+
+llvm::Error PatchableZipPayload::writeStringWithMembers(
+    std::string *outputString,
+    const std::map<std::string, ContentBuffer> &members) {
+  if (outputString == nullptr) // no output buffer
+    return llvm::make_error<llvm::StringError>("outputString buffer is null",
+                                               llvm::inconvertibleErrorCode());
+  if (!enableInMemory)
+    return llvm::make_error<llvm::StringError>(
+        "replacing members is only supported for in memory payloads",
+        llvm::inconvertibleErrorCode());
+
+  // Open a private archive over the unmodified payload so that concurrent
+  // writers never share libzip state.
+  zip_error_t err;
+  zip_error_init(&err);
+
+  zip_source_t *src =
+      zip_source_buffer_create(path.data(), path.length(), 0, &err);
+  if (src == nullptr)
+    return extractLibZipError("Creating zip source from payload", err);
+
+  zip_t *archive = zip_open_from_source(src, 0, &err);
+  if (archive == nullptr) {
+    zip_source_free(src);
+    return extractLibZipError(
+        "Failure while opening in memory circuit module (zip) ", err);
+  }
+
+  for (const auto &[memberPath, buf] : members) {
+    if (auto error = addFileToZip(
+            archive, locateInMemoryMember(archive, memberPath), buf, err)) {
+      zip_discard(archive);
+      return error;
+    }
+  }
+
+  zip_error_fini(&err);
+
+  zip_source_keep(src);
+  if (zip_close(archive)) {
+    auto error = extractLibZipError("writing payload", *zip_get_error(archive));
+    zip_discard(archive);
+    zip_source_free(src);
+    return error;
+  }
+
+  zip_int64_t sz;
+  char *outbuffer = qssc::payload::read_zip_src_to_buffer(src, sz);
+  if (outbuffer) {
+    outputString->assign(outbuffer, sz);
+    free(outbuffer);
+  }
+  zip_source_free(src);
+  return llvm::Error::success();
+}
+
 llvm::Expected<PatchableZipPayload::ContentBuffer &>
 PatchableZipPayload::readMember(llvm::StringRef path, bool markForWriteBack) {
+  std::lock_guard<std::mutex> const lock(readMutex);
 
   std::string pathStr = path.str();
   auto pos = files.find(pathStr);
@@ -230,55 +514,169 @@ PatchableZipPayload::readMember(llvm::StringRef path, bool markForWriteBack) {
   if (pos != files.end())
     return pos->second.buf;
 
-  if (enableInMemory &&
-      (zip_name_locate(zip, pathStr.c_str(), ZIP_FL_ENC_UTF_8) == -1)) {
-    // in memory payload does not have leading directory so attempt to remove
-    auto index = path.find("/") + 1;
-    path = path.substr(index);
-    pathStr = path.str();
-  }
-
   zip_stat_t zs;
 
   zip_stat_init(&zs);
 
-  if (zip_stat(zip, pathStr.c_str(), ZIP_FL_ENC_UTF_8, &zs) == -1) {
-    auto *err = zip_get_error(zip);
-
-    return extractLibZipError("Opening file within zip", *err);
+  // locate the member in the index rather than searching the archive by name
+  const MappedZipArchive::Member *member = nullptr;
+  if (auto err = ensureIndexed()) {
+    llvm::consumeError(std::move(err));
+  } else {
+    member = lookupMember(*index, path, enableInMemory, pathStr);
+    if (!member)
+      pathStr = path.str();
   }
 
-  auto *zipFile = zip_fopen_index(zip, zs.index, 0);
+  if (member) {
+    zs.index = member->index;
+    zs.size = member->size;
+  } else {
+    if (enableInMemory)
+      pathStr = locateInMemoryMember(zip, path);
 
-  if (!zipFile) {
-    auto *err = zip_get_error(zip);
-    return extractLibZipError("Opening file within zip", *err);
+    if (zip_stat(zip, pathStr.c_str(), ZIP_FL_ENC_UTF_8, &zs) == -1) {
+      auto *err = zip_get_error(zip);
+
+      return extractLibZipError("Opening file within zip", *err);
+    }
   }
 
-  ContentBuffer fileBuf(zs.size, 0);
+  auto fileBufOrErr = readIndexedMember(zip, zs.index, zs.size);
+  if (!fileBufOrErr)
+    return fileBufOrErr.takeError();
 
-  if (zip_fread(zipFile, (void *)fileBuf.data(), fileBuf.size()) !=
-      (zip_int64_t)fileBuf.size()) {
-    auto *err = zip_file_get_error(zipFile);
+  auto ins = files.emplace(
+      pathStr, TrackedFile{markForWriteBack, std::move(*fileBufOrErr)});
 
-    zip_fclose(zipFile);
+  assert(ins.second && "expect insertion, i.e., had not been present before.");
 
-    return extractLibZipError("Reading data from file within zip", *err);
+  return ins.first->second.buf;
+}
+
+llvm::Expected<llvm::MutableArrayRef<char>>
+PatchableZipPayload::readMemberInPlace(llvm::StringRef path) {
+  std::lock_guard<std::mutex> const lock(readMutex);
+
+  if (auto err = ensureMapped())
+    return std::move(err);
+
+  std::string pathStr = path.str();
+  auto memberOrErr = mapped->find(pathStr);
+  if (!memberOrErr && enableInMemory) {
+    // in memory payload does not have leading directory so attempt to remove
+    llvm::consumeError(memberOrErr.takeError());
+    pathStr = path.substr(path.find("/") + 1).str();
+    memberOrErr = mapped->find(pathStr);
   }
+  if (!memberOrErr)
+    return memberOrErr.takeError();
 
-  if (auto errorCode = zip_fclose(zipFile) != 0) {
-    zip_error_t err;
+  if (files.count(pathStr))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Member " + pathStr +
+                                       " has already been read");
 
-    zip_error_init_with_code(&err, errorCode);
-    return extractLibZipError("Closing file in zip", err);
+  auto viewOrErr = mapped->contents(memberOrErr.get());
+  if (!viewOrErr)
+    return viewOrErr.takeError();
+
+  if (!llvm::is_contained(patchedInPlace, pathStr))
+    patchedInPlace.push_back(pathStr);
+  return viewOrErr.get();
+}
+
+llvm::Expected<zip_t *> PatchableZipPayload::openReadOnly() {
+  zip_error_t zipError;
+  zip_error_init(&zipError);
+
+  zip_t *archive = nullptr;
+  if (enableInMemory) {
+    zip_source_t *src =
+        zip_source_buffer_create(path.data(), path.length(), 0, &zipError);
+    if (src) {
+      archive = zip_open_from_source(src, ZIP_RDONLY, &zipError);
+      if (!archive)
+        zip_source_free(src);
+    }
+  } else {
+    int errorCode = 0;
+    archive = zip_open(path.c_str(), ZIP_RDONLY, &errorCode);
+    if (!archive)
+      zip_error_init_with_code(&zipError, errorCode);
   }
+  if (!archive)
+    return extractLibZipError("Failure while opening circuit module (zip) ",
+                              zipError);
 
-  auto ins =
-      files.emplace(pathStr, TrackedFile{markForWriteBack, std::move(fileBuf)});
+  zip_error_fini(&zipError);
+  return archive;
+}
 
-  assert(ins.second && "expect insertion, i.e., had not been present before.");
+llvm::Error PatchableZipPayload::prefetchMembers(
+    llvm::ArrayRef<std::string> paths, bool markForWriteBack) {
+  struct Prefetch {
+    std::string name;
+    const MappedZipArchive::Member *member;
+    std::optional<ContentBuffer> contents;
+  };
+
+  // the compressed members which have not been read yet, the stored ones
+  // being patched in place
+  std::vector<Prefetch> prefetches;
+  {
+    std::lock_guard<std::mutex> const lock(readMutex);
+    if (auto err = ensureIndexed())
+      return err;
+    llvm::StringSet<> seen;
+    for (const auto &memberPath : paths) {
+      std::string name;
+      const auto *member =
+          lookupMember(*index, memberPath, enableInMemory, name);
+      if (!member || member->method == ZIP_CM_STORE || files.count(name) ||
+          !seen.insert(name).second)
+        continue;
+      prefetches.push_back({std::move(name), member});
+    }
+  }
+  if (prefetches.empty())
+    return llvm::Error::success();
 
-  return ins.first->second.buf;
+  // each worker opens the payload once for its share of the members
+  size_t const numWorkers = std::min<size_t>(
+      prefetches.size(), llvm::parallel::strategy.compute_thread_count());
+  std::mutex errorMutex;
+  llvm::Error errors = llvm::Error::success();
+  llvm::parallelFor(0, numWorkers, [&](size_t worker) {
+    auto archiveOrErr = openReadOnly();
+    if (!archiveOrErr) {
+      std::lock_guard<std::mutex> const lock(errorMutex);
+      errors = llvm::joinErrors(std::move(errors), archiveOrErr.takeError());
+      return;
+    }
+    auto closeArchive =
+        llvm::make_scope_exit([&]() { zip_discard(*archiveOrErr); });
+    for (size_t i = worker; i < prefetches.size(); i += numWorkers) {
+      auto &prefetch = prefetches[i];
+      auto contents = readIndexedMember(*archiveOrErr, prefetch.member->index,
+                                        prefetch.member->size);
+      // the members which fail to be read are left to readMember to report
+      if (!contents)
+        llvm::consumeError(contents.takeError());
+      else
+        prefetch.contents = std::move(*contents);
+    }
+  });
+  if (errors)
+    return errors;
+
+  std::lock_guard<std::mutex> const lock(readMutex);
+  for (auto &prefetch : prefetches)
+    if (prefetch.contents)
+      files.try_emplace(prefetch.name,
+                        TrackedFile{markForWriteBack,
+                                    std::move(*prefetch.contents)});
+  return llvm::Error::success();
 }
 
 PatchableZipPayload::~PatchableZipPayload() {
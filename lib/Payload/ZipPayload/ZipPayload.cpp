@@ -27,10 +27,17 @@
 #include "Payload/PayloadRegistry.h"
 #include <Config/QSSConfig.h>
 
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
@@ -44,6 +51,7 @@
 #include <string>
 // NOLINTNEXTLINE(misc-include-cleaner)
 #include <sys/stat.h>
+#include <utility>
 #include <vector>
 #include <zip.h>
 #include <zipconf.h>
@@ -51,6 +59,40 @@
 using namespace qssc::payload;
 namespace fs = std::filesystem;
 
+namespace {
+// the member indexing the byte ranges of the groups of a split payload
+constexpr const char *groupIndexName = "manifest/groups.json";
+// the member indexing the offsets of the members of a streamed payload
+constexpr const char *memberIndexName = "manifest/index.json";
+constexpr const char *manifestName = "manifest/manifest.json";
+// smaller members are archived rather than referred to in the blob store, as
+// their entries in the member index are about as large
+constexpr size_t minBlobSize = 1024;
+
+llvm::SmallString<128> blobPath(llvm::StringRef blobStore,
+                                llvm::StringRef sha256) {
+  llvm::SmallString<128> path(blobStore);
+  llvm::sys::path::append(path, sha256);
+  return path;
+}
+
+// add contents to the blob store, concurrent writers of the same blob write
+// the same contents
+llvm::Error storeBlob(llvm::StringRef blobStore, llvm::StringRef sha256,
+                      llvm::StringRef contents) {
+  if (auto ec = llvm::sys::fs::create_directories(blobStore))
+    return llvm::createStringError(ec, "Unable to create blob store " +
+                                           blobStore);
+  // Written to a temporary file and renamed so that concurrent compilers
+  // never observe partial blobs.
+  return llvm::writeToOutput(blobPath(blobStore, sha256),
+                             [&](llvm::raw_ostream &os) -> llvm::Error {
+                               os << contents;
+                               return llvm::Error::success();
+                             });
+}
+} // end anonymous namespace
+
 int qssc::payload::init() {
   const char *name = "ZIP";
   bool const registered = registry::PayloadRegistry::registerPlugin(
@@ -65,20 +107,133 @@ int qssc::payload::init() {
 }
 
 // creates a manifest json file and adds it to the file map
-void ZipPayload::addManifest() {
+void ZipPayload::addManifest(bool indexGroups, bool indexMembers) {
   std::lock_guard<std::mutex> const lock(_mtx);
-  std::string const manifest_fname = "manifest/manifest.json";
+  std::string const manifest_fname = manifestName;
   nlohmann::json manifest;
   manifest["version"] = QSSC_VERSION;
   manifest["contents_path"] = prefix;
+  if (indexGroups)
+    manifest["groups_index"] = groupIndexName;
+  if (indexMembers)
+    manifest["index"] = memberIndexName;
   files[manifest_fname] = manifest.dump() + "\n";
 }
 
 void ZipPayload::addFile(llvm::StringRef filename, llvm::StringRef str) {
   std::lock_guard<std::mutex> const lock(_mtx);
+  recordEmission(filename.str());
   files[filename.str()] = str;
 }
 
+ZipStreamWriter::Member ZipPayload::compressMember(const fs::path &fName,
+                                                  std::string contents) {
+  std::string name = fName.string();
+  if (blobStore.empty() || contents.size() < minBlobSize ||
+      name == manifestName)
+    return ZipStreamWriter::compress(std::move(name), std::move(contents),
+                                     getCompression(fName));
+
+  std::string sha256 = ZipStreamWriter::hashContents(contents);
+  if (llvm::sys::fs::exists(blobPath(blobStore, sha256)))
+    return ZipStreamWriter::reference(std::move(name), contents,
+                                      std::move(sha256));
+  // a member that could not be stored is archived only
+  if (auto err = storeBlob(blobStore, sha256, contents))
+    llvm::errs() << "Unable to store payload file " << name
+                 << " in the blob store: " << toString(std::move(err))
+                 << "\n";
+  return ZipStreamWriter::compress(std::move(name), std::move(contents),
+                                   getCompression(fName), std::move(sha256));
+}
+
+void ZipPayload::enableStreaming() {
+  std::lock_guard<std::mutex> const lock(_mtx);
+  if (!streamWriter)
+    streamWriter = std::make_unique<ZipStreamWriter>();
+}
+
+void ZipPayload::sealFiles(std::vector<fs::path> fileNames) {
+  // Emission scopes end before the payload is written, which keeps the writer
+  // alive while the sealed files are compressed without holding the lock.
+  ZipStreamWriter *writer = nullptr;
+  std::vector<std::pair<fs::path, std::string>> sealed;
+  std::string target;
+  {
+    std::lock_guard<std::mutex> const lock(_mtx);
+    if (!streamWriter)
+      return;
+    writer = streamWriter.get();
+
+    // hand the sealed files over to the archive, releasing them here
+    for (auto &fName : fileNames) {
+      auto pos = files.find(fName);
+      if (pos == files.end()) // already sealed by a previous scope
+        continue;
+      target = getGroup(fName);
+      sealed.emplace_back(fName, std::move(pos->second));
+      files.erase(pos);
+    }
+  }
+
+  // compressed on the emitting thread so that targets compress concurrently,
+  // and archived at once so that the files of the scope are contiguous
+  std::vector<ZipStreamWriter::Member> members;
+  members.reserve(sealed.size());
+  for (auto &[fName, contents] : sealed) {
+    members.push_back(compressMember(fName, std::move(contents)));
+    members.back().target = target;
+    if (splitByGroup)
+      members.back().group = target;
+  }
+  writer->add(std::move(members));
+}
+
+bool ZipPayload::fitsStreamedZip() {
+  std::lock_guard<std::mutex> const lock(_mtx);
+  uint64_t dataSize = 0;
+  for (const auto &[fName, contents] : files)
+    dataSize += 2 * fName.native().size() + contents.size();
+  return ZipStreamWriter::fitsArchive(files.size(), dataSize);
+}
+
+void ZipPayload::writeStreamedZip(llvm::raw_ostream &stream) {
+  if (verbosity >= qssc::config::QSSVerbosity::Info)
+    llvm::outs() << "Writing streamed zip to stream\n";
+
+  std::unique_ptr<ZipStreamWriter> writer;
+  {
+    std::lock_guard<std::mutex> const lock(_mtx);
+    writer = std::move(streamWriter);
+  }
+
+  // archive the files that have not been sealed
+  std::vector<fs::path> orderedNames = orderedFileNames();
+  std::vector<ZipStreamWriter::Member> members(orderedNames.size());
+  {
+    std::lock_guard<std::mutex> const lock(_mtx);
+    // the files of each group are archived contiguously
+    if (splitByGroup)
+      std::stable_sort(orderedNames.begin(), orderedNames.end(),
+                       [&](const fs::path &lhs, const fs::path &rhs) {
+                         return getGroup(lhs) < getGroup(rhs);
+                       });
+    llvm::parallelFor(0, orderedNames.size(), [&](size_t i) {
+      const auto &fName = orderedNames[i];
+      members[i] = compressMember(fName, std::move(files.at(fName)));
+      members[i].target = getGroup(fName);
+      if (splitByGroup)
+        members[i].group = members[i].target;
+    });
+    files.clear();
+  }
+  writer->add(std::move(members));
+
+  if (!writer->finish(stream, splitByGroup ? groupIndexName : "",
+                      memberIndexName))
+    llvm::errs() << "Problem writing streamed zip archive\n";
+}
+
 void ZipPayload::writePlain(const std::string &dirName) {
   std::lock_guard<std::mutex> const lock(_mtx);
   for (const auto &filePair : files) {
@@ -146,13 +301,60 @@ void setFilePermissions(zip_int64_t fileIndex, fs::path &fName,
                                      attributes);
   }
 }
+
+void setFileCompression(zip_int64_t fileIndex, const CompressionPolicy &policy,
+                        zip_t *new_archive) {
+  using qssc::config::PayloadCompression;
+
+  zip_int32_t method = ZIP_CM_STORE;
+  switch (policy.method) {
+  case PayloadCompression::Zstd:
+#ifdef ZIP_CM_ZSTD
+    if (zip_compression_method_supported(ZIP_CM_ZSTD, 1)) {
+      method = ZIP_CM_ZSTD;
+      break;
+    }
+#endif
+    [[fallthrough]];
+  case PayloadCompression::Deflate:
+    method = ZIP_CM_DEFLATE;
+    break;
+  case PayloadCompression::Store:
+    break;
+  }
+  zip_set_file_compression(new_archive, fileIndex, method, policy.level);
+}
+
+// 1980-01-01 00:00, the epoch of MS-DOS timestamps, rather than the time of
+// the compilation, as for the archives of ZipStreamWriter
+void setFileTime(zip_int64_t fileIndex, zip_t *new_archive) {
+  constexpr zip_uint16_t dosTime = 0;
+  constexpr zip_uint16_t dosDate = (1 << 5) | 1;
+  zip_file_set_dostime(new_archive, fileIndex, dosTime, dosDate, 0);
+}
 } // end anonymous namespace
 
 void ZipPayload::writeZip(llvm::raw_ostream &stream) {
+  // first add the manifest, streamed payloads are indexed by the writer
+  if (streamWriter) {
+    addManifest(splitByGroup, /*indexMembers=*/true);
+    writeStreamedZip(stream);
+    return;
+  }
+  // Write the archive directly to the stream rather than assembling it in
+  // memory first, which libzip does and which also compresses members
+  // serially. Archives beyond the limits of the stream writer, which does not
+  // implement zip64, are left to libzip, which indexes neither.
+  if (fitsStreamedZip()) {
+    addManifest(splitByGroup, /*indexMembers=*/true);
+    streamWriter = std::make_unique<ZipStreamWriter>(&stream);
+    writeStreamedZip(stream);
+    return;
+  }
+  addManifest(/*indexGroups=*/false, /*indexMembers=*/false);
+
   if (verbosity >= qssc::config::QSSVerbosity::Info)
     llvm::outs() << "Writing zip to stream\n";
-  // first add the manifest
-  addManifest();
 
   // zip archive stuff
   zip_source_t *new_archive_src;
@@ -218,9 +420,11 @@ void ZipPayload::writeZip(llvm::raw_ostream &stream) {
                    << " to archive: " << zip_strerror(new_archive) << "\n";
       continue;
     }
-    zip_set_file_compression(new_archive, fileIndex, ZIP_CM_STORE, 1);
+    setFileCompression(fileIndex, getCompression(fName), new_archive);
 
     setFilePermissions(fileIndex, fName, new_archive);
+
+    setFileTime(fileIndex, new_archive);
   }
 
   //===---- Shutdown archive ----===//
@@ -23,6 +23,13 @@
 
 #include "Payload/Payload.h"
 
+#include "ZipStreamWriter.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace qssc::payload {
 
 // Register the zip payload.
@@ -50,10 +57,27 @@ public:
   // write all files in plaintext to the dir named dirName
   void writePlain(const std::string &dirName = ".");
   void addFile(llvm::StringRef filename, llvm::StringRef str) override;
+  void enableStreaming() override;
+
+protected:
+  void sealFiles(std::vector<std::filesystem::path> fileNames) override;
 
 private:
-  // creates a manifest json file
-  void addManifest();
+  // creates a manifest json file, referring to the index of the groups if
+  // indexGroups and to the index of the members if indexMembers
+  void addManifest(bool indexGroups, bool indexMembers);
+  // compress a file for the stream writer or, if the blob store holds its
+  // contents, refer to them there, adding them to the store otherwise
+  ZipStreamWriter::Member compressMember(const std::filesystem::path &fName,
+                                         std::string contents);
+  // whether the files fit the limits of ZipStreamWriter
+  bool fitsStreamedZip();
+  // write the archive to the stream with streamWriter
+  void writeStreamedZip(llvm::raw_ostream &stream);
+
+  // archives sealed files in the background if streaming, otherwise created
+  // when the payload is written
+  std::unique_ptr<ZipStreamWriter> streamWriter;
 
 }; // class ZipPayload
 
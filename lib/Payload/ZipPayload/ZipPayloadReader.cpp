@@ -0,0 +1,283 @@
+//===- ZipPayloadReader.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the ZipPayloadReader class
+///
+//===----------------------------------------------------------------------===//
+
+#include "Payload/ZipPayloadReader.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <zip.h>
+
+using namespace qssc::payload;
+
+namespace {
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+constexpr uint64_t endOfCentralDirectorySize = 22;
+constexpr uint64_t maxCommentSize = 0xffff;
+constexpr uint16_t storedMethod = 0;
+constexpr uint16_t versionNeeded = 20;
+// the comment of the archive locating the member index
+constexpr llvm::StringLiteral indexCommentPrefix = "qssc-index ";
+
+llvm::Error makeError(const llvm::Twine &message) {
+  return llvm::make_error<llvm::StringError>(message,
+                                             llvm::inconvertibleErrorCode());
+}
+
+// wrap the compressed contents of a member in an archive of its own, so that
+// libzip decompresses them with the codecs it was built with
+std::string wrapMember(const ZipPayloadReader::Member &member,
+                       llvm::StringRef data) {
+  constexpr llvm::StringLiteral name = "m";
+  std::string archive;
+  llvm::raw_string_ostream os(archive);
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  auto writeHeader = [&]() {
+    writer.write<uint16_t>(0); // flags
+    writer.write<uint16_t>(member.method);
+    writer.write<uint16_t>(0); // time
+    writer.write<uint16_t>(0); // date
+    writer.write<uint32_t>(member.crc);
+    writer.write<uint32_t>(member.compressedSize);
+    writer.write<uint32_t>(member.size);
+    writer.write<uint16_t>(name.size());
+    writer.write<uint16_t>(0); // extra field length
+  };
+
+  writer.write<uint32_t>(localFileHeaderSignature);
+  writer.write<uint16_t>(versionNeeded);
+  writeHeader();
+  os << name << data;
+
+  uint64_t const centralDirectoryOffset = os.tell();
+  writer.write<uint32_t>(centralDirectorySignature);
+  writer.write<uint16_t>(versionNeeded); // version made by
+  writer.write<uint16_t>(versionNeeded);
+  writeHeader();
+  writer.write<uint16_t>(0); // comment length
+  writer.write<uint16_t>(0); // disk number
+  writer.write<uint16_t>(0); // internal attributes
+  writer.write<uint32_t>(0); // external attributes
+  writer.write<uint32_t>(0); // offset of the local header
+  os << name;
+  uint64_t const centralDirectorySize = os.tell() - centralDirectoryOffset;
+
+  writer.write<uint32_t>(endOfCentralDirectorySignature);
+  writer.write<uint16_t>(0); // disk number
+  writer.write<uint16_t>(0); // disk of the central directory
+  writer.write<uint16_t>(1);
+  writer.write<uint16_t>(1);
+  writer.write<uint32_t>(centralDirectorySize);
+  writer.write<uint32_t>(centralDirectoryOffset);
+  writer.write<uint16_t>(0); // comment length
+  os.flush();
+  return archive;
+}
+
+llvm::Expected<std::string> inflate(const ZipPayloadReader::Member &member,
+                                    llvm::StringRef data) {
+  std::string const archive = wrapMember(member, data);
+  zip_error_t error;
+  zip_error_init(&error);
+  zip_source_t *source =
+      zip_source_buffer_create(archive.data(), archive.size(), 0, &error);
+  zip_t *zip = source ? zip_open_from_source(source, ZIP_RDONLY, &error)
+                      : nullptr;
+  if (!zip) {
+    if (source)
+      zip_source_free(source);
+    std::string message = zip_error_strerror(&error);
+    zip_error_fini(&error);
+    return makeError("Unable to decompress " + member.name + ": " + message);
+  }
+  zip_error_fini(&error);
+
+  std::string contents(member.size, '\0');
+  zip_file_t *file = zip_fopen_index(zip, 0, 0);
+  zip_int64_t const read =
+      file ? zip_fread(file, contents.data(), contents.size()) : -1;
+  if (file)
+    zip_fclose(file);
+  zip_discard(zip);
+  if (read < 0 || static_cast<uint64_t>(read) != member.size)
+    return makeError("Unable to decompress " + member.name);
+  return contents;
+}
+} // end anonymous namespace
+
+llvm::Expected<ZipPayloadReader> ZipPayloadReader::open(RangeReader readRange,
+                                                        uint64_t payloadSize) {
+  // the end of central directory record is followed by the comment only
+  uint64_t const tailSize =
+      std::min(payloadSize, endOfCentralDirectorySize + maxCommentSize);
+  auto tail = readRange(payloadSize - tailSize, tailSize);
+  if (!tail)
+    return tail.takeError();
+  if (tail->size() != tailSize)
+    return makeError("Short read of the end of the payload");
+
+  llvm::StringRef comment;
+  bool found = false;
+  for (size_t pos = tail->size() >= endOfCentralDirectorySize
+                        ? tail->size() - endOfCentralDirectorySize + 1
+                        : 0;
+       pos-- > 0;) {
+    const char *record = tail->data() + pos;
+    using namespace llvm::support::endian;
+    if (read32le(record) != endOfCentralDirectorySignature)
+      continue;
+    uint16_t const commentSize = read16le(record + 20);
+    if (pos + endOfCentralDirectorySize + commentSize != tail->size())
+      continue;
+    comment = llvm::StringRef(record + endOfCentralDirectorySize, commentSize);
+    found = true;
+    break;
+  }
+  if (!found)
+    return makeError("Payload is not a zip archive");
+
+  uint64_t indexOffset = 0;
+  uint64_t indexSize = 0;
+  if (!comment.consume_front(indexCommentPrefix))
+    return makeError("Payload has no member index");
+  auto [offsetField, sizeField] = comment.split(' ');
+  if (offsetField.getAsInteger(10, indexOffset) ||
+      sizeField.getAsInteger(10, indexSize) ||
+      indexOffset + indexSize > payloadSize)
+    return makeError("Invalid member index location: " + comment);
+
+  ZipPayloadReader reader(std::move(readRange), payloadSize);
+  auto index = reader.readRange(indexOffset, indexSize);
+  if (!index)
+    return index.takeError();
+  if (index->size() != indexSize)
+    return makeError("Short read of the member index");
+  if (auto err = reader.parseIndex(*index))
+    return std::move(err);
+  return std::move(reader);
+}
+
+llvm::Error ZipPayloadReader::parseIndex(llvm::StringRef index) {
+  auto json = llvm::json::parse(index);
+  if (!json)
+    return json.takeError();
+  const auto *object = json->getAsObject();
+  const auto *jsonMembers = object ? object->getArray("members") : nullptr;
+  if (!jsonMembers)
+    return makeError("Member index has no members");
+
+  for (const auto &value : *jsonMembers) {
+    const auto *entry = value.getAsObject();
+    if (!entry)
+      return makeError("Invalid member index entry");
+    auto name = entry->getString("name");
+    auto size = entry->getInteger("size");
+    auto crc = entry->getInteger("crc32");
+    if (!name || !size || !crc || *size < 0)
+      return makeError("Invalid member index entry");
+
+    Member member;
+    member.name = name->str();
+    if (auto target = entry->getString("target"))
+      member.target = target->str();
+    if (auto sha256 = entry->getString("sha256"))
+      member.sha256 = sha256->str();
+    member.size = *size;
+    member.crc = *crc;
+    member.inBlobStore = entry->getBoolean("blob").value_or(false);
+    if (!member.inBlobStore) {
+      auto offset = entry->getInteger("offset");
+      auto compressedSize = entry->getInteger("compressed_size");
+      auto method = entry->getInteger("method");
+      if (!offset || !compressedSize || !method || *offset < 0 ||
+          *compressedSize < 0 ||
+          static_cast<uint64_t>(*offset + *compressedSize) > payloadSize)
+        return makeError("Invalid member index entry of " + member.name);
+      member.offset = *offset;
+      member.compressedSize = *compressedSize;
+      member.method = *method;
+    }
+    members.push_back(std::move(member));
+  }
+  return llvm::Error::success();
+}
+
+std::vector<const ZipPayloadReader::Member *>
+ZipPayloadReader::getMembersOf(llvm::StringRef target) const {
+  std::vector<const Member *> owned;
+  for (const auto &member : members)
+    if (member.target == target)
+      owned.push_back(&member);
+  return owned;
+}
+
+const ZipPayloadReader::Member *
+ZipPayloadReader::find(llvm::StringRef name) const {
+  for (const auto &member : members)
+    if (member.name == name)
+      return &member;
+  return nullptr;
+}
+
+llvm::Expected<std::string>
+ZipPayloadReader::readMember(llvm::StringRef name) const {
+  const auto *member = find(name);
+  if (!member)
+    return makeError("Payload has no member " + name);
+  return readMember(*member);
+}
+
+llvm::Expected<std::string>
+ZipPayloadReader::readMember(const Member &member) const {
+  if (member.inBlobStore)
+    return makeError("Member " + member.name +
+                     " is held by the blob store as " + member.sha256);
+  auto data = readRange(member.offset, member.compressedSize);
+  if (!data)
+    return data.takeError();
+  if (data->size() != member.compressedSize)
+    return makeError("Short read of member " + member.name);
+
+  if (member.method != storedMethod) {
+    auto contents = inflate(member, *data);
+    if (!contents)
+      return contents.takeError();
+    *data = std::move(*contents);
+  }
+  if (llvm::crc32(llvm::arrayRefFromStringRef(*data)) != member.crc)
+    return makeError("Checksum mismatch of member " + member.name);
+  return data;
+}
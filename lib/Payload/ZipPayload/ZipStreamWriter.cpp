@@ -0,0 +1,430 @@
+//===- ZipStreamWriter.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implements the ZipStreamWriter class
+///
+//===----------------------------------------------------------------------===//
+
+#include "ZipStreamWriter.h"
+
+#include "Payload/Payload.h"
+#include <Config/QSSConfig.h>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CRC.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <utility>
+// NOLINTNEXTLINE(misc-include-cleaner)
+#include <sys/stat.h>
+
+using namespace qssc::payload;
+namespace compression = llvm::compression;
+
+namespace {
+constexpr uint32_t localFileHeaderSignature = 0x04034b50;
+constexpr uint32_t centralDirectorySignature = 0x02014b50;
+constexpr uint32_t endOfCentralDirectorySignature = 0x06054b50;
+constexpr uint64_t localFileHeaderSize = 30;
+constexpr uint64_t centralDirectoryEntrySize = 46;
+// compression methods of the zip specification
+constexpr uint16_t storedMethod = 0;
+constexpr uint16_t deflatedMethod = 8;
+constexpr uint16_t zstdMethod = 93;
+// 1980-01-01 00:00, the epoch of MS-DOS timestamps, for reproducible payloads
+constexpr uint16_t dosTime = 0;
+constexpr uint16_t dosDate = (1 << 5) | 1;
+
+// zip 2.0, or 6.3 for zstd, made on UNIX, which is what libzip records for
+// the archives of ZipPayload::writeZip
+uint16_t versionNeeded(uint16_t method) {
+  return (method == zstdMethod) ? 63 : 20;
+}
+uint16_t versionMadeBy(uint16_t method) {
+  return (3 << 8) | versionNeeded(method);
+}
+
+// Permissions as applied by ZipPayload::writeZip: no write access for the
+// group and others, and execute access for the user on shell scripts.
+uint32_t externalAttributes(llvm::StringRef name) {
+  // NOLINTNEXTLINE(misc-include-cleaner)
+  uint32_t mode = S_IFREG | S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+  if (name.endswith(".sh"))
+    // NOLINTNEXTLINE(misc-include-cleaner)
+    mode |= S_IXUSR;
+  return mode << 16;
+}
+
+// Compress into a raw deflate stream as zip members need it, i.e., without
+// the header and the adler32 trailer of the zlib format.
+bool rawDeflate(llvm::ArrayRef<uint8_t> input,
+                llvm::SmallVectorImpl<uint8_t> &out, int level) {
+  if (!compression::zlib::isAvailable())
+    return false;
+  compression::zlib::compress(
+      input, out, level ? level : compression::zlib::DefaultCompression);
+
+  constexpr size_t headerSize = 2;
+  constexpr size_t trailerSize = 4;
+  // a preset dictionary would follow the header
+  constexpr uint8_t presetDictionaryFlag = 0x20;
+  if (out.size() < headerSize + trailerSize || (out[0] & 0x0f) != 8 ||
+      (out[1] & presetDictionaryFlag))
+    return false;
+  out.pop_back_n(trailerSize);
+  out.erase(out.begin(), out.begin() + headerSize);
+  return true;
+}
+} // end anonymous namespace
+
+ZipStreamWriter::ZipStreamWriter(llvm::raw_ostream *output)
+    : output(output), worker([this]() { run(); }) {}
+
+bool ZipStreamWriter::fitsArchive(size_t numMembers, uint64_t dataSize) {
+  // without zip64 extensions the archive is limited to 64Ki members and the
+  // offset of the central directory to 4GiB
+  uint64_t const headersSize =
+      numMembers * (localFileHeaderSize + centralDirectoryEntrySize);
+  return numMembers <= std::numeric_limits<uint16_t>::max() &&
+         dataSize + headersSize <= std::numeric_limits<uint32_t>::max();
+}
+
+ZipStreamWriter::~ZipStreamWriter() {
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    done = true;
+  }
+  queued.notify_one();
+  if (worker.joinable())
+    worker.join();
+}
+
+ZipStreamWriter::Member
+ZipStreamWriter::compress(std::string name, std::string contents,
+                          const CompressionPolicy &policy,
+                          std::string sha256) {
+  using qssc::config::PayloadCompression;
+
+  Member member;
+  member.name = std::move(name);
+  auto const input = llvm::arrayRefFromStringRef(contents);
+  member.crc = llvm::crc32(input);
+  member.size = contents.size();
+  member.sha256 = sha256.empty() ? hashContents(contents) : std::move(sha256);
+
+  llvm::SmallVector<uint8_t, 0> compressed;
+  uint16_t method = storedMethod;
+  switch (policy.method) {
+  case PayloadCompression::Zstd:
+    if (compression::zstd::isAvailable()) {
+      compression::zstd::compress(
+          input, compressed,
+          policy.level ? policy.level : compression::zstd::DefaultCompression);
+      method = zstdMethod;
+      break;
+    }
+    [[fallthrough]];
+  case PayloadCompression::Deflate:
+    if (rawDeflate(input, compressed, policy.level))
+      method = deflatedMethod;
+    break;
+  case PayloadCompression::Store:
+    break;
+  }
+
+  if (method != storedMethod && compressed.size() < contents.size()) {
+    member.method = method;
+    member.data = llvm::toStringRef(compressed).str();
+  } else {
+    member.data = std::move(contents);
+  }
+  return member;
+}
+
+ZipStreamWriter::Member ZipStreamWriter::reference(std::string name,
+                                                  llvm::StringRef contents,
+                                                  std::string sha256) {
+  Member member;
+  member.name = std::move(name);
+  member.crc = llvm::crc32(llvm::arrayRefFromStringRef(contents));
+  member.size = contents.size();
+  member.sha256 = std::move(sha256);
+  member.inBlobStore = true;
+  return member;
+}
+
+std::string ZipStreamWriter::hashContents(llvm::StringRef contents) {
+  return llvm::toHex(llvm::SHA256::hash(llvm::arrayRefFromStringRef(contents)),
+                     /*LowerCase=*/true);
+}
+
+void ZipStreamWriter::add(Member member) {
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    if (!output) {
+      std::pair<std::string, std::string> key{member.group, member.name};
+      held.emplace(std::move(key), std::move(member));
+      return;
+    }
+    queue.push_back(std::move(member));
+  }
+  queued.notify_one();
+}
+
+void ZipStreamWriter::add(std::vector<Member> members) {
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    for (auto &member : members) {
+      if (!output) {
+        std::pair<std::string, std::string> key{member.group, member.name};
+        held.emplace(std::move(key), std::move(member));
+        continue;
+      }
+      queue.push_back(std::move(member));
+    }
+  }
+  queued.notify_one();
+}
+
+void ZipStreamWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    queued.wait(lock, [&]() { return done || !queue.empty(); });
+    if (queue.empty())
+      return;
+
+    auto member = std::move(queue.front());
+    queue.pop_front();
+
+    // archive without holding the lock so that producers are not blocked
+    lock.unlock();
+    append(member);
+    lock.lock();
+  }
+}
+
+void ZipStreamWriter::append(const Member &member) {
+  if (!names.insert(member.name).second) {
+    llvm::errs() << "Payload file " << member.name
+                 << " was modified after it was archived\n";
+    failed = true;
+    return;
+  }
+
+  if (member.inBlobStore) {
+    references.push_back(member);
+    return;
+  }
+
+  // members without zip64 extensions are limited to 4GiB
+  if (member.size > std::numeric_limits<uint32_t>::max() ||
+      archiveSize > std::numeric_limits<uint32_t>::max()) {
+    llvm::errs() << "Payload file " << member.name
+                 << " exceeds the size limit of streamed payloads\n";
+    failed = true;
+    return;
+  }
+
+  uint32_t const offset = archiveSize;
+  uint32_t const compressedSize = member.data.size();
+  uint32_t const size = member.size;
+
+  auto &os = out();
+  uint64_t const start = os.tell();
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  writer.write<uint32_t>(localFileHeaderSignature);
+  writer.write<uint16_t>(versionNeeded(member.method));
+  writer.write<uint16_t>(0); // flags
+  writer.write<uint16_t>(member.method);
+  writer.write<uint16_t>(dosTime);
+  writer.write<uint16_t>(dosDate);
+  writer.write<uint32_t>(member.crc);
+  writer.write<uint32_t>(compressedSize);
+  writer.write<uint32_t>(size);
+  writer.write<uint16_t>(member.name.size());
+  writer.write<uint16_t>(0); // extra field length
+  os << member.name << member.data;
+  uint64_t const memberSize = os.tell() - start;
+  archiveSize += memberSize;
+
+  if (!member.group.empty()) {
+    // extend the last range of the group if the member follows it
+    auto &ranges = groupRanges[member.group];
+    if (!ranges.empty() &&
+        ranges.back().offset + ranges.back().size == offset)
+      ranges.back().size += memberSize;
+    else
+      ranges.push_back({offset, memberSize});
+    groupMembers[member.group].push_back(member.name);
+  }
+
+  entries.push_back({member.name, member.method, member.crc, compressedSize,
+                     size, offset, externalAttributes(member.name),
+                     member.target, member.sha256});
+}
+
+ZipStreamWriter::Member
+ZipStreamWriter::indexGroups(llvm::StringRef name) const {
+  llvm::json::Object groups;
+  for (const auto &[group, ranges] : groupRanges) {
+    llvm::json::Array jsonRanges;
+    for (const auto &range : ranges)
+      jsonRanges.push_back(
+          llvm::json::Object{{"offset", range.offset}, {"size", range.size}});
+    llvm::json::Array jsonMembers;
+    for (const auto &memberName : groupMembers.at(group))
+      jsonMembers.push_back(memberName);
+    groups[group] = llvm::json::Object{{"ranges", std::move(jsonRanges)},
+                                       {"members", std::move(jsonMembers)}};
+  }
+
+  std::string contents;
+  llvm::raw_string_ostream os(contents);
+  os << llvm::json::Value(llvm::json::Object{{"groups", std::move(groups)}})
+     << "\n";
+  os.flush();
+  return compress(name.str(), std::move(contents), CompressionPolicy{});
+}
+
+ZipStreamWriter::Member
+ZipStreamWriter::indexMembers(llvm::StringRef name) const {
+  llvm::json::Array members;
+  for (const auto &entry : entries) {
+    // the local headers of the writer have no extra field
+    uint64_t const dataOffset =
+        entry.offset + localFileHeaderSize + entry.name.size();
+    llvm::json::Object jsonEntry{{"name", entry.name},
+                                 {"offset", dataOffset},
+                                 {"compressed_size", entry.compressedSize},
+                                 {"size", entry.size},
+                                 {"method", entry.method},
+                                 {"crc32", entry.crc},
+                                 {"sha256", entry.sha256}};
+    if (!entry.target.empty())
+      jsonEntry["target"] = entry.target;
+    members.push_back(std::move(jsonEntry));
+  }
+  for (const auto &member : references) {
+    llvm::json::Object jsonEntry{{"name", member.name},
+                                 {"blob", true},
+                                 {"size", member.size},
+                                 {"crc32", member.crc},
+                                 {"sha256", member.sha256}};
+    if (!member.target.empty())
+      jsonEntry["target"] = member.target;
+    members.push_back(std::move(jsonEntry));
+  }
+
+  std::string contents;
+  llvm::raw_string_ostream os(contents);
+  os << llvm::json::Value(llvm::json::Object{{"members", std::move(members)}})
+     << "\n";
+  os.flush();
+  return compress(name.str(), std::move(contents), CompressionPolicy{});
+}
+
+bool ZipStreamWriter::finish(llvm::raw_ostream &stream,
+                             llvm::StringRef groupIndexName,
+                             llvm::StringRef memberIndexName) {
+  {
+    std::lock_guard<std::mutex> const lock(mutex);
+    done = true;
+  }
+  queued.notify_one();
+  worker.join();
+
+  for (auto &[key, member] : held)
+    append(member);
+  held.clear();
+
+  if (!groupIndexName.empty() && !groupRanges.empty())
+    append(indexGroups(groupIndexName));
+
+  // the index is stored, so that its contents may be read as they are
+  std::string comment;
+  if (!memberIndexName.empty() && !failed) {
+    append(indexMembers(memberIndexName));
+    const auto &entry = entries.back();
+    comment = "qssc-index " +
+              std::to_string(entry.offset + localFileHeaderSize +
+                             entry.name.size()) +
+              " " + std::to_string(entry.compressedSize);
+  }
+
+  if (entries.size() > std::numeric_limits<uint16_t>::max() ||
+      archiveSize > std::numeric_limits<uint32_t>::max()) {
+    llvm::errs() << "Streamed payload exceeds the zip size limits\n";
+    failed = true;
+  }
+  if (failed)
+    return false;
+
+  assert((!output || output == &stream) && "finishing on another stream");
+  uint32_t const centralDirectoryOffset = archiveSize;
+
+  auto &os = out();
+  uint64_t const start = os.tell();
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  for (const auto &entry : entries) {
+    writer.write<uint32_t>(centralDirectorySignature);
+    writer.write<uint16_t>(versionMadeBy(entry.method));
+    writer.write<uint16_t>(versionNeeded(entry.method));
+    writer.write<uint16_t>(0); // flags
+    writer.write<uint16_t>(entry.method);
+    writer.write<uint16_t>(dosTime);
+    writer.write<uint16_t>(dosDate);
+    writer.write<uint32_t>(entry.crc);
+    writer.write<uint32_t>(entry.compressedSize);
+    writer.write<uint32_t>(entry.size);
+    writer.write<uint16_t>(entry.name.size());
+    writer.write<uint16_t>(0); // extra field length
+    writer.write<uint16_t>(0); // comment length
+    writer.write<uint16_t>(0); // disk number
+    writer.write<uint16_t>(0); // internal attributes
+    writer.write<uint32_t>(entry.externalAttributes);
+    writer.write<uint32_t>(entry.offset);
+    os << entry.name;
+  }
+  uint32_t const centralDirectorySize = os.tell() - start;
+
+  writer.write<uint32_t>(endOfCentralDirectorySignature);
+  writer.write<uint16_t>(0); // disk number
+  writer.write<uint16_t>(0); // disk of the central directory
+  writer.write<uint16_t>(entries.size());
+  writer.write<uint16_t>(entries.size());
+  writer.write<uint32_t>(centralDirectorySize);
+  writer.write<uint32_t>(centralDirectoryOffset);
+  writer.write<uint16_t>(comment.size());
+  os << comment;
+
+  if (!output)
+    stream.write(archive.data(), archive.size());
+  stream.flush();
+  return true;
+}
@@ -0,0 +1,176 @@
+//===- ZipStreamWriter.h ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declares the ZipStreamWriter class
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef PAYLOAD_ZIPSTREAMWRITER_H
+#define PAYLOAD_ZIPSTREAMWRITER_H
+
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace qssc::payload {
+
+// Writes a zip archive incrementally. Members are compressed up front by the
+// producers with compress(), which is safe to call concurrently, and appended
+// to the archive by a background thread as they are added. Their contents are
+// released right away, so that archiving overlaps with the production of the
+// remaining files. The archive is either written to its output directly or,
+// if the output is not known yet, assembled in memory. Members are archived
+// in the order they are added to an output. Without one they are held until
+// the archive is finished and archived in the order of their groups and
+// names, so that the archive does not depend on the order in which concurrent
+// producers add them.
+//
+// Members may belong to a group, e.g., the files of an instrument. The
+// members of a group added at once are archived contiguously and the byte
+// ranges of the groups in the archive may be indexed in a member written
+// when the archive is finished, so that readers may fetch and unpack the
+// members of each group independently.
+class ZipStreamWriter {
+public:
+  // a member ready to be appended to the archive
+  struct Member {
+    std::string name;
+    // contents as stored in the archive, i.e., after compression
+    std::string data;
+    uint32_t crc = 0;
+    uint64_t size = 0;
+    uint16_t method = 0;
+    // group of the member, e.g., its instrument, empty for none
+    std::string group;
+    // target which emitted the member, empty for none
+    std::string target;
+    // SHA-256 of the contents in hex, which address them in a blob store
+    std::string sha256;
+    // whether the contents are held by a blob store rather than archived, in
+    // which case the member is only listed in the member index
+    bool inBlobStore = false;
+  };
+
+  // write the archive to output as members are added, or assemble it in
+  // memory if there is no output
+  explicit ZipStreamWriter(llvm::raw_ostream *output = nullptr);
+  ~ZipStreamWriter();
+
+  ZipStreamWriter(const ZipStreamWriter &) = delete;
+  ZipStreamWriter &operator=(const ZipStreamWriter &) = delete;
+
+  // compress the contents of a file according to the policy. Zstd falls back
+  // to deflate where unavailable and members which do not shrink are stored.
+  // The hash of the contents is computed unless given.
+  static Member compress(std::string name, std::string contents,
+                         const CompressionPolicy &policy,
+                         std::string sha256 = "");
+  // a member whose contents of hash sha256 are held by a blob store
+  static Member reference(std::string name, llvm::StringRef contents,
+                          std::string sha256);
+  // the SHA-256 of contents in hex
+  static std::string hashContents(llvm::StringRef contents);
+
+  // queue a member for archiving
+  void add(Member member);
+  // queue members for archiving contiguously
+  void add(std::vector<Member> members);
+  // archive the remaining members, complete the archive and write it to the
+  // stream, which must be the output if the writer has one. If
+  // groupIndexName is given and members have groups, a JSON member of this
+  // name is archived which holds the byte ranges of the local headers and
+  // contents of the members of each group. If memberIndexName is given, a
+  // JSON member of this name is archived last which holds the offset of the
+  // contents, the sizes, method, checksums and target of every other member,
+  // as well as the members held by a blob store, and the comment of the
+  // archive records its offset and size as "qssc-index <offset> <size>", see
+  // ZipPayloadReader. Returns false if the archive could not be completed.
+  bool finish(llvm::raw_ostream &stream, llvm::StringRef groupIndexName = "",
+              llvm::StringRef memberIndexName = "");
+  // whether an archive of numMembers members with their names and contents
+  // of dataSize bytes in total fits the zip limits of the writer
+  static bool fitsArchive(size_t numMembers, uint64_t dataSize);
+
+private:
+  struct CentralDirectoryEntry {
+    std::string name;
+    uint16_t method;
+    uint32_t crc;
+    uint32_t compressedSize;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t externalAttributes;
+    std::string target;
+    std::string sha256;
+  };
+
+  // byte range of contiguous members of a group
+  struct GroupRange {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  void run();
+  void append(const Member &member);
+  // the index of the byte ranges of the groups
+  Member indexGroups(llvm::StringRef name) const;
+  // the index of the members archived so far
+  Member indexMembers(llvm::StringRef name) const;
+  llvm::raw_ostream &out() { return output ? *output : archiveStream; }
+
+  // set on construction
+  llvm::raw_ostream *output;
+
+  std::mutex mutex;
+  std::condition_variable queued;
+  std::deque<Member> queue;
+  // the members added without an output, by group and name
+  std::multimap<std::pair<std::string, std::string>, Member> held;
+  bool done = false;
+
+  // only accessed by the worker until it is joined
+  std::string archive;
+  llvm::raw_string_ostream archiveStream{archive};
+  uint64_t archiveSize = 0;
+  std::vector<CentralDirectoryEntry> entries;
+  // the members held by a blob store, in the order they were added
+  std::vector<Member> references;
+  std::unordered_set<std::string> names;
+  // the ranges and member names of each group
+  std::map<std::string, std::vector<GroupRange>> groupRanges;
+  std::map<std::string, std::vector<std::string>> groupMembers;
+  bool failed = false;
+
+  // started last as it uses all of the above
+  std::thread worker;
+}; // class ZipStreamWriter
+
+} // namespace qssc::payload
+
+#endif // PAYLOAD_ZIPSTREAMWRITER_H
@@ -24,12 +24,27 @@
 #include "Config.h"
 #include "HAL/TargetSystem.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 using namespace qssc;
 using namespace llvm;
@@ -59,8 +74,138 @@ llvm::StringRef _getResourcesDir() {
   return QSSC_RESOURCES_INSTALL_PREFIX;
 }
 
+constexpr llvm::StringLiteral resourcePackMagic = "QSSCRES1";
+// the magic and the number of resources
+constexpr uint64_t resourcePackHeaderSize = 16;
+// the sizes of the path and contents and the offset of the contents
+constexpr uint64_t resourcePackEntrySize = 24;
+
+/// The resource pack of the resources directory, if it has a valid one.
+const ResourcePack *getResourcePack_() {
+  static std::unique_ptr<ResourcePack> const pack =
+      []() -> std::unique_ptr<ResourcePack> {
+    llvm::SmallString<128> path(getResourcesDir());
+    llvm::sys::path::append(path, resourcePackName);
+    if (!llvm::sys::fs::is_regular_file(path))
+      return nullptr;
+    auto packOrErr = ResourcePack::open(path);
+    if (!packOrErr) {
+      // serve the resources from the directory instead
+      llvm::consumeError(packOrErr.takeError());
+      return nullptr;
+    }
+    return std::move(*packOrErr);
+  }();
+  return pack.get();
+}
+
 }; // namespace
 
+llvm::Expected<std::unique_ptr<ResourcePack>>
+ResourcePack::open(llvm::StringRef path) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!bufferOrErr)
+    return llvm::createStringError(bufferOrErr.getError(),
+                                   "Unable to read resource pack " + path);
+  return create(std::move(*bufferOrErr));
+}
+
+llvm::Expected<std::unique_ptr<ResourcePack>>
+ResourcePack::create(std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  llvm::StringRef const data = buffer->getBuffer();
+  std::string const identifier = buffer->getBufferIdentifier().str();
+  auto invalid = [&]() {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid resource pack " + identifier);
+  };
+
+  if (data.size() < resourcePackHeaderSize ||
+      !data.startswith(resourcePackMagic))
+    return invalid();
+  uint64_t const count =
+      llvm::support::endian::read64le(data.data() + resourcePackMagic.size());
+  if (count > (data.size() - resourcePackHeaderSize) / resourcePackEntrySize)
+    return invalid();
+
+  std::unique_ptr<ResourcePack> pack(new ResourcePack(std::move(buffer)));
+  uint64_t pathOffset = resourcePackHeaderSize + count * resourcePackEntrySize;
+  for (uint64_t index = 0; index < count; ++index) {
+    const char *entry =
+        data.data() + resourcePackHeaderSize + index * resourcePackEntrySize;
+    uint64_t const pathSize = llvm::support::endian::read64le(entry);
+    uint64_t const size = llvm::support::endian::read64le(entry + 8);
+    uint64_t const offset = llvm::support::endian::read64le(entry + 16);
+    if (pathSize > data.size() - pathOffset || offset > data.size() ||
+        size > data.size() - offset)
+      return invalid();
+
+    pack->resources[data.substr(pathOffset, pathSize)] =
+        data.substr(offset, size);
+    pathOffset += pathSize;
+  }
+  return std::move(pack);
+}
+
+llvm::Error ResourcePack::write(llvm::StringRef dir, llvm::raw_ostream &os) {
+  // the paths relative to dir, sorted so that packs are reproducible
+  std::vector<std::pair<std::string, std::unique_ptr<llvm::MemoryBuffer>>>
+      files;
+  std::error_code ec;
+  for (llvm::sys::fs::recursive_directory_iterator it(dir, ec), end;
+       it != end && !ec; it.increment(ec)) {
+    if (!llvm::sys::fs::is_regular_file(it->path()))
+      continue;
+
+    llvm::SmallString<128> path(it->path());
+    llvm::sys::path::replace_path_prefix(path, dir, "");
+    std::string const slashed = llvm::sys::path::convert_to_slash(path);
+    llvm::StringRef const relative = llvm::StringRef(slashed).ltrim('/');
+    // including the temporary files of a pack being written to dir
+    if (relative.startswith(resourcePackName))
+      continue;
+
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(
+        it->path(), /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::createStringError(bufferOrErr.getError(),
+                                     "Unable to read resource " + it->path());
+    files.emplace_back(relative.str(), std::move(*bufferOrErr));
+  }
+  if (ec)
+    return llvm::createStringError(ec, "Unable to list resources of " + dir);
+  llvm::sort(files, [](const auto &lhs, const auto &rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  os << resourcePackMagic;
+  writer.write<uint64_t>(files.size());
+  uint64_t offset = resourcePackHeaderSize;
+  offset += files.size() * resourcePackEntrySize;
+  for (const auto &[path, buffer] : files)
+    offset += path.size();
+  for (const auto &[path, buffer] : files) {
+    writer.write<uint64_t>(path.size());
+    writer.write<uint64_t>(buffer->getBufferSize());
+    writer.write<uint64_t>(offset);
+    offset += buffer->getBufferSize();
+  }
+  for (const auto &[path, buffer] : files)
+    os << path;
+  for (const auto &[path, buffer] : files)
+    os << buffer->getBuffer();
+  return llvm::Error::success();
+}
+
+std::optional<llvm::MemoryBufferRef>
+ResourcePack::lookup(llvm::StringRef path) const {
+  auto resource = resources.find(path);
+  if (resource == resources.end())
+    return std::nullopt;
+  return llvm::MemoryBufferRef(resource->second, resource->first());
+}
+
 llvm::StringRef qssc::getResourcesDir() {
   static llvm::StringRef const resourcesDir = _getResourcesDir();
   return resourcesDir;
@@ -75,3 +220,35 @@ qssc::getTargetResourcesDir(qssc::hal::Target const *target) {
   llvm::sys::path::append(path, "targets", target->getResourcePath());
   return path;
 }
+
+llvm::Expected<llvm::MemoryBufferRef> qssc::getResource(llvm::StringRef path) {
+  if (const auto *pack = getResourcePack_())
+    if (auto resource = pack->lookup(path))
+      return *resource;
+
+  // the resources read from files are kept for the lifetime of the process
+  static std::mutex mutex;
+  static llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto buffer = buffers.find(path);
+  if (buffer == buffers.end()) {
+    llvm::SmallString<128> filePath(getResourcesDir());
+    llvm::sys::path::append(filePath, path);
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(
+        filePath, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr)
+      return llvm::createStringError(bufferOrErr.getError(),
+                                     "Unable to read resource " + filePath);
+    buffer = buffers.try_emplace(path, std::move(*bufferOrErr)).first;
+  }
+  return buffer->second->getMemBufferRef();
+}
+
+llvm::Expected<llvm::MemoryBufferRef>
+qssc::getTargetResource(qssc::hal::Target const *target,
+                        llvm::StringRef path) {
+  // as getTargetResourcesDir, relative to the resources directory
+  std::string const resourcePath =
+      ("targets/" + target->getResourcePath() + "/" + path).str();
+  return getResource(resourcePath);
+}
@@ -15,99 +15,190 @@
 //===----------------------------------------------------------------------===//
 #include "Utils/LegacyInputConversion.h"
 
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <complex>
+#include <cstddef>
 #include <cstdint>
-#include <fstream>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace qssc::utils {
 
-auto verifyInput(const std::string &calibrationsFilename,
-                 const std::string &expParamsFilename,
-                 const std::string &backendConfigFilename) {
+namespace {
+/// The qubits of a backend indexed by their id and its ports by name.
+struct BackendMaps {
+  std::vector<std::shared_ptr<Qubit>> qubits;
+  std::unordered_map<std::string, std::shared_ptr<Port>> ports;
 
-  std::ifstream calibrationConfigStream(calibrationsFilename);
-  std::ifstream expParamsConfigStream(expParamsFilename);
-  std::ifstream backendConfigStream(backendConfigFilename);
-
-  if (!backendConfigStream)
-    llvm::errs() << "Problem opening file " << backendConfigFilename << "\n";
-  if (!expParamsConfigStream)
-    llvm::errs() << "Problem opening file " << expParamsFilename << "\n";
-  if (!calibrationConfigStream)
-    llvm::errs() << "Problem opening file " << calibrationsFilename << "\n";
-
-  nlohmann::json calibrationConfig;
-  nlohmann::json expParamsConfig;
-  nlohmann::json backendConfig;
-
-  try {
-    calibrationConfigStream >> calibrationConfig;
-  } catch (std::exception &e) {
-    llvm::errs() << e.what() << "\n";
+  std::shared_ptr<Qubit> qubit(int id) const {
+    if (id < 0 || static_cast<size_t>(id) >= qubits.size())
+      return nullptr;
+    return qubits[id];
   }
 
-  try {
-    expParamsConfigStream >> expParamsConfig;
-  } catch (std::exception &e) {
-    llvm::errs() << e.what() << "\n";
+  std::shared_ptr<Port> port(const std::string &name) const {
+    auto it = ports.find(name);
+    return it != ports.end() ? it->second : nullptr;
   }
+};
 
-  try {
-    backendConfigStream >> backendConfig;
-  } catch (std::exception &e) {
-    llvm::errs() << e.what() << "\n";
-  }
-
-  return std::make_tuple(calibrationConfig, expParamsConfig, backendConfig);
-}
-
-auto createMaps(const nlohmann::json &backendConfig) {
+BackendMaps createMaps(const nlohmann::json &backendConfig) {
 
-  std::map<std::string, std::shared_ptr<qssc::utils::Port>> portMap;
-  std::map<uint32_t, std::shared_ptr<qssc::utils::Qubit>> qubitMap;
+  BackendMaps maps;
 
   // create qubits
   {
-    const auto &qubits = backendConfig["qubit_map"];
-    if (qubits.size() < 1)
+    auto qubits = backendConfig.find("qubit_map");
+    if (qubits == backendConfig.end() || qubits->size() < 1)
       llvm::errs() << "Unable to parse required field for declaring qubits.";
-    for (const auto &i : qubits) {
-      try {
-        qubitMap[i] =
-            std::make_shared<Qubit>(static_cast<uint32_t>(i.get<int>()));
-      } catch (const nlohmann::json::parse_error &e) {
-        llvm::errs() << "Unable to parse required field for qubit id.";
+    else
+      for (const auto &i : *qubits) {
+        try {
+          auto const id = static_cast<uint32_t>(i.get<int>());
+          if (id >= maps.qubits.size())
+            maps.qubits.resize(id + 1);
+          maps.qubits[id] = std::make_shared<Qubit>(id);
+        } catch (const nlohmann::json::exception &e) {
+          llvm::errs() << "Unable to parse required field for qubit id.";
+        }
       }
-    }
   }
 
   //   create ports
   {
-    const auto &ports = backendConfig["channel_mappings"];
-    if (ports.size() < 1)
+    auto ports = backendConfig.find("channel_mappings");
+    if (ports == backendConfig.end() || ports->size() < 1)
       llvm::errs() << "Unable to parse required field for declaring ports.";
-    for (const auto &[key, value] : ports.items()) {
-      try {
-        portMap[key] = std::make_shared<Port>(key);
-      } catch (const nlohmann::json::parse_error &e) {
-        llvm::errs() << "Unable to parse required field for port id.";
-      }
+    else
+      for (const auto &[key, value] : ports->items())
+        maps.ports.try_emplace(key, std::make_shared<Port>(key));
+  }
+
+  return maps;
+}
+
+/// The configuration files parsed so far by path, which are parsed again
+/// only once their size or modification time changes, along with the maps of
+/// the backend configurations. Compilations for the same backend share them.
+class ConfigCache {
+public:
+  std::shared_ptr<const nlohmann::json> load(const std::string &filename) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    if (auto *entry = getEntry(filename))
+      return entry->config;
+    return std::make_shared<const nlohmann::json>();
+  }
+
+  /// Get the maps of the backend configuration in filename, built once per
+  /// version of the file.
+  std::shared_ptr<const BackendMaps>
+  loadBackendMaps(const std::string &filename) {
+    std::lock_guard<std::mutex> const lock(mutex);
+    auto *entry = getEntry(filename);
+    if (!entry)
+      return std::make_shared<const BackendMaps>(
+          createMaps(nlohmann::json()));
+    if (!entry->maps)
+      entry->maps =
+          std::make_shared<const BackendMaps>(createMaps(*entry->config));
+    return entry->maps;
+  }
+
+private:
+  struct Entry {
+    std::shared_ptr<const nlohmann::json> config;
+    std::shared_ptr<const BackendMaps> maps;
+    // the stamp of the file the entry was parsed from, as a rewrite within
+    // the granularity of modification times usually changes the size
+    llvm::sys::TimePoint<> modificationTime;
+    uint64_t size = 0;
+  };
+
+  /// Get the entry of the current version of filename, parsing it if it is
+  /// not cached yet or was modified, or null if it cannot be parsed. The
+  /// mutex must be held.
+  Entry *getEntry(const std::string &filename) {
+    llvm::sys::fs::file_status status;
+    if (auto error = llvm::sys::fs::status(filename, status)) {
+      llvm::errs() << "Problem opening file " << filename << "\n";
+      return nullptr;
+    }
+
+    auto &entry = entries[filename];
+    if (entry.config &&
+        entry.modificationTime == status.getLastModificationTime() &&
+        entry.size == status.getSize())
+      return &entry;
+
+    auto buffer = llvm::MemoryBuffer::getFile(filename);
+    if (!buffer) {
+      llvm::errs() << "Problem opening file " << filename << "\n";
+      entries.erase(filename);
+      return nullptr;
     }
+    try {
+      entry.config = std::make_shared<const nlohmann::json>(
+          nlohmann::json::parse((*buffer)->getBuffer().begin(),
+                                (*buffer)->getBuffer().end()));
+      entry.maps.reset();
+      entry.modificationTime = status.getLastModificationTime();
+      entry.size = status.getSize();
+    } catch (std::exception &e) {
+      llvm::errs() << e.what() << "\n";
+      entries.erase(filename);
+      return nullptr;
+    }
+    return &entry;
   }
 
-  return std::make_tuple(qubitMap, portMap);
+  std::mutex mutex; // guards entries
+  std::unordered_map<std::string, Entry> entries;
+};
+
+ConfigCache &getConfigCache() {
+  static ConfigCache cache;
+  return cache;
+}
+
+/// Get a field of a configuration shared through the cache, which must not
+/// be modified by looking up missing fields, or null.
+const nlohmann::json &getField(const nlohmann::json &config,
+                               const char *name) {
+  static const nlohmann::json null;
+  auto field = config.find(name);
+  return field != config.end() ? *field : null;
+}
+} // anonymous namespace
+
+auto verifyInput(const std::string &calibrationsFilename,
+                 const std::string &expParamsFilename,
+                 const std::string &backendConfigFilename) {
+  auto &cache = getConfigCache();
+  return std::make_tuple(cache.load(calibrationsFilename),
+                         cache.load(expParamsFilename),
+                         cache.load(backendConfigFilename));
 }
 
 auto convertToComplex(const std::vector<double> &in) {
   return std::complex<double>(in[0], in[1]);
 }
 
-std::shared_ptr<PlayOp> selectPlayOp(
-    nlohmann::json dict,
-    std::map<std::string, std::vector<std::complex<double>>> pulse_library) {
+using PulseLibrary =
+    std::unordered_map<std::string, std::vector<std::complex<double>>>;
+
+std::shared_ptr<PlayOp> selectPlayOp(nlohmann::json dict,
+                                     const PulseLibrary &pulse_library) {
 
   using Shape = PlayOp::Shape;
   std::shared_ptr<PlayOp> operation;
@@ -146,9 +237,13 @@ std::shared_ptr<PlayOp> selectPlayOp(
         std::make_shared<Drag>(convertToComplex(amp), beta.get<double>(),
                                duration.get<int>(), sigma.get<int>());
     break;
-  case Shape::SampledPulse:
-    operation = std::make_shared<SampledPulse>(pulse_library[name]);
+  case Shape::SampledPulse: {
+    auto samples = pulse_library.find(name.get<std::string>());
+    operation = std::make_shared<SampledPulse>(
+        samples != pulse_library.end() ? samples->second
+                                       : std::vector<std::complex<double>>());
     break;
+  }
   case Shape::None:
     throw std::runtime_error("Encountered unexpected play type.");
     break;
@@ -156,9 +251,8 @@ std::shared_ptr<PlayOp> selectPlayOp(
   return operation;
 }
 
-std::shared_ptr<Operation> selectOp(
-    nlohmann::json dict,
-    std::map<std::string, std::vector<std::complex<double>>> pulse_library) {
+std::shared_ptr<Operation> selectOp(nlohmann::json dict,
+                                    const PulseLibrary &pulse_library) {
 
   const auto name = dict["name"].get<std::string>();
   std::shared_ptr<Operation> operation;
@@ -204,23 +298,26 @@ void LegacyInputConversion::create(const std::string &calibrationsFilename,
   const auto [calibrationConfig, expParamsConfig, backendConfig] = verifyInput(
       calibrationsFilename, expParamsFilename, backendConfigFilename);
 
-  auto [qubitMap, portMap] = createMaps(backendConfig);
+  // the maps are shared by the compilations for the backend
+  const auto maps = getConfigCache().loadBackendMaps(backendConfigFilename);
 
-  auto library = calibrationConfig["defaults"]["pulse_library"];
-  std::map<std::string, std::vector<std::complex<double>>> pulse_library;
+  const auto &defaults = getField(*calibrationConfig, "defaults");
+  const auto &library = getField(defaults, "pulse_library");
+  PulseLibrary pulse_library;
   if (!library.is_null()) {
+    pulse_library.reserve(library.size());
     for (const auto &i : library) {
-      const auto name = i["name"];
-      const auto samples = i["samples"];
+      const auto &samples = i["samples"];
       std::vector<std::complex<double>> samplesArray;
       samplesArray.reserve(samples.size());
       for (const auto &s : samples)
         samplesArray.emplace_back(convertToComplex(s));
-      pulse_library.emplace(name, samplesArray);
+      pulse_library.try_emplace(i["name"].get<std::string>(),
+                                std::move(samplesArray));
     }
   }
 
-  const auto commands = calibrationConfig["defaults"]["cmd_def"];
+  const auto &commands = getField(defaults, "cmd_def");
 
   if (commands.is_null())
     llvm::errs() << "Unable to parse required field for commands look up.";
@@ -237,15 +334,16 @@ void LegacyInputConversion::create(const std::string &calibrationsFilename,
     const auto gate = std::make_shared<Gate>(name, qubits);
 
     for (const auto qubit : qubits)
-      graph_.addEdge(qubitMap[qubit], gate);
+      graph_.addEdge(maps->qubit(qubit), gate);
     for (auto item : sequence) {
 
       const auto opName = item["name"].get<std::string>();
       const auto opLabel = item["label"];
       const auto portName = item["ch"];
 
-      const auto port = portName.is_null() ? std::make_shared<Port>(opName)
-                                           : portMap[portName];
+      const auto port = portName.is_null()
+                            ? std::make_shared<Port>(opName)
+                            : maps->port(portName.get<std::string>());
 
       auto delay = item["t0"];
       if (delay.is_number_integer() && delay > 0) {
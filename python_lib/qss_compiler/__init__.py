@@ -9,25 +9,40 @@
 # Any modifications or derivative works of this code must retain this
 # copyright notice, and modified files need to carry a notice indicating
 # that they have been altered from the originals.
+"""Python bindings for the QSS Compiler.
+
+Importing the package does not load the compiler, which is loaded by the
+first compilation or linking of the process.
+"""
 from ._version import version as __version__  # noqa: F401
-from .py_qssc import __doc__  # noqa: F401
 
 from .compile import (  # noqa: F401
+    compile_batch,
     compile_file,
+    compile_multi_config,
     compile_file_async,
     compile_str,
     compile_str_async,
+    CompileWorkerPool,
+    configure_default_worker_pool,
+    get_default_worker_pool,
     InputType,
     OutputType,
     CompileOptions,
 )
 
+from .cost import (  # noqa: F401
+    CompileCost,
+    estimate_compile_cost,
+)
+
 from .exceptions import (  # noqa: F401
     QSSCompilationFailure,
     QSSCompilerError,
+    QSSCompilerPoolBusy,
 )
 
-from .py_qssc import (  # noqa: F401
+from .py_qssc_enums import (  # noqa: F401
     Diagnostic,
     ErrorCategory,
     Severity,
@@ -35,5 +50,14 @@ from .py_qssc import (  # noqa: F401
 
 from .link import (  # noqa: F401
     link_file,
+    link_file_async,
+    link_file_batch,
+    link_many,
     LinkOptions,
 )
+
+from .metrics import (  # noqa: F401
+    export_metrics,
+    MetricsFormat,
+    reset_metrics,
+)
@@ -48,24 +48,56 @@ pass control to our backend function. We use multiprocessing's Pipe to
 pass input and output data to and from the compiling process. Process
 and Pipe take care of serializing python objects and passing them across
 process boundaries with pipes.
+
+
+Why keep compile processes in a pool?
+-------------------------------------
+
+Starting a process and importing the compiler dominates the compile time of
+small programs. A :class:`CompileWorkerPool` keeps its child processes
+alive, each holding a warm compiler (`_CompileServer` in `lib.cpp`) which
+reuses the target set up by its previous compilations. Each worker compiles
+one program at a time, so a crashing compilation only takes down its own
+worker, which the pool replaces.
+
+
+Why compile in process?
+-----------------------
+
+Compilations with `in_process=True` skip the compile process altogether and
+call `_compile_concurrent_with_args` in the calling process. The compiler
+releases the GIL while compiling and only holds its process-wide command
+line options while parsing them, so compilations from the threads of a
+Python thread pool run in parallel. Their diagnostics are collected from the
+compiler's threads and handed to Python once the compilation completes. This
+trades the isolation of the calling process for the cost of a compile
+process, and is meant for trusted inputs.
 """
 import asyncio
+import atexit
 from concurrent.futures import ThreadPoolExecutor
 from dataclasses import dataclass, field
 from enum import Enum
 from importlib import resources as importlib_resources
 import multiprocessing as mp
 from multiprocessing import connection
+import os
 from os import environ as os_environ
 from pathlib import Path
-from typing import Any, Callable, List, Optional, Tuple, Union
+import threading
+from typing import Any, Callable, List, Optional, Tuple, TYPE_CHECKING, Union
 
 from . import exceptions
-from .py_qssc import _compile_with_args, Diagnostic
+from .py_qssc_enums import Diagnostic
+
+if TYPE_CHECKING:
+    from .py_qssc import _CompileServer
 
 # use the forkserver context to create a server process
-# for forking new compiler processes
+# for forking new compiler processes. The server loads the compiler once so
+# that the compile processes forked from it do not import it again.
 mp_ctx = mp.get_context("forkserver")
+mp_ctx.set_forkserver_preload([__package__ + ".py_qssc"])
 
 
 class InputType(Enum):
@@ -84,6 +116,7 @@ class OutputType(Enum):
 
     QEM = "qem"
     MLIR = "mlir"
+    MLIR_BYTECODE = "bytecode"
 
     def __str__(self):
         return self.value
@@ -110,6 +143,14 @@ class CompileOptions:
     num_shots: Optional[int] = None
     """Repetition delay between shots in seconds."""
     shot_delay: Optional[float] = None
+    """Number of threads to run the passes on, 0 for one per hardware thread
+    available to the compiler. Lowering it avoids oversubscribing the host
+    when running many compilations in parallel."""
+    num_threads: Optional[int] = None
+    """CPUs to restrict the compiler to."""
+    cpu_affinity: Optional[List[int]] = None
+    """NUMA node whose CPUs to restrict the compiler to."""
+    numa_node: Optional[int] = None
     """Optional list of extra arguments to pass to the compiler.
 
     Individual arguments must be separate arguments in the list.
@@ -147,6 +188,16 @@ class CompileOptions:
         if self.shot_delay:
             args.append(f"--shot-delay={self.shot_delay*1e6}us")
 
+        if self.num_threads is not None:
+            args.append(f"--num-threads={self.num_threads}")
+
+        if self.cpu_affinity:
+            cpus = ",".join(str(cpu) for cpu in self.cpu_affinity)
+            args.append(f"--cpu-affinity={cpus}")
+
+        if self.numa_node is not None:
+            args.append(f"--numa-node={self.numa_node}")
+
         args.extend(self.extra_args)
         return args
 
@@ -175,6 +226,25 @@ class _CompilerExecution:
         return args
 
 
+@dataclass
+class _CompilerBatchExecution:
+    """Internal batch compiler execution dataclass."""
+
+    input_strs: List[str] = field(default_factory=list)
+    options: CompileOptions = field(default_factory=CompileOptions)
+
+    def prepare_compiler_args(self) -> List[str]:
+        return self.options.prepare_compiler_option_args()
+
+
+@dataclass
+class _CompilerMultiConfigExecution(_CompilerExecution):
+    """Internal compiler execution dataclass for a single program and several
+    target configurations."""
+
+    config_paths: List[str] = field(default_factory=list)
+
+
 @dataclass
 class _CompilerStatus:
     """Internal compiler result status dataclass."""
@@ -182,16 +252,31 @@ class _CompilerStatus:
     success: bool
 
 
-def _compile_child_backend(
-    execution: _CompilerExecution,
-    on_diagnostic: Callable[[Diagnostic], Any],
-) -> Tuple[_CompilerStatus, Union[bytes, None]]:
-    # TODO: want a corresponding C++ interface to avoid overhead
+@dataclass
+class _CompilerBatchStatus(_CompilerStatus):
+    """Internal batch compiler result status dataclass."""
+
+    program_successes: List[bool] = field(default_factory=list)
 
-    options = execution.options
-    args = execution.prepare_compiler_args()
-    output_as_return = False if options.output_file else True
 
+@dataclass
+class _CompilerDiagnostics:
+    """Internal dataclass of the diagnostics of a compilation, sent at once
+    ahead of its status."""
+
+    diagnostics: List[Diagnostic] = field(default_factory=list)
+
+
+@dataclass
+class _CompilerMetrics:
+    """Internal dataclass of the metrics recorded by the compile process while
+    compiling an execution, sent ahead of its status and merged into the
+    metrics of the calling process."""
+
+    metrics: str
+
+
+def _set_resources_env() -> None:
     # The qss-compiler expects the path to static resources in the environment
     # variable QSSC_RESOURCES. In the python package, those resources are
     # bundled under the directory resources/. Since python's functions for
@@ -200,36 +285,294 @@ def _compile_child_backend(
     with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
         resources_path = version_py_path.parent / "resources"
         os_environ["QSSC_RESOURCES"] = str(resources_path)
-        success, output = _compile_with_args(args, output_as_return, on_diagnostic)
+
+
+def _compile_child_backend(
+    execution: _CompilerExecution,
+    server: Optional["_CompileServer"] = None,
+) -> Tuple[_CompilerStatus, Union[memoryview, None], List[Diagnostic]]:
+    options = execution.options
+    args = execution.prepare_compiler_args()
+    output_as_return = False if options.output_file else True
+
+    _set_resources_env()
+    if server is not None:
+        success, output, diagnostics = server.compile(args, output_as_return)
+    else:
+        from .py_qssc import _compile_with_args
+
+        success, output, diagnostics = _compile_with_args(args, output_as_return)
 
     status = _CompilerStatus(success)
     if output_as_return:
-        return status, output
+        return status, output, diagnostics
     else:
-        return status, None
+        return status, None, diagnostics
 
 
-def _compile_child_runner(conn: connection.Connection) -> None:
-    execution = conn.recv()
+def _compile_batch_child_backend(
+    execution: _CompilerBatchExecution,
+    server: Optional["_CompileServer"] = None,
+) -> Tuple[_CompilerBatchStatus, List[memoryview], List[Diagnostic]]:
+    args = execution.prepare_compiler_args()
+
+    _set_resources_env()
+    if server is not None:
+        successes, outputs, diagnostics = server.compile_batch(args, execution.input_strs)
+    else:
+        from .py_qssc import _compile_batch_with_args
+
+        successes, outputs, diagnostics = _compile_batch_with_args(args, execution.input_strs)
+
+    return _CompilerBatchStatus(all(successes), list(successes)), outputs, diagnostics
+
+
+def _compile_multi_config_child_backend(
+    execution: _CompilerMultiConfigExecution,
+    server: Optional["_CompileServer"] = None,
+) -> Tuple[_CompilerBatchStatus, List[memoryview], List[Diagnostic]]:
+    args = execution.prepare_compiler_args()
+    config_paths = [str(config_path) for config_path in execution.config_paths]
+
+    _set_resources_env()
+    if server is not None:
+        successes, outputs, diagnostics = server.compile_multi_config(args, config_paths)
+    else:
+        from .py_qssc import _compile_multi_config_with_args
+
+        successes, outputs, diagnostics = _compile_multi_config_with_args(args, config_paths)
+
+    return _CompilerBatchStatus(all(successes), list(successes)), outputs, diagnostics
 
-    def on_diagnostic(diag):
-        conn.send(diag)
 
-    status, output = _compile_child_backend(execution, on_diagnostic)
+def _serve_execution(
+    conn: connection.Connection,
+    execution: Union[_CompilerExecution, _CompilerBatchExecution],
+    server: Optional["_CompileServer"] = None,
+) -> None:
+    # the diagnostics are collected by the compiler and sent in one message.
+    # the outputs are memoryviews of the compiler's buffers and are written to
+    # the pipe without copying them into bytes first
+    from .py_qssc import _export_metrics
+
+    if isinstance(execution, (_CompilerBatchExecution, _CompilerMultiConfigExecution)):
+        if isinstance(execution, _CompilerBatchExecution):
+            status, outputs, diagnostics = _compile_batch_child_backend(execution, server)
+        else:
+            status, outputs, diagnostics = _compile_multi_config_child_backend(execution, server)
+        if diagnostics:
+            conn.send(_CompilerDiagnostics(diagnostics))
+        conn.send(_CompilerMetrics(_export_metrics("json", reset=True)))
+        conn.send(status)
+        for output in outputs:
+            conn.send_bytes(output)
+        return
+
+    status, output, diagnostics = _compile_child_backend(execution, server)
+    if diagnostics:
+        conn.send(_CompilerDiagnostics(diagnostics))
+    conn.send(_CompilerMetrics(_export_metrics("json", reset=True)))
     conn.send(status)
     if output is not None:
         conn.send_bytes(output)
 
 
-def _do_compile(
-    execution: _CompilerExecution, return_diagnostics: bool = False
-) -> Union[bytes, str, None]:
+def _compile_child_runner(conn: connection.Connection) -> None:
+    _serve_execution(conn, conn.recv())
+
+
+def _compile_worker_runner(conn: connection.Connection) -> None:
+    # serve executions with a warm compiler until the pool sends None or
+    # closes the pipe
+    from .py_qssc import _CompileServer
+
+    server = _CompileServer()
+    while True:
+        try:
+            execution = conn.recv()
+        except EOFError:
+            return
+        if execution is None:
+            return
+        _serve_execution(conn, execution, server)
+
+
+def _check_execution(execution: Union[_CompilerExecution, _CompilerBatchExecution]) -> bool:
+    is_batch = isinstance(execution, _CompilerBatchExecution)
     assert (
-        execution.input_file is not None or execution.input_str is not None
+        is_batch or execution.input_file is not None or execution.input_str is not None
     ), "one of the compile options input_file or input_str must be set"
+    return is_batch
+
+
+def _receive_compilation(
+    conn: connection.Connection,
+    execution: Union[_CompilerExecution, _CompilerBatchExecution],
+    kill: Callable[[], None],
+    return_diagnostics: bool,
+) -> Tuple[bool, List[int], List[Diagnostic], Union[bytes, None, List[bytes]]]:
+    """Receive the diagnostics, status and output of an execution sent over conn.
 
+    The compile process is killed with `kill` whenever it fails to deliver
+    them.
+    """
+    is_batch = isinstance(execution, (_CompilerBatchExecution, _CompilerMultiConfigExecution))
     options = execution.options
 
+    success = False
+    failed_programs = []
+    # when no callback was provided, collect diagnostics and return in case of error
+    diagnostics = []
+    try:
+        while True:
+            received = conn.recv()
+
+            if isinstance(received, _CompilerDiagnostics):
+                if options.on_diagnostic:
+                    for diagnostic in received.diagnostics:
+                        options.on_diagnostic(diagnostic)
+                else:
+                    diagnostics.extend(received.diagnostics)
+            elif isinstance(received, _CompilerMetrics):
+                from .py_qssc import _merge_metrics
+
+                _merge_metrics(received.metrics)
+            elif isinstance(received, _CompilerStatus):
+                success = received.success
+                if isinstance(received, _CompilerBatchStatus):
+                    failed_programs = [
+                        index
+                        for index, program_success in enumerate(received.program_successes)
+                        if not program_success
+                    ]
+                break
+            else:
+                kill()
+                raise exceptions.QSSCompilerCommunicationFailure(
+                    "The compile process delivered an unexpected object instead of status or "
+                    "diagnostic information. This points to inconsistencies in the Python "
+                    "interface code between the calling process and the compile process.",
+                    return_diagnostics=return_diagnostics,
+                )
+
+        if isinstance(execution, _CompilerBatchExecution):
+            # one compilation result per program of the batch.
+            output = [conn.recv_bytes() for _ in execution.input_strs]
+        elif is_batch:
+            # one compilation result per target configuration.
+            output = [conn.recv_bytes() for _ in execution.config_paths]
+        elif options.output_file is None:
+            # return compilation result via IPC instead of in a file.
+            output = conn.recv_bytes()
+        else:
+            output = None
+    except EOFError:
+        # make sure that child process terminates
+        kill()
+        raise exceptions.QSSCompilerEOFFailure(
+            "Compile process exited before delivering output.",
+            diagnostics,
+            return_diagnostics=return_diagnostics,
+        )
+
+    return success, failed_programs, diagnostics, output
+
+
+def _finish_compilation(
+    execution: Union[_CompilerExecution, _CompilerBatchExecution],
+    success: bool,
+    failed_programs: List[int],
+    diagnostics: List[Diagnostic],
+    output: Union[bytes, None, List[bytes]],
+    return_diagnostics: bool,
+) -> Union[bytes, str, None, List[Union[bytes, str]]]:
+    if not success:
+        failed = ""
+        if failed_programs and isinstance(execution, _CompilerMultiConfigExecution):
+            failed_configs = [execution.config_paths[index] for index in failed_programs]
+            failed = f" for configurations {failed_configs}"
+        elif failed_programs:
+            failed = f" of programs {failed_programs}"
+        raise exceptions.QSSCompilationFailure(
+            "Failure during compilation" + failed,
+            diagnostics,
+            return_diagnostics=return_diagnostics,
+        )
+
+    options = execution.options
+    if isinstance(execution, (_CompilerBatchExecution, _CompilerMultiConfigExecution)):
+        if options.output_type == OutputType.MLIR:
+            return [program_output.decode("utf8") for program_output in output]
+        return output
+
+    if options.output_file is None:
+        # return compilation result
+        if options.output_type == OutputType.MLIR:
+            return output.decode("utf8")
+        return output
+
+
+def _raise_process_error(e: mp.ProcessError, return_diagnostics: bool):
+    raise exceptions.QSSCompilerError(
+        "It's likely that you've hit a bug in the QSS Compiler. Please "
+        "submit an issue to the team with relevant information "
+        "(https://github.com/Qiskit/qss-compiler/issues):\n"
+        f"{e}",
+        return_diagnostics=return_diagnostics,
+    )
+
+
+def _compile_in_process(
+    execution: _CompilerExecution,
+    return_diagnostics: bool = False,
+) -> Union[bytes, str, None]:
+    if isinstance(execution, (_CompilerBatchExecution, _CompilerMultiConfigExecution)):
+        raise ValueError("in process compilations support a single program only")
+    _check_execution(execution)
+
+    options = execution.options
+    args = execution.prepare_compiler_args()
+    output_as_return = False if options.output_file else True
+
+    _set_resources_env()
+    from .py_qssc import _compile_concurrent_with_args
+
+    success, output, compile_diagnostics = _compile_concurrent_with_args(args, output_as_return)
+
+    # when no callback was provided, collect diagnostics and return in case of error
+    diagnostics = []
+    if options.on_diagnostic:
+        for diagnostic in compile_diagnostics:
+            options.on_diagnostic(diagnostic)
+    else:
+        diagnostics.extend(compile_diagnostics)
+
+    return _finish_compilation(
+        execution,
+        success,
+        [],
+        diagnostics,
+        bytes(output) if output_as_return else None,
+        return_diagnostics,
+    )
+
+
+def _do_compile(
+    execution: Union[_CompilerExecution, _CompilerBatchExecution],
+    return_diagnostics: bool = False,
+    worker_pool: Optional["CompileWorkerPool"] = None,
+    in_process: bool = False,
+) -> Union[bytes, str, None, List[Union[bytes, str]]]:
+    if in_process:
+        if worker_pool is not None:
+            raise ValueError("in_process and worker_pool are mutually exclusive")
+        return _compile_in_process(execution, return_diagnostics)
+
+    if worker_pool is not None:
+        return worker_pool.compile(execution, return_diagnostics)
+
+    _check_execution(execution)
+
     parent_side, child_side = mp_ctx.Pipe(duplex=True)
 
     try:
@@ -245,45 +588,13 @@ def _do_compile(
         # exits and closes its end of the pipe.
         child_side.close()
 
-        success = False
-        # when no callback was provided, collect diagnostics and return in case of error
-        diagnostics = []
-        try:
-            while True:
-                received = parent_side.recv()
-
-                if isinstance(received, Diagnostic):
-                    if options.on_diagnostic:
-                        options.on_diagnostic(received)
-                    else:
-                        diagnostics.append(received)
-                elif isinstance(received, _CompilerStatus):
-                    success = received.success
-                    break
-                else:
-                    childproc.kill()
-                    childproc.join()
-                    raise exceptions.QSSCompilerCommunicationFailure(
-                        "The compile process delivered an unexpected object instead of status or "
-                        "diagnostic information. This points to inconsistencies in the Python "
-                        "interface code between the calling process and the compile process.",
-                        return_diagnostics=return_diagnostics,
-                    )
-
-            if options.output_file is None:
-                # return compilation result via IPC instead of in a file.
-                output = parent_side.recv_bytes()
-            else:
-                output = None
-        except EOFError:
-            # make sure that child process terminates
+        def kill():
             childproc.kill()
             childproc.join()
-            raise exceptions.QSSCompilerEOFFailure(
-                "Compile process exited before delivering output.",
-                diagnostics,
-                return_diagnostics=return_diagnostics,
-            )
+
+        success, failed_programs, diagnostics, output = _receive_compilation(
+            parent_side, execution, kill, return_diagnostics
+        )
 
         childproc.join()
         if childproc.exitcode != 0:
@@ -297,27 +608,314 @@ def _do_compile(
                 return_diagnostics=return_diagnostics,
             )
 
-        if not success:
-            raise exceptions.QSSCompilationFailure(
-                "Failure during compilation",
-                diagnostics,
+    except mp.ProcessError as e:
+        _raise_process_error(e, return_diagnostics)
+
+    return _finish_compilation(
+        execution, success, failed_programs, diagnostics, output, return_diagnostics
+    )
+
+
+class _CompileWorker:
+    """A persistent compile process of a :class:`CompileWorkerPool`."""
+
+    def __init__(self):
+        self.conn, child_side = mp_ctx.Pipe(duplex=True)
+        self.process = mp_ctx.Process(
+            target=_compile_worker_runner, args=(child_side,), daemon=True
+        )
+        self.process.start()
+        # as for single compilations, receives fail once the worker exits
+        child_side.close()
+
+    def kill(self) -> None:
+        self.process.kill()
+        self.process.join()
+        self.conn.close()
+
+    def close(self) -> None:
+        try:
+            self.conn.send(None)
+        except (BrokenPipeError, OSError):
+            pass
+        self.process.join()
+        self.conn.close()
+
+
+class _CompileCancellation:
+    """Cancels a compilation of a :class:`CompileWorkerPool`, whether it is
+    still waiting for a worker or already running on one."""
+
+    def __init__(self):
+        self.cancelled = False
+        self.worker: Optional[_CompileWorker] = None
+
+
+class CompileWorkerPool:
+    """A bounded pool of persistent compile processes.
+
+    Each worker holds a warm compiler which reuses the target of its previous
+    compilations when the target, its configuration and the pipeline options
+    are unchanged. A worker compiles one program or batch at a time, and a
+    worker which crashes or fails to communicate is replaced, so compilations
+    remain isolated from the calling process as with :func:`compile_str`.
+
+    Workers are started on demand, up to `max_workers`. Compilations wait for
+    a worker while all of them are busy. Async compilations queue in the
+    order they were issued, and once `max_queued` of them are waiting further
+    ones are rejected with :class:`QSSCompilerPoolBusy`. Cancelling an async
+    compilation removes it from the queue or stops the worker compiling it.
+
+    Example:
+
+        with CompileWorkerPool(max_workers=4) as pool:
+            payloads = [compile_str(program, worker_pool=pool) for program in programs]
+    """
+
+    def __init__(self, max_workers: Optional[int] = None, max_queued: Optional[int] = None):
+        """Create a pool of at most `max_workers` workers, by default the CPU count.
+
+        Args:
+            max_workers: The number of compile processes.
+            max_queued: The number of async compilations which may wait for a
+                worker, unbounded by default.
+        """
+        if max_workers is None:
+            max_workers = os.cpu_count() or 1
+        if max_workers < 1:
+            raise ValueError("max_workers must be at least 1")
+        if max_queued is not None and max_queued < 0:
+            raise ValueError("max_queued must not be negative")
+        self.max_workers = max_workers
+        self.max_queued = max_queued
+        self._idle: List[_CompileWorker] = []
+        self._num_workers = 0
+        self._num_async = 0
+        self._closed = False
+        self._available = threading.Condition()
+        self._executor: Optional[ThreadPoolExecutor] = None
+
+    def __enter__(self) -> "CompileWorkerPool":
+        return self
+
+    def __exit__(self, *exc_info) -> None:
+        self.close()
+
+    def _acquire(self, cancellation: Optional[_CompileCancellation] = None) -> _CompileWorker:
+        with self._available:
+            while True:
+                if self._closed:
+                    raise exceptions.QSSCompilerError("The compile worker pool is closed.")
+                if cancellation is not None and cancellation.cancelled:
+                    raise exceptions.QSSCompilerError("The compilation was cancelled.")
+                if self._idle:
+                    worker = self._idle.pop()
+                    if cancellation is not None:
+                        cancellation.worker = worker
+                    return worker
+                if self._num_workers < self.max_workers:
+                    self._num_workers += 1
+                    break
+                self._available.wait()
+
+        try:
+            worker = _CompileWorker()
+        except BaseException:
+            with self._available:
+                self._num_workers -= 1
+                self._available.notify()
+            raise
+
+        with self._available:
+            cancelled = cancellation is not None and cancellation.cancelled
+            if cancellation is not None and not cancelled:
+                cancellation.worker = worker
+        if cancelled:
+            self._release(worker, False, cancellation)
+            raise exceptions.QSSCompilerError("The compilation was cancelled.")
+        return worker
+
+    def _release(
+        self,
+        worker: _CompileWorker,
+        reusable: bool,
+        cancellation: Optional[_CompileCancellation] = None,
+    ) -> None:
+        with self._available:
+            if cancellation is not None:
+                reusable = reusable and not cancellation.cancelled
+                cancellation.worker = None
+            reusable = reusable and not self._closed and worker.process.is_alive()
+            if reusable:
+                self._idle.append(worker)
+            else:
+                self._num_workers -= 1
+            self._available.notify()
+
+        if not reusable:
+            worker.close() if worker.process.is_alive() else worker.kill()
+
+    def _cancel(self, cancellation: _CompileCancellation) -> None:
+        with self._available:
+            cancellation.cancelled = True
+            worker = cancellation.worker
+            self._available.notify_all()
+        # a compilation cannot be interrupted, stop its worker instead
+        if worker is not None:
+            worker.process.kill()
+
+    def compile(
+        self,
+        execution: Union[_CompilerExecution, _CompilerBatchExecution],
+        return_diagnostics: bool = False,
+        cancellation: Optional[_CompileCancellation] = None,
+    ) -> Union[bytes, str, None, List[Union[bytes, str]]]:
+        """Compile an execution with the next available worker."""
+        _check_execution(execution)
+
+        worker = self._acquire(cancellation)
+        reusable = False
+        try:
+            worker.conn.send(execution)
+            success, failed_programs, diagnostics, output = _receive_compilation(
+                worker.conn, execution, worker.kill, return_diagnostics
+            )
+            # the worker has delivered everything and serves the next execution
+            reusable = True
+        except (BrokenPipeError, OSError) as e:
+            worker.kill()
+            raise exceptions.QSSCompilerEOFFailure(
+                f"Compile worker exited before accepting the compilation: {e}",
                 return_diagnostics=return_diagnostics,
             )
+        except mp.ProcessError as e:
+            _raise_process_error(e, return_diagnostics)
+        finally:
+            self._release(worker, reusable, cancellation)
 
-    except mp.ProcessError as e:
-        raise exceptions.QSSCompilerError(
-            "It's likely that you've hit a bug in the QSS Compiler. Please "
-            "submit an issue to the team with relevant information "
-            "(https://github.com/Qiskit/qss-compiler/issues):\n"
-            f"{e}",
-            return_diagnostics=return_diagnostics,
+        return _finish_compilation(
+            execution, success, failed_programs, diagnostics, output, return_diagnostics
         )
 
-    if options.output_file is None:
-        # return compilation result
-        if options.output_type == OutputType.MLIR:
-            return output.decode("utf8")
-        return output
+    async def compile_async(
+        self,
+        execution: Union[_CompilerExecution, _CompilerBatchExecution],
+        return_diagnostics: bool = False,
+    ) -> Union[bytes, str, None, List[Union[bytes, str]]]:
+        """Compile an execution with the next available worker without
+        blocking the event loop."""
+        _check_execution(execution)
+
+        with self._available:
+            if self._closed:
+                raise exceptions.QSSCompilerError("The compile worker pool is closed.")
+            if (
+                self.max_queued is not None
+                and self._num_async >= self.max_workers + self.max_queued
+            ):
+                raise exceptions.QSSCompilerPoolBusy(
+                    f"More than {self.max_queued} compilations are waiting for a compile worker.",
+                    return_diagnostics=return_diagnostics,
+                )
+            self._num_async += 1
+            if self._executor is None:
+                # one thread per worker waits for its compilation, further
+                # compilations queue in the executor in order
+                self._executor = ThreadPoolExecutor(
+                    max_workers=self.max_workers, thread_name_prefix="qssc-compile"
+                )
+            executor = self._executor
+
+        def done(_):
+            with self._available:
+                self._num_async -= 1
+
+        cancellation = _CompileCancellation()
+        try:
+            future = executor.submit(self.compile, execution, return_diagnostics, cancellation)
+        except BaseException:
+            done(None)
+            raise
+        future.add_done_callback(done)
+        try:
+            return await asyncio.wrap_future(future)
+        except asyncio.CancelledError:
+            # queued compilations never start, running ones lose their worker
+            future.cancel()
+            self._cancel(cancellation)
+            raise
+
+    def close(self) -> None:
+        """Stop the idle workers. Busy workers stop once their compilation is done."""
+        with self._available:
+            self._closed = True
+            idle, self._idle = self._idle, []
+            self._num_workers -= len(idle)
+            executor, self._executor = self._executor, None
+            self._available.notify_all()
+        for worker in idle:
+            worker.close()
+        if executor is not None:
+            executor.shutdown(wait=False)
+
+
+_default_worker_pool: Optional[CompileWorkerPool] = None
+_default_worker_pool_lock = threading.Lock()
+
+
+def _close_default_worker_pool() -> None:
+    global _default_worker_pool
+    with _default_worker_pool_lock:
+        pool, _default_worker_pool = _default_worker_pool, None
+    if pool is not None:
+        pool.close()
+
+
+atexit.register(_close_default_worker_pool)
+
+
+def _new_default_worker_pool(
+    max_workers: Optional[int] = None, max_queued: Optional[int] = None
+) -> CompileWorkerPool:
+    if max_workers is None and "QSSC_COMPILE_WORKERS" in os_environ:
+        max_workers = int(os_environ["QSSC_COMPILE_WORKERS"])
+    return CompileWorkerPool(max_workers=max_workers, max_queued=max_queued)
+
+
+def configure_default_worker_pool(
+    max_workers: Optional[int] = None, max_queued: Optional[int] = None
+) -> CompileWorkerPool:
+    """Replace the worker pool shared by :func:`compile_file_async` and
+    :func:`compile_str_async`.
+
+    Compilations running on the previous pool complete on it while those still
+    waiting for one of its workers fail.
+
+    Args:
+        max_workers: The number of compile processes, by default the value of
+            the environment variable `QSSC_COMPILE_WORKERS` or the CPU count.
+        max_queued: The number of compilations which may wait for a worker,
+            unbounded by default.
+
+    Returns: The new default pool.
+    """
+    global _default_worker_pool
+    pool = _new_default_worker_pool(max_workers, max_queued)
+    with _default_worker_pool_lock:
+        previous, _default_worker_pool = _default_worker_pool, pool
+    if previous is not None:
+        previous.close()
+    return pool
+
+
+def get_default_worker_pool() -> CompileWorkerPool:
+    """Get the worker pool shared by :func:`compile_file_async` and
+    :func:`compile_str_async`, see :func:`configure_default_worker_pool`."""
+    global _default_worker_pool
+    with _default_worker_pool_lock:
+        if _default_worker_pool is None:
+            _default_worker_pool = _new_default_worker_pool()
+        return _default_worker_pool
 
 
 def _prepare_compile_options(
@@ -336,6 +934,8 @@ def compile_file(
     input_file: Union[Path, str],
     return_diagnostics: bool = False,
     compile_options: Optional[CompileOptions] = None,
+    worker_pool: Optional[CompileWorkerPool] = None,
+    in_process: bool = False,
     **kwargs,
 ) -> Union[bytes, str, None]:
     """! Compile a file to the specified output type using the given target.
@@ -348,6 +948,12 @@ def compile_file(
         input_file: Path to the input file to compile.
         return_diagnostics: diagnostics visibility flag
         compile_options: Optional :class:`CompileOptions` dataclass.
+        worker_pool: Optional :class:`CompileWorkerPool` whose warm workers compile
+            the input instead of a new compile process.
+        in_process: Compile in the calling process rather than in a compile
+            process, without holding the GIL, so that compilations from several
+            Python threads run in parallel. The calling process is not isolated
+            from crashes of the compiler.
         kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
             is provided directly.
 
@@ -358,24 +964,31 @@ def compile_file(
     input_file = _stringify_path(input_file)
     compile_options = _prepare_compile_options(compile_options, **kwargs)
     execution = _CompilerExecution(input_file=input_file, options=compile_options)
-    return _do_compile(execution, return_diagnostics)
+    return _do_compile(execution, return_diagnostics, worker_pool, in_process)
 
 
 async def compile_file_async(
     input_file: Union[Path, str],
     return_diagnostics: bool = False,
     compile_options: Optional[CompileOptions] = None,
+    worker_pool: Optional[CompileWorkerPool] = None,
     **kwargs,
 ) -> Union[bytes, str, None]:
     """Compile the given input file to the specified output type using the
     given target in an async context, and avoid blocking the event loop.
 
     Functionally, this function behaves like compile_str and accepts the same set of parameters.
+    The compilation runs on `worker_pool`, by default on the pool shared by all async
+    compilations (see :func:`configure_default_worker_pool`), and waits in its queue
+    while all of its workers are busy. Cancelling the returned coroutine cancels the
+    compilation.
 
     Args:
         input_file: Path to the input file to compile.
         return_diagnostics: diagnostics visibility flag
         compile_options: Optional :class:`CompileOptions` dataclass.
+        worker_pool: Optional :class:`CompileWorkerPool` to compile with instead of
+            the default pool.
         kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
             is provided directly.
 
@@ -383,21 +996,21 @@ async def compile_file_async(
         the compiler output as byte sequence or string, depending on the requested
         output format.
 
+    Raises: :class:`QSSCompilerPoolBusy` if the queue of the pool is full.
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
     execution = _CompilerExecution(input_file=input_file, options=compile_options)
-    with ThreadPoolExecutor() as executor:
-        loop = asyncio.get_running_loop()
-        return await loop.run_in_executor(executor, _do_compile, execution, return_diagnostics)
-    # As an alternative, ProcessPoolExecutor has somewhat higher overhead yet
-    # reduces complexity of integration by not requiring the preparatory call
-    # to set_start_method.
+    if worker_pool is None:
+        worker_pool = get_default_worker_pool()
+    return await worker_pool.compile_async(execution, return_diagnostics)
 
 
 def compile_str(
     input_str: str,
     return_diagnostics: bool = False,
     compile_options: Optional[CompileOptions] = None,
+    worker_pool: Optional[CompileWorkerPool] = None,
+    in_process: bool = False,
     **kwargs,
 ) -> Union[bytes, str, None]:
     """Compile the given input program to the specified output type using the
@@ -411,6 +1024,12 @@ def compile_str(
         input_str: input to compile as string (e.q., an OpenQASM3 program).
         return_diagnostics: diagnostics visibility flag
         compile_options: Optional :class:`CompileOptions` dataclass.
+        worker_pool: Optional :class:`CompileWorkerPool` whose warm workers compile
+            the input instead of a new compile process.
+        in_process: Compile in the calling process rather than in a compile
+            process, without holding the GIL, so that compilations from several
+            Python threads run in parallel. The calling process is not isolated
+            from crashes of the compiler.
         kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
             is provided directly.
 
@@ -420,24 +1039,36 @@ def compile_str(
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
     execution = _CompilerExecution(input_str=input_str, options=compile_options)
-    return _do_compile(execution, return_diagnostics=return_diagnostics)
+    return _do_compile(
+        execution,
+        return_diagnostics=return_diagnostics,
+        worker_pool=worker_pool,
+        in_process=in_process,
+    )
 
 
 async def compile_str_async(
     input_str: str,
     return_diagnostics: bool = False,
     compile_options: Optional[CompileOptions] = None,
+    worker_pool: Optional[CompileWorkerPool] = None,
     **kwargs,
 ) -> Union[bytes, str, None]:
     """Compile the given input program to the specified output type using the
     given target in an async context, and avoid blocking the event loop.
 
     Functionally, this function behaves like compile_str and accepts the same set of parameters.
+    The compilation runs on `worker_pool`, by default on the pool shared by all async
+    compilations (see :func:`configure_default_worker_pool`), and waits in its queue
+    while all of its workers are busy. Cancelling the returned coroutine cancels the
+    compilation.
 
     Args:
         input_str: input to compile as string (e.q., an OpenQASM3 program).
         return_diagnostics: diagnostics visibility flag
         compile_options: Optional :class:`CompileOptions` dataclass.
+        worker_pool: Optional :class:`CompileWorkerPool` to compile with instead of
+            the default pool.
         kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
             is provided directly.
 
@@ -445,12 +1076,94 @@ async def compile_str_async(
         the compiler output as byte sequence or string, depending on the requested
         output format.
 
+    Raises: :class:`QSSCompilerPoolBusy` if the queue of the pool is full.
     """
     compile_options = _prepare_compile_options(compile_options, **kwargs)
     execution = _CompilerExecution(input_str=input_str, options=compile_options)
-    with ThreadPoolExecutor() as executor:
-        loop = asyncio.get_running_loop()
-        return await loop.run_in_executor(executor, _do_compile, execution, return_diagnostics)
-    # As an alternative, ProcessPoolExecutor has somewhat higher overhead yet
-    # reduces complexity of integration by not requiring the preparatory call
-    # to set_start_method.
+    if worker_pool is None:
+        worker_pool = get_default_worker_pool()
+    return await worker_pool.compile_async(execution, return_diagnostics)
+
+
+def compile_batch(
+    input_strs: List[str],
+    return_diagnostics: bool = False,
+    compile_options: Optional[CompileOptions] = None,
+    worker_pool: Optional[CompileWorkerPool] = None,
+    **kwargs,
+) -> List[Union[bytes, str]]:
+    """Compile a batch of input programs sharing the same options to the
+    specified output type using the given target.
+
+    All programs are compiled within a single compile process which builds the
+    target once and compiles the programs in parallel.
+
+    Args:
+        input_strs: inputs to compile as strings (e.q., OpenQASM3 programs).
+        return_diagnostics: diagnostics visibility flag
+        compile_options: Optional :class:`CompileOptions` dataclass. `output_file`
+            is not supported.
+        worker_pool: Optional :class:`CompileWorkerPool` whose warm workers compile
+            the batch instead of a new compile process.
+        kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
+            is provided directly.
+
+    Returns: The compiler output of each input in order as byte sequence or string,
+        depending on the requested output format. If any input fails to compile
+        :class:`QSSCompilationFailure` is raised.
+    """
+    compile_options = _prepare_compile_options(compile_options, **kwargs)
+    if compile_options.output_file is not None:
+        raise exceptions.QSSCompilerError(
+            "Batch compilation returns its outputs and does not support output_file."
+        )
+    execution = _CompilerBatchExecution(input_strs=list(input_strs), options=compile_options)
+    return _do_compile(execution, return_diagnostics=return_diagnostics, worker_pool=worker_pool)
+
+
+def compile_multi_config(
+    config_paths: List[Union[str, Path]],
+    input_str: Optional[str] = None,
+    input_file: Optional[Union[str, Path]] = None,
+    return_diagnostics: bool = False,
+    compile_options: Optional[CompileOptions] = None,
+    worker_pool: Optional[CompileWorkerPool] = None,
+    **kwargs,
+) -> List[Union[bytes, str]]:
+    """Compile a single input program for several configurations of the
+    given target to the specified output type.
+
+    The program is parsed and the passes of `extra_args` are run once, after
+    which the program is compiled for each configuration in parallel within a
+    single compile process. These passes must not depend on the target.
+
+    Args:
+        config_paths: the target configurations to compile for, replacing
+            `config_path`.
+        input_str: input to compile as string (e.q., an OpenQASM3 program).
+        input_file: path to a file containing the input to compile, if
+            `input_str` is not provided.
+        return_diagnostics: diagnostics visibility flag
+        compile_options: Optional :class:`CompileOptions` dataclass. `output_file`
+            is not supported.
+        worker_pool: Optional :class:`CompileWorkerPool` whose warm workers compile
+            the program instead of a new compile process.
+        kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
+            is provided directly.
+
+    Returns: The compiler output for each configuration in order as byte sequence or
+        string, depending on the requested output format. If the program fails to
+        compile for any configuration :class:`QSSCompilationFailure` is raised.
+    """
+    compile_options = _prepare_compile_options(compile_options, **kwargs)
+    if compile_options.output_file is not None:
+        raise exceptions.QSSCompilerError(
+            "Multi-config compilation returns its outputs and does not support output_file."
+        )
+    execution = _CompilerMultiConfigExecution(
+        input_str=input_str,
+        input_file=input_file,
+        options=compile_options,
+        config_paths=[str(config_path) for config_path in config_paths],
+    )
+    return _do_compile(execution, return_diagnostics=return_diagnostics, worker_pool=worker_pool)
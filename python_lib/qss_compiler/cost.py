@@ -0,0 +1,121 @@
+# (C) Copyright IBM 2024.
+#
+# This code is part of Qiskit.
+#
+# This code is licensed under the Apache License, Version 2.0 with LLVM
+# Exceptions. You may obtain a copy of this license in the LICENSE.txt
+# file in the root directory of this source tree.
+#
+# Any modifications or derivative works of this code must retain this
+# copyright notice, and modified files need to carry a notice indicating
+# that they have been altered from the originals.
+"""
+This file defines the compile cost estimation interface for the qss_compiler
+package.
+
+The cost of a compilation is estimated from the program and the target it is
+compiled for, without compiling it: the program is parsed and the target is
+built in this process, and its time and peak memory are estimated from the
+operations, qubits and circuits of the program and the targets of the target
+system with a linear model. See ``qssc::CompileCostModel`` in ``API/api.h``.
+
+Example:
+
+    cost = estimate_compile_cost(input_str=program, target="mock", config_path=config)
+    if cost.fits(max_seconds=10.0, max_peak_memory_bytes=free_memory):
+        compile_str(program, target="mock", config_path=config)
+"""
+
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Optional, Union
+
+from .compile import (
+    _CompilerExecution,
+    _prepare_compile_options,
+    _set_resources_env,
+    _stringify_path,
+    CompileOptions,
+)
+
+from . import exceptions
+
+
+@dataclass
+class CompileCost:
+    """The estimated cost of a compilation and the features of the program it
+    was estimated from."""
+
+    """Estimated wall time of the compilation in seconds."""
+    seconds: float
+    """Estimated peak memory of the compilation in bytes."""
+    peak_memory_bytes: int
+    """Operations of the program after the frontend."""
+    num_operations: int
+    """Qubits declared by the program."""
+    num_qubits: int
+    """Circuits of the program."""
+    num_circuits: int
+    """Targets below the target system."""
+    num_targets: int
+
+    def fits(
+        self,
+        max_seconds: Optional[float] = None,
+        max_peak_memory_bytes: Optional[int] = None,
+    ) -> bool:
+        """Whether the compilation fits a budget, e.g., to admit it to a host
+        only while the host has the memory it needs.
+
+        Args:
+            max_seconds: The longest compilation admitted, unlimited by default.
+            max_peak_memory_bytes: The most memory a compilation may use,
+                unlimited by default.
+
+        Returns:
+            True if the estimate is within both limits.
+        """
+        return (max_seconds is None or self.seconds <= max_seconds) and (
+            max_peak_memory_bytes is None or self.peak_memory_bytes <= max_peak_memory_bytes
+        )
+
+
+def estimate_compile_cost(
+    input_str: Optional[str] = None,
+    input_file: Optional[Union[Path, str]] = None,
+    compile_options: Optional[CompileOptions] = None,
+    **kwargs,
+) -> CompileCost:
+    """Estimate the cost of compiling a program without compiling it.
+
+    Args:
+        input_str: input to estimate as string (e.q., an OpenQASM3 program).
+        input_file: input to estimate as file, if no input_str is provided.
+        compile_options: Optional :class:`CompileOptions` dataclass of the
+            compilation.
+        kwargs: Keywords corresponding to :class:`CompileOptions`. Ignored if `compile_options`
+            is provided directly.
+
+    Returns: The estimated cost of the compilation.
+
+    Raises: :class:`QSSCompilationFailure` if the program cannot be parsed or
+        the target cannot be built.
+    """
+    compile_options = _prepare_compile_options(compile_options, **kwargs)
+    execution = _CompilerExecution(
+        input_str=input_str,
+        input_file=_stringify_path(input_file),
+        options=compile_options,
+    )
+    _set_resources_env()
+    from .py_qssc import _estimate_compile_cost
+
+    success, cost, diagnostics = _estimate_compile_cost(execution.prepare_compiler_args())
+    if compile_options.on_diagnostic is not None:
+        for diagnostic in diagnostics:
+            compile_options.on_diagnostic(diagnostic)
+    if not success:
+        raise exceptions.QSSCompilationFailure(
+            "Failure while estimating the compile cost.", diagnostics
+        )
+    return CompileCost(**cost)
@@ -20,7 +20,7 @@ This file contains all the exception subclasses.
 
 from typing import List, Optional
 
-from .py_qssc import Diagnostic
+from .py_qssc_enums import Diagnostic
 
 
 def _diagnostics_to_str(diagnostics):
@@ -69,6 +69,10 @@ class QSSCompilationFailure(QSSCompilerError):
     """Raised during other compilation failure."""
 
 
+class QSSCompilerPoolBusy(QSSCompilerError):
+    """Raised when a compile worker pool has too many queued compilations."""
+
+
 class QSSLinkingFailure(QSSCompilerError):
     """Raised on linking failure."""
 
@@ -52,28 +52,109 @@
 //===----------------------------------------------------------------------===//
 
 #include "errors.h"
-#include "lib_enums.h"
 
 #include "API/api.h"
 
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <pybind11/buffer_info.h>
 #include <pybind11/cast.h>
 #include <pybind11/detail/common.h>
+#include <pybind11/gil.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace py = pybind11;
 
+namespace {
+/// A compiler or linker output handed to Python through the buffer protocol,
+/// so that payloads are exposed without copying them into Python bytes.
+class PayloadBuffer {
+public:
+  explicit PayloadBuffer(std::string storage) : storage(std::move(storage)) {}
+  explicit PayloadBuffer(std::unique_ptr<llvm::MemoryBuffer> buffer)
+      : buffer(std::move(buffer)) {}
+
+  const char *data() const {
+    return buffer ? buffer->getBufferStart() : storage.data();
+  }
+  size_t size() const {
+    return buffer ? buffer->getBufferSize() : storage.size();
+  }
+
+private:
+  std::string storage;
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+};
+
+/// Get a read-only memoryview of a payload which keeps the payload alive.
+py::memoryview toMemoryView(PayloadBuffer payload) {
+  return py::memoryview(py::cast(std::move(payload)));
+}
+
+py::list toMemoryViews(std::vector<std::string> &outputs) {
+  py::list results;
+  for (auto &output : outputs)
+    results.append(toMemoryView(PayloadBuffer(std::move(output))));
+  return results;
+}
+
+/// Collects the diagnostics of a compilation or link from any of its threads
+/// without the GIL, so that they are handed to Python as one list once the
+/// call returns instead of calling into Python for each of them.
+class DiagnosticCollector {
+public:
+  qssc::DiagnosticCallback callback() {
+    return [this](const qssc::Diagnostic &diagnostic) {
+      std::lock_guard<std::mutex> const lock(mutex);
+      diagnostics.push_back(diagnostic);
+    };
+  }
+
+  /// Get the collected diagnostics in the order they were emitted. Requires
+  /// the GIL.
+  py::list take() {
+    std::lock_guard<std::mutex> const lock(mutex);
+    py::list result;
+    for (auto &diagnostic : diagnostics)
+      result.append(py::cast(std::move(diagnostic)));
+    diagnostics.clear();
+    return result;
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<qssc::Diagnostic> diagnostics;
+};
+
+std::vector<char const *> toArgv(const std::vector<std::string> &args) {
+  std::vector<char const *> argv;
+  argv.reserve(args.size() + 1);
+  for (auto &str : args)
+    argv.push_back(str.c_str());
+  argv.push_back(nullptr);
+  return argv;
+}
+} // anonymous namespace
+
 /// Call into the qss-compiler via an interface to qss-compile's command line
-/// argument.
+/// argument. The output is returned as a memoryview of the compiler's buffer,
+/// followed by the list of diagnostics of the compilation.
 py::tuple py_compile_by_args(const std::vector<std::string> &args,
-                             bool outputAsStr,
-                             qssc::DiagnosticCallback onDiagnostic) {
+                             bool outputAsStr) {
   std::string outputStr("");
 
 #ifndef NDEBUG
@@ -82,55 +163,391 @@ py::tuple py_compile_by_args(const std::vector<std::string> &args,
     std::cout << str << '\n';
 #endif
 
-  // TODO: need a C++ interface into the compiler with fewer detours. the python
-  // api (inspired by IREE's python bindings) can be a start.
-  std::vector<char const *> argv;
-  argv.reserve(args.size() + 1);
-  for (auto &str : args)
-    argv.push_back(str.c_str());
-  argv.push_back(nullptr);
-
-  int const status = qssc::compile(args.size(), argv.data(),
-                                   outputAsStr ? &outputStr : nullptr,
-                                   std::move(onDiagnostic));
+  auto argv = toArgv(args);
+  DiagnosticCollector diagnostics;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    status = qssc::compile(args.size(), argv.data(),
+                           outputAsStr ? &outputStr : nullptr,
+                           diagnostics.callback());
+  }
   bool const success = status == 0;
 
 #ifndef NDEBUG
   std::cerr << "Compile " << (success ? "successful" : "failed") << '\n';
 #endif
 
-  return py::make_tuple(success, py::bytes(outputStr));
+  return py::make_tuple(success,
+                        toMemoryView(PayloadBuffer(std::move(outputStr))),
+                        diagnostics.take());
+}
+
+/// Call into the qss-compiler within this process via the qss-compiler command
+/// line arguments, as py_compile_by_args does, so that calls from several
+/// Python threads compile concurrently. The diagnostics of the compilation
+/// are collected from its threads and returned once it completes.
+py::tuple py_compile_concurrent_by_args(const std::vector<std::string> &args,
+                                        bool outputAsStr) {
+  std::string outputStr("");
+
+  auto argv = toArgv(args);
+  DiagnosticCollector diagnostics;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    status = qssc::compileConcurrent(args.size(), argv.data(),
+                                     outputAsStr ? &outputStr : nullptr,
+                                     diagnostics.callback());
+  }
+  bool const success = status == 0;
+
+  return py::make_tuple(success,
+                        toMemoryView(PayloadBuffer(std::move(outputStr))),
+                        diagnostics.take());
 }
 
-py::tuple py_link_file(const std::string &input, const bool enableInMemoryInput,
+/// Call into a long-lived compiler instance via the qss-compiler command line
+/// arguments, reusing the target set up by its previous compilations.
+py::tuple py_compile_server_by_args(qssc::CompileServer &server,
+                                    const std::vector<std::string> &args,
+                                    bool outputAsStr) {
+  std::string outputStr("");
+
+  auto argv = toArgv(args);
+  DiagnosticCollector diagnostics;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    status = server.compile(args.size(), argv.data(),
+                            outputAsStr ? &outputStr : nullptr,
+                            diagnostics.callback());
+  }
+  return py::make_tuple(status == 0,
+                        toMemoryView(PayloadBuffer(std::move(outputStr))),
+                        diagnostics.take());
+}
+
+/// Call into a long-lived compiler instance for a batch of programs sharing
+/// the qss-compiler command line arguments.
+py::tuple py_compile_server_batch_by_args(
+    qssc::CompileServer &server, const std::vector<std::string> &args,
+    const std::vector<std::string> &inputs) {
+  auto argv = toArgv(args);
+
+  std::vector<std::string> outputs;
+  std::vector<int> statuses;
+  DiagnosticCollector diagnostics;
+  {
+    py::gil_scoped_release const release;
+    server.compileBatch(args.size(), argv.data(), inputs, &outputs, &statuses,
+                        diagnostics.callback());
+  }
+
+  py::list successes;
+  for (size_t i = 0; i < inputs.size(); ++i)
+    successes.append(statuses[i] == 0);
+  return py::make_tuple(successes, toMemoryViews(outputs),
+                        diagnostics.take());
+}
+
+/// Call into the qss-compiler for a batch of programs sharing the
+/// qss-compiler command line arguments.
+py::tuple py_compile_batch_by_args(const std::vector<std::string> &args,
+                                   const std::vector<std::string> &inputs) {
+  auto argv = toArgv(args);
+
+  std::vector<std::string> outputs;
+  std::vector<int> statuses;
+  DiagnosticCollector diagnostics;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    status = qssc::compileBatch(args.size(), argv.data(), inputs, &outputs,
+                                &statuses, diagnostics.callback());
+  }
+
+#ifndef NDEBUG
+  std::cerr << "Batch compile " << (status == 0 ? "successful" : "failed")
+            << '\n';
+#endif
+
+  py::list successes;
+  for (size_t i = 0; i < inputs.size(); ++i)
+    successes.append(statuses[i] == 0);
+  return py::make_tuple(successes, toMemoryViews(outputs),
+                        diagnostics.take());
+}
+
+/// Call into the qss-compiler for a single program and several target
+/// configurations sharing the qss-compiler command line arguments.
+py::tuple
+py_compile_multi_config_by_args(const std::vector<std::string> &args,
+                                const std::vector<std::string> &configPaths) {
+  auto argv = toArgv(args);
+
+  std::vector<std::string> outputs;
+  std::vector<int> statuses;
+  DiagnosticCollector diagnostics;
+  {
+    py::gil_scoped_release const release;
+    qssc::compileMultiConfig(args.size(), argv.data(), configPaths, &outputs,
+                             &statuses, diagnostics.callback());
+  }
+
+  py::list successes;
+  for (size_t i = 0; i < configPaths.size(); ++i)
+    successes.append(statuses[i] == 0);
+  return py::make_tuple(successes, toMemoryViews(outputs),
+                        diagnostics.take());
+}
+
+/// Call into a long-lived compiler instance for a single program and several
+/// target configurations.
+py::tuple py_compile_server_multi_config_by_args(
+    qssc::CompileServer &server, const std::vector<std::string> &args,
+    const std::vector<std::string> &configPaths) {
+  auto argv = toArgv(args);
+
+  std::vector<std::string> outputs;
+  std::vector<int> statuses;
+  DiagnosticCollector diagnostics;
+  {
+    py::gil_scoped_release const release;
+    server.compileMultiConfig(args.size(), argv.data(), configPaths, &outputs,
+                              &statuses, diagnostics.callback());
+  }
+
+  py::list successes;
+  for (size_t i = 0; i < configPaths.size(); ++i)
+    successes.append(statuses[i] == 0);
+  return py::make_tuple(successes, toMemoryViews(outputs),
+                        diagnostics.take());
+}
+
+/// Get the memory accounting of a long-lived compiler instance.
+py::dict py_compile_server_metrics(const qssc::CompileServer &server) {
+  auto const metrics = server.getMetrics();
+  py::dict result;
+  result["num_jobs"] = metrics.numJobs;
+  result["context_generation"] = metrics.contextGeneration;
+  result["context_jobs"] = metrics.contextJobs;
+  result["context_allocated_bytes"] = metrics.contextAllocatedBytes;
+  result["last_job_allocated_bytes"] = metrics.lastJobAllocatedBytes;
+  result["last_job_resident_bytes"] = metrics.lastJobResidentBytes;
+  result["resident_bytes"] = metrics.residentBytes;
+  return result;
+}
+
+/// Export the metrics of the compilations and bindings of this process in
+/// the format named prometheus, openmetrics or json.
+std::string py_export_metrics(const std::string &format, bool reset) {
+  qssc::MetricsFormat metricsFormat;
+  if (format == "prometheus")
+    metricsFormat = qssc::MetricsFormat::Prometheus;
+  else if (format == "openmetrics")
+    metricsFormat = qssc::MetricsFormat::OpenMetrics;
+  else if (format == "json")
+    metricsFormat = qssc::MetricsFormat::JSON;
+  else
+    throw py::value_error("Unknown metrics format " + format);
+  return qssc::exportMetrics(metricsFormat, reset);
+}
+
+/// Estimate the cost of a compilation via the qss-compiler command line
+/// arguments. Returns whether the estimate succeeded, the estimate and the
+/// features it was estimated from, followed by the list of diagnostics.
+py::tuple py_estimate_compile_cost(const std::vector<std::string> &args) {
+  auto argv = toArgv(args);
+  DiagnosticCollector diagnostics;
+  qssc::CompileCostEstimate estimate;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    status = qssc::estimateCompileCost(args.size(), argv.data(), &estimate,
+                                       diagnostics.callback());
+  }
+
+  py::dict result;
+  result["seconds"] = estimate.seconds;
+  result["peak_memory_bytes"] = estimate.peakMemoryBytes;
+  result["num_operations"] = estimate.features.numOperations;
+  result["num_qubits"] = estimate.features.numQubits;
+  result["num_circuits"] = estimate.features.numCircuits;
+  result["num_targets"] = estimate.features.numTargets;
+  return py::make_tuple(status == 0, result, diagnostics.take());
+}
+
+/// View the module passed to the linker. Python bytes are immutable and kept
+/// alive by the caller so they are viewed in place, anything else is converted
+/// into storage.
+std::string_view viewLinkInput(const py::object &input, std::string &storage) {
+  if (py::isinstance<py::bytes>(input)) {
+    char *data;
+    Py_ssize_t size;
+    if (PyBytes_AsStringAndSize(input.ptr(), &data, &size) != 0)
+      throw py::error_already_set();
+    return {data, static_cast<size_t>(size)};
+  }
+  storage = input.cast<std::string>();
+  return storage;
+}
+
+/// Call into the linker. Modules passed as bytes are linked in place without
+/// copying them and the payload is returned as a memoryview of the linker's
+/// buffer, followed by the list of diagnostics of the link.
+py::tuple py_link_file(const py::object &input, const bool enableInMemoryInput,
                        const std::string &outputPath, const std::string &target,
                        const std::string &configPath,
                        const std::unordered_map<std::string, double> &arguments,
-                       bool treatWarningsAsErrors,
-                       qssc::DiagnosticCallback onDiagnostic) {
+                       bool treatWarningsAsErrors, bool patchInParallel) {
+
+  std::string inputStr;
+  std::string_view const inputView = viewLinkInput(input, inputStr);
 
   std::string inMemoryOutput("");
+  std::unique_ptr<llvm::MemoryBuffer> payload;
 
-  int const status = qssc::bindArguments(
-      target, configPath, input, outputPath, arguments, treatWarningsAsErrors,
-      enableInMemoryInput, &inMemoryOutput, std::move(onDiagnostic));
+  DiagnosticCollector diagnostics;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    if (enableInMemoryInput && outputPath.empty())
+      status = qssc::bindArgumentsInMemory(
+          target, configPath, inputView, arguments, treatWarningsAsErrors,
+          &payload, diagnostics.callback(), patchInParallel);
+    else
+      status = qssc::bindArguments(target, configPath, inputView, outputPath,
+                                   arguments, treatWarningsAsErrors,
+                                   enableInMemoryInput, &inMemoryOutput,
+                                   diagnostics.callback(), patchInParallel);
+  }
 
   bool const success = status == 0;
 #ifndef NDEBUG
   std::cerr << "Link " << (success ? "successful" : "failed") << '\n';
 #endif
-  return py::make_tuple(success, py::bytes(inMemoryOutput));
+  if (payload)
+    return py::make_tuple(success,
+                          toMemoryView(PayloadBuffer(std::move(payload))),
+                          diagnostics.take());
+  return py::make_tuple(success,
+                        toMemoryView(PayloadBuffer(std::move(inMemoryOutput))),
+                        diagnostics.take());
+}
+
+/// Call into the linker for a batch of argument sets bound to the same module.
+/// Unless onResult is None, it is called with the index, success and payload,
+/// as a memoryview, of each argument set as soon as it is bound, from the
+/// thread which bound it, and the returned payloads are empty.
+py::tuple py_link_file_batch(
+    const py::object &input, const bool enableInMemoryInput,
+    const std::string &target, const std::string &configPath,
+    const std::vector<std::unordered_map<std::string, double>> &argumentSets,
+    bool treatWarningsAsErrors, const py::object &onResult) {
+
+  std::string inputStr;
+  std::string_view const inputView = viewLinkInput(input, inputStr);
+
+  std::optional<std::function<void(size_t, int, std::string &)>> callback;
+  if (!onResult.is_none())
+    callback = [&onResult](size_t index, int status, std::string &payload) {
+      py::gil_scoped_acquire const acquire;
+      try {
+        onResult(index, status == 0,
+                 toMemoryView(PayloadBuffer(std::move(payload))));
+      } catch (py::error_already_set &error) {
+        // the binding threads cannot raise into Python
+        error.discard_as_unraisable("link_file_batch result callback");
+      }
+    };
+
+  std::vector<std::string> outputs;
+  std::vector<int> statuses;
+  DiagnosticCollector diagnostics;
+  int status;
+  {
+    py::gil_scoped_release const release;
+    status = qssc::bindArgumentsBatch(
+        target, configPath, inputView, argumentSets, treatWarningsAsErrors,
+        enableInMemoryInput, &outputs, &statuses, diagnostics.callback(),
+        callback);
+  }
+
+#ifndef NDEBUG
+  std::cerr << "Batch link " << (status == 0 ? "successful" : "failed")
+            << '\n';
+#endif
+
+  py::list successes;
+  for (size_t i = 0; i < argumentSets.size(); ++i)
+    successes.append(statuses[i] == 0);
+  return py::make_tuple(successes, toMemoryViews(outputs),
+                        diagnostics.take());
 }
 
 // Pybind module
 PYBIND11_MODULE(py_qssc, m) {
   m.doc() = "Python bindings for the QSS Compiler.";
 
+  py::class_<PayloadBuffer>(m, "_PayloadBuffer", py::buffer_protocol(),
+                            "A compiler or linker output")
+      .def_buffer([](const PayloadBuffer &payload) {
+        return py::buffer_info(
+            reinterpret_cast<const uint8_t *>(payload.data()),
+            static_cast<py::ssize_t>(payload.size()));
+      });
+
   m.def("_compile_with_args", &py_compile_by_args,
         "Call compiler via cli qss-compile");
+  m.def("_compile_concurrent_with_args", &py_compile_concurrent_by_args,
+        "Call compiler via cli qss-compile, concurrently with other calls");
+  m.def("_compile_batch_with_args", &py_compile_batch_by_args,
+        "Call compiler via cli qss-compile for a batch of programs");
+  m.def("_compile_multi_config_with_args", &py_compile_multi_config_by_args,
+        "Call compiler via cli qss-compile for several target "
+        "configurations");
+  py::class_<qssc::CompileServer>(
+      m, "_CompileServer",
+      "A compiler kept warm across compilations in the same process")
+      .def(py::init([](unsigned maxJobsPerContext, size_t maxContextBytes) {
+             return std::make_unique<qssc::CompileServer>(
+                 qssc::ContextRecyclingPolicy{maxJobsPerContext,
+                                              maxContextBytes});
+           }),
+           py::arg("max_jobs_per_context") = 0,
+           py::arg("max_context_bytes") = 0,
+           "Replace the MLIR context after max_jobs_per_context jobs or once "
+           "max_context_bytes have been allocated since its creation, 0 for "
+           "never")
+      .def("compile", &py_compile_server_by_args,
+           "Call the compiler via cli qss-compile arguments")
+      .def("compile_batch", &py_compile_server_batch_by_args,
+           "Call the compiler via cli qss-compile arguments for a batch of "
+           "programs")
+      .def("compile_multi_config", &py_compile_server_multi_config_by_args,
+           "Call the compiler via cli qss-compile arguments for several "
+           "target configurations")
+      .def("metrics", &py_compile_server_metrics,
+           "Get the memory accounting of the compiler")
+      .def("recycle_context", &qssc::CompileServer::recycleContext,
+           "Replace the MLIR context of the compiler, freeing its memory");
+  m.def("_export_metrics", &py_export_metrics, py::arg("format") = "prometheus",
+        py::arg("reset") = false,
+        "Export the metrics of the compilations and bindings of this process");
+  m.def(
+      "_merge_metrics",
+      [](const std::string &json) { return qssc::mergeMetrics(json) == 0; },
+      "Add metrics exported as json by another process to this process");
+  m.def("_estimate_compile_cost", &py_estimate_compile_cost,
+        "Estimate the cost of a compilation via cli qss-compile arguments");
   m.def("_link_file", &py_link_file, "Call the linker tool");
+  m.def("_link_file_batch", &py_link_file_batch,
+        "Call the linker tool for a batch of argument sets");
 
-  addErrorCategory(m);
-  addSeverity(m);
-  addDiagnostic(m);
+  // the diagnostics are registered by py_qssc_enums, which the package may
+  // have imported without the compiler
+  auto enums = py::module_::import("qss_compiler.py_qssc_enums");
+  for (const char *name : {"ErrorCategory", "Severity", "Diagnostic"})
+    m.attr(name) = enums.attr(name);
 }
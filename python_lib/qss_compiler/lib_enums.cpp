@@ -75,3 +75,13 @@ void addDiagnostic(py::module &m) {
             return qssc::Diagnostic(severity, category, std::move(message));
           }));
 }
+
+// The types shared by the compiler and its diagnostics, in a module of their
+// own so that they are available without loading the compiler
+PYBIND11_MODULE(py_qssc_enums, m) {
+  m.doc() = "Diagnostics of the QSS Compiler.";
+
+  addErrorCategory(m);
+  addSeverity(m);
+  addDiagnostic(m);
+}
@@ -19,13 +19,25 @@ package.
 
 """
 
+import asyncio
 from dataclasses import dataclass, field
+import functools
 from importlib import resources as importlib_resources
 from os import environ as os_environ
-from typing import Mapping, Any, Optional, Callable, Union
+from typing import (
+    Any,
+    AsyncIterator,
+    Callable,
+    List,
+    Mapping,
+    Optional,
+    Sequence,
+    Tuple,
+    Union,
+)
 import warnings
 
-from .py_qssc import _link_file, Diagnostic, ErrorCategory
+from .py_qssc_enums import Diagnostic, ErrorCategory
 from .compile import _stringify_path
 
 from . import exceptions
@@ -37,8 +49,8 @@ class LinkOptions:
 
     input_file: str = None
     """Path to input module."""
-    input_bytes: Union[str, None] = None
-    """Input payload as raw bytes"""
+    input_bytes: Union[bytes, str, None] = None
+    """Input payload as raw bytes. Bytes are linked in place without copying."""
     output_file: Union[str, None] = None
     """Output file, if not supplied raw bytes will be returned."""
     target: str = None
@@ -51,8 +63,16 @@ class LinkOptions:
     """Target configuration path."""
     treat_warnings_as_errors: bool = True
     """Treat link warnings as errors"""
+    parallel_patching: bool = False
+    """Patch the binaries of the module concurrently. Requires the target's
+        argument binding to support patching distinct binaries in parallel.
+    """
     on_diagnostic: Optional[Callable[[Diagnostic], Any]] = None
     """Optional callback for processing diagnostic messages from the linker."""
+    output_as_memoryview: bool = False
+    """Return payloads as read-only memoryviews of the linker's buffers instead
+        of copying them into bytes.
+    """
 
 
 def _prepare_link_options(link_options: Optional[LinkOptions] = None, **kwargs) -> LinkOptions:
@@ -61,10 +81,63 @@ def _prepare_link_options(link_options: Optional[LinkOptions] = None, **kwargs)
     return link_options
 
 
+def _convert_arguments(arguments: Mapping[str, Any]) -> Mapping[str, Any]:
+    for key, value in arguments.items():
+        if not isinstance(value, float):
+            if isinstance(value, int):
+                arguments[key] = float(value)
+            else:
+                raise exceptions.QSSArgumentInputTypeError(
+                    f"Only int & double arguments are supported, not {type(value)}"
+                )
+    return arguments
+
+
+def _set_resources_env(version_py_path):
+    # The qss-compiler expects the path to static resources in the environment
+    # variable QSSC_RESOURCES. In the python package, those resources are
+    # bundled under the directory resources/. Since python's functions for
+    # looking up resources only treat files as resources, use the generated
+    # python source _version.py to look up the path to the python package.
+    resources_path = version_py_path.parent / "resources"
+    os_environ["QSSC_RESOURCES"] = str(resources_path)
+
+
+def _raise_link_failure(diagnostics):
+    exception_mapping = {
+        ErrorCategory.QSSLinkerNotImplemented: exceptions.QSSLinkerNotImplemented,
+        ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
+        ErrorCategory.QSSLinkSignatureError: exceptions.QSSLinkSignatureError,
+        ErrorCategory.QSSLinkAddressError: exceptions.QSSLinkAddressError,
+        ErrorCategory.QSSLinkSignatureNotFound: exceptions.QSSLinkSignatureNotFound,
+        ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
+        ErrorCategory.QSSLinkInvalidPatchTypeError: exceptions.QSSLinkInvalidPatchTypeError,
+    }
+
+    if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
+        pass
+    elif diagnostics[0].category in exception_mapping.keys():
+        raise exception_mapping[diagnostics[0].category](diagnostics[0].message, diagnostics)
+    raise exceptions.QSSLinkingFailure("Unknown linking failure", diagnostics)
+
+
+def _warn_link_diagnostics(diagnostics):
+    warning_mapping = {
+        ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
+        ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
+    }
+    if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
+        pass
+    else:
+        for diagnostic in diagnostics:
+            if diagnostic.category in warning_mapping.keys():
+                warnings.warn(diagnostic.message, warning_mapping[diagnostic.category])
+
+
 def link_file(
     link_options: Optional[LinkOptions] = None,
     **kwargs,
-) -> Optional[bytes]:
+) -> Union[bytes, memoryview, None]:
     """Link a module and bind arguments to create a payload.
 
     Consume a circuit module in a file and binds the provided circuit
@@ -77,7 +150,8 @@ def link_file(
             with the target that created the module).
         arguments: Circuit arguments as name/value map.
 
-    Returns: Produces a payload in a file.
+    Returns: Produces a payload in a file, or returns it as raw bytes (a memoryview
+        with `output_as_memoryview`) if no output file is specified.
     """
     link_options = _prepare_link_options(link_options, **kwargs)
 
@@ -93,14 +167,7 @@ def link_file(
     if link_options.on_diagnostic is None:
         link_options.on_diagnostic = on_diagnostic
 
-    for key, value in link_options.arguments.items():
-        if not isinstance(value, float):
-            if isinstance(value, int):
-                link_options.arguments[key] = float(value)
-            else:
-                raise exceptions.QSSArgumentInputTypeError(
-                    f"Only int & double arguments are supported, not {type(value)}"
-                )
+    _convert_arguments(link_options.arguments)
 
     if link_options.input_file is not None and link_options.input_bytes is not None:
         raise ValueError("only one of input_file or input_bytes should have a value")
@@ -115,16 +182,11 @@ def link_file(
     # keep in mind that most of the infrastructure in the compile paths is for
     # taking care of the execution in a separate process. For the linker tool,
     # we aim at avoiding that right from the start!
-
-    # The qss-compiler expects the path to static resources in the environment
-    # variable QSSC_RESOURCES. In the python package, those resources are
-    # bundled under the directory resources/. Since python's functions for
-    # looking up resources only treat files as resources, use the generated
-    # python source _version.py to look up the path to the python package.
     with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
-        resources_path = version_py_path.parent / "resources"
-        os_environ["QSSC_RESOURCES"] = str(resources_path)
-        success, output = _link_file(
+        _set_resources_env(version_py_path)
+        from .py_qssc import _link_file
+
+        success, output, link_diagnostics = _link_file(
             input_file,
             enable_in_memory,
             output_file,
@@ -132,39 +194,199 @@ def link_file(
             config_path,
             link_options.arguments,
             link_options.treat_warnings_as_errors,
-            link_options.on_diagnostic,
+            link_options.parallel_patching,
         )
+        # the linker collects its diagnostics and delivers them at once
+        for diagnostic in link_diagnostics:
+            link_options.on_diagnostic(diagnostic)
         if not success:
-
-            exception_mapping = {
-                ErrorCategory.QSSLinkerNotImplemented: exceptions.QSSLinkerNotImplemented,
-                ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
-                ErrorCategory.QSSLinkSignatureError: exceptions.QSSLinkSignatureError,
-                ErrorCategory.QSSLinkAddressError: exceptions.QSSLinkAddressError,
-                ErrorCategory.QSSLinkSignatureNotFound: exceptions.QSSLinkSignatureNotFound,
-                ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
-                ErrorCategory.QSSLinkInvalidPatchTypeError: exceptions.QSSLinkInvalidPatchTypeError,
-            }
-
-            if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
-                pass
-            elif diagnostics[0].category in exception_mapping.keys():
-                raise exception_mapping[diagnostics[0].category](
-                    diagnostics[0].message, diagnostics
-                )
-            raise exceptions.QSSLinkingFailure("Unknown linking failure", diagnostics)
+            _raise_link_failure(diagnostics)
         else:
-            warning_mapping = {
-                ErrorCategory.QSSLinkSignatureWarning: exceptions.QSSLinkSignatureWarning,
-                ErrorCategory.QSSLinkArgumentNotFoundWarning: exceptions.QSSLinkArgumentNotFoundWarning,  # noqa
-            }
-            if diagnostics == [] or not isinstance(diagnostics[0], Diagnostic):
-                pass
-            else:
-                for diagnostic in diagnostics:
-                    if diagnostic.category in warning_mapping.keys():
-                        warnings.warn(diagnostic.message, warning_mapping[diagnostic.category])
+            _warn_link_diagnostics(diagnostics)
 
         # return in-memory raw bytes if output file is not specified
         if link_options.output_file is None:
-            return output
+            return output if link_options.output_as_memoryview else bytes(output)
+
+
+async def link_file_async(
+    link_options: Optional[LinkOptions] = None,
+    **kwargs,
+) -> Union[bytes, memoryview, None]:
+    """Link a module and bind arguments to create a payload without blocking
+    the event loop.
+
+    The link runs as :func:`link_file` on the default executor of the running
+    event loop. The linker does not hold the GIL while binding, so that links
+    of several argument sets proceed concurrently.
+
+    Returns: As :func:`link_file`.
+    """
+    loop = asyncio.get_running_loop()
+    return await loop.run_in_executor(None, functools.partial(link_file, link_options, **kwargs))
+
+
+def _prepare_link_batch(link_options: LinkOptions, arguments: Sequence[Mapping[str, Any]]):
+    input_file = _stringify_path(link_options.input_file)
+    config_path = _stringify_path(link_options.config_path)
+
+    diagnostics = []
+
+    def on_diagnostic(diag):
+        diagnostics.append(diag)
+
+    if link_options.on_diagnostic is None:
+        link_options.on_diagnostic = on_diagnostic
+
+    argument_sets = [_convert_arguments(dict(argument_set)) for argument_set in arguments]
+
+    if link_options.input_file is not None and link_options.input_bytes is not None:
+        raise ValueError("only one of input_file or input_bytes should have a value")
+
+    enable_in_memory = link_options.input_bytes is not None
+    if enable_in_memory:
+        input_file = link_options.input_bytes
+
+    return input_file, enable_in_memory, config_path, argument_sets, diagnostics
+
+
+def _finish_link_batch(link_options: LinkOptions, successes, link_diagnostics, diagnostics):
+    for diagnostic in link_diagnostics:
+        link_options.on_diagnostic(diagnostic)
+    if not all(successes):
+        _raise_link_failure(diagnostics)
+    else:
+        _warn_link_diagnostics(diagnostics)
+
+
+def link_file_batch(
+    arguments: Sequence[Mapping[str, Any]],
+    link_options: Optional[LinkOptions] = None,
+    output_files: Optional[Sequence[str]] = None,
+    **kwargs,
+) -> Optional[List[Union[bytes, memoryview]]]:
+    """Link a module once for many sets of arguments.
+
+    The module and its signature are loaded once and every argument set is
+    bound to its own copy of the payload in parallel, which is considerably
+    faster than calling link_file for each argument set in a parameter sweep.
+
+    Args:
+        arguments: Circuit arguments as one name/value map per payload.
+        link_options: Options shared by all payloads. Its arguments and
+            output_file are ignored.
+        output_files: Optional paths to write the payloads to, one for each
+            argument set.
+
+    Returns: The payloads as raw bytes, or memoryviews with
+        `output_as_memoryview`, if no output files are specified.
+    """
+    link_options = _prepare_link_options(link_options, **kwargs)
+
+    if output_files is not None and len(output_files) != len(arguments):
+        raise ValueError("output_files must provide a path for every argument set")
+
+    input_file, enable_in_memory, config_path, argument_sets, diagnostics = _prepare_link_batch(
+        link_options, arguments
+    )
+
+    with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
+        _set_resources_env(version_py_path)
+        from .py_qssc import _link_file_batch
+
+        successes, outputs, link_diagnostics = _link_file_batch(
+            input_file,
+            enable_in_memory,
+            link_options.target,
+            config_path,
+            argument_sets,
+            link_options.treat_warnings_as_errors,
+            None,
+        )
+        _finish_link_batch(link_options, successes, link_diagnostics, diagnostics)
+
+        if output_files is None:
+            if link_options.output_as_memoryview:
+                return outputs
+            return [bytes(output) for output in outputs]
+
+        for output_file, output in zip(output_files, outputs):
+            with open(_stringify_path(output_file), "wb") as f:
+                f.write(output)
+
+
+async def link_many(
+    arguments: Sequence[Mapping[str, Any]],
+    link_options: Optional[LinkOptions] = None,
+    **kwargs,
+) -> AsyncIterator[Tuple[int, Union[bytes, memoryview]]]:
+    """Link a module once for many sets of arguments, yielding each payload as
+    soon as it is bound.
+
+    As in :func:`link_file_batch` the module is loaded, and its signature
+    parsed, once and the argument sets are bound in parallel, without holding
+    the GIL or blocking the event loop. Payloads are yielded in the order they
+    are bound rather than the order of their argument sets::
+
+        async for index, payload in link_many(sweep, input_file=module, target=target):
+            submit(sweep[index], payload)
+
+    Args:
+        arguments: Circuit arguments as one name/value map per payload.
+        link_options: Options shared by all payloads. Its arguments and
+            output_file are ignored.
+
+    Yields: The index of each argument set bound successfully and its payload,
+        as raw bytes or a memoryview with `output_as_memoryview`. Failures are
+        raised once all argument sets have been bound.
+    """
+    link_options = _prepare_link_options(link_options, **kwargs)
+
+    input_file, enable_in_memory, config_path, argument_sets, diagnostics = _prepare_link_batch(
+        link_options, arguments
+    )
+
+    loop = asyncio.get_running_loop()
+    results = asyncio.Queue()
+
+    def put(result):
+        try:
+            loop.call_soon_threadsafe(results.put_nowait, result)
+        except RuntimeError:
+            # the event loop was closed before the batch completed
+            pass
+
+    def on_result(index, success, output):
+        put((index, success, output))
+
+    def link():
+        try:
+            with importlib_resources.path("qss_compiler", "_version.py") as version_py_path:
+                _set_resources_env(version_py_path)
+                from .py_qssc import _link_file_batch
+
+                return _link_file_batch(
+                    input_file,
+                    enable_in_memory,
+                    link_options.target,
+                    config_path,
+                    argument_sets,
+                    link_options.treat_warnings_as_errors,
+                    on_result,
+                )
+        finally:
+            # follows the results of all argument sets
+            put(None)
+
+    batch = loop.run_in_executor(None, link)
+
+    while True:
+        result = await results.get()
+        if result is None:
+            break
+        index, success, output = result
+        if success:
+            yield index, output if link_options.output_as_memoryview else bytes(output)
+
+    successes, _, link_diagnostics = await batch
+    _finish_link_batch(link_options, successes, link_diagnostics, diagnostics)
@@ -0,0 +1,66 @@
+# (C) Copyright IBM 2024.
+#
+# This code is part of Qiskit.
+#
+# This code is licensed under the Apache License, Version 2.0 with LLVM
+# Exceptions. You may obtain a copy of this license in the LICENSE.txt
+# file in the root directory of this source tree.
+#
+# Any modifications or derivative works of this code must retain this
+# copyright notice, and modified files need to carry a notice indicating
+# that they have been altered from the originals.
+"""
+This file defines the metrics interface for the qss_compiler package.
+
+The compiler counts the compilations and bindings of a process and records
+the latencies of their stages, the compile cache lookups and the payload
+sizes. Compilations run in compile processes, which send their metrics along
+with their results, so the metrics of this process include those of the
+compilations it requested. See ``qssc::exportMetrics`` in ``API/api.h`` for
+the metrics recorded.
+
+Example:
+
+    compile_str(program)
+    with open("metrics.prom", "w") as f:
+        f.write(export_metrics())
+"""
+
+from enum import Enum
+
+
+class MetricsFormat(Enum):
+    """Enumeration of the formats of exported metrics."""
+
+    PROMETHEUS = "prometheus"
+    OPENMETRICS = "openmetrics"
+    JSON = "json"
+
+    def __str__(self):
+        return self.value
+
+
+def export_metrics(
+    format: MetricsFormat = MetricsFormat.PROMETHEUS, reset: bool = False
+) -> str:
+    """Export the metrics of the compilations and bindings of this process.
+
+    Args:
+        format: The format of the metrics, the Prometheus text exposition
+            format by default.
+        reset: Whether to remove the exported metrics, e.g., to export only
+            the metrics recorded since the last export.
+
+    Returns:
+        The metrics.
+    """
+    from .py_qssc import _export_metrics
+
+    return _export_metrics(str(format), reset)
+
+
+def reset_metrics() -> None:
+    """Remove the metrics of this process."""
+    from .py_qssc import _export_metrics
+
+    _export_metrics(str(MetricsFormat.JSON), True)
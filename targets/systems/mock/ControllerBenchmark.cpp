@@ -0,0 +1,253 @@
+//===- ControllerBenchmark.cpp - JIT benchmark of the controller *- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the benchmark of the classical code of the Mock
+//  controller
+//
+//===----------------------------------------------------------------------===//
+
+#include "ControllerBenchmark.h"
+
+#include "Dialect/QCS/Utils/ShotLoop.h"
+
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
+#include "mlir/ExecutionEngine/OptUtils.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/Mangling.h"
+#include "llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
+#include "llvm/ExecutionEngine/Orc/Shared/ExecutorSymbolDef.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace qssc::targets::systems::mock;
+
+namespace {
+/// The calls of the JIT compiled code on this thread into the runtime hooks.
+thread_local uint64_t hookCalls = 0;
+
+/// The stub of the runtime hooks, which takes and ignores any integer or
+/// pointer arguments of the hook it resolves.
+int64_t runtimeHookStub() {
+  ++hookCalls;
+  return 0;
+}
+
+/// Counts the user space instructions retired by the calling thread, where
+/// the hardware counters of the host are available, e.g., not in all
+/// containers.
+class InstructionCounter {
+public:
+  InstructionCounter() {
+#if defined(__linux__)
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, /*pid=*/0,
+                                  /*cpu=*/-1, /*group_fd=*/-1, /*flags=*/0));
+#endif
+  }
+  InstructionCounter(const InstructionCounter &) = delete;
+  InstructionCounter &operator=(const InstructionCounter &) = delete;
+  ~InstructionCounter() {
+#if defined(__linux__)
+    if (fd >= 0)
+      close(fd);
+#endif
+  }
+
+  void start() {
+#if defined(__linux__)
+    if (fd < 0)
+      return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  std::optional<uint64_t> stop() {
+#if defined(__linux__)
+    if (fd < 0)
+      return std::nullopt;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t count = 0;
+    if (read(fd, &count, sizeof(count)) == sizeof(count))
+      return count;
+#endif
+    return std::nullopt;
+  }
+
+private:
+  int fd = -1;
+};
+
+llvm::Error makeError(const llvm::Twine &message) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(), message);
+}
+} // anonymous namespace
+
+void ControllerBenchmark::writeJSON(llvm::raw_ostream &os) const {
+  llvm::json::Object benchmark{
+      {"runs", runs},
+      {"shotsPerRun", static_cast<int64_t>(shotsPerRun)},
+      {"minRunSeconds", minRunSeconds},
+      {"medianRunSeconds", medianRunSeconds},
+      {"meanRunSeconds", meanRunSeconds},
+      {"medianShotSeconds", getMedianShotSeconds()},
+      {"staticInstructions", static_cast<int64_t>(staticInstructions)},
+      {"hookCallsPerRun", static_cast<int64_t>(hookCallsPerRun)}};
+  if (instructionsPerRun)
+    benchmark["instructionsPerRun"] = static_cast<int64_t>(*instructionsPerRun);
+  os << llvm::formatv("{0:2}\n", llvm::json::Value(std::move(benchmark)));
+}
+
+uint64_t qssc::targets::systems::mock::getShotsPerRun(mlir::ModuleOp moduleOp) {
+  auto shotLoop = mlir::qcs::getShotLoop(moduleOp);
+  if (!shotLoop)
+    return 1;
+  if (auto numShots = mlir::qcs::getNumShots(shotLoop))
+    return std::max<uint64_t>(*numShots, 1);
+
+  // the qcs.shot_init is not lowered by the Mock target, so fall back to the
+  // trip count of the loop
+  auto lowerBound = mlir::getConstantIntValue(shotLoop.getLowerBound());
+  auto upperBound = mlir::getConstantIntValue(shotLoop.getUpperBound());
+  auto step = mlir::getConstantIntValue(shotLoop.getStep());
+  if (!lowerBound || !upperBound || !step || *step <= 0 ||
+      *upperBound <= *lowerBound)
+    return 1;
+  return static_cast<uint64_t>((*upperBound - *lowerBound + *step - 1) /
+                               *step);
+}
+
+llvm::Expected<ControllerBenchmark>
+qssc::targets::systems::mock::benchmarkController(
+    mlir::ModuleOp controllerModule, uint64_t shotsPerRun, unsigned optLevel,
+    unsigned runs) {
+  ControllerBenchmark benchmark;
+  benchmark.runs = runs;
+  benchmark.shotsPerRun = std::max<uint64_t>(shotsPerRun, 1);
+
+  // the runtime hooks are the functions declared by the module which the
+  // process does not define
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+  llvm::SmallVector<std::string> hooks;
+  mlir::LLVM::LLVMFuncOp mainOp;
+  for (auto funcOp : controllerModule.getOps<mlir::LLVM::LLVMFuncOp>()) {
+    if (funcOp.isExternal()) {
+      if (!llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(
+              funcOp.getName().str()))
+        hooks.push_back(funcOp.getName().str());
+      continue;
+    }
+    funcOp.walk([&](mlir::Operation *) { ++benchmark.staticInstructions; });
+    if (funcOp.getName() == "main")
+      mainOp = funcOp;
+  }
+  if (!mainOp || mainOp.getNumArguments() != 0 ||
+      !llvm::isa<mlir::IntegerType>(
+          mainOp.getFunctionType().getReturnType()))
+    return makeError("The Mock controller module has no main function "
+                     "without arguments returning an integer to benchmark");
+
+  mlir::ExecutionEngineOptions options;
+  options.transformer = mlir::makeOptimizingTransformer(
+      optLevel, /*sizeLevel=*/0, /*targetMachine=*/nullptr);
+  options.jitCodeGenOptLevel = static_cast<llvm::CodeGenOpt::Level>(optLevel);
+  auto engineOrErr = mlir::ExecutionEngine::create(controllerModule, options);
+  if (!engineOrErr)
+    return llvm::joinErrors(
+        makeError("Unable to JIT compile the Mock controller module"),
+        engineOrErr.takeError());
+  auto &engine = *engineOrErr;
+  engine->registerSymbols([&](llvm::orc::MangleAndInterner interner) {
+    llvm::orc::SymbolMap symbols;
+    for (auto &hook : hooks)
+      symbols[interner(hook)] = llvm::orc::ExecutorSymbolDef(
+          llvm::orc::ExecutorAddr::fromPtr(&runtimeHookStub),
+          llvm::JITSymbolFlags::Exported);
+    return symbols;
+  });
+
+  auto mainOrErr = engine->lookup("main");
+  if (!mainOrErr)
+    return mainOrErr.takeError();
+  // the width of the returned integer does not matter, as it is ignored
+  auto *mainFn = reinterpret_cast<int64_t (*)()>(*mainOrErr);
+
+  // the first run resolves the lazily bound symbols and warms the caches
+  mainFn();
+
+  llvm::SmallVector<double> runSeconds;
+  InstructionCounter counter;
+  hookCalls = 0;
+  std::optional<uint64_t> instructions = 0;
+  for (unsigned run = 0; run < runs; ++run) {
+    counter.start();
+    auto const start = std::chrono::steady_clock::now();
+    mainFn();
+    auto const stop = std::chrono::steady_clock::now();
+    auto runInstructions = counter.stop();
+    runSeconds.push_back(std::chrono::duration<double>(stop - start).count());
+    if (instructions && runInstructions)
+      *instructions += *runInstructions;
+    else
+      instructions.reset();
+  }
+  if (runs == 0)
+    return benchmark;
+
+  llvm::sort(runSeconds);
+  benchmark.minRunSeconds = runSeconds.front();
+  benchmark.medianRunSeconds = runSeconds[runSeconds.size() / 2];
+  double totalSeconds = 0;
+  for (double const seconds : runSeconds)
+    totalSeconds += seconds;
+  benchmark.meanRunSeconds = totalSeconds / runs;
+  benchmark.hookCallsPerRun = hookCalls / runs;
+  if (instructions)
+    benchmark.instructionsPerRun = *instructions / runs;
+  return benchmark;
+}
@@ -0,0 +1,78 @@
+//===- ControllerBenchmark.h - JIT benchmark of the controller --*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the benchmark of the classical code of the Mock
+//  controller, which runs the controller module under a JIT on the host
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef HAL_TARGETS_MOCK_CONTROLLERBENCHMARK_H
+#define HAL_TARGETS_MOCK_CONTROLLERBENCHMARK_H
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace mlir {
+class ModuleOp;
+} // end namespace mlir
+
+namespace qssc::targets::systems::mock {
+
+/// The classical execution cost of the controller program, measured over
+/// runs of its main function, each of which executes shotsPerRun shots.
+struct ControllerBenchmark {
+  unsigned runs = 0;
+  uint64_t shotsPerRun = 1;
+  /// The wall time of a run, in seconds.
+  double minRunSeconds = 0;
+  double medianRunSeconds = 0;
+  double meanRunSeconds = 0;
+  /// The operations of the LLVM dialect functions of the controller module.
+  uint64_t staticInstructions = 0;
+  /// The user space instructions retired by a run, where the hardware
+  /// counters of the host are available.
+  std::optional<uint64_t> instructionsPerRun;
+  /// The calls of a run into the stubbed runtime hooks.
+  uint64_t hookCallsPerRun = 0;
+
+  double getMedianShotSeconds() const {
+    return medianRunSeconds / static_cast<double>(shotsPerRun);
+  }
+
+  void writeJSON(llvm::raw_ostream &os) const;
+};
+
+/// Get the number of shots of the shot loop of moduleOp, 1 if it has no
+/// shot loop or the trip count of the latter is not known. Must be called
+/// before the shot loop is lowered to the LLVM dialect.
+uint64_t getShotsPerRun(mlir::ModuleOp moduleOp);
+
+/// Benchmark the controller module, which must be translated to the LLVM
+/// dialect, by JIT compiling it at optLevel and running its main function
+/// once to warm up and then runs times. The external functions which the
+/// host process does not define, i.e., the runtime hooks of the controller,
+/// e.g., of the measurements, are resolved to a stub which counts its calls
+/// and returns 0.
+llvm::Expected<ControllerBenchmark>
+benchmarkController(mlir::ModuleOp controllerModule, uint64_t shotsPerRun,
+                    unsigned optLevel, unsigned runs);
+
+} // namespace qssc::targets::systems::mock
+
+#endif // HAL_TARGETS_MOCK_CONTROLLERBENCHMARK_H
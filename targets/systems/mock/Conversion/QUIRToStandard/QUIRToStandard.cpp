@@ -33,27 +33,48 @@
 #include "Dialect/QUIR/IR/QUIRDialect.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/FixedPointAngle.h"
 
+#include "mlir/Dialect/Affine/Analysis/AffineAnalysis.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Affine/Utils.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Func/Transforms/FuncConversions.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Dialect/Vector/Transforms/LoweringPatterns.h"
+#include "mlir/IR/AffineExpr.h"
+#include "mlir/IR/AffineMap.h"
+#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/ValueRange.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
-
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
 #include <utility>
 
 using namespace mlir;
@@ -92,15 +113,21 @@ struct ConstantOpConversionPat : public OpConversionPattern<quir::ConstantOp> {
       if (!angleWidth.has_value())
         return failure();
 
-      int64_t const multiplier = (int64_t)1 << (int64_t)angleWidth.value();
       // shift the floating point value up by the desired precision
-      double const fVal = angleAttr.getValue().convertToDouble() * multiplier;
+      double const value = angleAttr.getValue().convertToDouble();
+      auto bits = quir::visitAngleWidth(*angleWidth, [&](auto angle) {
+        return static_cast<int64_t>(
+            decltype(angle)::fromDouble(value).getStorage());
+      });
+      if (!bits)
+        return failure();
+
       IntegerType iType;
       if (angleWidth.value() > 31)
         iType = rewriter.getI64Type();
       else
         iType = rewriter.getI32Type();
-      IntegerAttr const iAttr = rewriter.getIntegerAttr(iType, (int64_t)fVal);
+      IntegerAttr const iAttr = rewriter.getIntegerAttr(iType, *bits);
 
       auto arithConstOp = rewriter.create<mlir::arith::ConstantOp>(
           constOp->getLoc(), iType, iAttr);
@@ -132,9 +159,13 @@ struct AngleBinOpConversionPat : public OpConversionPattern<QuirOp> {
     if (!angleWidth.has_value())
       return failure();
 
-    int64_t const maskVal = ((int64_t)1 << (int64_t)angleWidth.value()) - 1;
+    auto maskVal = quir::visitAngleWidth(*angleWidth, [](auto angle) {
+      return static_cast<int64_t>(decltype(angle)::mask);
+    });
+    if (!maskVal)
+      return failure();
     auto iType = operands[0].getType().template dyn_cast<IntegerType>();
-    IntegerAttr const iAttr = rewriter.getIntegerAttr(iType, maskVal);
+    IntegerAttr const iAttr = rewriter.getIntegerAttr(iType, *maskVal);
 
     auto stdOp =
         rewriter.create<StdOp>(binOp.getLoc(), iType, operands[0], operands[1]);
@@ -160,69 +191,414 @@ struct CommOpConversionPat : public OpConversionPattern<CommOp> {
                   ConversionPatternRewriter &rewriter) const override {
     const auto numResults = commOp.getOperation()->getNumResults();
 
-    switch (numResults) {
-    case 0:
+    if (numResults == 0) {
       rewriter.eraseOp(commOp.getOperation());
       return success();
+    }
 
-    case 1: {
-      // shift the floating point value up by the desired precision
-      int64_t const iVal = 1;
-      IntegerType const i1Type = rewriter.getI1Type();
+    // a receive may carry several values once messages are coalesced
+    int64_t const iVal = 1;
+    IntegerType const i1Type = rewriter.getI1Type();
 
-      IntegerAttr const iAttr = rewriter.getIntegerAttr(i1Type, iVal);
-      auto constOp = rewriter.create<mlir::arith::ConstantOp>(commOp->getLoc(),
-                                                              i1Type, iAttr);
-      rewriter.replaceOp(commOp.getOperation(), {constOp.getODSResults(0)});
-      return success();
+    IntegerAttr const iAttr = rewriter.getIntegerAttr(i1Type, iVal);
+    SmallVector<Value> values;
+    for (unsigned i = 0; i < numResults; ++i)
+      values.push_back(rewriter.create<mlir::arith::ConstantOp>(
+          commOp->getLoc(), i1Type, iAttr));
+    rewriter.replaceOp(commOp.getOperation(), values);
+    return success();
+  } // matchAndRewrite
+};  // struct CommOpConversionPat
+
+namespace {
+// the lanes of the vector operations computing independent angle operations
+constexpr unsigned maxAngleLanes = 16;
+// the iterations of a loop computed by each vector operation of its body
+constexpr int64_t loopVectorWidth = 4;
+
+// An angle operation as converted by AngleBinOpConversionPat, i.e., the
+// integer operation and the and masking its result to the width of the angle
+struct AngleArith {
+  Operation *op;
+  Operation *maskOp;
+  Attribute mask;
+};
+
+std::optional<AngleArith> matchAngleArith(Operation *op) {
+  if (!isa<arith::AddIOp, arith::SubIOp, arith::MulIOp>(op) ||
+      !op->hasOneUse())
+    return std::nullopt;
+  auto andOp = dyn_cast<LLVM::AndOp>(*op->user_begin());
+  if (!andOp || andOp->getBlock() != op->getBlock() ||
+      andOp->getOperand(0) != op->getResult(0))
+    return std::nullopt;
+  auto maskConstOp = andOp->getOperand(1).getDefiningOp<arith::ConstantOp>();
+  if (!maskConstOp)
+    return std::nullopt;
+  return AngleArith{op, andOp, maskConstOp.getValue()};
+}
+
+// Independent angle operations of the same kind and width, computed by one
+// vector operation before insertBefore, i.e., before the first use of their
+// results or their last member
+struct AngleGroup {
+  SmallVector<AngleArith> members;
+  SmallPtrSet<Value, 8> results;
+  Operation *insertBefore = nullptr;
+
+  bool accepts(const AngleArith &angle) const {
+    const auto &first = members.front();
+    return first.op->getName() == angle.op->getName() &&
+           first.op->getResultTypes() == angle.op->getResultTypes() &&
+           first.mask == angle.mask;
+  }
+};
+
+// Build a vector of the index-th operands of the members of a group, by a
+// broadcast if they are all the same value
+Value buildOperandVector(OpBuilder &builder, Location loc,
+                         const AngleGroup &group, unsigned index,
+                         VectorType vectorType, ArrayRef<Value> positions) {
+  Value const first = group.members.front().op->getOperand(index);
+  if (llvm::all_of(group.members, [&](const AngleArith &angle) {
+        return angle.op->getOperand(index) == first;
+      }))
+    return builder.create<vector::BroadcastOp>(loc, vectorType, first);
+
+  Value vector = builder.create<arith::ConstantOp>(
+      loc, vectorType, builder.getZeroAttr(vectorType));
+  for (const auto &[angle, position] : llvm::zip(group.members, positions))
+    vector = builder.create<vector::InsertElementOp>(
+        loc, angle.op->getOperand(index), vector, position);
+  return vector;
+}
+
+void vectorizeGroup(AngleGroup &group) {
+  auto &members = group.members;
+  OpBuilder builder(group.insertBefore);
+  Location const loc = members.front().op->getLoc();
+  auto vectorType =
+      VectorType::get({static_cast<int64_t>(members.size())},
+                      members.front().op->getResult(0).getType());
+
+  SmallVector<Value> positions;
+  for (unsigned i = 0; i < members.size(); ++i)
+    positions.push_back(builder.create<arith::ConstantIndexOp>(loc, i));
+  Value const lhs =
+      buildOperandVector(builder, loc, group, 0, vectorType, positions);
+  Value const rhs =
+      buildOperandVector(builder, loc, group, 1, vectorType, positions);
+  OperationState state(loc, members.front().op->getName());
+  state.addOperands({lhs, rhs});
+  state.types.push_back(vectorType);
+  state.addAttributes(members.front().op->getAttrs());
+  Operation *vectorOp = builder.create(state);
+  auto mask = builder.create<arith::ConstantOp>(
+      loc, vectorType,
+      DenseElementsAttr::get(vectorType, members.front().mask));
+  auto masked =
+      builder.create<arith::AndIOp>(loc, vectorOp->getResult(0), mask);
+
+  for (const auto &[angle, position] : llvm::zip(members, positions)) {
+    auto element = builder.create<vector::ExtractElementOp>(loc, masked,
+                                                            position);
+    angle.maskOp->getResult(0).replaceAllUsesWith(element.getResult());
+  }
+  // the members are erased once the builder no longer inserts before one
+  for (const auto &angle : members) {
+    Operation *maskConstOp = angle.maskOp->getOperand(1).getDefiningOp();
+    angle.maskOp->erase();
+    angle.op->erase();
+    if (maskConstOp->use_empty())
+      maskConstOp->erase();
+  }
+}
+
+// Compute the independent angle operations of each block, e.g., of the phases
+// tracked for many qubits, by vector operations. An operation joins a group of
+// the operations of its kind and width until an operation uses the result of
+// one of the group, before which the group is computed.
+void vectorizeAngleArithmetic(ModuleOp moduleOp) {
+  SmallVector<AngleGroup> groups;
+  moduleOp->walk([&](Block *block) {
+    SmallVector<AngleGroup> open;
+    SmallPtrSet<Operation *, 16> pendingMasks;
+    auto close = [&](AngleGroup &group, Operation *insertBefore) {
+      for (const auto &angle : group.members)
+        pendingMasks.erase(angle.maskOp);
+      if (group.members.size() > 1) {
+        group.insertBefore = insertBefore;
+        groups.push_back(std::move(group));
+      }
+    };
+
+    for (Operation &op : *block) {
+      if (pendingMasks.contains(&op))
+        continue;
+      // the group must be computed before any use of its results, including
+      // the uses in the regions of op
+      for (auto &group : open) {
+        bool const used =
+            op.walk([&](Operation *user) {
+                for (Value const operand : user->getOperands())
+                  if (group.results.contains(operand))
+                    return WalkResult::interrupt();
+                return WalkResult::advance();
+              }).wasInterrupted();
+        if (used) {
+          close(group, &op);
+          group.members.clear();
+        }
+      }
+      llvm::erase_if(open,
+                     [](const AngleGroup &group) {
+                       return group.members.empty();
+                     });
+
+      auto angle = matchAngleArith(&op);
+      if (!angle)
+        continue;
+      pendingMasks.insert(angle->maskOp);
+      auto *group = llvm::find_if(open, [&](const AngleGroup &candidate) {
+        return candidate.accepts(*angle);
+      });
+      if (group == open.end()) {
+        open.emplace_back();
+        group = std::prev(open.end());
+      }
+      group->members.push_back(*angle);
+      group->results.insert(angle->maskOp->getResult(0));
+      if (group->members.size() == maxAngleLanes) {
+        close(*group, &op);
+        open.erase(group);
+      }
     }
 
-    default:
-      commOp.emitOpError()
-          << "Error: " << commOp.getOperation() << " with " << numResults
-          << " is not currently handled by the pattern CommOpConversionPat!\n";
-      return failure();
+    // blocks which end without a terminator are left to the scalar operations
+    if (block->empty() || !block->back().hasTrait<OpTrait::IsTerminator>())
+      return;
+    for (auto &group : open)
+      close(group, &block->back());
+  });
+
+  // the groups are computed in the order they were closed, so that the
+  // operation a group is inserted before is removed by a later group only
+  for (auto &group : groups)
+    vectorizeGroup(group);
+}
+
+// An index of a memref access in a loop, i.e., a constant offset from the
+// induction variable of the loop or from 0
+struct LoopIndex {
+  bool isInductionVar = false;
+  int64_t offset = 0;
+};
+
+std::optional<LoopIndex> matchLoopIndex(Value index, Value inductionVar) {
+  if (index == inductionVar)
+    return LoopIndex{true, 0};
+  APInt value;
+  if (matchPattern(index, m_ConstantInt(&value)))
+    return LoopIndex{false, value.getSExtValue()};
+  auto addOp = index.getDefiningOp<arith::AddIOp>();
+  if (!addOp)
+    return std::nullopt;
+  auto lhs = matchLoopIndex(addOp.getLhs(), inductionVar);
+  auto rhs = matchLoopIndex(addOp.getRhs(), inductionVar);
+  // the accesses of the vectorized loops must be contiguous
+  if (!lhs || !rhs || (lhs->isInductionVar && rhs->isInductionVar))
+    return std::nullopt;
+  return LoopIndex{lhs->isInductionVar || rhs->isInductionVar,
+                   lhs->offset + rhs->offset};
+}
+
+// Raise a loop of constant bounds, of a multiple of loopVectorWidth
+// iterations, to an affine loop, which the affine vectorizer accepts. The
+// body of the loop may only compute arith operations and access the elements
+// of memrefs, e.g., of the registers of the controller, at a constant index
+// or a constant offset from the induction variable, within the bounds of the
+// memrefs for all iterations. The elements accessed at the induction variable
+// must be whole bytes, as vectors of i1 are packed in memory while memrefs of
+// i1 are not.
+std::optional<affine::AffineForOp> raiseArrayLoop(scf::ForOp forOp) {
+  APInt lowerBound;
+  APInt upperBound;
+  APInt step;
+  if (!forOp.getInitArgs().empty() ||
+      !matchPattern(forOp.getLowerBound(), m_ConstantInt(&lowerBound)) ||
+      !matchPattern(forOp.getUpperBound(), m_ConstantInt(&upperBound)) ||
+      !matchPattern(forOp.getStep(), m_ConstantInt(&step)) || !step.isOne())
+    return std::nullopt;
+  int64_t const lower = lowerBound.getSExtValue();
+  int64_t const upper = upperBound.getSExtValue();
+  if (upper <= lower || (upper - lower) % loopVectorWidth != 0)
+    return std::nullopt;
+
+  MLIRContext *context = forOp.getContext();
+  Value const inductionVar = forOp.getInductionVar();
+  DenseMap<Operation *, AffineMap> accessMaps;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (op.getNumRegions() != 0)
+      return std::nullopt;
+    if (isa<arith::ArithDialect>(op.getDialect()))
+      continue;
+    // e.g., the loads and stores of classical variables
+    if (auto affineLoadOp = dyn_cast<affine::AffineLoadOp>(op)) {
+      if (!affineLoadOp.getMapOperands().empty())
+        return std::nullopt;
+      continue;
     }
-  } // matchAndRewrite
-};  // struct CommOpConversionPat
+    if (auto affineStoreOp = dyn_cast<affine::AffineStoreOp>(op)) {
+      if (!affineStoreOp.getMapOperands().empty())
+        return std::nullopt;
+      continue;
+    }
+
+    Value memref;
+    ValueRange indices;
+    if (auto loadOp = dyn_cast<memref::LoadOp>(op)) {
+      memref = loadOp.getMemRef();
+      indices = loadOp.getIndices();
+    } else if (auto storeOp = dyn_cast<memref::StoreOp>(op)) {
+      memref = storeOp.getMemRef();
+      indices = storeOp.getIndices();
+    } else
+      return std::nullopt;
+
+    auto memrefType = memref.getType().cast<MemRefType>();
+    if (!memrefType.hasStaticShape())
+      return std::nullopt;
+    Type const elementType = memrefType.getElementType();
+    bool const isByteSized = elementType.isIntOrFloat() &&
+                             elementType.getIntOrFloatBitWidth() % 8 == 0;
+    SmallVector<AffineExpr> exprs;
+    for (auto [index, size] : llvm::zip(indices, memrefType.getShape())) {
+      auto loopIndex = matchLoopIndex(index, inductionVar);
+      if (!loopIndex || (loopIndex->isInductionVar && !isByteSized))
+        return std::nullopt;
+      int64_t const first =
+          loopIndex->offset + (loopIndex->isInductionVar ? lower : 0);
+      int64_t const last =
+          loopIndex->offset + (loopIndex->isInductionVar ? upper - 1 : 0);
+      if (first < 0 || last >= size)
+        return std::nullopt;
+      exprs.push_back(loopIndex->isInductionVar
+                          ? getAffineDimExpr(0, context) + loopIndex->offset
+                          : getAffineConstantExpr(loopIndex->offset, context));
+    }
+    accessMaps[&op] = AffineMap::get(1, 0, exprs, context);
+  }
+
+  OpBuilder builder(forOp);
+  auto affineForOp =
+      builder.create<affine::AffineForOp>(forOp.getLoc(), lower, upper);
+  Block *body = affineForOp.getBody();
+  body->getOperations().splice(std::prev(body->end()),
+                               forOp.getBody()->getOperations(),
+                               forOp.getBody()->begin(),
+                               std::prev(forOp.getBody()->end()));
+  Value const affineInductionVar = affineForOp.getInductionVar();
+  inductionVar.replaceAllUsesWith(affineInductionVar);
+  forOp.erase();
+
+  for (auto [op, map] : accessMaps) {
+    builder.setInsertionPoint(op);
+    if (auto loadOp = dyn_cast<memref::LoadOp>(op)) {
+      auto affineLoadOp = builder.create<affine::AffineLoadOp>(
+          loadOp.getLoc(), loadOp.getMemRef(), map,
+          ValueRange{affineInductionVar});
+      loadOp.getResult().replaceAllUsesWith(affineLoadOp.getResult());
+    } else {
+      auto storeOp = cast<memref::StoreOp>(op);
+      builder.create<affine::AffineStoreOp>(
+          storeOp.getLoc(), storeOp.getValueToStore(), storeOp.getMemRef(),
+          map, ValueRange{affineInductionVar});
+    }
+    op->erase();
+  }
+
+  // the index computations of the accesses are no longer used
+  for (Operation &op :
+       llvm::make_early_inc_range(llvm::reverse(body->without_terminator())))
+    if (isOpTriviallyDead(&op))
+      op.erase();
+  return affineForOp;
+}
+
+// Compute the iterations of the loops over the elements of memrefs on the
+// controller, e.g., over the bits of the syndromes of a decoding kernel, by
+// the vector operations of the affine vectorizer, loopVectorWidth iterations
+// at a time. Only the innermost loops whose iterations are independent and
+// which raiseArrayLoop raises are vectorized.
+void vectorizeArrayLoops(ModuleOp moduleOp) {
+  SmallVector<scf::ForOp> forOps;
+  moduleOp->walk([&](scf::ForOp forOp) { forOps.push_back(forOp); });
+
+  DenseSet<Operation *> parallelLoops;
+  for (auto forOp : forOps)
+    if (auto affineForOp = raiseArrayLoop(forOp))
+      if (affine::isLoopParallel(*affineForOp))
+        parallelLoops.insert(*affineForOp);
+  if (parallelLoops.empty())
+    return;
+
+  affine::vectorizeAffineLoops(moduleOp, parallelLoops, {loopVectorWidth},
+                               /*fastestVaryingPattern=*/{});
+
+  // the accesses of the raised loops are within bounds for all iterations,
+  // so that the transfers of the vector loops need not be masked
+  auto setInBounds = [](auto transferOp) {
+    if (!transferOp->template getParentOfType<affine::AffineForOp>())
+      return;
+    SmallVector<bool> const inBounds(transferOp.getTransferRank(), true);
+    transferOp.setInBoundsAttr(
+        OpBuilder(transferOp).getBoolArrayAttr(inBounds));
+  };
+  moduleOp->walk([&](vector::TransferReadOp readOp) { setInBounds(readOp); });
+  moduleOp->walk(
+      [&](vector::TransferWriteOp writeOp) { setInBounds(writeOp); });
+
+  // into the vector loads and stores which are lowered to LLVM
+  RewritePatternSet patterns(moduleOp.getContext());
+  vector::populateVectorTransferLoweringPatterns(patterns,
+                                                 /*maxTransferRank=*/1);
+  (void)applyPatternsAndFoldGreedily(moduleOp, std::move(patterns));
+}
+} // anonymous namespace
 
 void conversion::MockQUIRToStdPass::getDependentDialects(
     DialectRegistry &registry) const {
   registry.insert<LLVM::LLVMDialect, mlir::memref::MemRefDialect,
-                  mlir::affine::AffineDialect, arith::ArithDialect>();
+                  mlir::affine::AffineDialect, arith::ArithDialect,
+                  vector::VectorDialect>();
 }
 
-void MockQUIRToStdPass::runOnOperation(MockSystem &system) {
-  ModuleOp moduleOp = getOperation();
+LogicalResult MockQUIRToStdPass::initialize(MLIRContext *context) {
+  typeConverter = std::make_shared<QuirTypeConverter>();
+  target = std::make_shared<ConversionTarget>(*context);
 
-  // First remove all arguments from synchronization ops
-  moduleOp->walk([](qcs::SynchronizeOp synchOp) {
-    synchOp.getQubitsMutable().assign(ValueRange({}));
-  });
-
-  QuirTypeConverter typeConverter;
-  auto *context = &getContext();
-  ConversionTarget target(*context);
-
-  target.addLegalDialect<arith::ArithDialect, LLVM::LLVMDialect,
-                         mlir::affine::AffineDialect, memref::MemRefDialect,
-                         scf::SCFDialect, mlir::func::FuncDialect,
-                         mlir::pulse::PulseDialect>();
+  target->addLegalDialect<arith::ArithDialect, LLVM::LLVMDialect,
+                          mlir::affine::AffineDialect, memref::MemRefDialect,
+                          scf::SCFDialect, mlir::func::FuncDialect,
+                          mlir::pulse::PulseDialect>();
   // Since we are converting QUIR -> STD/LLVM, make QUIR illegal.
   // Further, because OQ3 and QCS ops are migrated from QUIR, make them also
   // illegal.
-  target
-      .addIllegalDialect<quir::QUIRDialect, qcs::QCSDialect, oq3::OQ3Dialect>();
-  target.addIllegalOp<qcs::RecvOp, qcs::BroadcastOp>();
-  target.addDynamicallyLegalOp<mlir::func::FuncOp>([&](mlir::func::FuncOp op) {
-    return typeConverter.isSignatureLegal(op.getFunctionType());
-  });
-  target.addDynamicallyLegalOp<func::CallOp>([&](func::CallOp op) {
-    return typeConverter.isSignatureLegal(op.getCalleeType());
+  target->addIllegalDialect<quir::QUIRDialect, qcs::QCSDialect,
+                            oq3::OQ3Dialect>();
+  target->addIllegalOp<qcs::RecvOp, qcs::BroadcastOp, qcs::SendOp>();
+  // The legality callbacks outlive this call along with the target.
+  auto *converter = typeConverter.get();
+  target->addDynamicallyLegalOp<mlir::func::FuncOp>(
+      [converter](mlir::func::FuncOp op) {
+        return converter->isSignatureLegal(op.getFunctionType());
+      });
+  target->addDynamicallyLegalOp<func::CallOp>([converter](func::CallOp op) {
+    return converter->isSignatureLegal(op.getCalleeType());
   });
-  target.addDynamicallyLegalOp<mlir::func::ReturnOp>(
-      [&](mlir::func::ReturnOp op) {
-        return typeConverter.isLegal(op.getOperandTypes());
+  target->addDynamicallyLegalOp<mlir::func::ReturnOp>(
+      [converter](mlir::func::ReturnOp op) {
+        return converter->isLegal(op.getOperandTypes());
       });
   // We mark `ConstantOp` legal so we don't err when attempting to convert a
   // constant `DurationType`. (Only `AngleType` is currently handled by the
@@ -235,33 +611,46 @@ void MockQUIRToStdPass::runOnOperation(MockSystem &system) {
   // explicitly marked illegal
   // ```
   // which for the `mock_target` are harmless.
-  target.addLegalOp<quir::ConstantOp>();
-  target.addLegalOp<quir::SwitchOp>();
-  target.addLegalOp<quir::YieldOp>();
+  target->addLegalOp<quir::ConstantOp>();
+  target->addLegalOp<quir::SwitchOp>();
+  target->addLegalOp<quir::YieldOp>();
 
   RewritePatternSet patterns(context);
   populateFunctionOpInterfaceTypeConversionPattern<mlir::func::FuncOp>(
-      patterns, typeConverter);
-  populateCallOpTypeConversionPattern(patterns, typeConverter);
+      patterns, *typeConverter);
+  populateCallOpTypeConversionPattern(patterns, *typeConverter);
   // clang-format off
   patterns.add<ConstantOpConversionPat,
                ReturnConversionPat,
                CommOpConversionPat<qcs::RecvOp>,
                CommOpConversionPat<qcs::BroadcastOp>,
+               CommOpConversionPat<qcs::SendOp>,
                AngleBinOpConversionPat<oq3::AngleAddOp, mlir::arith::AddIOp>,
                AngleBinOpConversionPat<oq3::AngleSubOp, mlir::arith::SubIOp>,
                AngleBinOpConversionPat<oq3::AngleMulOp, mlir::arith::MulIOp>,
                AngleBinOpConversionPat<oq3::AngleDivOp, mlir::arith::DivSIOp>>(
-      context, typeConverter);
+      context, *typeConverter);
   // clang-format on
 
   quir::populateVariableToGlobalMemRefConversionPatterns(
-      patterns, typeConverter, externalizeOutputVariables);
+      patterns, *typeConverter, externalizeOutputVariables);
+
+  frozenPatterns = FrozenRewritePatternSet(std::move(patterns));
+  return success();
+} // QUIRToStdPass::initialize()
+
+void MockQUIRToStdPass::runOnOperation(MockSystem &system) {
+  ModuleOp moduleOp = getOperation();
+
+  // First remove all arguments from synchronization ops
+  moduleOp->walk([](qcs::SynchronizeOp synchOp) {
+    synchOp.getQubitsMutable().assign(ValueRange({}));
+  });
 
   // With the target and rewrite patterns defined, we can now attempt the
   // conversion. The conversion will signal failure if any of our `illegal`
   // operations were not converted successfully.
-  if (failed(applyPartialConversion(moduleOp, target, std::move(patterns)))) {
+  if (failed(applyPartialConversion(moduleOp, *target, frozenPatterns))) {
     // If we fail conversion remove remaining ops for the Mock target.
     moduleOp.walk([&](Operation *op) {
       if (llvm::isa<oq3::OQ3Dialect>(op->getDialect()) ||
@@ -274,6 +663,11 @@ void MockQUIRToStdPass::runOnOperation(MockSystem &system) {
       }
     });
   }
+
+  if (vectorizeLoops)
+    vectorizeArrayLoops(moduleOp);
+  if (vectorizeAngles)
+    vectorizeAngleArithmetic(moduleOp);
 } // QUIRToStdPass::runOnOperation()
 
 llvm::StringRef MockQUIRToStdPass::getArgument() const {
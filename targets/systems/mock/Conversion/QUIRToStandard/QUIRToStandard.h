@@ -23,27 +23,65 @@
 
 #include "MockTarget.h"
 
+#include "Conversion/QUIRToStandard/TypeConversion.h"
 #include "HAL/TargetOperationPass.h"
 
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/DialectConversion.h"
+
+#include <memory>
 
 namespace qssc::targets::systems::mock::conversion {
 struct MockQUIRToStdPass
     : public mlir::PassWrapper<
           MockQUIRToStdPass,
           hal::TargetOperationPass<MockSystem, mlir::ModuleOp>> {
+  mlir::LogicalResult initialize(mlir::MLIRContext *context) override;
   void runOnOperation(MockSystem &system) override;
   void getDependentDialects(mlir::DialectRegistry &registry) const override;
 
   bool externalizeOutputVariables;
 
-  MockQUIRToStdPass(bool externalizeOutputVariables)
-      : PassWrapper(), externalizeOutputVariables(externalizeOutputVariables) {}
+  MockQUIRToStdPass(bool externalizeOutputVariables,
+                    bool vectorize = false, bool vectorizeArrays = false)
+      : PassWrapper(), externalizeOutputVariables(externalizeOutputVariables) {
+    vectorizeAngles = vectorize;
+    vectorizeLoops = vectorizeArrays;
+  }
+  MockQUIRToStdPass(const MockQUIRToStdPass &pass)
+      : PassWrapper(pass),
+        externalizeOutputVariables(pass.externalizeOutputVariables),
+        typeConverter(pass.typeConverter), target(pass.target),
+        frozenPatterns(pass.frozenPatterns) {}
+
+  Option<bool> vectorizeAngles{
+      *this, "vectorize-angles",
+      llvm::cl::desc("Compute the independent angle operations of a block, "
+                     "which are of the same kind and width, by vector "
+                     "operations"),
+      llvm::cl::init(false)};
+  Option<bool> vectorizeLoops{
+      *this, "vectorize-loops",
+      llvm::cl::desc("Raise the loops over the elements of memrefs, whose "
+                     "iterations are independent, to affine loops and compute "
+                     "their iterations by vector operations"),
+      llvm::cl::init(false)};
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
   llvm::StringRef getName() const override;
+
+private:
+  // Built once by initialize and shared by the copies of the pass converting
+  // the modules of the instruments concurrently, so that each run only
+  // converts. The patterns refer to the type converter.
+  std::shared_ptr<mlir::QuirTypeConverter> typeConverter;
+  std::shared_ptr<mlir::ConversionTarget> target;
+  mlir::FrozenRewritePatternSet frozenPatterns;
 };
 } // namespace qssc::targets::systems::mock::conversion
 
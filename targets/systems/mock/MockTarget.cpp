@@ -16,21 +16,30 @@
 
 #include "MockTarget.h"
 
+#include "ControllerBenchmark.h"
+
+#include "Config/QSSConfig.h"
 #include "Conversion/QUIRToLLVM/QUIRToLLVM.h"
 #include "Conversion/QUIRToStandard/QUIRToStandard.h"
 #include "Dialect/QUIR/Transforms/BreakReset.h"
 #include "Dialect/QUIR/Transforms/FunctionArgumentSpecialization.h"
 #include "Dialect/QUIR/Transforms/Passes.h"
 #include "Dialect/QUIR/Transforms/RemoveQubitOperands.h"
+#include "Dialect/QUIR/Transforms/RemoveUnusedQubits.h"
 #include "Dialect/QUIR/Transforms/SubroutineCloning.h"
+#include "Dialect/QUIR/Utils/Utils.h"
 #include "HAL/SystemConfiguration.h"
 #include "HAL/TargetSystem.h"
 #include "HAL/TargetSystemRegistry.h"
 #include "Payload/Payload.h"
+#include "Transforms/CommunicationMinimization.h"
+#include "Transforms/ControllerConversion.h"
 #include "Transforms/QubitLocalization.h"
+#include "Transforms/RackPartitioning.h"
 
-#include "mlir/Dialect/LLVMIR/Transforms/LegalizeForExport.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/ExecutionEngine/OptUtils.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
@@ -39,9 +48,17 @@
 #include "mlir/Target/LLVMIR/Export.h"
 #include "mlir/Transforms/Passes.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -49,21 +66,26 @@
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
-#include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/SubtargetFeature.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <fstream>
-#include <ios>
-#include <iterator>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <string>
 #include <sys/types.h>
 #include <utility>
@@ -82,6 +104,187 @@ llvm::cl::OptionCategory
     mockCat(" QSS Compiler Options for the Mock target",
             "Options that control Mock-specific behavior of the Mock QSS "
             "Compiler target");
+
+llvm::cl::opt<unsigned> controllerOptLevel(
+    "mock-controller-opt-level",
+    llvm::cl::desc("Optimization level (0-3) of the LLVM IR and of the code "
+                   "generation of the Mock controller"),
+    llvm::cl::init(0), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<unsigned> controllerCodegenThreads(
+    "mock-controller-codegen-threads",
+    llvm::cl::desc("Split the Mock controller module into this many "
+                   "partitions, which are compiled in parallel into an "
+                   "object file each"),
+    llvm::cl::init(1), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<std::string> controllerObjectCacheDir(
+    "mock-controller-object-cache-dir",
+    llvm::cl::desc("Cache the Mock controller object files in this "
+                   "directory, keyed by their LLVM IR and code generation "
+                   "options"),
+    llvm::cl::value_desc("path"), llvm::cl::init(""), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<bool> controllerVectorizeAngles(
+    "mock-controller-vectorize-angles",
+    llvm::cl::desc("Compute the independent angle operations of the Mock "
+                   "controller by vector operations, for controllers with "
+                   "SIMD units"),
+    llvm::cl::init(false), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<bool> controllerVectorizeLoops(
+    "mock-controller-vectorize-loops",
+    llvm::cl::desc("Compute the independent iterations of the loops of the "
+                   "Mock controller over its registers by vector "
+                   "operations, for controllers with SIMD units"),
+    llvm::cl::init(false), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<unsigned> controllerBenchmarkRuns(
+    "mock-controller-benchmark-runs",
+    llvm::cl::desc("JIT compile the Mock controller module with stubbed "
+                   "runtime hooks and run its main function this many times, "
+                   "reporting the execution time per shot and the "
+                   "instruction counts as controller.benchmark.json"),
+    llvm::cl::init(0), llvm::cl::cat(mockCat));
+
+llvm::cl::opt<bool> removeIdleQubits(
+    "mock-remove-idle-qubits",
+    llvm::cl::desc("Remove the resets, delays and barriers of the qubits "
+                   "which no other operation uses before qubit localization, "
+                   "so that the instruments of these qubits are not compiled"),
+    llvm::cl::init(false), llvm::cl::cat(mockCat));
+
+/// Initialize the native LLVM target once per process.
+void initializeNativeTarget() {
+  static std::once_flag initialized;
+  std::call_once(initialized, []() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmParser();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeAllTargetMCs();
+  });
+}
+
+/// Get the TargetMachine for the given triple, CPU and features. It is
+/// created on first use and then reused by all the compilations on the
+/// calling thread, since a TargetMachine must not be shared across threads.
+llvm::Expected<llvm::TargetMachine *>
+getTargetMachine(const std::string &targetTriple, llvm::StringRef cpu,
+                 llvm::StringRef features, llvm::CodeGenOpt::Level optLevel) {
+  thread_local llvm::StringMap<std::unique_ptr<llvm::TargetMachine>>
+      targetMachines;
+
+  std::string const key = (llvm::Twine(targetTriple) + "\n" + cpu + "\n" +
+                           features + "\n" + llvm::Twine(optLevel))
+                              .str();
+  auto &machine = targetMachines[key];
+  if (machine)
+    return machine.get();
+
+  initializeNativeTarget();
+  std::string errorMessage;
+  const auto *target =
+      llvm::TargetRegistry::lookupTarget(targetTriple, errorMessage);
+  if (!target) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to find target: " + errorMessage);
+  }
+
+  machine.reset(target->createTargetMachine(targetTriple, cpu, features, {},
+                                            {}, {}, optLevel));
+  if (!machine) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Unable to create target machine for " +
+                                       targetTriple);
+  }
+  return machine.get();
+}
+
+/// Generate the machine code of llvmModule into one object file per element
+/// of objects. The module is split into as many partitions, which are
+/// compiled in parallel with a TargetMachine of their own.
+llvm::Error emitObjectFiles(llvm::Module &llvmModule,
+                            llvm::TargetMachine &machine,
+                            llvm::MutableArrayRef<llvm::SmallVector<char, 0>>
+                                objects) {
+  llvm::SmallVector<std::unique_ptr<llvm::raw_svector_ostream>> objStreams;
+  llvm::SmallVector<llvm::raw_pwrite_stream *> objStreamPtrs;
+  for (auto &object : objects)
+    objStreamPtrs.push_back(
+        objStreams.emplace_back(
+            std::make_unique<llvm::raw_svector_ostream>(object))
+            .get());
+
+  if (objects.size() > 1) {
+    llvm::splitCodeGen(
+        llvmModule, objStreamPtrs, {},
+        [&]() {
+          return std::unique_ptr<llvm::TargetMachine>(
+              machine.getTarget().createTargetMachine(
+                  machine.getTargetTriple().str(), machine.getTargetCPU(),
+                  machine.getTargetFeatureString(), machine.Options,
+                  machine.getRelocationModel(), machine.getCodeModel(),
+                  machine.getOptLevel()));
+        },
+        llvm::CodeGenFileType::CGFT_ObjectFile);
+    return llvm::Error::success();
+  }
+
+  llvm::legacy::PassManager pass;
+  if (machine.addPassesToEmitFile(pass, *objStreamPtrs.front(), nullptr,
+                                  llvm::CodeGenFileType::CGFT_ObjectFile)) {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "Cannot emit object files with TargetMachine");
+  }
+  pass.run(llvmModule);
+  return llvm::Error::success();
+}
+
+/// Get the path of an object file of the cache entry key.
+std::string getCachedObjectPath(llvm::StringRef cacheDir, llvm::StringRef key,
+                                size_t index) {
+  llvm::SmallString<128> path(cacheDir);
+  llvm::sys::path::append(path, key + "-" + llvm::Twine(index) + ".o");
+  return std::string(path);
+}
+
+/// Read the object files of the cache entry key into objects, returning
+/// whether all of them are cached.
+bool lookupCachedObjects(
+    llvm::StringRef cacheDir, llvm::StringRef key,
+    llvm::MutableArrayRef<llvm::SmallVector<char, 0>> objects) {
+  for (auto [index, object] : llvm::enumerate(objects)) {
+    auto buffer = llvm::MemoryBuffer::getFile(
+        getCachedObjectPath(cacheDir, key, index), /*IsText=*/false,
+        /*RequiresNullTerminator=*/false);
+    if (!buffer)
+      return false;
+    object.assign((*buffer)->getBufferStart(), (*buffer)->getBufferEnd());
+  }
+  return true;
+}
+
+/// Store the object files of the cache entry key.
+llvm::Error
+storeCachedObjects(llvm::StringRef cacheDir, llvm::StringRef key,
+                   llvm::ArrayRef<llvm::SmallVector<char, 0>> objects) {
+  if (auto ec = llvm::sys::fs::create_directories(cacheDir))
+    return llvm::createStringError(ec, "Unable to create object cache " +
+                                           cacheDir);
+
+  // Written to a temporary file and renamed so that concurrent compilers
+  // never observe partial entries.
+  for (auto [index, object] : llvm::enumerate(objects))
+    if (auto err = llvm::writeToOutput(
+            getCachedObjectPath(cacheDir, key, index),
+            [&](llvm::raw_ostream &os) -> llvm::Error {
+              os.write(object.data(), object.size());
+              return llvm::Error::success();
+            }))
+      return err;
+  return llvm::Error::success();
+}
 } // anonymous namespace
 
 int qssc::targets::systems::mock::init() {
@@ -95,8 +298,10 @@ int qssc::targets::systems::mock::init() {
                   llvm::inconvertibleErrorCode(),
                   "Configuration file must be specified.\n");
 
-            auto config = std::make_unique<MockConfig>(*configurationPath);
-            return std::make_unique<MockSystem>(std::move(config));
+            auto config = MockConfig::get(*configurationPath);
+            if (!config)
+              return config.takeError();
+            return std::make_unique<MockSystem>(std::move(*config));
           });
   return registered ? 0 : -1;
 }
@@ -104,44 +309,16 @@ int qssc::targets::systems::mock::init() {
 const std::vector<std::string> MockSystem::childNames = {"MockChild1",
                                                          "MockChild2"};
 
-MockConfig::MockConfig(llvm::StringRef configurationPath)
-    : SystemConfiguration() {
-  std::ifstream configStream(configurationPath.str());
-  if (!configStream || !configStream.good()) {
-    llvm::errs() << "Problem opening file " + configurationPath;
-    return;
-  }
-
-  // This is a terrible parsing design just to make things work for now
-  std::string fieldName;
-  configStream >> fieldName;
-  if (fieldName == "num_qubits") {
-    configStream >> numQubits;
-  } else {
-    llvm::errs()
-        << "Problem parsing configStream, expecting num_qubits and found "
-        << fieldName << "\n";
-  }
-  configStream >> fieldName;
-  if (fieldName == "acquire_multiplexing_ratio_to_1") {
-    configStream >> multiplexing_ratio;
-  } else {
-    llvm::errs() << "Problem parsing configStream, expecting "
-                    "acquire_multiplexing_ratio_to_1 and found "
-                 << fieldName << "\n";
-  }
-  configStream >> fieldName;
-  if (fieldName == "controllerNodeId") {
-    configStream >> controllerNodeId;
-  } else {
-    llvm::errs()
-        << "Problem parsing configStream, expecting controllerNodeId and found "
-        << fieldName << "\n";
-  }
-
-  llvm::outs() << "Config:\nnum_qubits " << numQubits << "\nmultiplexing_ratio "
-               << multiplexing_ratio << "\n";
+MockConfig::MockConfig(uint numQubits, uint multiplexingRatio,
+                       uint controllerNodeId, uint instrumentsPerRack)
+    : SystemConfiguration(), controllerNodeId(controllerNodeId),
+      multiplexing_ratio(multiplexingRatio),
+      instrumentsPerRack(instrumentsPerRack) {
+  this->numQubits = numQubits;
+  mapNodes();
+} // MockConfig
 
+void MockConfig::mapNodes() {
   // preprocessing of config data for use by passes
   qubitDriveMap.resize(numQubits);
   qubitAcquireMap.resize(numQubits);
@@ -156,34 +333,237 @@ MockConfig::MockConfig(llvm::StringRef configurationPath)
     qubitAcquireMap[physId] = acquireId;
     qubitDriveMap[physId] = nextId++;
   }
-} // MockConfig
+} // mapNodes
+
+llvm::Expected<std::shared_ptr<const MockConfig>>
+MockConfig::get(llvm::StringRef configurationPath) {
+  return SystemConfigurationCache<MockConfig>::instance().getOrLoad(
+      configurationPath, MockConfig::load);
+} // get
+
+llvm::Expected<std::unique_ptr<MockConfig>>
+MockConfig::load(llvm::StringRef configurationPath) {
+  auto buffer = llvm::MemoryBuffer::getFile(configurationPath);
+  if (!buffer)
+    return llvm::createStringError(buffer.getError(),
+                                   "Problem opening file %s",
+                                   configurationPath.str().c_str());
+
+  auto config = parse((*buffer)->getBuffer());
+  if (!config)
+    return config.takeError();
+
+  llvm::outs() << "Config:\nnum_qubits " << (*config)->getNumQubits()
+               << "\nmultiplexing_ratio " << (*config)->getMultiplexingRatio()
+               << "\n";
+  return config;
+} // load
 
-MockSystem::MockSystem(std::unique_ptr<MockConfig> config)
-    : TargetSystem("MockSystem", nullptr), mockConfig(std::move(config)) {
-  // Create controller target
-  addChild(
-      std::make_unique<MockController>("MockController", this, *mockConfig));
-
-  // Create drive targets
-  for (const auto &result : llvm::enumerate(mockConfig->getDriveNodes())) {
-    uint32_t const qubitIdx = result.index();
-    uint32_t const nodeId = result.value();
-    addChild(std::make_unique<MockDrive>(
-        "MockDrive_" + std::to_string(qubitIdx), this, *mockConfig, nodeId));
+namespace {
+llvm::Error configurationError(llvm::StringRef message) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(), "%s",
+                                 message.str().c_str());
+}
+
+/// The number of the fields every configuration has, the following fields are
+/// optional and zero when absent.
+constexpr size_t numRequiredFields = 3;
+
+/// The legacy text format, i.e., the fields in order, each name followed by
+/// its value, the optional fields possibly omitted.
+llvm::Error parseTextFields(llvm::StringRef contents,
+                            llvm::MutableArrayRef<uint> values,
+                            llvm::ArrayRef<llvm::StringRef> fieldNames) {
+  llvm::SmallVector<llvm::StringRef> tokens;
+  llvm::SplitString(contents, tokens);
+  for (const auto &[index, fieldName] : llvm::enumerate(fieldNames)) {
+    if (index >= numRequiredFields && tokens.size() <= 2 * index)
+      break;
+    if (tokens.size() <= 2 * index || tokens[2 * index] != fieldName)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Problem parsing configuration, expecting %s and found %s",
+          fieldName.str().c_str(),
+          tokens.size() <= 2 * index ? "end of file"
+                                     : tokens[2 * index].str().c_str());
+    if (tokens.size() <= 2 * index + 1 ||
+        tokens[2 * index + 1].getAsInteger(10, values[index]))
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Problem parsing configuration, expecting a value for %s",
+          fieldName.str().c_str());
   }
+  return llvm::Error::success();
+}
+
+llvm::Error parseJSONFields(llvm::StringRef contents,
+                            llvm::MutableArrayRef<uint> values,
+                            llvm::ArrayRef<llvm::StringRef> fieldNames) {
+  auto object =
+      parseJSONConfiguration(contents, MockConfig::schemaVersion);
+  if (!object)
+    return object.takeError();
+  for (const auto &[index, fieldName] : llvm::enumerate(fieldNames)) {
+    if (index >= numRequiredFields && !object->get(fieldName))
+      continue;
+    auto value = object->getInteger(fieldName);
+    if (!value || *value < 0 || *value > UINT32_MAX)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "Problem parsing configuration, expecting an unsigned %s",
+          fieldName.str().c_str());
+    values[index] = *value;
+  }
+  return llvm::Error::success();
+}
 
-  // Create acquire targets
-  for (const auto &result : llvm::enumerate(mockConfig->getAcquireNodes())) {
-    uint32_t const acquireIdx = result.index();
-    uint32_t const nodeId = result.value();
-    addChild(std::make_unique<MockAcquire>("MockAcquire_" +
-                                               std::to_string(acquireIdx),
-                                           this, *mockConfig, nodeId));
+llvm::Error parseBinaryFields(llvm::StringRef contents,
+                              llvm::MutableArrayRef<uint> values) {
+  if (auto err = consumeBinaryConfigurationHeader(
+          contents, MockConfig::schemaVersion))
+    return err;
+  for (size_t index = 0; index < values.size(); ++index) {
+    if (index >= numRequiredFields && contents.empty())
+      break;
+    auto field = consumeBinaryUInt32(contents);
+    if (!field)
+      return field.takeError();
+    values[index] = *field;
   }
+  return llvm::Error::success();
+}
+
+const llvm::StringRef mockConfigFieldNames[] = {
+    "num_qubits", "acquire_multiplexing_ratio_to_1", "controllerNodeId",
+    "instruments_per_rack"};
+} // anonymous namespace
+
+llvm::Expected<std::unique_ptr<MockConfig>>
+MockConfig::parse(llvm::StringRef contents) {
+  // num_qubits, acquire_multiplexing_ratio_to_1, controllerNodeId and the
+  // optional instruments_per_rack
+  uint values[4] = {0, 0, 0, 0};
+  auto parseFields = [&]() -> llvm::Error {
+    switch (detectConfigurationFormat(contents)) {
+    case ConfigurationFormat::Text:
+      return parseTextFields(contents, values, mockConfigFieldNames);
+    case ConfigurationFormat::JSON:
+      return parseJSONFields(contents, values, mockConfigFieldNames);
+    case ConfigurationFormat::Binary:
+      return parseBinaryFields(contents, values);
+    }
+    llvm_unreachable("unknown configuration format");
+  };
+  if (auto err = parseFields())
+    return std::move(err);
+  if (values[1] == 0)
+    return configurationError(
+        "acquire_multiplexing_ratio_to_1 must be at least 1");
+  return std::make_unique<MockConfig>(values[0], values[1], values[2],
+                                      values[3]);
+} // parse
+
+void MockConfig::writeJSON(llvm::raw_ostream &os) const {
+  llvm::json::Object object{{"schemaVersion", schemaVersion},
+                            {mockConfigFieldNames[0], getNumQubits()},
+                            {mockConfigFieldNames[1], getMultiplexingRatio()},
+                            {mockConfigFieldNames[2], controllerNode()}};
+  if (getInstrumentsPerRack())
+    object[mockConfigFieldNames[3]] = getInstrumentsPerRack();
+  os << llvm::formatv("{0:2}\n", llvm::json::Value(std::move(object)));
+} // writeJSON
+
+void MockConfig::writeBinary(llvm::raw_ostream &os) const {
+  writeBinaryConfigurationHeader(os, schemaVersion);
+  writeBinaryUInt32(os, getNumQubits());
+  writeBinaryUInt32(os, getMultiplexingRatio());
+  writeBinaryUInt32(os, controllerNode());
+  if (getInstrumentsPerRack())
+    writeBinaryUInt32(os, getInstrumentsPerRack());
+} // writeBinary
+
+MockSystem::MockSystem(std::shared_ptr<const MockConfig> config)
+    : TargetSystem("MockSystem", nullptr), mockConfig(std::move(config)) {
 } // MockSystem
 
+namespace {
+/// Add the drive or acquire target of a node module to parent. Returns false
+/// if the node is neither.
+bool addInstrument(TargetSystem &parent, const MockConfig &config,
+                   llvm::StringRef nodeType, uint nodeId) {
+  if (nodeType == "drive") {
+    // Drive targets are named after their qubit
+    const auto &driveNodes = config.getDriveNodes();
+    auto qubitIdx = std::find(driveNodes.begin(), driveNodes.end(), nodeId) -
+                    driveNodes.begin();
+    parent.addChild(std::make_unique<MockDrive>(
+        "MockDrive_" + std::to_string(qubitIdx), &parent, config, nodeId));
+    return true;
+  }
+  if (nodeType == "acquire") {
+    // Acquire targets are named after their multiplexing group
+    auto acquireNodes = config.getAcquireNodes();
+    auto acquireIdx =
+        std::find(acquireNodes.begin(), acquireNodes.end(), nodeId) -
+        acquireNodes.begin();
+    parent.addChild(std::make_unique<MockAcquire>(
+        "MockAcquire_" + std::to_string(acquireIdx), &parent, config, nodeId));
+    return true;
+  }
+  return false;
+}
+
+/// Call addNode with the type and id of each node module of moduleOp which
+/// is not in instantiatedNodes yet.
+llvm::Error forEachNewNodeModule(
+    mlir::ModuleOp moduleOp,
+    std::set<std::pair<std::string, uint>> &instantiatedNodes,
+    llvm::function_ref<llvm::Error(llvm::StringRef, uint)> addNode) {
+  for (auto nodeModuleOp : moduleOp.getBody()->getOps<mlir::ModuleOp>()) {
+    auto nodeType = nodeModuleOp->getAttrOfType<StringAttr>("quir.nodeType");
+    if (!nodeType)
+      continue;
+    auto nodeId = getNodeId(nodeModuleOp);
+    if (auto err = nodeId.takeError())
+      return err;
+    if (!instantiatedNodes.emplace(nodeType.getValue().str(), *nodeId).second)
+      continue;
+    if (auto err = addNode(nodeType.getValue(), *nodeId))
+      return err;
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error unknownNodeType(llvm::StringRef nodeType) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Unknown mock node type %s",
+                                 nodeType.str().c_str());
+}
+} // anonymous namespace
+
+llvm::Error MockSystem::instantiateChildren(mlir::ModuleOp moduleOp) {
+  const std::lock_guard<std::mutex> lock(instantiateMutex);
+  return forEachNewNodeModule(
+      moduleOp, instantiatedNodes,
+      [&](llvm::StringRef nodeType, uint nodeId) -> llvm::Error {
+        if (nodeType == "controller")
+          addChild(std::make_unique<MockController>("MockController", this,
+                                                    *mockConfig));
+        else if (nodeType == "rack")
+          addChild(std::make_unique<MockRack>(
+              "MockRack_" + std::to_string(nodeId), this, *mockConfig,
+              nodeId));
+        else if (!addInstrument(*this, *mockConfig, nodeType, nodeId))
+          return unknownNodeType(nodeType);
+        return llvm::Error::success();
+      });
+} // MockSystem::instantiateChildren
+
 llvm::Error MockSystem::registerTargetPasses() {
   mlir::PassRegistration<MockQubitLocalizationPass>();
+  mlir::PassRegistration<MockCommunicationMinimizationPass>();
+  mlir::PassRegistration<MockRackPartitioningPass>();
+  mlir::PassRegistration<MockControllerConversionPass>();
   mlir::PassRegistration<conversion::MockQUIRToStdPass>(
       []() -> std::unique_ptr<conversion::MockQUIRToStdPass> {
         return std::make_unique<conversion::MockQUIRToStdPass>(false);
@@ -200,7 +580,11 @@ void mockPipelineBuilder(mlir::OpPassManager &pm) {
   pm.addPass(std::make_unique<mlir::quir::SubroutineCloningPass>());
   pm.addPass(std::make_unique<mlir::quir::RemoveQubitOperandsPass>());
   pm.addPass(std::make_unique<mlir::quir::ClassicalOnlyDetectionPass>());
+  // the modules of the instruments of unused qubits are not created
+  pm.addPass(
+      std::make_unique<mlir::quir::RemoveUnusedQubitsPass>(removeIdleQubits));
   pm.addPass(std::make_unique<MockQubitLocalizationPass>());
+  pm.addPass(std::make_unique<MockCommunicationMinimizationPass>());
   OpPassManager &nestedModulePM = pm.nest<ModuleOp>();
   nestedModulePM.addPass(
       std::make_unique<mlir::quir::FunctionArgumentSpecializationPass>());
@@ -221,6 +605,13 @@ llvm::Error MockSystem::addPasses(mlir::PassManager &pm) {
   pm.addPass(mlir::createCanonicalizerPass());
   pm.addPass(std::make_unique<BreakResetPass>());
   mockPipelineBuilder(pm);
+  // The adaptor coalesces with the one of mockPipelineBuilder, converting the
+  // controller module while the functions of the other node modules are
+  // specialized in parallel.
+  pm.nest<ModuleOp>().addPass(std::make_unique<MockControllerConversionPass>(
+      controllerVectorizeAngles, controllerVectorizeLoops));
+  // last, as the node modules nest in the rack modules after it
+  pm.addPass(std::make_unique<MockRackPartitioningPass>());
 
   return llvm::Error::success();
 } // MockSystem::addPasses
@@ -230,6 +621,73 @@ llvm::Error MockSystem::emitToPayload(mlir::ModuleOp moduleOp,
   return llvm::Error::success();
 } // MockSystem::emitToPayload
 
+MockRack::MockRack(std::string name, MockSystem *parent,
+                   const MockConfig &config, uint32_t rackId)
+    : TargetSystem(std::move(name), parent), config(config), rackId(rackId) {
+} // MockRack
+
+llvm::Expected<mlir::ModuleOp>
+MockRack::getModule(mlir::ModuleOp parentModuleOp) {
+  for (auto rackModuleOp :
+       parentModuleOp.getBody()->getOps<mlir::ModuleOp>()) {
+    auto nodeType = rackModuleOp->getAttrOfType<StringAttr>("quir.nodeType");
+    if (!nodeType || nodeType.getValue() != "rack")
+      continue;
+    auto nodeId = getNodeId(rackModuleOp);
+    if (auto err = nodeId.takeError())
+      return std::move(err);
+    if (*nodeId == rackId)
+      return rackModuleOp;
+  }
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Could not find the module of rack %u",
+                                 rackId);
+} // MockRack::getModule
+
+llvm::Error MockRack::addPasses(mlir::PassManager &pm) {
+  // The instruments of the rack are compiled by their own passes.
+  return llvm::Error::success();
+} // MockRack::addPasses
+
+llvm::Error MockRack::emitToPayload(mlir::ModuleOp moduleOp,
+                                    qssc::payload::Payload &payload) {
+  return llvm::Error::success();
+} // MockRack::emitToPayload
+
+llvm::Error
+MockRack::emitToPayloadPostChildren(mlir::ModuleOp moduleOp,
+                                    qssc::payload::Payload &payload) {
+  // The manifest of the instruments of this compilation, which the rack
+  // loads the payloads of its instruments by.
+  llvm::json::Array instruments;
+  for (auto nodeModuleOp : moduleOp.getBody()->getOps<mlir::ModuleOp>()) {
+    auto nodeType = nodeModuleOp->getAttrOfType<StringAttr>("quir.nodeType");
+    auto nodeId = getNodeId(nodeModuleOp);
+    if (auto err = nodeId.takeError())
+      return err;
+    instruments.push_back(llvm::json::Object{
+        {"name", nodeModuleOp.getSymName().value_or("")},
+        {"nodeType", nodeType ? nodeType.getValue() : ""},
+        {"nodeId", *nodeId}});
+  }
+  llvm::json::Object manifest{{"rack", rackId},
+                              {"instruments", std::move(instruments)}};
+  payload.getFileStream(name + ".json")
+      << llvm::formatv("{0:2}\n", llvm::json::Value(std::move(manifest)));
+  return llvm::Error::success();
+} // MockRack::emitToPayloadPostChildren
+
+llvm::Error MockRack::instantiateChildren(mlir::ModuleOp moduleOp) {
+  const std::lock_guard<std::mutex> lock(instantiateMutex);
+  return forEachNewNodeModule(
+      moduleOp, instantiatedNodes,
+      [&](llvm::StringRef nodeType, uint nodeId) -> llvm::Error {
+        if (!addInstrument(*this, config, nodeType, nodeId))
+          return unknownNodeType(nodeType);
+        return llvm::Error::success();
+      });
+} // MockRack::instantiateChildren
+
 MockController::MockController(std::string name, MockSystem *parent,
                                const SystemConfiguration &config)
     : TargetInstrument(std::move(name), parent) {} // MockController
@@ -241,19 +699,28 @@ void MockController::registerTargetPipelines() {
 } // MockController::registerTargetPipelines
 
 llvm::Error MockController::addPasses(mlir::PassManager &pm) {
-  pm.addPass(std::make_unique<conversion::MockQUIRToStdPass>(false));
-  pm.addPass(mlir::createCanonicalizerPass());
-  pm.addPass(mlir::LLVM::createLegalizeForExportPass());
-
+  // The controller module is converted by the pipeline of the system, see
+  // MockControllerConversionPass.
   return llvm::Error::success();
 } // MockController::addPasses
 
 llvm::Error MockController::emitToPayload(mlir::ModuleOp moduleOp,
                                           qssc::payload::Payload &payload) {
 
-  auto *mlirStr = payload.getFile(name + ".mlir");
-  llvm::raw_string_ostream mlirOStream(*mlirStr);
-  mlirOStream << moduleOp;
+  // the controller IR is a debug artifact, only the object file is executed
+  switch (payload.getDebugArtifacts()) {
+  case qssc::config::PayloadDebugArtifacts::Text:
+    payload.getFileStream(name + ".mlir") << moduleOp;
+    break;
+  case qssc::config::PayloadDebugArtifacts::Bytecode:
+    if (failed(mlir::writeBytecodeToFile(
+            moduleOp, payload.getFileStream(name + ".mlirbc"))))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Failed to write bytecode of " + name);
+    break;
+  case qssc::config::PayloadDebugArtifacts::None:
+    break;
+  }
 
   if (auto err = buildLLVMPayload(moduleOp, payload))
     return err;
@@ -266,41 +733,55 @@ llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
   auto timer = getTimer("build-llvm-payload");
 
   // Register LLVM dialect and all infrastructure required for translation to
-  // LLVM IR
+  // LLVM IR, which only takes effect once per MLIR context
   auto initLLVMTimer = timer.nest("init-llvm");
   auto *context = controllerModule.getContext();
   mlir::registerBuiltinDialectTranslation(*context);
   mlir::registerLLVMDialectTranslation(*context);
 
-  // Initialize native LLVM target
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmParser();
-  llvm::InitializeNativeTargetAsmPrinter();
-  llvm::InitializeAllTargetMCs();
+  if (controllerOptLevel > 3)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid Mock controller optimization "
+                                   "level, expecting 0 to 3");
+  if (controllerCodegenThreads == 0)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Invalid number of Mock controller codegen "
+                                   "threads, expecting at least 1");
 
   // Setup the machine properties for the target architecture.
   std::string const targetTriple = llvm::sys::getDefaultTargetTriple();
-  std::string errorMessage;
-  const auto *target =
-      llvm::TargetRegistry::lookupTarget(targetTriple, errorMessage);
-  if (!target) {
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Unable to find target: " + errorMessage);
-  }
-
   std::string const cpu("generic");
   llvm::SubtargetFeatures const features;
-  std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
-      targetTriple, cpu, features.getString(), {}, {}));
+  auto const codegenOptLevel =
+      static_cast<llvm::CodeGenOpt::Level>(controllerOptLevel.getValue());
+  auto machineOrErr = getTargetMachine(targetTriple, cpu,
+                                       features.getString(), codegenOptLevel);
+  if (!machineOrErr)
+    return machineOrErr.takeError();
+  auto *machine = *machineOrErr;
   auto dataLayout = machine->createDataLayout();
   initLLVMTimer.stop();
 
+  // the shot loop is no longer recognizable once lowered to the LLVM dialect
+  uint64_t const shotsPerRun =
+      controllerBenchmarkRuns ? getShotsPerRun(controllerModule) : 1;
+
   auto mlirToLLVMDialectTimer = timer.nest("translate-to-llvm-mlir-dialect");
   if (auto err =
           quir::translateModuleToLLVMDialect(controllerModule, dataLayout))
     return err;
   mlirToLLVMDialectTimer.stop();
 
+  if (controllerBenchmarkRuns) {
+    auto benchmarkTimer = timer.nest("benchmark-controller");
+    auto benchmark =
+        benchmarkController(controllerModule, shotsPerRun,
+                            controllerOptLevel, controllerBenchmarkRuns);
+    if (!benchmark)
+      return benchmark.takeError();
+    benchmark->writeJSON(payload.getFileStream("controller.benchmark.json"));
+  }
+
   auto mlirToLLVMIRTimer = timer.nest("mlir-to-llvm-ir");
   // Build LLVM payload
   llvm::LLVMContext llvmContext;
@@ -317,7 +798,9 @@ llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
   llvmModule->setTargetTriple(targetTriple);
 
   /// Optionally run an optimization pipeline over the llvm module.
-  auto optPipeline = mlir::makeOptimizingTransformer(0, 0, nullptr);
+  auto optPipeline =
+      mlir::makeOptimizingTransformer(controllerOptLevel.getValue(),
+                                      /*sizeLevel=*/0, machine);
   if (auto err = optPipeline(llvmModule.get())) {
     return llvm::joinErrors(
         llvm::createStringError(llvm::inconvertibleErrorCode(),
@@ -326,59 +809,90 @@ llvm::Error MockController::buildLLVMPayload(mlir::ModuleOp controllerModule,
   }
   llvmOptTimer.stop();
 
-  std::string *payloadStr = payload.getFile("llvmModule.ll");
-  llvm::raw_string_ostream llvmOStream(*payloadStr);
-  llvmOStream << *llvmModule;
-
-  auto emitObjectFileTimer = timer.nest("build-object-file");
-  // generate machine code and emit object file
-  llvm::SmallString<128> objPath;
-  int objFd;
-  if (auto err = llvm::sys::fs::createTemporaryFile("controllerModule", "o",
-                                                    objFd, objPath)) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Failed to create temporary object file for controller module");
+  // the object files are cached by the optimized LLVM IR, which is printed
+  // only once for both the key and the payload
+  auto const debugArtifacts = payload.getDebugArtifacts();
+  std::string cacheKey;
+  llvm::StringRef const cacheDir = controllerObjectCacheDir;
+  if (!cacheDir.empty()) {
+    auto cacheKeyTimer = timer.nest("object-cache-key");
+    std::string llvmIR;
+    llvm::raw_string_ostream llvmIRStream(llvmIR);
+    llvmIRStream << *llvmModule;
+    llvmIRStream.flush();
+
+    llvm::SHA256 hasher;
+    std::string const featureString = features.getString();
+    std::string const codegenOptions =
+        std::to_string(controllerOptLevel.getValue()) + "\n" +
+        std::to_string(controllerCodegenThreads.getValue());
+    for (llvm::StringRef const field :
+         {llvm::StringRef(llvmIR), llvm::StringRef(targetTriple),
+          llvm::StringRef(cpu), llvm::StringRef(featureString),
+          llvm::StringRef(codegenOptions)}) {
+      // length-prefixed so that the fields cannot run into each other
+      uint64_t const size = field.size();
+      hasher.update(llvm::ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(&size), sizeof(size)));
+      hasher.update(field);
+    }
+    cacheKey = llvm::toHex(hasher.final(), /*LowerCase=*/true);
+    if (debugArtifacts == qssc::config::PayloadDebugArtifacts::Text)
+      payload.getFileStream("llvmModule.ll") << llvmIR;
+  } else if (debugArtifacts == qssc::config::PayloadDebugArtifacts::Text) {
+    payload.getFileStream("llvmModule.ll") << *llvmModule;
+  }
+  if (debugArtifacts == qssc::config::PayloadDebugArtifacts::Bytecode)
+    llvm::WriteBitcodeToFile(*llvmModule,
+                             payload.getFileStream("llvmModule.bc"));
+
+  // generate machine code and emit the object files into memory
+  llvm::SmallVector<llvm::SmallVector<char, 0>> objects(
+      controllerCodegenThreads.getValue());
+  bool cached = false;
+  if (!cacheKey.empty()) {
+    auto cacheLookupTimer = timer.nest("object-cache-lookup");
+    cached = lookupCachedObjects(cacheDir, cacheKey, objects);
   }
-  auto obj = std::make_unique<llvm::ToolOutputFile>(objPath, objFd);
-  llvm::legacy::PassManager pass;
 
-  if (machine->addPassesToEmitFile(pass, obj->os(), nullptr,
-                                   llvm::CodeGenFileType::CGFT_ObjectFile)) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Cannot emit object files with TargetMachine");
+  if (!cached) {
+    auto emitObjectFileTimer =
+        timer.nest(objects.size() > 1 ? "build-object-files-parallel"
+                                      : "build-object-file");
+    if (auto err = emitObjectFiles(*llvmModule, *machine, objects))
+      return err;
+    emitObjectFileTimer.stop();
+
+    if (!cacheKey.empty()) {
+      auto cacheStoreTimer = timer.nest("object-cache-store");
+      if (auto err = storeCachedObjects(cacheDir, cacheKey, objects))
+        llvm::logAllUnhandledErrors(
+            std::move(err), llvm::errs(),
+            "Warning: unable to cache controller object files: ");
+    }
   }
-  pass.run(*llvmModule);
-  obj->os().flush();
-  emitObjectFileTimer.stop();
 
   auto emitBinaryTimer = timer.nest("emit-binary");
   // Note: an actual target will likely invoke a linker and pull in libraries to
   // generate a binary, and possibly do more postprocessing steps to create a
   // binary that can be executed on the controller
-  // include resulting file in payload
-  std::ifstream binary{objPath.c_str(), std::ios_base::binary};
-
-  if (!binary) {
-    return llvm::createStringError(
-        llvm::inconvertibleErrorCode(),
-        "Failed top open generated controller object file" + objPath);
+  // include resulting objects in payload, the partitions of a module split
+  // for parallel codegen after the first one as controller.<index>.bin. The
+  // objects are copied, as codegen needs a seekable stream, which a payload
+  // file, a std::string, cannot back
+  for (auto [index, object] : llvm::enumerate(objects)) {
+    std::string const fileName =
+        index ? "controller." + std::to_string(index) + ".bin"
+              : "controller.bin";
+    payload.getFile(fileName)->assign(object.begin(), object.end());
   }
-
-  /* read whole content of object file into buffer */
-  std::string binaryContents{
-      std::istreambuf_iterator<char>(binary),
-      /* eof representation */ std::istreambuf_iterator<char>()};
-
-  payload.getFile("controller.bin")->assign(std::move(binaryContents));
   emitBinaryTimer.stop();
 
   return llvm::Error::success();
 
 } // MockController::buildLLVMPayload
 
-MockAcquire::MockAcquire(std::string name, MockSystem *parent,
+MockAcquire::MockAcquire(std::string name, TargetSystem *parent,
                          const SystemConfiguration &config, uint32_t nodeId)
     : TargetInstrument(std::move(name), parent), nodeId_(nodeId) {
 } // MockAcquire
@@ -394,15 +908,12 @@ llvm::Error MockAcquire::addPasses(mlir::PassManager &pm) {
 
 llvm::Error MockAcquire::emitToPayload(mlir::ModuleOp moduleOp,
                                        qssc::payload::Payload &payload) {
-  std::string mlirStr;
-  llvm::raw_string_ostream mlirOStream(mlirStr);
-  mlirOStream << moduleOp;
-  payload.getFile(name + ".mlir")->assign(mlirOStream.str());
+  payload.getFileStream(name + ".mlir") << moduleOp;
 
   return llvm::Error::success();
 } // MockAcquire::emitToPayload
 
-MockDrive::MockDrive(std::string name, MockSystem *parent,
+MockDrive::MockDrive(std::string name, TargetSystem *parent,
                      const SystemConfiguration &config, uint32_t nodeId)
     : TargetInstrument(std::move(name), parent), nodeId_(nodeId) {} // MockDrive
 
@@ -418,10 +929,7 @@ llvm::Error MockDrive::addPasses(mlir::PassManager &pm) {
 llvm::Error MockDrive::emitToPayload(mlir::ModuleOp moduleOp,
                                      qssc::payload::Payload &payload) {
 
-  std::string mlirStr;
-  llvm::raw_string_ostream mlirOStream(mlirStr);
-  mlirOStream << moduleOp;
-  payload.getFile(name + ".mlir")->assign(mlirOStream.str());
+  payload.getFileStream(name + ".mlir") << moduleOp;
 
   return llvm::Error::success();
 } // MockDrive::emitToPayload
@@ -25,10 +25,17 @@
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
 #include <unordered_map>
+#include <utility>
 
 namespace qssc::targets::systems::mock {
 
@@ -37,29 +44,60 @@ int init();
 
 class MockConfig : public qssc::hal::SystemConfiguration {
 public:
-  explicit MockConfig(llvm::StringRef configurationPath);
+  /// The schema version of the JSON and binary forms of the configuration.
+  static constexpr uint32_t schemaVersion = 1;
+
+  MockConfig(uint numQubits, uint multiplexingRatio, uint controllerNodeId,
+             uint instrumentsPerRack = 0);
+
+  /// @brief Get the configuration at configurationPath from the cache of
+  /// the process, loading it if it is not cached or its file changed.
+  static llvm::Expected<std::shared_ptr<const MockConfig>>
+  get(llvm::StringRef configurationPath);
+
+  /// @brief Load a configuration in the text, JSON or binary format.
+  static llvm::Expected<std::unique_ptr<MockConfig>>
+  load(llvm::StringRef configurationPath);
+  static llvm::Expected<std::unique_ptr<MockConfig>>
+  parse(llvm::StringRef contents);
+
+  void writeJSON(llvm::raw_ostream &os) const;
+  void writeBinary(llvm::raw_ostream &os) const;
+
   uint getMultiplexingRatio() const { return multiplexing_ratio; }
   uint driveNode(uint qubitId) const { return qubitDriveMap[qubitId]; }
-  const std::vector<uint> &getDriveNodes() { return qubitDriveMap; }
+  const std::vector<uint> &getDriveNodes() const { return qubitDriveMap; }
   uint acquireNode(uint qubitId) const { return qubitAcquireMap[qubitId]; }
-  const std::vector<uint> getAcquireNodes() {
+  const std::vector<uint> getAcquireNodes() const {
     std::vector<uint> acquireNodes = qubitAcquireMap;
     acquireNodes.erase(std::unique(acquireNodes.begin(), acquireNodes.end()),
                        acquireNodes.end());
     return acquireNodes;
   }
-  const std::vector<int> &acquireQubits(uint nodeId) {
-    return qubitAcquireToPhysIdMap[nodeId];
+  const std::vector<int> &acquireQubits(uint nodeId) const {
+    static const std::vector<int> noQubits;
+    auto it = qubitAcquireToPhysIdMap.find(nodeId);
+    return it == qubitAcquireToPhysIdMap.end() ? noQubits : it->second;
   }
   uint controllerNode() const { return controllerNodeId; }
-  const std::vector<int> &multiplexedQubits(uint qubitId) {
+  /// @brief The number of drive and acquire nodes grouped in a rack, 0 if the
+  /// instruments are not grouped in racks but children of the system.
+  uint getInstrumentsPerRack() const { return instrumentsPerRack; }
+  /// @brief The rack of a drive or acquire node, i.e., the racks group the
+  /// nodes in the order of their ids.
+  uint rackOf(uint nodeId) const { return nodeId / instrumentsPerRack; }
+  const std::vector<int> &multiplexedQubits(uint qubitId) const {
     return acquireQubits(acquireNode(qubitId));
   }
 
 private:
+  /// Preprocess the configuration data for use by the passes.
+  void mapNodes();
+
   uint controllerNodeId;
   // The number of qubits attached to each acquire Mock
   uint multiplexing_ratio;
+  uint instrumentsPerRack;
   std::vector<uint> qubitDriveMap;   // map from physId to drive NodeId
   std::vector<uint> qubitAcquireMap; // map from physId to acquire NodeId
   // map from acquire NodeId to a list of physical Ids that
@@ -71,18 +109,56 @@ class MockSystem : public qssc::hal::TargetSystem {
 public:
   static constexpr auto name = "mock";
   static const std::vector<std::string> childNames;
-  explicit MockSystem(std::unique_ptr<MockConfig> config);
+  explicit MockSystem(std::shared_ptr<const MockConfig> config);
   static llvm::Error registerTargetPasses();
   static llvm::Error registerTargetPipelines();
   llvm::Error addPasses(mlir::PassManager &pm) override;
   llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
                             payload::Payload &payload) override;
-  auto getConfig() -> MockConfig & { return *mockConfig; }
+  bool emitsIndependentlyOfChildren() const override { return true; }
+  /// @brief Create the controller, drive, acquire and rack targets of the
+  /// node modules of the localized module that are not instantiated yet.
+  /// Nodes none of the compiled programs use are never instantiated.
+  llvm::Error instantiateChildren(mlir::ModuleOp moduleOp) override;
+  auto getConfig() -> const MockConfig & { return *mockConfig; }
 
 private:
-  std::unique_ptr<MockConfig> mockConfig;
+  std::shared_ptr<const MockConfig> mockConfig;
+  std::mutex instantiateMutex; // guards instantiatedNodes
+  /// The node types and ids of the children instantiated so far.
+  std::set<std::pair<std::string, uint>> instantiatedNodes;
 }; // class MockSystem
 
+/// @brief A rack of drive and acquire instruments, i.e., a subsystem of the
+/// mock system when its configuration groups the instruments in racks. The
+/// module of a rack nests the modules of its instruments, see
+/// MockRackPartitioningPass. After its instruments emitted their payload, a
+/// rack emits the manifest of the instruments it contains.
+class MockRack : public qssc::hal::TargetSystem {
+public:
+  MockRack(std::string name, MockSystem *parent, const MockConfig &config,
+           uint32_t rackId);
+  /// @brief The module of the rack among the modules of the system.
+  llvm::Expected<mlir::ModuleOp>
+  getModule(mlir::ModuleOp parentModuleOp) override;
+  llvm::Error addPasses(mlir::PassManager &pm) override;
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            payload::Payload &payload) override;
+  llvm::Error emitToPayloadPostChildren(mlir::ModuleOp moduleOp,
+                                        payload::Payload &payload) override;
+  bool emitsIndependentlyOfChildren() const override { return true; }
+  /// @brief Create the targets of the instruments of the rack module that
+  /// are not instantiated yet.
+  llvm::Error instantiateChildren(mlir::ModuleOp moduleOp) override;
+  uint32_t getRackId() const { return rackId; }
+
+private:
+  const MockConfig &config;
+  uint32_t rackId;
+  std::mutex instantiateMutex; // guards instantiatedNodes
+  std::set<std::pair<std::string, uint>> instantiatedNodes;
+}; // class MockRack
+
 class MockController : public qssc::hal::TargetInstrument {
 public:
   MockController(std::string name, MockSystem *parent,
@@ -92,6 +168,9 @@ public:
   virtual llvm::StringRef getNodeType() override { return "controller"; }
   // Currently there is a single controller with a fixed node id.
   virtual uint32_t getNodeId() override { return 1000; }
+  std::optional<std::string> getConfigurationFingerprint() const override {
+    return "controller";
+  }
   llvm::Error addPasses(mlir::PassManager &pm) override;
   llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
                             payload::Payload &payload) override;
@@ -103,12 +182,15 @@ private:
 
 class MockAcquire : public qssc::hal::TargetInstrument {
 public:
-  MockAcquire(std::string name, MockSystem *parent,
+  MockAcquire(std::string name, qssc::hal::TargetSystem *parent,
               const qssc::hal::SystemConfiguration &config, uint32_t nodeId);
   static void registerTargetPasses();
   static void registerTargetPipelines();
   virtual llvm::StringRef getNodeType() override { return "acquire"; }
   virtual uint32_t getNodeId() override { return nodeId_; };
+  std::optional<std::string> getConfigurationFingerprint() const override {
+    return "acquire:" + std::to_string(nodeId_);
+  }
   llvm::Error addPasses(mlir::PassManager &pm) override;
   llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
                             payload::Payload &payload) override;
@@ -120,12 +202,15 @@ private:
 
 class MockDrive : public qssc::hal::TargetInstrument {
 public:
-  MockDrive(std::string name, MockSystem *parent,
+  MockDrive(std::string name, qssc::hal::TargetSystem *parent,
             const qssc::hal::SystemConfiguration &config, uint32_t nodeId);
   static void registerTargetPasses();
   static void registerTargetPipelines();
   virtual llvm::StringRef getNodeType() override { return "drive"; }
   virtual uint32_t getNodeId() override { return nodeId_; };
+  std::optional<std::string> getConfigurationFingerprint() const override {
+    return "drive:" + std::to_string(nodeId_);
+  }
   llvm::Error addPasses(mlir::PassManager &pm) override;
   llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
                             payload::Payload &payload) override;
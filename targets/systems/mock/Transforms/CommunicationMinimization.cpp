@@ -0,0 +1,334 @@
+//===- CommunicationMinimization.cpp - Minimize node messages ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the pass for minimizing the messages between the
+//  controller and the other nodes of localized modules
+//
+//===----------------------------------------------------------------------===//
+
+#include "CommunicationMinimization.h"
+
+#include "MockTarget.h"
+#include "QubitLocalization.h"
+
+#include "Dialect/QCS/IR/QCSOps.h"
+
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Support/LLVM.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <sys/types.h>
+
+using namespace mlir;
+using namespace mlir::qcs;
+namespace mock = qssc::targets::systems::mock;
+using namespace mock;
+
+namespace {
+/// A value broadcast by the controller and its receives on the other nodes,
+/// paired by the message id of the qubit localization.
+struct Message {
+  BroadcastOp broadcastOp;
+  std::map<uint, RecvOp> recvOps; // one per nodeId
+  /// The sends replacing the broadcast for the nodes which use the value.
+  std::map<uint, SendOp> sendOps; // one per nodeId
+};
+
+std::optional<int64_t> getMessageId(Operation *op) {
+  if (auto attr = op->getAttrOfType<IntegerAttr>(messageIdAttrName))
+    return attr.getInt();
+  return std::nullopt;
+}
+
+/// Whether op is or contains a message from the controller which must stay
+/// ordered with commOp, i.e., any message for a broadcast or a message to the
+/// same node for a send.
+bool isOrderedWith(Operation *op, Operation *commOp) {
+  auto sendOp = dyn_cast<SendOp>(commOp);
+  return op
+      ->walk([&](Operation *nested) {
+        if (isa<BroadcastOp>(nested))
+          return WalkResult::interrupt();
+        if (auto nestedSendOp = dyn_cast<SendOp>(nested))
+          if (!sendOp || nestedSendOp.getIdAttr() == sendOp.getIdAttr())
+            return WalkResult::interrupt();
+        return WalkResult::advance();
+      })
+      .wasInterrupted();
+}
+
+/// Move a send or broadcast up to right after the definition of its values,
+/// without passing messages it must stay ordered with.
+void hoist(Operation *commOp) {
+  Operation *insertAfter = nullptr;
+  for (Operation *prev = commOp->getPrevNode(); prev;
+       prev = prev->getPrevNode()) {
+    bool const definesValue = llvm::any_of(commOp->getOperands(), [&](Value v) {
+      Operation *definingOp = v.getDefiningOp();
+      return definingOp && prev->isAncestor(definingOp);
+    });
+    if (definesValue || isOrderedWith(prev, commOp)) {
+      insertAfter = prev;
+      break;
+    }
+  }
+
+  if (insertAfter) {
+    if (insertAfter != commOp->getPrevNode())
+      commOp->moveAfter(insertAfter);
+  } else if (commOp != &commOp->getBlock()->front()) {
+    commOp->moveBefore(&commOp->getBlock()->front());
+  }
+}
+
+class CommunicationMinimizer {
+public:
+  CommunicationMinimizer(ModuleOp topModuleOp, uint controllerId)
+      : topModuleOp(topModuleOp), controllerId(controllerId) {}
+
+  void run();
+
+private:
+  void collectMessages();
+  void targetMessages();
+  void coalesceMessages(ModuleOp nodeModule, uint nodeId);
+  void coalesceRun(llvm::ArrayRef<RecvOp> run, uint nodeId);
+  void hoistMessages();
+
+  /// Whether recvOp receives a value the controller sends only to this node.
+  bool isTargeted(RecvOp recvOp, uint nodeId);
+
+  ModuleOp topModuleOp;
+  uint controllerId;
+  ModuleOp controllerModule;
+  std::map<uint, ModuleOp> nodeModules; // one per nodeId
+  llvm::DenseMap<int64_t, Message> messages;
+};
+
+void CommunicationMinimizer::run() {
+  for (auto moduleOp : topModuleOp.getOps<ModuleOp>()) {
+    auto nodeId = moduleOp->getAttrOfType<IntegerAttr>("quir.nodeId");
+    if (!nodeId)
+      continue;
+    if (nodeId.getUInt() == controllerId)
+      controllerModule = moduleOp;
+    else
+      nodeModules[nodeId.getUInt()] = moduleOp;
+  }
+
+  if (controllerModule) {
+    collectMessages();
+    targetMessages();
+    for (auto &[nodeId, nodeModule] : nodeModules)
+      coalesceMessages(nodeModule, nodeId);
+    hoistMessages();
+  }
+
+  topModuleOp->walk([](Operation *op) { op->removeAttr(messageIdAttrName); });
+}
+
+void CommunicationMinimizer::collectMessages() {
+  controllerModule->walk([&](BroadcastOp broadcastOp) {
+    if (auto messageId = getMessageId(broadcastOp))
+      messages[*messageId].broadcastOp = broadcastOp;
+  });
+  for (auto &[nodeId, nodeModule] : nodeModules)
+    nodeModule->walk([&, nodeId = nodeId](RecvOp recvOp) {
+      if (auto messageId = getMessageId(recvOp))
+        messages[*messageId].recvOps[nodeId] = recvOp;
+    });
+}
+
+void CommunicationMinimizer::targetMessages() {
+  for (auto &[messageId, message] : messages) {
+    if (!message.broadcastOp)
+      continue;
+
+    // the nodes which use the value
+    llvm::SmallVector<uint> receivers;
+    size_t const numRecvOps = message.recvOps.size();
+    for (auto it = message.recvOps.begin(); it != message.recvOps.end();) {
+      if (it->second->use_empty()) {
+        it->second->erase();
+        it = message.recvOps.erase(it);
+      } else {
+        receivers.push_back(it->first);
+        ++it;
+      }
+    }
+
+    // a broadcast all of its receivers need stays a single message
+    if (receivers.size() == numRecvOps && numRecvOps != 0)
+      continue;
+
+    OpBuilder builder(message.broadcastOp);
+    for (uint const nodeId : receivers) {
+      auto sendOp = builder.create<SendOp>(message.broadcastOp->getLoc(),
+                                           message.broadcastOp.getVal(),
+                                           builder.getIndexAttr(nodeId));
+      message.sendOps[nodeId] = sendOp;
+    }
+    message.broadcastOp->erase();
+    message.broadcastOp = {};
+  }
+}
+
+bool CommunicationMinimizer::isTargeted(RecvOp recvOp, uint nodeId) {
+  auto messageId = getMessageId(recvOp);
+  if (!messageId)
+    return false;
+  auto it = messages.find(*messageId);
+  return it != messages.end() && it->second.sendOps.count(nodeId);
+}
+
+void CommunicationMinimizer::coalesceMessages(ModuleOp nodeModule,
+                                              uint nodeId) {
+  // Runs of targeted receives only separated by operations free of side
+  // effects, which do not let the node proceed any further while waiting.
+  llvm::SmallVector<llvm::SmallVector<RecvOp>> runs;
+  nodeModule->walk([&](Block *block) {
+    llvm::SmallVector<RecvOp> run;
+    auto endRun = [&]() {
+      if (run.size() > 1)
+        runs.push_back(run);
+      run.clear();
+    };
+    for (Operation &op : *block) {
+      auto recvOp = dyn_cast<RecvOp>(op);
+      if (recvOp && isTargeted(recvOp, nodeId)) {
+        run.push_back(recvOp);
+        continue;
+      }
+      if (op.getNumRegions() == 0 && isMemoryEffectFree(&op))
+        continue;
+      endRun();
+    }
+    endRun();
+  });
+
+  for (auto &run : runs)
+    coalesceRun(run, nodeId);
+}
+
+void CommunicationMinimizer::coalesceRun(llvm::ArrayRef<RecvOp> run,
+                                         uint nodeId) {
+  llvm::SmallVector<SendOp> sendOps;
+  llvm::SmallPtrSet<Operation *, 4> sendOperations;
+  for (auto recvOp : run) {
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    auto sendOp = messages[*getMessageId(recvOp)].sendOps[nodeId];
+    sendOps.push_back(sendOp);
+    sendOperations.insert(sendOp);
+  }
+
+  // The sends are merged into the last of them, where all values are
+  // defined. The ones in between must not be messages to the node.
+  Block *block = sendOps.front()->getBlock();
+  if (llvm::any_of(sendOps, [&](SendOp sendOp) {
+        return sendOp->getBlock() != block;
+      }))
+    return;
+  auto [first, last] = std::minmax_element(
+      sendOps.begin(), sendOps.end(), [](SendOp lhs, SendOp rhs) {
+        return lhs->isBeforeInBlock(rhs);
+      });
+  for (Operation *op = (*first)->getNextNode(); op != *last;
+       op = op->getNextNode())
+    if (!sendOperations.count(op) && isOrderedWith(op, *last))
+      return;
+
+  llvm::SmallVector<Value> vals;
+  llvm::SmallVector<Location> sendLocs;
+  llvm::SmallVector<Type> types;
+  llvm::SmallVector<Location> recvLocs;
+  for (auto [recvOp, sendOp] : llvm::zip(run, sendOps)) {
+    vals.append(sendOp.getVals().begin(), sendOp.getVals().end());
+    sendLocs.push_back(sendOp->getLoc());
+    types.append(recvOp.getVals().getTypes().begin(),
+                 recvOp.getVals().getTypes().end());
+    recvLocs.push_back(recvOp->getLoc());
+  }
+
+  OpBuilder sendBuilder(*last);
+  sendBuilder.create<SendOp>(sendBuilder.getFusedLoc(sendLocs), vals,
+                             (*last).getIdAttr());
+  for (auto sendOp : sendOps)
+    sendOp->erase();
+
+  OpBuilder recvBuilder(run.front());
+  auto recvOp = recvBuilder.create<RecvOp>(
+      recvBuilder.getFusedLoc(recvLocs), types,
+      recvBuilder.getIndexArrayAttr(
+          llvm::SmallVector<int64_t>(types.size(), controllerId)));
+  unsigned index = 0;
+  for (auto runRecvOp : run) {
+    for (auto val : runRecvOp.getVals())
+      val.replaceAllUsesWith(recvOp.getVals()[index++]);
+    runRecvOp->erase();
+  }
+}
+
+void CommunicationMinimizer::hoistMessages() {
+  llvm::SmallVector<Operation *> commOps;
+  controllerModule->walk([&](Operation *op) {
+    if (isa<SendOp, BroadcastOp>(op))
+      commOps.push_back(op);
+  });
+  for (auto *commOp : commOps)
+    hoist(commOp);
+}
+} // anonymous namespace
+
+// Entry point for the pass.
+void mock::MockCommunicationMinimizationPass::runOnOperation(
+    MockSystem &target) {
+  auto topModuleOp = dyn_cast<ModuleOp>(getOperation());
+  if (!topModuleOp)
+    return;
+  CommunicationMinimizer(topModuleOp, target.getConfig().controllerNode())
+      .run();
+} // runOnOperation()
+
+llvm::StringRef MockCommunicationMinimizationPass::getArgument() const {
+  return "mock-communication-minimization";
+}
+
+llvm::StringRef MockCommunicationMinimizationPass::getDescription() const {
+  return "Send classical values only to the nodes using them, coalesced and "
+         "as early as possible.";
+}
+
+llvm::StringRef MockCommunicationMinimizationPass::getName() const {
+  return "Mock Communication Minimization Pass";
+}
@@ -0,0 +1,59 @@
+//===- CommunicationMinimization.h - Minimize node messages -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the pass for minimizing the messages between the
+//  controller and the other nodes of localized modules
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MOCK_COMMUNICATION_MINIMIZATION_H
+#define MOCK_COMMUNICATION_MINIMIZATION_H
+
+#include "MockTarget.h"
+
+#include "HAL/TargetOperationPass.h"
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace qssc::targets::systems::mock {
+
+/// @brief Minimize the messages the controller sends to the other nodes after
+/// qubit localization, which broadcasts every classical value crossing node
+/// boundaries to all nodes:
+/// - nodes which do not use a received value no longer receive it and a
+///   broadcast which not all of its receivers need becomes a qcs.send to each
+///   node which does,
+/// - the values a node receives back to back, only separated by operations
+///   free of side effects, are sent in a single message and received by a
+///   single qcs.recv,
+/// - the sends and broadcasts of the controller are hoisted to right after
+///   their values are defined, without reordering the messages to a node.
+struct MockCommunicationMinimizationPass
+    : public mlir::PassWrapper<MockCommunicationMinimizationPass,
+                               qssc::hal::TargetOperationPass<MockSystem>> {
+
+  void runOnOperation(MockSystem &target) override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct MockCommunicationMinimizationPass
+
+} // namespace qssc::targets::systems::mock
+
+#endif // MOCK_COMMUNICATION_MINIMIZATION_H
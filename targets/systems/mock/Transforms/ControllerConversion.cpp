@@ -0,0 +1,71 @@
+//===- ControllerConversion.cpp - Convert the controller module -*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the pass converting the controller module of
+//  localized modules to the standard and LLVM dialects
+//
+//===----------------------------------------------------------------------===//
+
+#include "ControllerConversion.h"
+
+#include "Conversion/QUIRToStandard/QUIRToStandard.h"
+
+#include "mlir/Dialect/LLVMIR/Transforms/LegalizeForExport.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Transforms/Passes.h"
+
+#include <memory>
+
+using namespace mlir;
+namespace mock = qssc::targets::systems::mock;
+using namespace mock;
+
+MockControllerConversionPass::MockControllerConversionPass(
+    bool vectorizeAngles, bool vectorizeLoops)
+    : controllerPM(ModuleOp::getOperationName()) {
+  controllerPM.addPass(std::make_unique<conversion::MockQUIRToStdPass>(
+      /*externalizeOutputVariables=*/false, vectorizeAngles, vectorizeLoops));
+  controllerPM.addPass(createCanonicalizerPass());
+  controllerPM.addPass(LLVM::createLegalizeForExportPass());
+} // MockControllerConversionPass
+
+void MockControllerConversionPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+  auto nodeType = moduleOp->getAttrOfType<StringAttr>("quir.nodeType");
+  if (!nodeType || nodeType.getValue() != "controller")
+    return;
+
+  if (failed(runPipeline(controllerPM, moduleOp)))
+    signalPassFailure();
+} // runOnOperation()
+
+void MockControllerConversionPass::getDependentDialects(
+    DialectRegistry &registry) const {
+  controllerPM.getDependentDialects(registry);
+}
+
+llvm::StringRef MockControllerConversionPass::getArgument() const {
+  return "mock-controller-conversion";
+}
+
+llvm::StringRef MockControllerConversionPass::getDescription() const {
+  return "Convert the controller module of localized modules to the standard "
+         "and LLVM dialects.";
+}
+
+llvm::StringRef MockControllerConversionPass::getName() const {
+  return "Mock Controller Conversion Pass";
+}
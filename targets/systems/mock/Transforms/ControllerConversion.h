@@ -0,0 +1,62 @@
+//===- ControllerConversion.h - Convert the controller module ---*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the pass converting the controller module of localized
+//  modules to the standard and LLVM dialects
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MOCK_CONTROLLER_CONVERSION_H
+#define MOCK_CONTROLLER_CONVERSION_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace qssc::targets::systems::mock {
+
+/// @brief Run the node-local pipeline of the controller, i.e., the conversion
+/// of QUIR to std, canonicalization and the legalization for the export to
+/// LLVM IR, on a module created by qubit localization. Nested under the pass
+/// manager of the system, next to the other passes on the node modules, it
+/// runs in parallel with the work on the drive and acquire modules instead of
+/// after the system pipeline has finished. Other modules are left untouched.
+/// With vectorizeAngles, the independent angle operations of the controller
+/// are computed by vector operations, and with vectorizeLoops, the
+/// independent iterations of its loops over registers.
+struct MockControllerConversionPass
+    : public mlir::PassWrapper<MockControllerConversionPass,
+                               mlir::OperationPass<mlir::ModuleOp>> {
+  MockControllerConversionPass(bool vectorizeAngles = false,
+                               bool vectorizeLoops = false);
+
+  void runOnOperation() override;
+  void getDependentDialects(mlir::DialectRegistry &registry) const override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+
+private:
+  mlir::OpPassManager controllerPM;
+}; // struct MockControllerConversionPass
+
+} // namespace qssc::targets::systems::mock
+
+#endif // MOCK_CONTROLLER_CONVERSION_H
@@ -26,6 +26,7 @@
 #include "Dialect/QCS/IR/QCSOps.h"
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Utils/OpDispatch.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -35,28 +36,33 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/Region.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
-#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <sys/types.h>
-#include <tuple>
-#include <unordered_map>
-#include <unordered_set>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -67,20 +73,76 @@ using namespace mlir::oq3;
 namespace mock = qssc::targets::systems::mock;
 using namespace mock;
 
+mock::MockQubitLocalizer::MockQubitLocalizer(
+    const MockLocalizationAnalysis &analysis, std::optional<uint> nodeId)
+    : analysis(analysis), config(analysis.config), nodeId(nodeId),
+      attributeBuilder(analysis.controllerModule.getContext()),
+      seenNodeIds(analysis.seenNodeIds),
+      controllerBuilder(analysis.controllerModule.getContext()),
+      nodeBuilder(analysis.controllerModule.getContext()) {}
+
 namespace {
+// the insertion point of an OpBuilder created on a region
+OpBuilder::InsertPoint regionStart(Region &region) {
+  if (region.empty())
+    return {};
+  return {&region.front(), region.front().begin()};
+}
+} // anonymous namespace
+
+bool mock::MockQubitLocalizer::localizesNode(uint id) const {
+  return nodeId == id && nodeBuilder.getInsertionBlock();
+} // localizesNode
+
+llvm::SmallVector<uint, 1>
+mock::MockQubitLocalizer::localNodeIds(const llvm::BitVector &nodeIds) const {
+  if (nodeId && *nodeId < nodeIds.size() && nodeIds.test(*nodeId) &&
+      localizesNode(*nodeId))
+    return {*nodeId};
+  return {};
+} // localNodeIds
+
+llvm::SmallVector<uint, 1>
+mock::MockQubitLocalizer::localNodeIds(llvm::ArrayRef<uint> nodeIds) const {
+  if (nodeId && llvm::is_contained(nodeIds, *nodeId) && localizesNode(*nodeId))
+    return {*nodeId};
+  return {};
+} // localNodeIds
+
+Operation *mock::MockQubitLocalizer::cloneToController(Operation &op) {
+  if (!localizesController())
+    return nullptr;
+  return controllerBuilder.clone(op, controllerMapping);
+} // cloneToController
+
+Operation *mock::MockQubitLocalizer::cloneToNode(uint id, Operation &op) {
+  if (!localizesNode(id))
+    return nullptr;
+  return nodeBuilder.clone(op, nodeMapping);
+} // cloneToNode
+
+InFlightDiagnostic mock::MockQubitLocalizer::emitOpError(Operation *op) {
+  if (!localizesController())
+    return {};
+  return op->emitOpError();
+} // emitOpError
+
 /// Returns true of this op has the classicalOnly attribute set to true
-auto classicalOnlyCheck(Operation *op) -> bool {
+auto mock::MockQubitLocalizer::classicalOnlyCheck(Operation *op) -> bool {
   auto classicalOnlyAttr = op->getAttrOfType<BoolAttr>("quir.classicalOnly");
   if (classicalOnlyAttr)
     return classicalOnlyAttr.getValue();
-  op->emitOpError() << "Error! No classicalOnly attribute found!\n"
-                    << "Try running --classical-only-detection first!\n";
+  emitOpError(op) << "Error! No classicalOnly attribute found!\n"
+                  << "Try running --classical-only-detection first!\n";
   return false;
-}
-} // end anonymous namespace
+} // classicalOnlyCheck
+
+llvm::raw_ostream &mock::MockQubitLocalizer::log() {
+  return localizesController() ? llvm::outs() : llvm::nulls();
+} // log
 
 // find a qubit ID from the attribute on its declaration
-auto mock::MockQubitLocalizationPass::lookupQubitId(const Value &val) -> int {
+auto mock::MockQubitLocalizer::lookupQubitId(const Value &val) -> int {
   auto declOp = val.getDefiningOp<DeclareQubitOp>();
   if (!declOp) { // Must be an argument to a function
     // see if we can find an attribute with the info
@@ -107,25 +169,34 @@ auto mock::MockQubitLocalizationPass::lookupQubitId(const Value &val) -> int {
 
 /// Creates a broadcast op on Controller and recvOp on all other mocks
 /// also checks if a value *should* be broadcast
-void mock::MockQubitLocalizationPass::broadcastAndReceiveValue(
-    const Value &val, const Location &loc,
-    const std::unordered_set<uint> &toNodeIds) {
+void mock::MockQubitLocalizer::broadcastAndReceiveValue(
+    const Value &val, const Location &loc, const llvm::BitVector &toNodeIds) {
+  broadcastAndReceiveValue(val, loc, localNodeIds(toNodeIds));
+} // broadcastValue
+
+void mock::MockQubitLocalizer::broadcastAndReceiveValue(
+    const Value &val, const Location &loc, llvm::ArrayRef<uint> toNodeIds) {
   if (alreadyBroadcastValues.count(val) == 0) {
     Operation *parentOp = val.getDefiningOp();
     if (parentOp) {
       if (dyn_cast<mlir::arith::ConstantOp>(parentOp) ||
           dyn_cast<quir::ConstantOp>(parentOp)) {
         // Just clone this op to the mocks
-        for (uint const id : toNodeIds)
-          (*mockBuilders)[id]->clone(*parentOp, mockMapping[id]);
+        for (uint const id : localNodeIds(toNodeIds))
+          cloneToNode(id, *parentOp);
       } else {
-        controllerBuilder->create<BroadcastOp>(
-            loc, controllerMapping.lookupOrNull(val));
-        for (uint const id : toNodeIds) {
-          auto recvOp = (*mockBuilders)[id]->create<RecvOp>(
+        auto messageId = attributeBuilder.getI64IntegerAttr(numMessages++);
+        if (localizesController()) {
+          auto broadcastOp = controllerBuilder.create<BroadcastOp>(
+              loc, controllerMapping.lookupOrNull(val));
+          broadcastOp->setAttr(messageIdAttrName, messageId);
+        }
+        for (uint const id : localNodeIds(toNodeIds)) {
+          auto recvOp = nodeBuilder.create<RecvOp>(
               loc, TypeRange(val.getType()),
-              controllerBuilder->getIndexArrayAttr(config->controllerNode()));
-          mockMapping[id].map(val, recvOp.getVals().front());
+              attributeBuilder.getIndexArrayAttr(config->controllerNode()));
+          recvOp->setAttr(messageIdAttrName, messageId);
+          nodeMapping.map(val, recvOp.getVals().front());
         }
       }
       alreadyBroadcastValues.insert(val);
@@ -135,16 +206,18 @@ void mock::MockQubitLocalizationPass::broadcastAndReceiveValue(
   } // if alreadyBroadcastValues.count(val) == 0
 } // broadcastValue
 
-void mock::MockQubitLocalizationPass::cloneRegionWithoutOps(Region *from,
-                                                            Region *dest,
-                                                            IRMapping &mapper) {
+void mock::MockQubitLocalizer::cloneRegionWithoutOps(Region *from,
+                                                     Region *dest,
+                                                     IRMapping &mapper) {
   assert(dest && "expected valid region to clone into");
   cloneRegionWithoutOps(from, dest, dest->end(), mapper);
 } // cloneRegionWithoutOps
 
 // clone region (from) into region (dest) before the given position
-void mock::MockQubitLocalizationPass::cloneRegionWithoutOps(
-    Region *from, Region *dest, Region::iterator destPos, IRMapping &mapper) {
+void mock::MockQubitLocalizer::cloneRegionWithoutOps(Region *from,
+                                                     Region *dest,
+                                                     Region::iterator destPos,
+                                                     IRMapping &mapper) {
   assert(dest && "expected valid region to clone into");
   assert(from != dest && "cannot clone region into itself");
 
@@ -195,48 +268,45 @@ auto mock::MockQubitLocalizationPass::addMainFunction(
   return funcOp;
 } // addMainFunction
 
-void mock::MockQubitLocalizationPass::processOp(DeclareQubitOp &qubitOp) {
+void mock::MockQubitLocalizer::processOp(DeclareQubitOp &qubitOp) {
   Operation *op = qubitOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
 
   // declare every qubit on each mock for multi-qubit gates purposes
-  for (auto nodeId : seenNodeIds) {
-    auto *clonedOp = (*mockBuilders)[nodeId]->clone(*op);
-    mockMapping[nodeId].map(qubitOp.getRes(),
-                            dyn_cast<DeclareQubitOp>(clonedOp).getRes());
+  if (!localNodeIds(seenNodeIds).empty()) {
+    auto *clonedOp = nodeBuilder.clone(*op);
+    nodeMapping.map(qubitOp.getRes(),
+                    dyn_cast<DeclareQubitOp>(clonedOp).getRes());
   }
 } // processOp DeclareQubitOp
 
-void mock::MockQubitLocalizationPass::processOp(ResetQubitOp &resetOp) {
+void mock::MockQubitLocalizer::processOp(ResetQubitOp &resetOp) {
   if (resetOp.getQubits().size() != 1) {
     signalPassFailure(); // only support single-qubit resets"
     return;
   }
 
   Operation *op = resetOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   int const qubitId = lookupQubitId(resetOp.getQubits().front());
   if (qubitId < 0) {
-    resetOp->emitOpError() << "Can't resolve qubit ID for resetOp\n";
+    emitOpError(resetOp) << "Can't resolve qubit ID for resetOp\n";
     return signalPassFailure();
   }
-  (*mockBuilders)[config->driveNode(qubitId)]->clone(
-      *op, mockMapping[config->driveNode(qubitId)]);
-  (*mockBuilders)[config->acquireNode(qubitId)]->clone(
-      *op, mockMapping[config->acquireNode(qubitId)]);
+  cloneToNode(config->driveNode(qubitId), *op);
+  cloneToNode(config->acquireNode(qubitId), *op);
 } // processOp ResetQubitOp
 
-void mock::MockQubitLocalizationPass::processOp(mlir::func::FuncOp &funcOp) {
+void mock::MockQubitLocalizer::processOp(mlir::func::FuncOp &funcOp) {
   Operation *op = funcOp.getOperation();
-  OpBuilder const fBuild(funcOp);
-  llvm::outs() << "Cloning FuncOp " << SymbolRefAttr::get(funcOp)
-               << " to Controller\n";
-  controllerBuilder->clone(*op, controllerMapping);
+  log() << "Cloning FuncOp " << SymbolRefAttr::get(funcOp)
+        << " to Controller\n";
+  cloneToController(*op);
 } // processOp FuncOp
 
-void mock::MockQubitLocalizationPass::processOp(Builtin_UOp &uOp) {
+void mock::MockQubitLocalizer::processOp(Builtin_UOp &uOp) {
   Operation *op = uOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   int const qubitId = lookupQubitId(uOp.getTarget());
 
   // broadcast all classical values from Controller to all Mockss
@@ -246,71 +316,69 @@ void mock::MockQubitLocalizationPass::processOp(Builtin_UOp &uOp) {
   broadcastAndReceiveValue(uOp.getLambda(), op->getLoc(), seenNodeIds);
 
   if (qubitId < 0) {
-    uOp->emitOpError() << "Can't resolve qubit ID for uOp\n";
+    emitOpError(uOp) << "Can't resolve qubit ID for uOp\n";
     return signalPassFailure();
   }
   // clone the gate call to the drive mock
-  (*mockBuilders)[config->driveNode(qubitId)]->clone(
-      *op, mockMapping[config->driveNode(qubitId)]);
+  cloneToNode(config->driveNode(qubitId), *op);
 } // processOp Builtin_UOp
 
-void mock::MockQubitLocalizationPass::processOp(BuiltinCXOp &cxOp) {
+void mock::MockQubitLocalizer::processOp(BuiltinCXOp &cxOp) {
   Operation *op = cxOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   int const qubitId1 = lookupQubitId(cxOp.getControl());
   int const qubitId2 = lookupQubitId(cxOp.getTarget());
 
   if (qubitId1 < 0 || qubitId2 < 0) {
-    cxOp->emitOpError() << "Can't resolve qubit ID for cxOp\n";
+    emitOpError(cxOp) << "Can't resolve qubit ID for cxOp\n";
     return signalPassFailure();
   }
   // clone the gate call to the drive mocks
-  (*mockBuilders)[config->driveNode(qubitId1)]->clone(
-      *op, mockMapping[config->driveNode(qubitId1)]);
-  (*mockBuilders)[config->driveNode(qubitId2)]->clone(
-      *op, mockMapping[config->driveNode(qubitId2)]);
+  cloneToNode(config->driveNode(qubitId1), *op);
+  cloneToNode(config->driveNode(qubitId2), *op);
 } // processOp BuiltinCXOp
 
-void mock::MockQubitLocalizationPass::processOp(MeasureOp &measureOp) {
+void mock::MockQubitLocalizer::processOp(MeasureOp &measureOp) {
   Operation *op = measureOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   // figure out which qubit this gate operates on
   int const qubitId = lookupQubitId(measureOp.getQubits().front());
   // clone the measure call to the drive and acquire mocks
-  (*mockBuilders)[config->driveNode(qubitId)]->clone(
-      *op, mockMapping[config->driveNode(qubitId)]);
-  Operation *clonedOp = (*mockBuilders)[config->acquireNode(qubitId)]->clone(
-      *op, mockMapping[config->acquireNode(qubitId)]);
-  auto clonedMeasureOp = dyn_cast<MeasureOp>(clonedOp);
-
-  // send the results from the acquire mock and recv on Controller
-  (*mockBuilders)[config->acquireNode(qubitId)]->create<SendOp>(
-      op->getLoc(), clonedMeasureOp.getOuts().front(),
-      controllerBuilder->getIndexAttr(config->controllerNode()));
-  auto recvOp = controllerBuilder->create<RecvOp>(
-      op->getLoc(), TypeRange(clonedMeasureOp.getOuts().front().getType()),
-      controllerBuilder->getIndexArrayAttr(qubitId));
-  // map the result on Controller
-  controllerMapping.map(measureOp.getOuts().front(), recvOp.getVals().front());
+  cloneToNode(config->driveNode(qubitId), *op);
+  if (Operation *clonedOp =
+          cloneToNode(config->acquireNode(qubitId), *op)) {
+    auto clonedMeasureOp = dyn_cast<MeasureOp>(clonedOp);
+
+    // send the results from the acquire mock
+    nodeBuilder.create<SendOp>(
+        op->getLoc(), clonedMeasureOp.getOuts().front(),
+        attributeBuilder.getIndexAttr(config->controllerNode()));
+  }
+
+  if (localizesController()) {
+    // recv the results on Controller
+    auto recvOp = controllerBuilder.create<RecvOp>(
+        op->getLoc(), TypeRange(measureOp.getOuts().front().getType()),
+        attributeBuilder.getIndexArrayAttr(qubitId));
+    // map the result on Controller
+    controllerMapping.map(measureOp.getOuts().front(),
+                          recvOp.getVals().front());
+  }
 } // processOp MeasureOp
 
-void mock::MockQubitLocalizationPass::processOp(
+void mock::MockQubitLocalizer::processOp(
     CallSubroutineOp &callOp,
-    std::deque<
-        std::tuple<Block *, OpBuilder *,
-                   std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-        &blockAndBuilderWorkList) {
+    BlockAndBuilderWorkList &blockAndBuilderWorkList) {
   Operation *op = callOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
 
-  controllerBuilder->clone(
-      *op, controllerMapping); // cloning the callOp to controller
+  cloneToController(*op); // cloning the callOp to controller
   // first look up the func def in the parent Module
   Operation *funcOperation = SymbolTable::lookupSymbolIn(
-      controllerModule->getParentOp(), callOp.getCallee());
+      analysis.controllerModule->getParentOp(), callOp.getCallee());
   if (!funcOperation) {
-    callOp->emitOpError() << "Unable to find func def to match "
-                          << callOp.getCallee() << "\n";
+    emitOpError(callOp) << "Unable to find func def to match "
+                        << callOp.getCallee() << "\n";
     return;
   }
   auto funcOp = dyn_cast<mlir::func::FuncOp>(funcOperation);
@@ -327,54 +395,52 @@ void mock::MockQubitLocalizationPass::processOp(
     }   // for operands
 
     // Clone the subroutine call to all drive and acquire mocks
-    for (uint const nodeId : seenNodeIds) {
-      (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+    for (uint const nodeId : localNodeIds(seenNodeIds)) {
+      cloneToNode(nodeId, *op);
     } // for nodeId in seenNodeIds
   }   // if !onlyToController
 
   // Now clone the corresponding funcOp and recurse on it
   // First check if it's already been cloned!
-  if (SymbolTable::lookupSymbolIn(controllerModule.getOperation(),
-                                  callOp.getCallee())) {
-    llvm::outs() << callOp.getCallee() << " has already been cloned!\n";
+  if (!clonedCallees.insert(callOp.getCallee()).second) {
+    log() << callOp.getCallee() << " has already been cloned!\n";
     return;
   }
-  OpBuilder::InsertPoint savedPoint = controllerBuilder->saveInsertionPoint();
-  auto newBuilders = std::make_unique<std::unordered_map<uint, OpBuilder *>>();
-  controllerBuilder->setInsertionPointToStart(controllerModule.getBody());
-  Operation *clonedFuncOperation =
-      controllerBuilder->cloneWithoutRegions(*funcOperation, controllerMapping);
-  auto clonedFuncOp = dyn_cast<mlir::func::FuncOp>(clonedFuncOperation);
-  if (funcOp.getCallableRegion()) {
-    cloneRegionWithoutOps(&funcOp.getBody(), &clonedFuncOp.getBody(),
-                          controllerMapping);
-  }
-  controllerBuilder->restoreInsertionPoint(savedPoint);
+  BlockToLocalize callee{&funcOp.getBody().getBlocks().front(), {}, {}};
+  if (localizesController()) {
+    OpBuilder::InsertionGuard const guard(controllerBuilder);
+    controllerBuilder.setInsertionPointToStart(
+        analysis.controllerModule.getBody());
+    Operation *clonedFuncOperation = controllerBuilder.cloneWithoutRegions(
+        *funcOperation, controllerMapping);
+    auto clonedFuncOp = dyn_cast<mlir::func::FuncOp>(clonedFuncOperation);
+    if (funcOp.getCallableRegion()) {
+      cloneRegionWithoutOps(&funcOp.getBody(), &clonedFuncOp.getBody(),
+                            controllerMapping);
+    }
+    callee.controller = regionStart(clonedFuncOp.getBody());
+  }
   if (!onlyToController) {
-    for (uint const nodeId : seenNodeIds) {
-      savedPoint = (*mockBuilders)[nodeId]->saveInsertionPoint();
-      (*mockBuilders)[nodeId]->setInsertionPointToStart(
-          dyn_cast<ModuleOp>(mockModules[nodeId]).getBody());
+    for (uint const nodeId : localNodeIds(seenNodeIds)) {
+      OpBuilder::InsertionGuard const guard(nodeBuilder);
+      nodeBuilder.setInsertionPointToStart(
+          dyn_cast<ModuleOp>(analysis.mockModules[nodeId]).getBody());
       Operation *clonedFuncOperation =
-          (*mockBuilders)[nodeId]->cloneWithoutRegions(*funcOperation,
-                                                       mockMapping[nodeId]);
+          nodeBuilder.cloneWithoutRegions(*funcOperation, nodeMapping);
       auto clonedFuncOp = dyn_cast<mlir::func::FuncOp>(clonedFuncOperation);
       if (funcOp.getCallableRegion()) {
         cloneRegionWithoutOps(&funcOp.getBody(), &clonedFuncOp.getBody(),
-                              mockMapping[nodeId]);
+                              nodeMapping);
       }
-      newBuilders->emplace(nodeId, new OpBuilder(&clonedFuncOp.getBody()));
-      (*mockBuilders)[nodeId]->restoreInsertionPoint(savedPoint);
+      callee.node = regionStart(clonedFuncOp.getBody());
     } // for nodeId in seenNodeIds
   }   // if !onlyToController
-  blockAndBuilderWorkList.emplace_back(&funcOp.getBody().getBlocks().front(),
-                                       new OpBuilder(&clonedFuncOp.getBody()),
-                                       std::move(newBuilders));
+  blockAndBuilderWorkList.push_back(callee);
 } // processOp CallSubroutineOp
 
-void mock::MockQubitLocalizationPass::processOp(CallGateOp &callOp) {
+void mock::MockQubitLocalizer::processOp(CallGateOp &callOp) {
   Operation *op = callOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   // first find out which qubits this call operates on
   // and what non-qubit values it uses
   std::vector<int> qInd;
@@ -391,7 +457,7 @@ void mock::MockQubitLocalizationPass::processOp(CallGateOp &callOp) {
     } // else non-qubit Type
   }   // for operands
   if (!qubitIdsResolved) {
-    callOp->emitOpError() << "Unable to resolve all qubit IDs for gate call\n";
+    emitOpError(callOp) << "Unable to resolve all qubit IDs for gate call\n";
     return signalPassFailure();
   }
 
@@ -403,14 +469,13 @@ void mock::MockQubitLocalizationPass::processOp(CallGateOp &callOp) {
 
   // Clone the gate call to all relevant drive mocks
   for (uint const qubitId : qInd) {
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
+    cloneToNode(config->driveNode(qubitId), *op);
   } // for qubitId in qInd
 } // processOp CallGateOp
 
-void mock::MockQubitLocalizationPass::processOp(BarrierOp &barrierOp) {
+void mock::MockQubitLocalizer::processOp(BarrierOp &barrierOp) {
   Operation *op = barrierOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
 
   std::vector<Value> qubitOperands;
   qubitCallOperands(barrierOp, qubitOperands);
@@ -426,21 +491,20 @@ void mock::MockQubitLocalizationPass::processOp(BarrierOp &barrierOp) {
   }
 
   if (!qubitIdsResolved) {
-    barrierOp->emitOpError() << "Unable to resolve all qubit IDs for barrier\n";
+    emitOpError(barrierOp) << "Unable to resolve all qubit IDs for barrier\n";
     return signalPassFailure();
   }
 
   // Clone the gate call to all relevant drive
   for (uint const qubitId : qubits) {
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
+    cloneToNode(config->driveNode(qubitId), *op);
   } // for qubitId in qInd
 
 } // processOp BarrierOp
 
-void mock::MockQubitLocalizationPass::processOp(CallDefCalGateOp &callOp) {
+void mock::MockQubitLocalizer::processOp(CallDefCalGateOp &callOp) {
   Operation *op = callOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   // first find out which qubits this call operates on
   // and what non-qubit values it uses
   std::vector<int> qInd;
@@ -457,7 +521,7 @@ void mock::MockQubitLocalizationPass::processOp(CallDefCalGateOp &callOp) {
     } // else non-qubit Type
   }
   if (!qubitIdsResolved) {
-    callOp->emitOpError() << "Unable to resolve all qubit IDs for gate call\n";
+    emitOpError(callOp) << "Unable to resolve all qubit IDs for gate call\n";
     return signalPassFailure();
   }
 
@@ -468,14 +532,13 @@ void mock::MockQubitLocalizationPass::processOp(CallDefCalGateOp &callOp) {
 
   // Clone the gate call to all relevant drive mocks
   for (uint const qubitId : qInd) {
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
+    cloneToNode(config->driveNode(qubitId), *op);
   } // for qubitId in qInd
 } // processOp CallDefCalGateOp
 
-void mock::MockQubitLocalizationPass::processOp(CallDefcalMeasureOp &callOp) {
+void mock::MockQubitLocalizer::processOp(CallDefcalMeasureOp &callOp) {
   Operation *op = callOp.getOperation();
-  llvm::outs() << "Localizing a " << op->getName() << "\n";
+  log() << "Localizing a " << op->getName() << "\n";
   // first find out which qubits this call operates on
   // and what non-qubit values it uses
   std::vector<int> qInd;
@@ -492,7 +555,7 @@ void mock::MockQubitLocalizationPass::processOp(CallDefcalMeasureOp &callOp) {
     } // else non-qubit Type
   }
   if (!qubitIdsResolved) {
-    callOp->emitOpError()
+    emitOpError(callOp)
         << "Unable to resolve all qubit IDs for measurement call\n";
     return signalPassFailure();
   }
@@ -504,26 +567,29 @@ void mock::MockQubitLocalizationPass::processOp(CallDefcalMeasureOp &callOp) {
 
   for (uint const qubitId : qInd) {
     // Clone the measure call to all drive and acquire mocks
-    (*mockBuilders)[config->driveNode(qubitId)]->clone(
-        *op, mockMapping[config->driveNode(qubitId)]);
-    Operation *acquireOperation =
-        (*mockBuilders)[config->acquireNode(qubitId)]->clone(
-            *op, mockMapping[config->acquireNode(qubitId)]);
-    auto acquireOp = dyn_cast<CallDefcalMeasureOp>(acquireOperation);
-
-    // Send the measured value back to Controller and receive it on Controller
-    (*mockBuilders)[config->acquireNode(qubitId)]->create<SendOp>(
-        op->getLoc(), acquireOp.getRes(),
-        controllerBuilder->getIndexAttr(config->controllerNode()));
-    auto recvOp = controllerBuilder->create<RecvOp>(
-        op->getLoc(), TypeRange(acquireOp.getRes().getType()),
-        controllerBuilder->getIndexArrayAttr(qubitId));
-    controllerMapping.map(callOp.getRes(), recvOp.getVals().front());
+    cloneToNode(config->driveNode(qubitId), *op);
+    if (Operation *acquireOperation =
+            cloneToNode(config->acquireNode(qubitId), *op)) {
+      auto acquireOp = dyn_cast<CallDefcalMeasureOp>(acquireOperation);
+
+      // Send the measured value back to Controller
+      nodeBuilder.create<SendOp>(
+          op->getLoc(), acquireOp.getRes(),
+          attributeBuilder.getIndexAttr(config->controllerNode()));
+    }
+
+    if (localizesController()) {
+      // Receive the measured value on Controller
+      auto recvOp = controllerBuilder.create<RecvOp>(
+          op->getLoc(), TypeRange(callOp.getRes().getType()),
+          attributeBuilder.getIndexArrayAttr(qubitId));
+      controllerMapping.map(callOp.getRes(), recvOp.getVals().front());
+    }
   }
 } // processOp CallDefcalMeasureOp
 
 template <class DelayOpType>
-void mock::MockQubitLocalizationPass::processOp(DelayOpType &delayOp) {
+void mock::MockQubitLocalizer::processOp(DelayOpType &delayOp) {
   Operation *op = delayOp.getOperation();
   std::vector<int> qInd;
   bool qubitIdsResolved = true;
@@ -533,200 +599,247 @@ void mock::MockQubitLocalizationPass::processOp(DelayOpType &delayOp) {
       qubitIdsResolved = false;
   }
   if (!qubitIdsResolved) {
-    delayOp->emitOpError() << "Unable to resolve all qubit IDs for delay\n";
+    emitOpError(delayOp) << "Unable to resolve all qubit IDs for delay\n";
     return signalPassFailure();
   }
   if (delayOp.getQubits().empty()) // no qubit args means all qubits
-    for (uint const qId : seenQubitIds)
+    for (uint const qId : analysis.seenQubitIds.set_bits())
       qInd.emplace_back((int)qId);
 
-  // turn the vector of qubitIds into a set of node Ids
-  std::unordered_set<uint> involvedNodes;
+  // turn the vector of qubitIds into the node ids
+  llvm::SmallVector<uint> involvedNodes;
   for (int const qubitId : qInd) {
-    involvedNodes.emplace(config->driveNode(qubitId));
-    involvedNodes.emplace(config->acquireNode(qubitId));
+    involvedNodes.push_back(config->driveNode(qubitId));
+    involvedNodes.push_back(config->acquireNode(qubitId));
   }
 
   if (auto dOp = dyn_cast<DelayOp>(op)) {
     auto *durationDeclare = dOp.getTime().getDefiningOp();
-    for (uint const id : involvedNodes)
-      (*mockBuilders)[id]->clone(*durationDeclare, mockMapping[id]);
+    for (uint const id : localNodeIds(involvedNodes))
+      cloneToNode(id, *durationDeclare);
   }
 
   if (delayOp.getQubits().empty())
-    controllerBuilder->clone(*op, controllerMapping);
+    cloneToController(*op);
   // clone the delay op to the involved nodes
-  for (uint const nodeId : involvedNodes)
-    (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+  for (uint const nodeId : localNodeIds(involvedNodes))
+    cloneToNode(nodeId, *op);
 } // processOp DelayOp
 
-void mock::MockQubitLocalizationPass::processOp(
-    mlir::func::ReturnOp &returnOp) {
+void mock::MockQubitLocalizer::processOp(mlir::func::ReturnOp &returnOp) {
   Operation *op = returnOp.getOperation();
-  controllerBuilder->clone(*op, controllerMapping);
+  cloneToController(*op);
   FlatSymbolRefAttr const symbolRef = SymbolRefAttr::get(op->getParentOp());
   if (symbolRef && symbolRef.getLeafReference() == "main")
     for (auto arg : returnOp.getOperands())
       broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
   if (!classicalOnlyCheck(op->getParentOp()))
-    for (uint const nodeId : seenNodeIds)
-      (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+    for (uint const nodeId : localNodeIds(seenNodeIds))
+      cloneToNode(nodeId, *op);
 } // processOp ReturnOp
 
-void mock::MockQubitLocalizationPass::processOp(scf::YieldOp &yieldOp) {
+void mock::MockQubitLocalizer::processOp(scf::YieldOp &yieldOp) {
   Operation *op = yieldOp.getOperation();
   for (auto arg : yieldOp.getResults())
     broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
   // copy op to all nodes
-  controllerBuilder->clone(*op, controllerMapping);
+  cloneToController(*op);
   if (!classicalOnlyCheck(op->getParentOp()))
-    for (auto nodeId : seenNodeIds)
-      (*mockBuilders)[nodeId]->clone(*op, mockMapping[nodeId]);
+    for (auto nodeId : localNodeIds(seenNodeIds))
+      cloneToNode(nodeId, *op);
 } // processOp YieldOp
 
-void mock::MockQubitLocalizationPass::processOp(
-    scf::IfOp &ifOp,
-    std::deque<
-        std::tuple<Block *, OpBuilder *,
-                   std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-        &blockAndBuilderWorkList) {
+void mock::MockQubitLocalizer::processOp(
+    scf::IfOp &ifOp, BlockAndBuilderWorkList &blockAndBuilderWorkList) {
   Operation *op = ifOp.getOperation();
-  llvm::outs() << "Localizing an " << op->getName()
-               << " operation, recursing into subregions\n";
+  log() << "Localizing an " << op->getName()
+        << " operation, recursing into subregions\n";
 
   if (classicalOnlyCheck(op)) {
     // only classical ops, everything goes on controller
-    controllerBuilder->clone(*op, controllerMapping);
+    cloneToController(*op);
     return;
   }
 
-  llvm::outs() << "Found a quantum ifOp!\n";
+  log() << "Found a quantum ifOp!\n";
   // first broadcast the condition value from Controller to Mockss
   // then clone the if op everywhere but with empty blocks
-  auto newThenBuilders =
-      std::make_unique<std::unordered_map<uint, OpBuilder *>>();
-  auto newElseBuilders =
-      std::make_unique<std::unordered_map<uint, OpBuilder *>>();
+  llvm::SmallVector<uint, 1> conditionNodeIds = localNodeIds(seenNodeIds);
 
   // check if the condition is the result of a single measurement
   auto measureOp = ifOp.getCondition().getDefiningOp<MeasureOp>();
-  int savedQubitId = -1;
-  if (measureOp) { // remove the drive node from seenNodeIds temporarily
+  if (measureOp) { // the drive node does not receive the broadcast
     // only if it can be resolved
-    savedQubitId = lookupQubitId(measureOp.getQubits().front());
-    if (savedQubitId >= 0) {
-      seenNodeIds.erase(config->driveNode(savedQubitId));
+    int const qubitId = lookupQubitId(measureOp.getQubits().front());
+    if (qubitId >= 0) {
+      uint const driveNodeId = config->driveNode(qubitId);
+      llvm::erase_value(conditionNodeIds, driveNodeId);
 
       // receive the measurement result directly from the acquireNode
-      auto recvOp =
-          (*mockBuilders)[config->driveNode(savedQubitId)]->create<RecvOp>(
-              measureOp->getLoc(), TypeRange(ifOp.getCondition().getType()),
-              controllerBuilder->getIndexArrayAttr(
-                  config->acquireNode(savedQubitId)));
-      // map the result on the drive node
-      mockMapping[config->driveNode(savedQubitId)].map(
-          ifOp.getCondition(), recvOp.getVals().front());
+      if (localizesNode(driveNodeId)) {
+        auto recvOp = nodeBuilder.create<RecvOp>(
+            measureOp->getLoc(), TypeRange(ifOp.getCondition().getType()),
+            attributeBuilder.getIndexArrayAttr(config->acquireNode(qubitId)));
+        // map the result on the drive node
+        nodeMapping.map(ifOp.getCondition(), recvOp.getVals().front());
+      }
     }
   }
 
-  broadcastAndReceiveValue(ifOp.getCondition(), op->getLoc(), seenNodeIds);
-
-  // now restore the erased drive node id
-  if (measureOp && savedQubitId != -1)
-    seenNodeIds.emplace(config->driveNode(savedQubitId));
+  broadcastAndReceiveValue(ifOp.getCondition(), op->getLoc(),
+                           conditionNodeIds);
 
-  Operation *clonedOp =
-      controllerBuilder->cloneWithoutRegions(*op, controllerMapping);
-  auto clonedIfOp = dyn_cast<scf::IfOp>(clonedOp);
-  if (!ifOp.getThenRegion().empty()) {
-    cloneRegionWithoutOps(&ifOp.getThenRegion(), &clonedIfOp.getThenRegion(),
-                          controllerMapping);
-  }
-  if (!ifOp.getElseRegion().empty()) {
-    cloneRegionWithoutOps(&ifOp.getElseRegion(), &clonedIfOp.getElseRegion(),
-                          controllerMapping);
-  }
-  for (uint const nodeId : seenNodeIds) {
+  BlockToLocalize thenBlock{nullptr, {}, {}};
+  BlockToLocalize elseBlock{nullptr, {}, {}};
+  if (localizesController()) {
     Operation *clonedOp =
-        (*mockBuilders)[nodeId]->cloneWithoutRegions(*op, mockMapping[nodeId]);
+        controllerBuilder.cloneWithoutRegions(*op, controllerMapping);
     auto clonedIfOp = dyn_cast<scf::IfOp>(clonedOp);
     if (!ifOp.getThenRegion().empty()) {
       cloneRegionWithoutOps(&ifOp.getThenRegion(), &clonedIfOp.getThenRegion(),
-                            mockMapping[nodeId]);
-      newThenBuilders->emplace(nodeId,
-                               new OpBuilder(clonedIfOp.getThenRegion()));
+                            controllerMapping);
+      thenBlock.controller = regionStart(clonedIfOp.getThenRegion());
     }
     if (!ifOp.getElseRegion().empty()) {
       cloneRegionWithoutOps(&ifOp.getElseRegion(), &clonedIfOp.getElseRegion(),
-                            mockMapping[nodeId]);
-      newElseBuilders->emplace(nodeId,
-                               new OpBuilder(clonedIfOp.getElseRegion()));
+                            controllerMapping);
+      elseBlock.controller = regionStart(clonedIfOp.getElseRegion());
     }
-  } // for nodeId : seenNodeIds
+  }
+  if (!localNodeIds(seenNodeIds).empty()) {
+    Operation *clonedOp = nodeBuilder.cloneWithoutRegions(*op, nodeMapping);
+    auto clonedIfOp = dyn_cast<scf::IfOp>(clonedOp);
+    if (!ifOp.getThenRegion().empty()) {
+      cloneRegionWithoutOps(&ifOp.getThenRegion(), &clonedIfOp.getThenRegion(),
+                            nodeMapping);
+      thenBlock.node = regionStart(clonedIfOp.getThenRegion());
+    }
+    if (!ifOp.getElseRegion().empty()) {
+      cloneRegionWithoutOps(&ifOp.getElseRegion(), &clonedIfOp.getElseRegion(),
+                            nodeMapping);
+      elseBlock.node = regionStart(clonedIfOp.getElseRegion());
+    }
+  } // if the node localizes the if
   if (!ifOp.getThenRegion().empty()) {
-    llvm::outs() << "Pushing onto blockAndBuilderWorkList! Then region\n";
-    blockAndBuilderWorkList.emplace_back(
-        &ifOp.getThenRegion().getBlocks().front(),
-        new OpBuilder(clonedIfOp.getThenRegion()), std::move(newThenBuilders));
+    log() << "Pushing onto blockAndBuilderWorkList! Then region\n";
+    thenBlock.block = &ifOp.getThenRegion().getBlocks().front();
+    blockAndBuilderWorkList.push_back(thenBlock);
   }
   if (!ifOp.getElseRegion().empty()) {
-    llvm::outs() << "Pushing onto blockAndBuilderWorkList! Else region\n";
-    blockAndBuilderWorkList.emplace_back(
-        &ifOp.getElseRegion().getBlocks().front(),
-        new OpBuilder(clonedIfOp.getElseRegion()), std::move(newElseBuilders));
+    log() << "Pushing onto blockAndBuilderWorkList! Else region\n";
+    elseBlock.block = &ifOp.getElseRegion().getBlocks().front();
+    blockAndBuilderWorkList.push_back(elseBlock);
   }
 } // processOp scf::IfOp
 
-void mock::MockQubitLocalizationPass::processOp(
-    scf::ForOp &forOp,
-    std::deque<
-        std::tuple<Block *, OpBuilder *,
-                   std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-        &blockAndBuilderWorkList) {
+void mock::MockQubitLocalizer::processOp(
+    scf::ForOp &forOp, BlockAndBuilderWorkList &blockAndBuilderWorkList) {
   Operation *op = forOp.getOperation();
 
-  llvm::outs() << "Localizing an " << op->getName()
-               << " operation, recursing into subregions\n";
+  log() << "Localizing an " << op->getName()
+        << " operation, recursing into subregions\n";
   if (classicalOnlyCheck(op)) {
     // only classical ops, everything goes on controller
-    controllerBuilder->clone(*op, controllerMapping);
+    cloneToController(*op);
   } else { // else some quantum ops
-    llvm::outs() << "Found a quantum forOp!\n";
+    log() << "Found a quantum forOp!\n";
     // first broadcast the lb, ub, step, and init args
     // from Controller to Mockss then clone the for op everywhere
     // but with empty blocks
-    auto newBuilders =
-        std::make_unique<std::unordered_map<uint, OpBuilder *>>();
     broadcastAndReceiveValue(forOp.getLowerBound(), op->getLoc(), seenNodeIds);
     broadcastAndReceiveValue(forOp.getUpperBound(), op->getLoc(), seenNodeIds);
     broadcastAndReceiveValue(forOp.getStep(), op->getLoc(), seenNodeIds);
     for (auto arg : forOp.getInitArgs())
       broadcastAndReceiveValue(arg, op->getLoc(), seenNodeIds);
 
-    Operation *clonedOp =
-        controllerBuilder->cloneWithoutRegions(*op, controllerMapping);
-    auto clonedForOp = dyn_cast<scf::ForOp>(clonedOp);
-    cloneRegionWithoutOps(&forOp.getLoopBody(), &clonedForOp.getLoopBody(),
-                          controllerMapping);
-    for (uint const nodeId : seenNodeIds) {
-      Operation *clonedOp = (*mockBuilders)[nodeId]->cloneWithoutRegions(
-          *op, mockMapping[nodeId]);
+    BlockToLocalize body{&forOp.getLoopBody().getBlocks().front(), {}, {}};
+    if (localizesController()) {
+      Operation *clonedOp =
+          controllerBuilder.cloneWithoutRegions(*op, controllerMapping);
+      auto clonedForOp = dyn_cast<scf::ForOp>(clonedOp);
+      cloneRegionWithoutOps(&forOp.getLoopBody(), &clonedForOp.getLoopBody(),
+                            controllerMapping);
+      body.controller = regionStart(clonedForOp.getLoopBody());
+    }
+    if (!localNodeIds(seenNodeIds).empty()) {
+      Operation *clonedOp = nodeBuilder.cloneWithoutRegions(*op, nodeMapping);
       auto clonedFor = dyn_cast<scf::ForOp>(clonedOp);
       cloneRegionWithoutOps(&forOp.getLoopBody(), &clonedFor.getLoopBody(),
-                            mockMapping[nodeId]);
-      newBuilders->emplace(nodeId, new OpBuilder(clonedFor.getLoopBody()));
-    } // for nodeId : seenNodeIds
-    blockAndBuilderWorkList.emplace_back(
-        &forOp.getLoopBody().getBlocks().front(),
-        new OpBuilder(clonedForOp.getLoopBody()), std::move(newBuilders));
+                            nodeMapping);
+      body.node = regionStart(clonedFor.getLoopBody());
+    } // if the node localizes the for
+    blockAndBuilderWorkList.push_back(body);
   } // else some quantum ops
 } // processOp scf::ForOp
 
+LogicalResult mock::MockQubitLocalizer::localize(Operation *mainFunc) {
+  OpBuilder::InsertPoint const mainControllerPoint =
+      localizesController() ? regionStart(analysis.controllerMain.getBody())
+                            : OpBuilder::InsertPoint();
+  OpBuilder::InsertPoint const mainNodePoint =
+      nodeId ? regionStart(analysis.mockMains[*nodeId].getBody())
+             : OpBuilder::InsertPoint();
+
+  // refill the worklist
+  BlockAndBuilderWorkList blockAndBuilderWorkList;
+  for (Region &region : mainFunc->getRegions()) {
+    for (Block &block : region.getBlocks()) {
+      blockAndBuilderWorkList.push_back(
+          {&block, mainControllerPoint, mainNodePoint});
+    }
+  }
+
+  // the func and module ops are not localized themselves
+  using Dispatcher =
+      OpDispatcher<DeclareQubitOp, ResetQubitOp, Builtin_UOp, BuiltinCXOp,
+                   MeasureOp, CallSubroutineOp, CallGateOp, BarrierOp,
+                   CallDefCalGateOp, CallDefcalMeasureOp, DelayOp,
+                   DelayCyclesOp, mlir::func::ReturnOp, scf::YieldOp,
+                   scf::IfOp, scf::ForOp, mlir::func::FuncOp, ModuleOp>;
+
+  // blocks are pushed while iterating, so the items are copied and visited
+  // by index
+  for (size_t i = 0; i < blockAndBuilderWorkList.size(); ++i) {
+    log() << "Entering blockAndBuilderWorklist body!\n";
+    BlockToLocalize const item = blockAndBuilderWorkList[i];
+    Block *block = item.block;
+    controllerBuilder.restoreInsertionPoint(item.controller);
+    nodeBuilder.restoreInsertionPoint(item.node);
+    for (Operation &op : block->getOperations()) {
+      bool const dispatched =
+          Dispatcher::get().dispatch(&op, [&](auto castOp) {
+            using OpTy = decltype(castOp);
+            if constexpr (std::is_same_v<OpTy, CallSubroutineOp> ||
+                          std::is_same_v<OpTy, scf::IfOp> ||
+                          std::is_same_v<OpTy, scf::ForOp>)
+              processOp(castOp, blockAndBuilderWorkList);
+            else if constexpr (!std::is_same_v<OpTy, mlir::func::FuncOp> &&
+                               !std::is_same_v<OpTy, ModuleOp>)
+              processOp(castOp);
+          });
+      if (!dispatched) { // some classical op, should go to Controller
+        if (auto *clonedOp = cloneToController(op)) {
+          // now add mappping for all results from the original op to the
+          // clonedOp
+          for (uint index = 0; index < op.getNumResults(); ++index) {
+            controllerMapping.map(op.getResult(index),
+                                  clonedOp->getResult(index));
+          }
+        }
+      } // some classical op
+    }   // for Operations
+  } // for blockAndBuilderWorklist
+
+  return failure(failed);
+} // localize
+
 // Entry point for the pass.
 void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
   // This pass is only called on the top-level module Op
   Operation *moduleOp = getOperation();
-  config = &target.getConfig();
+  MockLocalizationAnalysis analysis;
+  analysis.config = &target.getConfig();
+  const MockConfig *config = analysis.config;
 
   ModuleOp topModuleOp = dyn_cast<ModuleOp>(moduleOp);
   Operation *mainFunc = getMainFunction(moduleOp);
@@ -742,164 +855,121 @@ void mock::MockQubitLocalizationPass::runOnOperation(MockSystem &target) {
 
   // Initialize the Controller Module
   auto b = OpBuilder::atBlockEnd(topModuleOp.getBody());
-  // ModuleOp test = ModuleOp::create(b.getUnknownLoc());
-  controllerModule = dyn_cast<ModuleOp>(
+  analysis.controllerModule = dyn_cast<ModuleOp>(
       b.create<ModuleOp>(b.getUnknownLoc(), llvm::StringRef("controller"))
           .getOperation());
-  mlir::func::FuncOp controllerMainOp =
+  ModuleOp controllerModule = analysis.controllerModule;
+  analysis.controllerMain =
       addMainFunction(controllerModule.getOperation(), mainFunc->getLoc());
-  controllerBuilder = new OpBuilder(controllerMainOp.getBody());
   controllerModule->setAttr(
       llvm::StringRef("quir.nodeId"),
-      controllerBuilder->getUI32IntegerAttr(config->controllerNode()));
-  controllerModule->setAttr(
-      llvm::StringRef("quir.nodeType"),
-      controllerBuilder->getStringAttr(llvm::StringRef("controller")));
-
-  // first work on creating the modules
-  // We do this first so that we can detect all physical qubit declarations
-  auto newBuilders = std::make_unique<std::unordered_map<uint, OpBuilder *>>();
+      b.getUI32IntegerAttr(config->controllerNode()));
+  controllerModule->setAttr(llvm::StringRef("quir.nodeType"),
+                            b.getStringAttr(llvm::StringRef("controller")));
+
+  // the nodes of the drives and acquires are indexed by their ids
+  uint numNodeIds = 0;
+  for (uint const nodeId : config->getDriveNodes())
+    numNodeIds = std::max(numNodeIds, nodeId + 1);
+  for (uint const nodeId : config->getAcquireNodes())
+    numNodeIds = std::max(numNodeIds, nodeId + 1);
+  analysis.mockModules.resize(numNodeIds, nullptr);
+  analysis.mockMains.resize(numNodeIds);
+  analysis.seenNodeIds.resize(numNodeIds);
+  analysis.acquireNodeIds.resize(numNodeIds);
+  analysis.driveNodeIds.resize(numNodeIds);
+  analysis.seenQubitIds.resize(config->getNumQubits() + 1);
+
+  // first detect all physical qubit declarations
+  mainFunc->walk([&](DeclareQubitOp qubitOp) {
+    llvm::outs() << qubitOp.getOperation()->getName()
+                 << " id: " << qubitOp.getId() << "\n";
+    if (!qubitOp.getId().has_value() ||
+        qubitOp.getId().value() > config->getNumQubits()) {
+      qubitOp->emitOpError()
+          << "Error! Found a qubit without an ID or with ID > "
+          << std::to_string(config->getNumQubits())
+          << " (the number of qubits in the config)"
+          << " during qubit localization!\n";
+      return signalPassFailure();
+    }
+    uint const qId = qubitOp.getId().value();
+    analysis.seenQubitIds.set(qId);
+    analysis.driveNodeIds.set(config->driveNode(qId));
+    analysis.acquireNodeIds.set(config->acquireNode(qId));
+    analysis.seenNodeIds.set(config->driveNode(qId));
+    analysis.seenNodeIds.set(config->acquireNode(qId));
+  });
 
+  // then create the modules of the nodes of these qubits only, the targets of
+  // the other nodes are not instantiated
   for (const auto &result : llvm::enumerate(config->getDriveNodes())) {
     uint const qubitIdx = result.index();
     uint const nodeId = result.value();
+    if (!analysis.driveNodeIds.test(nodeId))
+      continue;
     llvm::outs() << "Creating module for drive Mocks " << qubitIdx << "\n";
     auto driveMod = b.create<ModuleOp>(
         b.getUnknownLoc(),
         llvm::StringRef("mock_drive_" + std::to_string(qubitIdx)));
     driveMod.getOperation()->setAttr(
         llvm::StringRef("quir.nodeType"),
-        controllerBuilder->getStringAttr(llvm::StringRef("drive")));
-    driveMod.getOperation()->setAttr(
-        llvm::StringRef("quir.nodeId"),
-        controllerBuilder->getUI32IntegerAttr(nodeId));
-    driveMod.getOperation()->setAttr(
-        llvm::StringRef("quir.physicalId"),
-        controllerBuilder->getI32IntegerAttr(qubitIdx));
-    mockModules[nodeId] = driveMod.getOperation();
-    mlir::func::FuncOp mockMainOp =
+        b.getStringAttr(llvm::StringRef("drive")));
+    driveMod.getOperation()->setAttr(llvm::StringRef("quir.nodeId"),
+                                     b.getUI32IntegerAttr(nodeId));
+    driveMod.getOperation()->setAttr(llvm::StringRef("quir.physicalId"),
+                                     b.getI32IntegerAttr(qubitIdx));
+    analysis.mockModules[nodeId] = driveMod.getOperation();
+    analysis.mockMains[nodeId] =
         addMainFunction(driveMod.getOperation(), mainFunc->getLoc());
-    newBuilders->emplace(nodeId, new OpBuilder(mockMainOp.getBody()));
   }
 
   for (const auto &result : llvm::enumerate(config->getAcquireNodes())) {
     uint const acquireIdx = result.index();
     uint const nodeId = result.value();
+    if (!analysis.acquireNodeIds.test(nodeId))
+      continue;
     llvm::outs() << "Creating module for acquire Mocks " << acquireIdx << "\n";
     auto acquireMod = b.create<ModuleOp>(
         b.getUnknownLoc(),
         llvm::StringRef("mock_acquire_" + std::to_string(acquireIdx)));
     acquireMod.getOperation()->setAttr(
         llvm::StringRef("quir.nodeType"),
-        controllerBuilder->getStringAttr(llvm::StringRef("acquire")));
-    acquireMod.getOperation()->setAttr(
-        llvm::StringRef("quir.nodeId"),
-        controllerBuilder->getUI32IntegerAttr(nodeId));
+        b.getStringAttr(llvm::StringRef("acquire")));
+    acquireMod.getOperation()->setAttr(llvm::StringRef("quir.nodeId"),
+                                       b.getUI32IntegerAttr(nodeId));
     acquireMod.getOperation()->setAttr(
         llvm::StringRef("quir.physicalIds"),
-        controllerBuilder->getI32ArrayAttr(
-            ArrayRef<int>(config->acquireQubits(nodeId))));
-    mockModules[nodeId] = acquireMod.getOperation();
-    mlir::func::FuncOp mockMainOp =
+        b.getI32ArrayAttr(ArrayRef<int>(config->acquireQubits(nodeId))));
+    analysis.mockModules[nodeId] = acquireMod.getOperation();
+    analysis.mockMains[nodeId] =
         addMainFunction(acquireMod.getOperation(), mainFunc->getLoc());
-    newBuilders->emplace(nodeId, new OpBuilder(mockMainOp.getBody()));
-  }
-
-  mainFunc->walk([&](DeclareQubitOp qubitOp) {
-    llvm::outs() << qubitOp.getOperation()->getName()
-                 << " id: " << qubitOp.getId() << "\n";
-    if (!qubitOp.getId().has_value() ||
-        qubitOp.getId().value() > config->getNumQubits()) {
-      qubitOp->emitOpError()
-          << "Error! Found a qubit without an ID or with ID > "
-          << std::to_string(config->getNumQubits())
-          << " (the number of qubits in the config)"
-          << " during qubit localization!\n";
-      signalPassFailure();
-    }
-    uint const qId = qubitOp.getId().value();
-    seenQubitIds.emplace(qId);
-    driveNodeIds.emplace(config->driveNode(qId));
-    acquireNodeIds.emplace(config->acquireNode(qId));
-    seenNodeIds.emplace(config->driveNode(qId));
-    seenNodeIds.emplace(config->acquireNode(qId));
-  });
-
-  // refill the worklist
-  std::deque<std::tuple<Block *, OpBuilder *,
-                        std::unique_ptr<std::unordered_map<uint, OpBuilder *>>>>
-      blockAndBuilderWorkList;
-  for (Region &region : mainFunc->getRegions()) {
-    for (Block &block : region.getBlocks()) {
-      blockAndBuilderWorkList.emplace_back(&block, controllerBuilder,
-                                           std::move(newBuilders));
-    }
   }
 
-  while (!blockAndBuilderWorkList.empty()) {
-    llvm::outs() << "Entering blockAndBuilderWorklist body!\n";
-    Block *block = std::get<0>(blockAndBuilderWorkList.front());
-    controllerBuilder = std::get<1>(blockAndBuilderWorkList.front());
-    mockBuilders = std::get<2>(blockAndBuilderWorkList.front()).release();
-    blockAndBuilderWorkList.pop_front();
-    for (Operation &op : block->getOperations()) {
-      if (auto qubitOp = dyn_cast<DeclareQubitOp>(op)) {
-        processOp(qubitOp);
-      } else if (auto resetOp = dyn_cast<ResetQubitOp>(op)) {
-        processOp(resetOp);
-      } else if (auto uOp = dyn_cast<Builtin_UOp>(op)) {
-        processOp(uOp);
-      } else if (auto cxOp = dyn_cast<BuiltinCXOp>(op)) {
-        processOp(cxOp);
-      } else if (auto measureOp = dyn_cast<MeasureOp>(op)) {
-        processOp(measureOp);
-      } else if (auto callOp = dyn_cast<CallSubroutineOp>(op)) {
-        processOp(callOp, blockAndBuilderWorkList);
-      } else if (auto callOp = dyn_cast<CallGateOp>(op)) {
-        processOp(callOp);
-      } else if (auto callOp = dyn_cast<BarrierOp>(op)) {
-        processOp(callOp);
-      } else if (auto callOp = dyn_cast<CallDefCalGateOp>(op)) {
-        processOp(callOp);
-      } else if (auto callOp = dyn_cast<CallDefcalMeasureOp>(op)) {
-        processOp(callOp);
-      } else if (auto delayOp = dyn_cast<DelayOp>(op)) {
-        processOp(delayOp);
-      } else if (auto delayOp = dyn_cast<DelayCyclesOp>(op)) {
-        processOp(delayOp);
-      } else if (auto returnOp = dyn_cast<mlir::func::ReturnOp>(op)) {
-        processOp(returnOp);
-      } else if (auto yieldOp = dyn_cast<scf::YieldOp>(op)) {
-        processOp(yieldOp);
-      } else if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
-        processOp(ifOp, blockAndBuilderWorkList);
-      } else if (auto forOp = dyn_cast<scf::ForOp>(op)) {
-        processOp(forOp, blockAndBuilderWorkList);
-      } else if (dyn_cast<mlir::func::FuncOp>(op) || dyn_cast<ModuleOp>(op)) {
-        // do nothing
-      }      // moduleOp
-      else { // some classical op, should go to Controller
-        auto *clonedOp = controllerBuilder->clone(op, controllerMapping);
-        // now add mappping for all results from the original op to the
-        // clonedOp
-        for (uint index = 0; index < op.getNumResults(); ++index) {
-          controllerMapping.map(op.getResult(index),
-                                clonedOp->getResult(index));
-        }
-      } // some classical op
-    }   // for Operations
-    // delete the allocated opbuilders
-    delete controllerBuilder;
-    for (uint const nodeId : seenNodeIds)
-      delete (*mockBuilders)[nodeId];
-    delete mockBuilders;
-  } // while !blockAndBuilderWorklist.empty()
-
-  cloneVariableDeclarations(topModuleOp);
+  // Every node is localized independently from the shared analysis, the
+  // controller including the broadcasts to and receives from the other nodes.
+  // The localizers only modify the module of their node and may run
+  // concurrently.
+  std::vector<std::unique_ptr<MockQubitLocalizer>> localizers;
+  localizers.push_back(
+      std::make_unique<MockQubitLocalizer>(analysis, std::nullopt));
+  for (uint nodeId = 0; nodeId < analysis.mockModules.size(); ++nodeId)
+    if (analysis.mockModules[nodeId])
+      localizers.push_back(
+          std::make_unique<MockQubitLocalizer>(analysis, nodeId));
+
+  if (failed(failableParallelForEach(
+          &getContext(), localizers,
+          [&](const std::unique_ptr<MockQubitLocalizer> &localizer) {
+            return localizer->localize(mainFunc);
+          })))
+    signalPassFailure();
+
+  cloneVariableDeclarations(topModuleOp, controllerModule);
 } // runOnOperation()
 
 void mock::MockQubitLocalizationPass::cloneVariableDeclarations(
-    mlir::ModuleOp topModuleOp) {
+    mlir::ModuleOp topModuleOp, mlir::ModuleOp controllerModule) {
 
   mlir::OpBuilder controllerModuleBuilder(controllerModule.getBodyRegion());
 
@@ -27,21 +27,75 @@
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "HAL/TargetOperationPass.h"
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Support/LogicalResult.h"
 
-#include <deque>
-#include <unordered_map>
-#include <unordered_set>
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 namespace qssc::targets::systems::mock {
 
-struct MockQubitLocalizationPass
-    : public mlir::PassWrapper<MockQubitLocalizationPass,
-                               qssc::hal::TargetOperationPass<MockSystem>> {
+/// @brief The modules and qubit usage of a program shared by the localizers
+/// of all nodes. It is computed before localization and read-only during it.
+/// The nodes of the drives and acquires are indexed densely by their ids, of
+/// which there are about as many as qubits, and the controller separately.
+struct MockLocalizationAnalysis {
+  const MockConfig *config;
+  mlir::ModuleOp controllerModule;
+  mlir::func::FuncOp controllerMain;
+  std::vector<mlir::Operation *> mockModules; // by nodeId, null if unused
+  std::vector<mlir::func::FuncOp> mockMains;  // by nodeId
+  llvm::BitVector seenNodeIds;
+  llvm::BitVector seenQubitIds;
+  llvm::BitVector acquireNodeIds;
+  llvm::BitVector driveNodeIds;
+};
+
+/// @brief Localizes the main function of a program to the module of a single
+/// node. The controller's localizer emits the classical operations and the
+/// broadcasts of classical values, the localizers of the other nodes emit the
+/// operations their node owns and the matching receives. Every localizer
+/// walks the same read-only input in the same order, which keeps broadcasts
+/// and receives paired and lets the localizers of all nodes run concurrently.
+class MockQubitLocalizer {
+public:
+  /// @brief Create a localizer for a node.
+  /// @param analysis The analysis shared by the localizers of all nodes.
+  /// @param nodeId The node to localize to, or none for the controller.
+  MockQubitLocalizer(const MockLocalizationAnalysis &analysis,
+                     std::optional<uint> nodeId);
+
+  /// @brief Localize the main function into the node's module.
+  mlir::LogicalResult localize(mlir::Operation *mainFunc);
+
+private:
+  /// @brief A block of the input and where its operations are localized to,
+  /// the insertion points being unset if the controller or node of this
+  /// localizer does not localize the block. The builders of the localizer
+  /// are moved between the insertion points of the blocks, so that a block
+  /// costs no allocation.
+  struct BlockToLocalize {
+    mlir::Block *block;
+    mlir::OpBuilder::InsertPoint controller;
+    mlir::OpBuilder::InsertPoint node;
+  };
+  /// The blocks to localize, in the order they are found, which is the same
+  /// for all localizers.
+  using BlockAndBuilderWorkList = llvm::SmallVector<BlockToLocalize>;
 
   void processOp(mlir::quir::DeclareQubitOp &qubitOp);
   void processOp(mlir::quir::ResetQubitOp &resetOp);
@@ -49,12 +103,8 @@ struct MockQubitLocalizationPass
   void processOp(mlir::quir::Builtin_UOp &uOp);
   void processOp(mlir::quir::BuiltinCXOp &cxOp);
   void processOp(mlir::quir::MeasureOp &measureOp);
-  void
-  processOp(mlir::quir::CallSubroutineOp &callOp,
-            std::deque<std::tuple<
-                mlir::Block *, mlir::OpBuilder *,
-                std::unique_ptr<std::unordered_map<uint, mlir::OpBuilder *>>>>
-                &blockAndBuilderWorkList);
+  void processOp(mlir::quir::CallSubroutineOp &callOp,
+                 BlockAndBuilderWorkList &blockAndBuilderWorkList);
   void processOp(mlir::quir::CallGateOp &callOp);
   void processOp(mlir::quir::BarrierOp &callOp);
   void processOp(mlir::quir::CallDefCalGateOp &callOp);
@@ -63,46 +113,78 @@ struct MockQubitLocalizationPass
   void processOp(DelayOpType &delayOp);
   void processOp(mlir::func::ReturnOp &returnOp);
   void processOp(mlir::scf::YieldOp &yieldOp);
-  void
-  processOp(mlir::scf::IfOp &ifOp,
-            std::deque<std::tuple<
-                mlir::Block *, mlir::OpBuilder *,
-                std::unique_ptr<std::unordered_map<uint, mlir::OpBuilder *>>>>
-                &blockAndBuilderWorkList);
-  void
-  processOp(mlir::scf::ForOp &forOp,
-            std::deque<std::tuple<
-                mlir::Block *, mlir::OpBuilder *,
-                std::unique_ptr<std::unordered_map<uint, mlir::OpBuilder *>>>>
-                &blockAndBuilderWorkList);
+  void processOp(mlir::scf::IfOp &ifOp,
+                 BlockAndBuilderWorkList &blockAndBuilderWorkList);
+  void processOp(mlir::scf::ForOp &forOp,
+                 BlockAndBuilderWorkList &blockAndBuilderWorkList);
 
-  void runOnOperation(MockSystem &target) override;
   auto lookupQubitId(const mlir::Value &val) -> int;
+  /// Broadcast a value from the controller and receive it on the nodes of
+  /// this localizer among toNodeIds, see localNodeIds.
+  void broadcastAndReceiveValue(const mlir::Value &val,
+                                const mlir::Location &loc,
+                                const llvm::BitVector &toNodeIds);
   void broadcastAndReceiveValue(const mlir::Value &val,
                                 const mlir::Location &loc,
-                                const std::unordered_set<uint> &toNodeIds);
+                                llvm::ArrayRef<uint> toNodeIds);
   void cloneRegionWithoutOps(mlir::Region *from, mlir::Region *dest,
                              mlir::IRMapping &mapper);
   void cloneRegionWithoutOps(mlir::Region *from, mlir::Region *dest,
                              mlir::Region::iterator destPos,
                              mlir::IRMapping &mapper);
-  auto addMainFunction(mlir::Operation *moduleOperation,
-                       const mlir::Location &loc) -> mlir::func::FuncOp;
-  void cloneVariableDeclarations(mlir::ModuleOp topModuleOp);
 
-  MockConfig *config;
-  mlir::ModuleOp controllerModule;
-  mlir::IRMapping controllerMapping;
-  mlir::OpBuilder *controllerBuilder;
-  std::unordered_set<uint> seenNodeIds;
-  std::unordered_set<uint> seenQubitIds;
-  std::unordered_set<uint> acquireNodeIds;
-  std::unordered_set<uint> driveNodeIds;
+  /// Whether this localizer emits the controller's operations.
+  bool localizesController() const { return !nodeId.has_value(); }
+  /// Whether this localizer emits the operations of a node in the current
+  /// block.
+  bool localizesNode(uint id) const;
+  /// The ids among nodeIds of the nodes this localizer emits in the current
+  /// block.
+  llvm::SmallVector<uint, 1> localNodeIds(const llvm::BitVector &nodeIds) const;
+  llvm::SmallVector<uint, 1> localNodeIds(llvm::ArrayRef<uint> nodeIds) const;
+  /// Clone an op to the controller if localized by this localizer.
+  mlir::Operation *cloneToController(mlir::Operation &op);
+  /// Clone an op to a node if localized by this localizer.
+  mlir::Operation *cloneToNode(uint id, mlir::Operation &op);
+
+  /// Diagnostics and progress are only reported by the controller's
+  /// localizer as all localizers encounter the same input.
+  mlir::InFlightDiagnostic emitOpError(mlir::Operation *op);
+  auto classicalOnlyCheck(mlir::Operation *op) -> bool;
+  llvm::raw_ostream &log();
+  void signalPassFailure() { failed = true; }
 
+  const MockLocalizationAnalysis &analysis;
+  const MockConfig *config;
+  std::optional<uint> nodeId;
+  mlir::Builder attributeBuilder;
+  bool failed = false;
+
+  const llvm::BitVector &seenNodeIds; // of the analysis
+  mlir::IRMapping controllerMapping;
+  mlir::OpBuilder controllerBuilder;
   mlir::DenseSet<mlir::Value> alreadyBroadcastValues;
-  std::unordered_map<uint, mlir::Operation *> mockModules;   // one per nodeId
-  std::unordered_map<uint, mlir::OpBuilder *> *mockBuilders; // one per nodeId
-  std::unordered_map<uint, mlir::IRMapping> mockMapping;     // one per nodeId
+  /// The number of broadcasts so far, which identifies the next broadcast and
+  /// its receives in the modules of all nodes.
+  int64_t numMessages = 0;
+  llvm::StringSet<> clonedCallees;
+  mlir::IRMapping nodeMapping;
+  mlir::OpBuilder nodeBuilder;
+}; // class MockQubitLocalizer
+
+/// The attribute pairing a broadcast on the controller with the receives of
+/// its value on the other nodes after localization.
+constexpr llvm::StringLiteral messageIdAttrName = "mock.messageId";
+
+struct MockQubitLocalizationPass
+    : public mlir::PassWrapper<MockQubitLocalizationPass,
+                               qssc::hal::TargetOperationPass<MockSystem>> {
+
+  void runOnOperation(MockSystem &target) override;
+  auto addMainFunction(mlir::Operation *moduleOperation,
+                       const mlir::Location &loc) -> mlir::func::FuncOp;
+  void cloneVariableDeclarations(mlir::ModuleOp topModuleOp,
+                                 mlir::ModuleOp controllerModule);
 
   llvm::StringRef getArgument() const override;
   llvm::StringRef getDescription() const override;
@@ -0,0 +1,95 @@
+//===- RackPartitioning.cpp - Group instruments in racks --------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the pass for grouping the modules of the instruments
+//  of a localized module into the modules of their racks
+//
+//===----------------------------------------------------------------------===//
+
+#include "RackPartitioning.h"
+
+#include "MockTarget.h"
+
+#include "Dialect/QUIR/Utils/Utils.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <sys/types.h>
+#include <utility>
+
+using namespace mlir;
+namespace mock = qssc::targets::systems::mock;
+using namespace mock;
+
+void mock::MockRackPartitioningPass::runOnOperation(MockSystem &target) {
+  const MockConfig &config = target.getConfig();
+  if (!config.getInstrumentsPerRack())
+    return;
+  auto topModuleOp = dyn_cast<ModuleOp>(getOperation());
+  if (!topModuleOp)
+    return;
+
+  llvm::SmallVector<std::pair<ModuleOp, uint>> instrumentModules;
+  for (auto nodeModuleOp : topModuleOp.getBody()->getOps<ModuleOp>()) {
+    auto nodeType = nodeModuleOp->getAttrOfType<StringAttr>("quir.nodeType");
+    if (!nodeType ||
+        (nodeType.getValue() != "drive" && nodeType.getValue() != "acquire"))
+      continue;
+    auto nodeId = quir::getNodeId(nodeModuleOp);
+    if (auto err = nodeId.takeError()) {
+      nodeModuleOp->emitOpError() << toString(std::move(err));
+      return signalPassFailure();
+    }
+    instrumentModules.emplace_back(nodeModuleOp, *nodeId);
+  }
+
+  // the racks are created in the order of their first instrument
+  auto builder = OpBuilder::atBlockEnd(topModuleOp.getBody());
+  llvm::DenseMap<uint, ModuleOp> rackModules;
+  for (auto [nodeModuleOp, nodeId] : instrumentModules) {
+    uint const rackId = config.rackOf(nodeId);
+    ModuleOp &rackModuleOp = rackModules[rackId];
+    if (!rackModuleOp) {
+      rackModuleOp = builder.create<ModuleOp>(
+          builder.getUnknownLoc(),
+          llvm::StringRef("rack_" + std::to_string(rackId)));
+      rackModuleOp->setAttr("quir.nodeType", builder.getStringAttr("rack"));
+      rackModuleOp->setAttr("quir.nodeId", builder.getUI32IntegerAttr(rackId));
+    }
+    nodeModuleOp->moveBefore(rackModuleOp.getBody(),
+                             rackModuleOp.getBody()->end());
+  }
+} // runOnOperation()
+
+llvm::StringRef MockRackPartitioningPass::getArgument() const {
+  return "mock-rack-partitioning";
+}
+
+llvm::StringRef MockRackPartitioningPass::getDescription() const {
+  return "Group the modules of the instruments into the modules of their "
+         "racks.";
+}
+
+llvm::StringRef MockRackPartitioningPass::getName() const {
+  return "Mock Rack Partitioning Pass";
+}
@@ -0,0 +1,54 @@
+//===- RackPartitioning.h - Group instruments in racks ----------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the pass for grouping the modules of the instruments
+//  of a localized module into the modules of their racks
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MOCK_RACK_PARTITIONING_H
+#define MOCK_RACK_PARTITIONING_H
+
+#include "MockTarget.h"
+
+#include "HAL/TargetOperationPass.h"
+
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/StringRef.h"
+
+namespace qssc::targets::systems::mock {
+
+/// @brief Move the drive and acquire modules of a localized module into one
+/// module per rack when the configuration groups the instruments in racks,
+/// see MockConfig::getInstrumentsPerRack. The controller module stays a
+/// child of the top module. A rack module has quir.nodeType "rack" and the
+/// id of the rack as quir.nodeId, and is the module of a MockRack. It has to
+/// run after the passes of the system which nest on the node modules.
+struct MockRackPartitioningPass
+    : public mlir::PassWrapper<MockRackPartitioningPass,
+                               qssc::hal::TargetOperationPass<MockSystem>> {
+
+  void runOnOperation(MockSystem &target) override;
+
+  llvm::StringRef getArgument() const override;
+  llvm::StringRef getDescription() const override;
+  llvm::StringRef getName() const override;
+}; // struct MockRackPartitioningPass
+
+} // namespace qssc::targets::systems::mock
+
+#endif // MOCK_RACK_PARTITIONING_H
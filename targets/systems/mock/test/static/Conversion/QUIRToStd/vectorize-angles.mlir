@@ -0,0 +1,56 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --pass-pipeline='builtin.module(mock-quir-to-std{vectorize-angles=true})' %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-quir-to-std %s | FileCheck %s --check-prefix SCALAR
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --pass-pipeline='builtin.module(mock-quir-to-std{vectorize-angles=true})' --emit=qem --plaintext-payload | FileCheck %s --check-prefix LLVM
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// SCALAR-NOT: vector.
+// LLVM: define {{.*}} @phases(
+// LLVM: add <3 x i32>
+// LLVM: and <3 x i32>
+
+module @controller attributes {quir.nodeId = 1000 : ui32, quir.nodeType = "controller"} {
+  // CHECK-LABEL: func.func @phases(
+  // CHECK-SAME: %[[P0:[a-z0-9]+]]: i32, %[[P1:[a-z0-9]+]]: i32, %[[P2:[a-z0-9]+]]: i32, %[[S:[a-z0-9]+]]: i32
+  func.func @phases(%p0: !quir.angle<20>, %p1: !quir.angle<20>, %p2: !quir.angle<20>, %step: !quir.angle<20>) -> (!quir.angle<20>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>) {
+    // the first layer is independent, with a common step
+    // CHECK: %[[LHS:.*]] = vector.insertelement %[[P2]]
+    // CHECK: %[[RHS:.*]] = vector.broadcast %[[S]] : i32 to vector<3xi32>
+    // CHECK: %[[SUM:.*]] = arith.addi %[[LHS]], %[[RHS]] : vector<3xi32>
+    // CHECK: %[[MASK:.*]] = arith.constant dense<1048575> : vector<3xi32>
+    // CHECK: %[[WRAPPED:.*]] = arith.andi %[[SUM]], %[[MASK]] : vector<3xi32>
+    // CHECK: %[[A0:.*]] = vector.extractelement %[[WRAPPED]]
+    // CHECK: %[[A1:.*]] = vector.extractelement %[[WRAPPED]]
+    // CHECK: %[[A2:.*]] = vector.extractelement %[[WRAPPED]]
+    %a0 = oq3.angle_add %p0, %step : !quir.angle<20>
+    %a1 = oq3.angle_add %p1, %step : !quir.angle<20>
+    %a2 = oq3.angle_add %p2, %step : !quir.angle<20>
+    // the second layer uses the first one, and is computed before the first
+    // use of its results
+    // CHECK-NOT: arith.muli {{.*}} : i32
+    // CHECK: %[[C:.*]] = arith.subi %[[A2]], %[[S]] : i32
+    // CHECK: llvm.and %[[C]]
+    // CHECK: vector.insertelement %[[A0]]
+    // CHECK: arith.muli %{{.*}}, %{{.*}} : vector<2xi32>
+    // CHECK: return
+    %b0 = oq3.angle_mul %a0, %a1 : !quir.angle<20>
+    %b1 = oq3.angle_mul %a1, %a2 : !quir.angle<20>
+    // a single operation is left scalar
+    %c = oq3.angle_sub %a2, %step : !quir.angle<20>
+    return %b0, %b1, %c, %a0 : !quir.angle<20>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  }
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,97 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --pass-pipeline='builtin.module(mock-quir-to-std{vectorize-loops=true})' %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-quir-to-std %s | FileCheck %s --check-prefix SCALAR
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --pass-pipeline='builtin.module(mock-quir-to-std{vectorize-loops=true})' --emit=qem --plaintext-payload | FileCheck %s --check-prefix LLVM
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// SCALAR-NOT: affine.for
+// SCALAR-NOT: vector.
+// LLVM: define {{.*}} @syndromes(
+// LLVM: xor <4 x i8>
+
+module @controller attributes {quir.nodeId = 1000 : ui32, quir.nodeType = "controller"} {
+  memref.global "private" @data : memref<9xi8> = dense<0>
+  memref.global "private" @syndrome : memref<8xi8> = dense<0>
+  memref.global "private" @flags : memref<8xi1> = dense<false>
+
+  // CHECK-LABEL: func.func @syndromes()
+  func.func @syndromes() {
+    %data = memref.get_global @data : memref<9xi8>
+    %syndrome = memref.get_global @syndrome : memref<8xi8>
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c8 = arith.constant 8 : index
+    // the syndromes of neighbouring data bits are computed 4 at a time
+    // CHECK: affine.for %[[I:.*]] = 0 to 8 step 4 {
+    // CHECK: %[[LHS:.*]] = vector.load %{{.*}}[%[[I]]] : memref<9xi8>, vector<4xi8>
+    // CHECK: %[[RHS:.*]] = vector.load %{{.*}} : memref<9xi8>, vector<4xi8>
+    // CHECK: %[[S:.*]] = arith.xori %[[LHS]], %[[RHS]] : vector<4xi8>
+    // CHECK: vector.store %[[S]], %{{.*}}[%[[I]]] : memref<8xi8>, vector<4xi8>
+    scf.for %i = %c0 to %c8 step %c1 {
+      %next = arith.addi %i, %c1 : index
+      %lhs = memref.load %data[%i] : memref<9xi8>
+      %rhs = memref.load %data[%next] : memref<9xi8>
+      %s = arith.xori %lhs, %rhs : i8
+      memref.store %s, %syndrome[%i] : memref<8xi8>
+    }
+    return
+  }
+
+  // CHECK-LABEL: func.func @prefix()
+  func.func @prefix() {
+    %syndrome = memref.get_global @syndrome : memref<8xi8>
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    // each iteration uses the store of the previous one
+    // CHECK: affine.for %{{.*}} = 0 to 4 {
+    // CHECK-NOT: vector.
+    // CHECK: return
+    scf.for %i = %c0 to %c4 step %c1 {
+      %next = arith.addi %i, %c1 : index
+      %lhs = memref.load %syndrome[%i] : memref<8xi8>
+      %rhs = memref.load %syndrome[%next] : memref<8xi8>
+      %s = arith.xori %lhs, %rhs : i8
+      memref.store %s, %syndrome[%next] : memref<8xi8>
+    }
+    return
+  }
+
+  // CHECK-LABEL: func.func @flags()
+  func.func @flags() {
+    %syndrome = memref.get_global @syndrome : memref<8xi8>
+    %flags = memref.get_global @flags : memref<8xi1>
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c8 = arith.constant 8 : index
+    %zero = arith.constant 0 : i8
+    // vectors of i1 are packed in memory, unlike memrefs of i1
+    // CHECK: scf.for
+    // CHECK-NOT: vector.
+    // CHECK: return
+    scf.for %i = %c0 to %c8 step %c1 {
+      %s = memref.load %syndrome[%i] : memref<8xi8>
+      %flag = arith.cmpi ne, %s, %zero : i8
+      memref.store %flag, %flags[%i] : memref<8xi1>
+    }
+    return
+  }
+
+  func.func @main() -> i32 attributes {quir.classicalOnly = false} {
+    call @syndromes() : () -> ()
+    call @prefix() : () -> ()
+    call @flags() : () -> ()
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,47 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-conversion %s | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+oq3.declare_variable @theta : !quir.angle<20>
+oq3.declare_variable @phi : !quir.angle<20>
+oq3.declare_variable @lambda : !quir.angle<20>
+
+func.func @main () -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+
+  quir.reset %q1 : !quir.qubit<1>
+  %theta = oq3.variable_load @theta : !quir.angle<20>
+  %phi = oq3.variable_load @phi : !quir.angle<20>
+  %lambda = oq3.variable_load @lambda : !quir.angle<20>
+  quir.builtin_U %q0, %theta, %phi, %lambda : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// The angles are only sent to the drive of q0, in a single message.
+// CHECK-LABEL: module @controller
+// CHECK:         [[THETA:%.*]] = oq3.variable_load @theta
+// CHECK:         [[PHI:%.*]] = oq3.variable_load @phi
+// CHECK:         [[LAMBDA:%.*]] = oq3.variable_load @lambda
+// CHECK-NEXT:    qcs.send [[THETA]], [[PHI]], [[LAMBDA]] to 1 : !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+// CHECK-NOT:     qcs.broadcast
+// CHECK-LABEL: module @mock_drive_0
+// CHECK:         [[ANGLES:%.*]]:3 = qcs.recv {fromIds = [1000 : index, 1000 : index, 1000 : index]} : !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+// CHECK-NOT:     qcs.recv
+// CHECK:         quir.builtin_U %{{.*}}, [[ANGLES]]#0, [[ANGLES]]#1, [[ANGLES]]#2
+// CHECK-LABEL: module @mock_drive_1
+// CHECK-NOT:     qcs.recv
+// CHECK-LABEL: module @mock_acquire_0
+// CHECK-NOT:     qcs.recv
+// CHECK-NOT:     mock.messageId
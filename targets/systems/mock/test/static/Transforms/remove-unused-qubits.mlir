@@ -0,0 +1,31 @@
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-conversion %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --target mock --config %TEST_CFG --mock-conversion --mock-remove-idle-qubits %s | FileCheck %s --check-prefix IDLE
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The instruments of unused qubits get no modules.
+// CHECK: module @mock_drive_0
+// CHECK: module @mock_drive_1
+// CHECK-NOT: module @mock_drive_2
+// IDLE: module @mock_drive_0
+// IDLE-NOT: module @mock_drive_1
+// IDLE-NOT: module @mock_drive_2
+func.func @main() -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  quir.reset %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  %c0 = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
@@ -0,0 +1,38 @@
+// RUN: echo '{"schemaVersion": 1, "num_qubits": 4, "acquire_multiplexing_ratio_to_1": 2, "controllerNodeId": 1000}' > %t.json
+// RUN: qss-compiler %s --target mock --config %t.json --emit=mlir | FileCheck %s --check-prefix JSON
+// RUN: printf 'QSSCCFG\000\001\000\000\000\003\000\000\000\005\000\000\000\350\003\000\000' > %t.bin
+// RUN: qss-compiler %s --target mock --config %t.bin --emit=mlir | FileCheck %s --check-prefix BINARY
+// RUN: echo '{"schemaVersion": 2, "num_qubits": 4}' > %t.bad.json
+// RUN: not qss-compiler %s --target mock --config %t.bad.json --emit=mlir 2>&1 | FileCheck %s --check-prefix BAD-VERSION
+// RUN: echo 'num_qubits 4 acquire_multiplexing_ratio_to_1 0 controllerNodeId 1000' > %t.bad.cfg
+// RUN: not qss-compiler %s --target mock --config %t.bad.cfg --emit=mlir 2>&1 | FileCheck %s --check-prefix BAD-RATIO
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that the mock configuration is loaded from its JSON and binary forms
+// as well as from text.
+func.func @main () -> i32 {
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// JSON: Config:
+// JSON-NEXT: num_qubits 4
+// JSON-NEXT: multiplexing_ratio 2
+
+// BINARY: Config:
+// BINARY-NEXT: num_qubits 3
+// BINARY-NEXT: multiplexing_ratio 5
+
+// BAD-VERSION: Unsupported configuration schemaVersion 2, expected 1
+
+// BAD-RATIO: acquire_multiplexing_ratio_to_1 must be at least 1
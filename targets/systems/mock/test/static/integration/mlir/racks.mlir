@@ -0,0 +1,46 @@
+// RUN: echo '{"schemaVersion": 1, "num_qubits": 4, "acquire_multiplexing_ratio_to_1": 2, "controllerNodeId": 1000, "instruments_per_rack": 3}' > %t.json
+// RUN: qss-compiler -X=mlir --target mock --config %t.json --mock-conversion --mock-rack-partitioning %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --target mock --config %t.json --emit=qem --plaintext-payload %s | FileCheck %s --check-prefix PAYLOAD
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that the instruments are grouped in racks of three nodes, the nodes
+// of each acquire and the qubits it multiplexes being numbered in turn, and
+// that each rack emits the manifest of its instruments.
+func.func @main () -> i32 {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  %q3 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+  %a0 = quir.constant #quir.angle<1.57079632679> : !quir.angle<20>
+  quir.builtin_U %q0, %a0, %a0, %a0 : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  quir.builtin_U %q1, %a0, %a0, %a0 : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  quir.builtin_U %q2, %a0, %a0, %a0 : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  quir.builtin_U %q3, %a0, %a0, %a0 : !quir.qubit<1>, !quir.angle<20>, !quir.angle<20>, !quir.angle<20>
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// CHECK: module @controller
+// CHECK: module @rack_0 attributes {quir.nodeId = 0 : ui32, quir.nodeType = "rack"} {
+// CHECK-NEXT: module @mock_drive_0
+// CHECK: module @mock_drive_1
+// CHECK: module @mock_acquire_0
+// CHECK: module @rack_1 attributes {quir.nodeId = 1 : ui32, quir.nodeType = "rack"} {
+// CHECK-NEXT: module @mock_drive_2
+// CHECK: module @mock_drive_3
+// CHECK: module @mock_acquire_1
+
+// PAYLOAD-DAG: MockRack_0.json
+// PAYLOAD-DAG: MockRack_1.json
+// PAYLOAD-DAG: "name": "mock_drive_0"
+// PAYLOAD-DAG: "name": "mock_acquire_1"
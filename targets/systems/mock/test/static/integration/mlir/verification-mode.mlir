@@ -0,0 +1,39 @@
+// Redirect stderr (where timing is printed to) to stdout and then stdout to filecheck
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --canonicalize --verification-mode=boundaries --mlir-timing --mlir-disable-threading 2>&1 >/dev/null | FileCheck %s
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --canonicalize --mlir-timing --mlir-disable-threading 2>&1 >/dev/null | FileCheck %s --check-prefix=PASSES
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Modules are only verified at the boundaries of the compilation stages.
+func.func @main () -> i32 {
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
+
+// CHECK: command-line-passes
+// CHECK:   Canonicalizer
+// CHECK:   verify
+// CHECK: compile-system
+// CHECK:   MockSystem
+// CHECK:     passes
+// CHECK:       Canonicalizer
+// CHECK:       verify
+// CHECK:     emit-to-payload
+// CHECK:     children
+// CHECK:       MockController
+// CHECK:         passes
+// CHECK:           verify
+// CHECK:         emit-to-payload
+
+// PASSES: command-line-passes
+// PASSES-NOT: verify
+// PASSES: compile-system
@@ -0,0 +1,41 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false --mock-controller-opt-level=2 --mock-controller-codegen-threads=2 | FileCheck %s
+// RUN: rm -rf %t && qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false --mock-controller-object-cache-dir=%t | FileCheck %s --check-prefix=CACHE
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false --mock-controller-object-cache-dir=%t | FileCheck %s --check-prefix=CACHE
+// RUN: ls %t | FileCheck %s --check-prefix=ENTRY
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: Manifest
+// CHECK: controller.1.bin
+// CHECK: controller.bin
+// CHECK: llvmModule.ll
+
+// CACHE: Manifest
+// CACHE-NOT: controller.1.bin
+// CACHE: controller.bin
+// CACHE: llvmModule.ll
+
+// ENTRY-COUNT-1: {{[0-9a-f]+}}-0.o
+qubit $0;
+qubit $1;
+
+gate cx control, target { }
+
+bit c0;
+bit c1;
+
+U(1.57079632679, 0.0, 3.14159265359) $0;
+cx $0, $1;
+measure $0 -> c0;
+measure $1 -> c1;
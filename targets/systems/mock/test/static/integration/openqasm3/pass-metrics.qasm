@@ -0,0 +1,42 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits=false -o %t.qem --pass-metrics-report=%t.txt && FileCheck %s --check-prefix=TABLE < %t.txt
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits=false -o %t.qem --pass-metrics-report=%t.json --pass-metrics-format=json && FileCheck %s --check-prefix=JSON < %t.json
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// TABLE: Pass metrics report
+// TABLE: Runs Ops dOps Symbols dSymbols dRSS(KiB) dAlloc(KiB) Pipeline: Pass
+// TABLE: MockSystem: Canonicalizer
+// TABLE: MockSystem: Mock Controller Conversion Pass
+
+// JSON: "runs": [
+// JSON: "after": {
+// JSON: "allocatedBytes":
+// JSON: "ops":
+// JSON: "residentBytes":
+// JSON: "symbols":
+// JSON: "before": {
+// JSON: "failed": false,
+// JSON: "op": "builtin.module",
+// JSON: "pass": "Canonicalizer",
+// JSON: "pipeline": "MockSystem"
+// JSON: "pass": "Mock Controller Conversion Pass",
+qubit $0;
+qubit $1;
+
+gate cx control, target { }
+
+bit c0;
+U(1.57079632679, 0.0, 3.14159265359) $0;
+cx $0, $1;
+measure $0 -> c0;
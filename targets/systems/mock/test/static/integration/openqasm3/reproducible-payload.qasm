@@ -0,0 +1,39 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits=false --mlir-disable-threading -o %t.serial.qem
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits=false -o %t.threaded.qem
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits=false --stream-payload -o %t.streamed.qem
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --enable-circuits=false --stream-payload --mlir-disable-threading -o %t.streamed.serial.qem
+// RUN: diff %t.serial.qem %t.threaded.qem
+// RUN: diff %t.serial.qem %t.streamed.qem
+// RUN: diff %t.serial.qem %t.streamed.serial.qem
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Payloads are byte-identical whether the targets are compiled and emitted
+// in parallel or not.
+qubit $0;
+qubit $1;
+qubit $2;
+
+gate cx control, target { }
+
+bit c0;
+bit c1;
+U(1.57079632679, 0.0, 3.14159265359) $0;
+cx $0, $1;
+cx $1, $2;
+c0 = measure $0;
+c1 = measure $2;
+if (c0) {
+  U(0.0, 0.0, 3.14159265359) $1;
+}
@@ -0,0 +1,52 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// A switch is a single multi-way branch on the controller. Cases which do
+// nothing branch straight to the end of the switch, the others through a
+// single block each.
+
+// CHECK: File: llvmModule.ll
+// CHECK: switch i32 %{{.*}}, label %[[DEFAULT:[0-9]+]] [
+// CHECK-NEXT: i32 1, label %[[CASE1:[0-9]+]]
+// CHECK-NEXT: i32 2, label %[[END:[0-9]+]]
+// CHECK-NEXT: i32 3, label %[[END]]
+// CHECK-NEXT: i32 5, label %[[CASE5:[0-9]+]]
+// CHECK-NEXT: ]
+// CHECK-DAG: br label %[[END]]
+
+qubit $0;
+int i = 15;
+int j = 0;
+
+switch (i) {
+    case 1: {
+        j = 1;
+    }
+    break;
+    case 2: {
+    }
+    break;
+    case 3: {
+    }
+    break;
+    case 5: {
+        j = 5;
+    }
+    break;
+    default: {
+        j = 2;
+    }
+    break;
+}
@@ -0,0 +1,28 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --target mock --config %TEST_CFG --emit=qem --plaintext-payload --enable-circuits=false | FileCheck %s
+
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Only the targets of the nodes of the qubits the program uses are built.
+// CHECK: Manifest
+// CHECK: MockAcquire_0.mlir
+// CHECK: MockController.mlir
+// CHECK-NOT: MockDrive_0.mlir
+// CHECK: MockDrive_1.mlir
+// CHECK: controller.bin
+qubit $1;
+
+bit c0;
+
+U(1.57079632679, 0.0, 3.14159265359) $1;
+measure $1 -> c0;
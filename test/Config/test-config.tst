@@ -1,6 +1,9 @@
 // RUN: qss-compiler --target Mock --config path/to/config --allow-unregistered-dialect=false \
-// RUN:          --add-target-passes=false --verbosity=info --show-config | FileCheck %s --check-prefix CLI
+// RUN:          --add-target-passes=false --verbosity=info --num-shots=10 --shot-delay=2ms \
+// RUN:          -I path/to/include -I path/to/other/include --qasm-streaming --qasm-locations=lines \
+// RUN:          --num-threads=4 --cpu-affinity=0,2 --numa-node=1 --show-config | FileCheck %s --check-prefix CLI
 // RUN: QSSC_TARGET_NAME="MockEnv" QSSC_TARGET_CONFIG_PATH="path/to/config/Env" QSSC_VERBOSITY=DEBUG \
+// RUN:          QSSC_COMPILE_CACHE_DIR="path/to/cache/Env" \
 // RUN:          qss-compiler --allow-unregistered-dialect=false --add-target-passes=false --show-config | FileCheck %s --check-prefix ENV
 // REQUIRES: !asserts
 
@@ -20,6 +23,29 @@
 // CLI: includeSource: 0
 // CLI: compileTargetIR: 0
 // CLI: bypassPayloadTargetCompilation: 0
+// CLI: streamPayload: 0
+// CLI: splitPayload: 0
+// CLI: payloadCompression: store
+// CLI: payloadCompressionLevel: 0
+// CLI: payloadDebugArtifacts: text
+// CLI: payloadBlobStore: None
+// CLI: compileCache: 0
+// CLI: parametricTemplates: 0
+// CLI: compileCacheDir: None
+// CLI: passMetricsReport: None
+// CLI: passMetricsFormat: table
+// CLI: passPipeline: None
+// CLI: numThreads: 4
+// CLI: cpuAffinity: 0 2
+// CLI: numaNode: 1
+
+// CLI: numShots: 10
+// CLI: shotDelay: 2ms
+// CLI: includeDirs: path/to/include path/to/other/include
+// CLI: gateLibraries:
+// CLI: cacheQASMIncludes: 0
+// CLI: streamQASM: 1
+// CLI: qasmLocations: lines
 
 // CLI: allowUnregisteredDialects: 0
 // CLI: dumpPassPipeline: 0
@@ -38,4 +64,9 @@
 // ENV: targetConfigPath: path/to/config/Env
 // ENV: verbosity: Debug
 // ENV: addTargetPasses: 0
+// ENV: compileCache: 1
+// ENV: compileCacheDir: path/to/cache/Env
+// ENV: numThreads: None
+// ENV: numShots: 1000
+// ENV: shotDelay: 1ms
 // ENV: allowUnregisteredDialects: 0
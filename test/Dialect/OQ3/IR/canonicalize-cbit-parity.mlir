@@ -0,0 +1,74 @@
+// RUN: qss-opt %s --canonicalize | qss-opt | FileCheck %s
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// This test verifies that the parity of bits of a register computed bit by
+// bit is folded into the population count of the masked register.
+
+// CHECK: func.func @parity(%[[ARG0:.*]]: !quir.cbit<8>) -> i1 {
+func.func @parity(%reg: !quir.cbit<8>) -> i1 {
+  // CHECK: %[[MASK:.*]] = arith.constant 13 : i8
+  // CHECK: %[[CAST:.*]] = "oq3.cast"(%[[MASK]]) : (i8) -> !quir.cbit<8>
+  // CHECK: %[[AND:.*]] = oq3.cbit_and %[[ARG0]], %[[CAST]] : !quir.cbit<8>
+  // CHECK: %[[COUNT:.*]] = oq3.cbit_popcount %[[AND]] : (!quir.cbit<8>) -> i8
+  // CHECK: %[[PARITY:.*]] = oq3.cbit_extractbit(%[[COUNT]] : i8) [0] : i1
+  // CHECK-NOT: oq3.cbit_xor
+  // CHECK: return %[[PARITY]] : i1
+  %0 = oq3.cbit_extractbit(%reg : !quir.cbit<8>) [0] : i1
+  %1 = oq3.cbit_extractbit(%reg : !quir.cbit<8>) [2] : i1
+  %2 = oq3.cbit_extractbit(%reg : !quir.cbit<8>) [3] : i1
+  %3 = oq3.cbit_xor %0, %1 : i1
+  %4 = oq3.cbit_xor %3, %2 : i1
+  return %4 : i1
+}
+
+// CHECK: func.func @full_parity(%[[ARG0:.*]]: !quir.cbit<3>) -> i1 {
+func.func @full_parity(%reg: !quir.cbit<3>) -> i1 {
+  // CHECK-NOT: oq3.cbit_and
+  // CHECK: %[[COUNT:.*]] = oq3.cbit_popcount %[[ARG0]] : (!quir.cbit<3>) -> i3
+  // CHECK: %[[PARITY:.*]] = oq3.cbit_extractbit(%[[COUNT]] : i3) [0] : i1
+  // CHECK: return %[[PARITY]] : i1
+  %0 = oq3.cbit_extractbit(%reg : !quir.cbit<3>) [0] : i1
+  %1 = oq3.cbit_extractbit(%reg : !quir.cbit<3>) [1] : i1
+  %2 = oq3.cbit_extractbit(%reg : !quir.cbit<3>) [2] : i1
+  %3 = oq3.cbit_xor %0, %1 : i1
+  %4 = oq3.cbit_xor %2, %3 : i1
+  return %4 : i1
+}
+
+// CHECK: func.func @cancelled(%{{.*}}: !quir.cbit<4>) -> i1 {
+func.func @cancelled(%reg: !quir.cbit<4>) -> i1 {
+  // CHECK: %[[FALSE:.*]] = arith.constant false
+  // CHECK: return %[[FALSE]] : i1
+  %0 = oq3.cbit_extractbit(%reg : !quir.cbit<4>) [1] : i1
+  %1 = oq3.cbit_extractbit(%reg : !quir.cbit<4>) [1] : i1
+  %2 = oq3.cbit_extractbit(%reg : !quir.cbit<4>) [2] : i1
+  %3 = oq3.cbit_extractbit(%reg : !quir.cbit<4>) [2] : i1
+  %4 = oq3.cbit_xor %0, %1 : i1
+  %5 = oq3.cbit_xor %2, %3 : i1
+  %6 = oq3.cbit_xor %4, %5 : i1
+  return %6 : i1
+}
+
+// CHECK: func.func @mixed_registers
+func.func @mixed_registers(%reg0: !quir.cbit<4>, %reg1: !quir.cbit<4>) -> i1 {
+  // CHECK-NOT: oq3.cbit_popcount
+  // CHECK: oq3.cbit_xor
+  // CHECK: oq3.cbit_xor
+  %0 = oq3.cbit_extractbit(%reg0 : !quir.cbit<4>) [0] : i1
+  %1 = oq3.cbit_extractbit(%reg1 : !quir.cbit<4>) [1] : i1
+  %2 = oq3.cbit_extractbit(%reg0 : !quir.cbit<4>) [2] : i1
+  %3 = oq3.cbit_xor %0, %1 : i1
+  %4 = oq3.cbit_xor %3, %2 : i1
+  return %4 : i1
+}
@@ -60,6 +60,10 @@ pulse.sequence @test_pulse_ops (%p0: !pulse.port, %p1: !pulse.port, %f0: !pulse.
     // CHECK %{{.*}} = pulse.const_waveform(%c160_i32, %[[ARG3]]) : (i32, complex<f64>) -> !pulse.waveform
     %kernel_waveform = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
     // CHECK %[[KERNELWAVEFORM:.*]] = pulse.create_waveform dense<[[0.000000e+00, 5.000000e-01], [5.000000e-01, 5.000000e-01], [5.000000e-01, 0.000000e+00]]> : tensor<3x2xf64> -> !pulse.waveform
+    %kernel_codes = pulse.create_waveform {scale = 1.0e-04 : f64} dense<[[0, 5000], [5000, 5000], [5000, 0]]> : tensor<3x2xi16> -> !pulse.waveform
+    // CHECK: pulse.create_waveform {scale = 1.000000e-04 : f64} dense<{{\[}}[0, 5000], [5000, 5000], [5000, 0]]> : tensor<3x2xi16> -> !pulse.waveform
+    %kernel_half = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.0]]> : tensor<2x2xf16> -> !pulse.waveform
+    // CHECK: pulse.create_waveform dense<{{\[}}[0.000000e+00, 5.000000e-01], [5.000000e-01, 0.000000e+00]]> : tensor<2x2xf16> -> !pulse.waveform
 
     %mf1 = "pulse.mix_frame"(%p0) {uid = "mf1-p0"} : (!pulse.port) -> !pulse.mixed_frame
     // CHECK: %{{.*}}   = "pulse.mix_frame"(%[[ARG0]]) {uid = "mf1-p0"} : (!pulse.port) -> !pulse.mixed_frame
@@ -106,6 +110,8 @@ pulse.sequence @test_pulse_ops (%p0: !pulse.port, %p1: !pulse.port, %f0: !pulse.
     // CHECK %[[KERNEL:.*]] = pulse.create_kernel(%[[KERNELWAVEFORM]]) : (!pulse.waveform) -> !pulse.kernel
     %res0 = pulse.capture(%mf0) : (!pulse.mixed_frame) -> i1
     // CHECK %[[RESULT:.*]] = pulse.capture(%[[ARG1]]) : (!pulse.mixed_frame) -> i1
+    %mux:2 = pulse.multiplexed_capture(%mf0, %f0) : (!pulse.mixed_frame, !pulse.frame) -> (i1, i1)
+    // CHECK: %{{.*}}:2 = pulse.multiplexed_capture(%{{.*}}, %{{.*}}) : (!pulse.mixed_frame, !pulse.frame) -> (i1, i1)
 
     pulse.return %res0, %res0: i1, i1
     // CHECK pulse.return %[[RESULT]], %[[RESULT]] : i1, i1
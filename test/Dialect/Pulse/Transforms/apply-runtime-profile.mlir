@@ -0,0 +1,105 @@
+// RUN: echo '{"sequences": {"x_0": 200, "circuit_0": 300, "other": 1}, "branches": {"prog.qasm:10:5": [10, 990], "prog.qasm:14:5": [5, 900, 95], "prog.qasm:22:5": [1]}}' > %t.json
+// RUN: qss-compiler -X=mlir --pulse-apply-runtime-profile='profile=%t.json' %s 2>&1 | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-apply-runtime-profile='profile=%t.json' --quantum-circuit-pulse-scheduling %s | FileCheck %s --check-prefix=SCHED
+// RUN: qss-compiler -X=mlir --pulse-apply-runtime-profile='profile=%t.json' --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+// RUN: not qss-compiler -X=mlir --pulse-apply-runtime-profile='profile=%t.missing.json' %s 2>&1 | FileCheck %s --check-prefix=MISSING
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: warning: runtime profile has 1 branch counts for 2 regions, ignoring them
+
+// MISSING: error: Failed to read the runtime profile: Failed to open
+
+// STATS: 2 num-branches-profiled
+// STATS: 1 num-branches-swapped
+// STATS: 2 num-sequences-profiled
+
+module {
+  func.func @main(%flag: i32) {
+    %port0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %frame0 = "pulse.mix_frame"(%port0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %port1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+    %frame1 = "pulse.mix_frame"(%port1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+
+    // The circuit is measured to take longer than its gates, the calls of
+    // which keep their timepoints.
+    // SCHED: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 300 : i64, pulse.timepoint = 200 : i64}
+    %m = pulse.call_sequence @circuit_0(%frame0, %frame1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> i1
+
+    // The hot else region is laid out first.
+    // CHECK: %[[TRUE:.*]] = arith.constant true
+    // CHECK: %[[NOT:.*]] = arith.xori %{{.*}}, %[[TRUE]] : i1
+    // CHECK: scf.if %[[NOT]] {
+    // CHECK-NEXT: pulse.call_sequence @x_1
+    // CHECK: } else {
+    // CHECK-NEXT: pulse.call_sequence @x_0
+    // CHECK: } {quir.branchCounts = array<i64: 990, 10>}
+    scf.if %m {
+      %0 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+    } else {
+      %1 = pulse.call_sequence @x_1(%frame1) : (!pulse.mixed_frame) -> i1
+    } loc("prog.qasm":10:5)
+
+    // The regions of a switch keep their order, which its lowering lays out
+    // by count.
+    // CHECK: quir.branchCounts = array<i64: 5, 900, 95>
+    quir.switch %flag {
+      quir.yield
+    } [
+      1: {
+        %2 = pulse.call_sequence @x_1(%frame1) : (!pulse.mixed_frame) -> i1
+        quir.yield
+      }
+      2: {
+        %3 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+        quir.yield
+      }
+    ] loc("prog.qasm":14:5)
+
+    // The counts of a conditional must match its regions.
+    // CHECK: scf.if %{{.*}} {
+    // CHECK-NOT: quir.branchCounts
+    // CHECK: return
+    scf.if %m {
+      %4 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+    } loc("prog.qasm":22:5)
+    return
+  }
+
+  // SCHED-LABEL: pulse.sequence @circuit_0
+  // SCHED: pulse.call_sequence @x_0{{.*}}pulse.timepoint = -200 : i64
+  // SCHED: pulse.call_sequence @x_1{{.*}}pulse.timepoint = -160 : i64
+  // CHECK-LABEL: pulse.sequence @circuit_0
+  // CHECK-SAME: pulse.measuredDuration = 300 : i64
+  pulse.sequence @circuit_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1 {
+    %0 = pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> i1
+    %1 = pulse.call_sequence @x_1(%arg1) : (!pulse.mixed_frame) -> i1
+    pulse.return %1 : i1
+  }
+
+  // The measured duration of a gate lengthens its nominal duration.
+  // CHECK-LABEL: pulse.sequence @x_0
+  // CHECK-SAME: pulse.measuredDuration = 200 : i64
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+
+  // CHECK-LABEL: pulse.sequence @x_1
+  // CHECK-NOT: pulse.measuredDuration
+  pulse.sequence @x_1(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p1"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+}
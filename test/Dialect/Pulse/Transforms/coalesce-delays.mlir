@@ -0,0 +1,90 @@
+// RUN: qss-compiler -X=mlir --coalesce-delays %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --coalesce-delays --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 1 : i32}) {
+    quir.call_gate @x(%arg0) : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+
+  // CHECK-LABEL: func.func @qubit_delays()
+  func.func @qubit_delays() {
+    // CHECK: [[Q0:%.*]] = quir.declare_qubit {id = 0 : i32}
+    // CHECK: [[Q1:%.*]] = quir.declare_qubit {id = 1 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %dur1 = quir.constant #quir.duration<100.0> : !quir.duration<dt>
+    %dur2 = quir.constant #quir.duration<60.0> : !quir.duration<dt>
+    %dur3 = quir.constant #quir.duration<20.0> : !quir.duration<ns>
+
+    // The delays on q0 are merged across the circuit on q1.
+    // CHECK: [[SUM:%.*]] = quir.constant #quir.duration<1.600000e+02> : !quir.duration<dt>
+    // CHECK-NEXT: quir.delay [[SUM]], ([[Q0]])
+    // CHECK-NEXT: quir.call_circuit @circuit_0([[Q1]])
+    // CHECK-NOT: quir.delay {{.*}}!quir.duration<dt>
+    quir.delay %dur1, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+    quir.call_circuit @circuit_0(%q1) : (!quir.qubit<1>) -> ()
+    quir.delay %dur2, (%q0) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+
+    // Delays in other units, or separated by an operation on the same qubit
+    // or a barrier are kept.
+    // CHECK: quir.delay %{{.*}}, ([[Q0]]) : !quir.duration<ns>
+    // CHECK-NEXT: quir.call_gate @x([[Q0]])
+    // CHECK-NEXT: quir.delay %{{.*}}, ([[Q0]]) : !quir.duration<ns>
+    // CHECK-NEXT: quir.barrier [[Q1]]
+    // CHECK-NEXT: quir.delay %{{.*}}, ([[Q0]]) : !quir.duration<ns>
+    quir.delay %dur3, (%q0) : !quir.duration<ns>, (!quir.qubit<1>) -> ()
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    quir.delay %dur3, (%q0) : !quir.duration<ns>, (!quir.qubit<1>) -> ()
+    quir.barrier %q1 : (!quir.qubit<1>) -> ()
+    quir.delay %dur3, (%q0) : !quir.duration<ns>, (!quir.qubit<1>) -> ()
+
+    // CHECK: qcs.delay_cycles([[Q1]]) {time = 300 : i64}
+    // CHECK-NEXT: quir.call_gate @x([[Q0]])
+    // CHECK-NEXT: return
+    qcs.delay_cycles (%q1) {time = 100 : i64} : (!quir.qubit<1>) -> ()
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    qcs.delay_cycles (%q1) {time = 200 : i64} : (!quir.qubit<1>) -> ()
+    return
+  }
+
+  // CHECK-LABEL: pulse.sequence @frame_delays(
+  pulse.sequence @frame_delays(%mf0: !pulse.mixed_frame, %mf1: !pulse.mixed_frame) -> i1 {
+    %c6_i32 = arith.constant 6 : i32
+    %c12_i32 = arith.constant 12 : i32
+
+    // The delays on %mf0 are merged across the sequence on %mf1 only.
+    // CHECK: [[C18:%.*]] = arith.constant 18 : i32
+    // CHECK-NEXT: pulse.delay(%arg0, [[C18]])
+    // CHECK-NEXT: pulse.call_sequence @seq_0(%arg1)
+    // CHECK-NEXT: pulse.call_sequence @seq_0(%arg0)
+    // CHECK-NEXT: pulse.delay(%arg0, %{{.*}})
+    // CHECK-NEXT: pulse.return
+    pulse.delay(%mf0, %c6_i32) : (!pulse.mixed_frame, i32)
+    %0 = pulse.call_sequence @seq_0(%mf1) : (!pulse.mixed_frame) -> i1
+    pulse.delay(%mf0, %c12_i32) : (!pulse.mixed_frame, i32)
+    %1 = pulse.call_sequence @seq_0(%mf0) : (!pulse.mixed_frame) -> i1
+    pulse.delay(%mf0, %c6_i32) : (!pulse.mixed_frame, i32)
+    pulse.return %1 : i1
+  }
+
+  pulse.sequence @seq_0(%arg0: !pulse.mixed_frame) -> i1 {
+    %c0_i1 = arith.constant 0 : i1
+    pulse.return %c0_i1 : i1
+  }
+}
+
+// STATS: 3 num-delays-coalesced
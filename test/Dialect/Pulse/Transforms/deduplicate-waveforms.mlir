@@ -0,0 +1,81 @@
+// RUN: qss-compiler -X=mlir --pulse-deduplicate-waveforms %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK-LABEL: func.func @main
+func.func @main() -> i32 {
+    %port = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %frame = "pulse.mix_frame"(%port) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+
+    // CHECK: %[[X90:.*]] = pulse.create_waveform {pulse.waveformName = "X90_0"}
+    // CHECK-NOT: pulse.waveformName = "X90_1"
+    // CHECK: %[[Y90:.*]] = pulse.create_waveform {pulse.waveformName = "Y90_0"}
+    %x90_0 = pulse.create_waveform {pulse.waveformName = "X90_0"} dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    %x90_1 = pulse.create_waveform {pulse.waveformName = "X90_1"} dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    %y90_0 = pulse.create_waveform {pulse.waveformName = "Y90_0"} dense<[[0.1, 0.5], [0.7, 0.5], [0.1, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+
+    // Parametric waveforms are compared by the values of their constant
+    // parameters.
+    %dur = arith.constant 160 : i32
+    %dur1 = arith.constant 160 : i32
+    %sigma = arith.constant 40 : i32
+    %dur2 = arith.constant 320 : i32
+    %amp_re = arith.constant 0.1 : f64
+    %amp_im = arith.constant 0.0 : f64
+    %amp = complex.create %amp_re, %amp_im : complex<f64>
+    %beta = arith.constant 0.5 : f64
+    // CHECK: %[[DRAG:.*]] = pulse.drag
+    // CHECK: %[[GAUSS:.*]] = pulse.gaussian
+    // CHECK: %[[GAUSS2:.*]] = pulse.gaussian
+    // CHECK-NOT: pulse.drag
+    // CHECK-NOT: pulse.gaussian
+    %drag_0 = pulse.drag(%dur, %amp, %sigma, %beta) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+    %gauss_0 = pulse.gaussian(%dur, %amp, %sigma) : (i32, complex<f64>, i32) -> !pulse.waveform
+    %gauss_1 = pulse.gaussian(%dur2, %amp, %sigma) : (i32, complex<f64>, i32) -> !pulse.waveform
+    %drag_1 = pulse.drag(%dur1, %amp, %sigma, %beta) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+
+    // CHECK: pulse.call_sequence @seq_0(%[[X90]], %[[X90]], %[[Y90]], %[[DRAG]], %[[DRAG]], %[[GAUSS]], %[[GAUSS2]], %{{.*}})
+    %res = pulse.call_sequence @seq_0(%x90_0, %x90_1, %y90_0, %drag_0, %drag_1, %gauss_0, %gauss_1, %frame) : (!pulse.waveform, !pulse.waveform, !pulse.waveform, !pulse.waveform, !pulse.waveform, !pulse.waveform, !pulse.waveform, !pulse.mixed_frame) -> i1
+
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+}
+
+// CHECK-LABEL: pulse.sequence @seq_0
+pulse.sequence @seq_0(%wfr0: !pulse.waveform, %wfr1: !pulse.waveform, %wfr2: !pulse.waveform, %wfr3: !pulse.waveform, %wfr4: !pulse.waveform, %wfr5: !pulse.waveform, %wfr6: !pulse.waveform, %frame: !pulse.mixed_frame) -> i1 {
+    // Waveforms of a sequence are not replaced by those of main.
+    // CHECK: %[[SEQ_X90:.*]] = pulse.create_waveform
+    // CHECK-NOT: pulse.create_waveform
+    %x90_0 = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    %x90_1 = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    // CHECK: pulse.play(%arg7, %[[SEQ_X90]])
+    // CHECK: pulse.play(%arg7, %[[SEQ_X90]])
+    pulse.play(%frame, %x90_0) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.play(%frame, %x90_1) : (!pulse.mixed_frame, !pulse.waveform)
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+// Kernels are shared once their weights are.
+// CHECK-LABEL: func.func @kernels
+func.func @kernels() -> (!pulse.kernel, !pulse.kernel) {
+    // CHECK: %[[WEIGHTS:.*]] = pulse.create_waveform
+    // CHECK-NEXT: %[[KERNEL:.*]] = pulse.create_kernel(%[[WEIGHTS]])
+    // CHECK-NEXT: return %[[KERNEL]], %[[KERNEL]]
+    %weights_0 = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    %weights_1 = pulse.create_waveform dense<[[0.0, 0.5], [0.5, 0.5], [0.5, 0.0]]> : tensor<3x2xf64> -> !pulse.waveform
+    %kernel_0 = pulse.create_kernel(%weights_0) : (!pulse.waveform) -> !pulse.kernel
+    %kernel_1 = pulse.create_kernel(%weights_1) : (!pulse.waveform) -> !pulse.kernel
+    return %kernel_0, %kernel_1 : !pulse.kernel, !pulse.kernel
+}
@@ -0,0 +1,36 @@
+// RUN: qss-compiler -X=mlir --pulse-eliminate-barriers %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK-LABEL: pulse.sequence @sequence(
+// CHECK-SAME: [[F0:%[a-z0-9]+]]: !pulse.mixed_frame, [[F1:%[a-z0-9]+]]: !pulse.mixed_frame, [[F2:%[a-z0-9]+]]: !pulse.mixed_frame
+pulse.sequence @sequence(%f0: !pulse.mixed_frame, %f1: !pulse.mixed_frame, %f2: !pulse.mixed_frame, %wfr: !pulse.waveform) -> i1 {
+    // CHECK-NOT: pulse.barrier [[F0]] :
+    pulse.barrier %f0 : !pulse.mixed_frame
+    pulse.play(%f0, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    // the second barrier aligns f0 and f1 again, and f2 is idle between
+    // them
+    // CHECK: pulse.play([[F0]]
+    // CHECK-NEXT: pulse.barrier [[F0]], [[F1]], [[F2]] :
+    // CHECK-NEXT: pulse.play([[F1]]
+    // CHECK-NEXT: pulse.barrier [[F0]], [[F1]] :
+    // CHECK-NEXT: pulse.play([[F0]]
+    pulse.barrier %f0, %f1, %f2 : !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame
+    pulse.play(%f1, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.barrier %f0, %f1, %f2 : !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame
+    pulse.play(%f0, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.barrier %f0, %f1, %f2 : !pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame
+    %false = arith.constant false
+    pulse.return %false : i1
+}
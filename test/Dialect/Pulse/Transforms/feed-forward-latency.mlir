@@ -0,0 +1,134 @@
+// RUN: qss-compiler -X=mlir --pulse-feed-forward-latency='hop-latency=50' %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-feed-forward-latency --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The calls after the measurement add up to the latency of the first
+// conditional.
+// CHECK: "conditionals": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "exact": true,
+// CHECK-NEXT: "function": "main",
+// CHECK-NEXT: "latency": 260,
+// CHECK-NEXT: "loc": "{{.*}}feed-forward-latency.mlir:{{[0-9]+}}:{{[0-9]+}}",
+// CHECK-NEXT: "op": "scf.if",
+// CHECK-NEXT: "sources": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "callee": "measure_0",
+// CHECK-NEXT: "exact": true,
+// CHECK-NEXT: "hops": 0,
+// CHECK-NEXT: "latency": 260,
+// CHECK-NEXT: "loc": "{{.*}}",
+// CHECK-NEXT: "op": "pulse.call_sequence"
+// CHECK-NEXT: }
+// CHECK-NEXT: ]
+// CHECK-NEXT: },
+
+// The received value is charged the hop latency, while the latency of the
+// measurement is not exact across the calls nested in the first conditional.
+// CHECK-NEXT: {
+// CHECK-NEXT: "exact": false,
+// CHECK-NEXT: "function": "main",
+// CHECK-NEXT: "latency": 420,
+// CHECK-NEXT: "loc": "{{.*}}",
+// CHECK-NEXT: "op": "quir.switch",
+// CHECK-NEXT: "sources": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "exact": true,
+// CHECK-NEXT: "hops": 1,
+// CHECK-NEXT: "latency": 50,
+// CHECK-NEXT: "loc": "{{.*}}",
+// CHECK-NEXT: "op": "qcs.recv"
+// CHECK-NEXT: },
+// CHECK-NEXT: {
+// CHECK-NEXT: "callee": "measure_0",
+// CHECK-NEXT: "exact": false,
+// CHECK-NEXT: "hops": 0,
+// CHECK-NEXT: "latency": 420,
+
+// The measurement is followed through the variable it is assigned to.
+// CHECK: "exact": true,
+// CHECK-NEXT: "function": "main",
+// CHECK-NEXT: "latency": 160,
+// CHECK-NEXT: "loc": "{{.*}}",
+// CHECK-NEXT: "op": "scf.if",
+
+// The conditional on an argument is not reported.
+// CHECK-NOT: "op": "scf.if"
+// CHECK: func.func @main
+
+// STATS: 3 num-conditionals
+
+module {
+  oq3.declare_variable @b : i1
+
+  func.func @main(%arg0: i1) {
+    %port0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %frame0 = "pulse.mix_frame"(%port0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %port1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+    %frame1 = "pulse.mix_frame"(%port1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+
+    %m = pulse.call_sequence @measure_0(%frame0) : (!pulse.mixed_frame) -> i1
+    %0 = pulse.call_sequence @x_1(%frame1) : (!pulse.mixed_frame) -> i1
+    %1 = pulse.call_sequence @delay_1(%frame1) {pulse.duration = 100 : i64} : (!pulse.mixed_frame) -> i1
+    scf.if %m {
+      %2 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+    }
+
+    %r = qcs.recv {fromId = [0 : index]} : i1
+    %and = arith.andi %m, %r : i1
+    %flag = arith.extui %and : i1 to i32
+    quir.switch %flag {
+      quir.yield
+    } [
+      1: {
+        %3 = pulse.call_sequence @x_1(%frame1) : (!pulse.mixed_frame) -> i1
+        quir.yield
+      }
+    ]
+
+    %m2 = pulse.call_sequence @measure_0(%frame0) : (!pulse.mixed_frame) -> i1
+    oq3.variable_assign @b : i1 = %m2
+    %4 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+    %b = oq3.variable_load @b : i1
+    scf.if %b {
+      %5 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+    }
+
+    scf.if %arg0 {
+      %6 = pulse.call_sequence @x_0(%frame0) : (!pulse.mixed_frame) -> i1
+    }
+    return
+  }
+
+  pulse.sequence @measure_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0"], pulse.duration = 400 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+
+  pulse.sequence @x_1(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p1"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+
+  pulse.sequence @delay_1(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p1"]} {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+}
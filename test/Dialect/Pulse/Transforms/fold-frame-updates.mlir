@@ -0,0 +1,75 @@
+// RUN: qss-compiler -X=mlir --pulse-fold-frame-updates %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-fold-frame-updates --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS: 6 num-updates-folded
+
+// CHECK-LABEL: pulse.sequence @virtual_z(
+// CHECK-SAME: %[[FRAME:[A-Za-z0-9]+]]: !pulse.mixed_frame,
+// CHECK-SAME: %[[OTHER:[A-Za-z0-9]+]]: !pulse.mixed_frame,
+// CHECK-SAME: %[[WFR:[A-Za-z0-9]+]]: !pulse.waveform,
+// CHECK-SAME: %[[THETA:[A-Za-z0-9]+]]: f64)
+pulse.sequence @virtual_z(%frame: !pulse.mixed_frame, %other: !pulse.mixed_frame, %wfr: !pulse.waveform, %theta: f64) -> i1 {
+    %a = arith.constant 0.25 : f64
+    %b = arith.constant 0.5 : f64
+    %c = arith.constant 1.0 : f64
+    %f = arith.constant 1.0e+03 : f64
+    %dur = arith.constant 10 : i32
+    %false = arith.constant false
+    // The shifts are summed across the play on another frame and the
+    // frequency update.
+    // CHECK-NOT: pulse.shift_phase
+    // CHECK: pulse.play(%[[OTHER]], %[[WFR]])
+    // CHECK-NEXT: pulse.shift_frequency(%[[FRAME]]
+    // CHECK-NEXT: %[[SUM:.*]] = arith.constant 1.750000e+00 : f64
+    // CHECK-NEXT: pulse.shift_phase(%[[FRAME]], %[[SUM]])
+    // CHECK-NEXT: pulse.play(%[[FRAME]], %[[WFR]])
+    pulse.shift_phase(%frame, %a) : (!pulse.mixed_frame, f64)
+    pulse.play(%other, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.shift_phase(%frame, %b) : (!pulse.mixed_frame, f64)
+    pulse.shift_frequency(%frame, %f) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%frame, %c) : (!pulse.mixed_frame, f64)
+    pulse.play(%frame, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+
+    // A set drops the updates before it and absorbs the shifts after it.
+    // CHECK-NEXT: %[[SET:.*]] = arith.constant 7.500000e-01 : f64
+    // CHECK-NEXT: pulse.set_phase(%[[FRAME]], %[[SET]])
+    // CHECK-NEXT: pulse.delay(%[[FRAME]]
+    pulse.shift_phase(%frame, %c) : (!pulse.mixed_frame, f64)
+    pulse.set_phase(%frame, %b) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%frame, %a) : (!pulse.mixed_frame, f64)
+    pulse.delay(%frame, %dur) : (!pulse.mixed_frame, i32)
+
+    // Frequency updates are only folded at the same timepoint.
+    // CHECK-NEXT: pulse.set_frequency {pulse.timepoint = 10 : i64}(%[[FRAME]]
+    // CHECK-NEXT: %[[FREQ:.*]] = arith.constant 2.000000e+03 : f64
+    // CHECK-NEXT: pulse.shift_frequency {pulse.timepoint = 20 : i64}(%[[FRAME]], %[[FREQ]])
+    // CHECK-NEXT: pulse.play(%[[FRAME]], %[[WFR]])
+    pulse.set_frequency {pulse.timepoint = 10 : i64} (%frame, %f) : (!pulse.mixed_frame, f64)
+    pulse.shift_frequency {pulse.timepoint = 20 : i64} (%frame, %f) : (!pulse.mixed_frame, f64)
+    pulse.shift_frequency {pulse.timepoint = 20 : i64} (%frame, %f) : (!pulse.mixed_frame, f64)
+    pulse.play(%frame, %wfr) : (!pulse.mixed_frame, !pulse.waveform)
+
+    // Updates by values which are not constant are kept, unless set again.
+    // CHECK-NEXT: pulse.shift_phase(%[[FRAME]], %[[THETA]])
+    // CHECK-NEXT: pulse.shift_phase(%[[FRAME]], %{{.*}})
+    // CHECK-NEXT: pulse.set_phase(%[[OTHER]], %[[THETA]])
+    // CHECK-NEXT: pulse.return
+    pulse.shift_phase(%frame, %theta) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%frame, %a) : (!pulse.mixed_frame, f64)
+    pulse.shift_phase(%other, %a) : (!pulse.mixed_frame, f64)
+    pulse.set_phase(%other, %theta) : (!pulse.mixed_frame, f64)
+    pulse.return %false : i1
+}
@@ -0,0 +1,48 @@
+// RUN: qss-compiler -X=mlir --pulse-merge-captures %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-merge-captures --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS: 3 num-captures-merged
+
+// CHECK-LABEL: pulse.sequence @measure(
+// CHECK-SAME: %[[M0:[A-Za-z0-9]+]]: !pulse.mixed_frame,
+// CHECK-SAME: %[[M1:[A-Za-z0-9]+]]: !pulse.mixed_frame,
+// CHECK-SAME: %[[M2:[A-Za-z0-9]+]]: !pulse.mixed_frame,
+// CHECK-SAME: %[[M3:[A-Za-z0-9]+]]: !pulse.mixed_frame)
+pulse.sequence @measure(%m0: !pulse.mixed_frame, %m1: !pulse.mixed_frame, %m2: !pulse.mixed_frame, %m3: !pulse.mixed_frame) -> (i1, i1, i1, i1) attributes {pulse.argPorts = ["m0", "m0", "m0", "m1"]} {
+    // The captures of the frames of port m0 at timepoint 100 are merged,
+    // the captures of another port or at another timepoint are not.
+    // CHECK: %[[MUX:.*]]:3 = pulse.multiplexed_capture {pulse.timepoint = 100 : i64}(%[[M0]], %[[M1]], %[[M2]]) : (!pulse.mixed_frame, !pulse.mixed_frame, !pulse.mixed_frame) -> (i1, i1, i1)
+    // CHECK-NEXT: %[[C3:.*]] = pulse.capture {pulse.timepoint = 100 : i64}(%[[M3]])
+    // CHECK-NEXT: %[[LATE:.*]] = pulse.capture {pulse.timepoint = 200 : i64}(%[[M1]])
+    // CHECK-NOT: pulse.capture
+    // CHECK: pulse.return %[[MUX]]#0, %[[MUX]]#2, %[[C3]], %[[LATE]]
+    %0 = pulse.capture {pulse.timepoint = 100 : i64} (%m0) : (!pulse.mixed_frame) -> i1
+    %1 = pulse.capture {pulse.timepoint = 100 : i64} (%m1) : (!pulse.mixed_frame) -> i1
+    %3 = pulse.capture {pulse.timepoint = 100 : i64} (%m3) : (!pulse.mixed_frame) -> i1
+    %4 = pulse.capture {pulse.timepoint = 200 : i64} (%m1) : (!pulse.mixed_frame) -> i1
+    %2 = pulse.capture {pulse.timepoint = 100 : i64} (%m2) : (!pulse.mixed_frame) -> i1
+    pulse.return {pulse.timepoint = 200 : i64} %0, %2, %3, %4 : i1, i1, i1, i1
+}
+
+// Captures are only merged in sequences with pulse.argPorts.
+// CHECK-LABEL: pulse.sequence @no_ports
+pulse.sequence @no_ports(%m0: !pulse.mixed_frame, %m1: !pulse.mixed_frame) -> (i1, i1) {
+    // CHECK: pulse.capture
+    // CHECK: pulse.capture
+    %0 = pulse.capture {pulse.timepoint = 0 : i64} (%m0) : (!pulse.mixed_frame) -> i1
+    %1 = pulse.capture {pulse.timepoint = 0 : i64} (%m1) : (!pulse.mixed_frame) -> i1
+    pulse.return %0, %1 : i1, i1
+}
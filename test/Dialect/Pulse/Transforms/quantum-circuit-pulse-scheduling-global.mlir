@@ -0,0 +1,73 @@
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling=global-scheduling=true %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling %s | FileCheck %s --check-prefix=CIRCUIT
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+func.func private @barrier() -> ()
+
+func.func @main() -> i32 {
+    %port0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %frame0 = "pulse.mix_frame"(%port0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %port1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+    %frame1 = "pulse.mix_frame"(%port1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+    // the circuits on p1 and p0 run in parallel, and the one on both ports
+    // starts when p0 is free, as its gate on p1 only starts after 160
+    // CHECK: pulse.call_sequence @circuit_1{{.*}}{pulse.duration = 0 : i64, pulse.timepoint = 160 : i64}
+    // CHECK: pulse.call_sequence @circuit_2{{.*}}{pulse.duration = 160 : i64, pulse.timepoint = 160 : i64}
+    // CHECK: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 560 : i64, pulse.timepoint = 560 : i64}
+    // CIRCUIT: pulse.call_sequence @circuit_1{{.*}}{pulse.duration = 160 : i64, pulse.timepoint = 160 : i64}
+    // CIRCUIT: pulse.call_sequence @circuit_2{{.*}}{pulse.duration = 160 : i64, pulse.timepoint = 160 : i64}
+    // CIRCUIT: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 560 : i64, pulse.timepoint = 560 : i64}
+    %0 = pulse.call_sequence @circuit_1(%frame1) : (!pulse.mixed_frame) -> i1
+    %1 = pulse.call_sequence @circuit_2(%frame0) : (!pulse.mixed_frame) -> i1
+    %2 = pulse.call_sequence @circuit_0(%frame0, %frame1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    // the calls do not overlap across operations with side effects
+    // CHECK: call @barrier()
+    // CHECK-NEXT: pulse.call_sequence @circuit_2{{.*}}{pulse.duration = 160 : i64, pulse.timepoint = 160 : i64}
+    call @barrier() : () -> ()
+    %3 = pulse.call_sequence @circuit_2(%frame0) : (!pulse.mixed_frame) -> i1
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+}
+
+pulse.sequence @circuit_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1 {
+    %0 = pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> i1
+    %1 = pulse.call_sequence @cx_0_1(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    pulse.return %1 : i1
+}
+
+pulse.sequence @circuit_1(%arg0: !pulse.mixed_frame) -> i1 {
+    %0 = pulse.call_sequence @x_1(%arg0) : (!pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+}
+
+pulse.sequence @circuit_2(%arg0: !pulse.mixed_frame) -> i1 {
+    %0 = pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+}
+
+pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+pulse.sequence @x_1(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p1"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+pulse.sequence @cx_0_1(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0", "p1"], pulse.duration = 400 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
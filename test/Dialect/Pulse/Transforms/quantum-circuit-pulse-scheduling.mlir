@@ -0,0 +1,74 @@
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quantum-circuit-pulse-scheduling=scheduling-method=asap %s | FileCheck %s --check-prefix=ASAP
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+func.func @main() -> i32 {
+    %port0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %frame0 = "pulse.mix_frame"(%port0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %port1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+    %frame1 = "pulse.mix_frame"(%port1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+    // CHECK: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 820 : i64, pulse.timepoint = 820 : i64}
+    // CHECK: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 820 : i64, pulse.timepoint = 820 : i64}
+    // ASAP: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 820 : i64, pulse.timepoint = 0 : i64}
+    // ASAP: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 820 : i64, pulse.timepoint = 0 : i64}
+    %0 = pulse.call_sequence @circuit_0(%frame0, %frame1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    %1 = pulse.call_sequence @circuit_0(%frame0, %frame1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+}
+
+// The calls of a gate sequence share its duration and ports, while the
+// duration of the delay depends on its call. The circuit called twice is
+// scheduled once.
+// CHECK-LABEL: pulse.sequence @circuit_0
+// ASAP-LABEL: pulse.sequence @circuit_0
+pulse.sequence @circuit_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1 {
+    // CHECK: pulse.call_sequence @x_0{{.*}}pulse.timepoint = -820 : i64
+    // ASAP: pulse.call_sequence @x_0{{.*}}pulse.timepoint = 0 : i64
+    %0 = pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> i1
+    // CHECK: pulse.call_sequence @x_1{{.*}}pulse.timepoint = -820 : i64
+    // ASAP: pulse.call_sequence @x_1{{.*}}pulse.timepoint = 0 : i64
+    %1 = pulse.call_sequence @x_1(%arg1) : (!pulse.mixed_frame) -> i1
+    // CHECK: pulse.call_sequence @cx_0_1{{.*}}pulse.timepoint = -660 : i64
+    // ASAP: pulse.call_sequence @cx_0_1{{.*}}pulse.timepoint = 160 : i64
+    %2 = pulse.call_sequence @cx_0_1(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    // CHECK: pulse.call_sequence @x_0{{.*}}pulse.timepoint = -260 : i64
+    // ASAP: pulse.call_sequence @x_0{{.*}}pulse.timepoint = 560 : i64
+    %3 = pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> i1
+    // CHECK: pulse.call_sequence @delay_0{{.*}}pulse.timepoint = -100 : i64
+    // ASAP: pulse.call_sequence @delay_0{{.*}}pulse.timepoint = 720 : i64
+    %4 = pulse.call_sequence @delay_0(%arg0) {pulse.duration = 100 : i64} : (!pulse.mixed_frame) -> i1
+    pulse.return %4 : i1
+}
+
+pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+pulse.sequence @x_1(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p1"], pulse.duration = 160 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+pulse.sequence @cx_0_1(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0", "p1"], pulse.duration = 400 : i64} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+pulse.sequence @delay_0(%arg0: !pulse.mixed_frame) -> i1 attributes {pulse.argPorts = ["p0"]} {
+    %false = arith.constant false
+    pulse.return %false : i1
+}
@@ -1,4 +1,5 @@
 // RUN: qss-compiler -X=mlir --pulse-remove-unused-arguments %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-remove-unused-arguments --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
 
 //
 // This code is part of Qiskit.
@@ -61,3 +62,29 @@ pulse.sequence @seq_0(%arg0: !pulse.port,  %arg1: !pulse.mixed_frame, %arg2: !pu
 
     pulse.return %c0_i1 : i1
 }
+
+// The arguments left unused by removing the operands of the calls of a
+// sequence are removed from its callers.
+// CHECK-LABEL: pulse.sequence @caller(%arg0: !pulse.port, %arg1: !pulse.mixed_frame, %arg2: !pulse.mixed_frame) -> i1 {
+pulse.sequence @caller(%port: !pulse.port, %frame0: !pulse.mixed_frame, %frame1: !pulse.mixed_frame) -> i1 {
+    // CHECK: pulse.call_sequence @outer(%arg1) : (!pulse.mixed_frame) -> i1
+    %0 = pulse.call_sequence @outer(%port, %frame0, %frame1) : (!pulse.port, !pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+}
+
+// CHECK-LABEL: pulse.sequence @outer(%arg0: !pulse.mixed_frame) -> i1 {
+pulse.sequence @outer(%port: !pulse.port, %frame0: !pulse.mixed_frame, %frame1: !pulse.mixed_frame) -> i1 {
+    // CHECK: pulse.call_sequence @inner(%arg0) : (!pulse.mixed_frame) -> i1
+    %0 = pulse.call_sequence @inner(%port, %frame0, %frame1) : (!pulse.port, !pulse.mixed_frame, !pulse.mixed_frame) -> i1
+    pulse.return %0 : i1
+}
+
+// CHECK-LABEL: pulse.sequence @inner(%arg0: !pulse.mixed_frame) -> i1 {
+pulse.sequence @inner(%port: !pulse.port, %frame0: !pulse.mixed_frame, %frame1: !pulse.mixed_frame) -> i1 {
+    %delay = arith.constant 16 : i32
+    pulse.delay(%frame0, %delay) : (!pulse.mixed_frame, i32)
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+// STATS: 7 num-arguments-removed
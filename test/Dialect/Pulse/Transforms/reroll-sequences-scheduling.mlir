@@ -0,0 +1,49 @@
+// RUN: qss-compiler -X=mlir --pulse-reroll-sequences --quantum-circuit-pulse-scheduling %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The gate repeated by rerolling lasts all its repetitions when the circuit
+// is scheduled.
+module {
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    %port0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %frame0 = "pulse.mix_frame"(%port0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %port1 = "pulse.create_port"() {uid = "p1"} : () -> !pulse.port
+    %frame1 = "pulse.mix_frame"(%port1) {uid = "mf0-p1"} : (!pulse.port) -> !pulse.mixed_frame
+    // CHECK: pulse.call_sequence @circuit_0{{.*}}{pulse.duration = 480 : i64, pulse.timepoint = 480 : i64}
+    pulse.call_sequence @circuit_0(%frame0, %frame1) : (!pulse.mixed_frame, !pulse.mixed_frame) -> ()
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+
+  // CHECK-LABEL: pulse.sequence @circuit_0
+  // CHECK: pulse.call_sequence @x_0({{.*}}) {pulse.repeat = 3 : i64, pulse.timepoint = -480 : i64}
+  // CHECK-NEXT: pulse.call_sequence @x_1({{.*}}) {pulse.timepoint = -160 : i64}
+  pulse.sequence @circuit_0(%arg0: !pulse.mixed_frame, %arg1: !pulse.mixed_frame) {
+    pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> ()
+    pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> ()
+    pulse.call_sequence @x_0(%arg0) : (!pulse.mixed_frame) -> ()
+    pulse.call_sequence @x_1(%arg1) : (!pulse.mixed_frame) -> ()
+    pulse.return
+  }
+
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) attributes {pulse.argPorts = ["p0"], pulse.duration = 160 : i64} {
+    pulse.return
+  }
+
+  pulse.sequence @x_1(%arg0: !pulse.mixed_frame) attributes {pulse.argPorts = ["p1"], pulse.duration = 160 : i64} {
+    pulse.return
+  }
+}
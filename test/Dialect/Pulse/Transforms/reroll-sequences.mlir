@@ -0,0 +1,69 @@
+// RUN: qss-compiler -X=mlir --pulse-reroll-sequences %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-reroll-sequences --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  pulse.sequence @x(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) attributes {pulse.duration = 10 : i64} {
+    pulse.play {pulse.timepoint = 0 : i64}(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+  }
+
+  // The periodic plays and delays are outlined, the last play is not part
+  // of the period.
+  // CHECK-LABEL: pulse.sequence @dd(
+  // CHECK-SAME: %[[FRAME:[A-Za-z0-9]+]]: !pulse.mixed_frame,
+  // CHECK-SAME: %[[WFR:[A-Za-z0-9]+]]: !pulse.waveform)
+  pulse.sequence @dd(%arg0: !pulse.mixed_frame, %arg1: !pulse.waveform) {
+    // CHECK: %[[C4:.*]] = arith.constant 4 : i32
+    // CHECK-NEXT: pulse.call_sequence @dd_repeat(%[[FRAME]], %[[WFR]], %[[C4]]) {pulse.repeat = 3 : i64, pulse.timepoint = 0 : i64}
+    // CHECK-NEXT: pulse.play {pulse.timepoint = 35 : i64}
+    // CHECK-NEXT: pulse.return
+    %c4 = arith.constant 4 : i32
+    pulse.play {pulse.timepoint = 0 : i64}(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.delay {pulse.timepoint = 4 : i64}(%arg0, %c4) : (!pulse.mixed_frame, i32)
+    pulse.play {pulse.timepoint = 10 : i64}(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.delay {pulse.timepoint = 14 : i64}(%arg0, %c4) : (!pulse.mixed_frame, i32)
+    pulse.play {pulse.timepoint = 20 : i64}(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.delay {pulse.timepoint = 24 : i64}(%arg0, %c4) : (!pulse.mixed_frame, i32)
+    pulse.play {pulse.timepoint = 35 : i64}(%arg0, %arg1) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.return
+  }
+
+  // The calls of a single sequence are repeated in place.
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+    %1 = "pulse.mix_frame"(%0) {uid = "mf0-p0"} : (!pulse.port) -> !pulse.mixed_frame
+    %2 = pulse.create_waveform dense<[[0.0, 1.0], [0.0, 1.0]]> : tensor<2x2xf64> -> !pulse.waveform
+    // CHECK: pulse.call_sequence @x(%{{.*}}, %{{.*}}) {pulse.repeat = 4 : i64}
+    // CHECK-NEXT: pulse.call_sequence @dd(
+    // CHECK-NEXT: return
+    pulse.call_sequence @x(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+    pulse.call_sequence @x(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+    pulse.call_sequence @x(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+    pulse.call_sequence @x(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+    pulse.call_sequence @dd(%1, %2) : (!pulse.mixed_frame, !pulse.waveform) -> ()
+    return %c0_i32 : i32
+  }
+
+  // CHECK: pulse.sequence @dd_repeat(%[[RFRAME:.*]]: !pulse.mixed_frame, %[[RWFR:.*]]: !pulse.waveform, %[[RDUR:.*]]: i32) attributes {pulse.duration = 10 : i64} {
+  // CHECK-NEXT: pulse.play {pulse.timepoint = 0 : i64}(%[[RFRAME]], %[[RWFR]])
+  // CHECK-NEXT: pulse.delay {pulse.timepoint = 4 : i64}(%[[RFRAME]], %[[RDUR]])
+  // CHECK-NEXT: pulse.return
+}
+
+// STATS: 10 num-ops-rerolled
+// STATS: 2 num-runs-rerolled
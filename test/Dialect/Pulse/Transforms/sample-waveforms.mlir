@@ -0,0 +1,70 @@
+// RUN: qss-compiler -X=mlir --pulse-sample-waveforms %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pulse-sample-waveforms=max-samples=100 %s | FileCheck %s --check-prefix=LIMIT
+// RUN: qss-compiler -X=mlir --pulse-sample-waveforms=sample-format=i16 %s | FileCheck %s --check-prefix=I16
+// RUN: qss-compiler -X=mlir "--pulse-sample-waveforms=sample-format=f16 use-resources=true" %s | FileCheck %s --check-prefix=RES
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK-LABEL: pulse.sequence @constant_parameters
+// I16-LABEL: pulse.sequence @constant_parameters
+// RES-LABEL: pulse.sequence @constant_parameters
+// LIMIT-LABEL: pulse.sequence @constant_parameters
+pulse.sequence @constant_parameters(%frame: !pulse.mixed_frame) -> i1 {
+    %dur3 = arith.constant 3 : i32
+    %dur160 = arith.constant 160 : i32
+    %sigma = arith.constant 40 : i32
+    %width = arith.constant 80 : i32
+    %beta = arith.constant 0.5 : f64
+    %amp = complex.constant [0.25, -0.5] : complex<f64>
+    %amp_re = arith.constant 0.1 : f64
+    %amp_im = arith.constant 0.0 : f64
+    %amp1 = complex.create %amp_re, %amp_im : complex<f64>
+
+    // CHECK: pulse.create_waveform dense<{{\[}}[2.500000e-01, -5.000000e-01], [2.500000e-01, -5.000000e-01], [2.500000e-01, -5.000000e-01]]> : tensor<3x2xf64> -> !pulse.waveform
+    // LIMIT: pulse.create_waveform {{.*}} : tensor<3x2xf64>
+    // I16: pulse.create_waveform dense<{{\[}}[8192, -16384], [8192, -16384], [8192, -16384]]> : tensor<3x2xi16> -> !pulse.waveform
+    // RES: pulse.create_waveform dense_resource<pulse_waveform{{.*}}> : tensor<3x2xf16> -> !pulse.waveform
+    %const = pulse.const_waveform(%dur3, %amp) : (i32, complex<f64>) -> !pulse.waveform
+    // CHECK: pulse.create_waveform {{.*}} : tensor<160x2xf64>
+    // LIMIT: pulse.gaussian
+    // I16: pulse.create_waveform {{.*}} : tensor<160x2xi16>
+    // RES: pulse.create_waveform dense_resource<pulse_waveform{{.*}}> : tensor<160x2xf16>
+    %gauss = pulse.gaussian(%dur160, %amp1, %sigma) : (i32, complex<f64>, i32) -> !pulse.waveform
+    // CHECK: pulse.create_waveform {{.*}} : tensor<160x2xf64>
+    // LIMIT: pulse.gaussian_square
+    %gauss_sq = pulse.gaussian_square(%dur160, %amp1, %sigma, %width) : (i32, complex<f64>, i32, i32) -> !pulse.waveform
+    // CHECK: pulse.create_waveform {{.*}} : tensor<160x2xf64>
+    // LIMIT: pulse.drag
+    %drag = pulse.drag(%dur160, %amp1, %sigma, %beta) : (i32, complex<f64>, i32, f64) -> !pulse.waveform
+    // CHECK-NOT: pulse.const_waveform
+    // CHECK-NOT: pulse.gaussian
+    // CHECK-NOT: pulse.drag
+    pulse.play(%frame, %const) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.play(%frame, %gauss) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.play(%frame, %gauss_sq) : (!pulse.mixed_frame, !pulse.waveform)
+    pulse.play(%frame, %drag) : (!pulse.mixed_frame, !pulse.waveform)
+    %false = arith.constant false
+    pulse.return %false : i1
+}
+
+// CHECK-LABEL: pulse.sequence @argument_parameters
+pulse.sequence @argument_parameters(%frame: !pulse.mixed_frame, %dur: i32, %amp: complex<f64>) -> i1 {
+    %sigma = arith.constant 40 : i32
+    // CHECK: pulse.gaussian(%arg1, %arg2, %{{.*}})
+    %gauss = pulse.gaussian(%dur, %amp, %sigma) : (i32, complex<f64>, i32) -> !pulse.waveform
+    // CHECK-NOT: pulse.create_waveform
+    pulse.play(%frame, %gauss) : (!pulse.mixed_frame, !pulse.waveform)
+    %false = arith.constant false
+    pulse.return %false : i1
+}
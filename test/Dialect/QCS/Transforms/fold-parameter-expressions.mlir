@@ -0,0 +1,70 @@
+// RUN: qss-compiler -X=mlir --qcs-fold-parameter-expressions %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --qcs-fold-parameter-expressions --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS: 3 num-expressions-folded
+
+module {
+  // the derived parameters are declared next to their first parameter, with
+  // the value of the expression over the initial values
+  // CHECK: qcs.declare_parameter @theta
+  // CHECK-NEXT: qcs.declare_parameter @"(angle (add theta phi))" : !quir.angle<64> = #quir.angle<2.00
+  // CHECK-NEXT: qcs.declare_parameter @"(angle (add (div theta 2) 3.1415926535897931))" : !quir.angle<64> = #quir.angle<3.64
+  qcs.declare_parameter @theta : !quir.angle<64> = #quir.angle<1.000000e+00> : !quir.angle<64>
+  qcs.declare_parameter @phi : !quir.angle<64> = #quir.angle<1.000000e+00> : !quir.angle<64>
+  // CHECK: qcs.declare_parameter @alpha
+  // CHECK-NEXT: qcs.declare_parameter @"(angle (neg (mul alpha 2)))" : !quir.angle<64> = #quir.angle<3.14
+  qcs.declare_parameter @alpha : f64 = 1.570796e+00 : f64
+
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    // CHECK-NOT: oq3.angle_div
+    %theta = qcs.parameter_load @theta : !quir.angle<64>
+    %two = quir.constant #quir.angle<2.0> : !quir.angle<64>
+    %pi = quir.constant #quir.angle<3.141592653589793> : !quir.angle<64>
+    %half = oq3.angle_div %theta, %two : !quir.angle<64>
+    %shifted = oq3.angle_add %half, %pi : !quir.angle<64>
+    // CHECK: [[SHIFTED:%.*]] = qcs.parameter_load @"(angle (add (div theta 2) 3.1415926535897931))" : !quir.angle<64>
+    // CHECK-NEXT: quir.call_gate @rz({{%.*}}, [[SHIFTED]])
+    quir.call_gate @rz(%q0, %shifted) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+
+    // CHECK: [[ANGLE:%.*]] = qcs.parameter_load @"(angle (neg (mul alpha 2)))" : !quir.angle<64>
+    // CHECK-NEXT: quir.call_gate @rz({{%.*}}, [[ANGLE]])
+    %alpha = qcs.parameter_load @alpha : f64
+    %c2 = arith.constant 2.0 : f64
+    %double = arith.mulf %alpha, %c2 : f64
+    %neg = arith.negf %double : f64
+    %angle = "oq3.cast"(%neg) : (f64) -> !quir.angle<64>
+    quir.call_gate @rz(%q0, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+
+    // the computations which depend on measurements stay in place, the
+    // parameter parts of them are folded
+    // CHECK: [[SUM:%.*]] = qcs.parameter_load @"(angle (add theta phi))" : !quir.angle<64>
+    // CHECK: [[M:%.*]] = quir.measure
+    // CHECK: [[BIT:%.*]] = "oq3.cast"([[M]])
+    // CHECK: oq3.angle_add [[SUM]], [[BIT]]
+    %theta1 = qcs.parameter_load @theta : !quir.angle<64>
+    %phi = qcs.parameter_load @phi : !quir.angle<64>
+    %sum = oq3.angle_add %theta1, %phi : !quir.angle<64>
+    %m = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+    %bit = "oq3.cast"(%m) : (i1) -> !quir.angle<64>
+    %offset = oq3.angle_add %sum, %bit : !quir.angle<64>
+    quir.call_gate @rz(%q0, %offset) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
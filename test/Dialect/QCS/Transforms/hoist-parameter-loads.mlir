@@ -0,0 +1,66 @@
+// RUN: qss-compiler -X=mlir --qcs-hoist-parameter-loads %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --qcs-hoist-parameter-loads --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS-DAG: 3 num-parameter-loads-hoisted
+// STATS-DAG: 2 num-ops-hoisted
+
+module {
+  qcs.declare_parameter @theta : !quir.angle<64> = #quir.angle<3.141000e+00> : !quir.angle<64>
+  qcs.declare_parameter @phi : !quir.angle<64> = #quir.angle<1.000000e+00> : !quir.angle<64>
+  qcs.declare_parameter @alpha : f64 = 1.560000e+00 : f64
+
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    qcs.init
+    %c0 = arith.constant 0 : index
+    %c1000 = arith.constant 1000 : index
+    %c1 = arith.constant 1 : index
+    // the loads, and the angle arithmetic over them, are computed once
+    // CHECK: [[ALPHA:%.*]] = qcs.parameter_load @alpha : f64
+    // CHECK: [[THETA:%.*]] = qcs.parameter_load @theta : !quir.angle<64>
+    // CHECK: [[PHI:%.*]] = qcs.parameter_load @phi : !quir.angle<64>
+    // CHECK: [[SUM:%.*]] = oq3.angle_add [[THETA]], [[PHI]] : !quir.angle<64>
+    // CHECK: [[TWICE:%.*]] = oq3.angle_add [[SUM]], [[SUM]] : !quir.angle<64>
+    // CHECK: scf.for
+    // CHECK-NEXT: qcs.shot_init
+    // CHECK-NOT: qcs.parameter_load
+    scf.for %arg0 = %c0 to %c1000 step %c1 {
+      qcs.shot_init {qcs.num_shots = 1000 : i32}
+      %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+      %theta = qcs.parameter_load @theta : !quir.angle<64>
+      %phi = qcs.parameter_load @phi : !quir.angle<64>
+      %sum = oq3.angle_add %theta, %phi : !quir.angle<64>
+      %twice = oq3.angle_add %sum, %sum : !quir.angle<64>
+      // CHECK: quir.call_gate @rz([[Q0:%.*]], [[TWICE]])
+      quir.call_gate @rz(%q0, %twice) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+      // measurement results differ between shots
+      // CHECK: [[M:%.*]] = quir.measure
+      %m = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+      // CHECK: scf.if [[M]]
+      scf.if %m {
+        // the computations in the control flow of a shot stay in place
+        // CHECK-NEXT: [[ANGLE:%.*]] = "oq3.cast"([[ALPHA]])
+        // CHECK-NEXT: quir.call_gate @rz([[Q0]], [[ANGLE]])
+        %alpha = qcs.parameter_load @alpha : f64
+        %angle = "oq3.cast"(%alpha) : (f64) -> !quir.angle<64>
+        quir.call_gate @rz(%q0, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+      }
+    } {qcs.shot_loop}
+    qcs.finalize
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
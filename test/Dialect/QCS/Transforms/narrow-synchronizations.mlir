@@ -0,0 +1,137 @@
+// RUN: qss-compiler -X=mlir --qcs-narrow-synchronizations %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --qcs-narrow-synchronizations --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  func.func @subroutine() {
+    return
+  }
+
+  // Only the controllers of q0 and q1 rendezvous after the parallel control
+  // flow, q2 is next used after the following synchronization.
+  // CHECK-LABEL: func.func @parallel_control_flow()
+  func.func @parallel_control_flow() {
+    // CHECK: [[Q0:%.*]] = quir.declare_qubit {id = 0 : i32}
+    // CHECK: [[Q1:%.*]] = quir.declare_qubit {id = 1 : i32}
+    // CHECK: [[Q2:%.*]] = quir.declare_qubit {id = 2 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+    %c0 = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+    %c1 = quir.measure(%q1) : (!quir.qubit<1>) -> i1
+    %c2 = quir.measure(%q2) : (!quir.qubit<1>) -> i1
+    qcs.parallel_control_flow {
+      scf.if %c0 {
+        quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+      } {quir.physicalIds = [0 : i32]}
+      scf.if %c1 {
+        quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+      } {quir.physicalIds = [1 : i32]}
+      scf.if %c2 {
+        quir.call_gate @x(%q2) : (!quir.qubit<1>) -> ()
+      } {quir.physicalIds = [2 : i32]}
+      qcs.parallel_control_flow_end
+    }
+    // CHECK: qcs.synchronize [[Q0]], [[Q1]] : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK-NEXT: quir.builtin_CX [[Q0]], [[Q1]]
+    // CHECK-NEXT: qcs.synchronize [[Q0]], [[Q1]], [[Q2]] : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+    qcs.synchronize %q0, %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+    qcs.synchronize %q0, %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+    return
+  }
+
+  // A synchronization directly followed by one of the same qubits is erased.
+  // CHECK-LABEL: func.func @redundant()
+  func.func @redundant() {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: quir.builtin_CX
+    // CHECK-NEXT: qcs.synchronize
+    // CHECK-NEXT: quir.builtin_CX
+    quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+    return
+  }
+
+  // The measurement of q1 is used on the controller of q0 after the
+  // synchronization, which is kept for both.
+  // CHECK-LABEL: func.func @data_dependence()
+  func.func @data_dependence() {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %m = quir.measure(%q1) : (!quir.qubit<1>) -> i1
+    // CHECK: qcs.synchronize %{{.*}}, %{{.*}} : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK: qcs.synchronize %{{.*}}, %{{.*}} : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    scf.if %m {
+      quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    }
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    return
+  }
+
+  // The qubits a subroutine operates on are not known.
+  // CHECK-LABEL: func.func @unknown_qubits()
+  func.func @unknown_qubits() {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: qcs.synchronize %{{.*}}, %{{.*}} : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK-NEXT: quir.call_subroutine @subroutine()
+    // CHECK-NEXT: qcs.synchronize %{{.*}}, %{{.*}} : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.call_subroutine @subroutine() : () -> ()
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    return
+  }
+
+  // The qubits of control flow decorated with an unresolved qubit are not
+  // known, even if those of the ops nested in it are.
+  // CHECK-LABEL: func.func @unresolved_qubits(
+  func.func @unresolved_qubits(%c: i1) {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: qcs.synchronize %{{.*}}, %{{.*}} : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK-NEXT: scf.if
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    scf.if %c {
+      quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    } {quir.physicalIds = [0 : i32, -1 : i32]}
+    qcs.synchronize %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    return
+  }
+
+  // A synchronization of all qubits is narrowed to the declared qubits used
+  // before the next one.
+  // CHECK-LABEL: func.func @all_qubits()
+  func.func @all_qubits() {
+    // CHECK: [[Q0:%.*]] = quir.declare_qubit {id = 0 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    quir.reset %q1 : !quir.qubit<1>
+    // CHECK: qcs.synchronize [[Q0]] : (!quir.qubit<1>) -> ()
+    // CHECK-NEXT: quir.call_gate @x([[Q0]])
+    // CHECK-NEXT: qcs.synchronize : () -> ()
+    qcs.synchronize : () -> ()
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    qcs.synchronize : () -> ()
+    return
+  }
+}
+
+// STATS: 1 num-synchronizations-eliminated
+// STATS: 2 num-synchronizations-narrowed
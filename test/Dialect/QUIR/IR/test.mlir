@@ -113,6 +113,8 @@ module {
         qcs.delay_cycles (%qb1) {time = 1000 : i64} : (!quir.qubit<1>) -> ()
         // CHECK: qcs.send %{{.*}} to 1 : i1
         qcs.send %val to 1 : i1
+        // CHECK: qcs.send %{{.*}}, %{{.*}} to 2 : i1, i1
+        qcs.send %val, %val to 2 : i1, i1
         // CHECK: %{{.*}} = qcs.recv : i1
         %cb3 = qcs.recv : i1
         // CHECK: %{{.*}} = qcs.recv {fromId = [10 : index]} : i1
@@ -0,0 +1,36 @@
+// RUN: qss-compiler -X=mlir --add-shot-loop=num-shots=50 %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// A main with a shot loop keeps its single shot body, with the new number
+// of shots.
+func.func @main() -> i32 {
+  qcs.init
+  %c0 = arith.constant 0 : index
+  %c1000 = arith.constant 1000 : index
+  %c1 = arith.constant 1 : index
+  // CHECK-NOT: arith.constant 1000 : index
+  // CHECK: %[[SHOTS:.*]] = arith.constant 50 : index
+  // CHECK: scf.for %{{.*}} = %{{.*}} to %[[SHOTS]] step %{{.*}} {
+  // CHECK-NOT: scf.for
+  scf.for %arg0 = %c0 to %c1000 step %c1 {
+    // CHECK: qcs.shot_init {qcs.num_shots = 50 : i32}
+    qcs.shot_init {qcs.num_shots = 1000 : i32}
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    quir.reset %0 : !quir.qubit<1>
+  } {qcs.shot_loop}
+  qcs.finalize
+  %c0_i32 = arith.constant 0 : i32
+  return %c0_i32 : i32
+}
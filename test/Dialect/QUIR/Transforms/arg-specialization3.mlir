@@ -0,0 +1,45 @@
+// RUN: qss-compiler -X=mlir --quir-arg-specialization %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that the calls of the same types share a single specialization, also
+// when the specialized function is called from functions called repeatedly.
+
+// CHECK: func.func @"defcalPhase_q0_!quir.angle<20>_!quir.qubit<1>"(%arg0: !quir.angle<20>, %arg1: !quir.qubit<1>)
+// CHECK-NOT: func.func @"defcalPhase_q0_!quir.angle<20>_!quir.qubit<1>"
+// CHECK: func.func @defcalPhase_q0(
+func.func @defcalPhase_q0(%arg0: !quir.angle, %arg1: !quir.qubit<1>) {
+  return
+}
+
+// CHECK: func.func @layer(%arg0: !quir.qubit<1>, %arg1: !quir.angle<20>)
+func.func @layer(%q : !quir.qubit<1>, %phi : !quir.angle<20>) {
+  // CHECK-COUNT-2: quir.call_gate @"defcalPhase_q0_!quir.angle<20>_!quir.qubit<1>"
+  quir.call_gate @defcalPhase_q0(%phi, %q) : (!quir.angle<20>, !quir.qubit<1>) -> ()
+  quir.call_gate @defcalPhase_q0(%phi, %q) : (!quir.angle<20>, !quir.qubit<1>) -> ()
+  return
+}
+
+func.func @main () -> i32 {
+  %q = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %ang = quir.constant #quir.angle<0.1> : !quir.angle<20>
+  // CHECK: quir.call_gate @"defcalPhase_q0_!quir.angle<20>_!quir.qubit<1>"
+  quir.call_gate @defcalPhase_q0(%ang, %q) : (!quir.angle<20>, !quir.qubit<1>) -> ()
+  // CHECK-COUNT-3: quir.call_subroutine @layer(
+  quir.call_subroutine @layer(%q, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @layer(%q, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  quir.call_subroutine @layer(%q, %ang) : (!quir.qubit<1>, !quir.angle<20>) -> ()
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
@@ -1,5 +1,6 @@
 // RUN: qss-compiler -X=mlir --break-reset %s | FileCheck %s
 // RUN: qss-compiler -X=mlir --break-reset='numIterations=2 delayCycles=500' %s | FileCheck %s --check-prefix DELAYITER
+// RUN: qss-compiler -X=mlir --break-reset='batchCorrections=true' %s | FileCheck %s --check-prefix BATCH
 
 //
 // This code is part of Qiskit.
@@ -22,6 +23,7 @@ func.func @main() {
 // DELAYITER: [[QUBIT0:%.*]] = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
 // DELAYITER: [[QUBIT1:%.*]] = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
 // DELAYITER: [[QUBIT2:%.*]] = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+// BATCH: [[QUBIT0:%.*]] = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
 
   %1 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
   %2 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
@@ -45,9 +47,20 @@ func.func @main() {
 
 // DELAYITER: quir.measure
 // DELAYITER-COUNT-3: scf.if
-// DELAYITER: quir.delay [[DURATION]], ([[QUBIT0]]) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
-// DELAYITER: quir.delay [[DURATION]], ([[QUBIT1]]) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
-// DELAYITER: quir.delay [[DURATION]], ([[QUBIT2]]) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+
+// BATCH: [[MEASUREMENT:%.*]]:3 = quir.measure(%0, %1, %2)
+// BATCH: [[ANY01:%.*]] = arith.ori [[MEASUREMENT]]#0, [[MEASUREMENT]]#1 : i1
+// BATCH: [[ANY:%.*]] = arith.ori [[ANY01]], [[MEASUREMENT]]#2 : i1
+// BATCH: scf.if [[ANY]] {
+// BATCH:   scf.if [[MEASUREMENT]]#0 {
+// BATCH:     quir.call_gate @x([[QUBIT0]]) : (!quir.qubit<1>) -> ()
+// BATCH:   }
+// BATCH:   scf.if [[MEASUREMENT]]#1 {
+// BATCH:   scf.if [[MEASUREMENT]]#2 {
+// BATCH: }
+// DELAYITER-NOT: quir.delay
+// DELAYITER: quir.delay [[DURATION]], ([[QUBIT0]], [[QUBIT1]], [[QUBIT2]]) : !quir.duration<dt>, (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+// DELAYITER-NOT: quir.delay
 // DELAYITER: quir.measure
 // DELAYITER-COUNT-3: scf.if
 
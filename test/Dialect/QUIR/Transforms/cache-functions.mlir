@@ -0,0 +1,44 @@
+// RUN: qss-compiler -X=mlir --quir-cache-functions %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-cache-functions --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  // CHECK: func.func @scale(
+  func.func @scale(%arg0: i32) -> i32 {
+    // CHECK: arith.constant 2 : i32
+    // CHECK-NOT: arith.addi
+    %c1 = arith.constant 1 : i32
+    %c2 = arith.addi %c1, %c1 : i32
+    %0 = arith.muli %arg0, %c2 : i32
+    return %0 : i32
+  }
+  // CHECK: quir.circuit @circuit_0(
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // main is not cached
+  // CHECK: func.func @main(
+  // CHECK: arith.addi
+  func.func @main() -> i32 {
+    %c1 = arith.constant 1 : i32
+    %c2 = arith.addi %c1, %c1 : i32
+    %0 = func.call @scale(%c2) : (i32) -> i32
+    return %0 : i32
+  }
+}
+
+// STATS: 0 num-cache-hits
+// STATS: 2 num-cache-misses
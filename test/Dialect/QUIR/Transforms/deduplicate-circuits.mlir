@@ -0,0 +1,84 @@
+// RUN: qss-compiler -X=mlir --deduplicate-circuits %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --deduplicate-circuits --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  // CHECK: quir.circuit @circuit_0(
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @rz(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // The same circuit with other value names
+  // CHECK-NOT: quir.circuit @circuit_1(
+  quir.circuit @circuit_1(%q: !quir.qubit<1> {quir.physicalId = 0 : i32}, %theta: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @rz(%q, %theta) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %result = quir.measure(%q) : (!quir.qubit<1>) -> i1
+    quir.return %result : i1
+  }
+  // A circuit on another qubit is kept
+  // CHECK: quir.circuit @circuit_2(
+  quir.circuit @circuit_2(%arg0: !quir.qubit<1> {quir.physicalId = 1 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [1 : i32]} {
+    quir.call_gate @rz(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // A circuit with another gate is kept
+  // CHECK: quir.circuit @circuit_3(
+  quir.circuit @circuit_3(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.angle<64>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @sx(%arg0, %arg1) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  // A circuit using its arguments in another order is kept
+  // CHECK: quir.circuit @circuit_4(
+  quir.circuit @circuit_4(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.qubit<1> {quir.physicalId = 1 : i32}) attributes {quir.physicalIds = [0 : i32, 1 : i32]} {
+    quir.builtin_CX %arg0, %arg1 : !quir.qubit<1>, !quir.qubit<1>
+    quir.return
+  }
+  // CHECK: quir.circuit @circuit_5(
+  quir.circuit @circuit_5(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.qubit<1> {quir.physicalId = 1 : i32}) attributes {quir.physicalIds = [0 : i32, 1 : i32]} {
+    quir.builtin_CX %arg1, %arg0 : !quir.qubit<1>, !quir.qubit<1>
+    quir.return
+  }
+  // CHECK-NOT: quir.circuit @circuit_6(
+  quir.circuit @circuit_6(%arg0: !quir.qubit<1> {quir.physicalId = 0 : i32}, %arg1: !quir.qubit<1> {quir.physicalId = 1 : i32}) attributes {quir.physicalIds = [0 : i32, 1 : i32]} {
+    quir.builtin_CX %arg1, %arg0 : !quir.qubit<1>, !quir.qubit<1>
+    quir.return
+  }
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %angle = quir.constant #quir.angle<1.5707963267948966> : !quir.angle<64>
+    // CHECK: quir.call_circuit @circuit_0(%{{.*}}, %{{.*}})
+    %2 = quir.call_circuit @circuit_0(%0, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_0(%{{.*}}, %{{.*}})
+    %3 = quir.call_circuit @circuit_1(%0, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_2(%{{.*}}, %{{.*}})
+    %4 = quir.call_circuit @circuit_2(%1, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_3(%{{.*}}, %{{.*}})
+    %5 = quir.call_circuit @circuit_3(%0, %angle) : (!quir.qubit<1>, !quir.angle<64>) -> i1
+    // CHECK: quir.call_circuit @circuit_4(%{{.*}}, %{{.*}})
+    quir.call_circuit @circuit_4(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK: quir.call_circuit @circuit_5(%{{.*}}, %{{.*}})
+    quir.call_circuit @circuit_5(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK: quir.call_circuit @circuit_5(%{{.*}}, %{{.*}})
+    quir.call_circuit @circuit_6(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    return %c0_i32 : i32
+  }
+}
+
+// STATS: 2 num-circuits-deduplicated
@@ -0,0 +1,90 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-barriers %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-eliminate-barriers --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS-DAG: 2 num-barriers-erased
+// STATS-DAG: 1 num-barriers-narrowed
+
+module {
+  func.func @x(%q: !quir.qubit<1>) {
+    return
+  }
+  func.func private @subroutine() -> ()
+
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    // CHECK: [[Q0:%.*]] = quir.declare_qubit {id = 0 : i32}
+    // CHECK: [[Q1:%.*]] = quir.declare_qubit {id = 1 : i32}
+    // CHECK: [[Q2:%.*]] = quir.declare_qubit {id = 2 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+
+    // a barrier of a single qubit does not delay anything
+    // CHECK-NOT: quir.barrier [[Q0]] :
+    quir.barrier %q0 : (!quir.qubit<1>) -> ()
+
+    // of two adjacent barriers on the same qubits, one is enough
+    // CHECK: quir.call_gate @x([[Q0]])
+    // CHECK-NEXT: quir.barrier [[Q0]], [[Q1]] :
+    // CHECK-NEXT: quir.call_gate @x([[Q1]])
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    quir.barrier %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.barrier %q0, %q1 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+
+    // q2 is idle between the synchronizations, so the barrier does not delay
+    // it
+    // CHECK: qcs.synchronize
+    // CHECK: quir.barrier [[Q0]], [[Q1]] :
+    // CHECK: qcs.synchronize
+    qcs.synchronize %q0, %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    quir.barrier %q0, %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+    qcs.synchronize %q0, %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+
+    // calls whose qubits are not known may use all qubits
+    // CHECK: call @subroutine()
+    // CHECK-NEXT: quir.barrier [[Q0]], [[Q2]] :
+    // CHECK-NEXT: call @subroutine()
+    call @subroutine() : () -> ()
+    quir.barrier %q0, %q2 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    call @subroutine() : () -> ()
+
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+
+  // control flow decorated with an unresolved qubit may use all qubits, so
+  // the barrier is not preceded by the synchronization on its qubits
+  // CHECK-LABEL: func.func @unresolved_qubit(
+  func.func @unresolved_qubit(%c: i1) {
+    // CHECK: [[Q1:%.*]] = quir.declare_qubit {id = 1 : i32}
+    // CHECK: [[Q2:%.*]] = quir.declare_qubit {id = 2 : i32}
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+    // CHECK: } {quir.physicalIds = [0 : i32, -1 : i32]}
+    // CHECK-NEXT: quir.barrier [[Q1]], [[Q2]] :
+    qcs.synchronize %q0, %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> ()
+    scf.if %c {
+      quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    } {quir.physicalIds = [0 : i32, -1 : i32]}
+    quir.barrier %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+    return
+  }
+}
@@ -0,0 +1,75 @@
+// RUN: qss-compiler -X=mlir --quir-fuse-single-qubit-gates %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --quir-fuse-single-qubit-gates --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS-DAG: 2 num-gates-fused
+// STATS-DAG: 2 num-gates-erased
+// STATS-DAG: 1 num-cx-cancelled
+
+module {
+  // a gate defined by builtin_U is part of runs
+  func.func @rz(%q: !quir.qubit<1>, %theta: !quir.angle<64>) {
+    %zero = quir.constant #quir.angle<0.0> : !quir.angle<64>
+    quir.builtin_U %q, %zero, %zero, %theta : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+    return
+  }
+  // a gate without body is defined by its calibration
+  func.func @x(%q: !quir.qubit<1>) {
+    return
+  }
+
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %zero = quir.constant #quir.angle<0.0> : !quir.angle<64>
+    %half_pi = quir.constant #quir.angle<1.5707963267948966> : !quir.angle<64>
+    %pi = quir.constant #quir.angle<3.141592653589793> : !quir.angle<64>
+    %a = quir.constant #quir.angle<5.000000e-01> : !quir.angle<64>
+    %b = quir.constant #quir.angle<2.500000e-01> : !quir.angle<64>
+
+    // H H is the identity
+    // CHECK-NOT: quir.builtin_U
+    quir.builtin_U %q0, %half_pi, %zero, %pi : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+    quir.builtin_U %q0, %half_pi, %zero, %pi : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+
+    // the rotations of q1 are fused, across the gates of q0
+    // CHECK: quir.call_gate @x([[Q0:%.*]])
+    // CHECK: [[THETA:%.*]] = quir.constant #quir.angle<0.000000e+00>
+    // CHECK: [[PHI:%.*]] = quir.constant #quir.angle<0.000000e+00>
+    // CHECK: [[LAMBDA:%.*]] = quir.constant #quir.angle<7.500000e-01>
+    // CHECK: quir.builtin_U [[Q1:%.*]], [[THETA]], [[PHI]], [[LAMBDA]]
+    // CHECK-NOT: quir.call_gate @rz
+    quir.call_gate @rz(%q1, %a) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    quir.call_gate @rz(%q1, %b) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+
+    // consecutive CX on the same qubits cancel
+    // CHECK-NOT: quir.builtin_CX
+    quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+    quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+
+    // runs end at measurements
+    // CHECK: quir.call_gate @rz([[Q1]]
+    // CHECK-NEXT: quir.measure([[Q1]])
+    // CHECK-NEXT: quir.call_gate @rz([[Q1]]
+    quir.call_gate @rz(%q1, %a) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+    %m = quir.measure(%q1) : (!quir.qubit<1>) -> i1
+    quir.call_gate @rz(%q1, %b) : (!quir.qubit<1>, !quir.angle<64>) -> ()
+
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
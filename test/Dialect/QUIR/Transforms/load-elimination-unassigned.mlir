@@ -0,0 +1,25 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-loads %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// A variable which is never assigned keeps its loads.
+module {
+  oq3.declare_variable @a : !quir.cbit<1>
+  func.func @main() -> i1 {
+    // CHECK: oq3.variable_load @a : !quir.cbit<1>
+    %0 = oq3.variable_load @a : !quir.cbit<1>
+    %1 = "oq3.cast"(%0) : (!quir.cbit<1>) -> i1
+    return %1 : i1
+  }
+}
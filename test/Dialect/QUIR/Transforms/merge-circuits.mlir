@@ -1,4 +1,5 @@
 // RUN: qss-compiler -X=mlir --subroutine-cloning --quantum-decorate --merge-circuits %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --subroutine-cloning --quantum-decorate --merge-circuits=single-sweep=true %s | FileCheck %s
 
 //
 // This code is part of Qiskit.
@@ -1,5 +1,9 @@
 // RUN: qss-compiler -X=mlir --canonicalize --merge-measures-lexographical %s | FileCheck %s --check-prefix LEX
 // RUN: qss-compiler -X=mlir --canonicalize --merge-measures-topological %s | FileCheck %s --check-prefix TOP
+// RUN: qss-compiler -X=mlir --canonicalize --merge-measures-lexographical --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix STATS
+// RUN: not qss-opt --pass-pipeline='builtin.module(merge-measures-lexographical{max-iterations=0})' %s 2>&1 | FileCheck %s --check-prefix BOUNDED
+// RUN: qss-opt --pass-pipeline='builtin.module(merge-measures-lexographical{max-width=3})' %s | FileCheck %s --check-prefix WIDTH
+// RUN: qss-opt --pass-pipeline='builtin.module(merge-measures-topological{max-width=3})' %s | FileCheck %s --check-prefix WIDTH
 
 //
 // This code is part of Qiskit.
@@ -52,6 +56,9 @@ func.func @four(%c : memref<1xi1>, %ind : index) {
   %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
   %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
   %q3 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+  // WIDTH-LABEL: func.func @four(
+  // WIDTH:  %{{.*}}:3 = quir.measure(%{{.*}}, %{{.*}}, %{{.*}}) : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> (i1, i1, i1)
+  // WIDTH:  %{{.*}} = quir.measure(%{{.*}}) : (!quir.qubit<1>) -> i1
   // LEX:  %{{.*}}:4 = quir.measure(%{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}) : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> (i1, i1, i1, i1)
   // TOP:  %{{.*}}:4 = quir.measure(%{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}) : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> (i1, i1, i1, i1)
   %res0 = quir.measure(%q0) : (!quir.qubit<1>) -> (i1)
@@ -176,3 +183,8 @@ func.func @inter_switch(%flag : i32) {
   %res4 = quir.measure(%q5) : (!quir.qubit<1>) -> (i1)
   return
 }
+
+// STATS: {{[1-9][0-9]*}} num-measures-merged
+// STATS: {{[1-9][0-9]*}} num-rewrite-iterations
+
+// BOUNDED: error: greedy rewrites did not converge within 0 iterations
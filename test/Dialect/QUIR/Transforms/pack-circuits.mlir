@@ -0,0 +1,79 @@
+// RUN: qss-compiler -X=mlir --pack-circuits %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pack-circuits=max-width=2 %s | FileCheck %s --check-prefix=WIDTH
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+module {
+  quir.circuit @circuit_0(%arg0: !quir.qubit<1>) -> i1 attributes {quir.physicalIds = [0 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  quir.circuit @circuit_1(%arg0: !quir.qubit<1>) -> i1 attributes {quir.physicalIds = [1 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+  quir.circuit @circuit_2(%arg0: !quir.qubit<1>) attributes {quir.physicalIds = [0 : i32]} {
+    quir.call_gate @x(%arg0) : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  quir.circuit @circuit_3(%arg0: !quir.qubit<1>) attributes {quir.physicalIds = [1 : i32]} {
+    quir.call_gate @x(%arg0) : (!quir.qubit<1>) -> ()
+    quir.return
+  }
+  quir.circuit @circuit_4(%arg0: !quir.qubit<1>) -> i1 attributes {quir.physicalIds = [2 : i32]} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0 : i1
+  }
+
+  // The circuits at the same depth of the dependencies on the qubits are
+  // packed, although they are not back to back.
+  // CHECK-LABEL: func.func @main()
+  // WIDTH-LABEL: func.func @main()
+  func.func @main() -> (i1, i1, i1) {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+    // CHECK: %[[MEAS:.*]]:3 = quir.call_circuit @circuit_0_circuit_1_circuit_4(%0, %1, %2) : (!quir.qubit<1>, !quir.qubit<1>, !quir.qubit<1>) -> (i1, i1, i1)
+    // CHECK-NEXT: quir.call_circuit @circuit_2_circuit_3(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // CHECK-NEXT: return %[[MEAS]]#0, %[[MEAS]]#1, %[[MEAS]]#2
+
+    // No more than two qubits are packed into a circuit.
+    // WIDTH: %[[MEAS:.*]]:2 = quir.call_circuit @circuit_0_circuit_1(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+    // WIDTH-NEXT: quir.call_circuit @circuit_2_circuit_3(%0, %1) : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+    // WIDTH-NEXT: %[[MEAS2:.*]] = quir.call_circuit @circuit_4(%2) : (!quir.qubit<1>) -> i1
+    // WIDTH-NEXT: return %[[MEAS]]#0, %[[MEAS]]#1, %[[MEAS2]]
+    %a = quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> i1
+    quir.call_circuit @circuit_2(%q0) : (!quir.qubit<1>) -> ()
+    %b = quir.call_circuit @circuit_1(%q1) : (!quir.qubit<1>) -> i1
+    quir.call_circuit @circuit_3(%q1) : (!quir.qubit<1>) -> ()
+    %c = quir.call_circuit @circuit_4(%q2) : (!quir.qubit<1>) -> i1
+    return %a, %b, %c : i1, i1, i1
+  }
+
+  // The circuits are not packed across control flow.
+  // CHECK-LABEL: func.func @control_flow(
+  // CHECK: quir.call_circuit @circuit_0(
+  // CHECK: scf.if
+  // CHECK: quir.call_circuit @circuit_1(
+  func.func @control_flow(%cond: i1) -> (i1, i1) {
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    %a = quir.call_circuit @circuit_0(%q0) : (!quir.qubit<1>) -> i1
+    scf.if %cond {
+      quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    }
+    %b = quir.call_circuit @circuit_1(%q1) : (!quir.qubit<1>) -> i1
+    return %a, %b : i1, i1
+  }
+}
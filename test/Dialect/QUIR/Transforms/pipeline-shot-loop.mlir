@@ -0,0 +1,72 @@
+// RUN: qss-compiler -X=mlir --pipeline-shot-loop %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --pipeline-shot-loop --mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// STATS: 1 num-pipelined-loops
+
+module {
+  oq3.declare_variable @m : i1
+  oq3.declare_variable @n : i1
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    qcs.init
+    %c0 = arith.constant 0 : index
+    %c1000 = arith.constant 1000 : index
+    %c1 = arith.constant 1 : index
+    // the first shot is delayed ahead of the loop
+    // CHECK: [[DUR:%.*]] = quir.constant #quir.duration<5.000000e+02> : !quir.duration<dt>
+    // CHECK-NEXT: quir.delay [[DUR]], ()
+    // CHECK-NEXT: scf.for
+    scf.for %arg0 = %c0 to %c1000 step %c1 {
+      // CHECK-NEXT: quir.constant #quir.duration<5.000000e+02>
+      // CHECK-NEXT: qcs.shot_init
+      %dur = quir.constant #quir.duration<5.000000e+02> : !quir.duration<dt>
+      quir.delay %dur, () : !quir.duration<dt>, () -> ()
+      qcs.shot_init {qcs.num_shots = 1000 : i32}
+      %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+      // the delay of the next shot elapses while the result is stored
+      // CHECK: quir.measure
+      // CHECK-NEXT: quir.delay %{{.*}}, ()
+      // CHECK-NEXT: oq3.variable_assign @m
+      %m = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+      oq3.variable_assign @m : i1 = %m
+    } {qcs.shot_loop}
+
+    // a delay which differs between shots stays in place
+    // CHECK: scf.for
+    // CHECK-NEXT: oq3.variable_load @n
+    // CHECK-NEXT: scf.if
+    // CHECK: quir.delay
+    // CHECK: qcs.shot_init
+    scf.for %arg0 = %c0 to %c1000 step %c1 {
+      %n = oq3.variable_load @n : i1
+      %dur = scf.if %n -> (!quir.duration<dt>) {
+        %long = quir.constant #quir.duration<1.000000e+03> : !quir.duration<dt>
+        scf.yield %long : !quir.duration<dt>
+      } else {
+        %short = quir.constant #quir.duration<5.000000e+02> : !quir.duration<dt>
+        scf.yield %short : !quir.duration<dt>
+      }
+      quir.delay %dur, () : !quir.duration<dt>, () -> ()
+      qcs.shot_init {qcs.num_shots = 1000 : i32}
+      %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+      %m = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+      oq3.variable_assign @n : i1 = %m
+    } {qcs.shot_loop}
+    qcs.finalize
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
@@ -46,3 +46,19 @@ func.func @t1 (%cond : i1) -> () {
   }
   return
 }
+
+// CHECK-LABEL: func.func @nested
+func.func @nested (%cond : i1, %qa : !quir.qubit<1>) -> () {
+  %q0 = quir.declare_qubit {id = 0: i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2: i32} : !quir.qubit<1>
+  scf.if %cond {
+    quir.call_gate @x(%q0) : (!quir.qubit<1>) -> ()
+    scf.if %cond {
+      quir.call_gate @x(%q2) : (!quir.qubit<1>) -> ()
+    }
+    // CHECK: {quir.physicalIds = [2 : i32]}
+    quir.call_gate @x(%qa) : (!quir.qubit<1>) -> ()
+  }
+  // CHECK: {quir.physicalIds = [-1 : i32, 0 : i32, 2 : i32]}
+  return
+}
@@ -0,0 +1,56 @@
+// RUN: qss-compiler -X=mlir --remove-unused-qubits %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --remove-unused-qubits=remove-idle-operations=true %s | FileCheck %s --check-prefix IDLE
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// qubit 1 is used by a subroutine only, e.g., after remove-qubit-args
+// CHECK-LABEL: func.func @sub
+// IDLE-LABEL: func.func @sub
+func.func @sub() {
+  // CHECK: quir.declare_qubit {id = 1 : i32}
+  // IDLE: quir.declare_qubit {id = 1 : i32}
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.call_gate @x(%q1) : (!quir.qubit<1>) -> ()
+  return
+}
+
+// CHECK-LABEL: func.func @main
+// IDLE-LABEL: func.func @main
+func.func @main() -> i32 {
+  // CHECK: %[[Q0:.*]] = quir.declare_qubit {id = 0 : i32}
+  // CHECK: %[[Q1:.*]] = quir.declare_qubit {id = 1 : i32}
+  // CHECK: %[[Q2:.*]] = quir.declare_qubit {id = 2 : i32}
+  // CHECK-NOT: quir.declare_qubit
+  // IDLE: %[[Q0:.*]] = quir.declare_qubit {id = 0 : i32}
+  // IDLE: %[[Q1:.*]] = quir.declare_qubit {id = 1 : i32}
+  // IDLE-NOT: quir.declare_qubit
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  %q2 = quir.declare_qubit {id = 2 : i32} : !quir.qubit<1>
+  %q3 = quir.declare_qubit {id = 3 : i32} : !quir.qubit<1>
+  %q4 = quir.declare_qubit {id = 4 : i32} : !quir.qubit<1>
+  // CHECK: quir.reset %[[Q0]], %[[Q2]]
+  // IDLE: quir.reset %[[Q0]] :
+  quir.reset %q0, %q2 : !quir.qubit<1>, !quir.qubit<1>
+  // IDLE-NOT: quir.delay
+  %dur = quir.constant #quir.duration<10.0> : !quir.duration<dt>
+  quir.delay %dur, (%q2) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+  // CHECK: quir.barrier %[[Q1]], %[[Q2]]
+  // IDLE: quir.barrier %[[Q1]] :
+  quir.barrier %q1, %q2 : (!quir.qubit<1>, !quir.qubit<1>) -> ()
+  quir.call_subroutine @sub() : () -> ()
+  %c0 = quir.measure(%q0) : (!quir.qubit<1>) -> i1
+  %zero = arith.constant 0 : i32
+  return %zero : i32
+}
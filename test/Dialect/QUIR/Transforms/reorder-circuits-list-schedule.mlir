@@ -0,0 +1,55 @@
+// RUN: qss-compiler -X=mlir --enable-circuits=true --reorder-circuits %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The call_circuits start as soon as the calls on their qubits complete,
+// with their durations taken from their circuits, and do not move across
+// the operations they may not commute with.
+
+module {
+  memref.global @a : memref<i1> = dense<false>
+  func.func private @external() -> ()
+  quir.circuit @long(%arg0: !quir.qubit<1>) -> i1 attributes {pulse.duration = 100 : i64} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  quir.circuit @short(%arg0: !quir.qubit<1>) -> i1 attributes {pulse.duration = 10 : i64} {
+    %0 = quir.measure(%arg0) : (!quir.qubit<1>) -> i1
+    quir.return %0: i1
+  }
+  // CHECK-LABEL: func.func @main()
+  func.func @main() -> i32 {
+    %0 = memref.get_global @a : memref<i1>
+    %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: [[Q0:%.*]] = quir.declare_qubit {id = 0 : i32}
+    // CHECK: [[Q1:%.*]] = quir.declare_qubit {id = 1 : i32}
+    // CHECK: [[M0:%.*]] = quir.call_circuit @long([[Q0]])
+    // CHECK-NEXT: quir.call_circuit @short([[Q1]])
+    // CHECK-NEXT: quir.call_circuit @short([[Q1]])
+    // CHECK-NEXT: affine.store [[M0]]
+    // CHECK-NEXT: quir.call_circuit @long([[Q0]])
+    // CHECK-NEXT: call @external()
+    // CHECK-NEXT: quir.call_circuit @short([[Q1]])
+    %1 = quir.call_circuit @long(%q0) : (!quir.qubit<1>) -> i1
+    affine.store %1, %0[] : memref<i1>
+    %2 = quir.call_circuit @long(%q0) : (!quir.qubit<1>) -> i1
+    %3 = quir.call_circuit @short(%q1) : (!quir.qubit<1>) -> i1
+    %4 = quir.call_circuit @short(%q1) : (!quir.qubit<1>) -> i1
+    func.call @external() : () -> ()
+    %5 = quir.call_circuit @short(%q1) : (!quir.qubit<1>) -> i1
+    %c0_i32 = arith.constant 0 : i32
+    return %c0_i32 : i32
+  }
+}
@@ -1,4 +1,5 @@
 // RUN: qss-compiler -X=mlir --enable-circuits=true --reorder-circuits %s | FileCheck %s
+// RUN: qss-compiler -X=mlir --enable-circuits=true --reorder-circuits=list-schedule=false %s | FileCheck %s
 
 //
 // This code is part of Qiskit.
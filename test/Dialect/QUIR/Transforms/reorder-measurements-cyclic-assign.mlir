@@ -0,0 +1,40 @@
+// RUN: qss-compiler --reorder-measures %s | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The chain of the cast used by the gate leads back to its own load, through
+// the assignment of the cast, so it may not be hoisted above the measurement
+// and the gate is not reordered.
+
+// CHECK: module
+module {
+  oq3.declare_variable @theta : !quir.angle<64>
+  // CHECK: func.func @main
+  func.func @main() -> i32 {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+    %1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+    // CHECK: quir.measure
+    // CHECK: oq3.variable_load @theta
+    // CHECK: oq3.cast
+    // CHECK: oq3.variable_assign @theta
+    // CHECK: quir.builtin_U
+    %2 = quir.measure(%0) : (!quir.qubit<1>) -> i1
+    %3 = oq3.variable_load @theta : !quir.angle<64>
+    %4 = "oq3.cast"(%3) : (!quir.angle<64>) -> !quir.angle<64>
+    oq3.variable_assign @theta : !quir.angle<64> = %4
+    quir.builtin_U %1, %4, %4, %4 : !quir.qubit<1>, !quir.angle<64>, !quir.angle<64>, !quir.angle<64>
+    return %c0_i32 : i32
+  }
+}
@@ -0,0 +1,67 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables=pack-variables=true %s | FileCheck %s
+//
+// This test verifies that private scalar variables are packed into a single
+// aligned buffer per element type, with the variables accessed in loops
+// placed first.
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: module
+module {
+  // CHECK: memref.global "private" @__quir_packed_variables_i32 : memref<2xi32> = uninitialized {alignment = 64 : i64}
+  // CHECK-NOT: memref.global
+  oq3.declare_variable @cold : i32
+  oq3.declare_variable @hot : i32
+  oq3.declare_variable @flag : !quir.cbit<1>
+  oq3.declare_variable {output} @out : i32
+
+  // CHECK: func.func @update
+  func.func @update(%n: index) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    // CHECK: [[BUFFER:%.*]] = memref.get_global @__quir_packed_variables_i32 : memref<2xi32>
+    // CHECK: scf.for
+    scf.for %i = %c0 to %n step %c1 {
+      // CHECK: [[HOT:%.*]] = affine.load [[BUFFER]][0] : memref<2xi32>
+      // CHECK: [[SUM:%.*]] = arith.addi [[HOT]], [[HOT]] : i32
+      // CHECK: affine.store [[SUM]], [[BUFFER]][0] : memref<2xi32>
+      %0 = oq3.variable_load @hot : i32
+      %1 = arith.addi %0, %0 : i32
+      oq3.variable_assign @hot : i32 = %1
+    }
+    return
+  }
+
+  // CHECK: func.func @main
+  func.func @main(%n: index) -> i32 {
+    // CHECK: [[BUFFER:%.*]] = memref.get_global @__quir_packed_variables_i32 : memref<2xi32>
+    // CHECK: affine.store {{.*}}, [[BUFFER]][1] : memref<2xi32>
+    // CHECK: affine.store {{.*}}, [[BUFFER]][0] : memref<2xi32>
+    %c1_i32 = arith.constant 1 : i32
+    oq3.variable_assign @cold : i32 = %c1_i32
+    oq3.variable_assign @hot : i32 = %c1_i32
+    call @update(%n) : (index) -> ()
+    // CHECK: call @update
+    // CHECK: affine.load [[BUFFER]][0] : memref<2xi32>
+    // CHECK: affine.load [[BUFFER]][1] : memref<2xi32>
+    %0 = oq3.variable_load @hot : i32
+    %1 = oq3.variable_load @cold : i32
+    %2 = arith.addi %0, %1 : i32
+    oq3.variable_assign @out : i32 = %2
+    %true = arith.constant true
+    %3 = "oq3.cast"(%true) : (i1) -> !quir.cbit<1>
+    oq3.variable_assign @flag : !quir.cbit<1> = %3
+    return %2 : i32
+  }
+}
@@ -0,0 +1,80 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables=reuse-variable-slots=true %s | FileCheck %s
+//
+// This test verifies that the private scalar variables of a block whose live
+// ranges do not overlap share a slot of the packed buffer of their type.
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: module
+module {
+  // @a, @b and @c share a slot, @acc is accessed in two functions, @keep is
+  // read before it is assigned and @d is live across a call
+  // CHECK: memref.global "private" @__quir_packed_variables_i32 : memref<4xi32> = uninitialized {alignment = 64 : i64}
+  // CHECK-NOT: memref.global
+  oq3.declare_variable @acc : i32
+  oq3.declare_variable @keep : i32
+  oq3.declare_variable @a : i32
+  oq3.declare_variable @b : i32
+  oq3.declare_variable @c : i32
+  oq3.declare_variable @d : i32
+  oq3.declare_variable {output} @out : i32
+
+  // CHECK: func.func @round
+  func.func @round(%n: index) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    // CHECK: [[BUFFER:%.*]] = memref.get_global @__quir_packed_variables_i32 : memref<4xi32>
+    // CHECK: scf.for
+    scf.for %i = %c0 to %n step %c1 {
+      // CHECK: affine.load [[BUFFER]][0] : memref<4xi32>
+      // CHECK: affine.store {{.*}}, [[BUFFER]][0] : memref<4xi32>
+      %0 = oq3.variable_load @acc : i32
+      %1 = arith.addi %0, %0 : i32
+      oq3.variable_assign @acc : i32 = %1
+    }
+    return
+  }
+
+  // CHECK: func.func @main
+  func.func @main(%n: index) -> i32 {
+    // CHECK: [[BUFFER:%.*]] = memref.get_global @__quir_packed_variables_i32 : memref<4xi32>
+    // CHECK: affine.load [[BUFFER]][2] : memref<4xi32>
+    // CHECK: affine.store {{.*}}, [[BUFFER]][2] : memref<4xi32>
+    %k = oq3.variable_load @keep : i32
+    %k1 = arith.addi %k, %k : i32
+    oq3.variable_assign @keep : i32 = %k1
+    // CHECK: affine.store {{.*}}, [[BUFFER]][1] : memref<4xi32>
+    // CHECK-NOT: [[BUFFER]][2]
+    // CHECK: affine.store {{.*}}, [[BUFFER]][3] : memref<4xi32>
+    %c1_i32 = arith.constant 1 : i32
+    oq3.variable_assign @a : i32 = %c1_i32
+    %0 = oq3.variable_load @a : i32
+    %1 = arith.addi %0, %0 : i32
+    oq3.variable_assign @b : i32 = %1
+    %2 = oq3.variable_load @b : i32
+    %3 = arith.addi %2, %2 : i32
+    oq3.variable_assign @c : i32 = %3
+    %4 = oq3.variable_load @c : i32
+    oq3.variable_assign @d : i32 = %4
+    // CHECK: call @round
+    // CHECK: affine.load [[BUFFER]][3] : memref<4xi32>
+    // CHECK: affine.load [[BUFFER]][0] : memref<4xi32>
+    call @round(%n) : (index) -> ()
+    %5 = oq3.variable_load @d : i32
+    %6 = oq3.variable_load @acc : i32
+    %7 = arith.addi %5, %6 : i32
+    oq3.variable_assign @out : i32 = %7
+    return %7 : i32
+  }
+}
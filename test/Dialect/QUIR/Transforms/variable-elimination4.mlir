@@ -0,0 +1,55 @@
+// RUN: qss-compiler -X=mlir --quir-eliminate-variables %s | FileCheck %s --implicit-check-not '!quir.cbit'
+//
+// This test verifies that bulk operations on multi-bit registers are lowered
+// to word-level operations.
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// CHECK: module
+module {
+  oq3.declare_variable @r : !quir.cbit<8>
+  func.func @main(%amount: i32, %narrow: i2) -> i32 {
+    %c5_i8 = arith.constant 5 : i8
+    %0 = "oq3.cast"(%c5_i8) : (i8) -> !quir.cbit<8>
+    oq3.variable_assign @r : !quir.cbit<8> = %0
+    %1 = oq3.variable_load @r : !quir.cbit<8>
+
+    // CHECK: [[ONES:%.*]] = arith.constant -1 : i8
+    // CHECK: [[NOT:%.*]] = llvm.xor {{.*}}, [[ONES]] : i8
+    %2 = oq3.cbit_not %1 : !quir.cbit<8>
+
+    // CHECK: [[REM:%.*]] = llvm.urem %arg0, {{.*}} : i32
+    // CHECK: [[ROTAMOUNT:%.*]] = llvm.trunc [[REM]] : i32 to i8
+    // CHECK: [[ROTL:%.*]] = llvm.intr.fshl([[NOT]], [[NOT]], [[ROTAMOUNT]])
+    %3 = oq3.cbit_rotl %2, %amount : (!quir.cbit<8>, i32) -> !quir.cbit<8>
+
+    // CHECK: [[SHIFTAMOUNT:%.*]] = llvm.trunc %arg0 : i32 to i8
+    // CHECK: [[SHL:%.*]] = llvm.shl [[ROTL]], [[SHIFTAMOUNT]] : i8
+    // CHECK: [[OUTOFRANGE:%.*]] = llvm.icmp "uge" %arg0, {{.*}} : i32
+    // CHECK: [[LSHIFT:%.*]] = llvm.select [[OUTOFRANGE]], {{.*}}, [[SHL]] : i1, i8
+    %4 = oq3.cbit_lshift %3, %amount : (!quir.cbit<8>, i32) -> !quir.cbit<8>
+
+    // a 2-bit amount is always narrower than the register
+    // CHECK: [[NARROWAMOUNT:%.*]] = llvm.zext %arg1 : i2 to i8
+    // CHECK-NOT: llvm.icmp
+    // CHECK: [[RSHIFT:%.*]] = llvm.lshr [[LSHIFT]], [[NARROWAMOUNT]] : i8
+    %5 = oq3.cbit_rshift %4, %narrow : (!quir.cbit<8>, i2) -> !quir.cbit<8>
+
+    // CHECK: [[COUNT:%.*]] = llvm.intr.ctpop([[RSHIFT]]) : (i8) -> i8
+    // CHECK: [[RESULT:%.*]] = llvm.zext [[COUNT]] : i8 to i32
+    // CHECK: return [[RESULT]] : i32
+    %6 = oq3.cbit_popcount %5 : (!quir.cbit<8>) -> i32
+    return %6 : i32
+  }
+}
@@ -0,0 +1,36 @@
+// RUN: qss-compiler -X=mlir --emit=bytecode %s -o %t.mlirbc
+// RUN: qss-compiler %t.mlirbc --emit=mlir | FileCheck %s
+// RUN: qss-compiler -X=mlir --emit=mlir --emit-bytecode %s -o %t.flag.mlirbc
+// RUN: qss-compiler -X=mlir %t.flag.mlirbc --emit=mlir | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that modules of the qss-compiler dialects round trip through
+// bytecode.
+
+// CHECK: oq3.declare_variable @cb : !quir.cbit<2>
+oq3.declare_variable @cb : !quir.cbit<2>
+
+// CHECK-LABEL: func.func @main
+func.func @main() {
+  // CHECK: qcs.init
+  qcs.init
+  // CHECK: quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  // CHECK: "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+  %p0 = "pulse.create_port"() {uid = "p0"} : () -> !pulse.port
+  // CHECK: qcs.finalize
+  qcs.finalize
+  return
+}
@@ -0,0 +1,20 @@
+// RUN: printf '%s\n' \
+// RUN:   '{"id": "str", "source": "OPENQASM 3.0;\nqubit $0;\nbit b;\nb = measure $0;\n", "inputType": "qasm", "emit": "mlir"}' \
+// RUN:   '{"id": "file", "source": "OPENQASM 3.0;\nqubit $0;\n", "inputType": "qasm", "numShots": 7, "output": "%t.mlir"}' \
+// RUN:   '' \
+// RUN:   '{"path": "%t.missing.qasm", "inputType": "qasm"}' \
+// RUN:   'not json' \
+// RUN:   '{"id": "both", "source": "", "path": "a.qasm"}' \
+// RUN:   | qss-compiler --batch-jsonl=2 | FileCheck %s
+// RUN: FileCheck %s --check-prefix FILE < %t.mlir
+// RUN: qss-compiler --batch-jsonl=two < /dev/null 2>&1 | FileCheck %s --check-prefix MALFORMED
+
+// CHECK-DAG: "id":"str","payload":"{{[A-Za-z0-9+/=]+}}","status":0,"timings":{"compileSeconds":
+// CHECK-DAG: "id":"file","output":"{{.*}}.mlir","status":0,
+// CHECK-DAG: "id":2,"status":1,
+// CHECK-DAG: "id":3,"status":1}
+// CHECK-DAG: "id":"both","status":1}
+
+// FILE: qcs.num_shots = 7 : i32
+
+// MALFORMED: Error: malformed --batch-jsonl job count
@@ -0,0 +1,44 @@
+// RUN: rm -rf %t && mkdir -p %t/out
+// RUN: cp %s %t/first.mlir && cp %s %t/second.mlir
+// RUN: echo %t/second.mlir > %t/inputs.txt
+// RUN: qss-opt --batch-input=%t/first.mlir --batch-input-list=%t/inputs.txt \
+// RUN:   --split-input-file --canonicalize --batch-output-dir=%t/out \
+// RUN:   | FileCheck %s
+// RUN: FileCheck %s --check-prefix OUT < %t/out/second.mlir
+// RUN: not qss-opt --batch-input=%t/first.mlir,%t/missing.mlir 2>/dev/null \
+// RUN:   | FileCheck %s --check-prefix MISSING
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that qss-opt processes batches of split input files and reports the
+// time spent on each.
+
+// CHECK: {"chunks":2,"input":"{{.*}}first.mlir","seconds":{{.*}},"status":0}
+// CHECK-NEXT: {"chunks":2,"input":"{{.*}}second.mlir","seconds":{{.*}},"status":0}
+
+// MISSING: {"chunks":1,"input":"{{.*}}first.mlir","seconds":{{.*}},"status":0}
+// MISSING-NEXT: {"chunks":0,"input":"{{.*}}missing.mlir","seconds":0,"status":1}
+
+// OUT: func.func @first
+// OUT: // -----
+// OUT: func.func @second
+func.func @first() {
+  return
+}
+
+// -----
+
+func.func @second() {
+  return
+}
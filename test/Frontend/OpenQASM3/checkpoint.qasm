@@ -0,0 +1,38 @@
+OPENQASM 3.0;
+// RUN: rm -rf %t
+// RUN: qss-compiler -X=qasm --emit=mlir --checkpoint-stages=frontend,passes --checkpoint-dir=%t/checkpoints --canonicalize %s -o %t/first.mlir
+// RUN: qss-compiler -X=qasm --emit=mlir --checkpoint-stages=frontend,passes --checkpoint-dir=%t/checkpoints --canonicalize %s -o %t/second.mlir --mlir-timing --mlir-disable-threading 2>&1 | FileCheck %s --check-prefix=PASSES
+// RUN: diff %t/first.mlir %t/second.mlir
+// RUN: FileCheck %s --input-file=%t/second.mlir
+// RUN: qss-compiler -X=qasm --emit=mlir --checkpoint-stages=frontend,passes --checkpoint-dir=%t/checkpoints --cse %s -o %t/third.mlir --mlir-timing --mlir-disable-threading 2>&1 | FileCheck %s --check-prefix=FRONTEND
+// RUN: FileCheck %s --input-file=%t/third.mlir
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that a compilation resumes from the checkpoint after the command line
+// passes, and from the checkpoint after the frontend once only the passes
+// change.
+
+// PASSES-NOT: {{load-qasm3|command-line-passes}}
+// PASSES: load-checkpoint
+// PASSES-NOT: {{load-qasm3|command-line-passes}}
+
+// FRONTEND-NOT: load-qasm3
+// FRONTEND: load-checkpoint
+// FRONTEND-NOT: load-qasm3
+
+// CHECK: quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+qubit $0;
+// CHECK: quir.reset
+reset $0;
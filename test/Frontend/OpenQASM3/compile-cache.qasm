@@ -0,0 +1,27 @@
+OPENQASM 3.0;
+// RUN: rm -rf %t
+// RUN: qss-compiler -X=qasm --emit=mlir --compile-cache-dir=%t/cache %s -o %t/first.mlir
+// RUN: qss-compiler -X=qasm --emit=mlir --compile-cache-dir=%t/cache %s -o %t/second.mlir
+// RUN: diff %t/first.mlir %t/second.mlir
+// RUN: FileCheck %s --input-file=%t/second.mlir
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that a compilation served from the compile cache matches the
+// original compilation.
+
+// CHECK: quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+qubit $0;
+// CHECK: quir.reset
+reset $0;
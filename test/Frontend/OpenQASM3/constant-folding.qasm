@@ -0,0 +1,45 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits=false | FileCheck %s --match-full-lines
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits=false | FileCheck %s --check-prefix FOLDED
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Expressions of literals are folded while generating QUIR, leaving a single
+// constant for each of them.
+
+qubit $0;
+// CHECK: oq3.variable_assign @flag : i1 = %true
+bool flag = true;
+
+// FOLDED-NOT: arith.cmpi
+// FOLDED-NOT: arith.andi
+
+// CHECK: %[[LT:.*]] = arith.constant true
+// CHECK-NEXT: scf.if %[[LT]] {
+if (2 < 100) {
+    U(0, 0, 0) $0;
+}
+
+// CHECK: %[[AND:.*]] = arith.constant false
+// CHECK-NEXT: scf.if %[[AND]] {
+if (1 == 1 && 3 != 3) {
+    U(0, 0, 0) $0;
+}
+
+// A conjunction with true is the other operand.
+// CHECK: %[[FLAG:.*]] = oq3.variable_load @flag : i1
+// CHECK-NEXT: scf.if %[[FLAG]] {
+if (flag && 1 < 2) {
+    U(0, 0, 0) $0;
+}
@@ -0,0 +1,32 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --emit=mlir %s --enable-circuits=false --qasm-dt-timestep=2e-9 | FileCheck %s
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// The durations of the program, including the shot delay, are emitted in dt
+// of the given timestep rather than in the units they are written in.
+// CHECK-NOT: !quir.duration<{{[mun]?s}}>
+
+qubit $0;
+
+// CHECK: quir.constant #quir.duration<{{.*}}> : !quir.duration<dt>
+// CHECK: quir.delay {{.*}}, ({{.*}}) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+delay[10ns] $0;
+// CHECK: quir.constant #quir.duration<{{.*}}> : !quir.duration<dt>
+// CHECK: quir.delay {{.*}}, ({{.*}}) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+delay[20us] $0;
+// durations written in dt are kept as they are
+// CHECK: quir.constant #quir.duration<4.000000e+01> : !quir.duration<dt>
+// CHECK: quir.delay {{.*}}, ({{.*}}) : !quir.duration<dt>, (!quir.qubit<1>) -> ()
+delay[40dt] $0;
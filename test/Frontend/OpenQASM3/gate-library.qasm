@@ -0,0 +1,29 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -X=qasm --direct -I=%S --emit=mlir 'OPENQASM 3.0; include "test-include.inc";' -o %t.lib.mlir
+// RUN: qss-compiler -I=%S --qasm-gate-library=%t.lib.mlir %s --emit=mlir | FileCheck %s
+// RUN: not qss-compiler -I=%S --qasm-gate-library=%t.missing.mlir %s --emit=mlir 2>&1 | FileCheck %s --check-prefix MISSING
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that the definitions of declared gates are linked from a precompiled
+// gate library and that the library's main function is not.
+
+// CHECK: func.func @rz
+// CHECK: func.func @main
+// CHECK-NOT: func.func @main
+include "test-include.inc";
+qubit $0;
+rz(0) $0;
+
+// MISSING: Failed to load gate library
@@ -0,0 +1,28 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --emit=mlir --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s --check-prefix FULL
+// RUN: qss-compiler %s --emit=mlir --qasm-locations=lines --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s --check-prefix LINES
+// RUN: qss-compiler %s --emit=mlir --qasm-locations=none --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s --check-prefix NONE
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that the operations generated from OpenQASM 3 are located at the line
+// and column of their statement, at its line only, or nowhere.
+
+qubit $0;
+
+// FULL: quir.delay {{.*}} loc("{{.*}}locations.qasm":{{[0-9]+}}:{{[1-9][0-9]*}})
+// LINES: quir.delay {{.*}} loc("{{.*}}locations.qasm":{{[0-9]+}}:0)
+// NONE: quir.delay {{.*}} loc(unknown)
+// NONE-NOT: locations.qasm
+delay[10ns] $0;
@@ -0,0 +1,39 @@
+OPENQASM 3.0;
+// RUN: qss-compiler %s --emit=mlir -o %t.ref.mlir
+// RUN: qss-compiler --qasm-streaming %s --emit=mlir -o %t.streaming.mlir
+// RUN: diff %t.ref.mlir %t.streaming.mlir
+// RUN: FileCheck %s --input-file=%t.streaming.mlir
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that lowering statement by statement generates the same QUIR as
+// lowering the whole AST at once.
+
+gate x q {
+  U(3.14159265358979, 0, 3.14159265358979) q;
+}
+
+qubit $0;
+bit b;
+
+// CHECK: quir.declare_qubit
+// CHECK: quir.delay
+delay[10ns] $0;
+x $0;
+// CHECK: quir.measure
+b = measure $0;
+if (b) {
+  x $0;
+}
+delay[160dt] $0;
@@ -0,0 +1,26 @@
+OPENQASM 3.0;
+// RUN: qss-compiler -I=%S %s --emit=mlir -o %t.ref.mlir
+// RUN: qss-compiler -I=%S --cache-qasm-includes %s --emit=mlir -o %t.cached.mlir
+// RUN: diff %t.ref.mlir %t.cached.mlir
+// RUN: FileCheck %s --input-file=%t.cached.mlir
+
+//
+// This code is part of Qiskit.
+//
+// (C) Copyright IBM 2024.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+
+// Check that includes expanded from the include cache compile as if the
+// parser had included them.
+
+// CHECK: func.func @rz
+include "test-include.inc";
+qubit $0;
+rz(0) $0;
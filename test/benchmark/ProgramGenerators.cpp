@@ -0,0 +1,336 @@
+//===- ProgramGenerators.cpp - Synthetic benchmark programs -----*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the generators of the large synthetic programs
+/// compiled by qssc-bench.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ProgramGenerators.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+using namespace qssc::bench;
+
+namespace {
+
+void emitHeader(llvm::raw_ostream &os, unsigned numQubits) {
+  os << "OPENQASM 3.0;\n\n";
+  os << "gate cx control, target { }\n";
+  os << "gate sx q { }\n";
+  os << "gate rz(phi) q { }\n";
+  os << "gate x q { }\n";
+  os << "gate y q { }\n\n";
+  for (unsigned q = 0; q < numQubits; ++q)
+    os << "qubit $" << q << ";\n";
+  for (unsigned q = 0; q < numQubits; ++q)
+    os << "bit c" << q << ";\n";
+  os << "\n";
+}
+
+void emitMeasureAll(llvm::raw_ostream &os, unsigned numQubits) {
+  for (unsigned q = 0; q < numQubits; ++q)
+    os << "c" << q << " = measure $" << q << ";\n";
+}
+
+} // anonymous namespace
+
+std::string qssc::bench::generateCircuit(unsigned numQubits, unsigned depth) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  emitHeader(os, numQubits);
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    for (unsigned q = 0; q < numQubits; ++q)
+      os << "U(" << 0.01 * (layer % 100 + 1) << ", 0.0, " << 0.02 * (q + 1)
+         << ") $" << q << ";\n";
+    for (unsigned q = layer % 2; q + 1 < numQubits; q += 2)
+      os << "cx $" << q << ", $" << q + 1 << ";\n";
+  }
+  emitMeasureAll(os, numQubits);
+  return program;
+}
+
+std::string qssc::bench::generateDynamicCircuit(unsigned numQubits,
+                                                unsigned depth) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  emitHeader(os, numQubits);
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    unsigned const measured = layer % numQubits;
+    unsigned const target = (measured + 1) % numQubits;
+    os << "sx $" << measured << ";\n";
+    os << "c" << measured << " = measure $" << measured << ";\n";
+    os << "if (c" << measured << ") {\n";
+    os << "  x $" << target << ";\n";
+    os << "}\n";
+  }
+  emitMeasureAll(os, numQubits);
+  return program;
+}
+
+std::string qssc::bench::generateParameterSweep(unsigned numQubits,
+                                                unsigned depth,
+                                                unsigned numParameters) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  emitHeader(os, numQubits);
+  for (unsigned p = 0; p < numParameters; ++p)
+    os << "input angle theta" << p << " = " << 0.1 * (p + 1) << ";\n";
+  os << "\n";
+  unsigned parameter = 0;
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    for (unsigned q = 0; q < numQubits; ++q) {
+      os << "sx $" << q << ";\n";
+      os << "rz(theta" << parameter << ") $" << q << ";\n";
+      parameter = (parameter + 1) % numParameters;
+    }
+    for (unsigned q = layer % 2; q + 1 < numQubits; q += 2)
+      os << "cx $" << q << ", $" << q + 1 << ";\n";
+  }
+  emitMeasureAll(os, numQubits);
+  return program;
+}
+
+std::string qssc::bench::generateDynamicalDecoupling(unsigned numQubits,
+                                                     unsigned depth) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  emitHeader(os, numQubits);
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    os << "c0 = measure $0;\n";
+    for (unsigned q = 1; q < numQubits; ++q) {
+      for (char const *gate : {"x", "y", "x", "y"}) {
+        os << "delay[80dt] $" << q << ";\n";
+        os << gate << " $" << q << ";\n";
+      }
+      os << "delay[80dt] $" << q << ";\n";
+    }
+  }
+  emitMeasureAll(os, numQubits);
+  return program;
+}
+
+std::string qssc::bench::generateClassicalScopes(unsigned numQubits,
+                                                 unsigned depth) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  emitHeader(os, numQubits);
+  os << "int count = 0;\n\n";
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    unsigned const measured = layer % numQubits;
+    unsigned const target = (measured + 1) % numQubits;
+    os << "duration d" << layer << " = " << 16 * (1 + layer % 8) << "dt;\n";
+    os << "int n" << layer << " = " << layer << ";\n";
+    os << "c" << measured << " = measure $" << measured << ";\n";
+    os << "if (c" << measured << ") {\n";
+    os << "  delay[d" << layer << "] $" << target << ";\n";
+    os << "  if (n" << layer << " > count) {\n";
+    os << "    x $" << target << ";\n";
+    os << "    count = n" << layer << ";\n";
+    os << "  }\n";
+    os << "} else {\n";
+    os << "  delay[d" << layer << "] $" << measured << ";\n";
+    os << "}\n";
+  }
+  emitMeasureAll(os, numQubits);
+  return program;
+}
+
+std::string qssc::bench::generatePulseSequences(unsigned numFrames,
+                                                unsigned depth) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  os << "module {\n";
+  os << "  pulse.sequence @sequence(";
+  for (unsigned f = 0; f < numFrames; ++f)
+    os << (f ? ", " : "") << "%frame" << f << ": !pulse.mixed_frame";
+  os << ") -> i1 {\n";
+  os << "    %dur = arith.constant 160 : i32\n";
+  os << "    %sigma = arith.constant 40 : i32\n";
+  os << "    %delay = arith.constant 16 : i32\n";
+  os << "    %beta = arith.constant 0.5 : f64\n";
+  for (unsigned a = 0; a < 4; ++a)
+    os << "    %amp" << a << " = complex.constant [" << 0.1 * (a + 1)
+       << ", 0.0] : complex<f64>\n";
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    for (unsigned f = 0; f < numFrames; ++f) {
+      std::string const waveform =
+          "%w" + std::to_string(layer) + "_" + std::to_string(f);
+      std::string const amp = "%amp" + std::to_string((layer + f) % 4);
+      if (layer % 2)
+        os << "    " << waveform << " = pulse.drag(%dur, " << amp
+           << ", %sigma, %beta) : (i32, complex<f64>, i32, f64) -> "
+              "!pulse.waveform\n";
+      else
+        os << "    " << waveform << " = pulse.gaussian(%dur, " << amp
+           << ", %sigma) : (i32, complex<f64>, i32) -> !pulse.waveform\n";
+      os << "    pulse.play(%frame" << f << ", " << waveform
+         << ") : (!pulse.mixed_frame, !pulse.waveform)\n";
+      for (unsigned d = 0; d < 2; ++d)
+        os << "    pulse.delay(%frame" << f
+           << ", %delay) : (!pulse.mixed_frame, i32)\n";
+    }
+  }
+  os << "    %false = arith.constant false\n";
+  os << "    pulse.return %false : i1\n";
+  os << "  }\n";
+  os << "}\n";
+  return program;
+}
+
+std::string qssc::bench::generatePulseCallGraph(unsigned numSequences,
+                                                unsigned numCalls) {
+  std::string const arguments = "(%port, %frame0, %frame1)";
+  std::string const signature =
+      "(!pulse.port, !pulse.mixed_frame, !pulse.mixed_frame) -> i1";
+  std::string const parameters = "(%port: !pulse.port, %frame0: "
+                                 "!pulse.mixed_frame, %frame1: "
+                                 "!pulse.mixed_frame) -> i1";
+
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  os << "module {\n";
+  os << "  func.func @main() -> i32 {\n";
+  os << "    %port = \"pulse.create_port\"() {uid = \"p0\"} : () -> "
+        "!pulse.port\n";
+  for (unsigned f = 0; f < 2; ++f)
+    os << "    %frame" << f << " = \"pulse.mix_frame\"(%port) {uid = \"mf" << f
+       << "-p0\"} : (!pulse.port) -> !pulse.mixed_frame\n";
+  for (unsigned c = 0; c < numCalls; ++c)
+    for (unsigned s = 0; s < numSequences; ++s)
+      os << "    %r" << c << "_" << s << " = pulse.call_sequence @outer" << s
+         << arguments << " : " << signature << "\n";
+  os << "    %c0_i32 = arith.constant 0 : i32\n";
+  os << "    return %c0_i32 : i32\n";
+  os << "  }\n";
+  for (unsigned s = 0; s < numSequences; ++s) {
+    os << "  pulse.sequence @outer" << s << parameters << " {\n";
+    os << "    %0 = pulse.call_sequence @inner" << s << arguments << " : "
+       << signature << "\n";
+    os << "    pulse.return %0 : i1\n";
+    os << "  }\n";
+    os << "  pulse.sequence @inner" << s << parameters << " {\n";
+    os << "    %delay = arith.constant 16 : i32\n";
+    os << "    pulse.delay(%frame0, %delay) : (!pulse.mixed_frame, i32)\n";
+    os << "    %false = arith.constant false\n";
+    os << "    pulse.return %false : i1\n";
+    os << "  }\n";
+  }
+  os << "}\n";
+  return program;
+}
+
+std::string qssc::bench::generateAngleArithmetic(unsigned numAngles,
+                                                 unsigned depth) {
+  std::string const angleType = "!quir.angle<20>";
+
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  os << "module @controller attributes {quir.nodeId = 1000 : ui32, "
+        "quir.nodeType = \"controller\"} {\n";
+  os << "  func.func @phases(";
+  for (unsigned a = 0; a < numAngles; ++a)
+    os << "%p0_" << a << ": " << angleType << ", ";
+  os << "%step: " << angleType << ", %scale: " << angleType << ") -> (";
+  for (unsigned a = 0; a < numAngles; ++a)
+    os << (a ? ", " : "") << angleType;
+  os << ") {\n";
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    // the angles of a layer only depend on the previous layer
+    const char *op = layer % 2 ? "oq3.angle_mul" : "oq3.angle_add";
+    const char *operand = layer % 2 ? "%scale" : "%step";
+    for (unsigned a = 0; a < numAngles; ++a)
+      os << "    %p" << layer + 1 << "_" << a << " = " << op << " %p" << layer
+         << "_" << a << ", " << operand << " : " << angleType << "\n";
+  }
+  os << "    return ";
+  for (unsigned a = 0; a < numAngles; ++a)
+    os << (a ? ", " : "") << "%p" << depth << "_" << a;
+  os << " : ";
+  for (unsigned a = 0; a < numAngles; ++a)
+    os << (a ? ", " : "") << angleType;
+  os << "\n";
+  os << "  }\n";
+  os << "  func.func @main() -> i32 {\n";
+  os << "    %c0_i32 = arith.constant 0 : i32\n";
+  os << "    return %c0_i32 : i32\n";
+  os << "  }\n";
+  os << "}\n";
+  return program;
+}
+
+std::string qssc::bench::generateDecodingLoops(unsigned numBits,
+                                               unsigned depth) {
+  std::string const bitsType = "memref<" + std::to_string(numBits + 1) + "xi8>";
+
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  os << "module @controller attributes {quir.nodeId = 1000 : ui32, "
+        "quir.nodeType = \"controller\"} {\n";
+  for (unsigned layer = 0; layer <= depth; ++layer)
+    os << "  memref.global \"private\" @layer" << layer << " : " << bitsType
+       << " = dense<0>\n";
+  os << "  func.func @decode() {\n";
+  os << "    %c0 = arith.constant 0 : index\n";
+  os << "    %c1 = arith.constant 1 : index\n";
+  os << "    %cn = arith.constant " << numBits << " : index\n";
+  for (unsigned layer = 0; layer <= depth; ++layer)
+    os << "    %layer" << layer << " = memref.get_global @layer" << layer
+       << " : " << bitsType << "\n";
+  for (unsigned layer = 0; layer < depth; ++layer) {
+    // the syndromes of a layer only depend on the previous layer
+    os << "    scf.for %i" << layer << " = %c0 to %cn step %c1 {\n";
+    os << "      %next" << layer << " = arith.addi %i" << layer
+       << ", %c1 : index\n";
+    os << "      %lhs" << layer << " = memref.load %layer" << layer << "[%i"
+       << layer << "] : " << bitsType << "\n";
+    os << "      %rhs" << layer << " = memref.load %layer" << layer
+       << "[%next" << layer << "] : " << bitsType << "\n";
+    os << "      %s" << layer << " = arith.xori %lhs" << layer << ", %rhs"
+       << layer << " : i8\n";
+    os << "      memref.store %s" << layer << ", %layer" << layer + 1 << "[%i"
+       << layer << "] : " << bitsType << "\n";
+    os << "    }\n";
+  }
+  os << "    return\n";
+  os << "  }\n";
+  os << "  func.func @main() -> i32 {\n";
+  os << "    call @decode() : () -> ()\n";
+  os << "    %c0_i32 = arith.constant 0 : i32\n";
+  os << "    return %c0_i32 : i32\n";
+  os << "  }\n";
+  os << "}\n";
+  return program;
+}
+
+std::string qssc::bench::generateMockConfig(unsigned numQubits,
+                                            unsigned multiplexingRatio,
+                                            unsigned instrumentsPerRack) {
+  unsigned const numAcquires =
+      (numQubits + multiplexingRatio - 1) / multiplexingRatio;
+
+  std::string config;
+  llvm::raw_string_ostream os(config);
+  os << "num_qubits " << numQubits << "\n";
+  os << "acquire_multiplexing_ratio_to_1 " << multiplexingRatio << "\n";
+  os << "controllerNodeId " << numQubits + numAcquires << "\n";
+  if (instrumentsPerRack)
+    os << "instruments_per_rack " << instrumentsPerRack << "\n";
+  return config;
+}
@@ -0,0 +1,86 @@
+//===- ProgramGenerators.h - Synthetic benchmark programs -------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the generators of the large synthetic programs, and of
+/// the configurations of the systems they are compiled for, by qssc-bench.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef QSSC_BENCH_PROGRAMGENERATORS_H
+#define QSSC_BENCH_PROGRAMGENERATORS_H
+
+#include <string>
+
+namespace qssc::bench {
+
+/// Generate an OpenQASM 3 circuit of depth layers of single qubit rotations
+/// on numQubits qubits, each followed by a ladder of cx gates, measuring all
+/// qubits at the end.
+std::string generateCircuit(unsigned numQubits, unsigned depth);
+
+/// Generate an OpenQASM 3 dynamic circuit in which each of the depth layers
+/// measures a qubit and conditionally flips its neighbour on the result.
+std::string generateDynamicCircuit(unsigned numQubits, unsigned depth);
+
+/// Generate an OpenQASM 3 circuit of depth layers of rotations by
+/// numParameters input angles, cycling through the parameters, for sweeping
+/// the parameters by binding arguments.
+std::string generateParameterSweep(unsigned numQubits, unsigned depth,
+                                   unsigned numParameters);
+
+/// Generate an OpenQASM 3 circuit of depth layers of XY4 dynamical
+/// decoupling sequences on idle qubits around a measurement of qubit 0.
+std::string generateDynamicalDecoupling(unsigned numQubits, unsigned depth);
+
+/// Generate an OpenQASM 3 dynamic circuit declaring a duration and an
+/// integer in each of the depth layers and using them in nested conditional
+/// blocks, for benchmarking the scoping of identifiers in QUIR generation.
+std::string generateClassicalScopes(unsigned numQubits, unsigned depth);
+
+/// Generate pulse dialect MLIR playing depth parametric waveforms with
+/// constant parameters on each of numFrames mixed frames, separated by
+/// delays, for benchmarking the pulse lowering passes.
+std::string generatePulseSequences(unsigned numFrames, unsigned depth);
+
+/// Generate lowered pulse dialect MLIR in which main calls each of
+/// numSequences sequences numCalls times, each sequence calling a sequence
+/// of its own which only uses one of its three arguments, for benchmarking
+/// the passes on the call graph of the sequences.
+std::string generatePulseCallGraph(unsigned numSequences, unsigned numCalls);
+
+/// Generate a mock controller module tracking the phases of numAngles angles
+/// through depth layers of independent angle additions and multiplications,
+/// for benchmarking the lowering of angle-heavy control code.
+std::string generateAngleArithmetic(unsigned numAngles, unsigned depth);
+
+/// Generate a mock controller module decoding numBits data bytes through
+/// depth loops, each computing the syndromes of neighbouring bytes from those
+/// of the previous loop, for benchmarking the lowering of loops over the
+/// registers of the controller.
+std::string generateDecodingLoops(unsigned numBits, unsigned depth);
+
+/// Generate the configuration of a mock system of numQubits qubits, the
+/// acquire of each group of multiplexingRatio qubits being a node of its own,
+/// with the controller numbered after the drive and acquire nodes. The
+/// instruments are grouped in racks of instrumentsPerRack nodes unless it
+/// is 0.
+std::string generateMockConfig(unsigned numQubits, unsigned multiplexingRatio,
+                               unsigned instrumentsPerRack = 0);
+
+} // namespace qssc::bench
+
+#endif // QSSC_BENCH_PROGRAMGENERATORS_H
@@ -0,0 +1,846 @@
+//===- qssc-bench.cpp - QSS compiler benchmark suite ------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the benchmarks of the stages of the compiler on large
+/// synthetic programs. Each stage is measured separately on the output of the
+/// previous stages, which is prepared outside of the timed loop:
+///
+///   Parse           OpenQASM 3 to AST
+///   QUIRGeneration  OpenQASM 3 to QUIR
+///   QUIRPipeline    QUIR transformations
+///   PulseLowering   pulse transformations, on generated pulse sequences
+///   PulseCallGraph  pulse transformations of the call graph of sequences,
+///                   on generated lowered pulse modules
+///   AngleArithmetic lowering of angle arithmetic of a generated mock
+///                   controller module into a payload, with and without
+///                   vectorizing independent angle operations
+///   DecodingLoops   lowering of the loops of a generated mock controller
+///                   decoding kernel into a payload, with and without
+///                   vectorizing their iterations
+///   QubitLocalization
+///                   the mock conversion, i.e., the localization of a
+///                   generated circuit into the modules of the mock nodes,
+///                   on a mock configuration with as many qubits
+///   OpDispatch      dispatch over the kinds of the quantum operations of
+///                   a generated QUIR module, by a chain of dyn_casts as
+///                   opposed to a quir::OpDispatcher
+///   TargetPasses    target passes, --compile-target-ir
+///   TargetCodegen   target code generation into a payload
+///   PayloadWrite    archiving of payload files
+///   Link            binding arguments, skipped if the target cannot bind
+///   CostModel       OpenQASM 3 to a payload, reporting the compile cost
+///                   estimated by qssc::estimateCompileCost alongside, for
+///                   calibrating qssc::CompileCostModel
+///   EndToEnd        OpenQASM 3 to QUIR, target IR and a payload in turn,
+///                   on a generated mock system configuration with as many
+///                   qubits as the program, flat or in racks of 64
+///                   instruments, reporting the time and peak memory growth
+///                   of each stage
+///   Startup         qss-compiler --version, a link and a minimal compile,
+///                   each in a new process, and the import of the
+///                   qss_compiler Python package with and without loading
+///                   the compiler
+///
+/// The target and its configuration default to the mock target and may be
+/// selected with QSSC_BENCH_TARGET and QSSC_BENCH_CONFIG.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ProgramGenerators.h"
+
+#include "API/api.h"
+#include "API/errors.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/OpDispatch.h"
+#include "Dialect/RegisterDialects.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <benchmark/benchmark.h>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace qssc::bench;
+
+namespace {
+
+std::string getEnv(const char *name, const char *defaultValue) {
+  const char *value = std::getenv(name);
+  return value ? value : defaultValue;
+}
+
+const std::string &getTarget() {
+  static const std::string target = getEnv("QSSC_BENCH_TARGET", "mock");
+  return target;
+}
+
+const std::string &getTargetConfig() {
+  static const std::string config =
+      getEnv("QSSC_BENCH_CONFIG", QSSC_BENCH_MOCK_CONFIG);
+  return config;
+}
+
+/// Compile with a warm compiler so that the one-time setup of the target is
+/// not measured. Returns false after reporting the error to the benchmark.
+bool compile(benchmark::State &state, std::vector<std::string> args,
+             std::string *output) {
+  static qssc::CompileServer server;
+
+  args.insert(args.begin(), "qss-compiler");
+  std::vector<const char *> argv;
+  argv.reserve(args.size() + 1);
+  for (auto &arg : args)
+    argv.push_back(arg.c_str());
+  argv.push_back(nullptr);
+
+  std::string errors;
+  int const status = server.compile(
+      static_cast<int>(args.size()), argv.data(), output,
+      [&](const qssc::Diagnostic &diagnostic) {
+        if (diagnostic.severity >= qssc::Severity::Error)
+          errors += diagnostic.toString() + "\n";
+      });
+  if (status != 0) {
+    state.SkipWithError(("compilation failed:\n" + errors).c_str());
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> targetArgs() {
+  return {"--target", getTarget(), "--config", getTargetConfig()};
+}
+
+std::vector<std::string> directInput(const char *inputType, std::string input) {
+  return {std::string("-X=") + inputType, "--direct", std::move(input)};
+}
+
+std::vector<std::string> concat(std::vector<std::string> args,
+                                const std::vector<std::string> &more) {
+  args.insert(args.end(), more.begin(), more.end());
+  return args;
+}
+
+/// Write contents to a new temporary file at path. Returns false after
+/// reporting the error to the benchmark.
+bool writeTemporaryFile(benchmark::State &state, llvm::StringRef suffix,
+                        llvm::StringRef contents,
+                        llvm::SmallVectorImpl<char> &path) {
+  if (auto ec =
+          llvm::sys::fs::createTemporaryFile("qssc-bench", suffix, path)) {
+    state.SkipWithError(ec.message().c_str());
+    return false;
+  }
+  std::error_code ec;
+  llvm::raw_fd_ostream os(llvm::StringRef(path.data(), path.size()), ec);
+  if (ec) {
+    state.SkipWithError(ec.message().c_str());
+    return false;
+  }
+  os << contents;
+  return true;
+}
+
+/// The peak resident set size of this process in bytes, 0 if unknown.
+uint64_t getPeakResidentBytes() {
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+/// The QUIR of an OpenQASM 3 program.
+bool generateQUIR(benchmark::State &state, const std::string &program,
+                  std::string *quir) {
+  return compile(state,
+                 concat(directInput("qasm", program),
+                        {"--emit=mlir", "--enable-circuits=false"}),
+                 quir);
+}
+
+/// The QUIR of an OpenQASM 3 program after the target passes.
+bool generateTargetIR(benchmark::State &state, const std::string &program,
+                      std::string *targetIR) {
+  std::string quir;
+  if (!generateQUIR(state, program, &quir))
+    return false;
+  return compile(state,
+                 concat(concat(directInput("mlir", quir), targetArgs()),
+                        {"--emit=mlir", "--compile-target-ir"}),
+                 targetIR);
+}
+
+/// Time repeated compilations with the same arguments.
+void runCompilations(benchmark::State &state,
+                     const std::vector<std::string> &args,
+                     size_t inputBytes) {
+  std::string output;
+  for (auto _ : state) {
+    output.clear();
+    if (!compile(state, args, &output))
+      return;
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(inputBytes));
+  state.counters["output_bytes"] = static_cast<double>(output.size());
+}
+
+using ProgramGenerator = std::function<std::string(const benchmark::State &)>;
+
+void benchParse(benchmark::State &state, const ProgramGenerator &generator) {
+  auto const program = generator(state);
+  runCompilations(state, concat(directInput("qasm", program), {"--emit=ast"}),
+                  program.size());
+}
+
+void benchQUIRGeneration(benchmark::State &state,
+                         const ProgramGenerator &generator) {
+  auto const program = generator(state);
+  runCompilations(state,
+                  concat(directInput("qasm", program),
+                         {"--emit=mlir", "--enable-circuits=false"}),
+                  program.size());
+}
+
+void benchQUIRPipeline(benchmark::State &state,
+                       const ProgramGenerator &generator) {
+  std::string quir;
+  if (!generateQUIR(state, generator(state), &quir))
+    return;
+  runCompilations(state,
+                  concat(directInput("mlir", quir),
+                         {"--emit=mlir", "--break-reset",
+                          "--subroutine-cloning", "--remove-qubit-args",
+                          "--classical-only-detection",
+                          "--merge-measures-lexographical",
+                          "--quir-eliminate-loads", "--canonicalize"}),
+                  quir.size());
+}
+
+void benchTargetPasses(benchmark::State &state,
+                       const ProgramGenerator &generator) {
+  std::string quir;
+  if (!generateQUIR(state, generator(state), &quir))
+    return;
+  runCompilations(state,
+                  concat(concat(directInput("mlir", quir), targetArgs()),
+                         {"--emit=mlir", "--compile-target-ir"}),
+                  quir.size());
+}
+
+void benchTargetCodegen(benchmark::State &state,
+                        const ProgramGenerator &generator) {
+  std::string targetIR;
+  if (!generateTargetIR(state, generator(state), &targetIR))
+    return;
+  runCompilations(state,
+                  concat(concat(directInput("mlir", targetIR), targetArgs()),
+                         {"--emit=qem", "--bypass-payload-target-compilation"}),
+                  targetIR.size());
+}
+
+void benchCostModel(benchmark::State &state,
+                    const ProgramGenerator &generator) {
+  auto const program = generator(state);
+  auto const args = concat(concat(directInput("qasm", program), targetArgs()),
+                           {"--emit=qem"});
+
+  std::vector<std::string> estimateArgs = args;
+  estimateArgs.insert(estimateArgs.begin(), "qss-compiler");
+  std::vector<const char *> argv;
+  for (auto &arg : estimateArgs)
+    argv.push_back(arg.c_str());
+  argv.push_back(nullptr);
+
+  qssc::CompileCostEstimate estimate;
+  auto const started = std::chrono::steady_clock::now();
+  if (qssc::estimateCompileCost(static_cast<int>(estimateArgs.size()),
+                                argv.data(), &estimate, std::nullopt) != 0) {
+    state.SkipWithError("compile cost estimation failed");
+    return;
+  }
+  std::chrono::duration<double> const estimateTime =
+      std::chrono::steady_clock::now() - started;
+
+  runCompilations(state, args, program.size());
+  state.counters["estimate_seconds"] = estimateTime.count();
+  state.counters["estimated_seconds"] = estimate.seconds;
+  state.counters["estimated_peak_bytes"] =
+      static_cast<double>(estimate.peakMemoryBytes);
+  state.counters["operations"] =
+      static_cast<double>(estimate.features.numOperations);
+  state.counters["qubits"] = static_cast<double>(estimate.features.numQubits);
+  state.counters["circuits"] =
+      static_cast<double>(estimate.features.numCircuits);
+  state.counters["targets"] = static_cast<double>(estimate.features.numTargets);
+}
+
+void benchEndToEnd(benchmark::State &state,
+                   const ProgramGenerator &generator) {
+  if (getTarget() != "mock") {
+    state.SkipWithError("the system configurations are generated for the "
+                        "mock target");
+    return;
+  }
+  auto const program = generator(state);
+  llvm::SmallString<128> configPath;
+  if (!writeTemporaryFile(
+          state, "cfg",
+          generateMockConfig(static_cast<unsigned>(state.range(0)), 5,
+                             static_cast<unsigned>(state.range(2))),
+          configPath))
+    return;
+  llvm::FileRemover const configRemover(configPath);
+  std::vector<std::string> const systemArgs = {"--target", "mock", "--config",
+                                               configPath.str().str()};
+
+  // each stage compiles the output of the previous one
+  using StageArgs = std::function<std::vector<std::string>(std::string)>;
+  std::pair<const char *, StageArgs> const stages[] = {
+      {"quir",
+       [](std::string input) {
+         return concat(directInput("qasm", std::move(input)),
+                       {"--emit=mlir", "--enable-circuits=false"});
+       }},
+      {"target_ir",
+       [&](std::string input) {
+         return concat(concat(directInput("mlir", std::move(input)),
+                              systemArgs),
+                       {"--emit=mlir", "--compile-target-ir"});
+       }},
+      {"payload",
+       [&](std::string input) {
+         return concat(concat(directInput("mlir", std::move(input)),
+                              systemArgs),
+                       {"--emit=qem", "--bypass-payload-target-compilation"});
+       }},
+  };
+
+  std::vector<double> seconds(std::size(stages));
+  std::vector<uint64_t> peakGrowth(std::size(stages));
+  std::string output;
+  for (auto _ : state) {
+    std::string input = program;
+    for (size_t i = 0; i < std::size(stages); ++i) {
+      uint64_t const peakBefore = getPeakResidentBytes();
+      auto const started = std::chrono::steady_clock::now();
+      output.clear();
+      if (!compile(state, stages[i].second(std::move(input)), &output))
+        return;
+      std::chrono::duration<double> const stageTime =
+          std::chrono::steady_clock::now() - started;
+      seconds[i] += stageTime.count();
+      peakGrowth[i] =
+          std::max(peakGrowth[i], getPeakResidentBytes() - peakBefore);
+      input = std::move(output);
+    }
+    benchmark::DoNotOptimize(input.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(program.size()));
+  // the peak grows in the first iteration only, in the stage which reached it
+  for (size_t i = 0; i < std::size(stages); ++i) {
+    std::string const name = stages[i].first;
+    state.counters[name + "_seconds"] =
+        benchmark::Counter(seconds[i], benchmark::Counter::kAvgIterations);
+    state.counters[name + "_peak_growth_bytes"] =
+        static_cast<double>(peakGrowth[i]);
+  }
+  state.counters["peak_bytes"] = static_cast<double>(getPeakResidentBytes());
+}
+
+void benchPulseLowering(benchmark::State &state) {
+  auto const sequences = generatePulseSequences(
+      static_cast<unsigned>(state.range(0)),
+      static_cast<unsigned>(state.range(1)));
+  runCompilations(state,
+                  concat(directInput("mlir", sequences),
+                         {"--emit=mlir", "--pulse-sample-waveforms",
+                          "--pulse-deduplicate-waveforms",
+                          "--pulse-merge-delay"}),
+                  sequences.size());
+}
+
+void benchPulseCallGraph(benchmark::State &state) {
+  auto const module = generatePulseCallGraph(
+      static_cast<unsigned>(state.range(0)),
+      static_cast<unsigned>(state.range(1)));
+  runCompilations(state,
+                  concat(directInput("mlir", module),
+                         {"--emit=mlir", "--pulse-remove-unused-arguments"}),
+                  module.size());
+}
+
+void benchAngleArithmetic(benchmark::State &state) {
+  if (getTarget() != "mock") {
+    state.SkipWithError("the angle arithmetic is lowered by the mock target");
+    return;
+  }
+  auto const module = generateAngleArithmetic(
+      static_cast<unsigned>(state.range(0)),
+      static_cast<unsigned>(state.range(1)));
+  std::string const pipeline =
+      std::string("--pass-pipeline=builtin.module(mock-quir-to-std{"
+                  "vectorize-angles=") +
+      (state.range(2) ? "true" : "false") + "})";
+  runCompilations(state,
+                  concat(concat(directInput("mlir", module), targetArgs()),
+                         {pipeline, "--emit=qem"}),
+                  module.size());
+}
+
+void benchDecodingLoops(benchmark::State &state) {
+  if (getTarget() != "mock") {
+    state.SkipWithError("the decoding loops are lowered by the mock target");
+    return;
+  }
+  auto const module =
+      generateDecodingLoops(static_cast<unsigned>(state.range(0)),
+                            static_cast<unsigned>(state.range(1)));
+  std::string const pipeline =
+      std::string("--pass-pipeline=builtin.module(mock-quir-to-std{"
+                  "vectorize-loops=") +
+      (state.range(2) ? "true" : "false") + "})";
+  runCompilations(state,
+                  concat(concat(directInput("mlir", module), targetArgs()),
+                         {pipeline, "--emit=qem"}),
+                  module.size());
+}
+
+void benchQubitLocalization(benchmark::State &state) {
+  if (getTarget() != "mock") {
+    state.SkipWithError("the qubits are localized by the mock target");
+    return;
+  }
+  auto const numQubits = static_cast<unsigned>(state.range(0));
+  std::string quir;
+  if (!generateQUIR(state,
+                    generateCircuit(numQubits,
+                                    static_cast<unsigned>(state.range(1))),
+                    &quir))
+    return;
+
+  // the nodes of the configuration scale with its qubits
+  llvm::SmallString<128> configPath;
+  if (!writeTemporaryFile(state, "cfg", generateMockConfig(numQubits, 5),
+                          configPath))
+    return;
+  llvm::FileRemover const configRemover(configPath);
+  std::string const config = configPath.str().str();
+  runCompilations(state,
+                  concat(directInput("mlir", quir),
+                         {"--target", "mock", "--config", config,
+                          "--mock-conversion", "--emit=mlir"}),
+                  quir.size());
+}
+
+/// Call visitor with op cast to the first of OpTys it is, trying each in
+/// turn.
+template <typename... OpTys, typename Visitor>
+bool dispatchByCasts(mlir::Operation *op, Visitor &visitor) {
+  auto tryCast = [&](auto castOp) {
+    if (!castOp)
+      return false;
+    visitor(castOp);
+    return true;
+  };
+  return (tryCast(llvm::dyn_cast<OpTys>(op)) || ...);
+}
+
+void benchOpDispatch(benchmark::State &state) {
+  std::string quir;
+  if (!generateQUIR(state,
+                    generateCircuit(static_cast<unsigned>(state.range(0)),
+                                    static_cast<unsigned>(state.range(1))),
+                    &quir))
+    return;
+
+  mlir::DialectRegistry registry;
+  qssc::dialect::registerDialects(registry);
+  mlir::MLIRContext context(registry);
+  auto moduleOp = mlir::parseSourceString<mlir::ModuleOp>(quir, &context);
+  if (!moduleOp) {
+    state.SkipWithError("unable to parse the generated QUIR");
+    return;
+  }
+
+  // the kinds of QuantumDecorationPass, in its order
+  using namespace mlir::quir;
+  using Dispatcher =
+      OpDispatcher<BuiltinCXOp, Builtin_UOp, CallDefCalGateOp, CallGateOp,
+                   BarrierOp, MeasureOp, CallDefcalMeasureOp, DelayOp,
+                   ResetQubitOp, CallCircuitOp>;
+  bool const byTable = state.range(2) != 0;
+  size_t numOps = 0;
+  size_t numDispatched = 0;
+  auto visitor = [&](auto castOp) {
+    ++numDispatched;
+    benchmark::DoNotOptimize(castOp.getOperation());
+  };
+  for (auto _ : state) {
+    numOps = 0;
+    numDispatched = 0;
+    moduleOp->walk([&](mlir::Operation *op) {
+      ++numOps;
+      if (byTable)
+        Dispatcher::get().dispatch(op, visitor);
+      else
+        dispatchByCasts<BuiltinCXOp, Builtin_UOp, CallDefCalGateOp,
+                        CallGateOp, BarrierOp, MeasureOp, CallDefcalMeasureOp,
+                        DelayOp, ResetQubitOp, CallCircuitOp>(op, visitor);
+    });
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(numOps));
+  state.counters["dispatched_ops"] = static_cast<double>(numDispatched);
+}
+
+void benchPayloadWrite(benchmark::State &state) {
+  auto payloadInfo =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  if (!payloadInfo.has_value()) {
+    state.SkipWithError("the ZIP payload is not registered");
+    return;
+  }
+
+  auto const numFiles = static_cast<size_t>(state.range(0));
+  std::string const contents(static_cast<size_t>(state.range(1)) * 1024, 'q');
+  std::string output;
+  for (auto _ : state) {
+    auto payload = payloadInfo.value()->createPluginInstance(std::nullopt);
+    if (auto err = payload.takeError()) {
+      state.SkipWithError(llvm::toString(std::move(err)).c_str());
+      return;
+    }
+    for (size_t i = 0; i < numFiles; ++i)
+      (*payload)->addFile("file" + std::to_string(i) + ".bin", contents);
+    output.clear();
+    llvm::raw_string_ostream os(output);
+    (*payload)->write(os);
+    os.flush();
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(numFiles * contents.size()));
+}
+
+void benchLink(benchmark::State &state) {
+  auto const numParameters = static_cast<unsigned>(state.range(2));
+  std::string targetIR;
+  if (!generateTargetIR(state,
+                        generateParameterSweep(
+                            static_cast<unsigned>(state.range(0)),
+                            static_cast<unsigned>(state.range(1)),
+                            numParameters),
+                        &targetIR))
+    return;
+  std::string module;
+  if (!compile(state,
+               concat(concat(directInput("mlir", targetIR), targetArgs()),
+                      {"--emit=qem", "--bypass-payload-target-compilation"}),
+               &module))
+    return;
+
+  std::unordered_map<std::string, double> arguments;
+  for (unsigned p = 0; p < numParameters; ++p)
+    arguments["theta" + std::to_string(p)] = 0.5 / (p + 1);
+
+  for (auto _ : state) {
+    std::unique_ptr<llvm::MemoryBuffer> payload;
+    std::string errors;
+    int const status = qssc::bindArgumentsInMemory(
+        getTarget(), getTargetConfig(), module, arguments,
+        /*treatWarningsAsErrors=*/false, &payload,
+        [&](const qssc::Diagnostic &diagnostic) {
+          errors += diagnostic.toString() + "\n";
+        });
+    if (status != 0) {
+      state.SkipWithError(("argument binding failed:\n" + errors).c_str());
+      return;
+    }
+    benchmark::DoNotOptimize(payload->getBufferStart());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(module.size()));
+}
+
+/// The path of this executable, which binds arguments in a new process for
+/// the Startup/Link benchmark.
+std::string benchExecutable;
+
+/// Bind arguments to the module of a file once, in the process the
+/// Startup/Link benchmark starts.
+int linkOnce(const char *modulePath) {
+  auto module = llvm::MemoryBuffer::getFile(modulePath);
+  if (!module)
+    return 1;
+  std::unique_ptr<llvm::MemoryBuffer> payload;
+  return qssc::bindArgumentsInMemory(getTarget(), getTargetConfig(),
+                                     (*module)->getBuffer(),
+                                     {{"theta0", 0.5}},
+                                     /*treatWarningsAsErrors=*/false,
+                                     &payload, std::nullopt);
+}
+
+/// Time running a process to completion, discarding its output.
+void runProcesses(
+    benchmark::State &state, llvm::StringRef program,
+    llvm::ArrayRef<llvm::StringRef> args,
+    std::optional<llvm::ArrayRef<llvm::StringRef>> env = std::nullopt) {
+  std::optional<llvm::StringRef> const redirects[] = {
+      std::nullopt, llvm::StringRef(""), llvm::StringRef("")};
+  for (auto _ : state) {
+    std::string errorMessage;
+    int const status = llvm::sys::ExecuteAndWait(
+        program, args, env, redirects,
+        /*SecondsToWait=*/0, /*MemoryLimit=*/0, &errorMessage);
+    if (status != 0) {
+      state.SkipWithError(
+          (program + " failed: " + errorMessage).str().c_str());
+      return;
+    }
+  }
+}
+
+void benchStartupVersion(benchmark::State &state) {
+  runProcesses(state, QSSC_BENCH_COMPILER,
+               {QSSC_BENCH_COMPILER, "--version"});
+}
+
+void benchStartupCompile(benchmark::State &state) {
+  std::string const target = getTarget();
+  std::string const config = getTargetConfig();
+  runProcesses(state, QSSC_BENCH_COMPILER,
+               {QSSC_BENCH_COMPILER, "-X=qasm", "--direct",
+                "OPENQASM 3.0; qubit $0; bit b; b = measure $0;", "--target",
+                target, "--config", config, "--emit=qem", "-o", "-"});
+}
+
+void benchStartupLink(benchmark::State &state) {
+  std::string targetIR;
+  if (!generateTargetIR(state, generateParameterSweep(1, 1, 1), &targetIR))
+    return;
+  std::string module;
+  if (!compile(state,
+               concat(concat(directInput("mlir", targetIR), targetArgs()),
+                      {"--emit=qem", "--bypass-payload-target-compilation"}),
+               &module))
+    return;
+
+  llvm::SmallString<128> modulePath;
+  if (!writeTemporaryFile(state, "qem", module, modulePath))
+    return;
+  llvm::FileRemover const moduleRemover(modulePath);
+  runProcesses(state, benchExecutable,
+               {benchExecutable, "--link-once", modulePath});
+}
+
+/// Time importing module in a new Python interpreter which finds the
+/// qss_compiler package of the build.
+void benchStartupPythonImport(benchmark::State &state,
+                              llvm::StringRef module) {
+  std::vector<std::string> environment;
+  for (char **var = environ; *var; ++var)
+    if (!llvm::StringRef(*var).starts_with("PYTHONPATH="))
+      environment.emplace_back(*var);
+  environment.push_back("PYTHONPATH=" QSSC_BENCH_PYTHON_PATH);
+  std::vector<llvm::StringRef> const env(environment.begin(),
+                                         environment.end());
+
+  std::string const statement = "import " + module.str();
+  runProcesses(state, QSSC_BENCH_PYTHON,
+               {QSSC_BENCH_PYTHON, "-c", statement}, env);
+}
+
+struct ProgramFamily {
+  const char *name;
+  ProgramGenerator generator;
+};
+
+std::vector<ProgramFamily> getProgramFamilies() {
+  auto const qubits = [](const benchmark::State &state) {
+    return static_cast<unsigned>(state.range(0));
+  };
+  auto const depth = [](const benchmark::State &state) {
+    return static_cast<unsigned>(state.range(1));
+  };
+  return {
+      {"Circuit",
+       [=](const benchmark::State &state) {
+         return generateCircuit(qubits(state), depth(state));
+       }},
+      {"DynamicCircuit",
+       [=](const benchmark::State &state) {
+         return generateDynamicCircuit(qubits(state), depth(state));
+       }},
+      {"ParameterSweep",
+       [=](const benchmark::State &state) {
+         return generateParameterSweep(qubits(state), depth(state), 16);
+       }},
+      {"DynamicalDecoupling",
+       [=](const benchmark::State &state) {
+         return generateDynamicalDecoupling(qubits(state), depth(state));
+       }},
+      {"ClassicalScopes",
+       [=](const benchmark::State &state) {
+         return generateClassicalScopes(qubits(state), depth(state));
+       }},
+  };
+}
+
+void registerBenchmarks() {
+  using StageFn = void (*)(benchmark::State &, const ProgramGenerator &);
+  std::pair<const char *, StageFn> const stages[] = {
+      {"Parse", benchParse},
+      {"QUIRGeneration", benchQUIRGeneration},
+      {"QUIRPipeline", benchQUIRPipeline},
+      {"TargetPasses", benchTargetPasses},
+      {"TargetCodegen", benchTargetCodegen},
+      {"CostModel", benchCostModel},
+  };
+
+  for (auto const &[stageName, stage] : stages) {
+    for (auto const &family : getProgramFamilies()) {
+      auto const generator = family.generator;
+      benchmark::RegisterBenchmark(
+          (std::string(stageName) + "/" + family.name).c_str(),
+          [stage = stage, generator](benchmark::State &state) {
+            stage(state, generator);
+          })
+          ->ArgNames({"qubits", "depth"})
+          ->ArgsProduct({{4, 16}, {100, 1000}})
+          ->Unit(benchmark::kMillisecond);
+    }
+  }
+
+  // the systems of the end to end compilations scale with the programs
+  for (auto const &family : getProgramFamilies()) {
+    auto const generator = family.generator;
+    benchmark::RegisterBenchmark(
+        (std::string("EndToEnd/") + family.name).c_str(),
+        [generator](benchmark::State &state) {
+          benchEndToEnd(state, generator);
+        })
+        ->ArgNames({"qubits", "depth", "rack"})
+        ->ArgsProduct({{1000, 10000}, {10}, {0, 64}})
+        ->Unit(benchmark::kMillisecond);
+  }
+
+  benchmark::RegisterBenchmark("PulseLowering", benchPulseLowering)
+      ->ArgNames({"frames", "depth"})
+      ->ArgsProduct({{4, 16}, {100, 1000}})
+      ->Unit(benchmark::kMillisecond);
+
+  benchmark::RegisterBenchmark("PulseCallGraph", benchPulseCallGraph)
+      ->ArgNames({"sequences", "calls"})
+      ->ArgsProduct({{100, 1000}, {1, 10}})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("AngleArithmetic", benchAngleArithmetic)
+      ->ArgNames({"angles", "depth", "vectorize"})
+      ->ArgsProduct({{16, 64}, {100, 1000}, {0, 1}})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("DecodingLoops", benchDecodingLoops)
+      ->ArgNames({"bits", "depth", "vectorize"})
+      ->ArgsProduct({{64, 1024}, {10, 100}, {0, 1}})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("QubitLocalization", benchQubitLocalization)
+      ->ArgNames({"qubits", "depth"})
+      ->ArgsProduct({{100, 1000}, {10}})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("OpDispatch", benchOpDispatch)
+      ->ArgNames({"qubits", "depth", "table"})
+      ->ArgsProduct({{100, 1000}, {100}, {0, 1}})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("PayloadWrite", benchPayloadWrite)
+      ->ArgNames({"files", "KiB"})
+      ->ArgsProduct({{8, 64}, {16, 1024}})
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("Link", benchLink)
+      ->ArgNames({"qubits", "depth", "parameters"})
+      ->Args({4, 100, 16})
+      ->Args({16, 1000, 256})
+      ->Unit(benchmark::kMillisecond);
+
+  benchmark::RegisterBenchmark("Startup/Version", benchStartupVersion)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("Startup/Link", benchStartupLink)
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("Startup/Compile", benchStartupCompile)
+      ->Unit(benchmark::kMillisecond);
+  // importing the package defers loading the compiler to its first use
+  benchmark::RegisterBenchmark("Startup/PythonImport",
+                               benchStartupPythonImport, "qss_compiler")
+      ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("Startup/PythonImportCompiler",
+                               benchStartupPythonImport,
+                               "qss_compiler.py_qssc")
+      ->Unit(benchmark::kMillisecond);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  if (argc == 3 && llvm::StringRef(argv[1]) == "--link-once")
+    return linkOnce(argv[2]);
+
+  benchExecutable = llvm::sys::fs::getMainExecutable(
+      argv[0], reinterpret_cast<void *>(&linkOnce));
+  registerBenchmarks();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
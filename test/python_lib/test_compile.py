@@ -13,17 +13,30 @@
 """
 Unit tests for the compiler API.
 """
+import asyncio
+from concurrent.futures import ThreadPoolExecutor
+import subprocess
+import sys
+
 import pytest
 import qss_compiler
 from qss_compiler import (
+    compile_batch,
     compile_file,
+    compile_multi_config,
     compile_str,
+    compile_str_async,
+    CompileWorkerPool,
     ErrorCategory,
+    estimate_compile_cost,
+    export_metrics,
     InputType,
+    MetricsFormat,
     OutputType,
+    reset_metrics,
     Severity,
 )
-from qss_compiler.exceptions import QSSCompilationFailure
+from qss_compiler.exceptions import QSSCompilationFailure, QSSCompilerPoolBusy
 
 
 def check_mlir_string(mlir):
@@ -85,6 +98,275 @@ def test_compile_str_to_mlir(example_qasm3_str):
     check_mlir_string(mlir)
 
 
+def test_compile_str_with_num_threads(example_qasm3_str):
+    """Test that the thread pool of a compilation may be sized to avoid
+    oversubscribing the host"""
+
+    mlir = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+        output_file=None,
+        num_threads=2,
+    )
+    check_mlir_string(mlir)
+
+
+def test_compile_str_metrics(example_qasm3_str):
+    """Test that the metrics of compilations in compile processes are
+    exported from the calling process"""
+
+    reset_metrics()
+    mlir = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+        output_file=None,
+    )
+    check_mlir_string(mlir)
+
+    metrics = export_metrics()
+    assert "# TYPE qssc_compilations_total counter" in metrics
+    assert 'qssc_compilations_total{status="success"} 1' in metrics
+    assert 'qssc_compile_stage_duration_seconds_count{stage="frontend"} 1' in metrics
+
+    openmetrics = export_metrics(MetricsFormat.OPENMETRICS, reset=True)
+    assert "# TYPE qssc_compilations counter" in openmetrics
+    assert openmetrics.endswith("# EOF\n")
+    assert "qssc_compilations_total" not in export_metrics()
+
+
+def test_estimate_compile_cost(example_qasm3_str):
+    """Test that the cost of a compilation is estimated from its program"""
+
+    cost = estimate_compile_cost(input_str=example_qasm3_str, input_type=InputType.QASM3)
+    assert cost.num_operations > 0
+    assert cost.num_qubits > 0
+    assert cost.num_targets == 0
+    assert cost.seconds > 0
+    assert cost.peak_memory_bytes > 0
+    assert cost.fits()
+    assert not cost.fits(max_peak_memory_bytes=cost.peak_memory_bytes - 1)
+
+
+def test_estimate_compile_cost_invalid_str(example_invalid_qasm3_str):
+    """Test that estimating the cost of an invalid program fails"""
+
+    with pytest.raises(QSSCompilationFailure):
+        estimate_compile_cost(input_str=example_invalid_qasm3_str, input_type=InputType.QASM3)
+
+
+def test_compile_batch_to_mlir(example_qasm3_str):
+    """Test that we can compile a batch of string inputs via the interface
+    compile_batch to one MLIR output per input"""
+
+    mlirs = compile_batch(
+        [example_qasm3_str, example_qasm3_str],
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+    assert len(mlirs) == 2
+    for mlir in mlirs:
+        check_mlir_string(mlir)
+    assert mlirs[0] == mlirs[1]
+
+
+def test_compile_batch_invalid_str(example_qasm3_str, example_invalid_qasm3_str):
+    """Test that a batch with an invalid program raises an error"""
+
+    with pytest.raises(QSSCompilationFailure):
+        compile_batch(
+            [example_qasm3_str, example_invalid_qasm3_str],
+            return_diagnostics=True,  # For testing purposes
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+        )
+
+
+def test_compile_multi_config_to_mlir(example_qasm3_str, tmp_path):
+    """Test that we can compile a program via the interface compile_multi_config
+    to one MLIR output per configuration"""
+
+    config_paths = [tmp_path / "config0.yaml", tmp_path / "config1.yaml"]
+    for config_path in config_paths:
+        config_path.write_text("")
+
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+    mlirs = compile_multi_config(
+        config_paths,
+        input_str=example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+    assert mlirs == [expected, expected]
+
+
+def test_compile_multi_config_invalid_str(example_invalid_qasm3_str, tmp_path):
+    """Test that an invalid program fails to compile for several configurations"""
+
+    config_path = tmp_path / "config.yaml"
+    config_path.write_text("")
+    with pytest.raises(QSSCompilationFailure):
+        compile_multi_config(
+            [config_path, config_path],
+            input_str=example_invalid_qasm3_str,
+            return_diagnostics=True,  # For testing purposes
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+        )
+
+
+def test_compile_with_worker_pool(example_qasm3_str, example_qasm3_tmpfile):
+    """Test that a worker pool compiles strings, files and batches like
+    the single compilation processes"""
+
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+    with CompileWorkerPool(max_workers=1) as pool:
+        for _ in range(3):
+            mlir = compile_str(
+                example_qasm3_str,
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+                worker_pool=pool,
+            )
+            assert mlir == expected
+
+        check_mlir_string(
+            compile_file(
+                example_qasm3_tmpfile,
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+                worker_pool=pool,
+            )
+        )
+        mlirs = compile_batch(
+            [example_qasm3_str, example_qasm3_str],
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            worker_pool=pool,
+        )
+        assert mlirs == [expected, expected]
+
+
+def test_worker_pool_survives_compilation_failure(example_qasm3_str, example_invalid_qasm3_str):
+    """Test that a worker remains usable after a program fails to compile"""
+
+    with CompileWorkerPool(max_workers=1) as pool:
+        with pytest.raises(QSSCompilationFailure):
+            compile_str(
+                example_invalid_qasm3_str,
+                return_diagnostics=True,  # For testing purposes
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+                worker_pool=pool,
+            )
+        check_mlir_string(
+            compile_str(
+                example_qasm3_str,
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+                worker_pool=pool,
+            )
+        )
+
+
+def test_compile_str_in_process_concurrently(example_qasm3_str):
+    """Test that compilations in process from several threads run alongside
+    each other and match a compilation in a compile process"""
+
+    def compile_in_process(_):
+        return compile_str(
+            example_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            in_process=True,
+        )
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        mlirs = list(executor.map(compile_in_process, range(8)))
+
+    expected = compile_str(
+        example_qasm3_str,
+        input_type=InputType.QASM3,
+        output_type=OutputType.MLIR,
+    )
+    for mlir in mlirs:
+        check_mlir_string(mlir)
+        assert mlir == expected
+
+
+def test_compile_str_in_process_failure(example_invalid_qasm3_str):
+    """Test that a failed in process compilation raises its diagnostics"""
+
+    with pytest.raises(QSSCompilationFailure) as error:
+        compile_str(
+            example_invalid_qasm3_str,
+            return_diagnostics=True,  # For testing purposes
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            in_process=True,
+        )
+    assert error.value.diagnostics
+
+
+@pytest.mark.asyncio
+async def test_compile_str_async_with_worker_pool(example_qasm3_str):
+    """Test that concurrent async compilations share the workers of a pool"""
+
+    with CompileWorkerPool(max_workers=2) as pool:
+        mlirs = await asyncio.gather(
+            *[
+                compile_str_async(
+                    example_qasm3_str,
+                    input_type=InputType.QASM3,
+                    output_type=OutputType.MLIR,
+                    worker_pool=pool,
+                )
+                for _ in range(6)
+            ]
+        )
+    for mlir in mlirs:
+        check_mlir_string(mlir)
+    assert all(mlir == mlirs[0] for mlir in mlirs)
+
+
+@pytest.mark.asyncio
+async def test_worker_pool_backpressure_and_cancellation(example_qasm3_str):
+    """Test that a full queue rejects compilations and that a cancelled
+    compilation leaves the pool usable"""
+
+    def compile_async(pool):
+        return asyncio.ensure_future(
+            compile_str_async(
+                example_qasm3_str,
+                input_type=InputType.QASM3,
+                output_type=OutputType.MLIR,
+                worker_pool=pool,
+            )
+        )
+
+    with CompileWorkerPool(max_workers=1, max_queued=1) as pool:
+        running = compile_async(pool)
+        queued = compile_async(pool)
+        await asyncio.sleep(0)
+        with pytest.raises(QSSCompilerPoolBusy):
+            await compile_async(pool)
+
+        queued.cancel()
+        running.cancel()
+        with pytest.raises(asyncio.CancelledError):
+            await running
+        check_mlir_string(await compile_async(pool))
+
+
 def test_empty_str():
     """Test that we can compile an empty string."""
 
@@ -139,3 +421,34 @@ def test_compile_invalid_str(example_invalid_qasm3_str):
     # check string representation of the exception to contain diagnostic messages
     assert "OpenQASM 3 parse error" in str(compfail.value)
     assert "unknown version number" in str(compfail.value)
+
+
+def test_compile_invalid_str_on_diagnostic(example_invalid_qasm3_str):
+    """Test that the diagnostics collected by the compiler are delivered in
+    order to the on_diagnostic callback"""
+
+    received = []
+    with pytest.raises(QSSCompilationFailure):
+        compile_str(
+            example_invalid_qasm3_str,
+            input_type=InputType.QASM3,
+            output_type=OutputType.MLIR,
+            on_diagnostic=received.append,
+        )
+
+    assert received
+    assert received[0].category == ErrorCategory.OpenQASM3ParseFailure
+    assert all(diag.severity == Severity.Error for diag in received)
+
+
+def test_import_does_not_load_compiler():
+    """Test that importing the package defers loading the compiler, while its
+    diagnostics are available"""
+
+    statement = (
+        "import sys; import qss_compiler; "
+        "assert 'qss_compiler.py_qssc' not in sys.modules; "
+        "assert qss_compiler.Severity.Error; "
+        "assert qss_compiler.ErrorCategory.OpenQASM3ParseFailure"
+    )
+    subprocess.run([sys.executable, "-c", statement], check=True)
@@ -15,7 +15,7 @@ Unit tests for the linker API.
 """
 import pytest
 
-from qss_compiler import link_file
+from qss_compiler import link_file, link_file_async, link_file_batch, link_many
 from qss_compiler.exceptions import QSSLinkerNotImplemented
 
 
@@ -34,3 +34,63 @@ def test_linker_not_implemented(tmp_path):
         )
 
     assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_linker_batch_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        link_file_batch(
+            [{"a": 0.5}, {"a": 1}],
+            input_file=qem_file,
+            target="Mock",
+        )
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+def test_linker_batch_output_files_mismatch(tmp_path):
+    with pytest.raises(ValueError):
+        link_file_batch(
+            [{"a": 0.5}, {"a": 1}],
+            input_file=tmp_path / "test.txt",
+            output_files=[tmp_path / "out.qem"],
+            target="Mock",
+        )
+
+
+@pytest.mark.asyncio
+async def test_linker_async_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        await link_file_async(
+            input_file=qem_file,
+            target="Mock",
+            arguments={},
+        )
+
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
+
+
+@pytest.mark.asyncio
+async def test_linker_many_not_implemented(tmp_path):
+    qem_file = tmp_path / "test.txt"
+    with open(qem_file, "w") as f:
+        f.write("dummy")
+
+    payloads = []
+    with pytest.raises(QSSLinkerNotImplemented) as error:
+        async for payload in link_many(
+            [{"a": 0.5}, {"a": 1}],
+            input_file=qem_file,
+            target="Mock",
+        ):
+            payloads.append(payload)
+
+    assert payloads == []
+    assert str(error.value.message) == "Unable to load bind arguments implementation for target."
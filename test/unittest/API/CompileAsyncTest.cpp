@@ -0,0 +1,91 @@
+//===- CompileAsyncTest.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for compiling asynchronously with
+/// cancellation and deadlines.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+#include "HAL/Compile/CompileCancellation.h"
+
+#include "llvm/Support/Error.h"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <system_error>
+
+namespace {
+
+using namespace qssc::config;
+using qssc::hal::compile::CompileCancellation;
+
+const char *source = R"(OPENQASM 3.0;
+qubit $0;
+bit b;
+b = measure $0;
+)";
+
+QSSConfig makeConfig() {
+  QSSConfig config;
+  config.setInputSource(source)
+      .directInput(true)
+      .setInputType(InputType::QASM)
+      .setEmitAction(EmitAction::MLIR);
+  return config;
+}
+
+TEST(CompileAsync, Completes) {
+  // As a compiler user, I want to compile without blocking the calling
+  // thread.
+
+  auto handle = qssc::compileAsync(makeConfig(), std::nullopt, std::nullopt);
+  auto result = handle.get();
+  EXPECT_EQ(result.status, 0);
+  EXPECT_FALSE(result.cancelled);
+  EXPECT_NE(result.output.find("qcs.shot_init"), std::string::npos);
+}
+
+TEST(CompileAsync, DeadlineExceeded) {
+  // As a compiler user, I want a compilation to stop once its deadline has
+  // passed.
+
+  auto handle = qssc::compileAsync(
+      makeConfig(), std::chrono::steady_clock::now() - std::chrono::seconds(1),
+      std::nullopt);
+  auto result = handle.get();
+  EXPECT_NE(result.status, 0);
+  EXPECT_TRUE(result.cancelled);
+}
+
+TEST(CompileAsync, Cancellation) {
+  CompileCancellation cancellation;
+  EXPECT_FALSE(cancellation.isCancelled());
+  EXPECT_FALSE(static_cast<bool>(cancellation.check()));
+
+  cancellation.cancel();
+  EXPECT_TRUE(cancellation.isCancelled());
+  std::error_code const ec = llvm::errorToErrorCode(cancellation.check());
+  EXPECT_EQ(ec, std::make_error_code(std::errc::operation_canceled));
+}
+
+TEST(CompileAsync, CancellationDeadline) {
+  CompileCancellation cancellation(CompileCancellation::Clock::now());
+  EXPECT_TRUE(cancellation.isCancelled());
+  std::error_code const ec = llvm::errorToErrorCode(cancellation.check());
+  EXPECT_EQ(ec, std::make_error_code(std::errc::timed_out));
+}
+
+} // anonymous namespace
@@ -0,0 +1,144 @@
+//===- CompileConfigTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for compiling with structured
+/// configurations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+#include "Config/QSSConfig.h"
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace qssc::config;
+
+const char *source = R"(OPENQASM 3.0;
+qubit $0;
+bit b;
+b = measure $0;
+)";
+
+QSSConfig makeConfig() {
+  QSSConfig config;
+  config.setInputSource(source)
+      .directInput(true)
+      .setInputType(InputType::QASM)
+      .setEmitAction(EmitAction::MLIR);
+  return config;
+}
+
+TEST(CompileConfig, ConcurrentFrontendOptions) {
+  // As a compiler user, I want to compile programs with different options
+  // concurrently within one process.
+
+  const std::vector<unsigned> numShots{10, 20, 30, 40};
+  std::vector<std::string> outputs(numShots.size());
+  std::vector<int> statuses(numShots.size(), 1);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < numShots.size(); ++i)
+    threads.emplace_back([&, i]() {
+      QSSConfig config = makeConfig();
+      config.setNumShots(numShots[i]);
+      statuses[i] = qssc::compile(config, &outputs[i], std::nullopt);
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < numShots.size(); ++i) {
+    EXPECT_EQ(statuses[i], 0);
+    EXPECT_NE(outputs[i].find("qcs.num_shots = " +
+                              std::to_string(numShots[i]) + " : i32"),
+              std::string::npos);
+  }
+}
+
+TEST(CompileConfig, PassPipeline) {
+  // As a compiler user, I want to select the passes of a compilation without
+  // a command line.
+
+  QSSConfig config = makeConfig();
+  config.setPassPipeline("builtin.module(canonicalize)");
+  std::string output;
+  EXPECT_EQ(qssc::compile(config, &output, std::nullopt), 0);
+  EXPECT_NE(output.find("qcs.shot_init"), std::string::npos);
+
+  config.setPassPipeline("builtin.module(not-a-registered-pass)");
+  EXPECT_NE(qssc::compile(config, &output, std::nullopt), 0);
+}
+
+TEST(CompileConfig, ThreadPool) {
+  // As a compiler user, I want to size the thread pool of compilations or
+  // share mine between them so that they do not oversubscribe the host.
+
+  QSSConfig config = makeConfig();
+  config.setNumThreads(2);
+  std::string output;
+  EXPECT_EQ(qssc::compile(config, &output, std::nullopt), 0);
+  EXPECT_NE(output.find("qcs.shot_init"), std::string::npos);
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(2));
+  std::vector<std::string> outputs(4);
+  std::vector<int> statuses(outputs.size(), 1);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < outputs.size(); ++i)
+    threads.emplace_back([&, i]() {
+      QSSConfig sharedConfig = makeConfig();
+      sharedConfig.setThreadPool(&pool);
+      statuses[i] = qssc::compile(sharedConfig, &outputs[i], std::nullopt);
+    });
+  for (auto &thread : threads)
+    thread.join();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    EXPECT_EQ(statuses[i], 0);
+    EXPECT_NE(outputs[i].find("qcs.shot_init"), std::string::npos);
+  }
+}
+
+TEST(CompileConfig, InputBuffer) {
+  // As a compiler user, I want to compile large generated programs from my
+  // own buffers without copying them into the configuration.
+
+  const std::string qasmSource = source;
+  QSSConfig config;
+  config.setInputBuffer(qasmSource)
+      .setInputType(InputType::QASM)
+      .setEmitAction(EmitAction::MLIR);
+  EXPECT_TRUE(config.isDirectInput());
+  EXPECT_EQ(config.getInputSource().data(), qasmSource.data());
+  std::string mlirSource;
+  EXPECT_EQ(qssc::compile(config, &mlirSource, std::nullopt), 0);
+  EXPECT_NE(mlirSource.find("qcs.shot_init"), std::string::npos);
+
+  config.setInputBuffer(mlirSource).setInputType(InputType::MLIR);
+  EXPECT_EQ(config.getInputSource().data(), mlirSource.data());
+  std::string output;
+  EXPECT_EQ(qssc::compile(config, &output, std::nullopt), 0);
+  EXPECT_NE(output.find("qcs.shot_init"), std::string::npos);
+
+  // Setting an owned source again drops the buffer.
+  config.setInputSource(source);
+  EXPECT_NE(config.getInputSource().data(), mlirSource.data());
+}
+
+} // anonymous namespace
@@ -0,0 +1,95 @@
+//===- CompileCostTest.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for estimating the cost of compilations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// A program applying depth layers of gates to numQubits qubits.
+std::string makeProgram(unsigned numQubits, unsigned depth) {
+  std::string program = "OPENQASM 3.0;\n";
+  for (unsigned q = 0; q < numQubits; ++q)
+    program += "qubit $" + std::to_string(q) + ";\n";
+  for (unsigned d = 0; d < depth; ++d)
+    for (unsigned q = 0; q < numQubits; ++q)
+      program += "U(0.1, 0.2, 0.3) $" + std::to_string(q) + ";\n";
+  return program;
+}
+
+int estimate(const std::string &program, qssc::CompileCostEstimate *cost) {
+  std::vector<const char *> argv{"qss-compiler", "-X=qasm", "--emit=mlir",
+                                 "--direct", program.c_str(), nullptr};
+  return qssc::estimateCompileCost(static_cast<int>(argv.size() - 1),
+                                   argv.data(), cost, std::nullopt);
+}
+
+TEST(CompileCost, GrowsWithProgram) {
+  // As a scheduler, I want to estimate the cost of compilations before
+  // admitting them to a host.
+
+  qssc::CompileCostEstimate small;
+  qssc::CompileCostEstimate large;
+  ASSERT_EQ(estimate(makeProgram(2, 2), &small), 0);
+  ASSERT_EQ(estimate(makeProgram(8, 16), &large), 0);
+
+  EXPECT_EQ(small.features.numQubits, 2u);
+  EXPECT_EQ(large.features.numQubits, 8u);
+  EXPECT_GT(large.features.numOperations, small.features.numOperations);
+  EXPECT_EQ(large.features.numTargets, 0u);
+  EXPECT_GT(large.seconds, small.seconds);
+  EXPECT_GT(large.peakMemoryBytes, small.peakMemoryBytes);
+}
+
+TEST(CompileCost, FailsOnInvalidProgram) {
+  qssc::CompileCostEstimate cost;
+  EXPECT_NE(estimate("OPENQASM 3.0;\nqubit $0;\nundefined $0;\n", &cost), 0);
+}
+
+TEST(CompileCost, Model) {
+  qssc::CompileCostModel model;
+  model.baseSeconds = 1.;
+  model.secondsPerOperation = 0.5;
+  model.secondsPerQubit = 0.;
+  model.secondsPerCircuit = 2.;
+  model.secondsPerTargetOperation = 0.25;
+  model.baseBytes = 1000;
+  model.bytesPerOperation = 10;
+  model.bytesPerQubit = 100;
+  model.bytesPerCircuit = 0;
+  model.bytesPerTargetOperation = 1;
+
+  qssc::CompileCostFeatures features;
+  features.numOperations = 4;
+  features.numQubits = 2;
+  features.numCircuits = 1;
+  features.numTargets = 3;
+  auto const cost = model.estimate(features);
+
+  EXPECT_DOUBLE_EQ(cost.seconds, 1. + 2. + 2. + 3.);
+  EXPECT_EQ(cost.peakMemoryBytes, uint64_t{1000 + 40 + 200 + 12});
+  EXPECT_TRUE(cost.fits(0., 0));
+  EXPECT_TRUE(cost.fits(8., 1252));
+  EXPECT_FALSE(cost.fits(7.9, 0));
+  EXPECT_FALSE(cost.fits(0., 1251));
+}
+
+} // anonymous namespace
@@ -0,0 +1,71 @@
+//===- CompileServerTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the context recycling and memory
+/// accounting of the compile server.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "API/api.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+int compile(qssc::CompileServer &server, std::string *output) {
+  std::vector<const char *> argv{"qss-compiler", "-X=qasm", "--emit=mlir",
+                                 "--direct",
+                                 "OPENQASM 3.0;\nqubit $0;\nbit b;\n"
+                                 "b = measure $0;\n",
+                                 nullptr};
+  return server.compile(static_cast<int>(argv.size() - 1), argv.data(),
+                        output, std::nullopt);
+}
+
+TEST(CompileServer, RecycleAfterJobs) {
+  // As a compile server operator, I want the context of the server to be
+  // replaced regularly so that its memory does not grow without bound.
+
+  qssc::CompileServer server({/*maxJobsPerContext=*/2,
+                              /*maxContextBytes=*/0});
+  for (unsigned i = 0; i < 5; ++i) {
+    std::string output;
+    EXPECT_EQ(compile(server, &output), 0);
+    EXPECT_NE(output.find("qcs.shot_init"), std::string::npos);
+  }
+
+  auto const metrics = server.getMetrics();
+  EXPECT_EQ(metrics.numJobs, 5U);
+  EXPECT_EQ(metrics.contextGeneration, 2U);
+  EXPECT_EQ(metrics.contextJobs, 1U);
+}
+
+TEST(CompileServer, RecycleContext) {
+  qssc::CompileServer server;
+  std::string output;
+  EXPECT_EQ(compile(server, &output), 0);
+  EXPECT_EQ(compile(server, &output), 0);
+  EXPECT_EQ(server.getMetrics().contextGeneration, 0U);
+  EXPECT_EQ(server.getMetrics().contextJobs, 2U);
+
+  server.recycleContext();
+  EXPECT_EQ(server.getMetrics().contextGeneration, 1U);
+  EXPECT_EQ(server.getMetrics().contextJobs, 0U);
+  EXPECT_EQ(compile(server, &output), 0);
+  EXPECT_NE(output.find("qcs.shot_init"), std::string::npos);
+  EXPECT_EQ(server.getMetrics().numJobs, 3U);
+}
+
+} // anonymous namespace
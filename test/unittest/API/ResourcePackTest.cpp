@@ -0,0 +1,106 @@
+//===- ResourcePackTest.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for packing static resources.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "QSSC.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <system_error>
+
+namespace {
+
+void writeFile(llvm::StringRef dir, llvm::StringRef name,
+               llvm::StringRef contents) {
+  llvm::SmallString<128> path(dir);
+  llvm::sys::path::append(path, name);
+  ASSERT_FALSE(
+      llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path)));
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec);
+  ASSERT_FALSE(ec);
+  os << contents;
+}
+
+TEST(ResourcePack, ServesPackedResources) {
+  // As a compile process, I want to map the static resources once rather
+  // than look each of them up in the resources directory.
+
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("resources", dir));
+  writeFile(dir, "stdgates.inc", "gate x a { U(pi, 0, pi) a; }");
+  writeFile(dir, "targets/mock/calibrations.mlir", "module {}");
+  writeFile(dir, "targets/mock/empty", "");
+  // a pack left in the directory is not packed again
+  writeFile(dir, qssc::resourcePackName, "stale");
+
+  std::string packed;
+  llvm::raw_string_ostream os(packed);
+  ASSERT_FALSE(llvm::errorToBool(qssc::ResourcePack::write(dir, os)));
+  os.flush();
+
+  auto pack = qssc::ResourcePack::create(
+      llvm::MemoryBuffer::getMemBuffer(packed, "pack",
+                                       /*RequiresNullTerminator=*/false));
+  ASSERT_TRUE(static_cast<bool>(pack)) << toString(pack.takeError());
+  EXPECT_EQ((*pack)->size(), 3u);
+
+  auto calibrations = (*pack)->lookup("targets/mock/calibrations.mlir");
+  ASSERT_TRUE(calibrations.has_value());
+  EXPECT_EQ(calibrations->getBuffer(), "module {}");
+  // the resource is a view into the pack
+  EXPECT_GE(calibrations->getBufferStart(), packed.data());
+  EXPECT_LE(calibrations->getBufferEnd(), packed.data() + packed.size());
+
+  auto gates = (*pack)->lookup("stdgates.inc");
+  ASSERT_TRUE(gates.has_value());
+  EXPECT_EQ(gates->getBuffer(), "gate x a { U(pi, 0, pi) a; }");
+  auto empty = (*pack)->lookup("targets/mock/empty");
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_TRUE(empty->getBuffer().empty());
+  EXPECT_FALSE((*pack)->lookup(qssc::resourcePackName).has_value());
+  EXPECT_FALSE((*pack)->lookup("missing").has_value());
+
+  llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(ResourcePack, RejectsTruncatedPacks) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("resources", dir));
+  writeFile(dir, "stdgates.inc", "gate x a { U(pi, 0, pi) a; }");
+
+  std::string packed;
+  llvm::raw_string_ostream os(packed);
+  ASSERT_FALSE(llvm::errorToBool(qssc::ResourcePack::write(dir, os)));
+  os.flush();
+  llvm::sys::fs::remove_directories(dir);
+
+  for (size_t const size : {size_t{0}, size_t{12}, packed.size() - 1}) {
+    auto pack = qssc::ResourcePack::create(llvm::MemoryBuffer::getMemBuffer(
+        llvm::StringRef(packed).take_front(size), "pack",
+        /*RequiresNullTerminator=*/false));
+    EXPECT_TRUE(llvm::errorToBool(pack.takeError())) << size;
+  }
+}
+
+} // anonymous namespace
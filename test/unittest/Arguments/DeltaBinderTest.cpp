@@ -0,0 +1,171 @@
+//===- DeltaBinderTest.cpp --------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for binding argument sets one after
+/// another, patching only the parameters which changed.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using namespace qssc::arguments;
+using qssc::payload::PatchablePayload;
+
+// a payload of named binaries, written as their concatenated contents
+class TestPayload : public PatchablePayload {
+public:
+  std::map<std::string, ContentBuffer> members;
+
+  llvm::Expected<ContentBuffer &> readMember(llvm::StringRef path,
+                                             bool markForWriteBack) override {
+    auto member = members.find(path.str());
+    if (member == members.end())
+      return llvm::make_error<llvm::StringError>(
+          "no member " + path, llvm::inconvertibleErrorCode());
+    return member->second;
+  }
+  llvm::Error writeBack() override { return llvm::Error::success(); }
+  llvm::Error writeString(std::string *outputString) override {
+    return writeStringWithMembers(outputString, members);
+  }
+  llvm::Error writeStringWithMembers(
+      std::string *outputString,
+      const std::map<std::string, ContentBuffer> &replaced) override {
+    outputString->clear();
+    for (auto const &[name, contents] : replaced)
+      outputString->append(contents.begin(), contents.end());
+    return llvm::Error::success();
+  }
+};
+
+// patches the value of a parameter into the byte at the patch point
+class TestBinder : public BindArgumentsImplementation {
+public:
+  explicit TestBinder(std::vector<char> *binary) : binary(binary) {}
+
+  llvm::Error patch(PatchPoint const &patchPoint,
+                    ArgumentSource const &arguments) override {
+    auto value = std::get<std::optional<double>>(
+        arguments.getArgumentValue(patchPoint.expression()));
+    if (!value)
+      return llvm::make_error<llvm::StringError>(
+          "missing " + patchPoint.expression(), llvm::inconvertibleErrorCode());
+    (*binary)[patchPoint.offset()] = static_cast<char>(*value);
+    return llvm::Error::success();
+  }
+  llvm::Error parseParamMapIntoSignature(llvm::StringRef, llvm::StringRef,
+                                         Signature &) override {
+    return llvm::Error::success();
+  }
+  PatchablePayload *getPayload(llvm::StringRef, bool) override {
+    return nullptr;
+  }
+  llvm::Expected<Signature> parseSignature(PatchablePayload *) override {
+    return Signature();
+  }
+
+private:
+  std::vector<char> *binary;
+};
+
+class TestFactory : public BindArgumentsImplementationFactory {
+public:
+  BindArgumentsImplementation *create(OptDiagnosticCallback) override {
+    return new TestBinder(nullptr);
+  }
+  BindArgumentsImplementation *create(std::vector<char> &buf,
+                                      OptDiagnosticCallback) override {
+    return new TestBinder(&buf);
+  }
+  BindArgumentsImplementation *create(std::string &,
+                                      OptDiagnosticCallback) override {
+    return new TestBinder(nullptr);
+  }
+};
+
+class TestArguments : public ArgumentSource {
+public:
+  llvm::StringMap<double> values;
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    auto value = values.find(name);
+    if (value == values.end())
+      return std::optional<double>();
+    return std::optional<double>(value->second);
+  }
+};
+
+TEST(DeltaBinder, PatchesChangedParameters) {
+  // As a user sweeping a parameter, I want each point of the sweep to only
+  // patch the parameter which changed.
+
+  TestPayload payload;
+  payload.members["drive0.bin"] = {0, 0};
+  payload.members["drive1.bin"] = {0};
+
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "u8", "drive0.bin", 0);
+  sig.addParameterPatchPoint("phi", "u8", "drive0.bin", 1);
+  sig.addParameterPatchPoint("theta", "u8", "drive1.bin", 0);
+
+  TestFactory factory;
+  auto binderOrErr =
+      DeltaBinder::create(payload, sig, false, factory, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(binderOrErr));
+  auto &binder = *binderOrErr;
+
+  TestArguments arguments;
+  arguments.values["theta"] = 1;
+  arguments.values["phi"] = 2;
+  std::string output;
+  ASSERT_FALSE(llvm::errorToBool(binder.bind(arguments, &output)));
+  EXPECT_EQ(binder.getNumPatched(), 3u);
+  EXPECT_EQ(output, std::string({1, 2, 1}));
+
+  arguments.values["phi"] = 3;
+  ASSERT_FALSE(llvm::errorToBool(binder.bind(arguments, &output)));
+  EXPECT_EQ(binder.getNumPatched(), 1u);
+  EXPECT_EQ(output, std::string({1, 3, 1}));
+
+  arguments.values["theta"] = 4;
+  ASSERT_FALSE(llvm::errorToBool(binder.bind(arguments, &output)));
+  EXPECT_EQ(binder.getNumPatched(), 2u);
+  EXPECT_EQ(output, std::string({4, 3, 4}));
+
+  // the payload itself remains unpatched
+  EXPECT_EQ(payload.members["drive0.bin"], std::vector<char>({0, 0}));
+
+  // a failed bind patches all parameters on the next bind
+  arguments.values.erase("phi");
+  EXPECT_TRUE(llvm::errorToBool(binder.bind(arguments, &output)));
+  arguments.values["phi"] = 3;
+  ASSERT_FALSE(llvm::errorToBool(binder.bind(arguments, &output)));
+  EXPECT_EQ(binder.getNumPatched(), 3u);
+  EXPECT_EQ(output, std::string({4, 3, 4}));
+}
+
+} // anonymous namespace
@@ -0,0 +1,121 @@
+//===- ParameterExpressionTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for evaluating the parameter expressions
+/// of patch points when arguments are bound.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/ParameterExpression.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using namespace qssc::arguments;
+
+class TestArguments : public ArgumentSource {
+public:
+  llvm::StringMap<double> values;
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    auto value = values.find(name);
+    if (value == values.end())
+      return std::optional<double>();
+    return std::optional<double>(value->second);
+  }
+};
+
+std::optional<double> valueOf(ArgumentType const &value) {
+  return std::get<std::optional<double>>(value);
+}
+
+TEST(ParameterExpression, EvaluatesOverArguments) {
+  // As a user binding a parameter which a gate uses as theta / 2 + pi, I
+  // want the angle computed once per binding rather than on the controller.
+
+  auto expression = ParameterExpression::parse(
+      "(angle (add (div theta 2) 3.141592653589793))");
+  ASSERT_TRUE(static_cast<bool>(expression))
+      << llvm::toString(expression.takeError());
+  EXPECT_EQ(expression->getParameters(), std::vector<std::string>{"theta"});
+
+  TestArguments arguments;
+  arguments.values["theta"] = 1.0;
+  auto value = valueOf(expression->evaluate(arguments));
+  ASSERT_TRUE(value.has_value());
+  EXPECT_DOUBLE_EQ(*value, 0.5 + llvm::numbers::pi);
+
+  // angle wraps around as the angle operations of the compiler
+  arguments.values["theta"] = 8.0;
+  value = valueOf(expression->evaluate(arguments));
+  ASSERT_TRUE(value.has_value());
+  EXPECT_DOUBLE_EQ(*value, 4.0 - llvm::numbers::pi);
+}
+
+TEST(ParameterExpression, HasNoValueWithoutArguments) {
+  auto expression = ParameterExpression::parse("(mul (neg alpha) beta)");
+  ASSERT_TRUE(static_cast<bool>(expression))
+      << llvm::toString(expression.takeError());
+  EXPECT_EQ(expression->getParameters(),
+            (std::vector<std::string>{"alpha", "beta"}));
+
+  TestArguments arguments;
+  arguments.values["alpha"] = 2.0;
+  EXPECT_FALSE(valueOf(expression->evaluate(arguments)).has_value());
+
+  arguments.values["beta"] = 3.0;
+  EXPECT_EQ(valueOf(expression->evaluate(arguments)), -6.0);
+}
+
+TEST(ParameterExpression, RejectsMalformedExpressions) {
+  for (llvm::StringRef text :
+       {"(add theta)", "(pow theta 2)", "(neg theta", "(add 1x theta)",
+        "(neg theta) phi"}) {
+    auto expression = ParameterExpression::parse(text);
+    EXPECT_FALSE(static_cast<bool>(expression)) << text.str();
+    llvm::consumeError(expression.takeError());
+  }
+}
+
+TEST(ParameterExpression, SourceEvaluatesExpressionNames) {
+  // As a target emitting the expressions of derived parameters as the names
+  // of their patch points, I want every binding path to see their values.
+
+  TestArguments arguments;
+  arguments.values["theta"] = 1.0;
+  ParameterExpressionCache cache;
+  ExpressionArgumentSource const source(arguments, cache);
+
+  EXPECT_EQ(valueOf(source.getArgumentValue("theta")), 1.0);
+  EXPECT_EQ(valueOf(source.getArgumentValue("(sub theta 0.25)")), 0.75);
+  EXPECT_FALSE(valueOf(source.getArgumentValue("(sub theta")).has_value());
+
+  std::vector<std::string> const names{"(mul theta 3)", "theta", "phi"};
+  std::vector<ArgumentType> values(names.size());
+  source.getArgumentValues(names, values);
+  EXPECT_EQ(valueOf(values[0]), 3.0);
+  EXPECT_EQ(valueOf(values[1]), 1.0);
+  EXPECT_FALSE(valueOf(values[2]).has_value());
+}
+
+} // anonymous namespace
@@ -0,0 +1,177 @@
+//===- ParameterTableTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for binding argument sets to the
+/// parameter table of a payload.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+#include "Payload/Payload.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using namespace qssc::arguments;
+using qssc::payload::PatchablePayload;
+
+class TestPayload : public PatchablePayload {
+public:
+  std::map<std::string, ContentBuffer> members;
+
+  llvm::Expected<ContentBuffer &> readMember(llvm::StringRef path,
+                                             bool markForWriteBack) override {
+    auto member = members.find(path.str());
+    if (member == members.end())
+      return llvm::make_error<llvm::StringError>(
+          "no member " + path, llvm::inconvertibleErrorCode());
+    return member->second;
+  }
+  llvm::Error writeBack() override { return llvm::Error::success(); }
+  llvm::Error writeString(std::string *outputString) override {
+    return llvm::Error::success();
+  }
+};
+
+llvm::Error patchU8(llvm::MutableArrayRef<char> binary, uint64_t offset,
+                    ArgumentType const &value) {
+  auto const &angle = std::get<std::optional<double>>(value);
+  if (!angle)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "missing value");
+  binary[offset] = static_cast<char>(*angle);
+  return llvm::Error::success();
+}
+
+// opens the payload and signature of the test
+class TestBinder : public BindArgumentsImplementation {
+public:
+  TestBinder(TestPayload *payload, const Signature *sig)
+      : payload(payload), sig(sig) {}
+
+  llvm::Error patch(PatchPoint const &, ArgumentSource const &) override {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "unexpected patch");
+  }
+  llvm::Error parseParamMapIntoSignature(llvm::StringRef, llvm::StringRef,
+                                         Signature &) override {
+    return llvm::Error::success();
+  }
+  PatchablePayload *getPayload(llvm::StringRef, bool) override {
+    return new TestPayload(*payload);
+  }
+  llvm::Expected<Signature> parseSignature(PatchablePayload *) override {
+    return *sig;
+  }
+
+private:
+  TestPayload *payload;
+  const Signature *sig;
+};
+
+class TestFactory : public BindArgumentsImplementationFactory {
+public:
+  TestFactory(TestPayload *payload, const Signature *sig)
+      : payload(payload), sig(sig) {}
+
+  BindArgumentsImplementation *create(OptDiagnosticCallback) override {
+    return new TestBinder(payload, sig);
+  }
+  BindArgumentsImplementation *create(std::vector<char> &,
+                                      OptDiagnosticCallback) override {
+    return new TestBinder(payload, sig);
+  }
+  BindArgumentsImplementation *create(std::string &,
+                                      OptDiagnosticCallback) override {
+    return new TestBinder(payload, sig);
+  }
+  Patcher getPatcher(llvm::StringRef patchType) const override {
+    return patchType == "u8" ? patchU8 : nullptr;
+  }
+
+private:
+  TestPayload *payload;
+  const Signature *sig;
+};
+
+class TestArguments : public ArgumentSource {
+public:
+  llvm::StringMap<double> values;
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    auto value = values.find(name);
+    if (value == values.end())
+      return std::optional<double>();
+    return std::optional<double>(value->second);
+  }
+};
+
+TEST(ParameterTable, WritesRowPerArgumentSet) {
+  // As a user sweeping parameters, I want a table of all points of the sweep
+  // without patching the instrument binaries for each.
+
+  TestPayload payload;
+  payload.members[parameterTableMember.str()] = {0, 0, 9};
+  payload.members["drive0.bin"] = {7};
+
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "u8", parameterTableMember, 0);
+  sig.addParameterPatchPoint("phi", "u8", parameterTableMember, 1);
+
+  TestFactory factory(&payload, &sig);
+
+  TestArguments first;
+  first.values = {{"theta", 1}, {"phi", 2}};
+  TestArguments second;
+  second.values = {{"theta", 3}, {"phi", 4}};
+  const ArgumentSource *argumentSets[] = {&first, &second};
+
+  std::string table;
+  ASSERT_FALSE(llvm::errorToBool(bindParameterTable(
+      "", argumentSets, false, true, table, factory, std::nullopt)));
+  EXPECT_EQ(table, std::string({1, 2, 9, 3, 4, 9}));
+}
+
+TEST(ParameterTable, RequiresUnpatchedBinaries) {
+  TestPayload payload;
+  payload.members[parameterTableMember.str()] = {0};
+  payload.members["drive0.bin"] = {0};
+
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "u8", parameterTableMember, 0);
+  sig.addParameterPatchPoint("theta", "u8", "drive0.bin", 0);
+
+  TestFactory factory(&payload, &sig);
+  TestArguments arguments;
+  arguments.values = {{"theta", 1}};
+  const ArgumentSource *argumentSets[] = {&arguments};
+
+  std::string table;
+  EXPECT_TRUE(llvm::errorToBool(bindParameterTable(
+      "", argumentSets, false, true, table, factory, std::nullopt)));
+  EXPECT_TRUE(table.empty());
+}
+
+} // anonymous namespace
@@ -0,0 +1,129 @@
+//===- PreparedSignatureTest.cpp --------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for binding arguments through the
+/// patchers of a prepared signature.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Arguments.h"
+#include "Arguments/Signature.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using namespace qssc::arguments;
+
+llvm::Error patchU8(llvm::MutableArrayRef<char> binary, uint64_t offset,
+                    ArgumentType const &value) {
+  auto const &angle = std::get<std::optional<double>>(value);
+  if (!angle)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "missing value");
+  binary[offset] = static_cast<char>(*angle);
+  return llvm::Error::success();
+}
+
+// a factory which only patches through patchers
+class TestFactory : public BindArgumentsImplementationFactory {
+public:
+  BindArgumentsImplementation *create(OptDiagnosticCallback) override {
+    return nullptr;
+  }
+  BindArgumentsImplementation *create(std::vector<char> &,
+                                      OptDiagnosticCallback) override {
+    return nullptr;
+  }
+  BindArgumentsImplementation *create(std::string &,
+                                      OptDiagnosticCallback) override {
+    return nullptr;
+  }
+  Patcher getPatcher(llvm::StringRef patchType) const override {
+    return patchType == "u8" ? patchU8 : nullptr;
+  }
+};
+
+// arguments indexed as the parameters of a prepared signature
+class IndexedArguments : public ArgumentSource {
+public:
+  std::vector<double> values;
+  mutable unsigned numBatches = 0;
+
+  ArgumentType getArgumentValue(llvm::StringRef name) const override {
+    return std::nullopt;
+  }
+  void
+  getArgumentValues(llvm::ArrayRef<std::string> names,
+                    llvm::MutableArrayRef<ArgumentType> out) const override {
+    ++numBatches;
+    for (size_t i = 0; i < names.size(); ++i)
+      out[i] = std::optional<double>(values[i]);
+  }
+};
+
+TEST(PreparedSignature, AppliesPatchers) {
+  // As a target developer, I want patch points resolved once per signature
+  // and patched without dispatching on their strings.
+
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "u8", "drive0.bin", 0);
+  sig.addParameterPatchPoint("phi", "u8", "drive0.bin", 1);
+  sig.addParameterPatchPoint("theta", "u8", "drive1.bin", 0);
+
+  TestFactory const factory;
+  auto preparedOrErr = PreparedSignature::prepare(sig, factory);
+  ASSERT_TRUE(static_cast<bool>(preparedOrErr));
+  auto const &prepared = *preparedOrErr;
+
+  ASSERT_EQ(prepared.getParameters().vec(),
+            std::vector<std::string>({"theta", "phi"}));
+  ASSERT_EQ(prepared.getNumBinaries(), 2u);
+  EXPECT_EQ(prepared.getBinaryName(1), "drive1.bin");
+
+  IndexedArguments arguments;
+  arguments.values = {1, 2};
+  auto const values = prepared.getValues(arguments);
+  EXPECT_EQ(arguments.numBatches, 1u);
+
+  std::vector<char> drive0(2, 0);
+  std::vector<char> drive1(1, 0);
+  ASSERT_FALSE(llvm::errorToBool(prepared.apply(0, drive0, values)));
+  ASSERT_FALSE(llvm::errorToBool(prepared.apply(1, drive1, values)));
+  EXPECT_EQ(drive0, std::vector<char>({1, 2}));
+  EXPECT_EQ(drive1, std::vector<char>({1}));
+
+  // patch points must lie within their binary
+  std::vector<char> truncated(1, 0);
+  EXPECT_TRUE(llvm::errorToBool(prepared.apply(0, truncated, values)));
+}
+
+TEST(PreparedSignature, RequiresPatchers) {
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "f64", "drive0.bin", 0);
+
+  TestFactory const factory;
+  auto preparedOrErr = PreparedSignature::prepare(sig, factory);
+  EXPECT_FALSE(static_cast<bool>(preparedOrErr));
+  llvm::consumeError(preparedOrErr.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,120 @@
+//===- SignatureTest.cpp ----------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the Signature serialization formats.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Arguments/Signature.h"
+
+#include "llvm/Support/Error.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+
+using qssc::arguments::Signature;
+using qssc::arguments::SignatureView;
+using qssc::arguments::SignatureWriter;
+
+Signature makeSignature() {
+  Signature sig;
+  sig.addParameterPatchPoint("theta", "f64", "drive0.bin", 16);
+  sig.addParameterPatchPoint("phi", "f64", "drive0.bin", 48);
+  sig.addParameterPatchPoint("theta", "f64", "drive1.bin", 8);
+  return sig;
+}
+
+TEST(Signature, BinaryRoundTrip) {
+  // As a compiler developer, I want signatures in the binary format to
+  // deserialize to the same signature as the text format.
+
+  auto sig = makeSignature();
+  std::string const binary = sig.serializeBinary();
+
+  ASSERT_TRUE(SignatureView::isBinarySignature(binary));
+  EXPECT_FALSE(SignatureView::isBinarySignature(sig.serialize()));
+
+  auto fromBinary = Signature::deserialize(binary, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(fromBinary));
+  auto fromText = Signature::deserialize(sig.serialize(), std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(fromText));
+
+  EXPECT_EQ(fromBinary->serialize(), fromText->serialize());
+}
+
+TEST(Signature, BinaryView) {
+  // As a compiler developer, I want to iterate a binary signature in place.
+
+  std::string const binary = makeSignature().serializeBinary();
+
+  auto view = SignatureView::create(binary, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(view));
+  EXPECT_EQ(view->serializedSize(), binary.size());
+  ASSERT_EQ(view->numBinaries(), 2U);
+
+  auto const drive0 = view->binary(0);
+  EXPECT_EQ(drive0.name(), "drive0.bin");
+  ASSERT_EQ(drive0.size(), 2U);
+  EXPECT_EQ(drive0[1].expression(), "phi");
+  EXPECT_EQ(drive0[1].patchType(), "f64");
+  EXPECT_EQ(drive0[1].offset(), 48U);
+
+  auto const drive1 = view->binary(1);
+  EXPECT_EQ(drive1.name(), "drive1.bin");
+  ASSERT_EQ(drive1.size(), 1U);
+  EXPECT_EQ(drive1[0].expression(), "theta");
+  EXPECT_EQ(drive1[0].offset(), 8U);
+}
+
+TEST(Signature, BinaryWriter) {
+  // As a compiler developer, I want to write the binary signature of the
+  // patch points of a payload as I emit them.
+
+  SignatureWriter writer;
+  ASSERT_FALSE(static_cast<bool>(writer.beginBinary("drive0.bin")));
+  writer.addPatchPoint("theta", "f64", 16);
+  writer.addPatchPoint("phi", "f64", 48);
+  ASSERT_FALSE(static_cast<bool>(writer.beginBinary("drive1.bin")));
+  writer.addPatchPoint("theta", "f64", 8);
+  EXPECT_EQ(writer.numBinaries(), 2U);
+  EXPECT_EQ(writer.numPatchPoints(), 3U);
+
+  std::string const binary = writer.serialize();
+  EXPECT_EQ(binary, makeSignature().serializeBinary());
+
+  auto view = SignatureView::create(binary, std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(view));
+  ASSERT_EQ(view->numBinaries(), 2U);
+  EXPECT_EQ(view->binary(0)[1].expression(), "phi");
+  EXPECT_EQ(view->binary(1)[0].offset(), 8U);
+
+  auto err = writer.beginBinary("drive0.bin");
+  EXPECT_TRUE(static_cast<bool>(err));
+  llvm::consumeError(std::move(err));
+}
+
+TEST(Signature, BinaryTruncated) {
+  // As a compiler developer, I want truncated binary signatures rejected.
+
+  std::string binary = makeSignature().serializeBinary();
+  binary.resize(binary.size() - 1);
+
+  auto view = SignatureView::create(binary, std::nullopt);
+  EXPECT_FALSE(static_cast<bool>(view));
+  llvm::consumeError(view.takeError());
+}
+
+} // anonymous namespace
@@ -0,0 +1,186 @@
+//===- PulseCalsCacheTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the cache and index of parsed pulse
+/// calibrations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Conversion/QUIRToPulse/PulseCalsCache.h"
+#include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using mlir::pulse::PulseCalsCache;
+
+constexpr llvm::StringLiteral xCals = R"(
+module {
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+}
+)";
+
+constexpr llvm::StringLiteral xAndSxCals = R"(
+module {
+  pulse.sequence @x_0(%arg0: !pulse.mixed_frame) -> i1 {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+  pulse.sequence @sx_0(%arg0: !pulse.mixed_frame) -> i1 {
+    %false = arith.constant false
+    pulse.return %false : i1
+  }
+}
+)";
+
+class PulseCalsCacheTest : public ::testing::Test {
+protected:
+  mlir::MLIRContext ctx;
+  llvm::SmallString<128> path;
+
+  PulseCalsCacheTest() {
+    mlir::DialectRegistry registry;
+    registry.insert<mlir::pulse::PulseDialect, mlir::arith::ArithDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+  }
+
+  void SetUp() override {
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("pulse-cals", "mlir",
+                                                    path));
+    PulseCalsCache::global().clear();
+  }
+
+  void TearDown() override {
+    PulseCalsCache::global().clear();
+    llvm::sys::fs::remove(path);
+  }
+
+  void writeCals(llvm::StringRef cals) {
+    std::error_code ec;
+    llvm::raw_fd_ostream file(path, ec);
+    ASSERT_FALSE(ec);
+    file << cals;
+  }
+
+  static std::vector<std::string> sequenceNames(mlir::ModuleOp module) {
+    std::vector<std::string> names;
+    module->walk([&](mlir::pulse::SequenceOp sequenceOp) {
+      names.push_back(sequenceOp.getSymName().str());
+    });
+    return names;
+  }
+};
+
+TEST_F(PulseCalsCacheTest, ReusesUnchangedFile) {
+  writeCals(xCals);
+  EXPECT_FALSE(PulseCalsCache::global().contains(path));
+
+  auto first = PulseCalsCache::global().load(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(first)) << llvm::toString(first.takeError());
+  EXPECT_TRUE(PulseCalsCache::global().contains(path));
+
+  auto second = PulseCalsCache::global().load(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(second)) << llvm::toString(second.takeError());
+
+  // Each load materializes its own module, which may be modified freely.
+  EXPECT_NE(first->get(), second->get());
+  EXPECT_EQ(sequenceNames(first->get()), std::vector<std::string>{"x_0"});
+  EXPECT_EQ(sequenceNames(second->get()), std::vector<std::string>{"x_0"});
+}
+
+TEST_F(PulseCalsCacheTest, ReloadsChangedFile) {
+  writeCals(xCals);
+  auto first = PulseCalsCache::global().load(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(first)) << llvm::toString(first.takeError());
+
+  writeCals(xAndSxCals);
+  auto second = PulseCalsCache::global().load(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(second)) << llvm::toString(second.takeError());
+  EXPECT_EQ(sequenceNames(second->get()),
+            (std::vector<std::string>{"x_0", "sx_0"}));
+}
+
+TEST_F(PulseCalsCacheTest, MaterializesIndexedSequences) {
+  writeCals(xAndSxCals);
+  auto index = PulseCalsCache::global().loadIndex(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(index)) << llvm::toString(index.takeError());
+  EXPECT_EQ((*index)->size(), 2u);
+  EXPECT_TRUE((*index)->contains("sx_0"));
+  EXPECT_FALSE((*index)->contains("cx_0_1"));
+
+  // Only the sequences looked up are deserialized.
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::ModuleOp::create(mlir::UnknownLoc::get(&ctx));
+  auto sequenceOp = (*index)->materialize("sx_0", module.get());
+  ASSERT_TRUE(static_cast<bool>(sequenceOp))
+      << llvm::toString(sequenceOp.takeError());
+  ASSERT_TRUE(*sequenceOp);
+  EXPECT_EQ(sequenceOp->getSymName(), "sx_0");
+  EXPECT_EQ(sequenceNames(module.get()), std::vector<std::string>{"sx_0"});
+
+  auto missing = (*index)->materialize("cx_0_1", module.get());
+  ASSERT_TRUE(static_cast<bool>(missing))
+      << llvm::toString(missing.takeError());
+  EXPECT_FALSE(*missing);
+
+  // Compilations loading the unchanged file share the index.
+  auto reloaded = PulseCalsCache::global().loadIndex(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(reloaded))
+      << llvm::toString(reloaded.takeError());
+  EXPECT_EQ(reloaded->get(), index->get());
+
+  writeCals(xCals);
+  auto changed = PulseCalsCache::global().loadIndex(path, &ctx);
+  ASSERT_TRUE(static_cast<bool>(changed))
+      << llvm::toString(changed.takeError());
+  EXPECT_EQ((*changed)->size(), 1u);
+  EXPECT_FALSE((*changed)->contains("sx_0"));
+  EXPECT_NE((*changed)->getVersion(), (*index)->getVersion());
+}
+
+TEST_F(PulseCalsCacheTest, MissingFile) {
+  llvm::sys::fs::remove(path);
+  auto module = PulseCalsCache::global().load(path, &ctx);
+  EXPECT_FALSE(static_cast<bool>(module));
+  llvm::consumeError(module.takeError());
+  EXPECT_FALSE(PulseCalsCache::global().contains(path));
+}
+
+} // anonymous namespace
@@ -0,0 +1,142 @@
+//===- MetricsRegistryTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the registry of compiler metrics and
+/// their export.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/MetricsRegistry.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using qssc::hal::compile::MetricsRegistry;
+
+std::string print(const MetricsRegistry &registry,
+                  MetricsRegistry::Format format) {
+  std::string output;
+  llvm::raw_string_ostream os(output);
+  registry.print(os, format);
+  return os.str();
+}
+
+TEST(MetricsRegistry, Counters) {
+  MetricsRegistry registry;
+  registry.increment("compilations_total", "Compilations",
+                     {{"status", "success"}});
+  registry.increment("compilations_total", "Compilations",
+                     {{"status", "success"}}, 2);
+  registry.increment("compilations_total", "Compilations",
+                     {{"status", "failure"}});
+
+  EXPECT_EQ(registry.getCounter("compilations_total", {{"status", "success"}}),
+            3);
+  EXPECT_EQ(registry.getCounter("compilations_total", {{"status", "failure"}}),
+            1);
+  EXPECT_FALSE(registry.getCounter("compilations_total").has_value());
+
+  auto const prometheus = print(registry, MetricsRegistry::Format::Prometheus);
+  EXPECT_NE(prometheus.find("# TYPE compilations_total counter\n"),
+            std::string::npos);
+  EXPECT_NE(prometheus.find("compilations_total{status=\"success\"} 3\n"),
+            std::string::npos);
+
+  auto const openMetrics =
+      print(registry, MetricsRegistry::Format::OpenMetrics);
+  EXPECT_NE(openMetrics.find("# TYPE compilations counter\n"),
+            std::string::npos);
+  EXPECT_NE(openMetrics.find("compilations_total{status=\"failure\"} 1\n"),
+            std::string::npos);
+  EXPECT_EQ(openMetrics.substr(openMetrics.size() - 6), "# EOF\n");
+}
+
+TEST(MetricsRegistry, Histograms) {
+  MetricsRegistry registry;
+  const double buckets[] = {1, 10};
+  for (double const value : {0.5, 1.0, 5.0, 50.0})
+    registry.observe("latency_seconds", "Latency", buckets,
+                     {{"stage", "emit"}}, value);
+
+  auto histogram =
+      registry.getHistogram("latency_seconds", {{"stage", "emit"}});
+  ASSERT_TRUE(histogram.has_value());
+  EXPECT_EQ(histogram->count, 4u);
+  EXPECT_EQ(histogram->sum, 56.5);
+  EXPECT_EQ(histogram->bucketCounts, (std::vector<uint64_t>{2, 1, 1}));
+
+  auto const prometheus = print(registry, MetricsRegistry::Format::Prometheus);
+  EXPECT_NE(prometheus.find("latency_seconds_bucket{stage=\"emit\",le=\"1\"} "
+                            "2\nlatency_seconds_bucket{stage=\"emit\",le="
+                            "\"10\"} 3\nlatency_seconds_bucket{stage="
+                            "\"emit\",le=\"+Inf\"} 4\n"),
+            std::string::npos);
+  EXPECT_NE(prometheus.find("latency_seconds_sum{stage=\"emit\"} 56.5\n"),
+            std::string::npos);
+  EXPECT_NE(prometheus.find("latency_seconds_count{stage=\"emit\"} 4\n"),
+            std::string::npos);
+}
+
+TEST(MetricsRegistry, LabelEscaping) {
+  MetricsRegistry registry;
+  registry.increment("files_total", "Files", {{"path", "a\"b\\c\nd"}});
+  EXPECT_NE(print(registry, MetricsRegistry::Format::Prometheus)
+                .find("files_total{path=\"a\\\"b\\\\c\\nd\"} 1\n"),
+            std::string::npos);
+}
+
+TEST(MetricsRegistry, Merge) {
+  // As an operator of compile processes, I want their metrics collected in
+  // the process which started them.
+
+  MetricsRegistry child;
+  const double buckets[] = {1};
+  child.increment("jobs_total", "Jobs", {{"status", "success"}});
+  child.observe("job_seconds", "Job latency", buckets, {}, 2);
+
+  MetricsRegistry parent;
+  parent.increment("jobs_total", "Jobs", {{"status", "success"}});
+  ASSERT_FALSE(llvm::errorToBool(parent.merge(child.toJSON())));
+  ASSERT_FALSE(llvm::errorToBool(parent.merge(child.toJSON())));
+
+  EXPECT_EQ(parent.getCounter("jobs_total", {{"status", "success"}}), 3);
+  auto histogram = parent.getHistogram("job_seconds");
+  ASSERT_TRUE(histogram.has_value());
+  EXPECT_EQ(histogram->count, 2u);
+  EXPECT_EQ(histogram->bucketCounts, (std::vector<uint64_t>{0, 2}));
+
+  // Metrics must keep their type and buckets.
+  MetricsRegistry conflicting;
+  const double otherBuckets[] = {5};
+  conflicting.observe("job_seconds", "Job latency", otherBuckets, {}, 2);
+  EXPECT_TRUE(llvm::errorToBool(parent.merge(conflicting.toJSON())));
+  EXPECT_TRUE(llvm::errorToBool(parent.merge(llvm::json::Array{})));
+}
+
+TEST(MetricsRegistry, Swap) {
+  MetricsRegistry registry;
+  registry.increment("jobs_total", "Jobs");
+  MetricsRegistry taken;
+  registry.swap(taken);
+  EXPECT_FALSE(registry.getCounter("jobs_total").has_value());
+  EXPECT_EQ(taken.getCounter("jobs_total"), 1);
+}
+
+} // anonymous namespace
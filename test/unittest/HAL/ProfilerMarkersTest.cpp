@@ -0,0 +1,104 @@
+//===- ProfilerMarkersTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the profiler markers of timing
+/// scopes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/ProfilerMarkers.h"
+
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using qssc::hal::compile::ProfilerMarkers;
+using qssc::hal::compile::ProfilingTimingManager;
+
+class RecordingMarkers : public ProfilerMarkers {
+public:
+  explicit RecordingMarkers(std::vector<std::string> &events)
+      : events(events) {}
+
+  void begin(uint64_t id, llvm::StringRef name) override {
+    const std::lock_guard<std::mutex> lock(mutex);
+    events.push_back("B " + std::to_string(id) + " " + name.str());
+  }
+
+  void end(uint64_t id) override {
+    const std::lock_guard<std::mutex> lock(mutex);
+    events.push_back("E " + std::to_string(id));
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<std::string> &events;
+};
+
+TEST(ProfilerMarkers, DisabledTimingIsInactive) {
+  ProfilerMarkers::install(nullptr);
+  ProfilingTimingManager tm;
+  mlir::TimingScope root = tm.getRootScope();
+  EXPECT_FALSE(static_cast<bool>(root));
+  mlir::TimingScope nested = root.nest("stage");
+  EXPECT_FALSE(static_cast<bool>(nested));
+}
+
+TEST(ProfilerMarkers, MarksScopesWithoutTiming) {
+  // As a developer profiling a production compilation with perf, I want the
+  // stages of the compilation marked without enabling timing.
+
+  std::vector<std::string> events;
+  ProfilerMarkers::install(std::make_unique<RecordingMarkers>(events));
+  {
+    ProfilingTimingManager tm;
+    mlir::TimingScope root = tm.getRootScope();
+    ASSERT_TRUE(static_cast<bool>(root));
+    {
+      mlir::TimingScope stage = root.nest("stage");
+      mlir::TimingScope const inner = stage.nest("inner");
+    }
+    root.stop();
+  }
+  ProfilerMarkers::install(nullptr);
+
+  ASSERT_EQ(events.size(), 6u);
+  EXPECT_EQ(llvm::StringRef(events[0]).substr(0, 2), "B ");
+  EXPECT_TRUE(llvm::StringRef(events[0]).endswith(" qssc"));
+  EXPECT_TRUE(llvm::StringRef(events[1]).endswith(" stage"));
+  EXPECT_TRUE(llvm::StringRef(events[2]).endswith(" inner"));
+  // the scopes end in reverse order with the ids they began with
+  EXPECT_EQ(events[3], "E" + events[2].substr(1, events[2].rfind(' ') - 1));
+  EXPECT_EQ(events[4], "E" + events[1].substr(1, events[1].rfind(' ') - 1));
+  EXPECT_EQ(events[5], "E" + events[0].substr(1, events[0].rfind(' ') - 1));
+}
+
+TEST(ProfilerMarkers, RejectsUnknownMarkers) {
+  EXPECT_TRUE(llvm::errorToBool(ProfilerMarkers::create("itt").takeError()));
+  EXPECT_TRUE(
+      llvm::errorToBool(ProfilerMarkers::create("tracy:x").takeError()));
+  EXPECT_TRUE(llvm::errorToBool(
+      ProfilerMarkers::create("library:/nonexistent/libmarkers.so")
+          .takeError()));
+}
+
+} // anonymous namespace
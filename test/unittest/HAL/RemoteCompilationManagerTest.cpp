@@ -0,0 +1,71 @@
+//===- RemoteCompilationManagerTest.cpp -------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the jobs exchanged between the remote
+/// compilation manager and its workers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/RemoteCompilationManager.h"
+
+#include "llvm/Support/Error.h"
+
+#include <string>
+
+namespace {
+
+using qssc::hal::compile::SubtreeJob;
+using qssc::hal::compile::SubtreeResult;
+
+TEST(RemoteCompilationManager, SerializeJobs) {
+  // As an operator of compile workers, I want jobs and their results to
+  // survive any byte transport unchanged.
+
+  SubtreeJob job;
+  job.targetPath = "controller/drive0";
+  job.payloadPrefix = "exp/";
+  job.compileMLIR = false;
+  job.moduleBytecode = std::string("ML\xefR\0bytes", 10);
+
+  auto parsedJob = SubtreeJob::deserialize(job.serialize());
+  ASSERT_TRUE(static_cast<bool>(parsedJob)) << toString(parsedJob.takeError());
+  EXPECT_EQ(parsedJob->targetPath, job.targetPath);
+  EXPECT_EQ(parsedJob->payloadPrefix, job.payloadPrefix);
+  EXPECT_FALSE(parsedJob->compileMLIR);
+  EXPECT_EQ(parsedJob->moduleBytecode, job.moduleBytecode);
+
+  SubtreeResult result;
+  result.moduleBytecode = "compiled";
+  result.files["exp/drive0.bin"] = std::string("\0\1\2", 3);
+  result.files["exp/drive0.json"] = "{}";
+
+  auto parsedResult = SubtreeResult::deserialize(result.serialize());
+  ASSERT_TRUE(static_cast<bool>(parsedResult))
+      << toString(parsedResult.takeError());
+  EXPECT_EQ(parsedResult->moduleBytecode, result.moduleBytecode);
+  EXPECT_EQ(parsedResult->files, result.files);
+}
+
+TEST(RemoteCompilationManager, RejectTruncatedJobs) {
+  SubtreeJob job;
+  job.targetPath = "drive0";
+  job.moduleBytecode = "module";
+  std::string serialized = job.serialize();
+  serialized.pop_back();
+  EXPECT_TRUE(
+      llvm::errorToBool(SubtreeJob::deserialize(serialized).takeError()));
+  EXPECT_TRUE(llvm::errorToBool(
+      SubtreeResult::deserialize(job.serialize()).takeError()));
+}
+
+} // anonymous namespace
@@ -23,6 +23,18 @@
 
 #include "HAL/TargetSystemRegistry.h"
 
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
 namespace {
 
 TEST(TargetSystemRegistry, LookupMockTarget) {
@@ -45,4 +57,118 @@ TEST(TargetSystemRegistry, LookupMockTarget) {
   }
 }
 
+TEST(TargetSystemRegistry, ConcurrentLookups) {
+  // As a compiler developer, I want concurrent jobs to look up targets
+  // without serializing them.
+
+  qssc::hal::registry::TargetSystemRegistry::registeredPlugins();
+  EXPECT_TRUE(qssc::hal::registry::TargetSystemRegistry::isFrozen());
+  EXPECT_FALSE(qssc::plugin::registry::PluginRegistry<
+               qssc::hal::registry::TargetSystemInfo>::
+                   registerPlugin("frozen", "frozen",
+                                  "Registered after freezing.", nullptr,
+                                  nullptr, nullptr));
+
+  std::atomic<int> numFound{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j)
+        if (qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo(
+                "mock"))
+          ++numFound;
+    });
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(numFound.load(), 8000);
+}
+
+TEST(TargetSystemRegistry, SharedTargets) {
+  // As a compiler developer, I want jobs for the same target configuration to
+  // share their target.
+
+  llvm::SmallString<128> configPath;
+  int fd = 0;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("mock", "cfg", fd, configPath));
+  {
+    llvm::raw_fd_ostream config(fd, /*shouldClose=*/true);
+    config << "num_qubits 2\nacquire_multiplexing_ratio_to_1 5\n"
+           << "controllerNodeId 1000\n";
+  }
+
+  auto *targetInfo =
+      *qssc::hal::registry::TargetSystemRegistry::lookupPluginInfo("mock");
+  mlir::MLIRContext firstContext;
+  mlir::MLIRContext secondContext;
+  auto first = targetInfo->createTarget(&firstContext,
+                                        llvm::StringRef(configPath));
+  ASSERT_TRUE(static_cast<bool>(first)) << llvm::toString(first.takeError());
+  auto second = targetInfo->createTarget(&secondContext,
+                                         llvm::StringRef(configPath));
+  ASSERT_TRUE(static_cast<bool>(second)) << llvm::toString(second.takeError());
+  EXPECT_EQ(*first, *second);
+
+  auto registered = targetInfo->getTarget(&secondContext);
+  ASSERT_TRUE(static_cast<bool>(registered));
+  EXPECT_EQ(*registered, *first);
+
+  llvm::sys::fs::remove(configPath);
+}
+
+TEST(TargetSystemRegistry, CachedTargetLookups) {
+  // As a target developer, I want passes running over many modules in
+  // parallel to look their target up without resolving it each time.
+
+  llvm::SmallString<128> configPath;
+  int fd = 0;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("mock", "cfg", fd, configPath));
+  {
+    llvm::raw_fd_ostream config(fd, /*shouldClose=*/true);
+    config << "num_qubits 2\nacquire_multiplexing_ratio_to_1 5\n"
+           << "controllerNodeId 1000\n";
+  }
+
+  using qssc::hal::registry::TargetSystemRegistry;
+  auto *targetInfo = *TargetSystemRegistry::lookupPluginInfo("mock");
+  mlir::MLIRContext context;
+  auto created =
+      targetInfo->createTarget(&context, llvm::StringRef(configPath));
+  ASSERT_TRUE(static_cast<bool>(created))
+      << llvm::toString(created.takeError());
+
+  std::atomic<int> numFound{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j) {
+        auto target = TargetSystemRegistry::lookupTarget(&context, "mock");
+        if (target && *target == *created)
+          ++numFound;
+        else if (!target)
+          llvm::consumeError(target.takeError());
+      }
+    });
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(numFound.load(), 8000);
+
+  // the cache does not outlive the target of the context
+  TargetSystemRegistry::releaseTargets(&context);
+  auto released = TargetSystemRegistry::lookupTarget(&context, "mock");
+  auto registered = targetInfo->getTarget(&context);
+  ASSERT_EQ(static_cast<bool>(released), static_cast<bool>(registered));
+  if (released)
+    EXPECT_EQ(*released, *registered);
+  llvm::consumeError(released.takeError());
+  llvm::consumeError(registered.takeError());
+
+  EXPECT_TRUE(llvm::errorToBool(
+      TargetSystemRegistry::lookupTarget(&context, "unregistered")
+          .takeError()));
+
+  llvm::sys::fs::remove(configPath);
+}
+
 } // anonymous namespace
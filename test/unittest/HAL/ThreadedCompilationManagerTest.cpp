@@ -0,0 +1,328 @@
+//===- ThreadedCompilationManagerTest.cpp -----------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements stress tests and a scaling benchmark of the threaded
+/// compilation of synthetic target trees of varying width and depth.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "HAL/Compile/MetricsRegistry.h"
+#include "HAL/Compile/ThreadedCompilationManager.h"
+#include "HAL/TargetSystem.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/TypeID.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::hal::TargetSystem;
+using qssc::hal::compile::MetricsRegistry;
+using qssc::hal::compile::ThreadedCompilationManager;
+
+/// The locks of the threaded compilation manager whose contention it records.
+constexpr llvm::StringLiteral lockNames[] = {
+    "context", "pass-manager-build", "pass-manager-pool", "pass-manager-pools",
+    "print-ir"};
+
+/// A CPU bound pass standing in for the pipeline of a target, which hashes
+/// the name of its module a number of times and only touches that module.
+struct SyntheticWorkPass
+    : public mlir::PassWrapper<SyntheticWorkPass,
+                               mlir::OperationPass<mlir::ModuleOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(SyntheticWorkPass)
+
+  explicit SyntheticWorkPass(unsigned iterations) : iterations(iterations) {}
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    std::string digest = moduleOp.getName().value_or("root").str();
+    for (unsigned i = 0; i < iterations; ++i) {
+      llvm::SHA256 hasher;
+      hasher.update(digest);
+      digest = llvm::toHex(hasher.final(), /*LowerCase=*/true);
+    }
+    moduleOp->setAttr("synthetic.digest",
+                      mlir::StringAttr::get(&getContext(), digest));
+  }
+
+  unsigned iterations;
+};
+
+/// A target system of width children per level, depth levels deep, each of
+/// which compiles the module of its name nested in the module of its parent.
+class SyntheticTarget : public TargetSystem {
+public:
+  SyntheticTarget(std::string name, Target *parent, unsigned width,
+                  unsigned depth, unsigned iterations)
+      : TargetSystem(std::move(name), parent), iterations(iterations) {
+    if (depth == 0)
+      return;
+    for (unsigned i = 0; i < width; ++i)
+      addChild(std::make_unique<SyntheticTarget>(
+          getName().str() + "_" + std::to_string(i), this, width, depth - 1,
+          iterations));
+  }
+
+  llvm::Expected<mlir::ModuleOp>
+  getModule(mlir::ModuleOp parentModuleOp) override {
+    if (!getParent())
+      return parentModuleOp;
+    for (auto moduleOp : parentModuleOp.getBody()->getOps<mlir::ModuleOp>())
+      if (moduleOp.getName() == getName())
+        return moduleOp;
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "No module for target " + getName());
+  }
+
+  llvm::Error addPasses(mlir::PassManager &pm) override {
+    pm.addPass(std::make_unique<SyntheticWorkPass>(iterations));
+    return llvm::Error::success();
+  }
+
+  llvm::Error emitToPayload(mlir::ModuleOp moduleOp,
+                            qssc::payload::Payload &payload) override {
+    return llvm::Error::success();
+  }
+
+private:
+  unsigned iterations;
+};
+
+/// Nest the modules of the children of target in moduleOp.
+void buildTargetModules(qssc::hal::Target &target, mlir::ModuleOp moduleOp) {
+  auto builder = mlir::OpBuilder::atBlockEnd(moduleOp.getBody());
+  for (auto *child : target.getChildren()) {
+    auto childModuleOp =
+        builder.create<mlir::ModuleOp>(builder.getUnknownLoc(),
+                                       child->getName());
+    buildTargetModules(*child, childModuleOp);
+  }
+}
+
+mlir::OwningOpRef<mlir::ModuleOp> buildModule(mlir::MLIRContext &context,
+                                              SyntheticTarget &target) {
+  mlir::OwningOpRef<mlir::ModuleOp> moduleOp(
+      mlir::ModuleOp::create(mlir::UnknownLoc::get(&context)));
+  buildTargetModules(target, *moduleOp);
+  return moduleOp;
+}
+
+/// Count the modules of the tree compiled by SyntheticWorkPass.
+unsigned countCompiledModules(mlir::ModuleOp moduleOp) {
+  unsigned count = 0;
+  moduleOp->walk([&](mlir::ModuleOp nestedModuleOp) {
+    if (nestedModuleOp->hasAttr("synthetic.digest"))
+      ++count;
+  });
+  return count;
+}
+
+unsigned countTargets(unsigned width, unsigned depth) {
+  unsigned count = 1;
+  unsigned level = 1;
+  for (unsigned i = 0; i < depth; ++i) {
+    level *= width;
+    count += level;
+  }
+  return count;
+}
+
+llvm::Error buildPassManager(mlir::PassManager &pm) {
+  return llvm::Error::success();
+}
+
+/// The contention recorded for each lock of the threaded compilation manager
+/// by the process metrics.
+std::map<std::string, std::pair<double, double>> getLockContention() {
+  std::map<std::string, std::pair<double, double>> contention;
+  auto &metrics = MetricsRegistry::instance();
+  for (auto name : lockNames) {
+    MetricsRegistry::Labels const labels{{"lock", name.str()}};
+    contention[name.str()] = {
+        metrics.getCounter("qssc_compile_lock_contentions_total", labels)
+            .value_or(0),
+        metrics.getCounter("qssc_compile_lock_wait_seconds_total", labels)
+            .value_or(0)};
+  }
+  return contention;
+}
+
+/// A context whose passes and target subtrees run on a pool of threads.
+struct ThreadedContext {
+  explicit ThreadedContext(unsigned threads)
+      : threadPool(llvm::hardware_concurrency(threads)),
+        context(mlir::MLIRContext::Threading::DISABLED) {
+    context.setThreadPool(threadPool);
+  }
+
+  llvm::ThreadPool threadPool;
+  mlir::MLIRContext context;
+};
+
+TEST(ThreadedCompilationManager, CompileTargetTrees) {
+  // As a compiler developer, I want every target of trees of any shape to be
+  // compiled exactly once regardless of the number of threads.
+  struct Shape {
+    unsigned width;
+    unsigned depth;
+  };
+  for (auto threads : {1U, 4U}) {
+    ThreadedContext threaded(threads);
+    for (auto shape : {Shape{1, 0}, Shape{1, 4}, Shape{8, 1}, Shape{4, 2},
+                       Shape{3, 3}}) {
+      SyntheticTarget target("root", nullptr, shape.width, shape.depth,
+                             /*iterations=*/16);
+      ThreadedCompilationManager manager(target, &threaded.context,
+                                         buildPassManager);
+      // later compilations reuse the pass managers of the first one
+      for (unsigned round = 0; round < 3; ++round) {
+        auto moduleOp = buildModule(threaded.context, target);
+        ASSERT_FALSE(llvm::errorToBool(manager.compileMLIR(*moduleOp)));
+        EXPECT_EQ(countCompiledModules(*moduleOp),
+                  countTargets(shape.width, shape.depth))
+            << "width " << shape.width << " depth " << shape.depth
+            << " threads " << threads;
+      }
+    }
+  }
+}
+
+TEST(ThreadedCompilationManager, ConcurrentManagersSharePools) {
+  // As an operator of a compile server, I want the compilations of several
+  // requests for the same target to run concurrently on shared pass manager
+  // pools, including while the pools are invalidated.
+  constexpr unsigned numManagers = 8;
+  constexpr unsigned numRounds = 8;
+  ThreadedContext threaded(4);
+  SyntheticTarget target("root", nullptr, /*width=*/4, /*depth=*/2,
+                         /*iterations=*/16);
+  ThreadedCompilationManager owner(target, &threaded.context,
+                                   buildPassManager);
+
+  std::vector<unsigned> compiled(numManagers, 0);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < numManagers; ++i)
+    threads.emplace_back([&, i]() {
+      ThreadedCompilationManager manager(target, &threaded.context,
+                                         buildPassManager,
+                                         owner.getPassManagerPools());
+      for (unsigned round = 0; round < numRounds; ++round) {
+        if (i == 0 && round == numRounds / 2)
+          manager.invalidateTargetPassManagers();
+        auto moduleOp = buildModule(threaded.context, target);
+        if (llvm::errorToBool(manager.compileMLIR(*moduleOp)))
+          continue;
+        if (countCompiledModules(*moduleOp) == countTargets(4, 2))
+          ++compiled[i];
+      }
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  for (unsigned i = 0; i < numManagers; ++i)
+    EXPECT_EQ(compiled[i], numRounds) << "manager " << i;
+}
+
+TEST(ThreadedCompilationManager, ScalingBenchmark) {
+  // As a compiler developer, I want to see how the compilation of wide and
+  // deep target trees scales with the number of threads, and how long the
+  // threads wait for the locks of the compilation manager, to verify that
+  // threading changes actually scale.
+  constexpr unsigned numRounds = 4;
+  unsigned const maxThreads =
+      std::min(8U, std::max(1U, std::thread::hardware_concurrency()));
+
+  struct Shape {
+    unsigned width;
+    unsigned depth;
+  };
+  for (auto shape : {Shape{16, 1}, Shape{4, 3}}) {
+    double baseline = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+      ThreadedContext threaded(threads);
+      SyntheticTarget target("root", nullptr, shape.width, shape.depth,
+                             /*iterations=*/4096);
+      ThreadedCompilationManager manager(target, &threaded.context,
+                                         buildPassManager);
+      // the first compilation builds the pass managers and is not measured
+      auto warmupModuleOp = buildModule(threaded.context, target);
+      ASSERT_FALSE(llvm::errorToBool(manager.compileMLIR(*warmupModuleOp)));
+
+      auto const contentionBefore = getLockContention();
+      auto const start = std::chrono::steady_clock::now();
+      for (unsigned round = 0; round < numRounds; ++round) {
+        auto moduleOp = buildModule(threaded.context, target);
+        ASSERT_FALSE(llvm::errorToBool(manager.compileMLIR(*moduleOp)));
+        EXPECT_EQ(countCompiledModules(*moduleOp),
+                  countTargets(shape.width, shape.depth));
+      }
+      std::chrono::duration<double> const elapsed =
+          std::chrono::steady_clock::now() - start;
+      auto const contentionAfter = getLockContention();
+
+      double const seconds = elapsed.count() / numRounds;
+      if (threads == 1)
+        baseline = seconds;
+      llvm::outs() << "width " << shape.width << " depth " << shape.depth
+                   << " threads " << threads << ": "
+                   << llvm::formatv("{0:F0}", seconds * 1e6)
+                   << "us per compilation, speedup "
+                   << llvm::formatv("{0:F2}", baseline / seconds) << "\n";
+      for (auto name : lockNames) {
+        auto const &[contentions, waited] = contentionAfter.at(name.str());
+        auto const &[contentionsBefore, waitedBefore] =
+            contentionBefore.at(name.str());
+        if (contentions == contentionsBefore)
+          continue;
+        llvm::outs() << "  lock " << name << ": "
+                     << contentions - contentionsBefore << " contended, "
+                     << llvm::formatv("{0:F1}",
+                                      (waited - waitedBefore) * 1e6)
+                     << "us waiting\n";
+      }
+    }
+  }
+}
+
+} // anonymous namespace
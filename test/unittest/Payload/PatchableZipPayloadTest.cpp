@@ -0,0 +1,75 @@
+//===- PatchableZipPayloadTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for reading the members of patchable zip
+/// payloads ahead of patching them.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/PatchableZipPayload.h"
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using qssc::payload::Payload;
+using qssc::payload::PatchableZipPayload;
+
+TEST(PatchableZipPayload, PrefetchesMembers) {
+  // As a user binding arguments to a payload of many instruments, I want the
+  // binaries decompressed concurrently rather than one after the other.
+
+  auto payloadInfo =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfo.has_value());
+  auto payload = payloadInfo.value()->createPluginInstance(std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(payload));
+
+  std::vector<std::string> names;
+  std::vector<std::string> programs;
+  for (char drive = '0'; drive < '8'; ++drive) {
+    names.push_back(std::string("drive") + drive + ".bin");
+    programs.emplace_back(4096, drive);
+    (*payload)->addFile(names.back(), programs.back());
+  }
+
+  std::string archive;
+  llvm::raw_string_ostream os(archive);
+  (*payload)->write(os);
+  os.flush();
+
+  PatchableZipPayload patchable(archive, /*enableInMemory=*/true);
+  std::vector<std::string> prefetched(names);
+  prefetched.emplace_back("missing.bin");
+  EXPECT_FALSE(llvm::errorToBool(patchable.prefetchMembers(prefetched)));
+
+  for (size_t index = 0; index < names.size(); ++index) {
+    auto contents = patchable.readMember(names[index]);
+    ASSERT_TRUE(static_cast<bool>(contents)) << toString(contents.takeError());
+    EXPECT_EQ(std::string(contents->begin(), contents->end()),
+              programs[index]);
+  }
+
+  // the members which could not be prefetched are reported when read
+  EXPECT_TRUE(
+      llvm::errorToBool(patchable.readMember("missing.bin").takeError()));
+}
+
+} // anonymous namespace
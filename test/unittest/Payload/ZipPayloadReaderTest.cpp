@@ -0,0 +1,165 @@
+//===- ZipPayloadReaderTest.cpp ---------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for reading single members of zip
+/// payloads through their member index.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Payload/Payload.h"
+#include "Payload/PayloadRegistry.h"
+#include "Payload/ZipPayloadReader.h"
+
+#include "Config/QSSConfig.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using qssc::payload::Payload;
+using qssc::payload::ZipPayloadReader;
+
+TEST(ZipPayloadReader, ReadsMembersOfTarget) {
+  // As a service fetching payloads from an object store, I want to read the
+  // members of a single instrument without fetching the whole payload.
+
+  auto payloadInfo =
+      qssc::payload::registry::PayloadRegistry::lookupPluginInfo("ZIP");
+  ASSERT_TRUE(payloadInfo.has_value());
+  auto payload = payloadInfo.value()->createPluginInstance(std::nullopt);
+  ASSERT_TRUE(static_cast<bool>(payload));
+
+  std::string const program(4096, 'x');
+  {
+    Payload::EmissionScope const scope(**payload, /*emittedFiles=*/nullptr,
+                                       "drive0");
+    (*payload)->addFile("drive0.bin", program);
+  }
+  (*payload)->addFile("config.json", "{}");
+
+  std::string archive;
+  llvm::raw_string_ostream os(archive);
+  (*payload)->write(os);
+  os.flush();
+
+  std::vector<std::pair<uint64_t, uint64_t>> reads;
+  auto reader = ZipPayloadReader::open(
+      [&](uint64_t offset, uint64_t size) -> llvm::Expected<std::string> {
+        reads.emplace_back(offset, size);
+        return archive.substr(offset, size);
+      },
+      archive.size());
+  ASSERT_TRUE(static_cast<bool>(reader)) << toString(reader.takeError());
+  // the end of the payload and the index
+  EXPECT_EQ(reads.size(), 2u);
+
+  auto owned = reader->getMembersOf("drive0");
+  ASSERT_EQ(owned.size(), 1u);
+  EXPECT_EQ(owned[0]->name, "drive0.bin");
+  EXPECT_NE(reader->find("manifest/manifest.json"), nullptr);
+
+  auto contents = reader->readMember(*owned[0]);
+  ASSERT_TRUE(static_cast<bool>(contents)) << toString(contents.takeError());
+  EXPECT_EQ(*contents, program);
+  EXPECT_EQ(reads.back().second, owned[0]->compressedSize);
+
+  EXPECT_TRUE(llvm::errorToBool(reader->readMember("missing").takeError()));
+}
+
+TEST(ZipPayloadReader, ThinPayloads) {
+  // As a pipeline running an experiment family, I want the members which the
+  // payloads of its compilations share stored once.
+
+  llvm::SmallString<128> blobStore;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("blobs", blobStore));
+
+  std::string const program(4096, 'x');
+  auto writePayload = [&]() {
+    qssc::payload::PayloadConfig config;
+    config.prefix = "exp";
+    config.name = "exp";
+    config.verbosity = qssc::config::QSSVerbosity::Warn;
+    config.blobStore = blobStore.str().str();
+    auto payload = qssc::payload::registry::PayloadRegistry::lookupPluginInfo(
+                       "ZIP")
+                       .value()
+                       ->createPluginInstance(config);
+    EXPECT_TRUE(static_cast<bool>(payload));
+    (*payload)->addFile("exp/drive0.bin", program);
+    std::string archive;
+    llvm::raw_string_ostream os(archive);
+    (*payload)->write(os);
+    return os.str();
+  };
+  auto readIndex = [](const std::string &archive) {
+    return ZipPayloadReader::open(
+        [&](uint64_t offset, uint64_t size) -> llvm::Expected<std::string> {
+          return archive.substr(offset, size);
+        },
+        archive.size());
+  };
+
+  // the first payload archives the member and adds it to the store
+  std::string const full = writePayload();
+  auto fullReader = readIndex(full);
+  ASSERT_TRUE(static_cast<bool>(fullReader))
+      << toString(fullReader.takeError());
+  const auto *member = fullReader->find("exp/drive0.bin");
+  ASSERT_NE(member, nullptr);
+  EXPECT_FALSE(member->inBlobStore);
+  EXPECT_EQ(member->sha256.size(), 64u);
+
+  // the second payload refers to the stored blob
+  std::string const thin = writePayload();
+  EXPECT_LT(thin.size(), full.size());
+  auto thinReader = readIndex(thin);
+  ASSERT_TRUE(static_cast<bool>(thinReader))
+      << toString(thinReader.takeError());
+  const auto *reference = thinReader->find("exp/drive0.bin");
+  ASSERT_NE(reference, nullptr);
+  EXPECT_TRUE(reference->inBlobStore);
+  EXPECT_EQ(reference->sha256, member->sha256);
+  EXPECT_TRUE(
+      llvm::errorToBool(thinReader->readMember(*reference).takeError()));
+
+  llvm::SmallString<128> blob(blobStore);
+  llvm::sys::path::append(blob, member->sha256);
+  auto buffer = llvm::MemoryBuffer::getFile(blob);
+  ASSERT_TRUE(static_cast<bool>(buffer));
+  EXPECT_EQ((*buffer)->getBuffer(), program);
+
+  llvm::sys::fs::remove_directories(blobStore);
+}
+
+TEST(ZipPayloadReader, RejectsUnindexedPayloads) {
+  std::string const archive(64, '\0');
+  auto reader = ZipPayloadReader::open(
+      [&](uint64_t offset, uint64_t size) -> llvm::Expected<std::string> {
+        return archive.substr(offset, size);
+      },
+      archive.size());
+  EXPECT_TRUE(llvm::errorToBool(reader.takeError()));
+}
+
+} // anonymous namespace
@@ -0,0 +1,128 @@
+//===- LoweredCircuitCacheTest.cpp ------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the cache of the circuits lowered to
+/// pulse sequences and of their schedules.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/Pulse/Utils/LoweredCircuitCache.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using mlir::pulse::ConvertedSequenceArg;
+using mlir::pulse::LoweredCircuit;
+using mlir::pulse::LoweredCircuitCache;
+using mlir::pulse::LoweredCircuitSchedule;
+
+class LoweredCircuitCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override { LoweredCircuitCache::global().clear(); }
+  void TearDown() override { LoweredCircuitCache::global().clear(); }
+
+  static LoweredCircuit makeCircuit(std::string bytecode) {
+    LoweredCircuit circuit;
+    circuit.bytecode = std::move(bytecode);
+    circuit.args.push_back({ConvertedSequenceArg::Kind::Angle, 1});
+    circuit.args.push_back({ConvertedSequenceArg::Kind::MixFrame, 0,
+                            "q0-drive-mixframe", "q0-drive-port"});
+    return circuit;
+  }
+
+  static LoweredCircuitSchedule makeSchedule(int64_t duration) {
+    LoweredCircuitSchedule schedule;
+    schedule.gateTimepoints = {-duration, -duration / 2};
+    schedule.duration = duration;
+    schedule.timepoint = duration;
+    schedule.portUsages.push_back({"q0-drive-port", 0, duration});
+    return schedule;
+  }
+};
+
+TEST_F(LoweredCircuitCacheTest, LooksUpInsertedCircuits) {
+  auto &cache = LoweredCircuitCache::global();
+  EXPECT_FALSE(cache.lookup("circuit"));
+
+  cache.insert("circuit", makeCircuit("bytecode"));
+  EXPECT_EQ(cache.size(), 1u);
+  auto circuit = cache.lookup("circuit");
+  ASSERT_TRUE(circuit);
+  EXPECT_EQ(circuit->bytecode, "bytecode");
+  ASSERT_EQ(circuit->args.size(), 2u);
+  EXPECT_EQ(circuit->args[0].kind, ConvertedSequenceArg::Kind::Angle);
+  EXPECT_EQ(circuit->args[0].circuitArgIndex, 1u);
+  EXPECT_EQ(circuit->args[1].name, "q0-drive-mixframe");
+  EXPECT_EQ(circuit->args[1].portName, "q0-drive-port");
+
+  // Entries looked up remain valid once replaced.
+  cache.insert("circuit", makeCircuit("other"));
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_EQ(circuit->bytecode, "bytecode");
+  EXPECT_EQ(cache.lookup("circuit")->bytecode, "other");
+}
+
+TEST_F(LoweredCircuitCacheTest, KeepsSchedulesByMethod) {
+  auto &cache = LoweredCircuitCache::global();
+
+  // A schedule is only kept along with its circuit.
+  cache.insertSchedule("circuit", "alap", makeSchedule(160));
+  EXPECT_FALSE(cache.lookupSchedule("circuit", "alap"));
+
+  cache.insert("circuit", makeCircuit("bytecode"));
+  cache.insertSchedule("circuit", "alap", makeSchedule(160));
+  auto schedule = cache.lookupSchedule("circuit", "alap");
+  ASSERT_TRUE(schedule);
+  EXPECT_EQ(schedule->gateTimepoints, (std::vector<int64_t>{-160, -80}));
+  EXPECT_EQ(schedule->duration, 160);
+  EXPECT_EQ(schedule->timepoint, 160);
+  ASSERT_EQ(schedule->portUsages.size(), 1u);
+  EXPECT_EQ(schedule->portUsages[0].portName, "q0-drive-port");
+  EXPECT_FALSE(cache.lookupSchedule("circuit", "asap"));
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_FALSE(cache.lookup("circuit"));
+  EXPECT_FALSE(cache.lookupSchedule("circuit", "alap"));
+}
+
+TEST_F(LoweredCircuitCacheTest, DropsEntriesBeyondMaxBytes) {
+  auto &cache = LoweredCircuitCache::global();
+  std::string const half(LoweredCircuitCache::maxBytes / 2, 'x');
+
+  cache.insert("first", makeCircuit(half));
+  cache.insertSchedule("first", "alap", makeSchedule(160));
+  cache.insert("second", makeCircuit(half));
+  EXPECT_EQ(cache.size(), 2u);
+
+  // Replacing an entry does not count its previous bytecode.
+  cache.insert("second", makeCircuit(half));
+  EXPECT_EQ(cache.size(), 2u);
+
+  cache.insert("third", makeCircuit("bytecode"));
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_FALSE(cache.lookup("first"));
+  EXPECT_FALSE(cache.lookupSchedule("first", "alap"));
+  EXPECT_TRUE(cache.lookup("third"));
+}
+
+} // anonymous namespace
@@ -0,0 +1,168 @@
+//===- SchedulePortTest.cpp -------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for scheduling the operations of the
+/// mixed frames of a sequence on their port.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/Pulse/IR/PulseDialect.h"
+#include "Dialect/Pulse/IR/PulseInterfaces.h"
+#include "Dialect/Pulse/IR/PulseOps.h"
+#include "Dialect/Pulse/Transforms/SchedulePort.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/LogicalResult.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace mlir;
+using namespace mlir::pulse;
+
+class SchedulePortTest : public ::testing::Test {
+protected:
+  MLIRContext ctx;
+
+  SchedulePortTest() {
+    DialectRegistry registry;
+    registry.insert<PulseDialect, arith::ArithDialect, func::FuncDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+  }
+
+  /// Build a dynamical decoupling train of numPeriods plays followed by
+  /// delays on each of two mixed frames of a port, with the operations of
+  /// the second frame after all those of the first in the block.
+  OwningOpRef<ModuleOp> buildTrain(size_t numPeriods) {
+    std::string source;
+    llvm::raw_string_ostream os(source);
+    os << "pulse.sequence @train(%wfr: !pulse.waveform, "
+          "%frame0: !pulse.mixed_frame, %frame1: !pulse.mixed_frame) -> i1 "
+          "{\n"
+          "  %false = arith.constant false\n"
+          "  %c16 = arith.constant 16 : i32\n"
+          "  %c24 = arith.constant 24 : i32\n";
+    for (auto [frame, delay] : {std::pair{"%frame0", "%c16"},
+                                std::pair{"%frame1", "%c24"}}) {
+      for (size_t i = 0; i < numPeriods; ++i)
+        os << "  pulse.play {pulse.duration = 8 : i64}(" << frame
+           << ", %wfr) : (!pulse.mixed_frame, !pulse.waveform)\n"
+           << "  pulse.delay(" << frame << ", " << delay
+           << ") : (!pulse.mixed_frame, i32)\n";
+    }
+    os << "  pulse.return %false : i1\n"
+          "}\n"
+          "func.func @main() -> i32 {\n"
+          "  %c0_i32 = arith.constant 0 : i32\n"
+          "  %port = \"pulse.create_port\"() {uid = \"p0\"} : () -> "
+          "!pulse.port\n"
+          "  %frame0 = \"pulse.mix_frame\"(%port) {uid = \"mf0-p0\"} : "
+          "(!pulse.port) -> !pulse.mixed_frame\n"
+          "  %frame1 = \"pulse.mix_frame\"(%port) {uid = \"mf1-p0\"} : "
+          "(!pulse.port) -> !pulse.mixed_frame\n"
+          "  %wfr = pulse.create_waveform dense<[[0.0, 1.0]]> : "
+          "tensor<1x2xf64> -> !pulse.waveform\n"
+          "  %0 = pulse.call_sequence @train(%wfr, %frame0, %frame1) : "
+          "(!pulse.waveform, !pulse.mixed_frame, !pulse.mixed_frame) -> i1\n"
+          "  return %c0_i32 : i32\n"
+          "}\n";
+    return parseSourceString<ModuleOp>(os.str(), ParserConfig(&ctx));
+  }
+
+  static LogicalResult schedule(ModuleOp module) {
+    PassManager pm(module->getContext());
+    pm.addPass(std::make_unique<SchedulePortPass>());
+    return pm.run(module);
+  }
+
+  /// Check that the plays of the train are ordered by timepoint and get the
+  /// timepoint of its return.
+  static std::optional<int64_t> checkTrain(ModuleOp module,
+                                           size_t numPeriods) {
+    auto sequenceOp = module.lookupSymbol<SequenceOp>("train");
+    size_t numPlays = 0;
+    int64_t lastTimepoint = 0;
+    for (auto playOp : sequenceOp.getBody().front().getOps<PlayOp>()) {
+      auto timepoint = PulseOpSchedulingInterface::getTimepoint(playOp);
+      EXPECT_TRUE(timepoint.has_value());
+      EXPECT_LE(lastTimepoint, timepoint.value_or(0));
+      lastTimepoint = timepoint.value_or(0);
+      ++numPlays;
+    }
+    EXPECT_EQ(numPlays, 2 * numPeriods);
+    EXPECT_TRUE(sequenceOp.getBody().front().getOps<DelayOp>().empty());
+    auto returnOp =
+        cast<ReturnOp>(sequenceOp.getBody().front().getTerminator());
+    return PulseOpSchedulingInterface::getTimepoint(returnOp);
+  }
+};
+
+TEST_F(SchedulePortTest, InterleavesMixedFrames) {
+  auto module = buildTrain(3);
+  ASSERT_TRUE(module);
+  ASSERT_TRUE(succeeded(schedule(*module)));
+
+  // The plays of the frames start every 24 and every 32 samples.
+  auto sequenceOp = module->lookupSymbol<SequenceOp>("train");
+  std::vector<int64_t> timepoints;
+  for (auto playOp : sequenceOp.getBody().front().getOps<PlayOp>())
+    timepoints.push_back(
+        PulseOpSchedulingInterface::getTimepoint(playOp).value_or(-1));
+  EXPECT_EQ(timepoints, (std::vector<int64_t>{0, 0, 24, 32, 48, 64}));
+  EXPECT_EQ(checkTrain(*module, 3), 96);
+}
+
+TEST_F(SchedulePortTest, Microbenchmark) {
+  // As a compiler developer, I want to know the cost of scheduling the long
+  // dynamical decoupling trains of our programs.
+  constexpr size_t numPeriods = 5000;
+  auto module = buildTrain(numPeriods);
+  ASSERT_TRUE(module);
+
+  auto const start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(succeeded(schedule(*module)));
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  RecordProperty(
+      "schedule_port_ns",
+      std::to_string(
+          std::chrono::duration<double, std::nano>(elapsed).count()));
+  EXPECT_EQ(checkTrain(*module, numPeriods),
+            static_cast<int64_t>(32 * numPeriods));
+}
+
+} // anonymous namespace
@@ -0,0 +1,169 @@
+//===- WaveformSamplingTest.cpp ---------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the evaluation of the samples of the
+/// parametric waveforms.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/Pulse/Utils/WaveformSampling.h"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mlir::pulse;
+
+/// The samples of a lifted Gaussian evaluated one sample at a time with
+/// std::exp, as a reference for the vector kernels.
+std::vector<double> referenceSamples(size_t dur, std::complex<double> amp,
+                                     double sigma, double width, double beta) {
+  double const center = static_cast<double>(dur) / 2;
+  double const flatBegin = center - width / 2;
+  double const flatEnd = center + width / 2;
+  auto const gaussian = [&](double distance) {
+    return std::exp(-0.5 * (distance / sigma) * (distance / sigma));
+  };
+  double const offset = gaussian(-1.0 - flatBegin);
+
+  std::vector<double> samples;
+  for (size_t i = 0; i < dur; ++i) {
+    double const time = static_cast<double>(i) + 0.5;
+    double distance = 0.0;
+    if (time < flatBegin)
+      distance = time - flatBegin;
+    else if (time > flatEnd)
+      distance = time - flatEnd;
+    double const value = (gaussian(distance) - offset) / (1.0 - offset);
+    double const derivative =
+        -distance / (sigma * sigma) * gaussian(distance) / (1.0 - offset);
+    std::complex<double> const sample =
+        amp * std::complex<double>(value, beta * derivative);
+    samples.push_back(sample.real());
+    samples.push_back(sample.imag());
+  }
+  return samples;
+}
+
+void expectSamplesNear(const std::vector<double> &actual,
+                       const std::vector<double> &expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i)
+    EXPECT_NEAR(actual[i], expected[i], 1e-14) << "at index " << i;
+}
+
+TEST(WaveformSampling, Exp) {
+  std::vector<double> values;
+  for (double x = -800.0; x <= 720.0; x += 0.37)
+    values.push_back(x);
+  values.push_back(0.0);
+  values.push_back(std::numeric_limits<double>::quiet_NaN());
+  values.push_back(-std::numeric_limits<double>::infinity());
+
+  std::vector<double> results = values;
+  expInPlace(results);
+  for (size_t i = 0; i < values.size(); ++i) {
+    double const expected = std::exp(values[i]);
+    if (std::isnan(expected))
+      EXPECT_TRUE(std::isnan(results[i]));
+    else if (std::isinf(expected) || expected == 0.0)
+      EXPECT_EQ(results[i], expected) << "exp(" << values[i] << ")";
+    else
+      EXPECT_NEAR(results[i] / expected, 1.0, 1e-15) << "exp(" << values[i]
+                                                     << ")";
+  }
+  RecordProperty("kernel", getWaveformSamplingKernel().str());
+}
+
+TEST(WaveformSampling, Const) {
+  std::vector<double> samples(6);
+  sampleConstWaveform({0.25, -0.5}, samples);
+  EXPECT_EQ(samples, (std::vector<double>{0.25, -0.5, 0.25, -0.5, 0.25, -0.5}));
+}
+
+TEST(WaveformSampling, Gaussian) {
+  std::complex<double> const amp(0.3, 0.1);
+  for (size_t const dur : {0, 1, 7, 160, 1001}) {
+    std::vector<double> samples(2 * dur);
+    sampleGaussianWaveform(amp, 40.0, samples);
+    expectSamplesNear(samples, referenceSamples(dur, amp, 40.0, 0.0, 0.0));
+  }
+
+  // The samples are symmetric about the center and the lifted edges
+  // vanish one sample outside the waveform.
+  std::vector<double> samples(2 * 10);
+  sampleGaussianWaveform({1.0, 0.0}, 2.0, samples);
+  for (size_t i = 0; i < 10; ++i)
+    EXPECT_DOUBLE_EQ(samples[2 * i], samples[2 * (9 - i)]);
+  EXPECT_GT(samples[0], 0.0);
+  EXPECT_LT(samples[8], 1.0);
+}
+
+TEST(WaveformSampling, GaussianSquare) {
+  std::complex<double> const amp(0.2, 0.0);
+  std::vector<double> samples(2 * 640);
+  sampleGaussianSquareWaveform(amp, 16.0, 512.0, samples);
+  expectSamplesNear(samples, referenceSamples(640, amp, 16.0, 512.0, 0.0));
+  for (size_t i = 64; i < 576; ++i)
+    EXPECT_DOUBLE_EQ(samples[2 * i], 0.2);
+}
+
+TEST(WaveformSampling, Drag) {
+  std::complex<double> const amp(0.1, 0.05);
+  std::vector<double> samples(2 * 333);
+  sampleDragWaveform(amp, 50.0, -0.7, samples);
+  expectSamplesNear(samples, referenceSamples(333, amp, 50.0, 0.0, -0.7));
+}
+
+TEST(WaveformSampling, Microbenchmark) {
+  // As a compiler developer, I want to know the cost of sampling waveforms
+  // of realistic durations with the vector kernel, compared with evaluating
+  // each sample with std::exp.
+  std::complex<double> const amp(0.1, 0.01);
+  auto const timeNs = [](auto &&body) {
+    auto const start = std::chrono::steady_clock::now();
+    body();
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count();
+  };
+
+  for (size_t const dur : {1000, 10000, 100000}) {
+    double const sigma = static_cast<double>(dur) / 8;
+    std::vector<double> expected;
+    double const referenceNs = timeNs(
+        [&]() { expected = referenceSamples(dur, amp, sigma, 0.0, 0.3); });
+
+    std::vector<double> samples(2 * dur);
+    double const kernelNs =
+        timeNs([&]() { sampleDragWaveform(amp, sigma, 0.3, samples); });
+
+    std::string const suffix = "_" + std::to_string(dur) + "_ns";
+    RecordProperty("reference_drag" + suffix, std::to_string(referenceNs));
+    RecordProperty("kernel_drag" + suffix, std::to_string(kernelNs));
+    expectSamplesNear(samples, expected);
+  }
+}
+
+} // anonymous namespace
@@ -0,0 +1,105 @@
+//===- CacheFunctionsTest.cpp -----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the cache of the functions optimized
+/// by the compilations of a process.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+#include "Dialect/QUIR/Transforms/CacheFunctions.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace {
+
+using namespace mlir;
+using namespace mlir::quir;
+
+constexpr llvm::StringLiteral program = R"(
+func.func @scale(%arg0: i32) -> i32 {
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.addi %c1, %c1 : i32
+  %0 = arith.muli %arg0, %c2 : i32
+  return %0 : i32
+}
+func.func @main() -> i32 {
+  %c3 = arith.constant 3 : i32
+  %0 = func.call @scale(%c3) : (i32) -> i32
+  return %0 : i32
+}
+)";
+
+/// Compile program in a context of its own, as a compilation of the process
+/// would, and get the number of cache hits and the optimized program.
+std::pair<unsigned, std::string> compile() {
+  MLIRContext ctx;
+  DialectRegistry registry;
+  registry.insert<QUIRDialect, arith::ArithDialect, func::FuncDialect>();
+  ctx.appendDialectRegistry(registry);
+  ctx.loadAllAvailableDialects();
+
+  auto moduleOp = parseSourceString<ModuleOp>(program, &ctx);
+  EXPECT_TRUE(moduleOp);
+
+  PassManager pm(&ctx);
+  auto pass = std::make_unique<CacheFunctionsPass>();
+  auto *cacheFunctions = pass.get();
+  pm.addPass(std::move(pass));
+  EXPECT_TRUE(succeeded(pm.run(moduleOp.get())));
+
+  std::string printed;
+  llvm::raw_string_ostream printedStream(printed);
+  moduleOp->print(printedStream);
+  return {cacheFunctions->numCacheHits.getValue(), printedStream.str()};
+}
+
+TEST(CacheFunctions, ReusesOptimizedFunctions) {
+  // As a user compiling programs which share subroutines, I want the
+  // subroutines optimized once per process.
+
+  FunctionCache::global().clear();
+
+  auto [firstHits, first] = compile();
+  EXPECT_EQ(firstHits, 0u);
+  EXPECT_EQ(FunctionCache::global().size(), 1u);
+  EXPECT_EQ(first.find("arith.addi"), std::string::npos);
+
+  auto [secondHits, second] = compile();
+  EXPECT_EQ(secondHits, 1u);
+  EXPECT_EQ(second, first);
+
+  FunctionCache::global().clear();
+}
+
+} // anonymous namespace
@@ -0,0 +1,166 @@
+//===- ConvertDurationUnitsTest.cpp -----------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the conversion of the units of QUIR
+/// durations.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QUIR/IR/QUIRAttributes.h"
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+#include "Dialect/QUIR/IR/QUIREnums.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/IR/QUIRTimeUnits.h"
+#include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/Transforms/ConvertDurationUnits.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/ValueRange.h"
+#include "mlir/Pass/PassManager.h"
+
+#include "llvm/ADT/APFloat.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace {
+
+using namespace mlir;
+using namespace mlir::quir;
+
+class ConvertDurationUnits : public ::testing::Test {
+protected:
+  MLIRContext ctx;
+
+  ConvertDurationUnits() {
+    DialectRegistry registry;
+    registry.insert<QUIRDialect, func::FuncDialect>();
+    ctx.appendDialectRegistry(registry);
+    ctx.loadAllAvailableDialects();
+  }
+
+  /// Build a circuit of numDelays delays on a qubit, cycling through a few
+  /// durations in ns.
+  OwningOpRef<ModuleOp> buildDelays(size_t numDelays) {
+    auto loc = UnknownLoc::get(&ctx);
+    OwningOpRef<ModuleOp> moduleOp = ModuleOp::create(loc);
+    OpBuilder builder(moduleOp->getBodyRegion());
+    auto funcOp = builder.create<func::FuncOp>(
+        loc, "main", builder.getFunctionType({}, {}));
+    builder.setInsertionPointToStart(funcOp.addEntryBlock());
+
+    auto qubit = builder.create<DeclareQubitOp>(
+        loc, builder.getType<QubitType>(1),
+        builder.getIntegerAttr(builder.getI32Type(), 0));
+    auto nsType = DurationType::get(&ctx, TimeUnits::ns);
+    for (size_t i = 0; i < numDelays; ++i) {
+      auto duration = builder.create<quir::ConstantOp>(
+          loc, DurationAttr::get(&ctx, nsType,
+                                 llvm::APFloat(static_cast<double>(
+                                     16 * (1 + i % 8)))));
+      builder.create<DelayOp>(loc, duration, ValueRange{qubit});
+    }
+    builder.create<func::ReturnOp>(loc);
+    return moduleOp;
+  }
+};
+
+TEST_F(ConvertDurationUnits, TimeUnitsTable) {
+  constexpr double dt = 0.25e-9;
+  for (size_t input = 0; input < numTimeUnits; ++input) {
+    for (size_t output = 0; output < numTimeUnits; ++output) {
+      auto inputUnits = static_cast<TimeUnits>(input);
+      auto outputUnits = static_cast<TimeUnits>(output);
+      double const value = 160.;
+      double expected = value;
+      if (inputUnits != outputUnits) {
+        double seconds = value;
+        if (inputUnits == TimeUnits::dt)
+          seconds = value * dt;
+        else
+          seconds = value / getUnitsPerSecond(inputUnits);
+        expected = outputUnits == TimeUnits::dt
+                       ? seconds / dt
+                       : seconds * getUnitsPerSecond(outputUnits);
+      }
+      EXPECT_EQ(DurationAttr::convertUnitsToUnits(value, inputUnits,
+                                                  outputUnits, dt),
+                expected)
+          << stringifyTimeUnits(inputUnits).str() << " to "
+          << stringifyTimeUnits(outputUnits).str();
+    }
+  }
+
+  EXPECT_EQ((convertTimeUnits<TimeUnits::us, TimeUnits::ns>(1.5, dt)), 1500.);
+  EXPECT_EQ((convertTimeUnits<TimeUnits::ns, TimeUnits::dt>(160., dt)), 640.);
+}
+
+TEST_F(ConvertDurationUnits, ConvertDurationConstants) {
+  auto moduleOp = buildDelays(16);
+  EXPECT_EQ(convertDurationConstants(*moduleOp, TimeUnits::dt, 0.25e-9), 16u);
+
+  size_t numDelays = 0;
+  moduleOp->walk([&](DelayOp delayOp) {
+    auto constantOp = delayOp.getTime().getDefiningOp<quir::ConstantOp>();
+    ASSERT_TRUE(constantOp);
+    auto duration = constantOp.getValue().cast<DurationAttr>();
+    EXPECT_EQ(duration.getType().getUnits(), TimeUnits::dt);
+    EXPECT_EQ(duration.getDuration().convertToDouble(),
+              64. * (1 + numDelays % 8));
+    ++numDelays;
+  });
+  EXPECT_EQ(numDelays, 16u);
+
+  // nothing is left to convert
+  EXPECT_EQ(convertDurationConstants(*moduleOp, TimeUnits::dt, 0.25e-9), 0u);
+}
+
+TEST_F(ConvertDurationUnits, Microbenchmark) {
+  // As a compiler developer, I want to know the cost of converting the
+  // durations of delay-dense circuits.
+  for (size_t const numDelays : {1000, 10000, 100000}) {
+    auto moduleOp = buildDelays(numDelays);
+    PassManager pm(&ctx);
+    pm.addPass(std::make_unique<ConvertDurationUnitsPass>(TimeUnits::dt,
+                                                          0.25e-9));
+
+    auto const start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(succeeded(pm.run(*moduleOp)));
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    moduleOp->walk([&](DelayOp delayOp) {
+      EXPECT_EQ(delayOp.getTime().getType().cast<DurationType>().getUnits(),
+                TimeUnits::dt);
+    });
+    RecordProperty(
+        "convert_duration_units_" + std::to_string(numDelays) + "_ns",
+        std::to_string(
+            std::chrono::duration<double, std::nano>(elapsed).count()));
+  }
+}
+
+} // anonymous namespace
@@ -0,0 +1,112 @@
+//===- DurationLexerTest.cpp ------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the QUIR duration literal lexer.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QUIR/IR/QUIREnums.h"
+#include "Dialect/QUIR/Utils/DurationLexer.h"
+
+#include "llvm/Support/Error.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace {
+
+using mlir::quir::lexDuration;
+using mlir::quir::lexTimeUnits;
+using mlir::quir::TimeUnits;
+
+void expectDuration(const char *literal, double value, TimeUnits units) {
+  auto duration = lexDuration(literal);
+  ASSERT_TRUE(static_cast<bool>(duration))
+      << literal << ": " << llvm::toString(duration.takeError());
+  EXPECT_EQ(duration->first, value) << literal;
+  EXPECT_EQ(duration->second, units) << literal;
+}
+
+void expectError(const char *literal) {
+  auto duration = lexDuration(literal);
+  EXPECT_FALSE(static_cast<bool>(duration)) << literal;
+  llvm::consumeError(duration.takeError());
+}
+
+TEST(DurationLexer, Units) {
+  EXPECT_EQ(lexTimeUnits(""), TimeUnits::s);
+  EXPECT_EQ(lexTimeUnits("dt"), TimeUnits::dt);
+  EXPECT_EQ(lexTimeUnits("DT"), TimeUnits::dt);
+  EXPECT_EQ(lexTimeUnits("s"), TimeUnits::s);
+  EXPECT_EQ(lexTimeUnits("ms"), TimeUnits::ms);
+  EXPECT_EQ(lexTimeUnits("uS"), TimeUnits::us);
+  EXPECT_EQ(lexTimeUnits("ns"), TimeUnits::ns);
+  EXPECT_EQ(lexTimeUnits("ps"), TimeUnits::ps);
+  EXPECT_EQ(lexTimeUnits("fs"), TimeUnits::fs);
+  EXPECT_FALSE(lexTimeUnits("min").has_value());
+}
+
+TEST(DurationLexer, Literals) {
+  expectDuration("10ns", 10.0, TimeUnits::ns);
+  expectDuration("1.5us", 1.5, TimeUnits::us);
+  expectDuration(".5ms", 0.5, TimeUnits::ms);
+  expectDuration("100DT", 100.0, TimeUnits::dt);
+  expectDuration("2", 2.0, TimeUnits::s);
+  expectDuration("0.1s", std::stod("0.1"), TimeUnits::s);
+  // Mantissas which are not exact doubles are converted by strtod.
+  expectDuration("12345678901234567890.5ps",
+                 std::stod("12345678901234567890.5"), TimeUnits::ps);
+}
+
+TEST(DurationLexer, Errors) {
+  expectError("");
+  expectError("ns");
+  expectError("5.");
+  expectError("1.2.3ns");
+  expectError("1e3ns");
+  expectError("10 ns");
+  expectError("-10ns");
+  expectError("10min");
+}
+
+TEST(DurationLexer, Microbenchmark) {
+  // As a compiler developer, I want to know the cost of lexing a duration
+  // literal, which is paid for every delay of delay-heavy programs.
+  constexpr std::array<const char *, 6> literals{
+      "10ns", "1.5us", "160dt", "0.25ms", "1000", "3.14159fs"};
+  constexpr size_t iterations = 100000;
+
+  double checksum = 0.0;
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    auto duration = lexDuration(literals[i % literals.size()]);
+    ASSERT_TRUE(static_cast<bool>(duration));
+    checksum += duration->first;
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  auto const nsPerLiteral =
+      std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  RecordProperty("ns_per_literal", std::to_string(nsPerLiteral));
+  EXPECT_GT(checksum, 0.0);
+}
+
+} // anonymous namespace
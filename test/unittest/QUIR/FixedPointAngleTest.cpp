@@ -0,0 +1,70 @@
+//===- FixedPointAngleTest.cpp ----------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the fixed-point values of angles.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QUIR/Utils/FixedPointAngle.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace {
+
+using namespace mlir::quir;
+
+// the arithmetic is usable in constant expressions
+static_assert((Angle<4>::fromBits(15) + Angle<4>::fromBits(3)).getBits() == 2);
+static_assert((Angle<4>::fromBits(1) - Angle<4>::fromBits(2)).getBits() == 15);
+static_assert((Angle<4>::fromBits(5) * Angle<4>::fromBits(7)).getBits() == 3);
+static_assert(std::is_same_v<Angle<31>::Storage, int32_t>);
+static_assert(std::is_same_v<Angle<32>::Storage, int64_t>);
+
+TEST(FixedPointAngle, FromDouble) {
+  EXPECT_EQ(Angle<20>::fromDouble(0.5).getBits(), uint64_t{1} << 19);
+  EXPECT_DOUBLE_EQ(Angle<20>::fromDouble(0.25).toDouble(), 0.25);
+
+  // values wrap around to the width
+  EXPECT_EQ(Angle<20>::fromDouble(1.5), Angle<20>::fromDouble(0.5));
+  EXPECT_EQ(Angle<20>::fromDouble(-0.25), Angle<20>::fromDouble(0.75));
+  EXPECT_EQ(Angle<63>::fromDouble(-std::ldexp(1.0, -63)).getBits(),
+            Angle<63>::mask);
+}
+
+TEST(FixedPointAngle, WrapsAroundLikeTheController) {
+  auto const lhs = Angle<20>::fromBits(Angle<20>::mask);
+  auto const rhs = Angle<20>::fromBits(2);
+  EXPECT_EQ((lhs + rhs).getBits(), 1U);
+  EXPECT_EQ((rhs - lhs).getBits(), 3U);
+  EXPECT_EQ((-rhs).getBits(), Angle<20>::mask - 1);
+}
+
+TEST(FixedPointAngle, VisitsTheWidth) {
+  auto mask = visitAngleWidth(
+      12, [](auto angle) { return decltype(angle)::mask; });
+  ASSERT_TRUE(mask.has_value());
+  EXPECT_EQ(*mask, 0xfffU);
+
+  EXPECT_FALSE(visitAngleWidth(0, [](auto) { return 0; }).has_value());
+  EXPECT_FALSE(visitAngleWidth(64, [](auto) { return 0; }).has_value());
+}
+
+} // anonymous namespace
@@ -0,0 +1,112 @@
+//===- OpDispatchTest.cpp ---------------------------------------*- C++ -*-===//
+//
+// (C) Copyright IBM 2024.
+//
+// This code is part of Qiskit.
+//
+// This code is licensed under the Apache License, Version 2.0 with LLVM
+// Exceptions. You may obtain a copy of this license in the LICENSE.txt
+// file in the root directory of this source tree.
+//
+// Any modifications or derivative works of this code must retain this
+// copyright notice, and modified files need to carry a notice indicating
+// that they have been altered from the originals.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements test cases for the dispatch of operations by their
+/// kind.
+///
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Dialect/QUIR/IR/QUIRDialect.h"
+#include "Dialect/QUIR/IR/QUIROps.h"
+#include "Dialect/QUIR/Utils/OpDispatch.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace mlir;
+using namespace mlir::quir;
+
+constexpr llvm::StringLiteral program = R"(
+func.func @main() {
+  %q0 = quir.declare_qubit {id = 0 : i32} : !quir.qubit<1>
+  %q1 = quir.declare_qubit {id = 1 : i32} : !quir.qubit<1>
+  quir.reset %q0 : !quir.qubit<1>
+  quir.builtin_CX %q0, %q1 : !quir.qubit<1>, !quir.qubit<1>
+  %0:2 = quir.measure(%q0, %q1) : (!quir.qubit<1>, !quir.qubit<1>) -> (i1, i1)
+  return
+}
+)";
+
+struct RecordKinds {
+  std::vector<std::string> &kinds;
+
+  void operator()(MeasureOp) { kinds.push_back("measure"); }
+  void operator()(ResetQubitOp) { kinds.push_back("reset"); }
+  void operator()(BuiltinCXOp) { kinds.push_back("cx"); }
+};
+
+TEST(OpDispatch, DispatchesByKind) {
+  MLIRContext ctx;
+  DialectRegistry registry;
+  registry.insert<QUIRDialect, func::FuncDialect>();
+  ctx.appendDialectRegistry(registry);
+  ctx.loadAllAvailableDialects();
+
+  auto moduleOp = parseSourceString<ModuleOp>(program, &ctx);
+  ASSERT_TRUE(moduleOp);
+
+  using Dispatcher = OpDispatcher<ResetQubitOp, BuiltinCXOp, MeasureOp>;
+  std::vector<std::string> kinds;
+  unsigned numSkipped = 0;
+  moduleOp->walk([&](Operation *op) {
+    if (!Dispatcher::get().dispatch(op, RecordKinds{kinds}))
+      ++numSkipped;
+    EXPECT_EQ(Dispatcher::get().contains(op),
+              isa<ResetQubitOp, BuiltinCXOp, MeasureOp>(op));
+  });
+
+  EXPECT_EQ(kinds, (std::vector<std::string>{"reset", "cx", "measure"}));
+  // the declarations, the return, the function and the module
+  EXPECT_EQ(numSkipped, 5u);
+}
+
+TEST(OpDispatch, FirstKindWins) {
+  MLIRContext ctx;
+  ctx.loadDialect<QUIRDialect, func::FuncDialect>();
+  auto moduleOp = parseSourceString<ModuleOp>(program, &ctx);
+  ASSERT_TRUE(moduleOp);
+
+  unsigned numFirst = 0;
+  unsigned numSecond = 0;
+  using Dispatcher = OpDispatcher<MeasureOp, ResetQubitOp, MeasureOp>;
+  moduleOp->walk([&](Operation *op) {
+    Dispatcher::get().dispatch(op, [&](auto castOp) {
+      if (isa<MeasureOp>(castOp))
+        ++numFirst;
+      else
+        ++numSecond;
+    });
+  });
+  EXPECT_EQ(numFirst, 1u);
+  EXPECT_EQ(numSecond, 1u);
+}
+
+} // anonymous namespace
@@ -18,8 +18,12 @@
 #include "Dialect/QUIR/IR/QUIROps.h"
 #include "Dialect/QUIR/IR/QUIRTraits.h"
 #include "Dialect/QUIR/IR/QUIRTypes.h"
+#include "Dialect/QUIR/IR/QubitSet.h"
+#include "Dialect/QUIR/Utils/QubitFootprintAnalysis.h"
+#include "Dialect/QUIR/Utils/SymbolIndexAnalysis.h"
 #include "Dialect/QUIR/Utils/Utils.h"
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/DialectRegistry.h"
@@ -29,6 +33,8 @@
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
 
+#include "llvm/ADT/SmallVector.h"
+
 #include "gtest/gtest.h"
 
 namespace {
@@ -105,4 +111,82 @@ TEST_F(QUIRDialect, MeasureSideEffects) {
   EXPECT_FALSE(mlir::isOpTriviallyDead(measureOp.getOperation()));
 }
 
+TEST_F(QUIRDialect, SymbolIndexAnalysis) {
+  ctx.loadDialect<mlir::func::FuncDialect>();
+
+  builder.setInsertionPointToStart(rootModule.getBody());
+  auto circuitOp = builder.create<mlir::quir::CircuitOp>(
+      unkownLoc, "circuit_0", builder.getFunctionType({}, {}));
+  auto mainFunc = builder.create<mlir::func::FuncOp>(
+      unkownLoc, "main", builder.getFunctionType({}, {}));
+  builder.setInsertionPointToStart(mainFunc.addEntryBlock());
+  auto callCircuitOp =
+      builder.create<mlir::quir::CallCircuitOp>(unkownLoc, circuitOp);
+
+  mlir::quir::SymbolIndexAnalysis symbolIndex(rootModule);
+  EXPECT_EQ(symbolIndex.getMainFunction(), mainFunc.getOperation());
+  EXPECT_EQ(symbolIndex.getCircuitOp(callCircuitOp), circuitOp);
+  EXPECT_FALSE(symbolIndex.lookupSymbolIn(rootModule, "circuit_1"));
+
+  // symbols inserted through the index can be looked up right away
+  builder.setInsertionPointToStart(rootModule.getBody());
+  auto newCircuitOp = builder.create<mlir::quir::CircuitOp>(
+      unkownLoc, "circuit_1", builder.getFunctionType({}, {}));
+  symbolIndex.getSymbolTable(rootModule).insert(newCircuitOp);
+  EXPECT_EQ(symbolIndex.lookupSymbolIn<mlir::quir::CircuitOp>(rootModule,
+                                                              "circuit_1"),
+            newCircuitOp);
+}
+
+TEST_F(QUIRDialect, QubitFootprintAnalysis) {
+  ctx.loadDialect<mlir::func::FuncDialect>();
+
+  builder.setInsertionPointToStart(rootModule.getBody());
+  auto mainFunc = builder.create<mlir::func::FuncOp>(
+      unkownLoc, "main", builder.getFunctionType({}, {}));
+  builder.setInsertionPointToStart(mainFunc.addEntryBlock());
+  llvm::SmallVector<mlir::Value> qubits;
+  for (int id = 0; id < 3; ++id)
+    qubits.push_back(builder.create<mlir::quir::DeclareQubitOp>(
+        unkownLoc, builder.getType<mlir::quir::QubitType>(1),
+        builder.getIntegerAttr(builder.getI32Type(), id)));
+  auto firstReset = builder.create<mlir::quir::ResetQubitOp>(
+      unkownLoc, mlir::ValueRange{qubits[0]});
+  auto barrier = builder.create<mlir::quir::BarrierOp>(
+      unkownLoc, mlir::ValueRange{qubits[1], qubits[2]});
+  auto lastReset = builder.create<mlir::quir::ResetQubitOp>(
+      unkownLoc, mlir::ValueRange{qubits[2]});
+
+  mlir::quir::QubitFootprintAnalysis footprints(rootModule);
+  EXPECT_EQ(footprints.getOperatedQubits(firstReset),
+            (mlir::quir::QubitSet{0}));
+  EXPECT_EQ(footprints.getOperatedQubits(mainFunc),
+            (mlir::quir::QubitSet{0, 1, 2}));
+  EXPECT_EQ(footprints.getQubitsBetween(qubits[0].getDefiningOp(), lastReset),
+            (mlir::quir::QubitSet{0, 1, 2}));
+  EXPECT_EQ(footprints.getQubitsBetween(firstReset, lastReset),
+            (mlir::quir::QubitSet{1, 2}));
+  EXPECT_TRUE(footprints.getQubitsBetween(firstReset, barrier).empty());
+
+  // rewrites reported through the listener update the cached footprints
+  footprints.getListener()->notifyOperationRemoved(barrier);
+  barrier->erase();
+  EXPECT_TRUE(footprints.getQubitsBetween(firstReset, lastReset).empty());
+  EXPECT_EQ(footprints.getOperatedQubits(mainFunc),
+            (mlir::quir::QubitSet{0, 2}));
+
+  builder.setListener(footprints.getListener());
+  builder.setInsertionPoint(lastReset);
+  builder.create<mlir::quir::ResetQubitOp>(unkownLoc,
+                                           mlir::ValueRange{qubits[1]});
+  EXPECT_EQ(footprints.getQubitsBetween(firstReset, lastReset),
+            (mlir::quir::QubitSet{1}));
+
+  // moves bypassing the rewriter are reported explicitly
+  firstReset->moveAfter(lastReset);
+  footprints.notifyOperationMoved(firstReset, firstReset->getBlock());
+  EXPECT_EQ(footprints.getQubitsBetween(qubits[2].getDefiningOp(), firstReset),
+            (mlir::quir::QubitSet{1, 2}));
+}
+
 } // namespace
@@ -15,7 +15,73 @@
 //===----------------------------------------------------------------------===//
 
 #include "API/api.h"
+#include "QSSC.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+#include <vector>
+
+/// Keep stdout for the responses of the server modes and send any output
+/// written directly by jobs to stderr so that it cannot corrupt them.
+static int redirectStdout() {
+  int const responseFd = dup(fileno(stdout));
+  if (responseFd < 0 || dup2(fileno(stderr), fileno(stdout)) < 0)
+    return -1;
+  return responseFd;
+}
 
 int main(int argc, const char **argv) {
+  if (argc == 2 && llvm::StringRef(argv[1]) == "--serve") {
+    int const responseFd = redirectStdout();
+    if (responseFd < 0) {
+      llvm::errs() << "Error: unable to set up the compile server streams\n";
+      return 1;
+    }
+    llvm::raw_fd_ostream responses(responseFd, /*shouldClose=*/true);
+
+    qssc::CompileServer server;
+    return server.serve(std::cin, responses);
+  }
+
+  if (argc == 4 && llvm::StringRef(argv[1]) == "--pack-resources") {
+    // Pack the static resources of a directory into a resource pack
+    if (auto err = llvm::writeToOutput(argv[3], [&](llvm::raw_ostream &os) {
+          return qssc::ResourcePack::write(argv[2], os);
+        })) {
+      llvm::errs() << "Error: " << llvm::toString(std::move(err)) << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  llvm::StringRef batchArg = argc >= 2 ? argv[1] : "";
+  if (batchArg.consume_front("--batch-jsonl")) {
+    // Compile the requests read from stdin with the remaining arguments as
+    // their base configuration. --batch-jsonl=N bounds the concurrent jobs.
+    unsigned numJobs = 0;
+    if (!batchArg.empty() &&
+        (!batchArg.consume_front("=") || batchArg.getAsInteger(10, numJobs))) {
+      llvm::errs() << "Error: malformed --batch-jsonl job count\n";
+      return 1;
+    }
+    int const responseFd = redirectStdout();
+    if (responseFd < 0) {
+      llvm::errs() << "Error: unable to set up the batch streams\n";
+      return 1;
+    }
+    llvm::raw_fd_ostream responses(responseFd, /*shouldClose=*/true);
+
+    std::vector<const char *> baseArgv{argv[0]};
+    baseArgv.insert(baseArgv.end(), argv + 2, argv + argc);
+    baseArgv.push_back(nullptr);
+    return qssc::compileJSONL(static_cast<int>(baseArgv.size() - 1),
+                              baseArgv.data(), std::cin, responses, numJobs);
+  }
+
   return qssc::compile(argc, argv, nullptr, {});
 }
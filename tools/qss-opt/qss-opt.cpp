@@ -18,6 +18,10 @@
 // registered. It is mainly for diagnostic verification (testing) but can
 // also be used for benchmarking and other types of testing.
 //
+// With --batch-input, many inputs are processed concurrently on a shared
+// thread pool, along with the chunks of split input files, and the time spent
+// on each input is reported, for running passes over large corpora.
+//
 //===----------------------------------------------------------------------===//
 
 #include "Config/CLIConfig.h"
@@ -27,31 +31,49 @@
 #include "HAL/TargetSystemRegistry.h"
 #include "Payload/PayloadRegistry.h"
 
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Debug/Counter.h"
 #include "mlir/IR/AsmState.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
 #include "mlir/InitAllExtensions.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Support/Timing.h"
+#include "mlir/Tools/ParseUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/Twine.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <chrono>
+#include <cstddef>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <stdio.h> // NOLINT: fileno is not in cstdio as suggested
 #include <string>
 #include <utility>
+#include <vector>
 
 using namespace qssc;
 using namespace qssc::hal;
@@ -60,6 +82,28 @@ using namespace qssc::hal;
 static const std::string toolName = "qss-opt";
 
 namespace {
+llvm::cl::list<std::string> batchInputs(
+    "batch-input",
+    llvm::cl::desc("Process these input files concurrently instead of the "
+                   "positional input, writing the time spent on each as JSON "
+                   "lines to the output"),
+    llvm::cl::value_desc("filename"), llvm::cl::CommaSeparated,
+    llvm::cl::cat(qssc::config::getQSSOptCLCategory()));
+
+llvm::cl::opt<std::string> batchInputList(
+    "batch-input-list",
+    llvm::cl::desc("File listing more batch inputs, one per line"),
+    llvm::cl::value_desc("filename"), llvm::cl::init(""),
+    llvm::cl::cat(qssc::config::getQSSOptCLCategory()));
+
+llvm::cl::opt<std::string> batchOutputDir(
+    "batch-output-dir",
+    llvm::cl::desc("Directory to write the output of each batch input to, "
+                   "named after the input. The outputs are discarded if "
+                   "unset"),
+    llvm::cl::value_desc("directory"), llvm::cl::init(""),
+    llvm::cl::cat(qssc::config::getQSSOptCLCategory()));
+
 void registerAndParseCLIOptions(int argc, char **argv, llvm::StringRef toolName,
                                 mlir::DialectRegistry &registry) {
 
@@ -134,6 +178,231 @@ llvm::Error buildTarget_(qssc::config::QSSConfig &config) {
 }
 } // anonymous namespace
 
+namespace {
+// The marker between the chunks of split input files, as in MlirOptMain.
+constexpr llvm::StringLiteral splitMarker = "// -----";
+
+/// A chunk of a batch input, processed by a job of its own.
+struct BatchChunk {
+  size_t input;
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  std::string output;
+  std::string diagnostics;
+  bool succeeded = false;
+  double seconds = 0.;
+};
+
+/// Split a batch input into its chunks, naming each after the line it starts
+/// on so that diagnostics refer to the input.
+void splitBatchInput(size_t input, llvm::MemoryBuffer &buffer, bool split,
+                     std::vector<BatchChunk> &chunks) {
+  llvm::StringRef const name = buffer.getBufferIdentifier();
+  llvm::StringRef remaining = buffer.getBuffer();
+  if (!split) {
+    chunks.push_back(
+        {input, llvm::MemoryBuffer::getMemBufferCopy(remaining, name)});
+    return;
+  }
+
+  unsigned line = 1;
+  unsigned chunkLine = 1;
+  llvm::StringRef chunk = remaining;
+  size_t chunkSize = 0;
+  while (!remaining.empty()) {
+    auto [current, rest] = remaining.split('\n');
+    size_t const lineSize = rest.data() ? rest.data() - remaining.data()
+                                        : remaining.size();
+    if (current.ltrim().startswith(splitMarker)) {
+      chunks.push_back(
+          {input, llvm::MemoryBuffer::getMemBufferCopy(
+                      chunk.take_front(chunkSize),
+                      name + ":" + llvm::Twine(chunkLine) + " offset ")});
+      chunk = rest;
+      chunkSize = 0;
+      chunkLine = line + 1;
+    } else {
+      chunkSize += lineSize;
+    }
+    remaining = remaining.drop_front(lineSize);
+    ++line;
+  }
+  chunks.push_back({input, llvm::MemoryBuffer::getMemBufferCopy(
+                               chunk.take_front(chunkSize),
+                               name + ":" + llvm::Twine(chunkLine) +
+                                   " offset ")});
+}
+
+/// Parse a chunk, run the pass pipeline on it and print the result, as
+/// MlirOptMain does, in a context of its own sharing threadPool.
+mlir::LogicalResult processBatchChunk(BatchChunk &chunk,
+                                      mlir::DialectRegistry &registry,
+                                      const qssc::config::QSSConfig &config,
+                                      llvm::ThreadPool &threadPool,
+                                      bool keepOutput) {
+  mlir::MLIRContext context(registry,
+                            mlir::MLIRContext::Threading::DISABLED);
+  context.setThreadPool(threadPool);
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+  context.printOpOnDiagnostic(!config.shouldVerifyDiagnostics());
+
+  auto sourceMgr = std::make_shared<llvm::SourceMgr>();
+  sourceMgr->AddNewSourceBuffer(std::move(chunk.buffer), llvm::SMLoc());
+  llvm::raw_string_ostream diagnostics(chunk.diagnostics);
+
+  auto run = [&]() -> mlir::LogicalResult {
+    mlir::ParserConfig const parseConfig(&context,
+                                         /*verifyAfterParse=*/true);
+    mlir::OwningOpRef<mlir::Operation *> op = mlir::parseSourceFileForTool(
+        sourceMgr, parseConfig, !config.shouldUseExplicitModule());
+    if (!op)
+      return mlir::failure();
+
+    mlir::PassManager pm(op.get()->getName(),
+                         mlir::PassManager::Nesting::Implicit);
+    pm.enableVerifier(config.shouldVerifyPasses());
+    if (mlir::failed(mlir::applyPassManagerCLOptions(pm)) ||
+        mlir::failed(config.setupPassPipeline(pm)) ||
+        mlir::failed(pm.run(*op)))
+      return mlir::failure();
+
+    if (!keepOutput)
+      return mlir::success();
+    llvm::raw_string_ostream os(chunk.output);
+    if (config.shouldEmitBytecode()) {
+      mlir::BytecodeWriterConfig writerConfig;
+      if (auto version = config.bytecodeVersionToEmit())
+        writerConfig.setDesiredBytecodeVersion(*version);
+      return mlir::writeBytecodeToFile(op.get(), os, writerConfig);
+    }
+    op.get()->print(os);
+    os << '\n';
+    return mlir::success();
+  };
+
+  if (!config.shouldVerifyDiagnostics()) {
+    mlir::SourceMgrDiagnosticHandler const handler(*sourceMgr, &context,
+                                                   diagnostics);
+    return run();
+  }
+  mlir::SourceMgrDiagnosticVerifierHandler handler(*sourceMgr, &context,
+                                                   diagnostics);
+  (void)run();
+  return handler.verify();
+}
+
+/// Get the inputs of the batch mode from the command line.
+llvm::Expected<std::vector<std::string>> getBatchInputs() {
+  std::vector<std::string> inputs(batchInputs.begin(), batchInputs.end());
+  if (!batchInputList.empty()) {
+    auto list = llvm::MemoryBuffer::getFileOrSTDIN(batchInputList);
+    if (!list)
+      return llvm::createStringError(list.getError(),
+                                     "Error: Unable to read " +
+                                         batchInputList);
+    llvm::SmallVector<llvm::StringRef> lines;
+    (*list)->getBuffer().split(lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+    for (auto line : lines)
+      if (!line.trim().empty())
+        inputs.push_back(line.trim().str());
+  }
+
+  if (!batchOutputDir.empty()) {
+    llvm::StringSet<> names;
+    for (const auto &input : inputs)
+      if (!names.insert(llvm::sys::path::filename(input)).second)
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            "Error: More than one batch input is named " +
+                llvm::sys::path::filename(input));
+  }
+  return inputs;
+}
+
+/// Process the batch inputs concurrently, the chunks of split input files
+/// included, and write the time spent on each input as JSON lines. The
+/// diagnostics of each chunk are printed at once when it completes.
+mlir::LogicalResult processBatch(llvm::raw_ostream &os,
+                                 mlir::DialectRegistry &registry,
+                                 const qssc::config::QSSConfig &config) {
+  auto inputs = getBatchInputs();
+  if (auto err = inputs.takeError()) {
+    llvm::errs() << err << "\n";
+    return mlir::failure();
+  }
+
+  std::vector<BatchChunk> chunks;
+  std::vector<bool> opened(inputs->size(), false);
+  for (size_t i = 0; i < inputs->size(); ++i) {
+    std::string errorMessage;
+    auto file = mlir::openInputFile((*inputs)[i], &errorMessage);
+    if (!file) {
+      llvm::errs() << errorMessage << "\n";
+      continue;
+    }
+    opened[i] = true;
+    splitBatchInput(i, *file, config.shouldSplitInputFile(), chunks);
+  }
+
+  bool const keepOutput = !batchOutputDir.empty();
+  llvm::ThreadPool threadPool(
+      llvm::hardware_concurrency(config.getNumThreads().value_or(0)));
+  std::mutex diagnosticsMutex;
+  llvm::ThreadPoolTaskGroup jobs(threadPool);
+  for (auto &chunk : chunks)
+    jobs.async([&]() {
+      auto const started = std::chrono::steady_clock::now();
+      chunk.succeeded = mlir::succeeded(processBatchChunk(
+          chunk, registry, config, threadPool, keepOutput));
+      chunk.seconds = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - started)
+                          .count();
+      const std::lock_guard<std::mutex> lock(diagnosticsMutex);
+      llvm::errs() << chunk.diagnostics;
+    });
+  jobs.wait();
+
+  bool succeeded = true;
+  size_t next = 0;
+  for (size_t i = 0; i < inputs->size(); ++i) {
+    bool inputSucceeded = opened[i];
+    double seconds = 0.;
+    size_t numChunks = 0;
+    std::string output;
+    for (; next < chunks.size() && chunks[next].input == i; ++next) {
+      inputSucceeded &= chunks[next].succeeded;
+      seconds += chunks[next].seconds;
+      if (numChunks++ > 0)
+        output += (splitMarker + "\n").str();
+      output += chunks[next].output;
+    }
+    succeeded &= inputSucceeded;
+
+    if (keepOutput && inputSucceeded) {
+      llvm::SmallString<128> outputPath(batchOutputDir.getValue());
+      llvm::sys::path::append(outputPath,
+                              llvm::sys::path::filename((*inputs)[i]));
+      if (auto err = llvm::writeToOutput(
+              outputPath, [&](llvm::raw_ostream &out) -> llvm::Error {
+                out << output;
+                return llvm::Error::success();
+              })) {
+        llvm::errs() << err << "\n";
+        succeeded = false;
+      }
+    }
+
+    os << llvm::json::Value(llvm::json::Object{
+              {"input", (*inputs)[i]},
+              {"status", inputSucceeded ? 0 : 1},
+              {"chunks", static_cast<int64_t>(numChunks)},
+              {"seconds", seconds}})
+       << "\n";
+  }
+  return mlir::success(succeeded);
+}
+} // anonymous namespace
+
 mlir::LogicalResult QSSCOptMain(int argc, char **argv,
                                 mlir::DialectRegistry &registry,
                                 qssc::config::QSSConfig &config) {
@@ -145,6 +414,19 @@ mlir::LogicalResult QSSCOptMain(int argc, char **argv,
     return mlir::failure();
   }
 
+  if (!batchInputs.empty() || !batchInputList.empty()) {
+    std::string errorMessage;
+    auto output =
+        mlir::openOutputFile(config.getOutputFilePath(), &errorMessage);
+    if (!output) {
+      llvm::errs() << errorMessage << "\n";
+      return mlir::failure();
+    }
+    auto const result = processBatch(output->os(), registry, config);
+    output->keep();
+    return result;
+  }
+
   // When reading from stdin and the input is a tty, it is often a user mistake
   // and the process "appears to be stuck". Print a message to let the user know
   // about it!